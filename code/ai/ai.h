@@ -267,6 +267,22 @@ extern pnode	*Ppfp;			//	Free pointer in path points.
 // Goober5000 (based on the "you can only remember 7 things in short-term memory" assumption)
 #define MAX_IGNORE_NEW_OBJECTS	7
 
+// the arguments of a call to ai_turn_towards_vector(), so ships which are not updated every frame can keep turning
+typedef struct ai_lod_turn {
+	bool	valid;
+	vec3d	dest;
+	float	turn_time;
+	bool	has_slide_vec;
+	vec3d	slide_vec;
+	bool	has_rel_pos;
+	vec3d	rel_pos;
+	float	bank_override;
+	int		flags;
+	bool	has_rvec;
+	vec3d	rvec;
+	int		sexp_flags;
+} ai_lod_turn;
+
 typedef struct ai_info {
 	flagset<AI::AI_Flags> ai_flags;				//	Special flags for AI behavior.
 	int		shipnum;					// Ship using this slot, -1 means none.
@@ -488,6 +504,18 @@ typedef struct ai_info {
 	flagset<AI::Maneuver_Override_Flags>	ai_override_flags;			// flags for marking ai overrides from sexp or lua systems
 	control_info	ai_override_ci;		// ai override control info
 	int		ai_override_timestamp;		// mark for when to end the current override
+
+	// reduced rate updates of distant ships, see ai_process()
+	std::int64_t	lod_think_timestamp;	// time at which the next full update is made, 1 if the ship is updated every frame, see timestamp_us()
+	control_info	lod_ci;				// the controls set by the last full update
+	ai_lod_turn	lod_turn;			// the last turn made by the last full update, repeated until the next one
+
+	// the result of the search for an enemy made by ai_think_all()
+	int		think_frame;				// the frame the search was made in, -1 if there is no result to use
+	int		think_enemy_team_mask;
+	int		think_enemy_wing;
+	int		think_nearest_objnum;
+	int		think_nearest_signature;
 } ai_info;
 
 // Goober5000
@@ -512,12 +540,16 @@ typedef struct {
 #define MAX_BURST_DAMAGE	20		// max damage that can be done in BURST_DURATION
 #define BURST_DURATION		500	// decay time over which Player->damage_this_burst falls from MAX_BURST_DAMAGE to 0
 
+extern bool Ai_lod_enabled;		// distant ships make their decisions at a reduced rate
+extern bool Ai_parallel_think;	// the ships search for enemies on the worker threads before they are moved
 extern int Mission_all_attack;	//	!0 means all teams attack all teams.
 extern int Total_goal_target_names;
 extern char Goal_target_names[MAX_GOAL_TARGET_NAMES][NAME_LENGTH];
 
 extern void update_ai_info_for_hit(int hitter_obj, int hit_obj);
 extern void ai_frame_all(void);
+extern void ai_think_all();
+extern bool ai_think_get_nearest_enemy(ai_info *aip, int enemy_team_mask, float range, int max_attackers, int ship_info_index, int *nearest_objnum);
 
 extern int find_guard_obj(void);
 
@@ -555,9 +555,9 @@ void ai_big_chase_attack(ai_info *aip, ship_info *sip, vec3d *enemy_pos, float d
 	} else {
 		//	If moving slowly, maybe evade incoming fire.
 		if (Pl_objp->phys_info.speed < 3.0f) {
-			object *objp;
-			for ( objp = GET_FIRST(&obj_used_list); objp !=END_OF_LIST(&obj_used_list); objp = GET_NEXT(objp) ) {
-				if ((objp->type == OBJ_WEAPON) && (iff_x_attacks_y(Ships[Pl_objp->instance].team, Weapons[objp->instance].team)))
+			for (int objnum : obj_get_type_list(OBJ_WEAPON)) {
+				object *objp = &Objects[objnum];
+				if (iff_x_attacks_y(Ships[Pl_objp->instance].team, Weapons[objp->instance].team))
 					if (Weapon_info[Weapons[objp->instance].weapon_info_index].subtype == WP_LASER) {
 						vec3d	in_vec;
 						float		dist;
@@ -758,12 +758,12 @@ void ai_big_maybe_fire_weapons(float dist_to_enemy, float dot_to_enemy, vec3d *f
 							//	If ship is protected and very low on hits, don't fire missiles.
 							if (!(En_objp->flags[Object::Object_Flags::Protected]) || (En_objp->hull_strength > 10*swip->damage)) {
 								if (aip->ai_flags[AI::AI_Flags::Unload_secondaries]) {
-									if (timestamp_until(swp->next_secondary_fire_stamp[current_bank]) > swip->fire_wait*1000.0f) {
-										swp->next_secondary_fire_stamp[current_bank] = timestamp((int) (swip->fire_wait*1000.0f));
+									if (timestamp_us_until(swp->next_secondary_fire_stamp[current_bank]) > swip->fire_wait*1000000.0f) {
+										swp->next_secondary_fire_stamp[current_bank] = timestamp_us((std::int64_t) (swip->fire_wait*1000000.0f));
 									}
 								}
 
-								if (timestamp_elapsed(swp->next_secondary_fire_stamp[current_bank])) {
+								if (timestamp_us_elapsed(swp->next_secondary_fire_stamp[current_bank])) {
 									float firing_range;
 									if (swip->wi_flags[Weapon::Info_Flags::Local_ssm])
 										firing_range=swip->lssm_lock_range;
@@ -811,11 +811,11 @@ void ai_big_maybe_fire_weapons(float dist_to_enemy, float dot_to_enemy, vec3d *f
 														}
 													}
 												}
-												swp->next_secondary_fire_stamp[current_bank] = timestamp((int) (t*1000.0f));
+												swp->next_secondary_fire_stamp[current_bank] = timestamp_us((std::int64_t) (t*1000000.0f));
 											}
 										//}
 									}
-									swp->next_secondary_fire_stamp[current_bank] = timestamp((int) (t*1000.0f));
+									swp->next_secondary_fire_stamp[current_bank] = timestamp_us((std::int64_t) (t*1000000.0f));
 								}
 							}
 						}
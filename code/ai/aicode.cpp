@@ -29,6 +29,7 @@
 #include "freespace.h"
 #include "gamesequence/gamesequence.h"
 #include "gamesnd/gamesnd.h"
+#include "globalincs/jobs.h"
 #include "globalincs/linklist.h"
 #include "hud/hud.h"
 #include "hud/hudets.h"
@@ -53,6 +54,7 @@
 #include "object/object.h"
 #include "object/objectdock.h"
 #include "object/objectshield.h"
+#include "object/objspatial.h"
 #include "object/waypoint.h"
 #include "parse/parselo.h"
 #include "physics/physics.h"
@@ -63,6 +65,7 @@
 #include "ship/ship.h"
 #include "ship/shipfx.h"
 #include "ship/shiphit.h"
+#include "tracing/Monitor.h"
 #include "weapon/beam.h"
 #include "weapon/flak.h"
 #include "weapon/swarm.h"
@@ -1130,6 +1133,28 @@ void ai_update_danger_weapon(int attacked_objnum, int weapon_objnum)
 	}
 }
 
+// the ship whose turns are recorded for the frames in which it isn't updated, see ai_process()
+static object *Ai_lod_turn_objp = NULL;
+
+static void ai_lod_record_turn(ai_lod_turn *turn, vec3d *dest, float turn_time, vec3d *slide_vec, vec3d *rel_pos, float bank_override, int flags, vec3d *rvec, int sexp_flags)
+{
+	turn->valid = true;
+	turn->dest = *dest;
+	turn->turn_time = turn_time;
+	turn->has_slide_vec = (slide_vec != NULL);
+	if (slide_vec != NULL)
+		turn->slide_vec = *slide_vec;
+	turn->has_rel_pos = (rel_pos != NULL);
+	if (rel_pos != NULL)
+		turn->rel_pos = *rel_pos;
+	turn->bank_override = bank_override;
+	turn->flags = flags;
+	turn->has_rvec = (rvec != NULL);
+	if (rvec != NULL)
+		turn->rvec = *rvec;
+	turn->sexp_flags = sexp_flags;
+}
+
 //	If rvec != NULL, use it to match bank by calling vm_matrix_interpolate.
 //	(rvec defaults to NULL)
 void ai_turn_towards_vector(vec3d *dest, object *objp, float frametime, float turn_time, vec3d *slide_vec, vec3d *rel_pos, float bank_override, int flags, vec3d *rvec, int sexp_flags)
@@ -1141,6 +1166,10 @@ void ai_turn_towards_vector(vec3d *dest, object *objp, float frametime, float tu
 	vec3d	vel_limit, acc_limit;
 	float		delta_bank;
 
+	if (objp == Ai_lod_turn_objp) {
+		ai_lod_record_turn(&Ai_info[Ships[objp->instance].ai_index].lod_turn, dest, turn_time, slide_vec, rel_pos, bank_override, flags, rvec, sexp_flags);
+	}
+
 	//	Don't allow a ship to turn if it has no engine strength.
 	// AL 3-12-98: objp may not always be a ship!
 	if ( (objp->type == OBJ_SHIP) && !(sexp_flags & AITTV_VIA_SEXP) ) {
@@ -2036,12 +2065,12 @@ void evaluate_object_as_nearest_objnum(eval_nearest_objnum *eno)
  * @param range				Ship must be within range "range".
  * @param max_attackers		Don't attack a ship that already has at least max_attackers attacking it.
  * @param ship_info_index	If >=0, the enemy object must be of the specified ship class
+ * @param candidates		Receives the ships near the object, so several threads can search at the same time
  */
-int get_nearest_objnum(int objnum, int enemy_team_mask, int enemy_wing, float range, int max_attackers, int ship_info_index)
+static int get_nearest_objnum(int objnum, int enemy_team_mask, int enemy_wing, float range, int max_attackers, int ship_info_index, SCP_vector<int> &candidates)
 {
 	object	*danger_weapon_objp;
 	ai_info	*aip;
-	ship_obj	*so;
 
 	// initialize eno struct
 	eval_nearest_objnum eno;
@@ -2055,9 +2084,12 @@ int get_nearest_objnum(int objnum, int enemy_team_mask, int enemy_wing, float ra
 	eno.nearest_objnum = -1;
 	eno.check_danger_weapon_objnum = 0;
 
-	// go through the list of all ships and evaluate as potential targets
-	for ( so = GET_FIRST(&Ship_obj_list); so != END_OF_LIST(&Ship_obj_list); so = GET_NEXT(so) ) {
-		eno.trial_objp = &Objects[so->objnum];
+	// go through the nearby enemy ships and evaluate as potential targets.  Fighters count at half their distance and
+	// vm_vec_dist_quick() can be off by a tenth, so no ship further away than this can be picked
+	obj_spatial_find_ships(&Objects[objnum].pos, range * 2.5f, enemy_team_mask, candidates);
+
+	for (int candidate : candidates) {
+		eno.trial_objp = &Objects[candidate];
 		evaluate_object_as_nearest_objnum(&eno);
 	}
 
@@ -2089,12 +2121,19 @@ int get_nearest_objnum(int objnum, int enemy_team_mask, int enemy_wing, float ra
 	//	If only looking for target in certain wing and couldn't find anything in
 	//	that wing, look for any object.
 	if ((eno.nearest_objnum == -1) && (enemy_wing != -1)) {
-		return get_nearest_objnum(objnum, enemy_team_mask, -1, range, max_attackers, ship_info_index);
+		return get_nearest_objnum(objnum, enemy_team_mask, -1, range, max_attackers, ship_info_index, candidates);
 	}
 
 	return eno.nearest_objnum;
 }
 
+int get_nearest_objnum(int objnum, int enemy_team_mask, int enemy_wing, float range, int max_attackers, int ship_info_index)
+{
+	static SCP_vector<int> candidates;
+
+	return get_nearest_objnum(objnum, enemy_team_mask, enemy_wing, range, max_attackers, ship_info_index, candidates);
+}
+
 /**
  * Given an object and an enemy team, return the index of the nearest enemy object.
  *
@@ -2155,7 +2194,7 @@ int num_turrets_attacking(object *turret_parent, int target_objnum)
 
 	Assert(turret_parent->type == OBJ_SHIP);
 
-	for (ss=GET_FIRST(&shipp->subsys_list); ss!=END_OF_LIST(&shipp->subsys_list); ss=GET_NEXT(ss)) {
+	for ( ss = shipp->subsys_array; ss < shipp->subsys_array + shipp->num_subsys; ss++ ) {
 		// check if subsys is alive
 		if (ss->current_hits <= 0.0f) {
 			continue;
@@ -2188,6 +2227,135 @@ int get_enemy_timestamp()
 	return (NUM_SKILL_LEVELS - Game_skill_level) * ( (myrand() % 500) + 500);
 }
 
+bool Ai_parallel_think = false;
+
+DCF_BOOL( parallel_ai, Ai_parallel_think )
+
+MONITOR( NumAIThinkSearches )
+MONITOR( NumAIThinkResultsUsed )
+
+static SCP_vector<int> Ai_think_objnums;
+
+int ai_need_new_target(object *pl_objp, int target_objnum);
+
+/**
+ * Checks if ai_frame() will look for a new enemy for a ship this frame, the same way it decides that itself.
+ */
+static bool ai_think_will_find_enemy(object *objp, ai_info *aip)
+{
+	ship *shipp = &Ships[objp->instance];
+	ship_info *sip = &Ship_info[shipp->ship_info_index];
+
+	if ((sip->class_type < 0) || !(Ship_types[sip->class_type].flags[Ship::Type_Info_Flags::AI_auto_attacks]))
+		return false;
+
+	if ((aip->mode == AIM_WARP_OUT) || (aip->mode == AIM_PLAY_DEAD) || (aip->mode == AIM_EVADE_WEAPON))
+		return false;
+
+	if ((aip->active_goal == AI_ACTIVE_GOAL_DYNAMIC) || (aip->resume_goal_time != -1))
+		return false;
+
+	// ships which are updated at a reduced rate only look on the frames they are updated in
+	if ((aip->lod_think_timestamp != 1) && !timestamp_us_elapsed(aip->lod_think_timestamp))
+		return false;
+
+	return timestamp_elapsed(aip->choose_enemy_timestamp) && ai_need_new_target(objp, aip->target_objnum);
+}
+
+/**
+ * The read-only part of the AI frame of all ships, done on the worker threads before any ship is moved.
+ *
+ * For now this is the search for the nearest enemy, the most expensive decision a ship makes.  Every search only looks
+ * at the state the ships are in before the frame, and the results are only taken up by find_enemy() when the ships are
+ * processed one after the other, so the outcome doesn't depend on the number of threads.
+ */
+void ai_think_all()
+{
+	ship_obj *so;
+
+	if (!Ai_parallel_think)
+		return;
+
+	// multiplayer clients don't make decisions for the AI ships
+	if ((Game_mode & GM_MULTIPLAYER) && !MULTIPLAYER_MASTER)
+		return;
+
+	Ai_think_objnums.clear();
+
+	for ( so = GET_FIRST(&Ship_obj_list); so != END_OF_LIST(&Ship_obj_list); so = GET_NEXT(so) ) {
+		object *objp = &Objects[so->objnum];
+		ship *shipp = &Ships[objp->instance];
+
+		if (objp->flags[Object::Object_Flags::Should_be_dead] || shipp->flags[Ship::Ship_Flags::Dying])
+			continue;
+
+		if ((shipp->ai_index < 0) || ((objp->flags[Object::Object_Flags::Player_ship]) && !Player_use_ai))
+			continue;
+
+		if (ai_think_will_find_enemy(objp, &Ai_info[shipp->ai_index]))
+			Ai_think_objnums.push_back(so->objnum);
+	}
+
+	if (Ai_think_objnums.empty())
+		return;
+
+	MONITOR_INC(NumAIThinkSearches, (int)Ai_think_objnums.size());
+
+	obj_spatial_prepare();
+
+	int max_attackers = The_mission.ai_profile->max_attackers[Game_skill_level];
+
+	// one list of candidates per worker, a worker only searches for one ship at a time
+	static SCP_vector<SCP_vector<int>> candidates;
+	candidates.resize(jobs::num_workers());
+
+	jobs::parallel_for(Ai_think_objnums.size(), 4, [max_attackers](size_t begin, size_t end, size_t worker) {
+		for (size_t i = begin; i < end; ++i) {
+			int objnum = Ai_think_objnums[i];
+			ai_info *aip = &Ai_info[Ships[Objects[objnum].instance].ai_index];
+
+			aip->think_enemy_team_mask = iff_get_attackee_mask(obj_team(&Objects[objnum]));
+			aip->think_enemy_wing = aip->enemy_wing;
+			aip->think_nearest_objnum = get_nearest_objnum(objnum, aip->think_enemy_team_mask, aip->enemy_wing,
+				MAX_ENEMY_DISTANCE, max_attackers, -1, candidates[worker]);
+			aip->think_nearest_signature = (aip->think_nearest_objnum >= 0) ? Objects[aip->think_nearest_objnum].signature : -1;
+			aip->think_frame = Framecount;
+		}
+	}, tracing::AIThinkJob);
+}
+
+/**
+ * Takes up the enemy found for a ship by ai_think_all(), if it was searched for the same way and is still valid.
+ *
+ * @return true if *nearest_objnum was set
+ */
+bool ai_think_get_nearest_enemy(ai_info *aip, int enemy_team_mask, float range, int max_attackers, int ship_info_index, int *nearest_objnum)
+{
+	if (aip->think_frame != Framecount)
+		return false;
+
+	// a result is only used once, another search in the same frame has to see what changed since
+	aip->think_frame = -1;
+
+	if ((range != MAX_ENEMY_DISTANCE) || (max_attackers != The_mission.ai_profile->max_attackers[Game_skill_level]) || (ship_info_index >= 0))
+		return false;
+
+	if ((enemy_team_mask != aip->think_enemy_team_mask) || (aip->enemy_wing != aip->think_enemy_wing))
+		return false;
+
+	if (aip->think_nearest_objnum >= 0) {
+		object *objp = &Objects[aip->think_nearest_objnum];
+
+		if ((objp->signature != aip->think_nearest_signature) || (objp->flags[Object::Object_Flags::Should_be_dead]) || (Ships[objp->instance].flags[Ship::Ship_Flags::Dying]))
+			return false;
+	}
+
+	MONITOR_INC(NumAIThinkResultsUsed, 1);
+
+	*nearest_objnum = aip->think_nearest_objnum;
+	return true;
+}
+
 /**
  * Return objnum if enemy found, else return -1;
  *
@@ -2227,6 +2395,10 @@ int find_enemy(int objnum, float range, int max_attackers, int ship_info_index)
 			}
 		}
 		
+		int nearest_objnum;
+		if (ai_think_get_nearest_enemy(aip, enemy_team_mask, range, max_attackers, ship_info_index, &nearest_objnum))
+			return nearest_objnum;
+
 		return get_nearest_objnum(objnum, enemy_team_mask, aip->enemy_wing, range, max_attackers, ship_info_index);
 		
 	} else {
@@ -5745,7 +5917,7 @@ int ai_fire_primary_weapon(object *objp)
 			((aip->targeted_subsys == NULL) || (enemy_objp->hull_strength < aip->targeted_subsys->current_hits + 50.0f)) &&
 			(swp->current_primary_bank >= 0) ) {
 			if (!(Weapon_info[swp->primary_bank_weapons[swp->current_primary_bank]].wi_flags[Weapon::Info_Flags::Puncture])) {
-				swp->next_primary_fire_stamp[swp->current_primary_bank] = timestamp(1000);
+				swp->next_primary_fire_stamp[swp->current_primary_bank] = timestamp_us(1000000);
 				return 0;
 			}
 		}
@@ -5923,16 +6095,11 @@ void ai_select_secondary_weapon(object *objp, ship_weapon *swp, flagset<Weapon::
  */
 int compute_num_homing_objects(object *target_objp)
 {
-	object	*objp;
 	int		count = 0;
 
-	for ( objp = GET_FIRST(&obj_used_list); objp !=END_OF_LIST(&obj_used_list); objp = GET_NEXT(objp) ) {
-		if (objp->type == OBJ_WEAPON) {
-			if (Weapon_info[Weapons[objp->instance].weapon_info_index].is_homing()) {
-				if (Weapons[objp->instance].homing_object == target_objp) {
-					count++;
-				}
-			}
+	for (int objnum : obj_get_homing_weapons()) {
+		if (Weapons[Objects[objnum].instance].homing_object == target_objp) {
+			count++;
 		}
 	}
 
@@ -6083,7 +6250,7 @@ int ai_fire_secondary_weapon(object *objp, int priority1, int priority2)
 	weapon_info	*wip = &Weapon_info[shipp->weapons.secondary_bank_weapons[current_bank]];
 
 	if ((wip->is_locked_homing()) && (!Ai_info[shipp->ai_index].current_target_is_locked)) {
-		swp->next_secondary_fire_stamp[current_bank] = timestamp(250);
+		swp->next_secondary_fire_stamp[current_bank] = timestamp_us(250000);
 	} else if ((wip->wi_flags[Weapon::Info_Flags::Bomb]) || (vm_vec_dist_quick(&objp->pos, &En_objp->pos) > 50.0f)) {
 		//	This might look dumb, firing a bomb even if closer than 50 meters, but the reason is, if you're carrying
 		//	bombs, delivering them is probably more important than surviving.
@@ -6096,11 +6263,11 @@ int ai_fire_secondary_weapon(object *objp, int priority1, int priority2)
 		if (check_ok_to_fire(OBJ_INDEX(objp), aip->target_objnum, wip)) {
 			if (ship_fire_secondary(objp)) {
 				rval = 1;
-				swp->next_secondary_fire_stamp[current_bank] = timestamp(500);
+				swp->next_secondary_fire_stamp[current_bank] = timestamp_us(500000);
 			}
 
 		} else {
-			swp->next_secondary_fire_stamp[current_bank] = timestamp(500);
+			swp->next_secondary_fire_stamp[current_bank] = timestamp_us(500000);
 		}
 	}
 
@@ -8787,12 +8954,12 @@ void ai_chase()
 						if (current_bank > -1) {
 							weapon_info	*swip = &Weapon_info[tswp->secondary_bank_weapons[current_bank]];
 							if (aip->ai_flags[AI::AI_Flags::Unload_secondaries]) {
-								if (timestamp_until(swp->next_secondary_fire_stamp[current_bank]) > swip->fire_wait*1000.0f) {
-									swp->next_secondary_fire_stamp[current_bank] = timestamp((int) (swip->fire_wait*1000.0f));
+								if (timestamp_us_until(swp->next_secondary_fire_stamp[current_bank]) > swip->fire_wait*1000000.0f) {
+									swp->next_secondary_fire_stamp[current_bank] = timestamp_us((std::int64_t) (swip->fire_wait*1000000.0f));
 								}
 							}
 
-							if (timestamp_elapsed(swp->next_secondary_fire_stamp[current_bank])) {
+							if (timestamp_us_elapsed(swp->next_secondary_fire_stamp[current_bank])) {
 								if (current_bank >= 0) {
 									float firing_range;
 									
@@ -8868,10 +9035,10 @@ void ai_chase()
 													}
 												}
 											}
-											swp->next_secondary_fire_stamp[current_bank] = timestamp((int) (t*1000.0f));
+											swp->next_secondary_fire_stamp[current_bank] = timestamp_us((std::int64_t) (t*1000000.0f));
 										}
 									} else {
-										swp->next_secondary_fire_stamp[current_bank] = timestamp(250);
+										swp->next_secondary_fire_stamp[current_bank] = timestamp_us(250000);
 									}
 								}
 							}
@@ -9734,24 +9901,23 @@ void ai_guard_find_nearby_asteroid(object *guarding_objp, object *guarded_objp)
 	object	*closest_asteroid_objp=NULL, *danger_asteroid_objp=NULL, *asteroid_objp;
 	float		dist_to_self, closest_danger_asteroid_dist=999999.0f, closest_asteroid_dist=999999.0f;
 
-	for ( asteroid_objp = GET_FIRST(&obj_used_list); asteroid_objp != END_OF_LIST(&obj_used_list); asteroid_objp = GET_NEXT(asteroid_objp) ) {
-		if ( asteroid_objp->type == OBJ_ASTEROID ) {
-			// Attack asteroid if near guarded ship
-			dist = vm_vec_dist_quick(&asteroid_objp->pos, &guarded_objp->pos);
-			if ( dist < (MAX_GUARD_DIST + guarded_objp->radius)*2) {
-				dist_to_self = vm_vec_dist_quick(&asteroid_objp->pos, &guarding_objp->pos);
-				if ( OBJ_INDEX(guarded_objp) == asteroid_collide_objnum(asteroid_objp) ) {
-					if( dist_to_self < closest_danger_asteroid_dist ) {
-						danger_asteroid_objp=asteroid_objp;
-						closest_danger_asteroid_dist=dist_to_self;
-					}
-				} 
-				if ( dist_to_self < closest_asteroid_dist ) {
-					// only attack if moving slower than own max speed
-					if ( vm_vec_mag_quick(&asteroid_objp->phys_info.vel) < guarding_objp->phys_info.max_vel.xyz.z ) {
-						closest_asteroid_dist = dist_to_self;
-						closest_asteroid_objp = asteroid_objp;
-					}
+	for (int objnum : obj_get_type_list(OBJ_ASTEROID)) {
+		asteroid_objp = &Objects[objnum];
+		// Attack asteroid if near guarded ship
+		dist = vm_vec_dist_quick(&asteroid_objp->pos, &guarded_objp->pos);
+		if ( dist < (MAX_GUARD_DIST + guarded_objp->radius)*2) {
+			dist_to_self = vm_vec_dist_quick(&asteroid_objp->pos, &guarding_objp->pos);
+			if ( OBJ_INDEX(guarded_objp) == asteroid_collide_objnum(asteroid_objp) ) {
+				if( dist_to_self < closest_danger_asteroid_dist ) {
+					danger_asteroid_objp=asteroid_objp;
+					closest_danger_asteroid_dist=dist_to_self;
+				}
+			} 
+			if ( dist_to_self < closest_asteroid_dist ) {
+				// only attack if moving slower than own max speed
+				if ( vm_vec_mag_quick(&asteroid_objp->phys_info.vel) < guarding_objp->phys_info.max_vel.xyz.z ) {
+					closest_asteroid_dist = dist_to_self;
+					closest_asteroid_objp = asteroid_objp;
 				}
 			}
 		}
@@ -11143,6 +11309,46 @@ void ai_debug_render_stuff()
 
 
 
+// the teams which have a ship, debris or weapon this frame and whether there is something which is the enemy of all
+// teams, see ai_turret_enemies_present()
+static int Turret_teams_frame = -1;
+static int Turret_teams_present = 0;
+static bool Turret_common_enemy_present = false;
+
+//	Returns true if there is anything the turrets of a ship of the team could shoot at: a ship, a piece of debris or a
+//	weapon of another team, or an asteroid.  The objects are only looked at once a frame for all ships.
+static bool ai_turret_enemies_present(int team)
+{
+	if (Turret_teams_frame != Framecount) {
+		Turret_teams_frame = Framecount;
+		Turret_teams_present = 0;
+		Turret_common_enemy_present = false;
+
+		for (object *objp = GET_FIRST(&obj_used_list); objp != END_OF_LIST(&obj_used_list); objp = GET_NEXT(objp)) {
+			switch (objp->type) {
+			case OBJ_SHIP:
+			case OBJ_DEBRIS:
+			case OBJ_WEAPON: {
+				int obj_team_num = obj_team(objp);
+
+				// an object without a team is not on the team of any ship
+				if (obj_team_num >= 0) {
+					Turret_teams_present |= (1 << obj_team_num);
+				} else {
+					Turret_common_enemy_present = true;
+				}
+				break;
+			}
+			case OBJ_ASTEROID:
+				Turret_common_enemy_present = true;
+				break;
+			}
+		}
+	}
+
+	return Turret_common_enemy_present || (Turret_teams_present & ~(1 << team)) != 0;
+}
+
 //	--------------------------------------------------------------------------
 // Process subobjects of object objnum.
 //	Deal with engines disabled.
@@ -11157,8 +11363,12 @@ void process_subobjects(int objnum)
 	//Look for enemies. If none are present, we don't have to move turrets
 	int enemies_present = -1;
 
+	// the turrets are aimed and fired together once the other subsystems are done
+	static SCP_vector<ship_subsys*> fire_turrets;
+	fire_turrets.clear();
+
 	model_subsystem	*psub;
-	for ( pss = GET_FIRST(&shipp->subsys_list); pss !=END_OF_LIST(&shipp->subsys_list); pss = GET_NEXT(pss) ) {
+	for ( pss = shipp->subsys_array; pss < shipp->subsys_array + shipp->num_subsys; pss++ ) {
 		psub = pss->system_info;
 
 		// Don't process destroyed objects (but allow subobjects with hitpoints disabled -nuke) (but also process subobjects that are allowed to rotate)
@@ -11178,32 +11388,11 @@ void process_subobjects(int objnum)
 			{
 				if(enemies_present == -1)
 				{
-					enemies_present = 0;
-					for(unsigned int i = 0; i < MAX_OBJECTS; i++)
-					{
-						objp = &Objects[i];
-						switch(objp->type)
-						{
-							case OBJ_SHIP:
-							case OBJ_DEBRIS:
-							case OBJ_WEAPON:
-								if(obj_team(objp) != shipp->team)
-									enemies_present = 1;
-								break;
-							case OBJ_ASTEROID:
-								enemies_present = 1;
-								break;
-						}
-
-						if(enemies_present==1)
-							break;
-					}
-					//Reset objp
-					objp = &Objects[objnum];
+					enemies_present = ai_turret_enemies_present(shipp->team) ? 1 : 0;
 				}
 				//Only move turrets if enemies are present
 				if(enemies_present == 1 || pss->turret_enemy_objnum >= 0)
-					ai_fire_from_turret(shipp, pss, objnum);
+					fire_turrets.push_back(pss);
 			} else {
 				Warning( LOCATION, "Turret %s on ship %s has no firing points assigned to it.\nThis needs to be fixed in the model.\n", psub->name, shipp->ship_name );
 			}
@@ -11231,6 +11420,10 @@ void process_subobjects(int objnum)
 		ship_do_submodel_rotation(shipp, psub, pss);
 	}
 
+	if ( !fire_turrets.empty() ) {
+		ai_fire_from_turrets(shipp, objnum, fire_turrets);
+	}
+
 	//	Deal with a ship with blown out engines.
 	if (ship_get_subsystem_strength(shipp, SUBSYSTEM_ENGINE) == 0.0f) {
 		// Karajorma - if Player_use_ai is ever fixed to work on multiplayer it should be checked that any player ships 
@@ -14201,6 +14394,93 @@ void ai_control_info_check( object *obj, ai_info *aip )
 
 int Last_ai_obj = -1;
 
+bool Ai_lod_enabled = false;
+
+DCF_BOOL( ai_lod, Ai_lod_enabled )
+
+MONITOR( NumAILodThinks )
+MONITOR( NumAILodSkips )
+
+#define AI_LOD_NEAR_DIST		2000.0f		//	Ships closer than this to the player or the eye are updated every frame.
+#define AI_LOD_FAR_DIST			5000.0f		//	Ships further away than this which are not on screen are updated least often.
+#define AI_LOD_NEAR_INTERVAL	100			//	Milliseconds between the full updates of distant ships.
+#define AI_LOD_FAR_INTERVAL		200
+#define AI_LOD_FRAME_BUDGET		2000		//	Microseconds per frame for the full updates of distant ships, more are put off.
+#define AI_LOD_HIT_TIME			(F1_0 * 5)	//	Ships hit this recently are updated every frame.
+
+static std::uint64_t Ai_lod_frame_time = 0;	//	Microseconds spent on the full updates of distant ships this frame.
+
+//	Returns the number of milliseconds between the full updates of a ship, 0 if it has to be updated every frame.
+//	Only ships which are far away from the viewer and not busy with anything that needs a quick reaction qualify.
+static int ai_lod_interval(object *objp, ai_info *aip)
+{
+	if (!Ai_lod_enabled || (Game_mode & GM_MULTIPLAYER) || AutoPilotEngaged)
+		return 0;
+
+	if (objp == Player_obj)
+		return 0;
+
+	switch (aip->mode) {
+	case AIM_NONE:
+	case AIM_STILL:
+	case AIM_WAYPOINTS:
+	case AIM_FLY_TO_SHIP:
+		break;
+	default:
+		return 0;
+	}
+
+	if (aip->ai_flags[AI::AI_Flags::Formation_object, AI::AI_Flags::Formation_wing, AI::AI_Flags::Awaiting_repair, AI::AI_Flags::Being_repaired,
+		AI::AI_Flags::Avoid_shockwave_ship, AI::AI_Flags::Avoid_shockwave_weapon, AI::AI_Flags::Big_ship_collide_recover_1,
+		AI::AI_Flags::Big_ship_collide_recover_2, AI::AI_Flags::Trying_unsuccessfully_to_warp])
+		return 0;
+
+	if (aip->ai_override_flags.any_set())
+		return 0;
+
+	if ((aip->danger_weapon_objnum >= 0) || (Missiontime - aip->last_hit_time < AI_LOD_HIT_TIME))
+		return 0;
+
+	float dist = vm_vec_dist_quick(&objp->pos, &Eye_position);
+	if (Player_obj != NULL)
+		dist = MIN(dist, vm_vec_dist_quick(&objp->pos, &Player_obj->pos));
+	dist -= objp->radius;
+
+	if (dist < AI_LOD_NEAR_DIST)
+		return 0;
+
+	if ((dist > AI_LOD_FAR_DIST) && !(objp->flags[Object::Object_Flags::Was_rendered]))
+		return AI_LOD_FAR_INTERVAL;
+
+	return AI_LOD_NEAR_INTERVAL;
+}
+
+//	The part of ai_frame() which has to be done every frame, for a ship which isn't updated in this one.
+//	The controls and the turn of the last update are kept up.
+static void ai_lod_frame(object *objp, ai_info *aip)
+{
+	ai_lod_turn *turn = &aip->lod_turn;
+
+	Pl_objp = objp;
+
+	AI_ci = aip->lod_ci;
+
+	if (turn->valid) {
+		ai_turn_towards_vector(&turn->dest, objp, flFrametime, turn->turn_time, turn->has_slide_vec ? &turn->slide_vec : NULL,
+			turn->has_rel_pos ? &turn->rel_pos : NULL, turn->bank_override, turn->flags, turn->has_rvec ? &turn->rvec : NULL, turn->sexp_flags);
+	}
+
+	aip->target_time += flFrametime;
+
+	process_subobjects(OBJ_INDEX(objp));
+
+	if (objp->phys_info.flags & PF_AFTERBURNER_ON ) {
+		if (Missiontime > aip->afterburner_stop_time) {
+			afterburners_stop(objp);
+		}
+	}
+}
+
 void ai_process( object * obj, int ai_index, float frametime )
 {
 	if (obj->flags[Object::Object_Flags::Should_be_dead])
@@ -14219,11 +14499,44 @@ void ai_process( object * obj, int ai_index, float frametime )
 	AI_frametime = frametime;
 	if (OBJ_INDEX(obj) <= Last_ai_obj) {
 		AI_FrameCount++;
+		Ai_lod_frame_time = 0;
 	}
 
+	ai_info	*aip = &Ai_info[Ships[obj->instance].ai_index];
+
 	memset( &AI_ci, 0, sizeof(AI_ci) );
 
-	ai_frame(OBJ_INDEX(obj));
+	//	Distant ships only decide what to do a few times a second, in between they keep flying the way they did.
+	//	If the full updates of this frame took too long they are put off, but not by more than one interval.
+	int lod_interval = ai_lod_interval(obj, aip);
+
+	if (lod_interval <= 0) {
+		aip->lod_think_timestamp = 1;
+		ai_frame(OBJ_INDEX(obj));
+	} else if ((aip->lod_think_timestamp != 1) && (!timestamp_us_elapsed(aip->lod_think_timestamp)
+		|| ((Ai_lod_frame_time > AI_LOD_FRAME_BUDGET) && (-timestamp_us_until(aip->lod_think_timestamp) < lod_interval * 1000)))) {
+		MONITOR_INC(NumAILodSkips, 1);
+		ai_lod_frame(obj, aip);
+	} else {
+		MONITOR_INC(NumAILodThinks, 1);
+
+		std::uint64_t start_time = timer_get_microseconds();
+
+		aip->lod_turn.valid = false;
+		Ai_lod_turn_objp = obj;
+		ai_frame(OBJ_INDEX(obj));
+		Ai_lod_turn_objp = NULL;
+		aip->lod_ci = AI_ci;
+
+		//	Spread the updates of the ships which just became distant over the interval.
+		//	In microseconds so they don't all land on the same frame when several frames have the same millisecond.
+		if (aip->lod_think_timestamp == 1)
+			aip->lod_think_timestamp = timestamp_us((std::int64_t)lod_interval * 1000 * (1 + OBJ_INDEX(obj) % 16) / 16);
+		else
+			aip->lod_think_timestamp = timestamp_us((std::int64_t)lod_interval * 1000);
+
+		Ai_lod_frame_time += timer_get_microseconds() - start_time;
+	}
 
 	AI_ci.pitch = 0.0f;
 	AI_ci.bank = 0.0f;
@@ -14231,7 +14544,6 @@ void ai_process( object * obj, int ai_index, float frametime )
 
 	// the ships maximum velocity now depends on the energy flowing to engines
 	obj->phys_info.max_vel.xyz.z = Ships[obj->instance].current_max_speed;
-	ai_info	*aip = &Ai_info[Ships[obj->instance].ai_index];
 
 	//	In certain circumstances, the AI says don't fly in the normal way.
 	//	One circumstance is in docking and undocking, when the ship is moving
@@ -14367,6 +14679,10 @@ void init_ai_object(int objnum)
 	aip->danger_weapon_objnum = -1;
 	aip->danger_weapon_signature = -1;
 
+	aip->lod_think_timestamp = 1;
+	aip->lod_turn.valid = false;
+	aip->think_frame = -1;
+
 	aip->lead_scale = 0.0f;
 	aip->last_hit_target_time = Missiontime;
 	aip->last_hit_time = Missiontime;
@@ -15510,10 +15826,10 @@ void cheat_fire_synaptic(object *objp, ship *shipp, ai_info *aip)
     flagset<Weapon::Info_Flags> flags;
     flags += Weapon::Info_Flags::Spawn;
 	ai_select_secondary_weapon(objp, swp, &flags, NULL);
-	if (timestamp_elapsed(swp->next_secondary_fire_stamp[current_bank])) {
+	if (timestamp_us_elapsed(swp->next_secondary_fire_stamp[current_bank])) {
 		if (ship_fire_secondary(objp)) {
 			nprintf(("AI", "ship %s cheat fired synaptic!\n", shipp->ship_name));
-			swp->next_secondary_fire_stamp[current_bank] = timestamp(2500);
+			swp->next_secondary_fire_stamp[current_bank] = timestamp_us(2500000);
 		}
 	}
 }
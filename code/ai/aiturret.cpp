@@ -14,10 +14,12 @@
 #include "network/multi.h"
 #include "network/multimsgs.h"
 #include "object/objectdock.h"
+#include "object/objspatial.h"
 #include "scripting/scripting.h"
 #include "render/3d.h"
 #include "ship/ship.h"
 #include "ship/shipfx.h"
+#include "tracing/Monitor.h"
 #include "weapon/beam.h"
 #include "weapon/flak.h"
 #include "weapon/muzzleflash.h"
@@ -85,8 +87,16 @@ typedef struct eval_enemy_obj_struct {
 
 	float			nearest_dist;						// nearest ship attacking this turret
 	int			nearest_objnum;
+
+	int			parent_check;						// what the parent ship already knows about the object, see turret_candidate_check()
 }	eval_enemy_obj_struct;
 
+// the results of the checks which only depend on the parent ship of a turret
+#define TURRET_CANDIDATE_UNCHECKED		-1		// the checks have to be made for every turret
+#define TURRET_CANDIDATE_REJECTED		0
+#define TURRET_CANDIDATE_TARGETABLE		1
+#define TURRET_CANDIDATE_STEALTH		2		// not targetable, but turrets can find it once in a while
+
 /**
  * Is object in turret field of view?
  *
@@ -388,7 +398,7 @@ weapon_info *get_turret_weapon_wip(ship_weapon *swp, int weapon_num)
 		return &Weapon_info[swp->primary_bank_weapons[weapon_num]];
 }
 
-int get_turret_weapon_next_fire_stamp(ship_weapon *swp, int weapon_num)
+std::int64_t get_turret_weapon_next_fire_stamp(ship_weapon *swp, int weapon_num)
 {
 	Assert(weapon_num < MAX_SHIP_WEAPONS);
 	Assert(weapon_num >= 0);
@@ -512,6 +522,53 @@ int valid_turret_enemy(object *objp, object *turret_parent)
 	return 0;
 }
 
+/**
+ * Can the turrets of a ship see a ship in the nebula?
+ *
+ * @return TURRET_CANDIDATE_TARGETABLE, TURRET_CANDIDATE_STEALTH or TURRET_CANDIDATE_REJECTED
+ */
+static int turret_candidate_visibility(object *objp, object *turret_parent_obj)
+{
+	if ( object_is_targetable(objp, &Ships[turret_parent_obj->instance]) ) {
+		return TURRET_CANDIDATE_TARGETABLE;
+	}
+
+	// BYPASS ocassionally for stealth
+	if ( is_object_stealth_ship(objp) ) {
+		return TURRET_CANDIDATE_STEALTH;
+	}
+
+	return TURRET_CANDIDATE_REJECTED;
+}
+
+/**
+ * The checks of evaluate_obj_as_target() which are the same for all turrets of a ship
+ *
+ * @param objp				The ship considered as a target
+ * @param turret_parent_obj	The ship the turrets sit on
+ * @param enemy_team_mask	OR'ed TEAM_ flags for the enemy of the turret parent ship
+ *
+ * @return TURRET_CANDIDATE_TARGETABLE, TURRET_CANDIDATE_STEALTH or TURRET_CANDIDATE_REJECTED
+ */
+static int turret_candidate_check(object *objp, object *turret_parent_obj, int enemy_team_mask)
+{
+	Assert(objp->type == OBJ_SHIP);
+
+	if ( !valid_turret_enemy(objp, turret_parent_obj) ) {
+		return TURRET_CANDIDATE_REJECTED;
+	}
+
+	if ( !iff_matches_mask(Ships[objp->instance].team, enemy_team_mask) ) {
+		return TURRET_CANDIDATE_REJECTED;
+	}
+
+	if (objp->flags[Object::Object_Flags::Protected]) {
+		return TURRET_CANDIDATE_REJECTED;
+	}
+
+	return turret_candidate_visibility(objp, turret_parent_obj);
+}
+
 extern int Player_attacking_enabled;
 void evaluate_obj_as_target(object *objp, eval_enemy_obj_struct *eeo)
 {
@@ -520,13 +577,14 @@ void evaluate_obj_as_target(object *objp, eval_enemy_obj_struct *eeo)
 	ship_subsys *ss = eeo->turret_subsys;
 	float dist, dist_comp;
 	bool turret_has_no_target = false;
+	bool checked = (eeo->parent_check != TURRET_CANDIDATE_UNCHECKED);
 
 	// Don't look for bombs when weapon system is not ok
 	if (objp->type == OBJ_WEAPON && !eeo->weapon_system_ok) {
 		return;
 	}
 
-	if ( !valid_turret_enemy(objp, turret_parent_obj) ) {
+	if ( !checked && !valid_turret_enemy(objp, turret_parent_obj) ) {
 		return;
 	}
 
@@ -540,12 +598,12 @@ void evaluate_obj_as_target(object *objp, eval_enemy_obj_struct *eeo)
 		shipp = &Ships[objp->instance];
 
 		// check on enemy team
-		if ( !iff_matches_mask(shipp->team, eeo->enemy_team_mask) ) {
+		if ( !checked && !iff_matches_mask(shipp->team, eeo->enemy_team_mask) ) {
 			return;
 		}
 
 		// check if protected
-		if (objp->flags[Object::Object_Flags::Protected]) {
+		if ( !checked && (objp->flags[Object::Object_Flags::Protected]) ) {
 			return;
 		}
 
@@ -605,10 +663,11 @@ void evaluate_obj_as_target(object *objp, eval_enemy_obj_struct *eeo)
 		}
 
 		// check if valid target in nebula
-		if ( !object_is_targetable(objp, &Ships[Objects[eeo->turret_parent_objnum].instance]) ) {
+		int visibility = checked ? eeo->parent_check : turret_candidate_visibility(objp, turret_parent_obj);
+		if ( visibility != TURRET_CANDIDATE_TARGETABLE ) {
 			// BYPASS ocassionally for stealth
 			int try_anyway = FALSE;
-			if ( is_object_stealth_ship(objp) ) {
+			if ( visibility == TURRET_CANDIDATE_STEALTH ) {
 				float turret_stealth_find_chance = 0.5f;
 				float speed_mod = -0.1f + vm_vec_mag_quick(&objp->phys_info.vel) / 70.0f;
 				if (frand() > (turret_stealth_find_chance + speed_mod)) {
@@ -815,6 +874,82 @@ int is_target_beam_valid(ship_weapon *swp, object *objp)
  * @param laser_flag
  * @param missile_flag
  */
+typedef struct turret_candidate {
+	int	objnum;
+	int	check;			// TURRET_CANDIDATE_TARGETABLE or TURRET_CANDIDATE_STEALTH
+} turret_candidate;
+
+// the enemy ships near a ship which its turrets may attack, collected once a frame for all of its turrets
+typedef struct turret_candidate_list {
+	int	frame = -1;
+	int	parent_signature = -1;
+	int	enemy_team_mask = 0;
+	float	range = 0.0f;		// the longest range of the turrets the ships were collected for
+	SCP_vector<turret_candidate> candidates;
+} turret_candidate_list;
+
+static SCP_vector<turret_candidate_list> Turret_candidate_lists;	// indexed by ship
+static SCP_vector<int> Turret_candidate_ships;
+
+MONITOR(NumTurretCandidateLists)
+
+/**
+ * Gets the enemy ships which may be attacked by a turret of a ship in this frame
+ *
+ * The ships are collected the first time a turret of the ship looks for a target in a frame. The list holds every
+ * ship which passes the checks that are the same for all turrets of the ship, in the order of Ship_obj_list.
+ *
+ * @param turret_parent_objnum	Parent objnum for the turret
+ * @param enemy_team_mask		OR'ed TEAM_ flags for the enemy of the turret parent ship
+ * @param range					The targeting range of the turret asking
+ */
+static const SCP_vector<turret_candidate> &get_turret_candidates(int turret_parent_objnum, int enemy_team_mask, float range)
+{
+	object *turret_parent_obj = &Objects[turret_parent_objnum];
+	ship *shipp = &Ships[turret_parent_obj->instance];
+
+	if (Turret_candidate_lists.size() <= (size_t)turret_parent_obj->instance) {
+		Turret_candidate_lists.resize(MAX_SHIPS);
+	}
+
+	turret_candidate_list *list = &Turret_candidate_lists[turret_parent_obj->instance];
+
+	if ((list->frame == Framecount) && (list->parent_signature == turret_parent_obj->signature) && (list->enemy_team_mask == enemy_team_mask) && (range <= list->range)) {
+		return list->candidates;
+	}
+
+	MONITOR_INC(NumTurretCandidateLists, 1);
+
+	list->frame = Framecount;
+	list->parent_signature = turret_parent_obj->signature;
+	list->enemy_team_mask = enemy_team_mask;
+	list->range = range;
+	list->candidates.clear();
+
+	for ( ship_subsys *ss = shipp->subsys_array; ss < shipp->subsys_array + shipp->num_subsys; ss++ ) {
+		if (ss->system_info->type == SUBSYSTEM_TURRET) {
+			list->range = MAX(list->range, longest_turret_weapon_range(&ss->weapons));
+		}
+	}
+
+	// only the enemy ships within the range of the turret weapons can become the nearest attacker, with some room for
+	// vm_vec_dist_quick() being off, and the turrets may sit anywhere on the ship
+	obj_spatial_find_ships(&turret_parent_obj->pos, list->range * 1.2f + turret_parent_obj->radius, enemy_team_mask, Turret_candidate_ships);
+
+	for (int objnum : Turret_candidate_ships) {
+		int check = turret_candidate_check(&Objects[objnum], turret_parent_obj, enemy_team_mask);
+
+		if (check != TURRET_CANDIDATE_REJECTED) {
+			turret_candidate candidate;
+			candidate.objnum = objnum;
+			candidate.check = check;
+			list->candidates.push_back(candidate);
+		}
+	}
+
+	return list->candidates;
+}
+
 int get_nearest_turret_objnum(int turret_parent_objnum, ship_subsys *turret_subsys, int enemy_team_mask, vec3d *tpos, vec3d *tvec, int current_enemy, bool big_only_flag, bool small_only_flag, bool tagged_only_flag, bool beam_flag, bool flak_flag, bool laser_flag, bool missile_flag)
 {
 	//float					weapon_travel_dist;
@@ -824,7 +959,6 @@ int get_nearest_turret_objnum(int turret_parent_objnum, ship_subsys *turret_subs
 	ship_weapon *swp = &turret_subsys->weapons;
 
 	// list of stuff to go thru
-	ship_obj		*so;
 	missile_obj *mo;
 
 	//wip=&Weapon_info[tp->turret_weapon_type];
@@ -881,6 +1015,8 @@ int get_nearest_turret_objnum(int turret_parent_objnum, ship_subsys *turret_subs
 	eeo.nearest_dist = 99999.0f;
 	eeo.nearest_objnum = -1;
 
+	eeo.parent_check = TURRET_CANDIDATE_UNCHECKED;
+
 	// here goes the new targeting priority setting
 	int n_tgt_priorities;
 	int priority_weapon_idx = -1;
@@ -1067,11 +1203,13 @@ int get_nearest_turret_objnum(int turret_parent_objnum, ship_subsys *turret_subs
 
 				case 1:
 					//Return if a ship is found
-					// Ship_used_list
-					for ( so = GET_FIRST(&Ship_obj_list); so != END_OF_LIST(&Ship_obj_list); so = GET_NEXT(so) ) {
-						objp = &Objects[so->objnum];
+					// the checks which are the same for all turrets of the ship were already made for the candidates
+					for (auto &candidate : get_turret_candidates(turret_parent_objnum, enemy_team_mask, eeo.weapon_travel_dist)) {
+						objp = &Objects[candidate.objnum];
+						eeo.parent_check = candidate.check;
 						evaluate_obj_as_target(objp, &eeo);
 					}
+					eeo.parent_check = TURRET_CANDIDATE_UNCHECKED;
 
 					Assert(eeo.nearest_attacker_objnum < 0 || is_target_beam_valid(swp, &Objects[eeo.nearest_attacker_objnum]));
 						// next highest priority is attacking ship
@@ -1572,7 +1710,7 @@ ship_subsys *aifft_find_turret_subsys(object *objp, ship_subsys *ssp, object *en
 	// first build up a list subsystems to traverse
 	ship_subsys	*pss;
 	aifft_list_size = 0;
-	for ( pss = GET_FIRST(&eshipp->subsys_list); pss !=END_OF_LIST(&eshipp->subsys_list); pss = GET_NEXT(pss) ) {
+	for ( pss = eshipp->subsys_array; pss < eshipp->subsys_array + eshipp->num_subsys; pss++ ) {
 		model_subsystem *psub = pss->system_info;
 
 		// if we've reached max turrets bail
@@ -1684,7 +1822,7 @@ void turret_set_next_fire_timestamp(int weapon_num, weapon_info *wip, ship_subsy
 		}
 	}
 
-	int *fs_dest;
+	std::int64_t *fs_dest;
 	if(weapon_num < MAX_SHIP_PRIMARY_BANKS)
 		fs_dest = &turret->weapons.next_primary_fire_stamp[weapon_num];
 	else
@@ -1740,7 +1878,7 @@ void turret_set_next_fire_timestamp(int weapon_num, weapon_info *wip, ship_subsy
 	if(turret->rof_scaler != 1.0f)
 		wait /= get_adjusted_turret_rof(turret);
 
-	(*fs_dest) = timestamp((int)wait);
+	(*fs_dest) = timestamp_us((std::int64_t)(wait * 1000.0f));
 }
 
 /**
@@ -1799,7 +1937,7 @@ bool turret_fire_weapon(int weapon_num, ship_subsys *turret, int parent_objnum,
 	}
 
 	//WMC - Limit firing to firestamp
-	if((!timestamp_elapsed(get_turret_weapon_next_fire_stamp(&turret->weapons, weapon_num))) && last_shot_in_salvo)
+	if((!timestamp_us_elapsed(get_turret_weapon_next_fire_stamp(&turret->weapons, weapon_num))) && last_shot_in_salvo)
 		return false;
 
 	parent_aip = &Ai_info[Ships[Objects[parent_objnum].instance].ai_index];
@@ -2157,11 +2295,63 @@ int Num_ai_firing = 0;
 int Num_find_turret_enemy = 0;
 int Num_turrets_fired = 0;
 
+#define TURRET_NEARBY_FIGHTER_DIST	1500.0f
+
+// what the turrets of the ship in ai_fire_from_turrets() share
+typedef struct turret_batch {
+	int	parent_objnum = -1;
+	SCP_vector<vec3d> gpos;			// the turret positions, see ship_get_global_turret_info()
+	SCP_vector<vec3d> gvec;			// the centers of the fields of view of the turrets
+	bool	fighters_found = false;
+	SCP_vector<vec3d> fighter_pos;	// the enemy fighters and bombers which may be near any of the turrets
+} turret_batch;
+
+static turret_batch Turret_batch;
+static SCP_vector<int> Turret_batch_ships;
+
+/**
+ * Counts the enemy fighters and bombers near a turret of the ship in ai_fire_from_turrets(), like num_nearby_fighters()
+ *
+ * The fighters around the ship are found the first time one of its turrets asks, the turrets then only test the
+ * distance to each of them.
+ */
+static int turret_batch_num_nearby_fighters(const vec3d *gpos)
+{
+	if (!Turret_batch.fighters_found) {
+		object *parent_objp = &Objects[Turret_batch.parent_objnum];
+
+		Turret_batch.fighters_found = true;
+		Turret_batch.fighter_pos.clear();
+
+		// leave room for vm_vec_dist_quick() being off, and the turrets may sit anywhere on the ship
+		obj_spatial_find_ships(&parent_objp->pos, TURRET_NEARBY_FIGHTER_DIST * 1.2f + parent_objp->radius, iff_get_attackee_mask(obj_team(parent_objp)), Turret_batch_ships);
+
+		for (int objnum : Turret_batch_ships) {
+			if (Ship_info[Ships[Objects[objnum].instance].ship_info_index].is_fighter_bomber()) {
+				Turret_batch.fighter_pos.push_back(Objects[objnum].pos);
+			}
+		}
+	}
+
+	int count = 0;
+
+	for (auto &pos : Turret_batch.fighter_pos) {
+		if (vm_vec_dist_quick(gpos, &pos) < TURRET_NEARBY_FIGHTER_DIST) {
+			count++;
+		}
+	}
+
+	return count;
+}
+
 /**
  * Given a turret tp and its parent parent_objnum, fire from the turret at its enemy.
+ *
+ * @param turret_gpos	The position of the turret, see ship_get_global_turret_info()
+ * @param turret_gvec	The center of the field of view of the turret
  */
 extern int Nebula_sec_range;
-void ai_fire_from_turret(ship *shipp, ship_subsys *ss, int parent_objnum)
+static void ai_fire_from_turret(ship *shipp, ship_subsys *ss, int parent_objnum, const vec3d *turret_gpos, const vec3d *turret_gvec)
 {
 	float		weapon_firing_range;
 
@@ -2264,8 +2454,7 @@ void ai_fire_from_turret(ship *shipp, ship_subsys *ss, int parent_objnum)
 	}
 
 	// Use the turret info for all guns, not one gun in particular.
-	vec3d	 gvec, gpos;
-	ship_get_global_turret_info(&Objects[parent_objnum], tp, &gpos, &gvec);
+	vec3d	 gvec = *turret_gvec, gpos = *turret_gpos;
 
 	if (tp->flags[Model::Subsystem_Flags::Turret_alt_math]) {
 		vm_matrix_x_matrix( &ss->world_to_turret_matrix, &Objects[parent_objnum].orient, &tp->turret_matrix );
@@ -2302,7 +2491,7 @@ void ai_fire_from_turret(ship *shipp, ship_subsys *ss, int parent_objnum)
 	int num_valid = 0;
 
 	weapon_info *wip;
-	int num_ships_nearby = num_nearby_fighters(iff_get_attackee_mask(obj_team(&Objects[parent_objnum])), &gpos, 1500.0f);
+	int num_ships_nearby = turret_batch_num_nearby_fighters(&gpos);
 	int i;
 	int secnum = 0;
 	for(i = 0; i < (MAX_SHIP_WEAPONS); i++)
@@ -2320,7 +2509,7 @@ void ai_fire_from_turret(ship *shipp, ship_subsys *ss, int parent_objnum)
 				i = MAX_SHIP_PRIMARY_BANKS - 1;	//we are done with primaries
 				continue;
 			}
-			if ( !timestamp_elapsed(swp->next_primary_fire_stamp[i]))
+			if ( !timestamp_us_elapsed(swp->next_primary_fire_stamp[i]))
 			{
 					continue;
 			}
@@ -2331,7 +2520,7 @@ void ai_fire_from_turret(ship *shipp, ship_subsys *ss, int parent_objnum)
 			secnum = i - MAX_SHIP_PRIMARY_BANKS;
 			if(secnum >= swp->num_secondary_banks)
 				break;	//we are done.
-			if ( !timestamp_elapsed(swp->next_secondary_fire_stamp[secnum]))
+			if ( !timestamp_us_elapsed(swp->next_secondary_fire_stamp[secnum]))
 			{
 				continue;
 			}
@@ -2751,9 +2940,9 @@ void ai_fire_from_turret(ship *shipp, ship_subsys *ss, int parent_objnum)
 					//timestamp range is 2 to INT_MAX/2
 					if (swp->next_primary_fire_stamp[i] < 2) continue;
 					
-					if (swp->next_primary_fire_stamp[i] < ss->turret_next_fire_stamp)
+					if (timestamp_us_to_ms(swp->next_primary_fire_stamp[i]) < ss->turret_next_fire_stamp)
 					{
-						ss->turret_next_fire_stamp = swp->next_primary_fire_stamp[i];
+						ss->turret_next_fire_stamp = timestamp_us_to_ms(swp->next_primary_fire_stamp[i]);
 					}
 				}
 				else
@@ -2761,9 +2950,9 @@ void ai_fire_from_turret(ship *shipp, ship_subsys *ss, int parent_objnum)
 					//timestamp range is 2 to INT_MAX/2
 					if (swp->next_secondary_fire_stamp[i - MAX_SHIP_PRIMARY_BANKS] < 2) continue;
 
-					if (swp->next_secondary_fire_stamp[i - MAX_SHIP_PRIMARY_BANKS] < ss->turret_next_fire_stamp)
+					if (timestamp_us_to_ms(swp->next_secondary_fire_stamp[i - MAX_SHIP_PRIMARY_BANKS]) < ss->turret_next_fire_stamp)
 					{
-						ss->turret_next_fire_stamp = swp->next_secondary_fire_stamp[i - MAX_SHIP_PRIMARY_BANKS];
+						ss->turret_next_fire_stamp = timestamp_us_to_ms(swp->next_secondary_fire_stamp[i - MAX_SHIP_PRIMARY_BANKS]);
 					}
 
 				}
@@ -2783,6 +2972,31 @@ void ai_fire_from_turret(ship *shipp, ship_subsys *ss, int parent_objnum)
 	}
 }
 
+void ai_fire_from_turrets(ship *shipp, int parent_objnum, const SCP_vector<ship_subsys*> &turrets)
+{
+	object *objp = &Objects[parent_objnum];
+
+	Turret_batch.parent_objnum = parent_objnum;
+	Turret_batch.fighters_found = false;
+	Turret_batch.gpos.resize(turrets.size());
+	Turret_batch.gvec.resize(turrets.size());
+
+	// the turrets are fixed to the ship, only their guns move
+	for (size_t i = 0; i < turrets.size(); i++) {
+		model_subsystem *tp = turrets[i]->system_info;
+
+		vm_vec_unrotate(&Turret_batch.gpos[i], &tp->pnt, &objp->orient);
+		vm_vec_add2(&Turret_batch.gpos[i], &objp->pos);
+		vm_vec_unrotate(&Turret_batch.gvec[i], &tp->turret_norm, &objp->orient);
+	}
+
+	for (size_t i = 0; i < turrets.size(); i++) {
+		ai_fire_from_turret(shipp, turrets[i], parent_objnum, &Turret_batch.gpos[i], &Turret_batch.gvec[i]);
+	}
+
+	Turret_batch.parent_objnum = -1;
+}
+
 bool turret_std_fov_test(ship_subsys *ss, vec3d *gvec, vec3d *v2e, float size_mod)
 {
 	model_subsystem *tp = ss->system_info;
@@ -2069,13 +2069,12 @@ int count_incident_asteroids()
 
 	count = 0;
 
-	for ( asteroid_objp = GET_FIRST(&obj_used_list); asteroid_objp !=END_OF_LIST(&obj_used_list); asteroid_objp = GET_NEXT(asteroid_objp) ) {
-		if (asteroid_objp->type == OBJ_ASTEROID ) {
-			asteroid *asp = &Asteroids[asteroid_objp->instance];
+	for (int objnum : obj_get_type_list(OBJ_ASTEROID)) {
+		asteroid_objp = &Objects[objnum];
+		asteroid *asp = &Asteroids[asteroid_objp->instance];
 
-			if ( asp->target_objnum >= 0 ) {
-				count++;
-			}
+		if ( asp->target_objnum >= 0 ) {
+			count++;
 		}
 	}
 
@@ -2154,11 +2153,8 @@ void asteroid_show_brackets()
 		player_target = NULL;
 	}
 
-	for ( asteroid_objp = GET_FIRST(&obj_used_list); asteroid_objp !=END_OF_LIST(&obj_used_list); asteroid_objp = GET_NEXT(asteroid_objp) ) {
-		if (asteroid_objp->type != OBJ_ASTEROID ) {
-			continue;
-		}
-
+	for (int objnum : obj_get_type_list(OBJ_ASTEROID)) {
+		asteroid_objp = &Objects[objnum];
 		asp = &Asteroids[asteroid_objp->instance];
 
 		if ( asp->collide_objnum < 0 ) {
@@ -2189,11 +2185,8 @@ void asteroid_target_closest_danger()
 	asteroid	*asp;
 	float		dist, closest_dist = 999999.0f;
 
-	for ( asteroid_objp = GET_FIRST(&obj_used_list); asteroid_objp !=END_OF_LIST(&obj_used_list); asteroid_objp = GET_NEXT(asteroid_objp) ) {
-		if (asteroid_objp->type != OBJ_ASTEROID ) {
-			continue;
-		}
-
+	for (int objnum : obj_get_type_list(OBJ_ASTEROID)) {
+		asteroid_objp = &Objects[objnum];
 		asp = &Asteroids[asteroid_objp->instance];
 
 		if ( asp->collide_objnum < 0 ) {
@@ -0,0 +1,226 @@
+#include "bmpman/atlas.h"
+
+#include "bmpman/bmpman.h"
+#include "graphics/2d.h"
+
+#include <algorithm>
+
+namespace {
+
+const int ATLAS_PAGE_SIZE = 1024;
+
+// larger bitmaps would fill a page with few of them, they keep their own textures
+const int ATLAS_MAX_BITMAP_SIZE = 256;
+
+const int ATLAS_MAX_PAGES = 8;
+
+// the repeated pixels around every bitmap
+const int ATLAS_BORDER = 1;
+
+struct atlas_page {
+	int handle = -1;
+	SCP_vector<ubyte> data;
+
+	// the row which is filled at the moment, bitmaps are placed from left to right in it
+	int row_y = 0;
+	int row_h = 0;
+	int row_x = 0;
+
+	// how far down the page is used
+	int used_h = 0;
+};
+
+struct atlas_entry {
+	int page;
+	int x, y;
+	bool copied;
+};
+
+SCP_vector<atlas_page> Atlas_pages;
+SCP_unordered_map<int, atlas_entry> Atlas_entries;
+
+bool atlas_place(int w, int h, atlas_entry* entry)
+{
+	int place_w = w + 2 * ATLAS_BORDER;
+	int place_h = h + 2 * ATLAS_BORDER;
+
+	if (Atlas_pages.empty()) {
+		Atlas_pages.emplace_back();
+	}
+
+	auto page = &Atlas_pages.back();
+
+	// start a new row below the last one, or a new page
+	if (page->row_x + place_w > ATLAS_PAGE_SIZE) {
+		page->row_y += page->row_h;
+		page->row_x = 0;
+		page->row_h = 0;
+	}
+
+	if (page->row_y + place_h > ATLAS_PAGE_SIZE) {
+		if ((int)Atlas_pages.size() >= ATLAS_MAX_PAGES) {
+			return false;
+		}
+
+		Atlas_pages.emplace_back();
+		page = &Atlas_pages.back();
+	}
+
+	entry->page = (int)Atlas_pages.size() - 1;
+	entry->x = page->row_x + ATLAS_BORDER;
+	entry->y = page->row_y + ATLAS_BORDER;
+	entry->copied = false;
+
+	page->row_x += place_w;
+	page->row_h = std::max(page->row_h, place_h);
+	page->used_h = std::max(page->used_h, page->row_y + page->row_h);
+
+	return true;
+}
+
+}
+
+void bm_atlas_reset()
+{
+	for (auto& page : Atlas_pages) {
+		if (page.handle >= 0) {
+			bm_release(page.handle);
+		}
+	}
+
+	Atlas_pages.clear();
+	Atlas_entries.clear();
+}
+
+void bm_atlas_place(const SCP_vector<int>& handles)
+{
+	bm_atlas_reset();
+
+	SCP_vector<std::pair<int, int>> bitmaps;
+
+	for (auto handle : handles) {
+		int w, h;
+		bm_get_info(handle, &w, &h);
+
+		if ((w > 0) && (h > 0) && (w <= ATLAS_MAX_BITMAP_SIZE) && (h <= ATLAS_MAX_BITMAP_SIZE)) {
+			bitmaps.emplace_back(h, handle);
+		}
+	}
+
+	// the tallest first so the rows waste little space below the smaller bitmaps
+	std::stable_sort(bitmaps.begin(), bitmaps.end(),
+		[](const std::pair<int, int>& a, const std::pair<int, int>& b) { return a.first > b.first; });
+
+	for (auto& bitmap : bitmaps) {
+		int w, h;
+		bm_get_info(bitmap.second, &w, &h);
+
+		atlas_entry entry;
+		if (!atlas_place(w, h, &entry)) {
+			break;
+		}
+
+		Atlas_entries[bitmap.second] = entry;
+	}
+
+	// the pages only have to be as tall as their content
+	for (auto& page : Atlas_pages) {
+		int page_h = 1;
+		while (page_h < page.used_h) {
+			page_h <<= 1;
+		}
+
+		page.used_h = page_h;
+		page.data.assign((size_t)ATLAS_PAGE_SIZE * page_h, 0);
+	}
+
+	if (!Atlas_entries.empty()) {
+		mprintf(("BMPMAN: %d small bitmaps are placed in %d atlas pages.\n", (int)Atlas_entries.size(), (int)Atlas_pages.size()));
+	}
+}
+
+bool bm_atlas_copy(int handle)
+{
+	auto iter = Atlas_entries.find(handle);
+	if (iter == Atlas_entries.end()) {
+		return false;
+	}
+
+	auto& entry = iter->second;
+
+	auto bmp = bm_lock(handle, 8, BMP_AABITMAP);
+
+	// only the 8 bit shades of the usual anti-aliased bitmaps can go into a page
+	if ((bmp == nullptr) || (bmp->bpp != 8) || (bmp->data == 0)) {
+		if (bmp != nullptr) {
+			bm_unlock(handle);
+		}
+
+		Atlas_entries.erase(iter);
+		return false;
+	}
+
+	auto& page = Atlas_pages[entry.page];
+	auto src = reinterpret_cast<const ubyte*>(bmp->data);
+	int w = bmp->w;
+	int h = bmp->h;
+
+	for (int y = -ATLAS_BORDER; y < h + ATLAS_BORDER; ++y) {
+		auto src_row = src + std::min(std::max(y, 0), h - 1) * w;
+		auto dest_row = &page.data[(size_t)(entry.y + y) * ATLAS_PAGE_SIZE + entry.x];
+
+		memcpy(dest_row, src_row, w);
+
+		for (int x = 1; x <= ATLAS_BORDER; ++x) {
+			dest_row[-x] = src_row[0];
+			dest_row[w - 1 + x] = src_row[w - 1];
+		}
+	}
+
+	bm_unlock(handle);
+
+	entry.copied = true;
+	return true;
+}
+
+void bm_atlas_finish()
+{
+	for (auto& page : Atlas_pages) {
+		if (page.data.empty()) {
+			continue;
+		}
+
+		page.handle = bm_create(8, ATLAS_PAGE_SIZE, page.used_h, page.data.data(), BMP_AABITMAP);
+
+		if (page.handle >= 0) {
+			gr_preload(page.handle, 1);
+		}
+	}
+
+	// the bitmaps of a page which couldn't be created are drawn from their own textures
+	for (auto iter = Atlas_entries.begin(); iter != Atlas_entries.end();) {
+		if (!iter->second.copied || (Atlas_pages[iter->second.page].handle < 0)) {
+			iter = Atlas_entries.erase(iter);
+		} else {
+			++iter;
+		}
+	}
+}
+
+bool bm_get_atlas(int handle, int* page, int* x, int* y)
+{
+	if (Atlas_entries.empty()) {
+		return false;
+	}
+
+	auto iter = Atlas_entries.find(handle);
+	if (iter == Atlas_entries.end()) {
+		return false;
+	}
+
+	*page = Atlas_pages[iter->second.page].handle;
+	*x = iter->second.x;
+	*y = iter->second.y;
+
+	return *page >= 0;
+}
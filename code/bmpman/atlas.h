@@ -0,0 +1,53 @@
+#ifndef _BMPMAN_ATLAS_H
+#define _BMPMAN_ATLAS_H
+#pragma once
+
+#include "globalincs/pstypes.h"
+
+/** @file
+ *  Atlas pages for the small anti-aliased bitmaps of a level.
+ *
+ *  The HUD draws dozens of small gauge frames every frame and each of them used to be a texture of its own. The
+ *  frames which are paged in with bm_page_in_aabitmap() and are small enough are copied into a few shared pages when
+ *  the level is loaded instead of getting a texture each. The renderer draws them from the part of the page they are
+ *  in, so consecutive frames from the same page don't have to bind another texture and can be drawn in one call.
+ *
+ *  Every frame gets a border which repeats its outermost pixels so filtering doesn't pick up its neighbours.
+ */
+
+/**
+ * @brief Releases the pages of the last level, called by bm_page_in_start()
+ */
+void bm_atlas_reset();
+
+/**
+ * @brief Finds places in the pages for the bitmaps which are small enough, called by bm_page_in_stop()
+ *
+ * @param handles The paged in anti-aliased bitmaps, each frame of an animation on its own
+ */
+void bm_atlas_place(const SCP_vector<int>& handles);
+
+/**
+ * @brief Copies a bitmap to its place in its page
+ *
+ * @return @c true if the bitmap is drawn from its page now and doesn't need a texture of its own
+ */
+bool bm_atlas_copy(int handle);
+
+/**
+ * @brief Creates the bitmaps of the pages once everything is copied, called by bm_page_in_stop()
+ */
+void bm_atlas_finish();
+
+/**
+ * @brief Gets the part of an atlas page a bitmap is drawn from
+ *
+ * @param handle The bitmap
+ * @param[out] page The bitmap of the page, 8 bit with BMP_AABITMAP like the bitmaps in it
+ * @param[out] x The left edge of the bitmap in the page
+ * @param[out] y The top edge of the bitmap in the page
+ * @return @c false if the bitmap isn't in a page
+ */
+bool bm_get_atlas(int handle, int* page, int* x, int* y);
+
+#endif // _BMPMAN_ATLAS_H
@@ -23,6 +23,10 @@
 
 #include "bmpman/bmpman.h"
 
+#include <map>
+#include <memory>
+#include <set>
+
 union bm_extra_info {
 	struct {
 		// Stuff needed for animations
@@ -57,7 +61,7 @@ struct bitmap_entry {
 
 	uint signature;         //!< a unique signature identifying the data
 	uint palette_checksum;  //!< checksum used to be sure bitmap is in current palette
-	int  handle;            //!< Handle = id*MAX_BITMAPS + bitmapnum
+	int  handle;            //!< Handle = generation*MAX_BITMAPS + bitmapnum
 	int  last_used;         //!< When this bitmap was last used
 
 	BM_TYPE type;             //!< PCX, USER, ANI, etc
@@ -66,9 +70,14 @@ struct bitmap_entry {
 
 	int dir_type;           //!< which directory this was loaded from (to skip other locations with same name)
 
+	// compressed copies of uncompressed images, see bmpman/texturecache.h
+	char texture_cache_filename[MAX_FILENAME_LEN]; //!< the copy in the cache directory, empty if the image has none
+	uint source_checksum;   //!< checksum of the image the copy is made from
+
 	// compressed bitmap stuff (.dds) - RT please take a look at this and tell me if we really need it
 	size_t mem_taken;          //!< How much memory does this bitmap use? - UnknownPlayer
 	int num_mipmaps;        //!< number of mipmap levels, we need to read all of them
+	int dds_skipped_levels; //!< top mipmap levels of a DDS image which weren't read into the data, see bm_lock_dds()
 
 	// Stuff to keep track of usage
 	ubyte preloaded;        //!< If set, then this was loaded from the lst file
@@ -89,7 +98,84 @@ struct bitmap_entry {
 #endif
 };
 
-extern bitmap_entry bm_bitmaps[MAX_BITMAPS];
+/**
+ * @brief The storage of the bitmap slots
+ *
+ * Slots are added in chunks once they are needed so only the slots a mod actually uses take up memory. A chunk never
+ * moves after it has been allocated so references to entries stay valid while the table grows.
+ *
+ * The free slots are kept as runs of consecutive slots since the frames of an animation have to be next to each other.
+ * A request is served by the smallest run which is big enough so the big runs stay available for long animations.
+ */
+class bitmap_slot_table {
+ public:
+	static const int CHUNK_SIZE = 512;
+
+	bitmap_entry& operator[](int n)
+	{
+		Assertion((n >= 0) && (n < _size), "Bitmap slot %d is out of range!", n);
+		return _chunks[n / CHUNK_SIZE]->entries[n % CHUNK_SIZE];
+	}
+
+	/**
+	 * @brief The number of slots which currently exist
+	 */
+	int size() const { return _size; }
+
+	/**
+	 * @brief Adds chunks until there are at least num_slots slots
+	 *
+	 * The new slots are free and zeroed, they still have to be initialized by bmpman.
+	 *
+	 * @return @c false if that would exceed MAX_BITMAPS
+	 */
+	bool grow(int num_slots);
+
+	/**
+	 * @brief Finds a run of free slots without claiming it
+	 *
+	 * @return The first slot of the run or -1 if no run is big enough
+	 */
+	int find_free(int count) const;
+
+	/**
+	 * @brief Takes slots out of the free runs once they are in use
+	 */
+	void claim(int first, int count);
+
+	/**
+	 * @brief Returns slots to the free runs, merging them with the adjacent runs
+	 */
+	void release(int first, int count);
+
+	/**
+	 * @brief Gets the next handle for a run of slots
+	 *
+	 * Every slot counts its own handle generations so handles only repeat after a single slot has been reused many
+	 * times. The slots of an animation share one generation, the handle of a frame is the returned handle plus the
+	 * offset of the frame.
+	 *
+	 * @return The handle of the first slot
+	 */
+	int next_handle(int first, int count);
+
+ private:
+	struct chunk {
+		bitmap_entry entries[CHUNK_SIZE];
+		int generations[CHUNK_SIZE];
+	};
+
+	std::unique_ptr<chunk> _chunks[MAX_BITMAPS / CHUNK_SIZE];
+	int _size = 0;
+
+	std::map<int, int> _free_runs;                  //!< first slot -> number of slots
+	std::set<std::pair<int, int>> _runs_by_length;  //!< (number of slots, first slot)
+
+	void add_run(int first, int count);
+	void remove_run(std::map<int, int>::iterator run);
+};
+
+extern bitmap_slot_table bm_bitmaps;
 
 // image specific lock functions
 void bm_lock_ani( int handle, int bitmapnum, bitmap_entry *be, bitmap *bmp, int bpp, ubyte flags );
@@ -101,5 +187,12 @@ void bm_lock_pcx( int handle, int bitmapnum, bitmap_entry *be, bitmap *bmp, int
 void bm_lock_tga( int handle, int bitmapnum, bitmap_entry *be, bitmap *bmp, int bpp, ubyte flags );
 void bm_lock_user( int handle, int bitmapnum, bitmap_entry *be, bitmap *bmp, int bpp, ubyte flags );
 
+/**
+ * Locks a frame of a big ANI or APNG animation without decoding all of its frames
+ *
+ * @returns false if the animation is small enough to be locked by bm_lock_ani() or bm_lock_apng()
+ */
+bool bm_lock_anim_stream( int handle, int bitmapnum, bitmap_entry *be, bitmap *bmp, int bpp, ubyte flags );
+
 
 #endif // __BM_INTERNAL_H__
@@ -18,10 +18,14 @@
 
 #include "anim/animplay.h"
 #include "anim/packunpack.h"
+#include "bmpman/atlas.h"
 #include "bmpman/bm_internal.h"
 #include "bmpman/bmpman.h"
+#include "bmpman/texturecache.h"
+#include "cmdline/cmdline.h"
 #include "ddsutils/ddsutils.h"
 #include "debugconsole/console.h"
+#include "globalincs/jobs.h"
 #include "globalincs/systemvars.h"
 #include "graphics/2d.h"
 #include "graphics/grinternal.h"
@@ -89,13 +93,12 @@ extern int Cmdline_cache_bitmaps;
 
 // --------------------------------------------------------------------------------------------------------------------
 // Definition of public variables (declared as extern in bm_internal.h).
-bitmap_entry bm_bitmaps[MAX_BITMAPS];
+bitmap_slot_table bm_bitmaps;
 
 // --------------------------------------------------------------------------------------------------------------------
 // Definition of private variables at file scope (static).
 static int bm_inited = 0;
 static uint Bm_next_signature = 0x1234;
-static int  bm_next_handle = 1;
 static int Bm_low_mem = 0;
 
 /**
@@ -210,6 +213,22 @@ static void bm_convert_format(bitmap *bmp, ubyte flags);
  */
 static void bm_free_data(int n, bool release = false);
 
+/**
+ * Waits for all queued streaming loads and drops them
+ */
+static void bm_stream_flush();
+static bool bm_ram_budget_reached();
+
+/**
+ * Queues the decoding of the frames of a streamed animation which follow the given frame, see bm_lock_anim_stream()
+ */
+static void bm_anim_stream_read_ahead(int first_frame, int frame);
+
+/**
+ * Drops the decoder of a streamed animation
+ */
+static void bm_anim_stream_free(int first_frame);
+
 /**
  * A special version of bm_free_data() that can be safely used in gr_*_texture
  * to save system memory once textures have been transfered to API memory
@@ -237,13 +256,38 @@ static int bm_load_sub_slow(const char *real_filename, const int num_ext, const
 static int bm_load_sub_fast(const char *real_filename, int *handle, int dir_type = CF_TYPE_ANY, bool animated_type = false);
 
 /**
- * Finds a block of... something
+ * Finds a run of n free bitmap slots, adding slots to the table if there is no run which is big enough
+ *
+ * @note The slots are only taken out of the free runs by bitmap_slot_table::claim()
  *
- * @returns -1 if the block could not be found
- * @returns the handle of the block ?
+ * @returns -1 if the slots could not be found
+ * @returns the first slot of the run
  */
 static int find_block_of(int n);
 
+/**
+ * Puts a bitmap slot into its initial, free state
+ */
+static void bm_init_slot(int n);
+
+/**
+ * Gets the file the DDS data of a bitmap is read from, the compressed copy if it was loaded from the texture cache
+ *
+ * @param filename Comes in as the name of the bitmap and is replaced by the name of the copy
+ * @returns the directory type to read the file from
+ */
+static int bm_get_dds_source(const bitmap_entry *be, char (&filename)[MAX_FILENAME_LEN]);
+
+/**
+ * Gets the number of top mipmap levels of a DDS image which don't have to be read with the current texture detail
+ *
+ * This matches the base level opengl_create_texture() uploads from, which only leaves out levels of model and effect
+ * textures.  Every other use of a bitmap gets the whole image.
+ *
+ * @param flags The flags the bitmap is locked with
+ */
+static int bm_get_dds_skip_levels(const bitmap_entry *be, ubyte flags);
+
 /**
  * Finds if a slot contains an animation
  */
@@ -276,7 +320,7 @@ DCF(bm_frag, "Shows BmpMan fragmentation") {
 	int xs = 2, ys = 2;
 	int w = 4, h = 4;
 
-	for (int i = 0; i<MAX_BITMAPS; i++) {
+	for (int i = 0; i<bm_bitmaps.size(); i++) {
 		switch (bm_bitmaps[i].type) {
 		case BM_TYPE_NONE:
 			gr_set_color(128, 128, 128);
@@ -321,7 +365,7 @@ DCF(bm_used, "Shows BmpMan Slot Usage") {
 	int eff = 0, eff_dds = 0, eff_tga = 0, eff_png = 0, eff_jpg = 0, eff_pcx = 0;
 	int render_target_dynamic = 0, render_target_static = 0;
 
-	for (int i = 0; i<MAX_BITMAPS; i++) {
+	for (int i = 0; i<bm_bitmaps.size(); i++) {
 		switch (bm_bitmaps[i].type) {
 		case BM_TYPE_NONE:
 			none++;
@@ -400,7 +444,7 @@ DCF(bm_used, "Shows BmpMan Slot Usage") {
 	text << "  " << std::dec << std::setw(4) << std::setfill('0') << eff_pcx  << ", EFF/PCX\n";
 	text << "  " << std::dec << std::setw(4) << std::setfill('0') << render_target_static  << ", Render/Static\n";
 	text << "  " << std::dec << std::setw(4) << std::setfill('0') << render_target_dynamic  << ", Render/Dynamic\n";
-	text << "  " << std::dec << std::setw(4) << std::setfill('0') << MAX_BITMAPS-none << "/" << MAX_BITMAPS  << ", Total\n";
+	text << "  " << std::dec << std::setw(4) << std::setfill('0') << bm_bitmaps.size()-none << "/" << bm_bitmaps.size()  << ", Total\n";
 	text << "\n";
 
 	// TODO consider converting 1's to monospace to make debug console output prettier
@@ -437,7 +481,7 @@ DCF(bmpman, "Shows/changes bitmap caching parameters and usage") {
 	if (dc_optional_string("flush")) {
 		dc_printf("Total RAM usage before flush: " SIZE_T_ARG " bytes\n", bm_texture_ram);
 		int i;
-		for (i = 0; i < MAX_BITMAPS; i++) {
+		for (i = 0; i < bm_bitmaps.size(); i++) {
 			if (bm_bitmaps[i].type != BM_TYPE_NONE) {
 				bm_free_data(i);
 			}
@@ -477,7 +521,9 @@ void bm_clean_slot(int n) {
 void bm_close() {
 	int i;
 	if (bm_inited) {
-		for (i = 0; i<MAX_BITMAPS; i++) {
+		bm_stream_flush();
+
+		for (i = 0; i<bm_bitmaps.size(); i++) {
 			bm_free_data(i);			// clears flags, bbp, data, etc
 		}
 		bm_inited = 0;
@@ -493,14 +539,7 @@ int bm_create(int bpp, int w, int h, void *data, int flags) {
 
 	if (!bm_inited) bm_init();
 
-	int n = -1;
-
-	for (int i = MAX_BITMAPS - 1; i >= 0; i--) {
-		if (bm_bitmaps[i].type == BM_TYPE_NONE) {
-			n = i;
-			break;
-		}
-	}
+	int n = find_block_of(1);
 
 	Assert(n > -1);
 
@@ -520,6 +559,7 @@ int bm_create(int bpp, int w, int h, void *data, int flags) {
 	bm_bitmaps[n].type = BM_TYPE_USER;
 	bm_bitmaps[n].comp_type = BM_TYPE_NONE;
 	bm_bitmaps[n].palette_checksum = 0;
+	bm_bitmaps.claim(n, 1);
 
 	bm_bitmaps[n].bm.w = (short)w;
 	bm_bitmaps[n].bm.h = (short)h;
@@ -536,7 +576,7 @@ int bm_create(int bpp, int w, int h, void *data, int flags) {
 
 	bm_bitmaps[n].signature = Bm_next_signature++;
 
-	bm_bitmaps[n].handle = bm_get_next_handle() * MAX_BITMAPS + n;
+	bm_bitmaps[n].handle = bm_get_next_handle(n);
 	bm_bitmaps[n].last_used = -1;
 	bm_bitmaps[n].mem_taken = (w * h * (bpp >> 3));
 
@@ -633,6 +673,7 @@ SkipFree:
 	bmp->bpp = 0;
 	bmp->data = 0;
 	bmp->palette = NULL;
+	be->dds_skipped_levels = 0;
 #ifdef BMPMAN_NDEBUG
 	be->data_size = 0;
 #endif
@@ -683,6 +724,7 @@ void bm_free_data_fast(int n)
 #endif
 	vm_free((void *)bmp->data);
 	bmp->data = 0;
+	be->dds_skipped_levels = 0;
 }
 
 int bm_get_anim_frame(const int frame1_handle, float elapsed_time, const float divisor, const bool loop)
@@ -739,6 +781,8 @@ int bm_get_anim_frame(const int frame1_handle, float elapsed_time, const float d
 	// note; this also makes non-looping anims hold on their last frame
 	CLAMP(frame, 0, last_frame);
 
+	bm_anim_stream_read_ahead(be->info.ani.first_frame, n - be->info.ani.first_frame + frame);
+
 	return frame;
 }
 
@@ -828,7 +872,7 @@ void bm_get_frame_usage(int *ntotal, int *nnew) {
 	*ntotal = 0;
 	*nnew = 0;
 
-	for (i = 0; i<MAX_BITMAPS; i++) {
+	for (i = 0; i<bm_bitmaps.size(); i++) {
 		if ((bm_bitmaps[i].type != BM_TYPE_NONE) && (bm_bitmaps[i].used_this_frame)) {
 			if (!bm_bitmaps[i].used_last_frame) {
 				*nnew += (int)bm_bitmaps[i].mem_taken;
@@ -892,22 +936,34 @@ int bm_get_info(int handle, int *w, int * h, ubyte * flags, int *nframes, int *f
 	}
 }
 
-int bm_get_next_handle() {
-	//bm_next_handle used to wrap around to 1 if it was over 30000. Now, believe it or not, but that is actually not uncommon;
-	//as bitmaps get allocated and released, bm_next_handle could get there far more often than you'd think.
-	//The check introduced below is intended to replace this behaviour with one that ensures we won't be seeing handle collisions
-	//for a very long time.
+bool bm_has_variable_frame_delays(int handle) {
+	int n = bm_get_cache_slot(handle, 1);
 
-	bm_next_handle++;
+	return bm_is_anim(n) && bm_bitmaps[n].info.ani.apng.is_apng;
+}
 
-	//Due to the way bm_next_handle is used to generate the /actual/ bitmap handles ( (bm_next_handle * MAX_BITMAPS) + free slot index in bm_bitmaps[]),
-	//this check is necessary to ensure we don't start giving out negative handles all of a sudden.
-	if ((bm_next_handle + 1) > INT_MAX / MAX_BITMAPS) {
-		bm_next_handle = 1;
-		mprintf(("BMPMAN: bitmap handles wrapped back to 1\n"));
-	}
+int bm_get_next_handle(int first_slot, int num_slots) {
+	return bm_bitmaps.next_handle(first_slot, num_slots);
+}
+
+bool bm_get_texture_cache_target(int handle, char (&cache_filename)[MAX_FILENAME_LEN], uint *source_checksum) {
+	int n = handle % MAX_BITMAPS;
+
+	Assert(n >= 0);
+	Assert(handle == bm_bitmaps[n].handle);
+
+	bitmap_entry *be = &bm_bitmaps[n];
+
+	// bitmaps which were loaded from their copy are DDS
+	if ((be->texture_cache_filename[0] == '\0') || (be->type == BM_TYPE_DDS) || be->info.ani.apng.is_apng)
+		return false;
 
-	return bm_next_handle;
+	strcpy_s(cache_filename, be->texture_cache_filename);
+	*source_checksum = be->source_checksum;
+
+	be->texture_cache_filename[0] = '\0';
+
+	return true;
 }
 
 int bm_get_num_mipmaps(int num) {
@@ -991,7 +1047,7 @@ bool bm_has_alpha_channel(int handle) {
 void bm_init() {
 	int i;
 
-	mprintf(("Size of bitmap info = " SIZE_T_ARG " KB\n", sizeof(bm_bitmaps) / 1024));
+	mprintf(("Size of bitmap info = " SIZE_T_ARG " bytes per slot\n", sizeof(bitmap_entry)));
 	mprintf(("Size of bitmap extra info = " SIZE_T_ARG " bytes\n", sizeof(bm_extra_info)));
 
 	if (!bm_inited) {
@@ -999,29 +1055,69 @@ void bm_init() {
 		atexit(bm_close);
 	}
 
-	for (i = 0; i<MAX_BITMAPS; i++) {
-		bm_bitmaps[i].filename[0] = '\0';
-		bm_bitmaps[i].type = BM_TYPE_NONE;
-		bm_bitmaps[i].comp_type = BM_TYPE_NONE;
-		bm_bitmaps[i].dir_type = CF_TYPE_ANY;
-		bm_bitmaps[i].info.user.data = NULL;
-		bm_bitmaps[i].mem_taken = 0;
-		bm_bitmaps[i].bm.data = 0;
-		bm_bitmaps[i].bm.palette = NULL;
-		bm_bitmaps[i].info.ani.eff.type = BM_TYPE_NONE;
-		bm_bitmaps[i].info.ani.eff.filename[0] = '\0';
+	for (i = 0; i < bm_bitmaps.size(); i++) {
+		if (bm_bitmaps[i].type != BM_TYPE_NONE) {
+			bm_bitmaps.release(i, 1);
+		}
+
+		bm_init_slot(i);
+	}
+}
+
+static int bm_get_dds_source(const bitmap_entry *be, char (&filename)[MAX_FILENAME_LEN]) {
+	if (be->texture_cache_filename[0] == '\0')
+		return be->dir_type;
+
+	strcpy_s(filename, be->texture_cache_filename);
+
+	return CF_TYPE_CACHE;
+}
+
+static int bm_get_dds_skip_levels(const bitmap_entry *be, ubyte flags) {
+	if ((Detail.hardware_textures >= 4) || (be->num_mipmaps <= 1))
+		return 0;
+
+	if (!(flags & BMP_TEX_COMP) && (flags != BMP_TEX_OTHER))
+		return 0;
+
+	BM_TYPE c_type = (be->type == BM_TYPE_EFF) ? be->info.ani.eff.type : be->type;
+
+	switch (c_type) {
+	case BM_TYPE_DDS:
+	case BM_TYPE_DXT1:
+	case BM_TYPE_DXT3:
+	case BM_TYPE_DXT5:
+		return MIN(4 - Detail.hardware_textures, be->num_mipmaps - 1);
+
+	default:
+		return 0;
+	}
+}
+
+static void bm_init_slot(int n) {
+	bm_bitmaps[n].filename[0] = '\0';
+	bm_bitmaps[n].type = BM_TYPE_NONE;
+	bm_bitmaps[n].comp_type = BM_TYPE_NONE;
+	bm_bitmaps[n].dir_type = CF_TYPE_ANY;
+	bm_bitmaps[n].texture_cache_filename[0] = '\0';
+	bm_bitmaps[n].info.user.data = NULL;
+	bm_bitmaps[n].mem_taken = 0;
+	bm_bitmaps[n].dds_skipped_levels = 0;
+	bm_bitmaps[n].bm.data = 0;
+	bm_bitmaps[n].bm.palette = NULL;
+	bm_bitmaps[n].info.ani.eff.type = BM_TYPE_NONE;
+	bm_bitmaps[n].info.ani.eff.filename[0] = '\0';
 #ifdef BMPMAN_NDEBUG
-		bm_bitmaps[i].data_size = 0;
-		bm_bitmaps[i].used_count = 0;
-		bm_bitmaps[i].used_last_frame = 0;
-		bm_bitmaps[i].used_this_frame = 0;
+	bm_bitmaps[n].data_size = 0;
+	bm_bitmaps[n].used_count = 0;
+	bm_bitmaps[n].used_last_frame = 0;
+	bm_bitmaps[n].used_this_frame = 0;
 #endif
-		bm_bitmaps[i].load_count = 0;
+	bm_bitmaps[n].load_count = 0;
 
-		gr_bm_init(i);
+	gr_bm_init(n);
 
-		bm_free_data(i);  	// clears flags, bbp, data, etc
-	}
+	bm_free_data(n);  	// clears flags, bbp, data, etc
 }
 
 int bm_is_compressed(int num) {
@@ -1084,6 +1180,8 @@ int bm_is_valid(int handle) {
 	if (!bm_inited) return 0;
 	if (handle < 0) return 0;
 
+	if ((handle % MAX_BITMAPS) >= bm_bitmaps.size()) return 0;
+
 	return (bm_bitmaps[handle % MAX_BITMAPS].handle == handle);
 }
 
@@ -1198,6 +1296,8 @@ int bm_load(const char *real_filename) {
 	size_t bm_size = 0;
 	int mm_lvl = 0;
 	char filename[MAX_FILENAME_LEN];
+	char cache_filename[MAX_FILENAME_LEN] = "";
+	uint source_checksum = 0;
 	BM_TYPE type = BM_TYPE_NONE;
 	BM_TYPE c_type = BM_TYPE_NONE;
 	CFILE *img_cfp = NULL;
@@ -1251,20 +1351,26 @@ int bm_load(const char *real_filename) {
 
 	Assert(type != BM_TYPE_NONE);
 
-	// Find an open slot
-	for (i = 0; i < MAX_BITMAPS; i++) {
-		if (bm_bitmaps[i].type == BM_TYPE_NONE) {
-			free_slot = i;
-			break;
+	// uncompressed images may have a compressed copy from an earlier run which is loaded in their place
+	if (texture_cache_enabled() && ((type == BM_TYPE_TGA) || (type == BM_TYPE_PNG) || (type == BM_TYPE_JPG))) {
+		CFILE *cache_cfp = texture_cache_open(filename, img_cfp, cache_filename, &source_checksum);
+
+		if (cache_cfp != NULL) {
+			cfclose(img_cfp);
+			img_cfp = cache_cfp;
+			type = BM_TYPE_DDS;
 		}
 	}
 
+	// Find an open slot
+	free_slot = find_block_of(1);
+
 	if (free_slot < 0) {
 		Assertion(free_slot < 0, "Could not find free BMPMAN slot for bitmap: %s", real_filename);
 		goto Done;
 	}
 
-	rc = bm_load_info(type, free_slot, filename, img_cfp, &w, &h, &bpp, &c_type, &mm_lvl, &bm_size);
+	rc = bm_load_info(type, free_slot, (type == BM_TYPE_DDS && *cache_filename) ? cache_filename : filename, img_cfp, &w, &h, &bpp, &c_type, &mm_lvl, &bm_size);
 
 	if (rc != 0)
 		goto Done;
@@ -1273,7 +1379,7 @@ int bm_load(const char *real_filename) {
 		bm_size = (w * h * (bpp >> 3));
 
 
-	handle = bm_get_next_handle() * MAX_BITMAPS + free_slot;
+	handle = bm_get_next_handle(free_slot);
 
 	// ensure fields are cleared out from previous bitmap
 	memset(&bm_bitmaps[free_slot], 0, sizeof(bitmap_entry));
@@ -1282,6 +1388,7 @@ int bm_load(const char *real_filename) {
 	// into this slot.
 	strncpy(bm_bitmaps[free_slot].filename, filename, MAX_FILENAME_LEN - 1);
 	bm_bitmaps[free_slot].type = type;
+	bm_bitmaps.claim(free_slot, 1);
 	bm_bitmaps[free_slot].comp_type = c_type;
 	bm_bitmaps[free_slot].signature = Bm_next_signature++;
 	bm_bitmaps[free_slot].bm.w = (short)w;
@@ -1295,6 +1402,8 @@ int bm_load(const char *real_filename) {
 	bm_bitmaps[free_slot].num_mipmaps = mm_lvl;
 	bm_bitmaps[free_slot].mem_taken = (size_t)bm_size;
 	bm_bitmaps[free_slot].dir_type = CF_TYPE_ANY;
+	strcpy_s(bm_bitmaps[free_slot].texture_cache_filename, cache_filename);
+	bm_bitmaps[free_slot].source_checksum = source_checksum;
 	bm_bitmaps[free_slot].palette_checksum = 0;
 	bm_bitmaps[free_slot].handle = handle;
 	bm_bitmaps[free_slot].last_used = -1;
@@ -1406,6 +1515,11 @@ static int bm_load_image_data(const char *filename, int handle, int bitmapnum, i
 	else
 		true_bpp = bpp;
 
+	// DDS data which was read without top mipmap levels the caller does need has to be read again
+	if ((bmp->data != 0) && (be->ref_count == 1) && (be->dds_skipped_levels > bm_get_dds_skip_levels(be, flags))) {
+		bm_free_data_fast(bitmapnum);
+	}
+
 	// don't do a bpp check here since it could be different in OGL - taylor
 	if (bmp->data == 0) {
 		Assert(be->ref_count == 1);
@@ -1443,7 +1557,9 @@ static int bm_load_image_data(const char *filename, int handle, int bitmapnum, i
 			break;
 
 		case BM_TYPE_ANI:
-			bm_lock_ani(handle, bitmapnum, be, bmp, true_bpp, flags);
+			if (!bm_lock_anim_stream(handle, bitmapnum, be, bmp, true_bpp, flags)) {
+				bm_lock_ani(handle, bitmapnum, be, bmp, true_bpp, flags);
+			}
 			break;
 
 		case BM_TYPE_TGA:
@@ -1453,7 +1569,9 @@ static int bm_load_image_data(const char *filename, int handle, int bitmapnum, i
 		case BM_TYPE_PNG:
 			//libpng handles compression with zlib
 			if (be->info.ani.apng.is_apng == true) {
-				bm_lock_apng( handle, bitmapnum, be, bmp, true_bpp, flags );
+				if (!bm_lock_anim_stream(handle, bitmapnum, be, bmp, true_bpp, flags)) {
+					bm_lock_apng( handle, bitmapnum, be, bmp, true_bpp, flags );
+				}
 			}
 			else {
 				bm_lock_png( handle, bitmapnum, be, bmp, true_bpp, flags );
@@ -1502,12 +1620,13 @@ int bm_load_animation(const char *real_filename, int *nframes, int *fps, int *ke
 	char filename[MAX_FILENAME_LEN];
 	int reduced = 0;
 	int anim_fps = 0, anim_frames = 0, key = 0;
-	float anim_total_time = 0.0f;
+	float anim_total_time = 0.0f, anim_total_delay = 0.0f;
 	int anim_width = 0, anim_height = 0;
 	BM_TYPE type = BM_TYPE_NONE, eff_type = BM_TYPE_NONE, c_type = BM_TYPE_NONE;
 	int bpp = 0, mm_lvl = 0;
 	size_t img_size = 0;
 	char clean_name[MAX_FILENAME_LEN];
+	SCP_vector<float> apng_delays;
 
 	if (!bm_inited)
 		bm_init();
@@ -1665,6 +1784,7 @@ int bm_load_animation(const char *real_filename, int *nframes, int *fps, int *ke
 			anim_height = the_apng.h;
 			bpp = the_apng.bpp;
 			img_size = the_apng.imgsize();
+			apng_delays = the_apng.frame_delays;
 		}
 		catch (const apng::ApngException& e) {
 			mprintf(("Failed to load apng: %s\n", e.what() ));
@@ -1700,7 +1820,6 @@ int bm_load_animation(const char *real_filename, int *nframes, int *fps, int *ke
 		return -1;
 	}
 
-	int first_handle = bm_get_next_handle();
 
 	for (i = 0; i < anim_frames; i++) {
 		memset(&bm_bitmaps[n + i], 0, sizeof(bitmap_entry));
@@ -1760,7 +1879,7 @@ int bm_load_animation(const char *real_filename, int *nframes, int *fps, int *ke
 		bm_bitmaps[n + i].comp_type = c_type;
 		bm_bitmaps[n + i].palette_checksum = 0;
 		bm_bitmaps[n + i].signature = Bm_next_signature++;
-		bm_bitmaps[n + i].handle = first_handle*MAX_BITMAPS + n + i;
+		bm_bitmaps[n + i].handle = -1;
 		bm_bitmaps[n + i].last_used = -1;
 		bm_bitmaps[n + i].num_mipmaps = mm_lvl;
 		bm_bitmaps[n + i].mem_taken = (size_t)img_size;
@@ -1782,6 +1901,12 @@ int bm_load_animation(const char *real_filename, int *nframes, int *fps, int *ke
 		bm_bitmaps[n + i].info.ani.apng.frame_delay = 0.0f;
 		if (type == BM_TYPE_PNG) {
 			bm_bitmaps[n + i].info.ani.apng.is_apng = true;
+
+			// the same incremental delay bm_lock_apng() sets, frames which aren't decoded yet need it too
+			if (i < (int)apng_delays.size()) {
+				anim_total_delay += apng_delays[i];
+				bm_bitmaps[n + i].info.ani.apng.frame_delay = anim_total_delay;
+			}
 		}
 		else {
 			bm_bitmaps[n + i].info.ani.apng.is_apng = false;
@@ -1789,6 +1914,15 @@ int bm_load_animation(const char *real_filename, int *nframes, int *fps, int *ke
 
 	}
 
+	// frames which couldn't be loaded stay free so the handles are only handed out once the final count is known
+	bm_bitmaps.claim(n, anim_frames);
+
+	int first_handle = bm_get_next_handle(n, anim_frames);
+
+	for (i = 0; i < anim_frames; i++) {
+		bm_bitmaps[n + i].handle = first_handle + i;
+	}
+
 	if (nframes != nullptr)
 		*nframes = anim_frames;
 
@@ -1843,7 +1977,7 @@ int bm_load_sub_fast(const char *real_filename, int *handle, int dir_type, bool
 
 	int i;
 
-	for (i = 0; i < MAX_BITMAPS; i++) {
+	for (i = 0; i < bm_bitmaps.size(); i++) {
 		if (bm_bitmaps[i].type == BM_TYPE_NONE)
 			continue;
 
@@ -1999,6 +2133,69 @@ bitmap * bm_lock(int handle, int bpp, ubyte flags, bool nodebug) {
 	return bmp;
 }
 
+/**
+ * Copies a decoded ANI frame into the data of a bitmap, scaling it down if the bitmap is smaller than the animation
+ */
+static void bm_copy_ani_frame(bitmap *bm, ubyte *frame_data, anim *the_anim, int bpp, int size) {
+	ubyte *dptr, *sptr;
+
+	sptr = frame_data;
+	dptr = (ubyte *)bm->data;
+
+	if ((bm->w != the_anim->width) || (bm->h != the_anim->height)) {
+		// Scale it down
+		// 8 bit
+		if (bpp == 8) {
+			int w, h;
+			fix u, utmp, v, du, dv;
+
+			u = v = 0;
+
+			du = (the_anim->width*F1_0) / bm->w;
+			dv = (the_anim->height*F1_0) / bm->h;
+
+			for (h = 0; h < bm->h; h++) {
+				ubyte *drow = &dptr[bm->w * h];
+				ubyte *srow = &sptr[f2i(v)*the_anim->width];
+
+				utmp = u;
+
+				for (w = 0; w < bm->w; w++) {
+					*drow++ = srow[f2i(utmp)];
+					utmp += du;
+				}
+				v += dv;
+			}
+		}
+		// 16 bpp
+		else {
+			int w, h;
+			fix u, utmp, v, du, dv;
+
+			u = v = 0;
+
+			du = (the_anim->width*F1_0) / bm->w;
+			dv = (the_anim->height*F1_0) / bm->h;
+
+			for (h = 0; h < bm->h; h++) {
+				unsigned short *drow = &((unsigned short*)dptr)[bm->w * h];
+				unsigned short *srow = &((unsigned short*)sptr)[f2i(v)*the_anim->width];
+
+				utmp = u;
+
+				for (w = 0; w < bm->w; w++) {
+					*drow++ = srow[f2i(utmp)];
+					utmp += du;
+				}
+				v += dv;
+			}
+		}
+	} else {
+		// 1-to-1 mapping
+		memcpy(dptr, sptr, size);
+	}
+}
+
 void bm_lock_ani(int handle, int bitmapnum, bitmap_entry *be, bitmap *bmp, int bpp, ubyte flags) {
 	anim				*the_anim;
 	anim_instance	*the_anim_instance;
@@ -2049,63 +2246,7 @@ void bm_lock_ani(int handle, int bitmapnum, bitmap_entry *be, bitmap *bmp, int b
 
 		frame_data = anim_get_next_raw_buffer(the_anim_instance, 0, flags & BMP_AABITMAP ? 1 : 0, bm->bpp);
 
-		ubyte *dptr, *sptr;
-
-		sptr = frame_data;
-		dptr = (ubyte *)bm->data;
-
-		if ((bm->w != the_anim->width) || (bm->h != the_anim->height)) {
-			// Scale it down
-			// 8 bit
-			if (bpp == 8) {
-				int w, h;
-				fix u, utmp, v, du, dv;
-
-				u = v = 0;
-
-				du = (the_anim->width*F1_0) / bm->w;
-				dv = (the_anim->height*F1_0) / bm->h;
-
-				for (h = 0; h < bm->h; h++) {
-					ubyte *drow = &dptr[bm->w * h];
-					ubyte *srow = &sptr[f2i(v)*the_anim->width];
-
-					utmp = u;
-
-					for (w = 0; w < bm->w; w++) {
-						*drow++ = srow[f2i(utmp)];
-						utmp += du;
-					}
-					v += dv;
-				}
-			}
-			// 16 bpp
-			else {
-				int w, h;
-				fix u, utmp, v, du, dv;
-
-				u = v = 0;
-
-				du = (the_anim->width*F1_0) / bm->w;
-				dv = (the_anim->height*F1_0) / bm->h;
-
-				for (h = 0; h < bm->h; h++) {
-					unsigned short *drow = &((unsigned short*)dptr)[bm->w * h];
-					unsigned short *srow = &((unsigned short*)sptr)[f2i(v)*the_anim->width];
-
-					utmp = u;
-
-					for (w = 0; w < bm->w; w++) {
-						*drow++ = srow[f2i(utmp)];
-						utmp += du;
-					}
-					v += dv;
-				}
-			}
-		} else {
-			// 1-to-1 mapping
-			memcpy(dptr, sptr, size);
-		}
+		bm_copy_ani_frame(bm, frame_data, the_anim, bpp, size);
 
 		bm_convert_format(bm, flags);
 
@@ -2168,128 +2309,458 @@ void bm_lock_apng(int handle, int bitmapnum, bitmap_entry *be, bitmap *bmp, int
 }
 
 
-void bm_lock_dds(int handle, int bitmapnum, bitmap_entry *be, bitmap *bmp, int bpp, ubyte flags) {
-	ubyte *data = NULL;
-	int error;
-	ubyte dds_bpp = 0;
-	char filename[MAX_FILENAME_LEN];
-
-	// free any existing data
-	bm_free_data(bitmapnum);
+bool Bm_anim_streaming = true;
+DCF_BOOL(anim_streaming, Bm_anim_streaming);
 
-	Assert(be->mem_taken > 0);
-	Assert(&be->bm == bmp);
+namespace {
 
-	data = (ubyte*)bm_malloc(bitmapnum, be->mem_taken);
+/**
+ * The decoder of a big ANI or APNG animation whose frames are decoded one at a time when they are locked
+ *
+ * Only the frame which was locked last and the few frames after it are kept in memory. The following APNG frames are
+ * decoded on a job worker, ANI frames are always decoded on the main thread since their pixel conversion depends on
+ * the screen format selected for the current lock.
+ */
+struct bm_anim_stream {
+	int first_frame = -1;
+	int handle = -1;			// of the first frame, the slots may have been reused in the meantime
+	int bpp = 0;
+	ubyte flags = 0;
 
-	if (data == NULL)
-		return;
+	anim *ani = nullptr;
+	anim_instance *ani_instance = nullptr;
+	bool can_drop_frames = false;
 
-	memset(data, 0, be->mem_taken);
+	std::unique_ptr<apng::apng_ani> apng;
 
-	// make sure we are using the correct filename in the case of an EFF.
-	// this will populate filename[] whether it's EFF or not
-	EFF_FILENAME_CHECK;
+	int next_frame = 0;			// the frame the decoder produces next
+	bool failed = false;		// the decoder has to be opened again before it can be used
 
-	error = dds_read_bitmap(filename, data, &dds_bpp, be->dir_type);
+	// the decoder belongs to the read ahead job until the group is done
+	jobs::job_group group;
+	int ahead_first = -1;
+	SCP_vector<SCP_vector<ubyte>> ahead;
 
-#if BYTE_ORDER == BIG_ENDIAN
-	// same as with TGA, we need to byte swap 16 & 32-bit, uncompressed, DDS images
-	if ((be->comp_type == BM_TYPE_DDS) || (be->comp_type == BM_TYPE_CUBEMAP_DDS)) {
-		size_t i = 0;
+	~bm_anim_stream();
+};
 
-		if (dds_bpp == 32) {
-			unsigned int *swap_tmp;
+bm_anim_stream::~bm_anim_stream() {
+	group.wait();
 
-			for (i = 0; i < be->mem_taken; i += 4) {
-				swap_tmp = (unsigned int *)(data + i);
-				*swap_tmp = INTEL_INT(*swap_tmp);
-			}
-		} else if (dds_bpp == 16) {
-			unsigned short *swap_tmp;
+	if (ani_instance != nullptr) {
+		free_anim_instance(ani_instance);
+	}
 
-			for (i = 0; i < be->mem_taken; i += 2) {
-				swap_tmp = (unsigned short *)(data + i);
-				*swap_tmp = INTEL_SHORT(*swap_tmp);
-			}
-		}
+	if (ani != nullptr) {
+		anim_free(ani);
 	}
-#endif
+}
 
-	bmp->bpp = dds_bpp;
-	bmp->data = (ptr_u)data;
-	bmp->flags = 0;
+SCP_unordered_map<int, std::unique_ptr<bm_anim_stream>> Bm_anim_streams;
 
-	if (error != DDS_ERROR_NONE) {
-		bm_free_data(bitmapnum);
-		return;
-	}
+// animations which fit into this size with all of their frames decoded are still decoded at once
+const size_t BM_ANIM_STREAM_MIN_SIZE = 8 * 1024 * 1024;
+
+// the number of frames kept in memory, starting with the frame which was locked last
+const int BM_ANIM_STREAM_FRAMES = 4;
 
-#ifdef BMPMAN_NDEBUG
-	Assert(be->data_size > 0);
-#endif
 }
 
-void bm_lock_jpg(int handle, int bitmapnum, bitmap_entry *be, bitmap *bmp, int bpp, ubyte flags) {
-	ubyte *data = NULL;
-	int d_size = 0;
-	int jpg_error = JPEG_ERROR_INVALID;
-	char filename[MAX_FILENAME_LEN];
+MONITOR(AnimStreams)
 
-	// Unload any existing data
-	bm_free_data(bitmapnum);
+/**
+ * Opens the decoder of a stream again so it starts with the first frame
+ */
+static bool bm_anim_stream_open(bm_anim_stream *stream) {
+	bitmap_entry *first_be = &bm_bitmaps[stream->first_frame];
 
-	d_size = (bpp >> 3);
+	stream->next_frame = 0;
+	stream->failed = false;
 
-	// allocate bitmap data
-	Assert(be->mem_taken > 0);
-	data = (ubyte*)bm_malloc(bitmapnum, be->mem_taken);
+	if (first_be->info.ani.apng.is_apng) {
+		stream->apng.reset();
 
-	if (data == NULL)
-		return;
+		try {
+			// without caching the decoder only holds the frame it is working on
+			stream->apng.reset(new apng::apng_ani(first_be->filename, false));
+		}
+		catch (const apng::ApngException& e) {
+			Warning(LOCATION, "Failed to load apng: %s", e.what());
+			stream->failed = true;
+			return false;
+		}
 
-	memset(data, 0, be->mem_taken);
+		return true;
+	}
 
-	bmp->bpp = bpp;
-	bmp->data = (ptr_u)data;
-	bmp->palette = NULL;
+	if (stream->ani_instance != nullptr) {
+		free_anim_instance(stream->ani_instance);
+		stream->ani_instance = nullptr;
+	}
 
-	Assert(&be->bm == bmp);
+	if (stream->ani == nullptr) {
+		stream->ani = anim_load(first_be->filename, first_be->dir_type);
 
-	// make sure we are using the correct filename in the case of an EFF.
-	// this will populate filename[] whether it's EFF or not
-	EFF_FILENAME_CHECK;
+		if (stream->ani == nullptr) {
+			nprintf(("BMPMAN", "Error opening %s in bm_lock\n", first_be->filename));
+			stream->failed = true;
+			return false;
+		}
+	}
 
-	jpg_error = jpeg_read_bitmap(filename, data, NULL, d_size, be->dir_type);
+	stream->ani_instance = init_anim_instance(stream->ani, stream->bpp);
 
-	if (jpg_error != JPEG_ERROR_NONE) {
-		bm_free_data(bitmapnum);
-		return;
+	if (stream->ani_instance == nullptr) {
+		nprintf(("BMPMAN", "Error opening %s in bm_lock\n", first_be->filename));
+		stream->failed = true;
+		return false;
 	}
 
-#ifdef BMPMAN_NDEBUG
-	Assert(be->data_size > 0);
-#endif
+	stream->can_drop_frames = (stream->ani->total_frames != first_be->info.ani.num_frames);
+
+	return true;
 }
 
-void bm_lock_pcx(int handle, int bitmapnum, bitmap_entry *be, bitmap *bmp, int bpp, ubyte flags) {
-	ubyte *data;
-	int pcx_error;
-	char filename[MAX_FILENAME_LEN];
+/**
+ * Decodes the next frame of an APNG stream, this also runs on the job workers
+ */
+static bool bm_anim_stream_next_apng(bm_anim_stream *stream) {
+	try {
+		stream->apng->next_frame();
+	}
+	catch (const apng::ApngException& e) {
+		mprintf(("Failed to get next apng frame: %s\n", e.what()));
+		stream->failed = true;
+		return false;
+	}
 
-	// Unload any existing data
-	bm_free_data(bitmapnum);
+	++stream->next_frame;
 
-	be->mem_taken = (bmp->w * bmp->h * (bpp >> 3));
-	data = (ubyte *)bm_malloc(bitmapnum, be->mem_taken);
-	bmp->bpp = bpp;
-	bmp->data = (ptr_u)data;
-	bmp->palette = NULL;
-	memset(data, 0, be->mem_taken);
+	return true;
+}
 
-	Assert(&be->bm == bmp);
-#ifdef BMPMAN_NDEBUG
-	Assert(be->data_size > 0);
+/**
+ * Waits for the read ahead job of a stream and hands the frames it decoded to their bitmaps
+ */
+static void bm_anim_stream_install(bm_anim_stream *stream) {
+	stream->group.wait();
+
+	if (stream->ahead.empty()) {
+		return;
+	}
+
+	if (bm_bitmaps[stream->first_frame].handle == stream->handle) {
+		for (size_t i = 0; i < stream->ahead.size(); ++i) {
+			int slot = stream->first_frame + stream->ahead_first + (int)i;
+			bitmap_entry *be = &bm_bitmaps[slot];
+
+			// the frame may have been decoded by a lock while the job was queued
+			if (stream->ahead[i].empty() || (be->bm.data != 0)) {
+				continue;
+			}
+
+			Assert(stream->ahead[i].size() >= be->mem_taken);
+
+			ubyte *data = static_cast<ubyte*>(bm_malloc(slot, be->mem_taken));
+			memcpy(data, stream->ahead[i].data(), be->mem_taken);
+
+			be->bm.data = reinterpret_cast<ptr_u>(data);
+			be->bm.palette = nullptr;
+			be->bm.bpp = (ubyte)stream->bpp;
+			be->bm.flags = 0;
+		}
+	}
+
+	stream->ahead.clear();
+}
+
+/**
+ * Queues a job which decodes the frames in [from, to) of an APNG stream that aren't in memory yet
+ */
+static void bm_anim_stream_queue_read_ahead(bm_anim_stream *stream, int from, int to) {
+	if (!stream->apng || stream->failed || !stream->group.done() || !stream->ahead.empty() || (jobs::num_workers() < 2)) {
+		return;
+	}
+
+	to = MIN(to, bm_bitmaps[stream->first_frame].info.ani.num_frames);
+
+	while ((from < to) && (bm_bitmaps[stream->first_frame + from].bm.data != 0)) {
+		++from;
+	}
+
+	// going back to an earlier frame means starting over, that is left to the lock which needs the frame
+	if ((from >= to) || (from < stream->next_frame)) {
+		return;
+	}
+
+	stream->ahead_first = from;
+	stream->ahead.resize(to - from);
+
+	stream->group.run([stream, to]() {
+		while (stream->next_frame < to) {
+			if (!bm_anim_stream_next_apng(stream)) {
+				break;
+			}
+
+			int index = stream->next_frame - 1 - stream->ahead_first;
+
+			if (index >= 0) {
+				stream->ahead[index] = stream->apng->frame.data;
+			}
+		}
+	}, tracing::AnimStreamJob);
+}
+
+/**
+ * Releases the data of the frames of a stream which are too far away from the frame which was locked last
+ */
+static void bm_anim_stream_trim(bm_anim_stream *stream, int frame) {
+	int nframes = bm_bitmaps[stream->first_frame].info.ani.num_frames;
+
+	for (int i = 0; i < nframes; ++i) {
+		if ((i >= frame) && (i < frame + BM_ANIM_STREAM_FRAMES)) {
+			continue;
+		}
+
+		bitmap_entry *be = &bm_bitmaps[stream->first_frame + i];
+
+		if ((be->bm.data != 0) && (be->ref_count == 0)) {
+			bm_free_data_fast(stream->first_frame + i);
+		}
+	}
+}
+
+static void bm_anim_stream_read_ahead(int first_frame, int frame) {
+	auto iter = Bm_anim_streams.find(first_frame);
+
+	if ((iter == Bm_anim_streams.end()) || (iter->second->handle != bm_bitmaps[first_frame].handle)) {
+		return;
+	}
+
+	bm_anim_stream_queue_read_ahead(iter->second.get(), frame, frame + BM_ANIM_STREAM_FRAMES);
+}
+
+static void bm_anim_stream_free(int first_frame) {
+	Bm_anim_streams.erase(first_frame);
+}
+
+bool bm_lock_anim_stream(int handle, int bitmapnum, bitmap_entry *be, bitmap *bmp, int bpp, ubyte flags) {
+	int first_frame = be->info.ani.first_frame;
+	bitmap_entry *first_be = &bm_bitmaps[first_frame];
+	int nframes = first_be->info.ani.num_frames;
+
+	if (!Bm_anim_streaming || Is_standalone || (nframes <= 1)) {
+		return false;
+	}
+
+	size_t size = be->info.ani.apng.is_apng ? be->mem_taken : (size_t)(bmp->w * bmp->h * (bpp >> 3));
+
+	if (size * nframes < BM_ANIM_STREAM_MIN_SIZE) {
+		return false;
+	}
+
+	std::unique_ptr<bm_anim_stream> &entry = Bm_anim_streams[first_frame];
+
+	if (!entry || (entry->handle != first_be->handle) || (entry->bpp != bpp) || (entry->flags != flags)) {
+		entry.reset(new bm_anim_stream());
+		entry->first_frame = first_frame;
+		entry->handle = first_be->handle;
+		entry->bpp = bpp;
+		entry->flags = flags;
+
+		if (!bm_anim_stream_open(entry.get())) {
+			// the data stays empty so the lock fails like it does with the other lock functions
+			Bm_anim_streams.erase(first_frame);
+			return true;
+		}
+	}
+
+	bm_anim_stream *stream = entry.get();
+	int frame = bitmapnum - first_frame;
+
+	// the job may already have decoded this frame
+	bm_anim_stream_install(stream);
+
+	if (bmp->data == 0) {
+		if ((stream->failed || (frame < stream->next_frame)) && !bm_anim_stream_open(stream)) {
+			Bm_anim_streams.erase(first_frame);
+			return true;
+		}
+
+		if (stream->apng) {
+			while (stream->next_frame <= frame) {
+				if (!bm_anim_stream_next_apng(stream)) {
+					Warning(LOCATION, "Failed to get frame %d of apng %s", frame, first_be->filename);
+					return true;
+				}
+			}
+
+			ubyte *data = static_cast<ubyte*>(bm_malloc(bitmapnum, be->mem_taken));
+			memcpy(data, stream->apng->frame.data.data(), be->mem_taken);
+
+			bmp->data = reinterpret_cast<ptr_u>(data);
+			bmp->palette = nullptr;
+			bmp->bpp = (ubyte)bpp;
+			bmp->flags = 0;
+		} else {
+			ubyte *frame_data = nullptr;
+			int aabitmap = (flags & BMP_AABITMAP) ? 1 : 0;
+
+			while (stream->next_frame <= frame) {
+				// skip the frames bm_lock_ani() drops
+				if (stream->can_drop_frames && (stream->next_frame > 0)) {
+					anim_get_next_raw_buffer(stream->ani_instance, 0, aabitmap, bpp);
+				}
+
+				frame_data = anim_get_next_raw_buffer(stream->ani_instance, 0, aabitmap, bpp);
+				++stream->next_frame;
+			}
+
+			be->mem_taken = size;
+
+			bmp->flags = 0;
+			bmp->bpp = (ubyte)bpp;
+			bmp->data = (ptr_u)bm_malloc(bitmapnum, size);
+
+			bm_copy_ani_frame(bmp, frame_data, stream->ani, bpp, (int)size);
+			bm_convert_format(bmp, flags);
+		}
+	}
+
+	bm_anim_stream_trim(stream, frame);
+	bm_anim_stream_queue_read_ahead(stream, frame + 1, frame + BM_ANIM_STREAM_FRAMES);
+
+	return true;
+}
+
+
+void bm_lock_dds(int handle, int bitmapnum, bitmap_entry *be, bitmap *bmp, int bpp, ubyte flags) {
+	ubyte *data = NULL;
+	int error;
+	ubyte dds_bpp = 0;
+	char filename[MAX_FILENAME_LEN];
+
+	// free any existing data
+	bm_free_data(bitmapnum);
+
+	Assert(be->mem_taken > 0);
+	Assert(&be->bm == bmp);
+
+	data = (ubyte*)bm_malloc(bitmapnum, be->mem_taken);
+
+	if (data == NULL)
+		return;
+
+	// make sure we are using the correct filename in the case of an EFF.
+	// this will populate filename[] whether it's EFF or not
+	EFF_FILENAME_CHECK;
+
+	int dir_type = bm_get_dds_source(be, filename);
+
+	// the levels the texture detail leaves out are neither read nor touched, the renderer starts after them
+	int skip_levels = bm_get_dds_skip_levels(be, flags);
+
+	error = dds_read_bitmap(filename, data, &dds_bpp, dir_type, skip_levels);
+
+#if BYTE_ORDER == BIG_ENDIAN
+	// same as with TGA, we need to byte swap 16 & 32-bit, uncompressed, DDS images
+	if ((be->comp_type == BM_TYPE_DDS) || (be->comp_type == BM_TYPE_CUBEMAP_DDS)) {
+		size_t i = 0;
+
+		if (dds_bpp == 32) {
+			unsigned int *swap_tmp;
+
+			for (i = 0; i < be->mem_taken; i += 4) {
+				swap_tmp = (unsigned int *)(data + i);
+				*swap_tmp = INTEL_INT(*swap_tmp);
+			}
+		} else if (dds_bpp == 16) {
+			unsigned short *swap_tmp;
+
+			for (i = 0; i < be->mem_taken; i += 2) {
+				swap_tmp = (unsigned short *)(data + i);
+				*swap_tmp = INTEL_SHORT(*swap_tmp);
+			}
+		}
+	}
+#endif
+
+	bmp->bpp = dds_bpp;
+	bmp->data = (ptr_u)data;
+	bmp->flags = 0;
+
+	if (error != DDS_ERROR_NONE) {
+		bm_free_data(bitmapnum);
+		return;
+	}
+
+	be->dds_skipped_levels = skip_levels;
+
+#ifdef BMPMAN_NDEBUG
+	Assert(be->data_size > 0);
+#endif
+}
+
+void bm_lock_jpg(int handle, int bitmapnum, bitmap_entry *be, bitmap *bmp, int bpp, ubyte flags) {
+	ubyte *data = NULL;
+	int d_size = 0;
+	int jpg_error = JPEG_ERROR_INVALID;
+	char filename[MAX_FILENAME_LEN];
+
+	// Unload any existing data
+	bm_free_data(bitmapnum);
+
+	d_size = (bpp >> 3);
+
+	// allocate bitmap data
+	Assert(be->mem_taken > 0);
+	data = (ubyte*)bm_malloc(bitmapnum, be->mem_taken);
+
+	if (data == NULL)
+		return;
+
+	memset(data, 0, be->mem_taken);
+
+	bmp->bpp = bpp;
+	bmp->data = (ptr_u)data;
+	bmp->palette = NULL;
+
+	Assert(&be->bm == bmp);
+
+	// make sure we are using the correct filename in the case of an EFF.
+	// this will populate filename[] whether it's EFF or not
+	EFF_FILENAME_CHECK;
+
+	jpg_error = jpeg_read_bitmap(filename, data, NULL, d_size, be->dir_type);
+
+	if (jpg_error != JPEG_ERROR_NONE) {
+		bm_free_data(bitmapnum);
+		return;
+	}
+
+#ifdef BMPMAN_NDEBUG
+	Assert(be->data_size > 0);
+#endif
+}
+
+void bm_lock_pcx(int handle, int bitmapnum, bitmap_entry *be, bitmap *bmp, int bpp, ubyte flags) {
+	ubyte *data;
+	int pcx_error;
+	char filename[MAX_FILENAME_LEN];
+
+	// Unload any existing data
+	bm_free_data(bitmapnum);
+
+	be->mem_taken = (bmp->w * bmp->h * (bpp >> 3));
+	data = (ubyte *)bm_malloc(bitmapnum, be->mem_taken);
+	bmp->bpp = bpp;
+	bmp->data = (ptr_u)data;
+	bmp->palette = NULL;
+	memset(data, 0, be->mem_taken);
+
+	Assert(&be->bm == bmp);
+#ifdef BMPMAN_NDEBUG
+	Assert(be->data_size > 0);
 #endif
 
 	// some sanity checks on flags
@@ -2456,7 +2927,7 @@ void bm_lock_user(int handle, int bitmapnum, bitmap_entry *be, bitmap *bmp, int
 }
 
 int bm_make_render_target(int width, int height, int flags) {
-	int i, n;
+	int n;
 	int mm_lvl = 0;
 	// final w and h may be different from passed width and height
 	int w = width, h = height;
@@ -2466,13 +2937,8 @@ int bm_make_render_target(int width, int height, int flags) {
 	if (!bm_inited)
 		bm_init();
 
-	// Find an open slot (starting from the end)
-	for (n = -1, i = MAX_BITMAPS - 1; i >= 0; i--) {
-		if (bm_bitmaps[i].type == BM_TYPE_NONE) {
-			n = i;
-			break;
-		}
-	}
+	// Find an open slot
+	n = find_block_of(1);
 
 	// Out of bitmap slots
 	if (n == -1)
@@ -2502,6 +2968,7 @@ int bm_make_render_target(int width, int height, int flags) {
 	memset(&bm_bitmaps[n], 0, sizeof(bitmap_entry));
 
 	bm_bitmaps[n].type = (flags & BMP_FLAG_RENDER_TARGET_STATIC) ? BM_TYPE_RENDER_TARGET_STATIC : BM_TYPE_RENDER_TARGET_DYNAMIC;
+	bm_bitmaps.claim(n, 1);
 	bm_bitmaps[n].signature = Bm_next_signature++;
 	sprintf(bm_bitmaps[n].filename, "RT_%dx%d+%d", w, h, bpp);
 	bm_bitmaps[n].bm.w = (short)w;
@@ -2517,7 +2984,7 @@ int bm_make_render_target(int width, int height, int flags) {
 	bm_bitmaps[n].dir_type = CF_TYPE_ANY;
 
 	bm_bitmaps[n].palette_checksum = 0;
-	bm_bitmaps[n].handle = bm_get_next_handle() * MAX_BITMAPS + n;
+	bm_bitmaps[n].handle = bm_get_next_handle(n);
 	bm_bitmaps[n].last_used = -1;
 
 	if (bm_bitmaps[n].mem_taken) {
@@ -2563,10 +3030,14 @@ void bm_page_in_aabitmap(int bitmapnum, int nframes) {
 void bm_page_in_start() {
 	int i;
 
+	bm_stream_flush();
+
+	bm_atlas_reset();
+
 	Bm_paging = 1;
 
 	// Mark all as inited
-	for (i = 0; i < MAX_BITMAPS; i++) {
+	for (i = 0; i < bm_bitmaps.size(); i++) {
 		if (!Cmdline_cache_bitmaps && (bm_bitmaps[i].type != BM_TYPE_NONE)) {
 			bm_unload_fast(bm_bitmaps[i].handle);
 		}
@@ -2581,6 +3052,180 @@ void bm_page_in_start() {
 	gr_bm_page_in_start();
 }
 
+namespace {
+
+/**
+ * A bitmap which is read and decoded by a job while the main thread continues
+ *
+ * Everything the job needs is copied out of the bitmap entry when the load is queued since the entry may be changed or
+ * even released by the main thread while the job runs.
+ */
+struct bm_page_in_image {
+	int bitmapnum = -1;
+	int handle = -1;
+
+	char filename[MAX_FILENAME_LEN];
+	BM_TYPE type = BM_TYPE_NONE;
+	int dir_type = CF_TYPE_ANY;
+	int w = 0;
+	int h = 0;
+	size_t mem_taken = 0;
+	int skip_levels = 0;
+
+	ubyte *data = nullptr;
+	size_t size = 0;
+	int bpp = 0;
+
+	// the time the load was queued at, used for finding stalled streaming loads
+	int queued_at = 0;
+
+	jobs::job_group group;
+};
+
+/**
+ * Checks if the image data of a bitmap can be loaded outside of the main thread
+ *
+ * Only DDS and PNG images are loaded in parallel since their loaders don't depend on any global state and produce the
+ * same data no matter which format the bitmap is locked in later.
+ */
+bool bm_page_in_can_decode(int n)
+{
+	bitmap_entry *be = &bm_bitmaps[n];
+
+	if (Is_standalone || be->bm.data != 0 || be->ref_count != 0) {
+		return false;
+	}
+
+	// the texture is still around from an earlier page in so there is nothing to load
+	if (gr_bm_is_uploaded(n)) {
+		return false;
+	}
+
+	BM_TYPE c_type = (be->type == BM_TYPE_EFF) ? be->info.ani.eff.type : be->type;
+
+	switch (c_type) {
+	case BM_TYPE_PNG:
+		return !be->info.ani.apng.is_apng && (be->bm.w * be->bm.h > 0);
+
+	case BM_TYPE_DDS:
+	case BM_TYPE_CUBEMAP_DDS:
+#if BYTE_ORDER == BIG_ENDIAN
+		// uncompressed images need to be byte swapped by bm_lock_dds()
+		return false;
+#endif
+	case BM_TYPE_DXT1:
+	case BM_TYPE_DXT3:
+	case BM_TYPE_DXT5:
+	case BM_TYPE_CUBEMAP_DXT1:
+	case BM_TYPE_CUBEMAP_DXT3:
+	case BM_TYPE_CUBEMAP_DXT5:
+		return be->mem_taken > 0;
+
+	default:
+		return false;
+	}
+}
+
+/**
+ * Copies what the decoding job needs to know about a bitmap
+ */
+void bm_page_in_prepare(bm_page_in_image *image, int n)
+{
+	bitmap_entry *be = &bm_bitmaps[n];
+	char filename[MAX_FILENAME_LEN];
+
+	EFF_FILENAME_CHECK;
+
+	image->bitmapnum = n;
+	image->handle = be->handle;
+	image->type = (be->type == BM_TYPE_EFF) ? be->info.ani.eff.type : be->type;
+	image->dir_type = (image->type == BM_TYPE_DDS) ? bm_get_dds_source(be, filename) : be->dir_type;
+	strcpy_s(image->filename, filename);
+	image->w = be->bm.w;
+	image->h = be->bm.h;
+	image->mem_taken = be->mem_taken;
+	image->skip_levels = bm_get_dds_skip_levels(be, be->used_flags);
+	image->queued_at = timer_get_milliseconds();
+}
+
+/**
+ * Reads and decodes the image of a bitmap, this runs on a worker thread
+ */
+void bm_page_in_decode(bm_page_in_image *image)
+{
+	bool success;
+
+	if (image->type == BM_TYPE_PNG) {
+		// same as bm_lock_png(), libpng expands everything to 32 bit
+		image->size = (size_t)(image->w * image->h * 4);
+		image->data = (ubyte*)vm_malloc(image->size);
+		memset(image->data, 0, image->size);
+
+		image->bpp = 32;
+		success = png_read_bitmap(image->filename, image->data, &image->bpp, 4, image->dir_type) == PNG_ERROR_NONE;
+	} else {
+		image->size = image->mem_taken;
+		image->data = (ubyte*)vm_malloc(image->size);
+
+		ubyte dds_bpp = 0;
+		success = dds_read_bitmap(image->filename, image->data, &dds_bpp, image->dir_type, image->skip_levels) == DDS_ERROR_NONE;
+		image->bpp = dds_bpp;
+	}
+
+	if (!success) {
+		// bm_lock() will try again and report the error
+		vm_free(image->data);
+		image->data = nullptr;
+	}
+}
+
+/**
+ * Hands the decoded data of a bitmap to its entry so the following bm_lock() doesn't have to load it again
+ *
+ * @return @c true if the entry got the data
+ */
+bool bm_page_in_install(bm_page_in_image *image)
+{
+	if (image->data == nullptr) {
+		return false;
+	}
+
+	bitmap_entry *be = &bm_bitmaps[image->bitmapnum];
+	bitmap *bmp = &be->bm;
+
+	char filename[MAX_FILENAME_LEN];
+
+	EFF_FILENAME_CHECK;
+
+	// the bitmap may have been released, reloaded or loaded some other way in the meantime
+	if ( (be->handle != image->handle) || (be->type == BM_TYPE_NONE) || (bmp->data != 0) || (be->ref_count != 0)
+		|| strcmp(filename, image->filename) )
+	{
+		vm_free(image->data);
+		image->data = nullptr;
+
+		return false;
+	}
+
+#ifdef BMPMAN_NDEBUG
+	Assert(be->data_size == 0);
+	be->data_size += image->size;
+	bm_texture_ram += image->size;
+#endif
+
+	bmp->data = (ptr_u)image->data;
+	bmp->bpp = image->bpp;
+	bmp->flags = 0;
+	bmp->palette = NULL;
+	be->dds_skipped_levels = (image->type == BM_TYPE_PNG) ? 0 : image->skip_levels;
+
+	image->data = nullptr;
+
+	return true;
+}
+
+}
+
 void bm_page_in_stop() {
 	TRACE_SCOPE(tracing::PageInStop);
 
@@ -2597,49 +3242,104 @@ void bm_page_in_stop() {
 
 	int bm_preloading = 1;
 
-	for (i = 0; i < MAX_BITMAPS; i++) {
+	SCP_vector<int> pages;
+	SCP_vector<bool> decode;
+	SCP_vector<int> atlas_candidates;
+
+	for (i = 0; i < bm_bitmaps.size(); i++) {
 		if ((bm_bitmaps[i].type != BM_TYPE_NONE) && (bm_bitmaps[i].type != BM_TYPE_RENDER_TARGET_DYNAMIC) && (bm_bitmaps[i].type != BM_TYPE_RENDER_TARGET_STATIC)) {
 			if (bm_bitmaps[i].preloaded) {
-				TRACE_SCOPE(tracing::PageInSingleBitmap);
-				if (bm_preloading) {
-					if (!gr_preload(bm_bitmaps[i].handle, (bm_bitmaps[i].preloaded == 2))) {
-						mprintf(("Out of VRAM.  Done preloading.\n"));
-						bm_preloading = 0;
-					}
-				} else {
-					bm_lock(bm_bitmaps[i].handle, (bm_bitmaps[i].used_flags == BMP_AABITMAP) ? 8 : 16, bm_bitmaps[i].used_flags);
-					if (bm_bitmaps[i].ref_count >= 1) {
-						bm_unlock( bm_bitmaps[i].handle );
-					}
+				pages.push_back(i);
+				decode.push_back(bm_page_in_can_decode(i));
+
+				// the HUD frames are 8 bit PCX and ANI files
+				if ((bm_bitmaps[i].preloaded == 2) && (bm_bitmaps[i].used_flags == BMP_AABITMAP)
+					&& ((bm_bitmaps[i].type == BM_TYPE_PCX) || (bm_bitmaps[i].type == BM_TYPE_ANI))) {
+					atlas_candidates.push_back(bm_bitmaps[i].handle);
 				}
+			} else {
+				bm_unload_fast(bm_bitmaps[i].handle);
+			}
+		}
+	}
+
+	if (!Is_standalone) {
+		bm_atlas_place(atlas_candidates);
+	}
+
+	// File reading and decoding runs on the job workers while the textures are uploaded here in the original order.
+	// Only a few images are decoded ahead so the decoded data of the whole level never has to be in memory at once.
+	size_t window = std::max(jobs::num_workers() * 2, (size_t)2);
+	std::unique_ptr<bm_page_in_image[]> images(new bm_page_in_image[window]);
+	size_t next_decode = 0;
+
+	for (size_t page = 0; page < pages.size(); page++) {
+		for (; next_decode < pages.size() && next_decode < page + window; next_decode++) {
+			if (!decode[next_decode]) {
+				continue;
+			}
+
+			bm_page_in_image *image = &images[next_decode % window];
+			bm_page_in_prepare(image, pages[next_decode]);
+
+			image->group.run([image]() { bm_page_in_decode(image); }, tracing::PageInDecodeJob);
+		}
 
-				n++;
+		i = pages[page];
 
-				multi_send_anti_timeout_ping();
+		bool installed = false;
+		if (decode[page]) {
+			bm_page_in_image *image = &images[page % window];
 
-				if ((bm_bitmaps[i].info.ani.first_frame == 0) || (bm_bitmaps[i].info.ani.first_frame == i)) {
+			image->group.wait();
+			installed = bm_page_in_install(image);
+		}
+
+		TRACE_SCOPE(tracing::PageInSingleBitmap);
+		if (bm_atlas_copy(bm_bitmaps[i].handle)) {
+			// it is drawn from its atlas page, it doesn't need a texture of its own
+			bm_unload_fast(bm_bitmaps[i].handle);
+		} else if (bm_preloading) {
+			if (!gr_preload(bm_bitmaps[i].handle, (bm_bitmaps[i].preloaded == 2))) {
+				mprintf(("Out of VRAM.  Done preloading.\n"));
+				bm_preloading = 0;
+			} else if (installed) {
+				// the data is normally released once it has been uploaded, make sure it's also gone if the texture
+				// didn't have to be created
+				bm_unload_fast(bm_bitmaps[i].handle);
+			}
+		} else if (!bm_ram_budget_reached()) {
+			bm_lock(bm_bitmaps[i].handle, (bm_bitmaps[i].used_flags == BMP_AABITMAP) ? 8 : 16, bm_bitmaps[i].used_flags);
+			if (bm_bitmaps[i].ref_count >= 1) {
+				bm_unlock( bm_bitmaps[i].handle );
+			}
+		}
+
+		n++;
+
+		multi_send_anti_timeout_ping();
+
+		if ((bm_bitmaps[i].info.ani.first_frame == 0) || (bm_bitmaps[i].info.ani.first_frame == i)) {
 #ifndef NDEBUG
-					memset(busy_text, 0, sizeof(busy_text));
+			memset(busy_text, 0, sizeof(busy_text));
 
-					strcat_s(busy_text, "** BmpMan: ");
-					strcat_s(busy_text, bm_bitmaps[i].filename);
-					strcat_s(busy_text, " **");
+			strcat_s(busy_text, "** BmpMan: ");
+			strcat_s(busy_text, bm_bitmaps[i].filename);
+			strcat_s(busy_text, " **");
 
-					game_busy(busy_text);
+			game_busy(busy_text);
 #else
-					game_busy();
+			game_busy();
 #endif
-				}
-			} else {
-				bm_unload_fast(bm_bitmaps[i].handle);
-			}
 		}
 	}
 
+	bm_atlas_finish();
+
 	nprintf(("BmpInfo", "BMPMAN: Loaded %d bitmaps that are marked as used for this level.\n", n));
 
 	int total_bitmaps = 0;
-	for (i = 0; i < MAX_BITMAPS; i++) {
+	for (i = 0; i < bm_bitmaps.size(); i++) {
 		if (bm_bitmaps[i].type != BM_TYPE_NONE) {
 			total_bitmaps++;
 		}
@@ -2648,11 +3348,182 @@ void bm_page_in_stop() {
 		}
 	}
 
-	mprintf(("Bmpman: %d/%d bitmap slots in use.\n", total_bitmaps, MAX_BITMAPS));
+	mprintf(("Bmpman: %d/%d bitmap slots in use.\n", total_bitmaps, bm_bitmaps.size()));
 
 	Bm_paging = 0;
 }
 
+namespace {
+
+SCP_unordered_map<int, std::unique_ptr<bm_page_in_image>> Bm_stream_requests;
+
+int Bm_stream_loaded = 0;
+
+// a streaming load which isn't done after this time is counted as stalled
+const int BM_STREAM_STALL_TIME = 1000;
+
+}
+
+bool Bm_streaming = true;
+DCF_BOOL(texture_streaming, Bm_streaming);
+
+MONITOR(TexStreamPending)
+MONITOR(TexStreamLoaded)
+MONITOR(TexStreamStalled)
+MONITOR(BitmapsEvicted)
+
+static bool bm_ram_budget_reached() {
+	return (Cmdline_bitmap_ram_budget > 0) && (bm_texture_ram >= (size_t)Cmdline_bitmap_ram_budget * 1024 * 1024);
+}
+
+/**
+ * Releases the data of the unlocked bitmaps which were locked the longest time ago until the bitmap data fits into the
+ * budget set with -bitmap_ram_budget. The data is simply loaded again the next time the bitmap is locked.
+ */
+static void bm_enforce_ram_budget() {
+	if (!bm_ram_budget_reached()) {
+		MONITOR_SET(BitmapsEvicted, 0);
+		return;
+	}
+
+	const size_t budget = (size_t)Cmdline_bitmap_ram_budget * 1024 * 1024;
+
+	SCP_vector<std::pair<int, int>> candidates;
+
+	for (int i = 0; i < bm_bitmaps.size(); i++) {
+		bitmap_entry *be = &bm_bitmaps[i];
+
+		if ((be->bm.data == 0) || (be->ref_count != 0) || (be->type == BM_TYPE_NONE) || (be->type == BM_TYPE_USER)
+			|| (be->type == BM_TYPE_RENDER_TARGET_STATIC) || (be->type == BM_TYPE_RENDER_TARGET_DYNAMIC)) {
+			continue;
+		}
+
+		candidates.emplace_back(be->last_used, i);
+	}
+
+	std::sort(candidates.begin(), candidates.end());
+
+	int evicted = 0;
+
+	for (auto& candidate : candidates) {
+		if (bm_texture_ram <= budget) {
+			break;
+		}
+
+		if (bm_unload_fast(bm_bitmaps[candidate.second].handle) == 1) {
+			++evicted;
+		}
+	}
+
+	MONITOR_SET(BitmapsEvicted, evicted);
+}
+
+bool bm_stream_ready(int handle) {
+	// without any workers the load would only run once the main thread waits for it
+	if (!Bm_streaming || Bm_paging || jobs::num_workers() < 2) {
+		return true;
+	}
+
+	int n = handle % MAX_BITMAPS;
+
+	Assertion(bm_bitmaps[n].handle == handle, "Invalid handle %d passed to bm_stream_ready.\n", handle);
+
+	auto iter = Bm_stream_requests.find(n);
+
+	if (iter != Bm_stream_requests.end()) {
+		bm_page_in_image *image = iter->second.get();
+
+		if (!image->group.done()) {
+			return false;
+		}
+
+		image->group.wait();
+
+		if (bm_page_in_install(image)) {
+			++Bm_stream_loaded;
+		}
+
+		Bm_stream_requests.erase(iter);
+
+		return true;
+	}
+
+	if (!bm_page_in_can_decode(n)) {
+		return true;
+	}
+
+	std::unique_ptr<bm_page_in_image> request(new bm_page_in_image());
+	bm_page_in_image *image = request.get();
+
+	bm_page_in_prepare(image, n);
+	image->group.run([image]() { bm_page_in_decode(image); }, tracing::TextureStreamJob);
+
+	Bm_stream_requests.emplace(n, std::move(request));
+
+	return false;
+}
+
+void bm_stream_frame() {
+	int pending = 0;
+	int stalled = 0;
+	int now = timer_get_milliseconds();
+
+	for (auto iter = Bm_stream_requests.begin(); iter != Bm_stream_requests.end();) {
+		bm_page_in_image *image = iter->second.get();
+
+		if (!image->group.done()) {
+			++pending;
+
+			if (now - image->queued_at > BM_STREAM_STALL_TIME) {
+				++stalled;
+			}
+
+			++iter;
+			continue;
+		}
+
+		// hand the data over right away so it's there once the bitmap is used again
+		image->group.wait();
+
+		if (bm_page_in_install(image)) {
+			++Bm_stream_loaded;
+		}
+
+		iter = Bm_stream_requests.erase(iter);
+	}
+
+	MONITOR_SET(TexStreamPending, pending);
+	MONITOR_SET(TexStreamLoaded, Bm_stream_loaded);
+	MONITOR_SET(TexStreamStalled, stalled);
+
+	for (auto& stream : Bm_anim_streams) {
+		if (stream.second->group.done()) {
+			bm_anim_stream_install(stream.second.get());
+		}
+	}
+
+	MONITOR_SET(AnimStreams, (int)Bm_anim_streams.size());
+
+	Bm_stream_loaded = 0;
+
+	bm_enforce_ram_budget();
+}
+
+static void bm_stream_flush() {
+	Bm_anim_streams.clear();
+
+	for (auto& request : Bm_stream_requests) {
+		request.second->group.wait();
+
+		if (request.second->data != nullptr) {
+			vm_free(request.second->data);
+			request.second->data = nullptr;
+		}
+	}
+
+	Bm_stream_requests.clear();
+}
+
 void bm_page_in_texture(int bitmapnum, int nframes) {
 	int i;
 	int n = bitmapnum % MAX_BITMAPS;
@@ -2781,7 +3652,7 @@ void bm_print_bitmaps() {
 #ifdef BMPMAN_NDEBUG
 	int i;
 
-	for (i = 0; i<MAX_BITMAPS; i++) {
+	for (i = 0; i<bm_bitmaps.size(); i++) {
 		if (bm_bitmaps[i].type != BM_TYPE_NONE) {
 			if (bm_bitmaps[i].data_size) {
 				nprintf(("BMP DEBUG", "BMPMAN = num: %d, name: %s, handle: %d - (%s) size: %.3fM\n", i, bm_bitmaps[i].filename, bm_bitmaps[i].handle, bm_bitmaps[i].data_size ? NOX("*LOCKED*") : NOX(""), ((float)bm_bitmaps[i].data_size / 1024.0f) / 1024.0f));
@@ -2840,6 +3711,8 @@ int bm_release(int handle, int clear_render_targets) {
 	if (bm_is_anim(n) == true) {
 		int i, first = be->info.ani.first_frame, total = bm_bitmaps[first].info.ani.num_frames;
 
+		bm_anim_stream_free(first);
+
 		for (i = 0; i < total; i++) {
 			bm_free_data(first + i, true);		// clears flags, bbp, data, etc
 
@@ -2863,6 +3736,8 @@ int bm_release(int handle, int clear_render_targets) {
 
 			bm_bitmaps[first + i].handle = -1;
 		}
+
+		bm_bitmaps.release(first, total);
 	} else {
 		bm_free_data(n, true);		// clears flags, bbp, data, etc
 
@@ -2885,6 +3760,8 @@ int bm_release(int handle, int clear_render_targets) {
 		bm_bitmaps[n].info.ani.first_frame = -1;
 
 		bm_bitmaps[n].handle = -1;
+
+		bm_bitmaps.release(n, 1);
 	}
 
 	return 1;
@@ -3135,6 +4012,8 @@ int bm_unload(int handle, int clear_render_targets, bool nodebug) {
 		if ((n > be->info.ani.first_frame) && (bm_bitmaps[first].bm.data == 0))
 			return 1;
 
+		bm_anim_stream_free(first);
+
 		for (i = 0; i < bm_bitmaps[first].info.ani.num_frames; i++) {
 			if (!nodebug)
 				nprintf(("BmpMan", "Unloading %s frame %d.  %dx%dx%d\n", be->filename, i, bmp->w, bmp->h, bmp->bpp));
@@ -3156,7 +4035,7 @@ void bm_unload_all() {
 	// safe to ignore load_count's and unload anyway
 	Bm_ignore_load_count = 1;
 
-	for (i = 0; i < MAX_BITMAPS; i++) {
+	for (i = 0; i < bm_bitmaps.size(); i++) {
 		if (bm_bitmaps[i].type != BM_TYPE_NONE) {
 			bm_unload(bm_bitmaps[i].handle, 1);
 		}
@@ -3238,26 +4117,145 @@ void bm_update_memory_used(int n, size_t size)
 
 int find_block_of(int n)
 {
-	int i, cnt = 0, nstart = 0;
-
 	if (n < 1) {
 		Int3();
 		return -1;
 	}
 
-	for (i = 0; i < MAX_BITMAPS; i++) {
-		if (bm_bitmaps[i].type == BM_TYPE_NONE) {
-			if (cnt == 0)
-				nstart = i;
+	int first = bm_bitmaps.find_free(n);
 
-			cnt++;
-		} else {
-			cnt = 0;
+	if (first >= 0) {
+		return first;
+	}
+
+	// a free run at the end of the table only has to be extended by what's missing
+	int num_slots = bm_bitmaps.size();
+	int needed = num_slots + n;
+
+	for (int i = num_slots - 1; (i >= 0) && (bm_bitmaps[i].type == BM_TYPE_NONE); i--) {
+		needed--;
+	}
+
+	if (!bm_bitmaps.grow(needed)) {
+		return -1;
+	}
+
+	for (int i = num_slots; i < bm_bitmaps.size(); i++) {
+		bm_init_slot(i);
+	}
+
+	return bm_bitmaps.find_free(n);
+}
+
+bool bitmap_slot_table::grow(int num_slots)
+{
+	if (num_slots > MAX_BITMAPS) {
+		mprintf(("BMPMAN: Can't add more than %d bitmap slots!\n", MAX_BITMAPS));
+		return false;
+	}
+
+	int first_new = _size;
+
+	while (_size < num_slots) {
+		_chunks[_size / CHUNK_SIZE].reset(new chunk());
+		_size += CHUNK_SIZE;
+	}
+
+	if (_size > first_new) {
+		add_run(first_new, _size - first_new);
+	}
+
+	return true;
+}
+
+int bitmap_slot_table::find_free(int count) const
+{
+	auto run = _runs_by_length.lower_bound(std::make_pair(count, 0));
+
+	if (run == _runs_by_length.end()) {
+		return -1;
+	}
+
+	return run->second;
+}
+
+void bitmap_slot_table::claim(int first, int count)
+{
+	auto run = _free_runs.upper_bound(first);
+
+	Assertion(run != _free_runs.begin(), "Bitmap slot %d is already in use!", first);
+	--run;
+
+	int run_first = run->first;
+	int run_count = run->second;
+
+	Assertion(first + count <= run_first + run_count, "Bitmap slots %d to %d are already in use!", first, first + count - 1);
+
+	remove_run(run);
+
+	if (first > run_first) {
+		add_run(run_first, first - run_first);
+	}
+	if (first + count < run_first + run_count) {
+		add_run(first + count, run_first + run_count - first - count);
+	}
+}
+
+void bitmap_slot_table::release(int first, int count)
+{
+	auto next = _free_runs.lower_bound(first);
+
+	if (next != _free_runs.end() && next->first == first + count) {
+		count += next->second;
+		remove_run(next);
+	}
+
+	auto prev = _free_runs.lower_bound(first);
+
+	if (prev != _free_runs.begin()) {
+		--prev;
+
+		if (prev->first + prev->second == first) {
+			first = prev->first;
+			count += prev->second;
+			remove_run(prev);
 		}
+	}
 
-		if (cnt == n)
-			return nstart;
+	add_run(first, count);
+}
+
+int bitmap_slot_table::next_handle(int first, int count)
+{
+	int generation = 0;
+
+	for (int i = first; i < first + count; i++) {
+		generation = std::max(generation, _chunks[i / CHUNK_SIZE]->generations[i % CHUNK_SIZE]);
 	}
 
-	return -1;
+	generation++;
+
+	// the generation is multiplied with MAX_BITMAPS so it has to wrap before the handle would become negative
+	if (generation >= INT_MAX / MAX_BITMAPS) {
+		generation = 1;
+		mprintf(("BMPMAN: bitmap handles of slot %d wrapped back to 1\n", first));
+	}
+
+	for (int i = first; i < first + count; i++) {
+		_chunks[i / CHUNK_SIZE]->generations[i % CHUNK_SIZE] = generation;
+	}
+
+	return generation * MAX_BITMAPS + first;
+}
+
+void bitmap_slot_table::add_run(int first, int count)
+{
+	_free_runs.emplace(first, count);
+	_runs_by_length.emplace(count, first);
+}
+
+void bitmap_slot_table::remove_run(std::map<int, int>::iterator run)
+{
+	_runs_by_length.erase(std::make_pair(run->second, run->first));
+	_free_runs.erase(run);
 }
@@ -33,19 +33,12 @@
  */
 
 /**
- * @brief How many bitmaps the game can handle
+ * @brief The upper limit of bitmap slots
  *
- * @attention  MAX_BITMAPS shouldn't need to be bumped again.  With the fixed bm_release() and it's proper use even the
- *   largest missions should stay under this number.  With the largest retail missions and wasteful content we should
- *   still have about 20% of the slots free.  If it still goes over then it's something the artists need to fix.
- *   For instance the Terran Mara fighter, with -spec and -glow and using the Shinepack, needs 117 bitmap slots alone.
- *   111 of those is just for the glowmaps.  This number can be greatly reduced if the number of ani frames for another
- *   LOD than LOD0 has fewer or no ani frames.  A 37 frame glow ani for LOD2 is little more than a waste of resources.
- *   Future reports of texture corruption should be initially approached with content as the cause and not code.
- *   If anything we could/should reduce MAX_BITMAPS in the future.  Where it's at now should accomidate even the
- *   largest mods.  --  Taylor
+ * @details Slots are allocated on demand so this doesn't cost any memory. It is also the stride of the slot index
+ * inside a handle so it has to stay well below INT_MAX to leave room for the handle generations.
  */
-#define MAX_BITMAPS 4750
+#define MAX_BITMAPS 65536
 
 // Flag positions for bitmap.flags
 // ***** NOTE:  bitmap.flags is an 8-bit value, no more BMP_TEX_* flags can be added unless the type is changed!! ******
@@ -152,9 +145,14 @@ void bm_close();
 int bm_get_cache_slot(int bitmap_id, int separate_ani_frames);
 
 /**
- * @brief Gets the next available bitmap slot.
+ * @brief Gets a new handle for a run of bitmap slots
+ *
+ * @param first_slot The first slot of the run
+ * @param num_slots The number of slots, the frames of an animation use the returned handle plus their offset
+ *
+ * @returns The handle of the first slot
  */
-int bm_get_next_handle();
+int bm_get_next_handle(int first_slot, int num_slots = 1);
 
 #define BMP_FLAG_RENDER_TARGET_STATIC		(1<<0)
 #define BMP_FLAG_RENDER_TARGET_DYNAMIC		(1<<1)
@@ -387,6 +385,13 @@ int bm_is_valid(int handle);
  */
 int bm_get_info(int handle, int *w = NULL, int * h = NULL, ubyte * flags = NULL, int *nframes = NULL, int *fps = NULL);
 
+/**
+ * @brief Checks if the frames of an animation are shown for different amounts of time
+ *
+ * @returns @c true for animations with a delay per frame like APNGs, @c false for everything else
+ */
+bool bm_has_variable_frame_delays(int handle);
+
 /**
  * @brief Gets the filename of the bitmap indexed by handle
  *
@@ -477,6 +482,30 @@ void bm_page_in_start();
  */
 void bm_page_in_stop();
 
+extern bool Bm_streaming;   //!< Bool type that indicates if bitmaps used outside of paging are loaded in the background
+extern bool Bm_anim_streaming;   //!< Bool type that indicates if big animations only keep a few frames decoded
+
+/**
+ * @brief Checks if the data of a bitmap can be used right away or starts loading it in the background
+ *
+ * Outside of paging, the first use of a bitmap which isn't in memory queues a load on the job workers instead of
+ * reading and decoding it on the main thread. Until that load is done the graphics code uses a placeholder.
+ *
+ * @param handle The bitmap which is about to be locked
+ *
+ * @returns true if the bitmap can be locked now, or
+ * @returns false if its data is still being loaded
+ */
+bool bm_stream_ready(int handle);
+
+/**
+ * @brief Hands finished background loads to their bitmaps, updates the streaming monitors and releases bitmap data
+ * which doesn't fit into the -bitmap_ram_budget anymore
+ *
+ * @note This is called once at the end of every frame
+ */
+void bm_stream_frame();
+
 // Paging code in a library should call these functions
 // in its page in function.
 
@@ -633,6 +662,18 @@ size_t bm_get_size(int handle);
  */
 int bm_get_num_mipmaps(int handle);
 
+/**
+ * @brief Gets where the compressed copy of a bitmap should be written to, see bmpman/texturecache.h
+ *
+ * The target is only handed out once so a bitmap which is uploaded again doesn't get written again.
+ *
+ * @param handle The bitmap
+ * @param[out] cache_filename The name of the copy
+ * @param[out] source_checksum The checksum of the image the copy is made from
+ * @return @c true if the bitmap was loaded from an image which should get a copy but has none yet
+ */
+bool bm_get_texture_cache_target(int handle, char (&cache_filename)[MAX_FILENAME_LEN], uint *source_checksum);
+
 /**
  * @brief Checks to see if the indexed bitmap has an alpha channel
  *
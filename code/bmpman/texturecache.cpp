@@ -0,0 +1,145 @@
+#include "bmpman/texturecache.h"
+
+#include "cmdline/cmdline.h"
+#include "ddsutils/ddsutils.h"
+#include "globalincs/systemvars.h"
+#include "tracing/tracing.h"
+
+#include <cctype>
+
+namespace {
+
+// stored in the reserved part of the DDS header, the DDS loaders skip it
+const uint TEXTURE_CACHE_ID = 0x43545350;	// "PSTC"
+const uint TEXTURE_CACHE_VERSION = 1;
+
+// the names of the copies have to fit into MAX_FILENAME_LEN with the hash of the full name and the extension
+const size_t TEXTURE_CACHE_NAME_LEN = 18;
+
+// where the reserved part starts, after the file code and seven fields of the header
+const int TEXTURE_CACHE_ID_OFFSET = 4 + 7 * 4;
+
+void texture_cache_filename(const char* filename, char (&cache_filename)[MAX_FILENAME_LEN])
+{
+	char name[MAX_FILENAME_LEN];
+	strcpy_s(name, filename);
+
+	auto p = strchr(name, '.');
+	if (p) {
+		*p = '\0';
+	}
+
+	for (auto c = name; *c != '\0'; ++c) {
+		*c = (char)tolower((unsigned char)*c);
+	}
+
+	// the hash keeps names apart which only differ after the truncated part
+	uint hash = cf_add_chksum_long(0, reinterpret_cast<ubyte*>(name), strlen(name));
+
+	if (strlen(name) > TEXTURE_CACHE_NAME_LEN) {
+		name[TEXTURE_CACHE_NAME_LEN] = '\0';
+	}
+
+	sprintf(cache_filename, "%s-%08x.dds", name, hash);
+}
+
+}
+
+bool texture_cache_enabled()
+{
+	return Cmdline_texture_cache && !Is_standalone && Use_compressed_textures;
+}
+
+CFILE* texture_cache_open(const char* filename, CFILE* img_cfp, char (&cache_filename)[MAX_FILENAME_LEN],
+	uint* source_checksum)
+{
+	Assert(img_cfp != nullptr);
+
+	TRACE_SCOPE(tracing::TextureCacheLoad);
+
+	texture_cache_filename(filename, cache_filename);
+
+	*source_checksum = 0;
+	cf_chksum_long(img_cfp, source_checksum);
+
+	auto cfp = cfopen(cache_filename, "rb", CFILE_NORMAL, CF_TYPE_CACHE);
+	if (cfp == nullptr) {
+		return nullptr;
+	}
+
+	bool valid = false;
+
+	if (cfread_int(cfp) == DDS_FILECODE && cfseek(cfp, TEXTURE_CACHE_ID_OFFSET, CF_SEEK_SET) == 0) {
+		auto id = cfread_uint(cfp);
+		auto version = cfread_uint(cfp);
+		auto checksum = cfread_uint(cfp);
+
+		valid = (id == TEXTURE_CACHE_ID) && (version == TEXTURE_CACHE_VERSION) && (checksum == *source_checksum);
+	}
+
+	if (!valid) {
+		nprintf(("TextureCache", "Cached copy of '%s' is out of date.\n", filename));
+		cfclose(cfp);
+		return nullptr;
+	}
+
+	cfseek(cfp, 0, CF_SEEK_SET);
+
+	nprintf(("TextureCache", "Loading '%s' from the cache.\n", filename));
+
+	return cfp;
+}
+
+void texture_cache_save(const char* cache_filename, uint source_checksum, int w, int h, int compression_type,
+	int num_mipmaps, const ubyte* data, size_t size)
+{
+	Assert((compression_type == DDS_DXT1) || (compression_type == DDS_DXT5));
+
+	TRACE_SCOPE(tracing::TextureCacheSave);
+
+	DDSURFACEDESC2 dds_header;
+	memset(&dds_header, 0, sizeof(dds_header));
+
+	int block_size = (compression_type == DDS_DXT1) ? 8 : 16;
+
+	uint flags = (DDSD_CAPS | DDSD_LINEARSIZE | DDSD_PIXELFORMAT | DDSD_WIDTH | DDSD_HEIGHT);
+	uint caps1 = DDSCAPS_TEXTURE;
+
+	if (num_mipmaps > 1) {
+		flags |= DDSD_MIPMAPCOUNT;
+		caps1 |= (DDSCAPS_COMPLEX | DDSCAPS_MIPMAP);
+	}
+
+	dds_header.dwSize				= sizeof(DDSURFACEDESC2);
+	dds_header.dwFlags				= flags;
+	dds_header.dwHeight				= h;
+	dds_header.dwWidth				= w;
+	dds_header.dwPitchOrLinearSize	= ((w + 3) / 4) * ((h + 3) / 4) * block_size;
+	dds_header.dwMipMapCount		= num_mipmaps;
+
+	dds_header.dwReserved1[0]		= TEXTURE_CACHE_ID;
+	dds_header.dwReserved1[1]		= TEXTURE_CACHE_VERSION;
+	dds_header.dwReserved1[2]		= source_checksum;
+
+	dds_header.ddpfPixelFormat.dwSize	= 32;
+	dds_header.ddpfPixelFormat.dwFlags	= DDPF_FOURCC;
+	dds_header.ddpfPixelFormat.dwFourCC	= (compression_type == DDS_DXT1) ? FOURCC_DXT1 : FOURCC_DXT5;
+
+	dds_header.ddsCaps.dwCaps1		= caps1;
+
+	auto cfp = cfopen(cache_filename, "wb", CFILE_NORMAL, CF_TYPE_CACHE);
+	if (cfp == nullptr) {
+		mprintf(("Could not open texture cache file %s!\n", cache_filename));
+		return;
+	}
+
+	uint dds_id = DDS_FILECODE;
+	cfwrite(&dds_id, 1, 4, cfp);
+	cfwrite(&dds_header, 1, sizeof(DDSURFACEDESC2), cfp);
+
+	if ((size_t)cfwrite(data, 1, (int)size, cfp) != size) {
+		mprintf(("Failed to write texture cache file %s!\n", cache_filename));
+	}
+
+	cfclose(cfp);
+}
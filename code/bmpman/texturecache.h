@@ -0,0 +1,53 @@
+#ifndef _TEXTURECACHE_H
+#define _TEXTURECACHE_H
+#pragma once
+
+#include "globalincs/pstypes.h"
+#include "cfile/cfile.h"
+
+/** @file
+ *  Compressed copies of uncompressed images.
+ *
+ *  TGA, PNG and JPG files have to be decoded every time they are loaded and are uploaded without mipmaps. With
+ *  -texture_cache the first upload of such an image as a texture compresses it and its mipmaps to DXT and writes the
+ *  result to the cache directory as a DDS file. Later loads of the same image read that file instead so they neither
+ *  decode the image nor compress it again.
+ *
+ *  A copy is only used if the checksum of the image it was made from matches the file which is loaded, otherwise it
+ *  is replaced by the next upload.
+ */
+
+/**
+ * @brief Checks if the texture cache is used
+ * @return @c true if images should be read from and written to the cache
+ */
+bool texture_cache_enabled();
+
+/**
+ * @brief Opens the compressed copy of an image
+ *
+ * @param filename The name of the image
+ * @param img_cfp The opened image, its position is kept
+ * @param[out] cache_filename The name of the copy in the cache directory, also set if there is no valid copy
+ * @param[out] source_checksum The checksum of the image
+ * @return The copy at its start if there is one made from the same image, @c nullptr otherwise
+ */
+CFILE* texture_cache_open(const char* filename, CFILE* img_cfp, char (&cache_filename)[MAX_FILENAME_LEN],
+	uint* source_checksum);
+
+/**
+ * @brief Writes the compressed copy of an image
+ *
+ * @param cache_filename The name returned by texture_cache_open()
+ * @param source_checksum The checksum returned by texture_cache_open()
+ * @param w The width of the image
+ * @param h The height of the image
+ * @param compression_type DDS_DXT1 or DDS_DXT5
+ * @param num_mipmaps The number of mipmap levels in @a data
+ * @param data The blocks of all mipmap levels, largest first
+ * @param size The size of @a data
+ */
+void texture_cache_save(const char* cache_filename, uint source_checksum, int w, int h, int compression_type,
+	int num_mipmaps, const ubyte* data, size_t size);
+
+#endif // _TEXTURECACHE_H
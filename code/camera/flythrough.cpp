@@ -0,0 +1,123 @@
+#include "camera/camera.h"
+#include "camera/flythrough.h"
+#include "math/vecmat.h"
+#include "object/waypoint.h"
+
+static SCP_vector<vec3d> Flythrough_points;
+static camid Flythrough_camera;
+static float Flythrough_duration = 0.0f;
+static float Flythrough_time = 0.0f;
+
+// how far ahead on the path the camera looks, as a part of the whole path
+#define FLYTHROUGH_LOOK_AHEAD		0.01f
+
+// the point at the given part of the path, a Catmull-Rom spline through all waypoints
+static void flythrough_get_point(vec3d *out, float t)
+{
+	int last = (int)Flythrough_points.size() - 1;
+
+	CLAMP(t, 0.0f, 1.0f);
+
+	float s = t * last;
+	int i = MIN((int)s, last - 1);
+	float u = s - i;
+
+	const vec3d &p0 = Flythrough_points[MAX(i - 1, 0)];
+	const vec3d &p1 = Flythrough_points[i];
+	const vec3d &p2 = Flythrough_points[i + 1];
+	const vec3d &p3 = Flythrough_points[MIN(i + 2, last)];
+
+	float u2 = u * u;
+	float u3 = u2 * u;
+
+	for (int axis = 0; axis < 3; axis++) {
+		out->a1d[axis] = 0.5f * ((2.0f * p1.a1d[axis]) +
+			(p2.a1d[axis] - p0.a1d[axis]) * u +
+			(2.0f * p0.a1d[axis] - 5.0f * p1.a1d[axis] + 4.0f * p2.a1d[axis] - p3.a1d[axis]) * u2 +
+			(3.0f * p1.a1d[axis] - p0.a1d[axis] - 3.0f * p2.a1d[axis] + p3.a1d[axis]) * u3);
+	}
+}
+
+// put the camera where it is at the current time, looking down the path
+static void flythrough_place_camera()
+{
+	float t = Flythrough_time / Flythrough_duration;
+	vec3d pos, ahead, dir;
+	matrix orient;
+
+	flythrough_get_point(&pos, t);
+
+	// at the end of the path look back from a bit before it, so there's always a direction
+	if (t + FLYTHROUGH_LOOK_AHEAD <= 1.0f) {
+		flythrough_get_point(&ahead, t + FLYTHROUGH_LOOK_AHEAD);
+		vm_vec_sub(&dir, &ahead, &pos);
+	} else {
+		flythrough_get_point(&ahead, 1.0f - FLYTHROUGH_LOOK_AHEAD);
+		vm_vec_sub(&dir, &pos, &ahead);
+	}
+
+	camera *cam = Flythrough_camera.getCamera();
+	cam->set_position(&pos);
+
+	if (!IS_VEC_NULL(&dir)) {
+		vm_vector_2_matrix(&orient, &dir, NULL, NULL);
+		cam->set_rotation(&orient);
+	}
+}
+
+bool flythrough_start(float duration)
+{
+	waypoint_list *path = find_matching_waypoint_list(FLYTHROUGH_PATH_NAME);
+
+	if ((path == NULL) && !Waypoint_lists.empty()) {
+		path = &Waypoint_lists.front();
+	}
+
+	Flythrough_points.clear();
+	if (path != NULL) {
+		for (auto &wpt : path->get_waypoints()) {
+			Flythrough_points.push_back(*wpt.get_pos());
+		}
+	}
+
+	if (Flythrough_points.size() < 2) {
+		mprintf(("The flythrough needs a waypoint path with at least two waypoints\n"));
+		Flythrough_points.clear();
+		return false;
+	}
+
+	Flythrough_duration = MAX(duration, 1.0f);
+	Flythrough_time = 0.0f;
+
+	Flythrough_camera = cam_create("Flythrough");
+	flythrough_place_camera();
+	cam_set_camera(Flythrough_camera);
+
+	mprintf(("Flythrough along path '%s' with " SIZE_T_ARG " waypoints for %.1f seconds\n", path->get_name(), Flythrough_points.size(), Flythrough_duration));
+
+	return true;
+}
+
+bool flythrough_do_frame(float frametime)
+{
+	if (Flythrough_points.empty() || !Flythrough_camera.isValid()) {
+		return true;
+	}
+
+	Flythrough_time = MIN(Flythrough_time + frametime, Flythrough_duration);
+	flythrough_place_camera();
+
+	return Flythrough_time >= Flythrough_duration;
+}
+
+void flythrough_stop()
+{
+	camid current = cam_get_current();
+
+	if (Flythrough_camera.isValid() && current.isValid() && (current.getSignature() == Flythrough_camera.getSignature())) {
+		cam_reset_camera();
+	}
+
+	Flythrough_points.clear();
+	Flythrough_camera = camid();
+}
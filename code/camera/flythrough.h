@@ -0,0 +1,20 @@
+#ifndef _FLYTHROUGH_H
+#define _FLYTHROUGH_H
+
+// The flythrough benchmark, see -benchmark_flythrough: a camera flies along a waypoint path of the mission at an even
+// pace while the frame times are recorded.
+
+// the waypoint path the camera follows, the first path of the mission is used if there is none with this name
+#define FLYTHROUGH_PATH_NAME		"Flythrough"
+
+// starts the camera at the beginning of the path, it takes duration seconds to get to the end.
+// returns false if the mission has no path with at least two waypoints
+bool flythrough_start(float duration);
+
+// moves the camera along the path, returns true once it got to the end
+bool flythrough_do_frame(float frametime);
+
+// gives the view back, the camera itself is freed with the other cameras when the mission ends
+void flythrough_stop();
+
+#endif // _FLYTHROUGH_H
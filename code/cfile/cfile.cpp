@@ -31,10 +31,17 @@
 #include "cfile/cfile.h"
 #include "cfile/cfilearchive.h"
 #include "cfile/cfilesystem.h"
+#include "globalincs/jobs.h"
 #include "osapi/osapi.h"
 #include "parse/encrypt.h"
+#include "tracing/StartupProfiler.h"
 
 #include <limits>
+#include <mutex>
+
+#if defined(__ARM_FEATURE_CRC32) && !defined(__ARM_BIG_ENDIAN)
+#include <arm_acle.h>
+#endif
 
 char Cfile_root_dir[CFILE_ROOT_DIRECTORY_LEN] = "";
 char Cfile_user_dir[CFILE_ROOT_DIRECTORY_LEN] = "";
@@ -101,6 +108,27 @@ static char Cfile_stack[CFILE_STACK_MAX][CFILE_ROOT_DIRECTORY_LEN];
 Cfile_block Cfile_block_list[MAX_CFILE_BLOCKS];
 static CFILE Cfile_list[MAX_CFILE_BLOCKS];
 
+// files are also read by job workers so taking and releasing blocks has to be serialized
+static std::mutex Cfile_block_mutex;
+
+// Pack files are mapped into memory once and the packed files inside of them are read straight from that mapping
+struct cf_pack_mapping {
+	SCP_string path;
+	ubyte *data = nullptr;
+	size_t length = 0;
+	int ref_count = 0;
+#ifdef _WIN32
+	HANDLE hInFile = INVALID_HANDLE_VALUE;
+	HANDLE hMapFile = NULL;
+#endif
+};
+
+static SCP_vector<cf_pack_mapping> Pack_mappings;
+static std::mutex Pack_mapping_mutex;
+
+// with a 32-bit address space mapping every pack for the whole session could exhaust the address space
+static const bool Pack_mappings_persistent = sizeof(void*) >= 8;
+
 static const char *Cfile_cdrom_dir = NULL;
 
 //
@@ -109,6 +137,10 @@ static const char *Cfile_cdrom_dir = NULL;
 static int cfget_cfile_block();
 static CFILE *cf_open_fill_cfblock(const char* source, int line, FILE * fp, int type);
 static CFILE *cf_open_packed_cfblock(const char* source, int line, FILE *fp, int type, size_t offset, size_t size);
+static CFILE *cf_open_packed_view(const char* source, int line, const char *pack_path, int type, size_t offset, size_t size);
+static int cf_pack_mapping_acquire(const char *pack_path);
+static void cf_pack_mapping_release(int index);
+static void cf_pack_mapping_close_all();
 
 #if defined _WIN32
 static CFILE *cf_open_mapped_fill_cfblock(const char* source, int line, HANDLE hFile, int type);
@@ -130,10 +162,13 @@ static void dump_opened_files()
 
 void cfile_close()
 {
+	cf_flush_async_writes();
+
 	mprintf(("Still opened files:\n"));
 	dump_opened_files();
 
 	cf_free_secondary_filelist();
+	cf_pack_mapping_close_all();
 
 	cfile_inited = 0;
 }
@@ -186,6 +221,8 @@ static bool cfile_in_root_dir(const char *exe_path)
  */
 int cfile_init(const char *exe_dir, const char *cdrom_dir)
 {
+	TRACE_STARTUP_SCOPE(tracing::CfileInit);
+
 	// initialize encryption
 	encrypt_init();	
 
@@ -487,6 +524,8 @@ int cf_delete(const char *filename, int path_type)
 
 	Assert(CF_TYPE_SPECIFIED(path_type));
 
+	cf_flush_async_writes();
+
 	cf_create_default_path_string(longname, sizeof(longname) - 1,
 	                              path_type, filename);
 
@@ -572,6 +611,8 @@ int cf_rename(const char *old_name, const char *name, int dir_type)
 	int ret_code;
 	char old_longname[_MAX_PATH];
 	char new_longname[_MAX_PATH];
+
+	cf_flush_async_writes();
 	
 	cf_create_default_path_string( old_longname, sizeof(old_longname)-1, dir_type, old_name );
 	cf_create_default_path_string( new_longname, sizeof(old_longname)-1, dir_type, name );
@@ -647,6 +688,98 @@ void cf_create_directory( int dir_type )
 }
 
 
+// the files queued by cf_write_file_async(), a single job writes them one after the other
+struct cf_async_write {
+	SCP_string path;
+	SCP_vector<ubyte> data;
+};
+
+static std::mutex Async_write_mutex;
+static SCP_deque<cf_async_write> Async_writes;
+static bool Async_write_job_running = false;
+static std::atomic<int> Async_writes_pending(0);
+static jobs::job_group Async_write_jobs;
+
+static void cf_write_file_now(const cf_async_write &write)
+{
+	SCP_string temp_path = write.path + ".tmp";
+
+	FILE *fp = fopen(temp_path.c_str(), "wb");
+	if (fp == NULL) {
+		mprintf(("CFILE: Unable to open '%s' for writing!\n", temp_path.c_str()));
+		return;
+	}
+
+	bool ok = write.data.empty() || (fwrite(write.data.data(), 1, write.data.size(), fp) == write.data.size());
+	ok = (fclose(fp) == 0) && ok;
+
+	if (!ok) {
+		mprintf(("CFILE: Unable to write '%s', keeping the old file!\n", temp_path.c_str()));
+		_unlink(temp_path.c_str());
+		return;
+	}
+
+#ifdef _WIN32
+	ok = MoveFileEx(temp_path.c_str(), write.path.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+	ok = rename(temp_path.c_str(), write.path.c_str()) == 0;
+#endif
+
+	if (!ok) {
+		mprintf(("CFILE: Unable to replace '%s' with the new file!\n", write.path.c_str()));
+		_unlink(temp_path.c_str());
+	}
+}
+
+static void cf_async_write_job()
+{
+	for (;;) {
+		cf_async_write write;
+		{
+			std::lock_guard<std::mutex> lock(Async_write_mutex);
+			if (Async_writes.empty()) {
+				Async_write_job_running = false;
+				return;
+			}
+
+			write = std::move(Async_writes.front());
+			Async_writes.pop_front();
+		}
+
+		cf_write_file_now(write);
+		--Async_writes_pending;
+	}
+}
+
+void cf_write_file_async(const char *filename, int dir_type, SCP_vector<ubyte> &&data)
+{
+	Assert( CF_TYPE_SPECIFIED(dir_type) );
+
+	cf_async_write write;
+	cf_create_directory( dir_type );
+	cf_create_default_path_string( write.path, dir_type, filename );
+	write.data = std::move(data);
+
+	std::lock_guard<std::mutex> lock(Async_write_mutex);
+	Async_writes.push_back(std::move(write));
+	++Async_writes_pending;
+
+	if (!Async_write_job_running) {
+		Async_write_job_running = true;
+		Async_write_jobs.run(cf_async_write_job, tracing::FileWriteJob);
+	}
+}
+
+void cf_flush_async_writes()
+{
+	if (Async_writes_pending == 0) {
+		return;
+	}
+
+	Async_write_jobs.wait();
+}
+
+
 extern int game_cd_changed();
 
 // cfopen()
@@ -682,6 +815,8 @@ CFILE *_cfopen(const char* source, int line, const char *file_path, const char *
 	// Check that all the parameters make sense
 	Assert(file_path && strlen(file_path));
 	Assert( mode != NULL );
+
+	cf_flush_async_writes();
 	
 	// Can only open read-only binary files in memory mapped mode.
 	if ( (type & CFILE_MEMORY_MAPPED) && strcmp(mode,"rb") ) {
@@ -771,8 +906,10 @@ CFILE *_cfopen(const char* source, int line, const char *file_path, const char *
 		
 		if ( type & CFILE_MEMORY_MAPPED ) {
 		
-			// Can't open memory mapped files out of pack files
-			if ( offset == 0 )	{
+			if ( offset ) {
+				// Found it in a pack file, this is a view into the mapping of the pack
+				return cf_open_packed_view(source, line, longname, dir_type, offset, size);
+			} else {
 #if defined _WIN32
 				HANDLE hFile;
 
@@ -791,6 +928,14 @@ CFILE *_cfopen(const char* source, int line, const char *file_path, const char *
 
 		} else {
 
+			if ( offset ) {
+				// Found it in a pack file, try to read it from the mapping of the pack first
+				CFILE *cfp = cf_open_packed_view(source, line, longname, dir_type, offset, size);
+				if ( cfp ) {
+					return cfp;
+				}
+			}
+
 			FILE *fp = fopen( longname, "rb" );
 
 			if ( fp )	{
@@ -836,6 +981,14 @@ CFILE *_cfopen_special(const char* source, int line, const char *file_path, cons
 		return NULL;
 	}
 
+	if ( offset ) {
+		// it's in a pack file, try to read it from the mapping of the pack first
+		CFILE *cfp = cf_open_packed_view(source, line, file_path, dir_type, offset, size);
+		if ( cfp ) {
+			return cfp;
+		}
+	}
+
 	// "file_path" should already be a fully qualified path, so just try to open it
 	FILE *fp = fopen( file_path, "rb" );
 
@@ -871,6 +1024,32 @@ CFILE *ctmpfile()
 		return NULL;
 }
 
+CFILE *cfopen_write_buffer(SCP_vector<ubyte> &buffer)
+{
+	int cfile_block_index = cfget_cfile_block();
+	if ( cfile_block_index == -1 ) {
+		return NULL;
+	}
+
+	buffer.clear();
+
+	Cfile_block *cfbp = &Cfile_block_list[cfile_block_index];
+	CFILE *cfp = &Cfile_list[cfile_block_index];
+	cfp->id = cfile_block_index;
+	cfp->version = 0;
+	cfbp->write_buffer = &buffer;
+	cfbp->dir_type = CF_TYPE_INVALID;
+	cfbp->max_read_len = 0;
+	cfbp->lib_offset = 0;
+	cfbp->raw_position = 0;
+	cfbp->size = 0;
+
+	cfbp->source_file = __FILE__;
+	cfbp->line_num = __LINE__;
+
+	return cfp;
+}
+
 
 
 // cfget_cfile_block() will try to find an empty Cfile_block structure in the
@@ -884,11 +1063,15 @@ static int cfget_cfile_block()
 	int i;
 	Cfile_block *cb;
 
+	std::lock_guard<std::mutex> lock(Cfile_block_mutex);
+
 	for ( i = 0; i < MAX_CFILE_BLOCKS; i++ ) {
 		cb = &Cfile_block_list[i];
 		if ( cb->type == CFILE_BLOCK_UNUSED ) {
 			cb->data = NULL;
+			cb->write_buffer = NULL;
 			cb->fp = NULL;
+			cb->pack_mapping = -1;
 			cb->type = CFILE_BLOCK_USED;
 			return i;
 		}
@@ -922,7 +1105,10 @@ int cfclose( CFILE * cfile )
 	cb = &Cfile_block_list[cfile->id];	
 
 	result = 0;
-	if ( cb->data ) {
+	if ( cb->pack_mapping >= 0 ) {
+		// view into a mapped pack file, the mapping is shared with the other files of the pack
+		cf_pack_mapping_release(cb->pack_mapping);
+	} else if ( cb->data ) {
 		// close memory mapped file
 #if defined _WIN32
 		result = UnmapViewOfFile((void*)cb->data);
@@ -945,9 +1131,12 @@ int cfclose( CFILE * cfile )
 		Assert(cb->fp != NULL);
 		result = fclose(cb->fp);
 	} else {
-		// VP  do nothing
+		// VP or write buffer, do nothing
 	}
 
+	cb->write_buffer = NULL;
+
+	std::lock_guard<std::mutex> lock(Cfile_block_mutex);
 	cb->type = CFILE_BLOCK_UNUSED;
 	return result;
 }
@@ -1053,6 +1242,205 @@ static CFILE *cf_open_packed_cfblock(const char* source, int line, FILE *fp, int
 
 
 
+// cf_pack_mapping_acquire() maps a pack file into memory or reuses the existing mapping of it
+//
+// returns:   success ==> index in Pack_mappings[]
+//            failure ==> -1
+//
+static int cf_pack_mapping_acquire(const char *pack_path)
+{
+	std::lock_guard<std::mutex> lock(Pack_mapping_mutex);
+
+	int free_index = -1;
+	for (int i = 0; i < (int)Pack_mappings.size(); i++) {
+		auto& mapping = Pack_mappings[i];
+
+		if (mapping.data == nullptr) {
+			if (free_index < 0) {
+				free_index = i;
+			}
+		} else if (!stricmp(mapping.path.c_str(), pack_path)) {
+			mapping.ref_count++;
+			return i;
+		}
+	}
+
+	cf_pack_mapping mapping;
+	mapping.path = pack_path;
+
+#if defined _WIN32
+	mapping.hInFile = CreateFile(pack_path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (mapping.hInFile == INVALID_HANDLE_VALUE) {
+		return -1;
+	}
+
+	LARGE_INTEGER file_size;
+	if (!GetFileSizeEx(mapping.hInFile, &file_size) || file_size.QuadPart <= 0
+		|| (ULONGLONG)file_size.QuadPart > (ULONGLONG)std::numeric_limits<size_t>::max()) {
+		CloseHandle(mapping.hInFile);
+		return -1;
+	}
+	mapping.length = (size_t)file_size.QuadPart;
+
+	mapping.hMapFile = CreateFileMapping(mapping.hInFile, NULL, PAGE_READONLY, 0, 0, NULL);
+	if (mapping.hMapFile == NULL) {
+		CloseHandle(mapping.hInFile);
+		return -1;
+	}
+
+	mapping.data = (ubyte*)MapViewOfFile(mapping.hMapFile, FILE_MAP_READ, 0, 0, 0);
+	if (mapping.data == nullptr) {
+		CloseHandle(mapping.hMapFile);
+		CloseHandle(mapping.hInFile);
+		return -1;
+	}
+#elif defined SCP_UNIX
+	FILE *fp = fopen(pack_path, "rb");
+	if (fp == NULL) {
+		return -1;
+	}
+
+	struct stat buf;
+	if (fstat(fileno(fp), &buf) != 0 || buf.st_size <= 0
+		|| (unsigned long long)buf.st_size > (unsigned long long)std::numeric_limits<size_t>::max()) {
+		fclose(fp);
+		return -1;
+	}
+	mapping.length = (size_t)buf.st_size;
+
+	void *data = mmap(NULL, mapping.length, PROT_READ, MAP_SHARED, fileno(fp), 0);
+
+	// the mapping stays valid after the file has been closed
+	fclose(fp);
+
+	if (data == MAP_FAILED) {
+		return -1;
+	}
+	mapping.data = (ubyte*)data;
+#endif
+
+	mapping.ref_count = 1;
+
+	if (free_index < 0) {
+		free_index = (int)Pack_mappings.size();
+		Pack_mappings.push_back(mapping);
+	} else {
+		Pack_mappings[free_index] = mapping;
+	}
+
+	nprintf(("CFileDebug", "Mapped pack file %s (" SIZE_T_ARG " bytes)\n", pack_path, mapping.length));
+
+	return free_index;
+}
+
+static void cf_pack_mapping_unmap(cf_pack_mapping& mapping)
+{
+	if (mapping.data == nullptr) {
+		return;
+	}
+
+#if defined _WIN32
+	UnmapViewOfFile(mapping.data);
+	CloseHandle(mapping.hMapFile);
+	CloseHandle(mapping.hInFile);
+	mapping.hMapFile = NULL;
+	mapping.hInFile = INVALID_HANDLE_VALUE;
+#elif defined SCP_UNIX
+	munmap(mapping.data, mapping.length);
+#endif
+
+	mapping.data = nullptr;
+	mapping.length = 0;
+	mapping.path.clear();
+}
+
+// cf_pack_mapping_release() drops one reference of a pack mapping. The pack stays mapped for the rest of the session
+// unless the address space is too small for that.
+static void cf_pack_mapping_release(int index)
+{
+	std::lock_guard<std::mutex> lock(Pack_mapping_mutex);
+
+	Assert(index >= 0 && index < (int)Pack_mappings.size());
+	auto& mapping = Pack_mappings[index];
+
+	Assert(mapping.ref_count > 0);
+	mapping.ref_count--;
+
+	if (mapping.ref_count == 0 && !Pack_mappings_persistent) {
+		cf_pack_mapping_unmap(mapping);
+	}
+}
+
+static void cf_pack_mapping_close_all()
+{
+	std::lock_guard<std::mutex> lock(Pack_mapping_mutex);
+
+	for (auto& mapping : Pack_mappings) {
+		Assertion(mapping.ref_count == 0, "Pack file %s is still used by an open file!", mapping.path.c_str());
+		cf_pack_mapping_unmap(mapping);
+	}
+
+	Pack_mappings.clear();
+}
+
+// cf_open_packed_view() will fill up a Cfile_block element in the Cfile_block_list[] array for a packed file which is
+// read directly from the memory mapping of its pack file
+//
+// returns:   success ==> ptr to CFILE structure.
+//            error   ==> NULL, the caller may fall back to cf_open_packed_cfblock()
+//
+static CFILE *cf_open_packed_view(const char* source, int line, const char *pack_path, int type, size_t offset, size_t size)
+{
+	int mapping_index = cf_pack_mapping_acquire(pack_path);
+	if ( mapping_index < 0 ) {
+		return NULL;
+	}
+
+	ubyte *data;
+	{
+		std::lock_guard<std::mutex> lock(Pack_mapping_mutex);
+		auto& mapping = Pack_mappings[mapping_index];
+
+		if ( offset > mapping.length || size > mapping.length - offset ) {
+			// the pack was changed since its index was read
+			data = NULL;
+		} else {
+			data = mapping.data + offset;
+		}
+	}
+
+	if ( data == NULL ) {
+		cf_pack_mapping_release(mapping_index);
+		return NULL;
+	}
+
+	int cfile_block_index = cfget_cfile_block();
+	if ( cfile_block_index == -1 ) {
+		cf_pack_mapping_release(mapping_index);
+		return NULL;
+	}
+
+	CFILE *cfp;
+	Cfile_block *cfbp;
+	cfbp = &Cfile_block_list[cfile_block_index];
+
+	cfp = &Cfile_list[cfile_block_index];
+	cfp->id = cfile_block_index;
+	cfp->version = 0;
+	cfbp->data = data;
+	cfbp->fp = NULL;
+	cfbp->pack_mapping = mapping_index;
+	cfbp->dir_type = type;
+	cfbp->max_read_len = 0;
+
+	cfbp->source_file = source;
+	cfbp->line_num = line;
+
+	cf_init_lowlevel_read_code(cfp, offset, size, 0);
+
+	return cfp;
+}
+
 // cf_open_mapped_fill_cfblock() will fill up a Cfile_block element in the Cfile_block_list[] array
 // for the case of a file being opened by cf_open_mapped();
 //
@@ -1091,7 +1479,6 @@ static CFILE *cf_open_mapped_fill_cfblock(const char* source, int line, FILE *fp
 		cfbp->source_file = source;
 		cfbp->line_num = line;
 
-		cf_init_lowlevel_read_code(cfp, 0, 0, 0 );
 #if defined _WIN32
 		cfbp->hMapFile = CreateFileMapping(cfbp->hInFile, NULL, PAGE_READONLY, 0, 0, NULL);
 		if (cfbp->hMapFile == NULL) { 
@@ -1101,6 +1488,8 @@ static CFILE *cf_open_mapped_fill_cfblock(const char* source, int line, FILE *fp
 	
 		cfbp->data = (ubyte*)MapViewOfFile(cfbp->hMapFile, FILE_MAP_READ, 0, 0, 0);
 		Assert( cfbp->data != NULL );		
+
+		cf_init_lowlevel_read_code(cfp, 0, GetFileSize(cfbp->hInFile, NULL), 0 );
 #elif defined SCP_UNIX
 		cfbp->fp = fp;
 		cfbp->data_length = filelength( fileno(fp) );
@@ -1111,6 +1500,8 @@ static CFILE *cf_open_mapped_fill_cfblock(const char* source, int line, FILE *fp
 								fileno(fp),				// fd
 								0);						// offset
 		Assert( cfbp->data != NULL );		
+
+		cf_init_lowlevel_read_code(cfp, 0, cfbp->data_length, 0 );
 #endif
 
 		return cfp;
@@ -1125,7 +1516,8 @@ int cf_get_dir_type(CFILE *cfile)
 // cf_returndata() returns the data pointer for a memory-mapped file that is associated
 // with the CFILE structure passed as a parameter
 //
-// 
+// This also works for packed files which are read from the mapping of their pack file,
+// the pointer then points to the start of the packed file and is valid until the file is closed.
 
 void *cf_returndata(CFILE *cfile)
 {
@@ -1417,10 +1809,7 @@ int cfilelength( CFILE * cfile )
 	Assert(cfile->id >= 0 && cfile->id < MAX_CFILE_BLOCKS);
 	cb = &Cfile_block_list[cfile->id];	
 
-	// TODO: return length of memory mapped file
-	Assert( !cb->data );
-
-	Assert(cb->fp != NULL);
+	Assert(cb->fp != NULL || cb->data != NULL || cb->write_buffer != NULL);
 
 	// cb->size gets set at cfopen
 	
@@ -1460,6 +1849,21 @@ int cfwrite(const void *buf, int elsize, int nelem, CFILE *cfile)
 	size_t bytes_written = 0;
 	size_t size = elsize * nelem;
 
+	if (cb->write_buffer != NULL) {
+		auto &buffer = *cb->write_buffer;
+
+		// may overwrite what is already there after seeking back
+		if (cb->raw_position + size > buffer.size()) {
+			buffer.resize(cb->raw_position + size);
+		}
+		memcpy(buffer.data() + cb->raw_position, buf, size);
+
+		cb->raw_position += size;
+		cb->size = buffer.size();
+
+		return nelem;
+	}
+
 	bytes_written = fwrite(buf, 1, size, cb->fp);
 
 	//WMC - update filesize and position
@@ -1630,14 +2034,17 @@ char *cfgets(char *buf, int n, CFILE *cfile)
 // CRC code for mission validation.  given to us by Kevin Bentley on 7/20/98.   Some sort of
 // checksumming code that he wrote a while ago.  
 #define CRC32_POLYNOMIAL					0xEDB88320
-static uint CRCTable[256];
 
-#define CF_CHKSUM_SAMPLE_SIZE				512
+// CRCTable[0] is the table of the usual byte at a time CRC, CRCTable[n] advances the CRC of a byte by another n zero
+// bytes so eight bytes can be added at once
+static uint CRCTable[8][256];
+
+#define CF_CHKSUM_SAMPLE_SIZE				65536
 
 // update cur_chksum with the chksum of the new_data of size new_data_size
-ushort cf_add_chksum_short(ushort seed, ubyte *buffer, int size)
+ushort cf_add_chksum_short(ushort seed, const ubyte *buffer, int size)
 {
-	ubyte *ptr = buffer;
+	const ubyte *ptr = buffer;
 	uint sum1, sum2;
 
 	sum1 = sum2 = (int)(seed);
@@ -1653,16 +2060,45 @@ ushort cf_add_chksum_short(ushort seed, ubyte *buffer, int size)
 }
 
 // update cur_chksum with the chksum of the new_data of size new_data_size
-uint cf_add_chksum_long(uint seed, ubyte *buffer, size_t size)
+// NOTE: the x86 crc32 instruction uses a different polynomial, only the ARMv8 one gives the same checksums
+uint cf_add_chksum_long(uint seed, const ubyte *buffer, size_t size)
 {
 	uint crc;
-	ubyte *p;
+	const ubyte *p;
 
 	p = buffer;
 	crc = seed;	
 
+#if defined(__ARM_FEATURE_CRC32) && !defined(__ARM_BIG_ENDIAN)
+	while (size >= 8) {
+		uint64_t data;
+		memcpy(&data, p, sizeof(data));
+
+		crc = __crc32d(crc, data);
+
+		p += 8;
+		size -= 8;
+	}
+
 	while (size--)
-		crc = (crc >> 8) ^ CRCTable[(crc ^ *p++) & 0xff];
+		crc = __crc32b(crc, *p++);
+#else
+	// slicing by 8, the bytes are put together by hand so it doesn't depend on the byte order
+	while (size >= 8) {
+		uint low = crc ^ ((uint)p[0] | ((uint)p[1] << 8) | ((uint)p[2] << 16) | ((uint)p[3] << 24));
+		uint high = (uint)p[4] | ((uint)p[5] << 8) | ((uint)p[6] << 16) | ((uint)p[7] << 24);
+
+		crc = CRCTable[7][low & 0xff] ^ CRCTable[6][(low >> 8) & 0xff] ^ CRCTable[5][(low >> 16) & 0xff]
+			^ CRCTable[4][low >> 24] ^ CRCTable[3][high & 0xff] ^ CRCTable[2][(high >> 8) & 0xff]
+			^ CRCTable[1][(high >> 16) & 0xff] ^ CRCTable[0][high >> 24];
+
+		p += 8;
+		size -= 8;
+	}
+
+	while (size--)
+		crc = (crc >> 8) ^ CRCTable[0][(crc ^ *p++) & 0xff];
+#endif
 
 	return crc;
 }
@@ -1682,7 +2118,13 @@ static void cf_chksum_long_init()
 				crc >>= 1;
 		}
 
-		CRCTable[i] = crc;
+		CRCTable[0][i] = crc;
+	}
+
+	for (i = 0; i < 256; i++) {
+		for (j = 1; j < 8; j++) {
+			CRCTable[j][i] = (CRCTable[j - 1][i] >> 8) ^ CRCTable[0][CRCTable[j - 1][i] & 0xff];
+		}
 	}
 }
 
@@ -1690,7 +2132,8 @@ static void cf_chksum_long_init()
 // NOTE : only one of chk_short or chk_long must be non-NULL (indicating which checksum to perform)
 static int cf_chksum_do(CFILE *cfile, ushort *chk_short, uint *chk_long, int max_size)
 {
-	ubyte cf_buffer[CF_CHKSUM_SAMPLE_SIZE];
+	SCP_vector<ubyte> cf_buffer;
+	const ubyte *data;
 	int is_long;
 	int cf_len = 0;
 	int cf_total;
@@ -1722,8 +2165,9 @@ static int cf_chksum_do(CFILE *cfile, ushort *chk_short, uint *chk_long, int max
 			read_size = max_size - cf_total;
 		}
 
-		// read in some buffer
-		cf_len = cfread(cf_buffer, 1, read_size, cfile);
+		// read in some buffer, files in memory are checksummed where they are
+		cf_len = read_size;
+		data = cfread_view(cfile, &cf_len, cf_buffer);
 
 		// total we've read so far
 		cf_total += cf_len;
@@ -1732,9 +2176,9 @@ static int cf_chksum_do(CFILE *cfile, ushort *chk_short, uint *chk_long, int max
 		if(cf_len > 0){
 			// do the proper short or long checksum
 			if(is_long){
-				*chk_long = cf_add_chksum_long(*chk_long, cf_buffer, cf_len);
+				*chk_long = cf_add_chksum_long(*chk_long, data, cf_len);
 			} else {
-				*chk_short = cf_add_chksum_short(*chk_short, cf_buffer, cf_len);
+				*chk_short = cf_add_chksum_short(*chk_short, data, cf_len);
 			}
 		}
 	} while((cf_len > 0) && (cf_total < max_size));
@@ -1748,27 +2192,31 @@ int cf_chksum_pack(const char *filename, uint *chk_long, bool full)
 	const size_t safe_size = 2097152; // 2 Meg
 	const int header_offset = 32;  // skip 32bytes for header (header is currently smaller than this though)
 
-	ubyte cf_buffer[CF_CHKSUM_SAMPLE_SIZE];
 	size_t read_size;
 	size_t max_size;
+	size_t file_size;
 
 	if (chk_long == NULL) {
 		Int3();
 		return 0;
 	}
 
+	*chk_long = 0;
+
+	// reading all of a large pack takes a while, so the checksums are kept until the pack changes
+	if (cf_pack_chksum_cache_find(filename, full, chk_long)) {
+		return 1;
+	}
+
 	FILE *fp = fopen(filename, "rb");
 
 	if (fp == NULL) {
-		*chk_long = 0;
 		return 0;
 	}
 
-	*chk_long = 0;
-
 	// get the max size
 	fseek(fp, 0, SEEK_END);
-	max_size = (size_t)ftell(fp);
+	file_size = max_size = (size_t)ftell(fp);
 
 	// maybe do a chksum of the entire file
 	if (full) {
@@ -1787,28 +2235,59 @@ int cf_chksum_pack(const char *filename, uint *chk_long, bool full)
 		fseek(fp, -((long)max_size), SEEK_END);
 	}
 
-	size_t cf_total = 0;
-	size_t cf_len = 0;
-	do {
-		// determine how much we want to read
-		if ( (max_size - cf_total) >= CF_CHKSUM_SAMPLE_SIZE )
-			read_size = CF_CHKSUM_SAMPLE_SIZE;
-		else
-			read_size = max_size - cf_total;
+	uint chksum = 0;
+	bool mapped = false;
 
-		// read in some buffer
-		cf_len = fread(cf_buffer, 1, read_size, fp);
+	// the checksum is taken straight from the mapping of the pack if it can be mapped
+	int mapping_index = cf_pack_mapping_acquire(filename);
+	if (mapping_index >= 0) {
+		const ubyte *data = NULL;
+		{
+			std::lock_guard<std::mutex> lock(Pack_mapping_mutex);
+			auto& mapping = Pack_mappings[mapping_index];
 
-		// total we've read so far
-		cf_total += cf_len;
+			if (mapping.length == file_size) {
+				data = mapping.data + (file_size - max_size);
+			}
+		}
 
-		// add the checksum
-		if (cf_len > 0)
-			*chk_long = cf_add_chksum_long((*chk_long), cf_buffer, cf_len);
-	} while ( (cf_len > 0) && (cf_total < max_size) );
+		if (data != NULL) {
+			chksum = cf_add_chksum_long(0, data, max_size);
+			mapped = true;
+		}
+
+		cf_pack_mapping_release(mapping_index);
+	}
+
+	if ( !mapped ) {
+		SCP_vector<ubyte> cf_buffer(CF_CHKSUM_SAMPLE_SIZE);
+
+		size_t cf_total = 0;
+		size_t cf_len = 0;
+		do {
+			// determine how much we want to read
+			if ( (max_size - cf_total) >= CF_CHKSUM_SAMPLE_SIZE )
+				read_size = CF_CHKSUM_SAMPLE_SIZE;
+			else
+				read_size = max_size - cf_total;
+
+			// read in some buffer
+			cf_len = fread(cf_buffer.data(), 1, read_size, fp);
+
+			// total we've read so far
+			cf_total += cf_len;
+
+			// add the checksum
+			if (cf_len > 0)
+				chksum = cf_add_chksum_long(chksum, cf_buffer.data(), cf_len);
+		} while ( (cf_len > 0) && (cf_total < max_size) );
+	}
 
 	fclose(fp);
 
+	*chk_long = chksum;
+	cf_pack_chksum_cache_store(filename, full, chksum);
+
 	return 1;
 }
 // get the 2 byte checksum of the passed filename - return 0 if operation failed, 1 if succeeded
@@ -1926,6 +2405,11 @@ int cflush(CFILE *cfile)
 	// not supported for memory mapped files
 	Assert( !cb->data );
 
+	// nothing to flush when writing into memory
+	if (cb->write_buffer != NULL) {
+		return 0;
+	}
+
 	Assert(cb->fp != NULL);
 
 	int result = fflush(cb->fp);
@@ -98,13 +98,13 @@ typedef struct {
 #define cfwrite_fix(i,file) cfwrite_int(i,file)
 
 // callback function used for get_file_list() to filter files to be added to list.  Return 1
-// to add file to list, or 0 to not add it.
-extern int (*Get_file_list_filter)(const char *filename);
+// to add file to list, or 0 to not add it. It is kept per thread and cf_get_file_list() resets it after use.
+extern SCP_THREAD_LOCAL int (*Get_file_list_filter)(const char *filename);
 
 // extra check for child directory under CF_TYPE_*
 // NOTE: if specified cf_get_file_list() will not search pack files!
 // NOTE: specified string must not contain ':' or spaces or begin with DIR_SEPARATOR!
-extern const char *Get_file_list_child;
+extern SCP_THREAD_LOCAL const char *Get_file_list_child;
 
 // cfile directory. valid after cfile_init() returns successfully
 #define CFILE_ROOT_DIRECTORY_LEN			256
@@ -174,6 +174,17 @@ int cf_exists_full_ext(const char *filename, int dir_type, const int num_ext, co
 // ctmpfile() opens a temporary file stream.  File is deleted automatically when closed
 CFILE *ctmpfile();
 
+// opens a file which is written into buffer instead of to disk, the buffer has to stay valid until the file is closed
+CFILE *cfopen_write_buffer(SCP_vector<ubyte> &buffer);
+
+// Writes data to the file in the directory of dir_type on a background thread. The data goes to a temporary file
+// first which then replaces the file, so the file is never left half written. The writes happen in the order they
+// were queued, and opening, listing, renaming or deleting files waits until the queued ones are done.
+void cf_write_file_async(const char *filename, int dir_type, SCP_vector<ubyte> &&data);
+
+// waits until all files queued with cf_write_file_async() have been written
+void cf_flush_async_writes();
+
 // Closes the file
 int cfclose(CFILE *cfile);
 
@@ -186,6 +197,9 @@ int cfilelength(CFILE *fp);
 // Reads data
 int cfread(void *buf, int elsize, int nelem, CFILE *fp);
 
+// Gets the next len bytes of a file in one piece and moves past them, see cfile/cfilereader.h for decoding them
+const ubyte *cfread_view(CFILE *fp, int *len, SCP_vector<ubyte> &buffer);
+
 // cfwrite() writes to the file
 int cfwrite(const void *buf, int elsize, int nelem, CFILE *cfile);
 
@@ -236,10 +250,10 @@ int cf_chksum_pack(const char *filename, uint *chk_long, bool full = false);
 // convenient for misc checksumming purposes ------------------------------------------
 
 // update cur_chksum with the chksum of the new_data of size new_data_size
-ushort cf_add_chksum_short(ushort seed, ubyte *buffer, int size);
+ushort cf_add_chksum_short(ushort seed, const ubyte *buffer, int size);
 
 // update cur_chksum with the chksum of the new_data of size new_data_size
-uint cf_add_chksum_long(uint seed, ubyte *buffer, size_t size);
+uint cf_add_chksum_long(uint seed, const ubyte *buffer, size_t size);
 
 // convenient for misc checksumming purposes ------------------------------------------
 
@@ -14,6 +14,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
+#include <ctype.h>
 
 #ifdef _WIN32
 #include <io.h>
@@ -46,7 +47,8 @@ void cf_init_lowlevel_read_code( CFILE * cfile, size_t lib_offset, size_t size,
 	cb->raw_position = pos;
 	cb->size = size;
 
-	if ( cb->fp )	{
+	// memory mapped files are read straight from their data, the file pointer isn't moved for them
+	if ( cb->fp && !cb->data )	{
 		if ( cb->lib_offset )	{
 			fseek( cb->fp, (long)cb->lib_offset, SEEK_SET );
 		}
@@ -78,14 +80,13 @@ int cfeof(CFILE *cfile)
 
 	result = 0;
 
-	// cfeof() not supported for memory-mapped files
-	Assert( !cb->data );
-
-	Assert(cb->fp != NULL);
+	Assert(cb->fp != NULL || cb->data != NULL || cb->write_buffer != NULL);
 
 	#if defined(CHECK_POSITION) && !defined(NDEBUG)
-	auto raw_position = ftell(cb->fp) - cb->lib_offset;
-	Assert(raw_position == cb->raw_position);
+	if ( cb->fp != NULL && !cb->data ) {
+		auto raw_position = ftell(cb->fp) - cb->lib_offset;
+		Assert(raw_position == cb->raw_position);
+	}
 	#endif
 		
 	if (cb->raw_position >= cb->size ) {
@@ -109,14 +110,13 @@ int cftell( CFILE * cfile )
 	Assert(cfile->id >= 0 && cfile->id < MAX_CFILE_BLOCKS);
 	cb = &Cfile_block_list[cfile->id];	
 
-	// Doesn't work for memory mapped files
-	Assert( !cb->data );
-
-	Assert(cb->fp != NULL);
+	Assert(cb->fp != NULL || cb->data != NULL || cb->write_buffer != NULL);
 
 	#if defined(CHECK_POSITION) && !defined(NDEBUG)
-	auto raw_position = ftell(cb->fp) - cb->lib_offset;
-	Assert(raw_position == cb->raw_position);
+	if ( cb->fp != NULL && !cb->data ) {
+		auto raw_position = ftell(cb->fp) - cb->lib_offset;
+		Assert(raw_position == cb->raw_position);
+	}
 	#endif
 
 	// The rest of the code still uses ints, do an overflow check to detect cases where this fails
@@ -140,9 +140,7 @@ int cfseek( CFILE *cfile, int offset, int where )
 	cb = &Cfile_block_list[cfile->id];	
 
 
-	// TODO: seek to offset in memory mapped file
-	Assert( !cb->data );
-	Assert( cb->fp != NULL );
+	Assert( cb->fp != NULL || cb->data != NULL || cb->write_buffer != NULL );
 	
 	size_t goal_position;
 
@@ -166,14 +164,19 @@ int cfseek( CFILE *cfile, int offset, int where )
 	// Make sure we don't seek beyond the end of the file
 	CAP(goal_position, cb->lib_offset, cb->lib_offset + cb->size);
 
-	int result = fseek(cb->fp, (long)goal_position, SEEK_SET );
+	int result = 0;
+	if ( !cb->data && !cb->write_buffer ) {
+		result = fseek(cb->fp, (long)goal_position, SEEK_SET );
+	}
 	Assertion(goal_position >= cb->lib_offset, "Invalid offset values detected while seeking! Goal was " SIZE_T_ARG ", lib_offset is " SIZE_T_ARG ".", goal_position, cb->lib_offset);
 	cb->raw_position = goal_position - cb->lib_offset;
 	Assertion(cb->raw_position <= cb->size, "Invalid raw_position value detected!");
 
 	#if defined(CHECK_POSITION) && !defined(NDEBUG)
-	auto tmp_offset = ftell(cb->fp) - cb->lib_offset;
-	Assert(tmp_offset==cb->raw_position);
+	if ( cb->fp != NULL && !cb->data ) {
+		auto tmp_offset = ftell(cb->fp) - cb->lib_offset;
+		Assert(tmp_offset==cb->raw_position);
+	}
 	#endif
 
 	return result;	
@@ -197,13 +200,6 @@ int cfread(void *buf, int elsize, int nelem, CFILE *cfile)
 
 	Cfile_block *cb = &Cfile_block_list[cfile->id];	
 
-	// cfread() not supported for memory-mapped files
-	if(cb->data != NULL)
-	{
-		Warning(LOCATION, "Writing is not supported for mem-mapped files");
-		return 0;
-	}
-
 	if ( (cb->raw_position+size) > cb->size ) {
 		Assertion(cb->raw_position <= cb->size, "Invalid raw_position value detected!");
 		size = cb->size - cb->raw_position;
@@ -222,21 +218,71 @@ int cfread(void *buf, int elsize, int nelem, CFILE *cfile)
 		}
 	}
 
-	size_t bytes_read = fread( buf, 1, size, cb->fp );
+	size_t bytes_read;
+	if ( cb->data ) {
+		// memory mapped files and files read from a mapped pack are copied straight out of the mapping
+		memcpy( buf, (const ubyte*)cb->data + cb->raw_position, size );
+		bytes_read = size;
+	} else {
+		bytes_read = fread( buf, 1, size, cb->fp );
+	}
 	if ( bytes_read > 0 )	{
 		cb->raw_position += bytes_read;
 		Assertion(cb->raw_position <= cb->size, "Invalid raw_position value detected!");
 	}		
 
 	#if defined(CHECK_POSITION) && !defined(NDEBUG)
-	auto tmp_offset = ftell(cb->fp) - cb->lib_offset;
-	Assert(tmp_offset==cb->raw_position);
+	if ( cb->fp != NULL && !cb->data ) {
+		auto tmp_offset = ftell(cb->fp) - cb->lib_offset;
+		Assert(tmp_offset==cb->raw_position);
+	}
 	#endif
 
 	return (int)(bytes_read / elsize);
 
 }
 
+// cfread_view() gets the next 'len' bytes of a file in one piece and moves past them
+//
+// Files which are mapped into memory, like the ones in a mapped pack, aren't copied: the view points into the
+// mapping.  Other files are read into 'buffer' with a single read.  The view stays valid until the file is closed or
+// 'buffer' is changed.
+//
+// returns:   the bytes, 'len' is reduced to what is left of the file if that is less
+//
+const ubyte *cfread_view(CFILE *cfile, int *len, SCP_vector<ubyte> &buffer)
+{
+	if(!cf_is_valid(cfile) || *len <= 0) {
+		*len = 0;
+		return NULL;
+	}
+
+	Cfile_block *cb = &Cfile_block_list[cfile->id];
+
+	Assertion(cb->raw_position <= cb->size, "Invalid raw_position value detected!");
+	size_t size = MIN((size_t)*len, cb->size - cb->raw_position);
+
+	if (cb->max_read_len && (cb->raw_position+size > cb->max_read_len)) {
+		std::ostringstream s_buf;
+		s_buf << "Attempted to read " << size << "-byte(s) beyond length limit";
+
+		throw cfile::max_read_length(s_buf.str());
+	}
+
+	const ubyte *view;
+	if ( cb->data ) {
+		view = (const ubyte*)cb->data + cb->raw_position;
+		cb->raw_position += size;
+	} else {
+		buffer.resize(size);
+		size = (size > 0) ? (size_t)cfread(buffer.data(), 1, (int)size, cfile) : 0;
+		view = buffer.data();
+	}
+
+	*len = (int)size;
+	return view;
+}
+
 int cfread_lua_number(double *buf, CFILE *cfile)
 {
 	if(!cf_is_valid(cfile))
@@ -247,11 +293,27 @@ int cfread_lua_number(double *buf, CFILE *cfile)
 
 	Cfile_block *cb = &Cfile_block_list[cfile->id];	
 
-	// cfread() not supported for memory-mapped files
-	if(cb->data != NULL)
-	{
-		Warning(LOCATION, "Writing is not supported for mem-mapped files");
-		return 0;
+	if ( cb->data ) {
+		// fscanf() can't be used on the mapping so the number is copied out of it first
+		const char *data = (const char*)cb->data;
+
+		while ( cb->raw_position < cb->size && isspace((unsigned char)data[cb->raw_position]) ) {
+			cb->raw_position++;
+		}
+
+		char number[64];
+		size_t len = MIN(cb->size - cb->raw_position, sizeof(number) - 1);
+		memcpy(number, data + cb->raw_position, len);
+		number[len] = '\0';
+
+		int chars_read = 0;
+		int items_read = sscanf(number, LUA_NUMBER_SCAN "%n", buf, &chars_read);
+		if ( items_read == 1 ) {
+			cb->raw_position += chars_read;
+		}
+		Assertion(cb->raw_position <= cb->size, "Invalid raw_position value detected!");
+
+		return items_read;
 	}
 
 	long orig_pos = ftell(cb->fp);
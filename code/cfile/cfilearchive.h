@@ -27,6 +27,7 @@ typedef struct Cfile_block {
 	int		dir_type;		// directory location
 	FILE		*fp;				// File pointer if opening an individual file
 	void		*data;			// Pointer for memory-mapped file access.  NULL if not mem-mapped.
+	SCP_vector<ubyte>	*write_buffer;	// receives what is written to a file opened by cfopen_write_buffer(), NULL otherwise
 #ifdef _WIN32
 	HANDLE	hInFile;			// Handle from CreateFile()
 	HANDLE	hMapFile;		// Handle from CreateFileMapping()
@@ -34,6 +35,7 @@ typedef struct Cfile_block {
 //	int		fd;				// file descriptor
 	size_t	data_length;	// length of data for mmap
 #endif
+	int		pack_mapping;	// index of the mapped pack file data points into, -1 if data isn't a view into a pack
 	size_t	lib_offset;
 	size_t	raw_position;
 	size_t	size;				// for packed files
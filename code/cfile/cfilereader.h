@@ -0,0 +1,99 @@
+#ifndef __CFILEREADER_H__
+#define __CFILEREADER_H__
+#pragma once
+
+#include "globalincs/pstypes.h"
+
+/** @file
+ *  Decoding of little endian data which is already in memory, like a chunk returned by cfread_view().
+ *
+ *  The reads behave like the cfread_*() functions of a file which ends where the data ends: past the end they return
+ *  0 and leave the rest of the output alone.
+ */
+
+namespace cfile {
+
+class chunk_reader {
+	const ubyte* _pos;
+	const ubyte* _end;
+
+ public:
+	chunk_reader(const ubyte* data, int size) : _pos(data), _end(data + ((data != nullptr && size > 0) ? size : 0)) {}
+
+	/**
+	 * @brief The number of bytes which haven't been read yet
+	 */
+	int left() const { return (int)(_end - _pos); }
+
+	/**
+	 * @brief Copies the next bytes, as many as there are if there aren't enough
+	 *
+	 * @return The number of bytes which were copied
+	 */
+	int read_bytes(void* dest, int size)
+	{
+		if (size <= 0) {
+			return 0;
+		}
+
+		size = MIN(size, left());
+		memcpy(dest, _pos, size);
+		_pos += size;
+
+		return size;
+	}
+
+	int read_int()
+	{
+		int i = 0;
+		if (left() < (int)sizeof(i)) {
+			_pos = _end;
+			return 0;
+		}
+
+		memcpy(&i, _pos, sizeof(i));
+		_pos += sizeof(i);
+
+		return INTEL_INT(i);
+	}
+
+	float read_float()
+	{
+		float f = 0.0f;
+		if (left() < (int)sizeof(f)) {
+			_pos = _end;
+			return 0.0f;
+		}
+
+		memcpy(&f, _pos, sizeof(f));
+		_pos += sizeof(f);
+
+		return INTEL_FLOAT(&f);
+	}
+
+	void read_vector(vec3d* vec)
+	{
+		vec->xyz.x = read_float();
+		vec->xyz.y = read_float();
+		vec->xyz.z = read_float();
+	}
+
+	/**
+	 * @brief Reads a string which is stored with its length in front, like cfread_string_len()
+	 *
+	 * @param buf Pre-allocated array to store string
+	 * @param n Size of pre-allocated array
+	 */
+	void read_string_len(char* buf, int n)
+	{
+		int len = read_int();
+		Assertion((len < n), "len: %i, n: %i", len, n);
+
+		len = read_bytes(buf, len);
+		buf[len] = 0;
+	}
+};
+
+}
+
+#endif // __CFILEREADER_H__
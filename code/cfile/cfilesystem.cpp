@@ -15,6 +15,7 @@
 #include <errno.h>
 #include <sstream>
 #include <algorithm>
+#include <sys/stat.h>
 
 #ifdef _WIN32
 #include <io.h>
@@ -36,10 +37,12 @@
 #include "cfile/cfile.h"
 #include "cfile/cfilesystem.h"
 #include "cmdline/cmdline.h"
+#include "io/timer.h"
 #include "globalincs/pstypes.h"
 #include "localization/localize.h"
 #include "osapi/osapi.h"
 #include "parse/parselo.h"
+#include "tracing/StartupProfiler.h"
 
 #define CF_ROOTTYPE_PATH 0
 #define CF_ROOTTYPE_PACK 1
@@ -98,6 +101,10 @@ typedef struct cf_file_block {
 static uint Num_files = 0;
 static cf_file_block  *File_blocks[CF_MAX_FILE_BLOCKS];
 
+// Maps the lower case base name (everything but the last extension) of every file to its indices in the file list.
+// The indices are in file list order so the first match in a list is also the one with the highest precedence.
+static SCP_unordered_map<SCP_string, SCP_vector<uint>> File_index;
+
 // Return a pointer to to file 'index'.
 cf_file *cf_get_file(int index)
 {
@@ -126,6 +133,35 @@ cf_file *cf_create_file()
 	return &File_blocks[block]->files[offset];
 }
 
+// Gets the key of a file name in File_index
+static SCP_string cf_file_index_key(const char *filename, size_t len)
+{
+	SCP_string key(filename, len);
+
+	std::transform(key.begin(), key.end(), key.begin(), [](char c) { return (char)tolower((unsigned char)c); });
+
+	return key;
+}
+
+static SCP_string cf_file_index_key(const char *filename)
+{
+	const char *ext = strrchr(filename, '.');
+
+	return cf_file_index_key(filename, ext ? (size_t)(ext - filename) : strlen(filename));
+}
+
+// Gets the files which have the given base name, in file list order
+static const SCP_vector<uint> *cf_file_index_find(const SCP_string &key)
+{
+	auto iter = File_index.find(key);
+
+	if (iter == File_index.end()) {
+		return nullptr;
+	}
+
+	return &iter->second;
+}
+
 extern int cfile_inited;
 
 // Create a new root and return a pointer to it.  The structure is assumed unitialized.
@@ -409,6 +445,8 @@ static void cf_add_mod_roots(const char* rootDirectory)
 
 void cf_build_root_list(const char *cdrom_dir)
 {
+	TRACE_STARTUP_SCOPE(tracing::BuildRootList);
+
 	Num_roots = 0;
 	Num_path_roots = 0;
 
@@ -730,47 +768,368 @@ typedef struct VP_FILE {
 	_fs_time_t write_time;
 } VP_FILE;
 
-void cf_search_root_pack(int root_index)
+// A file inside a pack as it is listed in the table of contents of the pack
+typedef struct cf_pack_entry {
+	SCP_string	path;				// Directory of the file inside the pack
+	SCP_string	filename;
+	int			offset;
+	int			size;
+	_fs_time_t	write_time;
+} cf_pack_entry;
+
+// The table of contents of a pack file as it was when the pack was last read
+typedef struct cf_pack_cache_entry {
+	int64_t		file_size;
+	int64_t		file_time;
+	SCP_vector<cf_pack_entry> files;
+} cf_pack_cache_entry;
+
+#define CF_PACK_CACHE_FILENAME		"pack_index.cache"
+#define CF_PACK_CACHE_VERSION		1
+
+// The contents of all packs seen so far, keyed by the path of the pack. This is saved between runs so packs which
+// haven't changed since then don't have to be read again.
+static SCP_unordered_map<SCP_string, cf_pack_cache_entry> Pack_cache;
+static bool Pack_cache_loaded = false;
+static bool Pack_cache_changed = false;
+
+// Gets the size and the modification time of a pack, they tell if the cached contents are still valid
+static bool cf_get_pack_stamp(const char *path, int64_t *file_size, int64_t *file_time)
 {
-	int num_files = 0;
-	cf_root *root = cf_get_root(root_index);
+	struct stat statbuf;
 
-	Assert( root != NULL );
+	if (stat(path, &statbuf) != 0) {
+		return false;
+	}
+
+	*file_size = (int64_t)statbuf.st_size;
+	*file_time = (int64_t)statbuf.st_mtime;
+
+	return true;
+}
+
+static bool cf_pack_cache_read_string(FILE *fp, SCP_string &str)
+{
+	uint len;
+
+	if ( (fread(&len, sizeof(len), 1, fp) != 1) || (len > CF_MAX_PATHNAME_LENGTH) ) {
+		return false;
+	}
+
+	str.resize(len);
+
+	return (len == 0) || (fread(&str[0], 1, len, fp) == len);
+}
+
+static void cf_pack_cache_write_string(FILE *fp, const SCP_string &str)
+{
+	uint len = (uint)str.size();
+
+	fwrite(&len, sizeof(len), 1, fp);
+	fwrite(str.c_str(), 1, len, fp);
+}
+
+static void cf_pack_cache_load()
+{
+	Pack_cache_loaded = true;
+
+	FILE *fp = fopen(os_get_config_path(CF_PACK_CACHE_FILENAME).c_str(), "rb");
+
+	if (!fp) {
+		return;
+	}
+
+	int version = 0;
+	uint num_packs = 0;
+	bool valid = (fread(&version, sizeof(version), 1, fp) == 1) && (version == CF_PACK_CACHE_VERSION)
+		&& (fread(&num_packs, sizeof(num_packs), 1, fp) == 1);
+
+	for (uint i = 0; valid && (i < num_packs); i++) {
+		SCP_string pack_path;
+		cf_pack_cache_entry pack;
+		uint num_files = 0;
+
+		valid = cf_pack_cache_read_string(fp, pack_path)
+			&& (fread(&pack.file_size, sizeof(pack.file_size), 1, fp) == 1)
+			&& (fread(&pack.file_time, sizeof(pack.file_time), 1, fp) == 1)
+			&& (fread(&num_files, sizeof(num_files), 1, fp) == 1);
+
+		for (uint j = 0; valid && (j < num_files); j++) {
+			cf_pack_entry entry;
+
+			valid = cf_pack_cache_read_string(fp, entry.path) && cf_pack_cache_read_string(fp, entry.filename)
+				&& (fread(&entry.offset, sizeof(entry.offset), 1, fp) == 1)
+				&& (fread(&entry.size, sizeof(entry.size), 1, fp) == 1)
+				&& (fread(&entry.write_time, sizeof(entry.write_time), 1, fp) == 1);
+
+			pack.files.push_back(entry);
+		}
+
+		if (valid) {
+			Pack_cache[pack_path] = std::move(pack);
+		}
+	}
+
+	fclose(fp);
+
+	if ( !valid ) {
+		mprintf(("Ignoring invalid pack index cache.\n"));
+		Pack_cache.clear();
+	}
+}
+
+static void cf_pack_cache_save()
+{
+	if ( !Pack_cache_changed ) {
+		return;
+	}
+
+	Pack_cache_changed = false;
+
+	// forget about packs which are gone or have changed since they were cached
+	for (auto iter = Pack_cache.begin(); iter != Pack_cache.end(); ) {
+		int64_t file_size, file_time;
+
+		if ( !cf_get_pack_stamp(iter->first.c_str(), &file_size, &file_time) || (file_size != iter->second.file_size)
+			|| (file_time != iter->second.file_time) ) {
+			iter = Pack_cache.erase(iter);
+		} else {
+			++iter;
+		}
+	}
+
+	FILE *fp = fopen(os_get_config_path(CF_PACK_CACHE_FILENAME).c_str(), "wb");
+
+	if (!fp) {
+		mprintf(("Unable to write the pack index cache.\n"));
+		return;
+	}
+
+	int version = CF_PACK_CACHE_VERSION;
+	uint num_packs = (uint)Pack_cache.size();
+
+	fwrite(&version, sizeof(version), 1, fp);
+	fwrite(&num_packs, sizeof(num_packs), 1, fp);
+
+	for (auto& pack : Pack_cache) {
+		uint num_files = (uint)pack.second.files.size();
+
+		cf_pack_cache_write_string(fp, pack.first);
+		fwrite(&pack.second.file_size, sizeof(pack.second.file_size), 1, fp);
+		fwrite(&pack.second.file_time, sizeof(pack.second.file_time), 1, fp);
+		fwrite(&num_files, sizeof(num_files), 1, fp);
+
+		for (auto& entry : pack.second.files) {
+			cf_pack_cache_write_string(fp, entry.path);
+			cf_pack_cache_write_string(fp, entry.filename);
+			fwrite(&entry.offset, sizeof(entry.offset), 1, fp);
+			fwrite(&entry.size, sizeof(entry.size), 1, fp);
+			fwrite(&entry.write_time, sizeof(entry.write_time), 1, fp);
+		}
+	}
+
+	fclose(fp);
+}
+
+// The checksums of a pack as it was when they were computed, the partial one only covers the end of the pack
+typedef struct cf_pack_chksum_entry {
+	int64_t		file_size;
+	int64_t		file_time;
+	bool		has_partial;
+	bool		has_full;
+	uint		partial;
+	uint		full;
+} cf_pack_chksum_entry;
+
+#define CF_PACK_CHKSUM_CACHE_FILENAME		"pack_chksum.cache"
+#define CF_PACK_CHKSUM_CACHE_VERSION		1
+
+static SCP_unordered_map<SCP_string, cf_pack_chksum_entry> Pack_chksum_cache;
+static bool Pack_chksum_cache_loaded = false;
+
+static void cf_pack_chksum_cache_load()
+{
+	Pack_chksum_cache_loaded = true;
+
+	FILE *fp = fopen(os_get_config_path(CF_PACK_CHKSUM_CACHE_FILENAME).c_str(), "rb");
+
+	if (!fp) {
+		return;
+	}
+
+	int version = 0;
+	uint num_packs = 0;
+	bool valid = (fread(&version, sizeof(version), 1, fp) == 1) && (version == CF_PACK_CHKSUM_CACHE_VERSION)
+		&& (fread(&num_packs, sizeof(num_packs), 1, fp) == 1);
+
+	for (uint i = 0; valid && (i < num_packs); i++) {
+		SCP_string pack_path;
+		cf_pack_chksum_entry pack;
+		ubyte has_partial = 0, has_full = 0;
+
+		valid = cf_pack_cache_read_string(fp, pack_path)
+			&& (fread(&pack.file_size, sizeof(pack.file_size), 1, fp) == 1)
+			&& (fread(&pack.file_time, sizeof(pack.file_time), 1, fp) == 1)
+			&& (fread(&has_partial, sizeof(has_partial), 1, fp) == 1)
+			&& (fread(&has_full, sizeof(has_full), 1, fp) == 1)
+			&& (fread(&pack.partial, sizeof(pack.partial), 1, fp) == 1)
+			&& (fread(&pack.full, sizeof(pack.full), 1, fp) == 1);
+
+		pack.has_partial = has_partial != 0;
+		pack.has_full = has_full != 0;
+
+		if (valid) {
+			Pack_chksum_cache[pack_path] = pack;
+		}
+	}
+
+	fclose(fp);
+
+	if ( !valid ) {
+		mprintf(("Ignoring invalid pack checksum cache.\n"));
+		Pack_chksum_cache.clear();
+	}
+}
+
+static void cf_pack_chksum_cache_save()
+{
+	FILE *fp = fopen(os_get_config_path(CF_PACK_CHKSUM_CACHE_FILENAME).c_str(), "wb");
+
+	if (!fp) {
+		mprintf(("Unable to write the pack checksum cache.\n"));
+		return;
+	}
+
+	int version = CF_PACK_CHKSUM_CACHE_VERSION;
+	uint num_packs = (uint)Pack_chksum_cache.size();
+
+	fwrite(&version, sizeof(version), 1, fp);
+	fwrite(&num_packs, sizeof(num_packs), 1, fp);
+
+	for (auto& pack : Pack_chksum_cache) {
+		ubyte has_partial = pack.second.has_partial ? 1 : 0;
+		ubyte has_full = pack.second.has_full ? 1 : 0;
+
+		cf_pack_cache_write_string(fp, pack.first);
+		fwrite(&pack.second.file_size, sizeof(pack.second.file_size), 1, fp);
+		fwrite(&pack.second.file_time, sizeof(pack.second.file_time), 1, fp);
+		fwrite(&has_partial, sizeof(has_partial), 1, fp);
+		fwrite(&has_full, sizeof(has_full), 1, fp);
+		fwrite(&pack.second.partial, sizeof(pack.second.partial), 1, fp);
+		fwrite(&pack.second.full, sizeof(pack.second.full), 1, fp);
+	}
+
+	fclose(fp);
+}
+
+bool cf_pack_chksum_cache_find(const char *pack_path, bool full, uint *chksum)
+{
+	if ( !Pack_chksum_cache_loaded ) {
+		cf_pack_chksum_cache_load();
+	}
+
+	auto cached = Pack_chksum_cache.find(pack_path);
+	if (cached == Pack_chksum_cache.end()) {
+		return false;
+	}
 
+	int64_t file_size, file_time;
+
+	if ( !cf_get_pack_stamp(pack_path, &file_size, &file_time) || (file_size != cached->second.file_size)
+		|| (file_time != cached->second.file_time) ) {
+		Pack_chksum_cache.erase(cached);
+		return false;
+	}
+
+	if ( !(full ? cached->second.has_full : cached->second.has_partial) ) {
+		return false;
+	}
+
+	*chksum = full ? cached->second.full : cached->second.partial;
+
+	return true;
+}
+
+void cf_pack_chksum_cache_store(const char *pack_path, bool full, uint chksum)
+{
+	if ( !Pack_chksum_cache_loaded ) {
+		cf_pack_chksum_cache_load();
+	}
+
+	int64_t file_size, file_time;
+
+	if ( !cf_get_pack_stamp(pack_path, &file_size, &file_time) ) {
+		return;
+	}
+
+	auto& pack = Pack_chksum_cache[pack_path];
+
+	// the other checksum belongs to an older version of the pack
+	if ( (pack.file_size != file_size) || (pack.file_time != file_time) ) {
+		pack.file_size = file_size;
+		pack.file_time = file_time;
+		pack.has_partial = false;
+		pack.has_full = false;
+	}
+
+	if (full) {
+		pack.has_full = true;
+		pack.full = chksum;
+	} else {
+		pack.has_partial = true;
+		pack.partial = chksum;
+	}
+
+	// forget about packs which are gone or have changed since they were cached
+	for (auto iter = Pack_chksum_cache.begin(); iter != Pack_chksum_cache.end(); ) {
+		if ( !cf_get_pack_stamp(iter->first.c_str(), &file_size, &file_time) || (file_size != iter->second.file_size)
+			|| (file_time != iter->second.file_time) ) {
+			iter = Pack_chksum_cache.erase(iter);
+		} else {
+			++iter;
+		}
+	}
+
+	cf_pack_chksum_cache_save();
+}
+
+// Reads the table of contents of a pack, returns false if it couldn't be read completely
+static bool cf_read_pack_contents(const char *pack_path, SCP_vector<cf_pack_entry> &files)
+{
 	// Open data		
-	FILE *fp = fopen( root->path, "rb" );
+	FILE *fp = fopen( pack_path, "rb" );
 	// Read the file header
 	if (!fp) {
-		return;
+		return false;
 	}
 
 	if ( filelength(fileno(fp)) < (int)(sizeof(VP_FILE_HEADER) + (sizeof(int) * 3)) ) {
-		mprintf(( "Skipping VP file ('%s') of invalid size...\n", root->path ));
+		mprintf(( "Skipping VP file ('%s') of invalid size...\n", pack_path ));
 		fclose(fp);
-		return;
+		return false;
 	}
 
 	VP_FILE_HEADER VP_header;
 
 	Assert( sizeof(VP_header) == 16 );
 	if (fread(&VP_header, sizeof(VP_header), 1, fp) != 1) {
-		mprintf(("Skipping VP file ('%s') because the header could not be read...\n", root->path));
+		mprintf(("Skipping VP file ('%s') because the header could not be read...\n", pack_path));
 		fclose(fp);
-		return;
+		return false;
 	}
 
 	VP_header.version = INTEL_INT( VP_header.version ); //-V570
 	VP_header.index_offset = INTEL_INT( VP_header.index_offset ); //-V570
 	VP_header.num_files = INTEL_INT( VP_header.num_files ); //-V570
 
-	mprintf(( "Searching root pack '%s' ... ", root->path ));
-
 	// Read index info
 	fseek(fp, VP_header.index_offset, SEEK_SET);
 
 	char search_path[CF_MAX_PATHNAME_LENGTH];
 
 	strcpy_s( search_path, "" );
+
+	bool complete = true;
 	
 	// Go through all the files
 	int i;
@@ -779,6 +1138,7 @@ void cf_search_root_pack(int root_index)
 
 		if (fread( &find, sizeof(VP_FILE), 1, fp ) != 1) {
 			mprintf(("Failed to read file entry (currently in directory %s)!\n", search_path));
+			complete = false;
 			break;
 		}
 
@@ -804,35 +1164,102 @@ void cf_search_root_pack(int root_index)
 
 			//mprintf(( "Current dir = '%s'\n", search_path ));
 		} else {
-	
-			int j;			
-							
-			for (j=CF_TYPE_ROOT; j<CF_MAX_PATH_TYPES; j++ )	{
-				
-				if ( !stricmp( search_path, Pathtypes[j].path ))	{
-					char *ext = strrchr( find.filename, '.' );
-					if ( ext )	{
-						if ( is_ext_in_list( Pathtypes[j].extensions, ext ) )	{
-							// Found a file!!!!
-							cf_file *file = cf_create_file();
-							strcpy_s( file->name_ext, find.filename );
-							file->root_index = root_index;
-							file->pathtype_index = j;
-							file->write_time = (time_t)find.write_time;
-							file->size = find.size;
-							file->pack_offset = find.offset;			// Mark as a packed file
+			cf_pack_entry entry;
+			entry.path = search_path;
+			entry.filename = find.filename;
+			entry.offset = find.offset;
+			entry.size = find.size;
+			entry.write_time = find.write_time;
+
+			files.push_back(entry);
+		}
+	}
 
-							num_files++;
-							//mprintf(( "Found pack file '%s'\n", file->name_ext ));
-						}
+	fclose(fp);
+
+	return complete;
+}
+
+void cf_search_root_pack(int root_index)
+{
+	int num_files = 0;
+	cf_root *root = cf_get_root(root_index);
+
+	Assert( root != NULL );
+
+	if ( !Pack_cache_loaded ) {
+		cf_pack_cache_load();
+	}
+
+	int64_t file_size = 0, file_time = 0;
+	bool stamped = cf_get_pack_stamp(root->path, &file_size, &file_time);
+
+	auto cached = Pack_cache.find(root->path);
+
+	if ( cached != Pack_cache.end() && (!stamped || (cached->second.file_size != file_size)
+		|| (cached->second.file_time != file_time)) ) {
+		Pack_cache.erase(cached);
+		cached = Pack_cache.end();
+		Pack_cache_changed = true;
+	}
+
+	SCP_vector<cf_pack_entry> uncached_files;
+	const SCP_vector<cf_pack_entry> *files;
+
+	if (cached != Pack_cache.end()) {
+		mprintf(( "Searching root pack '%s' (cached) ... ", root->path ));
+
+		files = &cached->second.files;
+	} else {
+		cf_pack_cache_entry pack;
+
+		bool complete = cf_read_pack_contents(root->path, pack.files);
+
+		if ( !complete && pack.files.empty() ) {
+			return;
+		}
+
+		mprintf(( "Searching root pack '%s' ... ", root->path ));
+
+		// a pack which couldn't be read completely is read again next time
+		if (stamped && complete) {
+			pack.file_size = file_size;
+			pack.file_time = file_time;
+
+			files = &Pack_cache.emplace(root->path, std::move(pack)).first->second.files;
+			Pack_cache_changed = true;
+		} else {
+			uncached_files.swap(pack.files);
+			files = &uncached_files;
+		}
+	}
+
+	for (auto& entry : *files) {
+		int j;
+
+		for (j=CF_TYPE_ROOT; j<CF_MAX_PATH_TYPES; j++ )	{
+			
+			if ( !stricmp( entry.path.c_str(), Pathtypes[j].path ))	{
+				const char *ext = strrchr( entry.filename.c_str(), '.' );
+				if ( ext )	{
+					if ( is_ext_in_list( Pathtypes[j].extensions, ext ) )	{
+						// Found a file!!!!
+						cf_file *file = cf_create_file();
+						strcpy_s( file->name_ext, entry.filename.c_str() );
+						file->root_index = root_index;
+						file->pathtype_index = j;
+						file->write_time = (time_t)entry.write_time;
+						file->size = entry.size;
+						file->pack_offset = entry.offset;			// Mark as a packed file
+
+						num_files++;
+						//mprintf(( "Found pack file '%s'\n", file->name_ext ));
 					}
 				}
 			}
 		}
 	}
 
-	fclose(fp);
-
 	mprintf(( "%i files\n", num_files ));
 }
 
@@ -841,19 +1268,35 @@ void cf_search_root_pack(int root_index)
 void cf_build_file_list()
 {
 	int i;
+	uint ui;
+
+	TRACE_STARTUP_SCOPE(tracing::BuildFileList);
 
 	Num_files = 0;
+	File_index.clear();
 
 	// For each root, find all files...
 	for (i=0; i<Num_roots; i++ )	{
 		cf_root	*root = cf_get_root(i);
+		auto start = timer_get_nanoseconds();
+
 		if ( root->roottype == CF_ROOTTYPE_PATH )	{
 			cf_search_root_path(i);
 		} else if ( root->roottype == CF_ROOTTYPE_PACK )	{
 			cf_search_root_pack(i);
 		}
+
+		tracing::startup::root_listed(root->path, root->roottype == CF_ROOTTYPE_PACK, timer_get_nanoseconds() - start);
 	}
 
+	cf_pack_cache_save();
+
+	// index the files by name so lookups don't have to go through the whole list
+	File_index.reserve(Num_files);
+
+	for (ui = 0; ui < Num_files; ui++) {
+		File_index[cf_file_index_key(cf_get_file(ui)->name_ext)].push_back(ui);
+	}
 }
 
 
@@ -915,6 +1358,7 @@ void cf_free_secondary_filelist()
 		}
 	}
 	Num_files = 0;
+	File_index.clear();
 }
 
 /**
@@ -1047,7 +1491,38 @@ int cf_find_file_location( const char *filespec, int pathtype, int max_out, char
 	}
 
 	// Search the pak files and CD-ROM.
-	for (ui = 0; ui < Num_files; ui++ )	{
+
+	// only the files with the plain or the localized name can match, both lists are merged in file list order
+	const SCP_vector<uint> *plain_matches = cf_file_index_find(cf_file_index_key(filespec));
+	const SCP_vector<uint> *localized_matches = nullptr;
+
+	if (localize) {
+		// create localized filespec
+		strncpy(longname, filespec, MAX_PATH_LEN - 1);
+
+		if ( lcl_add_dir_to_path_with_filename(longname, MAX_PATH_LEN - 1) ) {
+			localized_matches = cf_file_index_find(cf_file_index_key(longname));
+		} else {
+			localize = false;
+		}
+	}
+
+	size_t plain_pos = 0, localized_pos = 0;
+	size_t num_plain = plain_matches ? plain_matches->size() : 0;
+	size_t num_localized = localized_matches ? localized_matches->size() : 0;
+
+	while ( (plain_pos < num_plain) || (localized_pos < num_localized) ) {
+		if ( (localized_pos >= num_localized) || ((plain_pos < num_plain) && ((*plain_matches)[plain_pos] < (*localized_matches)[localized_pos])) ) {
+			ui = (*plain_matches)[plain_pos++];
+		} else {
+			ui = (*localized_matches)[localized_pos++];
+
+			// the file is in both lists if the localized name is the plain name
+			if ( (plain_pos < num_plain) && ((*plain_matches)[plain_pos] == ui) ) {
+				plain_pos++;
+			}
+		}
+
 		cf_file *f = cf_get_file(ui);
 
 		// only search paths we're supposed to...
@@ -1056,31 +1531,26 @@ int cf_find_file_location( const char *filespec, int pathtype, int max_out, char
 
 
 		if (localize) {
-			// create localized filespec
-			strncpy(longname, filespec, MAX_PATH_LEN - 1);
-
-			if ( lcl_add_dir_to_path_with_filename(longname, MAX_PATH_LEN - 1) ) {
-				if ( !stricmp(longname, f->name_ext) ) {
-					if (size)
-						*size = f->size;
+			if ( !stricmp(longname, f->name_ext) ) {
+				if (size)
+					*size = f->size;
 
-					if (offset)
-						*offset = (size_t)f->pack_offset;
+				if (offset)
+					*offset = (size_t)f->pack_offset;
 
-					if (pack_filename) {
-						if (f->pack_offset < 1) {
-							// This is a real file, return the actual file path
-							strncpy( pack_filename, f->real_name, max_out );
-						} else {
-							// File is in a pack file
-							cf_root *r = cf_get_root(f->root_index);
+				if (pack_filename) {
+					if (f->pack_offset < 1) {
+						// This is a real file, return the actual file path
+						strncpy( pack_filename, f->real_name, max_out );
+					} else {
+						// File is in a pack file
+						cf_root *r = cf_get_root(f->root_index);
 
-							strncpy( pack_filename, r->path, max_out );
-						}
+						strncpy( pack_filename, r->path, max_out );
 					}
-
-					return 1;
 				}
+
+				return 1;
 			}
 		}
 
@@ -1269,11 +1739,18 @@ int cf_find_file_location_ext( const char *filename, const int ext_num, const ch
 	int last_root_index = -1;
 	int last_path_index = -1;
 
-	file_list_index.reserve( MIN(ext_num * 4, (int)Num_files) );
+	// every extension of the base name is in the same list of the index so a single lookup finds all candidates
+	const SCP_vector<uint> *base_matches = cf_file_index_find(cf_file_index_key(filespec, filespec_len));
+
+	if (base_matches == nullptr) {
+		return -1;
+	}
+
+	file_list_index.reserve(base_matches->size());
 
 	// next, run though and pick out base matches
-	for (ui = 0; ui < Num_files; ui++) {
-		cf_file *f = cf_get_file(ui);
+	for (auto index : *base_matches) {
+		cf_file *f = cf_get_file(index);
 
 		// ... only search paths that we're supposed to
 		if ( (num_search_dirs == 1) && (pathtype != f->pathtype_index) )
@@ -1429,8 +1906,8 @@ int cf_matches_spec(const char *filespec, const char *filename)
 	}
 }
 
-int (*Get_file_list_filter)(const char *filename) = NULL;
-const char *Get_file_list_child = NULL;
+SCP_THREAD_LOCAL int (*Get_file_list_filter)(const char *filename) = NULL;
+SCP_THREAD_LOCAL const char *Get_file_list_child = NULL;
 int Skip_packfile_search = 0;
 
 static bool verify_file_list_child()
@@ -1495,6 +1972,8 @@ int cf_get_file_list( SCP_vector<SCP_string> &list, int pathtype, const char *fi
 	SCP_vector<file_list_info> my_info;
 	file_list_info tinfo;
 
+	cf_flush_async_writes();
+
 	if ( !info && (sort == CF_SORT_TIME) ) {
 		info = &my_info;
 		own_flag = 1;
@@ -1699,6 +2178,8 @@ int cf_get_file_list( int max, char **list, int pathtype, const char *filter, in
 	int num_files = 0, own_flag = 0;
 	size_t l;
 
+	cf_flush_async_writes();
+
 	if (max < 1) {
 		Get_file_list_filter = NULL;
 
@@ -42,4 +42,8 @@ extern cf_pathtype Pathtypes[CF_MAX_PATH_TYPES];
 int cf_create_default_path_string( char *path, uint path_max, int pathtype, const char *filename=NULL, bool localize = false);
 int cf_create_default_path_string( SCP_string &path, int pathtype, const char *filename=NULL, bool localize = false );
 
+// The checksums of packs computed by cf_chksum_pack(), they are kept between runs until the pack changes
+bool cf_pack_chksum_cache_find( const char *pack_path, bool full, uint *chksum );
+void cf_pack_chksum_cache_store( const char *pack_path, bool full, uint chksum );
+
 #endif	//_CFILESYSTEM_H
@@ -9,6 +9,7 @@
 
 
 
+#include "ai/ai.h"
 #include "camera/camera.h" //VIEWER_ZOOM_DEFAULT
 #include "cmdline/cmdline.h"
 #include "globalincs/linklist.h"
@@ -17,6 +18,8 @@
 #include "globalincs/version.h"
 #include "hud/hudconfig.h"
 #include "network/multi.h"
+#include "object/objcollide.h"
+#include "object/object.h"
 #include "scripting/scripting.h"
 #include "parse/sexp.h"
 #include "globalincs/version.h"
@@ -148,6 +151,7 @@ Flag exe_params[] =
 	{ "-noenv",				"Disable environment maps",					true,	EASY_DEFAULT_MEM,	EASY_MEM_ALL_ON,	"Graphics",		"http://www.hard-light.net/wiki/index.php/Command-Line_Reference#-env", },
 	{ "-nomotiondebris",	"Disable motion debris",					true,	EASY_ALL_ON,		EASY_DEFAULT,		"Graphics",		"http://www.hard-light.net/wiki/index.php/Command-Line_Reference#-nomotiondebris",},
 	{ "-noscalevid",		"Disable scale-to-window for movies",		true,	0,					EASY_DEFAULT,		"Graphics",		"http://www.hard-light.net/wiki/index.php/Command-Line_Reference#-noscalevid", },
+	{ "-hw_video_decode",	"Decode movies on the GPU",					true,	0,					EASY_DEFAULT,		"Graphics",		"", },
 	{ "-missile_lighting",	"Apply lighting to missiles"	,			true,	EASY_ALL_ON,		EASY_DEFAULT,		"Graphics",		"http://www.hard-light.net/wiki/index.php/Command-Line_Reference#-missile_lighting", },
 	{ "-nonormal",			"Disable normal maps",						true,	EASY_DEFAULT_MEM,	EASY_MEM_ALL_ON,	"Graphics",		"http://www.hard-light.net/wiki/index.php/Command-Line_Reference#-normal" },
 	{ "-no_emissive_light",	"Disable emissive light from ships",		true,	0,					EASY_DEFAULT,		"Graphics",		"http://www.hard-light.net/wiki/index.php/Command-Line_Reference#-no_emissive_light" },
@@ -162,6 +166,7 @@ Flag exe_params[] =
 	{ "-no_deferred",		"Disable Deferred Lighting",				true,	EASY_DEFAULT_MEM,	EASY_DEFAULT,		"Graphics",		"http://www.hard-light.net/wiki/index.php/Command-Line_Reference#-no_deferred"},
 	{ "-enable_shadows",	"Enable Shadows",							true,	EASY_MEM_ALL_ON,	EASY_DEFAULT,		"Graphics",		"http://www.hard-light.net/wiki/index.php/Command-Line_Reference#-no_shadows"},
 	{ "-no_vsync",			"Disable vertical sync",					true,	0,					EASY_DEFAULT,		"Game Speed",	"http://www.hard-light.net/wiki/index.php/Command-Line_Reference#-no_vsync", },
+	{ "-threaded_gl",		"Use the threaded OpenGL of the driver",	true,	0,					EASY_DEFAULT,		"Game Speed",	"", },
 	{ "-cache_bitmaps",		"Cache bitmaps between missions",			true,	0,					EASY_DEFAULT_MEM,	"Game Speed",	"http://www.hard-light.net/wiki/index.php/Command-Line_Reference#-cache_bitmaps", },
 
 	{ "-dualscanlines",		"Add another pair of scanning lines",		true,	0,					EASY_DEFAULT,		"HUD",			"http://www.hard-light.net/wiki/index.php/Command-Line_Reference#-dualscanlines", },
@@ -181,6 +186,7 @@ Flag exe_params[] =
 	{ "-nosound",			"Disable all sound",						false,	0,					EASY_DEFAULT,		"Audio",		"http://www.hard-light.net/wiki/index.php/Command-Line_Reference#-nosound", },
 	{ "-nomusic",			"Disable music",							false,	0,					EASY_DEFAULT,		"Audio",		"http://www.hard-light.net/wiki/index.php/Command-Line_Reference#-nomusic", },
 	{ "-no_enhanced_sound",	"Disable enhanced sound",					false,	0,					EASY_DEFAULT,		"Audio",		"http://www.hard-light.net/wiki/index.php/Command-Line_Reference#-no_enhanced_sound", },
+	{ "-virtual_voices",	"Queue 3D sounds when out of channels",		false,	0,					EASY_DEFAULT,		"Audio",		"", },
 
 	{ "-portable_mode",		"Store config in portable location",		false,	0,					EASY_DEFAULT,		"Launcher",		"http://www.hard-light.net/wiki/index.php/Command-Line_Reference#-portable_mode", },
 
@@ -206,16 +212,28 @@ Flag exe_params[] =
 	{ "-old_collision",		"Use old collision detection system",		true,	EASY_DEFAULT,		EASY_ALL_ON,		"Troubleshoot",	"http://www.hard-light.net/wiki/index.php/Command-Line_Reference#-old_collision", },
 	{ "-gl_finish",			"Fix input lag on some ATI+Linux systems",	true,	0,					EASY_DEFAULT,		"Troubleshoot", "http://www.hard-light.net/wiki/index.php/Command-Line_Reference#-gl_finish", },
 	{ "-no_batching",		"Disable batched model rendering",			true,	0,					EASY_DEFAULT,		"Troubleshoot", "", },
+	{ "-no_texture_arrays",	"Disable texture arrays for models",		true,	0,					EASY_DEFAULT,		"Troubleshoot", "", },
+	{ "-packed_vertices",	"Compress the vertices of models",			true,	0,					EASY_DEFAULT,		"Troubleshoot", "", },
+	{ "-generate_lods",		"Generate LODs for models without them",	true,	0,					EASY_DEFAULT,		"Troubleshoot", "", },
+	{ "-retained_draws",	"Reuse the draws of unchanged models",		true,	0,					EASY_DEFAULT,		"Troubleshoot", "", },
+	{ "-cached_background",	"Draw a static skybox only once",			true,	0,					EASY_DEFAULT,		"Troubleshoot", "", },
+	{ "-depth_prepass",		"Depth pre-pass for deferred lighting",		true,	0,					EASY_DEFAULT,		"Troubleshoot", "", },
 	{ "-no_geo_effects",	"Disable geometry shader for effects",		true,	0,					EASY_DEFAULT,		"Troubleshoot", "", },
 	{ "-set_cpu_affinity",	"Sets processor affinity to config value",	true,	0,					EASY_DEFAULT,		"Troubleshoot", "", },
 	{ "-nograb",			"Disables mouse grabbing",					true,	0,					EASY_DEFAULT,		"Troubleshoot", "http://www.hard-light.net/wiki/index.php/Command-Line_Reference#-nograb", },
 	{ "-noshadercache",		"Disables the shader cache",				true,	0,					EASY_DEFAULT,		"Troubleshoot", "http://www.hard-light.net/wiki/index.php/Command-Line_Reference#-noshadercache", },
+	{ "-no_parallel_shaders",	"Don't compile shaders in the background",	true,	0,					EASY_DEFAULT,		"Troubleshoot", "", },
+	{ "-model_cache",		"Cache processed models on disk",			true,	0,					EASY_DEFAULT,		"Troubleshoot", "", },
+	{ "-table_cache",		"Cache processed tables on disk",			true,	0,					EASY_DEFAULT,		"Troubleshoot", "", },
+	{ "-texture_cache",		"Cache compressed textures on disk",		true,	0,					EASY_DEFAULT,		"Troubleshoot", "", },
+	{ "-mission_cache",		"Cache processed missions",					true,	0,					EASY_DEFAULT,		"Troubleshoot", "", },
 #ifdef WIN32
 	{ "-fix_registry",	"Use a different registry path",			true,		0,					EASY_DEFAULT,		"Troubleshoot", "", },
 #endif
 
 	{ "-ingame_join",		"Allow in-game joining",					true,	0,					EASY_DEFAULT,		"Experimental",	"http://www.hard-light.net/wiki/index.php/Command-Line_Reference#-ingame_join", },
 	{ "-voicer",			"Enable voice recognition",					true,	0,					EASY_DEFAULT,		"Experimental",	"http://www.hard-light.net/wiki/index.php/Command-Line_Reference#-voicer", },
+	{ "-gpu_particles",		"Simulate effect particles on the GPU",		true,	0,					EASY_DEFAULT,		"Experimental",	"", },
 
 	{ "-fps",				"Show frames per second on HUD",			false,	0,					EASY_DEFAULT,		"Dev Tool",		"http://www.hard-light.net/wiki/index.php/Command-Line_Reference#-fps", },
 	{ "-pos",				"Show position of camera",					false,	0,					EASY_DEFAULT,		"Dev Tool",		"http://www.hard-light.net/wiki/index.php/Command-Line_Reference#-pos", },
@@ -228,6 +246,11 @@ Flag exe_params[] =
 	{ "-tablecrcs",			"Dump table CRCs for multi validation",		true,	0,					EASY_DEFAULT,		"Dev Tool",		"http://www.hard-light.net/wiki/index.php/Command-Line_Reference#-tablecrcs", },
 	{ "-missioncrcs",		"Dump mission CRCs for multi validation",	true,	0,					EASY_DEFAULT,		"Dev Tool",		"http://www.hard-light.net/wiki/index.php/Command-Line_Reference#-missioncrcs", },
 	{ "-dis_collisions",	"Disable collisions",						true,	0,					EASY_DEFAULT,		"Dev Tool",		"http://www.hard-light.net/wiki/index.php/Command-Line_Reference#-dis_collisions", },
+	{ "-parallel_collide",	"Multithreaded ship:weapon collisions",		true,	0,					EASY_DEFAULT,		"Dev Tool",		"http://www.hard-light.net/wiki/index.php/Command-Line_Reference#-parallel_collide", },
+	{ "-parallel_physics",	"Multithreaded physics integration",		true,	0,					EASY_DEFAULT,		"Dev Tool",		"http://www.hard-light.net/wiki/index.php/Command-Line_Reference#-parallel_physics", },
+	{ "-parallel_ai",		"Multithreaded AI target search",			true,	0,					EASY_DEFAULT,		"Dev Tool",		"http://www.hard-light.net/wiki/index.php/Command-Line_Reference#-parallel_ai", },
+	{ "-ai_lod",			"Update distant AI ships less often",		true,	0,					EASY_DEFAULT,		"Dev Tool",		"http://www.hard-light.net/wiki/index.php/Command-Line_Reference#-ai_lod", },
+	{ "-collision_hash",	"Use spatial hash collision broadphase",	true,	0,					EASY_DEFAULT,		"Dev Tool",		"http://www.hard-light.net/wiki/index.php/Command-Line_Reference#-collision_hash", },
 	{ "-dis_weapons",		"Disable weapon rendering",					true,	0,					EASY_DEFAULT,		"Dev Tool",		"http://www.hard-light.net/wiki/index.php/Command-Line_Reference#-dis_weapons", },
 	{ "-output_sexps",		"Output SEXPs to sexps.html",				true,	0,					EASY_DEFAULT,		"Dev Tool",		"http://www.hard-light.net/wiki/index.php/Command-Line_Reference#-output_sexps", },
 	{ "-output_scripting",	"Output scripting to scripting.html",		true,	0,					EASY_DEFAULT,		"Dev Tool",		"http://www.hard-light.net/wiki/index.php/Command-Line_Reference#-output_scripting", },
@@ -240,6 +263,7 @@ Flag exe_params[] =
 	{ "-noninteractive",	"Disables interactive dialogs",				true,	0,					EASY_DEFAULT,		"Dev Tool",		"http://www.hard-light.net/wiki/index.php/Command-Line_Reference#-noninteractive", },
 	{ "-json_pilot",		"Dump pilot files in JSON format",			true,	0,					EASY_DEFAULT,		"Dev Tool",		"http://www.hard-light.net/wiki/index.php/Command-Line_Reference#-json_pilot", },
 	{ "-json_profiling",	"Generate JSON profiling output",			true,	0,					EASY_DEFAULT,		"Dev Tool",		"http://www.hard-light.net/wiki/index.php/Command-Line_Reference#-json_profiling", },
+	{ "-profile_network",	"Write network traffic to file",			true,	0,					EASY_DEFAULT,		"Dev Tool",		"http://www.hard-light.net/wiki/index.php/Command-Line_Reference#-profile_network", },
 	{ "-profile_frame_time","Profile engine subsystems",				true,	0,					EASY_DEFAULT,		"Dev Tool",		"http://www.hard-light.net/wiki/index.php/Command-Line_Reference#-profile_frame_timings", },
 	{ "-debug_window",		"Enable the debug window",					true,	0,					EASY_DEFAULT,		"Dev Tool",		"http://www.hard-light.net/wiki/index.php/Command-Line_Reference#-debug_window", },
 };
@@ -259,10 +283,13 @@ cmdline_parm standalone_arg("-standalone", NULL, AT_NONE);
 cmdline_parm nosound_arg("-nosound", NULL, AT_NONE);			// Cmdline_freespace_no_sound
 cmdline_parm nomusic_arg("-nomusic", NULL, AT_NONE);			// Cmdline_freespace_no_music
 cmdline_parm noenhancedsound_arg("-no_enhanced_sound", NULL, AT_NONE);	// Cmdline_no_enhanced_sound
+cmdline_parm virtual_voices_arg("-virtual_voices", NULL, AT_NONE);	// Cmdline_virtual_voices
+cmdline_parm snd_ram_budget_arg("-snd_ram_budget", "Decoded sound memory budget in MB, 0 is unlimited", AT_INT);	// Cmdline_snd_ram_budget
 cmdline_parm startgame_arg("-startgame", NULL, AT_NONE);		// Cmdline_start_netgame
 cmdline_parm gameclosed_arg("-closed", NULL, AT_NONE);		// Cmdline_closed_game
 cmdline_parm gamerestricted_arg("-restricted", NULL, AT_NONE);	// Cmdline_restricted_game
 cmdline_parm port_arg("-port", "Multiplayer network port", AT_INT);
+cmdline_parm standalone_sessions_arg("-standalone_sessions", "Number of standalone games hosted by one install", AT_INT);	// Cmdline_standalone_sessions
 cmdline_parm multilog_arg("-multilog", NULL, AT_NONE);		// Cmdline_multi_log
 cmdline_parm client_dodamage("-clientdamage", NULL, AT_NONE);	// Cmdline_client_dodamage
 cmdline_parm pof_spew("-pofspew", NULL, AT_NONE);			// Cmdline_spew_pof_info
@@ -286,6 +313,7 @@ int Cmdline_multi_log = 0;
 int Cmdline_multi_stream_chat_to_file = 0;
 int Cmdline_network_port = -1;
 int Cmdline_restricted_game = 0;
+int Cmdline_standalone_sessions = 1;
 int Cmdline_spew_pof_info = 0;
 int Cmdline_start_netgame = 0;
 int Cmdline_timeout = -1;
@@ -308,6 +336,7 @@ cmdline_parm env("-noenv", NULL, AT_NONE);								// Cmdline_env
 cmdline_parm glow_arg("-noglow", NULL, AT_NONE); 						// Cmdline_glow  -- use Bobs glow code
 cmdline_parm nomotiondebris_arg("-nomotiondebris", NULL, AT_NONE);		// Cmdline_nomotiondebris  -- Removes those ugly floating rocks -C
 cmdline_parm noscalevid_arg("-noscalevid", NULL, AT_NONE);				// Cmdline_noscalevid  -- disable video scaling that fits to window
+cmdline_parm hw_video_decode_arg("-hw_video_decode", NULL, AT_NONE);	// Cmdline_hw_video_decode
 cmdline_parm spec_arg("-nospec", NULL, AT_NONE);			// Cmdline_spec  --
 cmdline_parm noemissive_arg("-no_emissive_light", "Disable emissive light from ships", AT_NONE);		// Cmdline_no_emissive  -- don't use emissive light in OGL
 cmdline_parm normal_arg("-nonormal", NULL, AT_NONE);						// Cmdline_normal  -- disable normal mapping
@@ -322,6 +351,16 @@ cmdline_parm fb_explosions_arg("-fb_explosions", NULL, AT_NONE);
 cmdline_parm fb_thrusters_arg("-fb_thrusters", NULL, AT_NONE);
 cmdline_parm flightshaftsoff_arg("-nolightshafts", NULL, AT_NONE);
 cmdline_parm no_batching("-no_batching", NULL, AT_NONE);
+cmdline_parm no_texture_arrays("-no_texture_arrays", NULL, AT_NONE);
+cmdline_parm packed_vertices("-packed_vertices", NULL, AT_NONE);
+cmdline_parm generate_lods("-generate_lods", NULL, AT_NONE);
+cmdline_parm retained_draws("-retained_draws", NULL, AT_NONE);
+cmdline_parm cached_background("-cached_background", NULL, AT_NONE);
+cmdline_parm depth_prepass("-depth_prepass", NULL, AT_NONE);
+cmdline_parm vram_budget_arg("-vram_budget", "Texture memory budget in MB, 0 is unlimited", AT_INT);
+cmdline_parm bitmap_ram_budget_arg("-bitmap_ram_budget", "Bitmap data memory budget in MB, 0 is unlimited", AT_INT);
+cmdline_parm dynamic_res_arg("-dynamic_res", "GPU time in ms the 3D scene is held to by lowering its resolution, 0 is off", AT_FLOAT);
+cmdline_parm particle_budget_arg("-particle_budget", "Number of particles above which distant ones are skipped, 0 is unlimited", AT_INT);
 cmdline_parm shadow_quality_arg("-shadow_quality", NULL, AT_INT);
 cmdline_parm enable_shadows_arg("-enable_shadows", NULL, AT_NONE);
 cmdline_parm no_deferred_lighting_arg("-no_deferred", NULL, AT_NONE);	// Cmdline_no_deferred
@@ -336,6 +375,7 @@ int Cmdline_missile_lighting = 0;
 int Cmdline_glow = 1;
 int Cmdline_nomotiondebris = 0;
 int Cmdline_noscalevid = 0;
+bool Cmdline_hw_video_decode = false;
 int Cmdline_spec = 1;
 int Cmdline_no_emissive = 0;
 int Cmdline_normal = 1;
@@ -350,6 +390,16 @@ extern int Fxaa_preset_last_frame;
 bool Cmdline_fb_explosions = 0;
 bool Cmdline_fb_thrusters = false;
 bool Cmdline_no_batching = false;
+bool Cmdline_no_texture_arrays = false;
+bool Cmdline_packed_vertices = false;
+bool Cmdline_generate_lods = false;
+bool Cmdline_retained_draws = false;
+bool Cmdline_cached_background = false;
+bool Cmdline_depth_prepass = false;
+int Cmdline_vram_budget = 0;
+int Cmdline_bitmap_ram_budget = 0;
+int Cmdline_particle_budget = 0;
+float Cmdline_dynamic_res = 0.0f;
 extern bool ls_force_off;
 int Cmdline_shadow_quality = 0;
 int Cmdline_no_deferred_lighting = 0;
@@ -358,10 +408,16 @@ int Cmdline_no_deferred_lighting = 0;
 cmdline_parm cache_bitmaps_arg("-cache_bitmaps", NULL, AT_NONE);	// Cmdline_cache_bitmaps
 cmdline_parm no_fpscap("-no_fps_capping", "Don't limit frames-per-second", AT_NONE);	// Cmdline_NoFPSCap
 cmdline_parm no_vsync_arg("-no_vsync", NULL, AT_NONE);		// Cmdline_no_vsync
+cmdline_parm low_latency_fps_cap_arg("-low_latency_fps_cap", NULL, AT_NONE);	// Cmdline_low_latency_fps_cap
+cmdline_parm fixed_simulation_arg("-fixed_simulation", "Simulate this many steps per second and interpolate the frames in between", AT_INT);	// Cmdline_fixed_simulation
+cmdline_parm light_projectiles_arg("-light_projectiles", "Keep primary weapon bolts out of the object list until they get close to something", AT_NONE);	// Cmdline_light_projectiles
 
 int Cmdline_cache_bitmaps = 0;	// caching of bitmaps between missions (faster loads, can hit swap on reload with <512 Meg RAM though) - taylor
 int Cmdline_NoFPSCap = 0; // Disable FPS capping - kazan
 int Cmdline_no_vsync = 0;
+bool Cmdline_low_latency_fps_cap = false;
+int Cmdline_fixed_simulation = 0;
+bool Cmdline_light_projectiles = false;
 
 // HUD related
 cmdline_parm ballistic_gauge("-ballistic_gauge", NULL, AT_NONE);	// Cmdline_ballistic_gauge
@@ -400,6 +456,8 @@ int Cmdline_query_speech = 0;
 int Cmdline_snd_preload = 0; // preload game sounds during mission load
 int Cmdline_voice_recognition = 0;
 int Cmdline_no_enhanced_sound = 0;
+bool Cmdline_virtual_voices = false;
+int Cmdline_snd_ram_budget = 0;
 
 // MOD related
 cmdline_parm mod_arg("-mod", "List of folders to overwrite/add-to the default data", AT_STRING, true);	// Cmdline_mod  -- DTP modsupport
@@ -439,10 +497,17 @@ cmdline_parm no_drawrangeelements("-use_gldrawelements", NULL, AT_NONE); // Cmdl
 cmdline_parm keyboard_layout("-keyboard_layout", "Specify keyboard layout (qwertz or azerty)", AT_STRING);
 cmdline_parm old_collision_system("-old_collision", NULL, AT_NONE); // Cmdline_old_collision_sys
 cmdline_parm gl_finish ("-gl_finish", NULL, AT_NONE);
+cmdline_parm threaded_gl("-threaded_gl", NULL, AT_NONE);	// Cmdline_threaded_gl -- let the driver replay the GL commands on its own thread
 cmdline_parm no_geo_sdr_effects("-no_geo_effects", NULL, AT_NONE);
 cmdline_parm set_cpu_affinity("-set_cpu_affinity", NULL, AT_NONE);
 cmdline_parm nograb_arg("-nograb", NULL, AT_NONE);
 cmdline_parm noshadercache_arg("-noshadercache", NULL, AT_NONE);
+cmdline_parm no_parallel_shaders_arg("-no_parallel_shaders", NULL, AT_NONE); // Cmdline_no_parallel_shaders
+cmdline_parm model_cache_arg("-model_cache", NULL, AT_NONE); // Cmdline_model_cache
+cmdline_parm table_cache_arg("-table_cache", NULL, AT_NONE); // Cmdline_table_cache
+cmdline_parm texture_cache_arg("-texture_cache", NULL, AT_NONE); // Cmdline_texture_cache
+cmdline_parm mission_cache_arg("-mission_cache", NULL, AT_NONE); // Cmdline_mission_cache
+cmdline_parm gpu_particles_arg("-gpu_particles", NULL, AT_NONE); // Cmdline_gpu_particles
 #ifdef WIN32
 cmdline_parm fix_registry("-fix_registry", NULL, AT_NONE);
 #endif
@@ -457,10 +522,17 @@ int Cmdline_no_3d_sound = 0;
 int Cmdline_drawelements = 0;
 char* Cmdline_keyboard_layout = NULL;
 bool Cmdline_gl_finish = false;
+bool Cmdline_threaded_gl = false;
 bool Cmdline_no_geo_sdr_effects = false;
 bool Cmdline_set_cpu_affinity = false;
 bool Cmdline_nograb = false;
 bool Cmdline_noshadercache = false;
+bool Cmdline_no_parallel_shaders = false;
+bool Cmdline_model_cache = false;
+bool Cmdline_table_cache = false;
+bool Cmdline_texture_cache = false;
+bool Cmdline_mission_cache = false;
+bool Cmdline_gpu_particles = false;
 #ifdef WIN32
 bool Cmdline_alternate_registry_path = false;
 #endif
@@ -469,6 +541,11 @@ bool Cmdline_alternate_registry_path = false;
 cmdline_parm start_mission_arg("-start_mission", "Skip mainhall and run this mission", AT_STRING);	// Cmdline_start_mission
 cmdline_parm dis_collisions("-dis_collisions", NULL, AT_NONE);	// Cmdline_dis_collisions
 cmdline_parm dis_weapons("-dis_weapons", NULL, AT_NONE);		// Cmdline_dis_weapons
+cmdline_parm collision_hash_arg("-collision_hash", NULL, AT_NONE);	// Collision_broadphase
+cmdline_parm parallel_collide_arg("-parallel_collide", NULL, AT_NONE);	// Collision_parallel_narrowphase
+cmdline_parm parallel_physics_arg("-parallel_physics", NULL, AT_NONE);	// Physics_parallel_integration
+cmdline_parm ai_lod_arg("-ai_lod", NULL, AT_NONE);	// Ai_lod_enabled
+cmdline_parm parallel_ai_arg("-parallel_ai", NULL, AT_NONE);	// Ai_parallel_think
 cmdline_parm noparseerrors_arg("-noparseerrors", NULL, AT_NONE);	// Cmdline_noparseerrors  -- turns off parsing errors -C
 cmdline_parm extra_warn_arg("-extra_warn", "Enable 'extra' warnings", AT_NONE);	// Cmdline_extra_warn
 cmdline_parm fps_arg("-fps", NULL, AT_NONE);					// Cmdline_show_fps
@@ -485,11 +562,22 @@ cmdline_parm reparse_mainhall_arg("-reparse_mainhall", NULL, AT_NONE); //Cmdline
 cmdline_parm frame_profile_write_file("-profile_write_file", NULL, AT_NONE); // Cmdline_profile_write_file
 cmdline_parm no_unfocused_pause_arg("-no_unfocused_pause", NULL, AT_NONE); //Cmdline_no_unfocus_pause
 cmdline_parm benchmark_mode_arg("-benchmark_mode", NULL, AT_NONE); //Cmdline_benchmark_mode
+cmdline_parm benchmark_simulation_arg("-benchmark_simulation", "Simulate this many frames of -start_mission without graphics", AT_INT); // Cmdline_benchmark_simulation
+cmdline_parm benchmark_seed_arg("-benchmark_seed", "Random seed of -benchmark_simulation", AT_INT); // Cmdline_benchmark_seed
+cmdline_parm benchmark_flythrough_arg("-benchmark_flythrough", "Fly along a path of -start_mission for this many seconds and time the frames", AT_FLOAT); // Cmdline_benchmark_flythrough
 cmdline_parm noninteractive_arg("-noninteractive", NULL, AT_NONE); //Cmdline_noninteractive
+cmdline_parm record_replay_arg("-record_replay", "Record the controls of the first mission to this file", AT_STRING); // Cmdline_record_replay
+cmdline_parm play_replay_arg("-play_replay", "Play back the mission and controls of a -record_replay file", AT_STRING); // Cmdline_play_replay
 cmdline_parm json_pilot("-json_pilot", NULL, AT_NONE); //Cmdline_json_pilot
 cmdline_parm json_profiling("-json_profiling", NULL, AT_NONE); //Cmdline_json_profiling
+cmdline_parm track_allocations_arg("-track_allocations", "Count the heap allocations per frame and trace scope, see alloc_stats", AT_NONE); // Cmdline_track_allocations
+cmdline_parm binary_profiling_arg("-binary_profiling", "Write the trace events compressed to tracing/trace.fstrace, see traceconv", AT_NONE); // Cmdline_binary_profiling
+cmdline_parm profile_network_arg("-profile_network", NULL, AT_NONE); //Cmdline_profile_network
+cmdline_parm flight_recorder_arg("-flight_recorder", "Keep the trace events of this many seconds in memory", AT_FLOAT); // Cmdline_flight_recorder
+cmdline_parm flight_recorder_hitch_arg("-flight_recorder_hitch", "Write out the flight recorder when a frame takes this many ms (default 200, 0 for never)", AT_INT); // Cmdline_flight_recorder_hitch
 cmdline_parm show_video_info("-show_video_info", NULL, AT_NONE); //Cmdline_show_video_info
 cmdline_parm frame_profile_arg("-profile_frame_time", NULL, AT_NONE); //Cmdline_frame_profile
+cmdline_parm frame_budget_graph_arg("-frame_budget_graph", "Graph the frame time of the main subsystems, see frame_budget", AT_NONE); // Cmdline_frame_budget_graph
 cmdline_parm debug_window_arg("-debug_window", NULL, AT_NONE);	// Cmdline_debug_window
 
 
@@ -514,10 +602,21 @@ int Cmdline_reparse_mainhall = 0;
 bool Cmdline_profile_write_file = false;
 bool Cmdline_no_unfocus_pause = false;
 bool Cmdline_benchmark_mode = false;
+int Cmdline_benchmark_simulation = 0;
+int Cmdline_benchmark_seed = 0;
+float Cmdline_benchmark_flythrough = 0.0f;
 bool Cmdline_noninteractive = false;
+char *Cmdline_record_replay = NULL;
+char *Cmdline_play_replay = NULL;
 bool Cmdline_json_pilot = false;
 bool Cmdline_json_profiling = false;
+bool Cmdline_binary_profiling = false;
+bool Cmdline_track_allocations = false;
+float Cmdline_flight_recorder = 0.0f;
+int Cmdline_flight_recorder_hitch = 200;
+bool Cmdline_profile_network = false;
 bool Cmdline_frame_profile = false;
+bool Cmdline_frame_budget_graph = false;
 bool Cmdline_show_video_info = false;
 bool Cmdline_debug_window = false;
 
@@ -1298,6 +1397,24 @@ bool SetCmdlineParams()
 		Cmdline_NoFPSCap = 1;
 	}
 
+	// wait for the framerate cap before the input is read instead of after it
+	if (low_latency_fps_cap_arg.found())
+	{
+		Cmdline_low_latency_fps_cap = true;
+	}
+
+	// only single player missions run in fixed steps, see game_fixed_simulation_active()
+	if (fixed_simulation_arg.found())
+	{
+		Cmdline_fixed_simulation = MAX(fixed_simulation_arg.get_int(), 0);
+	}
+
+	// only single player missions use the projectiles, see projectile_can_create()
+	if (light_projectiles_arg.found())
+	{
+		Cmdline_light_projectiles = true;
+	}
+
 	if(loadallweapons_arg.found())
 	{
 		Cmdline_load_all_weapons = 1;
@@ -1379,6 +1496,16 @@ bool SetCmdlineParams()
 		Cmdline_no_enhanced_sound = 1;
 	}
 
+	// keep the 3D sounds which can't get a channel and give them one when they are audible enough
+	if (virtual_voices_arg.found()) {
+		Cmdline_virtual_voices = true;
+	}
+
+	// decode the sounds which don't play all the time when they are played and evict them to stay in the budget
+	if (snd_ram_budget_arg.found()) {
+		Cmdline_snd_ram_budget = MAX(snd_ram_budget_arg.get_int(), 0);
+	}
+
 	// should we start a network game
 	if ( startgame_arg.found() ) {
 		Cmdline_use_last_pilot = 1;
@@ -1428,6 +1555,11 @@ bool SetCmdlineParams()
 		Cmdline_network_port = port_arg.get_int();
 	}
 
+	// how many games a standalone server hosts, each one on its own port
+	if ( standalone_sessions_arg.found() ) {
+		Cmdline_standalone_sessions = standalone_sessions_arg.get_int();
+	}
+
 	// the connect argument specifies to join a game at this particular address
 	if ( connect_arg.found() ) {
 		Cmdline_use_last_pilot = 1;
@@ -1500,6 +1632,11 @@ bool SetCmdlineParams()
 		Cmdline_noscalevid = 1;
 	}
 
+	// let FFmpeg decode the movies with the video hardware if the codec and the driver support it
+	if ( hw_video_decode_arg.found() ) {
+		Cmdline_hw_video_decode = true;
+	}
+
 	if(noparseerrors_arg.found()) {
 		Cmdline_noparseerrors = 1;
 	}
@@ -1690,6 +1827,11 @@ bool SetCmdlineParams()
 		Cmdline_gl_finish = true;
 	}
 
+	if (threaded_gl.found())
+	{
+		Cmdline_threaded_gl = true;
+	}
+
 	if ( no_geo_sdr_effects.found() )
 	{
 		Cmdline_no_geo_sdr_effects = true;
@@ -1710,6 +1852,36 @@ bool SetCmdlineParams()
 		Cmdline_noshadercache = true;
 	}
 
+	if (no_parallel_shaders_arg.found())
+	{
+		Cmdline_no_parallel_shaders = true;
+	}
+
+	if (model_cache_arg.found())
+	{
+		Cmdline_model_cache = true;
+	}
+
+	if (table_cache_arg.found())
+	{
+		Cmdline_table_cache = true;
+	}
+
+	if (texture_cache_arg.found())
+	{
+		Cmdline_texture_cache = true;
+	}
+
+	if (mission_cache_arg.found())
+	{
+		Cmdline_mission_cache = true;
+	}
+
+	if (gpu_particles_arg.found())
+	{
+		Cmdline_gpu_particles = true;
+	}
+
 	if (portable_mode.found())
 	{
 		Cmdline_portable_mode = true;
@@ -1747,6 +1919,21 @@ bool SetCmdlineParams()
 	if(dis_weapons.found())
 		Cmdline_dis_weapons = 1;
 
+	if ( collision_hash_arg.found() )
+		Collision_broadphase = COLLISION_BROADPHASE_HASH;
+
+	if ( parallel_collide_arg.found() )
+		Collision_parallel_narrowphase = true;
+
+	if ( parallel_physics_arg.found() )
+		Physics_parallel_integration = true;
+
+	if ( ai_lod_arg.found() )
+		Ai_lod_enabled = true;
+
+	if ( parallel_ai_arg.found() )
+		Ai_parallel_think = true;
+
 	if ( no_fbo_arg.found() ) {
 		Cmdline_no_fbo = 1;
 	}
@@ -1806,6 +1993,56 @@ bool SetCmdlineParams()
 		Cmdline_no_batching = true;
 	}
 
+	if ( no_texture_arrays.found() )
+	{
+		Cmdline_no_texture_arrays = true;
+	}
+
+	if ( packed_vertices.found() )
+	{
+		Cmdline_packed_vertices = true;
+	}
+
+	if ( generate_lods.found() )
+	{
+		Cmdline_generate_lods = true;
+	}
+
+	if ( retained_draws.found() )
+	{
+		Cmdline_retained_draws = true;
+	}
+
+	if ( cached_background.found() )
+	{
+		Cmdline_cached_background = true;
+	}
+
+	if ( depth_prepass.found() )
+	{
+		Cmdline_depth_prepass = true;
+	}
+
+	if ( vram_budget_arg.found() )
+	{
+		Cmdline_vram_budget = MAX(vram_budget_arg.get_int(), 0);
+	}
+
+	if ( bitmap_ram_budget_arg.found() )
+	{
+		Cmdline_bitmap_ram_budget = MAX(bitmap_ram_budget_arg.get_int(), 0);
+	}
+
+	if ( particle_budget_arg.found() )
+	{
+		Cmdline_particle_budget = MAX(particle_budget_arg.get_int(), 0);
+	}
+
+	if ( dynamic_res_arg.found() )
+	{
+		Cmdline_dynamic_res = MAX(dynamic_res_arg.get_float(), 0.0f);
+	}
+
 	if ( postprocess_arg.found() )
 	{
 		Cmdline_postprocess = 1;
@@ -1856,11 +2093,49 @@ bool SetCmdlineParams()
 		Cmdline_benchmark_mode = true;
 	}
 
+	// the simulation benchmark goes straight into the mission and quits when it is done, without anything to wait for
+	if (benchmark_simulation_arg.found())
+	{
+		Cmdline_benchmark_simulation = benchmark_simulation_arg.get_int();
+
+		if (Cmdline_benchmark_simulation > 0) {
+			Cmdline_benchmark_mode = true;
+			Cmdline_noninteractive = true;
+		}
+	}
+
+	if (benchmark_seed_arg.found())
+	{
+		Cmdline_benchmark_seed = benchmark_seed_arg.get_int();
+	}
+
+	// the flythrough benchmark needs the frame times, see MainFrameTimer
+	if (benchmark_flythrough_arg.found())
+	{
+		Cmdline_benchmark_flythrough = benchmark_flythrough_arg.get_float();
+
+		if (Cmdline_benchmark_flythrough > 0.0f) {
+			Cmdline_benchmark_mode = true;
+			Cmdline_noninteractive = true;
+			Cmdline_profile_write_file = true;
+		}
+	}
+
 	if (noninteractive_arg.found())
 	{
 		Cmdline_noninteractive = true;
 	}
 
+	if (record_replay_arg.found())
+	{
+		Cmdline_record_replay = record_replay_arg.str();
+	}
+
+	if (play_replay_arg.found())
+	{
+		Cmdline_play_replay = play_replay_arg.str();
+	}
+
 	if (json_pilot.found())
 	{
 		Cmdline_json_pilot = true;
@@ -1871,11 +2146,41 @@ bool SetCmdlineParams()
 		Cmdline_json_profiling = true;
 	}
 
+	if (binary_profiling_arg.found())
+	{
+		Cmdline_binary_profiling = true;
+	}
+
+	if (track_allocations_arg.found())
+	{
+		Cmdline_track_allocations = true;
+	}
+
+	if (profile_network_arg.found())
+	{
+		Cmdline_profile_network = true;
+	}
+
+	if (flight_recorder_arg.found())
+	{
+		Cmdline_flight_recorder = flight_recorder_arg.get_float();
+	}
+
+	if (flight_recorder_hitch_arg.found())
+	{
+		Cmdline_flight_recorder_hitch = flight_recorder_hitch_arg.get_int();
+	}
+
 	if (frame_profile_arg.found() )
 	{
 		Cmdline_frame_profile = true;
 	}
 
+	if (frame_budget_graph_arg.found())
+	{
+		Cmdline_frame_budget_graph = true;
+	}
+
 	if (debug_window_arg.found()) {
 		Cmdline_debug_window = true;
 	}
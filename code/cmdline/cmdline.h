@@ -40,6 +40,7 @@ extern int Cmdline_multi_log;
 extern int Cmdline_multi_stream_chat_to_file;
 extern int Cmdline_network_port;
 extern int Cmdline_restricted_game;
+extern int Cmdline_standalone_sessions;
 extern int Cmdline_spew_pof_info;
 extern int Cmdline_start_netgame;
 extern int Cmdline_timeout;
@@ -66,6 +67,7 @@ extern int Cmdline_missile_lighting;
 extern int Cmdline_glow;
 extern int Cmdline_nomotiondebris;
 extern int Cmdline_noscalevid;	// disables fit-to-window for movies - taylor
+extern bool Cmdline_hw_video_decode;
 extern int Cmdline_spec;
 extern int Cmdline_normal;
 extern int Cmdline_height;
@@ -78,6 +80,16 @@ extern int Cmdline_fxaa_preset;
 extern bool Cmdline_fb_explosions;
 extern bool Cmdline_fb_thrusters;
 extern bool Cmdline_no_batching;
+extern bool Cmdline_no_texture_arrays;
+extern bool Cmdline_packed_vertices;
+extern bool Cmdline_generate_lods;
+extern bool Cmdline_retained_draws;
+extern bool Cmdline_cached_background;
+extern bool Cmdline_depth_prepass;
+extern int Cmdline_vram_budget;
+extern int Cmdline_bitmap_ram_budget;
+extern int Cmdline_particle_budget;
+extern float Cmdline_dynamic_res;
 extern int Cmdline_shadow_quality;
 extern int Cmdline_no_deferred_lighting;
 extern int Cmdline_no_emissive;
@@ -86,6 +98,9 @@ extern int Cmdline_no_emissive;
 extern int Cmdline_cache_bitmaps;
 extern int Cmdline_NoFPSCap;
 extern int Cmdline_no_vsync;
+extern bool Cmdline_low_latency_fps_cap;
+extern int Cmdline_fixed_simulation;
+extern bool Cmdline_light_projectiles;
 
 // HUD related
 extern int Cmdline_ballistic_gauge;
@@ -107,6 +122,8 @@ extern int Cmdline_query_speech;
 extern int Cmdline_snd_preload;
 extern int Cmdline_voice_recognition;
 extern int Cmdline_no_enhanced_sound;
+extern bool Cmdline_virtual_voices;
+extern int Cmdline_snd_ram_budget;
 
 // MOD related
 extern char *Cmdline_mod;	 // DTP for mod support
@@ -133,10 +150,17 @@ extern int Cmdline_no_3d_sound;
 extern int Cmdline_drawelements;
 extern char* Cmdline_keyboard_layout;
 extern bool Cmdline_gl_finish;
+extern bool Cmdline_threaded_gl;
 extern bool Cmdline_no_geo_sdr_effects;
 extern bool Cmdline_set_cpu_affinity;
 extern bool Cmdline_nograb;
 extern bool Cmdline_noshadercache;
+extern bool Cmdline_no_parallel_shaders;
+extern bool Cmdline_model_cache;
+extern bool Cmdline_table_cache;
+extern bool Cmdline_texture_cache;
+extern bool Cmdline_mission_cache;
+extern bool Cmdline_gpu_particles;
 #ifdef WIN32
 extern bool Cmdline_alternate_registry_path;
 #endif
@@ -156,10 +180,21 @@ extern int Cmdline_reparse_mainhall;
 extern bool Cmdline_profile_write_file;
 extern bool Cmdline_no_unfocus_pause;
 extern bool Cmdline_benchmark_mode;
+extern int Cmdline_benchmark_simulation;
+extern int Cmdline_benchmark_seed;
+extern float Cmdline_benchmark_flythrough;
 extern bool Cmdline_noninteractive;
+extern char *Cmdline_record_replay;
+extern char *Cmdline_play_replay;
 extern bool Cmdline_json_pilot;
 extern bool Cmdline_json_profiling;
+extern bool Cmdline_binary_profiling;
+extern bool Cmdline_track_allocations;
+extern float Cmdline_flight_recorder;
+extern int Cmdline_flight_recorder_hitch;
+extern bool Cmdline_profile_network;
 extern bool Cmdline_frame_profile;
+extern bool Cmdline_frame_budget_graph;
 extern bool Cmdline_show_video_info;
 extern bool Cmdline_debug_window;
 
@@ -3,6 +3,7 @@
 #include "cutscene/ffmpeg/FFMPEGDecoder.h"
 
 #include "cfile/cfile.h"
+#include "cmdline/cmdline.h"
 #include "libs/ffmpeg/FFmpegContext.h"
 
 #include "cutscene/ffmpeg/internal.h"
@@ -73,6 +74,74 @@ CodecContextParameters getCodecParameters(AVStream* stream) {
 #endif
     return paras;
 }
+
+#ifdef CUTSCENE_FFMPEG_HWACCEL
+// The hardware decoders in the order they are tried, only the ones of the current platform can be created
+const AVHWDeviceType HW_DEVICE_TYPES[] = {
+	AV_HWDEVICE_TYPE_D3D11VA,
+	AV_HWDEVICE_TYPE_DXVA2,
+	AV_HWDEVICE_TYPE_VAAPI,
+	AV_HWDEVICE_TYPE_VIDEOTOOLBOX,
+};
+
+AVPixelFormat getHardwareFormat(AVCodecContext* ctx, const AVPixelFormat* formats) {
+	auto status = static_cast<DecoderStatus*>(ctx->opaque);
+
+	for (auto fmt = formats; *fmt != AV_PIX_FMT_NONE; ++fmt) {
+		if (*fmt == status->hwPixelFormat) {
+			return *fmt;
+		}
+	}
+
+	// The hardware can't decode this stream, use the first software format instead
+	mprintf(("FFmpeg: Hardware decoding is not supported for this video, falling back to software decoding.\n"));
+	status->hwPixelFormat = AV_PIX_FMT_NONE;
+
+	for (auto fmt = formats; *fmt != AV_PIX_FMT_NONE; ++fmt) {
+		auto desc = av_pix_fmt_desc_get(*fmt);
+
+		if (desc != nullptr && !(desc->flags & AV_PIX_FMT_FLAG_HWACCEL)) {
+			return *fmt;
+		}
+	}
+
+	return AV_PIX_FMT_NONE;
+}
+
+void setupHardwareDecoding(DecoderStatus* status) {
+	for (auto type : HW_DEVICE_TYPES) {
+		for (int i = 0;; ++i) {
+			auto config = avcodec_get_hw_config(status->videoCodec, i);
+
+			if (config == nullptr) {
+				break;
+			}
+
+			if (!(config->methods & AV_CODEC_HW_CONFIG_METHOD_HW_DEVICE_CTX) || config->device_type != type) {
+				continue;
+			}
+
+			AVBufferRef* device = nullptr;
+			if (av_hwdevice_ctx_create(&device, type, nullptr, nullptr, 0) < 0) {
+				// Not available on this system
+				break;
+			}
+
+			status->hwDeviceCtx = device;
+			status->hwPixelFormat = config->pix_fmt;
+
+			status->videoCodecCtx->hw_device_ctx = av_buffer_ref(device);
+			status->videoCodecCtx->opaque = status;
+			status->videoCodecCtx->get_format = getHardwareFormat;
+
+			mprintf(("FFmpeg: Using %s for hardware video decoding.\n", av_hwdevice_get_type_name(type)));
+			return;
+		}
+	}
+
+	mprintf(("FFmpeg: No hardware video decoder is available for %s, using software decoding.\n", status->videoCodec->name));
+}
+#endif
 }
 
 namespace cutscene {
@@ -173,7 +242,28 @@ std::unique_ptr<DecoderStatus> initializeStatus(std::unique_ptr<InputStream>& st
 	status->videoCodecCtx = status->videoStream->codec;
 #endif
 
+	if (Cmdline_hw_video_decode) {
+#ifdef CUTSCENE_FFMPEG_HWACCEL
+		setupHardwareDecoding(status.get());
+#else
+		mprintf(("FFmpeg: This FFmpeg version can't decode videos with the video hardware, using software decoding.\n"));
+#endif
+	}
+
 	err = avcodec_open2(status->videoCodecCtx, status->videoCodec, nullptr);
+#ifdef CUTSCENE_FFMPEG_HWACCEL
+	if (err < 0 && status->hwDeviceCtx != nullptr) {
+		mprintf(("FFmpeg: Failed to open the video codec with hardware decoding, falling back to software decoding.\n"));
+
+		av_buffer_unref(&status->videoCodecCtx->hw_device_ctx);
+		status->videoCodecCtx->get_format = avcodec_default_get_format;
+
+		av_buffer_unref(&status->hwDeviceCtx);
+		status->hwPixelFormat = AV_PIX_FMT_NONE;
+
+		err = avcodec_open2(status->videoCodecCtx, status->videoCodec, nullptr);
+	}
+#endif
 	if (err < 0) {
 		char errorStr[512];
 		av_strerror(err, errorStr, sizeof(errorStr));
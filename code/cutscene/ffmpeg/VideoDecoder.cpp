@@ -2,6 +2,8 @@
 
 #include "tracing/tracing.h"
 
+#include <mutex>
+
 namespace {
 const AVPixelFormat DESTINATION_FORMAT = AV_PIX_FMT_YUV420P;
 
@@ -17,15 +19,56 @@ double getFrameTime(int64_t pts, AVRational time_base) {
 
 namespace cutscene {
 namespace ffmpeg {
+/**
+ * @brief The pictures the player is done with
+ *
+ * The frames are handed back here by the main thread and handed out again on the decoder thread so a movie only
+ * allocates as many pictures as there are frames in flight.
+ */
+class VideoFramePool {
+	std::mutex m_lock;
+	SCP_vector<AVFrame*> m_frames;
+
+ public:
+	~VideoFramePool() {
+		for (auto frame : m_frames) {
+			av_frame_free(&frame);
+		}
+	}
+
+	AVFrame* get() {
+		std::lock_guard<std::mutex> guard(m_lock);
+
+		if (m_frames.empty()) {
+			return av_frame_alloc();
+		}
+
+		auto frame = m_frames.back();
+		m_frames.pop_back();
+
+		return frame;
+	}
+
+	void put(AVFrame* frame) {
+		std::lock_guard<std::mutex> guard(m_lock);
+
+		m_frames.push_back(frame);
+	}
+};
+
 class FFMPEGVideoFrame: public VideoFrame {
  public:
-	FFMPEGVideoFrame() : frame(nullptr) {
+	explicit FFMPEGVideoFrame(const std::shared_ptr<VideoFramePool>& pool) : frame(nullptr), referenced(false), m_pool(pool) {
 	}
 
 	virtual ~FFMPEGVideoFrame() {
 		if (frame != nullptr) {
-			av_freep(&frame->data[0]);
-			av_frame_free(&frame);
+			if (referenced) {
+				// give the picture back to the codec, the converted pictures keep their own buffers for the next frame
+				av_frame_unref(frame);
+			}
+
+			m_pool->put(frame);
 		}
 	}
 
@@ -39,48 +82,78 @@ class FFMPEGVideoFrame: public VideoFrame {
 	}
 
 	AVFrame* frame;
+	bool referenced; //!< The frame is a reference to the picture of the codec instead of a converted copy
+
+ private:
+	std::shared_ptr<VideoFramePool> m_pool;
 };
 
 VideoDecoder::VideoDecoder(DecoderStatus* status)
 	: FFMPEGStreamDecoder(status),
-	  m_frameId(0) {
+	  m_frameId(0), m_framePool(std::make_shared<VideoFramePool>()) {
 	m_swsCtx = getSWSContext(m_status->videoCodecPars.width, m_status->videoCodecPars.height,
 							 m_status->videoCodecPars.pixel_format);
+	m_transferFrame = av_frame_alloc();
 }
 
 VideoDecoder::~VideoDecoder() {
 	sws_freeContext(m_swsCtx);
+	av_frame_free(&m_transferFrame);
 }
 
 void VideoDecoder::convertAndPushPicture(const AVFrame* frame) {
-	// Allocate a picture to hold the YUV data
-	AVFrame* yuvFrame = av_frame_alloc();
-	av_frame_copy(yuvFrame, frame);
-	yuvFrame->format = DESTINATION_FORMAT;
-
-	av_image_alloc(yuvFrame->data,
-				   yuvFrame->linesize,
-				   m_status->videoCodecPars.width,
-				   m_status->videoCodecPars.height,
-				   DESTINATION_FORMAT,
-				   1);
-
-	std::unique_ptr<FFMPEGVideoFrame> videoFramePtr(new FFMPEGVideoFrame());
-
-	if (m_status->videoCodecPars.pixel_format == DESTINATION_FORMAT) {
-		av_image_copy(yuvFrame->data,
-					  yuvFrame->linesize,
-					  (const uint8_t**) (frame->data),
-					  frame->linesize,
-					  DESTINATION_FORMAT,
-					  m_status->videoCodecPars.width,
-					  m_status->videoCodecPars.height);
+	std::unique_ptr<FFMPEGVideoFrame> videoFramePtr(new FFMPEGVideoFrame(m_framePool));
+
+	AVFrame* yuvFrame = m_framePool->get();
+	videoFramePtr->frame = yuvFrame;
+
+	auto picture = frame;
+
+#ifdef CUTSCENE_FFMPEG_HWACCEL
+	if (m_status->hwPixelFormat != AV_PIX_FMT_NONE && frame->format == m_status->hwPixelFormat) {
+		TRACE_SCOPE(tracing::CutsceneFFmpegVideoTransfer);
+
+		// The picture is still in video memory. The transfer frame keeps its buffers from the last frame so this only
+		// allocates once.
+		auto err = av_hwframe_transfer_data(m_transferFrame, frame, 0);
+		if (err < 0) {
+			char errorStr[512];
+			av_strerror(err, errorStr, sizeof(errorStr));
+			mprintf(("FFmpeg: Failed to transfer a hardware decoded frame! Error: %s\n", errorStr));
+			return;
+		}
+
+		picture = m_transferFrame;
+	}
+#endif
+
+	tracing::counter::value(tracing::CutsceneFFmpegVideoHardware, picture != frame ? 1.0f : 0.0f);
+
+	if (picture == frame && picture->format == DESTINATION_FORMAT) {
+		// The picture already has the right format so the player can use the one of the codec. The codec only reuses
+		// it once the player is done with the frame.
+		av_frame_ref(yuvFrame, frame);
+		videoFramePtr->referenced = true;
 	} else {
+		if (yuvFrame->data[0] == nullptr) {
+			yuvFrame->format = DESTINATION_FORMAT;
+			yuvFrame->width = m_status->videoCodecPars.width;
+			yuvFrame->height = m_status->videoCodecPars.height;
+
+			av_frame_get_buffer(yuvFrame, 32);
+		}
+
+		// The frames of the hardware decoder are mostly NV12, the context is only created again if the format changes
+		m_swsCtx = sws_getCachedContext(m_swsCtx, m_status->videoCodecPars.width, m_status->videoCodecPars.height,
+										(AVPixelFormat) picture->format, m_status->videoCodecPars.width,
+										m_status->videoCodecPars.height, DESTINATION_FORMAT, SWS_BILINEAR, nullptr,
+										nullptr, nullptr);
+
 		// Convert frame to YUV
 		sws_scale(
 			m_swsCtx,
-			(uint8_t const* const*) frame->data,
-			frame->linesize,
+			(uint8_t const* const*) picture->data,
+			picture->linesize,
 			0,
 			m_status->videoCodecPars.height,
 			yuvFrame->data,
@@ -90,7 +163,6 @@ void VideoDecoder::convertAndPushPicture(const AVFrame* frame) {
 
 	videoFramePtr->id = ++m_frameId;
 	videoFramePtr->frameTime = getFrameTime(av_frame_get_best_effort_timestamp(frame), m_status->videoStream->time_base);
-	videoFramePtr->frame = yuvFrame;
 
 	videoFramePtr->ySize.height = static_cast<size_t>(m_status->videoCodecPars.height);
 	videoFramePtr->ySize.width = static_cast<size_t>(m_status->videoCodecPars.width);
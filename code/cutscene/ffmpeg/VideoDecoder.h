@@ -5,10 +5,14 @@
 
 namespace cutscene {
 namespace ffmpeg {
+class VideoFramePool;
+
 class VideoDecoder: public FFMPEGStreamDecoder<VideoFrame> {
  private:
 	int m_frameId;
 	SwsContext* m_swsCtx;
+	std::shared_ptr<VideoFramePool> m_framePool;
+	AVFrame* m_transferFrame; //!< The frame a picture of the hardware decoder is copied into
 
 	void convertAndPushPicture(const AVFrame* frame);
 
@@ -19,6 +19,11 @@ DecoderStatus::~DecoderStatus() {
 		videoCodecCtx = nullptr;
 	}
 
+	if (hwDeviceCtx != nullptr) {
+		av_buffer_unref(&hwDeviceCtx);
+	}
+	hwPixelFormat = AV_PIX_FMT_NONE;
+
 	audioStreamIndex = -1;
 	audioStream = nullptr;
 	audioCodec = nullptr;
@@ -6,6 +6,15 @@
 
 #include "cutscene/Decoder.h"
 
+// The hardware decoding API which came with FFmpeg 4.0
+#if !defined(WITH_LIBAV) && LIBAVCODEC_VERSION_INT >= AV_VERSION_INT(58, 18, 100)
+#define CUTSCENE_FFMPEG_HWACCEL
+
+extern "C" {
+#include <libavutil/hwcontext.h>
+}
+#endif
+
 namespace cutscene {
 namespace ffmpeg {
 struct CodecContextParameters {
@@ -25,6 +34,10 @@ struct DecoderStatus {
 	AVCodec* videoCodec = nullptr;
 	AVCodecContext* videoCodecCtx = nullptr;
 
+	// set when the video is decoded by the video hardware, the frames have hwPixelFormat then
+	AVBufferRef* hwDeviceCtx = nullptr;
+	AVPixelFormat hwPixelFormat = AV_PIX_FMT_NONE;
+
 	int audioStreamIndex = -1;
 	AVStream* audioStream = nullptr;
 	CodecContextParameters audioCodecPars;
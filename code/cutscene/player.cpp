@@ -443,6 +443,8 @@ void Player::startPlayback() {
 }
 
 void Player::decoderThread() {
+	tracing::set_thread_name("Cutscene decoder");
+
 	try {
 		m_decoder->startDecoding();
 	} catch (const std::exception& e) {
@@ -31,6 +31,8 @@ OpenGLVideoPresenter::OpenGLVideoPresenter(const MovieProperties& props) : _scal
 	if (_ytex + _utex + _vtex == 0) {
 		throw std::runtime_error("Can't create a GL texture");
 	}
+
+	glGenBuffers(NUM_PIXEL_BUFFERS, _pixelBuffers);
 	opengl_shader_set_current(_sdr_handle);
 
 	gr_set_lighting(false, false);
@@ -112,12 +114,12 @@ OpenGLVideoPresenter::OpenGLVideoPresenter(const MovieProperties& props) : _scal
 	int screenXW = screenX + static_cast<int>(props.size.width);
 	int screenYH = screenY + static_cast<int>(props.size.height);
 
-	Current_shader->program->Uniforms.setUniformi("ytex", 0);
-	Current_shader->program->Uniforms.setUniformi("utex", 1);
-	Current_shader->program->Uniforms.setUniformi("vtex", 2);
+	Current_shader->program->Uniforms.setUniformi(SDR_UNIFORM("ytex"), 0);
+	Current_shader->program->Uniforms.setUniformi(SDR_UNIFORM("utex"), 1);
+	Current_shader->program->Uniforms.setUniformi(SDR_UNIFORM("vtex"), 2);
 
-	Current_shader->program->Uniforms.setUniformMatrix4f("projMatrix", GL_projection_matrix);
-	Current_shader->program->Uniforms.setUniformMatrix4f("modelViewMatrix", GL_model_view_matrix);
+	Current_shader->program->Uniforms.setUniformMatrix4f(SDR_UNIFORM("projMatrix"), GL_projection_matrix);
+	Current_shader->program->Uniforms.setUniformMatrix4f(SDR_UNIFORM("modelViewMatrix"), GL_model_view_matrix);
 
 	GLfloat glVertices[4][4] = {{0}};
 	glVertices[0][0] = (GLfloat)screenX;
@@ -163,6 +165,8 @@ OpenGLVideoPresenter::~OpenGLVideoPresenter() {
 	glDeleteTextures(1, &_utex);
 	glDeleteTextures(1, &_vtex);
 
+	glDeleteBuffers(NUM_PIXEL_BUFFERS, _pixelBuffers);
+
 	opengl_set_texture_target();
 
 	_ytex = _utex = _vtex = 0;
@@ -173,6 +177,45 @@ void OpenGLVideoPresenter::uploadVideoFrame(const VideoFramePtr& frame) {
 	GR_DEBUG_SCOPE("Update video frame");
 	auto ptrs = frame->getDataPointers();
 
+	auto yBytes = frame->ySize.stride * frame->ySize.height;
+	auto uvBytes = frame->uvSize.stride * frame->uvSize.height;
+	auto size = yBytes + 2 * uvBytes;
+
+	// The buffers only grow with the first frame since all frames of a movie have the same size
+	if (_pixelBufferSize < size) {
+		for (auto buffer : _pixelBuffers) {
+			glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buffer);
+			glBufferData(GL_PIXEL_UNPACK_BUFFER, (GLsizeiptr)size, nullptr, GL_STREAM_DRAW);
+		}
+		_pixelBufferSize = size;
+	}
+
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, _pixelBuffers[_nextPixelBuffer]);
+	_nextPixelBuffer = (_nextPixelBuffer + 1) % NUM_PIXEL_BUFFERS;
+
+	auto dest = static_cast<ubyte*>(glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, (GLsizeiptr)size,
+		GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT));
+
+	if (dest == nullptr) {
+		// Upload straight from the frame then
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+		uploadPlanes(frame, ptrs.y, ptrs.u, ptrs.v);
+		return;
+	}
+
+	memcpy(dest, ptrs.y, yBytes);
+	memcpy(dest + yBytes, ptrs.u, uvBytes);
+	memcpy(dest + yBytes + uvBytes, ptrs.v, uvBytes);
+
+	glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+
+	// The data pointers are offsets into the pixel buffer now
+	uploadPlanes(frame, nullptr, reinterpret_cast<const ubyte*>(yBytes), reinterpret_cast<const ubyte*>(yBytes + uvBytes));
+
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+}
+
+void OpenGLVideoPresenter::uploadPlanes(const VideoFramePtr& frame, const ubyte* y, const ubyte* u, const ubyte* v) {
 	auto stride = static_cast<GLint>(frame->ySize.stride);
 	auto width = static_cast<GLint>(frame->ySize.width);
 	auto height = static_cast<GLint>(frame->ySize.height);
@@ -180,8 +223,7 @@ void OpenGLVideoPresenter::uploadVideoFrame(const VideoFramePtr& frame) {
 	GL_state.Texture.SetActiveUnit(0);
 	GL_state.Texture.Enable(_ytex);
 	glPixelStorei(GL_UNPACK_ROW_LENGTH, stride);
-	glTexSubImage2D(GL_state.Texture.GetTarget(), 0, 0, 0, width, height, GL_RED, GL_UNSIGNED_BYTE,
-					ptrs.y);
+	glTexSubImage2D(GL_state.Texture.GetTarget(), 0, 0, 0, width, height, GL_RED, GL_UNSIGNED_BYTE, y);
 
 	stride = static_cast<int>(frame->uvSize.stride);
 	width = static_cast<int>(frame->uvSize.width);
@@ -190,13 +232,11 @@ void OpenGLVideoPresenter::uploadVideoFrame(const VideoFramePtr& frame) {
 	GL_state.Texture.SetActiveUnit(1);
 	GL_state.Texture.Enable(_utex);
 	glPixelStorei(GL_UNPACK_ROW_LENGTH, stride);
-	glTexSubImage2D(GL_state.Texture.GetTarget(), 0, 0, 0, width, height, GL_RED, GL_UNSIGNED_BYTE,
-					ptrs.u);
+	glTexSubImage2D(GL_state.Texture.GetTarget(), 0, 0, 0, width, height, GL_RED, GL_UNSIGNED_BYTE, u);
 
 	GL_state.Texture.SetActiveUnit(2);
 	GL_state.Texture.Enable(_vtex);
-	glTexSubImage2D(GL_state.Texture.GetTarget(), 0, 0, 0, width, height, GL_RED, GL_UNSIGNED_BYTE,
-					ptrs.v);
+	glTexSubImage2D(GL_state.Texture.GetTarget(), 0, 0, 0, width, height, GL_RED, GL_UNSIGNED_BYTE, v);
 
 	// Reset this back to default
 	glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
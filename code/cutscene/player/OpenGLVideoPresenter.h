@@ -22,6 +22,14 @@ class OpenGLVideoPresenter: public VideoPresenter {
 	GLuint _ytex = 0;
 	GLuint _utex = 0;
 	GLuint _vtex = 0;
+
+	// the frames are copied into these pixel buffers in turn so the texture update doesn't wait for the last one
+	static const size_t NUM_PIXEL_BUFFERS = 2;
+	GLuint _pixelBuffers[NUM_PIXEL_BUFFERS] = {0};
+	size_t _pixelBufferSize = 0;
+	size_t _nextPixelBuffer = 0;
+
+	void uploadPlanes(const VideoFramePtr& frame, const ubyte* y, const ubyte* u, const ubyte* v);
  public:
 	OpenGLVideoPresenter(const MovieProperties& props);
 
@@ -272,8 +272,28 @@ Done:
 	return retval;
 }
 
+// size of the first 'levels' mipmap levels of a plain texture, which is where the following level starts
+static size_t dds_mipmap_offset(int w, int h, int bits, int ct, int levels)
+{
+	size_t offset = 0;
+
+	for (int i = 0; i < levels; i++) {
+		if (ct == DDS_UNCOMPRESSED) {
+			offset += (size_t)w * h * (bits / 8);
+		} else {
+			// size of data block (4x4)
+			offset += (size_t)((w + 3) / 4) * ((h + 3) / 4) * ((ct == DDS_DXT1) ? 8 : 16);
+		}
+
+		w = MAX(w / 2, 1);
+		h = MAX(h / 2, 1);
+	}
+
+	return offset;
+}
+
 //reads pixel info from a dds file
-int dds_read_bitmap(const char *filename, ubyte *data, ubyte *bpp, int cf_type)
+int dds_read_bitmap(const char *filename, ubyte *data, ubyte *bpp, int cf_type, int skip_levels)
 {
 	int retval;
 	int w,h,ct,lvl;
@@ -307,10 +327,26 @@ int dds_read_bitmap(const char *filename, ubyte *data, ubyte *bpp, int cf_type)
 		return retval;
 	}
 
-	cfseek(cfp, DDS_OFFSET, CF_SEEK_SET);
+	// the faces of cubemaps come one after the other and paletted images start with their palette, so only the top
+	// levels of plain textures can be left out
+	size_t skip_size = 0;
+
+	if ( (skip_levels > 0) && (bits != 8) && ((ct == DDS_UNCOMPRESSED) || (ct == DDS_DXT1) || (ct == DDS_DXT3) || (ct == DDS_DXT5)) ) {
+		skip_size = dds_mipmap_offset(w, h, bits, ct, MIN(skip_levels, lvl - 1));
+
+		if (skip_size >= size) {
+			skip_size = 0;
+		}
+	}
+
+	cfseek(cfp, (int)(DDS_OFFSET + skip_size), CF_SEEK_SET);
 
-	// read in the data
-	cfread(data, 1, (int)size, cfp);
+	// read in the data, anything the file is too short for is cleared
+	int read = cfread(data + skip_size, 1, (int)(size - skip_size), cfp);
+
+	if (read < (int)(size - skip_size)) {
+		memset(data + skip_size + MAX(read, 0), 0, size - skip_size - MAX(read, 0));
+	}
 
 	if (bpp)
 		*bpp = (ubyte)bits;
@@ -142,7 +142,8 @@ int dds_read_header(const char *filename, CFILE *img_cfp = NULL, int *width = 0,
 
 //reads bitmap
 //size of the data it stored in size
-int dds_read_bitmap(const char *filename, ubyte *data, ubyte *bpp = NULL, int cf_type = CF_TYPE_ANY);
+//'skip_levels' top mipmap levels aren't read, their part of 'data' is left alone
+int dds_read_bitmap(const char *filename, ubyte *data, ubyte *bpp = NULL, int cf_type = CF_TYPE_ANY, int skip_levels = 0);
 
 // writes a DDS file using given data
 void dds_save_image(int width, int height, int bpp, int num_mipmaps, ubyte *data = NULL, int cubemap = 0, const char *filename = NULL);
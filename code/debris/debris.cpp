@@ -21,6 +21,7 @@
 #include "network/multiutil.h"
 #include "object/objcollide.h"
 #include "object/objectsnd.h"
+#include "object/objtimer.h"
 #include "particle/particle.h"
 #include "radar/radar.h"
 #include "radar/radarsetup.h"
@@ -52,6 +53,12 @@ int Debris_num_submodels = 0;
 #define	DEBRIS_DISTANCE_CHECK_TIME		(10*1000)		//	Check every 10 seconds.
 #define	DEBRIS_INDEX(dp) (int)(dp-Debris)
 
+#define	DEBRIS_RECYCLE_HEADROOM			8			//	Pieces start to be recycled when this few entries of Debris are left.
+#define	DEBRIS_RECYCLE_DIST_PER_SECOND	50.0f		//	For recycling, this much distance from the eye counts like a second of age.
+#define	DEBRIS_OBJECT_RESERVE			30			//	Debris isn't created when this few object slots are left.
+#define	DEBRIS_ARC_FULL_RATE_DIST		1000.0f		//	Pieces farther away from the eye update their arcs less often.
+#define	DEBRIS_ARC_REDUCED_RATE			4			//	Every how many frames the arcs of distant pieces are updated.
+
 #define	MAX_SPEED_SMALL_DEBRIS		200					// maximum velocity of small debris piece
 #define	MAX_SPEED_BIG_DEBRIS			150					// maximum velocity of big debris piece
 #define	MAX_SPEED_CAPITAL_DEBRIS	100					// maximum velocity of capital debris piece
@@ -189,28 +196,29 @@ void debris_delete( object * obj )
  * If debris piece *db is far away from all players, make it go away very soon.
  * In single player game, delete if MAX_DEBRIS_DIST from player.
  * In multiplayer game, delete if MAX_DEBRIS_DIST from all players.
+ *
+ * Runs as a timer of the debris object, see obj_timer_schedule().
  */
-void maybe_delete_debris(debris *db)
+static void maybe_delete_debris(object *debris_objp, int /*data*/)
 {
 	object	*objp;
+	debris	*db = &Debris[debris_objp->instance];
 
-	if (timestamp_elapsed(db->next_distance_check) && timestamp_elapsed(db->must_survive_until)) {
-		if (!(Game_mode & GM_MULTIPLAYER)) {		//	In single player game, just check against player.
-			if (vm_vec_dist_quick(&Player_obj->pos, &Objects[db->objnum].pos) > MAX_DEBRIS_DIST)
-				db->lifeleft = 0.1f;
-			else
-				db->next_distance_check = timestamp(DEBRIS_DISTANCE_CHECK_TIME);
-		} else {
-			for ( objp = GET_FIRST(&obj_used_list); objp !=END_OF_LIST(&obj_used_list); objp = GET_NEXT(objp) ) {
-				if (objp->flags[Object::Object_Flags::Player_ship]) {
-					if (vm_vec_dist_quick(&objp->pos, &Objects[db->objnum].pos) < MAX_DEBRIS_DIST) {
-						db->next_distance_check = timestamp(DEBRIS_DISTANCE_CHECK_TIME);
-						return;
-					}
+	if (!(Game_mode & GM_MULTIPLAYER)) {		//	In single player game, just check against player.
+		if (vm_vec_dist_quick(&Player_obj->pos, &debris_objp->pos) > MAX_DEBRIS_DIST)
+			db->lifeleft = 0.1f;
+		else
+			obj_timer_schedule(debris_objp, MAX(timestamp(DEBRIS_DISTANCE_CHECK_TIME), db->must_survive_until), maybe_delete_debris);
+	} else {
+		for ( objp = GET_FIRST(&obj_used_list); objp !=END_OF_LIST(&obj_used_list); objp = GET_NEXT(objp) ) {
+			if (objp->flags[Object::Object_Flags::Player_ship]) {
+				if (vm_vec_dist_quick(&objp->pos, &debris_objp->pos) < MAX_DEBRIS_DIST) {
+					obj_timer_schedule(debris_objp, MAX(timestamp(DEBRIS_DISTANCE_CHECK_TIME), db->must_survive_until), maybe_delete_debris);
+					return;
 				}
 			}
-			db->lifeleft = 0.1f;
 		}
+		db->lifeleft = 0.1f;
 	}
 }
 
@@ -252,13 +260,17 @@ void debris_process_post(object * obj, float frame_time)
 		}
 	}
 
-	maybe_delete_debris(db);	//	Make this debris go away if it's very far away.
-
 	// ================== DO THE ELECTRIC ARCING STUFF =====================
 	if ( db->arc_frequency <= 0 )	{
 		return;			// If arc_frequency <= 0, this piece has no arcs on it
 	}
 
+	// the arcs of distant pieces can't be made out, spread them over a few frames.  The arcs are timed with
+	// timestamps so they still last as long.
+	if ( ((Framecount + num) % DEBRIS_ARC_REDUCED_RATE) != 0 && vm_vec_dist_quick(&obj->pos, &Eye_position) > DEBRIS_ARC_FULL_RATE_DIST + obj->radius ) {
+		return;
+	}
+
 	if ( !timestamp_elapsed(db->fire_timeout) && timestamp_elapsed(db->next_fireball))	{		
 
 		db->next_fireball = timestamp_rand(db->arc_frequency,db->arc_frequency*2 );
@@ -366,26 +378,62 @@ void debris_process_post(object * obj, float frame_time)
 }
 
 /**
- * Locate the oldest hull debris chunk.  Search through the ::Hull_debris_list, which is a list
- * of all the hull debris chunks.
+ * Makes room for a new piece of debris before the pool of ::Debris runs out
+ *
+ * Once fewer than ::DEBRIS_RECYCLE_HEADROOM entries are left, the piece which will be missed the least starts its
+ * death roll, so the entries are free again by the time the next pieces are created.  Pieces which are older or
+ * farther away from the eye go first.  Hull chunks which stay forever and pieces which must survive are left alone.
+ *
+ * @param hull_flag If the new piece is a hull chunk
+ * @return @c true if there is an entry for the new piece right now
  */
-int debris_find_oldest()
+static bool debris_maybe_recycle(int hull_flag)
 {
-	int		oldest_index;
-	fix		oldest_time;
-	debris	*db;
+	int	num_alive = 0;
+	int	num_hull_alive = 0;
+	int	num_free = 0;
+	int	best_index = -1;
+	float	best_score = -1.0f;
+
+	for ( int i = 0; i < MAX_DEBRIS_PIECES; i++ ) {
+		debris *db = &Debris[i];
+
+		if ( !(db->flags & DEBRIS_USED) ) {
+			num_free++;
+			continue;
+		}
 
-	oldest_index = -1;
-	oldest_time = 0x7fffffff;
+		object *objp = &Objects[db->objnum];
 
-	for ( db = GET_FIRST(&Hull_debris_list); db != END_OF_LIST(&Hull_debris_list); db = GET_NEXT(db) ) {
-		if ( (db->time_started < oldest_time) && !(Objects[db->objnum].flags[Object::Object_Flags::Should_be_dead]) ) {
-			oldest_index = DEBRIS_INDEX(db);
-			oldest_time = db->time_started;
+		if ( objp->flags[Object::Object_Flags::Should_be_dead] ) {
+			continue;
+		}
+
+		num_alive++;
+
+		if ( db->flags & DEBRIS_EXPIRE ) {
+			num_hull_alive++;
+		}
+
+		if ( (db->is_hull && !(db->flags & DEBRIS_EXPIRE)) || !timestamp_elapsed(db->must_survive_until) ) {
+			continue;
+		}
+
+		float score = f2fl(Missiontime - db->time_started) + vm_vec_dist_quick(&objp->pos, &Eye_position) / DEBRIS_RECYCLE_DIST_PER_SECOND;
+
+		if ( score > best_score ) {
+			best_index = i;
+			best_score = score;
+		}
+	}
+
+	if ( (num_alive >= MAX_DEBRIS_PIECES - DEBRIS_RECYCLE_HEADROOM) || (hull_flag && (num_hull_alive >= MAX_HULL_PIECES)) ) {
+		if ( best_index >= 0 ) {
+			debris_start_death_roll(&Objects[Debris[best_index].objnum], &Debris[best_index]);
 		}
 	}
 
-	return oldest_index;
+	return num_free > 0;
 }
 
 #define	DEBRIS_ROTVEL_SCALE	5.0f
@@ -432,12 +480,15 @@ object *debris_create(object *source_obj, int model_num, int submodel_num, vec3d
 		}
 	}
 
-	if ( hull_flag && (Num_hull_pieces >= MAX_HULL_PIECES ) ) {
-		// cause oldest hull debris chunk to blow up
-		n = debris_find_oldest();
-		if ( n >= 0 ) {
-			debris_start_death_roll(&Objects[Debris[n].objnum], &Debris[n] );
-		}
+	if ( !debris_maybe_recycle(hull_flag) ) {
+		nprintf(("Warning","Frame %i: Could not create debris, no more slots left\n", Framecount));
+		return NULL;
+	}
+
+	// debris does without before anything else, it must not make obj_create() free the slots of other objects
+	if ( Num_objects >= MAX_OBJECTS - DEBRIS_OBJECT_RESERVE ) {
+		nprintf(("Warning","Frame %i: Could not create debris, too few object slots left\n", Framecount));
+		return NULL;
 	}
 
 	for (n=0; n<MAX_DEBRIS_PIECES; n++ ) {
@@ -445,15 +496,7 @@ object *debris_create(object *source_obj, int model_num, int submodel_num, vec3d
 			break;
 	}
 
-	if (n == MAX_DEBRIS_PIECES) {
-		n = debris_find_oldest();
-
-		if (n >= 0)
-			debris_start_death_roll(&Objects[Debris[n].objnum], &Debris[n]);
-
-		nprintf(("Warning","Frame %i: Could not create debris, no more slots left\n", Framecount));
-		return NULL;
-	}
+	Assert(n < MAX_DEBRIS_PIECES);
 
 	db = &Debris[n];
 
@@ -512,7 +555,7 @@ object *debris_create(object *source_obj, int model_num, int submodel_num, vec3d
 	db->fire_timeout = 0;	// if not changed, timestamp_elapsed() will return false
 	db->time_started = Missiontime;
 	db->species = Ship_info[shipp->ship_info_index].species;
-	db->next_distance_check = (myrand() % 2000) + 4*DEBRIS_DISTANCE_CHECK_TIME;
+	int distance_check = (myrand() % 2000) + 4*DEBRIS_DISTANCE_CHECK_TIME;
 	db->parent_alt_name = shipp->alt_type_index;
 	db->damage_mult = 1.0f;
 
@@ -565,6 +608,9 @@ object *debris_create(object *source_obj, int model_num, int submodel_num, vec3d
 	obj = &Objects[objnum];
 	pi = &obj->phys_info;
 
+	//	Make this debris go away if it's very far away, but not before it must survive until.
+	obj_timer_schedule(obj, MAX(distance_check, db->must_survive_until), maybe_delete_debris);
+
 	// assign the network signature.  The signature will be 0 for non-hull pieces, but since that
 	// is our invalid signature, it should be okay.
 	obj->net_signature = 0;
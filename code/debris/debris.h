@@ -39,7 +39,6 @@ typedef struct debris {
 	int		fire_timeout;		// timestamp that holds time for fireballs to stop appearing
 	int		sound_delay;		// timestamp to signal when sound should start
 	fix		time_started;		// time when debris was created
-	int		next_distance_check;	//	timestamp to determine whether to delete this piece of debris.
 
 	vec3d	arc_pts[MAX_DEBRIS_ARCS][2];		// The endpoints of each arc
 	int		arc_timestamp[MAX_DEBRIS_ARCS];	// When this times out, the spark goes away.  -1 is not used
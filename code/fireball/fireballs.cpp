@@ -38,11 +38,11 @@ int Knossos_warp_ani_used;
 
 #define MAX_FIREBALL_LOD						4
 
-#define MAX_FIREBALLS	200
-
 #define MAX_WARP_LOD	0
 
-fireball Fireballs[MAX_FIREBALLS];
+// grows as needed, the slots of deleted fireballs are reused before new ones are added
+SCP_vector<fireball> Fireballs;
+static SCP_vector<int> Fireball_free_slots;
 
 fireball_info Fireball_info[MAX_FIREBALL_TYPES];
 
@@ -343,8 +343,6 @@ void fireball_load_data()
 // This will get called at the start of each level.
 void fireball_init()
 {
-	int i;
-
 	if ( !fireballs_inited ) {
 		fireballs_inited = 1;
 
@@ -355,9 +353,8 @@ void fireball_init()
 	
 	// Reset everything between levels
 	Num_fireballs = 0;
-	for (i=0; i<MAX_FIREBALLS; i++ )	{
-		Fireballs[i].objnum	= -1;
-	}
+	Fireballs.clear();
+	Fireball_free_slots.clear();
 
 	// Goober5000 - reset Knossos warp flag
 	Knossos_warp_ani_used = 0;
@@ -391,6 +388,7 @@ void fireball_delete( object * obj )
 	Assert( fb->objnum == OBJ_INDEX(obj));
 
 	Fireballs[num].objnum = -1;
+	Fireball_free_slots.push_back(num);
 	Num_fireballs--;
 	Assert( Num_fireballs >= 0 );
 }
@@ -403,7 +401,7 @@ void fireball_delete_all()
 	fireball	*fb;
 	int		i;
 
-	for ( i = 0; i < MAX_FIREBALLS; i++ ) {
+	for ( i = 0; i < (int)Fireballs.size(); i++ ) {
 		fb = &Fireballs[i];
 		if ( fb->objnum != -1 ) {
 			obj_delete(fb->objnum);
@@ -487,7 +485,7 @@ int fireball_free_one()
 	int		oldest_objnum = -1, oldest_slotnum = -1;
 	float		lifeleft, oldest_lifeleft = 0.0f;
 
-	for ( i = 0; i < MAX_FIREBALLS; i++ ) {
+	for ( i = 0; i < (int)Fireballs.size(); i++ ) {
 		fb = &Fireballs[i];
 
 		// only remove the ones that aren't warp effects
@@ -719,20 +717,21 @@ int fireball_create( vec3d * pos, int fireball_type, int render_type, int parent
 		}
 	}
 
-	if ( (Num_fireballs >= MAX_FIREBALLS) || (Num_objects >= MAX_OBJECTS) )	{
+	if ( Num_objects >= MAX_OBJECTS )	{
 
-		// out of slots, so free one up.
-		n = fireball_free_one();
-		if ( n < 0 ) {
+		// out of objects, so free one up. its fireball slot goes to the free list
+		if ( fireball_free_one() < 0 ) {
 			return -1;
 		}
+	}
+
+	if ( !Fireball_free_slots.empty() )	{
+		n = Fireball_free_slots.back();
+		Fireball_free_slots.pop_back();
 	} else {
-		for ( n = 0; n < MAX_FIREBALLS; n++ )	{
-			if ( Fireballs[n].objnum < 0  )	{
-				break;
-			}
-		}
-		Assert( n != MAX_FIREBALLS );
+		n = (int)Fireballs.size();
+		Fireballs.emplace_back();
+		Fireballs[n].objnum = -1;
 	}
 
 	fb = &Fireballs[n];
@@ -775,6 +774,7 @@ int fireball_create( vec3d * pos, int fireball_type, int render_type, int parent
 
 	if (objnum < 0) {
 		Int3();				// Get John, we ran out of objects for fireballs
+		Fireball_free_slots.push_back(n);
 		return objnum;
 	}
 
@@ -557,6 +557,47 @@ void gamesnd_unload_gameplay_sounds()
 	}
 }
 
+/**
+ * Start paging in the sounds of a level
+ *
+ * The gameplay sounds are kept loaded from one level to the next, like the models and bitmaps. Until
+ * gamesnd_page_in_stop() the sound code takes note of the sounds the new level loads.
+ */
+void gamesnd_page_in_start()
+{
+	snd_page_in_start();
+}
+
+/**
+ * Unload the gameplay sounds which neither the new level loaded nor the last level played
+ */
+void gamesnd_page_in_stop()
+{
+	snd_page_in_stop();
+
+	int num_unloaded = 0;
+
+	for (auto& gs : Snds) {
+		if ( gs.id == -1 ) {
+			continue;
+		}
+
+		// sounds sharing a Sounds[] element with one unloaded before are reset as well
+		if ( snd_is_loaded(&gs) ) {
+			if ( snd_is_paged_in(gs.id) ) {
+				continue;
+			}
+
+			snd_unload( gs.id );
+			num_unloaded++;
+		}
+
+		gs.id = -1;
+	}
+
+	nprintf(("Sound", "SOUND ==> Unloaded %d gameplay sounds the level doesn't need\n", num_unloaded));
+}
+
 /**
  * Load the interface sounds into memory
  */
@@ -25,6 +25,8 @@ void gamesnd_unload_interface_sounds();
 void gamesnd_preload_common_sounds();
 void gamesnd_load_gameplay_sounds();
 void gamesnd_unload_gameplay_sounds();
+void gamesnd_page_in_start();
+void gamesnd_page_in_stop();
 void gamesnd_play_iface(int n);
 void gamesnd_play_error_beep();
 int gamesnd_get_by_name(const char* name);
@@ -0,0 +1,162 @@
+#include "globalincs/frame_arena.h"
+
+#include <algorithm>
+#include <atomic>
+
+namespace {
+
+const size_t ARENA_ALIGNMENT = 16;
+const size_t ARENA_CHUNK_SIZE = 1024 * 1024;
+
+// an arena which has to use more than this without starting over is used for something which isn't a temporary
+const size_t ARENA_MAX_SIZE = 64 * 1024 * 1024;
+
+struct arena_chunk {
+	char* data;
+	size_t size;
+};
+
+struct arena {
+	SCP_vector<arena_chunk> chunks;
+
+	size_t current_chunk = 0;
+	size_t chunk_offset = 0;
+
+	// the size of the blocks handed out since the arena started over
+	size_t used = 0;
+
+	// may be decremented by other threads, see frame_arena::deallocate()
+	std::atomic<size_t> live_blocks;
+
+	bool heap_warned = false;
+
+	arena() : live_blocks(0) {}
+};
+
+// put in front of every block, aligned so the block is as well
+struct alignas(16) block_header {
+	// nullptr for blocks which were taken from the heap
+	arena* owner;
+};
+
+static_assert(sizeof(block_header) == ARENA_ALIGNMENT, "The block header must keep the blocks aligned!");
+
+// The arenas are never freed: the storage class of SCP_THREAD_LOCAL doesn't allow destructors on every compiler and
+// blocks may still be freed after the thread which owns the arena is gone.
+SCP_THREAD_LOCAL arena* Thread_arena = nullptr;
+
+arena* get_thread_arena()
+{
+	if (Thread_arena == nullptr) {
+		Thread_arena = new arena();
+	}
+
+	return Thread_arena;
+}
+
+void rewind(arena* a)
+{
+	a->current_chunk = 0;
+	a->chunk_offset = 0;
+	a->used = 0;
+}
+
+// replaces the chunks by one which has room for all of them, only allowed while no blocks are in use
+void merge_chunks(arena* a)
+{
+	if (a->chunks.size() <= 1) {
+		return;
+	}
+
+	size_t total = 0;
+	for (auto& chunk : a->chunks) {
+		total += chunk.size;
+		vm_free(chunk.data);
+	}
+
+	a->chunks.clear();
+	a->chunks.push_back({ static_cast<char*>(vm_malloc(total)), total });
+
+	rewind(a);
+}
+
+void* allocate_from_heap(size_t size)
+{
+	auto header = static_cast<block_header*>(vm_malloc(sizeof(block_header) + size));
+	header->owner = nullptr;
+
+	return header + 1;
+}
+
+}
+
+namespace frame_arena {
+
+void* allocate(size_t size)
+{
+	auto a = get_thread_arena();
+
+	if (a->live_blocks.load(std::memory_order_acquire) == 0) {
+		rewind(a);
+	}
+
+	auto needed = sizeof(block_header) + ((size + ARENA_ALIGNMENT - 1) & ~(ARENA_ALIGNMENT - 1));
+
+	if (a->used + needed > ARENA_MAX_SIZE) {
+		if (!a->heap_warned) {
+			mprintf(("Frame arena of a thread is larger than %d MB, taking further temporaries from the heap.\n",
+				(int)(ARENA_MAX_SIZE / (1024 * 1024))));
+			a->heap_warned = true;
+		}
+		return allocate_from_heap(size);
+	}
+
+	// find a chunk with enough room, the rest of the chunks which are skipped is wasted until the arena starts over
+	while (a->current_chunk < a->chunks.size() && a->chunk_offset + needed > a->chunks[a->current_chunk].size) {
+		a->used += a->chunks[a->current_chunk].size - a->chunk_offset;
+		++a->current_chunk;
+		a->chunk_offset = 0;
+	}
+
+	if (a->current_chunk == a->chunks.size()) {
+		auto chunk_size = std::max(ARENA_CHUNK_SIZE, needed);
+		a->chunks.push_back({ static_cast<char*>(vm_malloc(chunk_size)), chunk_size });
+	}
+
+	auto header = reinterpret_cast<block_header*>(a->chunks[a->current_chunk].data + a->chunk_offset);
+	header->owner = a;
+
+	a->chunk_offset += needed;
+	a->used += needed;
+	a->live_blocks.fetch_add(1, std::memory_order_relaxed);
+
+	return header + 1;
+}
+
+void deallocate(void* ptr)
+{
+	if (ptr == nullptr) {
+		return;
+	}
+
+	auto header = static_cast<block_header*>(ptr) - 1;
+
+	if (header->owner == nullptr) {
+		vm_free(header);
+		return;
+	}
+
+	header->owner->live_blocks.fetch_sub(1, std::memory_order_release);
+}
+
+void frame_end()
+{
+	auto a = get_thread_arena();
+
+	if (a->live_blocks.load(std::memory_order_acquire) == 0) {
+		merge_chunks(a);
+		rewind(a);
+	}
+}
+
+}
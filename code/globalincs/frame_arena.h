@@ -0,0 +1,87 @@
+#ifndef _GLOBALINCS_FRAME_ARENA_H
+#define _GLOBALINCS_FRAME_ARENA_H
+#pragma once
+
+#include "globalincs/pstypes.h"
+
+/** @file
+ *  Memory for the temporaries of a frame.
+ *
+ *  Every thread has its own arena. Allocating just moves a pointer forward in the current chunk of the arena of the
+ *  calling thread and freeing only counts the blocks which are still in use. Once all blocks of an arena have been
+ *  freed it starts from the beginning again, which for the temporaries of a frame happens at the latest when the frame
+ *  is over. A frame which needed more than one chunk makes the arena replace its chunks by one big enough for all of
+ *  them, so after a few frames the arena doesn't need the heap any more.
+ *
+ *  Memory of an arena is only given back to it as a whole, so containers which keep their memory longer than a frame
+ *  should not use it. If an arena grows too large without starting over, further blocks are taken from the heap.
+ */
+
+namespace frame_arena {
+
+/**
+ * @brief Allocates a block from the arena of the calling thread
+ *
+ * @param size The size of the block, may be 0
+ * @return The block, aligned to 16 bytes
+ */
+void* allocate(size_t size);
+
+/**
+ * @brief Frees a block returned by allocate()
+ *
+ * This may be called on any thread, not just on the one which allocated the block.
+ *
+ * @param ptr The block, may be @c nullptr
+ */
+void deallocate(void* ptr);
+
+/**
+ * @brief Called at the end of every frame, see gr_flip()
+ *
+ * Merges the chunks of the arena of the calling thread if all of its blocks have been freed.
+ */
+void frame_end();
+
+}
+
+/**
+ * @brief An allocator for standard containers which uses the frame arenas
+ *
+ * All instances are equal since a block knows the arena it belongs to.
+ */
+template<typename T>
+class SCP_frame_allocator {
+ public:
+	typedef T value_type;
+
+	SCP_frame_allocator() = default;
+
+	template<typename U>
+	SCP_frame_allocator(const SCP_frame_allocator<U>&) {}
+
+	T* allocate(size_t n) {
+		return static_cast<T*>(frame_arena::allocate(n * sizeof(T)));
+	}
+
+	void deallocate(T* ptr, size_t) {
+		frame_arena::deallocate(ptr);
+	}
+};
+
+template<typename T, typename U>
+bool operator==(const SCP_frame_allocator<T>&, const SCP_frame_allocator<U>&) {
+	return true;
+}
+
+template<typename T, typename U>
+bool operator!=(const SCP_frame_allocator<T>&, const SCP_frame_allocator<U>&) {
+	return false;
+}
+
+template<typename T>
+using SCP_frame_vector = std::vector<T, SCP_frame_allocator<T>>;
+
+typedef std::basic_string<char, std::char_traits<char>, SCP_frame_allocator<char>> SCP_frame_string;
+
+#endif // _GLOBALINCS_FRAME_ARENA_H
@@ -0,0 +1,379 @@
+#include "globalincs/jobs.h"
+#include "tracing/tracing.h"
+
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <thread>
+
+namespace jobs {
+
+struct job {
+	job_func func;
+	job_group* group;
+	const tracing::Category* category;
+
+	// connects the scope which submitted the job with the one which executes it in the traces
+	std::uint64_t flow_id;
+};
+
+void finish_job(job* j);
+
+}
+
+namespace {
+
+using namespace jobs;
+
+/**
+ * The jobs queued by one thread. The owner takes jobs from the back so it works with the data it just touched while
+ * other threads steal from the front.
+ */
+struct job_queue {
+	std::mutex mutex;
+	std::deque<job*> jobs;
+};
+
+SCP_vector<std::thread> Worker_threads;
+
+// One queue per worker, index 0 is used by every thread which isn't part of the pool
+SCP_vector<std::unique_ptr<job_queue>> Job_queues;
+
+std::mutex Sleep_mutex;
+std::condition_variable Jobs_available;
+
+std::atomic<size_t> Num_queued_jobs(0);
+
+bool Workers_started = false;
+bool Workers_shutdown = false;
+
+SCP_THREAD_LOCAL bool Is_worker_thread = false;
+SCP_THREAD_LOCAL size_t Worker_index = 0;
+
+std::unique_ptr<job_group> Frame_group;
+
+void push_job(job* j)
+{
+	auto queue = Job_queues[Worker_index].get();
+
+	{
+		std::lock_guard<std::mutex> lock(queue->mutex);
+		queue->jobs.push_back(j);
+	}
+
+	{
+		// Taking the lock makes sure a worker which just found nothing to do doesn't miss this job
+		std::lock_guard<std::mutex> lock(Sleep_mutex);
+		++Num_queued_jobs;
+	}
+	Jobs_available.notify_one();
+}
+
+job* pop_job()
+{
+	if (Num_queued_jobs == 0) {
+		return nullptr;
+	}
+
+	auto num_queues = Job_queues.size();
+
+	// Look at our own queue first, then steal from the others
+	for (size_t i = 0; i < num_queues; ++i) {
+		auto index = (Worker_index + i) % num_queues;
+		auto queue = Job_queues[index].get();
+
+		std::lock_guard<std::mutex> lock(queue->mutex);
+
+		if (queue->jobs.empty()) {
+			continue;
+		}
+
+		job* j;
+		if (i == 0) {
+			j = queue->jobs.back();
+			queue->jobs.pop_back();
+		} else {
+			j = queue->jobs.front();
+			queue->jobs.pop_front();
+		}
+
+		--Num_queued_jobs;
+		return j;
+	}
+
+	return nullptr;
+}
+
+void execute_job(job* j)
+{
+	{
+		TRACE_SCOPE(*j->category);
+		tracing::flow::end(*j->category, j->flow_id);
+
+		j->func();
+	}
+
+	finish_job(j);
+}
+
+void worker_thread(size_t worker)
+{
+	Is_worker_thread = true;
+	Worker_index = worker;
+
+	char name[32];
+	snprintf(name, sizeof(name), "Job worker " SIZE_T_ARG, worker);
+	tracing::set_thread_name(name);
+
+	while (true) {
+		auto j = pop_job();
+
+		if (j != nullptr) {
+			execute_job(j);
+			continue;
+		}
+
+		std::unique_lock<std::mutex> lock(Sleep_mutex);
+		Jobs_available.wait(lock, []() { return Workers_shutdown || Num_queued_jobs > 0; });
+
+		if (Workers_shutdown && Num_queued_jobs == 0) {
+			return;
+		}
+	}
+}
+
+}
+
+namespace jobs {
+
+void finish_job(job* j)
+{
+	auto group = j->group;
+	delete j;
+
+	// The counter is only changed with the lock held so run_after() and wait() see a consistent state. After the
+	// lock has been released the group may already be gone so it can't be used anymore.
+	SCP_vector<job*> continuations;
+	{
+		std::lock_guard<std::mutex> lock(group->_continuation_mutex);
+
+		if (--group->_pending == 0) {
+			continuations.swap(group->_continuations);
+		}
+	}
+
+	for (auto continuation : continuations) {
+		push_job(continuation);
+	}
+}
+
+job_group::job_group() : _pending(0)
+{
+}
+
+job_group::~job_group()
+{
+	wait();
+}
+
+void job_group::run(job_func func, const tracing::Category& category)
+{
+	init();
+
+	auto j = new job();
+	j->func = std::move(func);
+	j->group = this;
+	j->category = &category;
+	j->flow_id = tracing::flow::begin(category);
+
+	{
+		std::lock_guard<std::mutex> lock(_continuation_mutex);
+		++_pending;
+	}
+
+	push_job(j);
+}
+
+void job_group::run_after(job_group& dependency, job_func func, const tracing::Category& category)
+{
+	init();
+
+	auto j = new job();
+	j->func = std::move(func);
+	j->group = this;
+	j->category = &category;
+	j->flow_id = tracing::flow::begin(category);
+
+	{
+		std::lock_guard<std::mutex> lock(_continuation_mutex);
+		++_pending;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(dependency._continuation_mutex);
+
+		// The dependency may only be checked with the lock held since finish_job() takes the continuations under the
+		// same lock when the last job of the group is done
+		if (dependency._pending != 0) {
+			dependency._continuations.push_back(j);
+			return;
+		}
+	}
+
+	push_job(j);
+}
+
+void job_group::wait()
+{
+	while (_pending != 0) {
+		auto j = pop_job();
+
+		if (j != nullptr) {
+			execute_job(j);
+		} else {
+			// The remaining jobs are being executed by other threads
+			std::this_thread::yield();
+		}
+	}
+
+	// Wait until the thread which finished the last job has released the group
+	std::lock_guard<std::mutex> lock(_continuation_mutex);
+}
+
+bool job_group::done() const
+{
+	return _pending == 0;
+}
+
+void init()
+{
+	if (Workers_started) {
+		return;
+	}
+
+	Workers_started = true;
+	Workers_shutdown = false;
+
+	auto hw_threads = std::thread::hardware_concurrency();
+
+	// The calling thread is also doing work so it is not included here
+	size_t num_threads = hw_threads > 1 ? hw_threads - 1 : 0;
+
+	Job_queues.clear();
+	for (size_t i = 0; i < num_threads + 1; ++i) {
+		Job_queues.emplace_back(new job_queue());
+	}
+
+	for (size_t i = 0; i < num_threads; ++i) {
+		Worker_threads.emplace_back(worker_thread, i + 1);
+	}
+
+	Frame_group.reset(new job_group());
+
+	mprintf(("Started " SIZE_T_ARG " job worker threads.\n", num_threads));
+}
+
+void shutdown()
+{
+	if (!Workers_started) {
+		return;
+	}
+
+	end_frame();
+	Frame_group = nullptr;
+
+	{
+		std::lock_guard<std::mutex> lock(Sleep_mutex);
+		Workers_shutdown = true;
+	}
+	Jobs_available.notify_all();
+
+	for (auto& thread : Worker_threads) {
+		thread.join();
+	}
+
+	Worker_threads.clear();
+	Job_queues.clear();
+	Workers_started = false;
+}
+
+size_t num_workers()
+{
+	init();
+
+	return Worker_threads.size() + 1;
+}
+
+bool is_worker_thread()
+{
+	return Is_worker_thread;
+}
+
+size_t current_worker()
+{
+	return Worker_index;
+}
+
+void parallel_for(size_t count, size_t range_size, const range_func& func, const tracing::Category& category)
+{
+	if (count == 0) {
+		return;
+	}
+
+	init();
+
+	if (range_size < 1) {
+		range_size = 1;
+	}
+
+	auto num_ranges = (count + range_size - 1) / range_size;
+
+	if (Worker_threads.empty() || num_ranges <= 1) {
+		func(0, count, Worker_index);
+		return;
+	}
+
+	// Instead of queuing one job per range every helper keeps taking ranges until there are none left. That way the
+	// work still balances itself if the ranges take different amounts of time.
+	std::atomic<size_t> next_item(0);
+	auto process_ranges = [count, range_size, &next_item, &func]() {
+		while (true) {
+			auto begin = next_item.fetch_add(range_size);
+
+			if (begin >= count) {
+				break;
+			}
+
+			func(begin, std::min(begin + range_size, count), Worker_index);
+		}
+	};
+
+	job_group group;
+
+	auto num_helpers = std::min(num_ranges, Worker_threads.size() + 1) - 1;
+	for (size_t i = 0; i < num_helpers; ++i) {
+		group.run(process_ranges, category);
+	}
+
+	process_ranges();
+
+	group.wait();
+}
+
+job_group& frame_group()
+{
+	init();
+
+	return *Frame_group;
+}
+
+void end_frame()
+{
+	if (!Workers_started) {
+		return;
+	}
+
+	Frame_group->wait();
+}
+
+}
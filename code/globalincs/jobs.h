@@ -0,0 +1,163 @@
+#ifndef _GLOBALINCS_JOBS_H
+#define _GLOBALINCS_JOBS_H
+#pragma once
+
+#include "globalincs/pstypes.h"
+#include "tracing/categories.h"
+
+#include <atomic>
+#include <functional>
+#include <mutex>
+
+/** @file
+ *  @defgroup jobs The job system
+ *
+ *  The engine wide job system.
+ *
+ *  Work is split into jobs which are executed by a pool of worker threads, one for every hardware thread except the
+ *  one of the main thread. Every worker has its own queue and takes work from the other queues when its own queue runs
+ *  empty. A thread waiting for jobs to finish executes pending jobs while it waits so nested jobs can't deadlock the
+ *  pool.
+ *
+ *  Every job is executed inside a tracing scope of the category it was submitted with so it shows up on the timeline of
+ *  the worker which executed it, and a flow connects that scope with the one which submitted the job. Jobs may only use
+ *  tracing categories which don't use GPU queries.
+ */
+
+namespace jobs {
+
+/**
+ * @brief A function executed as a job
+ */
+typedef std::function<void()> job_func;
+
+/**
+ * @brief Function called for a range of work items
+ *
+ * @param begin The first item of the range
+ * @param end One past the last item of the range
+ * @param worker The index of the worker processing this range. This is always smaller than num_workers() and can be
+ * used for indexing per-thread buffers.
+ */
+typedef std::function<void(size_t begin, size_t end, size_t worker)> range_func;
+
+struct job;
+
+/**
+ * @brief A set of jobs which can be waited on together
+ *
+ * This is the fork/join primitive of the job system: jobs are added with run() and wait() returns once all of them
+ * have been executed. A group can also be used as the dependency of jobs in another group, see run_after().
+ *
+ * @warning The group must stay alive until all of its jobs have been executed. The destructor waits for that.
+ */
+class job_group {
+	std::atomic<size_t> _pending;
+
+	std::mutex _continuation_mutex;
+	SCP_vector<job*> _continuations;
+
+	friend void finish_job(job* j);
+
+ public:
+	job_group();
+	~job_group();
+
+	job_group(const job_group&) = delete;
+	job_group& operator=(const job_group&) = delete;
+
+	/**
+	 * @brief Adds a job to this group and queues it for execution
+	 *
+	 * @param func The function to execute
+	 * @param category The tracing category the job is shown with
+	 */
+	void run(job_func func, const tracing::Category& category = tracing::Job);
+
+	/**
+	 * @brief Adds a job to this group which is only queued once all jobs of another group have been executed
+	 *
+	 * @param dependency The group which has to be finished before this job can run
+	 * @param func The function to execute
+	 * @param category The tracing category the job is shown with
+	 */
+	void run_after(job_group& dependency, job_func func, const tracing::Category& category = tracing::Job);
+
+	/**
+	 * @brief Waits until all jobs of this group have been executed
+	 *
+	 * The calling thread executes queued jobs while it waits.
+	 */
+	void wait();
+
+	/**
+	 * @brief Checks if all jobs of this group have been executed
+	 * @return @c true if there is no pending job left
+	 */
+	bool done() const;
+};
+
+/**
+ * @brief Starts the worker threads
+ *
+ * @note This is called automatically the first time work is submitted
+ */
+void init();
+
+/**
+ * @brief Executes all remaining jobs, then stops and joins all worker threads
+ */
+void shutdown();
+
+/**
+ * @brief Gets the number of threads which may process work, including the calling thread
+ * @return The number of workers
+ */
+size_t num_workers();
+
+/**
+ * @brief Checks if the current thread is one of the worker threads
+ * @return @c true if this code runs inside a worker thread
+ */
+bool is_worker_thread();
+
+/**
+ * @brief Gets the index of the worker the current thread represents
+ * @return The worker index, 0 for every thread which isn't part of the pool
+ */
+size_t current_worker();
+
+/**
+ * @brief Splits the items into ranges and processes them on all available workers
+ *
+ * The calling thread takes part in processing the work and this function only returns once all items have been
+ * processed. If there is not enough work the items are processed directly on the calling thread.
+ *
+ * @param count The number of items to process
+ * @param range_size The number of items a worker takes at once
+ * @param func The function to call for every range
+ * @param category The tracing category the work is shown with on the workers
+ */
+void parallel_for(size_t count, size_t range_size, const range_func& func,
+                  const tracing::Category& category = tracing::Job);
+
+/**
+ * @brief The group of the jobs which belong to the current frame
+ *
+ * Jobs added to this group may run at any point during the frame but they are all finished once end_frame() returns.
+ * Later work of the same frame can depend on them with job_group::run_after().
+ *
+ * @return The frame group
+ */
+job_group& frame_group();
+
+/**
+ * @brief Waits for all jobs of the current frame
+ *
+ * @note This is called once at the end of every game frame
+ */
+void end_frame();
+
+}
+
+#endif // _GLOBALINCS_JOBS_H
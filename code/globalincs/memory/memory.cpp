@@ -1,6 +1,8 @@
 
 #include "globalincs/pstypes.h"
 
+#include <new>
+
 namespace memory {
 const quiet_alloc_t quiet_alloc;
 void out_of_memory() {
@@ -9,3 +11,68 @@ void out_of_memory() {
 		"virtual memory size, or installing more physical RAM.\n");
 }
 }
+
+// The global operators are replaced so the allocations of the containers and of new are tracked like vm_malloc
+
+void* operator new(std::size_t size) {
+	if (size == 0) {
+		size = 1;
+	}
+
+	void* ptr;
+	while ((ptr = std::malloc(size)) == nullptr) {
+		auto handler = std::get_new_handler();
+
+		if (handler == nullptr) {
+			throw std::bad_alloc();
+		}
+
+		handler();
+	}
+
+	if (memory::tracking::Enabled) {
+		memory::tracking::record_alloc(ptr);
+	}
+
+	return ptr;
+}
+
+void* operator new[](std::size_t size) {
+	return operator new(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+	try {
+		return operator new(size);
+	} catch (const std::bad_alloc&) {
+		return nullptr;
+	}
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+	return operator new(size, std::nothrow);
+}
+
+void operator delete(void* ptr) noexcept {
+	if (ptr == nullptr) {
+		return;
+	}
+
+	if (memory::tracking::Enabled) {
+		memory::tracking::record_free(ptr);
+	}
+
+	std::free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept {
+	operator delete(ptr);
+}
+
+void operator delete(void* ptr, const std::nothrow_t&) noexcept {
+	operator delete(ptr);
+}
+
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept {
+	operator delete(ptr);
+}
@@ -5,6 +5,7 @@
 #include <cstdlib>
 
 #include "globalincs/pstypes.h"
+#include "globalincs/memory/tracking.h"
 
 namespace memory
 {
@@ -15,7 +16,16 @@ namespace memory
 }
 
 inline void *vm_malloc(size_t size, const memory::quiet_alloc_t &)
-{ return std::malloc(size); }
+{
+	auto ptr = std::malloc(size);
+
+	if (memory::tracking::Enabled && ptr != NULL)
+	{
+		memory::tracking::record_alloc(ptr);
+	}
+
+	return ptr;
+}
 
 inline void *vm_malloc(size_t size)
 {
@@ -30,10 +40,34 @@ inline void *vm_malloc(size_t size)
 }
 
 inline void vm_free(void *ptr)
-{ std::free(ptr); }
+{
+	if (memory::tracking::Enabled && ptr != NULL)
+	{
+		memory::tracking::record_free(ptr);
+	}
+
+	std::free(ptr);
+}
 
 inline void *vm_realloc(void *ptr, size_t size, const memory::quiet_alloc_t &)
-{ return std::realloc(ptr, size); }
+{
+	if (!memory::tracking::Enabled)
+	{
+		return std::realloc(ptr, size);
+	}
+
+	// the old block can't be looked at anymore once it is resized
+	auto old_size = (ptr != NULL) ? memory::tracking::block_size(ptr) : 0;
+	auto ret_ptr = std::realloc(ptr, size);
+
+	// a failed realloc leaves the old block alone
+	if (ret_ptr != NULL || size == 0)
+	{
+		memory::tracking::record_realloc(ptr != NULL, old_size, ret_ptr);
+	}
+
+	return ret_ptr;
+}
 
 inline void *vm_realloc(void *ptr, size_t size)
 {
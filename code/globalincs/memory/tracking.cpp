@@ -0,0 +1,273 @@
+
+#include "globalincs/memory/tracking.h"
+#include "globalincs/pstypes.h"
+#include "cmdline/cmdline.h"
+#include "debugconsole/console.h"
+#include "tracing/Monitor.h"
+#include "tracing/tracing.h"
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+
+#if defined(_WIN32) || defined(__linux__)
+#include <malloc.h>
+#elif defined(__APPLE__)
+#include <malloc/malloc.h>
+#endif
+
+namespace {
+
+// the size of the tag table, must be a power of two
+const int MAX_TAGS = 256;
+const size_t TAG_NAME_LEN = 48;
+
+// the tag of everything outside of a trace scope, and of the tags which didn't fit into the table
+const char* const UNTAGGED = "Untagged";
+
+// the counts of a tag, these are changed by every thread so they can't allocate anything
+struct tag_counts {
+	std::atomic<const char*> tag;
+	std::atomic<bool> named;
+	char name[TAG_NAME_LEN];
+
+	std::atomic<std::uint64_t> allocs;
+	std::atomic<std::uint64_t> frees;
+	std::atomic<std::uint64_t> alloc_bytes;
+	std::atomic<std::uint64_t> free_bytes;
+};
+
+// the counts of a tag in the last frame, only used by the main thread
+struct tag_frame {
+	std::uint64_t total_allocs = 0;
+	std::uint64_t total_frees = 0;
+	std::uint64_t total_alloc_bytes = 0;
+	std::uint64_t total_free_bytes = 0;
+
+	std::uint64_t allocs = 0;
+	std::uint64_t frees = 0;
+	std::uint64_t alloc_bytes = 0;
+	std::uint64_t free_bytes = 0;
+
+	SCP_string counter_name;
+	std::unique_ptr<tracing::Category> counter;
+	bool counted = false;
+};
+
+// zero initialized before any allocation can happen
+tag_counts Tags[MAX_TAGS];
+
+tag_frame Tag_frames[MAX_TAGS];
+
+thread_local const char* Current_tag = nullptr;
+
+MONITOR(AllocationsPerFrame)
+MONITOR(FreesPerFrame)
+MONITOR(AllocatedKBPerFrame)
+
+tag_counts* find_slot(const char* tag) {
+	auto hash = (reinterpret_cast<uintptr_t>(tag) >> 3) * 2654435761u;
+
+	for (int probe = 0; probe < MAX_TAGS; ++probe) {
+		auto& slot = Tags[(hash + probe) & (MAX_TAGS - 1)];
+		auto key = slot.tag.load(std::memory_order_acquire);
+
+		if (key == tag) {
+			return &slot;
+		}
+
+		if (key == nullptr) {
+			const char* expected = nullptr;
+
+			if (slot.tag.compare_exchange_strong(expected, tag)) {
+				// The name is copied since the tags of the scripting categories may go away
+				strncpy(slot.name, tag, TAG_NAME_LEN - 1);
+				slot.named.store(true, std::memory_order_release);
+				return &slot;
+			}
+
+			if (expected == tag) {
+				return &slot;
+			}
+		}
+	}
+
+	return nullptr;
+}
+
+tag_counts* current_slot() {
+	auto slot = find_slot(Current_tag != nullptr ? Current_tag : UNTAGGED);
+
+	if (slot == nullptr) {
+		// The table is full, init() made sure this one is in it
+		slot = find_slot(UNTAGGED);
+	}
+
+	return slot;
+}
+
+void count_alloc(size_t size) {
+	auto slot = current_slot();
+
+	slot->allocs.fetch_add(1, std::memory_order_relaxed);
+	slot->alloc_bytes.fetch_add(size, std::memory_order_relaxed);
+}
+
+void count_free(size_t size) {
+	auto slot = current_slot();
+
+	slot->frees.fetch_add(1, std::memory_order_relaxed);
+	slot->free_bytes.fetch_add(size, std::memory_order_relaxed);
+}
+
+}
+
+namespace memory {
+namespace tracking {
+
+bool Enabled = false;
+
+void init() {
+	if (!Cmdline_track_allocations) {
+		return;
+	}
+
+	find_slot(UNTAGGED);
+	Enabled = true;
+}
+
+void record_alloc(void* ptr) {
+	count_alloc(block_size(ptr));
+}
+
+void record_free(void* ptr) {
+	count_free(block_size(ptr));
+}
+
+size_t block_size(void* ptr) {
+#if defined(_WIN32)
+	return _msize(ptr);
+#elif defined(__APPLE__)
+	return malloc_size(ptr);
+#elif defined(__linux__)
+	return malloc_usable_size(ptr);
+#else
+	SCP_UNUSED(ptr);
+	return 0;
+#endif
+}
+
+void record_realloc(bool had_block, size_t old_size, void* new_ptr) {
+	if (had_block) {
+		count_free(old_size);
+	}
+
+	if (new_ptr != nullptr) {
+		count_alloc(block_size(new_ptr));
+	}
+}
+
+const char* push_tag(const char* tag) {
+	auto previous = Current_tag;
+	Current_tag = tag;
+
+	return previous;
+}
+
+void pop_tag(const char* previous) {
+	Current_tag = previous;
+}
+
+void frame() {
+	if (!Enabled) {
+		return;
+	}
+
+	std::uint64_t allocs = 0;
+	std::uint64_t frees = 0;
+	std::uint64_t alloc_bytes = 0;
+
+	for (int i = 0; i < MAX_TAGS; ++i) {
+		auto& slot = Tags[i];
+
+		if (!slot.named.load(std::memory_order_acquire)) {
+			continue;
+		}
+
+		auto& frame = Tag_frames[i];
+
+		auto total_allocs = slot.allocs.load(std::memory_order_relaxed);
+		auto total_frees = slot.frees.load(std::memory_order_relaxed);
+		auto total_alloc_bytes = slot.alloc_bytes.load(std::memory_order_relaxed);
+		auto total_free_bytes = slot.free_bytes.load(std::memory_order_relaxed);
+
+		frame.allocs = total_allocs - frame.total_allocs;
+		frame.frees = total_frees - frame.total_frees;
+		frame.alloc_bytes = total_alloc_bytes - frame.total_alloc_bytes;
+		frame.free_bytes = total_free_bytes - frame.total_free_bytes;
+
+		frame.total_allocs = total_allocs;
+		frame.total_frees = total_frees;
+		frame.total_alloc_bytes = total_alloc_bytes;
+		frame.total_free_bytes = total_free_bytes;
+
+		allocs += frame.allocs;
+		frees += frame.frees;
+		alloc_bytes += frame.alloc_bytes;
+
+		// Only the tags which allocated something get a counter, and one more value once they stop
+		if (frame.allocs > 0 || frame.counted) {
+			if (!frame.counter) {
+				frame.counter_name = SCP_string("Allocations ") + slot.name;
+				frame.counter.reset(new tracing::Category(frame.counter_name.c_str(), false));
+			}
+
+			tracing::counter::value(*frame.counter, static_cast<float>(frame.allocs));
+			frame.counted = frame.allocs > 0;
+		}
+	}
+
+	MONITOR_SET(AllocationsPerFrame, static_cast<int>(allocs));
+	MONITOR_SET(FreesPerFrame, static_cast<int>(frees));
+	MONITOR_SET(AllocatedKBPerFrame, static_cast<int>(alloc_bytes / 1024));
+}
+
+}
+}
+
+DCF(alloc_stats, "Lists the heap allocations of the last frame per tag (see -track_allocations)")
+{
+	if (dc_optional_string_either("help", "--help")) {
+		dc_printf("Usage: alloc_stats\n");
+		dc_printf("\tLists the allocations, frees and allocated KB of the last frame and the allocations since the\n");
+		dc_printf("\tstart for every trace scope which allocated something\n");
+		return;
+	}
+
+	if (!memory::tracking::Enabled) {
+		dc_printf("Allocations are not tracked, start the game with -track_allocations\n");
+		return;
+	}
+
+	SCP_vector<int> used;
+	for (int i = 0; i < MAX_TAGS; ++i) {
+		if (Tags[i].named.load(std::memory_order_acquire) && Tag_frames[i].total_allocs > 0) {
+			used.push_back(i);
+		}
+	}
+
+	std::sort(used.begin(), used.end(), [](int left, int right) {
+		if (Tag_frames[left].allocs != Tag_frames[right].allocs) {
+			return Tag_frames[left].allocs > Tag_frames[right].allocs;
+		}
+		return Tag_frames[left].total_allocs > Tag_frames[right].total_allocs;
+	});
+
+	dc_printf("%-40s %8s %8s %10s %12s\n", "Tag", "Allocs", "Frees", "KB", "Total allocs");
+	for (auto i : used) {
+		auto& frame = Tag_frames[i];
+
+		dc_printf("%-40s %8u %8u %10.1f %12u\n", Tags[i].name, static_cast<uint>(frame.allocs),
+			static_cast<uint>(frame.frees), frame.alloc_bytes / 1024.0, static_cast<uint>(frame.total_allocs));
+	}
+}
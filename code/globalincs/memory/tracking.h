@@ -0,0 +1,50 @@
+#pragma once
+
+#include <stddef.h>
+
+/** @file
+ *  Counts the heap allocations, see -track_allocations.
+ *
+ *  Every allocation and free through vm_malloc, vm_realloc, vm_free and the global operator new and delete is counted
+ *  together with the size of the block. The counts are kept per tag, which is the category of the innermost trace scope
+ *  (TRACE_SCOPE) of the thread, so a hot loop shows up under the name it has in the traces. A free is counted for the
+ *  tag which is current when the block is freed, not the one where it was allocated.
+ *
+ *  Once per frame the counts of that frame are published as the AllocationsPerFrame, FreesPerFrame and
+ *  AllocatedKBPerFrame monitors and as one tracing counter per tag. The alloc_stats debug command lists them.
+ */
+
+namespace memory {
+namespace tracking {
+
+// whether the allocations are counted, only changed by init()
+extern bool Enabled;
+
+// turns the tracking on if the command line asks for it, call before any other threads are started
+void init();
+
+// records a new block
+void record_alloc(void* ptr);
+
+// records a block which is about to be freed
+void record_free(void* ptr);
+
+// the size of a block as the allocator sees it, 0 if that isn't known on this platform
+size_t block_size(void* ptr);
+
+// records a block of old_size which was resized, had_block is false if there was no block before and new_ptr is null
+// if there is none afterwards
+void record_realloc(bool had_block, size_t old_size, void* new_ptr);
+
+// makes the tag the current one of this thread, the tag must stay valid while it is in use
+// @return The tag which was current before, give it to pop_tag() when the tag isn't used anymore
+const char* push_tag(const char* tag);
+
+// makes the previous tag current again
+void pop_tag(const char* previous);
+
+// publishes the counts of the frame which just ended, call once per frame from the main thread
+void frame();
+
+}
+}
@@ -19,6 +19,7 @@
 
 #include "cmdline/cmdline.h"
 #include "debugconsole/console.h"
+#include "globalincs/frame_arena.h"
 #include "gamesequence/gamesequence.h"	//WMC - for scripting hooks in gr_flip()
 #include "globalincs/systemvars.h"
 #include "graphics/2d.h"
@@ -35,6 +36,7 @@
 #include "scripting/scripting.h"
 #include "parse/parselo.h"
 #include "render/3d.h"
+#include "tracing/StartupProfiler.h"
 #include "tracing/tracing.h"
 
 #if ( SDL_VERSION_ATLEAST(1, 2, 7) )
@@ -880,6 +882,9 @@ bool gr_init(std::unique_ptr<os::GraphicsOperations>&& graphicsOps, int d_mode,
 	int width = 1024, height = 768, depth = 32, mode = GR_OPENGL;
 	float center_aspect_ratio = -1.0f;
 	const char *ptr = NULL;
+
+	TRACE_STARTUP_SCOPE(tracing::GraphicsInit);
+
 	// If already inited, shutdown the previous graphics
 	if (Gr_inited) {
 		switch (gr_screen.mode) {
@@ -1001,8 +1006,8 @@ bool gr_init(std::unique_ptr<os::GraphicsOperations>&& graphicsOps, int d_mode,
 		}
 	}
 
-	// if we are in standalone mode then just use special defaults
-	if (Is_standalone) {
+	// if we are in standalone mode or only simulate then just use special defaults
+	if (Is_standalone || (Cmdline_benchmark_simulation > 0)) {
 		mode = GR_STUB;
 		width = 640;
 		height = 480;
@@ -1891,8 +1896,6 @@ void poly_list::calculate_tangent()
 	}
 }
 
-static poly_list buffer_list_internal;
-
 void poly_list::make_index_buffer(SCP_vector<int> &vertex_list)
 {
 	int nverts = 0;
@@ -1932,6 +1935,8 @@ void poly_list::make_index_buffer(SCP_vector<int> &vertex_list)
 		return;
 	}
 
+	// local so that the buffers of several models can be built at the same time
+	poly_list buffer_list_internal;
 	buffer_list_internal.n_verts = 0;
 	buffer_list_internal.allocate(nverts);
 
@@ -2124,6 +2129,10 @@ void gr_flip(bool execute_scripting)
 	}
 
 	gr_screen.gf_flip();
+
+	bm_stream_frame();
+
+	frame_arena::frame_end();
 }
 
 uint gr_determine_model_shader_flags(
@@ -129,10 +129,8 @@ enum shader_type {
 	SDR_TYPE_EFFECT_DISTORTION,
 	SDR_TYPE_POST_PROCESS_MAIN,
 	SDR_TYPE_POST_PROCESS_BLUR,
-	SDR_TYPE_POST_PROCESS_BLOOM_COMP,
 	SDR_TYPE_POST_PROCESS_BRIGHTPASS,
 	SDR_TYPE_POST_PROCESS_FXAA,
-	SDR_TYPE_POST_PROCESS_FXAA_PREPASS,
 	SDR_TYPE_POST_PROCESS_LIGHTSHAFTS,
 	SDR_TYPE_POST_PROCESS_TONEMAPPING,
 	SDR_TYPE_DEFERRED_LIGHTING,
@@ -140,6 +138,8 @@ enum shader_type {
 	SDR_TYPE_VIDEO_PROCESS,
 	SDR_TYPE_PASSTHROUGH_RENDER,
 	SDR_TYPE_SHIELD_DECAL,
+	SDR_TYPE_DECAL,
+	SDR_TYPE_BACKGROUND_CUBEMAP,
 	NUM_SHADER_TYPES
 };
 
@@ -166,12 +166,21 @@ enum shader_type {
 #define SDR_FLAG_MODEL_AMBIENT_MAP	(1<<19)
 #define SDR_FLAG_MODEL_NORMAL_ALPHA	(1<<20)
 #define SDR_FLAG_MODEL_NORMAL_EXTRUDE (1<<21)
+#define SDR_FLAG_MODEL_TEXTURE_ARRAYS (1<<22)
+#define SDR_FLAG_MODEL_DEPTH_PREPASS (1<<23)
 
 #define SDR_FLAG_PARTICLE_POINT_GEN			(1<<0)
+#define SDR_FLAG_PARTICLE_GPU_SIM			(1<<1)
+#define SDR_FLAG_PARTICLE_NEBULA_POOF		(1<<2)
 
 #define SDR_FLAG_BLUR_HORIZONTAL			(1<<0)
 #define SDR_FLAG_BLUR_VERTICAL				(1<<1)
 
+#define SDR_FLAG_TONEMAPPING_BLOOM			(1<<0)
+#define SDR_FLAG_TONEMAPPING_LUMA			(1<<1)
+
+#define SDR_FLAG_DEFERRED_TILED			(1<<0)
+
 struct vertex_format_data
 {
 	enum vertex_format {
@@ -186,7 +195,11 @@ struct vertex_format_data
 		TANGENT,
 		MODEL_ID,
 		RADIUS,
-		UVEC
+		UVEC,
+		TEX_COORD_HALF,
+		NORMAL_PACKED,
+		TANGENT_PACKED,
+		MODEL_ID_SHORT
 	};
 
 	vertex_format format_type;
@@ -262,6 +275,8 @@ typedef enum gr_capability {
 	CAPABILITY_BATCHED_SUBMODELS,
 	CAPABILITY_POINT_PARTICLES,
 	CAPABILITY_TIMESTAMP_QUERY,
+	CAPABILITY_TEXTURE_ARRAYS,
+	CAPABILITY_PACKED_VERTICES,
 } gr_capability;
 
 // stencil buffering stuff
@@ -538,6 +553,15 @@ struct indexed_vertex_source {
 
 struct light;
 
+// A decal which is projected onto the opaque geometry of the G-buffer, see gr_render_decals()
+struct decal_draw_info {
+	vec3d position;		// the center of the decal in world space
+	matrix orient;		// the fvec points into the surface, rvec and uvec span the texture
+	float radius;		// half the width and height of the texture
+	float depth;		// how far in front of and behind the center the surface may be
+	float alpha;
+};
+
 #define FIND_SCALED_NUM(x, x0, x1, y0, y1) ( ((((x) - (x0)) * ((y1) - (y0))) / ((x1) - (x0))) + (y0) )
 
 #define GR_ALPHABLEND_NONE			0		// no blending
@@ -551,7 +575,8 @@ struct light;
 #define GR_FOGMODE_FOG				1		// linear fog
 
 enum class QueryType {
-	Timestamp
+	Timestamp,
+	Occlusion // Counts the samples passing the depth test between gr_begin_query() and gr_end_query()
 };
 
 typedef struct screen {
@@ -627,6 +652,8 @@ typedef struct screen {
 	void (*gf_aabitmap_ex)(int x, int y, int w, int h, int sx, int sy, int resize_mode, bool mirror);
 
 	void(*gf_string)(float x, float y, const char * text, int resize_mode, int length);
+	void (*gf_string_batch_begin)();
+	void (*gf_string_batch_end)();
 
 	// Draw a gradient line... x1,y1 is bright, x2,y2 is transparent.
 	void (*gf_gradient)(int x1, int y1, int x2, int y2, int resize_mode);
@@ -710,6 +737,7 @@ typedef struct screen {
 	void (*gf_bm_init)(int n);
 	void (*gf_bm_page_in_start)();
 	bool (*gf_bm_data)(int n, bitmap* bm);
+	bool (*gf_bm_is_uploaded)(int n);
 
 	int (*gf_bm_make_render_target)(int n, int *width, int *height, int *bpp, int *mm_lvl, int flags );
 	int (*gf_bm_set_render_target)(int n, int face);
@@ -725,8 +753,13 @@ typedef struct screen {
 	void (*gf_delete_buffer)(int handle);
 
 	void (*gf_update_buffer_data)(int handle, size_t size, void* data);
+	void (*gf_update_buffer_data_offset)(int handle, size_t offset, size_t size, void* data);
 	void (*gf_update_transform_buffer)(void* data, size_t size);
 	void (*gf_set_transform_buffer_offset)(size_t offset);
+	void (*gf_set_transform_buffer_instances)(int num_instances, size_t instance_stride);
+
+	void* (*gf_map_immediate_buffer)(size_t size, size_t alignment, int* buffer_handle, size_t* offset);
+	void (*gf_unmap_immediate_buffer)();
 
 	void (*gf_render_stream_buffer)(int buffer_handle, size_t offset, size_t n_verts, int flags);
 	
@@ -763,7 +796,9 @@ typedef struct screen {
 
 	void (*gf_scene_texture_begin)();
 	void (*gf_scene_texture_end)();
-	void (*gf_copy_effect_texture)();
+	void (*gf_scene_resolution_begin)();
+	void (*gf_scene_resolution_end)();
+	void (*gf_copy_effect_texture)(int x1, int y1, int x2, int y2);
 
 	void (*gf_lighting)(bool,bool);
 
@@ -780,18 +815,22 @@ typedef struct screen {
 	void (*gf_sphere)(material *material_def, float rad);
 
 	int (*gf_maybe_create_shader)(shader_type type, unsigned int flags);
+	void (*gf_shader_precompile_begin)();
+	void (*gf_shader_precompile_end)();
 	
 	void (*gf_clear_states)();
 	
 	void (*gf_update_texture)(int bitmap_handle, int bpp, const ubyte* data, int width, int height);
 	void (*gf_get_bitmap_from_texture)(void* data_out, int bitmap_num);
 
-	void (*gf_shadow_map_start)(matrix4 *shadow_view_matrix, const matrix *light_matrix);
+	void (*gf_shadow_map_start)(matrix4 *shadow_view_matrix, const matrix *light_matrix, int num_cascades);
 	void (*gf_shadow_map_end)();
 
 	// new drawing functions
-	void (*gf_render_model)(model_material* material_info, indexed_vertex_source *vert_source, vertex_buffer* bufferp, size_t texi);
+	void (*gf_render_model)(model_material* material_info, indexed_vertex_source *vert_source, vertex_buffer* bufferp, size_t texi, size_t texi_count);
 	void (*gf_render_shield_impact)(shield_material *material_info, primitive_type prim_type, vertex_layout *layout, int buffer_handle, int n_verts);
+	void (*gf_render_decals)(int bitmap, const decal_draw_info *decals, int num_decals);
+	void (*gf_render_background_cubemap)(int cubemap);
 	void (*gf_render_primitives)(material* material_info, primitive_type prim_type, vertex_layout* layout, int offset, int n_verts, int buffer_handle);
 	void (*gf_render_primitives_immediate)(material* material_info, primitive_type prim_type, vertex_layout* layout, int n_verts, void* data, int size);
 	void (*gf_render_primitives_particle)(particle_material* material_info, primitive_type prim_type, vertex_layout* layout, int offset, int n_verts, int buffer_handle);
@@ -808,6 +847,8 @@ typedef struct screen {
 	void (*gf_query_value)(int obj, QueryType type);
 	bool (*gf_query_value_available)(int obj);
 	std::uint64_t (*gf_get_query_value)(int obj);
+	void (*gf_begin_query)(int obj, QueryType type);
+	void (*gf_end_query)(int obj);
 	void (*gf_delete_query_object)(int obj);
 
 	std::unique_ptr<os::Viewport> (*gf_create_viewport)(const os::ViewPortProperties& props);
@@ -1024,6 +1065,7 @@ __inline void gr_fog_set(int fog_mode, int r, int g, int b, float fog_near = -1.
 #define gr_bm_init					GR_CALL(*gr_screen.gf_bm_init)
 #define gr_bm_page_in_start			GR_CALL(*gr_screen.gf_bm_page_in_start)
 #define gr_bm_data					GR_CALL(*gr_screen.gf_bm_data)
+#define gr_bm_is_uploaded			GR_CALL(*gr_screen.gf_bm_is_uploaded)
 
 #define gr_bm_make_render_target					GR_CALL(*gr_screen.gf_bm_make_render_target)          
         
@@ -1046,8 +1088,25 @@ __inline int gr_create_index_buffer(bool static_buffer = false)
 
 #define gr_delete_buffer				GR_CALL(*gr_screen.gf_delete_buffer)
 #define gr_update_buffer_data			GR_CALL(*gr_screen.gf_update_buffer_data)
+#define gr_update_buffer_data_offset	GR_CALL(*gr_screen.gf_update_buffer_data_offset)
 #define gr_update_transform_buffer		GR_CALL(*gr_screen.gf_update_transform_buffer)
 #define gr_set_transform_buffer_offset	GR_CALL(*gr_screen.gf_set_transform_buffer_offset)
+#define gr_set_transform_buffer_instances	GR_CALL(*gr_screen.gf_set_transform_buffer_instances)
+
+/**
+ * @brief Maps a range of the per-frame immediate vertex buffer for writing
+ *
+ * The data written to the range stays valid until the end of the current frame. The range has to be unmapped with
+ * gr_unmap_immediate_buffer() before anything is rendered from it.
+ *
+ * @param size The size of the range in bytes
+ * @param alignment The offset of the range is a multiple of this, e.g. the vertex stride
+ * @param buffer_handle Receives the handle of the buffer the data needs to be rendered from
+ * @param offset Receives the byte offset of the range in that buffer
+ * @return A pointer to the mapped range or @c nullptr if the buffer can't be mapped
+ */
+#define gr_map_immediate_buffer			GR_CALL(*gr_screen.gf_map_immediate_buffer)
+#define gr_unmap_immediate_buffer		GR_CALL(*gr_screen.gf_unmap_immediate_buffer)
 
 #define gr_set_proj_matrix					GR_CALL(*gr_screen.gf_set_proj_matrix)            
 #define gr_end_proj_matrix					GR_CALL(*gr_screen.gf_end_proj_matrix)            
@@ -1065,6 +1124,8 @@ __inline int gr_create_index_buffer(bool static_buffer = false)
 
 #define gr_scene_texture_begin			GR_CALL(*gr_screen.gf_scene_texture_begin)
 #define gr_scene_texture_end			GR_CALL(*gr_screen.gf_scene_texture_end)
+#define gr_scene_resolution_begin		GR_CALL(*gr_screen.gf_scene_resolution_begin)
+#define gr_scene_resolution_end			GR_CALL(*gr_screen.gf_scene_resolution_end)
 #define gr_copy_effect_texture			GR_CALL(*gr_screen.gf_copy_effect_texture)
 
 #define gr_post_process_set_effect		GR_CALL(*gr_screen.gf_post_process_set_effect)
@@ -1094,16 +1155,25 @@ inline void gr_post_process_restore_zbuffer() {
 #define gr_sphere						GR_CALL(*gr_screen.gf_sphere)
 
 #define gr_maybe_create_shader			GR_CALL(*gr_screen.gf_maybe_create_shader)
+#define gr_shader_precompile_begin		GR_CALL(*gr_screen.gf_shader_precompile_begin)
+#define gr_shader_precompile_end		GR_CALL(*gr_screen.gf_shader_precompile_end)
 #define gr_set_animated_effect			GR_CALL(*gr_screen.gf_set_animated_effect)
 
 #define gr_clear_states					GR_CALL(*gr_screen.gf_clear_states)
 
+// the strings drawn between these two calls may be drawn together when gr_string_batch_end() is called. they end up on
+// top of everything else drawn in between so only use this where the strings don't overlap other elements
+#define gr_string_batch_begin			GR_CALL(*gr_screen.gf_string_batch_begin)
+#define gr_string_batch_end				GR_CALL(*gr_screen.gf_string_batch_end)
+
 #define gr_update_texture				GR_CALL(*gr_screen.gf_update_texture)
 #define gr_get_bitmap_from_texture		GR_CALL(*gr_screen.gf_get_bitmap_from_texture)
 
 #define gr_shadow_map_start				GR_CALL(*gr_screen.gf_shadow_map_start)
 #define gr_shadow_map_end				GR_CALL(*gr_screen.gf_shadow_map_end)
 #define gr_render_shield_impact			GR_CALL(*gr_screen.gf_render_shield_impact)
+#define gr_render_decals				GR_CALL(*gr_screen.gf_render_decals)
+#define gr_render_background_cubemap	GR_CALL(*gr_screen.gf_render_background_cubemap)
 
 __inline void gr_render_primitives(material* material_info, primitive_type prim_type, vertex_layout* layout, int offset, int n_verts, int buffer_handle = -1)
 {
@@ -1135,9 +1205,12 @@ __inline void gr_render_primitives_2d_immediate(material* material_info, primiti
 	(*gr_screen.gf_render_primitives_2d_immediate)(material_info, prim_type, layout, n_verts, data, size);
 }
 
-__inline void gr_render_model(model_material* material_info, indexed_vertex_source *vert_source, vertex_buffer* bufferp, size_t texi)
+/**
+ * @brief Draws texi_count consecutive texture buffers of a vertex buffer, their indices have to follow each other
+ */
+__inline void gr_render_model(model_material* material_info, indexed_vertex_source *vert_source, vertex_buffer* bufferp, size_t texi, size_t texi_count = 1)
 {
-	(*gr_screen.gf_render_model)(material_info, vert_source, bufferp, texi);
+	(*gr_screen.gf_render_model)(material_info, vert_source, bufferp, texi, texi_count);
 }
 
 __inline bool gr_is_capable(gr_capability capability)
@@ -1175,6 +1248,16 @@ inline std::uint64_t gr_get_query_value(int obj)
 	return (*gr_screen.gf_get_query_value)(obj);
 }
 
+inline void gr_begin_query(int obj, QueryType type)
+{
+	(*gr_screen.gf_begin_query)(obj, type);
+}
+
+inline void gr_end_query(int obj)
+{
+	(*gr_screen.gf_end_query)(obj);
+}
+
 inline void gr_delete_query_object(int obj)
 {
 	(*gr_screen.gf_delete_query_object)(obj);
@@ -1244,6 +1327,7 @@ void gr_pline_special(SCP_vector<vec3d> *pts, int thickness,int resize_mode=GR_R
 #define VB_FLAG_LARGE_INDEX	(1<<10)
 #define VB_FLAG_MODEL_ID	(1<<11)
 #define VB_FLAG_TRANS		(1<<12)
+#define VB_FLAG_PACKED		(1<<13)	//half float UVs, 10:10:10:2 normals and tangents and a short model ID
 
 /**
 * @brief Prints the current time
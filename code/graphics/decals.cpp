@@ -0,0 +1,209 @@
+#include "bmpman/bmpman.h"
+#include "graphics/2d.h"
+#include "graphics/decals.h"
+#include "io/timer.h"
+#include "math/floating.h"
+#include "math/vecmat.h"
+#include "model/model.h"
+#include "parse/parselo.h"
+#include "ship/ship.h"
+#include "tracing/tracing.h"
+
+#include <algorithm>
+
+namespace {
+
+// the last part of the lifetime in which a decal fades out
+const int DECAL_FADE_TIME = 2000;
+
+struct decal {
+	int objnum;
+	int signature;
+	int submodel_num;
+
+	vec3d local_pos;
+	vec3d local_fvec;	// into the surface
+	vec3d local_uvec;
+
+	float radius;
+	int bitmap;
+
+	int creation_time;
+	int lifetime;
+};
+
+decal Decals[MAX_DECALS];
+int Num_decals = 0;
+// where the next decal goes, once the array is full this is also the oldest one
+int Next_decal = 0;
+
+struct decal_draw {
+	int bitmap;
+	decal_draw_info info;
+};
+
+SCP_vector<decal_draw> Decal_draws;
+SCP_vector<decal_draw_info> Decal_draw_infos;
+
+}
+
+void decal_definition_parse(decal_definition *def)
+{
+	stuff_string(def->filename, F_NAME, MAX_FILENAME_LEN);
+
+	if (optional_string("+Radius:")) {
+		stuff_float(&def->radius);
+
+		if (def->radius <= 0.0f) {
+			Warning(LOCATION, "The radius of decal '%s' has to be greater than zero!", def->filename);
+			def->radius = 1.0f;
+		}
+	}
+
+	if (optional_string("+Lifetime:")) {
+		float lifetime;
+		stuff_float(&lifetime);
+
+		def->lifetime = lifetime > 0.0f ? fl2i(lifetime * 1000.0f) : -1;
+	}
+}
+
+void decal_definition_load(decal_definition *def)
+{
+	if (def->bitmap >= 0 || !strlen(def->filename)) {
+		return;
+	}
+
+	def->bitmap = bm_load(def->filename);
+
+	if (def->bitmap < 0) {
+		Warning(LOCATION, "Could not load decal texture '%s'!", def->filename);
+		// don't try again for every weapon which uses it
+		def->filename[0] = '\0';
+	}
+}
+
+void decals_add(object *objp, int submodel_num, const vec3d *local_pos, const vec3d *local_normal, const decal_definition *def)
+{
+	Assertion(objp->type == OBJ_SHIP, "Decals can only be added to ships!");
+
+	if (def->bitmap < 0 || submodel_num < 0) {
+		return;
+	}
+
+	auto dp = &Decals[Next_decal];
+	Next_decal = (Next_decal + 1) % MAX_DECALS;
+	Num_decals = MIN(Num_decals + 1, MAX_DECALS);
+
+	dp->objnum = OBJ_INDEX(objp);
+	dp->signature = objp->signature;
+	dp->submodel_num = submodel_num;
+	dp->local_pos = *local_pos;
+
+	vm_vec_copy_normalize(&dp->local_fvec, local_normal);
+	vm_vec_negate(&dp->local_fvec);
+
+	// every decal is rotated differently so the hits of the same weapon don't look alike
+	matrix orient;
+	vm_vector_2_matrix(&orient, &dp->local_fvec, nullptr, nullptr);
+
+	float angle = frand_range(0.0f, PI2);
+	vm_vec_copy_scale(&dp->local_uvec, &orient.vec.uvec, cosf(angle));
+	vm_vec_scale_add2(&dp->local_uvec, &orient.vec.rvec, sinf(angle));
+
+	dp->radius = def->radius;
+	dp->bitmap = def->bitmap;
+	dp->creation_time = timestamp();
+	dp->lifetime = def->lifetime;
+}
+
+void decals_render_all()
+{
+	if (Num_decals == 0) {
+		return;
+	}
+
+	TRACE_SCOPE(tracing::DeferredDecals);
+
+	int now = timestamp();
+
+	Decal_draws.clear();
+
+	// oldest first so the newer decals are drawn over the older ones
+	int first = (Num_decals < MAX_DECALS) ? 0 : Next_decal;
+	for (int i = 0; i < Num_decals; ++i) {
+		auto dp = &Decals[(first + i) % MAX_DECALS];
+
+		if (dp->objnum < 0) {
+			continue;
+		}
+
+		auto objp = &Objects[dp->objnum];
+		if (objp->signature != dp->signature || objp->type != OBJ_SHIP) {
+			// the ship is gone
+			dp->objnum = -1;
+			continue;
+		}
+
+		float alpha = 1.0f;
+		if (dp->lifetime >= 0) {
+			int left = dp->lifetime - (now - dp->creation_time);
+			if (left <= 0) {
+				dp->objnum = -1;
+				continue;
+			}
+
+			alpha = MIN(1.0f, (float)left / DECAL_FADE_TIME);
+		}
+
+		if ( !(objp->flags[Object::Object_Flags::Was_rendered]) ) {
+			continue;
+		}
+
+		auto shipp = &Ships[objp->instance];
+		auto pmi = model_get_instance(shipp->model_instance_num);
+		if (pmi->submodel[dp->submodel_num].blown_off) {
+			continue;
+		}
+
+		decal_draw draw;
+		draw.bitmap = dp->bitmap;
+		draw.info.radius = dp->radius;
+		// the decal reaches as far into and out of the surface as it is large so it covers bumpy hulls
+		draw.info.depth = dp->radius;
+		draw.info.alpha = alpha;
+
+		vec3d fvec, uvec;
+		model_instance_find_world_point(&draw.info.position, &dp->local_pos, shipp->model_instance_num, dp->submodel_num, &objp->orient, &objp->pos);
+		model_instance_find_world_dir(&fvec, &dp->local_fvec, shipp->model_instance_num, dp->submodel_num, &objp->orient);
+		model_instance_find_world_dir(&uvec, &dp->local_uvec, shipp->model_instance_num, dp->submodel_num, &objp->orient);
+		vm_vector_2_matrix(&draw.info.orient, &fvec, &uvec, nullptr);
+
+		Decal_draws.push_back(draw);
+	}
+
+	// one pass for every texture, the order of the decals in a pass stays the same
+	std::stable_sort(Decal_draws.begin(), Decal_draws.end(), [](const decal_draw& a, const decal_draw& b) {
+		return a.bitmap < b.bitmap;
+	});
+
+	for (size_t i = 0; i < Decal_draws.size();) {
+		int bitmap = Decal_draws[i].bitmap;
+
+		Decal_draw_infos.clear();
+		for (; i < Decal_draws.size() && Decal_draws[i].bitmap == bitmap; ++i) {
+			Decal_draw_infos.push_back(Decal_draws[i].info);
+		}
+
+		gr_render_decals(bitmap, Decal_draw_infos.data(), (int)Decal_draw_infos.size());
+	}
+}
+
+void decals_level_close()
+{
+	Num_decals = 0;
+	Next_decal = 0;
+
+	Decal_draws.clear();
+	Decal_draw_infos.clear();
+}
@@ -0,0 +1,65 @@
+#ifndef _DECALS_H
+#define _DECALS_H
+
+#include "globalincs/pstypes.h"
+#include "object/object.h"
+
+/** @file
+ *  Impact marks on the hulls of ships.
+ *
+ *  A decal is only a small record of where on which submodel it is, no geometry is created for it. With deferred
+ *  lighting all visible decals are projected onto the G-buffer in a pass per texture, see gr_render_decals(). Without
+ *  deferred lighting there are no decals.
+ */
+
+#define MAX_DECALS	256
+
+// what a weapon leaves on a hull, parsed from $Impact Decal:
+struct decal_definition {
+	char filename[MAX_FILENAME_LEN];
+	int bitmap;
+	float radius;
+	int lifetime;	// in milliseconds, -1 keeps the decal until it is replaced by a newer one
+
+	decal_definition() : bitmap(-1), radius(1.0f), lifetime(-1)
+	{
+		filename[0] = '\0';
+	}
+};
+
+/**
+ * @brief Parses the options of a decal definition after its filename
+ */
+void decal_definition_parse(decal_definition *def);
+
+/**
+ * @brief Loads the texture of a decal definition if it has one
+ */
+void decal_definition_load(decal_definition *def);
+
+/**
+ * @brief Adds a decal to a ship
+ *
+ * If there are already MAX_DECALS decals the oldest one is replaced.
+ *
+ * @param objp The ship which was hit
+ * @param submodel_num The submodel which was hit
+ * @param local_pos The position of the hit in the frame of reference of the submodel
+ * @param local_normal The normal of the surface at the hit in the frame of reference of the submodel
+ * @param def The decal
+ */
+void decals_add(object *objp, int submodel_num, const vec3d *local_pos, const vec3d *local_normal, const decal_definition *def);
+
+/**
+ * @brief Projects the decals onto the objects which were rendered this frame
+ *
+ * Has to be called while the opaque geometry is still being drawn to the G-buffer.
+ */
+void decals_render_all();
+
+/**
+ * @brief Removes all decals
+ */
+void decals_level_close();
+
+#endif // _DECALS_H
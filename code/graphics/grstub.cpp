@@ -207,6 +207,11 @@ void gr_stub_update_buffer_data(int handle, size_t size, void* data)
 
 }
 
+void gr_stub_update_buffer_data_offset(int handle, size_t offset, size_t size, void* data)
+{
+
+}
+
 void gr_stub_update_transform_buffer(void* data, size_t size)
 {
 
@@ -217,6 +222,21 @@ void gr_stub_set_transform_buffer_offset(size_t offset)
 
 }
 
+void gr_stub_set_transform_buffer_instances(int num_instances, size_t instance_stride)
+{
+
+}
+
+void* gr_stub_map_immediate_buffer(size_t size, size_t alignment, int* buffer_handle, size_t* offset)
+{
+	return nullptr;
+}
+
+void gr_stub_unmap_immediate_buffer()
+{
+
+}
+
 void gr_stub_render_stream_buffer(int buffer_handle, size_t offset, size_t n_verts, int flags)
 {
 }
@@ -353,7 +373,15 @@ void gr_stub_scene_texture_end()
 {
 }
 
-void gr_stub_copy_effect_texture()
+void gr_stub_copy_effect_texture(int x1, int y1, int x2, int y2)
+{
+}
+
+void gr_stub_scene_resolution_begin()
+{
+}
+
+void gr_stub_scene_resolution_end()
 {
 }
 
@@ -429,11 +457,32 @@ bool gr_stub_bm_data(int n, bitmap* bm)
 	return true;
 }
 
+bool gr_stub_bm_is_uploaded(int n)
+{
+	return false;
+}
+
 int gr_stub_maybe_create_shader(shader_type shader_t, unsigned int flags) {
 	return -1;
 }
 
-void gr_stub_shadow_map_start(matrix4 *shadow_view_matrix, const matrix* light_matrix)
+void gr_stub_string_batch_begin()
+{
+}
+
+void gr_stub_string_batch_end()
+{
+}
+
+void gr_stub_shader_precompile_begin()
+{
+}
+
+void gr_stub_shader_precompile_end()
+{
+}
+
+void gr_stub_shadow_map_start(matrix4 *shadow_view_matrix, const matrix* light_matrix, int num_cascades)
 {
 }
 
@@ -446,7 +495,17 @@ void gr_stub_render_shield_impact(shield_material *material_info, primitive_type
 
 }
 
-void gr_stub_render_model(model_material* material_info, indexed_vertex_source *vert_source, vertex_buffer* bufferp, size_t texi)
+void gr_stub_render_decals(int bitmap, const decal_draw_info *decals, int num_decals)
+{
+
+}
+
+void gr_stub_render_background_cubemap(int cubemap)
+{
+
+}
+
+void gr_stub_render_model(model_material* material_info, indexed_vertex_source *vert_source, vertex_buffer* bufferp, size_t texi, size_t texi_count)
 {
 
 }
@@ -511,6 +570,14 @@ std::uint64_t gr_stub_get_query_value(int obj)
 	return 0;
 }
 
+void gr_stub_begin_query(int obj, QueryType type)
+{
+}
+
+void gr_stub_end_query(int obj)
+{
+}
+
 void gr_stub_delete_query_object(int obj)
 {
 }
@@ -555,6 +622,8 @@ bool gr_stub_init()
 //	gr_screen.gf_rect				= gr_stub_rect;
 //	gr_screen.gf_shade				= gr_stub_shade;
 	gr_screen.gf_string				= gr_stub_string;
+	gr_screen.gf_string_batch_begin	= gr_stub_string_batch_begin;
+	gr_screen.gf_string_batch_end	= gr_stub_string_batch_end;
 	gr_screen.gf_circle				= gr_stub_circle;
 	gr_screen.gf_unfilled_circle	= gr_stub_unfilled_circle;
 	gr_screen.gf_curve				= gr_stub_curve;
@@ -596,6 +665,7 @@ bool gr_stub_init()
 	gr_screen.gf_bm_init				= gr_stub_bm_init;
 	gr_screen.gf_bm_page_in_start		= gr_stub_bm_page_in_start;
 	gr_screen.gf_bm_data				= gr_stub_bm_data;
+	gr_screen.gf_bm_is_uploaded			= gr_stub_bm_is_uploaded;
 	gr_screen.gf_bm_make_render_target	= gr_stub_bm_make_render_target;
 	gr_screen.gf_bm_set_render_target	= gr_stub_bm_set_render_target;
 
@@ -621,7 +691,11 @@ bool gr_stub_init()
 
 	gr_screen.gf_update_transform_buffer	= gr_stub_update_transform_buffer;
 	gr_screen.gf_update_buffer_data		= gr_stub_update_buffer_data;
+	gr_screen.gf_update_buffer_data_offset	= gr_stub_update_buffer_data_offset;
 	gr_screen.gf_set_transform_buffer_offset	= gr_stub_set_transform_buffer_offset;
+	gr_screen.gf_set_transform_buffer_instances	= gr_stub_set_transform_buffer_instances;
+	gr_screen.gf_map_immediate_buffer	= gr_stub_map_immediate_buffer;
+	gr_screen.gf_unmap_immediate_buffer	= gr_stub_unmap_immediate_buffer;
 
 	gr_screen.gf_render_stream_buffer		= gr_stub_render_stream_buffer;
 
@@ -644,6 +718,8 @@ bool gr_stub_init()
 	gr_screen.gf_scene_texture_begin = gr_stub_scene_texture_begin;
 	gr_screen.gf_scene_texture_end = gr_stub_scene_texture_end;
 	gr_screen.gf_copy_effect_texture = gr_stub_copy_effect_texture;
+	gr_screen.gf_scene_resolution_begin = gr_stub_scene_resolution_begin;
+	gr_screen.gf_scene_resolution_end = gr_stub_scene_resolution_end;
 
 	gr_screen.gf_deferred_lighting_begin = gr_stub_deferred_lighting_begin;
 	gr_screen.gf_deferred_lighting_end = gr_stub_deferred_lighting_end;
@@ -671,8 +747,12 @@ bool gr_stub_init()
 	gr_screen.gf_shadow_map_end		= gr_stub_shadow_map_end;
 
 	gr_screen.gf_render_shield_impact = gr_stub_render_shield_impact;
+	gr_screen.gf_render_decals = gr_stub_render_decals;
+	gr_screen.gf_render_background_cubemap = gr_stub_render_background_cubemap;
 
 	gr_screen.gf_maybe_create_shader = gr_stub_maybe_create_shader;
+	gr_screen.gf_shader_precompile_begin = gr_stub_shader_precompile_begin;
+	gr_screen.gf_shader_precompile_end = gr_stub_shader_precompile_end;
 	
 	gr_screen.gf_clear_states	= gr_stub_clear_states;
 	
@@ -696,6 +776,8 @@ bool gr_stub_init()
 	gr_screen.gf_query_value = gr_stub_query_value;
 	gr_screen.gf_query_value_available = gr_stub_query_value_available;
 	gr_screen.gf_get_query_value = gr_stub_get_query_value;
+	gr_screen.gf_begin_query = gr_stub_begin_query;
+	gr_screen.gf_end_query = gr_stub_end_query;
 	gr_screen.gf_delete_query_object = gr_stub_delete_query_object;
 
 	gr_screen.gf_create_viewport = [](const os::ViewPortProperties& props) {
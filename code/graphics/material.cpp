@@ -1,4 +1,6 @@
 #include "globalincs/pstypes.h"
+#include "bmpman/bmpman.h"
+#include "ddsutils/ddsutils.h"
 #include "graphics/grinternal.h"
 #include "graphics/2d.h"
 #include "graphics/material.h"
@@ -379,6 +381,46 @@ float material::get_color_scale()
 	return Clr_scale;
 }
 
+/**
+ * Checks if rendering with the other material would result in the same render state
+ */
+bool material::has_same_state(const material &other, bool compare_textures) const
+{
+	for ( int i = 0; compare_textures && i < TM_NUM_TYPES; ++i ) {
+		if ( Texture_maps[i] != other.Texture_maps[i] ) {
+			return false;
+		}
+	}
+
+	if ( Clip_params.enabled != other.Clip_params.enabled ) {
+		return false;
+	}
+
+	if ( Clip_params.enabled && (!vm_vec_same(&Clip_params.normal, &other.Clip_params.normal) || !vm_vec_same(&Clip_params.position, &other.Clip_params.position)) ) {
+		return false;
+	}
+
+	if ( Fog_params.enabled != other.Fog_params.enabled ) {
+		return false;
+	}
+
+	if ( Fog_params.enabled && (Fog_params.r != other.Fog_params.r || Fog_params.g != other.Fog_params.g || Fog_params.b != other.Fog_params.b
+		|| Fog_params.dist_near != other.Fog_params.dist_near || Fog_params.dist_far != other.Fog_params.dist_far) ) {
+		return false;
+	}
+
+	return Sdr_type == other.Sdr_type
+		&& Tex_type == other.Tex_type
+		&& Texture_addressing == other.Texture_addressing
+		&& Depth_mode == other.Depth_mode
+		&& Blend_mode == other.Blend_mode
+		&& Cull_mode == other.Cull_mode
+		&& Fill_mode == other.Fill_mode
+		&& Clr.xyzw.x == other.Clr.xyzw.x && Clr.xyzw.y == other.Clr.xyzw.y && Clr.xyzw.z == other.Clr.xyzw.z && Clr.xyzw.w == other.Clr.xyzw.w
+		&& Clr_scale == other.Clr_scale
+		&& Depth_bias == other.Depth_bias;
+}
+
 model_material::model_material() : material() {
 	set_shader_type(SDR_TYPE_MODEL);
 }
@@ -398,6 +440,11 @@ void model_material::set_shadow_casting(bool enabled)
 	Shadow_casting = enabled;
 }
 
+bool model_material::is_shadow_casting()
+{
+	return Shadow_casting;
+}
+
 void model_material::set_light_factor(float factor)
 {
 	Light_factor = factor;
@@ -496,6 +543,26 @@ bool model_material::is_batched()
 	return Batched;
 }
 
+void model_material::set_depth_prepass(bool enabled)
+{
+	Depth_prepass = enabled;
+}
+
+bool model_material::is_depth_prepass()
+{
+	return Depth_prepass;
+}
+
+void model_material::set_depth_prepassed(bool enabled)
+{
+	Depth_prepassed = enabled;
+}
+
+bool model_material::is_depth_prepassed()
+{
+	return Depth_prepassed;
+}
+
 void model_material::set_normal_alpha(float min, float max)
 {
 	Normal_alpha = true;
@@ -544,6 +611,71 @@ float model_material::get_normal_extrude_width()
 	return Normal_extrude_width;
 }
 
+bool model_material::has_same_state(const model_material &other, bool compare_textures) const
+{
+	if ( !material::has_same_state(other, compare_textures) ) {
+		return false;
+	}
+
+	if ( Team_color_set != other.Team_color_set ) {
+		return false;
+	}
+
+	if ( Team_color_set && memcmp(&Tm_color, &other.Tm_color, sizeof(Tm_color)) != 0 ) {
+		return false;
+	}
+
+	return Desaturate == other.Desaturate
+		&& Shadow_casting == other.Shadow_casting
+		&& Batched == other.Batched
+		&& Depth_prepass == other.Depth_prepass
+		&& Depth_prepassed == other.Depth_prepassed
+		&& Deferred == other.Deferred
+		&& HDR == other.HDR
+		&& lighting == other.lighting
+		&& Light_factor == other.Light_factor
+		&& Center_alpha == other.Center_alpha
+		&& Animated_effect == other.Animated_effect
+		&& Animated_timer == other.Animated_timer
+		&& Thrust_scale == other.Thrust_scale
+		&& Normal_alpha == other.Normal_alpha
+		&& Normal_alpha_min == other.Normal_alpha_min
+		&& Normal_alpha_max == other.Normal_alpha_max
+		&& Normal_extrude == other.Normal_extrude
+		&& Normal_extrude_width == other.Normal_extrude_width;
+}
+
+bool model_material::can_use_texture_arrays()
+{
+	if ( !gr_is_capable(CAPABILITY_TEXTURE_ARRAYS) ) {
+		return false;
+	}
+
+	static const int array_maps[] = { TM_BASE_TYPE, TM_GLOW_TYPE, TM_SPECULAR_TYPE, TM_SPEC_GLOSS_TYPE, TM_NORMAL_TYPE, TM_AMBIENT_TYPE, TM_MISC_TYPE };
+
+	for ( auto type : array_maps ) {
+		int texture = get_texture_map(type);
+
+		if ( texture <= 0 ) {
+			continue;
+		}
+
+		// render targets and cube maps can't be copied into an array
+		if ( bm_is_render_target(texture) ) {
+			return false;
+		}
+
+		switch ( bm_is_compressed(texture) ) {
+		case DDS_CUBEMAP_DXT1:
+		case DDS_CUBEMAP_DXT3:
+		case DDS_CUBEMAP_DXT5:
+			return false;
+		}
+	}
+
+	return true;
+}
+
 uint model_material::get_shader_flags()
 {
 	uint Shader_flags = 0;
@@ -562,6 +694,25 @@ uint model_material::get_shader_flags()
 
 		return Shader_flags;
 	}
+
+	if ( Depth_prepass ) {
+		// only what moves the vertices or discards fragments matters for the depth
+		Shader_flags |= SDR_FLAG_MODEL_DEPTH_PREPASS;
+
+		if ( Thrust_scale > 0.0f ) {
+			Shader_flags |= SDR_FLAG_MODEL_THRUSTER;
+		}
+
+		if ( get_texture_map(TM_BASE_TYPE) > 0 && !Basemap_override ) {
+			Shader_flags |= SDR_FLAG_MODEL_DIFFUSE_MAP;
+
+			if ( can_use_texture_arrays() ) {
+				Shader_flags |= SDR_FLAG_MODEL_TEXTURE_ARRAYS;
+			}
+		}
+
+		return Shader_flags;
+	}
 	
 	if ( is_fogged() ) {
 		Shader_flags |= SDR_FLAG_MODEL_FOG;
@@ -635,11 +786,17 @@ uint model_material::get_shader_flags()
 		Shader_flags |= SDR_FLAG_MODEL_NORMAL_EXTRUDE;
 	}
 
+	if ( (Shader_flags & (SDR_FLAG_MODEL_DIFFUSE_MAP | SDR_FLAG_MODEL_GLOW_MAP | SDR_FLAG_MODEL_SPEC_MAP | SDR_FLAG_MODEL_NORMAL_MAP
+		| SDR_FLAG_MODEL_AMBIENT_MAP | SDR_FLAG_MODEL_MISC_MAP)) && can_use_texture_arrays() ) {
+		Shader_flags |= SDR_FLAG_MODEL_TEXTURE_ARRAYS;
+	}
+
 	return Shader_flags;
 }
 
 particle_material::particle_material(): 
-material()  
+material(), Gpu_simulation(false), Simulation_time(0.0f), Frame_life_start(0.0f), Frame_life_end(0.0f),
+Nebula_poofs(false), Poof_shells(), Poof_break(vmd_zero_vector)
 {
 	set_shader_type(SDR_TYPE_EFFECT_PARTICLE);
 }
@@ -654,6 +811,57 @@ bool particle_material::get_point_sprite_mode()
 	return Point_sprite;
 }
 
+void particle_material::set_gpu_simulation(float time, float life_start, float life_end)
+{
+	Gpu_simulation = true;
+	Simulation_time = time;
+	Frame_life_start = life_start;
+	Frame_life_end = life_end;
+}
+
+bool particle_material::get_gpu_simulation()
+{
+	return Gpu_simulation;
+}
+
+float particle_material::get_simulation_time()
+{
+	return Simulation_time;
+}
+
+float particle_material::get_frame_life_start()
+{
+	return Frame_life_start;
+}
+
+float particle_material::get_frame_life_end()
+{
+	return Frame_life_end;
+}
+
+void particle_material::set_nebula_poofs(float time, const vec4 &shells, const vec3d &break_dist)
+{
+	Nebula_poofs = true;
+	Simulation_time = time;
+	Poof_shells = shells;
+	Poof_break = break_dist;
+}
+
+bool particle_material::get_nebula_poofs()
+{
+	return Nebula_poofs;
+}
+
+const vec4 &particle_material::get_poof_shells()
+{
+	return Poof_shells;
+}
+
+const vec3d &particle_material::get_poof_break()
+{
+	return Poof_break;
+}
+
 uint particle_material::get_shader_flags()
 {
 	uint flags = 0;
@@ -662,6 +870,14 @@ uint particle_material::get_shader_flags()
 		flags |= SDR_FLAG_PARTICLE_POINT_GEN;
 	}
 
+	if ( Gpu_simulation ) {
+		flags |= SDR_FLAG_PARTICLE_GPU_SIM;
+	}
+
+	if ( Nebula_poofs ) {
+		flags |= SDR_FLAG_PARTICLE_NEBULA_POOF;
+	}
+
 	return flags;
 }
 
@@ -686,19 +902,23 @@ shield_material::shield_material() :
 {
 	set_shader_type(SDR_TYPE_SHIELD_DECAL);
 
-	vm_set_identity(&Impact_orient);
-
-	Impact_pos.xyz.x = 0.0f;
-	Impact_pos.xyz.y = 0.0f;
-	Impact_pos.xyz.z = 0.0f;
-
+	Num_impacts = 0;
 	Impact_radius = 1.0f;
 }
 
-void shield_material::set_impact_transform(matrix &orient, vec3d &pos)
+bool shield_material::add_impact(const matrix &orient, const vec3d &pos, int bitmap)
 {
-	Impact_orient = orient;
-	Impact_pos = pos;
+	if ( Num_impacts >= SHIELD_MAX_IMPACTS ) {
+		return false;
+	}
+
+	Impacts[Num_impacts].orient = orient;
+	Impacts[Num_impacts].pos = pos;
+	Impacts[Num_impacts].bitmap = bitmap;
+
+	++Num_impacts;
+
+	return true;
 }
 
 void shield_material::set_impact_radius(float radius)
@@ -706,14 +926,16 @@ void shield_material::set_impact_radius(float radius)
 	Impact_radius = radius;
 }
 
-const matrix& shield_material::get_impact_orient()
+int shield_material::get_num_impacts()
 {
-	return Impact_orient;
+	return Num_impacts;
 }
 
-const vec3d& shield_material::get_impact_pos()
+const shield_material::impact& shield_material::get_impact(int n)
 {
-	return Impact_pos;
+	Assert(n >= 0 && n < Num_impacts);
+
+	return Impacts[n];
 }
 
 float shield_material::get_impact_radius()
@@ -98,6 +98,9 @@ public:
 
 	void set_color_scale(float scale);
 	float get_color_scale();
+
+	// the textures are left out of the comparison for draws which don't sample them
+	bool has_same_state(const material &other, bool compare_textures = true) const;
 };
 
 class model_material : public material
@@ -107,6 +110,9 @@ class model_material : public material
 	bool Shadow_casting = false;
 	bool Batched = false;
 
+	bool Depth_prepass = false;
+	bool Depth_prepassed = false;
+
 	bool Deferred = false;
 	bool HDR = false;
 	bool lighting = false;
@@ -176,18 +182,71 @@ public:
 	void set_batching(bool enabled);
 	bool is_batched();
 
+	// draws only the depth, see model_draw_list::render_depth_prepass()
+	void set_depth_prepass(bool enabled);
+	bool is_depth_prepass();
+
+	// the depth of the draw is already in the depth buffer, so it is drawn with an equal depth test
+	void set_depth_prepassed(bool enabled);
+	bool is_depth_prepassed();
+
+	bool has_same_state(const model_material &other, bool compare_textures = true) const;
+
+	// checks if all texture maps can be sampled from texture arrays
+	bool can_use_texture_arrays();
+
 	virtual uint get_shader_flags();
 };
 
 class particle_material : public material
 {
 	bool Point_sprite;
+
+	bool Gpu_simulation;
+	float Simulation_time;
+	float Frame_life_start;
+	float Frame_life_end;
+
+	bool Nebula_poofs;
+	vec4 Poof_shells;
+	vec3d Poof_break;
 public:
 	particle_material();
 
 	void set_point_sprite_mode(bool enabled);
 	bool get_point_sprite_mode();
 
+	/**
+	 * @brief Lets the shader move and age the particles
+	 *
+	 * Only the particles whose age divided by their lifetime lies in [life_start, life_end) are drawn, that is how a
+	 * single frame of an animation is selected.
+	 *
+	 * @param time The current time of the particle clock
+	 * @param life_start Start of the part of the lifetime which is drawn
+	 * @param life_end End of the part of the lifetime which is drawn
+	 */
+	void set_gpu_simulation(float time, float life_start, float life_end);
+	bool get_gpu_simulation();
+	float get_simulation_time();
+	float get_frame_life_start();
+	float get_frame_life_end();
+
+	/**
+	 * @brief Lets the shader turn and fade the nebula poofs
+	 *
+	 * The poofs fade in between the outer and the inner radius around the eye and out again between the inner radius
+	 * and the fade radius, see neb2_get_alpha_2shell(). Poofs which leave the screen fade out over the break distance.
+	 *
+	 * @param time The current time of the poof clock
+	 * @param shells The inner radius, the outer radius, the fade radius and the maximum alpha
+	 * @param break_dist The break distance in pixels along x and y and the alpha below which a poof isn't drawn
+	 */
+	void set_nebula_poofs(float time, const vec4 &shells, const vec3d &break_dist);
+	bool get_nebula_poofs();
+	const vec4 &get_poof_shells();
+	const vec3d &get_poof_break();
+
 	virtual uint get_shader_flags();
 };
 
@@ -201,19 +260,37 @@ public:
 	bool get_thruster_rendering();
 };
 
+// the number of impacts the shield shader draws at once, see shield-impact-v.sdr
+#define SHIELD_MAX_IMPACTS	4
+
 class shield_material : public material
 {
-	matrix Impact_orient;
-	vec3d Impact_pos;
+public:
+	struct impact {
+		matrix orient;
+		vec3d pos;
+		int bitmap;
+	};
+private:
+	impact Impacts[SHIELD_MAX_IMPACTS];
+	int Num_impacts;
 	float Impact_radius;
 public:
 	shield_material();
 
-	void set_impact_transform(matrix &orient, vec3d &pos);
+	/**
+	 * @brief Adds an impact to the draw, all impacts have the same radius and blend mode
+	 *
+	 * @param orient The orientation of the impact, the forward vector is the normal of the shield which was hit
+	 * @param pos The hit position in the frame of the shield
+	 * @param bitmap The frame of the impact animation
+	 * @return @c false if the draw already has SHIELD_MAX_IMPACTS impacts
+	 */
+	bool add_impact(const matrix &orient, const vec3d &pos, int bitmap);
 	void set_impact_radius(float radius);
 
-	const matrix& get_impact_orient();
-	const vec3d& get_impact_pos();
+	int get_num_impacts();
+	const impact& get_impact(int n);
 	float get_impact_radius();
 };
 
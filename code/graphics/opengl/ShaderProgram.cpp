@@ -5,6 +5,11 @@
 
 #include "graphics/opengl/gropenglstate.h"
 
+// from GL_KHR_parallel_shader_compile, the value is the same for GL_ARB_parallel_shader_compile
+#ifndef GL_COMPLETION_STATUS_KHR
+#define GL_COMPLETION_STATUS_KHR 0x91B1
+#endif
+
 namespace {
 
 /**
@@ -56,30 +61,40 @@ SCP_string get_program_info_log(GLuint program_object)
 }
 
 /**
- * Pass a GLSL shader source to OpenGL and compile it into a usable shader object.
- * Prints compilation errors (if any) to the log.
- * Note that this will only compile shaders into objects, linking them into executables happens later
+ * Pass a GLSL shader source to OpenGL and start compiling it into a shader object. The result isn't checked so the
+ * driver may still be compiling it when this returns, see check_shader_object().
  *
  * @param shader_source		GLSL sourcecode for the shader
  * @param shader_type		OpenGL ID for the type of shader being used, like GL_FRAGMENT_SHADER_ARB, GL_VERTEX_SHADER_ARB
- * @return 					OpenGL handle for the compiled shader object
+ * @return 					OpenGL handle for the shader object
  */
-GLuint compile_shader_object(const SCP_vector<SCP_string>& shader_source, GLenum shader_type)
+GLuint submit_shader_object(const SCP_vector<SCP_string>& shader_source, GLenum shader_type)
 {
-	GLuint shader_object = 0;
-	GLint status = 0;
-
 	SCP_vector<const GLcharARB*> sources;
 	sources.reserve(shader_source.size());
 	for (auto it = shader_source.begin(); it != shader_source.end(); ++it) {
 		sources.push_back(it->c_str());
 	}
 
-	shader_object = glCreateShader(shader_type);
+	auto shader_object = glCreateShader(shader_type);
 
 	glShaderSource(shader_object, static_cast<GLsizei>(sources.size()), &sources[0], NULL);
 	glCompileShader(shader_object);
 
+	return shader_object;
+}
+
+/**
+ * Waits for the compilation of a shader object and prints compilation errors (if any) to the log.
+ *
+ * @param shader_object		OpenGL handle of the shader object
+ * @param shader_type		OpenGL ID for the type of shader being used
+ * @return					@c false if the shader failed to compile
+ */
+bool check_shader_object(GLuint shader_object, GLenum shader_type)
+{
+	GLint status = 0;
+
 	// check if the compile was successful
 	glGetShaderiv(shader_object, GL_COMPILE_STATUS, &status);
 
@@ -90,12 +105,7 @@ GLuint compile_shader_object(const SCP_vector<SCP_string>& shader_source, GLenum
 		// basic error check
 		mprintf(("%s shader failed to compile:\n%s\n", (shader_type == GL_VERTEX_SHADER) ? "Vertex" : ((shader_type == GL_GEOMETRY_SHADER) ? "Geometry" : "Fragment"), info_log.c_str()));
 
-		// this really shouldn't exist, but just in case
-		if (shader_object) {
-			glDeleteProgram(shader_object);
-		}
-
-		throw std::runtime_error("Failed to compile shader!");
+		return false;
 	}
 
 	// we succeeded, maybe output warnings too
@@ -103,12 +113,36 @@ GLuint compile_shader_object(const SCP_vector<SCP_string>& shader_source, GLenum
 		nprintf(("SHADER-DEBUG", "%s shader compiled with warnings:\n%s\n", (shader_type == GL_VERTEX_SHADER) ? "Vertex" : ((shader_type == GL_GEOMETRY_SHADER) ? "Geometry" : "Fragment"), info_log.c_str()));
 	}
 
-	return shader_object;
+	return true;
 }
 
-void link_program(GLuint program) {
-	glLinkProgram(program);
+/**
+ * Pass a GLSL shader source to OpenGL and compile it into a usable shader object.
+ * Prints compilation errors (if any) to the log.
+ * Note that this will only compile shaders into objects, linking them into executables happens later
+ *
+ * @param shader_source		GLSL sourcecode for the shader
+ * @param shader_type		OpenGL ID for the type of shader being used, like GL_FRAGMENT_SHADER_ARB, GL_VERTEX_SHADER_ARB
+ * @return 					OpenGL handle for the compiled shader object
+ */
+GLuint compile_shader_object(const SCP_vector<SCP_string>& shader_source, GLenum shader_type)
+{
+	auto shader_object = submit_shader_object(shader_source, shader_type);
 
+	// we failed, bail out now...
+	if (!check_shader_object(shader_object, shader_type)) {
+		// this really shouldn't exist, but just in case
+		if (shader_object) {
+			glDeleteShader(shader_object);
+		}
+
+		throw std::runtime_error("Failed to compile shader!");
+	}
+
+	return shader_object;
+}
+
+void check_program_link(GLuint program) {
 	GLint status;
 	// check if the link was successful
 	glGetProgramiv(program, GL_LINK_STATUS, &status);
@@ -128,6 +162,12 @@ void link_program(GLuint program) {
 	}
 }
 
+void link_program(GLuint program) {
+	glLinkProgram(program);
+
+	check_program_link(program);
+}
+
 GLenum get_gl_shader_stage(opengl::ShaderStage stage) {
 	switch(stage) {
 		case opengl::STAGE_VERTEX:
@@ -177,6 +217,14 @@ void opengl::ShaderProgram::addShaderCode(opengl::ShaderStage stage, const SCP_s
 	auto shader_obj = compile_shader_object(codeParts, get_gl_shader_stage(stage));
 	opengl_set_object_label(GL_SHADER, shader_obj, name);
 	_compiled_shaders.push_back(shader_obj);
+	_compiled_stages.push_back(get_gl_shader_stage(stage));
+	glAttachShader(_program_id, shader_obj);
+}
+void opengl::ShaderProgram::submitShaderCode(opengl::ShaderStage stage, const SCP_string& name, const SCP_vector<SCP_string>& codeParts) {
+	auto shader_obj = submit_shader_object(codeParts, get_gl_shader_stage(stage));
+	opengl_set_object_label(GL_SHADER, shader_obj, name);
+	_compiled_shaders.push_back(shader_obj);
+	_compiled_stages.push_back(get_gl_shader_stage(stage));
 	glAttachShader(_program_id, shader_obj);
 }
 void opengl::ShaderProgram::freeCompiledShaders() {
@@ -185,6 +233,7 @@ void opengl::ShaderProgram::freeCompiledShaders() {
 		glDeleteShader(compiled_shader);
 	}
 	_compiled_shaders.clear();
+	_compiled_stages.clear();
 }
 void opengl::ShaderProgram::linkProgram() {
 	link_program(_program_id);
@@ -192,6 +241,32 @@ void opengl::ShaderProgram::linkProgram() {
 	// We don't need the shaders anymore
 	freeCompiledShaders();
 }
+void opengl::ShaderProgram::submitLink() {
+	glLinkProgram(_program_id);
+}
+bool opengl::ShaderProgram::isLinkComplete() {
+	GLint complete = GL_TRUE;
+	glGetProgramiv(_program_id, GL_COMPLETION_STATUS_KHR, &complete);
+
+	return complete == GL_TRUE;
+}
+void opengl::ShaderProgram::finishLink() {
+	// the errors of the shaders explain a failed link better than the log of the program
+	bool compiled = true;
+	for (size_t i = 0; i < _compiled_shaders.size(); ++i) {
+		compiled = check_shader_object(_compiled_shaders[i], _compiled_stages[i]) && compiled;
+	}
+
+	if (!compiled) {
+		freeCompiledShaders();
+
+		throw std::runtime_error("Failed to compile shader!");
+	}
+
+	check_program_link(_program_id);
+
+	freeCompiledShaders();
+}
 
 void opengl::ShaderProgram::initAttribute(const SCP_string& name, const vec4& default_value)
 {
@@ -224,6 +299,52 @@ GLint opengl::ShaderProgram::getAttributeLocation(const SCP_string& name) {
 	}
 }
 
+namespace {
+
+SCP_unordered_map<SCP_string, size_t> Uniform_ids;
+
+bool uniform_value_equal(const int& a, const int& b)
+{
+	return a == b;
+}
+bool uniform_value_equal(const float& a, const float& b)
+{
+	return fl_equal(a, b);
+}
+bool uniform_value_equal(const vec2d& a, const vec2d& b)
+{
+	return vm_vec_equal(a, b);
+}
+bool uniform_value_equal(const vec3d& a, const vec3d& b)
+{
+	return vm_vec_equal(a, b);
+}
+bool uniform_value_equal(const vec4& a, const vec4& b)
+{
+	return vm_vec_equal(a, b);
+}
+bool uniform_value_equal(const matrix4& a, const matrix4& b)
+{
+	return vm_matrix_equal(a, b);
+}
+
+}
+
+opengl::uniform_id opengl::get_uniform_id(const SCP_string& name)
+{
+	auto iter = Uniform_ids.find(name);
+
+	uniform_id id;
+	if (iter != Uniform_ids.end()) {
+		id.index = iter->second;
+	} else {
+		id.index = Uniform_ids.size();
+		Uniform_ids.insert(std::make_pair(name, id.index));
+	}
+
+	return id;
+}
+
 opengl::ShaderUniforms::ShaderUniforms(ShaderProgram* shaderProgram) : _program(shaderProgram) {
 	Assertion(shaderProgram != nullptr, "Shader program may not be null!");
 }
@@ -239,209 +360,112 @@ void opengl::ShaderUniforms::initUniform(const SCP_string& name)
 		return;
 	}
 
-	_uniform_locations.insert(std::make_pair(name, location));
-}
+	auto id = get_uniform_id(name);
 
-size_t opengl::ShaderUniforms::findUniform(const SCP_string& name)
-{
-	auto iter = _uniform_lookup.find(name);
-
-	if (iter == _uniform_lookup.end()) {
-		return INVALID_SIZE;
-	}
-	else {
-		return iter->second;
+	if (id.index >= _slots.size()) {
+		_slots.resize(id.index + 1);
 	}
+
+	_slots[id.index].location = location;
 }
-void opengl::ShaderUniforms::setUniformi(const SCP_string &name, const int val)
+
+opengl::ShaderUniforms::uniform_slot* opengl::ShaderUniforms::findSlot(uniform_id id)
 {
 	Assertion(GL_state.IsCurrentProgram(_program->getShaderHandle()), "The program must be current before setting uniforms!");
 
-	size_t uniform_index = findUniform(name);
-	bool resident = false;
-
-	if (uniform_index != (size_t)-1) {
-		Assert(uniform_index < _uniforms.size());
-
-		uniform_bind *bind_info = &_uniforms[uniform_index];
-
-		if (bind_info->type == uniform_bind::INT) {
-			if (_uniform_data_ints[bind_info->index] == val) {
-				return;
-			}
-
-			_uniform_data_ints[bind_info->index] = val;
-			resident = true;
-		}
-	}
-
-	if (!resident) {
-		// uniform doesn't exist in our previous uniform block so queue this new value
-		_uniform_data_ints.push_back(val);
-
-		uniform_bind new_bind;
-
-		new_bind.count = 1;
-		new_bind.index = _uniform_data_ints.size() - 1;
-		new_bind.type = uniform_bind::INT;
-		new_bind.name = name;
-
-		_uniforms.push_back(new_bind);
-
-		_uniform_lookup[name] = _uniforms.size() - 1;
+	if (id.index >= _slots.size() || _slots[id.index].location == -1) {
+		// not used by this program
+		return nullptr;
 	}
 
-	glUniform1i(findUniformLocation(name.c_str()), val);
+	return &_slots[id.index];
 }
 
-void opengl::ShaderUniforms::setUniform1iv(const SCP_string &name, const int count, const int *val)
+/**
+ * Stores a new value of a uniform
+ * @return @c true if the value is different from the last one and needs to be passed to GL
+ */
+template<typename T>
+bool opengl::ShaderUniforms::updateValue(uniform_slot* slot, SCP_vector<T>& data, data_type type, const int count, const T* val)
 {
-	Assertion(GL_state.IsCurrentProgram(_program->getShaderHandle()), "The program must be current before setting uniforms!");
+	if (slot->set && slot->type == type && slot->count == count) {
+		bool equal = true;
 
-	auto uniform_index = findUniform(name);
-	bool resident = false;
-
-	if (uniform_index != INVALID_SIZE) {
-		Assert((size_t)uniform_index < _uniforms.size());
-
-		uniform_bind *bind_info = &_uniforms[uniform_index];
-
-		if (bind_info->type == uniform_bind::INT && bind_info->count == count) {
-			bool equal = true;
-
-			// if the values are close enough, pass.
-			for (int i = 0; i < count; ++i) {
-				if (val[i] != _uniform_data_ints[bind_info->index + i]) {
-					equal = false;
-					break;
-				}
-			}
-
-			if (equal) {
-				return;
-			}
-
-			resident = true;
-			for (int i = 0; i < count; ++i) {
-				_uniform_data_ints[bind_info->index + i] = val[i];
+		// if the values are close enough, pass.
+		for (int i = 0; i < count; ++i) {
+			if (!uniform_value_equal(val[i], data[slot->index + i])) {
+				equal = false;
+				break;
 			}
 		}
-	}
 
-	if (!resident) {
-		// uniform doesn't exist in our previous uniform block so queue this new value
-		for (int i = 0; i < count; ++i) {
-			_uniform_data_ints.push_back(val[i]);
+		if (equal) {
+			return false;
 		}
+	} else {
+		// first value of this uniform (or the uniform changed its type) so it needs new storage
+		slot->set = true;
+		slot->type = type;
+		slot->count = count;
+		slot->index = data.size();
 
-		uniform_bind new_bind;
-		new_bind.count = count;
-		new_bind.index = _uniform_data_ints.size() - count;
-		//	new_bind.index = num_matrix_uniforms - count;
-		new_bind.type = uniform_bind::INT;
-		new_bind.name = name;
-
-		_uniforms.push_back(new_bind);
+		data.resize(data.size() + count);
+	}
 
-		_uniform_lookup[name] = _uniforms.size() - 1;
+	for (int i = 0; i < count; ++i) {
+		data[slot->index + i] = val[i];
 	}
 
-	glUniform1iv(findUniformLocation(name.c_str()), count, (const GLint*)val);
+	return true;
 }
 
-void opengl::ShaderUniforms::setUniformf(const SCP_string &name, const float val)
+void opengl::ShaderUniforms::setUniformi(uniform_id id, const int val)
 {
-	Assertion(GL_state.IsCurrentProgram(_program->getShaderHandle()), "The program must be current before setting uniforms!");
-
-	size_t uniform_index = findUniform(name);
-	bool resident = false;
-
-	if (uniform_index != (size_t)-1) {
-		Assert((size_t)uniform_index < _uniforms.size());
-
-		uniform_bind *bind_info = &_uniforms[uniform_index];
+	auto slot = findSlot(id);
 
-		if (bind_info->type == uniform_bind::FLOAT) {
-			if (fl_equal(_uniform_data_floats[bind_info->index], val)) {
-				return;
-			}
-
-			_uniform_data_floats[bind_info->index] = val;
-			resident = true;
-		}
+	if (slot != nullptr && updateValue(slot, _uniform_data_ints, INT, 1, &val)) {
+		glUniform1i(slot->location, val);
 	}
+}
 
-	if (!resident) {
-		// uniform doesn't exist in our previous uniform block so queue this new value
-		_uniform_data_floats.push_back(val);
-
-		uniform_bind new_bind;
+void opengl::ShaderUniforms::setUniform1iv(uniform_id id, const int count, const int *val)
+{
+	auto slot = findSlot(id);
 
-		new_bind.count = 1;
-		new_bind.index = _uniform_data_floats.size() - 1;
-		new_bind.type = uniform_bind::FLOAT;
-		new_bind.name = name;
+	if (slot != nullptr && updateValue(slot, _uniform_data_ints, INT, count, val)) {
+		glUniform1iv(slot->location, count, (const GLint*)val);
+	}
+}
 
-		_uniforms.push_back(new_bind);
+void opengl::ShaderUniforms::setUniformf(uniform_id id, const float val)
+{
+	auto slot = findSlot(id);
 
-		_uniform_lookup[name] = _uniforms.size() - 1;
+	if (slot != nullptr && updateValue(slot, _uniform_data_floats, FLOAT, 1, &val)) {
+		glUniform1f(slot->location, val);
 	}
-
-	glUniform1f(findUniformLocation(name.c_str()), val);
 }
 
-void opengl::ShaderUniforms::setUniform2f(const SCP_string &name, const float x, const float y)
+void opengl::ShaderUniforms::setUniform2f(uniform_id id, const float x, const float y)
 {
 	vec2d temp;
 
 	temp.x = x;
 	temp.y = y;
 
-	setUniform2f(name, temp);
+	setUniform2f(id, temp);
 }
 
-void opengl::ShaderUniforms::setUniform2f(const SCP_string &name, const vec2d &val)
+void opengl::ShaderUniforms::setUniform2f(uniform_id id, const vec2d &val)
 {
-	Assertion(GL_state.IsCurrentProgram(_program->getShaderHandle()), "The program must be current before setting uniforms!");
-
-	size_t uniform_index = findUniform(name);
-	bool resident = false;
-
-	if (uniform_index != (size_t)-1) {
-		Assert((size_t)uniform_index < _uniforms.size());
-
-		uniform_bind *bind_info = &_uniforms[uniform_index];
-
-		if (bind_info->type == uniform_bind::VEC2) {
-			if (vm_vec_equal(_uniform_data_vec2d[bind_info->index], val)) {
-				return;
-			}
-
-			_uniform_data_vec2d[bind_info->index] = val;
-			resident = true;
-		}
-	}
-
-	if (!resident) {
-		// uniform doesn't exist in our previous uniform block so queue this new value
-		_uniform_data_vec2d.push_back(val);
-
-		uniform_bind new_bind;
-
-		new_bind.count = 1;
-		new_bind.index = _uniform_data_vec2d.size() - 1;
-		new_bind.type = uniform_bind::VEC2;
-		new_bind.name = name;
+	auto slot = findSlot(id);
 
-		_uniforms.push_back(new_bind);
-
-		_uniform_lookup[name] = _uniforms.size() - 1;
+	if (slot != nullptr && updateValue(slot, _uniform_data_vec2d, VEC2, 1, &val)) {
+		glUniform2f(slot->location, val.x, val.y);
 	}
-
-	glUniform2f(findUniformLocation(name.c_str()), val.x, val.y);
 }
 
-void opengl::ShaderUniforms::setUniform3f(const SCP_string &name, const float x, const float y, const float z)
+void opengl::ShaderUniforms::setUniform3f(uniform_id id, const float x, const float y, const float z)
 {
 	vec3d temp;
 
@@ -449,51 +473,19 @@ void opengl::ShaderUniforms::setUniform3f(const SCP_string &name, const float x,
 	temp.xyz.y = y;
 	temp.xyz.z = z;
 
-	setUniform3f(name, temp);
+	setUniform3f(id, temp);
 }
 
-void opengl::ShaderUniforms::setUniform3f(const SCP_string &name, const vec3d &val)
+void opengl::ShaderUniforms::setUniform3f(uniform_id id, const vec3d &val)
 {
-	Assertion(GL_state.IsCurrentProgram(_program->getShaderHandle()), "The program must be current before setting uniforms!");
-
-	size_t uniform_index = findUniform(name);
-	bool resident = false;
+	auto slot = findSlot(id);
 
-	if (uniform_index != (size_t)-1) {
-		Assert((size_t)uniform_index < _uniforms.size());
-
-		uniform_bind *bind_info = &_uniforms[uniform_index];
-
-		if (bind_info->type == uniform_bind::VEC3) {
-			if (vm_vec_equal(_uniform_data_vec3d[bind_info->index], val)) {
-				return;
-			}
-
-			_uniform_data_vec3d[bind_info->index] = val;
-			resident = true;
-		}
-	}
-
-	if (!resident) {
-		// uniform doesn't exist in our previous uniform block so queue this new value
-		_uniform_data_vec3d.push_back(val);
-
-		uniform_bind new_bind;
-
-		new_bind.count = 1;
-		new_bind.index = _uniform_data_vec3d.size() - 1;
-		new_bind.type = uniform_bind::VEC3;
-		new_bind.name = name;
-
-		_uniforms.push_back(new_bind);
-
-		_uniform_lookup[name] = _uniforms.size() - 1;
+	if (slot != nullptr && updateValue(slot, _uniform_data_vec3d, VEC3, 1, &val)) {
+		glUniform3f(slot->location, val.a1d[0], val.a1d[1], val.a1d[2]);
 	}
-
-	glUniform3f(findUniformLocation(name.c_str()), val.a1d[0], val.a1d[1], val.a1d[2]);
 }
 
-void opengl::ShaderUniforms::setUniform4f(const SCP_string &name, const float x, const float y, const float z, const float w)
+void opengl::ShaderUniforms::setUniform4f(uniform_id id, const float x, const float y, const float z, const float w)
 {
 	vec4 temp;
 
@@ -502,321 +494,55 @@ void opengl::ShaderUniforms::setUniform4f(const SCP_string &name, const float x,
 	temp.xyzw.z = z;
 	temp.xyzw.w = w;
 
-	setUniform4f(name, temp);
+	setUniform4f(id, temp);
 }
 
-void opengl::ShaderUniforms::setUniform4f(const SCP_string &name, const vec4 &val)
+void opengl::ShaderUniforms::setUniform4f(uniform_id id, const vec4 &val)
 {
-	Assertion(GL_state.IsCurrentProgram(_program->getShaderHandle()), "The program must be current before setting uniforms!");
-
-	size_t uniform_index = findUniform(name);
-	bool resident = false;
-
-	if (uniform_index != (size_t)-1) {
-		Assert((size_t)uniform_index < _uniforms.size());
-
-		uniform_bind *bind_info = &_uniforms[uniform_index];
-
-		if (bind_info->type == uniform_bind::VEC4) {
-			if (vm_vec_equal(_uniform_data_vec4[bind_info->index], val)) {
-				// if the values are close enough, pass.
-				return;
-			}
+	auto slot = findSlot(id);
 
-			_uniform_data_vec4[bind_info->index] = val;
-			resident = true;
-		}
+	if (slot != nullptr && updateValue(slot, _uniform_data_vec4, VEC4, 1, &val)) {
+		glUniform4f(slot->location, val.a1d[0], val.a1d[1], val.a1d[2], val.a1d[3]);
 	}
-
-	if (!resident) {
-		// uniform doesn't exist in our previous uniform block so queue this new value
-		_uniform_data_vec4.push_back(val);
-
-		uniform_bind new_bind;
-
-		new_bind.count = 1;
-		new_bind.index = _uniform_data_vec4.size() - 1;
-		new_bind.type = uniform_bind::VEC4;
-		new_bind.name = name;
-
-		_uniforms.push_back(new_bind);
-
-		_uniform_lookup[name] = _uniforms.size() - 1;
-	}
-
-	glUniform4f(findUniformLocation(name.c_str()), val.a1d[0], val.a1d[1], val.a1d[2], val.a1d[3]);
 }
 
-void opengl::ShaderUniforms::setUniform1fv(const SCP_string &name, const int count, const float *val)
+void opengl::ShaderUniforms::setUniform1fv(uniform_id id, const int count, const float *val)
 {
-	Assertion(GL_state.IsCurrentProgram(_program->getShaderHandle()), "The program must be current before setting uniforms!");
+	auto slot = findSlot(id);
 
-	auto uniform_index = findUniform(name);
-	bool resident = false;
-
-	if (uniform_index != INVALID_SIZE) {
-		Assert((size_t)uniform_index < _uniforms.size());
-
-		uniform_bind *bind_info = &_uniforms[uniform_index];
-
-		if (bind_info->type == uniform_bind::FLOAT && bind_info->count == count) {
-			bool equal = true;
-
-			// if the values are close enough, pass.
-			for (int i = 0; i < count; ++i) {
-				if (!fl_equal(val[i], _uniform_data_floats[bind_info->index + i])) {
-					equal = false;
-					break;
-				}
-			}
-
-			if (equal) {
-				return;
-			}
-
-			resident = true;
-			for (int i = 0; i < count; ++i) {
-				_uniform_data_floats[bind_info->index + i] = val[i];
-			}
-		}
+	if (slot != nullptr && updateValue(slot, _uniform_data_floats, FLOAT, count, val)) {
+		glUniform1fv(slot->location, count, (const GLfloat*)val);
 	}
-
-	if (!resident) {
-		// uniform doesn't exist in our previous uniform block so queue this new value
-		for (int i = 0; i < count; ++i) {
-			_uniform_data_floats.push_back(val[i]);
-		}
-
-		uniform_bind new_bind;
-		new_bind.count = count;
-		new_bind.index = _uniform_data_floats.size() - count;
-		//	new_bind.index = num_matrix_uniforms - count;
-		new_bind.type = uniform_bind::FLOAT;
-		new_bind.name = name;
-
-		_uniforms.push_back(new_bind);
-
-		_uniform_lookup[name] = _uniforms.size() - 1;
-	}
-
-	glUniform1fv(findUniformLocation(name.c_str()), count, (const GLfloat*)val);
 }
 
-void opengl::ShaderUniforms::setUniform3fv(const SCP_string &name, const int count, const vec3d *val)
+void opengl::ShaderUniforms::setUniform3fv(uniform_id id, const int count, const vec3d *val)
 {
-	Assertion(GL_state.IsCurrentProgram(_program->getShaderHandle()), "The program must be current before setting uniforms!");
-
-	auto uniform_index = findUniform(name);
-	bool resident = false;
-
-	if (uniform_index != INVALID_SIZE) {
-		Assert((size_t)uniform_index < _uniforms.size());
-
-		uniform_bind *bind_info = &_uniforms[uniform_index];
+	auto slot = findSlot(id);
 
-		if (bind_info->type == uniform_bind::VEC3 && bind_info->count == count) {
-			bool equal = true;
-
-			// if the values are close enough, pass.
-			for (int i = 0; i < count; ++i) {
-				if (!vm_vec_equal(val[i], _uniform_data_vec3d[bind_info->index + i])) {
-					equal = false;
-					break;
-				}
-			}
-
-			if (equal) {
-				return;
-			}
-
-			resident = true;
-			for (int i = 0; i < count; ++i) {
-				_uniform_data_vec3d[bind_info->index + i] = val[i];
-			}
-		}
-	}
-
-	if (!resident) {
-		// uniform doesn't exist in our previous uniform block so queue this new value
-		for (int i = 0; i < count; ++i) {
-			_uniform_data_vec3d.push_back(val[i]);
-		}
-
-		uniform_bind new_bind;
-		new_bind.count = count;
-		new_bind.index = _uniform_data_vec3d.size() - count;
-		//	new_bind.index = num_matrix_uniforms - count;
-		new_bind.type = uniform_bind::VEC3;
-		new_bind.name = name;
-
-		_uniforms.push_back(new_bind);
-
-		_uniform_lookup[name] = _uniforms.size() - 1;
+	if (slot != nullptr && updateValue(slot, _uniform_data_vec3d, VEC3, count, val)) {
+		glUniform3fv(slot->location, count, (const GLfloat*)val);
 	}
-
-	glUniform3fv(findUniformLocation(name.c_str()), count, (const GLfloat*)val);
 }
 
-void opengl::ShaderUniforms::setUniform4fv(const SCP_string &name, const int count, const vec4 *val)
+void opengl::ShaderUniforms::setUniform4fv(uniform_id id, const int count, const vec4 *val)
 {
-	Assertion(GL_state.IsCurrentProgram(_program->getShaderHandle()), "The program must be current before setting uniforms!");
-
-	auto uniform_index = findUniform(name);
-	bool resident = false;
-
-	if (uniform_index != INVALID_SIZE) {
-		Assert((size_t)uniform_index < _uniforms.size());
-
-		uniform_bind *bind_info = &_uniforms[uniform_index];
-
-		if (bind_info->type == uniform_bind::VEC4 && bind_info->count == count) {
-			bool equal = true;
-
-			// if the values are close enough, pass.
-			for (int i = 0; i < count; ++i) {
-				if (!vm_vec_equal(val[i], _uniform_data_vec4[bind_info->index + i])) {
-					equal = false;
-					break;
-				}
-			}
+	auto slot = findSlot(id);
 
-			if (equal) {
-				return;
-			}
-
-			resident = true;
-			for (int i = 0; i < count; ++i) {
-				_uniform_data_vec4[bind_info->index + i] = val[i];
-			}
-		}
+	if (slot != nullptr && updateValue(slot, _uniform_data_vec4, VEC4, count, val)) {
+		glUniform4fv(slot->location, count, (const GLfloat*)val);
 	}
-
-	if (!resident) {
-		// uniform doesn't exist in our previous uniform block so queue this new value
-		for (int i = 0; i < count; ++i) {
-			_uniform_data_vec4.push_back(val[i]);
-		}
-
-		uniform_bind new_bind;
-		new_bind.count = count;
-		new_bind.index = _uniform_data_vec4.size() - count;
-		//	new_bind.index = num_matrix_uniforms - count;
-		new_bind.type = uniform_bind::VEC4;
-		new_bind.name = name;
-
-		_uniforms.push_back(new_bind);
-
-		_uniform_lookup[name] = _uniforms.size() - 1;
-	}
-
-	glUniform4fv(findUniformLocation(name.c_str()), count, (const GLfloat*)val);
 }
 
-void opengl::ShaderUniforms::setUniformMatrix4f(const SCP_string &name, const matrix4 &val)
+void opengl::ShaderUniforms::setUniformMatrix4f(uniform_id id, const matrix4 &val)
 {
-	Assertion(GL_state.IsCurrentProgram(_program->getShaderHandle()), "The program must be current before setting uniforms!");
-
-	size_t uniform_index = findUniform(name);
-	bool resident = false;
-
-	if (uniform_index != (size_t)-1) {
-		Assert((size_t)uniform_index < _uniforms.size());
-
-		uniform_bind *bind_info = &_uniforms[uniform_index];
-
-		if (bind_info->type == uniform_bind::MATRIX4 && bind_info->count == 1) {
-			if (vm_matrix_equal(_uniform_data_matrix4[bind_info->index], val)) {
-				return;
-			}
-
-			_uniform_data_matrix4[bind_info->index] = val;
-			resident = true;
-		}
-	}
-
-	if (!resident) {
-		// uniform doesn't exist in our previous uniform block so queue this new value
-		//matrix_uniform_data[num_matrix_uniforms] = val;
-		//memcpy(&(matrix_uniform_data[num_matrix_uniforms]), &val, sizeof(matrix4));
-		_uniform_data_matrix4.push_back(val);
-		//	num_matrix_uniforms += 1;
-
-		uniform_bind new_bind;
-		new_bind.count = 1;
-		new_bind.index = _uniform_data_matrix4.size() - 1;
-		//	new_bind.index = num_matrix_uniforms - 1;
-		new_bind.type = uniform_bind::MATRIX4;
-		new_bind.name = name;
-
-		_uniforms.push_back(new_bind);
-
-		_uniform_lookup[name] = _uniforms.size() - 1;
-	}
-
-	glUniformMatrix4fv(findUniformLocation(name.c_str()), 1, GL_FALSE, (const GLfloat*)&val);
+	setUniformMatrix4fv(id, 1, &val);
 }
 
-void opengl::ShaderUniforms::setUniformMatrix4fv(const SCP_string &name, const int count, const matrix4 *val)
+void opengl::ShaderUniforms::setUniformMatrix4fv(uniform_id id, const int count, const matrix4 *val)
 {
-	Assertion(GL_state.IsCurrentProgram(_program->getShaderHandle()), "The program must be current before setting uniforms!");
-
-	size_t uniform_index = findUniform(name);
-	bool resident = false;
-
-	if (uniform_index != (size_t)-1) {
-		Assert((size_t)uniform_index < _uniforms.size());
-
-		uniform_bind *bind_info = &_uniforms[uniform_index];
+	auto slot = findSlot(id);
 
-		if (bind_info->type == uniform_bind::MATRIX4 && bind_info->count == count) {
-			bool equal = true;
-
-			// if the values are close enough, pass.
-			for (int i = 0; i < count; ++i) {
-				if (!vm_matrix_equal(val[i], _uniform_data_matrix4[bind_info->index + i])) {
-					equal = false;
-					break;
-				}
-			}
-
-			if (equal) {
-				return;
-			}
-
-			resident = true;
-			for (int i = 0; i < count; ++i) {
-				_uniform_data_matrix4[bind_info->index + i] = val[i];
-			}
-		}
-	}
-
-	if (!resident) {
-		// uniform doesn't exist in our previous uniform block so queue this new value
-		for (int i = 0; i < count; ++i) {
-			_uniform_data_matrix4.push_back(val[i]);
-		}
-
-		uniform_bind new_bind;
-		new_bind.count = count;
-		new_bind.index = _uniform_data_matrix4.size() - count;
-		//	new_bind.index = num_matrix_uniforms - count;
-		new_bind.type = uniform_bind::MATRIX4;
-		new_bind.name = name;
-
-		_uniforms.push_back(new_bind);
-
-		_uniform_lookup[name] = _uniforms.size() - 1;
-	}
-
-	glUniformMatrix4fv(findUniformLocation(name.c_str()), count, GL_FALSE, (const GLfloat*)val);
-}
-GLint opengl::ShaderUniforms::findUniformLocation(const SCP_string& name) {
-	auto iter = _uniform_locations.find(name);
-
-	if (iter == _uniform_locations.end()) {
-		return -1;
-	}
-	else {
-		return iter->second;
+	if (slot != nullptr && updateValue(slot, _uniform_data_matrix4, MATRIX4, count, val)) {
+		glUniformMatrix4fv(slot->location, count, GL_FALSE, (const GLfloat*)val);
 	}
 }
@@ -10,30 +10,56 @@
 namespace opengl {
 
 class ShaderProgram;
+/**
+ * @brief Engine wide number of a uniform name
+ *
+ * Every uniform name is registered once and referred to by this number afterwards so setting a uniform only has to
+ * index an array instead of looking up the name. Use SDR_UNIFORM() for names which are known at compile time.
+ */
+struct uniform_id {
+	size_t index;
+};
+
+/**
+ * @brief Gets the number of a uniform name, registering the name if it wasn't used yet
+ *
+ * @param name The name of the uniform
+ * @return The number of the name
+ */
+uniform_id get_uniform_id(const SCP_string& name);
+
+/**
+ * @brief Resolves a constant uniform name only once per call site
+ */
+#define SDR_UNIFORM(name) ([]() { static const ::opengl::uniform_id id = ::opengl::get_uniform_id(name); return id; }())
+
 class ShaderUniforms {
-	struct uniform_bind
+	enum data_type {
+		INT,
+		FLOAT,
+		VEC2,
+		VEC3,
+		VEC4,
+		MATRIX4
+	};
+
+	// what is known about one uniform in this program, indexed by the uniform number
+	struct uniform_slot
 	{
-		SCP_string name;
-
-		enum data_type {
-			INT,
-			FLOAT,
-			VEC2,
-			VEC3,
-			VEC4,
-			MATRIX4
-		};
-
-		uniform_bind::data_type type;
-		size_t index;
+		GLint location;
 
+		// the last value which was passed to GL, only valid if set is true
+		bool set;
+		data_type type;
+		size_t index;
 		int count;
-		int tranpose;
+
+		uniform_slot() : location(-1), set(false), type(INT), index(0), count(0) {}
 	};
 
 	ShaderProgram* _program;
 
-	SCP_vector<uniform_bind> _uniforms;
+	SCP_vector<uniform_slot> _slots;
 
 	SCP_vector<int> _uniform_data_ints;
 	SCP_vector<float> _uniform_data_floats;
@@ -42,31 +68,45 @@ class ShaderUniforms {
 	SCP_vector<vec4> _uniform_data_vec4;
 	SCP_vector<matrix4> _uniform_data_matrix4;
 
-	SCP_unordered_map<SCP_string, size_t> _uniform_lookup;
+	uniform_slot* findSlot(uniform_id id);
 
-	SCP_unordered_map<SCP_string, GLint> _uniform_locations;
-
-	size_t findUniform(const SCP_string &name);
-	GLint findUniformLocation(const SCP_string& name);
+	template<typename T>
+	bool updateValue(uniform_slot* slot, SCP_vector<T>& data, data_type type, const int count, const T* val);
  public:
 	explicit ShaderUniforms(ShaderProgram* shaderProgram);
 
 	void initUniform(const SCP_string& name);
 
-	void setUniformi(const SCP_string &name, const int value);
-	void setUniform1iv(const SCP_string &name, const int count, const int *val);
-	void setUniformf(const SCP_string &name, const float value);
-	void setUniform2f(const SCP_string &name, const float x, const float y);
-	void setUniform2f(const SCP_string &name, const vec2d &val);
-	void setUniform3f(const SCP_string &name, const float x, const float y, const float z);
-	void setUniform3f(const SCP_string &name, const vec3d &value);
-	void setUniform4f(const SCP_string &name, const float x, const float y, const float z, const float w);
-	void setUniform4f(const SCP_string &name, const vec4 &val);
-	void setUniform1fv(const SCP_string &name, const int count, const float *val);
-	void setUniform3fv(const SCP_string &name, const int count, const vec3d *val);
-	void setUniform4fv(const SCP_string &name, const int count, const vec4 *val);
-	void setUniformMatrix4fv(const SCP_string &name, const int count, const matrix4 *value);
-	void setUniformMatrix4f(const SCP_string &name, const matrix4 &val);
+	void setUniformi(uniform_id id, const int value);
+	void setUniform1iv(uniform_id id, const int count, const int *val);
+	void setUniformf(uniform_id id, const float value);
+	void setUniform2f(uniform_id id, const float x, const float y);
+	void setUniform2f(uniform_id id, const vec2d &val);
+	void setUniform3f(uniform_id id, const float x, const float y, const float z);
+	void setUniform3f(uniform_id id, const vec3d &value);
+	void setUniform4f(uniform_id id, const float x, const float y, const float z, const float w);
+	void setUniform4f(uniform_id id, const vec4 &val);
+	void setUniform1fv(uniform_id id, const int count, const float *val);
+	void setUniform3fv(uniform_id id, const int count, const vec3d *val);
+	void setUniform4fv(uniform_id id, const int count, const vec4 *val);
+	void setUniformMatrix4fv(uniform_id id, const int count, const matrix4 *value);
+	void setUniformMatrix4f(uniform_id id, const matrix4 &val);
+
+	// Versions for names which are only known at runtime, these need to look up the name first
+	void setUniformi(const SCP_string &name, const int value) { setUniformi(get_uniform_id(name), value); }
+	void setUniform1iv(const SCP_string &name, const int count, const int *val) { setUniform1iv(get_uniform_id(name), count, val); }
+	void setUniformf(const SCP_string &name, const float value) { setUniformf(get_uniform_id(name), value); }
+	void setUniform2f(const SCP_string &name, const float x, const float y) { setUniform2f(get_uniform_id(name), x, y); }
+	void setUniform2f(const SCP_string &name, const vec2d &val) { setUniform2f(get_uniform_id(name), val); }
+	void setUniform3f(const SCP_string &name, const float x, const float y, const float z) { setUniform3f(get_uniform_id(name), x, y, z); }
+	void setUniform3f(const SCP_string &name, const vec3d &value) { setUniform3f(get_uniform_id(name), value); }
+	void setUniform4f(const SCP_string &name, const float x, const float y, const float z, const float w) { setUniform4f(get_uniform_id(name), x, y, z, w); }
+	void setUniform4f(const SCP_string &name, const vec4 &val) { setUniform4f(get_uniform_id(name), val); }
+	void setUniform1fv(const SCP_string &name, const int count, const float *val) { setUniform1fv(get_uniform_id(name), count, val); }
+	void setUniform3fv(const SCP_string &name, const int count, const vec3d *val) { setUniform3fv(get_uniform_id(name), count, val); }
+	void setUniform4fv(const SCP_string &name, const int count, const vec4 *val) { setUniform4fv(get_uniform_id(name), count, val); }
+	void setUniformMatrix4fv(const SCP_string &name, const int count, const matrix4 *value) { setUniformMatrix4fv(get_uniform_id(name), count, value); }
+	void setUniformMatrix4f(const SCP_string &name, const matrix4 &val) { setUniformMatrix4f(get_uniform_id(name), val); }
 };
 
 enum ShaderStage {
@@ -79,6 +119,7 @@ class ShaderProgram {
 	GLuint _program_id;
 
 	SCP_vector<GLuint> _compiled_shaders;
+	SCP_vector<GLenum> _compiled_stages;
 
 	SCP_unordered_map<SCP_string, GLint> _attribute_locations;
 
@@ -101,6 +142,17 @@ class ShaderProgram {
 
 	void linkProgram();
 
+	// The asynchronous version of addShaderCode() and linkProgram(): the driver may still be working on the program
+	// when these return, finishLink() waits for it and throws like linkProgram() if it failed. isLinkComplete() checks
+	// without waiting but it's only meaningful if GL_KHR_parallel_shader_compile is supported.
+	void submitShaderCode(ShaderStage stage, const SCP_string& name, const SCP_vector<SCP_string>& codeParts);
+
+	void submitLink();
+
+	bool isLinkComplete();
+
+	void finishLink();
+
 	void initAttribute(const SCP_string& name, const vec4& default_value);
 
 	GLint getAttributeLocation(const SCP_string& name);
@@ -14,6 +14,7 @@
 #include "gropengl.h"
 #include "gropenglbmpman.h"
 #include "gropengldraw.h"
+#include "gropengldynres.h"
 #include "gropengllight.h"
 #include "gropenglpostprocessing.h"
 #include "gropenglquery.h"
@@ -62,6 +63,8 @@ static ushort *GL_original_gamma_ramp = NULL;
 
 int Use_PBOs = 0;
 
+bool GL_parallel_shader_compile = false;
+
 float GL_line_width = 1.0f;
 
 static ubyte *GL_saved_screen = NULL;
@@ -149,6 +152,8 @@ void gr_opengl_clear()
 		blue = pow(blue, SRGB_GAMMA);
 	}
 
+	opengl_flush_string_batch();
+
 	glClearColor(red, green, blue, alpha);
 
 	glClear ( GL_COLOR_BUFFER_BIT );
@@ -161,6 +166,8 @@ void gr_opengl_flip()
 
 	TRACE_SCOPE(tracing::PageFlip);
 
+	opengl_flush_string_batch();
+
 	gr_reset_clip();
 
 	mouse_reset_deltas();
@@ -171,7 +178,9 @@ void gr_opengl_flip()
 	current_viewport->swapBuffers();
 
 	opengl_tcache_frame();
+	opengl_shader_frame();
 	opengl_reset_immediate_buffer();
+	opengl_frame_stats_end_frame();
 
 #ifndef NDEBUG
 	int ic = opengl_check_for_errors();
@@ -399,6 +408,7 @@ void gr_opengl_shutdown()
 	opengl_tcache_shutdown();
 	opengl_light_shutdown();
 	opengl_tnl_shutdown();
+	opengl_scene_resolution_shutdown();
 	opengl_scene_texture_shutdown();
 	opengl_post_process_shutdown();
 	opengl_shader_shutdown();
@@ -487,6 +497,8 @@ int gr_opengl_set_color_buffer(int mode)
 {
 	GLboolean enabled = GL_FALSE;
 
+	opengl_flush_bitmap_batch();
+
 	if ( mode ) {
 		enabled = GL_state.ColorMask(GL_TRUE);
 	} else {
@@ -551,6 +563,8 @@ int gr_opengl_stencil_set(int mode)
 {
 	int tmp = gr_stencil_mode;
 
+	opengl_flush_bitmap_batch();
+
 	gr_stencil_mode = mode;
 
 	if ( mode == GR_STENCIL_READ ) {
@@ -1140,6 +1154,8 @@ void opengl_setup_function_pointers()
 //	gr_screen.gf_rect				= gr_opengl_rect;
 //	gr_screen.gf_shade				= gr_opengl_shade;
 	gr_screen.gf_string				= gr_opengl_string;
+	gr_screen.gf_string_batch_begin	= gr_opengl_string_batch_begin;
+	gr_screen.gf_string_batch_end	= gr_opengl_string_batch_end;
 	gr_screen.gf_circle				= gr_opengl_circle;
 	gr_screen.gf_unfilled_circle	= gr_opengl_unfilled_circle;
 	gr_screen.gf_arc				= gr_opengl_arc;
@@ -1182,6 +1198,7 @@ void opengl_setup_function_pointers()
 	gr_screen.gf_bm_init				= gr_opengl_bm_init;
 	gr_screen.gf_bm_page_in_start		= gr_opengl_bm_page_in_start;
 	gr_screen.gf_bm_data				= gr_opengl_bm_data;
+	gr_screen.gf_bm_is_uploaded			= gr_opengl_bm_is_uploaded;
 	gr_screen.gf_bm_make_render_target	= gr_opengl_bm_make_render_target;
 	gr_screen.gf_bm_set_render_target	= gr_opengl_bm_set_render_target;
 
@@ -1205,9 +1222,13 @@ void opengl_setup_function_pointers()
 	gr_screen.gf_create_index_buffer	= gr_opengl_create_index_buffer;
 	gr_screen.gf_delete_buffer		= gr_opengl_delete_buffer;
 	gr_screen.gf_update_buffer_data		= gr_opengl_update_buffer_data;
+	gr_screen.gf_update_buffer_data_offset	= gr_opengl_update_buffer_data_offset;
 
 	gr_screen.gf_update_transform_buffer	= gr_opengl_update_transform_buffer;
 	gr_screen.gf_set_transform_buffer_offset	= gr_opengl_set_transform_buffer_offset;
+	gr_screen.gf_set_transform_buffer_instances	= gr_opengl_set_transform_buffer_instances;
+	gr_screen.gf_map_immediate_buffer	= gr_opengl_map_immediate_buffer;
+	gr_screen.gf_unmap_immediate_buffer	= gr_opengl_unmap_immediate_buffer;
 
 	gr_screen.gf_start_instance_matrix			= gr_opengl_start_instance_matrix;
 	gr_screen.gf_end_instance_matrix			= gr_opengl_end_instance_matrix;
@@ -1228,6 +1249,8 @@ void opengl_setup_function_pointers()
 	gr_screen.gf_scene_texture_begin = gr_opengl_scene_texture_begin;
 	gr_screen.gf_scene_texture_end = gr_opengl_scene_texture_end;
 	gr_screen.gf_copy_effect_texture = gr_opengl_copy_effect_texture;
+	gr_screen.gf_scene_resolution_begin = gr_opengl_scene_resolution_begin;
+	gr_screen.gf_scene_resolution_end = gr_opengl_scene_resolution_end;
 
 	gr_screen.gf_deferred_lighting_begin = gr_opengl_deferred_lighting_begin;
 	gr_screen.gf_deferred_lighting_end = gr_opengl_deferred_lighting_end;
@@ -1252,10 +1275,14 @@ void opengl_setup_function_pointers()
 	gr_screen.gf_sphere				= gr_opengl_sphere;
 	
 	gr_screen.gf_maybe_create_shader = gr_opengl_maybe_create_shader;
+	gr_screen.gf_shader_precompile_begin = opengl_shader_precompile_begin;
+	gr_screen.gf_shader_precompile_end = opengl_shader_precompile_end;
 	gr_screen.gf_shadow_map_start	= gr_opengl_shadow_map_start;
 	gr_screen.gf_shadow_map_end		= gr_opengl_shadow_map_end;
 
 	gr_screen.gf_render_shield_impact = gr_opengl_render_shield_impact;
+	gr_screen.gf_render_decals = gr_opengl_render_decals;
+	gr_screen.gf_render_background_cubemap = gr_opengl_render_background_cubemap;
 
 	gr_screen.gf_update_texture = gr_opengl_update_texture;
 	gr_screen.gf_get_bitmap_from_texture = gr_opengl_get_bitmap_from_texture;
@@ -1279,6 +1306,8 @@ void opengl_setup_function_pointers()
 	gr_screen.gf_query_value = gr_opengl_query_value;
 	gr_screen.gf_query_value_available = gr_opengl_query_value_available;
 	gr_screen.gf_get_query_value = gr_opengl_get_query_value;
+	gr_screen.gf_begin_query = gr_opengl_begin_query;
+	gr_screen.gf_end_query = gr_opengl_end_query;
 	gr_screen.gf_delete_query_object = gr_opengl_delete_query_object;
 
 	gr_screen.gf_create_viewport = gr_opengl_create_viewport;
@@ -1415,6 +1444,48 @@ static bool printNextDebugMessage() {
 }
 #endif
 
+static bool opengl_extension_supported(const char* name) {
+	GLint num_extensions = 0;
+	glGetIntegerv(GL_NUM_EXTENSIONS, &num_extensions);
+
+	for (GLint i = 0; i < num_extensions; ++i) {
+		auto extension = reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, (GLuint)i));
+
+		if (extension != nullptr && !strcmp(extension, name)) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+static void init_parallel_shader_compile() {
+	// glad doesn't know these extensions so the function is loaded here
+	typedef void (APIENTRYP max_shader_compiler_threads_proc)(GLuint count);
+
+	const char* max_threads_name = nullptr;
+
+	if (opengl_extension_supported("GL_KHR_parallel_shader_compile")) {
+		max_threads_name = "glMaxShaderCompilerThreadsKHR";
+	} else if (opengl_extension_supported("GL_ARB_parallel_shader_compile")) {
+		max_threads_name = "glMaxShaderCompilerThreadsARB";
+	}
+
+	if (max_threads_name == nullptr || Cmdline_no_parallel_shaders) {
+		return;
+	}
+
+	auto max_threads = reinterpret_cast<max_shader_compiler_threads_proc>(GL_context->getLoaderFunction()(max_threads_name));
+	if (max_threads != nullptr) {
+		// let the driver decide how many threads it uses
+		max_threads(0xFFFFFFFFu);
+	}
+
+	GL_parallel_shader_compile = true;
+
+	mprintf(("  Using parallel shader compilation\n"));
+}
+
 static void init_extensions() {
 	// if S3TC compression is found, then "GL_ARB_texture_compression" must be an extension
 	Use_compressed_textures = GLAD_GL_EXT_texture_compression_s3tc;
@@ -1454,6 +1525,8 @@ static void init_extensions() {
 	} else if (max_texture_units < 4) {
 		Error(LOCATION, "Not enough texture units found for proper rendering support! We need at least 4, we found %d.", max_texture_units);
 	}
+
+	init_parallel_shader_compile();
 }
 
 bool gr_opengl_init(std::unique_ptr<os::GraphicsOperations>&& graphicsOps)
@@ -1546,7 +1619,7 @@ bool gr_opengl_init(std::unique_ptr<os::GraphicsOperations>&& graphicsOps)
 
 	// create vertex array object to make OpenGL Core happy
 	glGenVertexArrays(1, &GL_vao);
-	glBindVertexArray(GL_vao);
+	GL_state.BindVertexArray(GL_vao);
 
 	GL_state.Texture.init(max_texture_units);
 	GL_state.Array.init(max_texture_coords);
@@ -1567,6 +1640,7 @@ bool gr_opengl_init(std::unique_ptr<os::GraphicsOperations>&& graphicsOps)
 	// post processing effects, after shaders are initialized
 	opengl_setup_scene_textures();
 	opengl_post_process_init();
+	opengl_scene_resolution_init();
 
 	// must be called after extensions are setup
 	opengl_set_vsync( !Cmdline_no_vsync );
@@ -1654,6 +1728,10 @@ bool gr_opengl_is_capable(gr_capability capability)
 		return !Cmdline_no_geo_sdr_effects;
 	case CAPABILITY_TIMESTAMP_QUERY:
 		return GL_version >= 33; // Timestamp queries are available from 3.3 onwards
+	case CAPABILITY_TEXTURE_ARRAYS:
+		return !Cmdline_no_texture_arrays;
+	case CAPABILITY_PACKED_VERTICES:
+		return Cmdline_packed_vertices && GL_version >= 33; // GL_INT_2_10_10_10_REV is core from 3.3 onwards
 	}
 
 	return false;
@@ -1687,6 +1765,7 @@ uint opengl_data_type_size(GLenum data_type)
 	case GL_SHORT:
 		return sizeof(GLshort);
 	case GL_UNSIGNED_SHORT:
+	case GL_HALF_FLOAT:
 		return sizeof(GLushort);
 	case GL_INT:
 		return sizeof(GLint);
@@ -53,6 +53,9 @@ extern int GLSL_version;
 
 extern int Use_PBOs;
 
+// whether the driver compiles shaders in the background (GL_KHR_parallel_shader_compile or its ARB version)
+extern bool GL_parallel_shader_compile;
+
 extern GLuint GL_vao;
 
 extern float GL_alpha_threshold;
@@ -79,6 +79,8 @@ void gr_opengl_bm_create(int n)
 void gr_opengl_bm_init(int n)
 {
 	Assert( (n >= 0) && (n < MAX_BITMAPS) );
+
+	opengl_tcache_add_slot(n);
 }
 
 /**
@@ -163,3 +165,10 @@ bool gr_opengl_bm_data(int n, bitmap* bm)
 	// Do nothing here
 	return true;
 }
+
+bool gr_opengl_bm_is_uploaded(int n)
+{
+	Assert( (n >= 0) && (n < MAX_BITMAPS) );
+
+	return opengl_texture_slot_valid(n, bm_bitmaps[n].handle);
+}
@@ -31,6 +31,9 @@ void gr_opengl_bm_page_in_start();
 
 bool gr_opengl_bm_data(int n, bitmap* bm);
 
+// checks if the texture of a bitmap is already in API memory
+bool gr_opengl_bm_is_uploaded(int n);
+
 void gr_opengl_bm_save_render_target(int slot);
 int gr_opengl_bm_make_render_target(int n, int *width, int *height, int *bpp, int *mm_lvl, int flags);
 int gr_opengl_bm_set_render_target(int n, int face);
@@ -8,8 +8,10 @@
 */
 
 #include <algorithm>
+#include "bmpman/atlas.h"
 #include "bmpman/bmpman.h"
 #include "cmdline/cmdline.h"
+#include "debugconsole/console.h"
 #include "freespace.h"
 #include "globalincs/pstypes.h"
 #include "globalincs/systemvars.h"
@@ -17,6 +19,7 @@
 #include "gropengl.h"
 #include "gropenglbmpman.h"
 #include "gropengldraw.h"
+#include "gropengldynres.h"
 #include "gropengllight.h"
 #include "gropenglpostprocessing.h"
 #include "gropenglshader.h"
@@ -31,6 +34,7 @@
 #include "lighting/lighting.h"
 #include "math/floating.h"
 #include "nebula/neb.h"
+#include "tracing/Monitor.h"
 #include "tracing/tracing.h"
 #include "osapi/osapi.h"
 #include "render/3d.h"
@@ -73,6 +77,8 @@ namespace
 
     graphics::paths::PathRenderer* beginDrawing(int resize_mode)
     {
+        opengl_flush_bitmap_batch();
+
         auto path = graphics::paths::PathRenderer::instance();
 
         path->saveState();
@@ -111,6 +117,9 @@ GLuint Distortion_framebuffer = 0;
 GLuint Distortion_texture[2];
 int Distortion_switch = 0;
 
+// set when a distortion sampled the distortion texture since its last update
+bool Distortion_used = false;
+
 int Scene_texture_initialized;
 bool Scene_framebuffer_in_frame;
 
@@ -146,7 +155,11 @@ static opengl_vertex_bind GL_array_binding_data[] =
 	{ vertex_format_data::TANGENT,		4, GL_FLOAT,			GL_FALSE, opengl_vert_attrib::TANGENT	},
 	{ vertex_format_data::MODEL_ID,		1, GL_FLOAT,			GL_FALSE, opengl_vert_attrib::MODEL_ID	},
 	{ vertex_format_data::RADIUS,		1, GL_FLOAT,			GL_FALSE, opengl_vert_attrib::RADIUS	},
-	{ vertex_format_data::UVEC,			3, GL_FLOAT,			GL_FALSE, opengl_vert_attrib::UVEC		}
+	{ vertex_format_data::UVEC,			3, GL_FLOAT,			GL_FALSE, opengl_vert_attrib::UVEC		},
+	{ vertex_format_data::TEX_COORD_HALF,	2, GL_HALF_FLOAT,		GL_FALSE, opengl_vert_attrib::TEXCOORD	},
+	{ vertex_format_data::NORMAL_PACKED,	4, GL_INT_2_10_10_10_REV,	GL_TRUE, opengl_vert_attrib::NORMAL	},
+	{ vertex_format_data::TANGENT_PACKED,	4, GL_INT_2_10_10_10_REV,	GL_TRUE, opengl_vert_attrib::TANGENT	},
+	{ vertex_format_data::MODEL_ID_SHORT,	1, GL_UNSIGNED_SHORT,	GL_FALSE, opengl_vert_attrib::MODEL_ID	}
 };
 
 inline GLenum opengl_primitive_type(primitive_type prim_type)
@@ -226,6 +239,64 @@ void gr_opengl_pixel(int x, int y, int resize_mode)
 	gr_line(x, y, x, y, resize_mode);
 }
 
+// the glyphs of consecutive VFNT strings are collected here and drawn in one call, see gr_opengl_string_batch_begin()
+struct string_vert {
+	GLfloat x, y, u, v;
+	ubyte r, g, b, a;
+};
+
+static SCP_vector<string_vert> GL_string_batch;
+static int GL_string_batch_bitmap = -1;
+static int GL_string_batch_depth = 0;
+
+// the same for the anti-aliased bitmaps of an atlas page while strings are batched. unlike the strings they have to be
+// drawn before anything else is, so they stay in their place between the other things the HUD gauges draw
+static SCP_vector<string_vert> GL_bitmap_batch;
+static int GL_bitmap_batch_bitmap = -1;
+
+void opengl_flush_bitmap_batch()
+{
+	if (GL_bitmap_batch.empty()) {
+		return;
+	}
+
+	GR_DEBUG_SCOPE("Render aabitmap batch");
+
+	GL_CHECK_FOR_ERRORS("start of flush_bitmap_batch()");
+
+	GL_state.SetAlphaBlendMode(ALPHA_BLEND_ALPHA_BLEND_ALPHA);
+	GL_state.SetZbufferType(ZBUFFER_TYPE_NONE);
+
+	GLboolean cull_face = GL_state.CullFace(GL_FALSE);
+	// the bitmaps were clipped when they were added, the clip rectangle may have changed since then
+	GLboolean scissor_test = GL_state.ScissorTest(GL_FALSE);
+
+	float u_scale, v_scale;
+
+	// the current bitmap is left alone, this may be called right before something else is drawn with it
+	if (gr_opengl_tcache_set(GL_bitmap_batch_bitmap, TCACHE_TYPE_AABITMAP, &u_scale, &v_scale)) {
+		vertex_layout vert_def;
+
+		vert_def.add_vertex_component(vertex_format_data::POSITION2, sizeof(string_vert), (int)offsetof(string_vert, x));
+		vert_def.add_vertex_component(vertex_format_data::TEX_COORD, sizeof(string_vert), (int)offsetof(string_vert, u));
+		vert_def.add_vertex_component(vertex_format_data::COLOR4, sizeof(string_vert), (int)offsetof(string_vert, r));
+
+		vec4 white = {{{ 1.0f, 1.0f, 1.0f, 1.0f }}};
+		opengl_shader_set_passthrough(true, true, &white, 1.0f);
+
+		opengl_render_primitives_immediate(PRIM_TYPE_TRIS, &vert_def, (int)GL_bitmap_batch.size(), GL_bitmap_batch.data(),
+			(int)(sizeof(string_vert) * GL_bitmap_batch.size()));
+	}
+
+	GL_bitmap_batch.clear();
+
+	GL_state.CullFace(cull_face);
+	GL_state.ScissorTest(scissor_test);
+
+	GL_CHECK_FOR_ERRORS("end of flush_bitmap_batch()");
+	gr_clear_states();
+}
+
 void opengl_aabitmap_ex_internal(int x, int y, int w, int h, int sx, int sy, int resize_mode, bool mirror)
 {
 	if ( (w < 1) || (h < 1) ) {
@@ -237,13 +308,26 @@ void opengl_aabitmap_ex_internal(int x, int y, int w, int h, int sx, int sy, int
 	}
 
 	float u_scale, v_scale;
+	float u_offset = 0.0f, v_offset = 0.0f;
+	int texture = gr_screen.current_bitmap;
+	int atlas_x, atlas_y;
 
 	GL_CHECK_FOR_ERRORS("start of aabitmap_ex_internal()");
 
-	GL_state.SetAlphaBlendMode(ALPHA_BLEND_ALPHA_BLEND_ALPHA);
-	GL_state.SetZbufferType(ZBUFFER_TYPE_NONE);
+	bool in_atlas = bm_get_atlas(gr_screen.current_bitmap, &texture, &atlas_x, &atlas_y);
+	bool batched = in_atlas && (GL_string_batch_depth > 0);
 
-	if ( !gr_opengl_tcache_set(gr_screen.current_bitmap, TCACHE_TYPE_AABITMAP, &u_scale, &v_scale) ) {
+	if ( !batched || (GL_bitmap_batch_bitmap != texture) ) {
+		opengl_flush_bitmap_batch();
+		GL_bitmap_batch_bitmap = texture;
+	}
+
+	if ( !batched ) {
+		GL_state.SetAlphaBlendMode(ALPHA_BLEND_ALPHA_BLEND_ALPHA);
+		GL_state.SetZbufferType(ZBUFFER_TYPE_NONE);
+	}
+
+	if ( !gr_opengl_tcache_set(texture, TCACHE_TYPE_AABITMAP, &u_scale, &v_scale) ) {
 		mprintf(("WARNING: Error setting aabitmap texture (%i)!\n", gr_screen.current_bitmap));
 		return;
 	}
@@ -260,11 +344,23 @@ void opengl_aabitmap_ex_internal(int x, int y, int w, int h, int sx, int sy, int
 
 	bm_get_info(gr_screen.current_bitmap, &bw, &bh);
 
-	u0 = u_scale * (i2fl(sx) / i2fl(bw));
-	v0 = v_scale * (i2fl(sy) / i2fl(bh));
+	// map the texture coordinates of the bitmap to its part of the page
+	if ( in_atlas ) {
+		int pw, ph;
+		bm_get_info(texture, &pw, &ph);
 
-	u1 = u_scale * (i2fl(sx+w) / i2fl(bw));
-	v1 = v_scale * (i2fl(sy+h) / i2fl(bh));
+		u_offset = u_scale * (i2fl(atlas_x) / i2fl(pw));
+		v_offset = v_scale * (i2fl(atlas_y) / i2fl(ph));
+
+		u_scale *= i2fl(bw) / i2fl(pw);
+		v_scale *= i2fl(bh) / i2fl(ph);
+	}
+
+	u0 = u_offset + u_scale * (i2fl(sx) / i2fl(bw));
+	v0 = v_offset + v_scale * (i2fl(sy) / i2fl(bh));
+
+	u1 = u_offset + u_scale * (i2fl(sx+w) / i2fl(bw));
+	v1 = v_offset + v_scale * (i2fl(sy+h) / i2fl(bh));
 
 	x1 = i2fl(x + ((do_resize) ? gr_screen.offset_x_unscaled : gr_screen.offset_x));
 	y1 = i2fl(y + ((do_resize) ? gr_screen.offset_y_unscaled : gr_screen.offset_y));
@@ -282,6 +378,32 @@ void opengl_aabitmap_ex_internal(int x, int y, int w, int h, int sx, int sy, int
 		u1 = temp;
 	}
 
+	if ( batched ) {
+		string_vert vert;
+		vert.r = gr_screen.current_color.red;
+		vert.g = gr_screen.current_color.green;
+		vert.b = gr_screen.current_color.blue;
+		vert.a = gr_screen.current_color.alpha;
+
+		auto add_vert = [&vert](float vx, float vy, float vu, float vv) {
+			vert.x = (GLfloat)vx;
+			vert.y = (GLfloat)vy;
+			vert.u = vu;
+			vert.v = vv;
+			GL_bitmap_batch.push_back(vert);
+		};
+
+		add_vert(x1, y1, u0, v0);
+		add_vert(x1, y2, u0, v1);
+		add_vert(x2, y1, u1, v0);
+
+		add_vert(x1, y2, u0, v1);
+		add_vert(x2, y1, u1, v0);
+		add_vert(x2, y2, u1, v1);
+
+		return;
+	}
+
 	GLboolean cull_face = GL_state.CullFace(GL_FALSE);
 
 	opengl_shader_set_passthrough(true, true, &gr_screen.current_color);
@@ -473,15 +595,75 @@ void gr_opengl_aabitmap(int x, int y, int resize_mode, bool mirror)
 	opengl_aabitmap_ex_internal(dx1, dy1, (dx2 - dx1 + 1), (dy2 - dy1 + 1), sx, sy, resize_mode, mirror);
 }
 
-#define MAX_VERTS_PER_DRAW 300
-struct v4 { GLfloat x,y,u,v; };
-static v4 GL_string_render_buff[MAX_VERTS_PER_DRAW];
-
 namespace font
 {
 	extern int get_char_width_old(font* fnt, ubyte c1, ubyte c2, int *width, int* spacing);
 }
 
+void opengl_flush_string_batch()
+{
+	// the strings go on top of the bitmaps
+	opengl_flush_bitmap_batch();
+
+	if (GL_string_batch.empty()) {
+		return;
+	}
+
+	GR_DEBUG_SCOPE("Render VFNT string batch");
+
+	GL_CHECK_FOR_ERRORS("start of flush_string_batch()");
+
+	gr_set_bitmap(GL_string_batch_bitmap);
+
+	GL_state.SetAlphaBlendMode(ALPHA_BLEND_ALPHA_BLEND_ALPHA);
+	GL_state.SetZbufferType(ZBUFFER_TYPE_NONE);
+
+	GLboolean cull_face = GL_state.CullFace(GL_FALSE);
+	GLboolean depth = GL_state.DepthTest(GL_FALSE);
+	// the glyphs were clipped when they were added, the clip rectangle may have changed since then
+	GLboolean scissor_test = GL_state.ScissorTest(GL_FALSE);
+
+	float u_scale, v_scale;
+
+	if (gr_opengl_tcache_set(gr_screen.current_bitmap, TCACHE_TYPE_AABITMAP, &u_scale, &v_scale)) {
+		vertex_layout vert_def;
+
+		vert_def.add_vertex_component(vertex_format_data::POSITION2, sizeof(string_vert), (int)offsetof(string_vert, x));
+		vert_def.add_vertex_component(vertex_format_data::TEX_COORD, sizeof(string_vert), (int)offsetof(string_vert, u));
+		vert_def.add_vertex_component(vertex_format_data::COLOR4, sizeof(string_vert), (int)offsetof(string_vert, r));
+
+		// the color of every string is in its vertices
+		vec4 white = {{{ 1.0f, 1.0f, 1.0f, 1.0f }}};
+		opengl_shader_set_passthrough(true, true, &white, 1.0f);
+
+		opengl_render_primitives_immediate(PRIM_TYPE_TRIS, &vert_def, (int)GL_string_batch.size(), GL_string_batch.data(),
+			(int)(sizeof(string_vert) * GL_string_batch.size()));
+	}
+
+	GL_string_batch.clear();
+
+	GL_state.CullFace(cull_face);
+	GL_state.DepthTest(depth);
+	GL_state.ScissorTest(scissor_test);
+
+	GL_CHECK_FOR_ERRORS("end of flush_string_batch()");
+	gr_clear_states();
+}
+
+void gr_opengl_string_batch_begin()
+{
+	++GL_string_batch_depth;
+}
+
+void gr_opengl_string_batch_end()
+{
+	Assertion(GL_string_batch_depth > 0, "gr_string_batch_end() called without gr_string_batch_begin()!");
+
+	if (--GL_string_batch_depth == 0) {
+		opengl_flush_string_batch();
+	}
+}
+
 void gr_opengl_string_old(float sx, float sy, const char* s, const char* end, font::font* fontData, float top, float height, int resize_mode)
 {
 	GR_DEBUG_SCOPE("Render VFNT string");
@@ -494,22 +676,19 @@ void gr_opengl_string_old(float sx, float sy, const char* s, const char* end, fo
 	float x1, x2, y1, y2;
 	float u_scale = 1.0f, v_scale = 1.0f;
 
-	GL_CHECK_FOR_ERRORS("start of string()");
+	if (GL_string_batch_bitmap != fontData->bitmap_id) {
+		opengl_flush_string_batch();
+		GL_string_batch_bitmap = fontData->bitmap_id;
+	}
 
- 	gr_set_bitmap(fontData->bitmap_id);
- 
- 	GL_state.SetAlphaBlendMode(ALPHA_BLEND_ALPHA_BLEND_ALPHA);
- 	GL_state.SetZbufferType(ZBUFFER_TYPE_NONE);
- 
- 	if (!gr_opengl_tcache_set(gr_screen.current_bitmap, TCACHE_TYPE_AABITMAP, &u_scale, &v_scale)) {
- 		return;
- 	}
-	
-	int buffer_offset = 0;
+	// only needed for the texture scale here, the texture is bound again when the batch is drawn
+	if (!gr_opengl_tcache_set(fontData->bitmap_id, TCACHE_TYPE_AABITMAP, &u_scale, &v_scale)) {
+		return;
+	}
 
 	int ibw, ibh;
 
-	bm_get_info(gr_screen.current_bitmap, &ibw, &ibh);
+	bm_get_info(fontData->bitmap_id, &ibw, &ibh);
 
 	bw = i2fl(ibw);
 	bh = i2fl(ibh);
@@ -532,12 +711,19 @@ void gr_opengl_string_old(float sx, float sy, const char* s, const char* end, fo
 	
 	spacing = 0;
 
-	vertex_layout vert_def;
-
-	vert_def.add_vertex_component(vertex_format_data::POSITION2, sizeof(v4), (int)offsetof(v4, x));
-	vert_def.add_vertex_component(vertex_format_data::TEX_COORD, sizeof(v4), (int)offsetof(v4, u));
+	string_vert vert;
+	vert.r = gr_screen.current_color.red;
+	vert.g = gr_screen.current_color.green;
+	vert.b = gr_screen.current_color.blue;
+	vert.a = gr_screen.current_color.is_alphacolor ? gr_screen.current_color.alpha : 255;
 
-	opengl_shader_set_passthrough(true, true, &gr_screen.current_color);
+	auto add_vert = [&vert](float vx, float vy, float vu, float vv) {
+		vert.x = (GLfloat)vx;
+		vert.y = (GLfloat)vy;
+		vert.u = vu;
+		vert.v = vv;
+		GL_string_batch.push_back(vert);
+	};
 
 	// pick out letter coords, draw it, goto next letter and do the same
 	while (s < end) {
@@ -628,54 +814,18 @@ void gr_opengl_string_old(float sx, float sy, const char* s, const char* end, fo
 		u1 = u_scale * (i2fl((u+xd)+wc) / bw);
 		v1 = v_scale * (i2fl((v+yd)+hc) / bh);
 
-		if ( buffer_offset == MAX_VERTS_PER_DRAW ) {
-			opengl_render_primitives_immediate(PRIM_TYPE_TRIS, &vert_def, buffer_offset, GL_string_render_buff, sizeof(v4) * buffer_offset);
-			buffer_offset = 0;
-		}
-
-		GL_string_render_buff[buffer_offset].x = (GLfloat)x1;
-		GL_string_render_buff[buffer_offset].y = (GLfloat)y1;
-		GL_string_render_buff[buffer_offset].u = u0;
-		GL_string_render_buff[buffer_offset].v = v0;
-		buffer_offset++;
-
-		GL_string_render_buff[buffer_offset].x = (GLfloat)x1;
-		GL_string_render_buff[buffer_offset].y = (GLfloat)y2;
-		GL_string_render_buff[buffer_offset].u = u0;
-		GL_string_render_buff[buffer_offset].v = v1;
-		buffer_offset++;
-
-		GL_string_render_buff[buffer_offset].x = (GLfloat)x2;
-		GL_string_render_buff[buffer_offset].y = (GLfloat)y1;
-		GL_string_render_buff[buffer_offset].u = u1;
-		GL_string_render_buff[buffer_offset].v = v0;
-		buffer_offset++;
-
-		GL_string_render_buff[buffer_offset].x = (GLfloat)x1;
-		GL_string_render_buff[buffer_offset].y = (GLfloat)y2;
-		GL_string_render_buff[buffer_offset].u = u0;
-		GL_string_render_buff[buffer_offset].v = v1;
-		buffer_offset++;
-
-		GL_string_render_buff[buffer_offset].x = (GLfloat)x2;
-		GL_string_render_buff[buffer_offset].y = (GLfloat)y1;
-		GL_string_render_buff[buffer_offset].u = u1;
-		GL_string_render_buff[buffer_offset].v = v0;
-		buffer_offset++;
+		add_vert(x1, y1, u0, v0);
+		add_vert(x1, y2, u0, v1);
+		add_vert(x2, y1, u1, v0);
 
-		GL_string_render_buff[buffer_offset].x = (GLfloat)x2;
-		GL_string_render_buff[buffer_offset].y = (GLfloat)y2;
-		GL_string_render_buff[buffer_offset].u = u1;
-		GL_string_render_buff[buffer_offset].v = v1;
-		buffer_offset++;
+		add_vert(x1, y2, u0, v1);
+		add_vert(x2, y1, u1, v0);
+		add_vert(x2, y2, u1, v1);
 	}
 
-	if (buffer_offset) {
-		opengl_render_primitives_immediate(PRIM_TYPE_TRIS, &vert_def, buffer_offset, GL_string_render_buff, sizeof(v4) * buffer_offset);
+	if (GL_string_batch_depth == 0) {
+		opengl_flush_string_batch();
 	}
-
-	GL_CHECK_FOR_ERRORS("end of string()");
-	gr_clear_states();
 }
 
 void gr_opengl_string(float sx, float sy, const char *s, int resize_mode, int in_length) {
@@ -1049,6 +1199,8 @@ void gr_opengl_flash(int r, int g, int b)
 	CLAMP(g, 0, 255);
 	CLAMP(b, 0, 255);
 
+	opengl_flush_bitmap_batch();
+
 	GL_state.SetAlphaBlendMode(ALPHA_BLEND_ALPHA_ADDITIVE);
 	GL_state.SetZbufferType(ZBUFFER_TYPE_NONE);
 
@@ -1075,6 +1227,8 @@ void gr_opengl_flash_alpha(int r, int g, int b, int a)
 	CLAMP(b, 0, 255);
 	CLAMP(a, 0, 255);
 
+	opengl_flush_bitmap_batch();
+
 	GL_state.SetAlphaBlendMode(ALPHA_BLEND_ALPHA_BLEND_ALPHA);
 	GL_state.SetZbufferType(ZBUFFER_TYPE_NONE);
 
@@ -1101,6 +1255,8 @@ void opengl_bitmap_ex_internal(int x, int y, int w, int h, int sx, int sy, int r
 	float x1, x2, y1, y2;
 	int bw, bh, do_resize;
 
+	opengl_flush_bitmap_batch();
+
 	GL_state.SetAlphaBlendMode(ALPHA_BLEND_ALPHA_BLEND_ALPHA);
 	GL_state.SetZbufferType(ZBUFFER_TYPE_NONE);
 
@@ -1353,7 +1509,7 @@ void gr_opengl_deferred_light_sphere_init(int rings, int segments) // Generate a
 
 	// make sure we have one
 	if (deferred_light_sphere_vbo) {
-		glBindBuffer(GL_ARRAY_BUFFER, deferred_light_sphere_vbo);
+		GL_state.Array.BindArrayBuffer(deferred_light_sphere_vbo);
 		glBufferData(GL_ARRAY_BUFFER, nVertex * sizeof(float), Vertices, GL_STATIC_DRAW);
 
 		// just in case
@@ -1363,7 +1519,7 @@ void gr_opengl_deferred_light_sphere_init(int rings, int segments) // Generate a
 			return;
 		}
 
-		glBindBuffer(GL_ARRAY_BUFFER, 0);
+		GL_state.Array.BindArrayBuffer(0);
 
 		vm_free(Vertices);
 		Vertices = NULL;
@@ -1373,7 +1529,7 @@ void gr_opengl_deferred_light_sphere_init(int rings, int segments) // Generate a
 
 	// make sure we have one
 	if (deferred_light_sphere_ibo) {
-		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, deferred_light_sphere_ibo);
+		GL_state.Array.BindElementBuffer(deferred_light_sphere_ibo);
 		glBufferData(GL_ELEMENT_ARRAY_BUFFER, nIndex * sizeof(ushort), Indices, GL_STATIC_DRAW);
 
 		// just in case
@@ -1383,7 +1539,7 @@ void gr_opengl_deferred_light_sphere_init(int rings, int segments) // Generate a
 			return;
 		}
 
-		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+		GL_state.Array.BindElementBuffer(0);
 
 		vm_free(Indices);
 		Indices = NULL;
@@ -1403,15 +1559,16 @@ void opengl_draw_sphere()
 	opengl_bind_vertex_layout(vertex_declare);
 
 	glDrawRangeElements(GL_TRIANGLES, 0, deferred_light_sphere_vcount, deferred_light_sphere_icount, GL_UNSIGNED_SHORT, 0);
+	++GL_frame_stats.draw_calls;
 }
 
 void gr_opengl_draw_deferred_light_sphere(vec3d *position, float rad, bool clearStencil = true)
 {
 	g3_start_instance_matrix(position, &vmd_identity_matrix, true);
 	
-	Current_shader->program->Uniforms.setUniform3f("scale", rad, rad, rad);
-	Current_shader->program->Uniforms.setUniformMatrix4f("modelViewMatrix", GL_model_view_matrix);
-	Current_shader->program->Uniforms.setUniformMatrix4f("projMatrix", GL_projection_matrix);
+	Current_shader->program->Uniforms.setUniform3f(SDR_UNIFORM("scale"), rad, rad, rad);
+	Current_shader->program->Uniforms.setUniformMatrix4f(SDR_UNIFORM("modelViewMatrix"), GL_model_view_matrix);
+	Current_shader->program->Uniforms.setUniformMatrix4f(SDR_UNIFORM("projMatrix"), GL_projection_matrix);
 
 	opengl_draw_sphere();
 
@@ -1488,7 +1645,7 @@ void gr_opengl_deferred_light_cylinder_init(int segments) // Generate a VBO of a
 
 	// make sure we have one
 	if (deferred_light_cylinder_vbo) {
-		glBindBuffer(GL_ARRAY_BUFFER, deferred_light_cylinder_vbo);
+		GL_state.Array.BindArrayBuffer(deferred_light_cylinder_vbo);
 		glBufferData(GL_ARRAY_BUFFER, nVertex * sizeof(float), Vertices, GL_STATIC_DRAW);
 
 		// just in case
@@ -1498,7 +1655,7 @@ void gr_opengl_deferred_light_cylinder_init(int segments) // Generate a VBO of a
 			return;
 		}
 
-		glBindBuffer(GL_ARRAY_BUFFER, 0);
+		GL_state.Array.BindArrayBuffer(0);
 
 		vm_free(Vertices);
 		Vertices = NULL;
@@ -1508,7 +1665,7 @@ void gr_opengl_deferred_light_cylinder_init(int segments) // Generate a VBO of a
 
 	// make sure we have one
 	if (deferred_light_cylinder_ibo) {
-		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, deferred_light_cylinder_ibo);
+		GL_state.Array.BindElementBuffer(deferred_light_cylinder_ibo);
 		glBufferData(GL_ELEMENT_ARRAY_BUFFER, nIndex * sizeof(ushort), Indices, GL_STATIC_DRAW);
 
 		// just in case
@@ -1518,7 +1675,7 @@ void gr_opengl_deferred_light_cylinder_init(int segments) // Generate a VBO of a
 			return;
 		}
 
-		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+		GL_state.Array.BindElementBuffer(0);
 
 		vm_free(Indices);
 		Indices = NULL;
@@ -1530,9 +1687,9 @@ void gr_opengl_draw_deferred_light_cylinder(vec3d *position,matrix *orient, floa
 {
 	g3_start_instance_matrix(position, orient, true);
 
-	Current_shader->program->Uniforms.setUniform3f("scale", rad, rad, length);
-	Current_shader->program->Uniforms.setUniformMatrix4f("modelViewMatrix", GL_model_view_matrix);
-	Current_shader->program->Uniforms.setUniformMatrix4f("projMatrix", GL_projection_matrix);
+	Current_shader->program->Uniforms.setUniform3f(SDR_UNIFORM("scale"), rad, rad, length);
+	Current_shader->program->Uniforms.setUniformMatrix4f(SDR_UNIFORM("modelViewMatrix"), GL_model_view_matrix);
+	Current_shader->program->Uniforms.setUniformMatrix4f(SDR_UNIFORM("projMatrix"), GL_projection_matrix);
 
 	GL_state.Array.BindArrayBuffer(deferred_light_cylinder_vbo);
 	GL_state.Array.BindElementBuffer(deferred_light_cylinder_ibo);
@@ -1544,6 +1701,7 @@ void gr_opengl_draw_deferred_light_cylinder(vec3d *position,matrix *orient, floa
 	opengl_bind_vertex_layout(vertex_declare);
 
 	glDrawRangeElements(GL_TRIANGLES, 0, deferred_light_cylinder_vcount, deferred_light_cylinder_icount, GL_UNSIGNED_SHORT, 0);
+	++GL_frame_stats.draw_calls;
 
 	g3_done_instance(true);
 }
@@ -1921,7 +2079,7 @@ void gr_opengl_scene_texture_begin()
 	GL_state.BindFrameBuffer(Scene_framebuffer);
 	//glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, Scene_depth_texture, 0);
 
-	if (GL_rendering_to_texture)
+	if (GL_rendering_to_texture || gr_screen.max_w < Scene_texture_width || gr_screen.max_h < Scene_texture_height)
 	{
 		Scene_texture_u_scale = i2fl(gr_screen.max_w) / i2fl(Scene_texture_width);
 		Scene_texture_v_scale = i2fl(gr_screen.max_h) / i2fl(Scene_texture_height);
@@ -1969,10 +2127,11 @@ void gr_opengl_scene_texture_end()
 	TRACE_SCOPE(tracing::SceneTextureEnd);
 
 	time_buffer+=flFrametime;
-	if(time_buffer>0.03f)
+	if(time_buffer>0.03f && Distortion_used)
 	{
 		gr_opengl_update_distortion();
 		time_buffer = 0.0f;
+		Distortion_used = false;
 	}
 
 	if ( Cmdline_postprocess && !PostProcessing_override ) {
@@ -1986,6 +2145,9 @@ void gr_opengl_scene_texture_end()
 		GLboolean blend = GL_state.Blend(GL_FALSE);
 		GLboolean cull = GL_state.CullFace(GL_FALSE);
 
+		// the scene texture is stretched over the whole screen
+		opengl_scene_resolution_restore();
+
 		GL_state.PopFramebufferState();
 
 		GL_state.Texture.SetActiveUnit(0);
@@ -2024,27 +2186,49 @@ void gr_opengl_scene_texture_end()
 	High_dynamic_range = false;
 }
 
-void gr_opengl_copy_effect_texture()
+void opengl_get_scene_sample_size(float* width, float* height)
+{
+	if (Scene_framebuffer_in_frame) {
+		*width = i2fl(Scene_texture_width);
+		*height = i2fl(Scene_texture_height);
+	} else {
+		*width = i2fl(gr_screen.max_w);
+		*height = i2fl(gr_screen.max_h);
+	}
+}
+
+/**
+ * Copies a part of the scene into the effect texture, the rectangle is in screen coordinates with y going down
+ */
+void gr_opengl_copy_effect_texture(int x1, int y1, int x2, int y2)
 {
 	if ( !Scene_framebuffer_in_frame ) {
 		return;
 	}
 
+	GR_DEBUG_SCOPE("Copy effect texture");
+	TRACE_SCOPE(tracing::CopyEffectTexture);
+
+	// the framebuffer has its origin at the bottom
+	int bottom = gr_screen.max_h - y2;
+	int top = gr_screen.max_h - y1;
+
 	glDrawBuffer(GL_COLOR_ATTACHMENT4);
-	glBlitFramebuffer(0, 0, gr_screen.max_w, gr_screen.max_h, 0, 0, gr_screen.max_w, gr_screen.max_h, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+	glBlitFramebuffer(x1, bottom, x2, top, x1, bottom, x2, top, GL_COLOR_BUFFER_BIT, GL_NEAREST);
 	glDrawBuffer(GL_COLOR_ATTACHMENT0);
 }
 
 void opengl_clear_deferred_buffers()
 {
 	GR_DEBUG_SCOPE("Clear deferred buffers");
+	TRACE_SCOPE(tracing::DeferredClearBuffers);
 
 	GLboolean depth = GL_state.DepthTest(GL_FALSE);
 	GLboolean depth_mask = GL_state.DepthMask(GL_FALSE);
 	GLboolean blend = GL_state.Blend(GL_FALSE);
 	GLboolean cull = GL_state.CullFace(GL_FALSE);
 
-	glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+	GL_state.ColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
 
 	opengl_shader_set_current( gr_opengl_maybe_create_shader(SDR_TYPE_DEFERRED_CLEAR, 0) );
 
@@ -2052,7 +2236,7 @@ void opengl_clear_deferred_buffers()
 
 	opengl_shader_set_current();
 
-	glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_FALSE);
+	GL_state.ColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_FALSE);
 
 	GL_state.DepthTest(depth);
 	GL_state.DepthMask(depth_mask);
@@ -2060,6 +2244,9 @@ void opengl_clear_deferred_buffers()
 	GL_state.CullFace(cull);
 }
 
+// times the opaque geometry drawn into the G-buffer between gr_opengl_deferred_lighting_begin() and _end()
+static tracing::trace_event Deferred_gbuffer_fill_event;
+
 void gr_opengl_deferred_lighting_begin()
 {
 	if ( Cmdline_no_deferred_lighting)
@@ -2067,8 +2254,12 @@ void gr_opengl_deferred_lighting_begin()
 
 	GR_DEBUG_SCOPE("Deferred lighting begin");
 
+	if ( !Deferred_lighting ) {
+		tracing::complete::start(tracing::DeferredGBufferFill, &Deferred_gbuffer_fill_event);
+	}
+
 	Deferred_lighting = true;
-	glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+	GL_state.ColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
 
 	GLenum buffers[] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1, GL_COLOR_ATTACHMENT2, GL_COLOR_ATTACHMENT3 };
 	glDrawBuffers(4, buffers);
@@ -2084,7 +2275,9 @@ void gr_opengl_deferred_lighting_end()
 	Deferred_lighting = false;
 	glDrawBuffer(GL_COLOR_ATTACHMENT0);
 
-	glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_FALSE);
+	GL_state.ColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_FALSE);
+
+	tracing::complete::end(&Deferred_gbuffer_fill_event);
 }
 
 extern light Lights[MAX_LIGHTS];
@@ -2093,71 +2286,194 @@ extern float static_point_factor;
 extern float static_light_factor;
 extern float static_tube_factor;
 
-void gr_opengl_deferred_lighting_finish()
+// Lights are binned into screen tiles of this size for the tiled lighting pass
+static const int DEFERRED_LIGHT_TILE_SIZE = 32;
+// With only a few lights drawing their volumes is cheaper than a full screen pass
+static const int DEFERRED_LIGHT_TILED_MIN_LIGHTS = 16;
+
+bool Deferred_lighting_tiled = true;
+DCF_BOOL(deferred_lighting_tiled, Deferred_lighting_tiled);
+
+struct tile_range {
+	uint light; // the index of the light or decal
+	int tiles[4]; // first x, first y, last x, last y
+};
+
+static int Deferred_light_data_buffer = -1;
+static int Deferred_light_tile_buffer = -1;
+
+static SCP_vector<vec4> Deferred_light_data;
+static SCP_vector<tile_range> Deferred_light_tile_ranges;
+static SCP_vector<uint> Deferred_light_tiles;
+
+// The pixels the lights of this frame shaded, by light type. There are no pipeline statistics queries so these are
+// estimated from the screen rectangles of the light volumes, or from the tiles of the lights in the tiled pass.
+enum deferred_light_counter {
+	DEFERRED_LIGHT_POINT,
+	DEFERRED_LIGHT_CONE,
+	DEFERRED_LIGHT_TUBE,
+
+	NUM_DEFERRED_LIGHT_COUNTERS
+};
+
+static std::uint64_t Deferred_light_pixels[NUM_DEFERRED_LIGHT_COUNTERS];
+
+MONITOR(DeferredPointLightKPixels)
+MONITOR(DeferredConeLightKPixels)
+MONITOR(DeferredTubeLightKPixels)
+// how often every pixel of the screen was shaded by a light on average, in percent
+MONITOR(DeferredLightOverdraw)
+
+static void opengl_deferred_light_publish_pixels()
 {
-	GR_DEBUG_SCOPE("Deferred lighting finish");
-	TRACE_SCOPE(tracing::ApplyLights);
+	MONITOR_SET(DeferredPointLightKPixels, (int)(Deferred_light_pixels[DEFERRED_LIGHT_POINT] / 1000));
+	MONITOR_SET(DeferredConeLightKPixels, (int)(Deferred_light_pixels[DEFERRED_LIGHT_CONE] / 1000));
+	MONITOR_SET(DeferredTubeLightKPixels, (int)(Deferred_light_pixels[DEFERRED_LIGHT_TUBE] / 1000));
 
-	if ( Cmdline_no_deferred_lighting ) {
-		return;
+	std::uint64_t total = 0;
+	for (auto pixels : Deferred_light_pixels) {
+		total += pixels;
 	}
 
-	GL_state.SetAlphaBlendMode( ALPHA_BLEND_ADDITIVE);
-	gr_zbuffer_set(GR_ZBUFF_NONE);
+	auto screen_pixels = (std::uint64_t)MAX(1, gr_screen.max_w * gr_screen.max_h);
+	MONITOR_SET(DeferredLightOverdraw, (int)(total * 100 / screen_pixels));
+}
 
-	//GL_state.DepthFunc(GL_GREATER);
-	//GL_state.DepthMask(GL_FALSE);
+/**
+ * Computes the rectangle on the screen covered by a bounding box in world space
+ *
+ * @return false if the box is completely outside of the screen
+ */
+static bool opengl_deferred_light_get_screen_rect(const vec3d* min, const vec3d* max, float* rect)
+{
+	float x0 = FLT_MAX, y0 = FLT_MAX;
+	float x1 = -FLT_MAX, y1 = -FLT_MAX;
+
+	for (int i = 0; i < 8; ++i) {
+		vec4 corner, view, clip;
+		corner.xyzw.x = (i & 1) ? max->xyz.x : min->xyz.x;
+		corner.xyzw.y = (i & 2) ? max->xyz.y : min->xyz.y;
+		corner.xyzw.z = (i & 4) ? max->xyz.z : min->xyz.z;
+		corner.xyzw.w = 1.0f;
+
+		vm_vec_transform(&view, &corner, &GL_view_matrix);
+		vm_vec_transform(&clip, &view, &GL_projection_matrix);
+
+		if (clip.xyzw.w < Min_draw_distance) {
+			// the box reaches behind the viewer so it may cover the whole screen
+			rect[0] = 0.0f;
+			rect[1] = 0.0f;
+			rect[2] = (float)gr_screen.max_w;
+			rect[3] = (float)gr_screen.max_h;
+			return true;
+		}
 
-	opengl_shader_set_current( gr_opengl_maybe_create_shader(SDR_TYPE_DEFERRED_LIGHTING, 0) );
+		float x = (clip.xyzw.x / clip.xyzw.w * 0.5f + 0.5f) * gr_screen.max_w;
+		float y = (clip.xyzw.y / clip.xyzw.w * 0.5f + 0.5f) * gr_screen.max_h;
 
-	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, Scene_luminance_texture, 0);
-	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, Scene_stencil_buffer);
-	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_STENCIL_ATTACHMENT, GL_RENDERBUFFER, Scene_stencil_buffer);
+		x0 = MIN(x0, x);
+		y0 = MIN(y0, y);
+		x1 = MAX(x1, x);
+		y1 = MAX(y1, y);
+	}
 
-	GL_state.Texture.SetShaderMode(GL_TRUE);
+	if (x1 < 0.0f || y1 < 0.0f || x0 >= gr_screen.max_w || y0 >= gr_screen.max_h) {
+		return false;
+	}
 
-	GL_state.Texture.SetActiveUnit(0);
-	GL_state.Texture.SetTarget(GL_TEXTURE_2D);
-	GL_state.Texture.Enable(Scene_color_texture);
+	rect[0] = x0;
+	rect[1] = y0;
+	rect[2] = x1;
+	rect[3] = y1;
 
-	GL_state.Texture.SetActiveUnit(1);
-	GL_state.Texture.SetTarget(GL_TEXTURE_2D);
-	GL_state.Texture.Enable(Scene_normal_texture);
+	return true;
+}
 
-	GL_state.Texture.SetActiveUnit(2);
-	GL_state.Texture.SetTarget(GL_TEXTURE_2D);
-	GL_state.Texture.Enable(Scene_position_texture);
+static void opengl_deferred_light_volume_box(const vec3d* center, float radius, vec3d* min, vec3d* max)
+{
+	*min = *center;
+	*max = *center;
+	min->xyz.x -= radius;
+	min->xyz.y -= radius;
+	min->xyz.z -= radius;
+	max->xyz.x += radius;
+	max->xyz.y += radius;
+	max->xyz.z += radius;
+}
 
-	GL_state.Texture.SetActiveUnit(3);
-	GL_state.Texture.SetTarget(GL_TEXTURE_2D);
-	GL_state.Texture.Enable(Scene_specular_texture);
+// adds the pixels a light volume covers on the screen to the estimate, the volume is a sphere around center
+static void opengl_deferred_light_add_volume_pixels(deferred_light_counter counter, const vec3d* center, float radius)
+{
+	vec3d min, max;
+	opengl_deferred_light_volume_box(center, radius, &min, &max);
 
-	glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
-	glClear(GL_COLOR_BUFFER_BIT);
+	float rect[4];
+	if ( !opengl_deferred_light_get_screen_rect(&min, &max, rect) ) {
+		return;
+	}
 
-	light lights_copy[MAX_LIGHTS];
-	memcpy(lights_copy, Lights, MAX_LIGHTS * sizeof(light));
+	float width = MIN(rect[2], (float)gr_screen.max_w) - MAX(rect[0], 0.0f);
+	float height = MIN(rect[3], (float)gr_screen.max_h) - MAX(rect[1], 0.0f);
 
-	std::sort(lights_copy, lights_copy+Num_lights, light_compare_by_type);
+	// a sphere covers pi / 4 of its bounding rectangle
+	Deferred_light_pixels[counter] += (std::uint64_t)(MAX(width, 0.0f) * MAX(height, 0.0f) * PI * 0.25f);
+}
+
+static void opengl_deferred_apply_lights_volumes(light* lights, int num_lights)
+{
+	opengl_shader_set_current( gr_opengl_maybe_create_shader(SDR_TYPE_DEFERRED_LIGHTING, 0) );
 
-	for(int i = 0; i < Num_lights; ++i)
+	float sample_w, sample_h;
+	opengl_get_scene_sample_size(&sample_w, &sample_h);
+	Current_shader->program->Uniforms.setUniformf(SDR_UNIFORM("invScreenWidth"), 1.0f / sample_w);
+	Current_shader->program->Uniforms.setUniformf(SDR_UNIFORM("invScreenHeight"), 1.0f / sample_h);
+
+	// the lights are sorted by type so every type gets its own scope
+	tracing::trace_event type_event;
+	int type_event_light_type = -1;
+
+	for(int i = 0; i < num_lights; ++i)
 	{
+		if (lights[i].type != type_event_light_type) {
+			if (type_event_light_type >= 0) {
+				tracing::complete::end(&type_event);
+				type_event_light_type = -1;
+			}
+
+			switch (lights[i].type) {
+				case LT_POINT:
+					tracing::complete::start(tracing::DeferredPointLights, &type_event);
+					type_event_light_type = LT_POINT;
+					break;
+				case LT_CONE:
+					tracing::complete::start(tracing::DeferredConeLights, &type_event);
+					type_event_light_type = LT_CONE;
+					break;
+				case LT_TUBE:
+					tracing::complete::start(tracing::DeferredTubeLights, &type_event);
+					type_event_light_type = LT_TUBE;
+					break;
+				default:
+					break;
+			}
+		}
+
 		GR_DEBUG_SCOPE("Deferred apply single light");
 
-		light *l = &lights_copy[i];
-		Current_shader->program->Uniforms.setUniformi( "lightType", 0 );
+		light *l = &lights[i];
+		Current_shader->program->Uniforms.setUniformi( SDR_UNIFORM("lightType"), 0 );
 		switch(l->type)
 		{
 			case LT_CONE:
-				Current_shader->program->Uniforms.setUniformi( "lightType", 2 );
-				Current_shader->program->Uniforms.setUniformi( "dualCone", l->dual_cone );
-				Current_shader->program->Uniforms.setUniformf( "coneAngle", l->cone_angle );
-				Current_shader->program->Uniforms.setUniformf( "coneInnerAngle", l->cone_inner_angle );
-				Current_shader->program->Uniforms.setUniform3f( "coneDir", l->vec2.xyz.x, l->vec2.xyz.y, l->vec2.xyz.z);
+				Current_shader->program->Uniforms.setUniformi( SDR_UNIFORM("lightType"), 2 );
+				Current_shader->program->Uniforms.setUniformi( SDR_UNIFORM("dualCone"), l->dual_cone );
+				Current_shader->program->Uniforms.setUniformf( SDR_UNIFORM("coneAngle"), l->cone_angle );
+				Current_shader->program->Uniforms.setUniformf( SDR_UNIFORM("coneInnerAngle"), l->cone_inner_angle );
+				Current_shader->program->Uniforms.setUniform3f( SDR_UNIFORM("coneDir"), l->vec2.xyz.x, l->vec2.xyz.y, l->vec2.xyz.z);
 			case LT_POINT:
-				Current_shader->program->Uniforms.setUniform3f( "diffuseLightColor", l->r * l->intensity, l->g * l->intensity, l->b * l->intensity );
-				Current_shader->program->Uniforms.setUniform3f( "specLightColor", l->spec_r * l->intensity * static_point_factor, l->spec_g * l->intensity * static_point_factor, l->spec_b * l->intensity * static_point_factor );
-				Current_shader->program->Uniforms.setUniformf( "lightRadius", MAX(l->rada, l->radb) * 1.25f );
+				Current_shader->program->Uniforms.setUniform3f( SDR_UNIFORM("diffuseLightColor"), l->r * l->intensity, l->g * l->intensity, l->b * l->intensity );
+				Current_shader->program->Uniforms.setUniform3f( SDR_UNIFORM("specLightColor"), l->spec_r * l->intensity * static_point_factor, l->spec_g * l->intensity * static_point_factor, l->spec_b * l->intensity * static_point_factor );
+				Current_shader->program->Uniforms.setUniformf( SDR_UNIFORM("lightRadius"), MAX(l->rada, l->radb) * 1.25f );
 
 				/*float dist;
 				vec3d a;
@@ -2166,12 +2482,13 @@ void gr_opengl_deferred_lighting_finish()
 				dist = vm_vec_mag(&a);*/
 
 				gr_opengl_draw_deferred_light_sphere(&l->vec, MAX(l->rada, l->radb) * 1.28f);
+				opengl_deferred_light_add_volume_pixels(l->type == LT_CONE ? DEFERRED_LIGHT_CONE : DEFERRED_LIGHT_POINT, &l->vec, MAX(l->rada, l->radb) * 1.28f);
 				break;
 			case LT_TUBE:
-				Current_shader->program->Uniforms.setUniform3f( "diffuseLightColor", l->r * l->intensity, l->g * l->intensity, l->b * l->intensity );
-				Current_shader->program->Uniforms.setUniform3f( "specLightColor", l->spec_r * l->intensity * static_tube_factor, l->spec_g * l->intensity * static_tube_factor, l->spec_b * l->intensity * static_tube_factor );
-				Current_shader->program->Uniforms.setUniformf( "lightRadius", l->radb * 1.5f );
-				Current_shader->program->Uniforms.setUniformi( "lightType", 1 );
+				Current_shader->program->Uniforms.setUniform3f( SDR_UNIFORM("diffuseLightColor"), l->r * l->intensity, l->g * l->intensity, l->b * l->intensity );
+				Current_shader->program->Uniforms.setUniform3f( SDR_UNIFORM("specLightColor"), l->spec_r * l->intensity * static_tube_factor, l->spec_g * l->intensity * static_tube_factor, l->spec_b * l->intensity * static_tube_factor );
+				Current_shader->program->Uniforms.setUniformf( SDR_UNIFORM("lightRadius"), l->radb * 1.5f );
+				Current_shader->program->Uniforms.setUniformi( SDR_UNIFORM("lightType"), 1 );
 			
 				vec3d a, b;
 				matrix orient;
@@ -2193,13 +2510,444 @@ void gr_opengl_deferred_lighting_finish()
 				}
 
 				gr_opengl_draw_deferred_light_cylinder(&l->vec2, &orient, l->radb * 1.53f, length);
-				Current_shader->program->Uniforms.setUniformi( "lightType", 0 );
+				Current_shader->program->Uniforms.setUniformi( SDR_UNIFORM("lightType"), 0 );
 				gr_opengl_draw_deferred_light_sphere(&l->vec, l->radb * 1.53f, false);
 				gr_opengl_draw_deferred_light_sphere(&l->vec2, l->radb * 1.53f, false);
+
+				vec3d center;
+				vm_vec_avg(&center, &l->vec, &l->vec2);
+				opengl_deferred_light_add_volume_pixels(DEFERRED_LIGHT_TUBE, &center, length * 0.5f + l->radb * 1.53f);
 				break;
 		}
 	}
 
+	if (type_event_light_type >= 0) {
+		tracing::complete::end(&type_event);
+	}
+}
+
+/**
+ * Computes the range of screen tiles covered by a bounding box in world space
+ *
+ * @return false if the box is completely outside of the screen
+ */
+static bool opengl_deferred_light_get_tiles(const vec3d* min, const vec3d* max, int num_tiles_x, int num_tiles_y, int* tiles)
+{
+	float rect[4];
+	if ( !opengl_deferred_light_get_screen_rect(min, max, rect) ) {
+		return false;
+	}
+
+	tiles[0] = MAX(0, fl2i(rect[0]) / DEFERRED_LIGHT_TILE_SIZE);
+	tiles[1] = MAX(0, fl2i(rect[1]) / DEFERRED_LIGHT_TILE_SIZE);
+	tiles[2] = MIN(num_tiles_x - 1, fl2i(rect[2]) / DEFERRED_LIGHT_TILE_SIZE);
+	tiles[3] = MIN(num_tiles_y - 1, fl2i(rect[3]) / DEFERRED_LIGHT_TILE_SIZE);
+
+	return true;
+}
+
+/**
+ * Builds the lists of the items in every screen tile from the tile ranges of the items
+ *
+ * Every tile gets the offset and the size of its list, the lists follow after the tiles.
+ */
+static void opengl_deferred_build_tile_lists(const SCP_vector<tile_range>& ranges, int num_tiles_x, int num_tiles, SCP_vector<uint>& tiles)
+{
+	tiles.assign(num_tiles * 2, 0);
+
+	for (auto& range : ranges) {
+		for (int y = range.tiles[1]; y <= range.tiles[3]; ++y) {
+			for (int x = range.tiles[0]; x <= range.tiles[2]; ++x) {
+				++tiles[(y * num_tiles_x + x) * 2 + 1];
+			}
+		}
+	}
+
+	uint offset = (uint)num_tiles * 2;
+	for (int i = 0; i < num_tiles; ++i) {
+		tiles[i * 2] = offset;
+		offset += tiles[i * 2 + 1];
+		tiles[i * 2 + 1] = 0;
+	}
+
+	tiles.resize(offset);
+
+	for (auto& range : ranges) {
+		for (int y = range.tiles[1]; y <= range.tiles[3]; ++y) {
+			for (int x = range.tiles[0]; x <= range.tiles[2]; ++x) {
+				auto tile = (y * num_tiles_x + x) * 2;
+				tiles[tiles[tile] + tiles[tile + 1]++] = range.light;
+			}
+		}
+	}
+}
+
+/**
+ * Applies all lights in a single full screen pass
+ *
+ * The lights are binned into screen tiles on the CPU and every fragment only shades the lights of its tile. The lights
+ * are set up exactly like the light volumes so both paths give the same result.
+ */
+static void opengl_deferred_apply_lights_tiled(light* lights, int num_lights)
+{
+	GR_DEBUG_SCOPE("Deferred apply tiled lights");
+	TRACE_SCOPE(tracing::DeferredTiledLights);
+
+	int num_tiles_x = (gr_screen.max_w + DEFERRED_LIGHT_TILE_SIZE - 1) / DEFERRED_LIGHT_TILE_SIZE;
+	int num_tiles_y = (gr_screen.max_h + DEFERRED_LIGHT_TILE_SIZE - 1) / DEFERRED_LIGHT_TILE_SIZE;
+	int num_tiles = num_tiles_x * num_tiles_y;
+
+	Deferred_light_data.clear();
+	Deferred_light_tile_ranges.clear();
+
+	// the light affects everything inside the sphere given by volume_center and volume_radius
+	auto add_light = [&](deferred_light_counter counter, const vec3d* pos, float radius, const vec3d* volume_center,
+		float volume_radius, int type, const vec3d& diffuse, const vec3d& spec, const vec3d* dir, float cone_angle,
+		float cone_inner_angle) {
+		vec3d min, max;
+		opengl_deferred_light_volume_box(volume_center, volume_radius, &min, &max);
+
+		tile_range range;
+		if ( !opengl_deferred_light_get_tiles(&min, &max, num_tiles_x, num_tiles_y, range.tiles) ) {
+			return;
+		}
+		range.light = (uint)(Deferred_light_data.size() / 4);
+		Deferred_light_tile_ranges.push_back(range);
+
+		// every pixel of the tiles of the light shades it
+		Deferred_light_pixels[counter] += (std::uint64_t)(range.tiles[2] - range.tiles[0] + 1) *
+			(range.tiles[3] - range.tiles[1] + 1) * DEFERRED_LIGHT_TILE_SIZE * DEFERRED_LIGHT_TILE_SIZE;
+
+		vec3d view_pos;
+		vm_vec_transform(&view_pos, const_cast<vec3d*>(pos), &GL_view_matrix, true);
+
+		vec4 data[4];
+		data[0].xyzw.x = view_pos.xyz.x;
+		data[0].xyzw.y = view_pos.xyz.y;
+		data[0].xyzw.z = view_pos.xyz.z;
+		data[0].xyzw.w = radius;
+		data[1].xyzw.x = diffuse.xyz.x;
+		data[1].xyzw.y = diffuse.xyz.y;
+		data[1].xyzw.z = diffuse.xyz.z;
+		data[1].xyzw.w = (float)type;
+		data[2].xyzw.x = spec.xyz.x;
+		data[2].xyzw.y = spec.xyz.y;
+		data[2].xyzw.z = spec.xyz.z;
+		data[2].xyzw.w = cone_angle;
+		data[3].xyzw.x = dir ? dir->xyz.x : 0.0f;
+		data[3].xyzw.y = dir ? dir->xyz.y : 0.0f;
+		data[3].xyzw.z = dir ? dir->xyz.z : 0.0f;
+		data[3].xyzw.w = cone_inner_angle;
+
+		Deferred_light_data.insert(Deferred_light_data.end(), data, data + 4);
+	};
+
+	for (int i = 0; i < num_lights; ++i) {
+		light *l = &lights[i];
+
+		vec3d diffuse;
+		vm_vec_make(&diffuse, l->r * l->intensity, l->g * l->intensity, l->b * l->intensity);
+
+		switch (l->type) {
+			case LT_CONE:
+			case LT_POINT: {
+				vec3d spec;
+				vm_vec_make(&spec, l->spec_r * l->intensity * static_point_factor, l->spec_g * l->intensity * static_point_factor, l->spec_b * l->intensity * static_point_factor);
+
+				float radius = MAX(l->rada, l->radb);
+
+				if (l->type == LT_CONE) {
+					// the cone direction is used as is, the same as the light volumes do
+					add_light(DEFERRED_LIGHT_CONE, &l->vec, radius * 1.25f, &l->vec, radius * 1.28f, l->dual_cone ? 3 : 2, diffuse, spec, &l->vec2, l->cone_angle, l->cone_inner_angle);
+				} else {
+					add_light(DEFERRED_LIGHT_POINT, &l->vec, radius * 1.25f, &l->vec, radius * 1.28f, 0, diffuse, spec, nullptr, 0.0f, 0.0f);
+				}
+				break;
+			}
+			case LT_TUBE: {
+				vec3d spec;
+				vm_vec_make(&spec, l->spec_r * l->intensity * static_tube_factor, l->spec_g * l->intensity * static_tube_factor, l->spec_b * l->intensity * static_tube_factor);
+
+				// the beam goes from the second point towards the first one in view space
+				vec3d world_beam, beam;
+				vm_vec_sub(&world_beam, &l->vec2, &l->vec);
+				vm_vec_transform(&beam, &world_beam, &GL_view_matrix, false);
+
+				float length = vm_vec_mag(&world_beam);
+				vec3d center;
+				vm_vec_avg(&center, &l->vec, &l->vec2);
+
+				add_light(DEFERRED_LIGHT_TUBE, &l->vec2, l->radb * 1.5f, &center, length * 0.5f + l->radb * 1.53f, 1, diffuse, spec, &beam, 0.0f, 0.0f);
+
+				// the light volumes add the end caps as point lights on top of the tube
+				add_light(DEFERRED_LIGHT_TUBE, &l->vec, l->radb * 1.5f, &l->vec, l->radb * 1.53f, 0, diffuse, spec, nullptr, 0.0f, 0.0f);
+				add_light(DEFERRED_LIGHT_TUBE, &l->vec2, l->radb * 1.5f, &l->vec2, l->radb * 1.53f, 0, diffuse, spec, nullptr, 0.0f, 0.0f);
+				break;
+			}
+			default:
+				break;
+		}
+	}
+
+	if (Deferred_light_tile_ranges.empty()) {
+		return;
+	}
+
+	opengl_deferred_build_tile_lists(Deferred_light_tile_ranges, num_tiles_x, num_tiles, Deferred_light_tiles);
+
+	if (Deferred_light_data_buffer < 0) {
+		Deferred_light_data_buffer = opengl_create_texture_buffer_object(GL_RGBA32F);
+		Deferred_light_tile_buffer = opengl_create_texture_buffer_object(GL_R32UI);
+	}
+
+	opengl_update_texture_buffer_object(Deferred_light_data_buffer, Deferred_light_data.size() * sizeof(vec4), Deferred_light_data.data());
+	opengl_update_texture_buffer_object(Deferred_light_tile_buffer, Deferred_light_tiles.size() * sizeof(uint), Deferred_light_tiles.data());
+
+	opengl_shader_set_current( gr_opengl_maybe_create_shader(SDR_TYPE_DEFERRED_LIGHTING, SDR_FLAG_DEFERRED_TILED) );
+
+	float sample_w, sample_h;
+	opengl_get_scene_sample_size(&sample_w, &sample_h);
+	Current_shader->program->Uniforms.setUniformf(SDR_UNIFORM("invScreenWidth"), 1.0f / sample_w);
+	Current_shader->program->Uniforms.setUniformf(SDR_UNIFORM("invScreenHeight"), 1.0f / sample_h);
+
+	GL_state.Texture.SetActiveUnit(4);
+	GL_state.Texture.SetTarget(GL_TEXTURE_BUFFER);
+	GL_state.Texture.Enable(opengl_get_texture_buffer_texture(Deferred_light_data_buffer));
+
+	GL_state.Texture.SetActiveUnit(5);
+	GL_state.Texture.SetTarget(GL_TEXTURE_BUFFER);
+	GL_state.Texture.Enable(opengl_get_texture_buffer_texture(Deferred_light_tile_buffer));
+
+	Current_shader->program->Uniforms.setUniformi( SDR_UNIFORM("tileSize"), DEFERRED_LIGHT_TILE_SIZE );
+	Current_shader->program->Uniforms.setUniformi( SDR_UNIFORM("numTilesX"), num_tiles_x );
+
+	float quad[8] = { -1.0f, -1.0f, 1.0f, -1.0f, -1.0f, 1.0f, 1.0f, 1.0f };
+
+	vertex_layout vert_def;
+	vert_def.add_vertex_component(vertex_format_data::POSITION2, sizeof(float) * 2, 0);
+
+	opengl_render_primitives_immediate(PRIM_TYPE_TRISTRIP, &vert_def, 4, quad, sizeof(quad));
+}
+
+static int Deferred_decal_data_buffer = -1;
+static int Deferred_decal_tile_buffer = -1;
+
+static SCP_vector<vec4> Deferred_decal_data;
+static SCP_vector<tile_range> Deferred_decal_tile_ranges;
+static SCP_vector<uint> Deferred_decal_tiles;
+
+/**
+ * Projects decals onto the opaque geometry in the G-buffer
+ *
+ * The decals are binned into screen tiles like the lights of the tiled lighting pass and a single full screen pass
+ * blends them into the diffuse color and the specular color of every pixel inside of their box. Has to be called
+ * before gr_deferred_lighting_end() since it writes to the G-buffer.
+ */
+void gr_opengl_render_decals(int bitmap, const decal_draw_info *decals, int num_decals)
+{
+	if ( !Deferred_lighting || num_decals <= 0 ) {
+		return;
+	}
+
+	GR_DEBUG_SCOPE("Deferred decals");
+	TRACE_SCOPE(tracing::DeferredDecals);
+
+	int sdr_handle = gr_opengl_maybe_create_shader(SDR_TYPE_DECAL, 0);
+	if ( sdr_handle < 0 ) {
+		return;
+	}
+
+	int num_tiles_x = (gr_screen.max_w + DEFERRED_LIGHT_TILE_SIZE - 1) / DEFERRED_LIGHT_TILE_SIZE;
+	int num_tiles_y = (gr_screen.max_h + DEFERRED_LIGHT_TILE_SIZE - 1) / DEFERRED_LIGHT_TILE_SIZE;
+	int num_tiles = num_tiles_x * num_tiles_y;
+
+	Deferred_decal_data.clear();
+	Deferred_decal_tile_ranges.clear();
+
+	for (int i = 0; i < num_decals; ++i) {
+		auto decal = &decals[i];
+
+		vec3d min, max;
+		float box_radius = fl_sqrt(2.0f * decal->radius * decal->radius + decal->depth * decal->depth);
+		opengl_deferred_light_volume_box(&decal->position, box_radius, &min, &max);
+
+		tile_range range;
+		if ( !opengl_deferred_light_get_tiles(&min, &max, num_tiles_x, num_tiles_y, range.tiles) ) {
+			continue;
+		}
+		range.light = (uint)(Deferred_decal_data.size() / 4);
+		Deferred_decal_tile_ranges.push_back(range);
+
+		// the axes of the box are scaled so the box goes from -1 to 1 along every one of them
+		vec3d view_pos, rvec, uvec, fvec;
+		vm_vec_transform(&view_pos, const_cast<vec3d*>(&decal->position), &GL_view_matrix, true);
+		vm_vec_transform(&rvec, const_cast<vec3d*>(&decal->orient.vec.rvec), &GL_view_matrix, false);
+		vm_vec_transform(&uvec, const_cast<vec3d*>(&decal->orient.vec.uvec), &GL_view_matrix, false);
+		vm_vec_transform(&fvec, const_cast<vec3d*>(&decal->orient.vec.fvec), &GL_view_matrix, false);
+		vm_vec_scale(&rvec, 1.0f / decal->radius);
+		vm_vec_scale(&uvec, 1.0f / decal->radius);
+		vm_vec_scale(&fvec, 1.0f / decal->depth);
+
+		vec4 data[4];
+		data[0].xyzw.x = view_pos.xyz.x;
+		data[0].xyzw.y = view_pos.xyz.y;
+		data[0].xyzw.z = view_pos.xyz.z;
+		data[0].xyzw.w = decal->alpha;
+		data[1].xyzw.x = rvec.xyz.x;
+		data[1].xyzw.y = rvec.xyz.y;
+		data[1].xyzw.z = rvec.xyz.z;
+		data[1].xyzw.w = 0.0f;
+		data[2].xyzw.x = uvec.xyz.x;
+		data[2].xyzw.y = uvec.xyz.y;
+		data[2].xyzw.z = uvec.xyz.z;
+		data[2].xyzw.w = 0.0f;
+		data[3].xyzw.x = fvec.xyz.x;
+		data[3].xyzw.y = fvec.xyz.y;
+		data[3].xyzw.z = fvec.xyz.z;
+		data[3].xyzw.w = 0.0f;
+
+		Deferred_decal_data.insert(Deferred_decal_data.end(), data, data + 4);
+	}
+
+	if (Deferred_decal_tile_ranges.empty()) {
+		return;
+	}
+
+	opengl_deferred_build_tile_lists(Deferred_decal_tile_ranges, num_tiles_x, num_tiles, Deferred_decal_tiles);
+
+	if (Deferred_decal_data_buffer < 0) {
+		Deferred_decal_data_buffer = opengl_create_texture_buffer_object(GL_RGBA32F);
+		Deferred_decal_tile_buffer = opengl_create_texture_buffer_object(GL_R32UI);
+	}
+
+	opengl_update_texture_buffer_object(Deferred_decal_data_buffer, Deferred_decal_data.size() * sizeof(vec4), Deferred_decal_data.data());
+	opengl_update_texture_buffer_object(Deferred_decal_tile_buffer, Deferred_decal_tiles.size() * sizeof(uint), Deferred_decal_tiles.data());
+
+	GLboolean depth = GL_state.DepthTest(GL_FALSE);
+	GLboolean depth_mask = GL_state.DepthMask(GL_FALSE);
+	GLboolean cull = GL_state.CullFace(GL_FALSE);
+
+	// only the diffuse and the specular color are changed, the position and the normal are read by the shader. The
+	// alpha channels are left alone since the lighting uses them.
+	GLenum buffers[] = { GL_COLOR_ATTACHMENT0, GL_NONE, GL_NONE, GL_COLOR_ATTACHMENT3 };
+	glDrawBuffers(4, buffers);
+	GL_state.ColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_FALSE);
+	GL_state.SetAlphaBlendMode(ALPHA_BLEND_PREMULTIPLIED);
+
+	opengl_shader_set_current(sdr_handle);
+
+	GL_state.Texture.SetShaderMode(GL_TRUE);
+
+	float u_scale, v_scale;
+	if ( !gr_opengl_tcache_set(bitmap, TCACHE_TYPE_NORMAL, &u_scale, &v_scale, 0) ) {
+		mprintf(("WARNING: Error setting decal texture (%i)!\n", bitmap));
+	}
+
+	GL_state.Texture.SetActiveUnit(1);
+	GL_state.Texture.SetTarget(GL_TEXTURE_2D);
+	GL_state.Texture.Enable(Scene_normal_texture);
+
+	GL_state.Texture.SetActiveUnit(2);
+	GL_state.Texture.SetTarget(GL_TEXTURE_2D);
+	GL_state.Texture.Enable(Scene_position_texture);
+
+	GL_state.Texture.SetActiveUnit(3);
+	GL_state.Texture.SetTarget(GL_TEXTURE_BUFFER);
+	GL_state.Texture.Enable(opengl_get_texture_buffer_texture(Deferred_decal_data_buffer));
+
+	GL_state.Texture.SetActiveUnit(4);
+	GL_state.Texture.SetTarget(GL_TEXTURE_BUFFER);
+	GL_state.Texture.Enable(opengl_get_texture_buffer_texture(Deferred_decal_tile_buffer));
+
+	Current_shader->program->Uniforms.setUniformi( SDR_UNIFORM("decalMap"), 0 );
+	Current_shader->program->Uniforms.setUniformi( SDR_UNIFORM("NormalBuffer"), 1 );
+	Current_shader->program->Uniforms.setUniformi( SDR_UNIFORM("PositionBuffer"), 2 );
+	Current_shader->program->Uniforms.setUniformi( SDR_UNIFORM("decalData"), 3 );
+	Current_shader->program->Uniforms.setUniformi( SDR_UNIFORM("tileData"), 4 );
+	Current_shader->program->Uniforms.setUniformi( SDR_UNIFORM("tileSize"), DEFERRED_LIGHT_TILE_SIZE );
+	Current_shader->program->Uniforms.setUniformi( SDR_UNIFORM("numTilesX"), num_tiles_x );
+	float sample_w, sample_h;
+	opengl_get_scene_sample_size(&sample_w, &sample_h);
+	Current_shader->program->Uniforms.setUniformf( SDR_UNIFORM("invScreenWidth"), 1.0f / sample_w );
+	Current_shader->program->Uniforms.setUniformf( SDR_UNIFORM("invScreenHeight"), 1.0f / sample_h );
+	Current_shader->program->Uniforms.setUniformi( SDR_UNIFORM("srgb"), High_dynamic_range ? 1 : 0 );
+
+	float quad[8] = { -1.0f, -1.0f, 1.0f, -1.0f, -1.0f, 1.0f, 1.0f, 1.0f };
+
+	vertex_layout vert_def;
+	vert_def.add_vertex_component(vertex_format_data::POSITION2, sizeof(float) * 2, 0);
+
+	opengl_render_primitives_immediate(PRIM_TYPE_TRISTRIP, &vert_def, 4, quad, sizeof(quad));
+
+	// back to filling the G-buffer, see gr_opengl_deferred_lighting_begin()
+	GL_state.SetAlphaBlendMode(ALPHA_BLEND_NONE);
+	GL_state.ColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+	GLenum gbuffer_buffers[] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1, GL_COLOR_ATTACHMENT2, GL_COLOR_ATTACHMENT3 };
+	glDrawBuffers(4, gbuffer_buffers);
+
+	GL_state.DepthTest(depth);
+	GL_state.DepthMask(depth_mask);
+	GL_state.CullFace(cull);
+
+	GL_state.Texture.SetShaderMode(GL_FALSE);
+	opengl_shader_set_current();
+}
+
+void gr_opengl_deferred_lighting_finish()
+{
+	GR_DEBUG_SCOPE("Deferred lighting finish");
+	TRACE_SCOPE(tracing::ApplyLights);
+
+	if ( Cmdline_no_deferred_lighting ) {
+		return;
+	}
+
+	GL_state.SetAlphaBlendMode( ALPHA_BLEND_ADDITIVE);
+	gr_zbuffer_set(GR_ZBUFF_NONE);
+
+	//GL_state.DepthFunc(GL_GREATER);
+	//GL_state.DepthMask(GL_FALSE);
+
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, Scene_luminance_texture, 0);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, Scene_stencil_buffer);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_STENCIL_ATTACHMENT, GL_RENDERBUFFER, Scene_stencil_buffer);
+
+	GL_state.Texture.SetShaderMode(GL_TRUE);
+
+	GL_state.Texture.SetActiveUnit(0);
+	GL_state.Texture.SetTarget(GL_TEXTURE_2D);
+	GL_state.Texture.Enable(Scene_color_texture);
+
+	GL_state.Texture.SetActiveUnit(1);
+	GL_state.Texture.SetTarget(GL_TEXTURE_2D);
+	GL_state.Texture.Enable(Scene_normal_texture);
+
+	GL_state.Texture.SetActiveUnit(2);
+	GL_state.Texture.SetTarget(GL_TEXTURE_2D);
+	GL_state.Texture.Enable(Scene_position_texture);
+
+	GL_state.Texture.SetActiveUnit(3);
+	GL_state.Texture.SetTarget(GL_TEXTURE_2D);
+	GL_state.Texture.Enable(Scene_specular_texture);
+
+	glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+	glClear(GL_COLOR_BUFFER_BIT);
+
+	light lights_copy[MAX_LIGHTS];
+	memcpy(lights_copy, Lights, MAX_LIGHTS * sizeof(light));
+
+	std::sort(lights_copy, lights_copy+Num_lights, light_compare_by_type);
+
+	memset(Deferred_light_pixels, 0, sizeof(Deferred_light_pixels));
+
+	if ( Deferred_lighting_tiled && Num_lights >= DEFERRED_LIGHT_TILED_MIN_LIGHTS ) {
+		opengl_deferred_apply_lights_tiled(lights_copy, Num_lights);
+	} else {
+		opengl_deferred_apply_lights_volumes(lights_copy, Num_lights);
+	}
+
+	opengl_deferred_light_publish_pixels();
+
 	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, Scene_color_texture, 0);
 	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_STENCIL_ATTACHMENT, GL_TEXTURE_2D, 0, 0);
 	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, Scene_depth_texture, 0);
@@ -2227,7 +2975,10 @@ void gr_opengl_deferred_lighting_finish()
 	GL_state.SetAlphaBlendMode( ALPHA_BLEND_ADDITIVE );
 	GL_state.DepthMask(GL_FALSE);
 
-	opengl_draw_textured_quad(0.0f, 0.0f, 0.0f, Scene_texture_v_scale, (float)gr_screen.max_w, (float)gr_screen.max_h, Scene_texture_u_scale, 0.0f);
+	{
+		TRACE_SCOPE(tracing::DeferredLightComposite);
+		opengl_draw_textured_quad(0.0f, 0.0f, 0.0f, Scene_texture_v_scale, (float)gr_screen.max_w, (float)gr_screen.max_h, Scene_texture_u_scale, 0.0f);
+	}
 
 	gr_set_proj_matrix(Proj_fov, gr_screen.clip_aspect, Min_draw_distance, Max_draw_distance);
 	gr_set_view_matrix(&Eye_position, &Eye_matrix);
@@ -2246,12 +2997,17 @@ void gr_opengl_deferred_lighting_finish()
 
 void gr_opengl_render_shield_impact(shield_material *material_info, primitive_type prim_type, vertex_layout *layout, int buffer_handle, int n_verts)
 {
-	matrix4 impact_transform;
 	matrix4 impact_projection;
 	vec3d min;
 	vec3d max;
 	
-	opengl_tnl_set_material(material_info, true);
+	int num_impacts = material_info->get_num_impacts();
+
+	if ( num_impacts <= 0 ) {
+		return;
+	}
+
+	opengl_tnl_set_material(material_info, false);
 
 	float radius = material_info->get_impact_radius();
 	min.xyz.x = min.xyz.y = min.xyz.z = -radius;
@@ -2259,23 +3015,96 @@ void gr_opengl_render_shield_impact(shield_material *material_info, primitive_ty
 
 	vm_matrix4_set_orthographic(&impact_projection, &max, &min);
 
-	matrix impact_orient = material_info->get_impact_orient();
-	vec3d impact_pos = material_info->get_impact_pos();
+	matrix4 impact_transforms[SHIELD_MAX_IMPACTS];
+	vec3d hit_normals[SHIELD_MAX_IMPACTS];
+	int shield_maps[SHIELD_MAX_IMPACTS];
+
+	for ( int i = 0; i < num_impacts; ++i ) {
+		auto &impact = material_info->get_impact(i);
+
+		matrix impact_orient = impact.orient;
+		vec3d impact_pos = impact.pos;
 
-	vm_matrix4_set_inverse_transform(&impact_transform, &impact_orient, &impact_pos);
+		vm_matrix4_set_inverse_transform(&impact_transforms[i], &impact_orient, &impact_pos);
+		hit_normals[i] = impact.orient.vec.fvec;
+		shield_maps[i] = i;
 
-	Current_shader->program->Uniforms.setUniform3f("hitNormal", impact_orient.vec.fvec);
-	Current_shader->program->Uniforms.setUniformMatrix4f("shieldProjMatrix", impact_projection);
-	Current_shader->program->Uniforms.setUniformMatrix4f("shieldModelViewMatrix", impact_transform);
-	Current_shader->program->Uniforms.setUniformi("shieldMap", 0);
-	Current_shader->program->Uniforms.setUniformi("srgb", High_dynamic_range ? 1 : 0);
-	Current_shader->program->Uniforms.setUniform4f("color", material_info->get_color());
-	Current_shader->program->Uniforms.setUniformMatrix4f("modelViewMatrix", GL_model_view_matrix);
-	Current_shader->program->Uniforms.setUniformMatrix4f("projMatrix", GL_projection_matrix);
+		float u_scale, v_scale;
+
+		if ( !gr_opengl_tcache_set(impact.bitmap, material_info->get_texture_type(), &u_scale, &v_scale, i) ) {
+			mprintf(("WARNING: Error setting shield impact texture (%i)!\n", impact.bitmap));
+		}
+	}
+
+	Current_shader->program->Uniforms.setUniformi(SDR_UNIFORM("numImpacts"), num_impacts);
+	Current_shader->program->Uniforms.setUniform3fv(SDR_UNIFORM("hitNormal"), num_impacts, hit_normals);
+	Current_shader->program->Uniforms.setUniformMatrix4f(SDR_UNIFORM("shieldProjMatrix"), impact_projection);
+	Current_shader->program->Uniforms.setUniformMatrix4fv(SDR_UNIFORM("shieldModelViewMatrix"), num_impacts, impact_transforms);
+	Current_shader->program->Uniforms.setUniform1iv(SDR_UNIFORM("shieldMap"), num_impacts, shield_maps);
+	Current_shader->program->Uniforms.setUniformi(SDR_UNIFORM("srgb"), High_dynamic_range ? 1 : 0);
+	Current_shader->program->Uniforms.setUniformi(SDR_UNIFORM("blendAlpha"), material_info->get_blend_mode() == ALPHA_BLEND_ADDITIVE ? 0 : 1);
+	Current_shader->program->Uniforms.setUniform4f(SDR_UNIFORM("color"), material_info->get_color());
+	Current_shader->program->Uniforms.setUniformMatrix4f(SDR_UNIFORM("modelViewMatrix"), GL_model_view_matrix);
+	Current_shader->program->Uniforms.setUniformMatrix4f(SDR_UNIFORM("projMatrix"), GL_projection_matrix);
 	
 	opengl_render_primitives(prim_type, layout, n_verts, buffer_handle, 0, 0);
 }
 
+/**
+ * Draws a cubemap as the background of the whole screen, as it is seen with the current view and projection
+ */
+void gr_opengl_render_background_cubemap(int cubemap)
+{
+	GR_DEBUG_SCOPE("Draw background cubemap");
+
+	int sdr_handle = gr_opengl_maybe_create_shader(SDR_TYPE_BACKGROUND_CUBEMAP, 0);
+	if ( sdr_handle < 0 ) {
+		return;
+	}
+
+	GLboolean depth = GL_state.DepthTest(GL_FALSE);
+	GLboolean depth_mask = GL_state.DepthMask(GL_FALSE);
+	GLboolean blend = GL_state.Blend(GL_FALSE);
+	GLboolean cull = GL_state.CullFace(GL_FALSE);
+
+	opengl_shader_set_current(sdr_handle);
+
+	GL_state.Texture.SetShaderMode(GL_TRUE);
+
+	float u_scale, v_scale;
+	if ( !gr_opengl_tcache_set(cubemap, TCACHE_TYPE_CUBEMAP, &u_scale, &v_scale, 0) ) {
+		mprintf(("WARNING: Error setting background cubemap (%i)!\n", cubemap));
+	}
+
+	// the same rotation from view space to the cubemap as the environment map uses, see gr_opengl_set_view_matrix()
+	matrix4 env_matrix;
+	vm_matrix4_set_identity(&env_matrix);
+	for ( int row = 0; row < 3; ++row ) {
+		for ( int col = 0; col < 3; ++col ) {
+			env_matrix.a1d[row * 4 + col] = GL_view_matrix.a1d[col * 4 + row];
+		}
+	}
+
+	Current_shader->program->Uniforms.setUniformi( SDR_UNIFORM("cubemap"), 0 );
+	Current_shader->program->Uniforms.setUniformMatrix4f( SDR_UNIFORM("envMatrix"), env_matrix );
+	Current_shader->program->Uniforms.setUniform2f( SDR_UNIFORM("projScale"), 1.0f / GL_projection_matrix.a1d[0], 1.0f / GL_projection_matrix.a1d[5] );
+
+	float quad[8] = { -1.0f, -1.0f, 1.0f, -1.0f, -1.0f, 1.0f, 1.0f, 1.0f };
+
+	vertex_layout vert_def;
+	vert_def.add_vertex_component(vertex_format_data::POSITION2, sizeof(float) * 2, 0);
+
+	opengl_render_primitives_immediate(PRIM_TYPE_TRISTRIP, &vert_def, 4, quad, sizeof(quad));
+
+	GL_state.DepthTest(depth);
+	GL_state.DepthMask(depth_mask);
+	GL_state.Blend(blend);
+	GL_state.CullFace(cull);
+
+	GL_state.Texture.SetShaderMode(GL_FALSE);
+	opengl_shader_set_current();
+}
+
 void gr_opengl_update_distortion()
 {
 	if (Distortion_framebuffer == 0) {
@@ -2386,6 +3215,7 @@ void opengl_render_primitives(primitive_type prim_type, vertex_layout* layout, i
 	opengl_bind_vertex_layout(*layout, 0, (ubyte*)byte_offset);
 
 	glDrawArrays(opengl_primitive_type(prim_type), (GLint)vert_offset, n_verts);
+	++GL_frame_stats.draw_calls;
 }
 
 void opengl_render_primitives_immediate(primitive_type prim_type, vertex_layout* layout, int n_verts, void* data, int size)
@@ -17,6 +17,8 @@
 #include "graphics/shadows.h"
 #include <glad/glad.h>
 
+extern bool Deferred_lighting_tiled;
+
 struct opengl_vertex_bind {
 	vertex_format_data::vertex_format format;
 	GLint size;
@@ -28,6 +30,12 @@ struct opengl_vertex_bind {
 void gr_opengl_aabitmap_ex(int x, int y, int w, int h, int sx, int sy, int resize_mode, bool mirror);
 void gr_opengl_aabitmap(int x, int y, int resize_mode, bool mirror);
 void gr_opengl_string(float sx, float sy, const char *s, int resize_mode, int length);
+void gr_opengl_string_batch_begin();
+void gr_opengl_string_batch_end();
+// draws the glyphs which were collected since the last call, needed before anything the strings depend on changes
+void opengl_flush_string_batch();
+// draws the atlas bitmaps which were collected since the last call, needed before anything else is drawn
+void opengl_flush_bitmap_batch();
 void gr_opengl_line(int x1,int y1,int x2,int y2, int resize_mode);
 void gr_opengl_aaline(vertex *v1, vertex *v2);
 void gr_opengl_pixel(int x, int y, int resize_mode);
@@ -52,16 +60,26 @@ void gr_opengl_draw_deferred_light_sphere(const vec3d *position, float rad, bool
 void gr_opengl_deferred_light_cylinder_init(int segments);
 void gr_opengl_draw_deferred_light_cylinder(const vec3d *position, const matrix *orient, float rad, float length, bool clearStencil);
 
-void gr_opengl_shadow_map_start(matrix4 *shadow_view_matrix, const matrix *light_orient);
+void gr_opengl_shadow_map_start(matrix4 *shadow_view_matrix, const matrix *light_orient, int num_cascades);
 void gr_opengl_shadow_map_end();
 
 void gr_opengl_render_shield_impact(shield_material *material_info, primitive_type prim_type, vertex_layout *layout, int buffer_handle, int n_verts);
+void gr_opengl_render_decals(int bitmap, const decal_draw_info *decals, int num_decals);
+void gr_opengl_render_background_cubemap(int cubemap);
 
 void opengl_setup_scene_textures();
 void opengl_scene_texture_shutdown();
 void gr_opengl_scene_texture_begin();
 void gr_opengl_scene_texture_end();
-void gr_opengl_copy_effect_texture();
+void gr_opengl_copy_effect_texture(int x1, int y1, int x2, int y2);
+
+/**
+ * @brief The size gl_FragCoord is divided by to sample the scene textures
+ *
+ * While the scene is drawn into the scene textures this is their size, which is larger than gr_screen when rendering
+ * to a texture or when the scene is scaled down by -dynamic_res.
+ */
+void opengl_get_scene_sample_size(float* width, float* height);
 
 void opengl_clear_deferred_buffers();
 void gr_opengl_deferred_lighting_begin();
@@ -103,6 +121,7 @@ inline void opengl_draw_textured_quad_instanced(
 
 	//glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
 	glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, count);
+	++GL_frame_stats.draw_calls;
 }
 
 inline void opengl_draw_textured_quad(
@@ -0,0 +1,292 @@
+#include "graphics/opengl/gropengldynres.h"
+
+#include "cmdline/cmdline.h"
+#include "debugconsole/console.h"
+#include "graphics/opengl/gropengl.h"
+#include "graphics/opengl/gropengldraw.h"
+#include "graphics/opengl/gropenglquery.h"
+#include "tracing/Monitor.h"
+
+extern void opengl_setup_viewport();
+
+namespace {
+
+// the GPU time the scene should take in milliseconds, 0 turns the scaling off
+float Scene_res_target_ms = 0.0f;
+
+// the scene is never drawn smaller than this part of the screen width and height
+float Scene_res_min_scale = 0.5f;
+
+float Scene_res_scale = 1.0f;
+float Scene_res_gpu_ms = 0.0f;
+int Scene_res_frames_since_change = 0;
+
+bool Scene_res_in_frame = false;
+bool Scene_res_scaled = false;
+
+struct saved_screen {
+	int max_w, max_h;
+	int center_w, center_h;
+	int center_offset_x, center_offset_y;
+};
+
+saved_screen Scene_res_saved_screen;
+
+// the timestamps of the last few scenes, they are only read once the GPU got to them so nothing waits
+struct scene_timer {
+	int begin_query = -1;
+	int end_query = -1;
+	bool pending = false;
+};
+
+const int SCENE_TIMER_FRAMES = 4;
+
+scene_timer Scene_timers[SCENE_TIMER_FRAMES];
+int Scene_timer_current = 0;
+bool Scene_timer_started = false;
+
+const float GPU_TIME_SMOOTHING = 0.2f;
+
+// scaling up only happens when the scene takes clearly less than the target so the scale doesn't flicker between two
+const float UPSCALE_THRESHOLD = 0.8f;
+const float UPSCALE_STEP = 0.05f;
+const float MAX_DOWNSCALE_STEP = 0.15f;
+
+// the measurements lag behind by a few frames, so after a change the scale is left alone for a while
+const int FRAMES_BEFORE_DOWNSCALE = 6;
+const int FRAMES_BEFORE_UPSCALE = 30;
+
+MONITOR(SceneResolutionPercent)
+
+bool scene_res_enabled()
+{
+	return Scene_res_target_ms > 0.0f && Scene_texture_initialized && gr_is_capable(CAPABILITY_TIMESTAMP_QUERY);
+}
+
+void read_scene_timers()
+{
+	// oldest first
+	for (int i = 1; i <= SCENE_TIMER_FRAMES; ++i) {
+		auto& timer = Scene_timers[(Scene_timer_current + i) % SCENE_TIMER_FRAMES];
+
+		if (!timer.pending || !gr_opengl_query_value_available(timer.end_query)) {
+			continue;
+		}
+
+		auto begin = gr_opengl_get_query_value(timer.begin_query);
+		auto end = gr_opengl_get_query_value(timer.end_query);
+		timer.pending = false;
+
+		if (end <= begin) {
+			continue;
+		}
+
+		auto ms = (end - begin) / 1000000.0f;
+
+		if (Scene_res_gpu_ms <= 0.0f) {
+			Scene_res_gpu_ms = ms;
+		} else {
+			Scene_res_gpu_ms += (ms - Scene_res_gpu_ms) * GPU_TIME_SMOOTHING;
+		}
+	}
+}
+
+void update_scale()
+{
+	++Scene_res_frames_since_change;
+
+	if (Scene_res_gpu_ms <= 0.0f) {
+		return;
+	}
+
+	float scale = Scene_res_scale;
+
+	if (Scene_res_gpu_ms > Scene_res_target_ms && Scene_res_frames_since_change >= FRAMES_BEFORE_DOWNSCALE) {
+		// the cost of the scene goes with its pixels, so with the square of the scale
+		scale *= MAX(fl_sqrt(Scene_res_target_ms / Scene_res_gpu_ms), 1.0f - MAX_DOWNSCALE_STEP);
+	} else if (Scene_res_gpu_ms < Scene_res_target_ms * UPSCALE_THRESHOLD
+		&& Scene_res_frames_since_change >= FRAMES_BEFORE_UPSCALE) {
+		scale += UPSCALE_STEP;
+	}
+
+	CLAMP(scale, Scene_res_min_scale, 1.0f);
+
+	if (fabsf(scale - Scene_res_scale) < 0.001f) {
+		return;
+	}
+
+	// until the new measurements come in, expect the time to change with the pixels
+	Scene_res_gpu_ms *= (scale * scale) / (Scene_res_scale * Scene_res_scale);
+
+	Scene_res_scale = scale;
+	Scene_res_frames_since_change = 0;
+}
+
+void apply_scale()
+{
+	int w = MAX(fl2i(gr_screen.max_w * Scene_res_scale + 0.5f) & ~1, 2);
+	int h = MAX(fl2i(gr_screen.max_h * Scene_res_scale + 0.5f) & ~1, 2);
+
+	if (w >= gr_screen.max_w && h >= gr_screen.max_h) {
+		return;
+	}
+
+	auto& saved = Scene_res_saved_screen;
+	saved.max_w = gr_screen.max_w;
+	saved.max_h = gr_screen.max_h;
+	saved.center_w = gr_screen.center_w;
+	saved.center_h = gr_screen.center_h;
+	saved.center_offset_x = gr_screen.center_offset_x;
+	saved.center_offset_y = gr_screen.center_offset_y;
+
+	gr_screen.max_w = w;
+	gr_screen.max_h = h;
+	gr_screen.center_w = saved.center_w * w / saved.max_w;
+	gr_screen.center_h = saved.center_h * h / saved.max_h;
+	gr_screen.center_offset_x = saved.center_offset_x * w / saved.max_w;
+	gr_screen.center_offset_y = saved.center_offset_y * h / saved.max_h;
+
+	Scene_res_scaled = true;
+
+	gr_reset_clip();
+	opengl_setup_viewport();
+}
+
+void print_values()
+{
+	if (!scene_res_enabled()) {
+		dc_printf("Dynamic resolution is off\n");
+	}
+
+	dc_printf("Scene scale %.2f, GPU time of the scene %.2f ms, target %.2f ms, minimum scale %.2f\n", Scene_res_scale,
+		Scene_res_gpu_ms, Scene_res_target_ms, Scene_res_min_scale);
+}
+
+}
+
+DCF(dynamic_res, "Shows or changes the dynamic resolution of the 3D scene (print|target|min_scale)")
+{
+	if (dc_optional_string_either("help", "--help")) {
+		dc_printf("Usage: dynamic_res [print|target <ms>|min_scale <scale>]\n");
+		dc_printf("\tprint      Shows the current scale and GPU time of the scene (default)\n");
+		dc_printf("\ttarget     Sets the GPU time the scene should take, 0 turns the scaling off\n");
+		dc_printf("\tmin_scale  Sets the smallest part of the screen size the scene is drawn with\n");
+		return;
+	}
+
+	if (dc_optional_string("target")) {
+		dc_stuff_float(&Scene_res_target_ms);
+		Scene_res_target_ms = MAX(Scene_res_target_ms, 0.0f);
+
+		if (Scene_res_target_ms <= 0.0f) {
+			Scene_res_scale = 1.0f;
+		}
+	} else if (dc_optional_string("min_scale")) {
+		dc_stuff_float(&Scene_res_min_scale);
+		CLAMP(Scene_res_min_scale, 0.25f, 1.0f);
+		Scene_res_scale = MAX(Scene_res_scale, Scene_res_min_scale);
+	}
+
+	print_values();
+}
+
+void opengl_scene_resolution_init()
+{
+	Scene_res_target_ms = MAX(Cmdline_dynamic_res, 0.0f);
+	Scene_res_scale = 1.0f;
+	Scene_res_gpu_ms = 0.0f;
+	Scene_res_frames_since_change = 0;
+
+	if (Scene_res_target_ms > 0.0f) {
+		if (!Scene_texture_initialized || !gr_is_capable(CAPABILITY_TIMESTAMP_QUERY)) {
+			mprintf(("  Dynamic resolution needs scene textures and timestamp queries, it stays off\n"));
+		} else {
+			mprintf(("  Dynamic resolution holds the scene to %.2f ms of GPU time\n", Scene_res_target_ms));
+		}
+	}
+}
+
+void opengl_scene_resolution_shutdown()
+{
+	for (auto& timer : Scene_timers) {
+		if (timer.begin_query >= 0) {
+			gr_opengl_delete_query_object(timer.begin_query);
+			gr_opengl_delete_query_object(timer.end_query);
+		}
+
+		timer = scene_timer();
+	}
+
+	Scene_timer_started = false;
+}
+
+void gr_opengl_scene_resolution_begin()
+{
+	if (Scene_res_in_frame || !scene_res_enabled() || gr_screen.rendering_to_texture != -1) {
+		return;
+	}
+
+	Scene_res_in_frame = true;
+
+	read_scene_timers();
+	update_scale();
+
+	// if the GPU is that far behind the timer of this frame is still in use and the frame goes unmeasured
+	auto& timer = Scene_timers[Scene_timer_current];
+	if (!timer.pending) {
+		if (timer.begin_query < 0) {
+			timer.begin_query = gr_opengl_create_query_object();
+			timer.end_query = gr_opengl_create_query_object();
+		}
+
+		gr_opengl_query_value(timer.begin_query, QueryType::Timestamp);
+		Scene_timer_started = true;
+	}
+
+	if (Scene_res_scale < 1.0f) {
+		apply_scale();
+	}
+
+	MONITOR_SET(SceneResolutionPercent, fl2i(Scene_res_scale * 100.0f + 0.5f));
+}
+
+void gr_opengl_scene_resolution_end()
+{
+	if (!Scene_res_in_frame) {
+		return;
+	}
+
+	opengl_scene_resolution_restore();
+
+	if (Scene_timer_started) {
+		auto& timer = Scene_timers[Scene_timer_current];
+
+		gr_opengl_query_value(timer.end_query, QueryType::Timestamp);
+		timer.pending = true;
+
+		Scene_timer_current = (Scene_timer_current + 1) % SCENE_TIMER_FRAMES;
+		Scene_timer_started = false;
+	}
+
+	Scene_res_in_frame = false;
+}
+
+void opengl_scene_resolution_restore()
+{
+	if (!Scene_res_scaled) {
+		return;
+	}
+
+	auto& saved = Scene_res_saved_screen;
+	gr_screen.max_w = saved.max_w;
+	gr_screen.max_h = saved.max_h;
+	gr_screen.center_w = saved.center_w;
+	gr_screen.center_h = saved.center_h;
+	gr_screen.center_offset_x = saved.center_offset_x;
+	gr_screen.center_offset_y = saved.center_offset_y;
+
+	Scene_res_scaled = false;
+
+	gr_reset_clip();
+	opengl_setup_viewport();
+}
@@ -0,0 +1,35 @@
+#ifndef _GROPENGLDYNRES_H
+#define _GROPENGLDYNRES_H
+#pragma once
+
+/** @file
+ *  Dynamic resolution of the 3D scene, see -dynamic_res.
+ *
+ *  The GPU time of the scene is measured with timestamp queries at its start and its end. When it takes longer than
+ *  the target, the scene is drawn into a smaller part of the scene textures by making gr_screen that small for the
+ *  time of the scene, the same way drawing into a render target does. The post processing keeps working on that part
+ *  and the last pass stretches it to the whole screen, so the HUD and the interface are still drawn at the full
+ *  resolution.
+ */
+
+void opengl_scene_resolution_init();
+void opengl_scene_resolution_shutdown();
+
+/**
+ * @brief Starts the scene of a frame, called before g3_start_frame() so the 3D code sees the scaled size
+ */
+void gr_opengl_scene_resolution_begin();
+
+/**
+ * @brief Ends the scene of a frame, after gr_scene_texture_end()
+ */
+void gr_opengl_scene_resolution_end();
+
+/**
+ * @brief Goes back to the full resolution for the passes which draw to the screen
+ *
+ * Does nothing if the scene isn't scaled.
+ */
+void opengl_scene_resolution_restore();
+
+#endif // _GROPENGLDYNRES_H
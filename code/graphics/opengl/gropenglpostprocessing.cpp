@@ -4,9 +4,11 @@
 #include "def_files/def_files.h"
 #include "gropengl.h"
 #include "gropengldraw.h"
+#include "gropengldynres.h"
 #include "gropenglpostprocessing.h"
 #include "gropenglshader.h"
 #include "gropenglstate.h"
+#include "gropengltexture.h"
 #include "io/timer.h"
 #include "lighting/lighting.h"
 #include "mod_table/mod_table.h"
@@ -38,6 +40,9 @@ int ls_samplenum = 50;
 
 const int MAX_MIP_BLUR_LEVELS = 4;
 
+// one blur iteration with the taps this much further apart blurs as much as the two iterations the bloom used to do
+const float BLOOM_TAP_SIZE = 1.41421356f;
+
 typedef struct post_effect_t {
 	SCP_string name;
 	SCP_string uniform_name;
@@ -76,23 +81,57 @@ static GLuint Post_shadow_depth_texture_id = 0;
 static int Post_texture_width = 0;
 static int Post_texture_height = 0;
 
-void opengl_post_pass_tonemap()
+/**
+ * Tonemaps the scene into the LDR texture. The bloom is added in the same pass and with FXAA the luma FXAA needs is
+ * written as well, in which case the result goes to the luminance texture FXAA reads from.
+ */
+void opengl_post_pass_tonemap(bool bloom, bool fxaa)
 {
 	GR_DEBUG_SCOPE("Tonemapping");
 	TRACE_SCOPE(tracing::Tonemapping);
 
-	opengl_shader_set_current( gr_opengl_maybe_create_shader(SDR_TYPE_POST_PROCESS_TONEMAPPING, 0) );
+	int flags = 0;
 
-	Current_shader->program->Uniforms.setUniformi("tex", 0);
-	Current_shader->program->Uniforms.setUniformf("exposure", 4.0f);
+	if (bloom) {
+		flags |= SDR_FLAG_TONEMAPPING_BLOOM;
+	}
 
-	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, Scene_ldr_texture, 0);
+	if (fxaa) {
+		flags |= SDR_FLAG_TONEMAPPING_LUMA;
+
+		// the luma is written to the alpha channel
+		GL_state.ColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+	}
+
+	opengl_shader_set_current( gr_opengl_maybe_create_shader(SDR_TYPE_POST_PROCESS_TONEMAPPING, flags) );
+
+	Current_shader->program->Uniforms.setUniformi(SDR_UNIFORM("tex"), 0);
+	Current_shader->program->Uniforms.setUniformf(SDR_UNIFORM("exposure"), 4.0f);
+
+	GL_state.BindFrameBuffer(Bloom_framebuffer);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, fxaa ? Scene_luminance_texture : Scene_ldr_texture, 0);
 
 	GL_state.Texture.SetActiveUnit(0);
 	GL_state.Texture.SetTarget(GL_TEXTURE_2D);
 	GL_state.Texture.Enable(Scene_color_texture);
 
-	opengl_draw_textured_quad(-1.0f, -1.0f, 0.0f, 0.0f, 1.0f, 1.0f, Scene_texture_u_scale, Scene_texture_u_scale);
+	if (bloom) {
+		Current_shader->program->Uniforms.setUniformi(SDR_UNIFORM("bloomed"), 1);
+		Current_shader->program->Uniforms.setUniformi(SDR_UNIFORM("levels"), MAX_MIP_BLUR_LEVELS);
+		Current_shader->program->Uniforms.setUniformf(SDR_UNIFORM("bloom_intensity"), Cmdline_bloom_intensity / 100.0f);
+		Current_shader->program->Uniforms.setUniform2f(SDR_UNIFORM("bloomScale"), 1.0f / Scene_texture_u_scale, 1.0f / Scene_texture_v_scale);
+
+		GL_state.Texture.SetActiveUnit(1);
+		GL_state.Texture.SetTarget(GL_TEXTURE_2D);
+		GL_state.Texture.Enable(Bloom_textures[0]);
+	}
+
+	opengl_draw_textured_quad(-1.0f, -1.0f, 0.0f, 0.0f, 1.0f, 1.0f, Scene_texture_u_scale, Scene_texture_v_scale);
+
+	if (bloom) {
+		opengl_release_transient_texture(Bloom_textures[0]);
+		Bloom_textures[0] = 0;
+	}
 }
 
 void opengl_post_pass_bloom()
@@ -103,8 +142,15 @@ void opengl_post_pass_bloom()
 	// we need the scissor test disabled
 	GLboolean scissor_test = GL_state.ScissorTest(GL_FALSE);
 
+	// width and height are 1/2 for the bright pass
+	int width = Post_texture_width >> 1;
+	int height = Post_texture_height >> 1;
+
+	// the first one is given back once the tonemapping added the bloom to the scene
+	Bloom_textures[0] = opengl_acquire_transient_texture(width, height, GL_RGBA16F, MAX_MIP_BLUR_LEVELS);
+	Bloom_textures[1] = opengl_acquire_transient_texture(width, height, GL_RGBA16F, MAX_MIP_BLUR_LEVELS);
+
 	// ------  begin bright pass ------
-	int width, height;
 	{
 		GR_DEBUG_SCOPE("Bloom bright pass");
 		TRACE_SCOPE(tracing::BloomBrightPass);
@@ -112,10 +158,6 @@ void opengl_post_pass_bloom()
 		GL_state.BindFrameBuffer(Bloom_framebuffer);
 		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, Bloom_textures[0], 0);
 
-		// width and height are 1/2 for the bright pass
-		width = Post_texture_width >> 1;
-		height = Post_texture_height >> 1;
-
 		glViewport(0, 0, width, height);
 
 		glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
@@ -123,13 +165,13 @@ void opengl_post_pass_bloom()
 
 		opengl_shader_set_current(gr_opengl_maybe_create_shader(SDR_TYPE_POST_PROCESS_BRIGHTPASS, 0));
 
-		Current_shader->program->Uniforms.setUniformi("tex", 0);
+		Current_shader->program->Uniforms.setUniformi(SDR_UNIFORM("tex"), 0);
 
 		GL_state.Texture.SetActiveUnit(0);
 		GL_state.Texture.SetTarget(GL_TEXTURE_2D);
 		GL_state.Texture.Enable(Scene_color_texture);
 
-		opengl_draw_textured_quad(-1.0f, -1.0f, 0.0f, 0.0f, 1.0f, 1.0f, 1.0f, 1.0f);
+		opengl_draw_textured_quad(-1.0f, -1.0f, 0.0f, 0.0f, 1.0f, 1.0f, Scene_texture_u_scale, Scene_texture_v_scale);
 	}
 	// ------ end bright pass ------
 
@@ -141,68 +183,47 @@ void opengl_post_pass_bloom()
 
 	glGenerateMipmap(GL_TEXTURE_2D);
 
-	for ( int iteration = 0; iteration < 2; iteration++) {
-		for (int pass = 0; pass < 2; pass++) {
-			GR_DEBUG_SCOPE("Bloom iteration step");
-			TRACE_SCOPE(tracing::BloomIterationStep);
+	// one iteration of both passes, see BLOOM_TAP_SIZE
+	for (int pass = 0; pass < 2; pass++) {
+		GR_DEBUG_SCOPE("Bloom iteration step");
+		TRACE_SCOPE(tracing::BloomIterationStep);
 
-			GLuint source_tex = Bloom_textures[pass];
-			GLuint dest_tex = Bloom_textures[1 - pass];
+		GLuint source_tex = Bloom_textures[pass];
+		GLuint dest_tex = Bloom_textures[1 - pass];
 
-			if (pass) {
-				opengl_shader_set_current(gr_opengl_maybe_create_shader(SDR_TYPE_POST_PROCESS_BLUR, SDR_FLAG_BLUR_HORIZONTAL));
-			} else {
-				opengl_shader_set_current(gr_opengl_maybe_create_shader(SDR_TYPE_POST_PROCESS_BLUR, SDR_FLAG_BLUR_VERTICAL));
-			}
+		if (pass) {
+			opengl_shader_set_current(gr_opengl_maybe_create_shader(SDR_TYPE_POST_PROCESS_BLUR, SDR_FLAG_BLUR_HORIZONTAL));
+		} else {
+			opengl_shader_set_current(gr_opengl_maybe_create_shader(SDR_TYPE_POST_PROCESS_BLUR, SDR_FLAG_BLUR_VERTICAL));
+		}
 
-			Current_shader->program->Uniforms.setUniformi("tex", 0);
+		Current_shader->program->Uniforms.setUniformi(SDR_UNIFORM("tex"), 0);
 
-			GL_state.Texture.SetActiveUnit(0);
-			GL_state.Texture.SetTarget(GL_TEXTURE_2D);
-			GL_state.Texture.Enable(source_tex);
+		GL_state.Texture.SetActiveUnit(0);
+		GL_state.Texture.SetTarget(GL_TEXTURE_2D);
+		GL_state.Texture.Enable(source_tex);
 
-			for (int mipmap = 0; mipmap < MAX_MIP_BLUR_LEVELS; ++mipmap) {
-				int bloom_width = width >> mipmap;
-				int bloom_height = height >> mipmap;
+		for (int mipmap = 0; mipmap < MAX_MIP_BLUR_LEVELS; ++mipmap) {
+			int bloom_width = width >> mipmap;
+			int bloom_height = height >> mipmap;
 
-				Current_shader->program->Uniforms.setUniformf("texSize", (pass) ? 1.0f / i2fl(bloom_width) : 1.0f / i2fl(bloom_height));
-				Current_shader->program->Uniforms.setUniformi("level", mipmap);
-				Current_shader->program->Uniforms.setUniformf("tapSize", 1.0f);
+			Current_shader->program->Uniforms.setUniformf(SDR_UNIFORM("texSize"), (pass) ? 1.0f / i2fl(bloom_width) : 1.0f / i2fl(bloom_height));
+			Current_shader->program->Uniforms.setUniformi(SDR_UNIFORM("level"), mipmap);
+			Current_shader->program->Uniforms.setUniformf(SDR_UNIFORM("tapSize"), BLOOM_TAP_SIZE);
 
-				glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, dest_tex, mipmap);
+			glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, dest_tex, mipmap);
 
-				glViewport(0, 0, bloom_width, bloom_height);
+			glViewport(0, 0, bloom_width, bloom_height);
 
-				opengl_draw_textured_quad(-1.0f, -1.0f, 0.0f, 0.0f, 1.0f, 1.0f, 1.0f, 1.0f);
-			}
+			opengl_draw_textured_quad(-1.0f, -1.0f, 0.0f, 0.0f, 1.0f, 1.0f, 1.0f, 1.0f);
 		}
 	}
 
-	// composite blur to the color texture
-	{
-		GR_DEBUG_SCOPE("Bloom composite step");
-		TRACE_SCOPE(tracing::BloomCompositeStep);
-
-		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, Scene_color_texture, 0);
-
-		opengl_shader_set_current(gr_opengl_maybe_create_shader(SDR_TYPE_POST_PROCESS_BLOOM_COMP, 0));
+	opengl_release_transient_texture(Bloom_textures[1]);
+	Bloom_textures[1] = 0;
 
-		Current_shader->program->Uniforms.setUniformi("tex", 0);
-		Current_shader->program->Uniforms.setUniformi("levels", MAX_MIP_BLUR_LEVELS);
-		Current_shader->program->Uniforms.setUniformf("bloom_intensity", Cmdline_bloom_intensity / 100.0f);
-
-		GL_state.Texture.SetActiveUnit(0);
-		GL_state.Texture.SetTarget(GL_TEXTURE_2D);
-		GL_state.Texture.Enable(Bloom_textures[0]);
-
-		GL_state.SetAlphaBlendMode(ALPHA_BLEND_ADDITIVE);
-
-		glViewport(0, 0, gr_screen.max_w, gr_screen.max_h);
-
-		opengl_draw_textured_quad(-1.0f, -1.0f, 0.0f, 0.0f, 1.0f, 1.0f, 1.0f, 1.0f);
-
-		GL_state.SetAlphaBlendMode(ALPHA_BLEND_NONE);
-	}
+	// the bloom is added to the scene by the tonemapping
+	glViewport(0, 0, gr_screen.max_w, gr_screen.max_h);
 
 	// ------ end blur pass --------
 
@@ -259,21 +280,9 @@ void opengl_post_pass_fxaa() {
 
 	// We only want to draw to ATTACHMENT0
 	glDrawBuffer(GL_COLOR_ATTACHMENT0);
-	glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+	GL_state.ColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
 
-	// Do a prepass to convert the main shaders' RGBA output into RGBL
-	opengl_shader_set_current( gr_opengl_maybe_create_shader(SDR_TYPE_POST_PROCESS_FXAA_PREPASS, 0) );
-
-	// basic/default uniforms
-	Current_shader->program->Uniforms.setUniformi( "tex", 0 );
-
-	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, Scene_luminance_texture, 0);
-
-	GL_state.Texture.SetActiveUnit(0);
-	GL_state.Texture.SetTarget(GL_TEXTURE_2D);
-	GL_state.Texture.Enable(Scene_ldr_texture);
-
-	opengl_draw_textured_quad(-1.0f, -1.0f, 0.0f, 0.0f, 1.0f, 1.0f, Scene_texture_u_scale, Scene_texture_u_scale);
+	// the tonemapping already wrote the RGBL input into the luminance texture
 
 	// set and configure post shader ..
 	opengl_shader_set_current( gr_opengl_maybe_create_shader(SDR_TYPE_POST_PROCESS_FXAA, 0) );
@@ -281,15 +290,15 @@ void opengl_post_pass_fxaa() {
 	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, Scene_ldr_texture, 0);
 
 	// basic/default uniforms
-	Current_shader->program->Uniforms.setUniformi( "tex0", 0 );
-	Current_shader->program->Uniforms.setUniformf( "rt_w", static_cast<float>(Post_texture_width));
-	Current_shader->program->Uniforms.setUniformf( "rt_h", static_cast<float>(Post_texture_height));
+	Current_shader->program->Uniforms.setUniformi( SDR_UNIFORM("tex0"), 0 );
+	Current_shader->program->Uniforms.setUniformf( SDR_UNIFORM("rt_w"), static_cast<float>(Post_texture_width));
+	Current_shader->program->Uniforms.setUniformf( SDR_UNIFORM("rt_h"), static_cast<float>(Post_texture_height));
 
 	GL_state.Texture.SetActiveUnit(0);
 	GL_state.Texture.SetTarget(GL_TEXTURE_2D);
 	GL_state.Texture.Enable(Scene_luminance_texture);
 
-	opengl_draw_textured_quad(-1.0f, -1.0f, 0.0f, 0.0f, 1.0f, 1.0f, Scene_texture_u_scale, Scene_texture_u_scale);
+	opengl_draw_textured_quad(-1.0f, -1.0f, 0.0f, 0.0f, 1.0f, 1.0f, Scene_texture_u_scale, Scene_texture_v_scale);
 
 	opengl_shader_set_current();
 }
@@ -330,14 +339,14 @@ void opengl_post_lightshafts()
 
 				x = asinf(vm_vec_dot(&light_dir, &Eye_matrix.vec.rvec)) / PI*1.5f + 0.5f; //cant get the coordinates right but this works for the limited glare fov
 				y = asinf(vm_vec_dot(&light_dir, &Eye_matrix.vec.uvec)) / PI*1.5f*gr_screen.clip_aspect + 0.5f;
-				Current_shader->program->Uniforms.setUniform2f("sun_pos", x, y);
-				Current_shader->program->Uniforms.setUniformi("scene", 0);
-				Current_shader->program->Uniforms.setUniformi("cockpit", 1);
-				Current_shader->program->Uniforms.setUniformf("density", ls_density);
-				Current_shader->program->Uniforms.setUniformf("falloff", ls_falloff);
-				Current_shader->program->Uniforms.setUniformf("weight", ls_weight);
-				Current_shader->program->Uniforms.setUniformf("intensity", Sun_spot * ls_intensity);
-				Current_shader->program->Uniforms.setUniformf("cp_intensity", Sun_spot * ls_cpintensity);
+				Current_shader->program->Uniforms.setUniform2f(SDR_UNIFORM("sun_pos"), x * Scene_texture_u_scale, y * Scene_texture_v_scale);
+				Current_shader->program->Uniforms.setUniformi(SDR_UNIFORM("scene"), 0);
+				Current_shader->program->Uniforms.setUniformi(SDR_UNIFORM("cockpit"), 1);
+				Current_shader->program->Uniforms.setUniformf(SDR_UNIFORM("density"), ls_density);
+				Current_shader->program->Uniforms.setUniformf(SDR_UNIFORM("falloff"), ls_falloff);
+				Current_shader->program->Uniforms.setUniformf(SDR_UNIFORM("weight"), ls_weight);
+				Current_shader->program->Uniforms.setUniformf(SDR_UNIFORM("intensity"), Sun_spot * ls_intensity);
+				Current_shader->program->Uniforms.setUniformf(SDR_UNIFORM("cp_intensity"), Sun_spot * ls_cpintensity);
 
 				GL_state.Texture.SetActiveUnit(0);
 				GL_state.Texture.SetTarget(GL_TEXTURE_2D);
@@ -348,7 +357,7 @@ void opengl_post_lightshafts()
 				GL_state.Blend(GL_TRUE);
 				GL_state.SetAlphaBlendMode(ALPHA_BLEND_ADDITIVE);
 
-				opengl_draw_textured_quad(-1.0f, -1.0f, 0.0f, 0.0f, 1.0f, 1.0f, Scene_texture_u_scale, Scene_texture_u_scale);
+				opengl_draw_textured_quad(-1.0f, -1.0f, 0.0f, 0.0f, 1.0f, 1.0f, Scene_texture_u_scale, Scene_texture_v_scale);
 
 				GL_state.Blend(GL_FALSE);
 				break;
@@ -372,16 +381,21 @@ void gr_opengl_post_process_end()
 
 	GL_state.PushFramebufferState();
 	
+	bool bloom = Cmdline_bloom_intensity > 0;
+	bool fxaa = Cmdline_fxaa && !fxaa_unavailable && !GL_rendering_to_texture;
+
 	// do bloom, hopefully ;)
-	opengl_post_pass_bloom();
+	if (bloom) {
+		opengl_post_pass_bloom();
+	}
 
 	// do tone mapping
-	opengl_post_pass_tonemap();
+	opengl_post_pass_tonemap(bloom, fxaa);
 
-    // Do FXAA
-    if (Cmdline_fxaa && !fxaa_unavailable && !GL_rendering_to_texture) {
-        opengl_post_pass_fxaa();
-    }
+	// Do FXAA
+	if (fxaa) {
+		opengl_post_pass_fxaa();
+	}
 
 	// render lightshafts
 	opengl_post_lightshafts();
@@ -413,9 +427,9 @@ void gr_opengl_post_process_end()
 	opengl_shader_set_current(post_sdr_handle);
 
 	// basic/default uniforms
-	Current_shader->program->Uniforms.setUniformi( "tex", 0 );
-	Current_shader->program->Uniforms.setUniformi( "depth_tex", 1);
-	Current_shader->program->Uniforms.setUniformf( "timer", static_cast<float>(timer_get_milliseconds() % 100 + 1) );
+	Current_shader->program->Uniforms.setUniformi( SDR_UNIFORM("tex"), 0 );
+	Current_shader->program->Uniforms.setUniformi( SDR_UNIFORM("depth_tex"), 1);
+	Current_shader->program->Uniforms.setUniformf( SDR_UNIFORM("timer"), static_cast<float>(timer_get_milliseconds() % 100 + 1) );
 
 	for (size_t idx = 0; idx < Post_effects.size(); idx++) {
 		if ( GL_shader[post_sdr_handle].flags & (1<<idx) ) {
@@ -427,6 +441,7 @@ void gr_opengl_post_process_end()
 	}
 
 	// now render it to the screen ...
+	opengl_scene_resolution_restore();
 	GL_state.PopFramebufferState();
 	GL_state.Texture.SetActiveUnit(0);
 	GL_state.Texture.SetTarget(GL_TEXTURE_2D);
@@ -437,7 +452,7 @@ void gr_opengl_post_process_end()
 	GL_state.Texture.SetTarget(GL_TEXTURE_2D);
 	GL_state.Texture.Enable(Scene_depth_texture);
 
-	opengl_draw_textured_quad(-1.0f, -1.0f, 0.0f, 0.0f, 1.0f, 1.0f, Scene_texture_u_scale, Scene_texture_u_scale);
+	opengl_draw_textured_quad(-1.0f, -1.0f, 0.0f, 0.0f, 1.0f, 1.0f, Scene_texture_u_scale, Scene_texture_v_scale);
 
 	//Shadow Map debug window
 //#define SHADOW_DEBUG
@@ -452,7 +467,7 @@ void gr_opengl_post_process_end()
 	GL_state.Texture.Enable(Shadow_map_texture);
 	glUniform1iARB( opengl_shader_get_uniform("shadow_map"), 0);
 	glUniform1iARB( opengl_shader_get_uniform("index"), 0);
-	//opengl_draw_textured_quad(-1.0f, -1.0f, 0.0f, 0.0f, -0.5f, -0.5f, Scene_texture_u_scale, Scene_texture_u_scale);
+	//opengl_draw_textured_quad(-1.0f, -1.0f, 0.0f, 0.0f, -0.5f, -0.5f, Scene_texture_u_scale, Scene_texture_v_scale);
 	//opengl_draw_textured_quad(-1.0f, -1.0f, 0.0f, 0.0f, -0.5f, -0.5f, 0.5f, 0.5f);
 	opengl_draw_textured_quad(-1.0f, -1.0f, 0.0f, 0.0f, -0.5f, -0.5f, 1.0f, 1.0f);
 	glUniform1iARB( opengl_shader_get_uniform("index"), 1);
@@ -476,19 +491,19 @@ void gr_opengl_post_process_end()
 	GL_state.Texture.SetTarget(GL_TEXTURE_2D);
 	GL_state.Texture.Enable(Scene_effect_texture);
 
-	opengl_draw_textured_quad(0.0f, -1.0f, 0.0f, 0.0f, 1.0f, 0.0f, Scene_texture_u_scale, Scene_texture_u_scale);
+	opengl_draw_textured_quad(0.0f, -1.0f, 0.0f, 0.0f, 1.0f, 0.0f, Scene_texture_u_scale, Scene_texture_v_scale);
 
 	GL_state.Texture.SetActiveUnit(0);
 	GL_state.Texture.SetTarget(GL_TEXTURE_2D);
 	GL_state.Texture.Enable(Scene_normal_texture);
 
-	opengl_draw_textured_quad(-1.0f, -0.0f, 0.0f, 0.0f, 0.0f, 1.0f, Scene_texture_u_scale, Scene_texture_u_scale);
+	opengl_draw_textured_quad(-1.0f, -0.0f, 0.0f, 0.0f, 0.0f, 1.0f, Scene_texture_u_scale, Scene_texture_v_scale);
 
 	GL_state.Texture.SetActiveUnit(0);
 	GL_state.Texture.SetTarget(GL_TEXTURE_2D);
 	GL_state.Texture.Enable(Scene_specular_texture);
 
-	opengl_draw_textured_quad(0.0f, -0.0f, 0.0f, 0.0f, 1.0f, 1.0f, Scene_texture_u_scale, Scene_texture_u_scale);
+	opengl_draw_textured_quad(0.0f, -0.0f, 0.0f, 0.0f, 1.0f, 1.0f, Scene_texture_u_scale, Scene_texture_v_scale);
 	*/
 
 	GL_state.Texture.SetShaderMode(GL_FALSE);
@@ -832,13 +847,13 @@ bool opengl_post_init_shaders()
 	if ( gr_opengl_maybe_create_shader(SDR_TYPE_POST_PROCESS_BRIGHTPASS, 0) < 0 || 
 		gr_opengl_maybe_create_shader(SDR_TYPE_POST_PROCESS_BLUR, SDR_FLAG_BLUR_HORIZONTAL) < 0 || 
 		gr_opengl_maybe_create_shader(SDR_TYPE_POST_PROCESS_BLUR, SDR_FLAG_BLUR_VERTICAL) < 0 ||
-		gr_opengl_maybe_create_shader(SDR_TYPE_POST_PROCESS_BLOOM_COMP, 0) < 0) {
+		gr_opengl_maybe_create_shader(SDR_TYPE_POST_PROCESS_TONEMAPPING, SDR_FLAG_TONEMAPPING_BLOOM) < 0) {
 		// disable bloom if we don't have those shaders available
 		Cmdline_bloom_intensity = 0;
 	}
 
 	if ( gr_opengl_maybe_create_shader(SDR_TYPE_POST_PROCESS_FXAA, 0) < 0 ||
-		gr_opengl_maybe_create_shader(SDR_TYPE_POST_PROCESS_FXAA_PREPASS, 0) < 0 ) {
+		gr_opengl_maybe_create_shader(SDR_TYPE_POST_PROCESS_TONEMAPPING, SDR_FLAG_TONEMAPPING_LUMA) < 0 ) {
 		Cmdline_fxaa = false;
 		fxaa_unavailable = true;
 		mprintf(("Error while compiling FXAA shaders. FXAA will be unavailable.\n"));
@@ -852,31 +867,7 @@ void opengl_setup_bloom_textures()
 	// two more framebuffers, one each for the two different sized bloom textures
 	glGenFramebuffers(1, &Bloom_framebuffer);
 
-	// need to generate textures for bloom too
-	glGenTextures(2, Bloom_textures);
-
-	// half size
-	int width = Post_texture_width >> 1;
-	int height = Post_texture_height >> 1;
-
-	for (int tex = 0; tex < 2; tex++) {
-		GL_state.Texture.SetActiveUnit(0);
-		GL_state.Texture.SetTarget(GL_TEXTURE_2D);
-		GL_state.Texture.Enable(Bloom_textures[tex]);
-
-		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA16F, width, height, 0, GL_BGRA, GL_UNSIGNED_INT_8_8_8_8_REV, NULL);
-
-		glGenerateMipmap(GL_TEXTURE_2D);
-
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, MAX_MIP_BLUR_LEVELS-1);
-	}
-
-	GL_state.BindFrameBuffer(0);
+	// the textures are transient and only taken while the bloom is drawn, see opengl_post_pass_bloom()
 }
 
 // generate and test the framebuffer and textures that we are going to use
@@ -968,16 +959,6 @@ static bool opengl_post_init_framebuffer()
 
 void opengl_post_process_shutdown_bloom()
 {
-	if ( Bloom_textures[0] ) {
-		glDeleteTextures(1, &Bloom_textures[0]);
-		Bloom_textures[0] = 0;
-	}
-
-	if ( Bloom_textures[1] ) {
-		glDeleteTextures(1, &Bloom_textures[1]);
-		Bloom_textures[1] = 0;
-	}
-
 	if ( Bloom_framebuffer > 0 ) {
 		glDeleteFramebuffers(1, &Bloom_framebuffer);
 		Bloom_framebuffer = 0;
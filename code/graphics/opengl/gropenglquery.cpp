@@ -1,82 +1,113 @@
-
-#include "graphics/opengl/gropenglquery.h"
-#include "graphics/opengl/gropengl.h"
-
-namespace {
-
-struct query_object_slot {
-	bool used = false;
-	GLuint name = 0;
-};
-
-SCP_vector<query_object_slot> query_objects;
-
-int get_new_query_slot() {
-	auto end = query_objects.end();
-	for (auto iter = query_objects.begin(); iter != end; ++iter) {
-		if (!iter->used) {
-			return (int) std::distance(query_objects.begin(), iter);
-		}
-	}
-
-	query_objects.emplace_back();
-	return (int) (query_objects.size() - 1);
-}
-
-query_object_slot& get_query_slot(int handle) {
-	Assertion(handle >= 0 && handle < (int)query_objects.size(), "Query object index %d is invalid!", handle);
-	return query_objects[handle];
-}
-
-}
-
-int gr_opengl_create_query_object() {
-	auto idx = get_new_query_slot();
-
-	auto& slot = query_objects[idx];
-	slot.used = true;
-
-	glGenQueries(1, &slot.name);
-
-	return idx;
-}
-
-void gr_opengl_query_value(int obj, QueryType type) {
-	auto& slot = get_query_slot(obj);
-
-	switch(type) {
-		case QueryType::Timestamp:
-			Assertion(GL_version >= 33, "Timestamp queries are only available from OpenGL 3.3 onwards.");
-			glQueryCounter(slot.name, GL_TIMESTAMP);
-			break;
-		default:
-			Assertion(false, "Unhandled enum value!");
-			break;
-	}
-}
-
-bool gr_opengl_query_value_available(int obj) {
-	auto& slot = get_query_slot(obj);
-
-	GLuint available;
-	glGetQueryObjectuiv(slot.name, GL_QUERY_RESULT_AVAILABLE, &available);
-
-	return available == GL_TRUE;
-}
-
-std::uint64_t gr_opengl_get_query_value(int obj) {
-	auto& slot = get_query_slot(obj);
-
-	GLuint64 available;
-	glGetQueryObjectui64v(slot.name, GL_QUERY_RESULT, &available);
-
-	return available;
-}
-
-void gr_opengl_delete_query_object(int obj) {
-	auto& slot = get_query_slot(obj);
-	glDeleteQueries(1, &slot.name);
-
-	slot.name = 0;
-	slot.used = false;
-}
+
+#include "graphics/opengl/gropenglquery.h"
+#include "graphics/opengl/gropengl.h"
+
+namespace {
+
+struct query_object_slot {
+	bool used = false;
+	GLuint name = 0;
+	GLenum active_target = GL_NONE; // The target of the query while it is between begin and end
+};
+
+SCP_vector<query_object_slot> query_objects;
+
+int get_new_query_slot() {
+	auto end = query_objects.end();
+	for (auto iter = query_objects.begin(); iter != end; ++iter) {
+		if (!iter->used) {
+			return (int) std::distance(query_objects.begin(), iter);
+		}
+	}
+
+	query_objects.emplace_back();
+	return (int) (query_objects.size() - 1);
+}
+
+query_object_slot& get_query_slot(int handle) {
+	Assertion(handle >= 0 && handle < (int)query_objects.size(), "Query object index %d is invalid!", handle);
+	return query_objects[handle];
+}
+
+}
+
+int gr_opengl_create_query_object() {
+	auto idx = get_new_query_slot();
+
+	auto& slot = query_objects[idx];
+	slot.used = true;
+
+	glGenQueries(1, &slot.name);
+
+	return idx;
+}
+
+void gr_opengl_query_value(int obj, QueryType type) {
+	auto& slot = get_query_slot(obj);
+
+	switch(type) {
+		case QueryType::Timestamp:
+			Assertion(GL_version >= 33, "Timestamp queries are only available from OpenGL 3.3 onwards.");
+			glQueryCounter(slot.name, GL_TIMESTAMP);
+			break;
+		case QueryType::Occlusion:
+			Assertion(false, "Occlusion queries need to be used with gr_begin_query() and gr_end_query()!");
+			break;
+		default:
+			Assertion(false, "Unhandled enum value!");
+			break;
+	}
+}
+
+bool gr_opengl_query_value_available(int obj) {
+	auto& slot = get_query_slot(obj);
+
+	GLuint available;
+	glGetQueryObjectuiv(slot.name, GL_QUERY_RESULT_AVAILABLE, &available);
+
+	return available == GL_TRUE;
+}
+
+std::uint64_t gr_opengl_get_query_value(int obj) {
+	auto& slot = get_query_slot(obj);
+
+	GLuint64 available;
+	glGetQueryObjectui64v(slot.name, GL_QUERY_RESULT, &available);
+
+	return available;
+}
+
+void gr_opengl_begin_query(int obj, QueryType type) {
+	auto& slot = get_query_slot(obj);
+
+	Assertion(slot.active_target == GL_NONE, "Query object %d has already been started!", obj);
+
+	switch(type) {
+		case QueryType::Occlusion:
+			// Only visibility matters so the cheaper boolean query is used where it is available
+			slot.active_target = GL_version >= 33 ? GL_ANY_SAMPLES_PASSED : GL_SAMPLES_PASSED;
+			break;
+		default:
+			Assertion(false, "Query type can't be used with gr_begin_query()!");
+			return;
+	}
+
+	glBeginQuery(slot.active_target, slot.name);
+}
+
+void gr_opengl_end_query(int obj) {
+	auto& slot = get_query_slot(obj);
+
+	Assertion(slot.active_target != GL_NONE, "Query object %d has not been started!", obj);
+
+	glEndQuery(slot.active_target);
+	slot.active_target = GL_NONE;
+}
+
+void gr_opengl_delete_query_object(int obj) {
+	auto& slot = get_query_slot(obj);
+	glDeleteQueries(1, &slot.name);
+
+	slot.name = 0;
+	slot.used = false;
+}
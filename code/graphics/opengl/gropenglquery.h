@@ -1,9 +1,9 @@
-
-#ifndef _GROPENGLQUERY_H
-#define _GROPENGLQUERY_H
-#pragma once
-
-#include "graphics/2d.h"
+
+#ifndef _GROPENGLQUERY_H
+#define _GROPENGLQUERY_H
+#pragma once
+
+#include "graphics/2d.h"
 
 int gr_opengl_create_query_object();
 
@@ -13,6 +13,10 @@ bool gr_opengl_query_value_available(int obj);
 
 std::uint64_t gr_opengl_get_query_value(int obj);
 
-void gr_opengl_delete_query_object(int obj);
-
-#endif // _GROPENGLQUERY_H
+void gr_opengl_begin_query(int obj, QueryType type);
+
+void gr_opengl_end_query(int obj);
+
+void gr_opengl_delete_query_object(int obj);
+
+#endif // _GROPENGLQUERY_H
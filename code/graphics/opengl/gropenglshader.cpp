@@ -12,6 +12,7 @@
 #include "def_files/def_files.h"
 #include "graphics/2d.h"
 #include "graphics/grinternal.h"
+#include "graphics/opengl/gropengl.h"
 #include "graphics/opengl/gropengldraw.h"
 #include "graphics/opengl/gropengllight.h"
 #include "graphics/opengl/gropenglpostprocessing.h"
@@ -23,6 +24,7 @@
 #include "math/vecmat.h"
 #include "mod_table/mod_table.h"
 #include "render/3d.h"
+#include "tracing/StartupProfiler.h"
 
 #include <md5.h>
 #include <jansson.h>
@@ -68,10 +70,6 @@ static opengl_shader_type_t GL_shader_types[] = {
 		{ "tex", "texSize", "level", "tapSize", "debug" },
 		{ opengl_vert_attrib::POSITION, opengl_vert_attrib::TEXCOORD }, "Gaussian Blur" },
 
-	{ SDR_TYPE_POST_PROCESS_BLOOM_COMP, "post-v.sdr", "bloom-comp-f.sdr", 0, 
-		{ "bloomed", "bloom_intensity", "levels" },
-		{ opengl_vert_attrib::POSITION, opengl_vert_attrib::TEXCOORD }, "Bloom Compositing" },
-
 	{ SDR_TYPE_POST_PROCESS_BRIGHTPASS, "post-v.sdr", "brightpass-f.sdr", 0, 
 		{ "tex" },
 		{ opengl_vert_attrib::POSITION, opengl_vert_attrib::TEXCOORD }, "Bloom Brightpass" },
@@ -80,10 +78,6 @@ static opengl_shader_type_t GL_shader_types[] = {
 		{ "tex0", "rt_w", "rt_h" },
 		{ opengl_vert_attrib::POSITION }, "FXAA" },
 
-	{ SDR_TYPE_POST_PROCESS_FXAA_PREPASS, "post-v.sdr", "fxaapre-f.sdr", 0, 
-		{ "tex" },
-		{ opengl_vert_attrib::POSITION, opengl_vert_attrib::TEXCOORD }, "FXAA Prepass" },
-
 	{ SDR_TYPE_POST_PROCESS_LIGHTSHAFTS, "post-v.sdr", "ls-f.sdr", 0, 
 		{ "scene", "cockpit", "sun_pos", "weight", "intensity", "falloff", "density", "cp_intensity" },
 		{ opengl_vert_attrib::POSITION, opengl_vert_attrib::TEXCOORD }, "Lightshafts" },
@@ -110,8 +104,16 @@ static opengl_shader_type_t GL_shader_types[] = {
 		{ opengl_vert_attrib::POSITION, opengl_vert_attrib::TEXCOORD, opengl_vert_attrib::COLOR }, "Passthrough" },
 
 	{ SDR_TYPE_SHIELD_DECAL, "shield-impact-v.sdr",	"shield-impact-f.sdr", 0,
-		{ "modelViewMatrix", "projMatrix", "shieldMap", "shieldModelViewMatrix", "shieldProjMatrix", "hitNormal", "srgb", "color" }, 
-		{ opengl_vert_attrib::POSITION, opengl_vert_attrib::NORMAL }, "Shield Decals" }
+		{ "modelViewMatrix", "projMatrix", "shieldMap", "shieldModelViewMatrix", "shieldProjMatrix", "hitNormal", "numImpacts", "blendAlpha", "srgb", "color" }, 
+		{ opengl_vert_attrib::POSITION, opengl_vert_attrib::NORMAL }, "Shield Decals" },
+
+	{ SDR_TYPE_DECAL, "decal-v.sdr", "decal-f.sdr", 0,
+		{ "decalMap", "NormalBuffer", "PositionBuffer", "decalData", "tileData", "tileSize", "numTilesX", "invScreenWidth", "invScreenHeight", "srgb" },
+		{ opengl_vert_attrib::POSITION }, "Decals" },
+
+	{ SDR_TYPE_BACKGROUND_CUBEMAP, "background-cubemap-v.sdr", "background-cubemap-f.sdr", 0,
+		{ "cubemap", "envMatrix", "projScale" },
+		{ opengl_vert_attrib::POSITION }, "Background Cubemap" }
 };
 
 /**
@@ -180,7 +182,7 @@ static opengl_shader_variant_t GL_shader_variants[] = {
 		"Thruster scaling" },
 	
 	{ SDR_TYPE_MODEL, false, SDR_FLAG_MODEL_TRANSFORM, "FLAG_TRANSFORM", 
-		{ "transform_tex", "buffer_matrix_offset" }, {  },
+		{ "transform_tex", "buffer_matrix_offset", "buffer_matrix_stride" }, {  },
 		"Submodel Transforms" },
 	
 	{ SDR_TYPE_MODEL, false, SDR_FLAG_MODEL_CLIP, "FLAG_CLIP", 
@@ -203,9 +205,25 @@ static opengl_shader_variant_t GL_shader_variants[] = {
 		{ "extrudeWidth" }, { },
 		"Normal Extrusion" },
 
+	{ SDR_TYPE_MODEL, false, SDR_FLAG_MODEL_TEXTURE_ARRAYS, "FLAG_TEXTURE_ARRAYS",
+		{ "baseLayer", "glowLayer", "specLayer", "normalLayer", "ambientLayer", "miscLayer" }, { },
+		"Texture Arrays" },
+
+	{ SDR_TYPE_MODEL, false, SDR_FLAG_MODEL_DEPTH_PREPASS, "FLAG_DEPTH_PREPASS",
+		{ }, { },
+		"Depth pre-pass" },
+
 	{ SDR_TYPE_EFFECT_PARTICLE, true, SDR_FLAG_PARTICLE_POINT_GEN, "FLAG_EFFECT_GEOMETRY", 
 		{ }, { opengl_vert_attrib::UVEC },
 		"Geometry shader point-based particles" },
+
+	{ SDR_TYPE_EFFECT_PARTICLE, true, SDR_FLAG_PARTICLE_GPU_SIM, "FLAG_EFFECT_GPU_SIM",
+		{ "particleTime", "frameLifeRange" }, { opengl_vert_attrib::NORMAL },
+		"GPU simulated particles" },
+
+	{ SDR_TYPE_EFFECT_PARTICLE, true, SDR_FLAG_PARTICLE_NEBULA_POOF, "FLAG_EFFECT_NEBULA_POOF",
+		{ "particleTime", "poofShells", "poofBreak", "viewerBank" }, { },
+		"Nebula poofs" },
 	
 	{ SDR_TYPE_POST_PROCESS_BLUR, false, SDR_FLAG_BLUR_HORIZONTAL, "PASS_0", 
 		{ }, {  },
@@ -213,19 +231,48 @@ static opengl_shader_variant_t GL_shader_variants[] = {
 	
 	{ SDR_TYPE_POST_PROCESS_BLUR, false, SDR_FLAG_BLUR_VERTICAL, "PASS_1", 
 		{ }, {  },
-		"Vertical blur pass" }
+		"Vertical blur pass" },
+
+	{ SDR_TYPE_POST_PROCESS_TONEMAPPING, false, SDR_FLAG_TONEMAPPING_BLOOM, "FLAG_BLOOM",
+		{ "bloomed", "bloom_intensity", "levels", "bloomScale" }, {  },
+		"Tonemapping with bloom" },
+
+	{ SDR_TYPE_POST_PROCESS_TONEMAPPING, false, SDR_FLAG_TONEMAPPING_LUMA, "FLAG_LUMA",
+		{ }, {  },
+		"Tonemapping with luma for FXAA" },
+
+	{ SDR_TYPE_DEFERRED_LIGHTING, false, SDR_FLAG_DEFERRED_TILED, "FLAG_TILED",
+		{ "lightData", "tileData", "tileSize", "numTilesX" }, {  },
+		"Tiled lighting" }
 };
 
 static const int GL_num_shader_variants = sizeof(GL_shader_variants) / sizeof(opengl_shader_variant_t);
 
 opengl_shader_t *Current_shader = NULL;
 
+// while this is set new shaders are only handed to the driver which compiles them in the background, see
+// opengl_shader_precompile_begin()
+static bool Shader_precompile = false;
+
+// The maps of a model material only add to what its shader does so a variant with a part of the maps can draw the
+// material while its own variant is still being compiled. This is as close as this gets to an uber-shader.
+static const uint Model_map_flags = SDR_FLAG_MODEL_DIFFUSE_MAP | SDR_FLAG_MODEL_GLOW_MAP | SDR_FLAG_MODEL_SPEC_MAP
+	| SDR_FLAG_MODEL_NORMAL_MAP | SDR_FLAG_MODEL_HEIGHT_MAP | SDR_FLAG_MODEL_ENV_MAP | SDR_FLAG_MODEL_MISC_MAP
+	| SDR_FLAG_MODEL_AMBIENT_MAP | SDR_FLAG_MODEL_TEAMCOLOR;
+
+static void opengl_shader_finish_compile(opengl_shader_t *shader_obj);
+
 /**
  * Set the currently active shader
  * @param shader_obj	Pointer to an opengl_shader_t object. This function calls glUseProgramARB with parameter 0 if shader_obj is NULL or if function is called without parameters, causing OpenGL to revert to fixed-function processing
  */
 void opengl_shader_set_current(opengl_shader_t *shader_obj)
 {
+	if (shader_obj && shader_obj->compiling) {
+		// the uniforms of the program are only known once it's linked
+		opengl_shader_finish_compile(shader_obj);
+	}
+
 	if (Current_shader != shader_obj) {
 		GR_DEBUG_SCOPE("Set shader");
 
@@ -249,6 +296,58 @@ void opengl_shader_set_current(int handle)
 	opengl_shader_set_current(&GL_shader[handle]);
 }
 
+static int opengl_shader_count_maps(uint flags)
+{
+	int count = 0;
+
+	for (flags &= Model_map_flags; flags != 0; flags &= flags - 1) {
+		++count;
+	}
+
+	return count;
+}
+
+/**
+ * Finds a compiled model shader which can draw the materials of a shader that is still being compiled
+ *
+ * @return Index into GL_shader or -1 if there is no such shader
+ */
+static int opengl_shader_find_fallback(const opengl_shader_t& shader_obj)
+{
+	if (shader_obj.shader != SDR_TYPE_MODEL) {
+		return -1;
+	}
+
+	int fallback = -1;
+	int fallback_maps = -1;
+
+	for (size_t i = 0; i < GL_shader.size(); ++i) {
+		auto& other = GL_shader[i];
+
+		if (other.shader != SDR_TYPE_MODEL || other.compiling) {
+			continue;
+		}
+
+		// everything but the maps has to match and the fallback may not use a map the material doesn't have
+		if ((other.flags & ~Model_map_flags) != (shader_obj.flags & ~Model_map_flags) || (other.flags & ~shader_obj.flags)) {
+			continue;
+		}
+
+		// the depth pre-pass has to discard the same fragments as the G-buffer pass which is drawn with its depth
+		if ((shader_obj.flags & SDR_FLAG_MODEL_DEPTH_PREPASS) && ((other.flags ^ shader_obj.flags) & SDR_FLAG_MODEL_DIFFUSE_MAP)) {
+			continue;
+		}
+
+		auto maps = opengl_shader_count_maps(other.flags);
+		if (maps > fallback_maps) {
+			fallback = (int)i;
+			fallback_maps = maps;
+		}
+	}
+
+	return fallback;
+}
+
 /**
  * Given a set of flags, determine whether a shader with these flags exists within the GL_shader vector. If no shader with the requested flags exists, attempt to compile one.
  *
@@ -263,6 +362,21 @@ int gr_opengl_maybe_create_shader(shader_type shader_t, unsigned int flags)
 
 	for (idx = 0; idx < max; idx++) {
 		if (GL_shader[idx].shader == shader_t && GL_shader[idx].flags == flags) {
+			auto& shader_obj = GL_shader[idx];
+
+			// while the mission loads this only asks for the shader to be compiled so it doesn't have to be ready
+			if (shader_obj.compiling && !Shader_precompile) {
+				if (!shader_obj.program->isLinkComplete()) {
+					auto fallback = opengl_shader_find_fallback(shader_obj);
+
+					if (fallback >= 0) {
+						return fallback;
+					}
+				}
+
+				opengl_shader_finish_compile(&shader_obj);
+			}
+
 			return (int)idx;
 		}
 	}
@@ -280,6 +394,8 @@ void opengl_delete_shader(int sdr_handle)
 
 	GL_shader[sdr_handle].flags = 0;
 	GL_shader[sdr_handle].flags2 = 0;
+	GL_shader[sdr_handle].compiling = false;
+	GL_shader[sdr_handle].binary_hash.clear();
 	GL_shader[sdr_handle].shader = NUM_SHADER_TYPES;
 }
 
@@ -518,6 +634,78 @@ static void cache_program_binary(GLuint program, const SCP_string& hash) {
 	cfclose(binary_fp);
 }
 
+/**
+ * Initializes the uniforms and attributes of a linked program
+ */
+static void opengl_shader_init_program(opengl_shader_t *shader_obj)
+{
+	opengl_shader_type_t *sdr_info = &GL_shader_types[shader_obj->shader];
+
+	opengl_shader_set_current(shader_obj);
+
+	// initialize uniforms and attributes
+	for (auto& unif : sdr_info->uniforms) {
+		shader_obj->program->Uniforms.initUniform(unif);
+	}
+
+	for (auto& attr : sdr_info->attributes) {
+		shader_obj->program->initAttribute(GL_vertex_attrib_info[attr].name, GL_vertex_attrib_info[attr].default_value);
+	}
+
+	// if this shader is POST_PROCESS_MAIN, hack in the user-defined flags
+	if ( sdr_info->type_id == SDR_TYPE_POST_PROCESS_MAIN ) {
+		opengl_post_init_uniforms(shader_obj->flags);
+	}
+
+	mprintf(("Shader Variant Features:\n"));
+
+	// initialize all uniforms and attributes that are specific to this variant
+	for ( int i = 0; i < GL_num_shader_variants; ++i ) {
+		opengl_shader_variant_t &variant = GL_shader_variants[i];
+
+		if ( sdr_info->type_id == variant.type_id && variant.flag & shader_obj->flags ) {
+			for (auto& unif : variant.uniforms) {
+				shader_obj->program->Uniforms.initUniform(unif);
+			}
+
+			for (auto& attr : variant.attributes) {
+				auto& attr_info = GL_vertex_attrib_info[attr];
+				shader_obj->program->initAttribute(attr_info.name, attr_info.default_value);
+			}
+
+			mprintf(("	%s\n", variant.description));
+		}
+	}
+
+	opengl_shader_set_current();
+}
+
+/**
+ * Waits for a program the driver compiles in the background and initializes it
+ */
+static void opengl_shader_finish_compile(opengl_shader_t *shader_obj)
+{
+	GR_DEBUG_SCOPE("Finishing shader compile");
+
+	Assert(shader_obj->compiling);
+	shader_obj->compiling = false;
+
+	mprintf(("Finishing shader:\n"));
+	mprintf(("	%s\n", GL_shader_types[shader_obj->shader].description));
+
+	try {
+		shader_obj->program->finishLink();
+	} catch (const std::exception&) {
+		// Since all shaders are required a compilation failure is a fatal error
+		Error(LOCATION, "A shader failed to compile! Check the debug log for more information.");
+	}
+
+	cache_program_binary(shader_obj->program->getShaderHandle(), shader_obj->binary_hash);
+	shader_obj->binary_hash.clear();
+
+	opengl_shader_init_program(shader_obj);
+}
+
 /**
  * Compiles a new shader, and creates an opengl_shader_t that will be put into the GL_shader vector
  * if compilation is successful.
@@ -568,13 +756,28 @@ int opengl_compile_shader(shader_type sdr, uint flags)
 	auto shader_hash = get_shader_hash(vert_content, geom_content, frag_content);
 	std::unique_ptr<opengl::ShaderProgram> program(new opengl::ShaderProgram(sdr_info->description));
 
+	new_shader.shader = sdr_info->type_id;
+	new_shader.flags = flags;
+
 	if (!load_cached_shader_binary(program.get(), shader_hash)) {
 		GR_DEBUG_SCOPE("Compiling shader code");
+
+		// the driver compiles the program in the background and it's finished when it's needed
+		bool in_background = Shader_precompile && GL_parallel_shader_compile;
+
 		try {
-			program->addShaderCode(opengl::STAGE_VERTEX, sdr_info->vert, vert_content);
-			program->addShaderCode(opengl::STAGE_FRAGMENT, sdr_info->frag, frag_content);
+			auto add_code = [&](opengl::ShaderStage stage, const char* name, const SCP_vector<SCP_string>& content) {
+				if (in_background) {
+					program->submitShaderCode(stage, name, content);
+				} else {
+					program->addShaderCode(stage, name, content);
+				}
+			};
+
+			add_code(opengl::STAGE_VERTEX, sdr_info->vert, vert_content);
+			add_code(opengl::STAGE_FRAGMENT, sdr_info->frag, frag_content);
 			if (use_geo_sdr) {
-				program->addShaderCode(opengl::STAGE_GEOMETRY, sdr_info->geo, geom_content);
+				add_code(opengl::STAGE_GEOMETRY, sdr_info->geo, geom_content);
 			}
 
 			for (int i = 0; i < opengl_vert_attrib::NUM_ATTRIBS; ++i) {
@@ -594,57 +797,30 @@ int opengl_compile_shader(shader_type sdr, uint flags)
 				glProgramParameteri(program->getShaderHandle(), GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
 			}
 
-			program->linkProgram();
+			if (in_background) {
+				program->submitLink();
+			} else {
+				program->linkProgram();
+			}
 		} catch (const std::exception&) {
 			// Since all shaders are required a compilation failure is a fatal error
 			Error(LOCATION, "A shader failed to compile! Check the debug log for more information.");
 		}
 
-		cache_program_binary(program->getShaderHandle(), shader_hash);
+		if (in_background) {
+			new_shader.compiling = true;
+			new_shader.binary_hash = shader_hash;
+		} else {
+			cache_program_binary(program->getShaderHandle(), shader_hash);
+		}
 	}
 
-	new_shader.shader = sdr_info->type_id;
-	new_shader.flags = flags;
 	new_shader.program = std::move(program);
 
-	opengl_shader_set_current(&new_shader);
-
-	// initialize uniforms and attributes
-	for (auto& unif : sdr_info->uniforms) {
-		new_shader.program->Uniforms.initUniform(unif);
-	}
-
-	for (auto& attr : sdr_info->attributes) {
-		new_shader.program->initAttribute(GL_vertex_attrib_info[attr].name, GL_vertex_attrib_info[attr].default_value);
-	}
-
-	// if this shader is POST_PROCESS_MAIN, hack in the user-defined flags
-	if ( sdr_info->type_id == SDR_TYPE_POST_PROCESS_MAIN ) {
-		opengl_post_init_uniforms(flags);
-	}
-
-	mprintf(("Shader Variant Features:\n"));
-
-	// initialize all uniforms and attributes that are specific to this variant
-	for ( int i = 0; i < GL_num_shader_variants; ++i ) {
-		opengl_shader_variant_t &variant = GL_shader_variants[i];
-
-		if ( sdr_info->type_id == variant.type_id && variant.flag & flags ) {
-			for (auto& unif : variant.uniforms) {
-				new_shader.program->Uniforms.initUniform(unif);
-			}
-
-			for (auto& attr : variant.attributes) {
-				auto& attr_info = GL_vertex_attrib_info[attr];
-				new_shader.program->initAttribute(attr_info.name, attr_info.default_value);
-			}
-
-			mprintf(("	%s\n", variant.description));
-		}
+	if (!new_shader.compiling) {
+		opengl_shader_init_program(&new_shader);
 	}
 
-	opengl_shader_set_current();
-
 	// add it to our list of embedded shaders
 	// see if we have empty shader slots
 	empty_idx = -1;
@@ -667,12 +843,58 @@ int opengl_compile_shader(shader_type sdr, uint flags)
 	return sdr_index;
 }
 
+/**
+ * Starts compiling the shaders in the background. The shaders the mission needs are asked for while its models are
+ * loaded and with GL_KHR_parallel_shader_compile the driver can compile all of them at the same time instead of one
+ * after the other when they're first drawn.
+ */
+void opengl_shader_precompile_begin()
+{
+	Shader_precompile = true;
+}
+
+/**
+ * Stops compiling new shaders in the background. The shaders which aren't done yet are finished when opengl_shader_frame()
+ * notices that they are or when they are needed, a model material can be drawn with a variant with less maps until then.
+ */
+void opengl_shader_precompile_end()
+{
+	Shader_precompile = false;
+
+	opengl_shader_frame();
+
+	int compiling = 0;
+	for (auto& shader_obj : GL_shader) {
+		if (shader_obj.compiling) {
+			++compiling;
+		}
+	}
+
+	if (compiling > 0) {
+		mprintf(("%d shaders are still being compiled in the background.\n", compiling));
+	}
+}
+
+/**
+ * Initializes the shaders which the driver finished compiling in the background
+ */
+void opengl_shader_frame()
+{
+	for (auto& shader_obj : GL_shader) {
+		if (shader_obj.compiling && shader_obj.program->isLinkComplete()) {
+			opengl_shader_finish_compile(&shader_obj);
+		}
+	}
+}
+
 /**
  * Initializes the shader system. Creates a 1x1 texture that can be used as a fallback texture when framebuffer support is missing.
  * Also compiles the shaders used for particle rendering.
  */
 void opengl_shader_init()
 {
+	TRACE_STARTUP_SCOPE(tracing::ShaderInit);
+
 	glGenTextures(1,&Framebuffer_fallback_texture_id);
 	GL_state.Texture.SetActiveUnit(0);
 	GL_state.Texture.SetTarget(GL_TEXTURE_2D);
@@ -694,10 +916,17 @@ void opengl_shader_init()
 	// compile effect shaders
 	gr_opengl_maybe_create_shader(SDR_TYPE_EFFECT_PARTICLE, 0);
 	gr_opengl_maybe_create_shader(SDR_TYPE_EFFECT_PARTICLE, SDR_FLAG_PARTICLE_POINT_GEN);
+	if (Cmdline_gpu_particles) {
+		gr_opengl_maybe_create_shader(SDR_TYPE_EFFECT_PARTICLE, SDR_FLAG_PARTICLE_POINT_GEN | SDR_FLAG_PARTICLE_GPU_SIM);
+	}
 	gr_opengl_maybe_create_shader(SDR_TYPE_EFFECT_DISTORTION, 0);
 
 	gr_opengl_maybe_create_shader(SDR_TYPE_SHIELD_DECAL, 0);
 
+	if ( !Cmdline_no_deferred_lighting ) {
+		gr_opengl_maybe_create_shader(SDR_TYPE_DECAL, 0);
+	}
+
 	// compile deferred lighting shaders
 	opengl_shader_compile_deferred_light_shader();
 
@@ -735,19 +964,40 @@ void opengl_shader_compile_deferred_light_shader()
 	if ( sdr_handle >= 0 ) {
 		opengl_shader_set_current(sdr_handle);
 
-		Current_shader->program->Uniforms.setUniformi("ColorBuffer", 0);
-		Current_shader->program->Uniforms.setUniformi("NormalBuffer", 1);
-		Current_shader->program->Uniforms.setUniformi("PositionBuffer", 2);
-		Current_shader->program->Uniforms.setUniformi("SpecBuffer", 3);
-		Current_shader->program->Uniforms.setUniformf("invScreenWidth", 1.0f / gr_screen.max_w);
-		Current_shader->program->Uniforms.setUniformf("invScreenHeight", 1.0f / gr_screen.max_h);
-		Current_shader->program->Uniforms.setUniformf("specFactor", Cmdline_ogl_spec);
+		Current_shader->program->Uniforms.setUniformi(SDR_UNIFORM("ColorBuffer"), 0);
+		Current_shader->program->Uniforms.setUniformi(SDR_UNIFORM("NormalBuffer"), 1);
+		Current_shader->program->Uniforms.setUniformi(SDR_UNIFORM("PositionBuffer"), 2);
+		Current_shader->program->Uniforms.setUniformi(SDR_UNIFORM("SpecBuffer"), 3);
+		Current_shader->program->Uniforms.setUniformf(SDR_UNIFORM("invScreenWidth"), 1.0f / gr_screen.max_w);
+		Current_shader->program->Uniforms.setUniformf(SDR_UNIFORM("invScreenHeight"), 1.0f / gr_screen.max_h);
+		Current_shader->program->Uniforms.setUniformf(SDR_UNIFORM("specFactor"), Cmdline_ogl_spec);
 	} else {
 		opengl_shader_set_current();
 		mprintf(("Failed to compile deferred lighting shader!\n"));
 		in_error = true;
 	}
 
+	sdr_handle = gr_opengl_maybe_create_shader(SDR_TYPE_DEFERRED_LIGHTING, SDR_FLAG_DEFERRED_TILED);
+
+	if ( sdr_handle >= 0 ) {
+		opengl_shader_set_current(sdr_handle);
+
+		Current_shader->program->Uniforms.setUniformi(SDR_UNIFORM("ColorBuffer"), 0);
+		Current_shader->program->Uniforms.setUniformi(SDR_UNIFORM("NormalBuffer"), 1);
+		Current_shader->program->Uniforms.setUniformi(SDR_UNIFORM("PositionBuffer"), 2);
+		Current_shader->program->Uniforms.setUniformi(SDR_UNIFORM("SpecBuffer"), 3);
+		Current_shader->program->Uniforms.setUniformi(SDR_UNIFORM("lightData"), 4);
+		Current_shader->program->Uniforms.setUniformi(SDR_UNIFORM("tileData"), 5);
+		Current_shader->program->Uniforms.setUniformf(SDR_UNIFORM("invScreenWidth"), 1.0f / gr_screen.max_w);
+		Current_shader->program->Uniforms.setUniformf(SDR_UNIFORM("invScreenHeight"), 1.0f / gr_screen.max_h);
+		Current_shader->program->Uniforms.setUniformf(SDR_UNIFORM("specFactor"), Cmdline_ogl_spec);
+	} else {
+		opengl_shader_set_current();
+		// the light volumes still work without this
+		mprintf(("Failed to compile tiled deferred lighting shader! Falling back to light volumes.\n"));
+		Deferred_lighting_tiled = false;
+	}
+
 	if ( gr_opengl_maybe_create_shader(SDR_TYPE_DEFERRED_CLEAR, 0) < 0 ) {
 		mprintf(("Failed to compile deferred lighting buffer clear shader!\n"));
 		in_error = true;
@@ -771,10 +1021,10 @@ void opengl_shader_compile_passthrough_shader()
 		opengl_shader_set_current(sdr_handle);
 
 		//Hardcoded Uniforms
-		Current_shader->program->Uniforms.setUniformi("baseMap", 0);
-		Current_shader->program->Uniforms.setUniformi("noTexturing", 0);
-		Current_shader->program->Uniforms.setUniformi("alphaTexture", 0);
-		Current_shader->program->Uniforms.setUniformi("srgb", 0);
+		Current_shader->program->Uniforms.setUniformi(SDR_UNIFORM("baseMap"), 0);
+		Current_shader->program->Uniforms.setUniformi(SDR_UNIFORM("noTexturing"), 0);
+		Current_shader->program->Uniforms.setUniformi(SDR_UNIFORM("alphaTexture"), 0);
+		Current_shader->program->Uniforms.setUniformi(SDR_UNIFORM("srgb"), 0);
 	} else {
 		opengl_shader_set_current();
 		mprintf(("Failed to compile passthrough shader!\n"));
@@ -793,35 +1043,35 @@ void opengl_shader_set_passthrough(bool textured, bool alpha, vec4 *clr, float c
 	opengl_shader_set_current(gr_opengl_maybe_create_shader(SDR_TYPE_PASSTHROUGH_RENDER, 0));
 
 	if ( textured ) {
-		Current_shader->program->Uniforms.setUniformi("noTexturing", 0);
+		Current_shader->program->Uniforms.setUniformi(SDR_UNIFORM("noTexturing"), 0);
 	} else {
-		Current_shader->program->Uniforms.setUniformi("noTexturing", 1);
+		Current_shader->program->Uniforms.setUniformi(SDR_UNIFORM("noTexturing"), 1);
 	}
 
 	if ( alpha ) {
-		Current_shader->program->Uniforms.setUniformi("alphaTexture", 1);
+		Current_shader->program->Uniforms.setUniformi(SDR_UNIFORM("alphaTexture"), 1);
 	} else {
-		Current_shader->program->Uniforms.setUniformi("alphaTexture", 0);
+		Current_shader->program->Uniforms.setUniformi(SDR_UNIFORM("alphaTexture"), 0);
 	}
 
 	if ( High_dynamic_range ) {
-		Current_shader->program->Uniforms.setUniformi("srgb", 1);
-		Current_shader->program->Uniforms.setUniformf("intensity", color_scale);
+		Current_shader->program->Uniforms.setUniformi(SDR_UNIFORM("srgb"), 1);
+		Current_shader->program->Uniforms.setUniformf(SDR_UNIFORM("intensity"), color_scale);
 	} else {
-		Current_shader->program->Uniforms.setUniformi("srgb", 0);
-		Current_shader->program->Uniforms.setUniformf("intensity", 1.0f);
+		Current_shader->program->Uniforms.setUniformi(SDR_UNIFORM("srgb"), 0);
+		Current_shader->program->Uniforms.setUniformf(SDR_UNIFORM("intensity"), 1.0f);
 	}
 
-	Current_shader->program->Uniforms.setUniformf("alphaThreshold", GL_alpha_threshold);
+	Current_shader->program->Uniforms.setUniformf(SDR_UNIFORM("alphaThreshold"), GL_alpha_threshold);
 
 	if ( clr != NULL ) {
-		Current_shader->program->Uniforms.setUniform4f("color", *clr);
+		Current_shader->program->Uniforms.setUniform4f(SDR_UNIFORM("color"), *clr);
 	} else {
-		Current_shader->program->Uniforms.setUniform4f("color", 1.0f, 1.0f, 1.0f, 1.0f);
+		Current_shader->program->Uniforms.setUniform4f(SDR_UNIFORM("color"), 1.0f, 1.0f, 1.0f, 1.0f);
 	}
 
 	if (clip_plane.enabled) {
-		Current_shader->program->Uniforms.setUniformi("clipEnabled", 1);
+		Current_shader->program->Uniforms.setUniformi(SDR_UNIFORM("clipEnabled"), 1);
 
 		vec4 clip_equation;
 		clip_equation.xyzw.x = clip_plane.normal.xyz.x;
@@ -829,14 +1079,14 @@ void opengl_shader_set_passthrough(bool textured, bool alpha, vec4 *clr, float c
 		clip_equation.xyzw.z = clip_plane.normal.xyz.z;
 		clip_equation.xyzw.w = -vm_vec_dot(&clip_plane.normal, &clip_plane.position);
 
-		Current_shader->program->Uniforms.setUniform4f("clipEquation", clip_equation);
-		Current_shader->program->Uniforms.setUniformMatrix4f("modelMatrix", GL_model_matrix_stack.get_transform());
+		Current_shader->program->Uniforms.setUniform4f(SDR_UNIFORM("clipEquation"), clip_equation);
+		Current_shader->program->Uniforms.setUniformMatrix4f(SDR_UNIFORM("modelMatrix"), GL_model_matrix_stack.get_transform());
 	} else {
-		Current_shader->program->Uniforms.setUniformi("clipEnabled", 0);
+		Current_shader->program->Uniforms.setUniformi(SDR_UNIFORM("clipEnabled"), 0);
 	}
 
-	Current_shader->program->Uniforms.setUniformMatrix4f("modelViewMatrix", GL_model_view_matrix);
-	Current_shader->program->Uniforms.setUniformMatrix4f("projMatrix", GL_projection_matrix);
+	Current_shader->program->Uniforms.setUniformMatrix4f(SDR_UNIFORM("modelViewMatrix"), GL_model_view_matrix);
+	Current_shader->program->Uniforms.setUniformMatrix4f(SDR_UNIFORM("projMatrix"), GL_projection_matrix);
 }
 
 void opengl_shader_set_passthrough(bool textured, bool alpha, color *clr)
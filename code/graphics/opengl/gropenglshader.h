@@ -122,7 +122,11 @@ typedef struct opengl_shader_t {
 	unsigned int flags;
 	int flags2;
 
-	opengl_shader_t() : shader(SDR_TYPE_NONE), flags(0), flags2(0)
+	// the driver is still compiling the program in the background, see opengl_shader_precompile_begin()
+	bool compiling;
+	SCP_string binary_hash;
+
+	opengl_shader_t() : shader(SDR_TYPE_NONE), flags(0), flags2(0), compiling(false)
 	{
 	}
 
@@ -134,6 +138,8 @@ typedef struct opengl_shader_t {
 		shader = other.shader;
 		flags = other.flags;
 		flags2 = other.flags2;
+		compiling = other.compiling;
+		binary_hash = std::move(other.binary_hash);
 
 		program = std::move(other.program);
 
@@ -158,6 +164,10 @@ void opengl_shader_shutdown();
 
 int opengl_compile_shader(shader_type sdr, uint flags);
 
+void opengl_shader_precompile_begin();
+void opengl_shader_precompile_end();
+void opengl_shader_frame();
+
 GLint opengl_shader_get_attribute(const char *attribute_text);
 
 void opengl_program_check_info_log(GLuint program_object);
@@ -13,12 +13,38 @@
 #include "graphics/material.h"
 #include "gropenglstate.h"
 #include "math/vecmat.h"
+#include "tracing/Monitor.h"
 
 extern GLfloat GL_max_anisotropy;
 
 
 opengl_state GL_state;
 
+opengl_frame_stats GL_frame_stats;
+
+MONITOR(GLStateChanges)
+MONITOR(GLTextureBinds)
+MONITOR(GLProgramBinds)
+MONITOR(GLFramebufferBinds)
+MONITOR(GLBufferBinds)
+MONITOR(GLDrawCalls)
+MONITOR(GLBufferUploads)
+MONITOR(GLBufferUploadKB)
+
+void opengl_frame_stats_end_frame()
+{
+	MONITOR_SET(GLStateChanges, GL_frame_stats.state_changes);
+	MONITOR_SET(GLTextureBinds, GL_frame_stats.texture_binds);
+	MONITOR_SET(GLProgramBinds, GL_frame_stats.program_binds);
+	MONITOR_SET(GLFramebufferBinds, GL_frame_stats.framebuffer_binds);
+	MONITOR_SET(GLBufferBinds, GL_frame_stats.buffer_binds);
+	MONITOR_SET(GLDrawCalls, GL_frame_stats.draw_calls);
+	MONITOR_SET(GLBufferUploads, GL_frame_stats.buffer_uploads);
+	MONITOR_SET(GLBufferUploadKB, (int)(GL_frame_stats.buffer_upload_bytes / 1024));
+
+	GL_frame_stats = opengl_frame_stats();
+}
+
 
 opengl_texture_state::~opengl_texture_state()
 {
@@ -37,21 +63,23 @@ void opengl_texture_state::init(GLuint n_units)
 		units[unit].enabled = GL_FALSE;
 
 		default_values(unit);
-
-		glActiveTexture(GL_TEXTURE0 + unit);
 	}
 
-	SetActiveUnit();
+	// default_values() changed the active unit behind our back so it can't be skipped here
+	glActiveTexture(GL_TEXTURE0);
+	active_texture_unit = 0;
 }
 
 void opengl_texture_state::default_values(GLint unit, GLenum target)
 {
-	glActiveTexture(GL_TEXTURE0 + unit);
-
 	if (target == GL_INVALID_ENUM) {
+		glActiveTexture(GL_TEXTURE0 + unit);
+		++GL_frame_stats.texture_binds;
 
 		glBindTexture(GL_TEXTURE_2D, 0);
+		++GL_frame_stats.texture_binds;
 		glBindTexture(GL_TEXTURE_CUBE_MAP, 0);
+		++GL_frame_stats.texture_binds;
 
 		units[unit].texture_target = GL_TEXTURE_2D;
 		units[unit].texture_id = 0;
@@ -64,6 +92,7 @@ void opengl_texture_state::SetTarget(GLenum tex_target)
 
 		if (units[active_texture_unit].texture_id) {
 			glBindTexture(units[active_texture_unit].texture_target, 0);
+			++GL_frame_stats.texture_binds;
 			units[active_texture_unit].texture_id = 0;
 		}
 
@@ -80,7 +109,12 @@ void opengl_texture_state::SetActiveUnit(GLuint id)
 		id = 0;
 	}
 
+	if (id == active_texture_unit) {
+		return;
+	}
+
 	glActiveTexture(GL_TEXTURE0 + id);
+	++GL_frame_stats.texture_binds;
 
 	active_texture_unit = id;
 }
@@ -93,6 +127,7 @@ void opengl_texture_state::Enable(GLuint tex_id)
 
 	if (units[active_texture_unit].texture_id != tex_id) {
 		glBindTexture(units[active_texture_unit].texture_target, tex_id);
+		++GL_frame_stats.texture_binds;
 		units[active_texture_unit].texture_id = tex_id;
 	}
 }
@@ -111,6 +146,7 @@ void opengl_texture_state::Delete(GLuint tex_id)
 			SetActiveUnit(i);
 
 			glBindTexture(units[i].texture_target, 0);
+			++GL_frame_stats.texture_binds;
 			units[i].texture_id = 0;
 
 			default_values(i, units[i].texture_target);
@@ -158,9 +194,24 @@ void opengl_state::init()
 		clipdistance_Status[i] = GL_FALSE;
 	}
 
+	glDisable(GL_STENCIL_TEST);
+	stenciltest_Status = GL_FALSE;
+
+	// invalid so the first stencil type which is set is always applied
+	Current_stencil_type = (gr_stencil_type)(-1);
+
 	glDepthMask(GL_FALSE);
 	depthmask_Status = GL_FALSE;
 
+	glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+	for (i = 0; i < 4; i++) {
+		colormask_Value[i] = GL_TRUE;
+	}
+
+	glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+	polygon_mode_Face = GL_FRONT_AND_BACK;
+	polygon_mode_Mode = GL_FILL;
+
 	glFrontFace(GL_CCW);
 	frontface_Value = GL_CCW;
 
@@ -184,6 +235,9 @@ void opengl_state::init()
 	current_framebuffer = 0;
 	glBindFramebuffer(GL_FRAMEBUFFER, 0);
 
+	current_vertex_array = 0;
+	glBindVertexArray(0);
+
 	framebuffer_stack.clear();
 }
 
@@ -195,9 +249,11 @@ GLboolean opengl_state::Blend(GLint state)
 		if (state) {
 			Assert( state == GL_TRUE );
 			glEnable(GL_BLEND);
+			++GL_frame_stats.state_changes;
 			blend_Status = GL_TRUE;
 		} else {
 			glDisable(GL_BLEND);
+			++GL_frame_stats.state_changes;
 			blend_Status = GL_FALSE;
 		}
 
@@ -215,9 +271,11 @@ GLboolean opengl_state::DepthTest(GLint state)
 		if (state) {
 			Assert( state == GL_TRUE );
 			glEnable(GL_DEPTH_TEST);
+			++GL_frame_stats.state_changes;
 			depthtest_Status = GL_TRUE;
 		} else {
 			glDisable(GL_DEPTH_TEST);
+			++GL_frame_stats.state_changes;
 			depthtest_Status = GL_FALSE;
 		}
 	}
@@ -233,9 +291,11 @@ GLboolean opengl_state::ScissorTest(GLint state)
 		if (state) {
 			Assert( state == GL_TRUE );
 			glEnable(GL_SCISSOR_TEST);
+			++GL_frame_stats.state_changes;
 			scissortest_Status = GL_TRUE;
 		} else {
 			glDisable(GL_SCISSOR_TEST);
+			++GL_frame_stats.state_changes;
 			scissortest_Status = GL_FALSE;
 		}
 	}
@@ -251,9 +311,11 @@ GLboolean opengl_state::StencilTest(GLint state)
         if (state) {
             Assert( state == GL_TRUE );
             glEnable(GL_STENCIL_TEST);
+            ++GL_frame_stats.state_changes;
             stenciltest_Status = GL_TRUE;
         } else {
             glDisable(GL_STENCIL_TEST);
+            ++GL_frame_stats.state_changes;
             stenciltest_Status = GL_FALSE;
         }
     }
@@ -269,9 +331,11 @@ GLboolean opengl_state::CullFace(GLint state)
 		if (state) {
 			Assert( state == GL_TRUE );
 			glEnable(GL_CULL_FACE);
+			++GL_frame_stats.state_changes;
 			cullface_Status = GL_TRUE;
 		} else {
 			glDisable(GL_CULL_FACE);
+			++GL_frame_stats.state_changes;
 			cullface_Status = GL_FALSE;
 		}
 	}
@@ -283,6 +347,7 @@ void opengl_state::SetPolygonMode(GLenum face, GLenum mode)
 {
 	if ( polygon_mode_Face != face || polygon_mode_Mode != mode ) {
 		glPolygonMode(face, mode);
+		++GL_frame_stats.state_changes;
 
 		polygon_mode_Face = face;
 		polygon_mode_Mode = mode;
@@ -293,6 +358,7 @@ void opengl_state::SetPolygonOffset(GLfloat factor, GLfloat units)
 {
 	if ( polygon_offset_Factor != factor || polygon_offset_Unit != units) {
 		glPolygonOffset(factor, units);
+		++GL_frame_stats.state_changes;
 
 		polygon_offset_Factor = factor;
 		polygon_offset_Unit = units;
@@ -307,9 +373,11 @@ GLboolean opengl_state::PolygonOffsetFill(GLint state)
 		if (state) {
 			Assert( state == GL_TRUE );
 			glEnable(GL_POLYGON_OFFSET_FILL);
+			++GL_frame_stats.state_changes;
 			polygonoffsetfill_Status = GL_TRUE;
 		} else {
 			glDisable(GL_POLYGON_OFFSET_FILL);
+			++GL_frame_stats.state_changes;
 			polygonoffsetfill_Status = GL_FALSE;
 		}
 	}
@@ -326,8 +394,10 @@ GLboolean opengl_state::ClipDistance(GLint num, bool state)
 	if (state != clipdistance_Status[num]) {
 		if (state) {
 			glEnable(GL_CLIP_DISTANCE0+num);
+			++GL_frame_stats.state_changes;
 		} else {
 			glDisable(GL_CLIP_DISTANCE0+num);
+			++GL_frame_stats.state_changes;
 		}
 		clipdistance_Status[num] = state;
 	}
@@ -343,9 +413,11 @@ GLboolean opengl_state::DepthMask(GLint state)
 		if (state) {
 			Assert( state == GL_TRUE );
 			glDepthMask(GL_TRUE);
+			++GL_frame_stats.state_changes;
 			depthmask_Status = GL_TRUE;
 		} else {
 			glDepthMask(GL_FALSE);
+			++GL_frame_stats.state_changes;
 			depthmask_Status = GL_FALSE;
 		}
 	}
@@ -355,20 +427,30 @@ GLboolean opengl_state::DepthMask(GLint state)
 
 GLboolean opengl_state::ColorMask(GLint state)
 {
-    GLboolean save_state = colormask_Status;
+	GLboolean save_state = colormask_Value[0];
 
-    if ( !((state == -1) || (state == colormask_Status)) ) {
-        if (state) {
-            Assert( state == GL_TRUE );
-            glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
-            colormask_Status = GL_TRUE;
-        } else {
-            glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
-            colormask_Status = GL_FALSE;
-        }
-    }
+	if (state != -1) {
+		Assert( state == GL_TRUE || state == GL_FALSE );
+		ColorMask((GLboolean)state, (GLboolean)state, (GLboolean)state, (GLboolean)state);
+	}
 
-    return save_state;
+	return save_state;
+}
+
+void opengl_state::ColorMask(GLboolean red, GLboolean green, GLboolean blue, GLboolean alpha)
+{
+	if ( colormask_Value[0] == red && colormask_Value[1] == green && colormask_Value[2] == blue
+		&& colormask_Value[3] == alpha ) {
+		return;
+	}
+
+	glColorMask(red, green, blue, alpha);
+	++GL_frame_stats.state_changes;
+
+	colormask_Value[0] = red;
+	colormask_Value[1] = green;
+	colormask_Value[2] = blue;
+	colormask_Value[3] = alpha;
 }
 
 void opengl_state::SetAlphaBlendMode(gr_alpha_blend ab)
@@ -450,17 +532,23 @@ void opengl_state::SetStencilType(gr_stencil_type st)
     switch (st) {
         case STENCIL_TYPE_NONE:
             glStencilFunc( GL_NEVER, 1, 0xFFFF );
+            ++GL_frame_stats.state_changes;
             glStencilOp( GL_KEEP, GL_KEEP, GL_KEEP );
+            ++GL_frame_stats.state_changes;
             break;
             
         case STENCIL_TYPE_READ:
             glStencilFunc( GL_NOTEQUAL, 1, 0XFFFF );
+            ++GL_frame_stats.state_changes;
             glStencilOp( GL_KEEP, GL_KEEP, GL_KEEP );
+            ++GL_frame_stats.state_changes;
             break;
             
         case STENCIL_TYPE_WRITE:
             glStencilFunc( GL_ALWAYS, 1, 0xFFFF );
+            ++GL_frame_stats.state_changes;
             glStencilOp( GL_KEEP, GL_KEEP, GL_REPLACE );
+            ++GL_frame_stats.state_changes;
             break;
                      
         default:
@@ -479,6 +567,7 @@ void opengl_state::SetLineWidth(GLfloat width)
 	}
 
 	glLineWidth(width);
+	++GL_frame_stats.state_changes;
 	line_width_Value = width;
 }
 void opengl_state::UseProgram(GLuint program)
@@ -489,6 +578,7 @@ void opengl_state::UseProgram(GLuint program)
 
 	current_program = program;
 	glUseProgram(program);
+	++GL_frame_stats.program_binds;
 }
 bool opengl_state::IsCurrentProgram(GLuint program) {
 	return current_program == program;
@@ -496,9 +586,17 @@ bool opengl_state::IsCurrentProgram(GLuint program) {
 void opengl_state::BindFrameBuffer(GLuint name) {
 	if (current_framebuffer != name) {
 		glBindFramebuffer(GL_FRAMEBUFFER, name);
+		++GL_frame_stats.framebuffer_binds;
 		current_framebuffer = name;
 	}
 }
+void opengl_state::BindVertexArray(GLuint name) {
+	if (current_vertex_array != name) {
+		glBindVertexArray(name);
+		++GL_frame_stats.state_changes;
+		current_vertex_array = name;
+	}
+}
 void opengl_state::PushFramebufferState() {
 	framebuffer_stack.push_back(current_framebuffer);
 }
@@ -553,6 +651,7 @@ void opengl_array_state::EnableVertexAttrib(GLuint index)
 	}
 
 	glEnableVertexAttribArray(index);
+	++GL_frame_stats.state_changes;
 	va_unit->status = GL_TRUE;
 	va_unit->status_init = true;
 }
@@ -566,6 +665,7 @@ void opengl_array_state::DisableVertexAttrib(GLuint index)
 	}
 
 	glDisableVertexAttribArray(index);
+	++GL_frame_stats.state_changes;
 	va_unit->status = GL_FALSE;
 	va_unit->status_init = true;
 }
@@ -588,6 +688,7 @@ void opengl_array_state::VertexAttribPointer(GLuint index, GLint size, GLenum ty
 	}
 
 	glVertexAttribPointer(index, size, type, normalized, stride, pointer);
+	++GL_frame_stats.state_changes;
 
 	va_unit->normalized = normalized;
 	va_unit->pointer = pointer;
@@ -640,6 +741,7 @@ void opengl_array_state::BindArrayBuffer(GLuint id)
 	}
 
 	glBindBuffer(GL_ARRAY_BUFFER, id);
+	++GL_frame_stats.buffer_binds;
 
 	array_buffer = id;
 
@@ -661,6 +763,7 @@ void opengl_array_state::BindElementBuffer(GLuint id)
 	}
 
 	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, id);
+	++GL_frame_stats.buffer_binds;
 
 	element_array_buffer = id;
 }
@@ -672,6 +775,7 @@ void opengl_array_state::BindTextureBuffer(GLuint id)
 	}
 
 	glBindBuffer(GL_TEXTURE_BUFFER, id);
+	++GL_frame_stats.buffer_binds;
 
 	texture_array_buffer = id;
 }
@@ -683,6 +787,7 @@ void opengl_array_state::BindUniformBufferBindingIndex(GLuint id, GLuint index)
 	}
 
 	glBindBufferBase(GL_UNIFORM_BUFFER, index, id);
+	++GL_frame_stats.buffer_binds;
 
 	uniform_buffer_index_bindings[index] = id;
 }
@@ -694,13 +799,14 @@ void opengl_array_state::BindUniformBuffer(GLuint id)
 	}
 
 	glBindBuffer(GL_UNIFORM_BUFFER, id);
+	++GL_frame_stats.buffer_binds;
 
 	uniform_buffer = id;
 }
 
 void gr_opengl_clear_states()
 {
-	glBindVertexArray(GL_vao);
+	GL_state.BindVertexArray(GL_vao);
 
 	gr_zbias(0);
 	gr_zbuffer_set(ZBUFFER_TYPE_READ);
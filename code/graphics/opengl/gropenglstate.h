@@ -22,6 +22,28 @@
 #define MAX_UNIFORM_BUFFERS 6
 #define MAX_UNIFORM_LOCATIONS 256
 
+/**
+ * The work handed to the driver during the current frame. Only calls which actually reach GL are counted, the values
+ * show up as monitors in the tracing output once the frame is done.
+ */
+struct opengl_frame_stats {
+	int state_changes = 0;
+	int texture_binds = 0;
+	int program_binds = 0;
+	int framebuffer_binds = 0;
+	int buffer_binds = 0;
+	int draw_calls = 0;
+	int buffer_uploads = 0;
+	size_t buffer_upload_bytes = 0;
+};
+
+extern opengl_frame_stats GL_frame_stats;
+
+/**
+ * @brief Publishes the counters of the frame which just ended and resets them
+ */
+void opengl_frame_stats_end_frame();
+
 struct opengl_texture_unit {
 	GLboolean enabled;	// has texture target enabled
 
@@ -53,6 +75,7 @@ class opengl_texture_state
 		void Delete(GLuint tex_id);
 		
 		inline GLenum GetTarget();
+		inline GLuint GetActiveUnit();
 		inline void SetShaderMode(GLboolean mode);
 };
 
@@ -61,6 +84,11 @@ inline GLenum opengl_texture_state::GetTarget()
 	return units[active_texture_unit].texture_target;
 }
 
+inline GLuint opengl_texture_state::GetActiveUnit()
+{
+	return active_texture_unit;
+}
+
 inline void opengl_texture_state::SetShaderMode(GLboolean mode)
 {
 	shader_mode = mode;
@@ -154,7 +182,7 @@ class opengl_state
 		GLboolean clipplane_Status[6];
 		bool clipdistance_Status[6];
 		GLboolean depthmask_Status;
-        GLboolean colormask_Status;
+		GLboolean colormask_Value[4];
 
 		GLenum frontface_Value;
 		GLenum cullface_Value;
@@ -174,6 +202,8 @@ class opengl_state
 
 		GLuint current_program;
 
+		GLuint current_vertex_array;
+
 		// The framebuffer state actually consists of draw and read buffers but we only use both at the same time
 		GLuint current_framebuffer;
 		SCP_vector<GLuint> framebuffer_stack;
@@ -204,7 +234,8 @@ class opengl_state
 		GLboolean PolygonOffsetFill(GLint state = -1);
 		GLboolean ClipDistance(GLint num, bool state = false);
 		GLboolean DepthMask(GLint state = -1);
-        GLboolean ColorMask(GLint state = -1);
+		GLboolean ColorMask(GLint state = -1);
+		void ColorMask(GLboolean red, GLboolean green, GLboolean blue, GLboolean alpha);
 
 		inline GLenum FrontFaceValue(GLenum new_val = GL_INVALID_ENUM);
 		inline GLenum CullFaceValue(GLenum new_val = GL_INVALID_ENUM);
@@ -219,6 +250,8 @@ class opengl_state
 
 		void BindFrameBuffer(GLuint name);
 
+		void BindVertexArray(GLuint name);
+
 		void PushFramebufferState();
 		void PopFramebufferState();
 };
@@ -228,6 +261,7 @@ inline GLenum opengl_state::FrontFaceValue(GLenum new_val)
 	if (new_val != frontface_Value) {
 		if (new_val != GL_INVALID_ENUM) {
 			glFrontFace(new_val);
+			++GL_frame_stats.state_changes;
 			frontface_Value = new_val;
 		}
 	}
@@ -240,6 +274,7 @@ inline GLenum opengl_state::CullFaceValue(GLenum new_val)
 	if (new_val != cullface_Value) {
 		if (new_val != GL_INVALID_ENUM) {
 			glCullFace(new_val);
+			++GL_frame_stats.state_changes;
 			cullface_Value = new_val;
 		}
 	}
@@ -251,6 +286,7 @@ inline void opengl_state::BlendFunc(GLenum s_val, GLenum d_val)
 {
 	if ( !((s_val == blendfunc_Value[0]) && (d_val == blendfunc_Value[1])) ) {
 		glBlendFunc(s_val, d_val);
+		++GL_frame_stats.state_changes;
 		blendfunc_Value[0] = s_val;
 		blendfunc_Value[1] = d_val;
 
@@ -273,6 +309,7 @@ inline GLenum opengl_state::DepthFunc(GLenum new_val)
 	if (new_val != depthfunc_Value) {
 		if (new_val != GL_INVALID_ENUM) {
 			glDepthFunc(new_val);
+			++GL_frame_stats.state_changes;
 			depthfunc_Value = new_val;
 		}
 	}
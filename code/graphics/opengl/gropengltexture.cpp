@@ -12,18 +12,22 @@
 #endif
 
 #include "bmpman/bmpman.h"
+#include "bmpman/texturecache.h"
 #include "cmdline/cmdline.h"
 #include "ddsutils/ddsutils.h"
 #include "globalincs/systemvars.h"
 #include "graphics/grinternal.h"
+#include "gropengldraw.h"
 #include "gropenglstate.h"
 #include "gropengltexture.h"
 #include "math/vecmat.h"
 #include "osapi/osregistry.h"
+#include "tracing/Monitor.h"
 
 
-static tcache_slot_opengl *Textures = NULL;
-static int *Tex_used_this_frame = NULL;
+// one entry for every bitmap slot, grown by opengl_tcache_add_slot() as bmpman adds slots
+static SCP_vector<tcache_slot_opengl> Textures;
+static SCP_vector<int> Tex_used_this_frame;
 
 matrix4 GL_texture_matrix;
 
@@ -34,6 +38,9 @@ int GL_min_texture_height = 0;
 GLint GL_max_texture_height = 0;
 int GL_textures_in = 0;
 int GL_textures_in_frame = 0;
+static int GL_texture_frame = 0;
+static int GL_textures_evicted = 0;
+static bool GL_texture_budget_warned = false;
 int GL_last_detail = -1;
 GLint GL_supported_texture_units = 2;
 int GL_should_preload = 0;
@@ -47,6 +54,31 @@ GLenum GL_texture_addressing = GL_REPEAT;
 bool GL_rendering_to_texture = false;
 GLint GL_max_renderbuffer_size = 0;
 
+/**
+ * A set of textures with the same format, size and number of mipmap levels stored in the layers of one texture array
+ */
+struct opengl_texture_array {
+	GLuint texture_id = 0;
+	GLenum internal_format = GL_RGBA8;
+	int w = 0;
+	int h = 0;
+	int mipmap_levels = 0;
+	int num_layers = 0;
+	int layer_size = 0;
+	GLenum wrap_mode = GL_REPEAT;
+
+	SCP_vector<int> free_layers;
+};
+
+static SCP_vector<opengl_texture_array> GL_texture_arrays;
+
+// bound instead of bitmaps which are still streaming in, indexed by [is_array][is_transparent]
+static GLuint GL_stream_placeholders[2][2] = { { 0, 0 }, { 0, 0 } };
+
+// a new array gets as many layers as fit into this size, arrays are never resized once they have been allocated
+static const int TEXTURE_ARRAY_MAX_SIZE = 32 * 1024 * 1024;
+static const int TEXTURE_ARRAY_MAX_LAYERS = 16;
+
 extern int GLOWMAP;
 extern int SPECMAP;
 extern int CLOAKMAP;
@@ -61,6 +93,7 @@ int opengl_create_texture_sub(int bitmap_handle, int bitmap_type, int bmap_w, in
 int opengl_create_texture (int bitmap_handle, int bitmap_type, tcache_slot_opengl *tslot = NULL);
 
 extern int get_num_mipmap_levels(int w, int h);
+int opengl_compress_image(ubyte **compressed_data, ubyte *in_data, int width, int height, int alpha, int num_mipmaps);
 
 void opengl_set_additive_tex_env()
 {
@@ -118,23 +151,11 @@ void opengl_tcache_init()
 		Error(LOCATION, "A minimum texture size of \"1024x1024\" is required for FS2_Open but only \"%ix%i\" was found.  Can not continue.", GL_max_texture_width, GL_max_texture_height);
 	}
 
-	if (Textures == NULL) {
-		Textures = (tcache_slot_opengl *) vm_malloc(MAX_BITMAPS * sizeof(tcache_slot_opengl), memory::quiet_alloc);
-	}
-
-	if (Tex_used_this_frame == NULL) {
-		Tex_used_this_frame = (int *) vm_malloc(MAX_BITMAPS * sizeof(int), memory::quiet_alloc);
-	}
-
-	if ( !Textures || !Tex_used_this_frame )
-		Error(LOCATION, "Unable to allocate memory for OpenGL texture slots!");
-
-
-	memset( Tex_used_this_frame, 0, MAX_BITMAPS * sizeof(int) );
+	std::fill(Tex_used_this_frame.begin(), Tex_used_this_frame.end(), 0);
 
 	// Init the texture structures
-	for (i = 0; i < MAX_BITMAPS; i++) {
-		Textures[i].reset();
+	for (auto& t : Textures) {
+		t.reset();
 	}
 
 	// check what mipmap filter we should be using
@@ -199,10 +220,7 @@ void opengl_tcache_flush()
 {
 	int i;
 
-	if ( Textures == NULL )
-		return;
-
-	for (i = 0; i < MAX_BITMAPS; i++)
+	for (i = 0; i < (int)Textures.size(); i++)
 		opengl_free_texture( &Textures[i] );
 
 	if (GL_textures_in != 0) {
@@ -216,29 +234,49 @@ extern void opengl_kill_all_render_targets();
 void opengl_tcache_shutdown()
 {
 	opengl_kill_all_render_targets();
+	opengl_kill_transient_textures();
 
 	opengl_tcache_flush();
 
 	GL_textures_in = 0;
 	GL_textures_in_frame = 0;
 
-	if (Textures != NULL) {
-		vm_free(Textures);
-		Textures = NULL;
-	}
+	GL_texture_arrays.clear();
 
-	if (Tex_used_this_frame != NULL) {
-		vm_free(Tex_used_this_frame);
-		Tex_used_this_frame = NULL;
+	for (auto& placeholders : GL_stream_placeholders) {
+		for (auto& placeholder : placeholders) {
+			if (placeholder != 0) {
+				GL_state.Texture.Delete(placeholder);
+				glDeleteTextures(1, &placeholder);
+				placeholder = 0;
+			}
+		}
 	}
 }
 
+MONITOR(TexturesEvicted)
+
 void opengl_tcache_frame()
 {
 	GL_textures_in_frame = 0;
 
+	++GL_texture_frame;
+
+	MONITOR_SET(TexturesEvicted, GL_textures_evicted);
+	GL_textures_evicted = 0;
+
 	// make all textures as not used
-	memset( Tex_used_this_frame, 0, MAX_BITMAPS * sizeof(int) );
+	std::fill(Tex_used_this_frame.begin(), Tex_used_this_frame.end(), 0);
+
+	opengl_transient_textures_frame();
+}
+
+void opengl_tcache_add_slot(int n)
+{
+	if (n >= (int)Textures.size()) {
+		Textures.resize(n + 1);
+		Tex_used_this_frame.resize(n + 1, 0);
+	}
 }
 
 extern bool GL_initted;
@@ -276,6 +314,30 @@ bool opengl_texture_slot_valid(int n, int handle)
 	return true;
 }
 
+static void opengl_texture_array_release(tcache_slot_opengl *t)
+{
+	if (t->array_index < 0) {
+		return;
+	}
+
+	opengl_texture_array *array = &GL_texture_arrays[t->array_index];
+
+	array->free_layers.push_back(t->array_layer);
+	GL_textures_in -= array->layer_size;
+
+	// the last layer is gone so the array isn't needed anymore
+	if ( (int)array->free_layers.size() == array->num_layers ) {
+		GL_state.Texture.Delete(array->texture_id);
+		glDeleteTextures(1, &array->texture_id);
+
+		array->texture_id = 0;
+		array->free_layers.clear();
+	}
+
+	t->array_index = -1;
+	t->array_layer = -1;
+}
+
 int opengl_free_texture(tcache_slot_opengl *t)
 {
 	// Bitmap changed!!     
@@ -287,6 +349,8 @@ int opengl_free_texture(tcache_slot_opengl *t)
 		}
 
 		// ok, now we know its legal to free everything safely
+		opengl_texture_array_release(t);
+
 		GL_state.Texture.Delete(t->texture_id);
 		glDeleteTextures (1, &t->texture_id);
 
@@ -298,6 +362,58 @@ int opengl_free_texture(tcache_slot_opengl *t)
 	return 1;
 }
 
+/**
+ * Frees the textures which haven't been used for the longest time until the texture memory fits into the budget set
+ * with -vram_budget. Textures used in the current frame are kept so a frame never loses textures it still draws with,
+ * in that case the budget is exceeded until the next frame.
+ */
+static void opengl_tcache_enforce_budget()
+{
+	if (Cmdline_vram_budget <= 0) {
+		return;
+	}
+
+	const int64_t budget = (int64_t)Cmdline_vram_budget * 1024 * 1024;
+
+	if (GL_textures_in <= budget) {
+		return;
+	}
+
+	SCP_vector<std::pair<int, int>> candidates;
+
+	for (int i = 0; i < (int)Textures.size(); i++) {
+		tcache_slot_opengl *t = &Textures[i];
+
+		// render targets don't have a bitmap handle and can't be recreated from their bitmap
+		if ( !t->texture_id || (t->bitmap_handle < 0) || (t->last_used_frame >= GL_texture_frame) ) {
+			continue;
+		}
+
+		candidates.emplace_back(t->last_used_frame, i);
+	}
+
+	std::sort(candidates.begin(), candidates.end());
+
+	for (auto& candidate : candidates) {
+		if (GL_textures_in <= budget) {
+			break;
+		}
+
+		tcache_slot_opengl *t = &Textures[candidate.second];
+		int size = t->size;
+
+		if (opengl_free_texture(t)) {
+			nprintf(("TextureCache", "Evicted texture in slot %d (%d bytes) to stay inside the texture budget.\n", candidate.second, size));
+			++GL_textures_evicted;
+		}
+	}
+
+	if ( (GL_textures_in > budget) && !GL_texture_budget_warned ) {
+		mprintf(("The textures of a single frame need %d MB which is more than the texture budget of %d MB!\n", GL_textures_in / (1024 * 1024), Cmdline_vram_budget));
+		GL_texture_budget_warned = true;
+	}
+}
+
 // data == start of bitmap data
 // bmap_w == width of source bitmap
 // bmap_h == height of source bitmap
@@ -343,6 +459,10 @@ int opengl_create_texture_sub(int bitmap_handle, int bitmap_type, int bmap_w, in
 			return 0;
 		}
 	}
+	else {
+		// the layer still has the contents of the previous bitmap
+		opengl_texture_array_release(t);
+	}
 
 	// for everything that might use mipmaps
 	mipmap_w = tex_w;
@@ -424,7 +544,8 @@ int opengl_create_texture_sub(int bitmap_handle, int bitmap_type, int bmap_w, in
 	}
 
 	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
-	glBindTexture(t->texture_target, t->texture_id);
+	GL_state.Texture.SetTarget(t->texture_target);
+	GL_state.Texture.Enable(t->texture_id);
 	if (!reload) {
 		opengl_set_object_label(GL_TEXTURE, t->texture_id, bm_get_filename(bitmap_handle));
 	}
@@ -804,8 +925,12 @@ int opengl_create_texture_sub(int bitmap_handle, int bitmap_type, int bmap_w, in
 
 	GL_textures_in_frame += t->size;
 
+	t->last_used_frame = GL_texture_frame;
+
 	if ( !reload ) {
 		GL_textures_in += t->size;
+
+		opengl_tcache_enforce_budget();
 	}
 
 	Tex_used_this_frame[idx] = 0;
@@ -815,6 +940,47 @@ int opengl_create_texture_sub(int bitmap_handle, int bitmap_type, int bmap_w, in
 	return ret_val;
 }
 
+/**
+ * Compresses the image of a texture and writes it to the texture cache, see bmpman/texturecache.h
+ *
+ * Only power-of-2 images get a copy since compressed textures can't be resized when they are uploaded.
+ */
+static void opengl_save_texture_cache(int bitmap_handle, bitmap *bmp)
+{
+	char cache_filename[MAX_FILENAME_LEN];
+	uint source_checksum;
+
+	if ( !texture_cache_enabled() || !Texture_compression_available ) {
+		return;
+	}
+
+	if ( ((bmp->bpp != 24) && (bmp->bpp != 32)) || (bmp->w < 4) || (bmp->h < 4) || (bmp->w & (bmp->w - 1)) || (bmp->h & (bmp->h - 1)) ) {
+		return;
+	}
+
+	if ( !bm_get_texture_cache_target(bitmap_handle, cache_filename, &source_checksum) ) {
+		return;
+	}
+
+	int alpha = (bmp->bpp == 32);
+	int num_mipmaps = get_num_mipmap_levels(bmp->w, bmp->h);
+	ubyte *compressed_data = NULL;
+
+	// the compressor works on texture unit 0, the caller binds the new texture to its unit afterwards
+	GLuint active_unit = GL_state.Texture.GetActiveUnit();
+	int size = opengl_compress_image(&compressed_data, (ubyte*)bmp->data, bmp->w, bmp->h, alpha, num_mipmaps);
+	GL_state.Texture.SetActiveUnit(active_unit);
+
+	if (size <= 0) {
+		mprintf(("Couldn't compress %s for the texture cache.\n", bm_get_filename(bitmap_handle)));
+		return;
+	}
+
+	texture_cache_save(cache_filename, source_checksum, bmp->w, bmp->h, alpha ? DDS_DXT5 : DDS_DXT1, num_mipmaps, compressed_data, (size_t)size);
+
+	vm_free(compressed_data);
+}
+
 int opengl_create_texture(int bitmap_handle, int bitmap_type, tcache_slot_opengl *tslot)
 {
 	ubyte flags;
@@ -960,6 +1126,10 @@ int opengl_create_texture(int bitmap_handle, int bitmap_type, tcache_slot_opengl
 	// call the helper
 	int ret_val = opengl_create_texture_sub(bitmap_handle, bitmap_type, bmp->w, bmp->h, max_w, max_h, (ubyte*)bmp->data, tslot, base_level, resize, reload);
 
+	if (ret_val && (bitmap_type == TCACHE_TYPE_NORMAL)) {
+		opengl_save_texture_cache(bitmap_handle, bmp);
+	}
+
 	// unlock the bitmap
 	bm_unlock(bitmap_handle);
 
@@ -978,6 +1148,41 @@ int opengl_create_texture(int bitmap_handle, int bitmap_type, tcache_slot_opengl
 // WARNING:  Needs to match what is in bm_internal.h!!!!!
 #define RENDER_TARGET_DYNAMIC	17
 
+/**
+ * Binds a single texel texture in place of a bitmap whose data is still being loaded, see bm_stream_ready()
+ *
+ * Textures get a neutral grey which also decodes to a flat normal, interface graphics stay invisible until they are
+ * loaded.
+ */
+static void opengl_bind_stream_placeholder(GLenum target, int bitmap_type)
+{
+	bool is_array = (target == GL_TEXTURE_2D_ARRAY);
+	bool transparent = (bitmap_type == TCACHE_TYPE_AABITMAP) || (bitmap_type == TCACHE_TYPE_INTERFACE) || (bitmap_type == TCACHE_TYPE_XPARENT);
+	GLuint *placeholder = &GL_stream_placeholders[is_array][transparent];
+
+	GL_state.Texture.SetTarget(target);
+
+	if (*placeholder == 0) {
+		const ubyte texel[4] = { 128, 128, 128, 128 };
+		const ubyte clear_texel[4] = { 0, 0, 0, 0 };
+
+		glGenTextures(1, placeholder);
+		GL_state.Texture.Enable(*placeholder);
+
+		if (is_array) {
+			glTexImage3D(target, 0, GL_RGBA8, 1, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, transparent ? clear_texel : texel);
+		} else {
+			glTexImage2D(target, 0, GL_RGBA8, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, transparent ? clear_texel : texel);
+		}
+
+		glTexParameteri(target, GL_TEXTURE_MAX_LEVEL, 0);
+		glTexParameteri(target, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+		glTexParameteri(target, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	}
+
+	GL_state.Texture.Enable(*placeholder);
+}
+
 int gr_opengl_tcache_set_internal(int bitmap_handle, int bitmap_type, float *u_scale, float *v_scale, int tex_unit = 0)
 {
 	int ret_val = 1;
@@ -997,6 +1202,16 @@ int gr_opengl_tcache_set_internal(int bitmap_handle, int bitmap_type, float *u_s
 	if (!bm_is_render_target(bitmap_handle) &&
 		((t->bitmap_handle < 0) || (bitmap_handle != t->bitmap_handle)) )
 	{
+		// the bitmap is still being loaded in the background
+		if ( (bitmap_type != TCACHE_TYPE_CUBEMAP) && !bm_stream_ready(bitmap_handle) ) {
+			*u_scale = 1.0f;
+			*v_scale = 1.0f;
+
+			opengl_bind_stream_placeholder(GL_TEXTURE_2D, bitmap_type);
+
+			return 1;
+		}
+
 		ret_val = opengl_create_texture( bitmap_handle, bitmap_type, t );
 	}
 
@@ -1018,6 +1233,7 @@ int gr_opengl_tcache_set_internal(int bitmap_handle, int bitmap_type, float *u_s
 			t->wrap_mode = GL_texture_addressing;
 		}
 
+		t->last_used_frame = GL_texture_frame;
 		Tex_used_this_frame[n]++;
 	}
 	// gah
@@ -1058,6 +1274,294 @@ int gr_opengl_tcache_set(int bitmap_handle, int bitmap_type, float *u_scale, flo
 	return rc;
 }
 
+/**
+ * Finds an array with a free layer for a texture of the given format or allocates a new one
+ */
+static int opengl_texture_array_find(GLenum internal_format, GLenum gl_format, GLenum tex_format, int block_size, int w, int h, int mipmap_levels, int layer_size)
+{
+	int free_slot = -1;
+
+	for (size_t i = 0; i < GL_texture_arrays.size(); ++i) {
+		opengl_texture_array *array = &GL_texture_arrays[i];
+
+		if (array->texture_id == 0) {
+			if (free_slot < 0) {
+				free_slot = (int)i;
+			}
+
+			continue;
+		}
+
+		if ( (array->internal_format == internal_format) && (array->w == w) && (array->h == h)
+			&& (array->mipmap_levels == mipmap_levels) && !array->free_layers.empty() )
+		{
+			return (int)i;
+		}
+	}
+
+	if (free_slot < 0) {
+		free_slot = (int)GL_texture_arrays.size();
+		GL_texture_arrays.emplace_back();
+	}
+
+	opengl_texture_array *array = &GL_texture_arrays[free_slot];
+
+	array->internal_format = internal_format;
+	array->w = w;
+	array->h = h;
+	array->mipmap_levels = mipmap_levels;
+	array->layer_size = layer_size;
+	array->num_layers = MAX(1, MIN(TEXTURE_ARRAY_MAX_SIZE / MAX(layer_size, 1), TEXTURE_ARRAY_MAX_LAYERS));
+	array->wrap_mode = GL_REPEAT;
+
+	glGenTextures(1, &array->texture_id);
+
+	GL_state.Texture.SetTarget(GL_TEXTURE_2D_ARRAY);
+	GL_state.Texture.Enable(array->texture_id);
+
+	GLenum min_filter = GL_LINEAR;
+
+	if (mipmap_levels > 1) {
+		min_filter = (GL_mipmap_filter) ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR_MIPMAP_NEAREST;
+
+		if ( GLAD_GL_EXT_texture_filter_anisotropic ) {
+			glTexParameterf(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAX_ANISOTROPY_EXT, GL_anisotropy);
+		}
+	}
+
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAX_LEVEL, mipmap_levels - 1);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, min_filter);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_REPEAT);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_REPEAT);
+
+	// the layers are only filled once textures are added so storage is allocated without any data
+	int mipmap_w = w;
+	int mipmap_h = h;
+
+	for (int i = 0; i < mipmap_levels; i++) {
+		if (block_size > 0) {
+			int dsize = ((mipmap_h + 3) / 4) * ((mipmap_w + 3) / 4) * block_size;
+
+			glCompressedTexImage3D(GL_TEXTURE_2D_ARRAY, i, internal_format, mipmap_w, mipmap_h, array->num_layers, 0, dsize * array->num_layers, NULL);
+		} else {
+			glTexImage3D(GL_TEXTURE_2D_ARRAY, i, internal_format, mipmap_w, mipmap_h, array->num_layers, 0, gl_format, tex_format, NULL);
+		}
+
+		mipmap_w = MAX(mipmap_w >> 1, 1);
+		mipmap_h = MAX(mipmap_h >> 1, 1);
+	}
+
+	array->free_layers.clear();
+	for (int i = array->num_layers - 1; i >= 0; i--) {
+		array->free_layers.push_back(i);
+	}
+
+	return free_slot;
+}
+
+/**
+ * Copies a bitmap which already has a texture into a layer of a matching texture array
+ *
+ * The array uses the same mipmap levels as the texture of the slot. Textures which were shrunk to match the texture
+ * detail setting without having mipmaps are stored in their original size.
+ */
+static bool opengl_texture_array_add(int bitmap_handle, tcache_slot_opengl *t)
+{
+	ubyte flags = BMP_TEX_OTHER;
+	ubyte bpp = 16;
+	GLenum texFormat = GL_UNSIGNED_INT_8_8_8_8_REV;
+	GLenum glFormat = GL_BGRA;
+	GLenum intFormat = GL_RGBA8;
+	int block_size = 0;
+
+	switch ( bm_is_compressed(bitmap_handle) ) {
+		case 0:
+			break;
+
+		case DDS_DXT1:
+			bpp = 24;
+			flags = BMP_TEX_DXT1;
+			intFormat = GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+			block_size = 8;
+			break;
+
+		case DDS_DXT3:
+			bpp = 32;
+			flags = BMP_TEX_DXT3;
+			intFormat = GL_COMPRESSED_RGBA_S3TC_DXT3_EXT;
+			block_size = 16;
+			break;
+
+		case DDS_DXT5:
+			bpp = 32;
+			flags = BMP_TEX_DXT5;
+			intFormat = GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+			block_size = 16;
+			break;
+
+		default:
+			// cube maps can't be stored in a 2D array
+			return false;
+	}
+
+	bitmap *bmp = bm_lock(bitmap_handle, bpp, flags);
+
+	if ( bmp == NULL ) {
+		mprintf(("Couldn't lock bitmap %d (%s) for its texture array.\n", bitmap_handle, bm_get_filename(bitmap_handle) ));
+		return false;
+	}
+
+	int byte_mult = (bmp->bpp >> 3);
+
+	if (block_size == 0) {
+		if (byte_mult == 4) {
+			texFormat = GL_UNSIGNED_INT_8_8_8_8_REV;
+			intFormat = (gr_screen.bits_per_pixel == 32) ? GL_RGBA8 : GL_RGB5_A1;
+			glFormat = GL_BGRA;
+		} else if (byte_mult == 3) {
+			texFormat = GL_UNSIGNED_BYTE;
+			intFormat = (gr_screen.bits_per_pixel == 32) ? GL_RGB8 : GL_RGB5;
+			glFormat = GL_BGR;
+		} else if (byte_mult == 2) {
+			texFormat = GL_UNSIGNED_SHORT_1_5_5_5_REV;
+			intFormat = GL_RGB5_A1;
+			glFormat = GL_BGRA;
+		} else {
+			bm_unlock(bitmap_handle);
+			return false;
+		}
+	}
+
+	// skip the levels the texture of the slot doesn't use because of the texture detail setting
+	int mipmap_levels = MAX(t->mipmap_levels, 1);
+	int base_level = MAX(bm_get_num_mipmaps(bitmap_handle) - mipmap_levels, 0);
+
+	int mipmap_w = bmp->w;
+	int mipmap_h = bmp->h;
+	int doffset = 0;
+
+	auto level_size = [block_size, byte_mult](int level_w, int level_h) {
+		return (block_size > 0) ? ((level_h + 3) / 4) * ((level_w + 3) / 4) * block_size : level_w * level_h * byte_mult;
+	};
+
+	for (int i = 0; i < base_level; i++) {
+		doffset += level_size(mipmap_w, mipmap_h);
+
+		mipmap_w = MAX(mipmap_w >> 1, 1);
+		mipmap_h = MAX(mipmap_h >> 1, 1);
+	}
+
+	int layer_size = 0;
+	for (int i = 0, level_w = mipmap_w, level_h = mipmap_h; i < mipmap_levels; i++) {
+		layer_size += level_size(level_w, level_h);
+
+		level_w = MAX(level_w >> 1, 1);
+		level_h = MAX(level_h >> 1, 1);
+	}
+
+	int array_index = opengl_texture_array_find(intFormat, glFormat, texFormat, block_size, mipmap_w, mipmap_h, mipmap_levels, layer_size);
+	opengl_texture_array *array = &GL_texture_arrays[array_index];
+
+	int layer = array->free_layers.back();
+	array->free_layers.pop_back();
+
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	GL_state.Texture.SetTarget(GL_TEXTURE_2D_ARRAY);
+	GL_state.Texture.Enable(array->texture_id);
+
+	ubyte *bmp_data = (ubyte*)bmp->data;
+
+	for (int i = 0; i < mipmap_levels; i++) {
+		int dsize = level_size(mipmap_w, mipmap_h);
+
+		if (block_size > 0) {
+			glCompressedTexSubImage3D(GL_TEXTURE_2D_ARRAY, i, 0, 0, layer, mipmap_w, mipmap_h, 1, intFormat, dsize, bmp_data + doffset);
+		} else {
+			glTexSubImage3D(GL_TEXTURE_2D_ARRAY, i, 0, 0, layer, mipmap_w, mipmap_h, 1, glFormat, texFormat, bmp_data + doffset);
+		}
+
+		doffset += dsize;
+
+		mipmap_w = MAX(mipmap_w >> 1, 1);
+		mipmap_h = MAX(mipmap_h >> 1, 1);
+	}
+
+	bm_unlock(bitmap_handle);
+	bm_unload_fast(bitmap_handle);
+
+	t->array_index = array_index;
+	t->array_layer = layer;
+
+	GL_textures_in += array->layer_size;
+	GL_textures_in_frame += array->layer_size;
+
+	opengl_tcache_enforce_budget();
+
+	return true;
+}
+
+int opengl_tcache_set_array(int bitmap_handle, int tex_unit)
+{
+	if (bitmap_handle <= 0) {
+		return -1;
+	}
+
+	GL_CHECK_FOR_ERRORS("start of tcache_set_array()");
+
+	if (GL_last_detail != Detail.hardware_textures) {
+		GL_last_detail = Detail.hardware_textures;
+		opengl_tcache_flush();
+	}
+
+	Assertion(!bm_is_render_target(bitmap_handle), "Render target %s can't be stored in a texture array!", bm_get_filename(bitmap_handle));
+
+	int n = bm_get_cache_slot(bitmap_handle, 1);
+	tcache_slot_opengl *t = &Textures[n];
+
+	GL_state.Texture.SetActiveUnit(tex_unit);
+
+	// the regular texture is still created since other code may use the bitmap without an array
+	if ( (t->bitmap_handle < 0) || (bitmap_handle != t->bitmap_handle) ) {
+		if ( !bm_stream_ready(bitmap_handle) ) {
+			opengl_bind_stream_placeholder(GL_TEXTURE_2D_ARRAY, TCACHE_TYPE_NORMAL);
+
+			return 0;
+		}
+
+		if ( !opengl_create_texture(bitmap_handle, bm_get_tcache_type(bitmap_handle), t) ) {
+			mprintf(("Texturing disabled for bitmap %d (%s) due to internal error.\n", bitmap_handle, bm_get_filename(bitmap_handle)));
+			return -1;
+		}
+	}
+
+	// marked before the array is added so making room for the new layer can't evict this texture
+	t->last_used_frame = GL_texture_frame;
+
+	if ( (t->array_index < 0) && !opengl_texture_array_add(bitmap_handle, t) ) {
+		mprintf(("Bitmap %d (%s) could not be added to a texture array.\n", bitmap_handle, bm_get_filename(bitmap_handle)));
+		return -1;
+	}
+
+	opengl_texture_array *array = &GL_texture_arrays[t->array_index];
+
+	GL_state.Texture.SetTarget(GL_TEXTURE_2D_ARRAY);
+	GL_state.Texture.Enable(array->texture_id);
+
+	if (array->wrap_mode != GL_texture_addressing) {
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_texture_addressing);
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_texture_addressing);
+
+		array->wrap_mode = GL_texture_addressing;
+	}
+
+	Tex_used_this_frame[n]++;
+
+	GL_CHECK_FOR_ERRORS("end of tcache_set_array()");
+
+	return t->array_layer;
+}
+
 void opengl_preload_init()
 {
 	if (gr_screen.mode != GR_OPENGL)
@@ -1077,6 +1581,11 @@ int gr_opengl_preload(int bitmap_num, int is_aabitmap)
 		return 0;
 	}
 
+	// once the budget is used up the remaining textures are only created when they are actually used
+	if ( (Cmdline_vram_budget > 0) && (GL_textures_in >= (int64_t)Cmdline_vram_budget * 1024 * 1024) ) {
+		return 0;
+	}
+
 	retval = gr_opengl_tcache_set(bitmap_num, (is_aabitmap) ? TCACHE_TYPE_AABITMAP : TCACHE_TYPE_NORMAL, &u_scale, &v_scale);
 
 	if ( !retval ) {
@@ -1130,6 +1639,29 @@ void gr_opengl_set_texture_addressing(int mode)
 	GL_CHECK_FOR_ERRORS("end of set_texture_addressing()");
 }
 
+/**
+ * Averages every 2x2 block of texels of an image, for the mipmap levels of opengl_compress_image()
+ */
+static void opengl_downsample_image(ubyte *out_data, const ubyte *in_data, int in_w, int in_h, int out_w, int out_h, int byte_mult)
+{
+	for (int y = 0; y < out_h; y++) {
+		int y0 = MIN(y * 2, in_h - 1);
+		int y1 = MIN(y * 2 + 1, in_h - 1);
+
+		for (int x = 0; x < out_w; x++) {
+			int x0 = MIN(x * 2, in_w - 1);
+			int x1 = MIN(x * 2 + 1, in_w - 1);
+
+			for (int k = 0; k < byte_mult; k++) {
+				int sum = in_data[(y0 * in_w + x0) * byte_mult + k] + in_data[(y0 * in_w + x1) * byte_mult + k]
+					+ in_data[(y1 * in_w + x0) * byte_mult + k] + in_data[(y1 * in_w + x1) * byte_mult + k];
+
+				*out_data++ = (ubyte)((sum + 2) / 4);
+			}
+		}
+	}
+}
+
 int opengl_compress_image( ubyte **compressed_data, ubyte *in_data, int width, int height, int alpha, int num_mipmaps )
 {
 	Assert( in_data != NULL );
@@ -1191,6 +1723,37 @@ int opengl_compress_image( ubyte **compressed_data, ubyte *in_data, int width, i
 	glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_INTERNAL_FORMAT, &compressed);
 	Assert( compressed == intFormat );
 
+	// mipmaps can't be generated for compressed formats so every level is made from the uncompressed one above it
+	if (num_mipmaps > 1) {
+		int byte_mult = (alpha) ? 4 : 3;
+		int mip_w = width;
+		int mip_h = height;
+		ubyte *mip_data[2];
+
+		mip_data[0] = (ubyte*)vm_malloc(MAX(width / 2, 1) * MAX(height / 2, 1) * byte_mult);
+		mip_data[1] = (ubyte*)vm_malloc(MAX(width / 4, 1) * MAX(height / 4, 1) * byte_mult);
+
+		ubyte *prev_data = in_data;
+
+		for (i = 1; i < num_mipmaps; i++) {
+			int prev_w = mip_w;
+			int prev_h = mip_h;
+			ubyte *level_data = mip_data[(i - 1) & 1];
+
+			mip_w = MAX(mip_w / 2, 1);
+			mip_h = MAX(mip_h / 2, 1);
+
+			opengl_downsample_image(level_data, prev_data, prev_w, prev_h, mip_w, mip_h, byte_mult);
+
+			glTexImage2D(GL_TEXTURE_2D, i, intFormat, mip_w, mip_h, 0, glFormat, texFormat, level_data);
+
+			prev_data = level_data;
+		}
+
+		vm_free(mip_data[0]);
+		vm_free(mip_data[1]);
+	}
+
 	// for each mipmap level we generate go ahead and figure up the total memory required
 	for (i = 0; i < num_mipmaps; i++) {
 		glGetTexLevelParameteriv(GL_TEXTURE_2D, i, GL_TEXTURE_COMPRESSED_IMAGE_SIZE, &testing);
@@ -1360,6 +1923,8 @@ void gr_opengl_update_texture(int bitmap_handle, int bpp, const ubyte* data, int
 	tcache_slot_opengl *t = &Textures[n];
 	if(!t->texture_id)
 		return;
+	// the array copy is created again from the new data once it's needed
+	opengl_texture_array_release(t);
 	int byte_mult = (bpp >> 3);
 	int true_byte_mult = (t->bpp >> 3);
 	ubyte* texmem = NULL;
@@ -1412,12 +1977,124 @@ void gr_opengl_update_texture(int bitmap_handle, int bpp, const ubyte* data, int
 		}
 	}
 	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
-	glBindTexture(GL_TEXTURE_2D, t->texture_id);
+	GL_state.Texture.SetTarget(GL_TEXTURE_2D);
+	GL_state.Texture.Enable(t->texture_id);
 	glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width, height, glFormat, texFormat, (texmem)?texmem:data);
 	if (texmem != NULL)
 		vm_free(texmem);
 }
 
+// -----------------------------------------------------------------------------
+// transient textures, see opengl_acquire_transient_texture()
+//
+
+struct transient_texture_t {
+	GLuint texture_id = 0;
+	int width = 0;
+	int height = 0;
+	GLint internal_format = 0;
+	int levels = 0;
+
+	bool in_use = false;
+	int last_used_frame = -1;
+};
+
+// a texture nobody asked for in this many frames is deleted, e.g. after the bloom got turned off or the size changed
+static const int TRANSIENT_TEXTURE_MAX_IDLE_FRAMES = 60;
+
+static SCP_vector<transient_texture_t> Transient_textures;
+
+GLuint opengl_acquire_transient_texture(int width, int height, GLint internal_format, int levels)
+{
+	Assertion(width > 0 && height > 0 && levels > 0, "Invalid transient texture of %dx%d with %d levels!", width, height, levels);
+
+	for (auto& tex : Transient_textures) {
+		if (!tex.in_use && (tex.width == width) && (tex.height == height) && (tex.internal_format == internal_format)
+			&& (tex.levels == levels)) {
+			tex.in_use = true;
+			tex.last_used_frame = GL_texture_frame;
+			return tex.texture_id;
+		}
+	}
+
+	transient_texture_t tex;
+	tex.width = width;
+	tex.height = height;
+	tex.internal_format = internal_format;
+	tex.levels = levels;
+	tex.in_use = true;
+	tex.last_used_frame = GL_texture_frame;
+
+	glGenTextures(1, &tex.texture_id);
+
+	GL_state.Texture.SetActiveUnit(0);
+	GL_state.Texture.SetTarget(GL_TEXTURE_2D);
+	GL_state.Texture.Enable(tex.texture_id);
+
+	for (int level = 0; level < levels; ++level) {
+		glTexImage2D(GL_TEXTURE_2D, level, internal_format, MAX(width >> level, 1), MAX(height >> level, 1), 0, GL_BGRA,
+			GL_UNSIGNED_INT_8_8_8_8_REV, NULL);
+	}
+
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, (levels > 1) ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, levels - 1);
+
+	opengl_set_object_label(GL_TEXTURE, tex.texture_id, "Transient texture");
+
+	mprintf(("OpenGL: Created %dx%d transient texture with %d levels.\n", width, height, levels));
+
+	Transient_textures.push_back(tex);
+
+	return tex.texture_id;
+}
+
+void opengl_release_transient_texture(GLuint texture_id)
+{
+	for (auto& tex : Transient_textures) {
+		if (tex.texture_id == texture_id) {
+			Assertion(tex.in_use, "Transient texture %u was released twice!", texture_id);
+			tex.in_use = false;
+			return;
+		}
+	}
+
+	Assertion(false, "Texture %u is not a transient texture!", texture_id);
+}
+
+void opengl_transient_textures_frame()
+{
+	for (auto iter = Transient_textures.begin(); iter != Transient_textures.end();) {
+		if (iter->in_use) {
+			// whoever forgot it can't rely on the contents anyway
+			mprintf(("OpenGL: Transient texture %u was not released before the end of the frame!\n", iter->texture_id));
+			iter->in_use = false;
+		}
+
+		if (GL_texture_frame - iter->last_used_frame > TRANSIENT_TEXTURE_MAX_IDLE_FRAMES) {
+			GL_state.Texture.Delete(iter->texture_id);
+			glDeleteTextures(1, &iter->texture_id);
+
+			iter = Transient_textures.erase(iter);
+		} else {
+			++iter;
+		}
+	}
+}
+
+void opengl_kill_transient_textures()
+{
+	for (auto& tex : Transient_textures) {
+		GL_state.Texture.Delete(tex.texture_id);
+		glDeleteTextures(1, &tex.texture_id);
+	}
+
+	Transient_textures.clear();
+}
+
 // -----------------------------------------------------------------------------
 // GL_EXT_framebuffer_object stuff (ie, render-to-texture)
 //
@@ -1502,7 +2179,7 @@ static fbo_t *opengl_get_fbo(int width, int height)
 
 void opengl_kill_render_target(int slot)
 {
-	if ( (slot < 0) || (slot >= MAX_BITMAPS) ) {
+	if ( (slot < 0) || (slot >= (int)Textures.size()) ) {
 		Int3();
 		return;
 	}
@@ -1573,6 +2250,9 @@ int opengl_set_render_target( int slot, int face, int is_static )
 
 	GL_CHECK_FOR_ERRORS("start of set_render_target()");
 
+	// the batched strings belong to the current target
+	opengl_flush_string_batch();
+
 	if (slot < 0) {
 		if ( (render_target != NULL) && (render_target->working_slot >= 0) ) {
 			if (Textures[render_target->working_slot].mipmap_levels > 1) {
@@ -1815,10 +2495,10 @@ int opengl_make_render_target( int handle, int slot, int *w, int *h, int *bpp, i
 
 	glTexParameteri(GL_texture_target, GL_TEXTURE_MAX_LEVEL, ts->mipmap_levels - 1);
 
-	// render buffer
-//	glGenRenderbuffers(1, &new_fbo.renderbuffer_id);
-//	glBindRenderbuffer(GL_RENDERBUFFER, new_fbo.renderbuffer_id);
-//	glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, *w, *h);
+	// depth buffer, shared by all the targets of this size so models can be drawn into them
+	glGenRenderbuffers(1, &new_fbo.renderbuffer_id);
+	glBindRenderbuffer(GL_RENDERBUFFER, new_fbo.renderbuffer_id);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, *w, *h);
 	glBindRenderbuffer(GL_RENDERBUFFER, 0);
 
 	// frame buffer
@@ -1831,7 +2511,7 @@ int opengl_make_render_target( int handle, int slot, int *w, int *h, int *bpp, i
 		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_state.Texture.GetTarget(), ts->texture_id, 0);
 	}
 
-//	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, new_fbo.renderbuffer_id);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, new_fbo.renderbuffer_id);
 
 	if ( opengl_check_framebuffer() ) {
 		// Oops!!  reset everything and then bail
@@ -1845,7 +2525,7 @@ int opengl_make_render_target( int handle, int slot, int *w, int *h, int *bpp, i
 
 		glDeleteFramebuffers(1, &new_fbo.framebuffer_id);
 
-	//	glDeleteRenderbuffersEXT(1, &new_fbo.renderbuffer_id);
+		glDeleteRenderbuffers(1, &new_fbo.renderbuffer_id);
 
 		opengl_set_texture_target();
 
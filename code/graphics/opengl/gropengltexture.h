@@ -27,10 +27,17 @@ typedef struct tcache_slot_opengl {
 	int bpp;
 	int mipmap_levels;
 
+	// the texture array which holds a copy of this texture, see opengl_tcache_set_array()
+	int array_index;
+	int array_layer;
+
+	// the texture cache frame this texture was last bound in, used for picking textures to evict
+	int last_used_frame;
+
 	tcache_slot_opengl() :
 		texture_id(0), texture_target(GL_TEXTURE_2D), wrap_mode(GL_REPEAT),
 		u_scale(1.0f), v_scale(1.0f), bitmap_handle(-1), size(0), w(0), h(0),
-		bpp(0), mipmap_levels(0)
+		bpp(0), mipmap_levels(0), array_index(-1), array_layer(-1), last_used_frame(-1)
 	{
 	}
 
@@ -47,6 +54,9 @@ typedef struct tcache_slot_opengl {
 		h = 0;
 		bpp = 0;
 		mipmap_levels = 0;
+		array_index = -1;
+		array_layer = -1;
+		last_used_frame = -1;
 	}
 } tcache_slot_opengl;
 
@@ -67,6 +77,7 @@ extern GLint GL_max_renderbuffer_size;
 void opengl_switch_arb(int unit, int state);
 void opengl_tcache_init();
 void opengl_free_texture_slot(int n);
+void opengl_tcache_add_slot(int n);
 void opengl_tcache_flush();
 void opengl_tcache_shutdown();
 void opengl_tcache_frame();
@@ -84,10 +95,46 @@ void opengl_set_texture_target(GLenum target = GL_TEXTURE_2D);
 void opengl_set_texture_face(GLenum face = GL_TEXTURE_2D);
 
 int gr_opengl_tcache_set(int bitmap_handle, int bitmap_type, float *u_scale, float *v_scale, int stage = 0);
+
+/**
+ * @brief Binds the texture array which holds a bitmap
+ *
+ * Textures of the same format and size share one GL_TEXTURE_2D_ARRAY so switching between them only requires a
+ * different layer index instead of a new texture binding.
+ *
+ * @param bitmap_handle The bitmap to bind, this may not be a render target or a cube map
+ * @param tex_unit The texture unit the array is bound to
+ * @return The layer of the bitmap in the bound array or -1 if the bitmap could not be put into an array. While the
+ * bitmap is still streaming in a placeholder array is bound and 0 is returned.
+ */
+int opengl_tcache_set_array(int bitmap_handle, int tex_unit = 0);
 int gr_opengl_preload(int bitmap_num, int is_aabitmap);
 void gr_opengl_set_texture_panning(float u, float v, bool enable);
 void gr_opengl_set_texture_addressing(int mode);
 GLuint opengl_get_rtt_framebuffer();
+
+/**
+ * @brief Gets a texture for passes which only need it during a part of the frame
+ *
+ * Textures of the same size, format and number of levels are shared by passes which don't overlap: once a pass
+ * released its texture, the next pass asking for the same kind gets it back instead of a new one. The contents are
+ * undefined. Textures which weren't asked for in a while are deleted.
+ *
+ * @param width The width of the first level
+ * @param height The height of the first level
+ * @param internal_format The OpenGL internal format of the texture, e.g. GL_RGBA16F
+ * @param levels The number of mipmap levels
+ * @return The GL_TEXTURE_2D, it has to be released again in the same frame
+ */
+GLuint opengl_acquire_transient_texture(int width, int height, GLint internal_format, int levels = 1);
+
+/**
+ * @brief Gives a texture from opengl_acquire_transient_texture() back to the passes which come after
+ */
+void opengl_release_transient_texture(GLuint texture_id);
+
+void opengl_transient_textures_frame();
+void opengl_kill_transient_textures();
 void gr_opengl_bm_generate_mip_maps(int slot);
 void gr_opengl_get_texture_scale(int bitmap_handle, float *u_scale, float *v_scale);
 
@@ -27,6 +27,7 @@
 #include "lighting/lighting.h"
 #include "math/vecmat.h"
 #include "render/3d.h"
+#include "tracing/tracing.h"
 #include "weapon/trails.h"
 #include "particle/particle.h"
 #include "graphics/shadows.h"
@@ -66,11 +67,18 @@ GLint GL_max_elements_indices = 4096;
 
 size_t GL_transform_buffer_offset = INVALID_SIZE;
 
+// number of instances of the next model draw, the transforms of each instance follow the ones of the previous instance
+int GL_transform_buffer_instances = 1;
+size_t GL_transform_buffer_instance_stride = 0;
+
 GLuint Shadow_map_texture = 0;
 GLuint Shadow_map_depth_texture = 0;
 GLuint shadow_fbo = 0;
 bool Rendering_to_shadow_map = false;
 
+// the cascades after these keep the content they got in an earlier frame
+int GL_shadow_map_cascades = 4;
+
 int Transform_buffer_handle = -1;
 
 transform_stack GL_model_matrix_stack;
@@ -87,15 +95,22 @@ struct opengl_buffer_object {
 	size_t size;
 
 	GLuint texture;	// for texture buffer objects
+	GLenum texture_format;
 };
 
 static SCP_vector<opengl_buffer_object> GL_buffer_objects;
 static int GL_vertex_buffers_in_use = 0;
 
+// The immediate buffer is a ring with one segment for every frame the GPU may still be working on. Each segment is
+// protected by a fence so the data can be written into the mapped buffer without the driver having to synchronize.
+static const int IMMEDIATE_BUFFER_SEGMENTS = 3;
+static const size_t IMMEDIATE_BUFFER_MIN_SEGMENT_SIZE = 256 * 1024;
+
 int GL_immediate_buffer_handle = -1;
-static uint GL_immediate_buffer_offset = 0;
-static uint GL_immediate_buffer_size = 0;
-static const int IMMEDIATE_BUFFER_RESIZE_BLOCK_SIZE = 2048;
+static size_t GL_immediate_buffer_segment_size = 0;
+static size_t GL_immediate_buffer_offset = 0;
+static int GL_immediate_buffer_segment = 0;
+static GLsync GL_immediate_buffer_fences[IMMEDIATE_BUFFER_SEGMENTS] = { nullptr };
 
 int opengl_create_buffer_object(GLenum type, GLenum usage)
 {
@@ -106,6 +121,8 @@ int opengl_create_buffer_object(GLenum type, GLenum usage)
 	buffer_obj.usage = usage;
 	buffer_obj.type = type;
 	buffer_obj.size = 0;
+	buffer_obj.texture = 0;
+	buffer_obj.texture_format = GL_NONE;
 
 	glGenBuffers(1, &buffer_obj.buffer_id);
 
@@ -159,6 +176,11 @@ void gr_opengl_update_buffer_data(int handle, size_t size, void* data)
 	GL_vertex_data_in += buffer_obj.size;
 
 	glBufferData(buffer_obj.type, size, data, buffer_obj.usage);
+
+	if ( data != nullptr ) {
+		++GL_frame_stats.buffer_uploads;
+		GL_frame_stats.buffer_upload_bytes += size;
+	}
 }
 
 void opengl_update_buffer_data_offset(int handle, uint offset, uint size, void* data)
@@ -173,6 +195,18 @@ void opengl_update_buffer_data_offset(int handle, uint offset, uint size, void*
 	opengl_bind_buffer_object(handle);
 	
 	glBufferSubData(buffer_obj.type, offset, size, data);
+
+	++GL_frame_stats.buffer_uploads;
+	GL_frame_stats.buffer_upload_bytes += size;
+}
+
+void gr_opengl_update_buffer_data_offset(int handle, size_t offset, size_t size, void* data)
+{
+	Assert(handle >= 0);
+	Assert((size_t)handle < GL_buffer_objects.size());
+	Assertion(offset + size <= GL_buffer_objects[handle].size, "Buffer update of %d bytes at offset %d is out of bounds!", (int)size, (int)offset);
+
+	opengl_update_buffer_data_offset(handle, (uint)offset, (uint)size, data);
 }
 
 void gr_opengl_delete_buffer(int handle)
@@ -223,32 +257,122 @@ int gr_opengl_create_index_buffer(bool static_buffer)
 	return opengl_create_buffer_object(GL_ELEMENT_ARRAY_BUFFER, static_buffer ? GL_STATIC_DRAW : GL_STREAM_DRAW);
 }
 
-uint opengl_add_to_immediate_buffer(uint size, void *data)
+static void opengl_delete_immediate_buffer_fences()
 {
-	GR_DEBUG_SCOPE("Add data to immediate buffer");
+	for ( auto& fence : GL_immediate_buffer_fences ) {
+		if ( fence != nullptr ) {
+			glDeleteSync(fence);
+			fence = nullptr;
+		}
+	}
+}
 
+/**
+ * @brief Reserves a range of the current segment of the immediate buffer
+ * @return The offset of the range from the start of the buffer, a multiple of alignment
+ */
+static size_t opengl_reserve_immediate_buffer(size_t size, size_t alignment)
+{
 	if ( GL_immediate_buffer_handle < 0 ) {
 		GL_immediate_buffer_handle = opengl_create_buffer_object(GL_ARRAY_BUFFER, GL_STREAM_DRAW);
 	}
 
-	Assert(size > 0 && data != NULL);
+	auto& fence = GL_immediate_buffer_fences[GL_immediate_buffer_segment];
+	if ( fence != nullptr ) {
+		// The segment was last used IMMEDIATE_BUFFER_SEGMENTS frames ago so this should almost never have to wait
+		GR_DEBUG_SCOPE("Wait for immediate buffer segment");
 
-	if ( GL_immediate_buffer_offset + size > GL_immediate_buffer_size ) {
-		// incoming data won't fit the immediate buffer. time to reallocate.
-		GL_immediate_buffer_offset = 0;
-		GL_immediate_buffer_size += MAX(IMMEDIATE_BUFFER_RESIZE_BLOCK_SIZE, size);
-		
-		gr_opengl_update_buffer_data(GL_immediate_buffer_handle, GL_immediate_buffer_size, NULL);
+		GLenum result;
+		do {
+			result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000);
+		} while ( result == GL_TIMEOUT_EXPIRED );
+
+		glDeleteSync(fence);
+		fence = nullptr;
 	}
 
-	// only update a section of the immediate vertex buffer
-	opengl_update_buffer_data_offset(GL_immediate_buffer_handle, GL_immediate_buffer_offset, size, data);
+	auto segment_start = GL_immediate_buffer_segment * GL_immediate_buffer_segment_size;
+	auto start = ((segment_start + GL_immediate_buffer_offset + alignment - 1) / alignment) * alignment;
+
+	if ( start + size > segment_start + GL_immediate_buffer_segment_size ) {
+		// incoming data won't fit the current segment. time to reallocate. The draws issued so far still use the old
+		// storage so orphaning the buffer is safe and none of the fences are needed anymore.
+		auto segment_size = MAX(GL_immediate_buffer_segment_size * 2, IMMEDIATE_BUFFER_MIN_SEGMENT_SIZE);
+		while ( segment_size < size + alignment ) {
+			segment_size *= 2;
+		}
+
+		GL_immediate_buffer_segment_size = segment_size;
+		gr_opengl_update_buffer_data(GL_immediate_buffer_handle, GL_immediate_buffer_segment_size * IMMEDIATE_BUFFER_SEGMENTS, nullptr);
 
-	uint old_offset = GL_immediate_buffer_offset;
+		opengl_delete_immediate_buffer_fences();
 
-	GL_immediate_buffer_offset += size;
+		segment_start = GL_immediate_buffer_segment * GL_immediate_buffer_segment_size;
+		start = ((segment_start + alignment - 1) / alignment) * alignment;
+	}
+
+	GL_immediate_buffer_offset = start + size - segment_start;
 
-	return old_offset;
+	return start;
+}
+
+void* gr_opengl_map_immediate_buffer(size_t size, size_t alignment, int* buffer_handle, size_t* offset)
+{
+	GR_DEBUG_SCOPE("Map immediate buffer");
+
+	Assert(size > 0 && alignment > 0);
+
+	auto start = opengl_reserve_immediate_buffer(size, alignment);
+
+	opengl_bind_buffer_object(GL_immediate_buffer_handle);
+
+	// The fence of the segment has already been waited on so the driver doesn't need to synchronize anything
+	auto ptr = glMapBufferRange(GL_ARRAY_BUFFER, (GLintptr)start, (GLsizeiptr)size,
+		GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+
+	if ( ptr == nullptr ) {
+		return nullptr;
+	}
+
+	*buffer_handle = GL_immediate_buffer_handle;
+	*offset = start;
+
+	++GL_frame_stats.buffer_uploads;
+	GL_frame_stats.buffer_upload_bytes += size;
+
+	return ptr;
+}
+
+void gr_opengl_unmap_immediate_buffer()
+{
+	GR_DEBUG_SCOPE("Unmap immediate buffer");
+
+	Assert(GL_immediate_buffer_handle >= 0);
+
+	opengl_bind_buffer_object(GL_immediate_buffer_handle);
+
+	glUnmapBuffer(GL_ARRAY_BUFFER);
+}
+
+uint opengl_add_to_immediate_buffer(uint size, void *data)
+{
+	GR_DEBUG_SCOPE("Add data to immediate buffer");
+
+	Assert(size > 0 && data != NULL);
+
+	int handle;
+	size_t offset;
+	auto ptr = gr_opengl_map_immediate_buffer(size, 1, &handle, &offset);
+
+	if ( ptr != nullptr ) {
+		memcpy(ptr, data, size);
+		gr_opengl_unmap_immediate_buffer();
+	} else {
+		offset = opengl_reserve_immediate_buffer(size, 1);
+		opengl_update_buffer_data_offset(GL_immediate_buffer_handle, (uint)offset, size, data);
+	}
+
+	return (uint)offset;
 }
 
 void opengl_reset_immediate_buffer()
@@ -258,14 +382,19 @@ void opengl_reset_immediate_buffer()
 		return;
 	}
 
-	// orphan the immediate buffer so we can start fresh in a new frame
-	gr_opengl_update_buffer_data(GL_immediate_buffer_handle, GL_immediate_buffer_size, NULL);
+	// the segment can be used again once the GPU has finished the commands of this frame
+	auto& fence = GL_immediate_buffer_fences[GL_immediate_buffer_segment];
+	if ( fence != nullptr ) {
+		glDeleteSync(fence);
+	}
+	fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
 
-	// bring our offset to the beginning of the immediate buffer
+	// continue with the next segment of the immediate buffer
+	GL_immediate_buffer_segment = (GL_immediate_buffer_segment + 1) % IMMEDIATE_BUFFER_SEGMENTS;
 	GL_immediate_buffer_offset = 0;
 }
 
-int opengl_create_texture_buffer_object()
+int opengl_create_texture_buffer_object(GLenum format)
 {
 	// create the buffer
 	int buffer_object_handle = opengl_create_buffer_object(GL_TEXTURE_BUFFER, GL_DYNAMIC_DRAW);
@@ -276,40 +405,57 @@ int opengl_create_texture_buffer_object()
 
 	// create the texture
 	glGenTextures(1, &buffer_obj.texture);
-	glBindTexture(GL_TEXTURE_BUFFER, buffer_obj.texture);
+	GL_state.Texture.SetTarget(GL_TEXTURE_BUFFER);
+	GL_state.Texture.Enable(buffer_obj.texture);
+
+	buffer_obj.texture_format = format;
 
 	gr_opengl_update_buffer_data(buffer_object_handle, 100, NULL);
 
-	glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, buffer_obj.buffer_id);
+	glTexBuffer(GL_TEXTURE_BUFFER, buffer_obj.texture_format, buffer_obj.buffer_id);
 
 	opengl_check_for_errors();
 
 	return buffer_object_handle;
 }
 
-void gr_opengl_update_transform_buffer(void* data, size_t size)
+void opengl_update_texture_buffer_object(int handle, size_t size, void* data)
 {
-	if ( Transform_buffer_handle < 0 || size <= 0 ) {
-		return;
-	}
+	Assert(handle >= 0);
+	Assert((size_t)handle < GL_buffer_objects.size());
 
-	gr_opengl_update_buffer_data(Transform_buffer_handle, size, data);
+	gr_opengl_update_buffer_data(handle, size, data);
 
-	opengl_buffer_object &buffer_obj = GL_buffer_objects[Transform_buffer_handle];
+	opengl_buffer_object &buffer_obj = GL_buffer_objects[handle];
 
 	// need to rebind the buffer object to the texture buffer after it's been updated.
 	// didn't have to do this on AMD and Nvidia drivers but Intel drivers seem to want it.
-	glBindTexture(GL_TEXTURE_BUFFER, buffer_obj.texture);
-	glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, buffer_obj.buffer_id);
+	GL_state.Texture.SetTarget(GL_TEXTURE_BUFFER);
+	GL_state.Texture.Enable(buffer_obj.texture);
+	glTexBuffer(GL_TEXTURE_BUFFER, buffer_obj.texture_format, buffer_obj.buffer_id);
 }
 
-GLuint opengl_get_transform_buffer_texture()
+GLuint opengl_get_texture_buffer_texture(int handle)
 {
-	if ( Transform_buffer_handle < 0 ) {
+	if ( handle < 0 ) {
 		return 0;
 	}
 
-	return GL_buffer_objects[Transform_buffer_handle].texture;
+	return GL_buffer_objects[handle].texture;
+}
+
+void gr_opengl_update_transform_buffer(void* data, size_t size)
+{
+	if ( Transform_buffer_handle < 0 || size <= 0 ) {
+		return;
+	}
+
+	opengl_update_texture_buffer_object(Transform_buffer_handle, size, data);
+}
+
+GLuint opengl_get_transform_buffer_texture()
+{
+	return opengl_get_texture_buffer_texture(Transform_buffer_handle);
 }
 
 void gr_opengl_set_transform_buffer_offset(size_t offset)
@@ -317,6 +463,14 @@ void gr_opengl_set_transform_buffer_offset(size_t offset)
 	GL_transform_buffer_offset = offset;
 }
 
+void gr_opengl_set_transform_buffer_instances(int num_instances, size_t instance_stride)
+{
+	Assert(num_instances >= 1);
+
+	GL_transform_buffer_instances = num_instances;
+	GL_transform_buffer_instance_stride = instance_stride;
+}
+
 void opengl_destroy_all_buffers()
 {
 	for ( uint i = 0; i < GL_buffer_objects.size(); i++ ) {
@@ -331,7 +485,7 @@ void opengl_tnl_init()
 	gr_opengl_deferred_light_cylinder_init(16);
 	gr_opengl_deferred_light_sphere_init(16, 16);
 
-	Transform_buffer_handle = opengl_create_texture_buffer_object();
+	Transform_buffer_handle = opengl_create_texture_buffer_object(GL_RGBA32F);
 
 	if ( Transform_buffer_handle < 0 ) {
 		Cmdline_no_batching = true;
@@ -412,7 +566,14 @@ void opengl_tnl_shutdown()
 		Shadow_map_texture = 0;
 	}
 
+	opengl_delete_immediate_buffer_fences();
+
 	opengl_destroy_all_buffers();
+
+	GL_immediate_buffer_handle = -1;
+	GL_immediate_buffer_segment_size = 0;
+	GL_immediate_buffer_offset = 0;
+	GL_immediate_buffer_segment = 0;
 }
 
 static void opengl_init_arrays(indexed_vertex_source *vert_src, vertex_buffer *bufferp)
@@ -428,7 +589,7 @@ static void opengl_init_arrays(indexed_vertex_source *vert_src, vertex_buffer *b
 	opengl_bind_vertex_layout(bufferp->layout, 0, ptr);
 }
 
-void opengl_render_model_program(model_material* material_info, indexed_vertex_source *vert_source, vertex_buffer* bufferp, buffer_data *datap)
+void opengl_render_model_program(model_material* material_info, indexed_vertex_source *vert_source, vertex_buffer* bufferp, size_t texi, size_t texi_count)
 {
 	GL_state.Texture.SetShaderMode(GL_TRUE);
 
@@ -436,9 +597,23 @@ void opengl_render_model_program(model_material* material_info, indexed_vertex_s
 
 	GLubyte *ibuffer = NULL;
 
+	buffer_data *datap = &bufferp->tex_buf[texi];
+
+	// merged texture buffers are drawn as one range of indices
 	size_t start = 0;
-	size_t end = (datap->n_verts - 1);
-	size_t count = (end - (start * 3) + 1);
+	size_t count = 0;
+	uint i_first = datap->i_first;
+	uint i_last = datap->i_last;
+
+	for ( size_t i = texi; i < texi + texi_count; ++i ) {
+		auto& tex_buf = bufferp->tex_buf[i];
+
+		Assert(i == texi || (tex_buf.flags & VB_FLAG_LARGE_INDEX) == (datap->flags & VB_FLAG_LARGE_INDEX));
+
+		count += tex_buf.n_verts;
+		i_first = MIN(i_first, tex_buf.i_first);
+		i_last = MAX(i_last, tex_buf.i_last);
+	}
 
 	GLenum element_type = (datap->flags & VB_FLAG_LARGE_INDEX) ? GL_UNSIGNED_INT : GL_UNSIGNED_SHORT;
 
@@ -453,15 +628,20 @@ void opengl_render_model_program(model_material* material_info, indexed_vertex_s
 		ibuffer = (GLubyte*)vert_source->Index_list;
 	}
 
+	++GL_frame_stats.draw_calls;
+
 	if ( Rendering_to_shadow_map ) {
 		glDrawElementsInstancedBaseVertex(GL_TRIANGLES, (GLsizei) count, element_type,
-										  ibuffer + (datap->index_offset + start), 4, (GLint)bufferp->vertex_num_offset);
+										  ibuffer + (datap->index_offset + start), GL_shadow_map_cascades, (GLint)bufferp->vertex_num_offset);
+	} else if ( GL_transform_buffer_instances > 1 ) {
+		glDrawElementsInstancedBaseVertex(GL_TRIANGLES, (GLsizei) count, element_type,
+										  ibuffer + (datap->index_offset + start), GL_transform_buffer_instances, (GLint)bufferp->vertex_num_offset);
 	} else {
 		if ( Cmdline_drawelements ) {
 			glDrawElementsBaseVertex(GL_TRIANGLES, (GLsizei) count,
 									 element_type, ibuffer + (datap->index_offset + start), (GLint)bufferp->vertex_num_offset);
 		} else {
-			glDrawRangeElementsBaseVertex(GL_TRIANGLES, datap->i_first, datap->i_last, (GLsizei) count,
+			glDrawRangeElementsBaseVertex(GL_TRIANGLES, i_first, i_last, (GLsizei) count,
 										  element_type, ibuffer + (datap->index_offset + start), (GLint)bufferp->vertex_num_offset);
 		}
 	}
@@ -469,18 +649,17 @@ void opengl_render_model_program(model_material* material_info, indexed_vertex_s
 	GL_state.Texture.SetShaderMode(GL_FALSE);
 }
 
-void gr_opengl_render_model(model_material* material_info, indexed_vertex_source *vert_source, vertex_buffer* bufferp, size_t texi)
+void gr_opengl_render_model(model_material* material_info, indexed_vertex_source *vert_source, vertex_buffer* bufferp, size_t texi, size_t texi_count)
 {
 	Assert(GL_htl_projection_matrix_set);
 	Assert(GL_htl_view_matrix_set);
 
 	Verify(bufferp != NULL);
+	Assert(texi + texi_count <= bufferp->tex_buf.size());
 
 	GL_CHECK_FOR_ERRORS("start of render_buffer()");
 
-	buffer_data *datap = &bufferp->tex_buf[texi];
-
-	opengl_render_model_program(material_info, vert_source, bufferp, datap);
+	opengl_render_model_program(material_info, vert_source, bufferp, texi, texi_count);
 
 	GL_CHECK_FOR_ERRORS("end of render_buffer()");
 }
@@ -491,6 +670,7 @@ extern GLuint Scene_depth_texture;
 extern GLuint Scene_position_texture;
 extern GLuint Distortion_texture[2];
 extern int Distortion_switch;
+extern bool Distortion_used;
 void opengl_create_perspective_projection_matrix(matrix4 *out, float left, float right, float bottom, float top, float near_dist, float far_dist)
 {
 	memset(out, 0, sizeof(matrix4));
@@ -590,6 +770,9 @@ void gr_opengl_end_instance_matrix()
 void gr_opengl_set_projection_matrix(float fov, float aspect, float z_near, float z_far)
 {
 	GL_CHECK_FOR_ERRORS("start of set_projection_matrix()()");
+
+	// the batched strings were positioned for the current matrices
+	opengl_flush_string_batch();
 	
 	if (GL_rendering_to_texture) {
 		glViewport(gr_screen.offset_x, gr_screen.offset_y, gr_screen.clip_width, gr_screen.clip_height);
@@ -619,6 +802,8 @@ void gr_opengl_end_projection_matrix()
 {
 	GL_CHECK_FOR_ERRORS("start of end_projection_matrix()");
 
+	opengl_flush_string_batch();
+
 	glViewport(0, 0, gr_screen.max_w, gr_screen.max_h);
 
 	GL_last_projection_matrix = GL_projection_matrix;
@@ -642,6 +827,8 @@ void gr_opengl_set_view_matrix(const vec3d *pos, const matrix *orient)
 
 	GL_CHECK_FOR_ERRORS("start of set_view_matrix()");
 
+	opengl_flush_string_batch();
+
 	opengl_create_view_matrix(&GL_view_matrix, pos, orient);
 	
 	GL_model_matrix_stack.clear();
@@ -679,6 +866,8 @@ void gr_opengl_end_view_matrix()
 {
 	Assert(GL_modelview_matrix_depth == 2);
 
+	opengl_flush_string_batch();
+
 	GL_model_matrix_stack.clear();
 	vm_matrix4_set_identity(&GL_view_matrix);
 	vm_matrix4_set_identity(&GL_model_view_matrix);
@@ -700,6 +889,8 @@ void gr_opengl_set_2d_matrix(/*int x, int y, int w, int h*/)
 	Assert( GL_htl_2d_matrix_set == 0 );
 	Assert( GL_htl_2d_matrix_depth == 0 );
 
+	opengl_flush_string_batch();
+
 	// the viewport needs to be the full screen size since glOrtho() is relative to it
 	glViewport(0, 0, gr_screen.max_w, gr_screen.max_h);
 
@@ -734,6 +925,8 @@ void gr_opengl_end_2d_matrix()
 
 	Assert( GL_htl_2d_matrix_depth == 1 );
 
+	opengl_flush_string_batch();
+
 	// reset viewport to what it was originally set to by the proj matrix
 	glViewport(gr_screen.offset_x, (gr_screen.max_h - gr_screen.offset_y - gr_screen.clip_height), gr_screen.clip_width, gr_screen.clip_height);
 
@@ -807,7 +1000,7 @@ void gr_opengl_set_clip_plane(vec3d *clip_normal, vec3d *clip_point)
 extern bool Glowpoint_override;
 bool Glowpoint_override_save;
 
-void gr_opengl_shadow_map_start(matrix4 *shadow_view_matrix, const matrix *light_orient)
+void gr_opengl_shadow_map_start(matrix4 *shadow_view_matrix, const matrix *light_orient, int num_cascades)
 {
 	if ( !Cmdline_shadow_quality )
 		return;
@@ -820,7 +1013,28 @@ void gr_opengl_shadow_map_start(matrix4 *shadow_view_matrix, const matrix *light
 	glDrawBuffers(1, buffers);
 
 	glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
-	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+	GL_shadow_map_cascades = MAX(1, MIN(num_cascades, MAX_SHADOW_CASCADES));
+
+	// all cascades are drawn in one layered pass so clearing them is the only part which is timed on its own
+	{
+		TRACE_SCOPE(tracing::ShadowMapClear);
+
+		if ( GL_shadow_map_cascades == MAX_SHADOW_CASCADES ) {
+			glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+		} else {
+			// glClear() affects every layer of a layered attachment so the cascades which are rendered again are
+			// attached one by one to keep the others intact
+			for ( int i = 0; i < GL_shadow_map_cascades; ++i ) {
+				glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, Shadow_map_depth_texture, 0, i);
+				glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, Shadow_map_texture, 0, i);
+				glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+			}
+
+			glFramebufferTexture(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, Shadow_map_depth_texture, 0);
+			glFramebufferTexture(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, Shadow_map_texture, 0);
+		}
+	}
 
 	gr_opengl_set_lighting(false,false);
 	
@@ -857,6 +1071,9 @@ void gr_opengl_shadow_map_end()
 
 void opengl_tnl_set_material(material* material_info, bool set_base_map)
 {
+	// the batched bitmaps are drawn before whatever uses this material
+	opengl_flush_bitmap_batch();
+
 	int shader_handle = material_info->get_shader_handle();
 	int base_map = material_info->get_texture_map(TM_BASE_TYPE);
 	vec4 clr = material_info->get_color();
@@ -909,6 +1126,22 @@ void opengl_tnl_set_material(material* material_info, bool set_base_map)
 	}
 }
 
+/**
+ * Binds one of the maps of a model material, packed into a texture array if the shader samples arrays
+ */
+static void opengl_tnl_set_model_texture(int bitmap_handle, opengl::uniform_id layer_uniform, int render_pass)
+{
+	if ( Current_shader->flags & SDR_FLAG_MODEL_TEXTURE_ARRAYS ) {
+		int layer = opengl_tcache_set_array(bitmap_handle, render_pass);
+
+		Current_shader->program->Uniforms.setUniformf(layer_uniform, (float)MAX(layer, 0));
+	} else {
+		float u_scale, v_scale;
+
+		gr_opengl_tcache_set(bitmap_handle, TCACHE_TYPE_NORMAL, &u_scale, &v_scale, render_pass);
+	}
+}
+
 void opengl_tnl_set_model_material(model_material *material_info)
 {
 	float u_scale, v_scale;
@@ -916,8 +1149,15 @@ void opengl_tnl_set_model_material(model_material *material_info)
 
 	opengl_tnl_set_material(material_info, false);
 
+	if ( material_info->is_depth_prepassed() ) {
+		// the depth pre-pass already wrote the depth, only the fragments which ended up in front are shaded
+		GL_state.DepthFunc(GL_EQUAL);
+		GL_state.DepthMask(GL_FALSE);
+	}
+
 	if ( GL_state.CullFace() ) {
-		GL_state.FrontFaceValue(GL_CW);
+		// the projection of a render target is flipped, which turns the winding of the triangles around
+		GL_state.FrontFaceValue(GL_rendering_to_texture ? GL_CCW : GL_CW);
 	}
 	
 	gr_opengl_set_center_alpha(material_info->get_center_alpha());
@@ -926,27 +1166,29 @@ void opengl_tnl_set_model_material(model_material *material_info)
 
 	GL_state.Texture.SetShaderMode(GL_TRUE);
 	
-	Current_shader->program->Uniforms.setUniformMatrix4f("modelViewMatrix", GL_model_view_matrix);
-	Current_shader->program->Uniforms.setUniformMatrix4f("modelMatrix", GL_model_matrix_stack.get_transform());
-	Current_shader->program->Uniforms.setUniformMatrix4f("viewMatrix", GL_view_matrix);
-	Current_shader->program->Uniforms.setUniformMatrix4f("projMatrix", GL_projection_matrix);
-	Current_shader->program->Uniforms.setUniformMatrix4f("textureMatrix", GL_texture_matrix);
+	Current_shader->program->Uniforms.setUniformMatrix4f(SDR_UNIFORM("modelViewMatrix"), GL_model_view_matrix);
+	Current_shader->program->Uniforms.setUniformMatrix4f(SDR_UNIFORM("modelMatrix"), GL_model_matrix_stack.get_transform());
+	Current_shader->program->Uniforms.setUniformMatrix4f(SDR_UNIFORM("viewMatrix"), GL_view_matrix);
+	Current_shader->program->Uniforms.setUniformMatrix4f(SDR_UNIFORM("projMatrix"), GL_projection_matrix);
+	Current_shader->program->Uniforms.setUniformMatrix4f(SDR_UNIFORM("textureMatrix"), GL_texture_matrix);
 
 	vec4 clr = material_info->get_color();
-	Current_shader->program->Uniforms.setUniform4f("color", clr);
+	Current_shader->program->Uniforms.setUniform4f(SDR_UNIFORM("color"), clr);
 
 	if ( Current_shader->flags & SDR_FLAG_MODEL_ANIMATED ) {
-		Current_shader->program->Uniforms.setUniformf("anim_timer", material_info->get_animated_effect_time());
-		Current_shader->program->Uniforms.setUniformi("effect_num", material_info->get_animated_effect());
-		Current_shader->program->Uniforms.setUniformf("vpwidth", 1.0f / gr_screen.max_w);
-		Current_shader->program->Uniforms.setUniformf("vpheight", 1.0f / gr_screen.max_h);
+		Current_shader->program->Uniforms.setUniformf(SDR_UNIFORM("anim_timer"), material_info->get_animated_effect_time());
+		Current_shader->program->Uniforms.setUniformi(SDR_UNIFORM("effect_num"), material_info->get_animated_effect());
+		float sample_w, sample_h;
+		opengl_get_scene_sample_size(&sample_w, &sample_h);
+		Current_shader->program->Uniforms.setUniformf(SDR_UNIFORM("vpwidth"), 1.0f / sample_w);
+		Current_shader->program->Uniforms.setUniformf(SDR_UNIFORM("vpheight"), 1.0f / sample_h);
 	}
 
 	if ( Current_shader->flags & SDR_FLAG_MODEL_CLIP ) {
 		if (material_info->is_clipped()) {
 			material::clip_plane &clip_info = material_info->get_clip_plane();
 			
-			Current_shader->program->Uniforms.setUniformi("use_clip_plane", 1);
+			Current_shader->program->Uniforms.setUniformi(SDR_UNIFORM("use_clip_plane"), 1);
 
 			vec4 clip_equation;
 			clip_equation.xyzw.x = clip_info.normal.xyz.x;
@@ -954,121 +1196,121 @@ void opengl_tnl_set_model_material(model_material *material_info)
 			clip_equation.xyzw.z = clip_info.normal.xyz.z;
 			clip_equation.xyzw.w = -vm_vec_dot(&clip_info.normal, &clip_info.position);
 
-			Current_shader->program->Uniforms.setUniform4f("clip_equation", clip_equation);
+			Current_shader->program->Uniforms.setUniform4f(SDR_UNIFORM("clip_equation"), clip_equation);
 		} else {
-			Current_shader->program->Uniforms.setUniformi("use_clip_plane", 0);
+			Current_shader->program->Uniforms.setUniformi(SDR_UNIFORM("use_clip_plane"), 0);
 		}
 	}
 
 	if ( Current_shader->flags & SDR_FLAG_MODEL_LIGHT ) {
 		int num_lights = MIN(Num_active_gl_lights, GL_max_lights) - 1;
 		float light_factor = material_info->get_light_factor();
-		Current_shader->program->Uniforms.setUniformi("n_lights", num_lights);
-		Current_shader->program->Uniforms.setUniform4fv("lightPosition", GL_max_lights, opengl_light_uniforms.Position);
-		Current_shader->program->Uniforms.setUniform3fv("lightDirection", GL_max_lights, opengl_light_uniforms.Direction);
-		Current_shader->program->Uniforms.setUniform3fv("lightDiffuseColor", GL_max_lights, opengl_light_uniforms.Diffuse_color);
-		Current_shader->program->Uniforms.setUniform3fv("lightSpecColor", GL_max_lights, opengl_light_uniforms.Spec_color);
-		Current_shader->program->Uniforms.setUniform1iv("lightType", GL_max_lights, opengl_light_uniforms.Light_type);
-		Current_shader->program->Uniforms.setUniform1fv("lightAttenuation", GL_max_lights, opengl_light_uniforms.Attenuation);
+		Current_shader->program->Uniforms.setUniformi(SDR_UNIFORM("n_lights"), num_lights);
+		Current_shader->program->Uniforms.setUniform4fv(SDR_UNIFORM("lightPosition"), GL_max_lights, opengl_light_uniforms.Position);
+		Current_shader->program->Uniforms.setUniform3fv(SDR_UNIFORM("lightDirection"), GL_max_lights, opengl_light_uniforms.Direction);
+		Current_shader->program->Uniforms.setUniform3fv(SDR_UNIFORM("lightDiffuseColor"), GL_max_lights, opengl_light_uniforms.Diffuse_color);
+		Current_shader->program->Uniforms.setUniform3fv(SDR_UNIFORM("lightSpecColor"), GL_max_lights, opengl_light_uniforms.Spec_color);
+		Current_shader->program->Uniforms.setUniform1iv(SDR_UNIFORM("lightType"), GL_max_lights, opengl_light_uniforms.Light_type);
+		Current_shader->program->Uniforms.setUniform1fv(SDR_UNIFORM("lightAttenuation"), GL_max_lights, opengl_light_uniforms.Attenuation);
 
 		if ( !material_info->get_center_alpha() ) {
-			Current_shader->program->Uniforms.setUniform3f("diffuseFactor", GL_light_color[0] * light_factor, GL_light_color[1] * light_factor, GL_light_color[2] * light_factor);
-			Current_shader->program->Uniforms.setUniform3f("ambientFactor", GL_light_ambient[0], GL_light_ambient[1], GL_light_ambient[2]);
+			Current_shader->program->Uniforms.setUniform3f(SDR_UNIFORM("diffuseFactor"), GL_light_color[0] * light_factor, GL_light_color[1] * light_factor, GL_light_color[2] * light_factor);
+			Current_shader->program->Uniforms.setUniform3f(SDR_UNIFORM("ambientFactor"), GL_light_ambient[0], GL_light_ambient[1], GL_light_ambient[2]);
 		} else {
-			//Current_shader->program->Uniforms.setUniform3f("diffuseFactor", GL_light_true_zero[0], GL_light_true_zero[1], GL_light_true_zero[2]);
-			//Current_shader->program->Uniforms.setUniform3f("ambientFactor", GL_light_true_zero[0], GL_light_true_zero[1], GL_light_true_zero[2]);
-			Current_shader->program->Uniforms.setUniform3f("diffuseFactor", GL_light_color[0] * light_factor, GL_light_color[1] * light_factor, GL_light_color[2] * light_factor);
-			Current_shader->program->Uniforms.setUniform3f("ambientFactor", GL_light_ambient[0], GL_light_ambient[1], GL_light_ambient[2]);
+			//Current_shader->program->Uniforms.setUniform3f(SDR_UNIFORM("diffuseFactor"), GL_light_true_zero[0], GL_light_true_zero[1], GL_light_true_zero[2]);
+			//Current_shader->program->Uniforms.setUniform3f(SDR_UNIFORM("ambientFactor"), GL_light_true_zero[0], GL_light_true_zero[1], GL_light_true_zero[2]);
+			Current_shader->program->Uniforms.setUniform3f(SDR_UNIFORM("diffuseFactor"), GL_light_color[0] * light_factor, GL_light_color[1] * light_factor, GL_light_color[2] * light_factor);
+			Current_shader->program->Uniforms.setUniform3f(SDR_UNIFORM("ambientFactor"), GL_light_ambient[0], GL_light_ambient[1], GL_light_ambient[2]);
 		}
 
 		if ( material_info->get_light_factor() > 0.25f && !Cmdline_no_emissive ) {
-			Current_shader->program->Uniforms.setUniform3f("emissionFactor", GL_light_emission[0], GL_light_emission[1], GL_light_emission[2]);
+			Current_shader->program->Uniforms.setUniform3f(SDR_UNIFORM("emissionFactor"), GL_light_emission[0], GL_light_emission[1], GL_light_emission[2]);
 		} else {
-			Current_shader->program->Uniforms.setUniform3f("emissionFactor", GL_light_zero[0], GL_light_zero[1], GL_light_zero[2]);
+			Current_shader->program->Uniforms.setUniform3f(SDR_UNIFORM("emissionFactor"), GL_light_zero[0], GL_light_zero[1], GL_light_zero[2]);
 		}
 
-		Current_shader->program->Uniforms.setUniformf("specPower", Cmdline_ogl_spec);
+		Current_shader->program->Uniforms.setUniformf(SDR_UNIFORM("specPower"), Cmdline_ogl_spec);
 
 		if ( Gloss_override_set ) {
-			Current_shader->program->Uniforms.setUniformf("defaultGloss", Gloss_override);
+			Current_shader->program->Uniforms.setUniformf(SDR_UNIFORM("defaultGloss"), Gloss_override);
 		} else {
-			Current_shader->program->Uniforms.setUniformf("defaultGloss", 0.6f); // add user configurable default gloss in the command line later
+			Current_shader->program->Uniforms.setUniformf(SDR_UNIFORM("defaultGloss"), 0.6f); // add user configurable default gloss in the command line later
 		}
 	}
 
 	if ( Current_shader->flags & SDR_FLAG_MODEL_DIFFUSE_MAP ) {
-		Current_shader->program->Uniforms.setUniformi("sBasemap", render_pass);
+		Current_shader->program->Uniforms.setUniformi(SDR_UNIFORM("sBasemap"), render_pass);
 
 		if ( material_info->is_desaturated() ) {
-			Current_shader->program->Uniforms.setUniformi("desaturate", 1);
+			Current_shader->program->Uniforms.setUniformi(SDR_UNIFORM("desaturate"), 1);
 		} else {
-			Current_shader->program->Uniforms.setUniformi("desaturate", 0);
+			Current_shader->program->Uniforms.setUniformi(SDR_UNIFORM("desaturate"), 0);
 		}
 
 		if ( Basemap_color_override_set ) {
-			Current_shader->program->Uniforms.setUniformi("overrideDiffuse", 1);
-			Current_shader->program->Uniforms.setUniform3f("diffuseClr", Basemap_color_override[0], Basemap_color_override[1], Basemap_color_override[2]);
+			Current_shader->program->Uniforms.setUniformi(SDR_UNIFORM("overrideDiffuse"), 1);
+			Current_shader->program->Uniforms.setUniform3f(SDR_UNIFORM("diffuseClr"), Basemap_color_override[0], Basemap_color_override[1], Basemap_color_override[2]);
 		} else {
-			Current_shader->program->Uniforms.setUniformi("overrideDiffuse", 0);
+			Current_shader->program->Uniforms.setUniformi(SDR_UNIFORM("overrideDiffuse"), 0);
 		}
 
 		switch ( material_info->get_blend_mode() ) {
 		case ALPHA_BLEND_PREMULTIPLIED:
-			Current_shader->program->Uniforms.setUniformi("blend_alpha", 1);
+			Current_shader->program->Uniforms.setUniformi(SDR_UNIFORM("blend_alpha"), 1);
 			break;
 		case ALPHA_BLEND_ADDITIVE:
-			Current_shader->program->Uniforms.setUniformi("blend_alpha", 2);
+			Current_shader->program->Uniforms.setUniformi(SDR_UNIFORM("blend_alpha"), 2);
 			break;
 		default:
-			Current_shader->program->Uniforms.setUniformi("blend_alpha", 0);
+			Current_shader->program->Uniforms.setUniformi(SDR_UNIFORM("blend_alpha"), 0);
 			break;
 		}
 
-		gr_opengl_tcache_set(material_info->get_texture_map(TM_BASE_TYPE), TCACHE_TYPE_NORMAL, &u_scale, &v_scale, render_pass);
+		opengl_tnl_set_model_texture(material_info->get_texture_map(TM_BASE_TYPE), SDR_UNIFORM("baseLayer"), render_pass);
 		
 		++render_pass;
 	}
 
 	if ( Current_shader->flags & SDR_FLAG_MODEL_GLOW_MAP ) {
-		Current_shader->program->Uniforms.setUniformi("sGlowmap", render_pass);
+		Current_shader->program->Uniforms.setUniformi(SDR_UNIFORM("sGlowmap"), render_pass);
 
 		if ( Glowmap_color_override_set ) {
-			Current_shader->program->Uniforms.setUniformi("overrideGlow", 1);
-			Current_shader->program->Uniforms.setUniform3f("glowClr", Glowmap_color_override[0], Glowmap_color_override[1], Glowmap_color_override[2]);
+			Current_shader->program->Uniforms.setUniformi(SDR_UNIFORM("overrideGlow"), 1);
+			Current_shader->program->Uniforms.setUniform3f(SDR_UNIFORM("glowClr"), Glowmap_color_override[0], Glowmap_color_override[1], Glowmap_color_override[2]);
 		} else {
-			Current_shader->program->Uniforms.setUniformi("overrideGlow", 0);
+			Current_shader->program->Uniforms.setUniformi(SDR_UNIFORM("overrideGlow"), 0);
 		}
 
-		gr_opengl_tcache_set(material_info->get_texture_map(TM_GLOW_TYPE), TCACHE_TYPE_NORMAL, &u_scale, &v_scale, render_pass);
+		opengl_tnl_set_model_texture(material_info->get_texture_map(TM_GLOW_TYPE), SDR_UNIFORM("glowLayer"), render_pass);
 
 		++render_pass;
 	}
 
 	if ( Current_shader->flags & SDR_FLAG_MODEL_SPEC_MAP ) {
-		Current_shader->program->Uniforms.setUniformi("sSpecmap", render_pass);
+		Current_shader->program->Uniforms.setUniformi(SDR_UNIFORM("sSpecmap"), render_pass);
 
 		if ( Specmap_color_override_set ) {
-			Current_shader->program->Uniforms.setUniformi("overrideSpec", 1);
-			Current_shader->program->Uniforms.setUniform3f("specClr", Specmap_color_override[0], Specmap_color_override[1], Specmap_color_override[2]);
+			Current_shader->program->Uniforms.setUniformi(SDR_UNIFORM("overrideSpec"), 1);
+			Current_shader->program->Uniforms.setUniform3f(SDR_UNIFORM("specClr"), Specmap_color_override[0], Specmap_color_override[1], Specmap_color_override[2]);
 		} else {
-			Current_shader->program->Uniforms.setUniformi("overrideSpec", 0);
+			Current_shader->program->Uniforms.setUniformi(SDR_UNIFORM("overrideSpec"), 0);
 		}
 
 		if ( material_info->get_texture_map(TM_SPEC_GLOSS_TYPE) > 0 ) {
-			gr_opengl_tcache_set(material_info->get_texture_map(TM_SPEC_GLOSS_TYPE), TCACHE_TYPE_NORMAL, &u_scale, &v_scale, render_pass);
+			opengl_tnl_set_model_texture(material_info->get_texture_map(TM_SPEC_GLOSS_TYPE), SDR_UNIFORM("specLayer"), render_pass);
 
-			Current_shader->program->Uniforms.setUniformi("gammaSpec", 1);
+			Current_shader->program->Uniforms.setUniformi(SDR_UNIFORM("gammaSpec"), 1);
 
 			if ( Gloss_override_set ) {
-				Current_shader->program->Uniforms.setUniformi("alphaGloss", 0);
+				Current_shader->program->Uniforms.setUniformi(SDR_UNIFORM("alphaGloss"), 0);
 			} else {
-				Current_shader->program->Uniforms.setUniformi("alphaGloss", 1);
+				Current_shader->program->Uniforms.setUniformi(SDR_UNIFORM("alphaGloss"), 1);
 			}
 		} else {
-			gr_opengl_tcache_set(material_info->get_texture_map(TM_SPECULAR_TYPE), TCACHE_TYPE_NORMAL, &u_scale, &v_scale, render_pass);
+			opengl_tnl_set_model_texture(material_info->get_texture_map(TM_SPECULAR_TYPE), SDR_UNIFORM("specLayer"), render_pass);
 
-			Current_shader->program->Uniforms.setUniformi("gammaSpec", 0);
-			Current_shader->program->Uniforms.setUniformi("alphaGloss", 0);
+			Current_shader->program->Uniforms.setUniformi(SDR_UNIFORM("gammaSpec"), 0);
+			Current_shader->program->Uniforms.setUniformi(SDR_UNIFORM("alphaGloss"), 0);
 		}
 		
 		++render_pass;
@@ -1081,13 +1323,13 @@ void opengl_tnl_set_model_material(model_material *material_info)
 			}
 
 			if ( material_info->get_texture_map(TM_SPEC_GLOSS_TYPE) > 0 || Gloss_override_set ) {
-				Current_shader->program->Uniforms.setUniformi("envGloss", 1);
+				Current_shader->program->Uniforms.setUniformi(SDR_UNIFORM("envGloss"), 1);
 			} else {
-				Current_shader->program->Uniforms.setUniformi("envGloss", 0);
+				Current_shader->program->Uniforms.setUniformi(SDR_UNIFORM("envGloss"), 0);
 			}
 
-			Current_shader->program->Uniforms.setUniformMatrix4f("envMatrix", texture_mat);
-			Current_shader->program->Uniforms.setUniformi("sEnvmap", render_pass);
+			Current_shader->program->Uniforms.setUniformMatrix4f(SDR_UNIFORM("envMatrix"), texture_mat);
+			Current_shader->program->Uniforms.setUniformi(SDR_UNIFORM("sEnvmap"), render_pass);
 
 			gr_opengl_tcache_set(ENVMAP, TCACHE_TYPE_CUBEMAP, &u_scale, &v_scale, render_pass);
 
@@ -1096,15 +1338,15 @@ void opengl_tnl_set_model_material(model_material *material_info)
 	}
 
 	if ( Current_shader->flags & SDR_FLAG_MODEL_NORMAL_MAP ) {
-		Current_shader->program->Uniforms.setUniformi("sNormalmap", render_pass);
+		Current_shader->program->Uniforms.setUniformi(SDR_UNIFORM("sNormalmap"), render_pass);
 
-		gr_opengl_tcache_set(material_info->get_texture_map(TM_NORMAL_TYPE), TCACHE_TYPE_NORMAL, &u_scale, &v_scale, render_pass);
+		opengl_tnl_set_model_texture(material_info->get_texture_map(TM_NORMAL_TYPE), SDR_UNIFORM("normalLayer"), render_pass);
 
 		++render_pass;
 	}
 
 	if ( Current_shader->flags & SDR_FLAG_MODEL_HEIGHT_MAP ) {
-		Current_shader->program->Uniforms.setUniformi("sHeightmap", render_pass);
+		Current_shader->program->Uniforms.setUniformi(SDR_UNIFORM("sHeightmap"), render_pass);
 
 		gr_opengl_tcache_set(material_info->get_texture_map(TM_HEIGHT_TYPE), TCACHE_TYPE_NORMAL, &u_scale, &v_scale, render_pass);
 
@@ -1112,29 +1354,29 @@ void opengl_tnl_set_model_material(model_material *material_info)
 	}
 
 	if ( Current_shader->flags & SDR_FLAG_MODEL_AMBIENT_MAP ) {
-		Current_shader->program->Uniforms.setUniformi("sAmbientmap", render_pass);
+		Current_shader->program->Uniforms.setUniformi(SDR_UNIFORM("sAmbientmap"), render_pass);
 
-		gr_opengl_tcache_set(material_info->get_texture_map(TM_AMBIENT_TYPE), TCACHE_TYPE_NORMAL, &u_scale, &v_scale, render_pass);
+		opengl_tnl_set_model_texture(material_info->get_texture_map(TM_AMBIENT_TYPE), SDR_UNIFORM("ambientLayer"), render_pass);
 
 		++render_pass;
 	}
 
 	if ( Current_shader->flags & SDR_FLAG_MODEL_MISC_MAP ) {
-		Current_shader->program->Uniforms.setUniformi("sMiscmap", render_pass);
+		Current_shader->program->Uniforms.setUniformi(SDR_UNIFORM("sMiscmap"), render_pass);
 
-		gr_opengl_tcache_set(material_info->get_texture_map(TM_MISC_TYPE), TCACHE_TYPE_NORMAL, &u_scale, &v_scale, render_pass);
+		opengl_tnl_set_model_texture(material_info->get_texture_map(TM_MISC_TYPE), SDR_UNIFORM("miscLayer"), render_pass);
 
 		++render_pass;
 	}
 
 	if ( Current_shader->flags & SDR_FLAG_MODEL_SHADOWS ) {
-		Current_shader->program->Uniforms.setUniformMatrix4f("shadow_mv_matrix", Shadow_view_matrix);
-		Current_shader->program->Uniforms.setUniformMatrix4fv("shadow_proj_matrix", MAX_SHADOW_CASCADES, Shadow_proj_matrix);
-		Current_shader->program->Uniforms.setUniformf("veryneardist", Shadow_cascade_distances[0]);
-		Current_shader->program->Uniforms.setUniformf("neardist", Shadow_cascade_distances[1]);
-		Current_shader->program->Uniforms.setUniformf("middist", Shadow_cascade_distances[2]);
-		Current_shader->program->Uniforms.setUniformf("fardist", Shadow_cascade_distances[3]);
-		Current_shader->program->Uniforms.setUniformi("shadow_map", render_pass);
+		Current_shader->program->Uniforms.setUniformMatrix4f(SDR_UNIFORM("shadow_mv_matrix"), Shadow_view_matrix);
+		Current_shader->program->Uniforms.setUniformMatrix4fv(SDR_UNIFORM("shadow_proj_matrix"), MAX_SHADOW_CASCADES, Shadow_proj_matrix);
+		Current_shader->program->Uniforms.setUniformf(SDR_UNIFORM("veryneardist"), Shadow_cascade_distances[0]);
+		Current_shader->program->Uniforms.setUniformf(SDR_UNIFORM("neardist"), Shadow_cascade_distances[1]);
+		Current_shader->program->Uniforms.setUniformf(SDR_UNIFORM("middist"), Shadow_cascade_distances[2]);
+		Current_shader->program->Uniforms.setUniformf(SDR_UNIFORM("fardist"), Shadow_cascade_distances[3]);
+		Current_shader->program->Uniforms.setUniformi(SDR_UNIFORM("shadow_map"), render_pass);
 
 		GL_state.Texture.SetActiveUnit(render_pass);
 		GL_state.Texture.SetTarget(GL_TEXTURE_2D_ARRAY);
@@ -1144,11 +1386,11 @@ void opengl_tnl_set_model_material(model_material *material_info)
 	}
 
 	if ( Current_shader->flags & SDR_FLAG_MODEL_SHADOW_MAP ) {
-		Current_shader->program->Uniforms.setUniformMatrix4fv("shadow_proj_matrix", MAX_SHADOW_CASCADES, Shadow_proj_matrix);
+		Current_shader->program->Uniforms.setUniformMatrix4fv(SDR_UNIFORM("shadow_proj_matrix"), MAX_SHADOW_CASCADES, Shadow_proj_matrix);
 	}
 
 	if ( Current_shader->flags & SDR_FLAG_MODEL_ANIMATED ) {
-		Current_shader->program->Uniforms.setUniformi("sFramebuffer", render_pass);
+		Current_shader->program->Uniforms.setUniformi(SDR_UNIFORM("sFramebuffer"), render_pass);
 
 		GL_state.Texture.SetActiveUnit(render_pass);
 		GL_state.Texture.SetTarget(GL_TEXTURE_2D);
@@ -1164,8 +1406,9 @@ void opengl_tnl_set_model_material(model_material *material_info)
 	}
 
 	if ( Current_shader->flags & SDR_FLAG_MODEL_TRANSFORM ) {
-		Current_shader->program->Uniforms.setUniformi("transform_tex", render_pass);
-		Current_shader->program->Uniforms.setUniformi("buffer_matrix_offset", (int)GL_transform_buffer_offset);
+		Current_shader->program->Uniforms.setUniformi(SDR_UNIFORM("transform_tex"), render_pass);
+		Current_shader->program->Uniforms.setUniformi(SDR_UNIFORM("buffer_matrix_offset"), (int)GL_transform_buffer_offset);
+		Current_shader->program->Uniforms.setUniformi(SDR_UNIFORM("buffer_matrix_stride"), (GL_transform_buffer_instances > 1) ? (int)GL_transform_buffer_instance_stride : 0);
 		
 		GL_state.Texture.SetActiveUnit(render_pass);
 		GL_state.Texture.SetTarget(GL_TEXTURE_BUFFER);
@@ -1190,18 +1433,18 @@ void opengl_tnl_set_model_material(model_material *material_info)
 		base_color.xyz.y = tm_clr.base.g;
 		base_color.xyz.z = tm_clr.base.b;
 
-		Current_shader->program->Uniforms.setUniform3f("stripe_color", stripe_color);
-		Current_shader->program->Uniforms.setUniform3f("base_color", base_color);
+		Current_shader->program->Uniforms.setUniform3f(SDR_UNIFORM("stripe_color"), stripe_color);
+		Current_shader->program->Uniforms.setUniform3f(SDR_UNIFORM("base_color"), base_color);
 
 		if ( bm_has_alpha_channel(material_info->get_texture_map(TM_MISC_TYPE)) ) {
-			Current_shader->program->Uniforms.setUniformi("team_glow_enabled", 1);
+			Current_shader->program->Uniforms.setUniformi(SDR_UNIFORM("team_glow_enabled"), 1);
 		} else {
-			Current_shader->program->Uniforms.setUniformi("team_glow_enabled", 0);
+			Current_shader->program->Uniforms.setUniformi(SDR_UNIFORM("team_glow_enabled"), 0);
 		}
 	}
 
 	if ( Current_shader->flags & SDR_FLAG_MODEL_THRUSTER ) {
-		Current_shader->program->Uniforms.setUniformf("thruster_scale", material_info->get_thrust_scale());
+		Current_shader->program->Uniforms.setUniformf(SDR_UNIFORM("thruster_scale"), material_info->get_thrust_scale());
 	}
 
 	
@@ -1209,18 +1452,18 @@ void opengl_tnl_set_model_material(model_material *material_info)
 		material::fog fog_params = material_info->get_fog();
 
 		if ( fog_params.enabled ) {
-			Current_shader->program->Uniforms.setUniformf("fogStart", fog_params.dist_near);
-			Current_shader->program->Uniforms.setUniformf("fogScale", 1.0f / (fog_params.dist_far - fog_params.dist_near));
-			Current_shader->program->Uniforms.setUniform4f("fogColor", i2fl(fog_params.r) / 255.0f, i2fl(fog_params.g) / 255.0f, i2fl(fog_params.b) / 255.0f, 1.0f);
+			Current_shader->program->Uniforms.setUniformf(SDR_UNIFORM("fogStart"), fog_params.dist_near);
+			Current_shader->program->Uniforms.setUniformf(SDR_UNIFORM("fogScale"), 1.0f / (fog_params.dist_far - fog_params.dist_near));
+			Current_shader->program->Uniforms.setUniform4f(SDR_UNIFORM("fogColor"), i2fl(fog_params.r) / 255.0f, i2fl(fog_params.g) / 255.0f, i2fl(fog_params.b) / 255.0f, 1.0f);
 		}
 	}
 
 	if ( Current_shader->flags & SDR_FLAG_MODEL_NORMAL_ALPHA ) {
-		Current_shader->program->Uniforms.setUniform2f("normalAlphaMinMax", material_info->get_normal_alpha_min(), material_info->get_normal_alpha_max());
+		Current_shader->program->Uniforms.setUniform2f(SDR_UNIFORM("normalAlphaMinMax"), material_info->get_normal_alpha_min(), material_info->get_normal_alpha_max());
 	}
 
 	if ( Current_shader->flags & SDR_FLAG_MODEL_NORMAL_EXTRUDE ) {
-		Current_shader->program->Uniforms.setUniformf("extrudeWidth", material_info->get_normal_extrude_width());
+		Current_shader->program->Uniforms.setUniformf(SDR_UNIFORM("extrudeWidth"), material_info->get_normal_extrude_width());
 	}
 
 	if ( Deferred_lighting ) {
@@ -1233,22 +1476,38 @@ void opengl_tnl_set_material_particle(particle_material * material_info)
 {
 	opengl_tnl_set_material(material_info, true);
 
-	Current_shader->program->Uniforms.setUniformMatrix4f("modelViewMatrix", GL_model_view_matrix);
-	Current_shader->program->Uniforms.setUniformMatrix4f("projMatrix", GL_projection_matrix);
+	Current_shader->program->Uniforms.setUniformMatrix4f(SDR_UNIFORM("modelViewMatrix"), GL_model_view_matrix);
+	Current_shader->program->Uniforms.setUniformMatrix4f(SDR_UNIFORM("projMatrix"), GL_projection_matrix);
+
+	Current_shader->program->Uniforms.setUniformi(SDR_UNIFORM("baseMap"), 0);
+	Current_shader->program->Uniforms.setUniformi(SDR_UNIFORM("depthMap"), 1);
+	float sample_w, sample_h;
+	opengl_get_scene_sample_size(&sample_w, &sample_h);
+	Current_shader->program->Uniforms.setUniformf(SDR_UNIFORM("window_width"), sample_w);
+	Current_shader->program->Uniforms.setUniformf(SDR_UNIFORM("window_height"), sample_h);
+	Current_shader->program->Uniforms.setUniformf(SDR_UNIFORM("nearZ"), Min_draw_distance);
+	Current_shader->program->Uniforms.setUniformf(SDR_UNIFORM("farZ"), Max_draw_distance);
+	Current_shader->program->Uniforms.setUniformi(SDR_UNIFORM("srgb"), High_dynamic_range ? 1 : 0);
+	Current_shader->program->Uniforms.setUniformi(SDR_UNIFORM("blend_alpha"), material_info->get_blend_mode() != ALPHA_BLEND_ADDITIVE);
+
+	if ( material_info->get_gpu_simulation() ) {
+		Current_shader->program->Uniforms.setUniformf(SDR_UNIFORM("particleTime"), material_info->get_simulation_time());
+		Current_shader->program->Uniforms.setUniform2f(SDR_UNIFORM("frameLifeRange"), material_info->get_frame_life_start(), material_info->get_frame_life_end());
+	}
 
-	Current_shader->program->Uniforms.setUniformi("baseMap", 0);
-	Current_shader->program->Uniforms.setUniformi("depthMap", 1);
-	Current_shader->program->Uniforms.setUniformf("window_width", (float)gr_screen.max_w);
-	Current_shader->program->Uniforms.setUniformf("window_height", (float)gr_screen.max_h);
-	Current_shader->program->Uniforms.setUniformf("nearZ", Min_draw_distance);
-	Current_shader->program->Uniforms.setUniformf("farZ", Max_draw_distance);
-	Current_shader->program->Uniforms.setUniformi("srgb", High_dynamic_range ? 1 : 0);
-	Current_shader->program->Uniforms.setUniformi("blend_alpha", material_info->get_blend_mode() != ALPHA_BLEND_ADDITIVE);
+	if ( material_info->get_nebula_poofs() ) {
+		extern float Physics_viewer_bank;
+
+		Current_shader->program->Uniforms.setUniformf(SDR_UNIFORM("particleTime"), material_info->get_simulation_time());
+		Current_shader->program->Uniforms.setUniform4f(SDR_UNIFORM("poofShells"), material_info->get_poof_shells());
+		Current_shader->program->Uniforms.setUniform3f(SDR_UNIFORM("poofBreak"), material_info->get_poof_break());
+		Current_shader->program->Uniforms.setUniformf(SDR_UNIFORM("viewerBank"), Physics_viewer_bank);
+	}
 
 	if ( Cmdline_no_deferred_lighting ) {
-		Current_shader->program->Uniforms.setUniformi("linear_depth", 0);
+		Current_shader->program->Uniforms.setUniformi(SDR_UNIFORM("linear_depth"), 0);
 	} else {
-		Current_shader->program->Uniforms.setUniformi("linear_depth", 1);
+		Current_shader->program->Uniforms.setUniformi(SDR_UNIFORM("linear_depth"), 1);
 	}
 
 	if ( !Cmdline_no_deferred_lighting ) {
@@ -1270,31 +1529,35 @@ void opengl_tnl_set_material_distortion(distortion_material* material_info)
 {
 	opengl_tnl_set_material(material_info, true);
 
-	Current_shader->program->Uniforms.setUniformMatrix4f("modelViewMatrix", GL_model_view_matrix);
-	Current_shader->program->Uniforms.setUniformMatrix4f("projMatrix", GL_projection_matrix);
+	Current_shader->program->Uniforms.setUniformMatrix4f(SDR_UNIFORM("modelViewMatrix"), GL_model_view_matrix);
+	Current_shader->program->Uniforms.setUniformMatrix4f(SDR_UNIFORM("projMatrix"), GL_projection_matrix);
 
-	Current_shader->program->Uniforms.setUniformi("baseMap", 0);
-	Current_shader->program->Uniforms.setUniformi("depthMap", 1);
-	Current_shader->program->Uniforms.setUniformf("window_width", (float)gr_screen.max_w);
-	Current_shader->program->Uniforms.setUniformf("window_height", (float)gr_screen.max_h);
-	Current_shader->program->Uniforms.setUniformf("nearZ", Min_draw_distance);
-	Current_shader->program->Uniforms.setUniformf("farZ", Max_draw_distance);
-	Current_shader->program->Uniforms.setUniformi("frameBuffer", 2);
+	Current_shader->program->Uniforms.setUniformi(SDR_UNIFORM("baseMap"), 0);
+	Current_shader->program->Uniforms.setUniformi(SDR_UNIFORM("depthMap"), 1);
+	float sample_w, sample_h;
+	opengl_get_scene_sample_size(&sample_w, &sample_h);
+	Current_shader->program->Uniforms.setUniformf(SDR_UNIFORM("window_width"), sample_w);
+	Current_shader->program->Uniforms.setUniformf(SDR_UNIFORM("window_height"), sample_h);
+	Current_shader->program->Uniforms.setUniformf(SDR_UNIFORM("nearZ"), Min_draw_distance);
+	Current_shader->program->Uniforms.setUniformf(SDR_UNIFORM("farZ"), Max_draw_distance);
+	Current_shader->program->Uniforms.setUniformi(SDR_UNIFORM("frameBuffer"), 2);
 
 	GL_state.Texture.SetActiveUnit(2);
 	GL_state.Texture.SetTarget(GL_TEXTURE_2D);
 	GL_state.Texture.Enable(Scene_effect_texture);
 
 	if(material_info->get_thruster_rendering()) {
-		Current_shader->program->Uniforms.setUniformi("distMap", 3);
+		Current_shader->program->Uniforms.setUniformi(SDR_UNIFORM("distMap"), 3);
 
 		GL_state.Texture.SetActiveUnit(3);
 		GL_state.Texture.SetTarget(GL_TEXTURE_2D);
 		GL_state.Texture.Enable(Distortion_texture[!Distortion_switch]);
-		Current_shader->program->Uniforms.setUniformf("use_offset", 1.0f);
+		Current_shader->program->Uniforms.setUniformf(SDR_UNIFORM("use_offset"), 1.0f);
+
+		Distortion_used = true;
 	} else {
-		Current_shader->program->Uniforms.setUniformi("distMap", 0);
-		Current_shader->program->Uniforms.setUniformf("use_offset", 0.0f);
+		Current_shader->program->Uniforms.setUniformi(SDR_UNIFORM("distMap"), 0);
+		Current_shader->program->Uniforms.setUniformf(SDR_UNIFORM("use_offset"), 0.0f);
 	}
 
 	Assert(Scene_depth_texture != 0);
@@ -65,10 +65,19 @@ int gr_opengl_create_index_buffer(bool static_buffer);
 
 void opengl_bind_buffer_object(int handle);
 void gr_opengl_update_buffer_data(int handle, size_t size, void* data);
+void gr_opengl_update_buffer_data_offset(int handle, size_t offset, size_t size, void* data);
 void gr_opengl_delete_buffer(int handle);
 
+int opengl_create_texture_buffer_object(GLenum format);
+void opengl_update_texture_buffer_object(int handle, size_t size, void* data);
+GLuint opengl_get_texture_buffer_texture(int handle);
+
 void gr_opengl_update_transform_buffer(void* data, size_t size);
 void gr_opengl_set_transform_buffer_offset(size_t offset);
+void gr_opengl_set_transform_buffer_instances(int num_instances, size_t instance_stride);
+
+void* gr_opengl_map_immediate_buffer(size_t size, size_t alignment, int* buffer_handle, size_t* offset);
+void gr_opengl_unmap_immediate_buffer();
 
 uint opengl_add_to_immediate_buffer(uint size, void *data);
 void opengl_reset_immediate_buffer();
@@ -76,8 +85,8 @@ void opengl_reset_immediate_buffer();
 void opengl_tnl_init();
 void opengl_tnl_shutdown();
 
-void gr_opengl_render_model(model_material* material_info, indexed_vertex_source *vert_source, vertex_buffer* bufferp, size_t texi);
-void opengl_render_model_program(model_material* material_info, indexed_vertex_source *vert_source, vertex_buffer* bufferp, buffer_data *datap);
+void gr_opengl_render_model(model_material* material_info, indexed_vertex_source *vert_source, vertex_buffer* bufferp, size_t texi, size_t texi_count);
+void opengl_render_model_program(model_material* material_info, indexed_vertex_source *vert_source, vertex_buffer* bufferp, size_t texi, size_t texi_count);
 
 void opengl_tnl_set_material(material* material_info, bool set_base_map);
 void opengl_tnl_set_material_distortion(distortion_material* material_info);
@@ -50,7 +50,7 @@ namespace
 		GL_state.Texture.SetActiveUnit(0);
 		GL_state.Texture.SetTarget(0);
 
-		glBindVertexArray(GL_vao);
+		GL_state.BindVertexArray(GL_vao);
 
 		GL_state.Array.BindArrayBuffer(0);
 		GL_state.Array.BindUniformBuffer(0);
@@ -103,7 +103,7 @@ namespace graphics
 		{
 			GR_DEBUG_SCOPE("NanoVG flush");
 
-			glBindVertexArray(0);
+			GL_state.BindVertexArray(0);
 
 			gr_opengl_set_2d_matrix();
 
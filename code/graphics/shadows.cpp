@@ -10,6 +10,7 @@
 #include "asteroid/asteroid.h"
 #include "cmdline/cmdline.h"
 #include "debris/debris.h"
+#include "debugconsole/console.h"
 #include "graphics/opengl/gropengldraw.h"
 #include "graphics/opengl/gropengltnl.h"
 #include "graphics/shadows.h"
@@ -18,6 +19,7 @@
 #include "model/model.h"
 #include "model/modelrender.h"
 #include "render/3d.h"
+#include "tracing/Monitor.h"
 #include "tracing/tracing.h"
 
 extern vec3d check_offsets[8];
@@ -28,6 +30,79 @@ float Shadow_cascade_distances[MAX_SHADOW_CASCADES];
 
 light_frustum_info Shadow_frustums[MAX_SHADOW_CASCADES];
 
+// The far cascade covers a lot of space at few pixels per meter so it is kept from earlier frames as long as nothing
+// which casts a shadow into it moved by more than a texel. Instead of fitting it to the view frustum it covers a cube
+// around the position of the eye at the time it was rendered which stays usable until the eye has moved too far.
+bool Shadow_cache_far_cascade = true;
+DCF_BOOL(shadow_cache, Shadow_cache_far_cascade);
+
+MONITOR(ShadowCascadesRendered)
+
+namespace {
+
+const int SHADOW_CACHED_CASCADE = MAX_SHADOW_CASCADES - 1;
+
+// how far the eye may move away from the center of the cached cascade, relative to the cascade distance
+const float SHADOW_CACHE_MARGIN = 0.25f;
+
+// animated submodels, cloaking and similar things aren't tracked so the cache is refreshed every so often anyway
+const int SHADOW_CACHE_MAX_AGE = 60;
+
+// casters smaller than this many texels of the cached cascade (fighters, usually) hardly show up in it so they don't
+// cause it to be rendered again when they move
+const float SHADOW_CACHE_MIN_CASTER_TEXELS = 2.0f;
+
+struct shadow_caster_state {
+	int objnum;
+	int signature;
+	vec3d pos;
+	matrix orient;
+	float radius;
+};
+
+struct shadow_cache_info {
+	bool valid = false;
+	int age = 0;
+
+	vec3d light_dir;
+
+	// the area covered by the cascade in light space, relative to the world origin instead of the eye
+	vec3d min;
+	vec3d max;
+
+	float texel_size = 0.0f;
+
+	SCP_vector<shadow_caster_state> casters;
+};
+
+shadow_cache_info Shadow_cache;
+
+SCP_vector<shadow_caster_state> Shadow_frame_casters;
+
+// the cascades of this frame, set up by shadows_prepare_frame()
+bool Shadow_frame_prepared = false;
+bool Shadow_frame_cache_far_cascade = false;
+matrix Shadow_frame_light_matrix;
+
+// the cascades the casters are being rendered into, 0 while no shadow map is rendered
+int Shadow_render_num_cascades = 0;
+
+}
+
+// pos_rot is relative to the eye in the frame of reference of the light
+static bool shadows_sphere_in_frustum(const vec3d *pos_rot, float radius, const vec3d *min, const vec3d *max)
+{
+	if ( (pos_rot->xyz.x - radius) > max->xyz.x 
+		|| (pos_rot->xyz.x + radius) < min->xyz.x 
+		|| (pos_rot->xyz.y - radius) > max->xyz.y 
+		|| (pos_rot->xyz.y + radius) < min->xyz.y 
+		|| (pos_rot->xyz.z - radius) > max->xyz.z ) {
+		return false;
+	}
+
+	return true;
+}
+
 bool shadows_obj_in_frustum(object *objp, matrix *light_orient, vec3d *min, vec3d *max)
 {
 	vec3d pos, pos_rot;
@@ -35,15 +110,7 @@ bool shadows_obj_in_frustum(object *objp, matrix *light_orient, vec3d *min, vec3
 	vm_vec_sub(&pos, &objp->pos, &Eye_position);
 	vm_vec_rotate(&pos_rot, &pos, light_orient);
 
-	if ( (pos_rot.xyz.x - objp->radius) > max->xyz.x 
-		|| (pos_rot.xyz.x + objp->radius) < min->xyz.x 
-		|| (pos_rot.xyz.y - objp->radius) > max->xyz.y 
-		|| (pos_rot.xyz.y + objp->radius) < min->xyz.y 
-		|| (pos_rot.xyz.z - objp->radius) > max->xyz.z ) {
-		return false;
-	}
-
-	return true;
+	return shadows_sphere_in_frustum(&pos_rot, objp->radius, min, max);
 }
 
 void shadows_construct_light_proj(light_frustum_info *shadow_data)
@@ -356,8 +423,74 @@ void shadows_construct_light_frustum(light_frustum_info *shadow_data, matrix *li
 	shadows_construct_light_proj(shadow_data);
 }
 
-matrix shadows_start_render(matrix *eye_orient, vec3d *eye_pos, float fov, float aspect, float veryneardist, float neardist, float middist, float fardist)
-{	
+/**
+ * Sets up the cached cascade for the current eye position, the cache is invalidated if the eye left the covered area
+ */
+static void shadows_construct_cached_frustum(light_frustum_info *shadow_data, matrix *light_matrix, vec3d *light_dir, vec3d *eye_pos, float fardist)
+{
+	vec3d eye_light;
+	vm_vec_rotate(&eye_light, eye_pos, light_matrix);
+
+	float margin = fardist * SHADOW_CACHE_MARGIN;
+
+	bool moved = !Shadow_cache.valid
+		|| vm_vec_dot(light_dir, &Shadow_cache.light_dir) < 0.9999f
+		|| eye_light.xyz.x - fardist < Shadow_cache.min.xyz.x || eye_light.xyz.x + fardist > Shadow_cache.max.xyz.x
+		|| eye_light.xyz.y - fardist < Shadow_cache.min.xyz.y || eye_light.xyz.y + fardist > Shadow_cache.max.xyz.y
+		|| eye_light.xyz.z - fardist < Shadow_cache.min.xyz.z || eye_light.xyz.z + fardist > Shadow_cache.max.xyz.z;
+
+	if ( moved ) {
+		Shadow_cache.valid = false;
+		Shadow_cache.light_dir = *light_dir;
+
+		vec3d extent;
+		vm_vec_make(&extent, fardist + margin, fardist + margin, fardist + margin);
+
+		vm_vec_sub(&Shadow_cache.min, &eye_light, &extent);
+		vm_vec_add(&Shadow_cache.max, &eye_light, &extent);
+
+		int size = (Cmdline_shadow_quality == 2 ? 1024 : 512);
+		Shadow_cache.texel_size = (Shadow_cache.max.xyz.x - Shadow_cache.min.xyz.x) / size;
+	}
+
+	// everything is rendered relative to the eye so the fixed area has to be moved by the opposite amount
+	vm_vec_sub(&shadow_data->min, &Shadow_cache.min, &eye_light);
+	vm_vec_sub(&shadow_data->max, &Shadow_cache.max, &eye_light);
+
+	shadows_construct_light_proj(shadow_data);
+}
+
+/**
+ * Checks if the shadow casters in the cached cascade are still where they were when it was rendered
+ */
+static bool shadows_cached_casters_moved()
+{
+	if ( Shadow_frame_casters.size() != Shadow_cache.casters.size() ) {
+		return true;
+	}
+
+	for ( size_t i = 0; i < Shadow_frame_casters.size(); ++i ) {
+		auto& now = Shadow_frame_casters[i];
+		auto& then = Shadow_cache.casters[i];
+
+		if ( now.objnum != then.objnum || now.signature != then.signature ) {
+			return true;
+		}
+
+		// how far the farthest point of the object may have moved
+		float dist = vm_vec_dist(&now.pos, &then.pos)
+			+ now.radius * (vm_vec_dist(&now.orient.vec.fvec, &then.orient.vec.fvec) + vm_vec_dist(&now.orient.vec.uvec, &then.orient.vec.uvec));
+
+		if ( dist > Shadow_cache.texel_size ) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+static matrix shadows_start_render_cascades(matrix *eye_orient, vec3d *eye_pos, float fov, float aspect, float veryneardist, float neardist, float middist, float fardist, bool cache_far_cascade)
+{
 	if(Static_light.empty())
 		return vmd_identity_matrix; 
 	
@@ -371,12 +504,26 @@ matrix shadows_start_render(matrix *eye_orient, vec3d *eye_pos, float fov, float
 	matrix light_matrix;
 
 	vm_vec_copy_normalize(&light_dir, &lp->vec);
-	vm_vector_2_matrix(&light_matrix, &light_dir, &eye_orient->vec.uvec, NULL);
+
+	if ( cache_far_cascade ) {
+		// the light space must not follow the eye or the cached cascade couldn't be used after the eye rolled
+		vm_vector_2_matrix(&light_matrix, &light_dir, NULL, NULL);
+	} else {
+		vm_vector_2_matrix(&light_matrix, &light_dir, &eye_orient->vec.uvec, NULL);
+	}
 
 	shadows_construct_light_frustum(&Shadow_frustums[0], &light_matrix, eye_orient, eye_pos, fov, aspect, 0.0f, veryneardist);
 	shadows_construct_light_frustum(&Shadow_frustums[1], &light_matrix, eye_orient, eye_pos, fov, aspect, veryneardist - (veryneardist - 0.0f)* 0.2f, neardist);
 	shadows_construct_light_frustum(&Shadow_frustums[2], &light_matrix, eye_orient, eye_pos, fov, aspect, neardist - (neardist - veryneardist) * 0.2f, middist);
-	shadows_construct_light_frustum(&Shadow_frustums[3], &light_matrix, eye_orient, eye_pos, fov, aspect, middist - (middist - neardist) * 0.2f, fardist);
+
+	if ( cache_far_cascade ) {
+		shadows_construct_cached_frustum(&Shadow_frustums[3], &light_matrix, &light_dir, eye_pos, fardist);
+	} else {
+		// whatever was cached is going to be overwritten
+		Shadow_cache.valid = false;
+
+		shadows_construct_light_frustum(&Shadow_frustums[3], &light_matrix, eye_orient, eye_pos, fov, aspect, middist - (middist - neardist) * 0.2f, fardist);
+	}
 	
 	Shadow_cascade_distances[0] = veryneardist;
 	Shadow_cascade_distances[1] = neardist;
@@ -388,7 +535,14 @@ matrix shadows_start_render(matrix *eye_orient, vec3d *eye_pos, float fov, float
 	Shadow_proj_matrix[2] = Shadow_frustums[2].proj_matrix;
 	Shadow_proj_matrix[3] = Shadow_frustums[3].proj_matrix;
 
-	gr_shadow_map_start(&Shadow_view_matrix, &light_matrix);
+	return light_matrix;
+}
+
+matrix shadows_start_render(matrix *eye_orient, vec3d *eye_pos, float fov, float aspect, float veryneardist, float neardist, float middist, float fardist)
+{	
+	matrix light_matrix = shadows_start_render_cascades(eye_orient, eye_pos, fov, aspect, veryneardist, neardist, middist, fardist, false);
+
+	gr_shadow_map_start(&Shadow_view_matrix, &light_matrix, MAX_SHADOW_CASCADES);
 
 	return light_matrix;
 }
@@ -398,19 +552,144 @@ void shadows_end_render()
 	gr_shadow_map_end();
 }
 
-void shadows_render_all(float fov, matrix *eye_orient, vec3d *eye_pos)
+static void shadows_queue_caster(object *objp, model_draw_list *scene)
 {
-	GR_DEBUG_SCOPE("Render shadows");
-	TRACE_SCOPE(tracing::BuildShadowMap);
+	switch(objp->type)
+	{
+	case OBJ_SHIP:
+		{
+			obj_queue_render(objp, scene);
+		}
+		break;
+	case OBJ_ASTEROID:
+		{
+			model_render_params render_info;
+
+			render_info.set_object_number(OBJ_INDEX(objp));
+			render_info.set_flags(MR_IS_ASTEROID | MR_NO_TEXTURING | MR_NO_LIGHTING);
+			
+			model_clear_instance( Asteroid_info[Asteroids[objp->instance].asteroid_type].model_num[Asteroids[objp->instance].asteroid_subtype]);
+			model_render_queue(&render_info, scene, Asteroid_info[Asteroids[objp->instance].asteroid_type].model_num[Asteroids[objp->instance].asteroid_subtype], &objp->orient, &objp->pos);
+		}
+		break;
+
+	case OBJ_DEBRIS:
+		{
+			debris *db;
+			db = &Debris[objp->instance];
+
+			if ( !(db->flags & DEBRIS_USED)){
+				return;
+			}
+							
+			objp = &Objects[db->objnum];
+
+			model_render_params render_info;
+
+			render_info.set_flags(MR_NO_TEXTURING | MR_NO_LIGHTING);
+
+			submodel_render_queue(&render_info, scene, db->model_num, db->submodel_num, &objp->orient, &objp->pos);
+		}
+		break; 
+	}
+}
+
+/**
+ * Sets up the cascades of this frame so the objects can be culled against them together with the other views, see
+ * obj_build_view_masks()
+ *
+ * @return @c true if shadows are rendered this frame
+ */
+bool shadows_prepare_frame(float fov, matrix *eye_orient, vec3d *eye_pos)
+{
+	Shadow_frame_prepared = false;
 
 	if ( Static_light.empty() ) {
-		return;
+		return false;
 	}
 
 	light *lp = *(Static_light.begin());
 
 	if( !Cmdline_shadow_quality || !lp ) {
-		return;
+		return false;
+	}
+
+	Shadow_frame_cache_far_cascade = Shadow_cache_far_cascade;
+
+	// these cascade distances are a result of some arbitrary tuning to give a good balance of quality and banding. 
+	// maybe we could use a more programmatic algorithim? 
+	Shadow_frame_light_matrix = shadows_start_render_cascades(eye_orient, eye_pos, fov, gr_screen.clip_aspect, 200.0f, 600.0f, 2500.0f, 8000.0f, Shadow_frame_cache_far_cascade);
+
+	Shadow_frame_prepared = true;
+
+	return true;
+}
+
+/**
+ * Gets the cascades of this frame an object casts a shadow into
+ *
+ * This only reads the object and the cascades so it can be called from the jobs.
+ *
+ * @return One bit for each cascade
+ */
+int shadows_obj_cascade_mask(object *objp)
+{
+	if ( !Shadow_frame_prepared ) {
+		return 0;
+	}
+
+	if ( objp->type != OBJ_SHIP && objp->type != OBJ_ASTEROID && objp->type != OBJ_DEBRIS ) {
+		return 0;
+	}
+
+	int mask = 0;
+
+	for ( int j = 0; j < MAX_SHADOW_CASCADES; ++j ) {
+		if ( shadows_obj_in_frustum(objp, &Shadow_frame_light_matrix, &Shadow_frustums[j].min, &Shadow_frustums[j].max) ) {
+			mask |= (1 << j);
+		}
+	}
+
+	return mask;
+}
+
+/**
+ * Checks if a sphere is inside of one of the cascades which are being rendered, used for culling parts of the casters
+ *
+ * @return true if the sphere is in a cascade or no shadow map is being rendered
+ */
+bool shadows_sphere_in_rendered_cascades(const vec3d *center, float radius)
+{
+	if ( Shadow_render_num_cascades == 0 ) {
+		return true;
+	}
+
+	vec3d pos, pos_rot;
+
+	vm_vec_sub(&pos, center, &Eye_position);
+	vm_vec_rotate(&pos_rot, &pos, &Shadow_frame_light_matrix);
+
+	for ( int j = 0; j < Shadow_render_num_cascades; ++j ) {
+		if ( shadows_sphere_in_frustum(&pos_rot, radius, &Shadow_frustums[j].min, &Shadow_frustums[j].max) ) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void shadows_render_all(float fov, matrix *eye_orient, vec3d *eye_pos)
+{
+	GR_DEBUG_SCOPE("Render shadows");
+	TRACE_SCOPE(tracing::BuildShadowMap);
+
+	if ( !Shadow_frame_prepared ) {
+		if ( !shadows_prepare_frame(fov, eye_orient, eye_pos) ) {
+			return;
+		}
+
+		// the objects were culled without the cascades
+		obj_build_view_masks();
 	}
 
 	//shadows_debug_show_frustum(&Player_obj->orient, &Player_obj->pos, fov, gr_screen.clip_aspect, Min_draw_distance, 3000.0f);
@@ -418,72 +697,73 @@ void shadows_render_all(float fov, matrix *eye_orient, vec3d *eye_pos)
 	gr_end_proj_matrix();
 	gr_end_view_matrix();
 
-	// these cascade distances are a result of some arbitrary tuning to give a good balance of quality and banding. 
-	// maybe we could use a more programmatic algorithim? 
-	matrix light_matrix = shadows_start_render(eye_orient, eye_pos, fov, gr_screen.clip_aspect, 200.0f, 600.0f, 2500.0f, 8000.0f);
+	bool cache_far_cascade = Shadow_frame_cache_far_cascade;
+	matrix light_matrix = Shadow_frame_light_matrix;
 
-	model_draw_list scene;
-	object *objp = Objects;
+	SCP_vector<std::pair<object*, bool>> casters;
+	Shadow_frame_casters.clear();
 
-	for ( int i = 0; i <= Highest_object_index; i++, objp++ ) {
-		bool cull = true;
+	for ( auto& view_mask : obj_get_view_masks() ) {
+		int cascades = view_mask.mask >> OBJ_VIEW_SHADOW_CASCADE_SHIFT;
 
-		for ( int j = 0; j < MAX_SHADOW_CASCADES; ++j ) {
-			if ( shadows_obj_in_frustum(objp, &light_matrix, &Shadow_frustums[j].min, &Shadow_frustums[j].max) ) {
-				cull = false;
-				break;
-			}
+		if ( cascades == 0 ) {
+			continue;
 		}
 
-		if ( cull ) {
-			continue;
+		object *objp = &Objects[view_mask.objnum];
+
+		bool in_near_cascades = (cascades & ((1 << SHADOW_CACHED_CASCADE) - 1)) != 0;
+		bool in_cached_cascade = (cascades & (1 << SHADOW_CACHED_CASCADE)) != 0;
+
+		if ( in_cached_cascade && objp->radius >= Shadow_cache.texel_size * SHADOW_CACHE_MIN_CASTER_TEXELS ) {
+			Shadow_frame_casters.push_back({ view_mask.objnum, objp->signature, objp->pos, objp->orient, objp->radius });
 		}
 
-		switch(objp->type)
-		{
-		case OBJ_SHIP:
-			{
-				obj_queue_render(objp, &scene);
-			}
-			break;
-		case OBJ_ASTEROID:
-			{
-				model_render_params render_info;
-
-				render_info.set_object_number(OBJ_INDEX(objp));
-				render_info.set_flags(MR_IS_ASTEROID | MR_NO_TEXTURING | MR_NO_LIGHTING);
-				
-				model_clear_instance( Asteroid_info[Asteroids[objp->instance].asteroid_type].model_num[Asteroids[objp->instance].asteroid_subtype]);
-				model_render_queue(&render_info, &scene, Asteroid_info[Asteroids[objp->instance].asteroid_type].model_num[Asteroids[objp->instance].asteroid_subtype], &objp->orient, &objp->pos);
-			}
-			break;
+		casters.emplace_back(objp, in_near_cascades);
+	}
 
-		case OBJ_DEBRIS:
-			{
-				debris *db;
-				db = &Debris[objp->instance];
+	bool render_cached_cascade = true;
 
-				if ( !(db->flags & DEBRIS_USED)){
-					continue;
-				}
-								
-				objp = &Objects[db->objnum];
+	if ( cache_far_cascade ) {
+		render_cached_cascade = !Shadow_cache.valid || Shadow_cache.age >= SHADOW_CACHE_MAX_AGE || shadows_cached_casters_moved();
 
-				model_render_params render_info;
+		if ( render_cached_cascade ) {
+			Shadow_cache.valid = true;
+			Shadow_cache.age = 0;
+			Shadow_cache.casters.swap(Shadow_frame_casters);
+		} else {
+			++Shadow_cache.age;
+		}
+	}
 
-				render_info.set_flags(MR_NO_TEXTURING | MR_NO_LIGHTING);
+	int num_cascades = render_cached_cascade ? MAX_SHADOW_CASCADES : SHADOW_CACHED_CASCADE;
+	MONITOR_SET(ShadowCascadesRendered, num_cascades);
 
-				submodel_render_queue(&render_info, &scene, db->model_num, db->submodel_num, &objp->orient, &objp->pos);
-			}
-			break; 
+	gr_shadow_map_start(&Shadow_view_matrix, &light_matrix, num_cascades);
+
+	model_draw_list scene;
+
+	Shadow_render_num_cascades = num_cascades;
+
+	for ( auto& caster : casters ) {
+		if ( caster.second || render_cached_cascade ) {
+			shadows_queue_caster(caster.first, &scene);
 		}
 	}
 
-	scene.init_render();
-	scene.render_all(ZBUFFER_TYPE_FULL);
+	Shadow_render_num_cascades = 0;
+
+	{
+		TRACE_SCOPE(tracing::RenderShadowCasters);
+
+		scene.init_render();
+		scene.render_all(ZBUFFER_TYPE_FULL);
+	}
 
 	shadows_end_render();
 
+	Shadow_frame_prepared = false;
+
 	gr_zbias(0);
 	gr_zbuffer_set(ZBUFFER_TYPE_READ);
 	gr_set_cull(0);
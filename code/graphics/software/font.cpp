@@ -27,6 +27,7 @@
 #include "localization/localize.h"
 #include "parse/parselo.h"
 #include "tracing/Monitor.h"
+#include "tracing/StartupProfiler.h"
 
 namespace
 {
@@ -382,6 +383,8 @@ namespace font
 {
 	void init()
 	{
+		TRACE_STARTUP_SCOPE(tracing::FontInit);
+
 		if (font_initialized) {
 			// Already initialized
 			return;
@@ -639,6 +639,143 @@ void HudGauge::onFrame(float frametime)
 	
 }
 
+bool HudGauge::getContentVersion(hud_content_hash& /*hash*/)
+{
+	return false;
+}
+
+/**
+ * Gets the version of what the gauge draws, including the state every gauge looks the same with
+ *
+ * @return false if the gauge can't tell, see getContentVersion()
+ */
+bool HudGauge::getContentKey(std::uint64_t& key)
+{
+	hud_content_hash hash;
+
+	// a flashing gauge changes its color by itself
+	if ( !flashExpiredSexp() || !getContentVersion(hash) ) {
+		return false;
+	}
+
+	hash.add(gauge_color);
+	hash.add(font_num);
+	hash.add(HUD_contrast);
+
+	key = hash.value();
+	return true;
+}
+
+void HudGauge::renderCached(float frametime)
+{
+	std::uint64_t key;
+
+	if ( !getContentKey(key) ) {
+		cache_valid = false;
+		cached_commands.clear();
+
+		render(frametime);
+		return;
+	}
+
+	// the same draw calls only end up the same on the same canvas
+	hud_content_hash hash;
+	hash.add(key);
+	hash.add(gr_screen.max_w);
+	hash.add(gr_screen.max_h);
+	hash.add(gr_screen.rendering_to_texture);
+
+	if ( cache_valid && (cached_version == hash.value()) ) {
+		replayCommands();
+		return;
+	}
+
+	cached_commands.clear();
+
+	cache_recording = true;
+	render(frametime);
+	cache_recording = false;
+
+	cached_version = hash.value();
+	cache_valid = true;
+}
+
+void HudGauge::recordCommand(hud_draw_command::draw_type type, int a0, int a1, int a2, int a3, int a4, int a5, const char* text)
+{
+	hud_draw_command cmd;
+
+	cmd.type = type;
+	cmd.args[0] = a0;
+	cmd.args[1] = a1;
+	cmd.args[2] = a2;
+	cmd.args[3] = a3;
+	cmd.args[4] = a4;
+	cmd.args[5] = a5;
+
+	if ( text != nullptr ) {
+		cmd.text = text;
+	}
+
+	cmd.clr = gr_screen.current_color;
+	cmd.font_num = font::get_current_fontnum();
+	cmd.bitmap = gr_screen.current_bitmap;
+	cmd.alphablend_mode = gr_screen.current_alphablend_mode;
+	cmd.bitblt_mode = gr_screen.current_bitblt_mode;
+	cmd.alpha = gr_screen.current_alpha;
+
+	cached_commands.push_back(std::move(cmd));
+}
+
+void HudGauge::replayCommands()
+{
+	for (auto& cmd : cached_commands) {
+		auto args = cmd.args;
+
+		gr_set_color_fast(&cmd.clr);
+		gr_set_bitmap(cmd.bitmap, cmd.alphablend_mode, cmd.bitblt_mode, cmd.alpha);
+
+		if ( font::get_current_fontnum() != cmd.font_num ) {
+			font::set_font(cmd.font_num);
+		}
+
+		switch (cmd.type) {
+		case hud_draw_command::draw_type::String:
+			renderString(args[0], args[1], cmd.text.c_str());
+			break;
+		case hud_draw_command::draw_type::StringEmp:
+			renderString(args[0], args[1], args[2], cmd.text.c_str());
+			break;
+		case hud_draw_command::draw_type::Bitmap:
+			renderBitmap(args[0], args[1]);
+			break;
+		case hud_draw_command::draw_type::BitmapColor:
+			renderBitmapColor(cmd.bitmap, args[0], args[1]);
+			break;
+		case hud_draw_command::draw_type::BitmapEx:
+			renderBitmapEx(cmd.bitmap, args[0], args[1], args[2], args[3], args[4], args[5]);
+			break;
+		case hud_draw_command::draw_type::Line:
+			renderLine(args[0], args[1], args[2], args[3]);
+			break;
+		case hud_draw_command::draw_type::GradientLine:
+			renderGradientLine(args[0], args[1], args[2], args[3]);
+			break;
+		case hud_draw_command::draw_type::Rect:
+			renderRect(args[0], args[1], args[2], args[3]);
+			break;
+		case hud_draw_command::draw_type::Circle:
+			renderCircle(args[0], args[1], args[2]);
+			break;
+		case hud_draw_command::draw_type::Clip:
+			setClip(args[0], args[1], args[2], args[3]);
+			break;
+		case hud_draw_command::draw_type::ResetClip:
+			resetClip();
+			break;
+		}
+	}
+}
+
 void HudGauge::render(float frametime)
 {
 	if(!custom_gauge) {
@@ -666,6 +803,10 @@ void HudGauge::renderString(int x, int y, const char *str)
 {
 	int nx = 0, ny = 0;
 
+	if ( cache_recording ) {
+		recordCommand(hud_draw_command::draw_type::String, x, y, 0, 0, 0, 0, str);
+	}
+
 	if ( gr_screen.rendering_to_texture != -1 ) {
 		gr_set_screen_scale(canvas_w, canvas_h, -1, -1, target_w, target_h, target_w, target_h, true);
 	} else {
@@ -689,6 +830,10 @@ void HudGauge::renderString(int x, int y, int gauge_id, const char *str)
 {
 	int nx = 0, ny = 0;
 
+	if ( cache_recording ) {
+		recordCommand(hud_draw_command::draw_type::StringEmp, x, y, gauge_id, 0, 0, 0, str);
+	}
+
 	if ( gr_screen.rendering_to_texture != -1 ) {
 		gr_set_screen_scale(canvas_w, canvas_h, -1, -1, target_w, target_h, target_w, target_h, true);
 	} else {
@@ -753,6 +898,11 @@ void HudGauge::renderBitmapColor(int frame, int x, int y)
 {
 	int nx = 0, ny = 0;
 
+	if ( cache_recording ) {
+		gr_set_bitmap(frame);
+		recordCommand(hud_draw_command::draw_type::BitmapColor, x, y);
+	}
+
 	if( !emp_should_blit_gauge() ) {
 		return;
 	}
@@ -783,6 +933,10 @@ void HudGauge::renderBitmap(int x, int y)
 {
 	int nx = 0, ny = 0;
 
+	if ( cache_recording ) {
+		recordCommand(hud_draw_command::draw_type::Bitmap, x, y);
+	}
+
 	if( !emp_should_blit_gauge() ) {
 		return;
 	}
@@ -818,6 +972,11 @@ void HudGauge::renderBitmap(int frame, int x, int y)
 void HudGauge::renderBitmapEx(int frame, int x, int y, int w, int h, int sx, int sy)
 {
 	int nx = 0, ny = 0; 
+
+	if ( cache_recording ) {
+		gr_set_bitmap(frame);
+		recordCommand(hud_draw_command::draw_type::BitmapEx, x, y, w, h, sx, sy);
+	}
 	
 	if( !emp_should_blit_gauge() ) { 
 		return;
@@ -851,6 +1010,10 @@ void HudGauge::renderLine(int x1, int y1, int x2, int y2)
 {
 	int nx = 0, ny = 0;
 
+	if ( cache_recording ) {
+		recordCommand(hud_draw_command::draw_type::Line, x1, y1, x2, y2);
+	}
+
 	if ( gr_screen.rendering_to_texture != -1 ) {
 		gr_set_screen_scale(canvas_w, canvas_h, -1, -1, target_w, target_h, target_w, target_h, true);
 	} else {
@@ -874,6 +1037,10 @@ void HudGauge::renderGradientLine(int x1, int y1, int x2, int y2)
 {
 	int nx = 0, ny = 0;
 
+	if ( cache_recording ) {
+		recordCommand(hud_draw_command::draw_type::GradientLine, x1, y1, x2, y2);
+	}
+
 	if ( gr_screen.rendering_to_texture != -1 ) {
 		gr_set_screen_scale(canvas_w, canvas_h, -1, -1, target_w, target_h, target_w, target_h, true);
 	} else {
@@ -897,6 +1064,10 @@ void HudGauge::renderRect(int x, int y, int w, int h)
 {
 	int nx = 0, ny = 0;
 
+	if ( cache_recording ) {
+		recordCommand(hud_draw_command::draw_type::Rect, x, y, w, h);
+	}
+
 	if ( gr_screen.rendering_to_texture != -1 ) {
 		gr_set_screen_scale(canvas_w, canvas_h, -1, -1, target_w, target_h, target_w, target_h, true);
 	} else {
@@ -920,6 +1091,10 @@ void HudGauge::renderCircle(int x, int y, int diameter)
 {
 	int nx = 0, ny = 0;
 
+	if ( cache_recording ) {
+		recordCommand(hud_draw_command::draw_type::Circle, x, y, diameter);
+	}
+
 	if ( gr_screen.rendering_to_texture != -1 ) {
 		gr_set_screen_scale(canvas_w, canvas_h, -1, -1, target_w, target_h, target_w, target_h, true);
 	} else {
@@ -944,6 +1119,10 @@ void HudGauge::setClip(int x, int y, int w, int h)
 	int hx = fl2i(HUD_offset_x);
 	int hy = fl2i(HUD_offset_y);
 
+	if ( cache_recording ) {
+		recordCommand(hud_draw_command::draw_type::Clip, x, y, w, h);
+	}
+
 	if ( gr_screen.rendering_to_texture != -1 ) {
 		gr_set_screen_scale(canvas_w, canvas_h, -1, -1, target_w, target_h, target_w, target_h, true);
 
@@ -980,6 +1159,10 @@ void HudGauge::resetClip()
 	int hx = 0, hy = 0;
 	int w, h;
 
+	if ( cache_recording ) {
+		recordCommand(hud_draw_command::draw_type::ResetClip);
+	}
+
 	if ( gr_screen.rendering_to_texture != -1 ) {
 		gr_set_screen_scale(canvas_w, canvas_h, -1, -1, target_w, target_h, target_w, target_h, true);
 		
@@ -1319,7 +1502,7 @@ void hud_maybe_popup_weapons_gauge()
 
 		for ( i = 0; i < swp->num_secondary_banks; i++ ) {
 			if ( swp->secondary_bank_ammo[i] > 0 ) {
-				int ms_till_fire = timestamp_until(swp->next_secondary_fire_stamp[i]);
+				int ms_till_fire = (int)(timestamp_us_until(swp->next_secondary_fire_stamp[i]) / 1000);
 				if ( ms_till_fire >= 1000 ) {
 					hud_gauge_popup_start(HUD_WEAPONS_GAUGE, 2500);
 				}
@@ -1730,6 +1913,41 @@ void hud_render_all()
 	font::set_font(font::FONT1);
 }
 
+/**
+ * Gets the version of everything the HUD gauges draw on a cockpit display
+ *
+ * @return 0 if one of the gauges on the display can't tell what it draws
+ */
+static std::uint64_t hud_cockpit_display_content_version(int cockpit_display_num)
+{
+	ship_info* sip = &Ship_info[Player_ship->ship_info_index];
+	int render_target = Player_displays[cockpit_display_num].target;
+	hud_content_hash hash;
+
+	for (auto gauge : sip->hud_gauges) {
+		if ( !gauge->setupRenderCanvas(render_target) ) {
+			continue;
+		}
+
+		bool visible = gauge->canRender();
+		hash.add(visible);
+
+		if ( !visible ) {
+			continue;
+		}
+
+		std::uint64_t key;
+
+		if ( !gauge->getContentKey(key) ) {
+			return 0;
+		}
+
+		hash.add(key);
+	}
+
+	return hash.value();
+}
+
 void hud_render_gauges(int cockpit_display_num)
 {
 	size_t j, num_gauges;
@@ -1745,6 +1963,11 @@ void hud_render_gauges(int cockpit_display_num)
 			return;
 		}
 
+		// the texture keeps what was drawn last until the display is due again
+		if ( !ship_cockpit_display_needs_update(cockpit_display_num, hud_cockpit_display_content_version(cockpit_display_num)) ) {
+			return;
+		}
+
 		render_target = ship_start_render_cockpit_display(cockpit_display_num);
 
 		if ( render_target <= 0 ) {
@@ -1780,7 +2003,11 @@ void hud_render_gauges(int cockpit_display_num)
 
 			sip->hud_gauges[j]->resetClip();
 			sip->hud_gauges[j]->setFont();
-			sip->hud_gauges[j]->render(flFrametime);
+
+			// the text of a gauge is drawn on top of it anyway, this draws the strings of a font in one call
+			gr_string_batch_begin();
+			sip->hud_gauges[j]->renderCached(flFrametime);
+			gr_string_batch_end();
 		}
 	} else {
 		num_gauges = default_hud_gauges.size();
@@ -1798,7 +2025,10 @@ void hud_render_gauges(int cockpit_display_num)
 
 			default_hud_gauges[j]->resetClip();
 			default_hud_gauges[j]->setFont();
-			default_hud_gauges[j]->render(flFrametime);
+
+			gr_string_batch_begin();
+			default_hud_gauges[j]->renderCached(flFrametime);
+			gr_string_batch_end();
 		}
 	}
 
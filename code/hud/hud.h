@@ -15,6 +15,7 @@
 #include "graphics/font.h"
 #include "hud/hudgauges.h"
 #include "hud/hudparse.h"
+#include "io/timer.h"
 
 class object;
 struct cockpit_display;
@@ -198,6 +199,93 @@ int hud_disabled_except_messages();
 void hud_toggle_contrast();
 void hud_set_contrast(int high);
 
+// the state the content of a gauge depends on, see HudGauge::getContentVersion()
+class hud_content_hash
+{
+	std::uint64_t _value = 14695981039346656037ULL;
+
+ public:
+	void add(const void* data, size_t size)
+	{
+		auto bytes = static_cast<const ubyte*>(data);
+		for (size_t i = 0; i < size; ++i) {
+			_value = (_value ^ bytes[i]) * 1099511628211ULL;
+		}
+	}
+
+	template <typename T>
+	void add(const T& value)
+	{
+		add(&value, sizeof(value));
+	}
+
+	void addString(const char* str)
+	{
+		add(str, strlen(str) + 1);
+	}
+
+	std::uint64_t value() const { return _value; }
+};
+
+// limits how often the state behind a gauge is gathered, the gauge draws what was gathered last in between
+class hud_update_rate
+{
+	int _interval;
+	int _next_update = 0;
+
+ public:
+	// a rate of 0 updates every frame
+	explicit hud_update_rate(int updates_per_second) { setRate(updates_per_second); }
+
+	void setRate(int updates_per_second) { _interval = (updates_per_second > 0) ? (1000 / updates_per_second) : 0; }
+
+	// true once every interval, starts the next one
+	bool due()
+	{
+		if (_interval > 0 && _next_update != 0 && !timestamp_elapsed(_next_update)) {
+			return false;
+		}
+
+		_next_update = timestamp(_interval);
+		return true;
+	}
+
+	// makes the next due() true, for changes which can't wait
+	void force() { _next_update = 0; }
+};
+
+// a call of one of the rendering functions of HudGauge, recorded so an unchanged gauge can be drawn without running
+// its render() again
+struct hud_draw_command
+{
+	enum class draw_type
+	{
+		String,
+		StringEmp,
+		Bitmap,
+		BitmapColor,
+		BitmapEx,
+		Line,
+		GradientLine,
+		Rect,
+		Circle,
+		Clip,
+		ResetClip
+	};
+
+	draw_type type;
+	int args[6];
+	SCP_string text;
+
+	// the state of gr_screen the call depends on
+	color clr;
+	int font_num;
+	int bitmap;
+	int alphablend_mode;
+	int bitblt_mode;
+	float alpha;
+};
+
 class HudGauge 
 {
 protected:
@@ -241,6 +329,16 @@ protected:
 	int target_w, target_h;
 	int target_x, target_y;
 	int display_offset_x, display_offset_y;
+
+	// retained content, see renderCached()
+	SCP_vector<hud_draw_command> cached_commands;
+	std::uint64_t cached_version = 0;
+	bool cache_valid = false;
+	bool cache_recording = false;
+
+	void recordCommand(hud_draw_command::draw_type type, int a0 = 0, int a1 = 0, int a2 = 0, int a3 = 0, int a4 = 0,
+		int a5 = 0, const char* text = nullptr);
+	void replayCommands();
 public:
 	// constructors
 	HudGauge();
@@ -295,6 +393,13 @@ public:
 	virtual void initialize();
 	virtual void onFrame(float frametime);
 
+	// Gauges which only draw through the rendering functions below can add everything their content depends on to
+	// the hash and return true. As long as the hash doesn't change the draw calls of the last render() are issued
+	// again instead of running it. Returns false if the content can't be reused in this frame, e.g. while it's flashing.
+	virtual bool getContentVersion(hud_content_hash& hash);
+	bool getContentKey(std::uint64_t& key);
+	void renderCached(float frametime);
+
 	bool setupRenderCanvas(int render_target = -1);
 	void setCockpitTarget(const cockpit_display *display);
 	void resetCockpitTarget();
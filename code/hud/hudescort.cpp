@@ -339,6 +339,45 @@ void HudGaugeEscort::render(float frametime)
 	renderIcon(x, y, i);
 }
 
+bool HudGaugeEscort::getContentVersion(hud_content_hash& hash)
+{
+	// the kill counts aren't worth keeping track of
+	if ( MULTI_DOGFIGHT ) {
+		return false;
+	}
+
+	hash.add(Show_escort_view);
+	hash.add(Num_escort_ships);
+
+	if ( !Show_escort_view ) {
+		return true;
+	}
+
+	int seen_from_team = (Player_ship != NULL) ? Player_ship->team : -1;
+
+	for (int i = 0; i < Num_escort_ships; i++) {
+		// the entry of a ship flashes for a while after it was hit
+		if ( !timestamp_elapsed(Escort_ships[i].escort_hit_timer) ) {
+			return false;
+		}
+
+		object *objp = &Objects[Escort_ships[i].objnum];
+		ship *sp = &Ships[objp->instance];
+
+		hash.add(Escort_ships[i].objnum);
+		hash.add(*iff_get_color_by_team_and_object(sp->team, seen_from_team, 0, objp));
+		hash.add(sp->flags[Ship::Ship_Flags::Disabled] || ship_subsys_disrupted(sp, SUBSYSTEM_ENGINE));
+		hash.addString(sp->ship_name);
+
+		float shields, integrity;
+		hud_get_target_strength(objp, &shields, &integrity);
+		hash.add(fl2i(integrity*100 + 0.5f));
+		hash.add(integrity > 0);
+	}
+
+	return true;
+}
+
 // draw the shield icon and integrity for the escort ship
 void HudGaugeEscort::renderIcon(int x, int y, int index)
 {
@@ -69,6 +69,7 @@ public:
 	void initRightAlignNames(bool align);
 	int setGaugeColorEscort(int index, int team);
 	virtual void render(float frametime);
+	virtual bool getContentVersion(hud_content_hash& hash);
 	void pageIn();
 	void renderIcon(int x, int y, int index);
 	void renderIconDogfight(int x, int y, int index);
@@ -302,7 +302,7 @@ void HudGaugeReticle::getFirepointStatus() {
 					int bankactive = 0;
 					ship_weapon *swp = &shipp->weapons;
 
-					if (!timestamp_elapsed(shipp->weapons.next_primary_fire_stamp[i]))
+					if (!timestamp_us_elapsed(shipp->weapons.next_primary_fire_stamp[i]))
 						bankactive = 1;
 					else if (timestamp_elapsed(shipp->weapons.primary_animation_done_time[i]))
 						bankactive = 1;
@@ -70,7 +70,10 @@ SCP_vector<target_display_info> target_display_list;
 
 // The following variables are global to this file, and do not need to be persistent from frame-to-frame
 // This means the variables are not player-specific
+#define HOSTILE_TRIANGLE_UPDATE_RATE	10		// times per second the closest attacker is looked for
 object* hostile_obj = NULL;
+static int Hostile_obj_sig;
+static hud_update_rate Hostile_triangle_update_rate(HOSTILE_TRIANGLE_UPDATE_RATE);
 
 static int ballistic_hud_index = 0;	// Goober5000
 
@@ -1062,6 +1065,9 @@ void hud_init_targeting()
 	Target_newest_ship_timestamp = timestamp(0);
 	Target_next_turret_timestamp = timestamp(0);
 
+	hostile_obj = NULL;
+	Hostile_triangle_update_rate.force();
+
 	if(The_mission.flags[Mission::Mission_Flags::Fullneb]) {
 		Toggle_text_alpha = TOGGLE_TEXT_NEBULA_ALPHA;
 	} else {
@@ -1274,6 +1280,124 @@ ship_obj *advance_ship(ship_obj *so, int next_flag)
 	return GET_LAST(so);
 }
 
+// the ships select_next_target_by_distance() cycles through when it isn't looking for attackers, sorted by their
+// distance to the player, so cycling through the targets several times in one frame only measures them once
+struct target_distance_entry {
+    float distance;
+    int objnum;
+};
+
+static struct {
+    int frame = -1;
+    int player_objnum = -1;
+    int team_mask = 0;
+    flagset<Ship::Info_Flags> filter;
+    SCP_vector<target_distance_entry> ships;
+} Target_distance_list;
+
+static const SCP_vector<target_distance_entry>& get_target_distance_list(const int valid_team_mask, const flagset<Ship::Info_Flags>& filter)
+{
+    auto& list = Target_distance_list;
+    int player_object_index = OBJ_INDEX(Player_obj);
+
+    if ((list.frame == Framecount) && (list.player_objnum == player_object_index) && (list.team_mask == valid_team_mask) && (list.filter == filter)) {
+        return list.ships;
+    }
+
+    list.frame = Framecount;
+    list.player_objnum = player_object_index;
+    list.team_mask = valid_team_mask;
+    list.filter = filter;
+    list.ships.clear();
+
+    for (ship_obj *so = GET_FIRST(&Ship_obj_list); so != END_OF_LIST(&Ship_obj_list); so = GET_NEXT(so)) {
+        object *objp = &Objects[so->objnum];
+        ship *shipp = &Ships[objp->instance];
+
+        if ((objp == Player_obj) || should_be_ignored(shipp)) {
+            continue;
+        }
+
+        if (!iff_matches_mask(shipp->team, valid_team_mask)) {
+            continue;
+        }
+
+        if ((Ship_info[shipp->ship_info_index].flags & filter).any_set()) {
+            continue;
+        }
+
+        if (hud_target_invalid_awacs(objp)) {
+            continue;
+        }
+
+        list.ships.push_back({ hud_find_target_distance(objp, Player_obj), so->objnum });
+    }
+
+    // ships at the same distance stay in the order of Ship_obj_list, like the loop over the list picked them
+    std::stable_sort(list.ships.begin(), list.ships.end(), [](const target_distance_entry& a, const target_distance_entry& b) {
+        return a.distance < b.distance;
+    });
+
+    return list.ships;
+}
+
+// picks from the sorted list what the loop in select_next_target_by_distance() would pick, see there
+static object* select_next_target_from_distance_list(const bool targeting_from_closest_to_farthest, const SCP_vector<target_distance_entry>& ships, const float current_distance) {
+    int target_objnum = Player_ai->target_objnum;
+
+    auto by_distance = [](const target_distance_entry& entry, float distance) { return entry.distance < distance; };
+
+    if (targeting_from_closest_to_farthest) {
+        // the first ship which is further away than the target
+        auto it = std::lower_bound(ships.begin(), ships.end(), current_distance, by_distance);
+        for (; it != ships.end(); ++it) {
+            if ((it->distance > current_distance) && (it->objnum != target_objnum)) {
+                return &Objects[it->objnum];
+            }
+        }
+
+        // otherwise start over with the closest one, the last of several at the same distance
+        object *closest = NULL;
+        float closest_distance = 0.0f;
+        for (auto& entry : ships) {
+            if (entry.objnum == target_objnum) {
+                continue;
+            }
+            if ((closest != NULL) && (entry.distance > closest_distance)) {
+                break;
+            }
+            closest = &Objects[entry.objnum];
+            closest_distance = entry.distance;
+        }
+        return closest;
+    } else {
+        // the ship right before the target, the first of several at the same distance
+        auto end = std::lower_bound(ships.begin(), ships.end(), current_distance, by_distance);
+        object *nearest = NULL;
+        float nearest_distance = 0.0f;
+        for (auto it = ships.begin(); it != end; ++it) {
+            if (it->objnum == target_objnum) {
+                continue;
+            }
+            if ((nearest == NULL) || (it->distance > nearest_distance)) {
+                nearest = &Objects[it->objnum];
+                nearest_distance = it->distance;
+            }
+        }
+        if (nearest != NULL) {
+            return nearest;
+        }
+
+        // otherwise start over with the farthest one, the last of several at the same distance
+        for (auto it = ships.rbegin(); it != ships.rend(); ++it) {
+            if (it->objnum != target_objnum) {
+                return &Objects[it->objnum];
+            }
+        }
+        return NULL;
+    }
+}
+
 /// \brief Iterates down to and selects the next target in a linked list
 ///        fashion ordered from closest to farthest from the
 ///        attacked_object_number, returning the next valid target.
@@ -1308,6 +1432,10 @@ static object* select_next_target_by_distance(const bool targeting_from_closest_
         filter.set(Ship::Info_Flags::Navbuoy);
     }
 
+    if (attacked_object_number == -1) {
+        return select_next_target_from_distance_list(targeting_from_closest_to_farthest, get_target_distance_list(valid_team_mask, filter), current_distance);
+    }
+
     float nearest_distance;
     if (targeting_from_closest_to_farthest) {
         nearest_distance = 1e20f;
@@ -3586,6 +3714,14 @@ void hud_show_hostile_triangle()
 	int player_obj_index = OBJ_INDEX(Player_obj);
 	int turret_is_attacking = 0;
 
+	// the triangle follows the attacker found last time until it's time to look again
+	if ( !Hostile_triangle_update_rate.due() ) {
+		if ( hostile_obj != NULL && hostile_obj->signature != Hostile_obj_sig ) {
+			hostile_obj = NULL;
+		}
+		return;
+	}
+
 	hostile_obj = NULL;
 
 	for ( so = GET_FIRST(&Ship_obj_list); so != END_OF_LIST(&Ship_obj_list);  so = GET_NEXT(so) ) {
@@ -3672,6 +3808,7 @@ void hud_show_hostile_triangle()
 	}
 
 	hostile_obj = nearest_obj;
+	Hostile_obj_sig = nearest_obj->signature;
 
 	// hook to maybe warn player about this attacking ship
 	ship_maybe_warn_player(&Ships[nearest_obj->instance], min_distance);
@@ -6146,7 +6283,7 @@ void HudGaugeWeapons::render(float frametime)
 
 			// show the cooldown time
 			if ( (sw->secondary_bank_ammo[i] > 0) && (sw->current_secondary_bank >= 0) ) {
-				int ms_till_fire = timestamp_until(sw->next_secondary_fire_stamp[sw->current_secondary_bank]);
+				int ms_till_fire = (int)(timestamp_us_until(sw->next_secondary_fire_stamp[sw->current_secondary_bank]) / 1000);
 				if ( (ms_till_fire >= 500) && ((wip->fire_wait >= 1 ) || (ms_till_fire > wip->fire_wait*1000)) ) {
 					renderPrintf(position[0] + Weapon_sreload_offset_x, name_y, EG_NULL, "%d", fl2i(ms_till_fire/1000.0f +0.5f));
 				}
@@ -7060,7 +7197,7 @@ void HudGaugeSecondaryWeapons::render(float frametime)
 
 			// show the cooldown time
 			if ( (sw->secondary_bank_ammo[i] > 0) && (sw->current_secondary_bank >= 0) ) {
-				int ms_till_fire = timestamp_until(sw->next_secondary_fire_stamp[sw->current_secondary_bank]);
+				int ms_till_fire = (int)(timestamp_us_until(sw->next_secondary_fire_stamp[sw->current_secondary_bank]) / 1000);
 				if ( (ms_till_fire >= 500) && ((wip->fire_wait >= 1 ) || (ms_till_fire > wip->fire_wait*1000)) ) {
 					renderPrintf(position[0] + _sreload_offset_x, position[1] + text_y_offset, EG_NULL, "%d", fl2i(ms_till_fire/1000.0f +0.5f));
 				}
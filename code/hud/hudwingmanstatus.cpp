@@ -531,6 +531,32 @@ void HudGaugeWingmanStatus::render(float frametime)
 	}
 }
 
+bool HudGaugeWingmanStatus::getContentVersion(hud_content_hash& hash)
+{
+	for (int i = 0; i < MAX_SQUADRON_WINGS; i++) {
+		hash.add(HUD_wingman_status[i].used);
+		hash.add(HUD_wingman_status[i].ignore);
+
+		if ( HUD_wingman_status[i].used <= 0 ) {
+			continue;
+		}
+
+		for (int j = 0; j < MAX_SHIPS_PER_WING; j++) {
+			// the dot of a ship flashes for a while after it was hit
+			if ( !timestamp_elapsed(HUD_wingman_flash_duration[i][j]) ) {
+				return false;
+			}
+
+			hash.add(HUD_wingman_status[i].status[j]);
+			hash.add(HUD_wingman_status[i].hull[j] > 0.5f);
+		}
+
+		hash.addString(Squadron_wing_names[i]);
+	}
+
+	return true;
+}
+
 // init the flashing timers for the wingman status gauge
 void hud_wingman_status_init_flash()
 {
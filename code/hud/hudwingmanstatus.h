@@ -77,6 +77,7 @@ public:
 	void pageIn();
 	void initialize();
 	void render(float frametime);
+	bool getContentVersion(hud_content_hash& hash);
 	void renderBackground(int num_wings_to_draw);
 	void renderDots(int wing_index, int screen_index, int num_wings_to_draw);
 	void initFlash();
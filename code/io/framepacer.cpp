@@ -0,0 +1,106 @@
+
+#include "io/framepacer.h"
+
+#include "io/timer.h"
+#include "osapi/osapi.h"
+#include "tracing/tracing.h"
+
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
+namespace {
+
+const std::uint64_t MIN_SPIN_NS = 500000;		// sleeping may always overshoot by this much
+const std::uint64_t MAX_SPIN_NS = 16000000;		// a coarse scheduler tick, the pacer does not yield for longer
+const int STATS_FRAMES = 120;					// the frames the deviation is computed over
+
+std::uint64_t Next_deadline = 0;
+std::uint64_t Spin_ns = 2000000;
+
+std::uint64_t Last_frame = 0;
+double Intervals[STATS_FRAMES];
+int Num_intervals = 0;
+int Next_interval = 0;
+double Interval_sum = 0.0;
+double Interval_sum_sq = 0.0;
+
+void sleep_until(std::uint64_t deadline)
+{
+	auto now = timer_get_nanoseconds();
+
+	while (now + Spin_ns < deadline) {
+		auto sleep_ms = (deadline - now - Spin_ns) / 1000000;
+		if (sleep_ms == 0) {
+			break;
+		}
+
+		os_sleep((uint)sleep_ms);
+
+		auto woken = timer_get_nanoseconds();
+		auto overshoot = woken - now > sleep_ms * 1000000 ? woken - now - sleep_ms * 1000000 : 0;
+
+		// grows right away so the next frame is on time, shrinks slowly when the scheduler is more precise again
+		Spin_ns = std::max(overshoot, Spin_ns - Spin_ns / 16);
+		CLAMP(Spin_ns, MIN_SPIN_NS, MAX_SPIN_NS);
+
+		now = woken;
+	}
+
+	while (now < deadline) {
+		std::this_thread::yield();
+		now = timer_get_nanoseconds();
+	}
+}
+
+void record_interval(std::uint64_t now)
+{
+	if (Last_frame != 0) {
+		double interval = (now - Last_frame) / 1000000.;
+
+		if (Num_intervals == STATS_FRAMES) {
+			Interval_sum -= Intervals[Next_interval];
+			Interval_sum_sq -= Intervals[Next_interval] * Intervals[Next_interval];
+		} else {
+			++Num_intervals;
+		}
+
+		Intervals[Next_interval] = interval;
+		Next_interval = (Next_interval + 1) % STATS_FRAMES;
+		Interval_sum += interval;
+		Interval_sum_sq += interval * interval;
+
+		double mean = Interval_sum / Num_intervals;
+		double variance = std::max(Interval_sum_sq / Num_intervals - mean * mean, 0.0);
+
+		tracing::counter::value(tracing::FramePacingInterval, (float)interval);
+		tracing::counter::value(tracing::FramePacingDeviation, (float)std::sqrt(variance));
+	}
+
+	Last_frame = now;
+}
+
+}
+
+void frame_pacer_wait(std::uint64_t frame_ns)
+{
+	TRACE_SCOPE(tracing::FramePacingWait);
+
+	auto now = timer_get_nanoseconds();
+
+	if (frame_ns == 0) {
+		Next_deadline = 0;
+	} else {
+		// after a frame which is late by more than a frame the deadlines start over instead of rushing the next ones
+		if (Next_deadline == 0 || now >= Next_deadline + frame_ns) {
+			Next_deadline = now;
+		} else {
+			sleep_until(Next_deadline);
+			now = timer_get_nanoseconds();
+		}
+
+		Next_deadline += frame_ns;
+	}
+
+	record_interval(now);
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+#include "globalincs/pstypes.h"
+
+#include <cstdint>
+
+/** @file
+ *  Paces the frames to the framerate cap.
+ *
+ *  The deadlines of the frames follow each other at the frame time, so a frame which took a bit longer makes the next
+ *  one wait less instead of shifting all that follow. The pacer sleeps until shortly before the deadline and yields for
+ *  the rest since a sleep only ends with the next tick of the scheduler. How far before is learned from how much the
+ *  sleeps overshot.
+ *
+ *  The time between the frames and its deviation over the last frames are traced as counters.
+ */
+
+/**
+ * @brief Waits until the next frame may start
+ *
+ * @param frame_ns The time of a frame at the framerate cap, 0 if the frames are not capped
+ */
+void frame_pacer_wait(std::uint64_t frame_ns);
@@ -59,6 +59,7 @@
 #include "autopilot/autopilot.h"
 #include "cmdline/cmdline.h"
 #include "object/objectshield.h"
+#include "playerman/replay.h"
 
 /**
 * Natural number factor lookup class.
@@ -1578,7 +1579,9 @@ void game_process_cheats(int k)
 			sprintf(name, NOX("Volition Bravos %d"), ship_idx);
 			if ( (ship_name_lookup(name) == -1) && (ship_find_exited_ship_by_name(name) == -1) )
 			{
+				ship_name_index_remove(SHIP_INDEX(shipp));
 				strcpy_s(shipp->ship_name, name);
+				ship_name_index_add(SHIP_INDEX(shipp));
 				break;
 			}
 
@@ -1694,6 +1697,9 @@ void game_process_keys()
 	}
 	while (k);
 
+	// a replay plays back the buttons of its recording instead
+	replay_buttons(&Player->bi);
+
 	// lua button command override goes here!!
 	if (lua_game_control & LGC_B_OVERRIDE) {
 		button_info temp = Player->bi;
@@ -1786,8 +1792,8 @@ int button_function_critical(int n, net_player *p = NULL)
 			hud_gauge_popup_start(HUD_WEAPONS_GAUGE);
 			if (ship_select_next_primary(objp, CYCLE_PRIMARY_NEXT)) {
 				ship* shipp = &Ships[objp->instance];
-				if ( timestamp_elapsed(shipp->weapons.next_primary_fire_stamp[shipp->weapons.current_primary_bank]) ) {
-					shipp->weapons.next_primary_fire_stamp[shipp->weapons.current_primary_bank] = timestamp(250);	//	1/4 second delay until can fire
+				if ( timestamp_us_elapsed(shipp->weapons.next_primary_fire_stamp[shipp->weapons.current_primary_bank]) ) {
+					shipp->weapons.next_primary_fire_stamp[shipp->weapons.current_primary_bank] = timestamp_us(250000);	//	1/4 second delay until can fire
 				}
 
 				// multiplayer server should maintain bank/link status here
@@ -1807,8 +1813,8 @@ int button_function_critical(int n, net_player *p = NULL)
 			hud_gauge_popup_start(HUD_WEAPONS_GAUGE);
 			if (ship_select_next_primary(objp, CYCLE_PRIMARY_PREV)) {
 				ship* shipp = &Ships[objp->instance];
-				if ( timestamp_elapsed(shipp->weapons.next_primary_fire_stamp[shipp->weapons.current_primary_bank]) ) {
-					shipp->weapons.next_primary_fire_stamp[shipp->weapons.current_primary_bank] = timestamp(250);	//	1/4 second delay until can fire
+				if ( timestamp_us_elapsed(shipp->weapons.next_primary_fire_stamp[shipp->weapons.current_primary_bank]) ) {
+					shipp->weapons.next_primary_fire_stamp[shipp->weapons.current_primary_bank] = timestamp_us(250000);	//	1/4 second delay until can fire
 				}
 
 				// multiplayer server should maintain bank/link status here
@@ -1827,8 +1833,8 @@ int button_function_critical(int n, net_player *p = NULL)
 			hud_gauge_popup_start(HUD_WEAPONS_GAUGE);
 			if (ship_select_next_secondary(objp)) {
 				ship* shipp = &Ships[objp->instance];
-				if ( timestamp_elapsed(shipp->weapons.next_secondary_fire_stamp[shipp->weapons.current_secondary_bank]) ) {
-					shipp->weapons.next_secondary_fire_stamp[shipp->weapons.current_secondary_bank] = timestamp(250);	//	1/4 second delay until can fire
+				if ( timestamp_us_elapsed(shipp->weapons.next_secondary_fire_stamp[shipp->weapons.current_secondary_bank]) ) {
+					shipp->weapons.next_secondary_fire_stamp[shipp->weapons.current_secondary_bank] = timestamp_us(250000);	//	1/4 second delay until can fire
 				}
 
 				// multiplayer server should maintain bank/link status here
@@ -227,3 +227,39 @@ void timestamp_set_value(int value) {
 	timestamp_ticker = (std::uint64_t) value * 1000;
 }
 
+std::int64_t timestamp_us(std::int64_t delta_us) {
+	if (delta_us < 0) return 0;
+	if (delta_us == 0) return 1;
+
+	const auto max_time_us = (std::int64_t)MAX_TIME * 1000;
+	auto now = (std::int64_t)timestamp_ticker;
+
+	auto t2 = now + delta_us;
+	if (t2 > max_time_us) {
+		// wraps like timestamp() does
+		t2 = delta_us - (max_time_us - now);
+	}
+	if (t2 < 2) t2 = 2;
+	return t2;
+}
+std::int64_t timestamp_us() {
+	return (std::int64_t)timestamp_ticker;
+}
+bool timestamp_us_elapsed(std::int64_t stamp) {
+	if (stamp == 0) {
+		return false;
+	}
+
+	return (std::int64_t)timestamp_ticker >= stamp;
+}
+std::int64_t timestamp_us_until(std::int64_t stamp) {
+	return stamp - (std::int64_t)timestamp_ticker;
+}
+int timestamp_us_to_ms(std::int64_t stamp) {
+	if (stamp <= 2) {
+		// These are special values, don't adjust them
+		return (int)stamp;
+	}
+	return (int)((stamp + 999) / 1000);
+}
+
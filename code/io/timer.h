@@ -123,5 +123,28 @@ int timestamp_has_time_elapsed(int stamp, int time);
 // safer version of timestamp
 bool timestamp_elapsed_safe(int a, int b);
 
+//=================================================================
+// The same timestamps with microseconds, for the timers which are due
+// many times a second. With milliseconds every frame above 1000 fps
+// has the same time and the timers of the frames in between all
+// elapse in one of them. The values are the same as above: 0 is
+// invalid and 1 has always elapsed.
+
+// a timestamp delta_us microseconds in the future, 0 for a negative
+// delta and 1 for zero
+std::int64_t timestamp_us(std::int64_t delta_us);
+
+// the current time
+std::int64_t timestamp_us();
+
+bool timestamp_us_elapsed(std::int64_t stamp);
+
+// microseconds until the timestamp elapses, negative if it has
+std::int64_t timestamp_us_until(std::int64_t stamp);
+
+// the millisecond timestamp which elapses in the same frame or the
+// one after, for the code which compares it with those
+int timestamp_us_to_ms(std::int64_t stamp);
+
 
 #endif
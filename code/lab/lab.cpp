@@ -1061,8 +1061,12 @@ void labviewer_render_model(float frametime)
 	}
 
 	batching_render_all();
-	gr_copy_effect_texture();
-	batching_render_all(true);
+
+	int dist_x1, dist_y1, dist_x2, dist_y2;
+	if ( batching_get_distortion_bounds(&dist_x1, &dist_y1, &dist_x2, &dist_y2) ) {
+		gr_copy_effect_texture(dist_x1, dist_y1, dist_x2, dist_y2);
+		batching_render_all(true);
+	}
 	gr_end_view_matrix();
 	gr_end_proj_matrix();
 
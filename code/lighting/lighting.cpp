@@ -20,6 +20,8 @@
 #include "model/modelrender.h"
 #include "render/3d.h"
 
+#include <algorithm>
+
 
 
 #define MAX_LIGHT_LEVELS 16
@@ -44,6 +46,23 @@ static int Light_in_shadow = 0;	// If true, this means we're in a shadow
 
 static int Lighting_off = 0;
 
+// changes whenever ::Lights changes, see scene_lights::setLightFilter()
+static int Light_generation = 0;
+
+#define LIGHT_GRID_CELL_SIZE		500.0f	// the size of the cells the lights are sorted into for the light filter
+#define LIGHT_GRID_MAX_CELLS		64		// lights reaching more cells than this are tested for every object
+#define LIGHT_GRID_MAX_QUERY_CELLS	64		// objects covering more cells than this test all lights
+
+// the lights found for an object, kept for the scenes of the other render passes of the frame
+typedef struct light_filter_cache_entry {
+	int	generation = -1;
+	vec3d	pos;
+	float	rad;
+	SCP_vector<size_t> lights;
+} light_filter_cache_entry;
+
+static SCP_vector<light_filter_cache_entry> Light_filter_cache;	// indexed by object
+
 // For lighting values, 0.75 is full intensity
 
 #if 1		// ADAM'S new stuff
@@ -146,13 +165,36 @@ DCF(light,"Changes lighting parameters")
 	}
 }
 
+// the lights of the last simulation step, see light_save_frame()
+static int Num_saved_lights = 0;
+static size_t Num_saved_static_lights = 0;
+
 void light_reset()
 {
 	Static_light.clear();
 
 	Num_lights = 0;
+	Num_saved_lights = 0;
+	Num_saved_static_lights = 0;
+	Light_generation++;
+	light_filter_reset();
+}
+
+void light_save_frame()
+{
+	Num_saved_lights = Num_lights;
+	Num_saved_static_lights = Static_light.size();
+}
+
+void light_restore_frame()
+{
+	Num_lights = Num_saved_lights;
+	Static_light.resize(Num_saved_static_lights);
+	Light_generation++;
+
 	light_filter_reset();
 }
+
 extern vec3d Object_position;
 
 /**
@@ -242,6 +284,7 @@ void light_add_directional(const vec3d *dir, float intensity, float r, float g,
 	l->light_ignore_objnum = -1;
 	l->affected_objnum = -1;
 	l->instance = Num_lights-1;
+	Light_generation++;
 		
 	Assert( Num_light_levels <= 1 );
 
@@ -289,6 +332,7 @@ void light_add_point(const vec3d *pos, float r1, float r2, float intensity, floa
 	l->light_ignore_objnum = light_ignore_objnum;
 	l->affected_objnum = -1;
 	l->instance = Num_lights-1;
+	Light_generation++;
 
 	Assert( Num_light_levels <= 1 );
 }
@@ -332,6 +376,7 @@ void light_add_point_unique(const vec3d *pos, float r1, float r2, float intensit
 	l->light_ignore_objnum = -1;
 	l->affected_objnum = affected_objnum;
 	l->instance = Num_lights-1;
+	Light_generation++;
 
 	Assert( Num_light_levels <= 1 );
 }
@@ -377,6 +422,7 @@ void light_add_tube(const vec3d *p0, const vec3d *p1, float r1, float r2, float
 	l->light_ignore_objnum = affected_objnum;
 	l->affected_objnum = -1;
 	l->instance = Num_lights-1;
+	Light_generation++;
 
 	Assert( Num_light_levels <= 1 );
 }
@@ -1082,6 +1128,7 @@ void light_add_cone(const vec3d *pos, const vec3d *dir, float angle, float inner
 	l->light_ignore_objnum = light_ignore_objnum;
 	l->affected_objnum = -1;
 	l->instance = Num_lights-1;
+	Light_generation++;
 
 	Assert( Num_light_levels <= 1 );
 }
@@ -1097,11 +1144,129 @@ void scene_lights::addLight(const light *light_ptr)
 
 	AllLights.push_back(*light_ptr);
 
+	if ( light_ptr != &Lights[AllLights.size() - 1] ) {
+		MirrorsGlobalLights = false;
+	}
+
+	LightGridBuilt = false;
+
 	if ( light_ptr->type == LT_DIRECTIONAL ) {
 		StaticLightIndices.push_back(AllLights.size() - 1);
 	}
 }
 
+static inline int light_grid_coord(float v)
+{
+	float c = floorf(v / LIGHT_GRID_CELL_SIZE);
+
+	// the keys have 21 bits per axis
+	return (int)MAX(-1048575.0f, MIN(c, 1048575.0f));
+}
+
+static inline uint64_t light_grid_key(int x, int y, int z)
+{
+	const std::int64_t offset = 1 << 20;
+
+	return (((std::uint64_t)(x + offset)) << 42) | (((std::uint64_t)(y + offset)) << 21) | ((std::uint64_t)(z + offset));
+}
+
+/**
+ * Sorts the point and tube lights into a grid, so the light filter of an object only looks at the lights in the
+ * cells around it. The other light types never pass the filter.
+ */
+void scene_lights::buildLightGrid()
+{
+	LightGrid.clear();
+	LargeLights.clear();
+
+	for ( size_t i = 0; i < AllLights.size(); ++i ) {
+		light& l = AllLights[i];
+		vec3d min, max;
+
+		if ( l.type == LT_POINT ) {
+			min = l.vec;
+			max = l.vec;
+		} else if ( l.type == LT_TUBE ) {
+			min.xyz.x = MIN(l.vec.xyz.x, l.vec2.xyz.x);
+			min.xyz.y = MIN(l.vec.xyz.y, l.vec2.xyz.y);
+			min.xyz.z = MIN(l.vec.xyz.z, l.vec2.xyz.z);
+			max.xyz.x = MAX(l.vec.xyz.x, l.vec2.xyz.x);
+			max.xyz.y = MAX(l.vec.xyz.y, l.vec2.xyz.y);
+			max.xyz.z = MAX(l.vec.xyz.z, l.vec2.xyz.z);
+		} else {
+			continue;
+		}
+
+		int x0 = light_grid_coord(min.xyz.x - l.radb), x1 = light_grid_coord(max.xyz.x + l.radb);
+		int y0 = light_grid_coord(min.xyz.y - l.radb), y1 = light_grid_coord(max.xyz.y + l.radb);
+		int z0 = light_grid_coord(min.xyz.z - l.radb), z1 = light_grid_coord(max.xyz.z + l.radb);
+
+		if ( (std::int64_t)(x1 - x0 + 1) * (y1 - y0 + 1) * (z1 - z0 + 1) > LIGHT_GRID_MAX_CELLS ) {
+			LargeLights.push_back(i);
+			continue;
+		}
+
+		for ( int x = x0; x <= x1; ++x ) {
+			for ( int y = y0; y <= y1; ++y ) {
+				for ( int z = z0; z <= z1; ++z ) {
+					LightGrid.emplace_back(light_grid_key(x, y, z), i);
+				}
+			}
+		}
+	}
+
+	std::sort(LightGrid.begin(), LightGrid.end());
+
+	LightQueryStamps.assign(AllLights.size(), 0);
+	LightQueryStamp = 0;
+	LightGridBuilt = true;
+}
+
+bool scene_lights::lightAffects(const light &l, int objnum, const vec3d *pos, float rad) const
+{
+	switch ( l.type ) {
+		case LT_DIRECTIONAL:
+			break;
+		case LT_POINT: {
+			// if this is a "unique" light source, it only affects one guy
+			if ( l.affected_objnum >= 0 && objnum != l.affected_objnum ) {
+				return false;
+			}
+
+			vec3d to_light;
+			float dist_squared, max_dist_squared;
+			vm_vec_sub( &to_light, &l.vec, pos );
+			dist_squared = vm_vec_mag_squared(&to_light);
+
+			max_dist_squared = l.radb+rad;
+			max_dist_squared *= max_dist_squared;
+
+			return dist_squared < max_dist_squared;
+		}
+		case LT_TUBE: {
+			if ( l.light_ignore_objnum != objnum ) {
+				vec3d nearest;
+				float dist_squared, max_dist_squared;
+				vm_vec_dist_squared_to_line(pos,&l.vec,&l.vec2,&nearest,&dist_squared);
+
+				max_dist_squared = l.radb+rad;
+				max_dist_squared *= max_dist_squared;
+
+				return dist_squared < max_dist_squared;
+			}
+		}
+		break;
+
+		case LT_CONE:
+			break;
+
+		default:
+			break;
+	}
+
+	return false;
+}
+
 void scene_lights::setLightFilter(int objnum, const vec3d *pos, float rad)
 {
 	size_t i;
@@ -1109,66 +1274,79 @@ void scene_lights::setLightFilter(int objnum, const vec3d *pos, float rad)
 	// clear out current filtered lights
 	FilteredLights.clear();
 
-	for ( i = 0; i < AllLights.size(); ++i ) {
-		light& l = AllLights[i];
+	// the shadow and environment map passes draw the same objects with the same lights
+	bool cacheable = (objnum >= 0) && MirrorsGlobalLights && (AllLights.size() == (size_t)Num_lights);
+	light_filter_cache_entry *cached = nullptr;
 
-		switch ( l.type ) {
-			case LT_DIRECTIONAL:
-				break;
-			case LT_POINT: {
-				// if this is a "unique" light source, it only affects one guy
-				if ( l.affected_objnum >= 0 ) {
-					if ( objnum == l.affected_objnum ) {
-						vec3d to_light;
-						float dist_squared, max_dist_squared;
-						vm_vec_sub( &to_light, &l.vec, pos );
-						dist_squared = vm_vec_mag_squared(&to_light);
+	if ( cacheable ) {
+		if ( Light_filter_cache.size() <= (size_t)objnum ) {
+			Light_filter_cache.resize(MAX_OBJECTS);
+		}
 
-						max_dist_squared = l.radb+rad;
-						max_dist_squared *= max_dist_squared;
+		cached = &Light_filter_cache[objnum];
 
-						if ( dist_squared < max_dist_squared )	{
-							FilteredLights.push_back(i);
-						}
-					}
-				} else { // otherwise check all relevant objects
-					vec3d to_light;
-					float dist_squared, max_dist_squared;
-					vm_vec_sub( &to_light, &l.vec, pos );
-					dist_squared = vm_vec_mag_squared(&to_light);
+		if ( (cached->generation == Light_generation) && (cached->rad == rad) && vm_vec_same(&cached->pos, pos) ) {
+			FilteredLights.assign(cached->lights.begin(), cached->lights.end());
+			return;
+		}
+	}
 
-					max_dist_squared = l.radb+rad;
-					max_dist_squared *= max_dist_squared;
+	if ( !LightGridBuilt ) {
+		buildLightGrid();
+	}
 
-					if ( dist_squared < max_dist_squared )	{
-						FilteredLights.push_back(i);
-					}
-				}
+	int x0 = light_grid_coord(pos->xyz.x - rad), x1 = light_grid_coord(pos->xyz.x + rad);
+	int y0 = light_grid_coord(pos->xyz.y - rad), y1 = light_grid_coord(pos->xyz.y + rad);
+	int z0 = light_grid_coord(pos->xyz.z - rad), z1 = light_grid_coord(pos->xyz.z + rad);
+
+	if ( (std::int64_t)(x1 - x0 + 1) * (y1 - y0 + 1) * (z1 - z0 + 1) > LIGHT_GRID_MAX_QUERY_CELLS ) {
+		for ( i = 0; i < AllLights.size(); ++i ) {
+			if ( lightAffects(AllLights[i], objnum, pos, rad) ) {
+				FilteredLights.push_back(i);
 			}
-			break;
-			case LT_TUBE: {
-				if ( l.light_ignore_objnum != objnum ) {
-					vec3d nearest;
-					float dist_squared, max_dist_squared;
-					vm_vec_dist_squared_to_line(pos,&l.vec,&l.vec2,&nearest,&dist_squared);
+		}
+	} else {
+		// a light can only reach the object if its range touches one of the cells the object touches
+		++LightQueryStamp;
+		LightCandidates.clear();
+
+		for ( auto light_index : LargeLights ) {
+			LightQueryStamps[light_index] = LightQueryStamp;
+			LightCandidates.push_back(light_index);
+		}
 
-					max_dist_squared = l.radb+rad;
-					max_dist_squared *= max_dist_squared;
+		for ( int x = x0; x <= x1; ++x ) {
+			for ( int y = y0; y <= y1; ++y ) {
+				for ( int z = z0; z <= z1; ++z ) {
+					auto key = light_grid_key(x, y, z);
+					auto it = std::lower_bound(LightGrid.begin(), LightGrid.end(), std::make_pair(key, (size_t)0));
 
-					if ( dist_squared < max_dist_squared ) {
-						FilteredLights.push_back(i);
+					for ( ; it != LightGrid.end() && it->first == key; ++it ) {
+						if ( LightQueryStamps[it->second] != LightQueryStamp ) {
+							LightQueryStamps[it->second] = LightQueryStamp;
+							LightCandidates.push_back(it->second);
+						}
 					}
 				}
 			}
-			break;
+		}
 
-			case LT_CONE:
-				break;
+		// keep the order of AllLights so the result is the same as when testing all lights
+		std::sort(LightCandidates.begin(), LightCandidates.end());
 
-			default:
-				break;
+		for ( auto light_index : LightCandidates ) {
+			if ( lightAffects(AllLights[light_index], objnum, pos, rad) ) {
+				FilteredLights.push_back(light_index);
+			}
 		}
 	}
+
+	if ( cached != nullptr ) {
+		cached->generation = Light_generation;
+		cached->pos = *pos;
+		cached->rad = rad;
+		cached->lights.assign(FilteredLights.begin(), FilteredLights.end());
+	}
 }
 
 light_indexing_info scene_lights::bufferLights()
@@ -1185,6 +1363,15 @@ light_indexing_info scene_lights::bufferLights()
 		return light_info;
 	}
 
+	// objects next to each other mostly get the same lights, sharing the indices lets their draws be instanced
+	if ( BufferedLights.size() >= FilteredLights.size()
+		&& std::equal(FilteredLights.begin(), FilteredLights.end(), BufferedLights.end() - FilteredLights.size()) ) {
+		light_info.index_start = BufferedLights.size() - FilteredLights.size();
+		light_info.num_lights = FilteredLights.size();
+
+		return light_info;
+	}
+
 	light_info.index_start = BufferedLights.size();
 	
 	for ( i = 0; i < FilteredLights.size(); ++i ) {
@@ -12,6 +12,8 @@
 #ifndef _LIGHTING_H
 #define _LIGHTING_H
 
+#include "globalincs/frame_arena.h"
+
 // Light stuff works like this:
 // At the start of the frame, call light_reset.
 // For each light source, call light_add_??? functions.
@@ -58,16 +60,33 @@ struct light_indexing_info
 
 class scene_lights
 {
-	SCP_vector<light> AllLights;
+	SCP_frame_vector<light> AllLights;
 	
-	SCP_vector<size_t> StaticLightIndices;
+	SCP_frame_vector<size_t> StaticLightIndices;
+
+	SCP_frame_vector<size_t> FilteredLights;
+
+	SCP_frame_vector<size_t> BufferedLights;
 
-	SCP_vector<size_t> FilteredLights;
+	// the point and tube lights by the grid cells their range touches, sorted by cell, see buildLightGrid()
+	SCP_frame_vector<std::pair<uint64_t, size_t>> LightGrid;
+	// the lights which reach too many cells to be put in the grid, they are tested for every object
+	SCP_frame_vector<size_t> LargeLights;
+	bool LightGridBuilt = false;
 
-	SCP_vector<size_t> BufferedLights;
+	// the lights in the grid cells around an object, a light touching several cells is only taken once
+	SCP_frame_vector<size_t> LightCandidates;
+	SCP_frame_vector<int> LightQueryStamps;
+	int LightQueryStamp = 0;
+
+	// if AllLights holds every one of ::Lights in the same order, the filter results can be shared with other scenes
+	bool MirrorsGlobalLights = true;
 
 	size_t current_light_index;
 	size_t current_num_lights;
+
+	void buildLightGrid();
+	bool lightAffects(const light &l, int objnum, const vec3d *pos, float rad) const;
 public:
 	scene_lights()
 	{
@@ -82,6 +101,11 @@ public:
 };
 
 extern void light_reset();
+
+// keeps the lights which were added so far, light_restore_frame() removes the ones added after that. With
+// -fixed_simulation this drops the lights rendering added while the ones of the last simulation step stay.
+extern void light_save_frame();
+extern void light_restore_frame();
 extern void light_set_ambient(float ambient_light);
 
 // Intensity - how strong the light is.  1.0 will cast light around 5meters or so.
@@ -17,6 +17,7 @@
 #include "parse/encrypt.h"
 #include "parse/parselo.h"
 #include "playerman/player.h"
+#include "tracing/StartupProfiler.h"
 
 
 
@@ -84,12 +85,21 @@ char *Lcl_ext_str[LCL_MAX_STRINGS];
 // LOCALIZE FORWARD DECLARATIONS
 //
 
+// the parts of an XSTR("string", id) tag, the string points into the tag
+typedef struct lcl_xstr_tag {
+	const char *text;
+	size_t text_len;
+	int id;
+} lcl_xstr_tag;
+
+// given a valid XSTR() tag piece of text, split it into the string and the id# in a single pass without copying the
+// string, nonzero on success
+int lcl_ext_parse_tag(const char *xstr, lcl_xstr_tag *out);
+
 // given a valid XSTR() tag piece of text, extract the string portion, return it in out, nonzero on success
-int lcl_ext_get_text(const char *xstr, char *out);
 int lcl_ext_get_text(const SCP_string &xstr, SCP_string &out);
 
 // given a valid XSTR() tag piece of text, extract the id# portion, return the value in out, nonzero on success
-int lcl_ext_get_id(const char *xstr, int *out);
 int lcl_ext_get_id(const SCP_string &xstr, int *out);
 
 // if the char is a valid char for a signed integer value string
@@ -110,6 +120,8 @@ void lcl_init(int lang_init)
 	const char *ret;
 	int lang, idx, i;
 
+	TRACE_STARTUP_SCOPE(tracing::LocalizationInit);
+
 	// initialize encryption
 	encrypt_init();
 
@@ -648,6 +660,19 @@ void lcl_fred_replace_stuff(SCP_string &text)
 	replace_all(text, "\\", "$backslash");
 }
 
+// copies the string of an XSTR() tag like strncpy() would if it was on its own
+static void lcl_ext_copy_tag_text(const lcl_xstr_tag &tag, char *out, size_t max_len)
+{
+	if (tag.text_len > max_len)
+		error_display(0, "Token too long: [%.*s].  Length = " SIZE_T_ARG ".  Max is " SIZE_T_ARG ".\n", (int)tag.text_len, tag.text, tag.text_len, max_len);
+
+	auto len = MIN(tag.text_len, max_len);
+	memcpy(out, tag.text, len);
+
+	if (len < max_len)
+		memset(out + len, 0, max_len - len);
+}
+
 // get the localized version of the string. if none exists, return the original string
 // valid input to this function includes :
 // "this is some text"
@@ -657,7 +682,7 @@ void lcl_fred_replace_stuff(SCP_string &text)
 // fills in id if non-NULL. a value of -2 indicates it is not an external string
 void lcl_ext_localize_sub(const char *in, char *out, size_t max_len, int *id)
 {
-	char text_str[PARSE_BUF_SIZE]="";
+	lcl_xstr_tag tag;
 	int str_id;
 	size_t str_len;
 
@@ -699,18 +724,7 @@ void lcl_ext_localize_sub(const char *in, char *out, size_t max_len, int *id)
 	}
 
 	// at this point we _know_ its an XSTR() tag, so split off the strings and id sections
-	if (!lcl_ext_get_text(in, text_str)) {
-		if (str_len > max_len)
-			error_display(0, "Token too long: [%s].  Length = " SIZE_T_ARG ".  Max is " SIZE_T_ARG ".\n", in, str_len, max_len);
-
-		strncpy(out, in, max_len);
-
-		if (id != NULL)
-			*id = -1;
-
-		return;
-	}
-	if (!lcl_ext_get_id(in, &str_id)) {
+	if (!lcl_ext_parse_tag(in, &tag)) {
 		if (str_len > max_len)
 			error_display(0, "Token too long: [%s].  Length = " SIZE_T_ARG ".  Max is " SIZE_T_ARG ".\n", in, str_len, max_len);
 
@@ -721,13 +735,11 @@ void lcl_ext_localize_sub(const char *in, char *out, size_t max_len, int *id)
 
 		return;
 	}
+	str_id = tag.id;
 	
 	// if the localization file is not open, or we're running in the default language, return the original string
 	if ( !Xstr_inited || (str_id < 0) || (Lcl_current_lang == FS2_OPEN_DEFAULT_LANGUAGE) ) {
-		if ( strlen(text_str) > max_len )
-			error_display(0, "Token too long: [%s].  Length = " SIZE_T_ARG ".  Max is " SIZE_T_ARG ".\n", text_str, strlen(text_str), max_len);
-
-		strncpy(out, text_str, max_len);
+		lcl_ext_copy_tag_text(tag, out, max_len);
 
 		if (id != NULL)
 			*id = str_id;
@@ -745,13 +757,10 @@ void lcl_ext_localize_sub(const char *in, char *out, size_t max_len, int *id)
 	}
 	// otherwise use what we have - probably should Int3() or assert here
 	else {
-		if ( strlen(text_str) > max_len )
-			error_display(0, "Token too long: [%s].  Length = " SIZE_T_ARG ".  Max is " SIZE_T_ARG ".\n", text_str, strlen(text_str), max_len);
-
 		if (str_id >= LCL_MAX_STRINGS)
 			error_display(0, "Invalid XSTR ID: [%d]. (Must be less than %d.)\n", str_id, LCL_MAX_STRINGS);
 
-		strncpy(out, text_str, max_len);
+		lcl_ext_copy_tag_text(tag, out, max_len);
 	}
 
 	// set the id #
@@ -897,55 +906,6 @@ int lcl_get_xstr_offset(int index, int res)
 // LOCALIZE FORWARD DEFINITIONS
 //
 
-// given a valid XSTR() tag piece of text, extract the string portion, return it in out, nonzero on success
-int lcl_ext_get_text(const char *xstr, char *out)
-{
-	size_t str_start, str_end;
-	size_t str_len;
-	const char *p, *p2;
-
-	Assert(xstr != NULL);
-	Assert(out != NULL);
-	str_len = strlen(xstr);
-	
-	// this is some crazy wack-ass code.
-	// look for the open quote
-	str_start = str_end = 0;
-	p = strstr(xstr, "\"");
-	if(p == NULL){
-		error_display(0, "Error parsing XSTR() tag %s\n", xstr);
-		return 0;
-	} else {
-		str_start = p - xstr + 1;		
-	}
-	// make sure we're not about to walk past the end of the string
-	if(static_cast<size_t>(p - xstr) >= str_len){
-		error_display(0, "Error parsing XSTR() tag %s\n", xstr);
-		return 0;
-	}
-
-	// look for the close quote
-	p2 = strstr(p+1, "\"");
-	if(p2 == NULL){
-		error_display(0, "Error parsing XSTR() tag %s\n", xstr);
-		return 0;
-	} else {
-		str_end = p2 - xstr;
-	}
-
-	// check bounds
-	if (str_end - str_start > PARSE_BUF_SIZE - 1) {
-		error_display(0, "String cannot fit within XSTR buffer!\n\n%s\n", xstr);
-		return 0;
-	}
-
-	// now that we know the boundaries of the actual string in the XSTR() tag, copy it
-	memcpy(out, xstr + str_start, str_end - str_start);	
-
-	// success
-	return 1;
-}
-
 // given a valid XSTR() tag piece of text, extract the string portion, return it in out, nonzero on success
 int lcl_ext_get_text(const SCP_string &xstr, SCP_string &out)
 {
@@ -973,79 +933,74 @@ int lcl_ext_get_text(const SCP_string &xstr, SCP_string &out)
 	return 1;
 }
 
-// given a valid XSTR() tag piece of text, extract the id# portion, return the value in out, nonzero on success
-int lcl_ext_get_id(const char *xstr, int *out)
+// given a valid XSTR() tag piece of text, split it into the string and the id# in a single pass without copying the
+// string, nonzero on success
+int lcl_ext_parse_tag(const char *xstr, lcl_xstr_tag *out)
 {
 	const char *p, *pnext;
-	size_t str_len;
 
 	Assert(xstr != NULL);
 	Assert(out != NULL);
-	
-	str_len = strlen(xstr);
 
-	// find the first quote
+	// look for the open quote
 	p = strchr(xstr, '"');
-	if(p == NULL){
-		error_display(0, "Error parsing id# in XSTR() tag %s\n", xstr);
+	if (p == NULL) {
+		error_display(0, "Error parsing XSTR() tag %s\n", xstr);
 		return 0;
 	}
-	// make sure we're not about to walk off the end of the string
-	if(static_cast<size_t>(p - xstr) >= str_len){
-		error_display(0, "Error parsing id# in XSTR() tag %s\n", xstr);
+	p++;
+
+	// the string goes up to the next quote
+	pnext = strchr(p, '"');
+	if (pnext == NULL) {
+		error_display(0, "Error parsing XSTR() tag %s\n", xstr);
 		return 0;
 	}
-	p++;
 
-	// continue searching until we find the close quote
-	while(true){
-		pnext = strchr(p, '"');
-		if(pnext == NULL){
+	// check bounds
+	if (static_cast<size_t>(pnext - p) > PARSE_BUF_SIZE - 1) {
+		error_display(0, "String cannot fit within XSTR buffer!\n\n%s\n", xstr);
+		return 0;
+	}
+
+	out->text = p;
+	out->text_len = pnext - p;
+
+	// the id# comes after the quote which isn't escaped
+	while (*(pnext - 1) == '\\') {
+		pnext = strchr(pnext + 1, '"');
+		if (pnext == NULL) {
 			error_display(0, "Error parsing id# in XSTR() tag %s\n", xstr);
 			return 0;
 		}
-
-		// if the previous char is a \, we know its not the "end-of-string" quote
-		if(*(pnext - 1) != '\\'){
-			p = pnext;
-			break;
-		}
-
-		// continue
-		p = pnext;
 	}
 
-	// search until we find a ,	
-	pnext = strchr(p, ',');
-	if(pnext == NULL){
+	// search until we find a ,
+	pnext = strchr(pnext, ',');
+	if (pnext == NULL) {
 		error_display(0, "Error parsing id# in XSTR() tag %s\n", xstr);
 		return 0;
 	}
-	// make sure we're not about to walk off the end of the string
-	if(static_cast<size_t>(pnext - xstr) >= str_len){
-		error_display(0, "Error parsing id# in XSTR() tag %s\n", xstr);
-		return 0;
-	}
-	
+
 	// now get the id string
-	p = pnext+1;
+	p = pnext + 1;
 	while (is_gray_space(*p))
 		p++;
-	pnext = strchr(p+1, ')');
-	if(pnext == NULL){
+	pnext = (*p != '\0') ? strchr(p + 1, ')') : NULL;
+	if (pnext == NULL) {
 		error_display(0, "Error parsing id# in XSTR() tag %s\n", xstr);
 		return 0;
 	}
-	if(pnext - p >= PARSE_ID_BUF_SIZE){
+	if (pnext - p >= PARSE_ID_BUF_SIZE) {
 		error_display(0, "XSTR() id# is too long in %s\n", xstr);
 		return 0;
 	}
 	char buf[PARSE_ID_BUF_SIZE];
-	strncpy(buf, p, pnext - p);
+	memcpy(buf, p, pnext - p);
 	buf[pnext - p] = 0;
 
 	// get the value and we're done
-	*out = atoi(buf);
+	out->id = atoi(buf);
 
 	// success
 	return 1;
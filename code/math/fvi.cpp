@@ -12,6 +12,11 @@
 #include "math/fvi.h"
 #include "math/vecmat.h"
 
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+	#include <xmmintrin.h>
+	#define FVI_USE_SSE
+#endif
+
 
 #define	SMALL_NUM	1E-6
 
@@ -307,6 +312,113 @@ int fvi_ray_sphere(vec3d *intp, const vec3d *p0, const vec3d *p1, const vec3d *s
 		return 0;
 }
 
+void fvi_segment_sphere_batch::clear()
+{
+	for (int i = 0; i < 3; ++i) {
+		p0[i].clear();
+		p1[i].clear();
+		center[i].clear();
+	}
+	radius.clear();
+}
+
+void fvi_segment_sphere_batch::add(const vec3d *seg_p0, const vec3d *seg_p1, const vec3d *sphere_pos, float sphere_rad)
+{
+	for (int i = 0; i < 3; ++i) {
+		p0[i].push_back(seg_p0->a1d[i]);
+		p1[i].push_back(seg_p1->a1d[i]);
+		center[i].push_back(sphere_pos->a1d[i]);
+	}
+	radius.push_back(sphere_rad);
+}
+
+// The batch test grows the spheres by this factor so rounding differences to fvi_segment_sphere() can never cull a
+// segment the exact test would accept
+#define FVI_BATCH_RADIUS_SCALE	1.001f
+#define FVI_BATCH_RADIUS_ADD	0.01f
+
+/**
+ * Same test as fvi_segment_sphere() for a single entry of the batch
+ */
+static bool fvi_segment_sphere_batch_entry(const fvi_segment_sphere_batch *batch, size_t i)
+{
+	vec3d d, w;
+
+	for (int axis = 0; axis < 3; ++axis) {
+		d.a1d[axis] = batch->p1[axis][i] - batch->p0[axis][i];
+		w.a1d[axis] = batch->center[axis][i] - batch->p0[axis][i];
+	}
+
+	float rad = batch->radius[i] * FVI_BATCH_RADIUS_SCALE + FVI_BATCH_RADIUS_ADD;
+	float mag_d = MAX(vm_vec_mag(&d), 1e-20f);
+
+	// distance of the closest point along the line, the line may not pass the sphere further away than its radius
+	float w_dist = vm_vec_dot(&d, &w) / mag_d;
+
+	if ( (w_dist < -rad) || (w_dist > mag_d + rad) ) {
+		return false;
+	}
+
+	return (vm_vec_mag_squared(&w) - w_dist * w_dist) < rad * rad;
+}
+
+size_t fvi_segment_sphere_batch_test(const fvi_segment_sphere_batch *batch, SCP_vector<ubyte> *hits)
+{
+	size_t count = batch->size();
+	size_t num_hits = 0;
+	size_t i = 0;
+
+	hits->resize(count);
+
+#ifdef FVI_USE_SSE
+	const __m128 radius_scale = _mm_set1_ps(FVI_BATCH_RADIUS_SCALE);
+	const __m128 radius_add = _mm_set1_ps(FVI_BATCH_RADIUS_ADD);
+	const __m128 min_mag = _mm_set1_ps(1e-20f);
+
+	for (; i + 4 <= count; i += 4) {
+		__m128 dd = _mm_setzero_ps();
+		__m128 dw = _mm_setzero_ps();
+		__m128 ww = _mm_setzero_ps();
+
+		for (int axis = 0; axis < 3; ++axis) {
+			__m128 p0 = _mm_loadu_ps(&batch->p0[axis][i]);
+			__m128 d = _mm_sub_ps(_mm_loadu_ps(&batch->p1[axis][i]), p0);
+			__m128 w = _mm_sub_ps(_mm_loadu_ps(&batch->center[axis][i]), p0);
+
+			dd = _mm_add_ps(dd, _mm_mul_ps(d, d));
+			dw = _mm_add_ps(dw, _mm_mul_ps(d, w));
+			ww = _mm_add_ps(ww, _mm_mul_ps(w, w));
+		}
+
+		__m128 rad = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(&batch->radius[i]), radius_scale), radius_add);
+		__m128 mag_d = _mm_max_ps(_mm_sqrt_ps(dd), min_mag);
+		__m128 w_dist = _mm_div_ps(dw, mag_d);
+
+		__m128 in_front = _mm_cmpge_ps(w_dist, _mm_sub_ps(_mm_setzero_ps(), rad));
+		__m128 in_reach = _mm_cmple_ps(w_dist, _mm_add_ps(mag_d, rad));
+		__m128 close = _mm_cmplt_ps(_mm_sub_ps(ww, _mm_mul_ps(w_dist, w_dist)), _mm_mul_ps(rad, rad));
+
+		int mask = _mm_movemask_ps(_mm_and_ps(_mm_and_ps(in_front, in_reach), close));
+
+		for (int lane = 0; lane < 4; ++lane) {
+			ubyte hit = (mask & (1 << lane)) ? 1 : 0;
+
+			(*hits)[i + lane] = hit;
+			num_hits += hit;
+		}
+	}
+#endif
+
+	for (; i < count; ++i) {
+		ubyte hit = fvi_segment_sphere_batch_entry(batch, i) ? 1 : 0;
+
+		(*hits)[i] = hit;
+		num_hits += hit;
+	}
+
+	return num_hits;
+}
+
 /**
  * Finds intersection of a ray and an axis-aligned bounding box
  *
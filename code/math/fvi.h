@@ -96,6 +96,26 @@ int fvi_segment_sphere(vec3d *intp, const vec3d *p0, const vec3d *p1, const vec3
 //else returns 0
 int fvi_ray_sphere(vec3d *intp, const vec3d *p0, const vec3d *p1, const vec3d *sphere_pos, float sphere_rad);
 
+// A batch of segment vs. sphere tests for fvi_segment_sphere_batch(). Every entry is one segment and the sphere it is
+// tested against, stored as one array per coordinate so several entries can be tested at once.
+struct fvi_segment_sphere_batch {
+	SCP_vector<float> p0[3];
+	SCP_vector<float> p1[3];
+	SCP_vector<float> center[3];
+	SCP_vector<float> radius;
+
+	void clear();
+	void add(const vec3d *seg_p0, const vec3d *seg_p1, const vec3d *sphere_pos, float sphere_rad);
+	size_t size() const { return radius.size(); }
+};
+
+//determine for every segment of the batch if it intersects with its sphere
+//this gives the same answer as fvi_segment_sphere() (but doesn't find the intersection point), except that spheres
+//are allowed to be very slightly larger, so only use it for culling before doing the exact check
+//hits receives a non-zero value for every entry which may intersect
+//returns the number of entries which may intersect
+size_t fvi_segment_sphere_batch_test(const fvi_segment_sphere_batch *batch, SCP_vector<ubyte> *hits);
+
 
 //==============================================================
 // Finds intersection of a ray and an axis-aligned bounding box
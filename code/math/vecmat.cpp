@@ -14,6 +14,11 @@
 	#include <xmmintrin.h>
 #endif
 
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+	#include <xmmintrin.h>
+	#define VECMAT_USE_SSE
+#endif
+
 #include "math/vecmat.h"
 
 
@@ -949,6 +954,87 @@ vec3d *vm_vec_unrotate(vec3d *dest, const vec3d *src, const matrix *m)
 	return dest;
 }
 
+// dest[i] = rows * (src[i] - pre) + post for the batch functions below, pre and post may be NULL.
+// dest can equal src.
+static void vm_vec_transform_batch(vec3d *dest, const vec3d *src, size_t count, const float rows[3][3], const vec3d *pre, const vec3d *post)
+{
+	const vec3d &pre_v = pre ? *pre : vmd_zero_vector;
+	const vec3d &post_v = post ? *post : vmd_zero_vector;
+	size_t i = 0;
+
+#ifdef VECMAT_USE_SSE
+	const __m128 r00 = _mm_set1_ps(rows[0][0]), r01 = _mm_set1_ps(rows[0][1]), r02 = _mm_set1_ps(rows[0][2]);
+	const __m128 r10 = _mm_set1_ps(rows[1][0]), r11 = _mm_set1_ps(rows[1][1]), r12 = _mm_set1_ps(rows[1][2]);
+	const __m128 r20 = _mm_set1_ps(rows[2][0]), r21 = _mm_set1_ps(rows[2][1]), r22 = _mm_set1_ps(rows[2][2]);
+	const __m128 pre_x = _mm_set1_ps(pre_v.xyz.x), pre_y = _mm_set1_ps(pre_v.xyz.y), pre_z = _mm_set1_ps(pre_v.xyz.z);
+	const __m128 post_x = _mm_set1_ps(post_v.xyz.x), post_y = _mm_set1_ps(post_v.xyz.y), post_z = _mm_set1_ps(post_v.xyz.z);
+
+	// four vectors are exactly three registers
+	for (; i + 4 <= count; i += 4) {
+		const float *in = src[i].a1d;
+		float *out = dest[i].a1d;
+
+		__m128 x0y0z0x1 = _mm_loadu_ps(in);
+		__m128 y1z1x2y2 = _mm_loadu_ps(in + 4);
+		__m128 z2x3y3z3 = _mm_loadu_ps(in + 8);
+
+		__m128 x2y2x3y3 = _mm_shuffle_ps(y1z1x2y2, z2x3y3z3, _MM_SHUFFLE(2, 1, 3, 2));
+		__m128 y0z0y1z1 = _mm_shuffle_ps(x0y0z0x1, y1z1x2y2, _MM_SHUFFLE(1, 0, 2, 1));
+
+		__m128 x = _mm_sub_ps(_mm_shuffle_ps(x0y0z0x1, x2y2x3y3, _MM_SHUFFLE(2, 0, 3, 0)), pre_x);
+		__m128 y = _mm_sub_ps(_mm_shuffle_ps(y0z0y1z1, x2y2x3y3, _MM_SHUFFLE(3, 1, 2, 0)), pre_y);
+		__m128 z = _mm_sub_ps(_mm_shuffle_ps(y0z0y1z1, z2x3y3z3, _MM_SHUFFLE(3, 0, 3, 1)), pre_z);
+
+		__m128 rx = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, r00), _mm_mul_ps(y, r01)), _mm_add_ps(_mm_mul_ps(z, r02), post_x));
+		__m128 ry = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, r10), _mm_mul_ps(y, r11)), _mm_add_ps(_mm_mul_ps(z, r12), post_y));
+		__m128 rz = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, r20), _mm_mul_ps(y, r21)), _mm_add_ps(_mm_mul_ps(z, r22), post_z));
+
+		__m128 xy01 = _mm_unpacklo_ps(rx, ry);
+		__m128 xy23 = _mm_unpackhi_ps(rx, ry);
+		__m128 z0z0x1x1 = _mm_shuffle_ps(rz, rx, _MM_SHUFFLE(1, 1, 0, 0));
+		__m128 y1y1z1z1 = _mm_shuffle_ps(ry, rz, _MM_SHUFFLE(1, 1, 1, 1));
+		__m128 z2z2x3x3 = _mm_shuffle_ps(rz, rx, _MM_SHUFFLE(3, 3, 2, 2));
+		__m128 y3y3z3z3 = _mm_shuffle_ps(ry, rz, _MM_SHUFFLE(3, 3, 3, 3));
+
+		_mm_storeu_ps(out, _mm_shuffle_ps(xy01, z0z0x1x1, _MM_SHUFFLE(2, 0, 1, 0)));
+		_mm_storeu_ps(out + 4, _mm_shuffle_ps(y1y1z1z1, xy23, _MM_SHUFFLE(1, 0, 2, 0)));
+		_mm_storeu_ps(out + 8, _mm_shuffle_ps(z2z2x3x3, y3y3z3z3, _MM_SHUFFLE(2, 0, 2, 0)));
+	}
+#endif
+
+	for (; i < count; ++i) {
+		float x = src[i].xyz.x - pre_v.xyz.x;
+		float y = src[i].xyz.y - pre_v.xyz.y;
+		float z = src[i].xyz.z - pre_v.xyz.z;
+
+		dest[i].xyz.x = (x*rows[0][0]) + (y*rows[0][1]) + (z*rows[0][2]) + post_v.xyz.x;
+		dest[i].xyz.y = (x*rows[1][0]) + (y*rows[1][1]) + (z*rows[1][2]) + post_v.xyz.y;
+		dest[i].xyz.z = (x*rows[2][0]) + (y*rows[2][1]) + (z*rows[2][2]) + post_v.xyz.z;
+	}
+}
+
+void vm_vec_rotate_n(vec3d *dest, const vec3d *src, size_t count, const matrix *m, const vec3d *origin)
+{
+	const float rows[3][3] = {
+		{ m->vec.rvec.xyz.x, m->vec.rvec.xyz.y, m->vec.rvec.xyz.z },
+		{ m->vec.uvec.xyz.x, m->vec.uvec.xyz.y, m->vec.uvec.xyz.z },
+		{ m->vec.fvec.xyz.x, m->vec.fvec.xyz.y, m->vec.fvec.xyz.z },
+	};
+
+	vm_vec_transform_batch(dest, src, count, rows, origin, NULL);
+}
+
+void vm_vec_unrotate_n(vec3d *dest, const vec3d *src, size_t count, const matrix *m, const vec3d *pos)
+{
+	const float rows[3][3] = {
+		{ m->vec.rvec.xyz.x, m->vec.uvec.xyz.x, m->vec.fvec.xyz.x },
+		{ m->vec.rvec.xyz.y, m->vec.uvec.xyz.y, m->vec.fvec.xyz.y },
+		{ m->vec.rvec.xyz.z, m->vec.uvec.xyz.z, m->vec.fvec.xyz.z },
+	};
+
+	vm_vec_transform_batch(dest, src, count, rows, NULL, pos);
+}
+
 //transpose a matrix in place. returns ptr to matrix
 matrix *vm_transpose(matrix *m)
 {
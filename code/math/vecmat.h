@@ -292,6 +292,32 @@ vec3d *vm_vec_rotate(vec3d *dest, const vec3d *src, const matrix *m);
 // vm_vec_transpose() / vm_vec_rotate() technique.
 vec3d *vm_vec_unrotate(vec3d *dest, const vec3d *src, const matrix *m);
 
+/**
+ * @brief Rotates an array of vectors through a matrix, like vm_vec_rotate() for each of them
+ *
+ * Four vectors are rotated at once where SSE is available.
+ *
+ * @param dest The rotated vectors, may be the same array as @a src
+ * @param src The vectors
+ * @param count The number of vectors
+ * @param m The matrix
+ * @param origin If not NULL, this is subtracted from the vectors before they are rotated, which turns world positions
+ * into positions relative to @a origin and @a m like g3_rotate_vector() does
+ */
+void vm_vec_rotate_n(vec3d *dest, const vec3d *src, size_t count, const matrix *m, const vec3d *origin = NULL);
+
+/**
+ * @brief Rotates an array of vectors through the transpose of a matrix, like vm_vec_unrotate() for each of them
+ *
+ * @param dest The rotated vectors, may be the same array as @a src
+ * @param src The vectors
+ * @param count The number of vectors
+ * @param m The matrix
+ * @param pos If not NULL, this is added to the vectors after they are rotated, which turns the points of an object
+ * into world positions
+ */
+void vm_vec_unrotate_n(vec3d *dest, const vec3d *src, size_t count, const matrix *m, const vec3d *pos = NULL);
+
 //transpose a matrix in place. returns ptr to matrix
 matrix *vm_transpose(matrix *m);
 
@@ -382,6 +382,7 @@ void mission_init_goals()
 		Mission_events[i].born_on_date = 0;
 		Mission_events[i].team = -1;
 		Mission_events[i].mission_log_flags = 0;
+		Mission_events[i].earliest_time = 0;
 	}
 
 	Mission_goal_timestamp = timestamp(GOAL_TIMESTAMP);
@@ -954,6 +955,9 @@ void mission_process_event( int event )
 		if ((Mission_events[event].mission_log_flags != 0) || Snapshot_all_events){
 			maybe_write_to_event_log(result);
 		}
+
+		// a false event which waits for a fixed time doesn't need to be evaluated again until then
+		Mission_events[event].earliest_time = result ? 0 : sexp_event_earliest_time(sindex);
 	}
 
 	Log_event = false;
@@ -1037,6 +1041,9 @@ void mission_eval_goals()
 {
 	int i, result;
 
+	// the goals and events checked this frame see the same mission, so they can share the results of pure operators
+	sexp_pure_results_begin();
+
 	// before checking whether or not we should evaluate goals, we should run through the events and
 	// process any whose timestamp is valid and has expired.  This would catch repeating events only
 	for (i=0; i<Num_mission_events; i++) {
@@ -1053,6 +1060,7 @@ void mission_eval_goals()
 	}
 	
 	if ( !timestamp_elapsed(Mission_goal_timestamp) ){
+		sexp_pure_results_end();
 		return;
 	}
 
@@ -1082,12 +1090,19 @@ void mission_eval_goals()
 			// we will evaluate repeatable events at the top of the file so we can get
 			// the exact interval that the designer asked for.
 			if ( !timestamp_valid( Mission_events[i].timestamp) ){
+				// nothing changes until the time the event waits for, unless the evaluation has to be logged
+				if ((Missiontime < Mission_events[i].earliest_time) && (Mission_events[i].mission_log_flags == 0) && !Snapshot_all_events) {
+					continue;
+				}
+
 				TRACE_SCOPE(tracing::NonrepeatingEvents);
 				mission_process_event( i );
 			}
 		}
 	}
 
+	sexp_pure_results_end();
+
 	// send and remaining sexp data to the clients
 	if (MULTIPLAYER_MASTER) {
 		Current_sexp_network_packet.sexp_flush_packet();
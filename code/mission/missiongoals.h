@@ -123,6 +123,7 @@ typedef struct mission_event {
 	SCP_vector<SCP_string> event_log_argument_buffer;
 	SCP_vector<SCP_string> backup_log_buffer;
 	int	previous_result;		// result of previous evaluation of event
+	fix	earliest_time;			// mission time before which evaluating the event is known not to do anything
 
 } mission_event;
 
@@ -23,6 +23,7 @@
 #include "parse/parselo.h"
 #include "playerman/player.h"
 #include "ship/ship.h"
+#include "utils/string_intern.h"
 
 
 
@@ -69,9 +70,90 @@ static fix Log_line_timestamps[MAX_LOG_LINES];
 log_entry log_entries[MAX_LOG_ENTRIES];	// static array because John says....
 int last_entry;
 
+// the indexes of the log entries by their type and primary name, each list is in the order the entries were added
+static SCP_unordered_map<uint64_t, SCP_vector<int>> Log_entry_index;
+
+// the number of times the log changed, never reset so it can't repeat between missions
+static int Log_changes = 0;
+
+static uint64_t mission_log_index_key(int type, int name_id)
+{
+	return (static_cast<uint64_t>(static_cast<uint32_t>(type)) << 32) | static_cast<uint32_t>(name_id);
+}
+
+static void mission_log_index_entry(int entry_index)
+{
+	auto entry = &log_entries[entry_index];
+
+	Log_entry_index[mission_log_index_key(entry->type, string_intern::intern(entry->pname))].push_back(entry_index);
+}
+
+static void mission_log_rebuild_index()
+{
+	for (auto& key_entries : Log_entry_index) {
+		key_entries.second.clear();
+	}
+
+	for (int i = 0; i < last_entry; i++) {
+		mission_log_index_entry(i);
+	}
+}
+
+// returns the indexes of the entries with the given type and primary name or NULL if there are none
+static const SCP_vector<int>* mission_log_index_find(int type, const char *name)
+{
+	if (name == NULL) {
+		return NULL;
+	}
+
+	auto name_id = string_intern::find(name);
+	if (name_id == string_intern::INVALID_ID) {
+		return NULL;
+	}
+
+	auto it = Log_entry_index.find(mission_log_index_key(type, name_id));
+	if (it == Log_entry_index.end() || it->second.empty()) {
+		return NULL;
+	}
+
+	return &it->second;
+}
+
+// calls func on every entry of the given type whose primary name is one of the two names, in the order the entries
+// were added, until func returns true.  The names may be NULL.
+template<typename Func>
+static void mission_log_for_each_entry(int type, const char *name1, const char *name2, Func func)
+{
+	auto list1 = mission_log_index_find(type, name1);
+	auto list2 = mission_log_index_find(type, name2);
+
+	if (list1 == list2) {
+		list2 = NULL;
+	}
+
+	size_t i1 = 0, i2 = 0;
+	size_t size1 = list1 ? list1->size() : 0;
+	size_t size2 = list2 ? list2->size() : 0;
+
+	while (i1 < size1 || i2 < size2) {
+		int entry_index;
+
+		if (i2 == size2 || (i1 < size1 && (*list1)[i1] < (*list2)[i2])) {
+			entry_index = (*list1)[i1++];
+		} else {
+			entry_index = (*list2)[i2++];
+		}
+
+		if (func(&log_entries[entry_index])) {
+			return;
+		}
+	}
+}
+
 void mission_log_init()
 {
 	last_entry = 0;
+	Log_entry_index.clear();
 
 	// zero out all the memory so we don't get bogus information when playing across missions!
 	memset( log_entries, 0, sizeof(log_entries) );
@@ -116,6 +198,10 @@ void mission_log_cull_obsolete_entries()
 		log_entries[i++] = log_entries[index++];
 	} while ( i < last_entry );
 
+	// the entries have moved
+	mission_log_rebuild_index();
+	Log_changes++;
+
 #ifndef NDEBUG
 	nprintf(("missionlog", "Ending entry: %d.\n", last_entry));
 #endif
@@ -375,7 +461,9 @@ void mission_log_add_entry(int type, const char *pname, const char *sname, int i
 		send_mission_log_packet( last_entry );
 	}
 
+	mission_log_index_entry(last_entry);
 	last_entry++;
+	Log_changes++;
 
 #ifndef NDEBUG
 	if ( !(last_entry % 10) ) {
@@ -423,73 +511,83 @@ void mission_log_add_entry_multi( int type, const char *pname, const char *sname
 
 	entry->flags = flags;
 	entry->timestamp = timestamp;
+
+	mission_log_index_entry(last_entry - 1);
+	Log_changes++;
+}
+
+// returns a number which is different every time an entry is added to the log or entries are removed from it
+int mission_log_get_change_count()
+{
+	return Log_changes;
 }
 
 // function to determine is the given event has taken place count number of times.
 
 int mission_log_get_time_indexed( int type, const char *pname, const char *sname, int count, fix *time)
 {
-	int i, found;
-	log_entry *entry;
+	int found = 0;
+
+	// if we are looking for a dock/undock entry, then we don't care about the order in which the names
+	// were passed into this function.  Count the entry as found if either name matches both in the other
+	// set.
+	if ( (type == LOG_SHIP_DOCKED) || (type == LOG_SHIP_UNDOCKED) ) {
+		if (sname == NULL) {
+			Int3();
+			return 0;
+		}
 
-	entry = &log_entries[0];
+		mission_log_for_each_entry(type, pname, sname, [&](log_entry *entry) {
+			if ( (!stricmp(entry->pname, pname) && !stricmp(entry->sname, sname)) || (!stricmp(entry->pname, sname) && !stricmp(entry->sname, pname)) ) {
+				count--;
+			}
 
-	for (i = 0; i < last_entry; i++, entry++) {
-		found = 0;
+			if ( !count ) {
+				found = 1;
+				entry->flags |= MLF_ESSENTIAL;				// since the goal code asked for this entry, mark it as essential
 
-		if ( entry->type == type ) {
-			// if we are looking for a dock/undock entry, then we don't care about the order in which the names
-			// were passed into this function.  Count the entry as found if either name matches both in the other
-			// set.
-			if ( (type == LOG_SHIP_DOCKED) || (type == LOG_SHIP_UNDOCKED) ) {
-				if (sname == NULL) {
-					Int3();
-					return 0;
+				if (time) {
+					*time = entry->timestamp;
 				}
+			}
 
-				if ( (!stricmp(entry->pname, pname) && !stricmp(entry->sname, sname)) || (!stricmp(entry->pname, sname) && !stricmp(entry->sname, pname)) ) {
-					found = 1;
-				}
-			} else {
-				// for non dock/undock goals, then the names are important!
-				if (pname == NULL) {
-					Int3();
-					return 0;
-				}
+			return found != 0;
+		});
+	} else {
+		// for non dock/undock goals, then the names are important!
+		if (pname == NULL) {
+			Int3();
+			return 0;
+		}
 
-				if ( stricmp(entry->pname, pname) ) {
-					continue;
+		mission_log_for_each_entry(type, pname, NULL, [&](log_entry *entry) {
+			// if we are looking for a subsystem entry, the subsystem names must be compared
+			if ((type == LOG_SHIP_SUBSYS_DESTROYED || type == LOG_CAP_SUBSYS_CARGO_REVEALED)) {
+				if ( (sname != NULL) && subsystem_stricmp(sname, entry->sname) ) {
+					return false;
 				}
-
-				// if we are looking for a subsystem entry, the subsystem names must be compared
-				if ((type == LOG_SHIP_SUBSYS_DESTROYED || type == LOG_CAP_SUBSYS_CARGO_REVEALED)) {
-					if ( (sname == NULL) || !subsystem_stricmp(sname, entry->sname) ) {
-						found = 1;
-					}
-				} else {
-					if ( (sname == NULL) || !stricmp(sname, entry->sname) ) {
-						found = 1;
-					}
+			} else {
+				if ( (sname != NULL) && stricmp(sname, entry->sname) ) {
+					return false;
 				}
 			}
 
-			if ( found ) {
-				count--;
+			count--;
 
-				if ( !count ) {
-					entry->flags |= MLF_ESSENTIAL;				// since the goal code asked for this entry, mark it as essential
-
-					if (time) {
-						*time = entry->timestamp;
-					}
+			if ( !count ) {
+				found = 1;
+				entry->flags |= MLF_ESSENTIAL;				// since the goal code asked for this entry, mark it as essential
 
-					return 1;
+				if (time) {
+					*time = entry->timestamp;
 				}
 			}
-		}
+
+			return found != 0;
+		});
 	}
 
-	return 0;
+	return found;
 }
 
 // this function determines if the given type of event on the specified
@@ -504,43 +602,36 @@ int mission_log_get_time( int type, const char *pname, const char *sname, fix *t
 
 int mission_log_get_count( int type, const char *pname, const char *sname )
 {
-	int i;
-	log_entry *entry;
-	int count = 0;  
-
-	entry = &log_entries[0];
-
-	for (i = 0; i < last_entry; i++, entry++) {
-
-		if ( entry->type == type ) {
-			// if we are looking for a dock/undock entry, then we don't care about the order in which the names
-			// were passed into this function.  Count the entry as found if either name matches both in the other
-			// set.
-			if ( (type == LOG_SHIP_DOCKED) || (type == LOG_SHIP_UNDOCKED) ) {
-				if (sname == NULL) {
-					Int3();
-					return 0;
-				}
-
-				if ( (!stricmp(entry->pname, pname) && !stricmp(entry->sname, sname)) || (!stricmp(entry->pname, sname) && !stricmp(entry->sname, pname)) ) {
-					count++;
-				}
-			} else {
-				// for non dock/undock goals, then the names are important!
-				if (pname == NULL) {
-					Int3();
-					return 0;
-				}
-
-				if ( stricmp(entry->pname, pname) ) {
-					continue;
-				}
+	int count = 0;
+
+	// if we are looking for a dock/undock entry, then we don't care about the order in which the names
+	// were passed into this function.  Count the entry as found if either name matches both in the other
+	// set.
+	if ( (type == LOG_SHIP_DOCKED) || (type == LOG_SHIP_UNDOCKED) ) {
+		if (sname == NULL) {
+			Int3();
+			return 0;
+		}
 
-				if ( (sname == NULL) || !stricmp(sname, entry->sname) ) {
-					count++;
-				}
+		mission_log_for_each_entry(type, pname, sname, [&](log_entry *entry) {
+			if ( (!stricmp(entry->pname, pname) && !stricmp(entry->sname, sname)) || (!stricmp(entry->pname, sname) && !stricmp(entry->sname, pname)) ) {
+				count++;
 			}
+			return false;
+		});
+	} else {
+		// for non dock/undock goals, then the names are important!
+		if (pname == NULL) {
+			Int3();
+			return 0;
 		}
+
+		mission_log_for_each_entry(type, pname, NULL, [&](log_entry *entry) {
+			if ( (sname == NULL) || !stricmp(sname, entry->sname) ) {
+				count++;
+			}
+			return false;
+		});
 	}
 
 	return count;
@@ -81,6 +81,9 @@ extern int mission_log_get_time_indexed( int type, const char *name, const char
 // get the number of times an event happened
 extern int mission_log_get_count( int type, const char *pname, const char *sname ); 
 
+// get a number which changes whenever the log changes
+extern int mission_log_get_change_count();
+
 // function to show all message log entries during or after mission
 // (code stolen liberally from Alan!)
 extern void mission_log_scrollback(float frametime);
@@ -21,6 +21,7 @@
 #include "iff_defs/iff_defs.h"
 #include "io/timer.h"
 #include "localization/localize.h"
+#include "mission/missiongoals.h"
 #include "mission/missionmessage.h"
 #include "mission/missiontraining.h"
 #include "mod_table/mod_table.h"
@@ -33,9 +34,12 @@
 #include "ship/ship.h"
 #include "ship/subsysdamage.h"
 #include "sound/fsspeech.h"
+#include "sound/sound.h"
 #include "species_defs/species_defs.h"
 #include "weapon/emp.h"
 
+#include <algorithm>
+
 SCP_vector<SCP_string> Builtin_moods;
 int Current_mission_mood;
 
@@ -195,6 +199,16 @@ static int Message_wave_muted;
 static int Message_wave_duration;
 static int Next_mute_time;
 
+// the voice files of the queued messages, and of the messages of the events which can fire soon, are prefetched
+#define MESSAGE_PREFETCH_INTERVAL		250			// milliseconds between looking for waves to prefetch
+#define MESSAGE_PREFETCH_EVENT_TIME		(F1_0*5)	// how far ahead of the time they wait for events are looked at
+
+static int Message_prefetch_timestamp;
+
+// the Message_waves[] indices of the messages each event sends, found the first time they're needed in a mission
+static SCP_vector<SCP_vector<int>> Message_event_waves;
+static bool Message_event_waves_found;
+
 #define MAX_DISTORT_PATTERNS	2
 #define MAX_DISTORT_LEVELS		6
 static float Distort_patterns[MAX_DISTORT_PATTERNS][MAX_DISTORT_LEVELS] = 
@@ -735,6 +749,10 @@ void messages_init()
 	Message_wave_muted = 0;
 	Next_mute_time = 1;
 
+	Message_prefetch_timestamp = timestamp(0);
+	Message_event_waves.clear();
+	Message_event_waves_found = false;
+
 	//wipe all the non-builtin messages
 	Messages.erase((Messages.begin()+Num_builtin_messages), Messages.end()); 
 	Message_avis.erase((Message_avis.begin()+Num_builtin_avis), Message_avis.end()); 
@@ -772,6 +790,9 @@ void message_mission_shutdown()
 		}
 	}
 
+	// and the prefetched ones which were never played
+	snd_prefetch_clear();
+
 	fsspeech_stop();
 
 	// free up remaining anim data - taylor
@@ -1013,6 +1034,28 @@ void message_load_wave(int index, const char *filename)
 		nprintf(("messaging", "Cannot load message wave: %s.  Will not play\n", Message_waves[index].name));
 }
 
+// Bashes the name of a voice file into the one of its Terran Command version. Look for "[1-6]_" at the front of the
+// name.  If found, then convert to TC_*
+//
+// returns:	false if the name can't be converted
+static bool message_convert_to_command_wave(char *filename)
+{
+	char *p, new_filename[MAX_FILENAME_LEN];
+
+	p = strchr(filename, '_' );
+	if ( p == NULL ) {
+		return false;
+	}
+
+	// prepend the command name, and then the rest of the filename.
+	p++;
+	strcpy_s( new_filename, COMMAND_WAVE_PREFIX );
+	strcat_s( new_filename, p );
+	strcpy_s( filename, MAX_FILENAME_LEN, new_filename );
+
+	return true;
+}
+
 // Goober5000
 bool message_filename_is_generic(char *filename)
 {
@@ -1061,23 +1104,12 @@ bool message_play_wave( message_q *q )
 
 		// if we need to bash the wave name because of "conversion" to terran command, do it here
 		if ( q->flags & MQF_CONVERT_TO_COMMAND ) {
-			char *p, new_filename[MAX_FILENAME_LEN];
-
 			Message_waves[index].num = -1;					// forces us to reload the message
 
-			// bash the filename here. Look for "[1-6]_" at the front of the message.  If found, then
-			// convert to TC_*
-			p = strchr(filename, '_' );
-			if ( p == NULL ) {
+			if ( !message_convert_to_command_wave(filename) ) {
 				mprintf(("Cannot convert %s to terran command wave -- find Sandeep or Allender\n", Message_waves[index].name));
 				return false;
 			}
-
-			// prepend the command name, and then the rest of the filename.
-			p++;
-			strcpy_s( new_filename, COMMAND_WAVE_PREFIX );
-			strcat_s( new_filename, p );
-			strcpy_s( filename, new_filename );
 		}
 
 		// load the sound file into memory
@@ -1280,6 +1312,117 @@ void message_play_anim( message_q *q )
 /** 
  * process the message queue -- called once a frame
  */
+// Finds the waves of the messages the events send with literal message names
+static void message_find_event_waves()
+{
+	SCP_vector<SCP_string> names;
+
+	Message_event_waves.clear();
+	Message_event_waves.resize(Num_mission_events);
+
+	for (int event = 0; event < Num_mission_events; event++) {
+		if (Mission_events[event].formula < 0) {
+			continue;
+		}
+
+		names.clear();
+		sexp_get_message_arguments(Mission_events[event].formula, names);
+
+		auto& waves = Message_event_waves[event];
+
+		for (auto& name : names) {
+			for (int i = 0; i < Num_messages; i++) {
+				if ( !stricmp(name.c_str(), Messages[i].name) ) {
+					int index = Messages[i].wave_info.index;
+
+					if ( (index >= 0) && (std::find(waves.begin(), waves.end(), index) == waves.end()) ) {
+						waves.push_back(index);
+					}
+					break;
+				}
+			}
+		}
+	}
+
+	Message_event_waves_found = true;
+}
+
+// Whether an event waits for a time which is about to come, so the messages it sends may be played soon.  Events
+// which just wait for a condition can't be predicted.
+static bool message_event_fires_soon(int event)
+{
+	mission_event *ev = &Mission_events[event];
+
+	if (ev->formula < 0) {
+		return false;
+	}
+
+	// a repeating event is evaluated again when its timestamp runs out
+	if ( timestamp_valid(ev->timestamp) ) {
+		return timestamp_until(ev->timestamp) <= f2i(MESSAGE_PREFETCH_EVENT_TIME) * 1000;
+	}
+
+	// the same chaining rules as mission_process_event()
+	if ( (ev->chain_delay >= 0) && (event > 0) ) {
+		mission_event *prev = &Mission_events[event - 1];
+
+		if ( !prev->result ) {
+			return false;
+		}
+
+		fix chain_time = (Alternate_chaining_behavior ? (fix) prev->satisfied_time : (fix) prev->timestamp) + i2f(ev->chain_delay);
+		if ( chain_time > Missiontime ) {
+			return chain_time - Missiontime <= MESSAGE_PREFETCH_EVENT_TIME;
+		}
+	}
+
+	return (ev->earliest_time > Missiontime) && (ev->earliest_time - Missiontime <= MESSAGE_PREFETCH_EVENT_TIME);
+}
+
+// Hands the voice files which are likely to be played next to snd_prefetch(), so they're decoded on a job worker
+// instead of when the messages start
+static void message_prefetch_waves()
+{
+	char filename[MAX_FILENAME_LEN];
+
+	if ( !Sound_enabled || !timestamp_elapsed(Message_prefetch_timestamp) ) {
+		return;
+	}
+
+	Message_prefetch_timestamp = timestamp(MESSAGE_PREFETCH_INTERVAL);
+
+	// the queue is sorted by priority, so the messages which play first are decoded first
+	for (int i = 0; i < MessageQ_num; i++) {
+		message_q *q = &MessageQ[i];
+
+		if ( (q->message_num < 0) || (Messages[q->message_num].wave_info.index < 0) ) {
+			continue;
+		}
+
+		strcpy_s( filename, Message_waves[Messages[q->message_num].wave_info.index].name );
+
+		if ( (q->flags & MQF_CONVERT_TO_COMMAND) && !message_convert_to_command_wave(filename) ) {
+			continue;
+		}
+
+		snd_prefetch(filename);
+	}
+
+	if ( !Message_event_waves_found ) {
+		message_find_event_waves();
+	}
+
+	for (int event = 0; event < Num_mission_events && event < (int)Message_event_waves.size(); event++) {
+		if ( Message_event_waves[event].empty() || !message_event_fires_soon(event) ) {
+			continue;
+		}
+
+		for (auto index : Message_event_waves[event]) {
+			snd_prefetch(Message_waves[index].name);
+		}
+	}
+}
+
 void message_queue_process()
 {	
 	char	buf[MESSAGE_LENGTH];
@@ -1295,6 +1438,8 @@ void message_queue_process()
 		return;
 	}
 
+	message_prefetch_waves();
+
 	// determine if all playing messages (if any) are done playing.  If any are done, remove their
 	// entries collapsing the Playing_messages array if necessary
 	if ( Num_messages_playing > 0 ) {
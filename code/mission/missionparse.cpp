@@ -20,6 +20,8 @@
 #include <stdarg.h>
 #include <setjmp.h>
 
+#include <algorithm>
+
 
 #include "ai/aigoals.h"
 #include "asteroid/asteroid.h"
@@ -125,6 +127,11 @@ p_object Ship_arrival_list;	// for linked list of ships to arrive later
 // all the ships that we parse
 SCP_vector<p_object> Parse_objects;
 
+// the indices of the parse objects by their lower case names, see mission_parse_get_parse_object()
+static SCP_unordered_map<SCP_string, size_t> Parse_object_index;
+static size_t Parse_object_index_count = 0;
+static bool Parse_object_index_dirty = true;
+
 
 // list for arriving support ship
 p_object	Support_ship_pobj;
@@ -1850,7 +1857,9 @@ int parse_create_object_sub(p_object *p_objp)
 
 	shipp->group = p_objp->group;
 	shipp->team = p_objp->team;
+	ship_name_index_remove(shipnum);
 	strcpy_s(shipp->ship_name, p_objp->name);
+	ship_name_index_add(shipnum);
 	shipp->escort_priority = p_objp->escort_priority;
 	shipp->use_special_explosion = p_objp->use_special_explosion;
 	shipp->special_exp_damage = p_objp->special_exp_damage;
@@ -3755,6 +3764,7 @@ void parse_objects(mission *pm, int flag)
 
 	// parse in objects
 	Parse_objects.clear();
+	Parse_object_index_dirty = true;
 	while (required_string_either("#Wings", "$Name:"))
 	{
 		p_object pobj;
@@ -3893,18 +3903,36 @@ p_object *mission_parse_get_parse_object(ushort net_signature)
 	return NULL;
 }
 
+static SCP_string parse_object_index_key(const char *name)
+{
+	SCP_string key = name;
+	std::transform(key.begin(), key.end(), key.begin(), ::tolower);
+	return key;
+}
+
 // Goober5000 - also get it by name
 p_object *mission_parse_get_parse_object(const char *name)
 {
-	SCP_vector<p_object>::iterator ii;
+	// the names don't change once an object is parsed, so the index only has to follow the objects which are added
+	if (Parse_object_index_dirty || (Parse_object_index_count != Parse_objects.size()))
+	{
+		Parse_object_index.clear();
 
-	// look for original ships
-	for (ii = Parse_objects.begin(); ii != Parse_objects.end(); ++ii)
-		if (!stricmp(ii->name, name))
-			return &(*ii);
+		// the first object of a name wins, like the search this replaces
+		for (size_t i = 0; i < Parse_objects.size(); i++)
+			Parse_object_index.emplace(parse_object_index_key(Parse_objects[i].name), i);
+
+		Parse_object_index_count = Parse_objects.size();
+		Parse_object_index_dirty = false;
+	}
+
+	auto iter = Parse_object_index.find(parse_object_index_key(name));
 
 	// boo
-	return NULL;
+	if (iter == Parse_object_index.end())
+		return NULL;
+
+	return &Parse_objects[iter->second];
 }
 
 int find_wing_name(char *name)
@@ -3946,7 +3974,7 @@ int parse_wing_create_ships( wing *wingp, int num_to_create, int force, int spec
 		// 2) multiplayer and I am the host of the game
 		// can't create any ships if the arrival cue is false or the timestamp has not elapsed.
 
-		if ( !eval_sexp(wingp->arrival_cue) ) /* || !timestamp_elapsed(wingp->arrival_delay) ) */
+		if ( !eval_cue(wingp->arrival_cue) ) /* || !timestamp_elapsed(wingp->arrival_delay) ) */
 			return 0;
 
 		// once the sexpressions becomes true, then check the arrival delay on the wing.  The first time, the
@@ -4728,6 +4756,26 @@ void post_process_ships_wings()
 	// both ships and wings have been parsed.
 	mission_parse_set_up_initial_docks();
 
+	// load the models of all ship classes in the mission up front so the job workers can process them while the
+	// next file is read, nothing in the loop below has to wait for them then
+	SCP_vector<bool> class_loaded(Ship_info.size(), false);
+
+	model_begin_batch_load();
+
+	for (SCP_vector<p_object>::iterator ii = Parse_objects.begin(); ii != Parse_objects.end(); ++ii)
+	{
+		if (class_loaded[ii->ship_class])
+			continue;
+
+		class_loaded[ii->ship_class] = true;
+
+		ship_info *sip = &Ship_info[ii->ship_class];
+
+		sip->model_num = model_load(sip->pof_file, sip->n_subsystems, (sip->n_subsystems > 0) ? &sip->subsystems[0] : NULL);
+	}
+
+	model_end_batch_load();
+
 	// Goober5000 - now create all objects that we can.  This must be done before any ship stuff
 	// but can't be done until the dock references are resolved.  This was originally done
 	// in parse_object().
@@ -6022,6 +6070,7 @@ void mission_parse_close()
 
 	// the destructor for each p_object will clear its dock list
 	Parse_objects.clear();
+	Parse_object_index_dirty = true;
 }
 
 /**
@@ -6648,7 +6697,7 @@ int mission_did_ship_arrive(p_object *objp)
 	int should_arrive;
 
 	// find out in the arrival cue became true
-	should_arrive = eval_sexp(objp->arrival_cue);
+	should_arrive = eval_cue(objp->arrival_cue);
 
 	// we must first check to see if this ship is a reinforcement or not.  If so, then don't
 	// process
@@ -6895,7 +6944,7 @@ void mission_eval_arrivals()
 		{
 			// check to see in the wings arrival cue is true, and if so, then mark the reinforcement
 			// as available
-			if (eval_sexp(wingp->arrival_cue))
+			if (eval_cue(wingp->arrival_cue))
 				mission_parse_mark_reinforcement_available(wingp->name);
 
 			// reinforcement wings skip the rest of the loop
@@ -7177,7 +7226,7 @@ void mission_eval_departures()
 			// when the departure cue becomes true, set off the departure delay timer.  We store the
 			// timer as -seconds in FreeSpace which indicates that the timer has not been set.  If the timer
 			// is not set, then turn it into a valid timer and keep evaluating the timer until it is elapsed
-			if ( eval_sexp(shipp->departure_cue) ) {
+			if ( eval_cue(shipp->departure_cue) ) {
 				if ( shipp->departure_delay <= 0 )
 					shipp->departure_delay = timestamp(-shipp->departure_delay * 1000 );
 				if ( timestamp_elapsed(shipp->departure_delay) )
@@ -7203,7 +7252,7 @@ void mission_eval_departures()
 		// that have not yet arrived as departed if they never arrive -- this may be bad, but for some reason
 		// seems like the right thing to do).
 
-		if ( eval_sexp(wingp->departure_cue) ) {
+		if ( eval_cue(wingp->departure_cue) ) {
 			// if we haven't set up the departure timer yet (would be <= 0) setup the timer to pop N seconds
 			// later
 			if ( wingp->departure_delay <= 0 )
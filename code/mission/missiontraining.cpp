@@ -11,6 +11,7 @@
 
 
 #include "cfile/cfile.h"
+#include "controlconfig/controlsconfig.h"
 #include "gamesequence/gamesequence.h"
 #include "globalincs/alphacolors.h"
 #include "hud/hudmessage.h"
@@ -222,6 +223,60 @@ void HudGaugeDirectives::pageIn()
 	bm_page_in_aabitmap(directives_bottom.first_frame, directives_bottom.num_frames);
 }
 
+bool HudGaugeDirectives::getContentVersion(hud_content_hash& hash)
+{
+	int i, z, end, offset;
+	bool key_lines = false;
+
+	hash.add(Training_obj_num_lines);
+	hash.add(Max_directives);
+
+	offset = 0;
+	end = Training_obj_num_lines;
+	if (end > Max_directives) {
+		end = Max_directives;
+		offset = Training_obj_num_lines - end;
+	}
+
+	for (i=0; i<end; i++) {
+		z = TRAINING_OBJ_LINES_MASK(i + offset);
+
+		hash.add(Training_obj_lines[i + offset]);
+
+		if (Training_obj_lines[i + offset] & TRAINING_OBJ_LINES_KEY) {
+			hash.addString(Mission_events[z].objective_key_text);
+			key_lines = true;
+			continue;
+		}
+
+		hash.addString(Mission_events[z].objective_text);
+		hash.add(Mission_events[z].count);
+		hash.add(Mission_events[z].team);
+
+		int status = mission_get_event_status(z);
+		hash.add(status);
+
+		// a directive blinks for two seconds after it was completed
+		if ((status == EVENT_SATISFIED) && (Mission_events[z].satisfied_time + i2f(2) > Missiontime)) {
+			hash.add(Missiontime % fl2f(.4f) < fl2f(.2f));
+		}
+	}
+
+	if ((MULTI_TEAM) && (Net_player != NULL)) {
+		hash.add(Net_player->p_info.team);
+	}
+
+	// the key lines show the keys the controls are bound to
+	if (key_lines) {
+		for (i=0; i<CCFG_MAX; i++) {
+			hash.add(Control_config[i].key_id);
+			hash.add(Control_config[i].joy_id);
+		}
+	}
+
+	return true;
+}
+
 void HudGaugeDirectives::render(float frametime)
 {
 	char buf[256], *second_line;
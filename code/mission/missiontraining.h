@@ -50,6 +50,7 @@ public:
 	void initTextHeight(int h);
 	void initMaxLineWidth(int w);
 	void render(float frametime);
+	bool getContentVersion(hud_content_hash& hash);
 	void pageIn();
 	bool canRender();
 };
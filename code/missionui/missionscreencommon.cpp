@@ -10,6 +10,7 @@
 
 
 
+#include <algorithm>
 #include <limits.h>		// this is need even when not building debug!!
 #include <type_traits>
 
@@ -940,6 +941,8 @@ void common_check_keys(int k)
 //
 // weapon_select_close() and ship_select_close() are both called, since common_select_close()
 // is the function that is called the interface screens are finally exited.
+static void model_icons_release();
+
 void common_select_close()
 {
 	if ( !Common_select_inited ) {
@@ -982,6 +985,9 @@ void common_select_close()
 
 	common_reset_team_pointers();
 
+	// the models of the icons may be gone before the screens are opened again
+	model_icons_release();
+
 	Common_select_inited = 0;
 }
 
@@ -1522,7 +1528,34 @@ int restore_wss_data(ubyte *block)
 	return offset;
 }
 
-void draw_model_icon(int model_id, int flags, float closeup_zoom, int x, int y, int w, int h, ship_info *sip, int resize_mode, const vec3d *closeup_pos)
+// model icons which were drawn into render targets, they look the same every frame so they are only drawn once
+#define MAX_MODEL_ICONS		64
+
+struct model_icon {
+	int model_id;
+	int flags;
+	float closeup_zoom;
+	int w, h;
+	ship_info *sip;
+	vec3d closeup_pos;
+
+	int bitmap;
+	int last_used;
+};
+
+static SCP_vector<model_icon> Model_icons;
+static int Model_icon_draws = 0;
+
+static void model_icons_release()
+{
+	for (auto &icon : Model_icons) {
+		bm_release(icon.bitmap, 1);
+	}
+
+	Model_icons.clear();
+}
+
+static void draw_model_icon_internal(int model_id, int flags, float closeup_zoom, int x, int y, int w, int h, ship_info *sip, int resize_mode, const vec3d *closeup_pos)
 {
 	matrix	object_orient	= IDENTITY_MATRIX;
 	angles rot_angles = {0.0f,0.0f,0.0f};
@@ -1639,6 +1672,88 @@ void draw_model_icon(int model_id, int flags, float closeup_zoom, int x, int y,
 	gr_reset_clip();
 }
 
+void draw_model_icon(int model_id, int flags, float closeup_zoom, int x, int y, int w, int h, ship_info *sip, int resize_mode, const vec3d *closeup_pos)
+{
+	int px = x;
+	int py = y;
+	int pw = w;
+	int ph = h;
+	gr_resize_screen_pos(&px, &py, &pw, &ph, resize_mode);
+
+	// not while something else is drawn into a render target, that one would be lost
+	if ((pw <= 0) || (ph <= 0) || (gr_screen.rendering_to_texture != -1)) {
+		draw_model_icon_internal(model_id, flags, closeup_zoom, x, y, w, h, sip, resize_mode, closeup_pos);
+		return;
+	}
+
+	Model_icon_draws++;
+
+	model_icon *icon = NULL;
+
+	for (auto &cached : Model_icons) {
+		if ((cached.model_id == model_id) && (cached.flags == flags) && (cached.closeup_zoom == closeup_zoom) && (cached.w == pw) && (cached.h == ph)
+			&& (cached.sip == sip) && vm_vec_equal(cached.closeup_pos, *closeup_pos)) {
+			icon = &cached;
+			break;
+		}
+	}
+
+	if (icon == NULL) {
+		int bitmap = bm_make_render_target(pw, ph, BMP_FLAG_RENDER_TARGET_DYNAMIC);
+
+		if (bitmap < 0) {
+			draw_model_icon_internal(model_id, flags, closeup_zoom, x, y, w, h, sip, resize_mode, closeup_pos);
+			return;
+		}
+
+		int bw, bh;
+		bm_get_info(bitmap, &bw, &bh);
+
+		if ((bw != pw) || (bh != ph) || !bm_set_render_target(bitmap)) {
+			bm_release(bitmap, 1);
+			draw_model_icon_internal(model_id, flags, closeup_zoom, x, y, w, h, sip, resize_mode, closeup_pos);
+			return;
+		}
+
+		// the background of the screen has to show through around the model
+		color saved_clear_color = gr_screen.current_clear_color;
+		gr_init_alphacolor(&gr_screen.current_clear_color, 0, 0, 0, 0);
+		gr_clear();
+		gr_screen.current_clear_color = saved_clear_color;
+
+		draw_model_icon_internal(model_id, flags, closeup_zoom, 0, 0, pw, ph, sip, GR_RESIZE_NONE, closeup_pos);
+
+		bm_set_render_target(-1);
+
+		// make room by throwing out the one which wasn't drawn for the longest time
+		if (Model_icons.size() >= MAX_MODEL_ICONS) {
+			auto oldest = std::min_element(Model_icons.begin(), Model_icons.end(),
+				[](const model_icon &a, const model_icon &b) { return a.last_used < b.last_used; });
+
+			bm_release(oldest->bitmap, 1);
+			Model_icons.erase(oldest);
+		}
+
+		model_icon new_icon;
+		new_icon.model_id = model_id;
+		new_icon.flags = flags;
+		new_icon.closeup_zoom = closeup_zoom;
+		new_icon.w = pw;
+		new_icon.h = ph;
+		new_icon.sip = sip;
+		new_icon.closeup_pos = *closeup_pos;
+		new_icon.bitmap = bitmap;
+
+		Model_icons.push_back(new_icon);
+		icon = &Model_icons.back();
+	}
+
+	icon->last_used = Model_icon_draws;
+
+	gr_set_bitmap(icon->bitmap, GR_ALPHABLEND_FILTER, GR_BITBLT_MODE_NORMAL, 1.0f);
+	gr_bitmap(px, py, GR_RESIZE_NONE);
+}
+
 void light_set_all_relevent();
 void draw_model_rotating(model_render_params *render_info, int model_id, int x1, int y1, int x2, int y2, float *rotation_buffer, vec3d *closeup_pos, float closeup_zoom, float rev_rate, int flags, int resize_mode, int effect)
 {
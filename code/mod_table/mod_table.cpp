@@ -14,6 +14,7 @@
 #include "mod_table/mod_table.h"
 #include "parse/parselo.h"
 #include "sound/sound.h"
+#include "tracing/StartupProfiler.h"
 
 int Directive_wait_time = 3000;
 bool True_loop_argument_sexps = false;
@@ -341,6 +342,8 @@ void parse_mod_table(const char *filename)
 
 void mod_table_init()
 {
+	TRACE_STARTUP_SCOPE(tracing::ModTableInit);
+
 	// first parse the default table
 	parse_mod_table(NULL);
 
@@ -27,10 +27,14 @@ extern int model_render_flags_size;
 
 #define MAX_DEBRIS_OBJECTS	32
 #define MAX_MODEL_DETAIL_LEVELS	8
+#define MAX_MODEL_GENERATED_LODS	3
 #define MAX_PROP_LEN			256
 #define MAX_NAME_LEN			32
 #define MAX_ARC_EFFECTS		8
 
+// the radius on screen in pixels below which a generated LOD is used, see -generate_lods
+extern const float Model_generated_lod_radius[MAX_MODEL_GENERATED_LODS];
+
 #define MOVEMENT_TYPE_NONE				-1
 #define MOVEMENT_TYPE_POS				0
 #define MOVEMENT_TYPE_ROT				1
@@ -94,6 +98,11 @@ typedef struct submodel_instance {
 	bool collision_checked;
 	bool blown_off;
 	submodel_instance_info *sii;
+
+	// orientation relative to the parent for local_angs, see model_instance_get_local_orient()
+	angles local_angs;
+	matrix local_orient;
+	bool local_orient_valid;
 } submodel_instance;
 
 // Data specific to a particular instance of a model.
@@ -240,10 +249,26 @@ struct bsp_collision_leaf {
 	int next;
 };
 
+// A node of the four wide bounding volume hierarchy built over the polygon groups of a bsp_collision_tree. The child
+// bounds are stored as one array per axis so all four children can be tested at once.
+#define BSP_BVH_WIDTH	4
+
+struct bsp_collision_bvh_node {
+	float min[3][BSP_BVH_WIDTH];
+	float max[3][BSP_BVH_WIDTH];
+
+	int child[BSP_BVH_WIDTH];	// index of the child node, or of the first bsp_collision_leaf if the bit in leaf_mask is set
+	ubyte num_children;
+	ubyte leaf_mask;
+};
+
 struct bsp_collision_tree {
 	bsp_collision_node *node_list;
 	int n_nodes;
 
+	bsp_collision_bvh_node *bvh_list;
+	int n_bvh_nodes;
+
 	bsp_collision_leaf *leaf_list;
 	int n_leaves;
 
@@ -672,7 +697,7 @@ public:
 		n_thrusters(0), gun_banks(NULL), missile_banks(NULL), docking_bays(NULL), thrusters(NULL), ship_bay(NULL), shield(),
 		shield_collision_tree(NULL), sldc_size(0), n_paths(0), paths(NULL), mass(0), num_xc(0), xc(NULL), num_split_plane(0),
 		num_ins(0), used_this_mission(0), n_glow_point_banks(0), glow_point_banks(NULL), gun_submodel_rotation(0),
-		vert_source()
+		vert_source(), n_generated_lods(0)
 	{
 		filename[0] = 0;
 		mins = maxs = autocenter = center_of_mass = vmd_zero_vector;
@@ -781,6 +806,9 @@ public:
 	indexed_vertex_source vert_source;
 	
 	vertex_buffer detail_buffers[MAX_MODEL_DETAIL_LEVELS];
+
+	// LODs made from detail level 0 with -generate_lods, they follow it in detail_buffers
+	int n_generated_lods;
 };
 
 // Call once to initialize the model system
@@ -796,6 +824,15 @@ void model_instance_free_all();
 // Loads a model from disk and returns the model number it loaded into.
 int model_load(const char *filename, int n_subsystems, model_subsystem *subsystems, int ferror = 1, int duplicate = 0);
 
+// Reads only the bounding box from the header of a model file, without loading the model or its textures. Returns
+// false if the file can't be opened or has no header.
+bool model_read_bounding_box(const char *filename, vec3d *mins, vec3d *maxs);
+
+// Models loaded between these calls build their vertex buffers and collision trees on the job workers. The buffers
+// and trees of such a model are only usable once model_end_batch_load() returned. Batches may be nested.
+void model_begin_batch_load();
+void model_end_batch_load();
+
 int model_create_instance(bool is_ship, int model_num);
 void model_delete_instance(int model_instance_num);
 
@@ -970,6 +1007,11 @@ extern void model_clear_instance(int model_num);
 void model_clear_submodel_instance( submodel_instance *sm_instance, bsp_info *sm );
 void model_clear_submodel_instances( int model_instance_num );
 
+// Gets the orientation of a submodel relative to its parent for the given angles, or the current angles of the
+// instance if angs is NULL. The result is kept in the submodel instance and only computed again when the angles change
+// so the render passes and the collision code can share it. pmi may be NULL.
+void model_instance_get_local_orient(matrix *out, polymodel *pm, const polymodel_instance *pmi, int submodel_num, const angles *angs = NULL);
+
 // Sets rotating submodel turn info to that stored in model
 void model_set_instance_info(submodel_instance_info *sii, float turn_rate, float turn_accel);
 
@@ -19,6 +19,9 @@ extern float flFrametime;
 
 SCP_vector<triggered_rotation> Triggered_rotations;
 
+// indices into Triggered_rotations of the rotations which are playing or have something queued
+static SCP_vector<int> Triggered_rotations_active;
+
 const char *Animation_type_names[MAX_TRIGGER_ANIMATION_TYPES] =
 {
 	"initial",
@@ -128,6 +131,19 @@ void triggered_rotation::start(queued_animation *q)
 
 	has_started = true;
 	end_time = q->end_time;
+
+	activate();
+}
+
+void triggered_rotation::activate()
+{
+	if (active)
+		return;
+
+	Assertion(!Triggered_rotations.empty() && (this >= &Triggered_rotations.front()) && (this <= &Triggered_rotations.back()), "A triggered rotation which isn't in Triggered_rotations was started; get a coder!\n");
+
+	active = true;
+	Triggered_rotations_active.push_back((int)(this - Triggered_rotations.data()));
 }
 
 void triggered_rotation::apply_trigger_angles(angles *submodel_angles)
@@ -201,6 +217,9 @@ void triggered_rotation::clear()
 	current_snd_index = -1;
 	snd_rad = 0.0;
 	obj_num = -1;
+	obj_signature = -1;
+	subsys = NULL;
+	active = false;
 }
 
 triggered_rotation::~triggered_rotation()
@@ -310,6 +329,8 @@ void triggered_rotation::add_queue(queued_animation *the_queue, int dir)
 	}
 
 	n_queue++;
+
+	activate();
 }
 
 /**
@@ -528,6 +549,90 @@ void model_anim_submodel_trigger_rotate(model_subsystem *psub, ship_subsys *ss)
 		sii->angs.b += PI2;
 }
 
+// whether the ship subsystem the rotation was made for is still around, and if so whether it may move this frame
+static ship_subsys *model_anim_get_rotating_subsys(triggered_rotation *trigger, int index)
+{
+	if ( (trigger->obj_num < 0) || (trigger->subsys == NULL) )
+		return NULL;
+
+	object *objp = &Objects[trigger->obj_num];
+
+	if ( (objp->type != OBJ_SHIP) || (objp->signature != trigger->obj_signature) || (trigger->subsys->triggered_rotation_index != index) )
+		return NULL;
+
+	return trigger->subsys;
+}
+
+static bool model_anim_subsys_may_rotate(ship_subsys *pss)
+{
+	model_subsystem *psub = pss->system_info;
+
+	// Don't process destroyed objects (but allow subobjects with hitpoints disabled -nuke) (but also process subobjects that are allowed to rotate)
+	if (pss->max_hits > 0 && pss->current_hits <= 0.0f && !(psub->flags[Model::Subsystem_Flags::Destroyed_rotation]))
+		return false;
+
+	if ( !(pss->flags[Ship::Subsystem_Flags::Rotates]) )
+		return false;
+
+	// multiplayer clients only play the animations which are safe to play on their own
+	if ( MULTIPLAYER_CLIENT ) {
+		for (int i = 0; i < psub->n_triggers; i++) {
+			switch (psub->triggers[i].type)
+			{
+				case TRIGGER_TYPE_PRIMARY_BANK:
+				case TRIGGER_TYPE_SECONDARY_BANK:
+				case TRIGGER_TYPE_AFTERBURNER:
+					return true;
+
+				default:
+					break;
+			}
+		}
+
+		return false;
+	}
+
+	return true;
+}
+
+void model_anim_process_triggered_rotations()
+{
+	size_t num_active = 0;
+
+	// only the running rotations are on the list, so idle subsystems are never looked at
+	for (size_t i = 0; i < Triggered_rotations_active.size(); i++) {
+		int index = Triggered_rotations_active[i];
+		triggered_rotation *trigger = &Triggered_rotations[index];
+
+		ship_subsys *pss = model_anim_get_rotating_subsys(trigger, index);
+
+		if (pss == NULL) {
+			trigger->active = false;
+			continue;
+		}
+
+		if (model_anim_subsys_may_rotate(pss)) {
+			trigger->process_queue();
+			model_anim_submodel_trigger_rotate(pss->system_info, pss);
+		}
+
+		// the rotations which came to a stop leave the list
+		if (trigger->is_idle()) {
+			trigger->active = false;
+		} else {
+			Triggered_rotations_active[num_active++] = index;
+		}
+	}
+
+	Triggered_rotations_active.resize(num_active);
+}
+
+void model_anim_clear_triggered_rotations()
+{
+	Triggered_rotations.clear();
+	Triggered_rotations_active.clear();
+}
+
 //************************************//
 //*** ship related animation stuff ***//
 //************************************//
@@ -857,56 +962,6 @@ void model_anim_set_initial_states(ship *shipp)
 	}
 }
 
-/**
- * Handles multiplayer-safe, client-side, animations
- */
-void model_anim_handle_multiplayer(ship *shipp)
-{
-	Assert( shipp != NULL );
-
-	ship_subsys *pss;
-	model_subsystem *psub;
-
-	if ( !(Game_mode & GM_MULTIPLAYER) ) {
-		Int3();
-		return;
-	}
-
-	if (Net_player->flags & NETINFO_FLAG_AM_MASTER)
-		return;
-
-	for ( pss = GET_FIRST(&shipp->subsys_list); pss !=END_OF_LIST(&shipp->subsys_list); pss = GET_NEXT(pss) ) {
-		psub = pss->system_info;
-
-		// Don't process destroyed objects  (but allow subobjects with hitpoints disabled -nuke)
-		if ( pss->max_hits > 0 && pss->current_hits <= 0.0f ) 
-			continue;
-
-		// not a triggered animation, skip it
-		if ( !(psub->flags[Model::Subsystem_Flags::Triggered]) )
-			continue;
-		Assert(pss->triggered_rotation_index >= 0);
-
-		for (int i = 0; i < psub->n_triggers; i++) {
-			switch (psub->triggers[i].type)
-			{
-				case TRIGGER_TYPE_PRIMARY_BANK:
-				case TRIGGER_TYPE_SECONDARY_BANK:
-				case TRIGGER_TYPE_AFTERBURNER:
-				{
-					Triggered_rotations[pss->triggered_rotation_index].process_queue();
-					model_anim_submodel_trigger_rotate(psub, pss );
-
-					break;
-				}
-
-				default:
-					break;
-			}
-		}
-	}
-}
-
 // Goober5000 - stack based animation for reversing a sequence of animations
 
 SCP_map<int, animation_stack> Animation_map;
@@ -89,6 +89,8 @@ struct trigger_instance{
 };
 */
 
+class ship_subsys;
+
 /**
  * This is the triggered animation object, it is responsable for controlling how the current triggered animation works
  * rot_accel is the acceleration for starting to move and stopping, so figure it in twice.
@@ -102,7 +104,6 @@ class triggered_rotation
 		int current_snd;
 		int current_snd_index;
 		float snd_rad;
-		int obj_num;
 
 		int n_queue;
 		queued_animation queue[MAX_TRIGGERED_ANIMATIONS];
@@ -121,6 +122,12 @@ class triggered_rotation
 		void add_queue(queued_animation *new_queue, int dir);
 		void process_queue();
 
+		// puts this rotation on the list model_anim_process_triggered_rotations() goes through
+		void activate();
+
+		// nothing is playing or queued, so the rotation can leave that list
+		bool is_idle() const { return !has_started && (n_queue == 0); }
+
 		vec3d current_ang;
 		vec3d current_vel;
 		vec3d rot_accel;	// rotational acceleration, 0 means instant
@@ -133,6 +140,11 @@ class triggered_rotation
 		bool has_started;	// animation has started playing
 		int end_time;		// time that we should stop
 		int start_time;		// the time the current animation started
+
+		int obj_num;		// the ship and subsystem this rotation belongs to, set by subsys_set()
+		int obj_signature;
+		ship_subsys *subsys;
+		bool active;		// on the list of running rotations
 };
 
 extern SCP_vector<triggered_rotation> Triggered_rotations;
@@ -140,11 +152,16 @@ extern SCP_vector<triggered_rotation> Triggered_rotations;
 // functions...
 
 class model_subsystem;
-class ship_subsys;
 class ship;
 class ship_info;
 
 void model_anim_submodel_trigger_rotate(model_subsystem *psub, ship_subsys *ss);
+
+// advances all triggered rotations which are playing or have something queued, once per frame
+void model_anim_process_triggered_rotations();
+
+// forgets all triggered rotations when the subsystems are freed
+void model_anim_clear_triggered_rotations();
 void model_anim_set_initial_states(ship *shipp);
 void model_anim_fix_reverse_times(ship_info *sip);
 
@@ -159,9 +176,6 @@ bool model_anim_start_type(ship *shipp, int animation_type, int subtype, int dir
 int model_anim_get_time_type(ship_subsys *pss, int animation_type, int subtype);	// for a specific subsystem
 int model_anim_get_time_type(ship *shipp, int animation_type, int subtype);			// for all valid subsystems
 
-// this is for handling multiplayer-safe, client-side, animations
-void model_anim_handle_multiplayer(ship *shipp);
-
 
 // for pushing and popping animations
 typedef struct stack_item
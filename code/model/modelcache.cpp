@@ -0,0 +1,509 @@
+#include "model/modelcache.h"
+
+#include "bmpman/bmpman.h"
+#include "cfile/cfile.h"
+#include "cmdline/cmdline.h"
+#include "globalincs/systemvars.h"
+#include "graphics/2d.h"
+#include "model/model.h"
+#include "tracing/tracing.h"
+
+#include <cstdint>
+
+void model_interp_set_buffer_layout(vertex_layout *layout, uint stride, int flags);
+
+namespace {
+
+const int MODEL_CACHE_ID = 0x434d5350;	// "PSMC"
+const int MODEL_CACHE_VERSION = 2;
+const int MODEL_CACHE_END = 0x444e4543;	// "CEND"
+
+// settings which change the result of processing a model
+const int MODEL_CACHE_NORMAL_MAPS = 1 << 0;
+const int MODEL_CACHE_NO_BATCHING = 1 << 1;
+const int MODEL_CACHE_COLLISION_TREES = 1 << 2;
+const int MODEL_CACHE_PACKED_VERTICES = 1 << 3;
+const int MODEL_CACHE_GENERATED_LODS = 1 << 4;
+
+const int MODEL_CACHE_FLAGS = PM_FLAG_BATCHED | PM_FLAG_TRANS_BUFFER;
+
+class cache_writer {
+	SCP_vector<ubyte> _data;
+
+ public:
+	void write_bytes(const void* src, size_t size)
+	{
+		auto bytes = reinterpret_cast<const ubyte*>(src);
+		_data.insert(_data.end(), bytes, bytes + size);
+	}
+
+	template <typename T>
+	void write(const T& value)
+	{
+		write_bytes(&value, sizeof(T));
+	}
+
+	const SCP_vector<ubyte>& data() const { return _data; }
+};
+
+class cache_reader {
+	const ubyte* _pos;
+	const ubyte* _end;
+	bool _ok;
+
+ public:
+	cache_reader(const void* data, size_t size)
+		: _pos(reinterpret_cast<const ubyte*>(data)), _end(reinterpret_cast<const ubyte*>(data) + size), _ok(true)
+	{
+	}
+
+	bool read_bytes(void* dest, size_t size)
+	{
+		if (!_ok || size > (size_t)(_end - _pos)) {
+			_ok = false;
+			return false;
+		}
+
+		memcpy(dest, _pos, size);
+		_pos += size;
+		return true;
+	}
+
+	template <typename T>
+	T read()
+	{
+		T value = T();
+		read_bytes(&value, sizeof(T));
+		return value;
+	}
+
+	// Reads an array into memory allocated with vm_malloc, NULL if the count is not positive
+	template <typename T>
+	T* read_array(int count)
+	{
+		if (!_ok || count <= 0) {
+			return nullptr;
+		}
+
+		if ((size_t)count > (size_t)(_end - _pos) / sizeof(T)) {
+			_ok = false;
+			return nullptr;
+		}
+
+		auto array = reinterpret_cast<T*>(vm_malloc(sizeof(T) * count));
+		read_bytes(array, sizeof(T) * count);
+		return array;
+	}
+
+	bool ok() const { return _ok; }
+};
+
+SCP_string model_cache_filename(const polymodel* pm)
+{
+	SCP_string name = pm->filename;
+
+	auto dot = name.rfind('.');
+	if (dot != SCP_string::npos) {
+		name.resize(dot);
+	}
+
+	return name + ".pmc";
+}
+
+int model_cache_settings()
+{
+	int settings = 0;
+
+	if (Cmdline_normal) {
+		settings |= MODEL_CACHE_NORMAL_MAPS;
+	}
+	if (Cmdline_no_batching) {
+		settings |= MODEL_CACHE_NO_BATCHING;
+	}
+	if (!Cmdline_old_collision_sys) {
+		settings |= MODEL_CACHE_COLLISION_TREES;
+	}
+	if (gr_is_capable(CAPABILITY_PACKED_VERTICES)) {
+		settings |= MODEL_CACHE_PACKED_VERTICES;
+	}
+	if (Cmdline_generate_lods) {
+		settings |= MODEL_CACHE_GENERATED_LODS;
+	}
+
+	return settings;
+}
+
+// The transparency index buffers depend on the alpha channel of the base textures so those are part of the key
+uint model_cache_texture_signature(polymodel* pm)
+{
+	uint signature = 0;
+
+	for (int i = 0; i < pm->n_textures; ++i) {
+		int handle = pm->maps[i].textures[TM_BASE_TYPE].GetTexture();
+
+		ubyte has_alpha = 0;
+		if (handle >= 0) {
+			auto filename = bm_get_filename(handle);
+			signature = cf_add_chksum_long(signature, (ubyte*)filename, strlen(filename));
+
+			has_alpha = bm_has_alpha_channel(handle) ? 1 : 0;
+		}
+
+		signature = cf_add_chksum_long(signature, &has_alpha, sizeof(has_alpha));
+	}
+
+	return signature;
+}
+
+void write_header(cache_writer& writer, polymodel* pm, uint pof_checksum)
+{
+	writer.write(MODEL_CACHE_ID);
+	writer.write(MODEL_CACHE_VERSION);
+
+	// the structures are stored as they are in memory so a build with a different layout can't use the file
+	writer.write((int)sizeof(vertex));
+	writer.write((int)sizeof(bsp_collision_node));
+	writer.write((int)sizeof(bsp_collision_leaf));
+	writer.write((int)sizeof(bsp_collision_bvh_node));
+	writer.write((int)sizeof(model_tmap_vert));
+
+	writer.write(pof_checksum);
+	writer.write(model_cache_texture_signature(pm));
+	writer.write(model_cache_settings());
+	writer.write(pm->n_models);
+	writer.write(pm->n_detail_levels);
+}
+
+void write_vertex_buffer(cache_writer& writer, vertex_buffer* vb)
+{
+	writer.write(vb->flags);
+	writer.write((uint64_t)vb->stride);
+	writer.write((uint64_t)vb->vertex_offset);
+	writer.write((uint64_t)vb->vertex_num_offset);
+
+	// only buffers which have been configured have a layout
+	ubyte has_layout = vb->layout.get_num_vertex_components() > 0 ? 1 : 0;
+	writer.write(has_layout);
+
+	writer.write((int)vb->tex_buf.size());
+	for (auto& tex_buf : vb->tex_buf) {
+		writer.write(tex_buf.flags);
+		writer.write(tex_buf.texture);
+		writer.write((uint64_t)tex_buf.n_verts);
+		writer.write((uint64_t)tex_buf.index_offset);
+		writer.write(tex_buf.i_first);
+		writer.write(tex_buf.i_last);
+	}
+}
+
+bool read_vertex_buffer(cache_reader& reader, vertex_buffer* vb)
+{
+	vb->flags = reader.read<int>();
+	vb->stride = (size_t)reader.read<uint64_t>();
+	vb->vertex_offset = (size_t)reader.read<uint64_t>();
+	vb->vertex_num_offset = (size_t)reader.read<uint64_t>();
+
+	auto has_layout = reader.read<ubyte>();
+
+	auto num_tex_bufs = reader.read<int>();
+	if (!reader.ok() || num_tex_bufs < 0 || num_tex_bufs > MAX_MODEL_TEXTURES) {
+		return false;
+	}
+
+	vb->tex_buf.resize((size_t)num_tex_bufs);
+	for (auto& tex_buf : vb->tex_buf) {
+		tex_buf.flags = reader.read<int>();
+		tex_buf.texture = reader.read<int>();
+		tex_buf.n_verts = (size_t)reader.read<uint64_t>();
+		tex_buf.index_offset = (size_t)reader.read<uint64_t>();
+		tex_buf.i_first = reader.read<uint>();
+		tex_buf.i_last = reader.read<uint>();
+	}
+
+	if (!reader.ok()) {
+		return false;
+	}
+
+	if (has_layout) {
+		model_interp_set_buffer_layout(&vb->layout, (uint)vb->stride, vb->flags);
+	}
+
+	return true;
+}
+
+void reset_vertex_buffer(vertex_buffer* vb)
+{
+	vb->clear();
+	vb->flags = 0;
+	vb->stride = 0;
+	vb->vertex_offset = 0;
+	vb->vertex_num_offset = 0;
+	vb->layout = vertex_layout();
+}
+
+void write_collision_tree(cache_writer& writer, bsp_collision_tree* tree)
+{
+	writer.write(tree->n_verts);
+	if (tree->n_verts > 0) {
+		writer.write_bytes(tree->point_list, sizeof(vec3d) * tree->n_verts);
+	}
+
+	writer.write(tree->n_nodes);
+	if (tree->n_nodes > 0) {
+		writer.write_bytes(tree->node_list, sizeof(bsp_collision_node) * tree->n_nodes);
+	}
+
+	writer.write(tree->n_bvh_nodes);
+	if (tree->n_bvh_nodes > 0) {
+		writer.write_bytes(tree->bvh_list, sizeof(bsp_collision_bvh_node) * tree->n_bvh_nodes);
+	}
+
+	writer.write(tree->n_leaves);
+	if (tree->n_leaves > 0) {
+		writer.write_bytes(tree->leaf_list, sizeof(bsp_collision_leaf) * tree->n_leaves);
+	}
+
+	// the tree doesn't store the size of the vertex list but every leaf references a range of it
+	int n_tmap_verts = 0;
+	for (int i = 0; i < tree->n_leaves; ++i) {
+		n_tmap_verts = MAX(n_tmap_verts, tree->leaf_list[i].vert_start + tree->leaf_list[i].num_verts);
+	}
+
+	writer.write(n_tmap_verts);
+	if (n_tmap_verts > 0) {
+		writer.write_bytes(tree->vert_list, sizeof(model_tmap_vert) * n_tmap_verts);
+	}
+}
+
+bool read_collision_tree(cache_reader& reader, bsp_collision_tree* tree)
+{
+	tree->n_verts = reader.read<int>();
+	tree->point_list = reader.read_array<vec3d>(tree->n_verts);
+
+	tree->n_nodes = reader.read<int>();
+	tree->node_list = reader.read_array<bsp_collision_node>(tree->n_nodes);
+
+	tree->n_bvh_nodes = reader.read<int>();
+	tree->bvh_list = reader.read_array<bsp_collision_bvh_node>(tree->n_bvh_nodes);
+
+	tree->n_leaves = reader.read<int>();
+	tree->leaf_list = reader.read_array<bsp_collision_leaf>(tree->n_leaves);
+
+	auto n_tmap_verts = reader.read<int>();
+	tree->vert_list = reader.read_array<model_tmap_vert>(n_tmap_verts);
+
+	return reader.ok();
+}
+
+// Undoes a partial load so the model can be processed normally
+void reset_model(polymodel* pm)
+{
+	for (int i = 0; i < pm->n_models; ++i) {
+		auto sm = &pm->submodel[i];
+
+		reset_vertex_buffer(&sm->buffer);
+		reset_vertex_buffer(&sm->trans_buffer);
+
+		if (sm->outline_buffer != nullptr) {
+			vm_free(sm->outline_buffer);
+			sm->outline_buffer = nullptr;
+		}
+		sm->n_verts_outline = 0;
+
+		if (sm->collision_tree_index >= 0) {
+			model_remove_bsp_collision_tree(sm->collision_tree_index);
+			sm->collision_tree_index = -1;
+		}
+	}
+
+	for (auto& detail_buffer : pm->detail_buffers) {
+		reset_vertex_buffer(&detail_buffer);
+	}
+	pm->n_generated_lods = 0;
+
+	if (pm->vert_source.Vertex_list != nullptr) {
+		vm_free(pm->vert_source.Vertex_list);
+		pm->vert_source.Vertex_list = nullptr;
+	}
+	if (pm->vert_source.Index_list != nullptr) {
+		vm_free(pm->vert_source.Index_list);
+		pm->vert_source.Index_list = nullptr;
+	}
+	pm->vert_source.Vertex_list_size = 0;
+	pm->vert_source.Index_list_size = 0;
+
+	pm->flags &= ~MODEL_CACHE_FLAGS;
+}
+
+bool read_model(cache_reader& reader, polymodel* pm, uint pof_checksum)
+{
+	// compare the header against the one this model would be written with
+	cache_writer expected;
+	write_header(expected, pm, pof_checksum);
+
+	SCP_vector<ubyte> header(expected.data().size());
+	if (!reader.read_bytes(header.data(), header.size()) || header != expected.data()) {
+		return false;
+	}
+
+	pm->flags |= reader.read<int>() & MODEL_CACHE_FLAGS;
+
+	auto& vert_source = pm->vert_source;
+	vert_source.Vertex_list_size = reader.read<uint>();
+	vert_source.Index_list_size = reader.read<uint>();
+
+	vert_source.Vertex_list = reader.read_array<float>((int)(vert_source.Vertex_list_size / sizeof(float)));
+	vert_source.Index_list = reader.read_array<ubyte>((int)vert_source.Index_list_size);
+
+	if (!reader.ok()) {
+		return false;
+	}
+
+	for (int i = 0; i < pm->n_models; ++i) {
+		auto sm = &pm->submodel[i];
+
+		if (!read_vertex_buffer(reader, &sm->buffer) || !read_vertex_buffer(reader, &sm->trans_buffer)) {
+			return false;
+		}
+
+		sm->n_verts_outline = reader.read<uint>();
+		sm->outline_buffer = reader.read_array<vertex>((int)sm->n_verts_outline);
+
+		if (!reader.ok()) {
+			return false;
+		}
+	}
+
+	pm->n_generated_lods = reader.read<int>();
+	if (!reader.ok() || pm->n_generated_lods < 0 || pm->n_detail_levels + pm->n_generated_lods > MAX_MODEL_DETAIL_LEVELS) {
+		return false;
+	}
+
+	for (int i = 0; i < pm->n_detail_levels + pm->n_generated_lods; ++i) {
+		if (!read_vertex_buffer(reader, &pm->detail_buffers[i])) {
+			return false;
+		}
+	}
+
+	if (model_cache_settings() & MODEL_CACHE_COLLISION_TREES) {
+		for (int i = 0; i < pm->n_models; ++i) {
+			pm->submodel[i].collision_tree_index = model_create_bsp_collision_tree();
+
+			if (!read_collision_tree(reader, model_get_bsp_collision_tree(pm->submodel[i].collision_tree_index))) {
+				return false;
+			}
+		}
+	}
+
+	return reader.read<int>() == MODEL_CACHE_END && reader.ok();
+}
+
+}
+
+bool model_cache_enabled()
+{
+	return Cmdline_model_cache && !Is_standalone;
+}
+
+bool model_cache_load(polymodel* pm, uint pof_checksum)
+{
+	if (!model_cache_enabled()) {
+		return false;
+	}
+
+	TRACE_SCOPE(tracing::ModelCacheLoad);
+
+	auto filename = model_cache_filename(pm);
+
+	auto cfp = cfopen(filename.c_str(), "rb", CFILE_MEMORY_MAPPED, CF_TYPE_CACHE);
+	if (cfp == nullptr) {
+		return false;
+	}
+
+	cache_reader reader(cf_returndata(cfp), (size_t)cfilelength(cfp));
+	bool loaded = read_model(reader, pm, pof_checksum);
+
+	cfclose(cfp);
+
+	if (!loaded) {
+		nprintf(("ModelCache", "Cached data of model '%s' is out of date.\n", pm->filename));
+		reset_model(pm);
+		return false;
+	}
+
+	nprintf(("ModelCache", "Loaded model '%s' from the cache.\n", pm->filename));
+
+	return true;
+}
+
+void model_cache_save(polymodel* pm, uint pof_checksum)
+{
+	if (!model_cache_enabled()) {
+		return;
+	}
+
+	TRACE_SCOPE(tracing::ModelCacheSave);
+
+	auto& vert_source = pm->vert_source;
+
+	// the data is only there until it has been submitted
+	if ((vert_source.Vertex_list_size > 0 && vert_source.Vertex_list == nullptr)
+		|| (vert_source.Index_list_size > 0 && vert_source.Index_list == nullptr)) {
+		return;
+	}
+
+	cache_writer writer;
+	write_header(writer, pm, pof_checksum);
+
+	writer.write(pm->flags & MODEL_CACHE_FLAGS);
+
+	writer.write(vert_source.Vertex_list_size);
+	writer.write(vert_source.Index_list_size);
+	if (vert_source.Vertex_list_size > 0) {
+		writer.write_bytes(vert_source.Vertex_list, vert_source.Vertex_list_size);
+	}
+	if (vert_source.Index_list_size > 0) {
+		writer.write_bytes(vert_source.Index_list, vert_source.Index_list_size);
+	}
+
+	for (int i = 0; i < pm->n_models; ++i) {
+		auto sm = &pm->submodel[i];
+
+		write_vertex_buffer(writer, &sm->buffer);
+		write_vertex_buffer(writer, &sm->trans_buffer);
+
+		writer.write(sm->n_verts_outline);
+		if (sm->n_verts_outline > 0) {
+			writer.write_bytes(sm->outline_buffer, sizeof(vertex) * sm->n_verts_outline);
+		}
+	}
+
+	writer.write(pm->n_generated_lods);
+
+	for (int i = 0; i < pm->n_detail_levels + pm->n_generated_lods; ++i) {
+		write_vertex_buffer(writer, &pm->detail_buffers[i]);
+	}
+
+	if (model_cache_settings() & MODEL_CACHE_COLLISION_TREES) {
+		for (int i = 0; i < pm->n_models; ++i) {
+			write_collision_tree(writer, model_get_bsp_collision_tree(pm->submodel[i].collision_tree_index));
+		}
+	}
+
+	writer.write(MODEL_CACHE_END);
+
+	auto filename = model_cache_filename(pm);
+
+	auto cfp = cfopen(filename.c_str(), "wb", CFILE_NORMAL, CF_TYPE_CACHE);
+	if (cfp == nullptr) {
+		mprintf(("Could not open model cache file %s!\n", filename.c_str()));
+		return;
+	}
+
+	auto& data = writer.data();
+	if ((size_t)cfwrite(data.data(), 1, (int)data.size(), cfp) != data.size()) {
+		mprintf(("Failed to write model cache file %s!\n", filename.c_str()));
+	}
+
+	cfclose(cfp);
+}
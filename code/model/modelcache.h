@@ -0,0 +1,48 @@
+#ifndef _MODELCACHE_H
+#define _MODELCACHE_H
+#pragma once
+
+#include "globalincs/pstypes.h"
+
+class polymodel;
+
+/** @file
+ *  Binary cache of the data derived from a POF file.
+ *
+ *  Building the vertex and index buffers and the collision trees of a model takes most of the time spent in
+ *  model_load() but the results only depend on the POF file and on a few settings. With -model_cache those results are
+ *  written to the cache directory after a model has been processed and the next load of the same file reads them
+ *  back instead of parsing the BSP data again.
+ *
+ *  A cache file is only used if the checksum of the POF file, the settings and the textures of the model all match
+ *  the values it was written with, otherwise it is rebuilt.
+ */
+
+/**
+ * @brief Loads the vertex buffer layout, the vertex and index data and the collision trees of a model from the cache
+ *
+ * Nothing is submitted to the GPU, that is still done by the caller.
+ *
+ * @param pm The model, the POF file and the textures have to be loaded already
+ * @param pof_checksum The checksum of the POF file
+ * @return @c true if the cache was valid and all data was loaded. On @c false the model is unchanged.
+ */
+bool model_cache_load(polymodel* pm, uint pof_checksum);
+
+/**
+ * @brief Writes the processed data of a model to the cache
+ *
+ * @note Must be called before the vertex data has been submitted since that releases the CPU copy of it
+ *
+ * @param pm The model
+ * @param pof_checksum The checksum of the POF file
+ */
+void model_cache_save(polymodel* pm, uint pof_checksum);
+
+/**
+ * @brief Checks if the model cache is used
+ * @return @c true if models should be read from and written to the cache
+ */
+bool model_cache_enabled();
+
+#endif // _MODELCACHE_H
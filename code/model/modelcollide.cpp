@@ -13,6 +13,8 @@
 #define MODEL_LIB
 
 #include "cmdline/cmdline.h"
+#include "debugconsole/console.h"
+#include "globalincs/jobs.h"
 #include "graphics/tmapper.h"
 #include "math/fvi.h"
 #include "math/vecmat.h"
@@ -21,6 +23,13 @@
 #include "tracing/tracing.h"
 #include "tracing/Monitor.h"
 
+#include <algorithm>
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+	#include <xmmintrin.h>
+	#define MC_BVH_USE_SSE
+#endif
+
 
 
 #define TOL		1E-4
@@ -28,27 +37,33 @@
 
 // Some global variables that get set by model_collide and are used internally for
 // checking a collision rather than passing a bunch of parameters around. These are
-// not persistant between calls to model_collide
+// not persistant between calls to model_collide. They are thread local since
+// collisions may be checked from several threads at once.
 
-static mc_info		*Mc;				// The mc_info passed into model_collide
+static SCP_THREAD_LOCAL mc_info		*Mc;				// The mc_info passed into model_collide
 	
-static polymodel	*Mc_pm;			// The polygon model we're checking
-static int			Mc_submodel;	// The current submodel we're checking
+static SCP_THREAD_LOCAL polymodel	*Mc_pm;			// The polygon model we're checking
+static SCP_THREAD_LOCAL int			Mc_submodel;	// The current submodel we're checking
 
-static polymodel_instance *Mc_pmi;
+static SCP_THREAD_LOCAL polymodel_instance *Mc_pmi;
 
-static matrix		Mc_orient;		// A matrix to rotate a world point into the current
+static SCP_THREAD_LOCAL matrix		Mc_orient;		// A matrix to rotate a world point into the current
 											// submodel's frame of reference.
-static vec3d		Mc_base;			// A point used along with Mc_orient.
+static SCP_THREAD_LOCAL vec3d		Mc_base;			// A point used along with Mc_orient.
 
-static vec3d		Mc_p0;			// The ray origin rotated into the current submodel's frame of reference
-static vec3d		Mc_p1;			// The ray end rotated into the current submodel's frame of reference
-static float		Mc_mag;			// The length of the ray
-static vec3d		Mc_direction;	// A vector from the ray's origin to its end, in the current submodel's frame of reference
+static SCP_THREAD_LOCAL vec3d		Mc_p0;			// The ray origin rotated into the current submodel's frame of reference
+static SCP_THREAD_LOCAL vec3d		Mc_p1;			// The ray end rotated into the current submodel's frame of reference
+static SCP_THREAD_LOCAL float		Mc_mag;			// The length of the ray
+static SCP_THREAD_LOCAL vec3d		Mc_direction;	// A vector from the ray's origin to its end, in the current submodel's frame of reference
 
 static vec3d 		**Mc_point_list = NULL;		// A pointer to the current submodel's vertex list
 
-static float		Mc_edge_time;
+static SCP_THREAD_LOCAL float		Mc_edge_time;
+
+// Use the bounding volume hierarchy instead of the bsp nodes for checking the polygons of a submodel
+static bool Mc_use_bvh = true;
+
+DCF_BOOL(bvh_collisions, Mc_use_bvh);
 
 
 void model_collide_free_point_list()
@@ -370,27 +385,6 @@ void model_collide_defpoints(ubyte * p)
 	} 
 }
 
-int model_collide_parse_bsp_defpoints(ubyte * p)
-{
-	int n;
-	int nverts = w(p+8);	
-	int offset = w(p+16);	
-
-	ubyte * normcount = p+20;
-	vec3d *src = vp(p+offset);
-
-	model_collide_allocate_point_list(nverts);
-
-	Assert( Mc_point_list != NULL );
-
-	for (n=0; n<nverts; n++ ) {
-		Mc_point_list[n] = src;
-
-		src += normcount[n]+1;
-	} 
-
-	return nverts;
-}
 
 // Flat Poly
 // +0      int         id
@@ -647,6 +641,163 @@ void model_collide_bsp(bsp_collision_tree *tree, int node_index)
 	}
 }
 
+/**
+ * @brief Tests the ray against the bounding boxes of all children of a BVH node
+ *
+ * The boxes are grown by @c expand so this also works for spheres moving along the ray.
+ *
+ * @return A mask with one bit set for every child which is hit before @c t_limit, the entry points are in @c t_entry
+ */
+static int mc_bvh_test_children(const bsp_collision_bvh_node *node, const vec3d *origin, const float *inv_dir, float expand, float t_limit, float *t_entry)
+{
+#ifdef MC_BVH_USE_SSE
+	__m128 grow = _mm_set1_ps(expand);
+	__m128 t_min = _mm_setzero_ps();
+	__m128 t_max = _mm_set1_ps(t_limit);
+
+	for (int axis = 0; axis < 3; ++axis) {
+		__m128 o = _mm_set1_ps(origin->a1d[axis]);
+		__m128 inv = _mm_set1_ps(inv_dir[axis]);
+
+		__m128 t0 = _mm_mul_ps(_mm_sub_ps(_mm_sub_ps(_mm_loadu_ps(node->min[axis]), grow), o), inv);
+		__m128 t1 = _mm_mul_ps(_mm_sub_ps(_mm_add_ps(_mm_loadu_ps(node->max[axis]), grow), o), inv);
+
+		t_min = _mm_max_ps(t_min, _mm_min_ps(t0, t1));
+		t_max = _mm_min_ps(t_max, _mm_max_ps(t0, t1));
+	}
+
+	_mm_storeu_ps(t_entry, t_min);
+
+	int mask = _mm_movemask_ps(_mm_cmple_ps(t_min, t_max));
+#else
+	int mask = 0;
+
+	for (int i = 0; i < BSP_BVH_WIDTH; ++i) {
+		float t_min = 0.0f;
+		float t_max = t_limit;
+
+		for (int axis = 0; axis < 3; ++axis) {
+			float t0 = (node->min[axis][i] - expand - origin->a1d[axis]) * inv_dir[axis];
+			float t1 = (node->max[axis][i] + expand - origin->a1d[axis]) * inv_dir[axis];
+
+			t_min = MAX(t_min, MIN(t0, t1));
+			t_max = MIN(t_max, MAX(t0, t1));
+		}
+
+		t_entry[i] = t_min;
+
+		if (t_min <= t_max) {
+			mask |= 1 << i;
+		}
+	}
+#endif
+
+	return mask & ((1 << node->num_children) - 1);
+}
+
+/**
+ * @brief Checks the polygons of a submodel using its bounding volume hierarchy
+ *
+ * This finds the same closest hit as model_collide_bsp() but only looks at the polygon groups whose bounds the ray
+ * actually passes through closer than the best hit found so far. Children are visited from near to far so the closer
+ * polygons usually prune most of the remaining tree.
+ */
+static void model_collide_bvh(bsp_collision_tree *tree)
+{
+	if ( tree->bvh_list == NULL || tree->n_verts <= 0 ) {
+		return;
+	}
+
+	float expand = (Mc->flags & MC_CHECK_SPHERELINE) ? Mc->radius : 0.0f;
+
+	// hit distances are measured in multiples of Mc_direction so a ray which isn't infinite ends at 1
+	float t_limit = (Mc->flags & MC_CHECK_RAY) ? FLT_MAX : 1.0f;
+
+	float inv_dir[3];
+	for (int axis = 0; axis < 3; ++axis) {
+		float d = Mc_direction.a1d[axis];
+
+		// a tiny value instead of zero keeps the slab test free of NaNs
+		if ( fl_abs(d) < 1e-20f ) {
+			d = (d < 0.0f) ? -1e-20f : 1e-20f;
+		}
+
+		inv_dir[axis] = 1.0f / d;
+	}
+
+	struct bvh_stack_entry {
+		int index;
+		bool leaf;
+		float t_entry;
+	};
+
+	// the hierarchy is balanced so this is enough for far more polygons than a POF can hold
+	const int MAX_STACK = 128;
+	bvh_stack_entry stack[MAX_STACK];
+	int stack_size = 0;
+
+	stack[stack_size].index = 0;
+	stack[stack_size].leaf = false;
+	stack[stack_size].t_entry = 0.0f;
+	++stack_size;
+
+	while ( stack_size > 0 ) {
+		bvh_stack_entry entry = stack[--stack_size];
+
+		// Everything in here is further away than what we already hit
+		if ( Mc->num_hits && (entry.t_entry > Mc->hit_dist) ) {
+			continue;
+		}
+
+		if ( entry.leaf ) {
+			model_collide_bsp_poly(tree, entry.index);
+			continue;
+		}
+
+		const bsp_collision_bvh_node *node = &tree->bvh_list[entry.index];
+
+		float limit = t_limit;
+		if ( Mc->num_hits ) {
+			limit = MIN(limit, Mc->hit_dist);
+		}
+
+		float t_entry[BSP_BVH_WIDTH];
+		int mask = mc_bvh_test_children(node, &Mc_p0, inv_dir, expand, limit, t_entry);
+
+		if ( mask == 0 ) {
+			continue;
+		}
+
+		// push the hit children far to near so the nearest one is processed next
+		bvh_stack_entry hits[BSP_BVH_WIDTH];
+		int num_hits = 0;
+
+		for (int i = 0; i < node->num_children; ++i) {
+			if ( !(mask & (1 << i)) ) {
+				continue;
+			}
+
+			bvh_stack_entry hit;
+			hit.index = node->child[i];
+			hit.leaf = (node->leaf_mask & (1 << i)) != 0;
+			hit.t_entry = t_entry[i];
+
+			int j = num_hits++;
+			while ( j > 0 && hits[j - 1].t_entry < hit.t_entry ) {
+				hits[j] = hits[j - 1];
+				--j;
+			}
+			hits[j] = hit;
+		}
+
+		Assertion(stack_size + num_hits <= MAX_STACK, "Collision BVH of model %s is too deep!", Mc_pm->filename);
+
+		for (int i = 0; i < num_hits; ++i) {
+			stack[stack_size++] = hits[i];
+		}
+	}
+}
+
 void model_collide_parse_bsp_tmappoly(bsp_collision_leaf *leaf, SCP_vector<model_tmap_vert> *vert_buffer, void *model_ptr)
 {
 	ubyte *p = (ubyte *)model_ptr;
@@ -730,6 +881,180 @@ void model_collide_parse_bsp_flatpoly(bsp_collision_leaf *leaf, SCP_vector<model
 	}
 }
 
+struct bvh_build_item {
+	vec3d min;
+	vec3d max;
+	vec3d center;
+	int leaf;
+};
+
+static void bvh_build_bounds(const SCP_vector<bvh_build_item> &items, size_t begin, size_t end, vec3d *min, vec3d *max)
+{
+	*min = items[begin].min;
+	*max = items[begin].max;
+
+	for (size_t i = begin + 1; i < end; ++i) {
+		for (int axis = 0; axis < 3; ++axis) {
+			min->a1d[axis] = MIN(min->a1d[axis], items[i].min.a1d[axis]);
+			max->a1d[axis] = MAX(max->a1d[axis], items[i].max.a1d[axis]);
+		}
+	}
+}
+
+// Splits the items in two halves along the axis where their centers are spread the furthest
+static size_t bvh_build_split(SCP_vector<bvh_build_item> &items, size_t begin, size_t end)
+{
+	vec3d center_min = items[begin].center;
+	vec3d center_max = items[begin].center;
+
+	for (size_t i = begin + 1; i < end; ++i) {
+		for (int a = 0; a < 3; ++a) {
+			center_min.a1d[a] = MIN(center_min.a1d[a], items[i].center.a1d[a]);
+			center_max.a1d[a] = MAX(center_max.a1d[a], items[i].center.a1d[a]);
+		}
+	}
+
+	int axis = 0;
+	for (int a = 1; a < 3; ++a) {
+		if ( (center_max.a1d[a] - center_min.a1d[a]) > (center_max.a1d[axis] - center_min.a1d[axis]) ) {
+			axis = a;
+		}
+	}
+
+	size_t mid = begin + (end - begin) / 2;
+
+	std::nth_element(items.begin() + begin, items.begin() + mid, items.begin() + end,
+		[axis](const bvh_build_item &a, const bvh_build_item &b) { return a.center.a1d[axis] < b.center.a1d[axis]; });
+
+	return mid;
+}
+
+static int bvh_build_node(SCP_vector<bsp_collision_bvh_node> &nodes, SCP_vector<bvh_build_item> &items, size_t begin, size_t end)
+{
+	int node_index = (int)nodes.size();
+	nodes.push_back(bsp_collision_bvh_node());
+
+	size_t group_begin[BSP_BVH_WIDTH];
+	size_t group_end[BSP_BVH_WIDTH];
+	int num_groups;
+
+	if ( (end - begin) <= BSP_BVH_WIDTH ) {
+		num_groups = (int)(end - begin);
+
+		for (int i = 0; i < num_groups; ++i) {
+			group_begin[i] = begin + i;
+			group_end[i] = begin + i + 1;
+		}
+	} else {
+		// two levels of binary splits give the four children
+		size_t mid = bvh_build_split(items, begin, end);
+		size_t left = bvh_build_split(items, begin, mid);
+		size_t right = bvh_build_split(items, mid, end);
+
+		num_groups = 4;
+		group_begin[0] = begin;	group_end[0] = left;
+		group_begin[1] = left;	group_end[1] = mid;
+		group_begin[2] = mid;	group_end[2] = right;
+		group_begin[3] = right;	group_end[3] = end;
+	}
+
+	for (int i = 0; i < num_groups; ++i) {
+		vec3d min, max;
+		bvh_build_bounds(items, group_begin[i], group_end[i], &min, &max);
+
+		int child;
+		bool leaf = (group_end[i] - group_begin[i]) == 1;
+
+		if ( leaf ) {
+			child = items[group_begin[i]].leaf;
+		} else {
+			child = bvh_build_node(nodes, items, group_begin[i], group_end[i]);
+		}
+
+		// the recursion may have reallocated the node list
+		bsp_collision_bvh_node *node = &nodes[node_index];
+
+		for (int axis = 0; axis < 3; ++axis) {
+			node->min[axis][i] = min.a1d[axis];
+			node->max[axis][i] = max.a1d[axis];
+		}
+
+		node->child[i] = child;
+		if ( leaf ) {
+			node->leaf_mask |= (ubyte)(1 << i);
+		}
+	}
+
+	nodes[node_index].num_children = (ubyte)num_groups;
+
+	return node_index;
+}
+
+/**
+ * @brief Builds the bounding volume hierarchy used by model_collide_bvh()
+ *
+ * Every polygon group of the bsp tree becomes one item of the hierarchy. The bounds are computed from the polygons
+ * themselves since not all POF versions store usable bounds for every bsp node.
+ */
+static void model_collide_build_bvh(bsp_collision_tree *tree)
+{
+	tree->bvh_list = NULL;
+	tree->n_bvh_nodes = 0;
+
+	SCP_vector<bvh_build_item> items;
+
+	for (int i = 0; i < tree->n_nodes; ++i) {
+		if ( tree->node_list[i].leaf < 0 ) {
+			continue;
+		}
+
+		bvh_build_item item;
+		bool first = true;
+
+		for (int leaf_index = tree->node_list[i].leaf; leaf_index >= 0; leaf_index = tree->leaf_list[leaf_index].next) {
+			bsp_collision_leaf *leaf = &tree->leaf_list[leaf_index];
+
+			for (int v = 0; v < leaf->num_verts; ++v) {
+				vec3d *pnt = &tree->point_list[tree->vert_list[leaf->vert_start + v].vertnum];
+
+				if ( first ) {
+					item.min = *pnt;
+					item.max = *pnt;
+					first = false;
+				} else {
+					for (int axis = 0; axis < 3; ++axis) {
+						item.min.a1d[axis] = MIN(item.min.a1d[axis], pnt->a1d[axis]);
+						item.max.a1d[axis] = MAX(item.max.a1d[axis], pnt->a1d[axis]);
+					}
+				}
+			}
+		}
+
+		if ( first ) {
+			// no polygons with vertices in this group
+			continue;
+		}
+
+		vm_vec_avg(&item.center, &item.min, &item.max);
+		item.leaf = tree->node_list[i].leaf;
+
+		items.push_back(item);
+	}
+
+	if ( items.empty() ) {
+		return;
+	}
+
+	SCP_vector<bsp_collision_bvh_node> nodes;
+	nodes.reserve(items.size() / 2 + 1);
+
+	bvh_build_node(nodes, items, 0, items.size());
+
+	tree->n_bvh_nodes = (int)nodes.size();
+	tree->bvh_list = (bsp_collision_bvh_node*)vm_malloc(sizeof(bsp_collision_bvh_node) * nodes.size());
+	memcpy(tree->bvh_list, &nodes[0], sizeof(bsp_collision_bvh_node) * nodes.size());
+}
+
 void model_collide_parse_bsp(bsp_collision_tree *tree, void *model_ptr, int version)
 {
 	TRACE_SCOPE(tracing::ModelParseBSPTree);
@@ -745,7 +1070,9 @@ void model_collide_parse_bsp(bsp_collision_tree *tree, void *model_ptr, int vers
 
 	Assert(chunk_type == OP_DEFPOINTS);
 
-	int n_verts = model_collide_parse_bsp_defpoints(p);
+	// the points are copied straight into the tree instead of going through Mc_point_list so trees of different
+	// models can be parsed on several threads at once
+	int n_verts = w(p+8);
 
 	if ( n_verts <= 0) {
 		tree->point_list = NULL;
@@ -760,9 +1087,24 @@ void model_collide_parse_bsp(bsp_collision_tree *tree, void *model_ptr, int vers
 		// finally copy the vert list.
 		tree->vert_list = NULL;
 
+		tree->n_bvh_nodes = 0;
+		tree->bvh_list = NULL;
+
 		return;
 	}
 
+	tree->point_list = (vec3d*)vm_malloc(sizeof(vec3d) * n_verts);
+	tree->n_verts = n_verts;
+
+	ubyte *normcount = p+20;
+	vec3d *src = vp(p+w(p+16));
+
+	for ( int n = 0; n < n_verts; ++n ) {
+		tree->point_list[n] = *src;
+
+		src += normcount[n]+1;
+	}
+
 	p += chunk_size;
 
 	bsp_collision_node new_node;
@@ -882,17 +1224,6 @@ void model_collide_parse_bsp(bsp_collision_tree *tree, void *model_ptr, int vers
 		}
 	}
 
-	// copy point list
-	Assert(n_verts != -1);
-
-	tree->point_list = (vec3d*)vm_malloc(sizeof(vec3d) * n_verts);
-
-	for ( i = 0; i < (size_t)n_verts; ++i ) {
-		tree->point_list[i] = *Mc_point_list[i];
-	}
-
-	tree->n_verts = n_verts;
-
 	// copy node info. this might be a good time to organize the nodes into a cache efficient tree layout.
 	tree->n_nodes = (int)node_buffer.size();
 	tree->node_list = (bsp_collision_node*)vm_malloc(sizeof(bsp_collision_node) * node_buffer.size());
@@ -909,6 +1240,8 @@ void model_collide_parse_bsp(bsp_collision_tree *tree, void *model_ptr, int vers
 	tree->vert_list = (model_tmap_vert*)vm_malloc(sizeof(model_tmap_vert) * vert_buffer.size());
 	memcpy(tree->vert_list, &vert_buffer[0], sizeof(model_tmap_vert) * vert_buffer.size());
 	vert_buffer.clear();
+
+	model_collide_build_bvh(tree);
 }
 
 bool mc_shield_check_common(shield_tri	*tri)
@@ -1135,9 +1468,9 @@ void mc_check_subobj( int mn )
 			if ( Cmdline_old_collision_sys ) {
 				model_collide_sub(sm->bsp_data);
 			} else {
-				if (Mc->lod > 0 && sm->num_details > 0) {
-					bsp_info *lod_sm = sm;
+				bsp_info *lod_sm = sm;
 
+				if (Mc->lod > 0 && sm->num_details > 0) {
 					for (i = Mc->lod - 1; i >= 0; i--) {
 						if (sm->details[i] != -1) {
 							lod_sm = &Mc_pm->submodel[sm->details[i]];
@@ -1146,10 +1479,14 @@ void mc_check_subobj( int mn )
 							break;
 						}
 					}
+				}
+
+				bsp_collision_tree *tree = model_get_bsp_collision_tree(lod_sm->collision_tree_index);
 
-					model_collide_bsp(model_get_bsp_collision_tree(lod_sm->collision_tree_index), 0);
+				if ( Mc_use_bvh ) {
+					model_collide_bvh(tree);
 				} else {
-					model_collide_bsp(model_get_bsp_collision_tree(sm->collision_tree_index), 0);
+					model_collide_bsp(tree, 0);
 				}
 			}
 		}
@@ -1235,7 +1572,10 @@ int model_collide(mc_info *mc_info_obj)
 {
 	Mc = mc_info_obj;
 
-	MONITOR_INC(NumFVI,1);
+	// the monitors are not thread safe
+	if ( !jobs::is_worker_thread() ) {
+		MONITOR_INC(NumFVI,1);
+	}
 
 	Mc->num_hits = 0;				// How many collisions were found
 	Mc->shield_hit_tri = -1;	// Assume we won't hit any shield polygons
@@ -1364,26 +1704,14 @@ void model_collide_preprocess_subobj(vec3d *pos, matrix *orient, polymodel *pm,
 	int i = pm->submodel[subobj_num].first_child;
 
 	while ( i >= 0 ) {
-		angles angs = pmi->submodel[i].angs;
 		bsp_info * csm = &pm->submodel[i];
 
-		matrix tm = IDENTITY_MATRIX;
-
 		vm_vec_unrotate(pos, &csm->offset, &smi->mc_orient );
 		vm_vec_add2(pos, &smi->mc_base);
 
-		if( vm_matrix_same(&tm, &csm->orientation)) {
-			// if submodel orientation matrix is identity matrix then don't bother with matrix ops
-			vm_angles_2_matrix(&tm, &angs);
-		} else {
-			matrix rotation_matrix = csm->orientation;
-			vm_rotate_matrix_by_angles(&rotation_matrix, &angs);
-
-			matrix inv_orientation;
-			vm_copy_transpose(&inv_orientation, &csm->orientation);
-
-			vm_matrix_x_matrix(&tm, &rotation_matrix, &inv_orientation);
-		}
+		// shared with the renderer
+		matrix tm;
+		model_instance_get_local_orient(&tm, pm, pmi, i);
 
 		vm_matrix_x_matrix(orient, &smi->mc_orient, &tm);
 
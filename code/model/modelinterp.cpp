@@ -38,6 +38,7 @@
 #include "tracing/tracing.h"
 
 #include <limits.h>
+#include <unordered_map>
 
 
 float model_radius = 0;
@@ -2016,6 +2017,132 @@ void model_interp_submit_buffers(indexed_vertex_source *vert_src)
 	}
 }
 
+// IEEE 754 binary16, rounded to nearest
+static ushort interp_pack_half_float(float f)
+{
+	uint bits;
+	memcpy(&bits, &f, sizeof(bits));
+
+	uint sign = (bits >> 16) & 0x8000;
+	int exponent = (int)((bits >> 23) & 0xff) - 127 + 15;
+	uint mantissa = bits & 0x7fffff;
+
+	if ( (bits & 0x7fffffff) > 0x7f800000 ) {
+		// NaN
+		return (ushort)(sign | 0x7e00);
+	}
+
+	if ( exponent >= 31 ) {
+		// too large, or infinite
+		return (ushort)(sign | 0x7c00);
+	}
+
+	if ( exponent <= 0 ) {
+		// denormal, or too small
+		if ( exponent < -10 ) {
+			return (ushort)sign;
+		}
+
+		mantissa |= 0x800000;
+
+		int shift = 14 - exponent;
+		uint half = mantissa >> shift;
+
+		if ( (mantissa >> (shift - 1)) & 1 ) {
+			++half;
+		}
+
+		return (ushort)(sign | half);
+	}
+
+	uint half = sign | ((uint)exponent << 10) | (mantissa >> 13);
+
+	// a carry out of the mantissa correctly bumps the exponent
+	if ( mantissa & 0x1000 ) {
+		++half;
+	}
+
+	return (ushort)half;
+}
+
+// signed normalized GL_INT_2_10_10_10_REV, x in the lowest bits
+static uint interp_pack_snorm_2_10_10_10(float x, float y, float z, float w)
+{
+	auto pack_10 = [](float v) -> uint {
+		CLAMP(v, -1.0f, 1.0f);
+		return (uint)(int)floorf(v * 511.0f + 0.5f) & 0x3ff;
+	};
+
+	// -2 instead of -1 since that is -1.0 with both the GL 3.3 and the GL 4.2 conversion rule
+	uint packed_w = (w > 0.0f) ? 1 : ((w < 0.0f) ? 2 : 0);
+
+	return pack_10(x) | (pack_10(y) << 10) | (pack_10(z) << 20) | (packed_w << 30);
+}
+
+// the VB_FLAG_PACKED version of the vertex
+static void interp_pack_vertex_packed(ubyte *dest, vertex_buffer *vb, int i)
+{
+	vertex *vl = &vb->model_list->vert[i];
+
+	// NOTE: UV->NORM->TSB->MODEL_ID->VERT, same as the unpacked vertex
+
+	// tex coords
+	ushort uv[2];
+
+	if ( vb->flags & VB_FLAG_UV1 ) {
+		uv[0] = interp_pack_half_float(vl->texture_position.u);
+		uv[1] = interp_pack_half_float(vl->texture_position.v);
+	} else {
+		uv[0] = uv[1] = interp_pack_half_float(1.0f);
+	}
+
+	memcpy(dest, uv, sizeof(uv));
+	dest += sizeof(uv);
+
+	// normals
+	uint norm;
+
+	if ( vb->flags & VB_FLAG_NORMAL ) {
+		Assert(vb->model_list->norm != NULL);
+		vec3d *nl = &vb->model_list->norm[i];
+		norm = interp_pack_snorm_2_10_10_10(nl->xyz.x, nl->xyz.y, nl->xyz.z, 0.0f);
+	} else {
+		norm = interp_pack_snorm_2_10_10_10(0.0f, 0.0f, 1.0f, 0.0f);
+	}
+
+	memcpy(dest, &norm, sizeof(norm));
+	dest += sizeof(norm);
+
+	// tangent space data
+	uint tangent;
+
+	if ( vb->flags & VB_FLAG_TANGENT ) {
+		Assert(vb->model_list->tsb != NULL);
+		tsb_t *tsb = &vb->model_list->tsb[i];
+		tangent = interp_pack_snorm_2_10_10_10(tsb->tangent.xyz.x, tsb->tangent.xyz.y, tsb->tangent.xyz.z, tsb->scaler);
+	} else {
+		tangent = interp_pack_snorm_2_10_10_10(1.0f, 0.0f, 0.0f, 0.0f);
+	}
+
+	memcpy(dest, &tangent, sizeof(tangent));
+	dest += sizeof(tangent);
+
+	// model id, padded to keep the position aligned
+	ushort model_id[2] = { 0, 0 };
+
+	if ( vb->flags & VB_FLAG_MODEL_ID ) {
+		Assert(vb->model_list->submodels != NULL);
+		Assert(vb->model_list->submodels[i] >= 0 && vb->model_list->submodels[i] <= USHRT_MAX);
+		model_id[0] = (ushort)vb->model_list->submodels[i];
+	}
+
+	memcpy(dest, model_id, sizeof(model_id));
+	dest += sizeof(model_id);
+
+	// verts
+	memcpy(dest, &vl->world, 3 * sizeof(float));
+}
+
 bool model_interp_pack_buffer(indexed_vertex_source *vert_src, vertex_buffer *vb)
 {
 	if ( vert_src == NULL ) {
@@ -2060,62 +2187,72 @@ bool model_interp_pack_buffer(indexed_vertex_source *vert_src, vertex_buffer *vb
 
 	// generate the vertex array
 	n_verts = vb->model_list->n_verts;
-	for ( i = 0; i < n_verts; i++ ) {
-		vertex *vl = &vb->model_list->vert[i];
-
-		// don't try to generate more data than what's available
-		Assert(((arsize * sizeof(float)) + vb->stride) <= (vert_src->Vertex_list_size - vb->vertex_offset));
 
-		// NOTE: UV->NORM->TSB->MODEL_ID->VERT, This array order *must* be preserved!!
+	if ( vb->flags & VB_FLAG_PACKED ) {
+		Assert((vb->stride * n_verts) <= (vert_src->Vertex_list_size - vb->vertex_offset));
 
-		// tex coords
-		if ( vb->flags & VB_FLAG_UV1 ) {
-			array[arsize++] = vl->texture_position.u;
-			array[arsize++] = vl->texture_position.v;
-		} else {
-			array[arsize++] = 1.0f;
-			array[arsize++] = 1.0f;
+		for ( i = 0; i < n_verts; i++ ) {
+			interp_pack_vertex_packed((ubyte*)array + (vb->stride * i), vb, i);
 		}
 
-		// normals
-		if ( vb->flags & VB_FLAG_NORMAL ) {
-			Assert(vb->model_list->norm != NULL);
-			vec3d *nl = &vb->model_list->norm[i];
-			array[arsize++] = nl->xyz.x;
-			array[arsize++] = nl->xyz.y;
-			array[arsize++] = nl->xyz.z;
-		} else {
-			array[arsize++] = 0.0f;
-			array[arsize++] = 0.0f;
-			array[arsize++] = 1.0f;
-		}
-
-		// tangent space data
-		if ( vb->flags & VB_FLAG_TANGENT ) {
-			Assert(vb->model_list->tsb != NULL);
-			tsb_t *tsb = &vb->model_list->tsb[i];
-			array[arsize++] = tsb->tangent.xyz.x;
-			array[arsize++] = tsb->tangent.xyz.y;
-			array[arsize++] = tsb->tangent.xyz.z;
-			array[arsize++] = tsb->scaler;
-		} else {
-			array[arsize++] = 1.0f;
-			array[arsize++] = 0.0f;
-			array[arsize++] = 0.0f;
-			array[arsize++] = 0.0f;
-		}
+	} else {
+		for ( i = 0; i < n_verts; i++ ) {
+			vertex *vl = &vb->model_list->vert[i];
 
-		if ( vb->flags & VB_FLAG_MODEL_ID ) {
-			Assert(vb->model_list->submodels != NULL);
-			array[arsize++] = (float)vb->model_list->submodels[i];
-		} else {
-			array[arsize++] = 0.0f;
-		}
+			// don't try to generate more data than what's available
+			Assert(((arsize * sizeof(float)) + vb->stride) <= (vert_src->Vertex_list_size - vb->vertex_offset));
+
+			// NOTE: UV->NORM->TSB->MODEL_ID->VERT, This array order *must* be preserved!!
+
+			// tex coords
+			if ( vb->flags & VB_FLAG_UV1 ) {
+				array[arsize++] = vl->texture_position.u;
+				array[arsize++] = vl->texture_position.v;
+			} else {
+				array[arsize++] = 1.0f;
+				array[arsize++] = 1.0f;
+			}
+
+			// normals
+			if ( vb->flags & VB_FLAG_NORMAL ) {
+				Assert(vb->model_list->norm != NULL);
+				vec3d *nl = &vb->model_list->norm[i];
+				array[arsize++] = nl->xyz.x;
+				array[arsize++] = nl->xyz.y;
+				array[arsize++] = nl->xyz.z;
+			} else {
+				array[arsize++] = 0.0f;
+				array[arsize++] = 0.0f;
+				array[arsize++] = 1.0f;
+			}
+
+			// tangent space data
+			if ( vb->flags & VB_FLAG_TANGENT ) {
+				Assert(vb->model_list->tsb != NULL);
+				tsb_t *tsb = &vb->model_list->tsb[i];
+				array[arsize++] = tsb->tangent.xyz.x;
+				array[arsize++] = tsb->tangent.xyz.y;
+				array[arsize++] = tsb->tangent.xyz.z;
+				array[arsize++] = tsb->scaler;
+			} else {
+				array[arsize++] = 1.0f;
+				array[arsize++] = 0.0f;
+				array[arsize++] = 0.0f;
+				array[arsize++] = 0.0f;
+			}
+
+			if ( vb->flags & VB_FLAG_MODEL_ID ) {
+				Assert(vb->model_list->submodels != NULL);
+				array[arsize++] = (float)vb->model_list->submodels[i];
+			} else {
+				array[arsize++] = 0.0f;
+			}
 
-		// verts
-		array[arsize++] = vl->world.xyz.x;
-		array[arsize++] = vl->world.xyz.y;
-		array[arsize++] = vl->world.xyz.z;
+			// verts
+			array[arsize++] = vl->world.xyz.x;
+			array[arsize++] = vl->world.xyz.y;
+			array[arsize++] = vl->world.xyz.z;
+		}
 	}
 
 	// generate the index array
@@ -2171,6 +2308,37 @@ void model_interp_set_buffer_layout(vertex_layout *layout, uint stride, int flag
 
 	// NOTE: UV->NORM->TSB->MODEL_ID->VERT, This array order *must* be preserved!!
 
+	if ( flags & VB_FLAG_PACKED ) {
+		if ( flags & VB_FLAG_UV1 ) {
+			layout->add_vertex_component(vertex_format_data::TEX_COORD_HALF, stride, offset);
+		}
+
+		offset += (2 * sizeof(ushort));
+
+		if ( flags & VB_FLAG_NORMAL ) {
+			layout->add_vertex_component(vertex_format_data::NORMAL_PACKED, stride, offset);
+		}
+
+		offset += sizeof(uint);
+
+		if ( flags & VB_FLAG_TANGENT ) {
+			layout->add_vertex_component(vertex_format_data::TANGENT_PACKED, stride, offset);
+		}
+
+		offset += sizeof(uint);
+
+		if ( flags & VB_FLAG_MODEL_ID ) {
+			layout->add_vertex_component(vertex_format_data::MODEL_ID_SHORT, stride, offset);
+		}
+
+		offset += (2 * sizeof(ushort));
+
+		Assert(flags & VB_FLAG_POSITION);
+		layout->add_vertex_component(vertex_format_data::POSITION3, stride, offset);
+
+		return;
+	}
+
 	if ( flags & VB_FLAG_UV1 ) {
 		layout->add_vertex_component(vertex_format_data::TEX_COORD, stride, offset);
 	}
@@ -2217,17 +2385,31 @@ bool model_interp_config_buffer(indexed_vertex_source *vert_src, vertex_buffer *
 	// pad out the vertex buffer even if it doesn't use certain attributes
 	// we require consistent stride across vertex buffers so we can use base vertex offsetting for performance reasons
 
-	// uv coords
-	vb->stride += (2 * sizeof(float));
+	if ( vb->flags & VB_FLAG_PACKED ) {
+		// half float uv coords
+		vb->stride += (2 * sizeof(ushort));
 
-	// normals
-	vb->stride += (3 * sizeof(float));
+		// 10:10:10:2 normals
+		vb->stride += sizeof(uint);
 
-	// tangent space data for normal maps (shaders only)
-	vb->stride += (4 * sizeof(float));
+		// 10:10:10:2 tangent space data
+		vb->stride += sizeof(uint);
 
-	// model ID for batched submodel rendering (shaders only)
-	vb->stride += (1 * sizeof(float));
+		// short model ID and padding
+		vb->stride += (2 * sizeof(ushort));
+	} else {
+		// uv coords
+		vb->stride += (2 * sizeof(float));
+
+		// normals
+		vb->stride += (3 * sizeof(float));
+
+		// tangent space data for normal maps (shaders only)
+		vb->stride += (4 * sizeof(float));
+
+		// model ID for batched submodel rendering (shaders only)
+		vb->stride += (1 * sizeof(float));
+	}
 
 	// position
 	vb->stride += (3 * sizeof(float));
@@ -2244,13 +2426,19 @@ bool model_interp_config_buffer(indexed_vertex_source *vert_src, vertex_buffer *
 	for ( size_t idx = 0; idx < vb->tex_buf.size(); idx++ ) {
 		buffer_data *bd = &vb->tex_buf[idx];
 
+		// only large indices need to be word aligned, the small ones of a buffer follow each other without a gap so the
+		// draws of consecutive textures can be merged, see model_draw_list::merge_draws()
+		if ( bd->flags & VB_FLAG_LARGE_INDEX ) {
+			vert_src->Index_list_size += (uint)(vert_src->Index_list_size % sizeof(uint));
+		}
+
 		bd->index_offset = vert_src->Index_list_size;
 		vert_src->Index_list_size += (uint)(bd->n_verts * ((bd->flags & VB_FLAG_LARGE_INDEX) ? sizeof(uint) : sizeof(ushort)));
-
-		// even out index buffer so we are always word aligned
-		vert_src->Index_list_size += (uint)(vert_src->Index_list_size % sizeof(uint));
 	}
 
+	// even out index buffer so we are always word aligned
+	vert_src->Index_list_size += (uint)(vert_src->Index_list_size % sizeof(uint));
+
 	return true;
 }
 
@@ -2266,10 +2454,8 @@ void interp_configure_vertex_buffers(polymodel *pm, int mn)
 
 	bsp_info *model = &pm->submodel[mn];
 
-	for (i = 0; i < MAX_MODEL_TEXTURES; i++) {
-		polygon_list[i].n_verts = 0;
-		tri_count[i] = 0;
-	}
+	// not the global lists since the buffers of several models may be configured at the same time
+	poly_list polygon_list[MAX_MODEL_TEXTURES];
 
 	int milliseconds = timer_get_milliseconds();
 
@@ -2277,7 +2463,6 @@ void interp_configure_vertex_buffers(polymodel *pm, int mn)
 
 	for (i = 0; i < MAX_MODEL_TEXTURES; i++) {
 		int vert_count = bsp_polies->get_num_triangles(i) * 3;
-		tri_count[i] = vert_count / 3;
 		total_verts += vert_count;
 
 		polygon_list[i].allocate(vert_count);
@@ -2365,6 +2550,10 @@ void interp_configure_vertex_buffers(polymodel *pm, int mn)
 		vertex_flags |= VB_FLAG_MODEL_ID;
 	}
 
+	if ( gr_is_capable(CAPABILITY_PACKED_VERTICES) ) {
+		vertex_flags |= VB_FLAG_PACKED;
+	}
+
 	model->buffer.flags = vertex_flags;
 
 	for (i = 0; i < MAX_MODEL_TEXTURES; i++) {
@@ -2526,6 +2715,213 @@ void interp_create_detail_index_buffer(polymodel *pm, int detail_num)
 	model_interp_config_buffer(&pm->vert_source, &pm->detail_buffers[detail_num], true);
 }
 
+const float Model_generated_lod_radius[MAX_MODEL_GENERATED_LODS] = { 160.0f, 64.0f, 24.0f };
+
+// how far a vertex of a generated LOD may move, in pixels at the radius the LOD is used from
+static const float GENERATED_LOD_ERROR_PIXELS = 1.0f;
+
+// a LOD has to remove at least this much of the previous one to be worth a draw of its own
+static const float GENERATED_LOD_MAX_RATIO = 0.8f;
+
+// models with fewer triangles are cheap enough as they are
+static const size_t GENERATED_LOD_MIN_TRIS = 512;
+
+namespace {
+// the vertices in one cell of the grid which are merged into one, they have to share the texture, submodel and the
+// rough direction of the normal so the silhouette and the hard edges survive
+struct lod_cluster_key {
+	int texture;
+	int submodel;
+	int x, y, z;
+	int normal;
+
+	bool operator==(const lod_cluster_key& other) const
+	{
+		return texture == other.texture && submodel == other.submodel && x == other.x && y == other.y
+			&& z == other.z && normal == other.normal;
+	}
+};
+
+struct lod_cluster_key_hash {
+	size_t operator()(const lod_cluster_key& key) const
+	{
+		size_t hash = (size_t)key.texture;
+		hash = hash * 31 + (size_t)key.submodel;
+		hash = hash * 73856093 + (size_t)key.x;
+		hash = hash * 19349663 + (size_t)key.y;
+		hash = hash * 83492791 + (size_t)key.z;
+		return hash * 7 + (size_t)key.normal;
+	}
+};
+
+int lod_normal_bucket(const vec3d *norm)
+{
+	float x = fl_abs(norm->xyz.x);
+	float y = fl_abs(norm->xyz.y);
+	float z = fl_abs(norm->xyz.z);
+
+	if ( x >= y && x >= z ) {
+		return norm->xyz.x < 0.0f ? 1 : 0;
+	} else if ( y >= z ) {
+		return norm->xyz.y < 0.0f ? 3 : 2;
+	} else {
+		return norm->xyz.z < 0.0f ? 5 : 4;
+	}
+}
+}
+
+/**
+ * Generates the LODs of a model which only has one detail level
+ *
+ * The triangles of the batched buffer of detail level 0 are simplified by vertex clustering. The vertices in a cell of
+ * a grid are replaced by the first of them and the triangles which collapse are dropped. Since the remaining indices
+ * still point into the vertex buffer of detail level 0 this only costs index memory. The cell size is derived from the
+ * screen radius the LOD is used from, see Model_generated_lod_radius.
+ *
+ * Needs the vertex data of the submodels so it has to be called before they are packed.
+ */
+void interp_create_generated_lods(polymodel *pm)
+{
+	TRACE_SCOPE(tracing::ModelCreateGeneratedLODs);
+
+	pm->n_generated_lods = 0;
+
+	vertex_buffer *source = &pm->detail_buffers[0];
+
+	if ( pm->n_detail_levels != 1 || source->tex_buf.empty() || pm->rad <= 0.0f ) {
+		return;
+	}
+
+	SCP_vector<int> submodel_list;
+	model_get_submodel_tree_list(submodel_list, pm, pm->detail[0]);
+
+	// look up the data of the vertices by their index in the whole buffer
+	size_t num_verts = 0;
+	for ( auto mn : submodel_list ) {
+		vertex_buffer *buffer = &pm->submodel[mn].buffer;
+
+		if ( !pm->submodel[mn].is_thruster && buffer->model_list != NULL ) {
+			num_verts = MAX(num_verts, buffer->vertex_num_offset + buffer->model_list->n_verts);
+		}
+	}
+
+	SCP_vector<const vec3d*> vert_pos(num_verts, nullptr);
+	SCP_vector<const vec3d*> vert_norm(num_verts, nullptr);
+	SCP_vector<int> vert_submodel(num_verts, -1);
+
+	for ( auto mn : submodel_list ) {
+		vertex_buffer *buffer = &pm->submodel[mn].buffer;
+
+		if ( pm->submodel[mn].is_thruster || buffer->model_list == NULL || buffer->model_list->norm == NULL ) {
+			continue;
+		}
+
+		for ( int i = 0; i < buffer->model_list->n_verts; ++i ) {
+			size_t index = buffer->vertex_num_offset + i;
+
+			vert_pos[index] = &buffer->model_list->vert[i].world;
+			vert_norm[index] = &buffer->model_list->norm[i];
+			vert_submodel[index] = mn;
+		}
+	}
+
+	size_t prev_indices = 0;
+	for ( auto& tex_buf : source->tex_buf ) {
+		prev_indices += tex_buf.n_verts;
+	}
+
+	if ( prev_indices / 3 < GENERATED_LOD_MIN_TRIS ) {
+		return;
+	}
+
+	std::unordered_map<lod_cluster_key, uint, lod_cluster_key_hash> clusters;
+	SCP_vector<uint> remapped;
+
+	for ( int lod = 0; lod < MAX_MODEL_GENERATED_LODS && lod + 1 < MAX_MODEL_DETAIL_LEVELS; ++lod ) {
+		float cell_size = pm->rad * GENERATED_LOD_ERROR_PIXELS / Model_generated_lod_radius[lod];
+
+		vertex_buffer *buffer = &pm->detail_buffers[lod + 1];
+		buffer->clear();
+
+		size_t total_indices = 0;
+
+		for ( auto& src_buf : source->tex_buf ) {
+			const uint *index = src_buf.get_index();
+			clusters.clear();
+			remapped.clear();
+
+			for ( size_t i = 0; i + 2 < src_buf.n_verts; i += 3 ) {
+				uint tri[3];
+
+				for ( int j = 0; j < 3; ++j ) {
+					uint vert = index[i + j];
+					tri[j] = vert;
+
+					if ( vert >= num_verts || vert_pos[vert] == nullptr ) {
+						continue;
+					}
+
+					const vec3d *pos = vert_pos[vert];
+
+					lod_cluster_key key;
+					key.texture = src_buf.texture;
+					key.submodel = vert_submodel[vert];
+					key.x = (int)floorf(pos->xyz.x / cell_size);
+					key.y = (int)floorf(pos->xyz.y / cell_size);
+					key.z = (int)floorf(pos->xyz.z / cell_size);
+					key.normal = lod_normal_bucket(vert_norm[vert]);
+
+					tri[j] = clusters.emplace(key, vert).first->second;
+				}
+
+				// the triangle collapsed into a line or a point
+				if ( tri[0] == tri[1] || tri[1] == tri[2] || tri[0] == tri[2] ) {
+					continue;
+				}
+
+				remapped.insert(remapped.end(), tri, tri + 3);
+			}
+
+			if ( remapped.empty() ) {
+				continue;
+			}
+
+			buffer->tex_buf.push_back(buffer_data(remapped.size()));
+
+			buffer_data &new_buffer = buffer->tex_buf.back();
+			new_buffer.texture = src_buf.texture;
+
+			for ( size_t i = 0; i < remapped.size(); ++i ) {
+				new_buffer.assign(i, remapped[i]);
+			}
+
+			if ( new_buffer.i_last >= USHRT_MAX ) {
+				new_buffer.flags |= VB_FLAG_LARGE_INDEX;
+			}
+
+			total_indices += remapped.size();
+		}
+
+		if ( total_indices == 0 || total_indices > prev_indices * GENERATED_LOD_MAX_RATIO ) {
+			buffer->clear();
+			break;
+		}
+
+		buffer->flags = source->flags;
+		buffer->vertex_offset = 0;
+		buffer->vertex_num_offset = 0;
+		buffer->model_list = new(std::nothrow) poly_list;
+
+		model_interp_config_buffer(&pm->vert_source, buffer, true);
+
+		nprintf(("Model", "Generated LOD %d of '%s' with %d triangles, down from %d\n", lod + 1, pm->filename,
+			(int)(total_indices / 3), (int)(prev_indices / 3)));
+
+		prev_indices = total_indices;
+		pm->n_generated_lods++;
+	}
+}
+
 void interp_create_transparency_index_buffer(polymodel *pm, int mn)
 {
 	TRACE_SCOPE(tracing::ModelCreateTransparencyIndexBuffer);
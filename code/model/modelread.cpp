@@ -22,7 +22,9 @@
 #include "asteroid/asteroid.h"
 #include "bmpman/bmpman.h"
 #include "cfile/cfile.h"
+#include "cfile/cfilereader.h"
 #include "cmdline/cmdline.h"
+#include "globalincs/jobs.h"
 #include "freespace.h"		// For flFrameTime
 #include "gamesnd/gamesnd.h"
 #include "globalincs/linklist.h"
@@ -31,6 +33,7 @@
 #include "math/fvi.h"
 #include "math/vecmat.h"
 #include "model/model.h"
+#include "model/modelcache.h"
 #include "model/modelsinc.h"
 #include "parse/parselo.h"
 #include "render/3dinternal.h"
@@ -59,6 +62,72 @@ int model_render_flags_size = sizeof(model_render_flags)/sizeof(flag_def_list);
 polymodel *Polygon_models[MAX_POLYGON_MODELS];
 SCP_vector<polymodel_instance*> Polygon_model_instances;
 
+// the free slots of Polygon_model_instances, the last one is used first
+static SCP_vector<int> Polygon_model_instance_free_slots;
+
+// Model instances are created and deleted all the time while ships, debris and weapons come and go. Each one is a
+// single block with the polymodel_instance followed by its submodel instances. The blocks are cut from chunks by their
+// number of submodels and deleted blocks are kept for the next instance with the same number, until
+// model_instance_free_all() releases everything.
+typedef struct model_instance_block {
+	int n_models;
+	polymodel_instance pmi;
+} model_instance_block;
+
+typedef struct model_instance_pool {
+	size_t block_size;
+	SCP_vector<char*> chunks;
+	SCP_vector<model_instance_block*> free_blocks;
+} model_instance_pool;
+
+#define MODEL_INSTANCE_POOL_CHUNK	16
+
+static SCP_unordered_map<int, model_instance_pool> Model_instance_pools;	// by number of submodels
+
+static size_t model_instance_submodel_offset()
+{
+	const size_t align = alignof(submodel_instance);
+	return ((sizeof(model_instance_block) + align - 1) / align) * align;
+}
+
+static polymodel_instance *model_instance_alloc(int n_models)
+{
+	auto &pool = Model_instance_pools[n_models];
+
+	if ( pool.free_blocks.empty() ) {
+		const size_t align = MAX(alignof(model_instance_block), alignof(submodel_instance));
+		pool.block_size = model_instance_submodel_offset() + sizeof(submodel_instance) * n_models;
+		pool.block_size = ((pool.block_size + align - 1) / align) * align;
+
+		char *chunk = (char*)vm_malloc(pool.block_size * MODEL_INSTANCE_POOL_CHUNK);
+		pool.chunks.push_back(chunk);
+
+		// the front of the chunk is handed out first
+		for ( int i = MODEL_INSTANCE_POOL_CHUNK - 1; i >= 0; i-- ) {
+			pool.free_blocks.push_back(reinterpret_cast<model_instance_block*>(chunk + pool.block_size * i));
+		}
+	}
+
+	auto block = pool.free_blocks.back();
+	pool.free_blocks.pop_back();
+
+	block->n_models = n_models;
+	memset(&block->pmi, 0, sizeof(polymodel_instance));
+
+	if ( n_models > 0 ) {
+		block->pmi.submodel = reinterpret_cast<submodel_instance*>(reinterpret_cast<char*>(block) + model_instance_submodel_offset());
+	}
+
+	return &block->pmi;
+}
+
+static void model_instance_release(polymodel_instance *pmi)
+{
+	auto block = reinterpret_cast<model_instance_block*>(reinterpret_cast<char*>(pmi) - offsetof(model_instance_block, pmi));
+
+	Model_instance_pools[block->n_models].free_blocks.push_back(block);
+}
+
 SCP_vector<bsp_collision_tree> Bsp_collision_tree_list;
 
 static int model_initted = 0;
@@ -82,9 +151,26 @@ static uint Global_checksum = 0;
 
 static int Model_signature = 0;
 
+// A model loaded inside a batch whose vertex buffers and collision trees are still being built by a job
+struct model_pending_load {
+	polymodel *pm = NULL;
+	uint pof_checksum = 0;
+	bool cached = false;
+
+	// the trees are only added to Bsp_collision_tree_list on the main thread since the list may be reallocated
+	SCP_vector<bsp_collision_tree> trees;
+};
+
+static int Model_batch_depth = 0;
+static jobs::job_group Model_batch_jobs;
+static SCP_vector<std::unique_ptr<model_pending_load>> Model_pending_loads;
+
+static void model_finish_pending_loads();
+
 void interp_configure_vertex_buffers(polymodel*, int);
 void interp_pack_vertex_buffers(polymodel* pm, int mn);
 void interp_create_detail_index_buffer(polymodel *pm, int detail);
+void interp_create_generated_lods(polymodel *pm);
 void interp_create_transparency_index_buffer(polymodel *pm, int detail_num);
 void model_interp_process_shield_mesh(polymodel * pm);
 
@@ -186,6 +272,9 @@ void model_unload(int modelnum, int force)
 	if (!force && (--pm->used_this_mission > 0))
 		return;
 
+	// a job of the current batch may still be working on this model
+	model_finish_pending_loads();
+
 	mprintf(("Unloading model '%s' from slot '%i'\n", pm->filename, num));
 
 	// so that the textures can be released
@@ -389,11 +478,19 @@ void model_instance_free_all()
 		}
 	}
 
+	for ( auto &entry : Model_instance_pools ) {
+		for ( auto chunk : entry.second.chunks ) {
+			vm_free(chunk);
+		}
+	}
+	Model_instance_pools.clear();
+
 	// clear skybox model instance if we have one; it is not an object and therefore has no <object>_delete function which would remove the instance
 	extern int Nmodel_instance_num;
 	Nmodel_instance_num = -1;
 
 	Polygon_model_instances.clear();
+	Polygon_model_instance_free_slots.clear();
 }
 
 void model_page_in_start()
@@ -873,6 +970,20 @@ void create_family_tree(polymodel *obj)
 	}
 }
 
+// determine the size and configuration of each buffer segment, this only touches the model itself so it can be done
+// by a job
+void configure_vertex_buffer(polymodel *pm)
+{
+	if (Is_standalone) {
+		return;
+	}
+
+	for (int i = 0; i < pm->n_models; i++) {
+		interp_configure_vertex_buffers(pm, i);
+	}
+}
+
+// needs the configured buffers and has to be done on the main thread since the transparency check looks at the textures
 void create_vertex_buffer(polymodel *pm)
 {
 	if (Is_standalone) {
@@ -883,11 +994,6 @@ void create_vertex_buffer(polymodel *pm)
 
 	int i;
 
-	// determine the size and configuration of each buffer segment
-	for (i = 0; i < pm->n_models; i++) {
-		interp_configure_vertex_buffers(pm, i);
-	}
-
 	// figure out which vertices are transparent
 	for ( i = 0; i < pm->n_models; i++ ) {
 		if ( !pm->submodel[i].is_thruster ) {
@@ -920,6 +1026,10 @@ void create_vertex_buffer(polymodel *pm)
 		for ( i = 0; i < pm->n_detail_levels; i++ )	{
 			interp_create_detail_index_buffer(pm, i);
 		}
+
+		if ( Cmdline_generate_lods ) {
+			interp_create_generated_lods(pm);
+		}
 	}
 
 	// now actually fill the buffer with our info ...
@@ -933,7 +1043,7 @@ void create_vertex_buffer(polymodel *pm)
 
 	if ( use_batched_rendering ) {
 		// pack the merged index buffers to the vbo.
-		for ( i = 0; i < pm->n_detail_levels; ++i ) {
+		for ( i = 0; i < pm->n_detail_levels + pm->n_generated_lods; ++i ) {
 			if ( pm->detail_buffers[i].model_list == NULL ) {
 				continue;
 			}
@@ -944,6 +1054,14 @@ void create_vertex_buffer(polymodel *pm)
 
 		pm->flags |= PM_FLAG_BATCHED;
 	}
+}
+
+// the buffers are only submitted once everything else has been set up so the model cache can still copy the data
+void submit_vertex_buffer(polymodel *pm)
+{
+	if (Is_standalone) {
+		return;
+	}
 
 	// ... and then finalize buffer
 	model_interp_pack_buffer(&pm->vert_source, NULL);
@@ -1074,6 +1192,9 @@ int read_model_file(polymodel * pm, const char *filename, int n_subsystems, mode
 	cf_chksum_long(fp, &Global_checksum);
 	cfseek(fp, 0, SEEK_SET);
 
+	// every chunk is read in one go (or just looked at where the file is mapped) and decoded from memory
+	SCP_vector<ubyte> chunk_buffer;
+
 
 	// code to get a filename to write out subsystem information for each model that
 	// is read.  This info is essentially debug stuff that is used to help get models
@@ -1132,6 +1253,9 @@ int read_model_file(polymodel * pm, const char *filename, int n_subsystems, mode
 	next_chunk = cftell(fp) + len;
 
 	while (!cfeof(fp)) {
+		int chunk_len = len;
+		const ubyte *chunk_data = cfread_view(fp, &chunk_len, chunk_buffer);
+		cfile::chunk_reader chunk(chunk_data, chunk_len);
 
 //		mprintf(("Processing chunk <%c%c%c%c>, len = %d\n",id,id>>8,id>>16,id>>24,len));
 //		key_getch();
@@ -1144,14 +1268,14 @@ int read_model_file(polymodel * pm, const char *filename, int n_subsystems, mode
 				//mprintf(0,"Got chunk OHDR, len=%d\n",len);
 
 #if defined( FREESPACE1_FORMAT )
-				pm->n_models = cfread_int(fp);
+				pm->n_models = chunk.read_int();
 //				mprintf(( "Num models = %d\n", pm->n_models ));
-				pm->rad = cfread_float(fp);
-				pm->flags = cfread_int(fp);	// 1=Allow tiling
+				pm->rad = chunk.read_float();
+				pm->flags = chunk.read_int();	// 1=Allow tiling
 #elif defined( FREESPACE2_FORMAT )
-				pm->rad = cfread_float(fp);
-				pm->flags = cfread_int(fp);	// 1=Allow tiling
-				pm->n_models = cfread_int(fp);
+				pm->rad = chunk.read_float();
+				pm->flags = chunk.read_int();	// 1=Allow tiling
+				pm->n_models = chunk.read_int();
 //				mprintf(( "Num models = %d\n", pm->n_models ));
 #endif
 
@@ -1165,8 +1289,8 @@ int read_model_file(polymodel * pm, const char *filename, int n_subsystems, mode
 
 				//Assert(pm->n_models <= MAX_SUBMODELS);
 
-				cfread_vector(&pm->mins,fp);
-				cfread_vector(&pm->maxs,fp);
+				chunk.read_vector(&pm->mins);
+				chunk.read_vector(&pm->maxs);
 
 				// sanity first!
 				if (maybe_swap_mins_maxs(&pm->mins, &pm->maxs)) {
@@ -1174,19 +1298,19 @@ int read_model_file(polymodel * pm, const char *filename, int n_subsystems, mode
 				}
 				model_calc_bound_box(pm->bounding_box, &pm->mins, &pm->maxs);
 				
-				pm->n_detail_levels = cfread_int(fp);
+				pm->n_detail_levels = chunk.read_int();
 			//	mprintf(( "There are %d detail levels\n", pm->n_detail_levels ));
 				for (i=0; i<pm->n_detail_levels;i++ )	{
-					pm->detail[i] = cfread_int(fp);
+					pm->detail[i] = chunk.read_int();
 					pm->detail_depth[i] = 0.0f;
 			///		mprintf(( "Detail level %d is model %d.\n", i, pm->detail[i] ));
 				}
 
-				pm->num_debris_objects = cfread_int(fp);
+				pm->num_debris_objects = chunk.read_int();
 				Assert( pm->num_debris_objects <= MAX_DEBRIS_OBJECTS );
 				// mprintf(( "There are %d debris objects\n", pm->num_debris_objects ));
 				for (i=0; i<pm->num_debris_objects;i++ )	{
-					pm->debris_objects[i] = cfread_int(fp);
+					pm->debris_objects[i] = chunk.read_int();
 					// mprintf(( "Debris object %d is model %d.\n", i, pm->debris_objects[i] ));
 				}
 
@@ -1194,11 +1318,11 @@ int read_model_file(polymodel * pm, const char *filename, int n_subsystems, mode
 	
 					if ( pm->version >= 2009 )	{
 																	
-						pm->mass = cfread_float(fp);
-						cfread_vector( &pm->center_of_mass, fp );
-						cfread_vector( &pm->moment_of_inertia.vec.rvec, fp );
-						cfread_vector( &pm->moment_of_inertia.vec.uvec, fp );
-						cfread_vector( &pm->moment_of_inertia.vec.fvec, fp );
+						pm->mass = chunk.read_float();
+						chunk.read_vector(&pm->center_of_mass);
+						chunk.read_vector(&pm->moment_of_inertia.vec.rvec);
+						chunk.read_vector(&pm->moment_of_inertia.vec.uvec);
+						chunk.read_vector(&pm->moment_of_inertia.vec.fvec);
 
 						if(!is_valid_vec(&pm->moment_of_inertia.vec.rvec) || !is_valid_vec(&pm->moment_of_inertia.vec.uvec) || !is_valid_vec(&pm->moment_of_inertia.vec.fvec)) {
 							Warning(LOCATION, "Moment of inertia values for model %s are invalid. This has to be fixed.\n", pm->filename);
@@ -1207,7 +1331,7 @@ int read_model_file(polymodel * pm, const char *filename, int n_subsystems, mode
 					} else {
 						// old code where mass wasn't based on area, so do the calculation manually
 
-						float vol_mass = cfread_float(fp);
+						float vol_mass = chunk.read_float();
 						//	Attn: John Slagel:  The following is better done in bspgen.
 						// Convert volume (cubic) to surface area (quadratic) and scale so 100 -> 100
 						float area_mass = (float) pow(vol_mass, 0.6667f) * 4.65f;
@@ -1215,10 +1339,10 @@ int read_model_file(polymodel * pm, const char *filename, int n_subsystems, mode
 						pm->mass = area_mass;
 						float mass_ratio = vol_mass / area_mass; 
 							
-						cfread_vector( &pm->center_of_mass, fp );
-						cfread_vector( &pm->moment_of_inertia.vec.rvec, fp );
-						cfread_vector( &pm->moment_of_inertia.vec.uvec, fp );
-						cfread_vector( &pm->moment_of_inertia.vec.fvec, fp );
+						chunk.read_vector(&pm->center_of_mass);
+						chunk.read_vector(&pm->moment_of_inertia.vec.rvec);
+						chunk.read_vector(&pm->moment_of_inertia.vec.uvec);
+						chunk.read_vector(&pm->moment_of_inertia.vec.fvec);
 
 						if(!is_valid_vec(&pm->moment_of_inertia.vec.rvec) || !is_valid_vec(&pm->moment_of_inertia.vec.uvec) || !is_valid_vec(&pm->moment_of_inertia.vec.fvec)) {
 							Warning(LOCATION, "Moment of inertia values for model %s are invalid. This has to be fixed.\n", pm->filename);
@@ -1251,12 +1375,12 @@ int read_model_file(polymodel * pm, const char *filename, int n_subsystems, mode
 				// read in cross section info
 				pm->xc = NULL;
 				if ( pm->version >= 2014 ) {
-					pm->num_xc = cfread_int(fp);
+					pm->num_xc = chunk.read_int();
 					if (pm->num_xc > 0) {
 						pm->xc = (cross_section*) vm_malloc(pm->num_xc*sizeof(cross_section));
 						for (i=0; i<pm->num_xc; i++) {
-							pm->xc[i].z = cfread_float(fp);
-							pm->xc[i].radius = cfread_float(fp);
+							pm->xc[i].z = chunk.read_float();
+							pm->xc[i].radius = chunk.read_float();
 						}
 					}
 				} else {
@@ -1264,14 +1388,14 @@ int read_model_file(polymodel * pm, const char *filename, int n_subsystems, mode
 				}
 
 				if ( pm->version >= 2007 )	{
-					pm->num_lights = cfread_int(fp);
+					pm->num_lights = chunk.read_int();
 					//mprintf(( "Found %d lights!\n", pm->num_lights ));
 
 					if (pm->num_lights > 0) {
 						pm->lights = (bsp_light *)vm_malloc( sizeof(bsp_light)*pm->num_lights );
 						for (i=0; i<pm->num_lights; i++ )	{			
-							cfread_vector(&pm->lights[i].pos,fp);
-							pm->lights[i].type = cfread_int(fp);
+							chunk.read_vector(&pm->lights[i].pos);
+							pm->lights[i].type = chunk.read_int();
 							pm->lights[i].value = 0.0f;
 						}
 					}
@@ -1290,40 +1414,40 @@ int read_model_file(polymodel * pm, const char *filename, int n_subsystems, mode
 
 				//mprintf(0,"Got chunk SOBJ, len=%d\n",len);
 
-				n = cfread_int(fp);
+				n = chunk.read_int();
 				//mprintf(("SOBJ IDed itself as %d", n));
 
 				Assert(n < pm->n_models );
 
 #if defined( FREESPACE2_FORMAT )	
-				pm->submodel[n].rad = cfread_float(fp);		//radius
+				pm->submodel[n].rad = chunk.read_float();		//radius
 #endif
 
-				pm->submodel[n].parent = cfread_int(fp);
+				pm->submodel[n].parent = chunk.read_int();
 
-//				cfread_vector(&pm->submodel[n].norm,fp);
-//				d = cfread_float(fp);				
-//				cfread_vector(&pm->submodel[n].pnt,fp);
-				cfread_vector(&pm->submodel[n].offset,fp);
+//				chunk.read_vector(&pm->submodel[n].norm);
+//				d = chunk.read_float();				
+//				chunk.read_vector(&pm->submodel[n].pnt);
+				chunk.read_vector(&pm->submodel[n].offset);
 
 //			mprintf(( "Subobj %d, offs = %.1f, %.1f, %.1f\n", n, pm->submodel[n].offset.xyz.x, pm->submodel[n].offset.xyz.y, pm->submodel[n].offset.xyz.z ));
 	
 #if defined ( FREESPACE1_FORMAT )
-				pm->submodel[n].rad = cfread_float(fp);		//radius
+				pm->submodel[n].rad = chunk.read_float();		//radius
 #endif
 
-//				pm->submodel[n].tree_offset = cfread_int(fp);	//offset
-//				pm->submodel[n].data_offset = cfread_int(fp);	//offset
+//				pm->submodel[n].tree_offset = chunk.read_int();	//offset
+//				pm->submodel[n].data_offset = chunk.read_int();	//offset
 
-				cfread_vector(&pm->submodel[n].geometric_center,fp);
+				chunk.read_vector(&pm->submodel[n].geometric_center);
 
-				cfread_vector(&pm->submodel[n].min,fp);
-				cfread_vector(&pm->submodel[n].max,fp);
+				chunk.read_vector(&pm->submodel[n].min);
+				chunk.read_vector(&pm->submodel[n].max);
 
 				pm->submodel[n].name[0] = '\0';
 
-				cfread_string_len(pm->submodel[n].name, MAX_NAME_LEN, fp);		// get the name
-				cfread_string_len(props, MAX_PROP_LEN, fp);			// and the user properties
+				chunk.read_string_len(pm->submodel[n].name, MAX_NAME_LEN);		// get the name
+				chunk.read_string_len(props, MAX_PROP_LEN);			// and the user properties
 
 				// Check for unrealistic radii
 				if ( pm->submodel[n].rad <= 0.1f )
@@ -1337,8 +1461,8 @@ int read_model_file(polymodel * pm, const char *filename, int n_subsystems, mode
 				}
 				model_calc_bound_box(pm->submodel[n].bounding_box, &pm->submodel[n].min, &pm->submodel[n].max);
 
-				pm->submodel[n].movement_type = cfread_int(fp);
-				pm->submodel[n].movement_axis = cfread_int(fp);
+				pm->submodel[n].movement_type = chunk.read_int();
+				pm->submodel[n].movement_axis = chunk.read_int();
 
 				// change turret movement type to MOVEMENT_TYPE_ROT_SPECIAL
 				if ( strstr(pm->submodel[n].name, "turret") || strstr(pm->submodel[n].name, "gun") || strstr(pm->submodel[n].name, "cannon")) {
@@ -1684,15 +1808,15 @@ int read_model_file(polymodel * pm, const char *filename, int n_subsystems, mode
 				pm->submodel[n].angs.h = 0.0f;
 
 				{
-					int nchunks = cfread_int( fp );		// Throw away nchunks
+					int nchunks = chunk.read_int();		// Throw away nchunks
 					if ( nchunks > 0 )	{
 						Error( LOCATION, "Model '%s' is chunked.  See John or Adam!\n", pm->filename );
 					}
 				}
-				pm->submodel[n].bsp_data_size = cfread_int(fp);
+				pm->submodel[n].bsp_data_size = chunk.read_int();
 				if ( pm->submodel[n].bsp_data_size > 0 )	{
 					pm->submodel[n].bsp_data = (ubyte *)vm_malloc(pm->submodel[n].bsp_data_size);
-					cfread(pm->submodel[n].bsp_data,1,pm->submodel[n].bsp_data_size,fp);
+					chunk.read_bytes(pm->submodel[n].bsp_data, pm->submodel[n].bsp_data_size);
 					swap_bsp_data( pm, pm->submodel[n].bsp_data );
 				} else {
 					pm->submodel[n].bsp_data = NULL;
@@ -1728,9 +1852,9 @@ int read_model_file(polymodel * pm, const char *filename, int n_subsystems, mode
 
 			case ID_SLDC: // kazan - Shield Collision tree
 				{
-					pm->sldc_size = cfread_int(fp);
+					pm->sldc_size = chunk.read_int();
 					pm->shield_collision_tree = (ubyte *)vm_malloc(pm->sldc_size);
-					cfread(pm->shield_collision_tree,1,pm->sldc_size,fp);
+					chunk.read_bytes(pm->shield_collision_tree, pm->sldc_size);
 					swap_sldc_data(pm->shield_collision_tree);
 					//mprintf(( "Shield Collision Tree, %d bytes in size\n", pm->sldc_size));
 				}
@@ -1738,27 +1862,27 @@ int read_model_file(polymodel * pm, const char *filename, int n_subsystems, mode
 
 			case ID_SHLD:
 				{
-					pm->shield.nverts = cfread_int( fp );		// get the number of vertices in the list
+					pm->shield.nverts = chunk.read_int();		// get the number of vertices in the list
 
 					if (pm->shield.nverts > 0) {
 						pm->shield.verts = (shield_vertex *)vm_malloc(pm->shield.nverts * sizeof(shield_vertex) );
 						Assert( pm->shield.verts );
 						for ( i = 0; i < pm->shield.nverts; i++ ) {						// read in the vertex list
-							cfread_vector( &(pm->shield.verts[i].pos), fp );
+							chunk.read_vector(&(pm->shield.verts[i].pos));
 						}
 					}
 
-					pm->shield.ntris = cfread_int( fp );		// get the number of triangles that compose the shield
+					pm->shield.ntris = chunk.read_int();		// get the number of triangles that compose the shield
 
 					if (pm->shield.ntris > 0) {
 						pm->shield.tris = (shield_tri *)vm_malloc(pm->shield.ntris * sizeof(shield_tri) );
 						Assert( pm->shield.tris );
 						for ( i = 0; i < pm->shield.ntris; i++ ) {
-							cfread_vector( &temp_vec, fp );
+							chunk.read_vector(&temp_vec);
 							vm_vec_normalize_safe(&temp_vec);
 							pm->shield.tris[i].norm = temp_vec;
 							for ( j = 0; j < 3; j++ ) {
-								pm->shield.tris[i].verts[j] = cfread_int( fp );		// read in the indices into the shield_vertex list
+								pm->shield.tris[i].verts[j] = chunk.read_int();		// read in the indices into the shield_vertex list
 #ifndef NDEBUG
 								if (pm->shield.tris[i].verts[j] >= pm->shield.nverts) {
 									Error(LOCATION, "Ship %s has a bogus shield mesh.\nOnly %i vertices, index %i found.\n", filename, pm->shield.nverts, pm->shield.tris[i].verts[j]);
@@ -1767,7 +1891,7 @@ int read_model_file(polymodel * pm, const char *filename, int n_subsystems, mode
 							}
 							
 							for ( j = 0; j < 3; j++ ) {
-								pm->shield.tris[i].neighbors[j] = cfread_int( fp );	// read in the neighbor indices -- indexes into tri list
+								pm->shield.tris[i].neighbors[j] = chunk.read_int();	// read in the neighbor indices -- indexes into tri list
 #ifndef NDEBUG
 								if (pm->shield.tris[i].neighbors[j] >= pm->shield.ntris) {
 									Error(LOCATION, "Ship %s has a bogus shield mesh.\nOnly %i triangles, index %i found.\n", filename, pm->shield.ntris, pm->shield.tris[i].neighbors[j]);
@@ -1780,7 +1904,7 @@ int read_model_file(polymodel * pm, const char *filename, int n_subsystems, mode
 				break;
 
 			case ID_GPNT:
-				pm->n_guns = cfread_int(fp);
+				pm->n_guns = chunk.read_int();
 
 				if (pm->n_guns > 0) {
 					pm->gun_banks = (w_bank *)vm_malloc(sizeof(w_bank) * pm->n_guns);
@@ -1789,11 +1913,11 @@ int read_model_file(polymodel * pm, const char *filename, int n_subsystems, mode
 					for (i = 0; i < pm->n_guns; i++ ) {
 						w_bank *bank = &pm->gun_banks[i];
 
-						bank->num_slots = cfread_int(fp);
+						bank->num_slots = chunk.read_int();
 						Assert ( bank->num_slots < MAX_SLOTS );
 						for (j = 0; j < bank->num_slots; j++) {
-							cfread_vector( &(bank->pnt[j]), fp );
-							cfread_vector( &temp_vec, fp );
+							chunk.read_vector(&(bank->pnt[j]));
+							chunk.read_vector(&temp_vec);
 							vm_vec_normalize_safe(&temp_vec);
 							bank->norm[j] = temp_vec;
 						}
@@ -1802,7 +1926,7 @@ int read_model_file(polymodel * pm, const char *filename, int n_subsystems, mode
 				break;
 			
 			case ID_MPNT:
-				pm->n_missiles = cfread_int(fp);
+				pm->n_missiles = chunk.read_int();
 
 				if (pm->n_missiles > 0) {
 					pm->missile_banks = (w_bank *)vm_malloc(sizeof(w_bank) * pm->n_missiles);
@@ -1811,11 +1935,11 @@ int read_model_file(polymodel * pm, const char *filename, int n_subsystems, mode
 					for (i = 0; i < pm->n_missiles; i++ ) {
 						w_bank *bank = &pm->missile_banks[i];
 
-						bank->num_slots = cfread_int(fp);
+						bank->num_slots = chunk.read_int();
 						Assert ( bank->num_slots < MAX_SLOTS );
 						for (j = 0; j < bank->num_slots; j++) {
-							cfread_vector( &(bank->pnt[j]), fp );
-							cfread_vector( &temp_vec, fp );
+							chunk.read_vector(&(bank->pnt[j]));
+							chunk.read_vector(&temp_vec);
 							vm_vec_normalize_safe(&temp_vec);
 							bank->norm[j] = temp_vec;
 						}
@@ -1826,7 +1950,7 @@ int read_model_file(polymodel * pm, const char *filename, int n_subsystems, mode
 			case ID_DOCK: {
 				char props[MAX_PROP_LEN];
 
-				pm->n_docks = cfread_int(fp);
+				pm->n_docks = chunk.read_int();
 
 				if (pm->n_docks > 0) {
 					pm->docking_bays = (dock_bay *)vm_malloc(sizeof(dock_bay) * pm->n_docks);
@@ -1836,7 +1960,7 @@ int read_model_file(polymodel * pm, const char *filename, int n_subsystems, mode
 						char *p;
 						dock_bay *bay = &pm->docking_bays[i];
 
-						cfread_string_len( props, MAX_PROP_LEN, fp );
+						chunk.read_string_len(props, MAX_PROP_LEN);
 						if ( (p = strstr(props, "$name"))!= NULL ) {
 							get_user_prop_value(p+5, bay->name);
 
@@ -1853,11 +1977,11 @@ int read_model_file(polymodel * pm, const char *filename, int n_subsystems, mode
 							sprintf(bay->name, "<unnamed bay %c>", 'A' + i);
 						}
 
-						bay->num_spline_paths = cfread_int( fp );
+						bay->num_spline_paths = chunk.read_int();
 						if ( bay->num_spline_paths > 0 ) {
 							bay->splines = (int *)vm_malloc(sizeof(int) * bay->num_spline_paths);
 							for ( j = 0; j < bay->num_spline_paths; j++ )
-								bay->splines[j] = cfread_int(fp);
+								bay->splines[j] = chunk.read_int();
 						} else {
 							bay->splines = NULL;
 						}
@@ -1868,15 +1992,15 @@ int read_model_file(polymodel * pm, const char *filename, int n_subsystems, mode
 						else
 							bay->type_flags = (DOCK_TYPE_REARM | DOCK_TYPE_GENERIC);
 
-						bay->num_slots = cfread_int(fp);
+						bay->num_slots = chunk.read_int();
 
 						if(bay->num_slots != 2) {
 							Warning(LOCATION, "Model '%s' has %d slots in dock point '%s'; models must have exactly %d slots per dock point.", filename, bay->num_slots, bay->name, 2);
 						}
 
 						for (j = 0; j < bay->num_slots; j++) {
-							cfread_vector( &(bay->pnt[j]), fp );
-							cfread_vector( &(bay->norm[j]), fp );
+							chunk.read_vector(&(bay->pnt[j]));
+							chunk.read_vector(&(bay->norm[j]));
 							if(vm_vec_mag(&(bay->norm[j])) <= 0.0f) {
 								Warning(LOCATION, "Model '%s' dock point '%s' has a null normal. ", filename, bay->name);
 							}
@@ -1913,7 +2037,7 @@ int read_model_file(polymodel * pm, const char *filename, int n_subsystems, mode
 			{
 				char props[MAX_PROP_LEN];
 
-				int gpb_num = cfread_int(fp);
+				int gpb_num = chunk.read_int();
 
 				pm->n_glow_point_banks = gpb_num;
 				pm->glow_point_banks = NULL;
@@ -1930,13 +2054,13 @@ int read_model_file(polymodel * pm, const char *filename, int n_subsystems, mode
 
 					bank->is_on = true;
 					bank->glow_timestamp = 0;
-					bank->disp_time = cfread_int(fp);
-					bank->on_time = cfread_int(fp);
-					bank->off_time = cfread_int(fp);
-					bank->submodel_parent = cfread_int(fp);
-					bank->LOD = cfread_int(fp);
-					bank->type = cfread_int(fp);
-					bank->num_points = cfread_int(fp);
+					bank->disp_time = chunk.read_int();
+					bank->on_time = chunk.read_int();
+					bank->off_time = chunk.read_int();
+					bank->submodel_parent = chunk.read_int();
+					bank->LOD = chunk.read_int();
+					bank->type = chunk.read_int();
+					bank->num_points = chunk.read_int();
 					bank->points = NULL;
 
 					if (bank->num_points > 0)
@@ -1945,7 +2069,7 @@ int read_model_file(polymodel * pm, const char *filename, int n_subsystems, mode
 					//if((bank->off_time > 0) && (bank->disp_time > 0))
 						//bank->is_on = false;
 	
-					cfread_string_len(props, MAX_PROP_LEN, fp);
+					chunk.read_string_len(props, MAX_PROP_LEN);
 					// look for $glow_texture=xxx
 					auto length = strlen(props);
 
@@ -1996,14 +2120,14 @@ int read_model_file(polymodel * pm, const char *filename, int n_subsystems, mode
 					{
 						glow_point *p = &bank->points[j];
 
-						cfread_vector(&(p->pnt), fp);
-						cfread_vector( &temp_vec, fp );
+						chunk.read_vector(&(p->pnt));
+						chunk.read_vector(&temp_vec);
 						if (!IS_VEC_NULL_SQ_SAFE(&temp_vec))
 							vm_vec_normalize(&temp_vec);
 						else
 							vm_vec_zero(&temp_vec);
 						p->norm = temp_vec;
-						p->radius = cfread_float( fp);
+						p->radius = chunk.read_float();
 					}
 				}
 				break;					
@@ -2011,7 +2135,7 @@ int read_model_file(polymodel * pm, const char *filename, int n_subsystems, mode
 
 			case ID_FUEL:
 				char props[MAX_PROP_LEN];
-				pm->n_thrusters = cfread_int(fp);
+				pm->n_thrusters = chunk.read_int();
 
 				if (pm->n_thrusters > 0) {
 					pm->thrusters = (thruster_bank *)vm_malloc(sizeof(thruster_bank) * pm->n_thrusters);
@@ -2020,7 +2144,7 @@ int read_model_file(polymodel * pm, const char *filename, int n_subsystems, mode
 					for (i = 0; i < pm->n_thrusters; i++ ) {
 						thruster_bank *bank = &pm->thrusters[i];
 
-						bank->num_points = cfread_int(fp);
+						bank->num_points = chunk.read_int();
 						bank->points = NULL;
 
 						if (bank->num_points > 0)
@@ -2032,7 +2156,7 @@ int read_model_file(polymodel * pm, const char *filename, int n_subsystems, mode
 						if (pm->version < 2117) {
 							bank->wash_info_pointer = NULL;
 						} else {
-							cfread_string_len( props, MAX_PROP_LEN, fp );
+							chunk.read_string_len(props, MAX_PROP_LEN);
 							// look for $engine_subsystem=xxx
 							auto length = strlen(props);
 							if (length > 0) {
@@ -2081,13 +2205,13 @@ int read_model_file(polymodel * pm, const char *filename, int n_subsystems, mode
 						for (j = 0; j < bank->num_points; j++) {
 							glow_point *p = &bank->points[j];
 
-							cfread_vector( &(p->pnt), fp );
-							cfread_vector( &temp_vec, fp );
+							chunk.read_vector(&(p->pnt));
+							chunk.read_vector(&temp_vec);
 							vm_vec_normalize_safe(&temp_vec);
 							p->norm = temp_vec;
 
 							if ( pm->version > 2004 )	{
-								p->radius = cfread_float( fp );
+								p->radius = chunk.read_float();
 								//mprintf(( "Rad = %.2f\n", rad ));
 							} else {
 								p->radius = 1.0f;
@@ -2100,7 +2224,7 @@ int read_model_file(polymodel * pm, const char *filename, int n_subsystems, mode
 
 			case ID_TGUN:
 			case ID_TMIS: {
-				int n_banks = cfread_int(fp);			// Number of turrets
+				int n_banks = chunk.read_int();			// Number of turrets
 
 				for ( i = 0; i < n_banks; i++ ) {
 					int parent;							// The parent subobj of the turret (the gun base)
@@ -2108,8 +2232,8 @@ int read_model_file(polymodel * pm, const char *filename, int n_subsystems, mode
 					int n_slots;						// How many firepoints the turret has
 					model_subsystem *subsystemp;		// The actual turret subsystem
 
-					parent = cfread_int( fp );
-					physical_parent = cfread_int(fp);
+					parent = chunk.read_int();
+					physical_parent = chunk.read_int();
 
 					int snum=-1;
 					if ( subsystems ) {
@@ -2117,12 +2241,12 @@ int read_model_file(polymodel * pm, const char *filename, int n_subsystems, mode
 							subsystemp = &subsystems[snum];
 
 							if ( parent == subsystemp->subobj_num ) {
-								cfread_vector( &temp_vec, fp );
+								chunk.read_vector(&temp_vec);
 								vm_vec_normalize_safe(&temp_vec);
 								subsystemp->turret_norm = temp_vec;
 								vm_vector_2_matrix(&subsystemp->turret_matrix,&subsystemp->turret_norm,NULL,NULL);
 
-								n_slots = cfread_int( fp );
+								n_slots = chunk.read_int();
 								subsystemp->turret_gun_sobj = physical_parent;
 								if(n_slots > MAX_TFP) {
 									Warning(LOCATION, "Model %s has %i turret firing points on subsystem %s, maximum is %i", pm->filename, n_slots, subsystemp->name, MAX_TFP);
@@ -2130,11 +2254,11 @@ int read_model_file(polymodel * pm, const char *filename, int n_subsystems, mode
 
 								for (j = 0; j < n_slots; j++ )	{
 									if(j < MAX_TFP)
-										cfread_vector( &subsystemp->turret_firing_point[j], fp );
+										chunk.read_vector(&subsystemp->turret_firing_point[j]);
 									else
 									{
 										vec3d bogus;
-										cfread_vector(&bogus, fp);
+										chunk.read_vector(&bogus);
 									}
 								}
 								Assertion( n_slots > 0, "Turret %s in model %s has no firing points.\n", subsystemp->name, pm->filename);
@@ -2150,10 +2274,10 @@ int read_model_file(polymodel * pm, const char *filename, int n_subsystems, mode
 						vec3d bogus;
 
 						nprintf(("Warning", "Turret submodel %i not found for turret %i in model %s\n", parent, i, pm->filename));
-						cfread_vector( &bogus, fp );
-						n_slots = cfread_int( fp );
+						chunk.read_vector(&bogus);
+						n_slots = chunk.read_int();
 						for (j = 0; j < n_slots; j++ )
-							cfread_vector( &bogus, fp );
+							chunk.read_vector(&bogus);
 					}
 				}
 				break;
@@ -2165,16 +2289,16 @@ int read_model_file(polymodel * pm, const char *filename, int n_subsystems, mode
 				float radius;
 				vec3d pnt;
 
-				n_specials = cfread_int(fp);		// get the number of special subobjects we have
+				n_specials = chunk.read_int();		// get the number of special subobjects we have
 				for (i = 0; i < n_specials; i++) {
 
 					// get the next free object of the subobject list.  Flag error if no more room
 
-					cfread_string_len(name, MAX_NAME_LEN, fp);			// get the name of this special polygon
+					chunk.read_string_len(name, MAX_NAME_LEN);			// get the name of this special polygon
 
-					cfread_string_len(props_spcl, MAX_PROP_LEN, fp);		// will definately have properties as well!
-					cfread_vector( &pnt, fp );
-					radius = cfread_float( fp );
+					chunk.read_string_len(props_spcl, MAX_PROP_LEN);		// will definately have properties as well!
+					chunk.read_vector(&pnt);
+					radius = chunk.read_float();
 
 					// check if $Split
 					p = strstr(name, "$split");
@@ -2207,7 +2331,7 @@ int read_model_file(polymodel * pm, const char *filename, int n_subsystems, mode
 				//mprintf(0,"Got chunk TXTR, len=%d\n",len);
 
 
-				n = cfread_int(fp);
+				n = chunk.read_int();
 				pm->n_textures = n;
 				// Don't overwrite memory!!
 				Verify(pm->n_textures <= MAX_MODEL_TEXTURES);
@@ -2215,7 +2339,7 @@ int read_model_file(polymodel * pm, const char *filename, int n_subsystems, mode
 				for (i=0; i<n; i++ )
 				{
 					char tmp_name[256];
-					cfread_string_len(tmp_name,127,fp);
+					chunk.read_string_len(tmp_name, 127);
 					model_load_texture(pm, i, tmp_name);
 					//mprintf(0,"<%s>\n",name_buf);
 				}
@@ -2231,7 +2355,7 @@ int read_model_file(polymodel * pm, const char *filename, int n_subsystems, mode
 				pm->model_data_size = len;
 				Assert(pm->model_data != NULL );
 			
-				cfread(pm->model_data,1,len,fp);
+				chunk.read_bytes(pm->model_data, len);
 			
 				break;
 */
@@ -2243,7 +2367,7 @@ int read_model_file(polymodel * pm, const char *filename, int n_subsystems, mode
 					pm->debug_info = (char *)vm_malloc(pm->debug_info_size+1);
 					Assert(pm->debug_info!=NULL);
 					memset(pm->debug_info,0,len+1);
-					cfread( pm->debug_info, 1, len, fp );
+					chunk.read_bytes(pm->debug_info, len);
 				#endif
 				break;
 
@@ -2251,7 +2375,7 @@ int read_model_file(polymodel * pm, const char *filename, int n_subsystems, mode
 				break;
 
 			case ID_PATH:
-				pm->n_paths = cfread_int( fp );
+				pm->n_paths = chunk.read_int();
 
 				if (pm->n_paths <= 0) {
 					break;
@@ -2263,10 +2387,10 @@ int read_model_file(polymodel * pm, const char *filename, int n_subsystems, mode
 				memset( pm->paths, 0, sizeof(model_path) * pm->n_paths );
 					
 				for (i=0; i<pm->n_paths; i++ )	{
-					cfread_string_len(pm->paths[i].name , MAX_NAME_LEN-1, fp);
+					chunk.read_string_len(pm->paths[i].name, MAX_NAME_LEN-1);
 					if ( pm->version >= 2002 ) {
 						// store the sub_model name number of the parent
-						cfread_string_len(pm->paths[i].parent_name , MAX_NAME_LEN-1, fp);
+						chunk.read_string_len(pm->paths[i].parent_name, MAX_NAME_LEN-1);
 						// get rid of leading '$' char in name
 						if ( pm->paths[i].parent_name[0] == '$' ) {
 							char tmpbuf[MAX_NAME_LEN];
@@ -2285,7 +2409,7 @@ int read_model_file(polymodel * pm, const char *filename, int n_subsystems, mode
 						pm->paths[i].parent_submodel = -1;
 					}
 
-					pm->paths[i].nverts = cfread_int( fp );
+					pm->paths[i].nverts = chunk.read_int();
 					pm->paths[i].verts = (mp_vert *)vm_malloc( sizeof(mp_vert) * pm->paths[i].nverts );
 					pm->paths[i].goal = pm->paths[i].nverts - 1;
 					pm->paths[i].type = MP_TYPE_UNUSED;
@@ -2294,19 +2418,19 @@ int read_model_file(polymodel * pm, const char *filename, int n_subsystems, mode
 					memset( pm->paths[i].verts, 0, sizeof(mp_vert) * pm->paths[i].nverts );
 
 					for (j=0; j<pm->paths[i].nverts; j++ )	{
-						cfread_vector(&pm->paths[i].verts[j].pos,fp );
-						pm->paths[i].verts[j].radius = cfread_float( fp );
+						chunk.read_vector(&pm->paths[i].verts[j].pos);
+						pm->paths[i].verts[j].radius = chunk.read_float();
 						
 						{					// version 1802 added turret stuff
 							int nturrets, k;
 
-							nturrets = cfread_int( fp );
+							nturrets = chunk.read_int();
 							pm->paths[i].verts[j].nturrets = nturrets;
 
 							if (nturrets > 0) {
 								pm->paths[i].verts[j].turret_ids = (int *)vm_malloc( sizeof(int) * nturrets );
 								for ( k = 0; k < nturrets; k++ )
-									pm->paths[i].verts[j].turret_ids[k] = cfread_int( fp );
+									pm->paths[i].verts[j].turret_ids[k] = chunk.read_int();
 							}
 						} 
 						
@@ -2321,13 +2445,13 @@ int read_model_file(polymodel * pm, const char *filename, int n_subsystems, mode
 					// all eyes points are stored simply as vectors and their normals.
 					// 0th element is used as usual player view position.
 
-					num_eyes = cfread_int( fp );
+					num_eyes = chunk.read_int();
 					pm->n_view_positions = num_eyes;
 					Assert ( num_eyes < MAX_EYES );
 					for (i = 0; i < num_eyes; i++ ) {
-						pm->view_positions[i].parent = cfread_int( fp );
-						cfread_vector( &pm->view_positions[i].pnt, fp );
-						cfread_vector( &pm->view_positions[i].norm, fp );
+						pm->view_positions[i].parent = chunk.read_int();
+						chunk.read_vector(&pm->view_positions[i].pnt);
+						chunk.read_vector(&pm->view_positions[i].norm);
 					}
 				}
 				break;			
@@ -2336,41 +2460,41 @@ int read_model_file(polymodel * pm, const char *filename, int n_subsystems, mode
 				int num_ins, num_verts, num_faces, idx, idx2, idx3;			
 				
 				// get the # of insignias
-				num_ins = cfread_int(fp);
+				num_ins = chunk.read_int();
 				pm->num_ins = num_ins;
 				
 				// read in the insignias
 				for(idx=0; idx<num_ins; idx++){
 					// get the detail level
-					pm->ins[idx].detail_level = cfread_int(fp);
+					pm->ins[idx].detail_level = chunk.read_int();
 					if (pm->ins[idx].detail_level < 0) {
 						Warning(LOCATION, "Model '%s': insignia uses an invalid LOD (%i)\n", pm->filename, pm->ins[idx].detail_level);
 					}
 
 					// # of faces
-					num_faces = cfread_int(fp);
+					num_faces = chunk.read_int();
 					pm->ins[idx].num_faces = num_faces;
 					Assert(num_faces <= MAX_INS_FACES);
 
 					// # of vertices
-					num_verts = cfread_int(fp);
+					num_verts = chunk.read_int();
 					Assert(num_verts <= MAX_INS_VECS);
 
 					// read in all the vertices
 					for(idx2=0; idx2<num_verts; idx2++){
-						cfread_vector(&pm->ins[idx].vecs[idx2], fp);
+						chunk.read_vector(&pm->ins[idx].vecs[idx2]);
 					}
 
 					// read in world offset
-					cfread_vector(&pm->ins[idx].offset, fp);
+					chunk.read_vector(&pm->ins[idx].offset);
 
 					// read in all the faces
 					for(idx2=0; idx2<pm->ins[idx].num_faces; idx2++){						
 						// read in 3 vertices
 						for(idx3=0; idx3<3; idx3++){
-							pm->ins[idx].faces[idx2][idx3] = cfread_int(fp);
-							pm->ins[idx].u[idx2][idx3] = cfread_float(fp);
-							pm->ins[idx].v[idx2][idx3] = cfread_float(fp);
+							pm->ins[idx].faces[idx2][idx3] = chunk.read_int();
+							pm->ins[idx].u[idx2][idx3] = chunk.read_float();
+							pm->ins[idx].v[idx2][idx3] = chunk.read_float();
 						}
 						vec3d tempv;
 
@@ -2392,13 +2516,12 @@ int read_model_file(polymodel * pm, const char *filename, int n_subsystems, mode
 
 			// autocentering info
 			case ID_ACEN:
-				cfread_vector(&pm->autocenter, fp);
+				chunk.read_vector(&pm->autocenter);
 				pm->flags |= PM_FLAG_AUTOCEN;
 				break;
 
 			default:
 				mprintf(("Unknown chunk <%c%c%c%c>, len = %d\n",id,id>>8,id>>16,id>>24,len));
-				cfseek(fp,len,SEEK_CUR);
 				break;
 
 		}
@@ -2582,6 +2705,8 @@ void model_load_texture(polymodel *pm, int i, char *file)
 		shader_flags |= SDR_FLAG_MODEL_MISC_MAP;
 	if (tambient->GetTexture() >0)
 		shader_flags |= SDR_FLAG_MODEL_AMBIENT_MAP;
+	if ((shader_flags & ~(SDR_FLAG_MODEL_HEIGHT_MAP | SDR_FLAG_MODEL_ENV_MAP)) && gr_is_capable(CAPABILITY_TEXTURE_ARRAYS))
+		shader_flags |= SDR_FLAG_MODEL_TEXTURE_ARRAYS;
 	
 	gr_maybe_create_shader(SDR_TYPE_MODEL, SDR_FLAG_MODEL_SHADOW_MAP);
 
@@ -2615,7 +2740,120 @@ void model_load_texture(polymodel *pm, int i, char *file)
 	}
 }
 
+// The part of loading a model which only reads the BSP data and writes to the model itself. Inside a batch this runs
+// on a job worker.
+static void model_load_process(model_pending_load *load)
+{
+	polymodel *pm = load->pm;
+
+	if ( load->cached ) {
+		return;
+	}
+
+	configure_vertex_buffer(pm);
+
+	if ( !Cmdline_old_collision_sys ) {
+		TRACE_SCOPE(tracing::ModelParseAllBSPTrees);
+
+		load->trees.resize(pm->n_models);
+
+		for ( int i = 0; i < pm->n_models; ++i ) {
+			model_collide_parse_bsp(&load->trees[i], pm->submodel[i].bsp_data, pm->version);
+		}
+	}
+}
+
+// Everything which needs the processed data and can only be done on the main thread
+static void model_load_finish(model_pending_load *load)
+{
+	polymodel *pm = load->pm;
+
+	if ( !load->cached ) {
+		create_vertex_buffer(pm);
+
+		for ( int i = 0; i < (int)load->trees.size(); ++i ) {
+			pm->submodel[i].collision_tree_index = model_create_bsp_collision_tree();
+
+			bsp_collision_tree *tree = model_get_bsp_collision_tree(pm->submodel[i].collision_tree_index);
+			*tree = load->trees[i];
+			tree->used = true;
+		}
+
+		model_cache_save(pm, load->pof_checksum);
+	}
+
+	submit_vertex_buffer(pm);
+}
+
+static void model_finish_pending_loads()
+{
+	if ( Model_pending_loads.empty() ) {
+		return;
+	}
+
+	TRACE_SCOPE(tracing::ModelFinishBatchLoad);
+
+	Model_batch_jobs.wait();
+
+	// in the order the models were loaded so the result is the same as without a batch
+	for ( auto &load : Model_pending_loads ) {
+		model_load_finish(load.get());
+	}
+
+	Model_pending_loads.clear();
+}
+
 //returns the number of this model
+bool model_read_bounding_box(const char *filename, vec3d *mins, vec3d *maxs)
+{
+	auto fp = cfopen(filename, "rb");
+	if (!fp) {
+		return false;
+	}
+
+	bool found = false;
+
+	int version = 0;
+	if (cfread_int(fp) == POF_HEADER_ID) {
+		version = cfread_int(fp);
+	}
+
+	if (version >= PM_COMPATIBLE_VERSION && (version / 100) <= PM_OBJFILE_MAJOR_VERSION) {
+		while (!cfeof(fp)) {
+			int id = cfread_int(fp);
+			int len = cfread_int(fp);
+
+			if (id == ID_OHDR) {
+				// see the header chunk in read_model_file()
+#if defined( FREESPACE1_FORMAT )
+				cfread_int(fp);						// n_models
+				cfread_float(fp);					// rad
+				cfread_int(fp);						// flags
+#elif defined( FREESPACE2_FORMAT )
+				cfread_float(fp);					// rad
+				cfread_int(fp);						// flags
+				cfread_int(fp);						// n_models
+#endif
+				cfread_vector(mins, fp);
+				cfread_vector(maxs, fp);
+
+				maybe_swap_mins_maxs(mins, maxs);
+
+				found = true;
+				break;
+			}
+
+			if (len <= 0 || cfseek(fp, len, SEEK_CUR)) {
+				break;
+			}
+		}
+	}
+
+	cfclose(fp);
+
+	return found;
+}
+
 int model_load(const  char *filename, int n_subsystems, model_subsystem *subsystems, int ferror, int duplicate)
 {
 	int i, num, arc_idx;
@@ -2689,6 +2927,8 @@ int model_load(const  char *filename, int n_subsystems, model_subsystem *subsyst
 		return -1;
 	}
 
+	uint pof_checksum = Global_checksum;
+
 	pm->used_this_mission++;
 
 #ifdef _DEBUG
@@ -2746,8 +2986,7 @@ int model_load(const  char *filename, int n_subsystems, model_subsystem *subsyst
 
 	create_family_tree(pm);
 
-	// maybe generate vertex buffers
-	create_vertex_buffer(pm);
+	bool cached = model_cache_load(pm, pof_checksum);
 
 	//==============================
 	// Find all the lower detail versions of the hires model
@@ -2853,17 +3092,6 @@ int model_load(const  char *filename, int n_subsystems, model_subsystem *subsyst
 
 	model_octant_create( pm );
 
-	if ( !Cmdline_old_collision_sys ) {
-		TRACE_SCOPE(tracing::ModelParseAllBSPTrees);
-
-		for ( i = 0; i < pm->n_models; ++i ) {
-			pm->submodel[i].collision_tree_index = model_create_bsp_collision_tree();
-			bsp_collision_tree *tree = model_get_bsp_collision_tree(pm->submodel[i].collision_tree_index);
-
-			model_collide_parse_bsp(tree, pm->submodel[i].bsp_data, pm->version);
-		}
-	}
-
 	// Find the core_radius... the minimum of 
 	float rx, ry, rz;
 	rx = fl_abs( pm->submodel[pm->detail[0]].max.xyz.x - pm->submodel[pm->detail[0]].min.xyz.x );
@@ -2888,37 +3116,62 @@ int model_load(const  char *filename, int n_subsystems, model_subsystem *subsyst
 	model_set_subsys_path_nums(pm, n_subsystems, subsystems);
 	model_set_bay_path_nums(pm);
 
+	std::unique_ptr<model_pending_load> load(new model_pending_load);
+	load->pm = pm;
+	load->pof_checksum = pof_checksum;
+	load->cached = cached;
+
+	if ( Model_batch_depth > 0 && !cached ) {
+		model_pending_load *job_load = load.get();
+
+		Model_batch_jobs.run([job_load]() { model_load_process(job_load); }, tracing::ModelLoadJob);
+		Model_pending_loads.push_back(std::move(load));
+	} else {
+		model_load_process(load.get());
+		model_load_finish(load.get());
+	}
+
 	return pm->id;
 }
 
+void model_begin_batch_load()
+{
+	++Model_batch_depth;
+}
+
+void model_end_batch_load()
+{
+	Assert( Model_batch_depth > 0 );
+
+	if ( --Model_batch_depth > 0 ) {
+		return;
+	}
+
+	model_finish_pending_loads();
+}
+
 int model_create_instance(bool is_ship, int model_num)
 {
 	int i = 0;
 	int open_slot = -1;
 
-	// go through model instances and find an empty slot
-	for ( i = 0; i < (int)Polygon_model_instances.size(); i++) {
-		if ( !Polygon_model_instances[i] ) {
-			open_slot = i;
-		}
-	}
+	polymodel *pm = model_get(model_num);
 
-	polymodel_instance *pmi = (polymodel_instance*)vm_malloc(sizeof(polymodel_instance));
-	memset(pmi, 0, sizeof(polymodel_instance));
+	polymodel_instance *pmi = model_instance_alloc(pm->n_models);
 	pmi->model_num = model_num;
 
-	// if not found, create a slot
-	if ( open_slot < 0 ) {
+	// if there is no empty slot, create one
+	if ( Polygon_model_instance_free_slots.empty() ) {
 		Polygon_model_instances.push_back( pmi );
 		open_slot = (int)(Polygon_model_instances.size() - 1);
 	} else {
+		open_slot = Polygon_model_instance_free_slots.back();
+		Polygon_model_instance_free_slots.pop_back();
+
+		Assert(Polygon_model_instances[open_slot] == NULL);
 		Polygon_model_instances[open_slot] = pmi;
 	}
 
-	polymodel *pm = model_get(model_num);
-
-	pmi->submodel = (submodel_instance*)vm_malloc( sizeof(submodel_instance)*pm->n_models );
-
 	for ( i = 0; i < pm->n_models; i++ ) {
 		model_clear_submodel_instance( &pmi->submodel[i], &pm->submodel[i] );
 	}
@@ -2951,13 +3204,10 @@ void model_delete_instance(int model_instance_num)
 
 	polymodel_instance *pmi = Polygon_model_instances[model_instance_num];
 
-	if ( pmi->submodel ) {
-		vm_free(pmi->submodel);
-	}
-
-	vm_free(pmi);
+	model_instance_release(pmi);
 
 	Polygon_model_instances[model_instance_num] = NULL;
+	Polygon_model_instance_free_slots.push_back(model_instance_num);
 
 	// delete intrinsic rotations associated with this instance
 	for (auto intrinsic_it = Intrinsic_rotations.begin(); intrinsic_it != Intrinsic_rotations.end(); ++intrinsic_it) {
@@ -3465,16 +3715,7 @@ void model_instance_find_obj_dir(vec3d *w_vec, vec3d *m_vec, int model_instance_
 
 	// instance up the tree for this point
 	while ( (mn >= 0) && (pm->submodel[mn].parent >= 0) ) {
-		// By using this kind of computation, the rotational angles can always
-		// be computed relative to the submodel itself, instead of relative
-		// to the parent - KeldorKatarn
-		matrix rotation_matrix = pm->submodel[mn].orientation;
-		vm_rotate_matrix_by_angles(&rotation_matrix, &pmi->submodel[mn].angs);
-
-		matrix inv_orientation;
-		vm_copy_transpose(&inv_orientation, &pm->submodel[mn].orientation);
-
-		vm_matrix_x_matrix(&m, &rotation_matrix, &inv_orientation);
+		model_instance_get_local_orient(&m, pm, pmi, mn);
 
 		vm_vec_unrotate(&tvec, &vec, &m);
 		vec = tvec;
@@ -4185,16 +4426,7 @@ void model_instance_find_world_point(vec3d *outpnt, vec3d *mpnt, int model_insta
 
 	//instance up the tree for this point
 	while ( (mn >= 0) && (pm->submodel[mn].parent >= 0) ) {
-		// By using this kind of computation, the rotational angles can always
-		// be computed relative to the submodel itself, instead of relative
-		// to the parent - KeldorKatarn
-		matrix rotation_matrix = pm->submodel[mn].orientation;
-		vm_rotate_matrix_by_angles(&rotation_matrix, &pmi->submodel[mn].angs);
-
-		matrix inv_orientation;
-		vm_copy_transpose(&inv_orientation, &pm->submodel[mn].orientation);
-
-		vm_matrix_x_matrix(&m, &rotation_matrix, &inv_orientation);
+		model_instance_get_local_orient(&m, pm, pmi, mn);
 
 		vm_vec_unrotate(&tpnt, &pnt, &m);
 
@@ -4272,16 +4504,7 @@ void world_find_model_instance_point(vec3d *out, vec3d *world_pt, const polymode
 	// put into submodel RF
 	vm_vec_sub2(&tempv2, &pm->submodel[submodel_num].offset);
 
-	// By using this kind of computation, the rotational angles can always
-	// be computed relative to the submodel itself, instead of relative
-	// to the parent - KeldorKatarn
-	matrix rotation_matrix = pm->submodel[submodel_num].orientation;
-	vm_rotate_matrix_by_angles(&rotation_matrix, &pmi->submodel[submodel_num].angs);
-
-	matrix inv_orientation;
-	vm_copy_transpose(&inv_orientation, &pm->submodel[submodel_num].orientation);
-
-	vm_matrix_x_matrix(&m, &rotation_matrix, &inv_orientation);
+	model_instance_get_local_orient(&m, pm, pmi, submodel_num);
 
 	vm_vec_rotate(out, &tempv2, &m);
 }
@@ -4297,7 +4520,7 @@ void world_find_model_instance_point(vec3d *out, vec3d *world_pt, const polymode
 void find_submodel_instance_point(vec3d *outpnt, int model_instance_num, int submodel_num)
 {
 	vm_vec_zero(outpnt);
-	matrix submodel_instance_matrix, rotation_matrix, inv_orientation;
+	matrix submodel_instance_matrix;
 
 	polymodel_instance *pmi = model_get_instance(model_instance_num);
 	polymodel *pm = model_get(pmi->model_num);
@@ -4309,12 +4532,7 @@ void find_submodel_instance_point(vec3d *outpnt, int model_instance_num, int sub
 		int parent_mn = pm->submodel[mn].parent;
 
 		if (pm->submodel[parent_mn].can_move) {
-			rotation_matrix = pm->submodel[parent_mn].orientation;
-			vm_rotate_matrix_by_angles(&rotation_matrix, &pmi->submodel[parent_mn].angs);
-
-			vm_copy_transpose(&inv_orientation, &pm->submodel[parent_mn].orientation);
-
-			vm_matrix_x_matrix(&submodel_instance_matrix, &rotation_matrix, &inv_orientation);
+			model_instance_get_local_orient(&submodel_instance_matrix, pm, pmi, parent_mn);
 
 			vec3d tvec = offset;
 			vm_vec_unrotate(&offset, &tvec, &submodel_instance_matrix);
@@ -4342,7 +4560,7 @@ void find_submodel_instance_point_normal(vec3d *outpnt, vec3d *outnorm, int mode
 {
 	*outnorm = *submodel_norm;
 	vm_vec_zero(outpnt);
-	matrix submodel_instance_matrix, rotation_matrix, inv_orientation;
+	matrix submodel_instance_matrix;
 
 	polymodel_instance *pmi = model_get_instance(model_instance_num);
 	polymodel *pm = model_get(pmi->model_num);
@@ -4354,12 +4572,7 @@ void find_submodel_instance_point_normal(vec3d *outpnt, vec3d *outnorm, int mode
 		if ( mn == submodel_num) {
 			vec3d submodel_pnt_offset = *submodel_pnt;
 
-			rotation_matrix = pm->submodel[submodel_num].orientation;
-			vm_rotate_matrix_by_angles(&rotation_matrix, &pmi->submodel[submodel_num].angs);
-
-			vm_copy_transpose(&inv_orientation, &pm->submodel[submodel_num].orientation);
-
-			vm_matrix_x_matrix(&submodel_instance_matrix, &rotation_matrix, &inv_orientation);
+			model_instance_get_local_orient(&submodel_instance_matrix, pm, pmi, submodel_num);
 
 			vec3d tvec = submodel_pnt_offset;
 			vm_vec_unrotate(&submodel_pnt_offset, &tvec, &submodel_instance_matrix);
@@ -4372,12 +4585,7 @@ void find_submodel_instance_point_normal(vec3d *outpnt, vec3d *outnorm, int mode
 
 		int parent_model_num = pm->submodel[mn].parent;
 
-		rotation_matrix = pm->submodel[parent_model_num].orientation;
-		vm_rotate_matrix_by_angles(&rotation_matrix, &pmi->submodel[parent_model_num].angs);
-
-		vm_copy_transpose(&inv_orientation, &pm->submodel[parent_model_num].orientation);
-
-		vm_matrix_x_matrix(&submodel_instance_matrix, &rotation_matrix, &inv_orientation);
+		model_instance_get_local_orient(&submodel_instance_matrix, pm, pmi, parent_model_num);
 
 		vec3d tvec = offset;
 		vm_vec_unrotate(&offset, &tvec, &submodel_instance_matrix);
@@ -4410,7 +4618,7 @@ void find_submodel_instance_point_orient(vec3d *outpnt, matrix *outorient, int m
 {
 	*outorient = *submodel_orient;
 	vm_vec_zero(outpnt);
-	matrix submodel_instance_matrix, rotation_matrix, inv_orientation;
+	matrix submodel_instance_matrix;
 
 	polymodel_instance *pmi = model_get_instance(model_instance_num);
 	polymodel *pm = model_get(pmi->model_num);
@@ -4422,12 +4630,7 @@ void find_submodel_instance_point_orient(vec3d *outpnt, matrix *outorient, int m
 		if ( mn == submodel_num) {
 			vec3d submodel_pnt_offset = *submodel_pnt;
 
-			rotation_matrix = pm->submodel[submodel_num].orientation;
-			vm_rotate_matrix_by_angles(&rotation_matrix, &pmi->submodel[submodel_num].angs);
-
-			vm_copy_transpose(&inv_orientation, &pm->submodel[submodel_num].orientation);
-
-			vm_matrix_x_matrix(&submodel_instance_matrix, &rotation_matrix, &inv_orientation);
+			model_instance_get_local_orient(&submodel_instance_matrix, pm, pmi, submodel_num);
 
 			vec3d tvec = submodel_pnt_offset;
 			vm_vec_unrotate(&submodel_pnt_offset, &tvec, &submodel_instance_matrix);
@@ -4440,12 +4643,7 @@ void find_submodel_instance_point_orient(vec3d *outpnt, matrix *outorient, int m
 
 		int parent_model_num = pm->submodel[mn].parent;
 
-		rotation_matrix = pm->submodel[parent_model_num].orientation;
-		vm_rotate_matrix_by_angles(&rotation_matrix, &pmi->submodel[parent_model_num].angs);
-
-		vm_copy_transpose(&inv_orientation, &pm->submodel[parent_model_num].orientation);
-
-		vm_matrix_x_matrix(&submodel_instance_matrix, &rotation_matrix, &inv_orientation);
+		model_instance_get_local_orient(&submodel_instance_matrix, pm, pmi, parent_model_num);
 
 		vec3d tvec = offset;
 		vm_vec_unrotate(&offset, &tvec, &submodel_instance_matrix);
@@ -4637,16 +4835,7 @@ void model_instance_find_world_dir(vec3d *out_dir, vec3d *in_dir, int model_inst
 
 	//instance up the tree for this point
 	while ( (mn >= 0) && (pm->submodel[mn].parent >= 0) ) {
-		// By using this kind of computation, the rotational angles can always
-		// be computed relative to the submodel itself, instead of relative
-		// to the parent - KeldorKatarn
-		matrix rotation_matrix = pm->submodel[mn].orientation;
-		vm_rotate_matrix_by_angles(&rotation_matrix, &pmi->submodel[mn].angs);
-
-		matrix inv_orientation;
-		vm_copy_transpose(&inv_orientation, &pm->submodel[mn].orientation);
-
-		vm_matrix_x_matrix(&m, &rotation_matrix, &inv_orientation);
+		model_instance_get_local_orient(&m, pm, pmi, mn);
 
 		vm_vec_unrotate(&tpnt, &pnt, &m);
 		pnt = tpnt;
@@ -4730,6 +4919,50 @@ void model_clear_submodel_instance( submodel_instance *sm_instance, bsp_info *sm
 
 	sm_instance->collision_checked = false;
 	sm_instance->sii = NULL;
+
+	sm_instance->local_orient_valid = false;
+}
+
+void model_instance_get_local_orient(matrix *out, polymodel *pm, const polymodel_instance *pmi, int submodel_num, const angles *angs)
+{
+	Assert( (submodel_num >= 0) && (submodel_num < pm->n_models) );
+
+	bsp_info *sm = &pm->submodel[submodel_num];
+	submodel_instance *smi = (pmi != NULL) ? &pmi->submodel[submodel_num] : NULL;
+
+	if ( angs == NULL ) {
+		angs = (smi != NULL) ? &smi->angs : &sm->angs;
+	}
+
+	if ( smi != NULL && smi->local_orient_valid && smi->local_angs.p == angs->p && smi->local_angs.b == angs->b
+		&& smi->local_angs.h == angs->h ) {
+		*out = smi->local_orient;
+		return;
+	}
+
+	matrix tm = IDENTITY_MATRIX;
+
+	if ( vm_matrix_same(&tm, &sm->orientation) ) {
+		// if submodel orientation matrix is identity matrix then don't bother with matrix ops
+		vm_angles_2_matrix(out, angs);
+	} else {
+		// By using this kind of computation, the rotational angles can always
+		// be computed relative to the submodel itself, instead of relative
+		// to the parent - KeldorKatarn
+		matrix rotation_matrix = sm->orientation;
+		vm_rotate_matrix_by_angles(&rotation_matrix, angs);
+
+		matrix inv_orientation;
+		vm_copy_transpose(&inv_orientation, &sm->orientation);
+
+		vm_matrix_x_matrix(out, &rotation_matrix, &inv_orientation);
+	}
+
+	if ( smi != NULL ) {
+		smi->local_angs = *angs;
+		smi->local_orient = *out;
+		smi->local_orient_valid = true;
+	}
 }
 
 void model_clear_submodel_instances( int model_instance_num )
@@ -5251,6 +5484,10 @@ void model_remove_bsp_collision_tree(int tree_index)
 	if ( Bsp_collision_tree_list[tree_index].leaf_list ) {
 		vm_free(Bsp_collision_tree_list[tree_index].leaf_list);
 	}
+
+	if ( Bsp_collision_tree_list[tree_index].bvh_list ) {
+		vm_free(Bsp_collision_tree_list[tree_index].bvh_list);
+	}
 	
 	if ( Bsp_collision_tree_list[tree_index].point_list ) {
 		vm_free( Bsp_collision_tree_list[tree_index].point_list );
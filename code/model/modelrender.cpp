@@ -9,11 +9,18 @@
 
 #include <algorithm>
 
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+	#include <xmmintrin.h>
+	#define MR_GLOW_USE_SSE
+#endif
+
 #include "asteroid/asteroid.h"
 #include "cmdline/cmdline.h"
+#include "debugconsole/console.h"
 #include "gamesequence/gamesequence.h"
 #include "graphics/opengl/gropengldraw.h"
 #include "graphics/opengl/gropenglshader.h"
+#include "graphics/shadows.h"
 #include "graphics/tmapper.h"
 #include "io/timer.h"
 #include "math/staticrand.h"
@@ -25,6 +32,7 @@
 #include "math/staticrand.h"
 #include "ship/ship.h"
 #include "ship/shipfx.h"
+#include "tracing/Monitor.h"
 #include "tracing/tracing.h"
 #include "weapon/weapon.h"
 
@@ -349,6 +357,8 @@ void model_batch_buffer::reset()
 	Submodel_matrices.clear();
 
 	Current_offset = 0;
+	Current_num_models = 0;
+	Current_first_model = 0;
 }
 
 void model_batch_buffer::set_num_models(int n_models)
@@ -358,12 +368,39 @@ void model_batch_buffer::set_num_models(int n_models)
 	vm_matrix4_set_identity(&init_mat);
 
 	Current_offset = Submodel_matrices.size();
+	Current_num_models = (size_t)n_models;
+	Current_first_model = 0;
 
 	for ( int i = 0; i < n_models; ++i ) {
 		Submodel_matrices.push_back(init_mat);
 	}
 }
 
+/**
+ * Adds the transform of a single submodel, for drawing the buffer of just that submodel
+ *
+ * The vertices of the buffer still index the transforms with the submodel number, so the offset is set where the
+ * transform of submodel 0 would be. The buffer is padded if that would be before its start.
+ */
+void model_batch_buffer::set_single_model(int model_id)
+{
+	Assert(model_id >= 0);
+
+	matrix4 init_mat;
+
+	vm_matrix4_set_identity(&init_mat);
+
+	while ( Submodel_matrices.size() < (size_t)model_id ) {
+		Submodel_matrices.push_back(init_mat);
+	}
+
+	Current_offset = Submodel_matrices.size() - (size_t)model_id;
+	Current_num_models = 1;
+	Current_first_model = (size_t)model_id;
+
+	Submodel_matrices.push_back(init_mat);
+}
+
 void model_batch_buffer::set_model_transform(matrix4 &transform, int model_id)
 {
 	Submodel_matrices[Current_offset + model_id] = transform;
@@ -379,6 +416,55 @@ size_t model_batch_buffer::get_buffer_offset()
 	return Current_offset;
 }
 
+size_t model_batch_buffer::get_num_models()
+{
+	return Current_num_models;
+}
+
+size_t model_batch_buffer::get_first_model()
+{
+	return Current_first_model;
+}
+
+/**
+ * Appends a copy of some of the transforms to the buffer
+ * @return The offset of the copy
+ */
+size_t model_batch_buffer::copy_transforms(size_t offset, size_t count)
+{
+	Assert(offset + count <= Submodel_matrices.size());
+
+	size_t copy_offset = Submodel_matrices.size();
+
+	for ( size_t i = 0; i < count; ++i ) {
+		Submodel_matrices.push_back(Submodel_matrices[offset + i]);
+	}
+
+	return copy_offset;
+}
+
+void model_batch_buffer::get_transforms(size_t offset, size_t count, SCP_vector<matrix4> &transforms)
+{
+	Assert(offset + count <= Submodel_matrices.size());
+
+	transforms.assign(Submodel_matrices.begin() + offset, Submodel_matrices.begin() + offset + count);
+}
+
+/**
+ * Appends the transforms of a model to the buffer like set_num_models() and set_model_transform() would
+ * @return The offset of the transforms
+ */
+size_t model_batch_buffer::add_transforms(const SCP_vector<matrix4> &transforms)
+{
+	Current_offset = Submodel_matrices.size();
+	Current_num_models = transforms.size();
+	Current_first_model = 0;
+
+	Submodel_matrices.insert(Submodel_matrices.end(), transforms.begin(), transforms.end());
+
+	return Current_offset;
+}
+
 void model_batch_buffer::allocate_memory()
 {
 	auto size = Submodel_matrices.size() * sizeof(matrix4);
@@ -416,6 +502,7 @@ void model_draw_list::reset()
 {
 	Render_elements.clear();
 	Render_keys.clear();
+	Sort_shader_flags.clear();
 
 	Transformations.clear();
 
@@ -424,10 +511,121 @@ void model_draw_list::reset()
 	Current_scale.xyz.z = 1.0f;
 }
 
+// bit layout of the sort keys, the most expensive state change is in the highest bits
+#define DRAW_SORT_LIGHTS_BITS		11
+#define DRAW_SORT_TEXTURE_BITS		16
+#define DRAW_SORT_IBO_BITS			12
+#define DRAW_SORT_VBO_BITS			12
+#define DRAW_SORT_BLEND_BITS		3
+#define DRAW_SORT_SHADER_BITS		10
+
+static inline std::uint64_t draw_sort_field(std::uint64_t key, std::uint64_t value, int bits)
+{
+	return (key << bits) | (value & ((UINT64_C(1) << bits) - 1));
+}
+
+/**
+ * Packs the render state of a draw into one key so that sorting the keys groups draws with the same state.
+ *
+ * Fields which don't fit are truncated. The order of the draws doesn't affect the image, the worst a truncated field
+ * can do is split up draws which could have shared their state.
+ */
+std::uint64_t model_draw_list::compute_sort_key(queued_buffer_draw *draw_data)
+{
+	model_material *mat = &draw_data->render_material;
+
+	// there are only a few distinct shaders so they get numbered in the order they show up
+	size_t shader_id = 0;
+	while ( shader_id < Sort_shader_flags.size() && Sort_shader_flags[shader_id] != draw_data->sdr_flags ) {
+		++shader_id;
+	}
+	if ( shader_id == Sort_shader_flags.size() ) {
+		Sort_shader_flags.push_back(draw_data->sdr_flags);
+	}
+
+	// draws with the same textures end up next to each other, the order between different texture sets is arbitrary
+	static const int texture_types[] = { TM_BASE_TYPE, TM_SPECULAR_TYPE, TM_SPEC_GLOSS_TYPE, TM_GLOW_TYPE,
+		TM_NORMAL_TYPE, TM_HEIGHT_TYPE, TM_AMBIENT_TYPE, TM_MISC_TYPE };
+
+	// the shadow map shader doesn't sample any texture, so the draws of a buffer stay next to each other in the order
+	// they were queued and can be merged
+	bool shadow = mat->is_shadow_casting();
+
+	std::uint32_t texture_hash = 2166136261u;
+	if ( !shadow ) {
+		for ( auto type : texture_types ) {
+			texture_hash = (texture_hash ^ (std::uint32_t)mat->get_texture_map(type)) * 16777619u;
+		}
+	}
+
+	// the same goes for the part of the buffer which is drawn, that way identical draws of different models end up
+	// next to each other so they can be instanced
+	texture_hash = (texture_hash ^ (std::uint32_t)(size_t)draw_data->buffer) * 16777619u;
+	if ( !shadow ) {
+		texture_hash = (texture_hash ^ (std::uint32_t)draw_data->texi) * 16777619u;
+	}
+	texture_hash ^= texture_hash >> 16;
+
+	std::uint64_t key = 0;
+	key = draw_sort_field(key, shader_id, DRAW_SORT_SHADER_BITS);
+	key = draw_sort_field(key, (std::uint64_t)mat->get_blend_mode(), DRAW_SORT_BLEND_BITS);
+	key = draw_sort_field(key, (std::uint64_t)draw_data->vert_src->Vbuffer_handle, DRAW_SORT_VBO_BITS);
+	key = draw_sort_field(key, (std::uint64_t)draw_data->vert_src->Ibuffer_handle, DRAW_SORT_IBO_BITS);
+	key = draw_sort_field(key, texture_hash, DRAW_SORT_TEXTURE_BITS);
+	key = draw_sort_field(key, draw_data->lights.index_start, DRAW_SORT_LIGHTS_BITS);
+
+	return key;
+}
+
 void model_draw_list::sort_draws()
 {
-	std::sort(Render_keys.begin(), Render_keys.end(),
-			  [this](const int a, const int b) { return model_draw_list::sort_draw_pair(this, a, b); });
+	size_t count = Render_keys.size();
+
+	Sort_entries.resize(count);
+	Sort_scratch.resize(count);
+
+	std::uint64_t all_bits = 0;
+	std::uint64_t common_bits = ~UINT64_C(0);
+
+	for ( size_t i = 0; i < count; ++i ) {
+		Sort_entries[i].key = Render_elements[Render_keys[i]].sort_key;
+		Sort_entries[i].index = Render_keys[i];
+
+		all_bits |= Sort_entries[i].key;
+		common_bits &= Sort_entries[i].key;
+	}
+
+	// LSD radix sort, one byte per pass. Bytes which are the same in every key don't need a pass.
+	std::uint64_t varying_bits = all_bits & ~common_bits;
+
+	for ( int shift = 0; shift < 64; shift += 8 ) {
+		if ( ((varying_bits >> shift) & 0xff) == 0 ) {
+			continue;
+		}
+
+		size_t offsets[256] = { 0 };
+
+		for ( size_t i = 0; i < count; ++i ) {
+			++offsets[(Sort_entries[i].key >> shift) & 0xff];
+		}
+
+		size_t sum = 0;
+		for ( auto& offset : offsets ) {
+			size_t bucket = offset;
+			offset = sum;
+			sum += bucket;
+		}
+
+		for ( size_t i = 0; i < count; ++i ) {
+			Sort_scratch[offsets[(Sort_entries[i].key >> shift) & 0xff]++] = Sort_entries[i];
+		}
+
+		Sort_entries.swap(Sort_scratch);
+	}
+
+	for ( size_t i = 0; i < count; ++i ) {
+		Render_keys[i] = Sort_entries[i].index;
+	}
 }
 
 void model_draw_list::start_model_batch(int n_models)
@@ -435,6 +633,11 @@ void model_draw_list::start_model_batch(int n_models)
 	TransformBufferHandler.set_num_models(n_models);
 }
 
+void model_draw_list::start_submodel_batch(int model_num)
+{
+	TransformBufferHandler.set_single_model(model_num);
+}
+
 void model_draw_list::add_submodel_to_batch(int model_num)
 {
 	matrix4 transform;
@@ -489,34 +692,96 @@ void model_draw_list::add_buffer_draw(model_material *render_material, indexed_v
 		draw_data.scale.xyz.z = 1.0f;
 
 		draw_data.transform_buffer_offset = TransformBufferHandler.get_buffer_offset();
+		draw_data.instance_stride = TransformBufferHandler.get_num_models();
+		draw_data.first_model_id = TransformBufferHandler.get_first_model();
 
 		render_material->set_batching(true);
 	} else {
 		draw_data.transform = Transformations.get_transform();
 		draw_data.scale = Current_scale;
 		draw_data.transform_buffer_offset = INVALID_SIZE;
+		draw_data.instance_stride = 0;
+		draw_data.first_model_id = 0;
 		render_material->set_batching(false);
 	}
 
+	draw_data.num_instances = 1;
 	draw_data.sdr_flags = render_material->get_shader_flags();
 
 	draw_data.vert_src = vert_src;
 	draw_data.buffer = buffer;
 	draw_data.texi = texi;
+	draw_data.texi_count = 1;
 	draw_data.flags = tmap_flags;
 	draw_data.render_material = *render_material;
 	draw_data.lights = Current_lights_set;
+	draw_data.sort_key = compute_sort_key(&draw_data);
 
 	Render_elements.push_back(draw_data);
 	Render_keys.push_back((int) (Render_elements.size() - 1));
 }
 
+size_t model_draw_list::get_num_buffer_draws()
+{
+	return Render_elements.size();
+}
+
+/**
+ * Copies the buffer draws queued since first_draw so they can be queued again with add_retained_buffer_draws()
+ *
+ * The draws have to belong to one model. If it was batched, its transforms are the last ones in the transform buffer.
+ */
+void model_draw_list::retain_buffer_draws(size_t first_draw, bool batched, retained_buffer_draws *retained)
+{
+	Assert(first_draw <= Render_elements.size());
+
+	retained->draws.assign(Render_elements.begin() + first_draw, Render_elements.end());
+
+	if ( batched ) {
+		TransformBufferHandler.get_transforms(TransformBufferHandler.get_buffer_offset(), TransformBufferHandler.get_num_models(), retained->transforms);
+	} else {
+		retained->transforms.clear();
+	}
+}
+
+/**
+ * Queues the retained draws of a model again
+ *
+ * Only the lights and whatever depends on the position of the draws in this frame are set up again, everything else
+ * is the same as when the draws were retained.
+ */
+void model_draw_list::add_retained_buffer_draws(retained_buffer_draws *retained)
+{
+	size_t transform_offset = INVALID_SIZE;
+
+	if ( !retained->transforms.empty() ) {
+		transform_offset = TransformBufferHandler.add_transforms(retained->transforms);
+	}
+
+	for ( auto &retained_draw : retained->draws ) {
+		Render_elements.push_back(retained_draw);
+
+		queued_buffer_draw &draw_data = Render_elements.back();
+
+		if ( draw_data.transform_buffer_offset != INVALID_SIZE ) {
+			Assert(transform_offset != INVALID_SIZE);
+			draw_data.transform_buffer_offset = transform_offset;
+		}
+
+		draw_data.lights = Current_lights_set;
+		draw_data.sort_key = compute_sort_key(&draw_data);
+
+		Render_keys.push_back((int) (Render_elements.size() - 1));
+	}
+}
+
 void model_draw_list::render_buffer(queued_buffer_draw &render_elements)
 {
 	GR_DEBUG_SCOPE("Render buffer");
 	TRACE_SCOPE(tracing::RenderBuffer);
 
 	gr_set_transform_buffer_offset(render_elements.transform_buffer_offset);
+	gr_set_transform_buffer_instances(render_elements.num_instances, render_elements.instance_stride);
 
 	if ( render_elements.render_material.is_lit() ) {
 		Scene_light_handler.setLights(&render_elements.lights);
@@ -536,7 +801,9 @@ void model_draw_list::render_buffer(queued_buffer_draw &render_elements)
 
 	gr_push_scale_matrix(&render_elements.scale);
 
-	gr_render_model(&render_elements.render_material, render_elements.vert_src, render_elements.buffer, render_elements.texi);
+	gr_render_model(&render_elements.render_material, render_elements.vert_src, render_elements.buffer, render_elements.texi, render_elements.texi_count);
+
+	gr_set_transform_buffer_instances(1, 0);
 
 	gr_pop_scale_matrix();
 
@@ -565,6 +832,11 @@ vec3d model_draw_list::get_view_position()
 	return return_val;
 }
 
+const matrix4 &model_draw_list::get_transform()
+{
+	return Transformations.get_transform();
+}
+
 void model_draw_list::push_transform(vec3d *pos, matrix *orient)
 {
 	Transformations.push(pos, orient);
@@ -600,10 +872,161 @@ void model_draw_list::init()
 	TransformBufferHandler.reset();
 }
 
+/**
+ * Checks if two draws only differ in their transforms so they can be drawn as instances of one draw
+ */
+static bool queued_draws_can_instance(queued_buffer_draw *a, queued_buffer_draw *b)
+{
+	// the shadow map already uses instancing for the cascades
+	if ( a->render_material.is_shadow_casting() ) {
+		return false;
+	}
+
+	if ( a->transform_buffer_offset == INVALID_SIZE || b->transform_buffer_offset == INVALID_SIZE ) {
+		return false;
+	}
+
+	return a->sort_key == b->sort_key
+		&& a->vert_src == b->vert_src
+		&& a->buffer == b->buffer
+		&& a->texi == b->texi
+		&& a->flags == b->flags
+		&& a->sdr_flags == b->sdr_flags
+		&& a->instance_stride == b->instance_stride
+		&& a->first_model_id == b->first_model_id
+		&& a->lights.index_start == b->lights.index_start
+		&& a->lights.num_lights == b->lights.num_lights
+		&& a->render_material.has_same_state(b->render_material);
+}
+
+static bool Model_draw_instancing = true;
+DCF_BOOL(model_instancing, Model_draw_instancing);
+
+/**
+ * Merges runs of identical batched draws into instanced draws. This needs the draws to be sorted and has to be done
+ * before the transform buffer is submitted since it adds the transforms of the instances to it.
+ */
+void model_draw_list::build_instanced_draws()
+{
+	if ( !Model_draw_instancing ) {
+		return;
+	}
+
+	size_t num_draws = 0;
+
+	for ( size_t i = 0; i < Render_keys.size(); ) {
+		queued_buffer_draw *first = &Render_elements[Render_keys[i]];
+
+		size_t end = i + 1;
+		while ( end < Render_keys.size() && queued_draws_can_instance(first, &Render_elements[Render_keys[end]]) ) {
+			++end;
+		}
+
+		if ( end - i > 1 ) {
+			// the transforms of the instances need to follow each other
+			size_t offset = INVALID_SIZE;
+
+			for ( size_t j = i; j < end; ++j ) {
+				auto copy_offset = TransformBufferHandler.copy_transforms(Render_elements[Render_keys[j]].transform_buffer_offset + first->first_model_id, first->instance_stride);
+
+				if ( offset == INVALID_SIZE ) {
+					offset = copy_offset;
+				}
+			}
+
+			// the copies are only the transforms from the first model id on
+			first->transform_buffer_offset = offset - first->first_model_id;
+			first->num_instances = (int)(end - i);
+		}
+
+		Render_keys[num_draws++] = Render_keys[i];
+		i = end;
+	}
+
+	Render_keys.resize(num_draws);
+}
+
+/**
+ * Checks if a draw can be appended to a draw of the texture buffers before it in the same vertex buffer, which needs
+ * everything but the textures to be the same and the indices of the texture buffers to follow each other
+ */
+static bool queued_draws_can_merge(queued_buffer_draw *a, queued_buffer_draw *b)
+{
+	if ( a->buffer != b->buffer || b->texi != a->texi + a->texi_count ) {
+		return false;
+	}
+
+	auto& last = a->buffer->tex_buf[a->texi + a->texi_count - 1];
+	auto& next = b->buffer->tex_buf[b->texi];
+
+	if ( (last.flags & VB_FLAG_LARGE_INDEX) != (next.flags & VB_FLAG_LARGE_INDEX) ) {
+		return false;
+	}
+
+	size_t index_size = (last.flags & VB_FLAG_LARGE_INDEX) ? sizeof(uint) : sizeof(ushort);
+	if ( last.index_offset + last.n_verts * index_size != next.index_offset ) {
+		return false;
+	}
+
+	if ( a->num_instances != b->num_instances || a->transform_buffer_offset != b->transform_buffer_offset ) {
+		return false;
+	}
+
+	if ( a->transform_buffer_offset == INVALID_SIZE
+		&& (memcmp(&a->transform, &b->transform, sizeof(a->transform)) != 0 || !vm_vec_same(&a->scale, &b->scale)) ) {
+		return false;
+	}
+
+	// the textures only matter to the shaders which sample them
+	bool compare_textures = !a->render_material.is_shadow_casting();
+
+	return a->vert_src == b->vert_src
+		&& a->flags == b->flags
+		&& a->sdr_flags == b->sdr_flags
+		&& a->instance_stride == b->instance_stride
+		&& a->first_model_id == b->first_model_id
+		&& a->lights.index_start == b->lights.index_start
+		&& a->lights.num_lights == b->lights.num_lights
+		&& a->render_material.has_same_state(b->render_material, compare_textures);
+}
+
+static bool Model_draw_merging = true;
+DCF_BOOL(model_draw_merging, Model_draw_merging);
+
+/**
+ * Merges runs of draws of consecutive texture buffers into one draw call. The shadow map draws of a model only differ
+ * in their textures, so a model ends up with one draw there instead of one per texture.
+ */
+void model_draw_list::merge_draws()
+{
+	if ( !Model_draw_merging ) {
+		return;
+	}
+
+	size_t num_draws = 0;
+
+	for ( size_t i = 0; i < Render_keys.size(); ) {
+		queued_buffer_draw *first = &Render_elements[Render_keys[i]];
+
+		size_t end = i + 1;
+		while ( end < Render_keys.size() && queued_draws_can_merge(first, &Render_elements[Render_keys[end]]) ) {
+			first->texi_count += Render_elements[Render_keys[end]].texi_count;
+			++end;
+		}
+
+		Render_keys[num_draws++] = Render_keys[i];
+		i = end;
+	}
+
+	Render_keys.resize(num_draws);
+}
+
 void model_draw_list::init_render(bool sort)
 {
 	if ( sort ) {
 		sort_draws();
+		build_instanced_draws();
+		merge_draws();
 	}
 
 	TransformBufferHandler.submit_buffer_data();
@@ -627,6 +1050,53 @@ void model_draw_list::render_all(gr_zbuffer_type depth_mode)
 	gr_alpha_mask_set(0, 1.0f);
 }
 
+/**
+ * Checks if the depth of a draw can be laid down before the draw itself, which needs the full pass to end up with exactly
+ * the same depth and to discard the same fragments as the depth-only shader
+ */
+static bool queued_draw_can_prepass(queued_buffer_draw *draw)
+{
+	auto& mat = draw->render_material;
+
+	return mat.get_depth_mode() == ZBUFFER_TYPE_FULL
+		&& mat.get_blend_mode() == ALPHA_BLEND_NONE
+		&& !mat.is_shadow_casting()
+		&& mat.get_animated_effect() < 0
+		&& !mat.is_normal_alpha_active()
+		&& !mat.is_normal_extrude_active();
+}
+
+/**
+ * Draws the depth of the opaque draws in the order of the sorted list, the draws which were part of it are then drawn
+ * by render_all() with an equal depth test so the G-buffer is only written once per pixel.
+ */
+void model_draw_list::render_depth_prepass()
+{
+	GR_DEBUG_SCOPE("Depth pre-pass");
+	TRACE_SCOPE(tracing::DeferredDepthPrepass);
+
+	Scene_light_handler.resetLightState();
+
+	int color_buffer = gr_set_color_buffer(0);
+
+	for ( auto render_index : Render_keys ) {
+		auto& draw = Render_elements[render_index];
+
+		if ( !queued_draw_can_prepass(&draw) ) {
+			continue;
+		}
+
+		draw.render_material.set_depth_prepass(true);
+		render_buffer(draw);
+		draw.render_material.set_depth_prepass(false);
+
+		draw.render_material.set_depth_prepassed(true);
+	}
+
+	gr_set_color_buffer(color_buffer);
+	gr_alpha_mask_set(0, 1.0f);
+}
+
 void model_draw_list::render_arc(arc_effect &arc)
 {
 	g3_start_instance_matrix(&arc.transform);	
@@ -728,58 +1198,6 @@ void model_draw_list::render_outline(outline_draw &outline_info)
 	g3_done_instance(true);
 }
 
-bool model_draw_list::sort_draw_pair(model_draw_list* target, const int a, const int b)
-{
-	queued_buffer_draw *draw_call_a = &target->Render_elements[a];
-	queued_buffer_draw *draw_call_b = &target->Render_elements[b];
-
-	if ( draw_call_a->sdr_flags != draw_call_b->sdr_flags ) {
-		return draw_call_a->sdr_flags < draw_call_b->sdr_flags;
-	}
-
-	if ( draw_call_a->vert_src->Vbuffer_handle != draw_call_b->vert_src->Vbuffer_handle ) {
-		return draw_call_a->vert_src->Vbuffer_handle < draw_call_b->vert_src->Vbuffer_handle;
-	}
-
-	if ( draw_call_a->vert_src->Ibuffer_handle != draw_call_b->vert_src->Ibuffer_handle ) {
-		return draw_call_a->vert_src->Ibuffer_handle < draw_call_b->vert_src->Ibuffer_handle;
-	}
-
-	if ( draw_call_a->render_material.get_texture_map(TM_BASE_TYPE) != draw_call_b->render_material.get_texture_map(TM_BASE_TYPE) ) {
-		return draw_call_a->render_material.get_texture_map(TM_BASE_TYPE) < draw_call_b->render_material.get_texture_map(TM_BASE_TYPE);
-	}
-
-	if ( draw_call_a->render_material.get_texture_map(TM_SPECULAR_TYPE) != draw_call_b->render_material.get_texture_map(TM_SPECULAR_TYPE) ) {
-		return draw_call_a->render_material.get_texture_map(TM_SPECULAR_TYPE) < draw_call_b->render_material.get_texture_map(TM_SPECULAR_TYPE);
-	}
-	
-	if ( draw_call_a->render_material.get_texture_map(TM_SPEC_GLOSS_TYPE) != draw_call_b->render_material.get_texture_map(TM_SPEC_GLOSS_TYPE) ) {
-		return draw_call_a->render_material.get_texture_map(TM_SPEC_GLOSS_TYPE) < draw_call_b->render_material.get_texture_map(TM_SPEC_GLOSS_TYPE);
-	}
-
-	if ( draw_call_a->render_material.get_texture_map(TM_GLOW_TYPE) != draw_call_b->render_material.get_texture_map(TM_GLOW_TYPE) ) {
-		return draw_call_a->render_material.get_texture_map(TM_GLOW_TYPE) < draw_call_b->render_material.get_texture_map(TM_GLOW_TYPE);
-	}
-
-	if ( draw_call_a->render_material.get_texture_map(TM_NORMAL_TYPE) != draw_call_b->render_material.get_texture_map(TM_NORMAL_TYPE) ) {
-		return draw_call_a->render_material.get_texture_map(TM_NORMAL_TYPE) < draw_call_b->render_material.get_texture_map(TM_NORMAL_TYPE);
-	}
-
-	if ( draw_call_a->render_material.get_texture_map(TM_HEIGHT_TYPE) != draw_call_b->render_material.get_texture_map(TM_HEIGHT_TYPE) ) {
-		return draw_call_a->render_material.get_texture_map(TM_HEIGHT_TYPE) < draw_call_b->render_material.get_texture_map(TM_HEIGHT_TYPE);
-	}
-
-	if ( draw_call_a->render_material.get_texture_map(TM_AMBIENT_TYPE) != draw_call_b->render_material.get_texture_map(TM_AMBIENT_TYPE) ) {
-		return draw_call_a->render_material.get_texture_map(TM_AMBIENT_TYPE) < draw_call_b->render_material.get_texture_map(TM_AMBIENT_TYPE);
-	}
-
-	if ( draw_call_a->render_material.get_texture_map(TM_MISC_TYPE) != draw_call_b->render_material.get_texture_map(TM_MISC_TYPE) ) {
-		return draw_call_a->render_material.get_texture_map(TM_MISC_TYPE) < draw_call_b->render_material.get_texture_map(TM_MISC_TYPE);
-	}
-
-	return draw_call_a->lights.index_start < draw_call_b->lights.index_start;
-}
-
 void model_render_add_lightning( model_draw_list *scene, model_render_params* interp, polymodel *pm, bsp_info * sm )
 {
 	int i;
@@ -881,6 +1299,79 @@ float model_render_determine_depth(int obj_num, int model_num, matrix* orient, v
 	return depth;
 }
 
+// how far past a LOD threshold an object has to be before the LOD changes, so objects at the threshold don't keep
+// switching between two LODs
+static const float MODEL_LOD_HYSTERESIS = 0.1f;
+
+// the vertical field of view the detail distances of the tables are meant for, that is the retail default zoom
+static const float MODEL_LOD_REFERENCE_FOV = 1.39626348f * 0.75f;
+
+// the LODs which were picked for an object the last time it was rendered
+struct model_detail_state {
+	int signature = -1;
+	int model_num = -1;
+	int detail_index = -1;
+	int generated_lod = -1;
+};
+
+static model_detail_state Model_detail_states[MAX_OBJECTS];
+
+static model_detail_state *model_render_get_detail_state(int obj_num, int model_num)
+{
+	if ( obj_num < 0 || obj_num >= MAX_OBJECTS ) {
+		return NULL;
+	}
+
+	model_detail_state *state = &Model_detail_states[obj_num];
+
+	if ( state->signature != Objects[obj_num].signature || state->model_num != model_num ) {
+		state->signature = Objects[obj_num].signature;
+		state->model_num = model_num;
+		state->detail_index = -1;
+		state->generated_lod = -1;
+	}
+
+	return state;
+}
+
+/**
+ * Picks the LOD from a list of increasing thresholds with hysteresis
+ *
+ * @return The number of thresholds the value is past
+ */
+static int model_render_pick_lod(const float *thresholds, int num_thresholds, float value, int *last_lod)
+{
+	int lod_far = 0;
+	int lod_near = 0;
+
+	// with the thresholds moved away the LOD doesn't drop until the object is well past it, moved closer it doesn't
+	// rise until the object is well before the threshold
+	while ( lod_far < num_thresholds && value > thresholds[lod_far] * (1.0f + MODEL_LOD_HYSTERESIS) ) {
+		lod_far++;
+	}
+	while ( lod_near < num_thresholds && value > thresholds[lod_near] * (1.0f - MODEL_LOD_HYSTERESIS) ) {
+		lod_near++;
+	}
+
+	// a LOD between the two is still fine
+	int lod = (*last_lod < 0) ? lod_far : *last_lod;
+	CLAMP(lod, lod_far, lod_near);
+
+	*last_lod = lod;
+
+	return lod;
+}
+
+// scales a distance by how much larger than at the reference field of view things are on screen
+static float model_render_fov_scaled_depth(float depth)
+{
+	if ( Proj_fov <= 0.0f ) {
+		return depth;
+	}
+
+	return depth * tanf(Proj_fov * 0.5f) / tanf(MODEL_LOD_REFERENCE_FOV * 0.5f);
+}
+
 int model_render_determine_detail(float depth, int obj_num, int model_num, matrix* orient, vec3d* pos, int flags, int detail_level_locked)
 {
 	int tmp_detail_level = Game_detail_level;
@@ -899,10 +1390,16 @@ int model_render_determine_detail(float depth, int obj_num, int model_num, matri
 #if MAX_DETAIL_LEVEL != 4
 #error Code in modelrender.cpp assumes MAX_DETAIL_LEVEL == 4
 #endif
-			for ( i = 0; i < pm->n_detail_levels; i++ )	{
-				if ( depth <= pm->detail_depth[i] ) {
-					break;
-				}
+			// the detail distances stand for a size on screen so zooming in needs more detail
+			float scaled_depth = model_render_fov_scaled_depth(depth);
+
+			model_detail_state *state = model_render_get_detail_state(obj_num, model_num);
+			int last_index = (state != NULL) ? state->detail_index : -1;
+
+			i = model_render_pick_lod(pm->detail_depth, pm->n_detail_levels, scaled_depth, &last_index);
+
+			if ( state != NULL ) {
+				state->detail_index = last_index;
 			}
 
 			// If no valid detail depths specified, use highest.
@@ -925,24 +1422,219 @@ int model_render_determine_detail(float depth, int obj_num, int model_num, matri
 	}
 }
 
-void model_render_buffers(model_draw_list* scene, model_material *rendering_material, model_render_params* interp, vertex_buffer *buffer, polymodel *pm, int mn, int detail_level, uint tmap_flags)
+/**
+ * Picks one of the LODs made by -generate_lods from the radius of the model on screen
+ *
+ * @return The index into detail_buffers, 0 for the model itself
+ */
+static int model_render_determine_generated_lod(float depth, int obj_num, polymodel *pm, int detail_level_locked)
 {
-	bsp_info *model = NULL;
-	const uint model_flags = interp->get_model_flags();
-	const int obj_num = interp->get_object_number();
+	if ( pm->n_generated_lods <= 0 || detail_level_locked >= 0 || Proj_fov <= 0.0f ) {
+		return 0;
+	}
 
-	Assert(buffer != NULL);
-	Assert(detail_level >= 0);
+	// the distances at which the model gets as small as the radius of each LOD
+	float pixels_per_unit = (gr_screen.clip_height * 0.5f) / tanf(Proj_fov * 0.5f);
+	float thresholds[MAX_MODEL_GENERATED_LODS];
 
-	if ( (mn >= 0) && (mn < pm->n_models) ) {
-		model = &pm->submodel[mn];
+	for ( int i = 0; i < pm->n_generated_lods; ++i ) {
+		thresholds[i] = pm->rad * pixels_per_unit / Model_generated_lod_radius[i];
 	}
 
-	bool render_as_thruster = (model != NULL) && model->is_thruster && (model_flags & MR_SHOW_THRUSTERS);
+	model_detail_state *state = model_render_get_detail_state(obj_num, pm->id);
+	int last_lod = (state != NULL) ? state->generated_lod : -1;
 
-	vec3d scale;
+	int lod = model_render_pick_lod(thresholds, pm->n_generated_lods, depth, &last_lod);
 
-	if ( render_as_thruster ) {
+	if ( state != NULL ) {
+		state->generated_lod = last_lod;
+	}
+
+	return lod;
+}
+
+// the buffer draws of an object and everything they were queued with, see model_render_get_retained_state()
+struct model_retained_state {
+	int signature = -1;
+	int model_num = -1;
+
+	// if the model has nothing which changes its draws without the rest of the state changing
+	bool model_can_retain = false;
+
+	int detail_level = -1;
+	int detail_buffer = -1;
+	uint model_flags = 0;
+	uint tmap_flags = 0;
+	vec3d pos;
+	matrix orient;
+	vec3d warp_scale;
+	color clr;
+	float gun_rotation = 0.0f;
+	bool deferred_lighting = false;
+	bool high_dynamic_range = false;
+	int lighting_detail = -1;
+	model_material material;
+	SCP_vector<angles> submodel_angs;
+	SCP_vector<ubyte> submodel_blown_off;
+
+	// how many frames in a row the state didn't change
+	int unchanged_frames = 0;
+
+	bool recorded = false;
+	retained_buffer_draws draws;
+};
+
+static model_retained_state Model_retained_states[MAX_OBJECTS];
+
+/**
+ * Checks if anything in a model changes its draws from frame to frame even when the object stays where it is
+ */
+static bool model_render_model_can_retain(polymodel *pm)
+{
+	for ( int i = 0; i < pm->n_models; ++i ) {
+		bsp_info *model = &pm->submodel[i];
+
+		// the detail boxes depend on the view position
+		if ( model->use_render_box || model->use_render_sphere ) {
+			return false;
+		}
+	}
+
+	for ( int i = 0; i < pm->n_textures; ++i ) {
+		for ( int j = 0; j < TM_NUM_TYPES; ++j ) {
+			if ( pm->maps[i].textures[j].GetNumFrames() > 1 ) {
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+/**
+ * Gets the retained draws of an object, with -retained_draws objects which don't change keep their draws from the
+ * last frames and only queue them again
+ *
+ * Whatever the draws are made from is compared to what it was the last time. The draws are only kept once an object
+ * stayed the same for a frame so objects which move don't copy their draws every frame.
+ *
+ * @return The state of the object or NULL if its draws can't be retained
+ */
+static model_retained_state *model_render_get_retained_state(model_render_params *interp, int obj_num, polymodel *pm, polymodel_instance *pmi, int detail_level, int detail_buffer, uint tmap_flags, model_material *material, const vec3d *pos, matrix *orient)
+{
+	if ( !Cmdline_retained_draws || Rendering_to_shadow_map || obj_num < 0 || obj_num >= MAX_OBJECTS ) {
+		return NULL;
+	}
+
+	model_retained_state *state = &Model_retained_states[obj_num];
+
+	if ( state->signature != Objects[obj_num].signature || state->model_num != pm->id ) {
+		state->signature = Objects[obj_num].signature;
+		state->model_num = pm->id;
+		state->model_can_retain = model_render_model_can_retain(pm);
+		state->unchanged_frames = 0;
+		state->recorded = false;
+		state->detail_level = -1;
+	}
+
+	const uint model_flags = interp->get_model_flags();
+
+	// these change the draws every frame or add more than buffer draws
+	bool can_retain = state->model_can_retain
+		&& !(model_flags & (MR_SHOW_OUTLINE | MR_SHOW_OUTLINE_HTL | MR_SHOW_OUTLINE_PRESET | MR_NO_POLYS | MR_ALL_XPARENT | MR_ATTACHED_MODEL))
+		&& !interp->is_clip_plane_set()
+		&& interp->get_animated_effect_num() < 0
+		&& interp->get_warp_bitmap() < 0
+		&& interp->get_forced_bitmap() < 0
+		&& interp->get_replacement_textures() == NULL;
+
+	for ( int i = 0; can_retain && i < pm->n_models; ++i ) {
+		// the lightning arcs and the thrusters are different every frame
+		if ( pm->submodel[i].num_arcs || ((model_flags & MR_SHOW_THRUSTERS) && pm->submodel[i].is_thruster) ) {
+			can_retain = false;
+		}
+	}
+
+	if ( !can_retain ) {
+		state->unchanged_frames = 0;
+		state->recorded = false;
+		state->detail_level = -1;
+		return NULL;
+	}
+
+	bool unchanged = state->detail_level == detail_level
+		&& state->detail_buffer == detail_buffer
+		&& state->model_flags == model_flags
+		&& state->tmap_flags == tmap_flags
+		&& vm_vec_same(&state->pos, pos)
+		&& vm_matrix_same(&state->orient, orient)
+		&& vm_vec_same(&state->warp_scale, &interp->get_warp_scale())
+		&& !memcmp(&state->clr, &interp->get_color(), sizeof(color))
+		&& state->gun_rotation == pm->gun_submodel_rotation
+		&& state->deferred_lighting == (Deferred_lighting != 0)
+		&& state->high_dynamic_range == (High_dynamic_range != 0)
+		&& state->lighting_detail == Detail.lighting
+		&& state->material.has_same_state(*material)
+		&& state->submodel_angs.size() == (size_t)pm->n_models;
+
+	for ( int i = 0; unchanged && i < pm->n_models; ++i ) {
+		const angles &angs = (pmi != NULL) ? pmi->submodel[i].angs : pm->submodel[i].angs;
+		ubyte blown_off = (ubyte)((pmi != NULL) ? pmi->submodel[i].blown_off : (pm->submodel[i].blown_off != 0));
+
+		unchanged = !memcmp(&state->submodel_angs[i], &angs, sizeof(angles)) && state->submodel_blown_off[i] == blown_off;
+	}
+
+	if ( unchanged ) {
+		state->unchanged_frames++;
+		return state;
+	}
+
+	state->detail_level = detail_level;
+	state->detail_buffer = detail_buffer;
+	state->model_flags = model_flags;
+	state->tmap_flags = tmap_flags;
+	state->pos = *pos;
+	state->orient = *orient;
+	state->warp_scale = interp->get_warp_scale();
+	state->clr = interp->get_color();
+	state->gun_rotation = pm->gun_submodel_rotation;
+	state->deferred_lighting = Deferred_lighting != 0;
+	state->high_dynamic_range = High_dynamic_range != 0;
+	state->lighting_detail = Detail.lighting;
+	state->material = *material;
+
+	state->submodel_angs.resize(pm->n_models);
+	state->submodel_blown_off.resize(pm->n_models);
+
+	for ( int i = 0; i < pm->n_models; ++i ) {
+		state->submodel_angs[i] = (pmi != NULL) ? pmi->submodel[i].angs : pm->submodel[i].angs;
+		state->submodel_blown_off[i] = (ubyte)((pmi != NULL) ? pmi->submodel[i].blown_off : (pm->submodel[i].blown_off != 0));
+	}
+
+	state->unchanged_frames = 0;
+	state->recorded = false;
+
+	return state;
+}
+
+void model_render_buffers(model_draw_list* scene, model_material *rendering_material, model_render_params* interp, vertex_buffer *buffer, polymodel *pm, int mn, int detail_level, uint tmap_flags)
+{
+	bsp_info *model = NULL;
+	const uint model_flags = interp->get_model_flags();
+	const int obj_num = interp->get_object_number();
+
+	Assert(buffer != NULL);
+	Assert(detail_level >= 0);
+
+	if ( (mn >= 0) && (mn < pm->n_models) ) {
+		model = &pm->submodel[mn];
+	}
+
+	bool render_as_thruster = (model != NULL) && model->is_thruster && (model_flags & MR_SHOW_THRUSTERS);
+
+	vec3d scale;
+
+	if ( render_as_thruster ) {
 		scale.xyz.x = 1.0f;
 		scale.xyz.y = 1.0f;
 
@@ -1179,6 +1871,81 @@ void model_render_buffers(model_draw_list* scene, model_material *rendering_mate
 	}
 }
 
+// Smaller models are hardly ever partly on the screen so their submodels are not culled on their own
+static const float MR_SUBMODEL_CULL_MIN_RADIUS = 250.0f;
+
+static bool Model_submodel_culling = true;
+DCF_BOOL(submodel_culling, Model_submodel_culling);
+
+// counts the culled submodels so model_render_queue() knows if the draws of a model are complete
+static uint Model_submodels_culled = 0;
+
+MONITOR(NumSubmodelsCulled)
+
+/**
+ * Checks if the geometry of a submodel is outside of everything which is being rendered, the view frustum or the shadow
+ * cascades which are rendered this frame
+ *
+ * The bounding box of the submodel is transformed with the current transform of the scene so the submodel transform
+ * has to be pushed already. The children of a submodel are not inside of its box, they have to be checked on their own.
+ */
+static bool model_render_submodel_culled(model_draw_list *scene, model_render_params *interp, polymodel *pm, int mn)
+{
+	if ( !Model_submodel_culling || pm->rad < MR_SUBMODEL_CULL_MIN_RADIUS ) {
+		return false;
+	}
+
+	bsp_info *model = &pm->submodel[mn];
+
+	// thrusters are stretched and the warp scales the model, neither is in the bounding box
+	if ( model->is_thruster || interp->get_warp_bitmap() >= 0 ) {
+		return false;
+	}
+
+	matrix4 transform = scene->get_transform();
+	matrix orient;
+	vec3d pos;
+	vm_matrix4_get_orientation(&orient, &transform);
+	vm_matrix4_get_offset(&pos, &transform);
+
+	bool culled;
+
+	if ( Rendering_to_shadow_map ) {
+		vec3d center, world_center;
+		vm_vec_avg(&center, &model->min, &model->max);
+		vm_vec_unrotate(&world_center, &center, &orient);
+		vm_vec_add2(&world_center, &pos);
+
+		culled = !shadows_sphere_in_rendered_cascades(&world_center, vm_vec_dist(&model->min, &model->max) * 0.5f);
+	} else {
+		// the same test as obj_in_view_cone(), with the corners of the box
+		ubyte and_codes = 0xff;
+		vec3d corners[8];
+
+		vm_vec_unrotate_n(corners, model->bounding_box, 8, &orient, &pos);
+		vm_vec_rotate_n(corners, corners, 8, &Eye_matrix, &Eye_position);
+
+		for ( int i = 0; i < 8 && and_codes; ++i ) {
+			vec3d &view = corners[i];
+
+			view.xyz.x *= Matrix_scale.xyz.x;
+			view.xyz.y *= Matrix_scale.xyz.y;
+			view.xyz.z *= Matrix_scale.xyz.z;
+
+			and_codes &= g3_code_vector(&view);
+		}
+
+		culled = and_codes != 0;
+	}
+
+	if ( culled ) {
+		++Model_submodels_culled;
+		MONITOR_INC(NumSubmodelsCulled, 1);
+	}
+
+	return culled;
+}
+
 void model_render_children_buffers(model_draw_list* scene, model_material *rendering_material, model_render_params* interp, polymodel* pm, polymodel_instance *pmi, int mn, int detail_level, uint tmap_flags, bool trans_buffer)
 {
 	int i;
@@ -1240,22 +2007,16 @@ void model_render_children_buffers(model_draw_list* scene, model_material *rende
 	}
 
 	// Compute final submodel orientation by using the orientation matrix
-	// and the rotation angles.
-	// By using this kind of computation, the rotational angles can always
-	// be computed relative to the submodel itself, instead of relative
-	// to the parent
-	matrix rotation_matrix = model->orientation;
-	vm_rotate_matrix_by_angles(&rotation_matrix, &ang);
-
-	matrix inv_orientation;
-	vm_copy_transpose(&inv_orientation, &model->orientation);
-
+	// and the rotation angles. This is cached by the instance so the other
+	// render passes of this frame don't have to do it again.
 	matrix submodel_matrix;
-	vm_matrix_x_matrix(&submodel_matrix, &rotation_matrix, &inv_orientation);
+	model_instance_get_local_orient(&submodel_matrix, pm, pmi, mn, &ang);
 
 	scene->push_transform(&model->offset, &submodel_matrix);
 	
-	if ( (model_flags & MR_SHOW_OUTLINE || model_flags & MR_SHOW_OUTLINE_HTL || model_flags & MR_SHOW_OUTLINE_PRESET) && 
+	if ( model_render_submodel_culled(scene, interp, pm, mn) ) {
+		// a batched submodel which isn't added to the batch stays hidden
+	} else if ( (model_flags & MR_SHOW_OUTLINE || model_flags & MR_SHOW_OUTLINE_HTL || model_flags & MR_SHOW_OUTLINE_PRESET) && 
 		pm->submodel[mn].outline_buffer != NULL ) {
 		color outline_color = interp->get_color();
 		scene->add_outline(pm->submodel[mn].outline_buffer, pm->submodel[mn].n_verts_outline, &outline_color);
@@ -1454,6 +2215,8 @@ void submodel_render_immediate(model_render_params *render_info, int model_num,
 	model_list.init();
 
 	submodel_render_queue(render_info, &model_list, model_num, submodel_num, orient, pos);
+
+	model_list.init_render(false);
 	
 	model_list.render_all();
 
@@ -1473,125 +2236,420 @@ void submodel_render_queue(model_render_params *render_info, model_draw_list *sc
 	polymodel * pm;
 	model_material rendering_material;
 
-	//MONITOR_INC( NumModelsRend, 1 );	
+	//MONITOR_INC( NumModelsRend, 1 );	
+
+	if ( !( Game_detail_flags & DETAIL_FLAG_MODELS ) )	return;
+	
+	if ( render_info->is_clip_plane_set() ) {
+		rendering_material.set_clip_plane(render_info->get_clip_plane_normal(), render_info->get_clip_plane_pos());
+	}
+
+	if ( render_info->is_team_color_set() ) {
+		rendering_material.set_team_color(render_info->get_team_color());
+	}
+		
+	uint flags = render_info->get_model_flags();
+	int objnum = render_info->get_object_number();
+
+	pm = model_get(model_num);
+
+	// Set the flags we will pass to the tmapper
+	uint tmap_flags = TMAP_FLAG_GOURAUD | TMAP_FLAG_RGB;
+
+	// if we're in nebula mode
+	if( ( The_mission.flags[Mission::Mission_Flags::Fullneb] ) && ( Neb2_render_mode != NEB2_RENDER_NONE ) ) {
+		tmap_flags |= TMAP_FLAG_PIXEL_FOG;
+	}
+
+	if ( !( flags & MR_NO_TEXTURING ) )	{
+		tmap_flags |= TMAP_FLAG_TEXTURED;
+
+		if ( ( pm->flags & PM_FLAG_ALLOW_TILING ) && tiling )
+			tmap_flags |= TMAP_FLAG_TILED;
+
+		if ( !( flags & MR_NO_CORRECT ) )	{
+			tmap_flags |= TMAP_FLAG_CORRECT;
+		}
+	}
+
+	if ( render_info->get_animated_effect_num() >= 0 ) {
+		tmap_flags |= TMAP_ANIMATED_SHADER;
+		rendering_material.set_animated_effect(render_info->get_animated_effect_num(), render_info->get_animated_effect_timer());
+	}
+
+	bool is_outlines_only_htl = (flags & MR_NO_POLYS) && (flags & MR_SHOW_OUTLINE_HTL);
+
+	//set to true since D3d and OGL need the api matrices set
+	scene->push_transform(pos, orient);
+
+	
+	vec3d auto_back = ZERO_VECTOR;
+	bool set_autocen = model_render_determine_autocenter(&auto_back, pm, render_info->get_detail_level_lock(), flags);
+
+	if ( set_autocen ) {
+		scene->push_transform(&auto_back, NULL);
+	}
+
+	// the buffers of a submodel carry its number as the model id, so with its transform in the transform buffer the
+	// draws of the many pieces of debris using the same submodel can be instanced
+	if ( !Cmdline_no_batching && !(flags & MR_NO_BATCH) && !is_outlines_only_htl ) {
+		tmap_flags |= TMAP_FLAG_BATCH_TRANSFORMS;
+	}
+
+	if (is_outlines_only_htl) {
+		rendering_material.set_fill_mode(GR_FILL_MODE_WIRE);
+
+		color outline_color = render_info->get_color();
+		rendering_material.set_color(outline_color);
+
+		tmap_flags &= ~TMAP_FLAG_RGB;
+	} else {
+		rendering_material.set_fill_mode(GR_FILL_MODE_SOLID);
+	}
+
+	rendering_material.set_light_factor(1.0f);
+	
+	if ( !( flags & MR_NO_LIGHTING ) ) {
+		scene->set_light_filter(-1, pos, pm->submodel[submodel_num].rad);
+		rendering_material.set_lighting(true);
+	} else {
+		rendering_material.set_lighting(false);
+	}
+
+	// fixes disappearing HUD in OGL - taylor
+	rendering_material.set_cull_mode(true);
+
+	// RT - Put this here to fog debris
+	if( tmap_flags & TMAP_FLAG_PIXEL_FOG ) {
+		float fog_near, fog_far;
+		object *obj = NULL;
+
+		if (objnum >= 0)
+			obj = &Objects[objnum];
+
+		neb2_get_adjusted_fog_values(&fog_near, &fog_far, obj);
+		unsigned char r, g, b;
+		neb2_get_fog_color(&r, &g, &b);
+
+		rendering_material.set_fog(r, g, b, fog_near, fog_far);
+	} else {
+		rendering_material.set_fog();
+	}
+
+	if(Rendering_to_shadow_map) {
+		rendering_material.set_depth_bias(-1024);
+	} else {
+		rendering_material.set_depth_bias(0);
+	}
+
+	vec3d view_pos = scene->get_view_position();
+
+	if ( model_render_check_detail_box(&view_pos, pm, submodel_num, flags) ) {
+		int buffer_mn = submodel_num;
+
+		if ( tmap_flags & TMAP_FLAG_BATCH_TRANSFORMS ) {
+			// this only adds the transform of the submodel, the buffers are then drawn like the detail buffer of a model
+			scene->start_submodel_batch(submodel_num);
+			model_render_buffers(scene, &rendering_material, render_info, &pm->submodel[submodel_num].buffer, pm, submodel_num, 0, tmap_flags);
+
+			buffer_mn = -1;
+		}
+
+		model_render_buffers(scene, &rendering_material, render_info, &pm->submodel[submodel_num].buffer, pm, buffer_mn, 0, tmap_flags);
+
+		if ( pm->flags & PM_FLAG_TRANS_BUFFER && pm->submodel[submodel_num].trans_buffer.flags & VB_FLAG_TRANS ) {
+			model_render_buffers(scene, &rendering_material, render_info, &pm->submodel[submodel_num].trans_buffer, pm, buffer_mn, 0, tmap_flags);
+		}
+	}
+	
+	if ( pm->submodel[submodel_num].num_arcs )	{
+		model_render_add_lightning( scene, render_info, pm, &pm->submodel[submodel_num] );
+	}
+
+	if ( set_autocen ) {
+		scene->pop_transform();
+	}
+
+	scene->pop_transform();
+}
+
+/**
+ * The transform from the frame of a glow point or thruster bank into the world
+ *
+ * A point is at base + unrotate(pnt, pnt_orient) and its normal at unrotate(norm, norm_orient).
+ */
+struct model_bank_transform {
+	vec3d base;
+	matrix pnt_orient;
+	matrix norm_orient;
+};
+
+/**
+ * Gets the transform of a bank, with the rotations of its submodel if model_instance_num is not -1
+ *
+ * find_submodel_instance_point_normal() moves the point affinely and the normal linearly, so the transform is read off
+ * its results for the basis vectors. That way the points of a bank don't have to walk the submodel tree one by one.
+ */
+static void model_get_bank_transform(model_bank_transform *xform, int model_instance_num, int submodel_num, const vec3d *submodel_static_offset, const matrix *orient, const vec3d *pos)
+{
+	if ( model_instance_num < 0 ) {
+		xform->base = *pos;
+		xform->pnt_orient = *orient;
+		xform->norm_orient = *orient;
+		return;
+	}
+
+	// the points are given relative to the static offset of the submodel
+	vec3d origin = *submodel_static_offset;
+	vm_vec_negate(&origin);
+
+	vec3d local_base, unused;
+	find_submodel_instance_point_normal(&local_base, &unused, model_instance_num, submodel_num, &origin, &vmd_zero_vector);
+
+	const vec3d *axes[3] = { &vmd_x_vector, &vmd_y_vector, &vmd_z_vector };
+	vec3d *pnt_rows[3] = { &xform->pnt_orient.vec.rvec, &xform->pnt_orient.vec.uvec, &xform->pnt_orient.vec.fvec };
+	vec3d *norm_rows[3] = { &xform->norm_orient.vec.rvec, &xform->norm_orient.vec.uvec, &xform->norm_orient.vec.fvec };
+
+	for ( int i = 0; i < 3; ++i ) {
+		vec3d pnt, local_pnt, local_norm;
+		vm_vec_add(&pnt, &origin, axes[i]);
+
+		find_submodel_instance_point_normal(&local_pnt, &local_norm, model_instance_num, submodel_num, &pnt, axes[i]);
+		vm_vec_sub2(&local_pnt, &local_base);
+
+		// and then into the world
+		vm_vec_unrotate(pnt_rows[i], &local_pnt, orient);
+		vm_vec_unrotate(norm_rows[i], &local_norm, orient);
+	}
+
+	vm_vec_unrotate(&xform->base, &local_base, orient);
+	vm_vec_add2(&xform->base, pos);
+}
+
+static void model_bank_transform_point(vec3d *world_pnt, vec3d *world_norm, const model_bank_transform *xform, const glow_point *gpt)
+{
+	vm_vec_unrotate(world_pnt, &gpt->pnt, &xform->pnt_orient);
+	vm_vec_add2(world_pnt, &xform->base);
+
+	vm_vec_unrotate(world_norm, &gpt->norm, &xform->norm_orient);
+}
+
+/**
+ * The planes of the warp effects the glows of a ship are cut off by
+ */
+struct model_warp_clip {
+	int num_planes = 0;
+	vec3d pnt[2];
+	vec3d norm[2];		// points to the visible side
+};
+
+static void model_get_warp_clip(model_warp_clip *clip, ship *shipp)
+{
+	clip->num_planes = 0;
+
+	if ( shipp == NULL ) {
+		return;
+	}
+
+	if ( (shipp->is_arriving() ) && (shipp->warpin_effect) && Ship_info[shipp->ship_info_index].warpin_type != WT_HYPERSPACE) {
+		matrix warp_orient;
+
+		shipp->warpin_effect->getWarpPosition(&clip->pnt[clip->num_planes]);
+		shipp->warpin_effect->getWarpOrientation(&warp_orient);
+		clip->norm[clip->num_planes] = warp_orient.vec.fvec;
+		clip->num_planes++;
+	}
+
+	if ( (shipp->flags[Ship::Ship_Flags::Depart_warp] ) && (shipp->warpout_effect) && Ship_info[shipp->ship_info_index].warpout_type != WT_HYPERSPACE) {
+		matrix warp_orient;
+
+		shipp->warpout_effect->getWarpPosition(&clip->pnt[clip->num_planes]);
+		shipp->warpout_effect->getWarpOrientation(&warp_orient);
+		clip->norm[clip->num_planes] = warp_orient.vec.fvec;
+		vm_vec_negate(&clip->norm[clip->num_planes]);
+		clip->num_planes++;
+	}
+}
+
+static bool model_warp_clip_visible(const model_warp_clip *clip, const vec3d *world_pnt)
+{
+	for ( int i = 0; i < clip->num_planes; ++i ) {
+		vec3d tmp;
+		vm_vec_sub(&tmp, world_pnt, &clip->pnt[i]);
+
+		if ( vm_vec_dot(&tmp, &clip->norm[i]) < 0.0f ) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+// the points of the glow point bank being rendered, one array per component so the facing can be computed four at once
+static SCP_vector<float> Glow_bank_data;
+
+/**
+ * Computes how much each glow point faces the viewer, the dot product of the normal and the direction to the viewer
+ */
+static void model_glow_bank_facing(const float *px, const float *py, const float *pz, const float *nx, const float *ny, const float *nz, int num_points, float *facing)
+{
+	int i = 0;
+
+#ifdef MR_GLOW_USE_SSE
+	__m128 vx = _mm_set1_ps(View_position.xyz.x);
+	__m128 vy = _mm_set1_ps(View_position.xyz.y);
+	__m128 vz = _mm_set1_ps(View_position.xyz.z);
+	__m128 min_len = _mm_set1_ps(1e-16f);
+
+	for ( ; i + 4 <= num_points; i += 4 ) {
+		__m128 dx = _mm_sub_ps(vx, _mm_loadu_ps(px + i));
+		__m128 dy = _mm_sub_ps(vy, _mm_loadu_ps(py + i));
+		__m128 dz = _mm_sub_ps(vz, _mm_loadu_ps(pz + i));
+
+		__m128 len = _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz)));
+
+		__m128 dot = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, _mm_loadu_ps(nx + i)), _mm_mul_ps(dy, _mm_loadu_ps(ny + i))),
+			_mm_mul_ps(dz, _mm_loadu_ps(nz + i)));
+
+		_mm_storeu_ps(facing + i, _mm_div_ps(dot, _mm_max_ps(len, min_len)));
+	}
+#endif
+
+	for ( ; i < num_points; ++i ) {
+		float dx = View_position.xyz.x - px[i];
+		float dy = View_position.xyz.y - py[i];
+		float dz = View_position.xyz.z - pz[i];
+
+		float len = fl_sqrt(dx * dx + dy * dy + dz * dz);
 
-	if ( !( Game_detail_flags & DETAIL_FLAG_MODELS ) )	return;
-	
-	if ( render_info->is_clip_plane_set() ) {
-		rendering_material.set_clip_plane(render_info->get_clip_plane_normal(), render_info->get_clip_plane_pos());
+		facing[i] = (dx * nx[i] + dy * ny[i] + dz * nz[i]) / MAX(len, 1e-16f);
 	}
+}
 
-	if ( render_info->is_team_color_set() ) {
-		rendering_material.set_team_color(render_info->get_team_color());
-	}
-		
-	uint flags = render_info->get_model_flags();
-	int objnum = render_info->get_object_number();
+/**
+ * Checks if a bank can be rendered by model_render_glowpoint_bank(), the others go through model_render_glowpoint()
+ * one point at a time
+ */
+static bool model_glowpoint_bank_is_batched(glow_point_bank *bank, glow_point_bank_override *gpo)
+{
+	int type = (gpo && gpo->type_override) ? gpo->type : bank->type;
 
-	pm = model_get(model_num);
+	// the lights of a bank depend on the pulse of each point
+	return type == 0 && !(Deferred_lighting && gpo && gpo->is_lightsource);
+}
 
-	// Set the flags we will pass to the tmapper
-	uint tmap_flags = TMAP_FLAG_GOURAUD | TMAP_FLAG_RGB;
+/**
+ * Renders all points of a bank with the default glow type
+ *
+ * Same as model_render_glowpoint() for each point but the transform and the warp planes are only computed once and
+ * the facing of the points is computed together. The bitmaps all go to the same batch so they are drawn together.
+ */
+static void model_render_glowpoint_bank(glow_point_bank *bank, glow_point_bank_override *gpo, polymodel *pm, ship *shipp, const model_warp_clip *warp_clip, matrix *orient, vec3d *pos, bool use_depth_buffer)
+{
+	int bitmap_id = (gpo && gpo->glow_bitmap_override) ? gpo->glow_bitmap : bank->glow_bitmap;
 
-	// if we're in nebula mode
-	if( ( The_mission.flags[Mission::Mission_Flags::Fullneb] ) && ( Neb2_render_mode != NEB2_RENDER_NONE ) ) {
-		tmap_flags |= TMAP_FLAG_PIXEL_FOG;
+	if ( bitmap_id < 0 || bank->num_points <= 0 ) {
+		return;
 	}
 
-	if ( !( flags & MR_NO_TEXTURING ) )	{
-		tmap_flags |= TMAP_FLAG_TEXTURED;
+	Assert( bank->points != NULL );
 
-		if ( ( pm->flags & PM_FLAG_ALLOW_TILING ) && tiling )
-			tmap_flags |= TMAP_FLAG_TILED;
+	vec3d submodel_static_offset = vmd_zero_vector;
+	int model_instance_num = -1;
 
-		if ( !( flags & MR_NO_CORRECT ) )	{
-			tmap_flags |= TMAP_FLAG_CORRECT;
-		}
-	}
+	if ( bank->submodel_parent > 0 && pm->submodel[bank->submodel_parent].can_move && (gameseq_get_state_idx(GS_STATE_LAB) == -1) && shipp != NULL ) {
+		model_find_submodel_offset(&submodel_static_offset, Ship_info[shipp->ship_info_index].model_num, bank->submodel_parent);
 
-	if ( render_info->get_animated_effect_num() >= 0 ) {
-		tmap_flags |= TMAP_ANIMATED_SHADER;
-		rendering_material.set_animated_effect(render_info->get_animated_effect_num(), render_info->get_animated_effect_timer());
+		model_instance_num = shipp->model_instance_num;
 	}
 
-	bool is_outlines_only_htl = (flags & MR_NO_POLYS) && (flags & MR_SHOW_OUTLINE_HTL);
+	model_bank_transform xform;
+	model_get_bank_transform(&xform, model_instance_num, bank->submodel_parent, &submodel_static_offset, orient, pos);
 
-	//set to true since D3d and OGL need the api matrices set
-	scene->push_transform(pos, orient);
+	int num_points = bank->num_points;
 
-	
-	vec3d auto_back = ZERO_VECTOR;
-	bool set_autocen = model_render_determine_autocenter(&auto_back, pm, render_info->get_detail_level_lock(), flags);
+	Glow_bank_data.resize(num_points * 7);
 
-	if ( set_autocen ) {
-		scene->push_transform(&auto_back, NULL);
+	float *px = &Glow_bank_data[0];
+	float *py = px + num_points;
+	float *pz = py + num_points;
+	float *nx = pz + num_points;
+	float *ny = nx + num_points;
+	float *nz = ny + num_points;
+	float *facing = nz + num_points;
+
+	for ( int j = 0; j < num_points; j++ ) {
+		vec3d world_pnt, world_norm;
+		model_bank_transform_point(&world_pnt, &world_norm, &xform, &bank->points[j]);
+
+		px[j] = world_pnt.xyz.x;
+		py[j] = world_pnt.xyz.y;
+		pz[j] = world_pnt.xyz.z;
+		nx[j] = world_norm.xyz.x;
+		ny[j] = world_norm.xyz.y;
+		nz[j] = world_norm.xyz.z;
 	}
 
-	if (is_outlines_only_htl) {
-		rendering_material.set_fill_mode(GR_FILL_MODE_WIRE);
+	model_glow_bank_facing(px, py, pz, nx, ny, nz, num_points, facing);
 
-		color outline_color = render_info->get_color();
-		rendering_material.set_color(outline_color);
+	int num_arcs = pm->submodel[pm->detail[0]].num_arcs;
+	bool fullneb = The_mission.flags[Mission::Mission_Flags::Fullneb];
 
-		tmap_flags &= ~TMAP_FLAG_RGB;
-	} else {
-		rendering_material.set_fill_mode(GR_FILL_MODE_SOLID);
-	}
+	for ( int j = 0; j < num_points; j++ ) {
+		glow_point *gpt = &bank->points[j];
 
-	rendering_material.set_light_factor(1.0f);
-	
-	if ( !( flags & MR_NO_LIGHTING ) ) {
-		scene->set_light_filter(-1, pos, pm->submodel[submodel_num].rad);
-		rendering_material.set_lighting(true);
-	} else {
-		rendering_material.set_lighting(false);
-	}
+		if ( num_arcs ) {
+			//the more damage, the more arcs, the more likely the lights will fail
+			if ( static_rand( timestamp() % 20 ) % (num_arcs + j) != 1 ) {
+				continue;
+			}
+		}
 
-	// fixes disappearing HUD in OGL - taylor
-	rendering_material.set_cull_mode(true);
+		vec3d world_pnt;
+		world_pnt.xyz.x = px[j];
+		world_pnt.xyz.y = py[j];
+		world_pnt.xyz.z = pz[j];
 
-	// RT - Put this here to fog debris
-	if( tmap_flags & TMAP_FLAG_PIXEL_FOG ) {
-		float fog_near, fog_far;
-		object *obj = NULL;
+		if ( !model_warp_clip_visible(warp_clip, &world_pnt) ) {
+			continue;
+		}
 
-		if (objnum >= 0)
-			obj = &Objects[objnum];
+		float d;
 
-		neb2_get_adjusted_fog_values(&fog_near, &fog_far, obj);
-		unsigned char r, g, b;
-		neb2_get_fog_color(&r, &g, &b);
+		if ( IS_VEC_NULL(&gpt->norm) ) {
+			d = 1.0f;	//if given a nul vector then always show it
+		} else {
+			d = facing[j] - 0.25f;
+		}
 
-		rendering_material.set_fog(r, g, b, fog_near, fog_far);
-	} else {
-		rendering_material.set_fog();
-	}
+		if ( d <= 0.0f ) {
+			continue;
+		}
 
-	if(Rendering_to_shadow_map) {
-		rendering_material.set_depth_bias(-1024);
-	} else {
-		rendering_material.set_depth_bias(0);
-	}
+		float w = gpt->radius;
 
-	vec3d view_pos = scene->get_view_position();
+		d *= 3.0f;
 
-	if ( model_render_check_detail_box(&view_pos, pm, submodel_num, flags) ) {
-		model_render_buffers(scene, &rendering_material, render_info, &pm->submodel[submodel_num].buffer, pm, submodel_num, 0, tmap_flags);
+		if (d > 1.0f)
+			d = 1.0f;
 
-		if ( pm->flags & PM_FLAG_TRANS_BUFFER && pm->submodel[submodel_num].trans_buffer.flags & VB_FLAG_TRANS ) {
-			model_render_buffers(scene, &rendering_material, render_info, &pm->submodel[submodel_num].trans_buffer, pm, submodel_num, 0, tmap_flags);
+		// fade them in the nebula as well
+		if ( fullneb ) {
+			d *= (1.0f - neb2_get_fog_intensity(&world_pnt));
+			w *= 1.5;	//make it bigger in a nebula
 		}
-	}
-	
-	if ( pm->submodel[submodel_num].num_arcs )	{
-		model_render_add_lightning( scene, render_info, pm, &pm->submodel[submodel_num] );
-	}
 
-	if ( set_autocen ) {
-		scene->pop_transform();
-	}
+		vertex p;
+		g3_transfer_vertex(&p, &world_pnt);
 
-	scene->pop_transform();
+		p.r = p.g = p.b = p.a = (ubyte)(255.0f * MAX(d,0.0f));
+
+		if ( use_depth_buffer ) {
+			batching_add_volume_bitmap(bitmap_id, &p, 0, (w * 0.5f), d, w);
+		} else {
+			batching_add_bitmap(bitmap_id, &p, 0, (w * 0.5f), d, w);
+		}
+	}
 }
 
 void model_render_glowpoint(int point_num, vec3d *pos, matrix *orient, glow_point_bank *bank, glow_point_bank_override *gpo, polymodel *pm, ship* shipp, bool use_depth_buffer)
@@ -1919,6 +2977,9 @@ void model_render_glow_points(polymodel *pm, ship *shipp, matrix *orient, vec3d
 		}
 	}
 
+	model_warp_clip warp_clip;
+	model_get_warp_clip(&warp_clip, shipp);
+
 	for (i = 0; i < pm->n_glow_point_banks; i++ ) {
 		glow_point_bank *bank = &pm->glow_point_banks[i];
 
@@ -1942,6 +3003,11 @@ void model_render_glow_points(polymodel *pm, ship *shipp, matrix *orient, vec3d
 			if ( (shipp != NULL) && !(shipp->glow_point_bank_active[i]) )
 				continue;
 
+			if ( model_glowpoint_bank_is_batched(bank, gpo) ) {
+				model_render_glowpoint_bank(bank, gpo, pm, shipp, &warp_clip, orient, pos, use_depth_buffer);
+				continue;
+			}
+
 			for (j = 0; j < bank->num_points; j++) {
 				Assert( bank->points != NULL );
 				int flick;
@@ -2025,9 +3091,12 @@ void model_queue_render_thrusters(model_render_params *interp, polymodel *pm, in
 	norm.xyz.y *= thruster_info.rotvel.xyz.x/2;
 	vm_vec_normalize(&norm);
 
+	model_warp_clip warp_clip;
+	model_get_warp_clip(&warp_clip, shipp);
+
 	for (i = 0; i < pm->n_thrusters; i++ ) {
-		vec3d submodel_static_offset; // The associated submodel's static offset in the ship's frame of reference
-		bool submodel_rotation = false;
+		vec3d submodel_static_offset = vmd_zero_vector; // The associated submodel's static offset in the ship's frame of reference
+		int model_instance_num = -1;
 
 		bank = &pm->thrusters[i];
 
@@ -2044,62 +3113,31 @@ void model_queue_render_thrusters(model_render_params *interp, polymodel *pm, in
 		if ( bank->submodel_num > -1 && pm->submodel[bank->submodel_num].can_move && (gameseq_get_state_idx(GS_STATE_LAB) == -1) ) {
 			model_find_submodel_offset(&submodel_static_offset, Ship_info[shipp->ship_info_index].model_num, bank->submodel_num);
 
-			submodel_rotation = true;
+			model_instance_num = shipp->model_instance_num;
 		}
 
+		// the transform is the same for all points of the bank
+		model_bank_transform xform;
+		model_get_bank_transform(&xform, model_instance_num, bank->submodel_num, &submodel_static_offset, orient, pos);
+
 		for (j = 0; j < bank->num_points; j++) {
 			Assert( bank->points != NULL );
 
 			float d, D;
 			vec3d tempv;
 			glow_point *gpt = &bank->points[j];
-			vec3d loc_offset = gpt->pnt;
-			vec3d loc_norm = gpt->norm;
 			vec3d world_pnt;
 			vec3d world_norm;
 
-			if ( submodel_rotation ) {
-				vm_vec_sub(&loc_offset, &gpt->pnt, &submodel_static_offset);
-
-				tempv = loc_offset;
-				find_submodel_instance_point_normal(&loc_offset, &loc_norm, shipp->model_instance_num, bank->submodel_num, &tempv, &loc_norm);
-			}
-
-			vm_vec_unrotate(&world_pnt, &loc_offset, orient);
-			vm_vec_add2(&world_pnt, pos);
-
-			if (shipp) {
-				// if ship is warping out, check position of the engine glow to the warp plane
-				if ( (shipp->is_arriving() ) && (shipp->warpin_effect) && Ship_info[shipp->ship_info_index].warpin_type != WT_HYPERSPACE) {
-					vec3d warp_pnt, tmp;
-					matrix warp_orient;
-
-					shipp->warpin_effect->getWarpPosition(&warp_pnt);
-					shipp->warpin_effect->getWarpOrientation(&warp_orient);
-					vm_vec_sub( &tmp, &world_pnt, &warp_pnt );
-
-					if ( vm_vec_dot( &tmp, &warp_orient.vec.fvec ) < 0.0f ) {
-						break;
-					}
-				}
-
-				if ( (shipp->flags[Ship::Ship_Flags::Depart_warp] ) && (shipp->warpout_effect) && Ship_info[shipp->ship_info_index].warpout_type != WT_HYPERSPACE) {
-					vec3d warp_pnt, tmp;
-					matrix warp_orient;
-
-					shipp->warpout_effect->getWarpPosition(&warp_pnt);
-					shipp->warpout_effect->getWarpOrientation(&warp_orient);
-					vm_vec_sub( &tmp, &world_pnt, &warp_pnt );
+			model_bank_transform_point(&world_pnt, &world_norm, &xform, gpt);
 
-					if ( vm_vec_dot( &tmp, &warp_orient.vec.fvec ) > 0.0f ) {
-						break;
-					}
-				}
+			// if ship is warping out, check position of the engine glow to the warp plane
+			if ( !model_warp_clip_visible(&warp_clip, &world_pnt) ) {
+				break;
 			}
 
 			vm_vec_sub(&tempv, &View_position, &world_pnt);
 			vm_vec_normalize(&tempv);
-			vm_vec_unrotate(&world_norm, &loc_norm, orient);
 			D = d = vm_vec_dot(&tempv, &world_norm);
 
 			// ADAM: Min throttle draws rad*MIN_SCALE, max uses max.
@@ -2524,10 +3562,91 @@ void model_render_immediate(model_render_params *render_info, int model_num, mat
 	}
 }
 
-void model_render_queue(model_render_params *interp, model_draw_list *scene, int model_num, matrix *orient, vec3d *pos)
+/**
+ * Queues the buffers of the submodels and the hull of a model
+ */
+static void model_render_queue_buffers(model_draw_list *scene, model_material *rendering_material, model_render_params *interp, polymodel *pm, polymodel_instance *pmi, int detail_level, int detail_buffer, uint tmap_flags, bool is_outlines_only, bool is_outlines_only_htl)
 {
 	int i;
+	const int model_flags = interp->get_model_flags();
 
+	if ( (tmap_flags & TMAP_FLAG_BATCH_TRANSFORMS) ) {
+		scene->start_model_batch(pm->n_models);
+		model_render_buffers(scene, rendering_material, interp, &pm->detail_buffers[detail_buffer], pm, -1, detail_level, tmap_flags);
+	}
+		
+	// Draw the subobjects
+	bool draw_thrusters = false;
+	bool trans_buffer = false;
+	i = pm->submodel[pm->detail[detail_level]].first_child;
+
+	while( i >= 0 )	{
+		if ( !pm->submodel[i].is_thruster ) {
+			model_render_children_buffers( scene, rendering_material, interp, pm, pmi, i, detail_level, tmap_flags, trans_buffer );
+		} else {
+			draw_thrusters = true;
+		}
+
+		i = pm->submodel[i].next_sibling;
+	}
+
+	//*************************** draw the hull of the ship *********************************************
+	vec3d view_pos = scene->get_view_position();
+
+	if ( model_render_check_detail_box(&view_pos, pm, pm->detail[detail_level], model_flags) && !model_render_submodel_culled(scene, interp, pm, pm->detail[detail_level]) ) {
+		int detail_model_num = pm->detail[detail_level];
+
+		if ( (is_outlines_only || is_outlines_only_htl) && pm->submodel[detail_model_num].outline_buffer != NULL ) {
+			color outline_color = interp->get_color();
+			scene->add_outline(pm->submodel[detail_model_num].outline_buffer, pm->submodel[detail_model_num].n_verts_outline, &outline_color);
+		} else {
+			model_render_buffers(scene, rendering_material, interp, &pm->submodel[detail_model_num].buffer, pm, detail_model_num, detail_level, tmap_flags);
+
+			if ( pm->submodel[detail_model_num].num_arcs ) {
+				model_render_add_lightning( scene, interp, pm, &pm->submodel[detail_model_num] );
+			}
+		}
+	}
+	
+	// make sure batch rendering is unconditionally off.
+	tmap_flags &= ~TMAP_FLAG_BATCH_TRANSFORMS;
+
+	if ( pm->flags & PM_FLAG_TRANS_BUFFER && !(is_outlines_only || is_outlines_only_htl) ) {
+		trans_buffer = true;
+		i = pm->submodel[pm->detail[detail_level]].first_child;
+
+		while( i >= 0 )	{
+			if ( !pm->submodel[i].is_thruster ) {
+				model_render_children_buffers( scene, rendering_material, interp, pm, pmi, i, detail_level, tmap_flags, trans_buffer );
+			}
+
+			i = pm->submodel[i].next_sibling;
+		}
+
+		view_pos = scene->get_view_position();
+
+		if ( model_render_check_detail_box(&view_pos, pm, pm->detail[detail_level], model_flags) && !model_render_submodel_culled(scene, interp, pm, pm->detail[detail_level]) ) {
+			int detail_model_num = pm->detail[detail_level];
+			model_render_buffers(scene, rendering_material, interp, &pm->submodel[detail_model_num].trans_buffer, pm, detail_model_num, detail_level, tmap_flags);
+		}
+	}
+
+	// Draw the thruster subobjects
+	if ( draw_thrusters && !(is_outlines_only || is_outlines_only_htl) ) {
+		i = pm->submodel[pm->detail[detail_level]].first_child;
+		trans_buffer = false;
+
+		while( i >= 0 ) {
+			if (pm->submodel[i].is_thruster) {
+				model_render_children_buffers( scene, rendering_material, interp, pm, pmi, i, detail_level, tmap_flags, trans_buffer );
+			}
+			i = pm->submodel[i].next_sibling;
+		}
+	}
+}
+
+void model_render_queue(model_render_params *interp, model_draw_list *scene, int model_num, matrix *orient, vec3d *pos)
+{
 	const int objnum = interp->get_object_number();
 	const int model_flags = interp->get_model_flags();
 
@@ -2708,79 +3827,28 @@ void model_render_queue(model_render_params *interp, model_draw_list *scene, int
 		tmap_flags |= TMAP_FLAG_BATCH_TRANSFORMS;
 	}
 
-	if ( (tmap_flags & TMAP_FLAG_BATCH_TRANSFORMS) ) {
-		scene->start_model_batch(pm->n_models);
-		model_render_buffers(scene, &rendering_material, interp, &pm->detail_buffers[detail_level], pm, -1, detail_level, tmap_flags);
-	}
-		
-	// Draw the subobjects
-	bool draw_thrusters = false;
-	bool trans_buffer = false;
-	i = pm->submodel[pm->detail[detail_level]].first_child;
-
-	while( i >= 0 )	{
-		if ( !pm->submodel[i].is_thruster ) {
-			model_render_children_buffers( scene, &rendering_material, interp, pm, pmi, i, detail_level, tmap_flags, trans_buffer );
-		} else {
-			draw_thrusters = true;
-		}
+	int detail_buffer = detail_level;
 
-		i = pm->submodel[i].next_sibling;
+	if ( (tmap_flags & TMAP_FLAG_BATCH_TRANSFORMS) && detail_level == 0 ) {
+		detail_buffer = model_render_determine_generated_lod(depth, objnum, pm, interp->get_detail_level_lock());
 	}
 
 	model_radius = pm->submodel[pm->detail[detail_level]].rad;
 
-	//*************************** draw the hull of the ship *********************************************
-	vec3d view_pos = scene->get_view_position();
-
-	if ( model_render_check_detail_box(&view_pos, pm, pm->detail[detail_level], model_flags) ) {
-		int detail_model_num = pm->detail[detail_level];
-
-		if ( (is_outlines_only || is_outlines_only_htl) && pm->submodel[detail_model_num].outline_buffer != NULL ) {
-			color outline_color = interp->get_color();
-			scene->add_outline(pm->submodel[detail_model_num].outline_buffer, pm->submodel[detail_model_num].n_verts_outline, &outline_color);
-		} else {
-			model_render_buffers(scene, &rendering_material, interp, &pm->submodel[detail_model_num].buffer, pm, detail_model_num, detail_level, tmap_flags);
-
-			if ( pm->submodel[detail_model_num].num_arcs ) {
-				model_render_add_lightning( scene, interp, pm, &pm->submodel[detail_model_num] );
-			}
-		}
-	}
-	
-	// make sure batch rendering is unconditionally off.
-	tmap_flags &= ~TMAP_FLAG_BATCH_TRANSFORMS;
-
-	if ( pm->flags & PM_FLAG_TRANS_BUFFER && !(is_outlines_only || is_outlines_only_htl) ) {
-		trans_buffer = true;
-		i = pm->submodel[pm->detail[detail_level]].first_child;
-
-		while( i >= 0 )	{
-			if ( !pm->submodel[i].is_thruster ) {
-				model_render_children_buffers( scene, &rendering_material, interp, pm, pmi, i, detail_level, tmap_flags, trans_buffer );
-			}
-
-			i = pm->submodel[i].next_sibling;
-		}
-
-		view_pos = scene->get_view_position();
+	model_retained_state *retained = model_render_get_retained_state(interp, objnum, pm, pmi, detail_level, detail_buffer, tmap_flags, &rendering_material, pos, orient);
 
-		if ( model_render_check_detail_box(&view_pos, pm, pm->detail[detail_level], model_flags) ) {
-			int detail_model_num = pm->detail[detail_level];
-			model_render_buffers(scene, &rendering_material, interp, &pm->submodel[detail_model_num].trans_buffer, pm, detail_model_num, detail_level, tmap_flags);
-		}
-	}
+	if ( retained != NULL && retained->recorded ) {
+		scene->add_retained_buffer_draws(&retained->draws);
+	} else {
+		size_t first_draw = scene->get_num_buffer_draws();
+		uint submodels_culled = Model_submodels_culled;
 
-	// Draw the thruster subobjects
-	if ( draw_thrusters && !(is_outlines_only || is_outlines_only_htl) ) {
-		i = pm->submodel[pm->detail[detail_level]].first_child;
-		trans_buffer = false;
+		model_render_queue_buffers(scene, &rendering_material, interp, pm, pmi, detail_level, detail_buffer, tmap_flags, is_outlines_only, is_outlines_only_htl);
 
-		while( i >= 0 ) {
-			if (pm->submodel[i].is_thruster) {
-				model_render_children_buffers( scene, &rendering_material, interp, pm, pmi, i, detail_level, tmap_flags, trans_buffer );
-			}
-			i = pm->submodel[i].next_sibling;
+		// what was culled depends on the view so these draws are only good for this frame
+		if ( retained != NULL && retained->unchanged_frames > 0 && submodels_culled == Model_submodels_culled ) {
+			scene->retain_buffer_draws(first_draw, (tmap_flags & TMAP_FLAG_BATCH_TRANSFORMS) != 0, &retained->draws);
+			retained->recorded = true;
 		}
 	}
 
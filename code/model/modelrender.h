@@ -10,6 +10,7 @@
 #ifndef _MODELRENDER_H
 #define _MODELRENDER_H
 
+#include "globalincs/frame_arena.h"
 #include "graphics/material.h"
 #include "lighting/lighting.h"
 #include "math/vecmat.h"
@@ -180,6 +181,14 @@ struct queued_buffer_draw
 {
 	size_t transform_buffer_offset;
 
+	// batched draws of identical models are drawn as instances, the transforms of each instance follow the ones of the
+	// previous instance in the transform buffer
+	int num_instances;
+	size_t instance_stride;
+
+	// the model id of the first transform, the draws of a single submodel only add the transform of that submodel
+	size_t first_model_id;
+
 	model_material render_material;
 
 	matrix4 transform;
@@ -188,16 +197,40 @@ struct queued_buffer_draw
 	indexed_vertex_source *vert_src;
 	vertex_buffer *buffer;
 	size_t texi;
+
+	// the number of texture buffers from texi on which are drawn at once, see model_draw_list::merge_draws()
+	size_t texi_count;
+
 	int flags;
 	int sdr_flags;
 
 	light_indexing_info lights;
 
+	// packed render state the draws are sorted by, see model_draw_list::compute_sort_key()
+	std::uint64_t sort_key;
+
 	queued_buffer_draw()
 	{
 	}
 };
 
+/**
+ * The buffer draws of a model which can be queued again as long as nothing about the model changed
+ */
+struct retained_buffer_draws
+{
+	SCP_vector<queued_buffer_draw> draws;
+
+	// the transforms of the batched submodels, empty if the model wasn't batched
+	SCP_vector<matrix4> transforms;
+};
+
+struct draw_sort_entry
+{
+	std::uint64_t key;
+	int index;
+};
+
 struct outline_draw
 {
 	vertex* vert_array;
@@ -214,15 +247,23 @@ class model_batch_buffer
 	size_t Mem_alloc_size;
 
 	size_t Current_offset;
+	size_t Current_num_models;
+	size_t Current_first_model;
 
 	void allocate_memory();
 public:
-	model_batch_buffer() : Mem_alloc(NULL), Mem_alloc_size(0), Current_offset(0) {};
+	model_batch_buffer() : Mem_alloc(NULL), Mem_alloc_size(0), Current_offset(0), Current_num_models(0), Current_first_model(0) {};
 
 	void reset();
 
 	size_t get_buffer_offset();
+	size_t get_num_models();
+	size_t get_first_model();
 	void set_num_models(int n_models);
+	void set_single_model(int model_id);
+	size_t copy_transforms(size_t offset, size_t count);
+	void get_transforms(size_t offset, size_t count, SCP_vector<matrix4> &transforms);
+	size_t add_transforms(const SCP_vector<matrix4> &transforms);
 	void set_model_transform(matrix4 &transform, int model_id);
 
 	void submit_buffer_data();
@@ -243,25 +284,40 @@ class model_draw_list
 	void render_outline(outline_draw &outline_info);
 	void render_buffer(queued_buffer_draw &render_elements);
 	
-	SCP_vector<queued_buffer_draw> Render_elements;
-	SCP_vector<int> Render_keys;
+	SCP_frame_vector<queued_buffer_draw> Render_elements;
+	SCP_frame_vector<int> Render_keys;
 
-	SCP_vector<arc_effect> Arcs;
-	SCP_vector<insignia_draw_data> Insignias;
-	SCP_vector<outline_draw> Outlines;
+	// shader flags of the queued draws, the position in here is used for the sort key
+	SCP_frame_vector<int> Sort_shader_flags;
 
-	static bool sort_draw_pair(model_draw_list* target, const int a, const int b);
+	// scratch buffers of the sort
+	SCP_frame_vector<draw_sort_entry> Sort_entries;
+	SCP_frame_vector<draw_sort_entry> Sort_scratch;
+
+	SCP_frame_vector<arc_effect> Arcs;
+	SCP_frame_vector<insignia_draw_data> Insignias;
+	SCP_frame_vector<outline_draw> Outlines;
+
+	std::uint64_t compute_sort_key(queued_buffer_draw *draw_data);
 	void sort_draws();
+	void build_instanced_draws();
+	void merge_draws();
 public:
 	model_draw_list();
 	void init();
 
 	void add_submodel_to_batch(int model_num);
 	void start_model_batch(int n_models);
+	void start_submodel_batch(int model_num);
 
 	void add_buffer_draw(model_material *render_material, indexed_vertex_source *vert_src, vertex_buffer *buffer, size_t texi, uint tmap_flags);
+
+	size_t get_num_buffer_draws();
+	void retain_buffer_draws(size_t first_draw, bool batched, retained_buffer_draws *retained);
+	void add_retained_buffer_draws(retained_buffer_draws *retained);
 	
 	vec3d get_view_position();
+	const matrix4 &get_transform();
 	void push_transform(vec3d* pos, matrix* orient);
 	void pop_transform();
 	void set_scale(vec3d *scale = NULL);
@@ -279,6 +335,7 @@ public:
 
 	void init_render(bool sort = true);
 	void render_all(gr_zbuffer_type depth_mode = ZBUFFER_TYPE_DEFAULT);
+	void render_depth_prepass();
 	void reset();
 };
 
@@ -14,6 +14,7 @@
 #include "ddsutils/ddsutils.h"
 #include "debugconsole/console.h"
 #include "freespace.h"
+#include "graphics/material.h"
 #include "jpgutils/jpgutils.h"
 #include "mission/missionparse.h"
 #include "nebula/neb.h"
@@ -26,6 +27,9 @@
 #include "tgautils/tgautils.h"
 #include "tracing/tracing.h"
 
+#include <algorithm>
+#include <cstddef>
+
 
 // --------------------------------------------------------------------------------------------------------
 // NEBULA DEFINES/VARS
@@ -216,6 +220,30 @@ int Neb2_background_color[3] = {0, 0, 255};			// rgb background color (used for
 
 int Neb2_regen = 0;
 
+// the layout of a poof in the vertex buffer, see effect-v.sdr
+struct neb2_gpu_poof {
+	vec3d pos;
+	float rot;			// angle in radians at the start of the poof clock
+	float rot_speed;	// radians per second
+	float radius;
+};
+
+// the poofs which use the same bitmap are next to each other in the buffer
+struct neb2_poof_range {
+	int bitmap;
+	int offset;
+	int count;
+};
+
+// the poofs are only uploaded again when the cube around the eye changed
+static int Neb2_poof_buffer = -1;
+static bool Neb2_poof_buffer_dirty = true;
+static float Neb2_poof_buffer_radius = 0.0f;
+static SCP_vector<neb2_poof_range> Neb2_poof_ranges;
+
+// advances with the frametime, the poofs turn with it on the GPU
+static float Neb2_poof_time = 0.0f;
+
 // --------------------------------------------------------------------------------------------------------
 // NEBULA FORWARD DECLARATIONS
 //
@@ -444,6 +472,13 @@ void neb2_level_close()
 		}
 	}
 
+	if (Neb2_poof_buffer >= 0) {
+		gr_delete_buffer(Neb2_poof_buffer);
+		Neb2_poof_buffer = -1;
+	}
+	Neb2_poof_ranges.clear();
+	Neb2_poof_buffer_dirty = true;
+
 	// unflag the mission as being fullneb so stuff doesn't fog in the techdata room :D
     The_mission.flags.remove(Mission::Mission_Flags::Fullneb);
 
@@ -810,6 +845,9 @@ void neb2_gen_slice(int xyz, int src, vec3d *cube_center)
 	cube_corner.xyz.x -= (Nd->cube_dim / 2.0f);
 	cube_corner.xyz.y -= (Nd->cube_dim / 2.0f);
 	cube_corner.xyz.z -= (Nd->cube_dim / 2.0f);
+
+	Neb2_poof_buffer_dirty = true;
+
 	switch(xyz) {
 		case 0:
 			for (idx1=0; idx1<Neb2_slices; idx1++) {
@@ -908,6 +946,105 @@ DCF(max_area, "")
 }
 */
 
+// the poofs can be drawn as soft particles which the shader turns and fades
+static bool neb2_poofs_on_gpu()
+{
+	return gr_is_capable(CAPABILITY_SOFT_PARTICLES) && gr_is_capable(CAPABILITY_POINT_PARTICLES);
+}
+
+static void neb2_upload_poofs()
+{
+	SCP_vector<neb2_gpu_poof> poofs;
+	SCP_vector<int> bitmaps;
+
+	for (int idx1 = 0; idx1 < Neb2_slices; idx1++) {
+		for (int idx2 = 0; idx2 < Neb2_slices; idx2++) {
+			for (int idx3 = 0; idx3 < Neb2_slices; idx3++) {
+				auto &cube = Neb2_cubes[idx1][idx2][idx3];
+
+				if (cube.bmap == -1) {
+					continue;
+				}
+
+				neb2_gpu_poof poof;
+				poof.pos = cube.pt;
+				poof.rot = fl_radians(cube.rot);
+				poof.rot_speed = fl_radians(cube.rot_speed);
+				poof.radius = Nd->prad;
+
+				poofs.push_back(poof);
+				bitmaps.push_back(cube.bmap);
+			}
+		}
+	}
+
+	// group the poofs by bitmap so each bitmap is a single draw
+	SCP_vector<size_t> order(poofs.size());
+	for (size_t i = 0; i < order.size(); i++) {
+		order[i] = i;
+	}
+	std::stable_sort(order.begin(), order.end(), [&bitmaps](size_t a, size_t b) { return bitmaps[a] < bitmaps[b]; });
+
+	SCP_vector<neb2_gpu_poof> sorted;
+	sorted.reserve(poofs.size());
+	Neb2_poof_ranges.clear();
+
+	for (auto i : order) {
+		if (Neb2_poof_ranges.empty() || Neb2_poof_ranges.back().bitmap != bitmaps[i]) {
+			Neb2_poof_ranges.push_back({ bitmaps[i], (int)sorted.size(), 0 });
+		}
+		Neb2_poof_ranges.back().count++;
+
+		sorted.push_back(poofs[i]);
+	}
+
+	if (Neb2_poof_buffer < 0) {
+		Neb2_poof_buffer = gr_create_vertex_buffer();
+	}
+
+	if (!sorted.empty()) {
+		gr_update_buffer_data(Neb2_poof_buffer, sorted.size() * sizeof(neb2_gpu_poof), sorted.data());
+	}
+
+	Neb2_poof_buffer_dirty = false;
+	Neb2_poof_buffer_radius = Nd->prad;
+}
+
+// the positions stay on the GPU, the shader computes the rotation and the fade of every poof and blends it softly
+// against the scene depth
+static void neb2_render_poofs_gpu()
+{
+	GR_DEBUG_SCOPE("Nebula render poofs");
+
+	if (Neb2_poof_buffer_dirty || (Neb2_poof_buffer_radius != Nd->prad)) {
+		neb2_upload_poofs();
+	}
+
+	vertex_layout layout;
+	layout.add_vertex_component(vertex_format_data::POSITION3, sizeof(neb2_gpu_poof), (int)offsetof(neb2_gpu_poof, pos));
+	layout.add_vertex_component(vertex_format_data::TEX_COORD, sizeof(neb2_gpu_poof), (int)offsetof(neb2_gpu_poof, rot));
+	layout.add_vertex_component(vertex_format_data::RADIUS, sizeof(neb2_gpu_poof), (int)offsetof(neb2_gpu_poof, radius));
+
+	vec4 shells;
+	shells.xyzw.x = Nd->cube_inner;
+	shells.xyzw.y = Nd->cube_outer;
+	shells.xyzw.z = Nd->prad / 4.0f;
+	shells.xyzw.w = Nd->max_alpha_glide;
+
+	vec3d break_dist;
+	break_dist.xyz.x = Nd->break_x;
+	break_dist.xyz.y = Nd->break_y;
+	break_dist.xyz.z = Nd->break_alpha;
+
+	for (auto &range : Neb2_poof_ranges) {
+		particle_material material_def;
+		material_set_unlit_volume(&material_def, range.bitmap, true);
+		material_def.set_nebula_poofs(Neb2_poof_time, shells, break_dist);
+
+		gr_render_primitives_particle(&material_def, PRIM_TYPE_POINTS, &layout, range.offset, range.count, Neb2_poof_buffer);
+	}
+}
+
 float g3_draw_rotated_bitmap_area(vertex *pnt, float angle, float rad, uint tmap_flags, float area);
 int neb_mode = 1;
 int frames_total = 0;
@@ -1007,6 +1144,12 @@ void neb2_render_player()
 		return;
 	}
 
+	if (neb2_poofs_on_gpu()) {
+		Neb2_poof_time += flFrametime;
+		neb2_render_poofs_gpu();
+		return;
+	}
+
 	frame_rendered = 0;
 	// render the nebula
 	for (idx1=0; idx1<Neb2_slices; idx1++) {
@@ -41,6 +41,7 @@
 #include "mission/missiongoals.h"
 #include "network/multi_log.h"
 #include "network/multi_rate.h"
+#include "network/multi_profile.h"
 #include "hud/hudescort.h"
 #include "hud/hudmessage.h"
 #include "globalincs/alphacolors.h"
@@ -948,6 +949,8 @@ void multi_process_bigdata(ubyte *data, int len, net_addr *from_addr, int reliab
 		header_info.id = -1;
 	}   
 
+	multi_profile_datagram(MULTI_PROFILE_IN, len);
+
 	bytes_processed = 0;
 	while( (bytes_processed >= 0) && (bytes_processed < len) )  {
 
@@ -967,6 +970,8 @@ void multi_process_bigdata(ubyte *data, int len, net_addr *from_addr, int reliab
 
 		// perform any special processing checks here		
 		process_packet_normal(buf,&header_info);
+
+		multi_profile_packet(MULTI_PROFILE_IN, player_num, type, header_info.bytes_processed);
 		 
 		// MWA -- magic number was removed from header on 8/4/97.  Replaced with bytes_processed
 		// variable which gets stuffed whenever a packet is processed.
@@ -1128,6 +1133,7 @@ void multi_do_frame()
 
 	// datarate tracking
 	multi_rate_process();
+	multi_profile_frame();
 
 	// always process any pending endgame details
 	multi_endgame_process();		
@@ -11,6 +11,7 @@
 
 
 #include <limits.h>		// this is need even when not building debug!!
+#include <zlib.h>
 
 #include "globalincs/globals.h"
 #include "object/object.h"
@@ -66,7 +67,8 @@
 // 6.) After verifiying or kicking the player because of his file signature, the server tells the
 //     player to load the mission
 // 7.) When the mission is loaded, the server, sends a netgame update to the client
-// 8.) Without waiting, the server then begins sending data ship packets to the player
+// 8.) Without waiting, the server then streams the ship list to the player. It is built and compressed once
+//     per frame, so joiners which get there in the same frame share it
 // 9.) Upon confirmation of receiving these packets, the server sends wing data packets
 // 10.) Upon completion of this, the server sends respawn point packets
 // 11.) Upon completion of this, the server sends a post briefing data block packet containing ship class and 
@@ -87,6 +89,41 @@
 LOCAL	int	Ingame_ships_deleted = 0;
 //LOCAL	int	Ingame_ships_to_delete[MAX_SHIPS];
 
+// how the ship list for ingame joiners is encoded
+#define INGAME_SNAPSHOT_RAW					0			// the ship list as it is
+#define INGAME_SNAPSHOT_ZLIB					1			// the ship list compressed with zlib
+
+// the joiner refuses ship lists larger than this
+#define INGAME_SNAPSHOT_MAX_SIZE				(4 * 1024 * 1024)
+
+// bytes of the ship list in one SHIPS_INGAME_PACKET, the rest of it is the header and where the piece goes
+#define INGAME_SNAPSHOT_CHUNK_SIZE			(MAX_PACKET_SIZE - HEADER_LENGTH - 16)
+
+// the ship list as the server sends it. the ships change all the time, so it is only reused in the frame it was built
+typedef struct ingame_snapshot {
+	int frame;														// Framecount when it was built
+	fix mission_time;												// Missiontime when it was built
+	int type;														// INGAME_SNAPSHOT_*
+	int raw_size;													// size of the ship list before compression
+	SCP_vector<ubyte> payload;									// what is sent
+} ingame_snapshot;
+
+LOCAL ingame_snapshot Ingame_snapshot = { -1, 0, INGAME_SNAPSHOT_RAW, 0, {} };
+
+// the ship list on the joiner while its pieces come in
+LOCAL SCP_vector<ubyte> Ingame_snapshot_recv;
+LOCAL int Ingame_snapshot_recv_size = 0;
+
+// the ship updates for the joiners of a team, built once per frame like the ship list
+typedef struct ingame_update_cache {
+	int team;
+	int frame;
+	fix mission_time;
+	SCP_vector<SCP_vector<ubyte>> packets;
+} ingame_update_cache;
+
+LOCAL SCP_vector<ingame_update_cache> Ingame_update_caches;
+
 
 // --------------------------------------------------------------------------------------------------
 // INGAME JOIN FORWARD DECLARATIONS
@@ -287,6 +324,9 @@ void multi_ingame_sync_init()
 	send_file_sig_packet(Multi_current_file_checksum,Multi_current_file_length);
 	
 	Ingame_ships_deleted = 0;
+
+	Ingame_snapshot_recv.clear();
+	Ingame_snapshot_recv_size = 0;
 }
 
 // mission sync screen do function for ingame joining
@@ -969,7 +1009,8 @@ void multi_ingame_handle_timeout()
 
 #define INGAME_PACKET_SLOP		75				// slop value used for packets to ingame joiner
 
-void process_ingame_ships_packet( ubyte *data, header *hinfo )
+// create the ships of the ship list once all of it is here
+static void multi_ingame_create_ships(ubyte *data, int size)
 {
 	int offset, team, j;
     std::uint64_t oflags, sflags;
@@ -999,11 +1040,11 @@ void process_ingame_ships_packet( ubyte *data, header *hinfo )
 		Ingame_ships_deleted = 1;
 	}
 
-	offset = HEADER_LENGTH;
+	offset = 0;
 
 	// go
 	GET_DATA( p_type );	
-	while ( p_type == INGAME_SHIP_NEXT ) {
+	while ( (p_type == INGAME_SHIP_NEXT) && (offset < size) ) {
 		p_object *p_objp;
 		int ship_num, objnum;
 
@@ -1043,7 +1084,9 @@ void process_ingame_ships_packet( ubyte *data, header *hinfo )
 		Objects[objnum].net_signature = net_signature;
 
 		// assign any common data
+		ship_name_index_remove(ship_num);
 		strcpy_s(Ships[ship_num].ship_name, ship_name);
+		ship_name_index_add(ship_num);
 		Ships[ship_num].flags.from_u64(sflags);
 		Ships[ship_num].team = team;
 		Ships[ship_num].wingnum = (int)wing_data;				
@@ -1051,7 +1094,11 @@ void process_ingame_ships_packet( ubyte *data, header *hinfo )
 		GET_DATA( p_type );
 	}
 
-	PACKET_SET_SIZE();
+	if ( offset > size ) {
+		nprintf(("Network", "MULTI INGAME : ship list runs past its end\n"));
+		multi_quit_game(PROMPT_NONE, MULTI_END_NOTIFY_NONE, MULTI_END_ERROR_INGAME_BOGUS);
+		return;
+	}
 
 	// if we have reached the end of the list and change our network state
 	if ( p_type == INGAME_SHIP_LIST_EOL ) {		
@@ -1100,7 +1147,69 @@ void process_ingame_ships_packet( ubyte *data, header *hinfo )
 	}
 }
 
-void send_ingame_ships_packet(net_player *player)
+void process_ingame_ships_packet( ubyte *data, header *hinfo )
+{
+	int offset;
+	ubyte type;
+	int raw_size, payload_size, chunk_offset;
+	ushort chunk_size;
+	ubyte *chunk;
+
+	offset = HEADER_LENGTH;
+
+	GET_DATA( type );
+	GET_INT( raw_size );
+	GET_INT( payload_size );
+	GET_INT( chunk_offset );
+	GET_USHORT( chunk_size );
+	chunk = data + offset;
+	offset += chunk_size;
+
+	PACKET_SET_SIZE();
+
+	// a raw ship list is as large as its payload, a compressed one is only sent if it is smaller
+	if ( (raw_size <= 0) || (raw_size > INGAME_SNAPSHOT_MAX_SIZE) || (payload_size <= 0) || (payload_size > raw_size)
+		|| ((type == INGAME_SNAPSHOT_RAW) && (payload_size != raw_size)) || ((type != INGAME_SNAPSHOT_RAW) && (type != INGAME_SNAPSHOT_ZLIB))
+		|| (chunk_size > INGAME_SNAPSHOT_CHUNK_SIZE) || (chunk_offset != Ingame_snapshot_recv_size) || (chunk_offset + chunk_size > payload_size) ) {
+		nprintf(("Network", "MULTI INGAME : got a bogus piece of the ship list\n"));
+		multi_quit_game(PROMPT_NONE, MULTI_END_NOTIFY_NONE, MULTI_END_ERROR_INGAME_BOGUS);
+		return;
+	}
+
+	// the pieces come in order on the reliable socket
+	if ( chunk_offset == 0 ) {
+		Ingame_snapshot_recv.resize(payload_size);
+	}
+
+	memcpy(Ingame_snapshot_recv.data() + chunk_offset, chunk, chunk_size);
+	Ingame_snapshot_recv_size += chunk_size;
+
+	if ( Ingame_snapshot_recv_size < payload_size ) {
+		return;
+	}
+
+	SCP_vector<ubyte> ship_list;
+	if ( type == INGAME_SNAPSHOT_ZLIB ) {
+		ship_list.resize(raw_size);
+
+		uLongf ship_list_size = (uLongf)raw_size;
+		if ( (uncompress(ship_list.data(), &ship_list_size, Ingame_snapshot_recv.data(), (uLong)payload_size) != Z_OK) || (ship_list_size != (uLongf)raw_size) ) {
+			nprintf(("Network", "MULTI INGAME : could not decompress the ship list\n"));
+			multi_quit_game(PROMPT_NONE, MULTI_END_NOTIFY_NONE, MULTI_END_ERROR_INGAME_BOGUS);
+			return;
+		}
+	} else {
+		ship_list.swap(Ingame_snapshot_recv);
+	}
+
+	Ingame_snapshot_recv.clear();
+	Ingame_snapshot_recv_size = 0;
+
+	multi_ingame_create_ships(ship_list.data(), raw_size);
+}
+
+// serialize the ships the joiner has to create and compress them, unless that was already done this frame
+static void multi_ingame_build_ship_snapshot()
 {
 	ubyte data[MAX_PACKET_SIZE];
 	ubyte p_type;
@@ -1108,26 +1217,25 @@ void send_ingame_ships_packet(net_player *player)
 	int packet_size;
 	short wing_data;
 
-	BUILD_HEADER( SHIPS_INGAME_PACKET );
+	auto &snapshot = Ingame_snapshot;
+	if ( (snapshot.frame == Framecount) && (snapshot.mission_time == Missiontime) ) {
+		return;
+	}
 
-	// essentially, we are going to send a list of ship names to the joiner for ships that are not
-	// in wings.  The joiner will take the list, create any ships which should be created, and delete all
-	// other ships after the list is sent.
+	// essentially, we are going to send a list of ship names to the joiner.  The joiner will delete all
+	// ships, then take the list and create the ships which are in it.
+	SCP_vector<ubyte> ship_list;
 	for ( so = GET_FIRST(&Ship_obj_list); so != END_OF_LIST(&Ship_obj_list); so = GET_NEXT(so) ) {
 		ship *shipp;
 
 		shipp = &Ships[Objects[so->objnum].instance];
 
-		// skip all wings.
-		// if ( shipp->wingnum != -1 ){
-			// continue;
-		// }
-
 		if ( Objects[so->objnum].net_signature == STANDALONE_SHIP_SIG ){
 			continue;
 		}
 
 		//  add the ship name and other information such as net signature, ship and object(?) flags.
+		packet_size = 0;
 		p_type = INGAME_SHIP_NEXT;
 		ADD_DATA( p_type );
 		ADD_STRING( shipp->ship_name );
@@ -1141,20 +1249,58 @@ void send_ingame_ships_packet(net_player *player)
 			ADD_INT(Wings[wing_data].current_wave);
 		}
 
-		// don't send anymore data if we are getting close to the maximum size of this packet.  Send it off and
-		// keep going
-		if ( packet_size > (MAX_PACKET_SIZE - INGAME_PACKET_SLOP) ) {
-			p_type = INGAME_SHIP_LIST_EOP;
-			ADD_DATA( p_type );			
-			multi_io_send_reliable(player, data, packet_size);
-			BUILD_HEADER( SHIPS_INGAME_PACKET );
-		}
+		ship_list.insert(ship_list.end(), data, data + packet_size);
 	}
 
 	// end of the ship list!!!
-	p_type = INGAME_SHIP_LIST_EOL;
-	ADD_DATA( p_type );	
-	multi_io_send_reliable(player, data, packet_size);
+	ship_list.push_back(INGAME_SHIP_LIST_EOL);
+
+	snapshot.frame = Framecount;
+	snapshot.mission_time = Missiontime;
+	snapshot.raw_size = (int)ship_list.size();
+
+	// the names and flags of the ships repeat a lot, so the list usually shrinks to a fraction
+	uLongf compressed_size = compressBound((uLong)ship_list.size());
+	snapshot.payload.resize(compressed_size);
+	if ( (compress2(snapshot.payload.data(), &compressed_size, ship_list.data(), (uLong)ship_list.size(), Z_DEFAULT_COMPRESSION) == Z_OK) && (compressed_size < (uLongf)ship_list.size()) ) {
+		snapshot.type = INGAME_SNAPSHOT_ZLIB;
+		snapshot.payload.resize(compressed_size);
+	} else {
+		snapshot.type = INGAME_SNAPSHOT_RAW;
+		snapshot.payload.swap(ship_list);
+	}
+
+	nprintf(("Network", "MULTI INGAME : ship list of %d bytes is sent as %d bytes\n", snapshot.raw_size, (int)snapshot.payload.size()));
+}
+
+void send_ingame_ships_packet(net_player *player)
+{
+	ubyte data[MAX_PACKET_SIZE];
+	ubyte type;
+	int packet_size, payload_size, chunk_offset;
+	ushort chunk_size;
+
+	multi_ingame_build_ship_snapshot();
+
+	auto &snapshot = Ingame_snapshot;
+	type = (ubyte)snapshot.type;
+	payload_size = (int)snapshot.payload.size();
+
+	// all the pieces go out at once, the reliable socket streams them to the joiner
+	for ( chunk_offset = 0; chunk_offset < payload_size; chunk_offset += INGAME_SNAPSHOT_CHUNK_SIZE ) {
+		chunk_size = (ushort)MIN(INGAME_SNAPSHOT_CHUNK_SIZE, payload_size - chunk_offset);
+
+		BUILD_HEADER( SHIPS_INGAME_PACKET );
+		ADD_DATA( type );
+		ADD_INT( snapshot.raw_size );
+		ADD_INT( payload_size );
+		ADD_INT( chunk_offset );
+		ADD_USHORT( chunk_size );
+		memcpy(data + packet_size, snapshot.payload.data() + chunk_offset, chunk_size);
+		packet_size += chunk_size;
+
+		multi_io_send_reliable(player, data, packet_size);
+	}
 }
 
 void process_ingame_wings_packet( ubyte *data, header *hinfo )
@@ -1606,6 +1752,9 @@ void process_ingame_ship_request_packet(ubyte *data, header *hinfo)
 
 		// initialize datarate limiting for this guy
 		multi_oo_rate_init(&Net_players[player_num]);
+
+		// he has none of the object updates we sent to whoever had his slot before
+		multi_oo_player_reset_all(&Net_players[player_num]);
 		
 		// ack him
 		send_ingame_ship_request_packet(INGAME_SR_CONFIRM,OBJ_INDEX(objp),&Net_players[player_num]);
@@ -1775,51 +1924,88 @@ void process_ingame_ship_request_packet(ubyte *data, header *hinfo)
 // INGAME JOIN FORWARD DEFINITIONS
 //
 
-void multi_ingame_send_ship_update(net_player *p)
+// for now, I guess we'll just send hull and shield % values. as many ships as fit go into one packet
+static void multi_ingame_build_ship_updates(ingame_update_cache *cache)
 {
+	ubyte data[MAX_PACKET_SIZE];
 	ship_obj *moveup;
-	
-	// get the first object on the list
-	moveup = GET_FIRST(&Ship_obj_list);
-	
+	object *objp;
+	int idx;
+	int packet_size = 0;
+	ubyte count = 0;
+	float f_tmp;
+
+	cache->packets.clear();
+
 	// go through the list and send all ships which are mark as OF_COULD_BE_PLAYER
-	while(moveup!=END_OF_LIST(&Ship_obj_list)){
+	for ( moveup = GET_FIRST(&Ship_obj_list); moveup != END_OF_LIST(&Ship_obj_list); moveup = GET_NEXT(moveup) ) {
+		objp = &Objects[moveup->objnum];
+
 		//Make sure the object can be a player and is on the same team as this guy
-		if(Objects[moveup->objnum].flags[Object::Object_Flags::Could_be_player] && obj_team(&Objects[moveup->objnum]) == p->p_info.team){
-			// send the update
-			send_ingame_ship_update_packet(p,&Ships[Objects[moveup->objnum].instance]);
+		if ( !objp->flags[Object::Object_Flags::Could_be_player] || (obj_team(objp) != cache->team) ) {
+			continue;
 		}
 
-		// move to the next item
-		moveup = GET_NEXT(moveup);
+		// send off the packet when this ship wouldn't fit anymore
+		int ship_size = (int)(sizeof(ushort) + sizeof(std::uint64_t) + sizeof(int) + sizeof(float) * (1 + objp->n_quadrants));
+		if ( (count > 0) && ((packet_size + ship_size >= MAX_PACKET_SIZE) || (count == UCHAR_MAX)) ) {
+			data[HEADER_LENGTH] = count;
+			cache->packets.emplace_back(data, data + packet_size);
+			count = 0;
+		}
+
+		if ( count == 0 ) {
+			BUILD_HEADER(INGAME_SHIP_UPDATE);
+			ADD_DATA(count);
+		}
+
+		// just send net signature, shield and hull percentages
+		ADD_USHORT(objp->net_signature);
+		ADD_ULONG(objp->flags.to_u64());
+		ADD_INT(objp->n_quadrants);
+		ADD_FLOAT(objp->hull_strength);
+
+		// shield percentages
+		for(idx=0; idx<objp->n_quadrants; idx++){
+			f_tmp = objp->shield_quadrant[idx];
+			ADD_FLOAT(f_tmp);
+		}
+
+		count++;
+	}
+
+	if ( count > 0 ) {
+		data[HEADER_LENGTH] = count;
+		cache->packets.emplace_back(data, data + packet_size);
 	}
 }
 
-// for now, I guess we'll just send hull and shield % values
-void send_ingame_ship_update_packet(net_player *p,ship *sp)
+void multi_ingame_send_ship_update(net_player *p)
 {
-	ubyte data[MAX_PACKET_SIZE];
-	object *objp;
-	int idx;
-	int packet_size = 0;
-	float f_tmp;
+	ingame_update_cache *cache = nullptr;
 
-	BUILD_HEADER(INGAME_SHIP_UPDATE);
-	
-	// just send net signature, shield and hull percentages
-	objp = &Objects[sp->objnum];
-	ADD_USHORT(objp->net_signature);
-	ADD_ULONG(objp->flags.to_u64());
-	ADD_INT(objp->n_quadrants);
-	ADD_FLOAT(objp->hull_strength);
-	
-	// shield percentages
-	for(idx=0; idx<objp->n_quadrants; idx++){
-		f_tmp = objp->shield_quadrant[idx];
-		ADD_FLOAT(f_tmp);
+	for ( auto &team_cache : Ingame_update_caches ) {
+		if ( team_cache.team == p->p_info.team ) {
+			cache = &team_cache;
+			break;
+		}
+	}
+
+	if ( cache == nullptr ) {
+		Ingame_update_caches.push_back({ p->p_info.team, -1, 0, {} });
+		cache = &Ingame_update_caches.back();
+	}
+
+	// the joiners of a team whose updates are due in the same frame get the same packets
+	if ( (cache->frame != Framecount) || (cache->mission_time != Missiontime) ) {
+		multi_ingame_build_ship_updates(cache);
+		cache->frame = Framecount;
+		cache->mission_time = Missiontime;
+	}
+
+	for ( auto &packet : cache->packets ) {
+		multi_io_send_reliable(p, packet.data(), (int)packet.size());
 	}
-	
-	multi_io_send_reliable(p, data, packet_size);
 }
 
 void process_ingame_ship_update_packet(ubyte *data, header *hinfo)
@@ -1832,33 +2018,37 @@ void process_ingame_ship_update_packet(ubyte *data, header *hinfo)
 	ushort net_sig;
 	object *lookup;
 	float f_tmp;
+	ubyte count;
 	
 	offset = HEADER_LENGTH;
-	// get the net sig for the ship and do a lookup
-	GET_USHORT(net_sig);
-	GET_ULONG(flags);
-	GET_INT(n_quadrants);
-
-	// get the object
-	lookup = multi_get_network_object(net_sig);
-	if(lookup == NULL){
-		// read in garbage values if we can't find the ship
-		nprintf(("Network","Got ingame ship update for unknown object\n"));
-		GET_FLOAT(garbage);
-		for(idx=0;idx<n_quadrants;idx++){
+	GET_DATA(count);
+
+	for ( ; count > 0; count-- ) {
+		// get the net sig for the ship and do a lookup
+		GET_USHORT(net_sig);
+		GET_ULONG(flags);
+		GET_INT(n_quadrants);
+
+		// get the object
+		lookup = multi_get_network_object(net_sig);
+		if(lookup == NULL){
+			// read in garbage values if we can't find the ship
+			nprintf(("Network","Got ingame ship update for unknown object\n"));
 			GET_FLOAT(garbage);
-		}
+			for(idx=0;idx<n_quadrants;idx++){
+				GET_FLOAT(garbage);
+			}
 
-		PACKET_SET_SIZE();
-		return;
-	}
-	// otherwise read in the ship values
-	lookup->flags.from_u64(flags);
-	lookup->n_quadrants = n_quadrants;
- 	GET_FLOAT(lookup->hull_strength);
-	for(idx=0;idx<n_quadrants;idx++){
-		GET_FLOAT(f_tmp);
-		lookup->shield_quadrant[idx] = f_tmp;
+			continue;
+		}
+		// otherwise read in the ship values
+		lookup->flags.from_u64(flags);
+		lookup->n_quadrants = n_quadrants;
+		GET_FLOAT(lookup->hull_strength);
+		for(idx=0;idx<n_quadrants;idx++){
+			GET_FLOAT(f_tmp);
+			lookup->shield_quadrant[idx] = f_tmp;
+		}
 	}
 
 	PACKET_SET_SIZE();
@@ -20,6 +20,7 @@
 #include "network/multiutil.h"
 #include "network/multi_options.h"
 #include "network/multi_rate.h"
+#include "network/multi_packet.h"
 #include "network/multi.h"
 #include "object/object.h"
 #include "object/objectshield.h"
@@ -30,6 +31,8 @@
 #include "ship/afterburner.h"
 #include "cfile/cfile.h"
 #include "debugconsole/console.h"
+#include "globalincs/jobs.h"
+#include "tracing/categories.h"
 
 
 // ---------------------------------------------------------------------------------------------------
@@ -53,6 +56,10 @@ bool Multi_oo_afterburn_hack = false;
 
 // how much data we're willing to put into a given oo packet
 #define OO_MAX_SIZE					480
+#define OO_MAX_OBJECT_SIZE			(6 + 255)		// the most multi_oo_pack_data() packs for one object, the header and the data
+#define OO_MAX_FIELD_SIZE			32				// the most one of the multi_pack_unpack_* functions writes
+#define OO_BUILD_PACKET_ROOM		(OO_MAX_SIZE + OO_MAX_OBJECT_SIZE + 3)	// the room one packet may need while it is built
+#define OO_CONTROL_MAX_SIZE			(OO_MAX_OBJECT_SIZE + 16)	// a packet with a single object, the header, stop bytes and acks
 
 // tolerance for bashing position
 #define OO_POS_UPDATE_TOLERANCE	100.0f
@@ -85,6 +92,113 @@ bool Multi_oo_afterburn_hack = false;
 #define OO_HULL_SHIELD_TIME		600
 #define OO_SUBSYS_TIME				1000
 
+// the update rates of the ranges above are raised for ships which cover more of the screen, by the ratio of their
+// radius to their distance times this, up to the max
+#define OO_SCREEN_SIZE_SCALE		10.0f
+#define OO_SCREEN_SIZE_MAX			2.0f
+
+// ships which are fighting the player are updated this much more often, for this many seconds after a hit
+#define OO_INTERACTION_SCALE		2.0f
+#define OO_INTERACTION_TIME		5
+
+// DELTA UPDATES
+// The server sends the movement of a ship as the difference to an earlier update of the same ship which the client
+// has acknowledged. Every object update packet from the server has an id, and the clients send the ids of the packets
+// they got back with their control info. The updates in a packet become the new baselines once it is acknowledged.
+// The clients keep the last few updates of every ship around, so the server only uses a baseline while the client is
+// sure to still have it.
+
+// how many updates of a ship the client keeps, the baseline must be one of them
+#define OO_BASELINE_RING			8
+
+// how long the server uses a baseline and the client keeps it, in ms. the client has to keep it for longer
+#define OO_BASELINE_SERVER_TIME	1500
+#define OO_BASELINE_CLIENT_TIME	2000
+
+// how many packets the server remembers per player, and how many a client acknowledges at once besides the last one
+#define OO_PACKET_HISTORY			64
+#define OO_ACK_BITS					32
+
+// the movement of a ship in an update sent by the server
+typedef struct oo_sent_move {
+	int ship_index;
+	int signature;							// the signature of the ship object
+	ubyte seq;								// the sequence # of the update
+	int parts;								// MULTI_MOVE_* flags
+	int expire;								// until when it may be used as a baseline
+	multi_move_state state;
+} oo_sent_move;
+
+typedef struct oo_sent_packet {
+	int id;									// -1 if this slot is unused or was already acknowledged
+	SCP_vector<oo_sent_move> moves;
+} oo_sent_packet;
+
+// what the server knows about one player
+typedef struct oo_player_baselines {
+	ushort next_packet_id;
+	oo_sent_packet packets[OO_PACKET_HISTORY];
+	oo_sent_move ships[MAX_SHIPS];		// the last acknowledged update of each ship, signature is -1 if there is none
+} oo_player_baselines;
+
+static oo_player_baselines Oo_baselines[MAX_PLAYERS];
+
+// the updates for the players are built in parallel, this is everything the server keeps while building them for one
+typedef struct oo_player_build {
+	SCP_vector<short> ship_index;		// the ships to check, the most relevant first
+	oo_sent_move packed_move;			// the move which was packed last by multi_oo_pack_data(), ship_index is -1 if there is none
+	SCP_vector<ubyte> packets;			// the packets to send, one after the other. they are built right here, so it only grows
+	int packets_used;					// how many bytes of packets are in use
+	SCP_vector<int> packet_sizes;
+	int capped;							// how many ships were skipped because of his datarate
+} oo_player_build;
+
+static oo_player_build Oo_player_builds[MAX_PLAYERS];
+
+// the movement of every ship is quantized once per frame and shared by the updates for all players
+typedef struct oo_frame_move {
+	int signature;							// the signature of the ship object, -1 if there is no state
+	multi_move_state state;
+} oo_frame_move;
+
+static oo_frame_move Oo_frame_moves[MAX_SHIPS];
+
+// only set while the updates are built, the ships may move after that
+static bool Oo_frame_moves_valid = false;
+
+static bool Oo_parallel_build = true;
+DCF_BOOL( parallel_object_updates, Oo_parallel_build )
+
+// updates are moved ahead by the time they took to get here, at most this many seconds
+#define OO_EXTRAPOLATE_MAX_TIME					0.5f
+
+static bool Oo_extrapolate = true;
+DCF_BOOL( extrapolate_object_updates, Oo_extrapolate )
+
+// the last updates of a ship the client got
+typedef struct oo_received_move {
+	bool valid;
+	ubyte seq;
+	int parts;
+	int expire;								// until when it has to be kept
+	multi_move_state state;
+} oo_received_move;
+
+typedef struct oo_received_ring {
+	oo_received_move moves[OO_BASELINE_RING];
+} oo_received_ring;
+
+// by net signature, so updates for ships which this client doesn't know yet are kept as well
+static SCP_unordered_map<ushort, oo_received_ring> Oo_received_moves;
+
+// the packets the client got from the server, bit i of the mask is for the packet Oo_ack_id - 1 - i
+static bool Oo_ack_valid = false;
+static ushort Oo_ack_id = 0;
+static uint Oo_ack_mask = 0;
+
+// false if an update in the packet which is read right now could not be used
+static bool Oo_packet_ackable = true;
+
 // timestamp values for object update times based on client's update level.
 int Multi_oo_target_update_times[MAX_OBJ_UPDATE_LEVELS] = 
 {
@@ -148,8 +262,8 @@ int Multi_oo_rear_far_update_times[MAX_OBJ_UPDATE_LEVELS] =
 	66,
 };
 
-// ship index list for possibly sorting ships based upon distance, etc
-short OO_ship_index[MAX_SHIPS];
+// ship index list, sorted by update priority
+static int multi_oo_get_update_time(net_player *pl, object *objp, int range, int in_cone);
 
 int OO_update_index = -1;							// index into OO_update_records for displaying update record info
 
@@ -157,57 +271,96 @@ int OO_update_index = -1;							// index into OO_update_records for displaying u
 // OBJECT UPDATE FUNCTIONS
 //
 
-object *OO_player_obj;
 int OO_sort = 1;
 
-bool multi_oo_sort_func(const short &index1, const short &index2)
+// the ships with the highest priority are sent first
+static bool multi_oo_sort_func(int player_index, short index1, short index2)
 {
-	object *obj1, *obj2;
-	float dist1, dist2;
-	float dot1, dot2;
-	vec3d v1, v2;
-	vec3d vn1, vn2;
-
 	// if the indices are bogus, or the objnums are bogus, return ">"
 	if((index1 < 0) || (index2 < 0) || (Ships[index1].objnum < 0) || (Ships[index2].objnum < 0)){
 		return false;
 	}
 
-	// get the 2 objects
-	obj1 = &Objects[Ships[index1].objnum];
-	obj2 = &Objects[Ships[index2].objnum];
+	return Ships[index1].np_updates[player_index].priority > Ships[index2].np_updates[player_index].priority;
+}
+
+// if the ship and the player's ship are fighting each other
+static bool multi_oo_is_interacting(object *objp, object *player_obj)
+{
+	ship *shipp = &Ships[objp->instance];
+	fix recent = Missiontime - i2f(OO_INTERACTION_TIME);
 
-	// get the distance and dot product to the player obj for both
-	vm_vec_sub(&v1, &OO_player_obj->pos, &obj1->pos);
-	dist1 = vm_vec_copy_normalize(&vn1, &v1);
-	vm_vec_sub(&v2, &OO_player_obj->pos, &obj2->pos);
-	dist2 = vm_vec_copy_normalize(&vn2, &v2);
-	dot1 = vm_vec_dot(&OO_player_obj->orient.vec.fvec, &vn1);
-	dot2 = vm_vec_dot(&OO_player_obj->orient.vec.fvec, &vn2);
+	if((shipp->ai_index >= 0) && (shipp->ai_index < MAX_AI_INFO)){
+		ai_info *aip = &Ai_info[shipp->ai_index];
 
-	// objects in front take precedence
-	if((dot1 < 0.0f) && (dot2 >= 0.0f)){
-		return false;
-	} else if((dot2 < 0.0f) && (dot1 >= 0.0f)){
-		return true;
+		// he is after the player, or the player hit him
+		if(aip->target_objnum == OBJ_INDEX(player_obj)){
+			return true;
+		}
+		if((aip->hitter_objnum == OBJ_INDEX(player_obj)) && (aip->last_hit_time > recent)){
+			return true;
+		}
 	}
 
-	// otherwise go by distance
-	return (dist1 < dist2);
+	// he hit the player
+	if((player_obj->type == OBJ_SHIP) && (Ships[player_obj->instance].ai_index >= 0) && (Ships[player_obj->instance].ai_index < MAX_AI_INFO)){
+		ai_info *aip = &Ai_info[Ships[player_obj->instance].ai_index];
+
+		if((aip->hitter_objnum == OBJ_INDEX(objp)) && (aip->last_hit_time > recent)){
+			return true;
+		}
+	}
+
+	return false;
+}
+
+// how many updates per second this ship should get for this player
+static float multi_oo_update_rate(net_player *pl, object *objp, object *player_obj)
+{
+	vec3d obj_dot;
+	float dist;
+	int in_cone = 0;
+	int range;
+	float rate;
+
+	// the same ranges and cone as for the update times
+	vm_vec_sub(&obj_dot, &objp->pos, &pl->s_info.eye_pos);
+	dist = vm_vec_mag(&obj_dot);
+	if(dist > 0.0f){
+		in_cone = (vm_vec_dot(&obj_dot, &pl->s_info.eye_orient.vec.fvec) / dist >= OO_VIEW_CONE_DOT) ? 1 : 0;
+	}
+
+	if(dist < OO_NEAR_DIST){
+		range = OO_NEAR;
+	} else if(dist < OO_MIDRANGE_DIST){
+		range = OO_MIDRANGE;
+	} else {
+		range = OO_FAR;
+	}
+
+	rate = 1000.0f / i2fl(multi_oo_get_update_time(pl, objp, range, in_cone));
+
+	// ships which cover more of the screen show their errors more
+	if(in_cone && (dist > 0.0f)){
+		rate *= 1.0f + MIN(objp->radius / dist * OO_SCREEN_SIZE_SCALE, OO_SCREEN_SIZE_MAX);
+	}
+
+	if(multi_oo_is_interacting(objp, player_obj)){
+		rate *= OO_INTERACTION_SCALE;
+	}
+
+	// never more often than the target
+	return MIN(rate, 1000.0f / i2fl(Multi_oo_target_update_times[pl->p_info.options.obj_update_level]));
 }
 
 // build the list of ship indices to use when updating for this player
 void multi_oo_build_ship_list(net_player *pl)
 {
-	int ship_index;
-	int idx;
 	ship_obj *moveup;
 	object *player_obj;
+	SCP_vector<short> *ship_index = &Oo_player_builds[NET_PLAYER_NUM(pl)].ship_index;
 
-	// set all indices to be -1
-	for(idx = 0;idx<MAX_SHIPS; idx++){
-		OO_ship_index[idx] = -1;
-	}
+	ship_index->clear();
 
 	// get the player object
 	if(pl->m_player->objnum < 0){
@@ -216,7 +369,6 @@ void multi_oo_build_ship_list(net_player *pl)
 	player_obj = &Objects[pl->m_player->objnum];
 	
 	// go through all other relevant objects
-	ship_index = 0;
 	for ( moveup = GET_FIRST(&Ship_obj_list); moveup != END_OF_LIST(&Ship_obj_list); moveup = GET_NEXT(moveup) ) {
 		// if it is an invalid ship object, skip it
 		if((moveup->objnum < 0) || (Objects[moveup->objnum].instance < 0) || (Objects[moveup->objnum].type != OBJ_SHIP)){
@@ -248,31 +400,34 @@ void multi_oo_build_ship_list(net_player *pl)
 			continue;
 		}
 
+		// the more relevant the ship is to him the sooner it is due, the ships which don't fit into his bandwidth
+		// keep their priority so they are sent first next time
+		Ships[Objects[moveup->objnum].instance].np_updates[NET_PLAYER_NUM(pl)].priority += multi_oo_update_rate(pl, &Objects[moveup->objnum], player_obj) * flFrametime;
+
 		// don't send info for his targeted ship here, since its always done first
 		if((pl->s_info.target_objnum != -1) && (moveup->objnum == pl->s_info.target_objnum)){
 			continue;
 		}
 
 		// add the ship 
-		if(ship_index < MAX_SHIPS){
-			OO_ship_index[ship_index++] = (short)Objects[moveup->objnum].instance;
-		}
+		ship_index->push_back((short)Objects[moveup->objnum].instance);
 	}
 
 	// maybe sort the thing here
-	OO_player_obj = player_obj;
+	int player_index = NET_PLAYER_NUM(pl);
 	if (OO_sort) {
-		std::sort(OO_ship_index, OO_ship_index + ship_index, multi_oo_sort_func);
+		std::sort(ship_index->begin(), ship_index->end(), [player_index](short index1, short index2) {
+			return multi_oo_sort_func(player_index, index1, index2);
+		});
 	}
 }
 
-// pack information for a client (myself), return bytes added
-int multi_oo_pack_client_data(ubyte *data)
+// pack information for a client (myself)
+static void multi_oo_pack_client_data(packet_writer &w)
 {
 	ubyte out_flags;
 	ushort tnet_signature;
 	char t_subsys, l_subsys;
-	int packet_size = 0;
 
 	// get our firing stuff
 	out_flags = Net_player->s_info.accum_buttons;	
@@ -311,7 +466,7 @@ int multi_oo_pack_client_data(ubyte *data)
 	}
 
 	// copy the final flags in
-	ADD_DATA( out_flags );
+	w.write_ubyte( out_flags );
 
 	// client targeting information	
 	t_subsys = -1;
@@ -338,31 +493,202 @@ int multi_oo_pack_client_data(ubyte *data)
 	}
 
 	// add them all
-	ADD_USHORT( tnet_signature );
-	ADD_DATA( t_subsys );
-	ADD_DATA( l_subsys );
+	w.write_ushort( tnet_signature );
+	w.write_ubyte( (ubyte)t_subsys );
+	w.write_ubyte( (ubyte)l_subsys );
+}
+
+// the update of this ship the player has acknowledged, if it can be used as the baseline for the update with this sequence #
+static oo_sent_move *multi_oo_get_baseline(net_player *pl, object *objp, ubyte seq)
+{
+	oo_sent_move *base = &Oo_baselines[NET_PLAYER_NUM(pl)].ships[objp->instance];
+
+	if (base->signature != objp->signature) {
+		return NULL;
+	}
+
+	// the client only keeps the last few updates
+	ubyte age = (ubyte)(seq - base->seq);
+	if ((age == 0) || (age >= OO_BASELINE_RING) || timestamp_elapsed(base->expire)) {
+		return NULL;
+	}
+
+	return base;
+}
+
+// starts a new object update packet for this player, returns its id
+static ushort multi_oo_start_packet(net_player *pl)
+{
+	oo_player_baselines *baselines = &Oo_baselines[NET_PLAYER_NUM(pl)];
+	ushort id = baselines->next_packet_id++;
+	oo_sent_packet *packet = &baselines->packets[id % OO_PACKET_HISTORY];
+
+	packet->id = id;
+	packet->moves.clear();
+
+	return id;
+}
+
+// remember the move packed last as part of this packet
+static void multi_oo_record_packed_move(net_player *pl, ushort packet_id)
+{
+	oo_sent_move *move = &Oo_player_builds[NET_PLAYER_NUM(pl)].packed_move;
+
+	if (move->ship_index < 0) {
+		return;
+	}
+
+	oo_sent_packet *packet = &Oo_baselines[NET_PLAYER_NUM(pl)].packets[packet_id % OO_PACKET_HISTORY];
 
-	return packet_size;
+	if (packet->id == packet_id) {
+		packet->moves.push_back(*move);
+	}
+
+	move->ship_index = -1;
 }
 
-// pack the appropriate info into the data
-#define PACK_PERCENT(v) { std::uint8_t upercent; if(v < 0.0f){v = 0.0f;} upercent = (v * 255.0f) <= 255.0f ? (std::uint8_t)(v * 255.0f) : (std::uint8_t)255; memcpy(data + packet_size + header_bytes, &upercent, sizeof(std::uint8_t)); packet_size++; }
-#define PACK_BYTE(v) { memcpy( data + packet_size + header_bytes, &v, 1 ); packet_size += 1; }
-#define PACK_SHORT(v) { std::int16_t swap = INTEL_SHORT(v); memcpy( data + packet_size + header_bytes, &swap, sizeof(std::int16_t) ); packet_size += sizeof(std::int16_t); }
-#define PACK_USHORT(v) { std::uint16_t swap = INTEL_SHORT(v); memcpy( data + packet_size + header_bytes, &swap, sizeof(std::uint16_t) ); packet_size += sizeof(std::uint16_t); }
-#define PACK_INT(v) { std::int32_t swap = INTEL_INT(v); memcpy( data + packet_size + header_bytes, &swap, sizeof(std::int32_t) ); packet_size += sizeof(std::int32_t); }
-#define PACK_ULONG(v) { std::uint64_t swap = INTEL_LONG(v); memcpy( data + packet_size + header_bytes, &swap, sizeof(std::uint64_t) ); packet_size += sizeof(std::uint64_t); }
-int multi_oo_pack_data(net_player *pl, object *objp, ubyte oo_flags, ubyte *data_out)
+// the player got these packets, so the updates in them are the new baselines
+static void multi_oo_process_ack(net_player *pl, ushort id, uint mask)
+{
+	oo_player_baselines *baselines = &Oo_baselines[NET_PLAYER_NUM(pl)];
+	int idx;
+
+	for (idx = 0; idx <= OO_ACK_BITS; idx++) {
+		if ((idx > 0) && !(mask & (1u << (idx - 1)))) {
+			continue;
+		}
+
+		ushort packet_id = (ushort)(id - idx);
+		oo_sent_packet *packet = &baselines->packets[packet_id % OO_PACKET_HISTORY];
+
+		if (packet->id != packet_id) {
+			continue;
+		}
+
+		for (auto &move : packet->moves) {
+			oo_sent_move *base = &baselines->ships[move.ship_index];
+
+			// the acks may arrive out of order
+			if ((base->signature != move.signature) || ((signed char)(move.seq - base->seq) > 0)) {
+				*base = move;
+			}
+		}
+
+		packet->id = -1;
+		packet->moves.clear();
+	}
+}
+
+// read the movement of a ship from the server and keep it as a possible baseline, returns bytes processed
+static int multi_oo_unpack_move(ushort net_sig, ubyte seq, ubyte base_ref, int parts, ubyte *data, multi_move_state *state, bool *complete)
+{
+	oo_received_ring *ring = &Oo_received_moves[net_sig];
+	const oo_received_move *base = NULL;
+
+	if (base_ref != 0) {
+		ubyte base_seq = (ubyte)(seq - base_ref);
+		const oo_received_move *move = &ring->moves[base_seq % OO_BASELINE_RING];
+
+		if (move->valid && (move->seq == base_seq)) {
+			base = move;
+		}
+	}
+
+	int size = multi_pack_unpack_move_state(0, data, parts, state, base ? &base->state : NULL, base ? base->parts : 0, complete);
+
+	// the server must not use an update as a baseline if it isn't here
+	if (!*complete) {
+		Oo_packet_ackable = false;
+		return size;
+	}
+
+	// don't replace a newer update with a late one
+	oo_received_move *slot = &ring->moves[seq % OO_BASELINE_RING];
+
+	if (!slot->valid || timestamp_elapsed(slot->expire) || ((signed char)(seq - slot->seq) >= 0)) {
+		slot->valid = true;
+		slot->seq = seq;
+		slot->parts = parts;
+		slot->expire = timestamp(OO_BASELINE_CLIENT_TIME);
+		slot->state = *state;
+	} else {
+		Oo_packet_ackable = false;
+	}
+
+	return size;
+}
+
+// the client got this packet from the server
+static void multi_oo_ack_packet(ushort id)
+{
+	if (!Oo_ack_valid) {
+		Oo_ack_valid = true;
+		Oo_ack_id = id;
+		Oo_ack_mask = 0;
+		return;
+	}
+
+	short diff = (short)(id - Oo_ack_id);
+
+	if (diff > 0) {
+		// a newer packet, the last one moves into the mask
+		Oo_ack_mask = (diff < OO_ACK_BITS) ? (Oo_ack_mask << diff) : 0;
+		if (diff <= OO_ACK_BITS) {
+			Oo_ack_mask |= 1u << (diff - 1);
+		}
+		Oo_ack_id = id;
+	} else if ((diff < 0) && (-diff <= OO_ACK_BITS)) {
+		// an older one which arrived late
+		Oo_ack_mask |= 1u << (-diff - 1);
+	}
+}
+
+// reset the baselines the server keeps for this player, or for all players
+void multi_oo_player_reset_all(net_player *pl)
+{
+	int idx, s_idx;
+
+	for (idx = 0; idx < MAX_PLAYERS; idx++) {
+		if ((pl != NULL) && (idx != NET_PLAYER_NUM(pl))) {
+			continue;
+		}
+
+		Oo_baselines[idx].next_packet_id = 0;
+
+		for (s_idx = 0; s_idx < OO_PACKET_HISTORY; s_idx++) {
+			Oo_baselines[idx].packets[s_idx].id = -1;
+			Oo_baselines[idx].packets[s_idx].moves.clear();
+		}
+
+		for (s_idx = 0; s_idx < MAX_SHIPS; s_idx++) {
+			Oo_baselines[idx].ships[s_idx].signature = -1;
+		}
+
+		Oo_player_builds[idx].packed_move.ship_index = -1;
+	}
+}
+
+// pack a value from 0 to 1 into a byte
+static void multi_oo_pack_percent(packet_writer &w, float v)
+{
+	if(v < 0.0f){
+		v = 0.0f;
+	}
+	w.write_ubyte((v * 255.0f) <= 255.0f ? (ubyte)(v * 255.0f) : (ubyte)255);
+}
+
+// pack the appropriate info into data_out, which has room for max_size bytes. return bytes packed, 0 if there is
+// nothing to send or it doesn't fit
+int multi_oo_pack_data(net_player *pl, object *objp, ubyte oo_flags, ubyte *data_out, int max_size)
 {	
-	ubyte data[255];
 	ubyte data_size = 0;	
 	char percent;
 	ship *shipp;	
 	ship_info *sip;
+	ubyte *field;
 	ubyte ret;
 	float temp;	
 	int header_bytes;
-	int packet_size = 0;
 
 	// make sure we have a valid ship
 	Assert(objp->type == OBJ_SHIP);
@@ -395,50 +721,93 @@ int multi_oo_pack_data(net_player *pl, object *objp, ubyte oo_flags, ubyte *data
 
 	// header sizes
 	if(MULTIPLAYER_MASTER){
-		header_bytes = 5;
+		header_bytes = 6;
 	} else {
 		header_bytes = 2;
 	}	
 
+	// the data goes right behind the header, which is filled in once the size of the data is known
+	packet_writer w(data_out, max_size, header_bytes);
+
 	// if we're a client (and therefore sending control info), pack client-specific info
 	if((Net_player != NULL) && !(Net_player->flags & NETINFO_FLAG_AM_MASTER)){
-		packet_size += multi_oo_pack_client_data(data + packet_size + header_bytes);		
+		multi_oo_pack_client_data(w);
 	}		
 		
+	// the server sends position, velocity and orientation as the difference to an update the player has acknowledged
+	ubyte base_ref = 0;
+	oo_sent_move *move = &Oo_player_builds[NET_PLAYER_NUM(pl)].packed_move;
+	move->ship_index = -1;
+	if ( MULTIPLAYER_MASTER && (oo_flags & (OO_POS_NEW | OO_ORIENT_NEW)) ) {
+		ubyte seq = shipp->np_updates[NET_PLAYER_NUM(pl)].seq;
+		oo_sent_move *base = multi_oo_get_baseline(pl, objp, seq);
+		oo_frame_move *frame_move = &Oo_frame_moves[objp->instance];
+
+		move->ship_index = objp->instance;
+		move->signature = objp->signature;
+		move->seq = seq;
+		move->parts = ((oo_flags & OO_POS_NEW) ? MULTI_MOVE_POS : 0) | ((oo_flags & OO_ORIENT_NEW) ? MULTI_MOVE_ORIENT : 0);
+		move->expire = timestamp(OO_BASELINE_SERVER_TIME);
+		if (Oo_frame_moves_valid && (frame_move->signature == objp->signature)) {
+			move->state = frame_move->state;
+		} else {
+			multi_quantize_move_state(&move->state, &objp->pos, &objp->orient, &objp->phys_info);
+		}
+
+		if (base != NULL) {
+			base_ref = (ubyte)(seq - base->seq);
+		}
+
+		field = w.reserve(OO_MAX_FIELD_SIZE);
+		if (field != nullptr) {
+			ret = (ubyte)multi_pack_unpack_move_state( 1, field, move->parts, &move->state, base ? &base->state : NULL, base ? base->parts : 0, NULL );
+			w.commit(ret);
+
+			// global records
+			multi_rate_add(NET_PLAYER_NUM(pl), "mov", ret);
+		}
+	}
+
 	// position, velocity
-	if ( oo_flags & OO_POS_NEW ) {		
-		ret = (ubyte)multi_pack_unpack_position( 1, data + packet_size + header_bytes, &objp->pos );
-		packet_size += ret;
+	if ( !MULTIPLAYER_MASTER && (oo_flags & OO_POS_NEW) ) {		
+		field = w.reserve(OO_POS_RET_SIZE + OO_VEL_RET_SIZE);
+		if (field != nullptr) {
+			ret = (ubyte)multi_pack_unpack_position( 1, field, &objp->pos );
+			w.commit(ret);
 		
-		// global records
-		multi_rate_add(NET_PLAYER_NUM(pl), "pos", ret);		
+			// global records
+			multi_rate_add(NET_PLAYER_NUM(pl), "pos", ret);		
 			
-		ret = (ubyte)multi_pack_unpack_vel( 1, data + packet_size + header_bytes, &objp->orient, &objp->pos, &objp->phys_info );
-		packet_size += ret;		
+			ret = (ubyte)multi_pack_unpack_vel( 1, field + ret, &objp->orient, &objp->pos, &objp->phys_info );
+			w.commit(ret);
 			
-		// global records		
-		multi_rate_add(NET_PLAYER_NUM(pl), "pos", ret);				
+			// global records		
+			multi_rate_add(NET_PLAYER_NUM(pl), "pos", ret);				
+		}
 	}	
 
 	// orientation	
-	if(oo_flags & OO_ORIENT_NEW){
-		ret = (ubyte)multi_pack_unpack_orient( 1, data + packet_size + header_bytes, &objp->orient );
-		// Assert(ret == OO_ORIENT_RET_SIZE);
-		packet_size += ret;
-		multi_rate_add(NET_PLAYER_NUM(pl), "ori", ret);				
-
-		ret = (ubyte)multi_pack_unpack_rotvel( 1, data + packet_size + header_bytes, &objp->orient, &objp->pos, &objp->phys_info );
-		packet_size += ret;	
-
-		// global records		
-		multi_rate_add(NET_PLAYER_NUM(pl), "ori", ret);		
+	if( !MULTIPLAYER_MASTER && (oo_flags & OO_ORIENT_NEW) ){
+		field = w.reserve(OO_ORIENT_RET_SIZE + OO_ROTVEL_RET_SIZE);
+		if (field != nullptr) {
+			ret = (ubyte)multi_pack_unpack_orient( 1, field, &objp->orient );
+			// Assert(ret == OO_ORIENT_RET_SIZE);
+			w.commit(ret);
+			multi_rate_add(NET_PLAYER_NUM(pl), "ori", ret);				
+
+			ret = (ubyte)multi_pack_unpack_rotvel( 1, field + ret, &objp->orient, &objp->pos, &objp->phys_info );
+			w.commit(ret);
+
+			// global records		
+			multi_rate_add(NET_PLAYER_NUM(pl), "ori", ret);		
+		}
 	}
 			
 	// forward thrust	
 	percent = (char)(objp->phys_info.forward_thrust * 100.0f);
 	Assert( percent <= 100 );
 
-	PACK_BYTE( percent );
+	w.write_ubyte( (ubyte)percent );
 
 	// global records	
 	multi_rate_add(NET_PLAYER_NUM(pl), "fth", 1);	
@@ -450,14 +819,13 @@ int multi_oo_pack_data(net_player *pl, object *objp, ubyte oo_flags, ubyte *data
 		if ( (temp < 0.004f) && (temp > 0.0f) ) {
 			temp = 0.004f;		// 0.004 is the lowest positive value we can have before we zero out when packing
 		}
-		PACK_PERCENT(temp);				
+		multi_oo_pack_percent(w, temp);
 		multi_rate_add(NET_PLAYER_NUM(pl), "hul", 1);	
 
 		float quad = shield_get_max_quad(objp);
 
 		for (int i = 0; i < objp->n_quadrants; i++) {
-			temp = (objp->shield_quadrant[i] / quad);
-			PACK_PERCENT(temp);
+			multi_oo_pack_percent(w, objp->shield_quadrant[i] / quad);
 		}
 				
 		multi_rate_add(NET_PLAYER_NUM(pl), "shl", objp->n_quadrants);	
@@ -465,35 +833,29 @@ int multi_oo_pack_data(net_player *pl, object *objp, ubyte oo_flags, ubyte *data
 
 	// subsystem info
 	if( oo_flags & OO_SUBSYSTEMS_AND_AI_NEW ){
-		ubyte ns;		
 		ship_subsys *subsysp;
 				
 		// just in case we have some kind of invalid data (should've been taken care of earlier in this function)
 		if(shipp->ship_info_index < 0){
-			ns = 0;
-			PACK_BYTE( ns );
+			w.write_ubyte( 0 );
 
 			multi_rate_add(NET_PLAYER_NUM(pl), "sub", 1);	
 		}
 		// add the # of subsystems, and their data
 		else {
-			ns = (ubyte)Ship_info[shipp->ship_info_index].n_subsystems;
-			PACK_BYTE( ns );
+			w.write_ubyte( (ubyte)Ship_info[shipp->ship_info_index].n_subsystems );
 
 			multi_rate_add(NET_PLAYER_NUM(pl), "sub", 1);	
 
 			// now the subsystems.
-			for ( subsysp = GET_FIRST(&shipp->subsys_list); subsysp != END_OF_LIST(&shipp->subsys_list); subsysp = GET_NEXT(subsysp) ) {
-				temp = (float)subsysp->current_hits / (float)subsysp->max_hits;
-				PACK_PERCENT(temp);
+			for ( subsysp = shipp->subsys_array; subsysp < shipp->subsys_array + shipp->num_subsys; subsysp++ ) {
+				multi_oo_pack_percent(w, (float)subsysp->current_hits / (float)subsysp->max_hits);
 				
 				multi_rate_add(NET_PLAYER_NUM(pl), "sub", 1);
 			}
 		}
 
 		// ai mode info
-		ubyte umode = (ubyte)(Ai_info[shipp->ai_index].mode);
-		short submode = (short)(Ai_info[shipp->ai_index].submode);
 		ushort target_signature;
 
 		target_signature = 0;
@@ -501,15 +863,14 @@ int multi_oo_pack_data(net_player *pl, object *objp, ubyte oo_flags, ubyte *data
 			target_signature = Objects[Ai_info[shipp->ai_index].target_objnum].net_signature;
 		}
 
-		PACK_BYTE( umode );
-		PACK_SHORT( submode );
-		PACK_USHORT( target_signature );	
+		w.write_ubyte( (ubyte)(Ai_info[shipp->ai_index].mode) );
+		w.write_short( (short)(Ai_info[shipp->ai_index].submode) );
+		w.write_ushort( target_signature );	
 
 		multi_rate_add(NET_PLAYER_NUM(pl), "aim", 5);
 
 		// primary weapon energy
-		temp = shipp->weapon_energy / sip->max_weapon_reserve;
-		PACK_PERCENT(temp);
+		multi_oo_pack_percent(w, shipp->weapon_energy / sip->max_weapon_reserve);
 	}		
 
 	// afterburner info
@@ -519,16 +880,14 @@ int multi_oo_pack_data(net_player *pl, object *objp, ubyte oo_flags, ubyte *data
 	}
 
 	// if this ship is a support ship, send some extra info
-	ubyte support_extra = 0;
 	if(MULTIPLAYER_MASTER && (sip->flags[Ship::Info_Flags::Support]) && (shipp->ai_index >= 0) && (shipp->ai_index < MAX_AI_INFO)){
 		ushort dock_sig;
 
 		// flag
-		support_extra = 1;		
-		PACK_BYTE( support_extra );
-		PACK_ULONG( Ai_info[shipp->ai_index].ai_flags.to_u64() );
-		PACK_INT( Ai_info[shipp->ai_index].mode );
-		PACK_INT( Ai_info[shipp->ai_index].submode );
+		w.write_ubyte( 1 );
+		w.write_ulong( Ai_info[shipp->ai_index].ai_flags.to_u64() );
+		w.write_int( Ai_info[shipp->ai_index].mode );
+		w.write_int( Ai_info[shipp->ai_index].submode );
 
 		if((Ai_info[shipp->ai_index].support_ship_objnum < 0) || (Ai_info[shipp->ai_index].support_ship_objnum >= MAX_OBJECTS)){
 			dock_sig = 0;
@@ -536,44 +895,45 @@ int multi_oo_pack_data(net_player *pl, object *objp, ubyte oo_flags, ubyte *data
 			dock_sig = Objects[Ai_info[shipp->ai_index].support_ship_objnum].net_signature;
 		}		
 
-		PACK_USHORT( dock_sig );
+		w.write_ushort( dock_sig );
 	} else {
-		support_extra = 0;
-		PACK_BYTE( support_extra );
+		w.write_ubyte( 0 );
 	}			
 
 	// make sure we have a valid chunk of data
 	// Clients: must be able to accomodate the data_size and shipp->np_updates[NET_PLAYER_NUM(pl)].seq before the data itself
 	// Server: TODO
-	Assert(packet_size < 255-1);
-	if(packet_size >= 255-1){
+	int packet_size = w.size() - header_bytes;
+	Assert(!w.overflowed() && (packet_size < 255-1));
+	if(w.overflowed() || (packet_size >= 255-1)){
 		return 0;
 	}
 	data_size = (ubyte)packet_size;
 
 	// add the object's net signature, type and oo_flags
-	packet_size = 0;
+	packet_writer header(data_out, header_bytes);
 	// don't add for clients
 	if(Net_player->flags & NETINFO_FLAG_AM_MASTER){		
 		multi_rate_add(NET_PLAYER_NUM(pl), "sig", 2);
-		ADD_USHORT( objp->net_signature );		
+		header.write_ushort( objp->net_signature );		
 
 		multi_rate_add(NET_PLAYER_NUM(pl), "flg", 1);
-		ADD_DATA( oo_flags );
+		header.write_ubyte( oo_flags );
 	}	
 
 	multi_rate_add(NET_PLAYER_NUM(pl), "siz", 1);
-	ADD_DATA( data_size );	
+	header.write_ubyte( data_size );	
 	
 	multi_rate_add(NET_PLAYER_NUM(pl), "seq", 1);
-	ADD_DATA( shipp->np_updates[NET_PLAYER_NUM(pl)].seq );
+	header.write_ubyte( shipp->np_updates[NET_PLAYER_NUM(pl)].seq );
 
-	packet_size += data_size;
+	// how many updates back the baseline is, 0 if there is none
+	if(Net_player->flags & NETINFO_FLAG_AM_MASTER){
+		multi_rate_add(NET_PLAYER_NUM(pl), "bas", 1);
+		header.write_ubyte( base_ref );
+	}
 
-	// copy to the outgoing data
-	memcpy(data_out, data, packet_size);	
-	
-	return packet_size;	
+	return header_bytes + data_size;	
 }
 
 // unpack information for a client , return bytes processed
@@ -691,6 +1051,41 @@ int multi_oo_unpack_client_data(net_player *pl, ubyte *data)
 	return offset;
 }
 
+// how long the updates from this player took to get here, in seconds
+static float multi_oo_update_age(net_player *pl)
+{
+	net_player *from = MULTIPLAYER_MASTER ? pl : Netgame.server;
+
+	if(!Oo_extrapolate || (from == NULL) || (from->s_info.ping.ping_avg < 0)){
+		return 0.0f;
+	}
+
+	// half of the round trip, the rest is the way back
+	return MIN(i2fl(from->s_info.ping.ping_avg) / 2000.0f, OO_EXTRAPOLATE_MAX_TIME);
+}
+
+// moves the given parts of an update ahead by the time it took to get here, so the ship is interpolated towards where
+// it is now instead of where it was when the update was sent
+static void multi_oo_extrapolate_move(int parts, float age, vec3d *pos, matrix *orient, physics_info *pi)
+{
+	if(age <= 0.0f){
+		return;
+	}
+
+	if(parts & MULTI_MOVE_POS){
+		vm_vec_scale_add2(pos, &pi->vel, age);
+	}
+
+	// keep turning the way the ship turned when the update was sent
+	if(parts & MULTI_MOVE_ORIENT){
+		physics_info rot = *pi;
+		rot.desired_rotvel = rot.rotvel;
+		rot.flags &= ~PF_IN_SHOCKWAVE;
+
+		physics_sim_rot(orient, &rot, age);
+	}
+}
+
 // unpack the object data, return bytes processed
 #define UNPACK_PERCENT(v)					{ ubyte temp_byte; memcpy(&temp_byte, data + offset, sizeof(ubyte)); v = (float)temp_byte / 255.0f; offset++;}
 int multi_oo_unpack_data(net_player *pl, ubyte *data)
@@ -717,6 +1112,21 @@ int multi_oo_unpack_data(net_player *pl, ubyte *data)
 	GET_DATA( data_size );	
 	GET_DATA( seq_num );
 
+	// the movement from the server is read right away, so it is kept as a baseline even if the rest is skipped
+	multi_move_state move_state;
+	bool move_complete = true;
+	int move_size = 0;
+	if(!(Net_player->flags & NETINFO_FLAG_AM_MASTER)){
+		ubyte base_ref;
+		int move_parts = ((oo_flags & OO_POS_NEW) ? MULTI_MOVE_POS : 0) | ((oo_flags & OO_ORIENT_NEW) ? MULTI_MOVE_ORIENT : 0);
+
+		GET_DATA( base_ref );
+
+		if(move_parts != 0){
+			move_size = multi_oo_unpack_move(net_sig, seq_num, base_ref, move_parts, data + offset, &move_state, &move_complete);
+		}
+	}
+
 	// try and find the object
 	if(!(Net_player->flags & NETINFO_FLAG_AM_MASTER)){
 		pobjp = multi_get_network_object(net_sig);	
@@ -764,6 +1174,18 @@ int multi_oo_unpack_data(net_player *pl, ubyte *data)
 	vec3d new_pos = pobjp->pos;
 	physics_info new_phys_info = pobjp->phys_info;
 	matrix new_orient = pobjp->orient;
+
+	// the movement from the server
+	if(!(Net_player->flags & NETINFO_FLAG_AM_MASTER)){
+		offset += move_size;
+
+		// the baseline is gone, so there's nothing to use
+		if(!move_complete){
+			oo_flags &= ~(OO_POS_NEW | OO_ORIENT_NEW);
+		}
+
+		multi_dequantize_move_state(&move_state, ((oo_flags & OO_POS_NEW) ? MULTI_MOVE_POS : 0) | ((oo_flags & OO_ORIENT_NEW) ? MULTI_MOVE_ORIENT : 0), &new_pos, &new_orient, &new_phys_info);
+	}
 	
 	// position
 	if ( oo_flags & OO_POS_NEW ) {						
@@ -787,20 +1209,22 @@ int multi_oo_unpack_data(net_player *pl, ubyte *data)
 		// next expected arrival time
 		oo_arrive_time_next[shipp - Ships] = 0.0f;
 
-		// int r1 = multi_pack_unpack_position( 0, data + offset, &pobjp->pos );
-		int r1 = multi_pack_unpack_position( 0, data + offset, &new_pos );
-		offset += r1;				
+		if(Net_player->flags & NETINFO_FLAG_AM_MASTER){
+			// int r1 = multi_pack_unpack_position( 0, data + offset, &pobjp->pos );
+			int r1 = multi_pack_unpack_position( 0, data + offset, &new_pos );
+			offset += r1;				
 
-		// int r3 = multi_pack_unpack_vel( 0, data + offset, &pobjp->orient, &pobjp->pos, &pobjp->phys_info );
-		int r3 = multi_pack_unpack_vel( 0, data + offset, &pobjp->orient, &new_pos, &new_phys_info );
-		offset += r3;
+			// int r3 = multi_pack_unpack_vel( 0, data + offset, &pobjp->orient, &pobjp->pos, &pobjp->phys_info );
+			int r3 = multi_pack_unpack_vel( 0, data + offset, &pobjp->orient, &new_pos, &new_phys_info );
+			offset += r3;
+		}
 		
 		// bash desired vel to be velocity
 		// pobjp->phys_info.desired_vel = pobjp->phys_info.vel;		
 	}	
 
 	// orientation	
-	if ( oo_flags & OO_ORIENT_NEW ) {		
+	if ( (oo_flags & OO_ORIENT_NEW) && (Net_player->flags & NETINFO_FLAG_AM_MASTER) ) {		
 		// int r2 = multi_pack_unpack_orient( 0, data + offset, &pobjp->orient );
 		int r2 = multi_pack_unpack_orient( 0, data + offset, &new_orient );
 		offset += r2;		
@@ -813,6 +1237,11 @@ int multi_oo_unpack_data(net_player *pl, ubyte *data)
 		// pobjp->phys_info.desired_rotvel = vmd_zero_vector;
 	}
 	
+	// the updates are old by the time they get here, the player's own ship is only sent when it was changed on purpose
+	if(pobjp != Player_obj){
+		multi_oo_extrapolate_move(((oo_flags & OO_POS_NEW) ? MULTI_MOVE_POS : 0) | ((oo_flags & OO_ORIENT_NEW) ? MULTI_MOVE_ORIENT : 0), multi_oo_update_age(pl), &new_pos, &new_orient, &new_phys_info);
+	}
+
 	// forward thrust	
 	percent = (char)(pobjp->phys_info.forward_thrust * 100.0f);
 	Assert( percent <= 100 );
@@ -882,7 +1311,7 @@ int multi_oo_unpack_data(net_player *pl, ubyte *data)
 		
 		// fill in the subsystem data
 		subsys_count = 0;
-		for ( subsysp = GET_FIRST(&shipp->subsys_list); subsysp != END_OF_LIST(&shipp->subsys_list); subsysp = GET_NEXT(subsysp) ) {
+		for ( subsysp = shipp->subsys_array; subsysp < shipp->subsys_array + shipp->num_subsys; subsysp++ ) {
 			int subsys_type;
 
 			val = subsystem_percent[subsys_count] * subsysp->max_hits;
@@ -1014,8 +1443,8 @@ int multi_oo_unpack_data(net_player *pl, ubyte *data)
 	return offset;
 }
 
-// reset the timestamp appropriately for the passed in object
-void multi_oo_reset_timestamp(net_player *pl, object *objp, int range, int in_cone)
+// the time between updates of the passed in object
+static int multi_oo_get_update_time(net_player *pl, object *objp, int range, int in_cone)
 {
 	int stamp = 0;	
 
@@ -1057,10 +1486,7 @@ void multi_oo_reset_timestamp(net_player *pl, object *objp, int range, int in_co
 		}						
 	}
 
-	// reset the timestamp for this object
-	if(objp->type == OBJ_SHIP){
-		Ships[objp->instance].np_updates[NET_PLAYER_NUM(pl)].update_stamp = timestamp(stamp);
-	} 
+	return stamp;
 }
 
 // reset the timestamp appropriately for the passed in object
@@ -1076,10 +1502,9 @@ void multi_oo_reset_subsys_timestamp(object *objp, int player_index)
 }
 
 // determine what needs to get sent for this player regarding the passed object, and when
-int multi_oo_maybe_update(net_player *pl, object *obj, ubyte *data)
+int multi_oo_maybe_update(net_player *pl, object *obj, ubyte *data, int max_size)
 {
 	ubyte oo_flags;
-	int stamp;
 	int player_index;
 	vec3d player_eye;
 	vec3d obj_dot;
@@ -1097,15 +1522,13 @@ int multi_oo_maybe_update(net_player *pl, object *obj, ubyte *data)
 		return 0;
 	}
 
-	// determine what the timestamp is for this object
-	if(obj->type == OBJ_SHIP){
-		stamp = Ships[obj->instance].np_updates[NET_PLAYER_NUM(pl)].update_stamp;
-	} else {
+	// only ships are updated here
+	if(obj->type != OBJ_SHIP){
 		return 0;
 	}
 
-	// stamp hasn't popped yet
-	if((stamp != -1) && !timestamp_elapsed_safe(stamp, OO_MAX_TIMESTAMP)){
+	// not due yet
+	if(Ships[obj->instance].np_updates[player_index].priority < OO_PRIORITY_DUE){
 		return 0;
 	}
 	
@@ -1141,8 +1564,8 @@ int multi_oo_maybe_update(net_player *pl, object *obj, ubyte *data)
 		range = OO_FAR;
 	}
 
-	// reset the timestamp for the next update for this guy
-	multi_oo_reset_timestamp(pl, obj, range, in_cone);
+	// start over for the next update for this guy
+	shipp->np_updates[player_index].priority = 0.0f;
 
 	// base oo_flags
 	oo_flags = OO_POS_NEW | OO_ORIENT_NEW;
@@ -1220,7 +1643,7 @@ int multi_oo_maybe_update(net_player *pl, object *obj, ubyte *data)
 	shipp->np_updates[player_index].orient_chksum = cur_orient_chksum;
 
 	// pack stuff only if we have to 	
-	int packed = multi_oo_pack_data(pl, obj, oo_flags ,data);	
+	int packed = multi_oo_pack_data(pl, obj, oo_flags, data, max_size);	
 
 	// increment sequence #
 	Ships[obj->instance].np_updates[NET_PLAYER_NUM(pl)].seq++;
@@ -1229,17 +1652,49 @@ int multi_oo_maybe_update(net_player *pl, object *obj, ubyte *data)
 	return packed;
 }
 
-// process all other objects for this player
+// start a new object update packet behind the packets built so far for this player
+static packet_writer multi_oo_start_build_packet(net_player *pl, ushort *packet_id)
+{
+	oo_player_build *build = &Oo_player_builds[NET_PLAYER_NUM(pl)];
+	size_t room = (size_t)(build->packets_used + OO_BUILD_PACKET_ROOM);
+
+	if(build->packets.size() < room){
+		build->packets.resize(room);
+	}
+
+	packet_writer w(&build->packets[build->packets_used], OO_BUILD_PACKET_ROOM);
+
+	// build the header
+	*packet_id = multi_oo_start_packet(pl);
+	w.write_ubyte(OBJECT_UPDATE);
+	w.write_ushort(*packet_id);
+
+	return w;
+}
+
+// keep a finished packet until it is sent
+static void multi_oo_queue_packet(net_player *pl, int packet_size)
+{
+	oo_player_build *build = &Oo_player_builds[NET_PLAYER_NUM(pl)];
+
+	build->packets_used += packet_size;
+	build->packet_sizes.push_back(packet_size);
+
+	pl->s_info.rate_bytes += packet_size + UDP_HEADER_SIZE;
+}
+
+// build the packets of all other objects for this player. this runs on the worker threads, so it must only change what
+// belongs to this player, the packets are sent by multi_oo_send_all()
 void multi_oo_process_all(net_player *pl)
 {
-	ubyte data[MAX_PACKET_SIZE];
-	ubyte data_add[MAX_PACKET_SIZE];
-	ubyte stop;
+	ubyte moved[OO_MAX_OBJECT_SIZE];
+	ubyte *add;
 	int add_size;	
-	int packet_size = 0;
-	int idx;
+	size_t idx;
 		
 	object *moveup;	
+	ushort packet_id;
+	oo_player_build *build = &Oo_player_builds[NET_PLAYER_NUM(pl)];
 
 	// if the player has an invalid objnum..
 	if(pl->m_player->objnum < 0){
@@ -1251,102 +1706,151 @@ void multi_oo_process_all(net_player *pl)
 	// build the list of ships to check against
 	multi_oo_build_ship_list(pl);
 
+	// the objects are packed right into the packet, behind the stop byte in front of them
+	packet_writer w = multi_oo_start_build_packet(pl, &packet_id);
+
 	// do nothing if he has no object targeted, or if he has a weapon targeted
 	if((pl->s_info.target_objnum != -1) && (Objects[pl->s_info.target_objnum].type == OBJ_SHIP)){
-		// build the header
-		BUILD_HEADER(OBJECT_UPDATE);		
-	
 		// get a pointer to the object
 		targ_obj = &Objects[pl->s_info.target_objnum];
 	
 		// run through the maybe_update function
-		add_size = multi_oo_maybe_update(pl, targ_obj, data_add);
+		add = w.reserve(1 + OO_MAX_OBJECT_SIZE);
+		add_size = multi_oo_maybe_update(pl, targ_obj, add + 1, OO_MAX_OBJECT_SIZE);
 
-		// copy in any relevant data
+		// keep any relevant data
 		if(add_size){
-			stop = 0xff;			
 			multi_rate_add(NET_PLAYER_NUM(pl), "stp", 1);
-			ADD_DATA(stop);
+			add[0] = 0xff;
+			w.commit(1 + add_size);
 
-			memcpy(data + packet_size, data_add, add_size);
-			packet_size += add_size;		
+			multi_oo_record_packed_move(pl, packet_id);
 		}
-	} else {
-		// just build the header for the rest of the function
-		BUILD_HEADER(OBJECT_UPDATE);		
 	}
 		
-	idx = 0;
-	// rely on logical-AND shortcut evaluation to prevent array out-of-bounds read of OO_ship_index[idx]
-	while((idx < MAX_SHIPS) && (OO_ship_index[idx] >= 0)){
+	for(idx = 0; idx < build->ship_index.size(); idx++){
 		// if this guy is over his datarate limit, do nothing
 		if(multi_oo_rate_exceeded(pl)){
-			nprintf(("Network","Capping client\n"));
-			idx++;
-
+			build->capped++;
 			continue;
 		}			
 
 		// get the object
-		moveup = &Objects[Ships[OO_ship_index[idx]].objnum];
+		moveup = &Objects[Ships[build->ship_index[idx]].objnum];
 
 		// maybe send some info		
-		add_size = multi_oo_maybe_update(pl, moveup, data_add);
+		add = w.reserve(1 + OO_MAX_OBJECT_SIZE);
+		Assert(add != nullptr);
+		if(add == nullptr){
+			break;
+		}
+		add_size = multi_oo_maybe_update(pl, moveup, add + 1, OO_MAX_OBJECT_SIZE);
 
 		// if this data is too much for the packet, send off what we currently have and start over
-		if(packet_size + add_size > OO_MAX_SIZE){
-			stop = 0x00;			
+		if(w.size() + add_size > OO_MAX_SIZE){
+			// the stop byte goes where the data starts, so it is kept aside for the next packet
+			memcpy(moved, add + 1, add_size);
+
 			multi_rate_add(NET_PLAYER_NUM(pl), "stp", 1);
-			ADD_DATA(stop);
+			w.write_ubyte(0x00);
 									
-			multi_io_send(pl, data, packet_size);
-			pl->s_info.rate_bytes += packet_size + UDP_HEADER_SIZE;
+			multi_oo_queue_packet(pl, w.size());
+
+			w = multi_oo_start_build_packet(pl, &packet_id);
 
-			packet_size = 0;
-			BUILD_HEADER(OBJECT_UPDATE);			
+			// copy in the data
+			add = w.reserve(1 + OO_MAX_OBJECT_SIZE);
+			memcpy(add + 1, moved, add_size);
 		}
 
 		if(add_size){
-			stop = 0xff;			
 			multi_rate_add(NET_PLAYER_NUM(pl), "stp", 1);
-			ADD_DATA(stop);
+			add[0] = 0xff;
+			w.commit(1 + add_size);
 
-			// copy in the data
-			memcpy(data + packet_size,data_add,add_size);
-			packet_size += add_size;
+			multi_oo_record_packed_move(pl, packet_id);
 		}
-
-		// next ship
-		idx++;
 	}
 
-	// if we have anything more than 3 byte in the packet, send the last one off
-	if(packet_size > 3){
-		stop = 0x00;		
+	// if we have anything more than the header and the packet id in the packet, send the last one off
+	if(w.size() > HEADER_LENGTH + 2){
 		multi_rate_add(NET_PLAYER_NUM(pl), "stp", 1);
-		ADD_DATA(stop);
+		w.write_ubyte(0x00);
 								
-		multi_io_send(pl, data, packet_size);
-		pl->s_info.rate_bytes += packet_size + UDP_HEADER_SIZE;
+		multi_oo_queue_packet(pl, w.size());
 	}
 }
 
+// send off the packets which were built for this player
+static void multi_oo_send_all(net_player *pl)
+{
+	oo_player_build *build = &Oo_player_builds[NET_PLAYER_NUM(pl)];
+	size_t offset = 0;
+
+	if(build->capped > 0){
+		nprintf(("Network","Capping client, %d ships skipped\n", build->capped));
+	}
+
+	for(int packet_size : build->packet_sizes){
+		multi_io_send(pl, &build->packets[offset], packet_size);
+		offset += packet_size;
+	}
+
+	build->packets_used = 0;
+	build->packet_sizes.clear();
+	build->capped = 0;
+}
+
+
 // process all object update details for this frame
 void multi_oo_process()
 {
 	int idx;	
-	
-	// process each player
+	ship_obj *moveup;
+	SCP_vector<int> players;
+
 	for(idx=0; idx<MAX_PLAYERS; idx++){
 		if(MULTI_CONNECTED(Net_players[idx]) && !MULTI_STANDALONE(Net_players[idx]) && (Net_player != &Net_players[idx]) /*&& !MULTI_OBSERVER(Net_players[idx])*/ ){
-			// now process the rest of the objects
-			multi_oo_process_all(&Net_players[idx]);
-
-			// do firing stuff for this player
-			if((Net_players[idx].m_player != NULL) && (Net_players[idx].m_player->objnum >= 0) && !(Net_players[idx].flags & NETINFO_FLAG_LIMBO) && !(Net_players[idx].flags & NETINFO_FLAG_RESPAWNING)){
-				if((Objects[Net_players[idx].m_player->objnum].flags[Object::Object_Flags::Player_ship]) && !(Objects[Net_players[idx].m_player->objnum].flags[Object::Object_Flags::Should_be_dead])){
-					obj_player_fire_stuff( &Objects[Net_players[idx].m_player->objnum], Net_players[idx].m_player->ci );
-				}
+			players.push_back(idx);
+		}
+	}
+
+	// quantize the movement of every ship once, instead of once per player who gets an update of it
+	for ( moveup = GET_FIRST(&Ship_obj_list); moveup != END_OF_LIST(&Ship_obj_list); moveup = GET_NEXT(moveup) ) {
+		object *objp = &Objects[moveup->objnum];
+
+		if((objp->type != OBJ_SHIP) || (objp->instance < 0)){
+			continue;
+		}
+
+		Oo_frame_moves[objp->instance].signature = objp->signature;
+		multi_quantize_move_state(&Oo_frame_moves[objp->instance].state, &objp->pos, &objp->orient, &objp->phys_info);
+	}
+	Oo_frame_moves_valid = true;
+
+	// the players only read the world, so their packets can be built at the same time
+	if(Oo_parallel_build){
+		jobs::parallel_for(players.size(), 1, [&players](size_t begin, size_t end, size_t) {
+			for (size_t i = begin; i < end; ++i) {
+				multi_oo_process_all(&Net_players[players[i]]);
+			}
+		}, tracing::ObjectUpdateJob);
+	} else {
+		for(int player : players){
+			multi_oo_process_all(&Net_players[player]);
+		}
+	}
+
+	Oo_frame_moves_valid = false;
+
+	// process each player
+	for(int player : players){
+		multi_oo_send_all(&Net_players[player]);
+
+		// do firing stuff for this player
+		if((Net_players[player].m_player != NULL) && (Net_players[player].m_player->objnum >= 0) && !(Net_players[player].flags & NETINFO_FLAG_LIMBO) && !(Net_players[player].flags & NETINFO_FLAG_RESPAWNING)){
+			if((Objects[Net_players[player].m_player->objnum].flags[Object::Object_Flags::Player_ship]) && !(Objects[Net_players[player].m_player->objnum].flags[Object::Object_Flags::Should_be_dead])){
+				obj_player_fire_stuff( &Objects[Net_players[player].m_player->objnum], Net_players[player].m_player->ci );
 			}
 		}
 	}
@@ -1370,6 +1874,13 @@ void multi_oo_process_update(ubyte *data, header *hinfo)
 		pl = Net_player;
 	}
 
+	// the packets from the server have an id to acknowledge them with
+	ushort packet_id = 0;
+	if(!MULTIPLAYER_MASTER){
+		GET_USHORT(packet_id);
+		Oo_packet_ackable = true;
+	}
+
 	GET_DATA(stop);
 	
 	while(stop == 0xff){
@@ -1378,6 +1889,25 @@ void multi_oo_process_update(ubyte *data, header *hinfo)
 
 		GET_DATA(stop);
 	}
+
+	if(MULTIPLAYER_MASTER){
+		// the packets the client got from us
+		ubyte have_ack;
+		GET_DATA(have_ack);
+		if(have_ack){
+			ushort ack_id;
+			uint ack_mask;
+
+			GET_USHORT(ack_id);
+			GET_UINT(ack_mask);
+
+			if(player_index != -1){
+				multi_oo_process_ack(pl, ack_id, ack_mask);
+			}
+		}
+	} else if(Oo_packet_ackable){
+		multi_oo_ack_packet(packet_id);
+	}
 	PACKET_SET_SIZE();
 }
 
@@ -1408,7 +1938,7 @@ void multi_oo_gameplay_init()
 		
 			// update the timestamps
 			for(idx=0;idx<MAX_PLAYERS;idx++){
-				shipp->np_updates[idx].update_stamp = timestamp(cur);
+				shipp->np_updates[idx].priority = OO_PRIORITY_DUE;
 				shipp->np_updates[idx].status_update_stamp = timestamp(cur);
 				shipp->np_updates[idx].subsys_update_stamp = timestamp(cur);
 				shipp->np_updates[idx].seq = 0;		
@@ -1424,6 +1954,10 @@ void multi_oo_gameplay_init()
 		}
 	//}			
 
+	// forget all baselines
+	multi_oo_player_reset_all();
+	multi_oo_reset_sequencing();
+
 	// reset datarate stamp now
 	extern int OO_gran;
 	for(idx=0; idx<MAX_PLAYERS; idx++){
@@ -1434,61 +1968,73 @@ void multi_oo_gameplay_init()
 // send control info for a client (which is basically a "reverse" object update)
 void multi_oo_send_control_info()
 {
-	ubyte data[MAX_PACKET_SIZE], stop;
-	ubyte data_add[MAX_PACKET_SIZE];
+	ubyte *data, *add;
 	ubyte oo_flags;	
 	int add_size;
-	int packet_size = 0;
 
 	// if I'm dying or my object type is not a ship, bail here
 	if((Player_obj != NULL) && (Player_ship->flags[Ship::Ship_Flags::Dying])){
 		return;
 	}	
+
+	// the packet is built right in the buffer which is sent to the server
+	if(Netgame.server == NULL){
+		return;
+	}
+	data = multi_io_send_begin(Net_player, OO_CONTROL_MAX_SIZE);
+	if(data == nullptr){
+		return;
+	}
+	packet_writer w(data, OO_CONTROL_MAX_SIZE);
 	
 	// build the header
-	BUILD_HEADER(OBJECT_UPDATE);		
+	w.write_ubyte(OBJECT_UPDATE);
 
 	// pos and orient always
 	oo_flags = (OO_POS_NEW | OO_ORIENT_NEW);		
 
-	// pack the appropriate info into the data
-	add_size = multi_oo_pack_data(Net_player, Player_obj, oo_flags, data_add);
+	// pack the appropriate info into the data, behind its stop byte
+	add = w.reserve(1 + OO_MAX_OBJECT_SIZE);
+	add_size = multi_oo_pack_data(Net_player, Player_obj, oo_flags, add + 1, OO_MAX_OBJECT_SIZE);
 
-	// copy in any relevant data
+	// keep any relevant data
 	if(add_size){
-		stop = 0xff;		
 		multi_rate_add(NET_PLAYER_NUM(Net_player), "stp", 1);
-		
-		ADD_DATA(stop);
-
-		memcpy(data + packet_size, data_add, add_size);
-		packet_size += add_size;		
+		add[0] = 0xff;
+		w.commit(1 + add_size);
 	}
 
 	// add the final stop byte
-	stop = 0x0;	
 	multi_rate_add(NET_PLAYER_NUM(Net_player), "stp", 1);
-	ADD_DATA(stop);
+	w.write_ubyte(0x0);
+
+	// acknowledge the object updates we got
+	ubyte have_ack = Oo_ack_valid ? 1 : 0;
+	multi_rate_add(NET_PLAYER_NUM(Net_player), "ack", 1);
+	w.write_ubyte(have_ack);
+	if(have_ack){
+		multi_rate_add(NET_PLAYER_NUM(Net_player), "ack", 6);
+		w.write_ushort(Oo_ack_id);
+		w.write_uint(Oo_ack_mask);
+	}
 
 	// increment sequence #
 	Player_ship->np_updates[MY_NET_PLAYER_NUM].seq++;
 
 	// send to the server
-	if(Netgame.server != NULL){								
-		multi_io_send(Net_player, data, packet_size);
-	}
+	Assert(!w.overflowed());
+	multi_io_send_end(Net_player, w.size());
 }
 
 // Sends a packet from the server to the client, syncing the player's position/orientation to the
 // Server's. Allows for use of certain SEXPs in multiplayer.
 void multi_oo_send_changed_object(object *changedobj)
 {
-	ubyte data[MAX_PACKET_SIZE], stop;
-	ubyte data_add[MAX_PACKET_SIZE];
+	ubyte *data, *add;
 	ubyte oo_flags;	
 	int add_size;
-	int packet_size = 0;
 	int idx = 0;
+	ushort packet_id;
 #ifndef NDEBUG
 	nprintf(("Network","Attempting to affect player object.\n"));
 #endif
@@ -1504,38 +2050,45 @@ void multi_oo_send_changed_object(object *changedobj)
 	if( idx >= MAX_PLAYERS ) {
 		return;
 	}
+
+	// the packet is built right in the buffer which is sent to the player
+	data = multi_io_send_begin(&Net_players[idx], OO_CONTROL_MAX_SIZE);
+	if(data == nullptr){
+		return;
+	}
+	packet_writer w(data, OO_CONTROL_MAX_SIZE);
+
 	// build the header
-	BUILD_HEADER(OBJECT_UPDATE);		
+	w.write_ubyte(OBJECT_UPDATE);
+	packet_id = multi_oo_start_packet(&Net_players[idx]);
+	w.write_ushort(packet_id);
 
 	// pos and orient always
 	oo_flags = (OO_POS_NEW | OO_ORIENT_NEW);
 
-	// pack the appropriate info into the data
-	add_size = multi_oo_pack_data(&Net_players[idx], changedobj, oo_flags, data_add);
+	// pack the appropriate info into the data, the player never gets his own ship otherwise so it isn't recorded
+	add = w.reserve(1 + OO_MAX_OBJECT_SIZE);
+	add_size = multi_oo_pack_data(&Net_players[idx], changedobj, oo_flags, add + 1, OO_MAX_OBJECT_SIZE);
+	Oo_player_builds[idx].packed_move.ship_index = -1;
 
-	// copy in any relevant data
+	// keep any relevant data
 	if(add_size){
-		stop = 0xff;		
 		multi_rate_add(idx, "stp", 1);
-		
-		ADD_DATA(stop);
-
-		memcpy(data + packet_size, data_add, add_size);
-		packet_size += add_size;		
+		add[0] = 0xff;
+		w.commit(1 + add_size);
 	}
 
 	// add the final stop byte
-	stop = 0x0;	
 	multi_rate_add(idx, "stp", 1);
-	ADD_DATA(stop);
+	w.write_ubyte(0x0);
 
 	// increment sequence #
 //	Player_ship->np_updates[idx].seq++;
 
-	multi_io_send(&Net_players[idx], data, packet_size);
+	Assert(!w.overflowed());
+	multi_io_send_end(&Net_players[idx], w.size());
 }
 
-
 // display any oo info on the hud
 void multi_oo_display()
 {
@@ -1818,6 +2371,11 @@ void multi_oo_update_server_rate()
 // reset all sequencing info (obsolete for new object update stuff)
 void multi_oo_reset_sequencing()
 {		
+	// the updates and packets we got from the server
+	Oo_received_moves.clear();
+	Oo_ack_valid = false;
+	Oo_ack_id = 0;
+	Oo_ack_mask = 0;
 }
 
 // is this object one which needs to go through the interpolation
@@ -34,10 +34,13 @@ struct net_player;
 #define OOC_AFTERBURNER_ON			(1<<7)
 // NOTE: no additional flags here unless it's sent in an extra data byte
 
+// an update of a ship is due once its priority reaches this
+#define OO_PRIORITY_DUE				1.0f
+
 // update info
 typedef struct np_update {	
 	ubyte		seq;							// sequence #
-	int		update_stamp;				// global update stamp
+	float		priority;					// grows with the relevance of the ship to the player, reset when it is sent
 	int		status_update_stamp;
 	int		subsys_update_stamp;
 	ushort	pos_chksum;					// positional checksum
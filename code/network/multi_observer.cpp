@@ -142,7 +142,9 @@ void multi_obs_create_observer_client()
 	// make ship hidden from sensors so that this observer cannot target it.  Observers really have two ships
 	// one observer, and one "Player_ship".  Observer needs to ignore the Player_ship.
     Player_ship->flags.set(Ship::Ship_Flags::Hidden_from_sensors);
+	ship_name_index_remove(Objects[pobj_num].instance);
 	strcpy_s(Player_ship->ship_name, XSTR("Observer Ship",688));
+	ship_name_index_add(Objects[pobj_num].instance);
 	Player_ai = &Ai_info[Ships[Objects[pobj_num].instance].ai_index];		
 
 	// configure the hud to be in "observer" mode
@@ -0,0 +1,408 @@
+#ifndef _MULTI_PACKET_H
+#define _MULTI_PACKET_H
+#pragma once
+
+#include "globalincs/pstypes.h"
+
+/** @file
+ *  Typed writing and reading of packet data.
+ *
+ *  The writer puts the values straight into the buffer it is given, in the same byte order as the ADD_* macros of
+ *  multimsgs.h, so a packet can be built right where it is sent from. Values can also be packed into any number of
+ *  bits, starting with the most significant bit like the bitbuffer of multiutil.cpp does it, or as variable width
+ *  integers which take one byte for every 7 bits of the value.
+ *
+ *  Both sides check the bounds of the buffer. A value which doesn't fit isn't written or read, instead the writer or
+ *  reader is marked as overflowed so the caller only has to check that once when it is done.
+ */
+
+/**
+ * @brief Writes typed values into a packet buffer
+ */
+class packet_writer {
+	ubyte *_data;
+	int _size;
+	int _max_size;
+	bool _overflowed;
+
+	// the bits written last which don't make up a full byte yet
+	uint _rack;
+	int _rack_bits;
+
+	void put_byte(ubyte value) {
+		if (_overflowed || (_size >= _max_size)) {
+			_overflowed = true;
+			return;
+		}
+
+		_data[_size++] = value;
+	}
+
+	bool fits(int count) {
+		flush_bits();
+
+		if (_overflowed || (count < 0) || (_size + count > _max_size)) {
+			_overflowed = true;
+			return false;
+		}
+
+		return true;
+	}
+
+ public:
+	/**
+	 * @param data The buffer to write into
+	 * @param max_size The size of the buffer
+	 * @param offset Where in the buffer to start writing
+	 */
+	packet_writer(ubyte *data, int max_size, int offset = 0)
+		: _data(data), _size(offset), _max_size(max_size), _overflowed(offset > max_size), _rack(0), _rack_bits(0) {
+	}
+
+	void write_ubyte(ubyte value) {
+		flush_bits();
+		put_byte(value);
+	}
+
+	void write_short(short value) {
+		short swap = INTEL_SHORT(value);
+		write_data(&swap, sizeof(swap));
+	}
+
+	void write_ushort(ushort value) {
+		ushort swap = INTEL_SHORT(value);
+		write_data(&swap, sizeof(swap));
+	}
+
+	void write_int(int value) {
+		int swap = INTEL_INT(value);
+		write_data(&swap, sizeof(swap));
+	}
+
+	void write_uint(uint value) {
+		uint swap = INTEL_INT(value);
+		write_data(&swap, sizeof(swap));
+	}
+
+	void write_ulong(std::uint64_t value) {
+		std::uint64_t swap = INTEL_LONG(value);
+		write_data(&swap, sizeof(swap));
+	}
+
+	void write_float(float value) {
+		float swap = INTEL_FLOAT(&value);
+		write_data(&swap, sizeof(swap));
+	}
+
+	void write_vector(const vec3d &value) {
+		write_float(value.xyz.x);
+		write_float(value.xyz.y);
+		write_float(value.xyz.z);
+	}
+
+	/**
+	 * @brief Writes the length of the string followed by its characters, the same as ADD_STRING
+	 */
+	void write_string(const char *str) {
+		int len = (int)strlen(str);
+
+		if (fits(len + (int)sizeof(int))) {
+			write_int(len);
+			write_data(str, len);
+		}
+	}
+
+	void write_data(const void *data, int count) {
+		if (fits(count)) {
+			memcpy(_data + _size, data, count);
+			_size += count;
+		}
+	}
+
+	/**
+	 * @brief Writes the lowest bits of a value
+	 *
+	 * The bits are collected until they make up a full byte, the next value which isn't written as bits starts at the
+	 * next full byte.
+	 *
+	 * @param value The value
+	 * @param count The number of bits to write, at most 32
+	 */
+	void write_bits(uint value, int count) {
+		Assert((count > 0) && (count <= 32));
+
+		for (int bit = count - 1; bit >= 0; bit--) {
+			_rack = (_rack << 1) | ((value >> bit) & 1);
+
+			if (++_rack_bits == 8) {
+				put_byte((ubyte)_rack);
+				_rack = 0;
+				_rack_bits = 0;
+			}
+		}
+	}
+
+	/**
+	 * @brief Fills up the last byte written as bits with zeroes
+	 */
+	void flush_bits() {
+		if (_rack_bits > 0) {
+			ubyte last = (ubyte)(_rack << (8 - _rack_bits));
+
+			_rack = 0;
+			_rack_bits = 0;
+			put_byte(last);
+		}
+	}
+
+	/**
+	 * @brief Writes an unsigned value in as few bytes as it needs, 7 bits per byte
+	 */
+	void write_varuint(uint value) {
+		flush_bits();
+
+		while (value >= 0x80) {
+			put_byte((ubyte)(value | 0x80));
+			value >>= 7;
+		}
+		put_byte((ubyte)value);
+	}
+
+	/**
+	 * @brief Room for a function which writes into a plain buffer, such as the multi_pack_unpack_* functions
+	 *
+	 * @param max_count The most bytes which will be written there
+	 * @return Where to write, @c nullptr if that many bytes don't fit. Call commit() with the bytes actually written.
+	 */
+	ubyte *reserve(int max_count) {
+		return fits(max_count) ? (_data + _size) : nullptr;
+	}
+
+	/**
+	 * @brief Adds the bytes which were written into the room given by reserve()
+	 */
+	void commit(int count) {
+		Assert((count >= 0) && (_size + count <= _max_size));
+		_size += count;
+	}
+
+	/**
+	 * @return The offset of the next byte which is written, which is the size of the packet once it is done
+	 */
+	int size() const {
+		return _size + ((_rack_bits > 0) ? 1 : 0);
+	}
+
+	/**
+	 * @return @c true if something didn't fit into the buffer. The data written so far then isn't complete.
+	 */
+	bool overflowed() const {
+		return _overflowed;
+	}
+};
+
+/**
+ * @brief Reads typed values written by a packet_writer or the ADD_* macros
+ */
+class packet_reader {
+	const ubyte *_data;
+	int _offset;
+	int _size;
+	bool _overflowed;
+
+	// the rest of the byte which is read as bits
+	uint _rack;
+	int _rack_bits;
+
+	bool fits(int count) {
+		_rack_bits = 0;
+
+		if (_overflowed || (count < 0) || (_offset + count > _size)) {
+			_overflowed = true;
+			return false;
+		}
+
+		return true;
+	}
+
+	ubyte get_byte() {
+		if (_overflowed || (_offset >= _size)) {
+			_overflowed = true;
+			return 0;
+		}
+
+		return _data[_offset++];
+	}
+
+ public:
+	/**
+	 * @param data The packet
+	 * @param size The size of the packet
+	 * @param offset Where in the packet to start reading
+	 */
+	packet_reader(const ubyte *data, int size, int offset = 0)
+		: _data(data), _offset(offset), _size(size), _overflowed(offset > size), _rack(0), _rack_bits(0) {
+	}
+
+	ubyte read_ubyte() {
+		_rack_bits = 0;
+		return get_byte();
+	}
+
+	short read_short() {
+		short swap = 0;
+		read_data(&swap, sizeof(swap));
+		return INTEL_SHORT(swap);
+	}
+
+	ushort read_ushort() {
+		ushort swap = 0;
+		read_data(&swap, sizeof(swap));
+		return INTEL_SHORT(swap);
+	}
+
+	int read_int() {
+		int swap = 0;
+		read_data(&swap, sizeof(swap));
+		return INTEL_INT(swap);
+	}
+
+	uint read_uint() {
+		uint swap = 0;
+		read_data(&swap, sizeof(swap));
+		return INTEL_INT(swap);
+	}
+
+	std::uint64_t read_ulong() {
+		std::uint64_t swap = 0;
+		read_data(&swap, sizeof(swap));
+		return INTEL_LONG(swap);
+	}
+
+	float read_float() {
+		float swap = 0.0f;
+		read_data(&swap, sizeof(swap));
+		return INTEL_FLOAT(&swap);
+	}
+
+	void read_vector(vec3d *value) {
+		value->xyz.x = read_float();
+		value->xyz.y = read_float();
+		value->xyz.z = read_float();
+	}
+
+	/**
+	 * @brief Reads a string written by write_string() or ADD_STRING
+	 *
+	 * @param str Where to put the string
+	 * @param max_size The size of str, a longer string is an overflow
+	 */
+	void read_string(char *str, int max_size) {
+		int len = read_int();
+
+		if ((len < 0) || (len >= max_size) || !fits(len)) {
+			_overflowed = true;
+			str[0] = '\0';
+			return;
+		}
+
+		memcpy(str, _data + _offset, len);
+		str[len] = '\0';
+		_offset += len;
+	}
+
+	void read_data(void *data, int count) {
+		if (fits(count)) {
+			memcpy(data, _data + _offset, count);
+			_offset += count;
+		}
+	}
+
+	/**
+	 * @brief Reads bits written by packet_writer::write_bits()
+	 *
+	 * @param count The number of bits to read, at most 32
+	 */
+	uint read_bits(int count) {
+		uint value = 0;
+
+		Assert((count > 0) && (count <= 32));
+
+		for (int bit = 0; bit < count; bit++) {
+			if (_rack_bits == 0) {
+				_rack = get_byte();
+				_rack_bits = 8;
+			}
+
+			_rack_bits--;
+			value = (value << 1) | ((_rack >> _rack_bits) & 1);
+		}
+
+		return value;
+	}
+
+	/**
+	 * @brief Reads bits written from a signed value, the highest bit is the sign
+	 */
+	int read_signed_bits(int count) {
+		uint value = read_bits(count);
+
+		if ((count < 32) && (value & (1u << (count - 1)))) {
+			value |= ~((1u << count) - 1);
+		}
+
+		return (int)value;
+	}
+
+	/**
+	 * @brief Reads a value written by packet_writer::write_varuint()
+	 */
+	uint read_varuint() {
+		uint value = 0;
+		ubyte next;
+		int shift = 0;
+
+		_rack_bits = 0;
+
+		do {
+			next = get_byte();
+			if (shift < 32) {
+				value |= (uint)(next & 0x7f) << shift;
+			}
+			shift += 7;
+		} while ((next & 0x80) && !_overflowed);
+
+		return value;
+	}
+
+	/**
+	 * @brief Where a function which reads from a plain buffer, such as the multi_pack_unpack_* functions, can start
+	 *
+	 * Call skip() with the bytes it read.
+	 */
+	const ubyte *position() const {
+		return _data + _offset;
+	}
+
+	void skip(int count) {
+		if (fits(count)) {
+			_offset += count;
+		}
+	}
+
+	/**
+	 * @return The offset of the next byte which is read
+	 */
+	int offset() const {
+		return _offset;
+	}
+
+	/**
+	 * @return @c true if something was read beyond the end of the packet, the values read then are 0
+	 */
+	bool overflowed() const {
+		return _overflowed;
+	}
+};
+
+#endif // _MULTI_PACKET_H
@@ -0,0 +1,389 @@
+#include "network/multi_profile.h"
+
+#include "cfile/cfile.h"
+#include "cmdline/cmdline.h"
+#include "debugconsole/console.h"
+#include "io/timer.h"
+#include "network/multi.h"
+#include "network/psnet2.h"
+#include "tracing/tracing.h"
+
+namespace {
+
+// the last slot is for the players who aren't known yet
+const int PROFILE_PLAYERS = MAX_PLAYERS + 1;
+const int PROFILE_TYPES = MAX_TYPE_ID + 1;
+
+// the sizes of the datagrams are counted in steps of this many bytes, the last bucket is for anything bigger than a
+// regular packet
+const int PROFILE_SIZE_STEP = 32;
+const int PROFILE_SIZE_BUCKETS = MAX_PACKET_SIZE / PROFILE_SIZE_STEP + 1;
+
+// the default name of the CSV file for -profile_network
+const char* PROFILE_CSV_FILENAME = "network_profile.csv";
+
+struct traffic {
+	std::uint64_t bytes = 0;
+	std::uint64_t packets = 0;
+
+	void add(int size)
+	{
+		bytes += size;
+		++packets;
+	}
+};
+
+struct direction_stats {
+	traffic frame[PROFILE_PLAYERS][PROFILE_TYPES];
+	traffic total[PROFILE_PLAYERS][PROFILE_TYPES];
+
+	// the entries of frame which have traffic, so only those have to be written and cleared
+	SCP_vector<int> frame_used;
+	traffic frame_sum;
+
+	std::uint64_t sizes[PROFILE_SIZE_BUCKETS];
+	traffic datagrams;
+};
+
+direction_stats Profile_stats[2];
+
+// reliable packets, the resent ones aren't in the sent ones
+traffic Profile_reliable_frame_sent;
+traffic Profile_reliable_frame_resent;
+traffic Profile_reliable_sent;
+traffic Profile_reliable_resent;
+
+bool Profile_enabled = false;
+
+int Profile_frame = 0;
+int Profile_start_ms = 0;
+
+CFILE* Profile_csv = nullptr;
+int Profile_csv_flush_stamp = -1;
+
+tracing::Category Net_bytes_out_category("Net bytes out", false);
+tracing::Category Net_bytes_in_category("Net bytes in", false);
+tracing::Category Net_packets_out_category("Net packets out", false);
+tracing::Category Net_packets_in_category("Net packets in", false);
+tracing::Category Net_resent_category("Net reliable resent", false);
+
+const char* direction_name(int direction)
+{
+	return direction == MULTI_PROFILE_OUT ? "out" : "in";
+}
+
+void reset_stats()
+{
+	for (auto& stats : Profile_stats) {
+		for (auto& player : stats.frame) {
+			for (auto& type : player) {
+				type = traffic();
+			}
+		}
+		for (auto& player : stats.total) {
+			for (auto& type : player) {
+				type = traffic();
+			}
+		}
+
+		stats.frame_used.clear();
+		stats.frame_sum = traffic();
+		memset(stats.sizes, 0, sizeof(stats.sizes));
+		stats.datagrams = traffic();
+	}
+
+	Profile_reliable_frame_sent = traffic();
+	Profile_reliable_frame_resent = traffic();
+	Profile_reliable_sent = traffic();
+	Profile_reliable_resent = traffic();
+
+	Profile_frame = 0;
+	Profile_start_ms = timer_get_milliseconds();
+}
+
+void close_csv()
+{
+	if (Profile_csv != nullptr) {
+		cfclose(Profile_csv);
+		Profile_csv = nullptr;
+	}
+}
+
+bool open_csv(const char* filename)
+{
+	close_csv();
+
+	Profile_csv = cfopen(filename, "wt", CFILE_NORMAL, CF_TYPE_DATA);
+	if (Profile_csv == nullptr) {
+		mprintf(("Network: Could not open the network profile file '%s'\n", filename));
+		return false;
+	}
+
+	cfputs("frame,time_ms,direction,player,type,bytes,packets\n", Profile_csv);
+	Profile_csv_flush_stamp = timestamp(1000);
+
+	return true;
+}
+
+void enable()
+{
+	if (!Profile_enabled) {
+		reset_stats();
+	}
+
+	Profile_enabled = true;
+}
+
+void print_histogram(const direction_stats& stats)
+{
+	for (int idx = 0; idx < PROFILE_SIZE_BUCKETS; ++idx) {
+		if (stats.sizes[idx] == 0) {
+			continue;
+		}
+
+		auto share = stats.datagrams.packets > 0 ? (float)stats.sizes[idx] * 100.0f / (float)stats.datagrams.packets : 0.0f;
+
+		if (idx == PROFILE_SIZE_BUCKETS - 1) {
+			dc_printf("  %4d+     %10llu %6.1f%%\n", idx * PROFILE_SIZE_STEP, (unsigned long long)stats.sizes[idx], share);
+		} else {
+			dc_printf("  %4d-%-4d %10llu %6.1f%%\n", idx * PROFILE_SIZE_STEP, (idx + 1) * PROFILE_SIZE_STEP - 1,
+					  (unsigned long long)stats.sizes[idx], share);
+		}
+	}
+}
+
+void print_stats()
+{
+	auto seconds = MAX((float)(timer_get_milliseconds() - Profile_start_ms) / 1000.0f, 0.001f);
+	auto frames = MAX(Profile_frame, 1);
+
+	dc_printf("Network profile over %.1f seconds and %d frames\n", seconds, Profile_frame);
+
+	for (int direction = 0; direction < 2; ++direction) {
+		auto& stats = Profile_stats[direction];
+		traffic types[PROFILE_TYPES];
+		traffic players[PROFILE_PLAYERS];
+		traffic sum;
+
+		for (int player = 0; player < PROFILE_PLAYERS; ++player) {
+			for (int type = 0; type < PROFILE_TYPES; ++type) {
+				auto& entry = stats.total[player][type];
+
+				types[type].bytes += entry.bytes;
+				types[type].packets += entry.packets;
+				players[player].bytes += entry.bytes;
+				players[player].packets += entry.packets;
+				sum.bytes += entry.bytes;
+				sum.packets += entry.packets;
+			}
+		}
+
+		dc_printf("\n%s: %llu bytes in %llu packets (%.0f bytes/s, %.1f bytes/frame), %llu datagrams\n",
+				  direction_name(direction), (unsigned long long)sum.bytes, (unsigned long long)sum.packets,
+				  (float)sum.bytes / seconds, (float)sum.bytes / (float)frames, (unsigned long long)stats.datagrams.packets);
+
+		dc_printf("  %-6s %10s %12s %10s %9s\n", "Type", "Packets", "Bytes", "Bytes/s", "Avg size");
+		for (int type = 0; type < PROFILE_TYPES; ++type) {
+			if (types[type].packets == 0) {
+				continue;
+			}
+
+			dc_printf("  %-6d %10llu %12llu %10.0f %9.1f\n", type, (unsigned long long)types[type].packets,
+					  (unsigned long long)types[type].bytes, (float)types[type].bytes / seconds,
+					  (float)types[type].bytes / (float)types[type].packets);
+		}
+
+		dc_printf("  %-6s %10s %12s %10s\n", "Player", "Packets", "Bytes", "Bytes/s");
+		for (int player = 0; player < PROFILE_PLAYERS; ++player) {
+			if (players[player].packets == 0) {
+				continue;
+			}
+
+			dc_printf("  %-6d %10llu %12llu %10.0f\n", player == MAX_PLAYERS ? -1 : player,
+					  (unsigned long long)players[player].packets, (unsigned long long)players[player].bytes,
+					  (float)players[player].bytes / seconds);
+		}
+
+		dc_printf("  Datagram sizes:\n");
+		print_histogram(stats);
+	}
+
+	auto reliable = Profile_reliable_sent.packets + Profile_reliable_resent.packets;
+	dc_printf("\nreliable: %llu sent, %llu resent (%.1f%% of %llu bytes)\n", (unsigned long long)Profile_reliable_sent.packets,
+			  (unsigned long long)Profile_reliable_resent.packets,
+			  reliable > 0 ? (float)Profile_reliable_resent.packets * 100.0f / (float)reliable : 0.0f,
+			  (unsigned long long)(Profile_reliable_sent.bytes + Profile_reliable_resent.bytes));
+}
+
+void write_csv_frame(int time)
+{
+	char line[256];
+
+	for (int direction = 0; direction < 2; ++direction) {
+		auto& stats = Profile_stats[direction];
+
+		for (auto index : stats.frame_used) {
+			int player = index / PROFILE_TYPES;
+			int type = index % PROFILE_TYPES;
+			auto& entry = stats.frame[player][type];
+
+			sprintf(line, "%d,%d,%s,%d,%d,%llu,%llu\n", Profile_frame, time, direction_name(direction),
+					player == MAX_PLAYERS ? -1 : player, type, (unsigned long long)entry.bytes,
+					(unsigned long long)entry.packets);
+			cfputs(line, Profile_csv);
+		}
+	}
+
+	// the reliable packets which had to be sent again, they don't belong to a player or a type
+	if (Profile_reliable_frame_resent.packets > 0) {
+		sprintf(line, "%d,%d,out,-1,resent,%llu,%llu\n", Profile_frame, time,
+				(unsigned long long)Profile_reliable_frame_resent.bytes,
+				(unsigned long long)Profile_reliable_frame_resent.packets);
+		cfputs(line, Profile_csv);
+	}
+
+	if (timestamp_elapsed(Profile_csv_flush_stamp)) {
+		cflush(Profile_csv);
+		Profile_csv_flush_stamp = timestamp(1000);
+	}
+}
+
+}
+
+DCF(net_profile, "Records the network traffic per packet type and player (on|off|reset|print|csv|close)")
+{
+	if (dc_optional_string_either("help", "--help")) {
+		dc_printf("Usage: net_profile [on|off|reset|print|csv <file>|close]\n");
+		dc_printf("\ton      Starts recording the traffic\n");
+		dc_printf("\toff     Stops recording and closes the CSV file\n");
+		dc_printf("\treset   Forgets all recorded values\n");
+		dc_printf("\tprint   Lists the traffic per packet type and player, the sizes of the datagrams and the\n");
+		dc_printf("\t        reliable packets which were resent since the last reset (default)\n");
+		dc_printf("\tcsv     Starts recording and writes the traffic of every frame to the file in the data\n");
+		dc_printf("\t        directory\n");
+		dc_printf("\tclose   Closes the CSV file\n");
+		return;
+	}
+
+	if (dc_optional_string("on")) {
+		enable();
+	} else if (dc_optional_string("off")) {
+		Profile_enabled = false;
+		close_csv();
+	} else if (dc_optional_string("reset")) {
+		reset_stats();
+	} else if (dc_optional_string("csv")) {
+		SCP_string filename;
+		dc_stuff_string_white(filename);
+
+		if (open_csv(filename.c_str())) {
+			enable();
+		}
+	} else if (dc_optional_string("close")) {
+		close_csv();
+	} else {
+		print_stats();
+	}
+
+	dc_printf("Network profile is %s%s\n", Profile_enabled ? "on" : "off", Profile_csv != nullptr ? ", writing CSV" : "");
+}
+
+void multi_profile_init()
+{
+	if (!Cmdline_profile_network) {
+		return;
+	}
+
+	open_csv(PROFILE_CSV_FILENAME);
+	enable();
+}
+
+void multi_profile_close()
+{
+	close_csv();
+	Profile_enabled = false;
+}
+
+void multi_profile_packet(int direction, int np_index, int type, int size)
+{
+	if (!Profile_enabled || (type < 0) || (type >= PROFILE_TYPES)) {
+		return;
+	}
+
+	if ((np_index < 0) || (np_index >= MAX_PLAYERS)) {
+		np_index = MAX_PLAYERS;
+	}
+
+	auto& stats = Profile_stats[direction];
+	auto& entry = stats.frame[np_index][type];
+
+	if (entry.packets == 0) {
+		stats.frame_used.push_back(np_index * PROFILE_TYPES + type);
+	}
+
+	entry.add(size);
+	stats.total[np_index][type].add(size);
+	stats.frame_sum.add(size);
+}
+
+void multi_profile_datagram(int direction, int size)
+{
+	if (!Profile_enabled) {
+		return;
+	}
+
+	auto& stats = Profile_stats[direction];
+
+	stats.sizes[MIN(size / PROFILE_SIZE_STEP, PROFILE_SIZE_BUCKETS - 1)]++;
+	stats.datagrams.add(size);
+}
+
+void multi_profile_reliable(bool resent, int size)
+{
+	if (!Profile_enabled) {
+		return;
+	}
+
+	if (resent) {
+		Profile_reliable_frame_resent.add(size);
+		Profile_reliable_resent.add(size);
+	} else {
+		Profile_reliable_frame_sent.add(size);
+		Profile_reliable_sent.add(size);
+	}
+}
+
+void multi_profile_frame()
+{
+	if (!Profile_enabled) {
+		return;
+	}
+
+	auto& out = Profile_stats[MULTI_PROFILE_OUT];
+	auto& in = Profile_stats[MULTI_PROFILE_IN];
+
+	tracing::counter::value(Net_bytes_out_category, (float)out.frame_sum.bytes);
+	tracing::counter::value(Net_bytes_in_category, (float)in.frame_sum.bytes);
+	tracing::counter::value(Net_packets_out_category, (float)out.frame_sum.packets);
+	tracing::counter::value(Net_packets_in_category, (float)in.frame_sum.packets);
+	tracing::counter::value(Net_resent_category, (float)Profile_reliable_frame_resent.packets);
+
+	if (Profile_csv != nullptr) {
+		write_csv_frame(timer_get_milliseconds());
+	}
+
+	// start the next frame
+	for (auto& stats : Profile_stats) {
+		for (auto index : stats.frame_used) {
+			stats.frame[index / PROFILE_TYPES][index % PROFILE_TYPES] = traffic();
+		}
+
+		stats.frame_used.clear();
+		stats.frame_sum = traffic();
+	}
+
+	Profile_reliable_frame_sent = traffic();
+	Profile_reliable_frame_resent = traffic();
+
+	++Profile_frame;
+}
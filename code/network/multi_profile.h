@@ -0,0 +1,41 @@
+#ifndef _MULTI_PROFILE_H
+#define _MULTI_PROFILE_H
+#pragma once
+
+/** @file
+ *  Records the network traffic for capacity planning.
+ *
+ *  While the profiler is enabled, with the net_profile debug command or the -profile_network command line option, the
+ *  bytes and the number of game packets of every packet type are added up per player and direction every frame. The
+ *  sizes of the datagrams sent and received are counted in a histogram and the reliable packets which had to be sent
+ *  again are counted as well.
+ *
+ *  The totals of every frame are written to the trace output as counters, so they show up in the -json_profiling
+ *  output. When a CSV file is open every frame adds one row per player, direction and packet type which had traffic.
+ *  The totals since the last reset can be printed on the debug console.
+ */
+
+// the directions of the traffic
+#define MULTI_PROFILE_OUT				0
+#define MULTI_PROFILE_IN				1
+
+// initializes the profiler from the command line, call once at startup
+void multi_profile_init();
+
+// closes the CSV file, call once at shutdown
+void multi_profile_close();
+
+// records a game packet of the given type sent to or received from a player, np_index may be -1 if the player isn't
+// known
+void multi_profile_packet(int direction, int np_index, int type, int size);
+
+// records a datagram sent or received by the game, for the histogram of the sizes
+void multi_profile_datagram(int direction, int size);
+
+// records a reliable packet which was handed to the reliable socket or sent again because it wasn't acknowledged
+void multi_profile_reliable(bool resent, int size);
+
+// finishes the current frame, call once every frame before doing network operations
+void multi_profile_frame();
+
+#endif // _MULTI_PROFILE_H
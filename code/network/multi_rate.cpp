@@ -52,6 +52,9 @@ typedef struct mr_info {
 // all records
 mr_info Multi_rate[MAX_RATE_PLAYERS][MAX_RATE_TYPES];
 
+// the socket calls psnet makes, for all players together
+static mr_info Multi_rate_syscalls = { "syscalls", 0, -1 };
+
 
 // -----------------------------------------------------------------------------------------------------------------------
 // MULTI RATE FUNCTIONS
@@ -123,8 +126,58 @@ int multi_rate_add(int np_index, const char *type, int size)
 	return 1;
 }
 
+// add socket calls, for all players together
+void multi_rate_add_syscalls(int count)
+{
+	Multi_rate_syscalls.total_bytes += count;
+	Multi_rate_syscalls.bytes_second += count;
+	Multi_rate_syscalls.bytes_frame += count;
+}
+
 // process
 #define R_AVG(ct, ar, avg)		do {int av_idx; float av_sum = 0.0f; if(ct == 0){ avg = 0;} else { for(av_idx=0; av_idx<ct; av_idx++){ av_sum += (float)ar[av_idx]; } avg = av_sum / (float)ct; } }while(0)
+static void multi_rate_process_info(mr_info *m)
+{
+	// process alltime
+	if(m->stamp_second == -1){
+		m->stamp_second = timestamp(1000);
+	} else if(timestamp_elapsed(m->stamp_second)){
+		// if we've reached max records
+		if(m->records_second_count >= NUM_UPDATE_RECORDS){
+			memmove(m->records_second, m->records_second+1, sizeof(int) * (NUM_UPDATE_RECORDS - 1)); 
+			m->records_second[NUM_UPDATE_RECORDS-1] = m->bytes_second; 
+		}
+		// haven't reached max records
+		else {
+			m->records_second[m->records_second_count++] = m->bytes_second;
+		}
+
+		// recalculate the average
+		R_AVG(m->records_second_count, m->records_second, m->avg_second);
+
+		// reset bytes/second and timestamp
+		m->bytes_second = 0;
+		m->stamp_second = timestamp(1000);
+	}
+
+	// process per-frame
+	// if we've reached max records
+	if(m->records_frame_count >= NUM_UPDATE_RECORDS){
+		memmove(m->records_frame, m->records_frame+1, sizeof(int) * (NUM_UPDATE_RECORDS - 1)); 
+		m->records_frame[NUM_UPDATE_RECORDS-1] = m->bytes_frame; 
+	}
+	// haven't reached max records
+	else {
+		m->records_frame[m->records_frame_count++] = m->bytes_frame;
+	}
+
+	// recalculate the average
+	R_AVG(m->records_frame_count, m->records_frame, m->avg_frame);
+
+	// reset bytes/frame
+	m->bytes_frame = 0;			
+}
+
 void multi_rate_process()
 {
 	int idx, s_idx;
@@ -140,46 +193,11 @@ void multi_rate_process()
 				continue;
 			}
 
-			// process alltime
-			if(m->stamp_second == -1){
-				m->stamp_second = timestamp(1000);
-			} else if(timestamp_elapsed(m->stamp_second)){
-				// if we've reached max records
-				if(m->records_second_count >= NUM_UPDATE_RECORDS){
-					memmove(m->records_second, m->records_second+1, sizeof(int) * (NUM_UPDATE_RECORDS - 1)); 
-					m->records_second[NUM_UPDATE_RECORDS-1] = m->bytes_second; 
-				}
-				// haven't reached max records
-				else {
-					m->records_second[m->records_second_count++] = m->bytes_second;
-				}
-
-				// recalculate the average
-				R_AVG(m->records_second_count, m->records_second, m->avg_second);
-
-				// reset bytes/second and timestamp
-				m->bytes_second = 0;
-				m->stamp_second = timestamp(1000);
-			}
-
-			// process per-frame
-			// if we've reached max records
-			if(m->records_frame_count >= NUM_UPDATE_RECORDS){
-				memmove(m->records_frame, m->records_frame+1, sizeof(int) * (NUM_UPDATE_RECORDS - 1)); 
-				m->records_frame[NUM_UPDATE_RECORDS-1] = m->bytes_frame; 
-			}
-			// haven't reached max records
-			else {
-				m->records_frame[m->records_frame_count++] = m->bytes_frame;
-			}
-
-			// recalculate the average
-			R_AVG(m->records_frame_count, m->records_frame, m->avg_frame);
-
-			// reset bytes/frame
-			m->bytes_frame = 0;			
+			multi_rate_process_info(m);
 		}
 	}	
+
+	multi_rate_process_info(&Multi_rate_syscalls);
 }
 
 // display
@@ -194,6 +212,12 @@ void multi_rate_display(int np_index, int x, int y)
 		return;
 	}
 
+	// the socket calls aren't per player
+	m = &Multi_rate_syscalls;
+	gr_set_color_fast(&Color_bright_white);
+	gr_printf_no_resize(x, y, "%s %d (%d/s) (%f/f)", m->type, m->total_bytes, (int)m->avg_second, m->avg_frame);
+	y += line_height;
+
 	// get info
 	for(idx=0; idx<MAX_RATE_TYPES; idx++){
 		m = &Multi_rate[np_index][idx];
@@ -36,6 +36,9 @@ void multi_rate_reset(int np_index);
 // add data of the specified type to datarate processing, returns 0 on fail (if we ran out of types, etc, etc)
 int multi_rate_add(int np_index, const char *type, int size);
 
+// add socket calls, for all players together
+void multi_rate_add_syscalls(int count);
+
 // process. call _before_ doing network operations each frame
 void multi_rate_process();
 
@@ -47,6 +50,7 @@ void multi_rate_display(int np_index, int x, int y);
 // stubs using #defines (c.f. NO_SOUND)
 #define multi_rate_reset(np_index)
 #define multi_rate_add(np_index, type, size) 	do { } while (0)
+#define multi_rate_add_syscalls(count)			do { } while (0)
 #define multi_rate_process()
 #define multi_rate_display(np_index, x, y)
 
@@ -346,7 +346,7 @@ int multi_respawn_common_stuff(p_object *pobjp)
 		shipp->np_updates[idx].seq = 0;
 		shipp->np_updates[idx].status_update_stamp = -1;
 		shipp->np_updates[idx].subsys_update_stamp = -1;
-		shipp->np_updates[idx].update_stamp = -1;
+		shipp->np_updates[idx].priority = OO_PRIORITY_DUE;
 	}
 
 	// change the ship type and the weapons
@@ -447,7 +447,7 @@ void multi_respawn_player(net_player *pl, char cur_primary_bank, char cur_second
 	shipp->engine_recharge_index = (ship_ets & 0x000f);
 
 	// give the current bank a half-second timestamp so that we don't fire immediately unpon respawn
-	shipp->weapons.next_secondary_fire_stamp[shipp->weapons.current_secondary_bank] = timestamp(500);
+	shipp->weapons.next_secondary_fire_stamp[shipp->weapons.current_secondary_bank] = timestamp_us(500000);
 
 	// if this is a dogfight mission, make him TEAM_TRAITOR
 	if(Netgame.type_flags & NG_TYPE_DOGFIGHT){
@@ -17,6 +17,8 @@
 #include "io/timer.h"
 #include "cfile/cfile.h"
 
+#include <zlib.h>
+
 #ifndef NDEBUG
 #include "playerman/player.h"
 #include "network/multiutil.h"
@@ -40,6 +42,7 @@
 #define MULTI_XFER_CODE_HEADER				2				// file xfer header information follows, requires a HEADER_RESPONSE
 #define MULTI_XFER_CODE_DATA					3				// data block follows, requires an ack
 #define MULTI_XFER_CODE_FINAL					4				// indication from sender that xfer is complete, requires an ack
+#define MULTI_XFER_CODE_HAVE					5				// response to a header from a receiver which already has the file
 
 // entry flags
 #define MULTI_XFER_FLAG_USED					(1<<0)		// this entry is in use	
@@ -57,6 +60,16 @@
 // packet size for file xfer
 #define MULTI_XFER_MAX_DATA_SIZE				490			// this will keep us within the MULTI_XFER_MAX_SIZE_LIMIT
 
+// how many data blocks may be in flight before the sender waits for an ack
+#define MULTI_XFER_WINDOW						16
+
+// how the payload of an xfer is encoded
+#define MULTI_XFER_PAYLOAD_RAW				0				// the file as it is
+#define MULTI_XFER_PAYLOAD_ZLIB				1				// the file compressed with zlib
+
+// the receiver refuses compressed payloads larger than this, they are kept in memory until the xfer is done
+#define MULTI_XFER_MAX_PAYLOAD_SIZE			(32 * 1024 * 1024)
+
 // timeout for a given xfer operation
 #define MULTI_XFER_TIMEOUT						10000		
 
@@ -75,8 +88,12 @@ typedef struct xfer_entry {
 	char ex_filename[MAX_FILENAME_LEN+10];					// filename with xfer prefix tacked on to the front
 	CFILE *file;													// file handle of the current xferring file
 	int file_size;													// total size of the file being xferred
-	int file_ptr;													// total bytes we're received so far
-	ushort file_chksum;											// used for checking successfully xferred files
+	int file_ptr;													// total bytes of the payload we've sent/received so far
+	uint file_chksum;												// used for checking successfully xferred files and skipping ones the receiver has
+	ubyte *payload;												// the whole payload on the sender, the compressed payload on the receiver
+	int payload_size;												// size of the payload, the file size unless it is compressed
+	int payload_type;												// MULTI_XFER_PAYLOAD_* 
+	int in_flight;													// data blocks sent which have not been acked yet
 	PSNET_SOCKET_RELIABLE file_socket;						// socket used to xfer the file	
 	int xfer_stamp;												// timestamp for the current operation		
 	int force_dir;													// force the file to go to this directory on receive (will override Multi_xfer_force_dir)	
@@ -123,11 +140,26 @@ void multi_xfer_process_final(xfer_entry *xe);
 void multi_xfer_process_data(xfer_entry *xe, ubyte *data, int data_size);
 	
 // process a header
-void multi_xfer_process_header(ubyte *data, PSNET_SOCKET_RELIABLE who, ushort sig, char *filename, int file_size, ushort file_checksum);		
+void multi_xfer_process_header(ubyte *data, PSNET_SOCKET_RELIABLE who, ushort sig, char *filename, int file_size, uint file_checksum, int payload_type, int payload_size);
+
+// process a response from a receiver which already has the file
+void multi_xfer_process_have(xfer_entry *xe);
+
+// free the payload of this entry
+void multi_xfer_free_payload(xfer_entry *xe);
+
+// if the receiver already has the exact file of this entry where it would be put
+int multi_xfer_have_file(xfer_entry *xe);
 
 // send the next block of outgoing data or a "final" packet if we're done
 void multi_xfer_send_next(xfer_entry *xe);
 
+// send blocks of outgoing data until the window is full
+void multi_xfer_fill_window(xfer_entry *xe);
+
+// send a response to a header for a file we already have
+void multi_xfer_send_have(PSNET_SOCKET_RELIABLE socket, ushort sig);
+
 // send an ack to the sender
 void multi_xfer_send_ack(PSNET_SOCKET_RELIABLE socket, ushort sig);
 
@@ -243,18 +275,51 @@ int multi_xfer_send_file(PSNET_SOCKET_RELIABLE who, char *filename, int cfile_fl
 	temp_entry.file_ptr = 0;
 
 	// get the file checksum
-	if(!cf_chksum_short(temp_entry.file,&temp_entry.file_chksum)){
+	if(!cf_chksum_long(temp_entry.file,&temp_entry.file_chksum)){
 #ifdef MULTI_XFER_VERBOSE
 		nprintf(("Network","MULTI XFER : Could not get file checksum for file %s on xfer send\n",filename));
 #endif
 		return -1;
 	} 
 #ifdef MULTI_XFER_VERBOSE
-	nprintf(("Network","MULTI XFER : Got file %s checksum of %d\n",temp_entry.filename,(int)temp_entry.file_chksum));
+	nprintf(("Network","MULTI XFER : Got file %s checksum of %u\n",temp_entry.filename,temp_entry.file_chksum));
 #endif
 	// rewind the file pointer to the beginning of the file
 	cfseek(temp_entry.file,0,CF_SEEK_SET);
 
+	// read the whole file, so it can be compressed and so the data blocks don't have to wait for the disk
+	auto contents = (ubyte*)vm_malloc(MAX(temp_entry.file_size, 1));
+	if((temp_entry.file_size > 0) && (cfread(contents, 1, temp_entry.file_size, temp_entry.file) != temp_entry.file_size)){
+#ifdef MULTI_XFER_VERBOSE
+		nprintf(("Network","MULTI XFER : Could not read file %s on xfer send\n",filename));
+#endif
+		vm_free(contents);
+		cfclose(temp_entry.file);
+		return -1;
+	}
+	cfclose(temp_entry.file);
+	temp_entry.file = NULL;
+
+	// compress the file, mission files and tables shrink a lot. if it doesn't get smaller, send it as it is
+	temp_entry.payload = contents;
+	temp_entry.payload_size = temp_entry.file_size;
+	temp_entry.payload_type = MULTI_XFER_PAYLOAD_RAW;
+
+	uLongf compressed_size = compressBound((uLong)temp_entry.file_size);
+	auto compressed = (ubyte*)vm_malloc(compressed_size);
+	if((compress2(compressed, &compressed_size, contents, (uLong)temp_entry.file_size, Z_DEFAULT_COMPRESSION) == Z_OK) && (compressed_size < (uLongf)temp_entry.file_size)){
+		vm_free(contents);
+
+		temp_entry.payload = compressed;
+		temp_entry.payload_size = (int)compressed_size;
+		temp_entry.payload_type = MULTI_XFER_PAYLOAD_ZLIB;
+	} else {
+		vm_free(compressed);
+	}
+#ifdef MULTI_XFER_VERBOSE
+	nprintf(("Network","MULTI XFER : Sending file %s as %d of %d bytes\n",temp_entry.filename,temp_entry.payload_size,temp_entry.file_size));
+#endif
+
 	// set the flags
 	temp_entry.flags |= (MULTI_XFER_FLAG_USED | MULTI_XFER_FLAG_SEND | MULTI_XFER_FLAG_PENDING);
 	temp_entry.flags |= flags;
@@ -328,6 +393,9 @@ void multi_xfer_abort(int handle)
 		}
 	}
 
+	// free the payload
+	multi_xfer_free_payload(xe);
+
 	// zero the socket
 	xe->file_socket = INVALID_SOCKET;
 
@@ -359,6 +427,9 @@ void multi_xfer_release_handle(int handle)
 		}
 	}
 
+	// free the payload
+	multi_xfer_free_payload(xe);
+
 	// zero the socket
 	xe->file_socket = INVALID_SOCKET;	
 
@@ -464,13 +535,13 @@ float multi_xfer_pct_complete(int handle)
 		return -1.0f;
 	}
 
-	// if the file size is 0, return invalid
-	if(Multi_xfer_entry[handle].file_size == 0){
+	// if the payload size is 0, return invalid
+	if(Multi_xfer_entry[handle].payload_size == 0){
 		return -1.0f;
 	}
 
 	// return the pct completion
-	return (float)Multi_xfer_entry[handle].file_ptr / (float)Multi_xfer_entry[handle].file_size;
+	return (float)Multi_xfer_entry[handle].file_ptr / (float)Multi_xfer_entry[handle].payload_size;
 }
 
 // get the socket of the file xfer (useful for identifying players)
@@ -623,10 +694,22 @@ void multi_xfer_fail_entry(xfer_entry *xe)
 		multi_xfer_release_handle((int)std::distance(Multi_xfer_entry, xe));
 	}
 
+	// free the payload
+	multi_xfer_free_payload(xe);
+
 	// blast the memory clean
 	memset(xe,0,sizeof(xfer_entry));
 }
 
+// free the payload of this entry
+void multi_xfer_free_payload(xfer_entry *xe)
+{
+	if(xe->payload != NULL){
+		vm_free(xe->payload);
+		xe->payload = NULL;
+	}
+}
+
 // get a valid xfer entry handle
 int multi_xfer_get_free_handle()
 {
@@ -656,7 +739,9 @@ int multi_xfer_process_packet(unsigned char *data, PSNET_SOCKET_RELIABLE who)
 	char filename[255];
 	ushort data_size = 0;
 	int file_size = -1;
-	ushort file_checksum = 0;
+	uint file_checksum = 0;
+	ubyte payload_type = MULTI_XFER_PAYLOAD_RAW;
+	int payload_size = -1;
 	int offset = 0;
 	ubyte xfer_data[600];
 	ushort sig;
@@ -678,13 +763,16 @@ int multi_xfer_process_packet(unsigned char *data, PSNET_SOCKET_RELIABLE who)
 	case MULTI_XFER_CODE_HEADER:		
 		GET_STRING(filename);
 		GET_INT(file_size);					
-		GET_USHORT(file_checksum);
+		GET_UINT(file_checksum);
+		GET_DATA(payload_type);
+		GET_INT(payload_size);
 		sender_side = 0;
 		break;
 
 	// SEND side
 	case MULTI_XFER_CODE_ACK:
 	case MULTI_XFER_CODE_NAK:
+	case MULTI_XFER_CODE_HAVE:
 		break;
 
 	// RECV side
@@ -744,6 +832,12 @@ int multi_xfer_process_packet(unsigned char *data, PSNET_SOCKET_RELIABLE who)
 		multi_xfer_process_nak(xe);
 		break;
 
+	// process a response for a file the receiver already has
+	case MULTI_XFER_CODE_HAVE :
+		Assert(xe != NULL);
+		multi_xfer_process_have(xe);
+		break;
+
 	// process a "final" packet
 	case MULTI_XFER_CODE_FINAL :
 		Assert(xe != NULL);
@@ -759,7 +853,7 @@ int multi_xfer_process_packet(unsigned char *data, PSNET_SOCKET_RELIABLE who)
 	// process a header
 	case MULTI_XFER_CODE_HEADER :
 		// send on my reliable socket
-		multi_xfer_process_header(xfer_data, who, sig, filename, file_size, file_checksum);
+		multi_xfer_process_header(xfer_data, who, sig, filename, file_size, file_checksum, payload_type, payload_size);
 		break;
 	}		
 	return offset;
@@ -784,13 +878,44 @@ void multi_xfer_process_ack(xfer_entry *xe)
 				multi_xfer_release_handle((int)std::distance(Multi_xfer_entry, xe));
 			}
 		} 
-		// otherwise if we're waiting for an ack, we should send the next chunk of data or a "final" packet if we're done
+		// otherwise if we're waiting for an ack, a block (or the header) got through. keep the window full or send
+		// a "final" packet if we're done
 		else if(xe->flags & MULTI_XFER_FLAG_WAIT_ACK){
-			multi_xfer_send_next(xe);
+			if(xe->in_flight > 0){
+				xe->in_flight--;
+			}
+
+			// set the timestmp
+			xe->xfer_stamp = timestamp(MULTI_XFER_TIMEOUT);
+
+			multi_xfer_fill_window(xe);
 		}
 	}
 }
 
+// process a response from a receiver which already has the file
+void multi_xfer_process_have(xfer_entry *xe)
+{
+	// only the header has been sent for this entry
+	if(!(xe->flags & MULTI_XFER_FLAG_SEND) || !(xe->flags & MULTI_XFER_FLAG_WAIT_ACK) || (xe->file_ptr != 0)){
+		return;
+	}
+
+	xe->flags &= ~(MULTI_XFER_FLAG_WAIT_ACK);
+	xe->flags |= MULTI_XFER_FLAG_SUCCESS;
+	xe->file_ptr = xe->payload_size;
+	multi_xfer_free_payload(xe);
+
+#ifdef MULTI_XFER_VERBOSE
+	nprintf(("Network", "MULTI XFER : Receiver already has file %s\n", xe->filename));
+#endif
+
+	// if we should be auto-destroying this entry, do so
+	if(xe->flags & MULTI_XFER_FLAG_AUTODESTROY){
+		multi_xfer_release_handle((int)std::distance(Multi_xfer_entry, xe));
+	}
+}
+
 // process a nak for this entry
 void multi_xfer_process_nak(xfer_entry *xe)
 {		
@@ -801,10 +926,33 @@ void multi_xfer_process_nak(xfer_entry *xe)
 // process a "final" packet	
 void multi_xfer_process_final(xfer_entry *xe)
 {	
-	ushort chksum;
+	uint chksum;
 
 	// make sure we skip a line
 	nprintf(("Network","\n"));
+
+	// a compressed payload is only written once all of it is here
+	if((xe->payload_type == MULTI_XFER_PAYLOAD_ZLIB) && (xe->file != NULL)){
+		auto contents = (ubyte*)vm_malloc(MAX(xe->file_size, 1));
+		uLongf contents_size = (uLongf)xe->file_size;
+		int ok = (xe->file_ptr == xe->payload_size) && (uncompress(contents, &contents_size, xe->payload, (uLong)xe->payload_size) == Z_OK) && (contents_size == (uLongf)xe->file_size);
+
+		if(ok && (xe->file_size > 0)){
+			ok = cfwrite(contents, xe->file_size, 1, xe->file);
+		}
+		vm_free(contents);
+		multi_xfer_free_payload(xe);
+
+		if(!ok){
+#ifdef MULTI_XFER_VERBOSE
+			nprintf(("Network","MULTI XFER : could not decompress file %s!\n",xe->ex_filename));
+#endif
+			// the file is never renamed, so the checksum below fails it
+			cfclose(xe->file);
+			xe->file = NULL;
+			cf_delete(xe->ex_filename, xe->force_dir);
+		}
+	}
 	
 	// close the file
 	if(xe->file != NULL){
@@ -815,12 +963,12 @@ void multi_xfer_process_final(xfer_entry *xe)
 
 	// check to make sure the file checksum is the same
 	chksum = 0;
-	if(!cf_chksum_short(xe->ex_filename, &chksum, -1, xe->force_dir) || (chksum != xe->file_chksum)){
+	if(!cf_chksum_long(xe->ex_filename, &chksum, -1, xe->force_dir) || (chksum != xe->file_chksum)){
 		// mark as failed
 		xe->flags |= MULTI_XFER_FLAG_FAIL;
 
 #ifdef MULTI_XFER_VERBOSE
-		nprintf(("Network","MULTI XFER : file %s failed checksum %d %d!\n",xe->ex_filename, (int)xe->file_chksum, (int)chksum));
+		nprintf(("Network","MULTI XFER : file %s failed checksum %u %u!\n",xe->ex_filename, xe->file_chksum, chksum));
 #endif
 
 		// abort the xfer
@@ -830,7 +978,7 @@ void multi_xfer_process_final(xfer_entry *xe)
 	// checksums check out, so rename the file and be done with it
 	else {
 #ifdef MULTI_XFER_VERBOSE
-		nprintf(("Network","MULTI XFER : renaming xferred file from %s to %s (chksum %d %d)\n", xe->ex_filename, xe->filename, (int)xe->file_chksum, (int)chksum));
+		nprintf(("Network","MULTI XFER : renaming xferred file from %s to %s (chksum %u %u)\n", xe->ex_filename, xe->filename, xe->file_chksum, chksum));
 #endif
 		// rename the file properly
 		if(cf_rename(xe->ex_filename,xe->filename, xe->force_dir) == CF_RENAME_SUCCESS){
@@ -866,8 +1014,19 @@ void multi_xfer_process_data(xfer_entry *xe, ubyte *data, int data_size)
 	// print out a crude progress indicator
 	nprintf(("Network","."));		
 
-	// attempt to write the rest of the data string to the file
-	if((xe->file == NULL) || !cfwrite(data, data_size, 1, xe->file)){
+	// a compressed payload is gathered until it is complete, anything else is written to the file right away
+	int ok;
+	if(xe->payload_type == MULTI_XFER_PAYLOAD_ZLIB){
+		ok = (xe->file != NULL) && (xe->payload != NULL) && (data_size <= xe->payload_size - xe->file_ptr);
+		if(ok){
+			memcpy(xe->payload + xe->file_ptr, data, data_size);
+		}
+	} else {
+		ok = (xe->file != NULL) && cfwrite(data, data_size, 1, xe->file);
+	}
+
+	// if the data could not be stored
+	if(!ok){
 		// inform the sender we had a problem
 		multi_xfer_send_nak(xe->file_socket, xe->sig);
 
@@ -889,13 +1048,14 @@ void multi_xfer_process_data(xfer_entry *xe, ubyte *data, int data_size)
 }
 	
 // process a header, return bytes processed
-void multi_xfer_process_header(ubyte *data, PSNET_SOCKET_RELIABLE who, ushort sig, char *filename, int file_size, ushort file_checksum)
+void multi_xfer_process_header(ubyte *data, PSNET_SOCKET_RELIABLE who, ushort sig, char *filename, int file_size, uint file_checksum, int payload_type, int payload_size)
 {		
 	xfer_entry *xe;		
 	int handle;	
 
-	// if the xfer system is locked, send a nak
-	if(Multi_xfer_locked){		
+	// if the xfer system is locked or the payload is bogus, send a nak
+	if(Multi_xfer_locked || (file_size < 0) || (payload_size < 0) || ((payload_type != MULTI_XFER_PAYLOAD_RAW) && (payload_type != MULTI_XFER_PAYLOAD_ZLIB)) ||
+		((payload_type == MULTI_XFER_PAYLOAD_RAW) && (payload_size != file_size)) || (payload_size > MULTI_XFER_MAX_PAYLOAD_SIZE)){		
 		multi_xfer_send_nak(who, sig);
 		return;
 	}
@@ -919,6 +1079,10 @@ void multi_xfer_process_header(ubyte *data, PSNET_SOCKET_RELIABLE who, ushort si
 	// get the file chksum
 	xe->file_chksum = file_checksum;	
 
+	// get the payload
+	xe->payload_type = payload_type;
+	xe->payload_size = payload_size;
+
 	// set the socket
 	xe->file_socket = who;	
 
@@ -951,6 +1115,25 @@ void multi_xfer_process_header(ubyte *data, PSNET_SOCKET_RELIABLE who, ushort si
 		return;
 	}			
 
+	// if we already have this exact file, tell the sender it doesn't have to send it
+	if(multi_xfer_have_file(xe)){
+		xe->flags |= MULTI_XFER_FLAG_SUCCESS;
+		xe->file_ptr = xe->payload_size;
+		xe->xfer_stamp = -1;
+
+		multi_xfer_send_have(who, sig);
+
+#ifdef MULTI_XFER_VERBOSE
+		nprintf(("Network","MULTI XFER : already have file %s (chksum %u)\n", xe->filename, xe->file_chksum));
+#endif
+
+		// if we should be auto-destroying this entry, do so
+		if(xe->flags & MULTI_XFER_FLAG_AUTODESTROY){
+			multi_xfer_release_handle(handle);
+		}
+		return;
+	}
+
 	// delete the old file (if it exists)
 	cf_delete( xe->filename, CF_TYPE_MULTI_CACHE );
 	cf_delete( xe->filename, CF_TYPE_MISSIONS );
@@ -965,6 +1148,11 @@ void multi_xfer_process_header(ubyte *data, PSNET_SOCKET_RELIABLE who, ushort si
 		memset(xe, 0, sizeof(xfer_entry));
 		return;
 	}
+
+	// a compressed payload is kept in memory until it is complete
+	if(xe->payload_type == MULTI_XFER_PAYLOAD_ZLIB){
+		xe->payload = (ubyte*)vm_malloc(MAX(xe->payload_size, 1));
+	}
 	
 	// set the waiting for data flag
 	xe->flags |= MULTI_XFER_FLAG_WAIT_DATA;		
@@ -988,7 +1176,7 @@ void multi_xfer_send_next(xfer_entry *xe)
 	nprintf(("Network", "+"));		
 
 	// if we've sent all the data, then we should send a "final" packet
-	if(xe->file_ptr >= xe->file_size){
+	if(xe->file_ptr >= xe->payload_size){
 		// mark the entry as unknown 
 		xe->flags |= MULTI_XFER_FLAG_UNKNOWN;
 
@@ -1008,13 +1196,11 @@ void multi_xfer_send_next(xfer_entry *xe)
 	auto flen = strlen(xe->filename) + 4;
 
 	// determine how much data we are going to send with this packet and add it in
-	if((size_t)(xe->file_size - xe->file_ptr) >= (MULTI_XFER_MAX_DATA_SIZE - flen)){
+	if((size_t)(xe->payload_size - xe->file_ptr) >= (MULTI_XFER_MAX_DATA_SIZE - flen)){
 		data_size = (ushort)(MULTI_XFER_MAX_DATA_SIZE - flen);
 	} else {
-		data_size = (unsigned short)(xe->file_size - xe->file_ptr);
+		data_size = (unsigned short)(xe->payload_size - xe->file_ptr);
 	}
-	// increment the file pointer
-	xe->file_ptr += data_size;	
 
 	// add the opcode
 	code = MULTI_XFER_CODE_DATA;
@@ -1027,17 +1213,14 @@ void multi_xfer_send_next(xfer_entry *xe)
 	ADD_USHORT(data_size);
 	
 	// copy in the data
-	if(cfread(data+packet_size,1,(int)data_size,xe->file) == 0){
-		// send a nack to the receiver
-		multi_xfer_send_nak(xe->file_socket, xe->sig);
-
-		// fail this send
-		multi_xfer_fail_entry(xe);		
-		return;
-	}
+	memcpy(data+packet_size, xe->payload+xe->file_ptr, data_size);
 
-	// increment the packet size
+	// increment the packet size and the file pointer
 	packet_size += (int)data_size;
+	xe->file_ptr += data_size;	
+
+	// one more block waiting for an ack
+	xe->in_flight++;
 
 	// set the timestmp
 	xe->xfer_stamp = timestamp(MULTI_XFER_TIMEOUT);
@@ -1046,6 +1229,20 @@ void multi_xfer_send_next(xfer_entry *xe)
 	psnet_rel_send(xe->file_socket, data, packet_size);
 }
 
+// send blocks of outgoing data until the window is full
+void multi_xfer_fill_window(xfer_entry *xe)
+{
+	// the reliable socket keeps the blocks in order, so several of them can be on their way at once
+	while((xe->in_flight < MULTI_XFER_WINDOW) && (xe->file_ptr < xe->payload_size)){
+		multi_xfer_send_next(xe);
+	}
+
+	// once everything got through, finish the xfer
+	if((xe->in_flight == 0) && (xe->file_ptr >= xe->payload_size)){
+		multi_xfer_send_next(xe);
+	}
+}
+
 // send an ack to the sender
 void multi_xfer_send_ack(PSNET_SOCKET_RELIABLE socket, ushort sig)
 {
@@ -1086,6 +1283,26 @@ void multi_xfer_send_nak(PSNET_SOCKET_RELIABLE socket, ushort sig)
 	psnet_rel_send(socket, data, packet_size);
 }
 
+// send a response to a header for a file we already have
+void multi_xfer_send_have(PSNET_SOCKET_RELIABLE socket, ushort sig)
+{
+	ubyte data[MAX_PACKET_SIZE],code;	
+	int packet_size = 0;
+
+	// build the header and add the code
+	BUILD_HEADER(XFER_PACKET);	
+
+	// add the opcode
+	code = MULTI_XFER_CODE_HAVE;
+	ADD_DATA(code);
+
+	// add the sig
+	ADD_USHORT(sig);
+
+	// send the data	
+	psnet_rel_send(socket, data, packet_size);
+}
+
 // send a "final" packet
 void multi_xfer_send_final(xfer_entry *xe)
 {
@@ -1127,12 +1344,35 @@ void multi_xfer_send_header(xfer_entry *xe)
 	ADD_INT(xe->file_size);
 
 	// add the file checksum
-	ADD_USHORT(xe->file_chksum);
+	ADD_UINT(xe->file_chksum);
+
+	// add how the payload is encoded
+	ubyte payload_type = (ubyte)xe->payload_type;
+	ADD_DATA(payload_type);
+	ADD_INT(xe->payload_size);
 
 	// send the packet	
 	psnet_rel_send(xe->file_socket, data, packet_size);
 }
 
+// if the receiver already has the exact file of this entry where it would be put
+int multi_xfer_have_file(xfer_entry *xe)
+{
+	CFILE *file;
+	uint chksum = 0;
+	int have;
+
+	file = cfopen(xe->filename, "rb", CFILE_NORMAL, xe->force_dir);
+	if(file == NULL){
+		return 0;
+	}
+
+	have = (cfilelength(file) == xe->file_size) && cf_chksum_long(file, &chksum) && (chksum == xe->file_chksum);
+	cfclose(file);
+
+	return have;
+}
+
 // convert the filename into the prefixed ex_filename
 void multi_xfer_conv_prefix(char *filename,char *ex_filename)
 {
@@ -60,6 +60,7 @@
 #include "weapon/flak.h"
 #include "weapon/beam.h"
 #include "network/multi_rate.h"
+#include "network/multi_profile.h"
 #include "nebula/neblightning.h"
 #include "hud/hud.h"
 #include "missionui/missionscreencommon.h"
@@ -368,32 +369,44 @@ void get_vector_data(ubyte *data, int *size, vec3d vec)
 	*size = offset;
 }
 */
-// send the specified data packet to all players
-void multi_io_send(net_player *pl, ubyte *data, int len)
-{		
+// if unreliable packets may be sent to this player
+static int multi_io_can_send(net_player *pl)
+{
 	// invalid
 	if((pl == NULL) || (NET_PLAYER_NUM(pl) >= MAX_PLAYERS)){
-		return;
+		return 0;
 	}
 
 	// don't do it for single player
 	if(!(Game_mode & GM_MULTIPLAYER)){
-		return;
+		return 0;
 	}
 
 	// sanity checks
 	if(MULTIPLAYER_CLIENT){
 		// Assert(pl == Net_player);
 		if(pl != Net_player){
-			return;
+			return 0;
 		}
 	} else {
 		// Assert(pl != Net_player);
 		if(pl == Net_player){
-			return;
+			return 0;
 		}
 	}
 
+	return 1;
+}
+
+// send the specified data packet to all players
+void multi_io_send(net_player *pl, ubyte *data, int len)
+{		
+	if(!multi_io_can_send(pl)){
+		return;
+	}
+
+	multi_profile_packet(MULTI_PROFILE_OUT, NET_PLAYER_NUM(pl), data[0], len);
+
 	// If this packet will push the buffer over MAX_PACKET_SIZE, send the current send_buffer
 	if ((pl->s_info.unreliable_buffer_size + len) > MAX_PACKET_SIZE) {		
 		multi_io_send_force(pl);
@@ -406,6 +419,34 @@ void multi_io_send(net_player *pl, ubyte *data, int len)
 	pl->s_info.unreliable_buffer_size += len;
 }
 
+// room for a packet of at most max_len bytes, so it can be built right in the buffer of this player
+ubyte *multi_io_send_begin(net_player *pl, int max_len)
+{
+	if(!multi_io_can_send(pl)){
+		return NULL;
+	}
+
+	Assert(max_len <= MAX_PACKET_SIZE);
+
+	// If this packet could push the buffer over MAX_PACKET_SIZE, send the current send_buffer
+	if ((pl->s_info.unreliable_buffer_size + max_len) > MAX_PACKET_SIZE) {		
+		multi_io_send_force(pl);
+		pl->s_info.unreliable_buffer_size = 0;
+	}
+
+	return pl->s_info.unreliable_buffer + pl->s_info.unreliable_buffer_size;
+}
+
+// add the packet which was built in the room from multi_io_send_begin()
+void multi_io_send_end(net_player *pl, int len)
+{
+	Assert((pl->s_info.unreliable_buffer_size + len) <= MAX_PACKET_SIZE);
+
+	multi_profile_packet(MULTI_PROFILE_OUT, NET_PLAYER_NUM(pl), pl->s_info.unreliable_buffer[pl->s_info.unreliable_buffer_size], len);
+
+	pl->s_info.unreliable_buffer_size += len;
+}
+
 void multi_io_send_to_all(ubyte *data, int length, net_player *ignore)
 {	
 	int i;
@@ -444,6 +485,8 @@ void multi_io_send_force(net_player *pl)
 		return;
 	}
 
+	multi_profile_datagram(MULTI_PROFILE_OUT, pl->s_info.unreliable_buffer_size);
+
 	// send everything in 
 	if (MULTIPLAYER_MASTER) {
 		psnet_send(&pl->p_info.addr, pl->s_info.unreliable_buffer, pl->s_info.unreliable_buffer_size, NET_PLAYER_NUM(pl));
@@ -482,6 +525,8 @@ void multi_io_send_reliable(net_player *pl, ubyte *data, int len)
 		}
 	}
 
+	multi_profile_packet(MULTI_PROFILE_OUT, NET_PLAYER_NUM(pl), data[0], len);
+
 	// If this packet will push the buffer over MAX_PACKET_SIZE, send the current send_buffer
 	if ((pl->s_info.reliable_buffer_size + len) > MAX_PACKET_SIZE) {		
 		multi_io_send_reliable_force(pl);
@@ -532,6 +577,8 @@ void multi_io_send_reliable_force(net_player *pl)
 		return;
 	}
 
+	multi_profile_datagram(MULTI_PROFILE_OUT, pl->s_info.reliable_buffer_size);
+
 	// send everything in 
 	if(MULTIPLAYER_MASTER) {
 		psnet_rel_send(pl->reliable_socket, pl->s_info.reliable_buffer, pl->s_info.reliable_buffer_size, NET_PLAYER_NUM(pl));
@@ -3120,7 +3167,7 @@ void process_secondary_fired_packet(ubyte* data, header* hinfo, int from_player)
 	shipp->weapons.current_secondary_bank = current_bank;
 
 	// make it so we can fire this ship's secondary bank immediately!!!
-	shipp->weapons.next_secondary_fire_stamp[shipp->weapons.current_secondary_bank] = timestamp(0);
+	shipp->weapons.next_secondary_fire_stamp[shipp->weapons.current_secondary_bank] = timestamp_us(0);
 	shipp->weapons.detonate_weapon_time = timestamp(5000);		// be sure that we don't detonate a remote weapon before it is time.
 
 	// set this ship's target and subsystem information.  We will save and restore target and
@@ -7025,7 +7072,7 @@ void send_client_update_packet(net_player *pl)
 		ADD_DATA( ns );
 
 		// now the subsystems.
-		for ( subsysp = GET_FIRST(&shipp->subsys_list); subsysp != END_OF_LIST(&shipp->subsys_list); subsysp = GET_NEXT(subsysp) ) {
+		for ( subsysp = shipp->subsys_array; subsysp < shipp->subsys_array + shipp->num_subsys; subsysp++ ) {
 			percent = (ubyte)(subsysp->current_hits / subsysp->max_hits * 100.0f);
 			ADD_DATA( percent );
 		}
@@ -7145,7 +7192,7 @@ void process_client_update_packet(ubyte *data, header *hinfo)
 			if ( n_subsystems == sip->n_subsystems ) {
 
 				n_subsystems = 0;		// reuse this variable
-				for ( subsysp = GET_FIRST(&shipp->subsys_list); subsysp != END_OF_LIST(&shipp->subsys_list); subsysp = GET_NEXT(subsysp) ) {
+				for ( subsysp = shipp->subsys_array; subsysp < shipp->subsys_array + shipp->num_subsys; subsysp++ ) {
 					int subsys_type;
 
 					fl_val = subsystem_percent[n_subsystems] * subsysp->max_hits / 100.0f;
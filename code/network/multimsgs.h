@@ -69,6 +69,11 @@ void multi_io_send(net_player *pl, ubyte *data, int length);
 void multi_io_send_to_all(ubyte *data, int length, net_player *ignore = NULL);
 void multi_io_send_force(net_player *pl);
 
+// build a packet right in the buffer of unreliable packets for a player: multi_io_send_begin() returns room for a packet
+// of at most max_len bytes, or NULL if nothing may be sent to him, and multi_io_send_end() adds the packet to the buffer
+ubyte *multi_io_send_begin(net_player *pl, int max_len);
+void multi_io_send_end(net_player *pl, int len);
+
 // send the data packet to all players via their reliable sockets
 void multi_io_send_reliable(net_player *pl, ubyte *data, int length);
 void multi_io_send_to_all_reliable(ubyte* data, int length, net_player *ignore = NULL);
@@ -353,8 +358,6 @@ void send_netplayer_slot_packet();
 
 void send_subsys_update_packet(net_player *p);
 
-void send_ingame_ship_update_packet(net_player *p,ship *sp);
-
 void send_ingame_final_packet(int net_sig);
 
 void send_file_sig_packet(ushort sum_sig,int length_sig);
@@ -716,7 +716,7 @@ void multi_assign_player_ship( int net_player_num, object *objp,int ship_class )
 		shipp->np_updates[idx].seq = 0;
 		shipp->np_updates[idx].status_update_stamp = -1;
 		shipp->np_updates[idx].subsys_update_stamp = -1;
-		shipp->np_updates[idx].update_stamp = -1;
+		shipp->np_updates[idx].priority = OO_PRIORITY_DUE;
 	}
 }
 
@@ -1596,7 +1596,9 @@ void multi_create_standalone_object()
 	// make ship hidden from sensors so that this observer cannot target it.  Observers really have two ships
 	// one observer, and one "Player_ship".  Observer needs to ignore the Player_ship.
     Player_ship->flags.set(Ship::Ship_Flags::Hidden_from_sensors);
+	ship_name_index_remove(Objects[pobj_num].instance);
 	strcpy_s(Player_ship->ship_name, XSTR("Standalone Ship",904));
+	ship_name_index_add(Objects[pobj_num].instance);
 	Player_ai = &Ai_info[Ships[Objects[pobj_num].instance].ai_index];		
 
 }
@@ -4152,6 +4154,284 @@ int multi_pack_unpack_desired_rotvel( int write, ubyte *data, matrix *orient, ve
 	}
 }
 
+// the scales of the movement state, they match the packing functions above
+#define MOVE_POS_SCALE			105.0f
+#define MOVE_POS_BITS			24
+#define MOVE_VEL_SCALE			0.5f
+#define MOVE_VEL_BITS			10
+#define MOVE_ORIENT_SCALE		2047.0f
+#define MOVE_ORIENT_BITS		12
+#define MOVE_ROTVEL_SCALE		32.0f
+#define MOVE_ROTVEL_BITS		10
+
+// the smallest three quaternion components are at most this big
+#define MOVE_ORIENT_MAX			0.70710678f
+
+// differences are written with a 2 bit size class followed by this many bits, 0 means the difference is 0
+static const int Move_pos_delta_bits[4] = { 0, 8, 14, MOVE_POS_BITS + 1 };
+static const int Move_vel_delta_bits[4] = { 0, 3, 6, MOVE_VEL_BITS + 1 };
+static const int Move_orient_delta_bits[4] = { 0, 4, 8, MOVE_ORIENT_BITS + 1 };
+static const int Move_rotvel_delta_bits[4] = { 0, 3, 6, MOVE_ROTVEL_BITS + 1 };
+
+static void move_put_delta( bitbuffer *buf, int value, const int *bits )
+{
+	// zigzag, so small negative values have few bits as well
+	uint zigzag = ((uint)value << 1) ^ (uint)(value >> 31);
+	int size_class;
+
+	for (size_class = 0; size_class < 3; size_class++) {
+		if ((bits[size_class] == 0) ? (zigzag == 0) : (zigzag < (1u << bits[size_class]))) {
+			break;
+		}
+	}
+
+	bitbuffer_put( buf, (uint)size_class, 2 );
+	if (bits[size_class] > 0) {
+		bitbuffer_put( buf, zigzag, bits[size_class] );
+	}
+}
+
+static int move_get_delta( bitbuffer *buf, const int *bits )
+{
+	int size_class = (int)bitbuffer_get_unsigned( buf, 2 );
+
+	if (bits[size_class] == 0) {
+		return 0;
+	}
+
+	uint zigzag = bitbuffer_get_unsigned( buf, bits[size_class] );
+
+	return (int)(zigzag >> 1) ^ -(int)(zigzag & 1);
+}
+
+// writes or reads one value, in full or as the difference to the baseline
+static void move_pack_unpack_value( int write, bitbuffer *buf, int *value, const int *base, int abs_bits, const int *delta_bits )
+{
+	if (write) {
+		if (base != NULL) {
+			move_put_delta( buf, *value - *base, delta_bits );
+		} else {
+			bitbuffer_put( buf, (uint)*value, abs_bits );
+		}
+	} else {
+		if (base != NULL) {
+			*value = *base + move_get_delta( buf, delta_bits );
+		} else {
+			*value = bitbuffer_get_signed( buf, abs_bits );
+		}
+	}
+}
+
+void multi_quantize_move_state(multi_move_state *state, const vec3d *pos, const matrix *orient, const physics_info *pi)
+{
+	int idx;
+
+	for (idx = 0; idx < 3; idx++) {
+		state->pos[idx] = fl2i(pos->a1d[idx] * MOVE_POS_SCALE + 0.5f);
+		CAP(state->pos[idx], -(1 << (MOVE_POS_BITS - 1)), (1 << (MOVE_POS_BITS - 1)) - 1);
+
+		state->vel[idx] = fl2i(pi->vel.a1d[idx] * MOVE_VEL_SCALE);
+		CAP(state->vel[idx], -(1 << (MOVE_VEL_BITS - 1)), (1 << (MOVE_VEL_BITS - 1)) - 1);
+
+		state->rotvel[idx] = fl2i(pi->rotvel.a1d[idx] * MOVE_ROTVEL_SCALE);
+		CAP(state->rotvel[idx], -(1 << (MOVE_ROTVEL_BITS - 1)), (1 << (MOVE_ROTVEL_BITS - 1)) - 1);
+	}
+
+	// the quaternion (a, b, c, s) of vm_quaternion_rotate()
+	const float (*m)[3] = orient->a2d;
+	float trace = m[0][0] + m[1][1] + m[2][2];
+	float q[4], k;
+
+	if (trace > 0.0f) {
+		q[3] = 0.5f * fl_sqrt(1.0f + trace);
+		k = 0.25f / q[3];
+		q[0] = (m[1][2] - m[2][1]) * k;
+		q[1] = (m[2][0] - m[0][2]) * k;
+		q[2] = (m[0][1] - m[1][0]) * k;
+	} else if ((m[0][0] >= m[1][1]) && (m[0][0] >= m[2][2])) {
+		q[0] = 0.5f * fl_sqrt(MAX(1.0f + m[0][0] - m[1][1] - m[2][2], 0.0f));
+		k = (q[0] > 0.0f) ? 0.25f / q[0] : 0.0f;
+		q[1] = (m[0][1] + m[1][0]) * k;
+		q[2] = (m[0][2] + m[2][0]) * k;
+		q[3] = (m[1][2] - m[2][1]) * k;
+	} else if (m[1][1] >= m[2][2]) {
+		q[1] = 0.5f * fl_sqrt(MAX(1.0f - m[0][0] + m[1][1] - m[2][2], 0.0f));
+		k = (q[1] > 0.0f) ? 0.25f / q[1] : 0.0f;
+		q[0] = (m[0][1] + m[1][0]) * k;
+		q[2] = (m[1][2] + m[2][1]) * k;
+		q[3] = (m[2][0] - m[0][2]) * k;
+	} else {
+		q[2] = 0.5f * fl_sqrt(MAX(1.0f - m[0][0] - m[1][1] + m[2][2], 0.0f));
+		k = (q[2] > 0.0f) ? 0.25f / q[2] : 0.0f;
+		q[0] = (m[0][2] + m[2][0]) * k;
+		q[1] = (m[1][2] + m[2][1]) * k;
+		q[3] = (m[0][1] - m[1][0]) * k;
+	}
+
+	// leave out the biggest component, q and -q are the same rotation so it can always be made positive
+	int largest = 0;
+	for (idx = 1; idx < 4; idx++) {
+		if (fl_abs(q[idx]) > fl_abs(q[largest])) {
+			largest = idx;
+		}
+	}
+
+	float sign = (q[largest] < 0.0f) ? -1.0f : 1.0f;
+	int count = 0;
+
+	state->orient_index = largest;
+	for (idx = 0; idx < 4; idx++) {
+		if (idx != largest) {
+			state->orient[count] = fl2i(sign * q[idx] / MOVE_ORIENT_MAX * MOVE_ORIENT_SCALE + ((sign * q[idx] < 0.0f) ? -0.5f : 0.5f));
+			CAP(state->orient[count], -(1 << (MOVE_ORIENT_BITS - 1)), (1 << (MOVE_ORIENT_BITS - 1)) - 1);
+			count++;
+		}
+	}
+}
+
+void multi_dequantize_move_state(const multi_move_state *state, int parts, vec3d *pos, matrix *orient, physics_info *pi)
+{
+	int idx;
+
+	if (parts & MULTI_MOVE_POS) {
+		for (idx = 0; idx < 3; idx++) {
+			pos->a1d[idx] = i2fl(state->pos[idx]) / MOVE_POS_SCALE;
+			pi->vel.a1d[idx] = i2fl(state->vel[idx]) / MOVE_VEL_SCALE;
+		}
+	}
+
+	if (parts & MULTI_MOVE_ORIENT) {
+		float q[4], sum = 0.0f;
+		int count = 0;
+
+		for (idx = 0; idx < 4; idx++) {
+			if (idx != state->orient_index) {
+				q[idx] = i2fl(state->orient[count++]) / MOVE_ORIENT_SCALE * MOVE_ORIENT_MAX;
+				sum += q[idx] * q[idx];
+			}
+		}
+		q[state->orient_index] = fl_sqrt(MAX(1.0f - sum, 0.0f));
+
+		float a = q[0], b = q[1], c = q[2], s = q[3];
+
+		// the same as vm_quaternion_rotate()
+		orient->vec.rvec.xyz.x = 1.0f - 2.0f*b*b - 2.0f*c*c;
+		orient->vec.rvec.xyz.y = 2.0f*a*b + 2.0f*s*c;
+		orient->vec.rvec.xyz.z = 2.0f*a*c - 2.0f*s*b;
+		orient->vec.uvec.xyz.x = 2.0f*a*b - 2.0f*s*c;
+		orient->vec.uvec.xyz.y = 1.0f - 2.0f*a*a - 2.0f*c*c;
+		orient->vec.uvec.xyz.z = 2.0f*b*c + 2.0f*s*a;
+		orient->vec.fvec.xyz.x = 2.0f*a*c + 2.0f*s*b;
+		orient->vec.fvec.xyz.y = 2.0f*b*c - 2.0f*s*a;
+		orient->vec.fvec.xyz.z = 1.0f - 2.0f*a*a - 2.0f*b*b;
+
+		vm_orthogonalize_matrix(orient);
+
+		for (idx = 0; idx < 3; idx++) {
+			pi->rotvel.a1d[idx] = i2fl(state->rotvel[idx]) / MOVE_ROTVEL_SCALE;
+		}
+	}
+}
+
+int multi_pack_unpack_move_state(int write, ubyte *data, int parts, multi_move_state *state, const multi_move_state *baseline, int baseline_parts, bool *complete)
+{
+	bitbuffer buf;
+	int idx;
+
+	bitbuffer_init(&buf, data);
+
+	if (!write) {
+		*complete = true;
+	}
+
+	// a missing baseline is read as zeroes so the size comes out right
+	multi_move_state zero_state;
+	memset(&zero_state, 0, sizeof(zero_state));
+
+	if (parts & MULTI_MOVE_POS) {
+		uint delta = (write && (baseline != NULL) && (baseline_parts & MULTI_MOVE_POS)) ? 1 : 0;
+		const multi_move_state *base;
+
+		if (write) {
+			bitbuffer_put( &buf, delta, 1 );
+		} else {
+			delta = bitbuffer_get_unsigned( &buf, 1 );
+		}
+
+		base = NULL;
+		if (delta) {
+			if ((baseline != NULL) && (baseline_parts & MULTI_MOVE_POS)) {
+				base = baseline;
+			} else {
+				base = &zero_state;
+				*complete = false;
+			}
+		}
+
+		for (idx = 0; idx < 3; idx++) {
+			move_pack_unpack_value( write, &buf, &state->pos[idx], base ? &base->pos[idx] : NULL, MOVE_POS_BITS, Move_pos_delta_bits );
+		}
+		for (idx = 0; idx < 3; idx++) {
+			move_pack_unpack_value( write, &buf, &state->vel[idx], base ? &base->vel[idx] : NULL, MOVE_VEL_BITS, Move_vel_delta_bits );
+		}
+	}
+
+	if (parts & MULTI_MOVE_ORIENT) {
+		uint delta = (write && (baseline != NULL) && (baseline_parts & MULTI_MOVE_ORIENT)) ? 1 : 0;
+		uint same_index = 0;
+		const multi_move_state *base;
+
+		if (write) {
+			bitbuffer_put( &buf, delta, 1 );
+		} else {
+			delta = bitbuffer_get_unsigned( &buf, 1 );
+		}
+
+		base = NULL;
+		if (delta) {
+			if ((baseline != NULL) && (baseline_parts & MULTI_MOVE_ORIENT)) {
+				base = baseline;
+			} else {
+				base = &zero_state;
+				*complete = false;
+			}
+
+			// the components can only be compared if the same one is left out
+			if (write) {
+				same_index = (state->orient_index == base->orient_index) ? 1 : 0;
+				bitbuffer_put( &buf, same_index, 1 );
+			} else {
+				same_index = bitbuffer_get_unsigned( &buf, 1 );
+			}
+		}
+
+		if (same_index) {
+			if (!write) {
+				state->orient_index = base->orient_index;
+			}
+		} else {
+			if (write) {
+				bitbuffer_put( &buf, (uint)state->orient_index, 2 );
+			} else {
+				state->orient_index = (int)bitbuffer_get_unsigned( &buf, 2 );
+			}
+		}
+
+		for (idx = 0; idx < 3; idx++) {
+			move_pack_unpack_value( write, &buf, &state->orient[idx], same_index ? &base->orient[idx] : NULL, MOVE_ORIENT_BITS, Move_orient_delta_bits );
+		}
+		for (idx = 0; idx < 3; idx++) {
+			move_pack_unpack_value( write, &buf, &state->rotvel[idx], base ? &base->rotvel[idx] : NULL, MOVE_ROTVEL_BITS, Move_rotvel_delta_bits );
+		}
+	}
+
+	if (write) {
+		return bitbuffer_write_flush(&buf);
+	} else {
+		return bitbuffer_read_flush(&buf);
+	}
+}
+
 // Karajorma - sends the player to the correct debrief for this game type
 // Currently supports the dogfight kill matrix and normal debriefing stages but if new types are created they should be added here
 void send_debrief_event() {	
@@ -215,6 +215,32 @@ int multi_pack_unpack_rotvel(int write, ubyte *data, matrix *orient, vec3d *pos,
 #define OO_DESIRED_ROTVEL_RET_SIZE			3
 int multi_pack_unpack_desired_rotvel(int write, ubyte *data, matrix *orient, vec3d *pos, physics_info *pi, ship_info *sip);
 
+// the parts of a multi_move_state
+#define MULTI_MOVE_POS							(1<<0)		// position and velocity
+#define MULTI_MOVE_ORIENT						(1<<1)		// orientation and rotational velocity
+
+// the movement of an object as it is sent over the network, at the precision of the packing functions above
+typedef struct multi_move_state {
+	int pos[3];
+	int vel[3];
+	int orient_index;					// the quaternion component which is left out, it is always positive
+	int orient[3];						// the other three components
+	int rotvel[3];
+} multi_move_state;
+
+// Rounds the movement of an object to what can be sent over the network
+void multi_quantize_move_state(multi_move_state *state, const vec3d *pos, const matrix *orient, const physics_info *pi);
+
+// Gets the movement back from the rounded values, only the given parts are set
+void multi_dequantize_move_state(const multi_move_state *state, int parts, vec3d *pos, matrix *orient, physics_info *pi);
+
+// Packs/unpacks the given parts of a movement state.
+// Parts which are in the baseline are written as the difference to it, the others are written in full. When reading,
+// complete is set to false if the data refers to a part of the baseline which is missing; the size is still right
+// so the data can be skipped.
+// Returns number of bytes read or written.
+int multi_pack_unpack_move_state(int write, ubyte *data, int parts, multi_move_state *state, const multi_move_state *baseline, int baseline_parts, bool *complete);
+
 char multi_unit_to_char(float unit);
 float multi_char_to_unit(float val);
 
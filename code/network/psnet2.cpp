@@ -32,6 +32,10 @@
 #include <stdio.h>
 #include <limits.h>
 #include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
 
 #include "globalincs/pstypes.h"
 #include "network/psnet2.h"
@@ -42,7 +46,10 @@
 #include "io/timer.h"
 #include "network/multi_log.h"
 #include "network/multi_rate.h"
+#include "network/multi_profile.h"
 #include "cmdline/cmdline.h"
+#include "utils/spsc_queue.h"
+#include "tracing/tracing.h"
 
 // -------------------------------------------------------------------------------------------------------
 // PSNET 2 DEFINES/VARS
@@ -109,6 +116,8 @@ typedef struct network_packet_buffer
 	int		sequence_number;
 	int		len;	
 	net_addr	from_addr;
+	float		arrival_time;		// psnet_get_time() when the packet was read off the socket
+	int		acked;				// if the reliable data in the packet was already acknowledged by the IO thread
 	ubyte		data[MAX_TOP_LAYER_PACKET_SIZE];
 } network_packet_buffer;
 
@@ -220,6 +229,47 @@ unsigned int Serverconn = 0xffffffff;
 // top layer buffers
 network_packet_buffer_list Psnet_top_buffers[PSNET_NUM_TYPES];
 
+// The socket is read by a thread of its own, so packets are taken off the socket the moment they arrive and reliable
+// data is acknowledged right away, even while the game thread is loading or stuck in a long frame. The IO thread hands
+// the packets to the game thread with the time they arrived and sends the packets the game thread queued. The reliable
+// sockets still belong to the game thread, it only tells the IO thread which peers are connected and which packet it
+// expects from each of them next, see psnet_io_publish_socket().
+
+#define PSNET_IO_QUEUE_SIZE		1024		// packets in each direction
+#define PSNET_IO_WAIT_US			1000		// how long the IO thread waits for data before it looks at the outgoing packets
+#define PSNET_IO_BATCH_SIZE		32			// the most packets which are sent or read at once
+
+// Linux can send and read a whole batch of packets with one call, elsewhere every packet takes a call of its own
+#ifdef __linux__
+#define PSNET_IO_BATCHES
+#endif
+
+typedef struct psnet_io_packet {
+	int		len;
+	float		arrival_time;
+	int		acked;
+	SOCKADDR_IN addr;						// where the packet came from or goes to
+	int		addr_len;
+	ubyte		data[MAX_TOP_LAYER_PACKET_SIZE + 150];		// including the packet type
+} psnet_io_packet;
+
+static std::thread Psnet_io_thread;
+static std::atomic<bool> Psnet_io_running(false);
+static SOCKET Psnet_io_socket = INVALID_SOCKET;
+
+static std::unique_ptr<spsc_queue<psnet_io_packet>> Psnet_io_received;	// IO thread -> game thread
+static std::unique_ptr<spsc_queue<psnet_io_packet>> Psnet_io_outgoing;	// game thread -> IO thread
+
+// the address and port of the peer of every reliable socket, and what the game thread knows about it
+#define PSNET_IO_PEER_MASK			((1ull << 48) - 1)
+#define PSNET_IO_PEER_USED			(1ull << 48)
+#define PSNET_IO_PEER_CONNECTED	(1ull << 49)
+static std::atomic<std::uint64_t> Psnet_io_peers[MAXRELIABLESOCKETS];
+static std::atomic<ushort> Psnet_io_sequences[MAXRELIABLESOCKETS];
+
+// the socket calls since the last PSNET_TOP_LAYER_PROCESS(), of both the IO thread and the game thread
+static std::atomic<int> Psnet_io_syscalls(0);
+
 // -------------------------------------------------------------------------------------------------------
 // PSNET 2 FORWARD DECLARATIONS
 //
@@ -255,10 +305,26 @@ void psnet_rel_close();
 void psnet_buffer_init(network_packet_buffer_list *l);
 
 // buffer a packet (maintain order!)
-void psnet_buffer_packet(network_packet_buffer_list *l, ubyte *data, int length, net_addr *from);
+void psnet_buffer_packet(network_packet_buffer_list *l, ubyte *data, int length, net_addr *from, float arrival_time, int acked);
+
+// if there is no room for another packet
+bool psnet_buffer_full(network_packet_buffer_list *l);
 
 // get the index of the next packet in order!
-int psnet_buffer_get_next(network_packet_buffer_list *l, ubyte *data, int *length, net_addr *from);
+int psnet_buffer_get_next(network_packet_buffer_list *l, ubyte *data, int *length, net_addr *from, float *arrival_time = NULL, int *acked = NULL);
+
+// start and stop the thread which reads the socket
+void psnet_io_start();
+void psnet_io_stop();
+
+// buffer the packets the IO thread read
+void psnet_io_receive();
+
+// tell the IO thread about a reliable socket
+void psnet_io_publish_socket(int idx);
+
+// fill in the ack for a reliable packet, returns its size
+int psnet_rel_build_ack(reliable_header *ack_header, unsigned int sig, float time_sent);
 
 
 // -------------------------------------------------------------------------------------------------------
@@ -268,7 +334,7 @@ int psnet_buffer_get_next(network_packet_buffer_list *l, ubyte *data, int *lengt
 /**
  * Wrappers around select() and recvfrom() for lagging/losing data
  */
-int RECVFROM(SOCKET s, char *buf, int len, int flags, sockaddr *from, int *fromlen, int psnet_type)
+int RECVFROM(SOCKET s, char *buf, int len, int flags, sockaddr *from, int *fromlen, int psnet_type, float *arrival_time, int *acked)
 {
 	network_packet_buffer_list *l;
 	net_addr addr;
@@ -283,7 +349,7 @@ int RECVFROM(SOCKET s, char *buf, int len, int flags, sockaddr *from, int *froml
 	l = &Psnet_top_buffers[psnet_type];
 
 	// if we have no buffer! The user should have made sure this wasn't the case by calling SELECT()
-	ret = psnet_buffer_get_next(l, (ubyte*)buf, &ret_len, &addr);
+	ret = psnet_buffer_get_next(l, (ubyte*)buf, &ret_len, &addr, arrival_time, acked);
 	if(!ret){
 		Int3();
 		return -1;
@@ -342,7 +408,7 @@ int SELECT(int nfds, fd_set * readfds, fd_set * writefds, fd_set * exceptfds, st
 /**
  * Wrappers around sendto to sorting through different packet types
  */
-int SENDTO(SOCKET s, char * buf, int len, int flags, sockaddr *to, int tolen, int psnet_type)
+static int psnet_sendto_type(SOCKET s, char * buf, int len, int flags, sockaddr *to, int tolen, int psnet_type)
 {	
 	char outbuf[MAX_TOP_LAYER_PACKET_SIZE + 150];		
 
@@ -351,9 +417,37 @@ int SENDTO(SOCKET s, char * buf, int len, int flags, sockaddr *to, int tolen, in
 	memcpy(&outbuf[1], buf, len);
 	
 	// send it
+	Psnet_io_syscalls.fetch_add(1, std::memory_order_relaxed);
 	return sendto(s, outbuf, len + 1, flags, (SOCKADDR*)to, tolen);
 }
 
+/**
+ * Wrappers around sendto to sorting through different packet types
+ *
+ * While the IO thread is running the packet is queued for it, only the game thread may call this then.
+ */
+int SENDTO(SOCKET s, char * buf, int len, int flags, sockaddr *to, int tolen, int psnet_type)
+{	
+	if(Psnet_io_running.load(std::memory_order_acquire) && (s == Psnet_io_socket) && (tolen <= (int)sizeof(SOCKADDR_IN))){
+		psnet_io_packet packet;
+
+		Assert(len + 1 <= (int)sizeof(packet.data));
+		packet.data[0] = (ubyte)psnet_type;
+		memcpy(&packet.data[1], buf, len);
+		packet.len = len + 1;
+		memcpy(&packet.addr, to, tolen);
+		packet.addr_len = tolen;
+
+		if(Psnet_io_outgoing->push(packet)){
+			return packet.len;
+		}
+
+		// the IO thread is behind, it doesn't matter who sends this one
+	}
+
+	return psnet_sendto_type(s, buf, len, flags, to, tolen, psnet_type);
+}
+
 /**
  * Call this once per frame to read everything off of our socket
  */
@@ -376,6 +470,15 @@ void PSNET_TOP_LAYER_PROCESS()
 		return;
 	}
 
+	// the socket calls count towards the frame they are noticed in
+	multi_rate_add_syscalls(Psnet_io_syscalls.exchange(0, std::memory_order_relaxed));
+
+	// the IO thread has already read the socket
+	if ( Psnet_io_running.load(std::memory_order_acquire) ) {
+		psnet_io_receive();
+		return;
+	}
+
 	while ( 1 ) {		
 		// check if there is any data on the socket to be read.  The amount of data that can be 
 		// atomically read is stored in len.
@@ -385,6 +488,7 @@ void PSNET_TOP_LAYER_PROCESS()
 		timeout.tv_sec = 0;
 		timeout.tv_usec = 0;
 
+		multi_rate_add_syscalls(1);
 #ifdef _WIN32
 		if ( select( -1, &rfds, NULL, NULL, &timeout) == SOCKET_ERROR ) {
 #else
@@ -404,6 +508,7 @@ void PSNET_TOP_LAYER_PROCESS()
 		switch ( Socket_type ) {
 		case NET_TCP:
 			from_len = sizeof(SOCKADDR_IN);			
+			multi_rate_add_syscalls(1);
 			read_len = recvfrom( Unreliable_socket, (char*)packet_read.data, MAX_TOP_LAYER_PACKET_SIZE, 0,  (SOCKADDR*)&ip_addr, &from_len);
 			break;
 		
@@ -442,7 +547,7 @@ void PSNET_TOP_LAYER_PROCESS()
 		Assertion(((packet_type >= 0) && (packet_type < PSNET_NUM_TYPES)), "Invalid packet_type found. Packet type %d does not exist", packet_type);
 		if((packet_type >= 0) && (packet_type < PSNET_NUM_TYPES)){
 			// buffer the packet
-			psnet_buffer_packet(&Psnet_top_buffers[packet_type], packet_read.data + 1, read_len - 1, &from_addr);
+			psnet_buffer_packet(&Psnet_top_buffers[packet_type], packet_read.data + 1, read_len - 1, &from_addr, psnet_get_time(), 0);
 		}
 	}
 }
@@ -566,6 +671,9 @@ void psnet_close()
 		return;
 	}
 
+	// the sockets are about to go away
+	psnet_io_stop();
+
 #ifdef _WIN32
 	WSACancelBlockingCall();		
 
@@ -661,6 +769,9 @@ int psnet_use_protocol( int protocol )
 	Psnet_my_addr.type = protocol;
 	Socket_type = protocol;
 
+	// read the socket on its own thread from now on
+	psnet_io_start();
+
 	return 1;
 }
 
@@ -832,23 +943,27 @@ int psnet_send( net_addr * who_to, void * data, int len, int np_index )
 	send_data = (ubyte*)data;
 	send_len = len;
 
-	FD_ZERO(&wfds);
-	FD_SET( send_sock, &wfds );
-	timeout.tv_sec = 0;
-	timeout.tv_usec = 0;
+	// the IO thread does the sending, without waiting for the socket
+	if ( !Psnet_io_running.load(std::memory_order_acquire) ) {
+		FD_ZERO(&wfds);
+		FD_SET( send_sock, &wfds );
+		timeout.tv_sec = 0;
+		timeout.tv_usec = 0;
 
+		multi_rate_add_syscalls(1);
 #ifdef _WIN32
-	if ( SELECT( -1, NULL, &wfds, NULL, &timeout, PSNET_TYPE_UNRELIABLE) == SOCKET_ERROR ) {
+		if ( SELECT( -1, NULL, &wfds, NULL, &timeout, PSNET_TYPE_UNRELIABLE) == SOCKET_ERROR ) {
 #else
-	if ( SELECT( send_sock+1, NULL, &wfds, NULL, &timeout, PSNET_TYPE_UNRELIABLE) == SOCKET_ERROR ) {
+		if ( SELECT( send_sock+1, NULL, &wfds, NULL, &timeout, PSNET_TYPE_UNRELIABLE) == SOCKET_ERROR ) {
 #endif
-		ml_printf("Error on blocking select for write %d", WSAGetLastError() );
-		return 0;
-	}
+			ml_printf("Error on blocking select for write %d", WSAGetLastError() );
+			return 0;
+		}
 
-	// if the write file descriptor is not set, then bail!
-	if ( !FD_ISSET(send_sock, &wfds ) ){
-		return 0;
+		// if the write file descriptor is not set, then bail!
+		if ( !FD_ISSET(send_sock, &wfds ) ){
+			return 0;
+		}
 	}
 
 	ret = SOCKET_ERROR;
@@ -972,23 +1087,31 @@ int psnet_is_valid_ip_string( char *ip_string, int allow_port )
 // PSNET 2 RELIABLE SOCKET FUNCTIONS
 //
 
+int psnet_rel_build_ack(reliable_header *ack_header, unsigned int sig, float time_sent)
+{
+	int sig_tmp;
+	ack_header->type = RNT_ACK;	
+	ack_header->data_len = sizeof(unsigned int);
+	ack_header->send_time = time_sent;
+	ack_header->send_time = INTEL_FLOAT(&ack_header->send_time);
+	sig_tmp = INTEL_INT(sig);
+	memcpy(&ack_header->data,&sig_tmp,sizeof(unsigned int));
+
+	return RELIABLE_PACKET_HEADER_ONLY_SIZE + sizeof(unsigned int);
+}
+
 void psnet_rel_send_ack(SOCKADDR *raddr, unsigned int sig, ubyte link_type, float time_sent)
 {
-	int ret, sig_tmp;
+	int ret, size;
 	reliable_header ack_header;
-	ack_header.type = RNT_ACK;	
-	ack_header.data_len = sizeof(unsigned int);
-	ack_header.send_time = time_sent;
-	ack_header.send_time = INTEL_FLOAT(&ack_header.send_time);
-	sig_tmp = INTEL_INT(sig);
-	memcpy(&ack_header.data,&sig_tmp,sizeof(unsigned int));
+	size = psnet_rel_build_ack(&ack_header, sig, time_sent);
 	switch (link_type) {
 	case NET_TCP:
 		if(!Tcp_active){
 			ml_string("No TCP in rel_send_ack()");
 			return;
 		}
-		ret = SENDTO(Unreliable_socket, (char *)&ack_header, RELIABLE_PACKET_HEADER_ONLY_SIZE+ack_header.data_len, 0, raddr, sizeof(SOCKADDR), PSNET_TYPE_RELIABLE);
+		ret = SENDTO(Unreliable_socket, (char *)&ack_header, size, 0, raddr, sizeof(SOCKADDR), PSNET_TYPE_RELIABLE);
 		if (ret == -1) {
 			ml_string("TCP SENDTO failed in rel_send_ack()");
 		}
@@ -1059,6 +1182,7 @@ void psnet_rel_close_socket( PSNET_SOCKET_RELIABLE *sockp )
 	}
 	memset(&Reliable_sockets[*sockp],0,sizeof(reliable_socket));
 	Reliable_sockets[*sockp].status = RNF_UNUSED;	
+	psnet_io_publish_socket(*sockp);
 }
 
 // function to check the status of the reliable socket and try to re-initialize it if necessary.
@@ -1104,6 +1228,8 @@ int psnet_rel_send(PSNET_SOCKET_RELIABLE socketid, ubyte *data, int length, int
 		
 			memcpy(rsocket->sbuffers[i]->buffer,data,length);	
 
+			multi_profile_reliable(false, length);
+
 			send_header.seq = INTEL_SHORT( rsocket->theirsequence );
 			rsocket->ssequence[i] = rsocket->theirsequence;
 			
@@ -1195,6 +1321,8 @@ void psnet_rel_work()
 	static SOCKADDR rcv_addr;
 	int bytesin = 0;
 	int addrlen = sizeof(SOCKADDR);
+	float arrival_time = 0.0f;
+	int acked = 0;
 	timeout.tv_sec=0;            
 	timeout.tv_usec=0;
 
@@ -1258,7 +1386,7 @@ void psnet_rel_work()
 			SOCKADDR_IN *tcp_addr = (SOCKADDR_IN *)&rcv_addr;
 			memset(&d3_rcv_addr,0,sizeof(net_addr));
 			memset(&rcv_addr,0,sizeof(SOCKADDR));
-			bytesin = RECVFROM(Unreliable_socket, (char *)&rcv_buff,sizeof(reliable_header), 0, (SOCKADDR *)&rcv_addr,&addrlen, PSNET_TYPE_RELIABLE);
+			bytesin = RECVFROM(Unreliable_socket, (char *)&rcv_buff,sizeof(reliable_header), 0, (SOCKADDR *)&rcv_addr,&addrlen, PSNET_TYPE_RELIABLE, &arrival_time, &acked);
 			rcv_buff.seq = INTEL_SHORT( rcv_buff.seq ); //-V570
 			rcv_buff.data_len = INTEL_SHORT( rcv_buff.data_len ); //-V570
 			rcv_buff.send_time = INTEL_FLOAT( &rcv_buff.send_time );
@@ -1299,7 +1427,7 @@ void psnet_rel_work()
 						Reliable_sockets[i].ping_pos = 0;
 						Reliable_sockets[i].num_ping_samples = 0;
 						Reliable_sockets[i].status = RNF_LIMBO;
-						Reliable_sockets[i].last_packet_received = psnet_get_time();
+						Reliable_sockets[i].last_packet_received = arrival_time;
 						rsocket = &Reliable_sockets[i];
 						rcvaddr = (SOCKADDR_IN *)&rcv_addr;
 						ml_printf("Connect from %s:%d", inet_ntoa(rcvaddr->sin_addr), htons(rcvaddr->sin_port));
@@ -1327,7 +1455,7 @@ void psnet_rel_work()
 				ml_printf("Received from %s:%d\n",inet_ntoa(rcvaddr->sin_addr),rcvaddr->sin_port);
 				continue ;
 			}
-			rsocket->last_packet_received = psnet_get_time();
+			rsocket->last_packet_received = arrival_time;
 			
 			if(rsocket->status != RNF_CONNECTED){
 				//Get out of limbo
@@ -1352,12 +1480,12 @@ void psnet_rel_work()
 				if((rcv_buff.type == RNT_DATA) && (Serverconn != 0xffffffff)){
 					rsocket->status = RNF_CONNECTED;
 				} else {					
-					rsocket->last_packet_received = psnet_get_time();
+					rsocket->last_packet_received = arrival_time;
 					continue;
 				}				
 			}
 			//Update the last recv variable so we don't need a heartbeat
-			rsocket->last_packet_received = psnet_get_time();
+			rsocket->last_packet_received = arrival_time;
 
 			if(rcv_buff.type == RNT_HEARTBEAT){
 				continue;
@@ -1396,7 +1524,7 @@ void psnet_rel_work()
 					}
 				}
 				//remove that packet from the send buffer
-				rsocket->last_packet_received = psnet_get_time();
+				rsocket->last_packet_received = arrival_time;
 				continue;
 			}
 
@@ -1451,7 +1579,10 @@ void psnet_rel_work()
 						}
 					}
 				}
-				psnet_rel_send_ack(&rsocket->addr, rcv_buff.seq, link_type, rcv_buff.send_time);		
+				// unless the IO thread did already
+				if(!acked){
+					psnet_rel_send_ack(&rsocket->addr, rcv_buff.seq, link_type, rcv_buff.send_time);		
+				}
 			}
 			
 		}
@@ -1506,6 +1637,8 @@ void psnet_rel_work()
 					} else {
 						rsocket->last_packet_sent = psnet_get_time();
 						rsocket->timesent[i] = psnet_get_time();
+
+						multi_profile_reliable(true, rsocket->send_len[i]);
 					}
 					
 				}//getcwd
@@ -1533,6 +1666,8 @@ void psnet_rel_work()
 				rsocket->status = RNF_BROKEN;
 			}
 		}
+
+		psnet_io_publish_socket(j);
 	}	
 }
 
@@ -1822,7 +1957,7 @@ void psnet_buffer_init(network_packet_buffer_list *l)
 /**
  * Buffer a packet (maintain order!)
  */
-void psnet_buffer_packet(network_packet_buffer_list *l, ubyte *data, int length, net_addr *from)
+void psnet_buffer_packet(network_packet_buffer_list *l, ubyte *data, int length, net_addr *from, float arrival_time, int acked)
 {
 	int idx;
 	int found_buf = 0;
@@ -1843,6 +1978,8 @@ void psnet_buffer_packet(network_packet_buffer_list *l, ubyte *data, int length,
 		memcpy(l->psnet_buffers[idx].data, data, length);
 		l->psnet_buffers[idx].len = length;
 		memcpy(&l->psnet_buffers[idx].from_addr, from, sizeof(net_addr));
+		l->psnet_buffers[idx].arrival_time = arrival_time;
+		l->psnet_buffers[idx].acked = acked;
 		l->psnet_buffers[idx].sequence_number = l->psnet_seq_number;
 		
 		// keep track of the highest id#
@@ -1855,10 +1992,26 @@ void psnet_buffer_packet(network_packet_buffer_list *l, ubyte *data, int length,
 	}
 }
 
+/**
+ * If there is no room for another packet
+ */
+bool psnet_buffer_full(network_packet_buffer_list *l)
+{
+	int idx;
+
+	for(idx=0;idx<MAX_PACKET_BUFFERS;idx++){
+		if(l->psnet_buffers[idx].sequence_number == -1){
+			return false;
+		}
+	}
+
+	return true;
+}
+
 /**
  * Get the index of the next packet in order!
  */
-int psnet_buffer_get_next(network_packet_buffer_list *l, ubyte *data, int *length, net_addr *from)
+int psnet_buffer_get_next(network_packet_buffer_list *l, ubyte *data, int *length, net_addr *from, float *arrival_time, int *acked)
 {	
 	int idx;
 	int found_buf = 0;
@@ -1884,6 +2037,12 @@ int psnet_buffer_get_next(network_packet_buffer_list *l, ubyte *data, int *lengt
 	memcpy(data, l->psnet_buffers[idx].data, l->psnet_buffers[idx].len);
 	*length = l->psnet_buffers[idx].len;
 	memcpy(from, &l->psnet_buffers[idx].from_addr, sizeof(net_addr));
+	if(arrival_time != NULL){
+		*arrival_time = l->psnet_buffers[idx].arrival_time;
+	}
+	if(acked != NULL){
+		*acked = l->psnet_buffers[idx].acked;
+	}
 
 	// now we need to cleanup the packet list
 
@@ -1894,6 +2053,389 @@ int psnet_buffer_get_next(network_packet_buffer_list *l, ubyte *data, int *lengt
 	return 1;
 }
 
+// -------------------------------------------------------------------------------------------------------
+// PSNET 2 IO THREAD FUNCTIONS
+//
+
+/**
+ * The address and port of a peer the way Psnet_io_peers has them
+ */
+static std::uint64_t psnet_io_peer_key(const ubyte *addr, short port)
+{
+	std::uint32_t ip;
+
+	memcpy(&ip, addr, sizeof(ip));
+
+	return (((std::uint64_t)ip << 16) | (ushort)port) & PSNET_IO_PEER_MASK;
+}
+
+/**
+ * Tell the IO thread about the current state of a reliable socket
+ */
+void psnet_io_publish_socket(int idx)
+{
+	reliable_socket *rsocket = &Reliable_sockets[idx];
+	std::uint64_t peer = 0;
+
+	if(rsocket->status != RNF_UNUSED){
+		peer = psnet_io_peer_key(rsocket->m_net_addr.addr, rsocket->m_net_addr.port) | PSNET_IO_PEER_USED;
+
+		if(rsocket->status == RNF_CONNECTED){
+			peer |= PSNET_IO_PEER_CONNECTED;
+		}
+	}
+
+	Psnet_io_sequences[idx].store(rsocket->oursequence, std::memory_order_relaxed);
+	Psnet_io_peers[idx].store(peer, std::memory_order_release);
+}
+
+/**
+ * If the IO thread may acknowledge this reliable packet, because psnet_rel_work() would do the same with it
+ *
+ * The sequence the game thread expects next may be a little behind, which only ever makes this more careful about
+ * new packets; the old ones it still lets through have been delivered already.
+ */
+static bool psnet_io_should_ack(const SOCKADDR_IN *from, const reliable_header *header, int len)
+{
+	int i;
+
+	if((len < (int)RELIABLE_PACKET_HEADER_ONLY_SIZE) || ((header->type != RNT_DATA) && (header->type != RNT_DATA_COMP))){
+		return false;
+	}
+
+	if(INTEL_SHORT(header->data_len) > NETBUFFERSIZE){
+		return false;
+	}
+
+	std::uint64_t key = psnet_io_peer_key((const ubyte*)&from->sin_addr.s_addr, (short)from->sin_port);
+
+	for(i=1; i<MAXRELIABLESOCKETS; i++){
+		std::uint64_t peer = Psnet_io_peers[i].load(std::memory_order_acquire);
+
+		if(!(peer & PSNET_IO_PEER_USED) || ((peer & PSNET_IO_PEER_MASK) != key)){
+			continue;
+		}
+
+		// the game thread only ever looks at the first socket of a peer
+		if(!(peer & PSNET_IO_PEER_CONNECTED)){
+			return false;
+		}
+
+		int seqdelta = INTEL_SHORT(header->seq) - Psnet_io_sequences[i].load(std::memory_order_relaxed);
+		if(seqdelta < 0){
+			seqdelta = -seqdelta;
+		}
+
+		return seqdelta < MAXNETBUFFERS - 1;
+	}
+
+	return false;
+}
+
+/**
+ * Buffer the packets the IO thread read, in the order they arrived
+ */
+void psnet_io_receive()
+{
+	psnet_io_packet *packet;
+	net_addr from_addr;
+
+	while ( (packet = Psnet_io_received->front()) != NULL ) {
+		int packet_type = packet->data[0];
+		Assertion(((packet_type >= 0) && (packet_type < PSNET_NUM_TYPES)), "Invalid packet_type found. Packet type %d does not exist", packet_type);
+
+		if ( (packet_type >= 0) && (packet_type < PSNET_NUM_TYPES) ) {
+			// the sender thinks acknowledged data has arrived, so it has to wait until there is room for it
+			if ( packet->acked && psnet_buffer_full(&Psnet_top_buffers[packet_type]) ) {
+				break;
+			}
+
+			memset(&from_addr, 0, sizeof(from_addr));
+			from_addr.type = NET_TCP;
+			from_addr.port = ntohs( packet->addr.sin_port );
+			memcpy(from_addr.addr, &packet->addr.sin_addr.s_addr, 4); //-V512
+
+			psnet_buffer_packet(&Psnet_top_buffers[packet_type], packet->data + 1, packet->len - 1, &from_addr, packet->arrival_time, packet->acked);
+		}
+
+		Psnet_io_received->pop();
+	}
+}
+
+/**
+ * Send the packets with as few calls as possible, returns how many were sent
+ *
+ * A packet which can't be sent is dropped like the game thread would.
+ */
+static int psnet_io_send_packets(SOCKET sock, psnet_io_packet **packets, bool *sent, int count)
+{
+	int idx;
+	int num_sent = 0;
+
+#ifdef PSNET_IO_BATCHES
+	struct mmsghdr msgs[PSNET_IO_BATCH_SIZE];
+	struct iovec iovs[PSNET_IO_BATCH_SIZE];
+
+	idx = 0;
+	while(idx < count){
+		int batch = MIN(count - idx, PSNET_IO_BATCH_SIZE);
+		int b_idx;
+
+		memset(msgs, 0, sizeof(struct mmsghdr) * batch);
+		for(b_idx=0; b_idx<batch; b_idx++){
+			iovs[b_idx].iov_base = packets[idx + b_idx]->data;
+			iovs[b_idx].iov_len = packets[idx + b_idx]->len;
+			msgs[b_idx].msg_hdr.msg_name = &packets[idx + b_idx]->addr;
+			msgs[b_idx].msg_hdr.msg_namelen = packets[idx + b_idx]->addr_len;
+			msgs[b_idx].msg_hdr.msg_iov = &iovs[b_idx];
+			msgs[b_idx].msg_hdr.msg_iovlen = 1;
+		}
+
+		int ret = sendmmsg(sock, msgs, batch, 0);
+		Psnet_io_syscalls.fetch_add(1, std::memory_order_relaxed);
+
+		// the packet the kernel stopped at is dropped
+		if(ret <= 0){
+			sent[idx++] = false;
+			continue;
+		}
+
+		for(b_idx=0; b_idx<ret; b_idx++){
+			sent[idx++] = true;
+		}
+		num_sent += ret;
+	}
+#else
+	for(idx=0; idx<count; idx++){
+		sent[idx] = sendto(sock, (char*)packets[idx]->data, packets[idx]->len, 0, (SOCKADDR*)&packets[idx]->addr, packets[idx]->addr_len) != SOCKET_ERROR;
+		Psnet_io_syscalls.fetch_add(1, std::memory_order_relaxed);
+
+		if(sent[idx]){
+			num_sent++;
+		}
+	}
+#endif
+
+	return num_sent;
+}
+
+/**
+ * Read the packets which are waiting on the socket, returns how many were read
+ */
+static int psnet_io_receive_packets(SOCKET sock, psnet_io_packet *packets, int count)
+{
+#ifdef PSNET_IO_BATCHES
+	struct mmsghdr msgs[PSNET_IO_BATCH_SIZE];
+	struct iovec iovs[PSNET_IO_BATCH_SIZE];
+	int idx, ret;
+
+	count = MIN(count, PSNET_IO_BATCH_SIZE);
+
+	memset(msgs, 0, sizeof(struct mmsghdr) * count);
+	for(idx=0; idx<count; idx++){
+		iovs[idx].iov_base = packets[idx].data;
+		iovs[idx].iov_len = MAX_TOP_LAYER_PACKET_SIZE;
+		msgs[idx].msg_hdr.msg_name = &packets[idx].addr;
+		msgs[idx].msg_hdr.msg_namelen = sizeof(SOCKADDR_IN);
+		msgs[idx].msg_hdr.msg_iov = &iovs[idx];
+		msgs[idx].msg_hdr.msg_iovlen = 1;
+	}
+
+	ret = recvmmsg(sock, msgs, count, MSG_DONTWAIT, NULL);
+	Psnet_io_syscalls.fetch_add(1, std::memory_order_relaxed);
+
+	if(ret <= 0){
+		return 0;
+	}
+
+	for(idx=0; idx<ret; idx++){
+		packets[idx].len = (int)msgs[idx].msg_len;
+		packets[idx].addr_len = (int)msgs[idx].msg_hdr.msg_namelen;
+	}
+
+	return ret;
+#else
+	socklen_t from_len = sizeof(SOCKADDR_IN);
+
+	packets[0].len = recvfrom(sock, (char*)packets[0].data, MAX_TOP_LAYER_PACKET_SIZE, 0, (SOCKADDR*)&packets[0].addr, &from_len);
+	packets[0].addr_len = from_len;
+	Psnet_io_syscalls.fetch_add(1, std::memory_order_relaxed);
+
+	return (packets[0].len == SOCKET_ERROR) ? 0 : 1;
+#endif
+}
+
+/**
+ * Reads the socket and sends the queued packets until psnet_io_stop() is called
+ */
+static void psnet_io_thread_main(SOCKET sock)
+{
+	// kept out of the stack, a batch of packets is quite big
+	SCP_vector<psnet_io_packet> received(PSNET_IO_BATCH_SIZE);
+	SCP_vector<psnet_io_packet> acks(PSNET_IO_BATCH_SIZE);
+	psnet_io_packet *to_send[PSNET_IO_BATCH_SIZE];
+	int ack_of[PSNET_IO_BATCH_SIZE];
+	bool sent[PSNET_IO_BATCH_SIZE];
+	psnet_io_packet *outgoing;
+	fd_set rfds;
+	timeval timeout;
+	int idx, count, num_acks, ret;
+
+	tracing::set_thread_name("Network IO");
+
+	while(Psnet_io_running.load(std::memory_order_acquire)){
+		// everything the game thread queued since the last time
+		count = 0;
+		while((outgoing = Psnet_io_outgoing->front(count)) != NULL){
+			to_send[count++] = outgoing;
+
+			if(count == PSNET_IO_BATCH_SIZE){
+				psnet_io_send_packets(sock, to_send, sent, count);
+				Psnet_io_outgoing->pop(count);
+				count = 0;
+			}
+		}
+		if(count > 0){
+			psnet_io_send_packets(sock, to_send, sent, count);
+			Psnet_io_outgoing->pop(count);
+		}
+
+		FD_ZERO(&rfds);
+		FD_SET(sock, &rfds);
+		timeout.tv_sec = 0;
+		timeout.tv_usec = PSNET_IO_WAIT_US;
+
+#ifdef _WIN32
+		ret = select(-1, &rfds, NULL, NULL, &timeout);
+#else
+		ret = select(sock + 1, &rfds, NULL, NULL, &timeout);
+#endif
+		Psnet_io_syscalls.fetch_add(1, std::memory_order_relaxed);
+
+		if(ret == SOCKET_ERROR){
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+			continue;
+		}
+
+		if(!FD_ISSET(sock, &rfds)){
+			continue;
+		}
+
+		count = psnet_io_receive_packets(sock, received.data(), PSNET_IO_BATCH_SIZE);
+
+		// acknowledge reliable data now instead of once the game thread gets to it, so the peer doesn't resend it
+		num_acks = 0;
+		for(idx=0; idx<count; idx++){
+			psnet_io_packet *packet = &received[idx];
+
+			packet->arrival_time = psnet_get_time();
+			packet->acked = 0;
+
+			if((packet->len <= 1) || (packet->data[0] != PSNET_TYPE_RELIABLE) || !Tcp_active){
+				continue;
+			}
+
+			reliable_header header;
+			int len = MIN(packet->len - 1, (int)sizeof(reliable_header));
+
+			memset(&header, 0, sizeof(header));
+			memcpy(&header, packet->data + 1, len);
+
+			if(psnet_io_should_ack(&packet->addr, &header, len)){
+				reliable_header ack_header;
+				psnet_io_packet *ack = &acks[num_acks];
+				int size = psnet_rel_build_ack(&ack_header, INTEL_SHORT(header.seq), INTEL_FLOAT(&header.send_time));
+
+				ack->data[0] = PSNET_TYPE_RELIABLE;
+				memcpy(&ack->data[1], &ack_header, size);
+				ack->len = size + 1;
+				ack->addr = packet->addr;
+				ack->addr_len = sizeof(SOCKADDR);
+
+				to_send[num_acks] = ack;
+				ack_of[num_acks++] = idx;
+			}
+		}
+
+		if(num_acks > 0){
+			psnet_io_send_packets(sock, to_send, sent, num_acks);
+
+			for(idx=0; idx<num_acks; idx++){
+				received[ack_of[idx]].acked = sent[idx] ? 1 : 0;
+			}
+		}
+
+		for(idx=0; idx<count; idx++){
+			if(received[idx].len <= 0){
+				continue;
+			}
+
+			// the game thread is far behind, wait for it since acknowledged data must not be dropped
+			while(!Psnet_io_received->push(received[idx]) && Psnet_io_running.load(std::memory_order_acquire)){
+				std::this_thread::sleep_for(std::chrono::milliseconds(1));
+			}
+		}
+	}
+}
+
+/**
+ * Start reading the socket on the IO thread
+ */
+void psnet_io_start()
+{
+	int idx;
+
+	psnet_io_stop();
+
+	if(Unreliable_socket == INVALID_SOCKET){
+		return;
+	}
+
+	if(Psnet_io_received == nullptr){
+		Psnet_io_received.reset(new spsc_queue<psnet_io_packet>(PSNET_IO_QUEUE_SIZE));
+		Psnet_io_outgoing.reset(new spsc_queue<psnet_io_packet>(PSNET_IO_QUEUE_SIZE));
+	}
+	Psnet_io_received->clear();
+	Psnet_io_outgoing->clear();
+
+	for(idx=0; idx<MAXRELIABLESOCKETS; idx++){
+		psnet_io_publish_socket(idx);
+	}
+
+	Psnet_io_socket = Unreliable_socket;
+	Psnet_io_running.store(true, std::memory_order_release);
+	Psnet_io_thread = std::thread(psnet_io_thread_main, Psnet_io_socket);
+
+	ml_string("Psnet IO thread started");
+}
+
+/**
+ * Stop the IO thread, the game thread reads the socket itself afterwards
+ */
+void psnet_io_stop()
+{
+	psnet_io_packet *outgoing;
+
+	if(!Psnet_io_running.load(std::memory_order_acquire)){
+		return;
+	}
+
+	Psnet_io_running.store(false, std::memory_order_release);
+	Psnet_io_thread.join();
+
+	// the game thread still gets what the IO thread read
+	psnet_io_receive();
+
+	while((outgoing = Psnet_io_outgoing->front()) != NULL){
+		sendto(Psnet_io_socket, (char*)outgoing->data, outgoing->len, 0, (SOCKADDR*)&outgoing->addr, outgoing->addr_len);
+		Psnet_io_outgoing->pop();
+	}
+
+	Psnet_io_socket = INVALID_SOCKET;
+
+	ml_string("Psnet IO thread stopped");
+}
+
 // -------------------------------------------------------------------------------------------------------
 // PSNET 2 FORWARD DEFINITIONS
 //
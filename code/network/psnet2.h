@@ -115,7 +115,8 @@ struct fd_set;
 struct timeval;
 
 // wrappers around select() and recvfrom() for lagging/losing data, and for sorting through different packet types
-int RECVFROM(uint s, char * buf, int len, int flags, sockaddr *from, int *fromlen, int psnet_type);
+// arrival_time is set to when the packet was read off the socket and acked to whether the IO thread acknowledged it
+int RECVFROM(uint s, char * buf, int len, int flags, sockaddr *from, int *fromlen, int psnet_type, float *arrival_time = NULL, int *acked = NULL);
 int SELECT(int nfds, fd_set *readfds, fd_set *writefds, fd_set*exceptfds, const timeval* timeout, int psnet_type);
 
 // wrappers around sendto to sorting through different packet types
@@ -28,6 +28,7 @@
 #include "render/3d.h"			// needed for View_position, which is used when playing 3d sound
 #include "ship/ship.h"
 #include "ship/shiphit.h"
+#include "tracing/Monitor.h"
 
 
 #define COLLIDE_DEBUG
@@ -51,6 +52,77 @@ DCF_BOOL( collide_friendly, Collide_friendly )
 static int Player_collide_sound, AI_collide_sound;
 static int Player_collide_shield_sound, AI_collide_shield_sound;
 
+#define SHIP_SHIP_CONTACT_TOLERANCE		0.05f	// how far the light ship may move relative to the heavy ship before it's tested again
+#define SHIP_SHIP_MAX_CONTACTS			256		// more contacts than this and the ones not used lately are dropped
+
+// The last model test of a pair of ships whose spheres overlap. Ships parked or flying in formation next to a big ship
+// sweep the same path through its model every frame, as long as that path and the rotating submodels stay the same
+// the test is going to miss again.
+typedef struct ship_ship_contact {
+	vec3d	p0, p1;				// the sweep of the light ship in the heavy ship's reference frame
+	float	radius;
+	int		flags;
+	float	submodel_angles;	// the sum of the angles of the rotating submodels which were tested
+	int		frame;				// the last frame in which the contact was used
+	bool	hit;
+} ship_ship_contact;
+
+static SCP_unordered_map<uint64_t, ship_ship_contact> Ship_ship_contacts;
+
+MONITOR(NumShipShipContactsSkipped)
+
+static uint64_t ship_ship_contact_key(object *heavy_obj, object *light_obj)
+{
+	return ((uint64_t)(uint)heavy_obj->signature << 32) | (uint)light_obj->signature;
+}
+
+static ship_ship_contact *ship_ship_find_contact(object *heavy_obj, object *light_obj)
+{
+	if ( Ship_ship_contacts.size() > SHIP_SHIP_MAX_CONTACTS ) {
+		for ( auto it = Ship_ship_contacts.begin(); it != Ship_ship_contacts.end(); ) {
+			if ( it->second.frame < Framecount - 1 ) {
+				it = Ship_ship_contacts.erase(it);
+			} else {
+				++it;
+			}
+		}
+	}
+
+	auto it = Ship_ship_contacts.find(ship_ship_contact_key(heavy_obj, light_obj));
+
+	return (it != Ship_ship_contacts.end()) ? &it->second : nullptr;
+}
+
+// adds up the current and last angles of the rotating submodels, if any of them moves or is blown off the sum changes
+static float ship_ship_submodel_angles(polymodel_instance *pmi, const SCP_vector<int> &submodel_vector)
+{
+	float sum = 0.0f;
+
+	for ( auto submodel_num : submodel_vector ) {
+		auto smi = &pmi->submodel[submodel_num];
+
+		if ( smi->blown_off ) {
+			sum += 1000.0f * (submodel_num + 1);
+		} else {
+			sum += smi->angs.p + smi->angs.b + smi->angs.h + smi->prev_angs.p + smi->prev_angs.b + smi->prev_angs.h;
+		}
+	}
+
+	return sum;
+}
+
+static bool ship_ship_contact_is_same(const ship_ship_contact *contact, const vec3d *p0, const vec3d *p1, float radius, int flags, float submodel_angles)
+{
+	return (contact->flags == flags) && (contact->radius == radius) && (contact->submodel_angles == submodel_angles)
+		&& (vm_vec_dist_squared(&contact->p0, p0) < SHIP_SHIP_CONTACT_TOLERANCE * SHIP_SHIP_CONTACT_TOLERANCE)
+		&& (vm_vec_dist_squared(&contact->p1, p1) < SHIP_SHIP_CONTACT_TOLERANCE * SHIP_SHIP_CONTACT_TOLERANCE);
+}
+
+void collide_ship_ship_reset_contacts()
+{
+	Ship_ship_contacts.clear();
+}
+
 /**
  * Return true if two ships are docking.
  */
@@ -239,7 +311,7 @@ int ship_ship_check_collision(collision_info_struct *ship_ship_hit_info, vec3d *
 	SCP_vector<int> submodel_vector;
 	int valid_hit_occured = 0;
 	polymodel *pm_light;
-	polymodel_instance *pmi;
+	polymodel_instance *pmi = model_get_instance(heavy_shipp->model_instance_num);
 		
 	pm_light = model_get(Ship_info[light_shipp->ship_info_index].model_num);
 
@@ -249,6 +321,23 @@ int ship_ship_check_collision(collision_info_struct *ship_ship_hit_info, vec3d *
 
 	if (model_collide(&mc)) {
 
+		if ( ship_ship_hit_info->collide_rotate ) {
+			model_get_rotating_submodel_list(&submodel_vector, heavy_obj);
+		}
+
+		// a sweep which missed last time misses again if nothing changed
+		float submodel_angles = ship_ship_submodel_angles(pmi, submodel_vector);
+		ship_ship_contact *contact = ship_ship_find_contact(heavy_obj, light_obj);
+
+		if ( contact != nullptr ) {
+			contact->frame = Framecount;
+
+			if ( !contact->hit && ship_ship_contact_is_same(contact, &copy_p0, &copy_p1, mc.radius, copy_flags, submodel_angles) ) {
+				MONITOR_INC(NumShipShipContactsSkipped, 1);
+				return 0;
+			}
+		}
+
 		// Set earliest hit time
 		ship_ship_hit_info->hit_time = FLT_MAX;
 
@@ -256,10 +345,6 @@ int ship_ship_check_collision(collision_info_struct *ship_ship_hit_info, vec3d *
 		if ( ship_ship_hit_info->collide_rotate ) {
 			SCP_vector<int>::iterator smv;
 
-			model_get_rotating_submodel_list(&submodel_vector, heavy_obj);
-
-			pmi = model_get_instance(heavy_shipp->model_instance_num);
-
 			// turn off all rotating submodels and test for collision
 			for (smv = submodel_vector.begin(); smv != submodel_vector.end(); ++smv) {
 				pmi->submodel[*smv].collision_checked = true;
@@ -348,6 +433,18 @@ int ship_ship_check_collision(collision_info_struct *ship_ship_hit_info, vec3d *
 				vm_vec_scale_add(&ship_ship_hit_info->light_collision_cm_pos, mc.p0, &diff, mc.hit_dist);
 			}
 		}
+
+		// only the sweep which was tested is kept so the light ship can't creep through the model in small steps
+		if ( contact == nullptr ) {
+			contact = &Ship_ship_contacts[ship_ship_contact_key(heavy_obj, light_obj)];
+		}
+		contact->p0 = copy_p0;
+		contact->p1 = copy_p1;
+		contact->radius = mc.radius;
+		contact->flags = copy_flags;
+		contact->submodel_angles = submodel_angles;
+		contact->frame = Framecount;
+		contact->hit = valid_hit_occured != 0;
 	}
 
 	if (valid_hit_occured) {
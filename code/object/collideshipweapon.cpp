@@ -9,9 +9,12 @@
 
 
 
+#include "globalincs/jobs.h"
+#include "graphics/decals.h"
 #include "hud/hudshield.h"
 #include "hud/hudwingmanstatus.h"
 #include "io/timer.h"
+#include "math/fvi.h"
 #include "network/multi.h"
 #include "network/multimsgs.h"
 #include "network/multiutil.h"
@@ -77,6 +80,11 @@ void ship_weapon_do_hit_stuff(object *pship_obj, object *weapon_obj, vec3d *worl
 	// Apply hit & damage & stuff to weapon
 	weapon_hit(weapon_obj, pship_obj,  world_hitpos, quadrant_num, &worldNormal);
 
+	// only the hull is marked, not the shield
+	if ( (quadrant_num < 0) && (wip->impact_decal.bitmap >= 0) && (vm_vec_mag_squared(&hit_dir) > 0.0f) ) {
+		decals_add(pship_obj, submodel_num, hitpos, &hit_dir, &wip->impact_decal);
+	}
+
 	if (wip->damage_time >= 0.0f && wp->lifeleft <= wip->damage_time) {
 		if (wip->atten_damage >= 0.0f) {
 			damage = (((wip->damage - wip->atten_damage) * (wp->lifeleft / wip->damage_time)) + wip->atten_damage);
@@ -123,47 +131,36 @@ void ship_weapon_do_hit_stuff(object *pship_obj, object *weapon_obj, vec3d *worl
 
 extern int Framecount;
 
-int ship_weapon_check_collision(object *ship_objp, object *weapon_objp, float time_limit = 0.0f, int *next_hit = NULL)
-{
-	mc_info mc, mc_shield, mc_hull;
-	ship	*shipp;
-	ship_info *sip;
-	weapon	*wp;
-	weapon_info	*wip;
-
-	Assert( ship_objp != NULL );
-	Assert( ship_objp->type == OBJ_SHIP );
-	Assert( ship_objp->instance >= 0 );
-
-	shipp = &Ships[ship_objp->instance];
-	sip = &Ship_info[shipp->ship_info_index];
-
-	Assert( weapon_objp != NULL );
-	Assert( weapon_objp->type == OBJ_WEAPON );
-	Assert( weapon_objp->instance >= 0 );
-
-	wp = &Weapons[weapon_objp->instance];
-	wip = &Weapon_info[wp->weapon_info_index];
+// Result of the read-only part of a ship-weapon collision check
+typedef struct ship_weapon_collision {
+	mc_info	mc_shield;
+	mc_info	mc_hull;
+	int		shield_collision;
+	int		hull_collision;
 
+	// the collision infos point to these so they need to live as long as the infos
+	vec3d	weapon_end_pos;
+	vec3d	shield_ignored_until;
+} ship_weapon_collision;
 
-	Assert( shipp->objnum == OBJ_INDEX(ship_objp));
+/**
+ * Read-only part of the ship-weapon collision check. This only queries the models and can therefore be done on any
+ * thread.
+ */
+static void ship_weapon_check_collision_geometry(object *ship_objp, object *weapon_objp, float time_limit, ship_weapon_collision *swc)
+{
+	ship	*shipp = &Ships[ship_objp->instance];
+	ship_info *sip = &Ship_info[shipp->ship_info_index];
+	weapon	*wp = &Weapons[weapon_objp->instance];
 
-	// Make ships that are warping in not get collision detection done
-	if ( shipp->is_arriving() ) return 0;
-	
-	//	Return information for AI to detect incoming fire.
-	//	Could perhaps be done elsewhere at lower cost --MK, 11/7/97
-	float	dist = vm_vec_dist_quick(&ship_objp->pos, &weapon_objp->pos);
-	if (dist < weapon_objp->phys_info.speed) {
-		update_danger_weapon(ship_objp, weapon_objp);
-	}
+	mc_info mc;
+	mc_info &mc_shield = swc->mc_shield;
+	mc_info &mc_hull = swc->mc_hull;
 
-	int	valid_hit_occurred = 0;				// If this is set, then hitpos is set
-	int	quadrant_num = -1;
 	polymodel *pm = model_get(sip->model_num);
 
 	//	total time is flFrametime + time_limit (time_limit used to predict collisions into the future)
-	vec3d weapon_end_pos;
+	vec3d &weapon_end_pos = swc->weapon_end_pos;
 	vm_vec_scale_add( &weapon_end_pos, &weapon_objp->pos, &weapon_objp->phys_info.vel, time_limit );
 
 
@@ -202,14 +199,18 @@ int ship_weapon_check_collision(object *ship_objp, object *weapon_objp, float ti
 	// Someone should make one.
 
 	// check both kinds of collisions
-	int shield_collision = 0;
-	int hull_collision = 0;
+	int &shield_collision = swc->shield_collision;
+	int &hull_collision = swc->hull_collision;
+
+	shield_collision = 0;
+	hull_collision = 0;
 
 	// check shields for impact
 	if (!(ship_objp->flags[Object::Object_Flags::No_shields])) {
 		if (sip->flags[Ship::Info_Flags::Auto_spread_shields]) {
 			// The weapon is not allowed to impact the shield before it reaches this point
-			vec3d shield_ignored_until = weapon_objp->last_pos;
+			vec3d &shield_ignored_until = swc->shield_ignored_until;
+			shield_ignored_until = weapon_objp->last_pos;
 
 			float weapon_flown_for = vm_vec_dist(&wp->start_pos, &weapon_objp->last_pos);
 			float min_weapon_span;
@@ -346,6 +347,35 @@ int ship_weapon_check_collision(object *ship_objp, object *weapon_objp, float ti
 		mc_hull.flags = MC_CHECK_MODEL;
 		hull_collision = model_collide(&mc_hull);
 	}
+}
+
+/**
+ * Applies the result of the collision geometry check. This must happen on the main thread.
+ */
+static int ship_weapon_apply_collision(object *ship_objp, object *weapon_objp, float time_limit, int *next_hit, ship_weapon_collision *swc)
+{
+	ship	*shipp = &Ships[ship_objp->instance];
+	ship_info *sip = &Ship_info[shipp->ship_info_index];
+	weapon	*wp = &Weapons[weapon_objp->instance];
+	weapon_info	*wip = &Weapon_info[wp->weapon_info_index];
+
+	//	Return information for AI to detect incoming fire.
+	//	Could perhaps be done elsewhere at lower cost --MK, 11/7/97
+	float	dist = vm_vec_dist_quick(&ship_objp->pos, &weapon_objp->pos);
+	if (dist < weapon_objp->phys_info.speed) {
+		update_danger_weapon(ship_objp, weapon_objp);
+	}
+
+	mc_info mc;
+	mc_info &mc_shield = swc->mc_shield;
+	mc_info &mc_hull = swc->mc_hull;
+	int shield_collision = swc->shield_collision;
+	int hull_collision = swc->hull_collision;
+
+	int	valid_hit_occurred = 0;				// If this is set, then hitpos is set
+	int	quadrant_num = -1;
+
+	mc_info_init(&mc);
 
 	if (shield_collision) {
 		// pick out the shield quadrant
@@ -464,14 +494,34 @@ int ship_weapon_check_collision(object *ship_objp, object *weapon_objp, float ti
 }
 
 
-/**
- * Checks ship-weapon collisions.  
- * @param pair obj_pair pointer to the two objects. pair->a is ship and pair->b is weapon.
- * @return 1 if all future collisions between these can be ignored
- */
-int collide_ship_weapon( obj_pair * pair )
+int ship_weapon_check_collision(object *ship_objp, object *weapon_objp, float time_limit = 0.0f, int *next_hit = NULL)
+{
+	Assert( ship_objp != NULL );
+	Assert( ship_objp->type == OBJ_SHIP );
+	Assert( ship_objp->instance >= 0 );
+
+	Assert( weapon_objp != NULL );
+	Assert( weapon_objp->type == OBJ_WEAPON );
+	Assert( weapon_objp->instance >= 0 );
+
+	Assert( Ships[ship_objp->instance].objnum == OBJ_INDEX(ship_objp));
+
+	// Make ships that are warping in not get collision detection done
+	if ( Ships[ship_objp->instance].is_arriving() ) return 0;
+
+	ship_weapon_collision swc;
+	ship_weapon_check_collision_geometry(ship_objp, weapon_objp, time_limit, &swc);
+
+	return ship_weapon_apply_collision(ship_objp, weapon_objp, time_limit, next_hit, &swc);
+}
+
+// What collide_ship_weapon() has to do with a pair
+#define SWC_STAGE_NONE			0	// this pair can't collide right now
+#define SWC_STAGE_BIG_SHIP		1	// the weapon is inside a big ship which needs the predictive check
+#define SWC_STAGE_CHECK			2	// do the normal collision check
+
+static int collide_ship_weapon_stage( obj_pair * pair )
 {
-	int		did_hit;
 	object *ship = pair->a;
 	object *weapon_obj = pair->b;
 	
@@ -483,11 +533,11 @@ int collide_ship_weapon( obj_pair * pair )
 	// Don't check collisions for player if past first warpout stage.
 	if ( Player->control_mode > PCM_WARPOUT_STAGE1)	{
 		if ( ship == Player_obj )
-			return 0;
+			return SWC_STAGE_NONE;
 	}
 
 	if (reject_due_collision_groups(ship, weapon_obj))
-		return 0;
+		return SWC_STAGE_NONE;
 
 	// Cull lasers within big ship spheres by casting a vector forward for (1) exit sphere or (2) lifetime of laser
 	// If it does hit, don't check the pair until about 200 ms before collision.  
@@ -500,10 +550,33 @@ int collide_ship_weapon( obj_pair * pair )
 		// Note: culling ships with auto spread shields seems to waste more performance than it saves,
 		// so we're not doing that here
 		if ( !(sip->flags[Ship::Info_Flags::Auto_spread_shields]) && vm_vec_dist_squared(&ship->pos, &weapon_obj->pos) < (1.2f*ship->radius*ship->radius) ) {
-			return check_inside_radius_for_big_ships( ship, weapon_obj, pair );
+			return SWC_STAGE_BIG_SHIP;
 		}
 	}
 
+	return SWC_STAGE_CHECK;
+}
+
+/**
+ * Checks ship-weapon collisions.  
+ * @param pair obj_pair pointer to the two objects. pair->a is ship and pair->b is weapon.
+ * @return 1 if all future collisions between these can be ignored
+ */
+int collide_ship_weapon( obj_pair * pair )
+{
+	int		did_hit;
+	object *ship = pair->a;
+	object *weapon_obj = pair->b;
+
+	switch (collide_ship_weapon_stage(pair)) {
+	case SWC_STAGE_NONE:
+		return 0;
+	case SWC_STAGE_BIG_SHIP:
+		return check_inside_radius_for_big_ships( ship, weapon_obj, pair );
+	default:
+		break;
+	}
+
 	did_hit = ship_weapon_check_collision( ship, weapon_obj );
 
 	if ( !did_hit )	{
@@ -515,6 +588,118 @@ int collide_ship_weapon( obj_pair * pair )
 	return 0;
 }
 
+/**
+ * Checks a number of ship-weapon pairs at once.
+ *
+ * The model queries of all pairs are done on the worker threads first, then the hits are applied in the order of the
+ * pairs on the calling thread so the outcome doesn't depend on how the work was split up.
+ *
+ * @param pairs The pairs to check, pair->a is the ship and pair->b is the weapon
+ * @param results Receives what collide_ship_weapon() would have returned for each pair
+ * @param count The number of pairs
+ */
+void collide_ship_weapon_batch( obj_pair *pairs, int *results, size_t count )
+{
+	static SCP_vector<int> stages;
+	static SCP_vector<ship_weapon_collision> collisions;
+	static fvi_segment_sphere_batch spheres;
+	static SCP_vector<size_t> sphere_pairs;
+	static SCP_vector<ubyte> sphere_hits;
+	static SCP_vector<size_t> geometry_pairs;
+
+	// this must not be resized while the collisions are in use since the collision infos point into it
+	stages.resize(count);
+	collisions.resize(count);
+
+	jobs::parallel_for(count, 8, [&](size_t begin, size_t end, size_t) {
+		for (size_t i = begin; i < end; ++i) {
+			results[i] = 0;
+			stages[i] = collide_ship_weapon_stage(&pairs[i]);
+
+			if (stages[i] != SWC_STAGE_CHECK) {
+				continue;
+			}
+
+			// Make ships that are warping in not get collision detection done
+			if (Ships[pairs[i].a->instance].is_arriving()) {
+				stages[i] = SWC_STAGE_NONE;
+				results[i] = -1;
+			}
+		}
+	}, tracing::ShipWeaponCollisionJob);
+
+	// Every model query starts by testing the weapon path against the bounding sphere of the model. Doing that for all
+	// pairs at once first means most pairs never need to set up the model queries at all.
+	spheres.clear();
+	sphere_pairs.clear();
+	geometry_pairs.clear();
+
+	for (size_t i = 0; i < count; ++i) {
+		if (stages[i] != SWC_STAGE_CHECK) {
+			continue;
+		}
+
+		object *ship = pairs[i].a;
+		object *weapon_obj = pairs[i].b;
+		ship_info *sip = &Ship_info[Ships[ship->instance].ship_info_index];
+
+		// the shield check of auto spread shields may start away from the weapon path so it can't use the same sphere
+		if (sip->flags[Ship::Info_Flags::Auto_spread_shields]) {
+			geometry_pairs.push_back(i);
+			continue;
+		}
+
+		spheres.add(&weapon_obj->last_pos, &weapon_obj->pos, &ship->pos, model_get(sip->model_num)->rad);
+		sphere_pairs.push_back(i);
+	}
+
+	fvi_segment_sphere_batch_test(&spheres, &sphere_hits);
+
+	for (size_t j = 0; j < sphere_pairs.size(); ++j) {
+		size_t i = sphere_pairs[j];
+
+		if (sphere_hits[j]) {
+			geometry_pairs.push_back(i);
+		} else {
+			collisions[i].shield_collision = 0;
+			collisions[i].hull_collision = 0;
+			collisions[i].weapon_end_pos = pairs[i].b->pos;
+		}
+	}
+
+	jobs::parallel_for(geometry_pairs.size(), 8, [&](size_t begin, size_t end, size_t) {
+		for (size_t j = begin; j < end; ++j) {
+			size_t i = geometry_pairs[j];
+
+			ship_weapon_check_collision_geometry(pairs[i].a, pairs[i].b, 0.0f, &collisions[i]);
+		}
+	}, tracing::ShipWeaponCollisionJob);
+
+	for (size_t i = 0; i < count; ++i) {
+		object *ship = pairs[i].a;
+		object *weapon_obj = pairs[i].b;
+		int did_hit;
+
+		switch (stages[i]) {
+		case SWC_STAGE_NONE:
+			// arriving ships don't get hit but may still be culled
+			if (results[i] == -1) {
+				results[i] = weapon_will_never_hit( weapon_obj, ship, &pairs[i] );
+			} else {
+				results[i] = 0;
+			}
+			break;
+		case SWC_STAGE_BIG_SHIP:
+			results[i] = check_inside_radius_for_big_ships( ship, weapon_obj, &pairs[i] );
+			break;
+		default:
+			did_hit = ship_weapon_apply_collision( ship, weapon_obj, 0.0f, NULL, &collisions[i] );
+			results[i] = did_hit ? 0 : weapon_will_never_hit( weapon_obj, ship, &pairs[i] );
+			break;
+		}
+	}
+}
+
 /**
  * Upper limit estimate ship speed at end of time
  */
@@ -9,6 +9,7 @@
 
 
 
+#include "debugconsole/console.h"
 #include "globalincs/linklist.h"
 #include "io/timer.h"
 #include "object/objcollide.h"
@@ -43,7 +44,52 @@ obj_pair *Obj_pairs = NULL;
 obj_pair pair_used_list;
 obj_pair pair_free_list;
 
+// The collider lists are kept sorted along each axis between frames so that the broadphase only has to repair the
+// ordering with an insertion sort instead of sorting from scratch every frame
 SCP_vector<int> Collision_sort_list;
+SCP_vector<int> Collision_sort_list_y;
+SCP_vector<int> Collision_sort_list_z;
+
+// scratch list for the last sweep, kept around so it doesn't have to be reallocated every frame
+static SCP_vector<int> Collision_overlap_list;
+
+// per frame cache of the collider extents, indexed by object number
+typedef struct collider_endpoints {
+	float min[3];
+	float max[3];
+} collider_endpoints;
+
+static collider_endpoints Collider_endpoints[MAX_OBJECTS];
+
+// marks the last sweep in which an object was found to overlap with another object
+static uint Collider_overlap_mark[MAX_OBJECTS];
+static uint Collider_overlap_sweep = 0;
+
+// number of colliders added since the lists were last sorted
+static size_t Collision_sort_list_num_added = 0;
+
+// number of pairs passed to the narrow phase by the last sweep
+static int Collision_sort_num_candidates = 0;
+
+int Collision_broadphase = COLLISION_BROADPHASE_SORT;
+
+bool Collision_parallel_narrowphase = false;
+
+// Colliders which cover more than this many cells along one axis are not inserted into the hash and are instead
+// checked against all other colliders
+#define COLLISION_HASH_MAX_CELL_SPAN	4
+
+// the cell size is this multiple of the average collider extent
+#define COLLISION_HASH_CELL_SCALE		2.0f
+#define COLLISION_HASH_MIN_CELL_SIZE	10.0f
+
+typedef struct collision_hash_entry {
+	std::uint64_t key;
+	int objnum;
+} collision_hash_entry;
+
+static SCP_vector<collision_hash_entry> Collision_hash_entries;
+static SCP_vector<int> Collision_hash_large;
 
 class collider_pair
 {
@@ -55,20 +101,214 @@ public:
 	int next_check_time;
 	bool initialized;
 
-	// we need to define a constructor because the hash map can
-	// implicitly insert an object when we use the [] operator
 	collider_pair()
 		: a(NULL), b(NULL), signature_a(-1), signature_b(-1), next_check_time(-1), initialized(false)
 	{}
+
+	// the pair refers to objects which have been deleted or it was explicitly dropped
+	bool stale() const
+	{
+		return !initialized || signature_a != a->signature || signature_b != b->signature;
+	}
+};
+
+#define COLLIDER_PAIR_EMPTY_KEY		0xffffffffu
+#define COLLIDER_PAIR_MIN_CAPACITY	1024
+
+/**
+ * The cached pairs of the new collision system. This is an open addressing hash table with linear probing which keeps
+ * the pairs in one array so looking up a pair never allocates.
+ *
+ * Pairs are never removed one by one. Stale pairs are dropped when the table has to grow instead, which also keeps the
+ * table from filling up with pairs of objects which are long gone.
+ *
+ * @warning Inserting may move all pairs so pointers into the table must not be kept across insertions.
+ */
+class collider_pair_cache
+{
+	SCP_vector<uint> _keys;
+	SCP_vector<collider_pair> _pairs;
+	size_t _count;
+	uint _shift;
+
+	size_t slot_of(uint key) const
+	{
+		// Fibonacci hashing, the keys are packed object numbers which would cluster badly otherwise
+		return (size_t)((key * 2654435769u) >> _shift);
+	}
+
+	void rebuild(size_t capacity)
+	{
+		SCP_vector<uint> old_keys;
+		SCP_vector<collider_pair> old_pairs;
+
+		old_keys.swap(_keys);
+		old_pairs.swap(_pairs);
+
+		_shift = 32;
+		for (size_t i = capacity; i > 1; i >>= 1) {
+			--_shift;
+		}
+
+		_keys.assign(capacity, COLLIDER_PAIR_EMPTY_KEY);
+		_pairs.assign(capacity, collider_pair());
+		_count = 0;
+
+		for (size_t i = 0; i < old_keys.size(); ++i) {
+			if (old_keys[i] == COLLIDER_PAIR_EMPTY_KEY) {
+				continue;
+			}
+
+			if (old_pairs[i].stale()) {
+				++num_evicted;
+				continue;
+			}
+
+			size_t slot = slot_of(old_keys[i]);
+			while (_keys[slot] != COLLIDER_PAIR_EMPTY_KEY) {
+				slot = (slot + 1) & (capacity - 1);
+			}
+
+			_keys[slot] = old_keys[i];
+			_pairs[slot] = old_pairs[i];
+			++_count;
+		}
+	}
+
+	void reserve_one()
+	{
+		if ((_count + 1) * 2 <= _keys.size()) {
+			return;
+		}
+
+		size_t live = 0;
+		for (size_t i = 0; i < _keys.size(); ++i) {
+			if (_keys[i] != COLLIDER_PAIR_EMPTY_KEY && !_pairs[i].stale()) {
+				++live;
+			}
+		}
+
+		// leave enough room that the next rebuild is a while away
+		size_t capacity = COLLIDER_PAIR_MIN_CAPACITY;
+		while (capacity < (live + 1) * 4) {
+			capacity *= 2;
+		}
+
+		rebuild(capacity);
+	}
+
+public:
+	int num_hits;
+	int num_misses;
+	int num_evicted;
+
+	collider_pair_cache() : _count(0), _shift(32), num_hits(0), num_misses(0), num_evicted(0)
+	{
+	}
+
+	/**
+	 * Gets the pair with the specified key
+	 * @return The pair or @c NULL if there is none
+	 */
+	collider_pair *find(uint key)
+	{
+		if (_keys.empty()) {
+			return NULL;
+		}
+
+		size_t mask = _keys.size() - 1;
+		for (size_t slot = slot_of(key); _keys[slot] != COLLIDER_PAIR_EMPTY_KEY; slot = (slot + 1) & mask) {
+			if (_keys[slot] == key) {
+				return &_pairs[slot];
+			}
+		}
+
+		return NULL;
+	}
+
+	/**
+	 * Gets the pair with the specified key, a default constructed pair is added if there is none yet
+	 */
+	collider_pair *find_or_insert(uint key)
+	{
+		Assert(key != COLLIDER_PAIR_EMPTY_KEY);
+
+		auto pair = find(key);
+		if (pair != NULL) {
+			return pair;
+		}
+
+		reserve_one();
+
+		size_t mask = _keys.size() - 1;
+		size_t slot = slot_of(key);
+		while (_keys[slot] != COLLIDER_PAIR_EMPTY_KEY) {
+			slot = (slot + 1) & mask;
+		}
+
+		_keys[slot] = key;
+		++_count;
+
+		return &_pairs[slot];
+	}
+
+	void clear()
+	{
+		_keys.clear();
+		_pairs.clear();
+		_count = 0;
+		_shift = 32;
+	}
+
+	size_t size() const
+	{
+		return _count;
+	}
+
+	template<typename F>
+	void for_each(F func)
+	{
+		for (size_t i = 0; i < _keys.size(); ++i) {
+			if (_keys[i] != COLLIDER_PAIR_EMPTY_KEY) {
+				func(&_pairs[i]);
+			}
+		}
+	}
 };
 
-SCP_unordered_map<uint, collider_pair> Collision_cached_pairs;
+static collider_pair_cache Collision_cached_pairs;
+
+// ship:weapon pairs found by the broadphase which are checked together once the broadphase is done
+// the cached pairs are referred to by their key since the broadphase may still grow the cache
+static SCP_vector<obj_pair> Collision_deferred_pairs;
+static SCP_vector<uint> Collision_deferred_keys;
+static SCP_vector<int> Collision_deferred_results;
 
 class checkobject;
 extern checkobject CheckObjects[MAX_OBJECTS];
 
 extern int Cmdline_old_collision_sys;
 
+DCF(collision_broadphase, "Switches the broadphase of the new collision system (sort or hash)")
+{
+	if (dc_optional_string_either("help", "--help")) {
+		dc_printf("Usage: collision_broadphase [sort|hash]\n");
+		dc_printf("\tsort  Sweep-and-prune on the sorted collider lists (default)\n");
+		dc_printf("\thash  Uniform spatial hash\n");
+		return;
+	}
+
+	if (dc_optional_string("sort")) {
+		Collision_broadphase = COLLISION_BROADPHASE_SORT;
+	} else if (dc_optional_string("hash")) {
+		Collision_broadphase = COLLISION_BROADPHASE_HASH;
+	}
+
+	dc_printf("Collision broadphase is %s\n", (Collision_broadphase == COLLISION_BROADPHASE_HASH) ? "hash" : "sort");
+}
+
+DCF_BOOL(parallel_collisions, Collision_parallel_narrowphase);
+
 void obj_pairs_close()
 {
 	if (Obj_pairs != NULL) {
@@ -109,6 +349,8 @@ void obj_reset_pairs()
 
 	Num_pairs = 0;
 
+	collide_ship_ship_reset_contacts();
+
 	if (Obj_pairs != NULL) {
 		vm_free(Obj_pairs);
 		Obj_pairs = NULL;
@@ -526,6 +768,13 @@ void obj_add_pair( object *A, object *B, int check_time, int add_to_end )
 MONITOR(NumPairs)
 MONITOR(NumPairsChecked)
 
+MONITOR(SortCandidatePairs)
+MONITOR(HashCandidatePairs)
+MONITOR(HashCellSize)
+MONITOR(HashOccupiedCells)
+MONITOR(HashMaxCellOccupancy)
+MONITOR(HashLargeColliders)
+
 //#define PAIR_STATS
 
 extern int Cmdline_dis_collisions;
@@ -1069,14 +1318,9 @@ int collide_remove_weapons( )
 			opp = opp->next;
 		}
 	} else {
-		SCP_unordered_map<uint, collider_pair>::iterator it;
-		collider_pair *pair_obj;
-
-		for ( it = Collision_cached_pairs.begin(); it != Collision_cached_pairs.end(); ++it ) {
-			pair_obj = &it->second;
-			
+		Collision_cached_pairs.for_each([](collider_pair *pair_obj) {
 			if ( !pair_obj->initialized ) {
-				continue;
+				return;
 			}
 
 			if ( pair_obj->a->type == OBJ_WEAPON && pair_obj->signature_a == pair_obj->a->signature ) {
@@ -1094,7 +1338,7 @@ int collide_remove_weapons( )
 					pair_obj->initialized = false;
 				}
 			}
-		}
+		});
 	}
 
 	// for each weapon which could be removed, delete the object
@@ -1179,25 +1423,32 @@ void obj_add_collider(int obj_index)
 	}
 
 	Collision_sort_list.push_back(obj_index);
+	Collision_sort_list_y.push_back(obj_index);
+	Collision_sort_list_z.push_back(obj_index);
+	Collision_sort_list_num_added++;
 
 	objp->flags.remove(Object::Object_Flags::Not_in_coll);
 }
 
+// removes the collider while keeping the order of the remaining entries intact
+static void obj_remove_collider_from_list(SCP_vector<int> *list, int obj_index)
+{
+	auto it = std::find(list->begin(), list->end(), obj_index);
+
+	if ( it != list->end() ) {
+		list->erase(it);
+	}
+}
+
 void obj_remove_collider(int obj_index)
 {
 #ifdef OBJECT_CHECK 
     CheckObjects[obj_index].flags.set(Object::Object_Flags::Not_in_coll);
 #endif	
 
-	size_t i;
-
-	for ( i = 0; i < Collision_sort_list.size(); ++i ) {
-		if ( Collision_sort_list[i] == obj_index ) {
-			Collision_sort_list[i] = Collision_sort_list.back();
-			Collision_sort_list.pop_back();
-			break;
-		}
-	}
+	obj_remove_collider_from_list(&Collision_sort_list, obj_index);
+	obj_remove_collider_from_list(&Collision_sort_list_y, obj_index);
+	obj_remove_collider_from_list(&Collision_sort_list_z, obj_index);
 
 	Objects[obj_index].flags.set(Object::Object_Flags::Not_in_coll);
 }
@@ -1205,16 +1456,75 @@ void obj_remove_collider(int obj_index)
 void obj_reset_colliders()
 {
 	Collision_sort_list.clear();
+	Collision_sort_list_y.clear();
+	Collision_sort_list_z.clear();
+	Collision_overlap_list.clear();
+	Collision_deferred_pairs.clear();
+	Collision_deferred_keys.clear();
 	Collision_cached_pairs.clear();
+
+	collide_ship_ship_reset_contacts();
+
+	Collision_sort_list_num_added = 0;
 }
 
-void obj_collide_retime_cached_pairs(int checkdly)
+// the longest delay the pairs are retimed with, this leaves room for the objects to speed up
+#define COLLISION_RETIME_MAX_DELAY	1000
+
+/**
+ * Gets the earliest time in ms at which the objects of a pair could touch if they would fly straight at each other
+ * with their current speeds.
+ */
+static int obj_collide_pair_retime_delay(const collider_pair *pair, int min_delay)
 {
-	SCP_unordered_map<uint, collider_pair>::iterator it;
+	object *A = pair->a;
+	object *B = pair->b;
 
-	for ( it = Collision_cached_pairs.begin(); it != Collision_cached_pairs.end(); ++it ) {
-		it->second.next_check_time = timestamp(checkdly);
+	// beams are checked every frame anyway
+	if ( A->type == OBJ_BEAM || B->type == OBJ_BEAM ) {
+		return min_delay;
 	}
+
+	float gap = vm_vec_dist(&A->pos, &B->pos) - A->radius - B->radius;
+	float closing_speed = vm_vec_mag(&A->phys_info.vel) + vm_vec_mag(&B->phys_info.vel);
+
+	if ( gap <= 0.0f ) {
+		return min_delay;
+	}
+
+	if ( closing_speed * COLLISION_RETIME_MAX_DELAY <= gap * 1000.0f ) {
+		return COLLISION_RETIME_MAX_DELAY;
+	}
+
+	return MAX(min_delay, fl2i(1000.0f * gap / closing_speed));
+}
+
+void obj_collide_retime_cached_pairs(int checkdly)
+{
+	Collision_cached_pairs.for_each([checkdly](collider_pair *pair) {
+		if ( pair->stale() ) {
+			return;
+		}
+
+		pair->next_check_time = timestamp(obj_collide_pair_retime_delay(pair, checkdly));
+	});
+}
+
+MONITOR(CachedPairs)
+MONITOR(CachedPairHits)
+MONITOR(CachedPairMisses)
+MONITOR(CachedPairEvictions)
+
+static void obj_collide_update_cache_monitors()
+{
+	MONITOR_SET(CachedPairs, (int)Collision_cached_pairs.size());
+	MONITOR_SET(CachedPairHits, Collision_cached_pairs.num_hits);
+	MONITOR_SET(CachedPairMisses, Collision_cached_pairs.num_misses);
+	MONITOR_SET(CachedPairEvictions, Collision_cached_pairs.num_evicted);
+
+	Collision_cached_pairs.num_hits = 0;
+	Collision_cached_pairs.num_misses = 0;
+	Collision_cached_pairs.num_evicted = 0;
 }
 
 void obj_sort_and_collide()
@@ -1225,29 +1535,331 @@ void obj_sort_and_collide()
 	if ( !(Game_detail_flags & DETAIL_FLAG_COLLISION) )
 		return;
 
-	SCP_vector<int> sort_list_y;
-	SCP_vector<int> sort_list_z;
+	obj_update_collider_endpoints();
+
+	// lots of new colliders (e.g. on mission start) would make the insertion sort degenerate, so fall back to a
+	// full sort in that case
+	bool full_sort = Collision_sort_list_num_added > (Collision_sort_list.size() / 4);
+	Collision_sort_list_num_added = 0;
 
-	sort_list_y.clear();
 	{
 		TRACE_SCOPE(tracing::SortColliders);
-		obj_quicksort_colliders(&Collision_sort_list, 0, (int)(Collision_sort_list.size() - 1), 0);
+		obj_sort_colliders(&Collision_sort_list, 0, full_sort);
+		obj_sort_colliders(&Collision_sort_list_y, 1, full_sort);
+		obj_sort_colliders(&Collision_sort_list_z, 2, full_sort);
 	}
-	obj_find_overlap_colliders(&sort_list_y, &Collision_sort_list, 0, false);
 
-	sort_list_z.clear();
-	{
-		TRACE_SCOPE(tracing::SortColliders);
-		obj_quicksort_colliders(&sort_list_y, 0, (int)(sort_list_y.size() - 1), 1);
+	// the x and y sweeps only mark the objects which overlap with something on that axis, the following sweep then
+	// skips everything that wasn't marked by the previous one
+	uint x_sweep = obj_sweep_colliders(&Collision_sort_list, 0, 0);
+	uint y_sweep = obj_sweep_colliders(&Collision_sort_list_y, 1, x_sweep);
+
+	// Collisions may create new objects so the last sweep works on a copy of the remaining colliders
+	Collision_overlap_list.clear();
+	for (auto objnum : Collision_sort_list_z) {
+		if ( Collider_overlap_mark[objnum] == y_sweep ) {
+			Collision_overlap_list.push_back(objnum);
+		}
+	}
+
+	Collision_sort_num_candidates = 0;
+	obj_find_overlap_colliders(NULL, &Collision_overlap_list, 2, true);
+	MONITOR_SET(SortCandidatePairs, Collision_sort_num_candidates);
+
+	obj_collide_deferred_pairs();
+	obj_collide_update_cache_monitors();
+}
+
+void obj_collide_deferred_pairs()
+{
+	if ( Collision_deferred_pairs.empty() ) {
+		return;
+	}
+
+	TRACE_SCOPE(tracing::CollideDeferredPairs);
+
+	Collision_deferred_results.resize(Collision_deferred_pairs.size());
+
+	collide_ship_weapon_batch(Collision_deferred_pairs.data(), Collision_deferred_results.data(), Collision_deferred_pairs.size());
+
+	for ( size_t i = 0; i < Collision_deferred_pairs.size(); ++i ) {
+		collider_pair *collision_info = Collision_cached_pairs.find(Collision_deferred_keys[i]);
+
+		if ( collision_info == NULL ) {
+			continue;
+		}
+
+		if ( Collision_deferred_results[i] ) {
+			// don't have to check ever again
+			collision_info->next_check_time = -1;
+		} else {
+			collision_info->next_check_time = Collision_deferred_pairs[i].next_check_time;
+		}
+	}
+
+	Collision_deferred_pairs.clear();
+	Collision_deferred_keys.clear();
+}
+
+static inline bool obj_collider_extents_overlap(const collider_endpoints *a, const collider_endpoints *b)
+{
+	for (int axis = 0; axis < 3; ++axis) {
+		if ( a->min[axis] > b->max[axis] || b->min[axis] > a->max[axis] ) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+static inline int obj_hash_cell_coord(float pos, float inv_cell_size)
+{
+	return (int)floorf(pos * inv_cell_size);
+}
+
+// packs the cell coordinates into one key, 21 bits per axis is plenty for any sensible world size
+static inline std::uint64_t obj_hash_cell_key(int x, int y, int z)
+{
+	const std::uint64_t mask = (1 << 21) - 1;
+
+	return (((std::uint64_t)x & mask) << 42) | (((std::uint64_t)y & mask) << 21) | ((std::uint64_t)z & mask);
+}
+
+static inline void obj_hash_collide_pair(int a, int b, int *num_candidates)
+{
+	// always pass in the same order so the pair cache finds the same entry every frame
+	if ( a > b ) {
+		std::swap(a, b);
 	}
-	obj_find_overlap_colliders(&sort_list_z, &sort_list_y, 1, false);
 
-	sort_list_y.clear();
+	++(*num_candidates);
+	obj_collide_pair(&Objects[a], &Objects[b]);
+}
+
+void obj_hash_and_collide()
+{
+	if (Cmdline_dis_collisions)
+		return;
+
+	if ( !(Game_detail_flags & DETAIL_FLAG_COLLISION) )
+		return;
+
+	obj_update_collider_endpoints();
+
+	Collision_hash_entries.clear();
+	Collision_hash_large.clear();
+
+	if ( Collision_sort_list.empty() ) {
+		return;
+	}
+
+	// size the cells from the colliders we actually have
+	float extent_sum = 0.0f;
+	for (auto objnum : Collision_sort_list) {
+		collider_endpoints *ends = &Collider_endpoints[objnum];
+
+		extent_sum += MAX(ends->max[0] - ends->min[0], MAX(ends->max[1] - ends->min[1], ends->max[2] - ends->min[2]));
+	}
+
+	float cell_size = MAX(COLLISION_HASH_CELL_SCALE * extent_sum / Collision_sort_list.size(), COLLISION_HASH_MIN_CELL_SIZE);
+	float inv_cell_size = 1.0f / cell_size;
+
+	int num_candidates = 0;
+
 	{
 		TRACE_SCOPE(tracing::SortColliders);
-		obj_quicksort_colliders(&sort_list_z, 0, (int)(sort_list_z.size() - 1), 2);
+
+		for (auto objnum : Collision_sort_list) {
+			collider_endpoints *ends = &Collider_endpoints[objnum];
+			int cell_min[3], cell_max[3];
+			bool large = false;
+
+			for (int axis = 0; axis < 3; ++axis) {
+				cell_min[axis] = obj_hash_cell_coord(ends->min[axis], inv_cell_size);
+				cell_max[axis] = obj_hash_cell_coord(ends->max[axis], inv_cell_size);
+
+				if ( cell_max[axis] - cell_min[axis] >= COLLISION_HASH_MAX_CELL_SPAN ) {
+					large = true;
+				}
+			}
+
+			if ( large ) {
+				Collision_hash_large.push_back(objnum);
+				continue;
+			}
+
+			for (int x = cell_min[0]; x <= cell_max[0]; ++x) {
+				for (int y = cell_min[1]; y <= cell_max[1]; ++y) {
+					for (int z = cell_min[2]; z <= cell_max[2]; ++z) {
+						collision_hash_entry entry;
+						entry.key = obj_hash_cell_key(x, y, z);
+						entry.objnum = objnum;
+
+						Collision_hash_entries.push_back(entry);
+					}
+				}
+			}
+		}
+
+		std::sort(Collision_hash_entries.begin(), Collision_hash_entries.end(),
+			[](const collision_hash_entry& a, const collision_hash_entry& b) { return a.key < b.key; });
+	}
+
+	TRACE_SCOPE(tracing::FindOverlapColliders);
+
+	int num_cells = 0;
+	size_t max_occupancy = 0;
+
+	// Collisions may create new objects so only the entries which exist now are processed
+	size_t num_entries = Collision_hash_entries.size();
+	size_t run_start = 0;
+
+	while ( run_start < num_entries ) {
+		std::uint64_t key = Collision_hash_entries[run_start].key;
+		size_t run_end = run_start + 1;
+
+		while ( run_end < num_entries && Collision_hash_entries[run_end].key == key ) {
+			++run_end;
+		}
+
+		++num_cells;
+		max_occupancy = MAX(max_occupancy, run_end - run_start);
+
+		for (size_t i = run_start; i < run_end; ++i) {
+			int a = Collision_hash_entries[i].objnum;
+			collider_endpoints *ends_a = &Collider_endpoints[a];
+
+			for (size_t j = i + 1; j < run_end; ++j) {
+				int b = Collision_hash_entries[j].objnum;
+				collider_endpoints *ends_b = &Collider_endpoints[b];
+
+				if ( !obj_collider_extents_overlap(ends_a, ends_b) ) {
+					continue;
+				}
+
+				// a pair may share several cells, only check it in the cell which contains the minimum corner of the
+				// overlapping region
+				std::uint64_t owner_key = obj_hash_cell_key(
+					obj_hash_cell_coord(MAX(ends_a->min[0], ends_b->min[0]), inv_cell_size),
+					obj_hash_cell_coord(MAX(ends_a->min[1], ends_b->min[1]), inv_cell_size),
+					obj_hash_cell_coord(MAX(ends_a->min[2], ends_b->min[2]), inv_cell_size));
+
+				if ( owner_key == key ) {
+					obj_hash_collide_pair(a, b, &num_candidates);
+				}
+			}
+		}
+
+		run_start = run_end;
+	}
+
+	// the large colliders are checked against everything else
+	size_t num_large = Collision_hash_large.size();
+	size_t num_colliders = Collision_sort_list.size();
+
+	for (size_t i = 0; i < num_large; ++i) {
+		int large_objnum = Collision_hash_large[i];
+		collider_endpoints *large_ends = &Collider_endpoints[large_objnum];
+
+		for (size_t j = 0; j < num_colliders; ++j) {
+			int objnum = Collision_sort_list[j];
+
+			if ( objnum == large_objnum ) {
+				continue;
+			}
+
+			// pairs of two large colliders are found from both sides, only check them once
+			if ( objnum < large_objnum && std::find(Collision_hash_large.begin(), Collision_hash_large.end(), objnum) != Collision_hash_large.end() ) {
+				continue;
+			}
+
+			if ( obj_collider_extents_overlap(large_ends, &Collider_endpoints[objnum]) ) {
+				obj_hash_collide_pair(large_objnum, objnum, &num_candidates);
+			}
+		}
 	}
-	obj_find_overlap_colliders(&sort_list_y, &sort_list_z, 2, true);
+
+	MONITOR_SET(HashCandidatePairs, num_candidates);
+	MONITOR_SET(HashCellSize, fl2i(cell_size));
+	MONITOR_SET(HashOccupiedCells, num_cells);
+	MONITOR_SET(HashMaxCellOccupancy, (int)max_occupancy);
+	MONITOR_SET(HashLargeColliders, (int)num_large);
+
+	obj_collide_deferred_pairs();
+	obj_collide_update_cache_monitors();
+}
+
+void obj_update_collider_endpoints()
+{
+	for (auto objnum : Collision_sort_list) {
+		collider_endpoints *ends = &Collider_endpoints[objnum];
+		int hot = Object_hot_index[objnum];
+
+		// beams don't use their position, and anything not in the hot store has to be read from the object
+		if ( hot < 0 || Objects[objnum].type == OBJ_BEAM ) {
+			for (int axis = 0; axis < 3; ++axis) {
+				ends->min[axis] = obj_get_collider_endpoint(objnum, axis, true);
+				ends->max[axis] = obj_get_collider_endpoint(objnum, axis, false);
+			}
+			continue;
+		}
+
+		const vec3d *pos = &Object_hot.pos[hot];
+		float radius = Object_hot.radius[hot];
+
+		if ( Objects[objnum].type == OBJ_WEAPON ) {
+			// weapons cover their whole path since the last frame
+			const vec3d *last_pos = &Object_hot.last_pos[hot];
+
+			for (int axis = 0; axis < 3; ++axis) {
+				ends->min[axis] = MIN(pos->a1d[axis], last_pos->a1d[axis]) - radius;
+				ends->max[axis] = MAX(pos->a1d[axis], last_pos->a1d[axis]) + radius;
+			}
+		} else {
+			for (int axis = 0; axis < 3; ++axis) {
+				ends->min[axis] = pos->a1d[axis] - radius;
+				ends->max[axis] = pos->a1d[axis] + radius;
+			}
+		}
+	}
+}
+
+uint obj_sweep_colliders(SCP_vector<int> *list, int axis, uint required_sweep)
+{
+	TRACE_SCOPE(tracing::FindOverlapColliders);
+
+	// 0 is never used as a sweep number so a fresh mark array doesn't look like it passed a previous sweep
+	if ( ++Collider_overlap_sweep == 0 ) {
+		memset(Collider_overlap_mark, 0, sizeof(Collider_overlap_mark));
+		Collider_overlap_sweep = 1;
+	}
+
+	uint sweep = Collider_overlap_sweep;
+
+	// the list is sorted by minimum endpoint so the object with the largest maximum endpoint seen so far is the
+	// only one we have to compare against to know if the current object overlaps with anything before it
+	int reach_obj = -1;
+	float reach_max = 0.0f;
+
+	for (auto objnum : *list) {
+		if ( required_sweep != 0 && Collider_overlap_mark[objnum] != required_sweep ) {
+			continue;
+		}
+
+		collider_endpoints *ends = &Collider_endpoints[objnum];
+
+		if ( reach_obj >= 0 && ends->min[axis] <= reach_max ) {
+			Collider_overlap_mark[objnum] = sweep;
+			Collider_overlap_mark[reach_obj] = sweep;
+		}
+
+		if ( reach_obj < 0 || ends->max[axis] > reach_max ) {
+			reach_obj = objnum;
+			reach_max = ends->max[axis];
+		}
+	}
+
+	return sweep;
 }
 
 void obj_find_overlap_colliders(SCP_vector<int> *overlap_list_out, SCP_vector<int> *list, int axis, bool collide)
@@ -1257,29 +1869,35 @@ void obj_find_overlap_colliders(SCP_vector<int> *overlap_list_out, SCP_vector<in
 	size_t i, j;
 	bool overlapped;
 	bool first_not_added = true;
-	SCP_vector<int> overlappers;
+	static SCP_vector<int> overlappers;
 
 	float min;
 	float overlap_max;
 	
 	overlappers.clear();
 
-	for ( i = 0; i < (*list).size(); ++i ) {
+	// only iterate over the entries which were in the list when we started, new objects are picked up next frame
+	size_t list_size = (*list).size();
+
+	for ( i = 0; i < list_size; ++i ) {
 		overlapped = false;
 
-		min = obj_get_collider_endpoint((*list)[i], axis, true);
+		min = Collider_endpoints[(*list)[i]].min[axis];
 
 		for ( j = 0; j < overlappers.size(); ) {
-			overlap_max = obj_get_collider_endpoint(overlappers[j], axis, false);
+			overlap_max = Collider_endpoints[overlappers[j]].max[axis];
 			if ( min <= overlap_max ) {
 				overlapped = true;
 
 				if ( overlappers.size() == 1 && first_not_added ) {
 					first_not_added = false;
-					overlap_list_out->push_back(overlappers[j]);
+					if ( overlap_list_out ) {
+						overlap_list_out->push_back(overlappers[j]);
+					}
 				}
 				
 				if ( collide ) {
+					++Collision_sort_num_candidates;
 					obj_collide_pair(&Objects[(*list)[i]], &Objects[overlappers[j]]);
 				}
 			} else {
@@ -1295,14 +1913,12 @@ void obj_find_overlap_colliders(SCP_vector<int> *overlap_list_out, SCP_vector<in
 			first_not_added = true;
 		}
 
-		if ( overlapped ) {
+		if ( overlapped && overlap_list_out ) {
 			overlap_list_out->push_back((*list)[i]);
 		}
 
 		overlappers.push_back((*list)[i]);
 	}
-
-	overlapped = true;
 }
 
 float obj_get_collider_endpoint(int obj_num, int axis, bool min)
@@ -1352,39 +1968,32 @@ float obj_get_collider_endpoint(int obj_num, int axis, bool min)
 	}
 }
 
-void obj_quicksort_colliders(SCP_vector<int> *list, int left, int right, int axis)
+void obj_sort_colliders(SCP_vector<int> *list, int axis, bool full_sort)
 {
 	Assert( axis >= 0 );
 	Assert( axis <= 2 );
 
-	if ( right > left ) {
-		int pivot_index = left + (right - left) / 2;
-
-		float pivot_value = obj_get_collider_endpoint((*list)[pivot_index], axis, true);
+	if ( full_sort ) {
+		std::sort(list->begin(), list->end(), [axis](int a, int b) {
+			return Collider_endpoints[a].min[axis] < Collider_endpoints[b].min[axis];
+		});
+		return;
+	}
 
-		// swap!
-		int temp = (*list)[pivot_index];
-		(*list)[pivot_index] = (*list)[right];
-		(*list)[right] = temp;
+	// objects only move a little between frames so the list is almost sorted already
+	int size = (int)list->size();
 
-		int store_index = left;
+	for ( int i = 1; i < size; ++i ) {
+		int objnum = (*list)[i];
+		float value = Collider_endpoints[objnum].min[axis];
 
-		int i;
-		for ( i = left; i < right; ++i ) {
-			if ( obj_get_collider_endpoint((*list)[i], axis, true) <= pivot_value ) {
-				temp = (*list)[i];
-				(*list)[i] = (*list)[store_index];
-				(*list)[store_index] = temp;
-				store_index++;
-			}
+		int j = i - 1;
+		while ( j >= 0 && Collider_endpoints[(*list)[j]].min[axis] > value ) {
+			(*list)[j + 1] = (*list)[j];
+			--j;
 		}
 
-		temp = (*list)[right];
-		(*list)[right] = (*list)[store_index];
-		(*list)[store_index] = temp;
-
-		obj_quicksort_colliders(list, left, store_index - 1, axis);
-		obj_quicksort_colliders(list, store_index + 1, right, axis);
+		(*list)[j + 1] = objnum;
 	}
 }
 
@@ -1559,14 +2168,16 @@ void obj_collide_pair(object *A, object *B)
 	bool valid = false;
 	uint key = (OBJ_INDEX(A) << 12) + OBJ_INDEX(B);
 
-	collision_info = &Collision_cached_pairs[key];
+	collision_info = Collision_cached_pairs.find_or_insert(key);
 
 	if ( collision_info->initialized ) {
 		// make sure we're referring to the correct objects in case the original pair was deleted
 		if ( collision_info->signature_a == collision_info->a->signature && 
 			collision_info->signature_b == collision_info->b->signature ) {
 			valid = true;
+			++Collision_cached_pairs.num_hits;
 		} else {
+			++Collision_cached_pairs.num_misses;
 			collision_info->a = A;
 			collision_info->b = B;
 			collision_info->signature_a = A->signature;
@@ -1574,6 +2185,7 @@ void obj_collide_pair(object *A, object *B)
 			collision_info->next_check_time = timestamp(0);
 		}
 	} else {
+		++Collision_cached_pairs.num_misses;
 		collision_info->a = A;
 		collision_info->b = B;
 		collision_info->signature_a = A->signature;
@@ -1665,6 +2277,13 @@ void obj_collide_pair(object *A, object *B)
 	new_pair.check_collision = check_collision;
 	new_pair.next_check_time = collision_info->next_check_time;
 
+	// the collision checks of these pairs get done together once the broadphase is done
+	if ( Collision_parallel_narrowphase && check_collision == collide_ship_weapon ) {
+		Collision_deferred_pairs.push_back(new_pair);
+		Collision_deferred_keys.push_back(key);
+		return;
+	}
+
 	if ( check_collision(&new_pair) ) {
 		// don't have to check ever again
 		collision_info->next_check_time = -1;
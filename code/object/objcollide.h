@@ -68,6 +68,15 @@ typedef struct obj_pair	{
 
 extern int collision_type;
 
+// broadphase used by the new collision system
+#define COLLISION_BROADPHASE_SORT	0	// sweep-and-prune on the sorted collider lists
+#define COLLISION_BROADPHASE_HASH	1	// uniform spatial hash sized from the collider extents
+
+extern int Collision_broadphase;
+
+// if set, the narrow phase of ship:weapon pairs is run on all worker threads
+extern bool Collision_parallel_narrowphase;
+
 #define SUBMODEL_NO_ROT_HIT	0
 #define SUBMODEL_ROT_HIT		1
 void set_hit_struct_info(collision_info_struct *hit, mc_info *mc, int submodel_rot_hit);
@@ -82,8 +91,12 @@ void obj_reset_colliders();
 
 void obj_check_all_collisions();
 void obj_sort_and_collide();
-void obj_quicksort_colliders(SCP_vector<int> *list, int left, int right, int axis);
+void obj_update_collider_endpoints();
+void obj_sort_colliders(SCP_vector<int> *list, int axis, bool full_sort);
+uint obj_sweep_colliders(SCP_vector<int> *list, int axis, uint required_sweep);
 void obj_find_overlap_colliders(SCP_vector<int> *overlap_list_out, SCP_vector<int> *list, int axis, bool collide);
+void obj_hash_and_collide();
+void obj_collide_deferred_pairs();
 float obj_get_collider_endpoint(int obj_num, int axis, bool min);
 void obj_collide_pair(object *A, object *B);
 
@@ -117,6 +130,7 @@ int collide_weapon_weapon( obj_pair * pair );
 // Returns 1 if all future collisions between these can be ignored
 // CODE is locatated in CollideShipWeapon.cpp
 int collide_ship_weapon( obj_pair * pair );
+void collide_ship_weapon_batch( obj_pair *pairs, int *results, size_t count );
 void ship_weapon_do_hit_stuff(object *pship_obj, object *weapon_obj, vec3d *world_hitpos, vec3d *hitpos, int quadrant_num, int submodel_num = -1);
 
 // Checks debris-weapon collisions.  pair->a is debris and pair->b is weapon.
@@ -150,6 +164,9 @@ int collide_remove_weapons(void);
 void collide_ship_ship_do_sound(vec3d *world_hit_pos, object *A, object *B, int player_involved);
 void collide_ship_ship_sounds_init();
 
+// forgets the last model tests of the ship:ship pairs
+void collide_ship_ship_reset_contacts();
+
 int get_ship_quadrant_from_global(vec3d *global_pos, object *objp);
 
 int reject_due_collision_groups(object *A, object *B);
@@ -16,6 +16,7 @@
 #include "debugconsole/console.h"
 #include "fireball/fireballs.h"
 #include "freespace.h"
+#include "globalincs/jobs.h"
 #include "globalincs/linklist.h"
 #include "iff_defs/iff_defs.h"
 #include "io/timer.h"
@@ -30,6 +31,7 @@
 #include "object/objectdock.h"
 #include "object/objectshield.h"
 #include "object/objectsnd.h"
+#include "object/objtimer.h"
 #include "observer/observer.h"
 #include "scripting/scripting.h"
 #include "playerman/player.h"
@@ -40,6 +42,7 @@
 #include "ship/ship.h"
 #include "tracing/tracing.h"
 #include "weapon/beam.h"
+#include "weapon/projectile.h"
 #include "weapon/shockwave.h"
 #include "weapon/swarm.h"
 #include "weapon/weapon.h"
@@ -71,6 +74,13 @@ int Num_objects=-1;
 int Highest_object_index=-1;
 int Highest_ever_object_index=0;
 int Object_next_signature = 1;	//0 is bogus, start at 1
+
+// maps the signatures of all allocated objects to their object number so obj_get_by_signature() doesn't have to walk
+// the used list
+static SCP_unordered_map<int, int> Object_signature_index;
+
+object_hot_store Object_hot;
+int Object_hot_index[MAX_OBJECTS];
 int Object_inited = 0;
 int Show_waypoints = 0;
 
@@ -153,6 +163,163 @@ void object::clear()
 	dock_free_dead_dock_list(this);
 }
 
+// the objects on obj_used_list by type, see obj_get_type_list()
+static SCP_vector<int> Object_type_lists[MAX_OBJECT_TYPES];
+static SCP_vector<int> Object_homing_weapons;
+static int Object_type_list_index[MAX_OBJECTS];	// position of each object in its type list, -1 if it isn't in there
+static int Object_homing_weapon_index[MAX_OBJECTS];
+
+static void obj_type_lists_reset()
+{
+	for (auto& list : Object_type_lists) {
+		list.clear();
+	}
+	Object_homing_weapons.clear();
+
+	for (int i = 0; i < MAX_OBJECTS; ++i) {
+		Object_type_list_index[i] = -1;
+		Object_homing_weapon_index[i] = -1;
+	}
+}
+
+static void obj_dense_list_add(SCP_vector<int>& list, int* list_index, int objnum)
+{
+	Assert(list_index[objnum] < 0);
+
+	list_index[objnum] = (int)list.size();
+	list.push_back(objnum);
+}
+
+static void obj_dense_list_remove(SCP_vector<int>& list, int* list_index, int objnum)
+{
+	int index = list_index[objnum];
+
+	if (index < 0) {
+		return;
+	}
+
+	// move the last entry into the freed spot
+	int last = list.back();
+	list[index] = last;
+	list_index[last] = index;
+	list.pop_back();
+
+	list_index[objnum] = -1;
+}
+
+static void obj_type_list_add(int objnum)
+{
+	object *objp = &Objects[objnum];
+
+	Assert((objp->type > OBJ_NONE) && (objp->type < MAX_OBJECT_TYPES));
+	obj_dense_list_add(Object_type_lists[objp->type], Object_type_list_index, objnum);
+
+	if ((objp->type == OBJ_WEAPON) && Weapon_info[Weapons[objp->instance].weapon_info_index].is_homing()) {
+		obj_dense_list_add(Object_homing_weapons, Object_homing_weapon_index, objnum);
+	}
+}
+
+static void obj_type_list_remove(int objnum)
+{
+	if (Object_type_list_index[objnum] < 0) {
+		return;
+	}
+
+	obj_dense_list_remove(Object_type_lists[Objects[objnum].type], Object_type_list_index, objnum);
+	obj_dense_list_remove(Object_homing_weapons, Object_homing_weapon_index, objnum);
+}
+
+const SCP_vector<int>& obj_get_type_list(int type)
+{
+	Assert((type >= 0) && (type < MAX_OBJECT_TYPES));
+	return Object_type_lists[type];
+}
+
+const SCP_vector<int>& obj_get_homing_weapons()
+{
+	return Object_homing_weapons;
+}
+
+static void obj_hot_reset()
+{
+	Object_hot.objnum.clear();
+	Object_hot.pos.clear();
+	Object_hot.last_pos.clear();
+	Object_hot.orient.clear();
+	Object_hot.radius.clear();
+	Object_hot.vel.clear();
+
+	for (int i = 0; i < MAX_OBJECTS; ++i) {
+		Object_hot_index[i] = -1;
+	}
+}
+
+static void obj_hot_add(int objnum)
+{
+	Assert(Object_hot_index[objnum] < 0);
+
+	object *objp = &Objects[objnum];
+
+	Object_hot_index[objnum] = (int)Object_hot.objnum.size();
+	Object_hot.objnum.push_back(objnum);
+	Object_hot.pos.push_back(objp->pos);
+	Object_hot.last_pos.push_back(objp->last_pos);
+	Object_hot.orient.push_back(objp->orient);
+	Object_hot.radius.push_back(objp->radius);
+	Object_hot.vel.push_back(objp->phys_info.vel);
+}
+
+static void obj_hot_remove(int objnum)
+{
+	int index = Object_hot_index[objnum];
+
+	if (index < 0) {
+		return;
+	}
+
+	// move the last entry into the freed spot
+	size_t last = Object_hot.objnum.size() - 1;
+	if ((size_t)index != last) {
+		Object_hot.objnum[index] = Object_hot.objnum[last];
+		Object_hot.pos[index] = Object_hot.pos[last];
+		Object_hot.last_pos[index] = Object_hot.last_pos[last];
+		Object_hot.orient[index] = Object_hot.orient[last];
+		Object_hot.radius[index] = Object_hot.radius[last];
+		Object_hot.vel[index] = Object_hot.vel[last];
+
+		Object_hot_index[Object_hot.objnum[index]] = index;
+	}
+
+	Object_hot.objnum.pop_back();
+	Object_hot.pos.pop_back();
+	Object_hot.last_pos.pop_back();
+	Object_hot.orient.pop_back();
+	Object_hot.radius.pop_back();
+	Object_hot.vel.pop_back();
+
+	Object_hot_index[objnum] = -1;
+}
+
+/**
+ * Copy the current values of the hot object fields into Object_hot
+ */
+void obj_hot_sync()
+{
+	TRACE_SCOPE(tracing::SyncHotObjects);
+
+	size_t count = Object_hot.objnum.size();
+
+	for (size_t i = 0; i < count; ++i) {
+		object *objp = &Objects[Object_hot.objnum[i]];
+
+		Object_hot.pos[i] = objp->pos;
+		Object_hot.last_pos[i] = objp->last_pos;
+		Object_hot.orient[i] = objp->orient;
+		Object_hot.radius[i] = objp->radius;
+		Object_hot.vel[i] = objp->phys_info.vel;
+	}
+}
+
 /**
  * Scan the object list, freeing down to num_used objects
  *
@@ -345,6 +512,12 @@ void obj_init()
 	}
 
 	Object_next_signature = 1;	//0 is invalid, others start at 1
+	obj_reset_sim_transforms();
+	obj_timer_reset();
+	Object_signature_index.clear();
+	Object_signature_index.reserve(MAX_OBJECTS);
+	obj_hot_reset();
+	obj_type_lists_reset();
 	Num_objects = 0;
 	Highest_object_index = 0;
 
@@ -485,6 +658,7 @@ int obj_create(ubyte type,int parent_obj,int instance, matrix * orient,
 
 	Assert(Object_next_signature > 0);	// 0 is bogus!
 	obj->signature = Object_next_signature++;
+	Object_signature_index[obj->signature] = objnum;
 
 	obj->type 					= type;
 	obj->instance				= instance;
@@ -512,6 +686,8 @@ int obj_create(ubyte type,int parent_obj,int instance, matrix * orient,
 
 	obj->n_quadrants = DEFAULT_SHIELD_SECTIONS; // Might be changed by the ship creation code
 	obj->shield_quadrant.resize(obj->n_quadrants);
+
+	obj_hot_add(objnum);
 	return objnum;
 }
 
@@ -545,7 +721,12 @@ void obj_delete(int objnum)
 		break;
 	case OBJ_SHIP:
 		if ((objp == Player_obj) && !Fred_running) {
+			bool in_type_list = (Object_type_list_index[objnum] >= 0);
+			obj_type_list_remove(objnum);
 			objp->type = OBJ_GHOST;
+			if (in_type_list) {
+				obj_type_list_add(objnum);
+			}
             objp->flags.remove(Object::Object_Flags::Should_be_dead);
 			
 			// we have to traverse the ship_obj list and remove this guy from it as well
@@ -615,9 +796,14 @@ void obj_delete(int objnum)
 	// if a persistant sound has been created, delete it
 	obj_snd_delete_type(OBJ_INDEX(objp));		
 
+	obj_type_list_remove(objnum);
+
 	objp->type = OBJ_NONE;		//unused!
+	Object_signature_index.erase(objp->signature);
 	objp->signature = 0;
 
+	obj_hot_remove(objnum);
+
 	obj_free(objnum);
 }
 
@@ -668,6 +854,7 @@ void obj_merge_created_list(void)
 
 		// Then add it to the object used list
 		list_append( &obj_used_list, objp );
+		obj_type_list_add(OBJ_INDEX(objp));
 
 		objp = GET_FIRST(&obj_create_list);
 	}
@@ -780,12 +967,13 @@ void obj_player_fire_stuff( object *objp, control_info ci )
 	
 }
 
-void obj_move_call_physics(object *objp, float frametime)
+/**
+ * @brief Sets up the physics state of an object for this frame
+ *
+ * @return @c true if physics_sim() has to be called for this object
+ */
+static bool obj_move_physics_prepare(object *objp, float frametime)
 {
-	TRACE_SCOPE(tracing::Physics);
-
-	int has_fired = -1;	//stop fireing stuff-Bobboau
-
 	//	Do physics for objects with OF_PHYSICS flag set and with some engine strength remaining.
 	if ( objp->flags[Object::Object_Flags::Physics] ) {
 		// only set phys info if ship is not dead
@@ -856,9 +1044,7 @@ void obj_move_call_physics(object *objp, float frametime)
 		}
 
 		if (physics_paused)	{
-			if (objp==Player_obj){
-				physics_sim(&objp->pos, &objp->orient, &objp->phys_info, frametime );		// simulate the physics
-			}
+			return objp == Player_obj;
 		} else {
 			//	Hack for dock mode.
 			//	If docking with a ship, we don't obey the normal ship physics, we can slew about.
@@ -889,30 +1075,41 @@ void obj_move_call_physics(object *objp, float frametime)
 			// then reset the flag and don't move the object.
             if (MULTIPLAYER_MASTER && (objp->flags[Object::Object_Flags::Just_updated])) {
 				objp->flags.remove(Object::Object_Flags::Just_updated);
-				goto obj_maybe_fire;
+				return false;
 			}
 
-				physics_sim(&objp->pos, &objp->orient, &objp->phys_info, frametime );		// simulate the physics
-
-			// if the object is the player object, do things that need to be done after the ship
-			// is moved (like firing weapons, etc).  This routine will get called either single
-			// or multiplayer.  We must find the player object to get to the control info field
-obj_maybe_fire:
-			if ( (objp->flags[Object::Object_Flags::Player_ship]) && (objp->type != OBJ_OBSERVER) && (objp == Player_obj)) {
-				player *pp;
-				if(Player != NULL){
-					pp = Player;
-					obj_player_fire_stuff( objp, pp->ci );				
-				}
-			}
+			return true;
+		}
+	}
+
+	return false;
+}
+
+/**
+ * @brief Does everything which has to happen after an object has been moved by physics_sim()
+ */
+static void obj_move_physics_finish(object *objp)
+{
+	int has_fired = -1;	//stop fireing stuff-Bobboau
 
-			// fire streaming weapons for ships in here - ALL PLAYERS, regardless of client, single player, server, whatever.
-			// do stream weapon firing for all ships themselves. 
-			if(objp->type == OBJ_SHIP){
-				ship_fire_primary(objp, 1, 0);
-					has_fired = 1;
+	if ( objp->flags[Object::Object_Flags::Physics] && !physics_paused ) {
+		// if the object is the player object, do things that need to be done after the ship
+		// is moved (like firing weapons, etc).  This routine will get called either single
+		// or multiplayer.  We must find the player object to get to the control info field
+		if ( (objp->flags[Object::Object_Flags::Player_ship]) && (objp->type != OBJ_OBSERVER) && (objp == Player_obj)) {
+			player *pp;
+			if(Player != NULL){
+				pp = Player;
+				obj_player_fire_stuff( objp, pp->ci );				
 			}
 		}
+
+		// fire streaming weapons for ships in here - ALL PLAYERS, regardless of client, single player, server, whatever.
+		// do stream weapon firing for all ships themselves. 
+		if(objp->type == OBJ_SHIP){
+			ship_fire_primary(objp, 1, 0);
+				has_fired = 1;
+		}
 	}
 	
 	if(has_fired == -1){
@@ -942,6 +1139,29 @@ obj_maybe_fire:
 	}
 }
 
+/**
+ * @brief Checks if physics_sim_drift() can be used for an object, only debris and asteroids are checked for it
+ */
+static bool obj_move_can_drift(object *objp)
+{
+	return (objp->type == OBJ_DEBRIS || objp->type == OBJ_ASTEROID) && physics_can_sim_drift(&objp->phys_info);
+}
+
+void obj_move_call_physics(object *objp, float frametime)
+{
+	TRACE_SCOPE(tracing::Physics);
+
+	if ( obj_move_physics_prepare(objp, frametime) ) {
+		if ( obj_move_can_drift(objp) ) {
+			physics_sim_drift(&objp->pos, &objp->orient, &objp->phys_info, frametime);
+		} else {
+			physics_sim(&objp->pos, &objp->orient, &objp->phys_info, frametime );		// simulate the physics
+		}
+	}
+
+	obj_move_physics_finish(objp);
+}
+
 
 #define IMPORTANT_FLAGS (OF_COLLIDES)
 
@@ -1168,7 +1388,7 @@ void obj_clear_weapon_group_id_list()
 
 int Arc_light = 1;		// If set, electrical arcs on debris cast light
 DCF_BOOL(arc_light, Arc_light)	
-extern fireball Fireballs[];
+extern SCP_vector<fireball> Fireballs;
 
 void obj_move_all_post(object *objp, float frametime)
 {
@@ -1391,30 +1611,56 @@ int Collisions_enabled = 1;
 
 DCF_BOOL( collisions, Collisions_enabled )
 
+bool Physics_parallel_integration = false;
+
+DCF_BOOL( parallel_physics, Physics_parallel_integration )
+
 MONITOR( NumObjects )
 
-/**
- * Move all objects for the current frame
- */
-void obj_move_all(float frametime)
+// Equipment script processing
+static void obj_run_equipment_scripts(object *objp)
 {
-	TRACE_SCOPE(tracing::MoveObjects);
+	if (objp->type == OBJ_SHIP) {
+		ship* shipp = &Ships[objp->instance];
+		object* target;
 
-	object *objp;	
+		if (Ai_info[shipp->ai_index].target_objnum != -1)
+			target = &Objects[Ai_info[shipp->ai_index].target_objnum];
+		else
+			target = NULL;
+		if (objp == Player_obj && Player_ai->target_objnum != -1)
+			target = &Objects[Player_ai->target_objnum];
 
-	// Goober5000 - HACK HACK HACK
-	// this function also resets the OF_DOCKED_ALREADY_HANDLED flag, to save trips
-	// through the used object list
-	obj_delete_all_that_should_be_dead();
+		Script_system.SetHookObjects(2, "User", objp, "Target", target);
+		Script_system.RunCondition(CHA_ONWPEQUIPPED, 0, NULL, objp);
+	}
+	Script_system.RemHookVars(2, "User", "Target");
+}
 
-	obj_merge_created_list();
+typedef struct obj_move_entry {
+	int objnum;
+	bool physics;		// obj_move_physics_finish() has to be called for this object
+} obj_move_entry;
 
-	// Clear the table that tells which groups of weapons have cast light so far.
-	if(!(Game_mode & GM_MULTIPLAYER) || (MULTIPLAYER_MASTER)) {
-		obj_clear_weapon_group_id_list();
-	}
+static SCP_vector<obj_move_entry> Obj_move_entries;
+static SCP_vector<int> Obj_integrate_list;
+static SCP_vector<int> Obj_drift_list;
 
-	MONITOR_INC( NumObjects, Num_objects );	
+/**
+ * Version of the obj_move_all() loop which integrates the physics of all objects at once
+ *
+ * All objects are pre-moved first, then physics_sim() runs for all of them on the worker pool and then the post-move
+ * code runs for every object. physics_sim() only touches the state of the object it is called for, docked objects are
+ * aligned to each other afterwards by dock_move_docked_objects() so they don't need any special treatment here.
+ * Debris and asteroids which only drift are integrated in a batch of their own with physics_sim_drift().
+ */
+static void obj_move_all_parallel(float frametime)
+{
+	object *objp;
+
+	Obj_move_entries.clear();
+	Obj_integrate_list.clear();
+	Obj_drift_list.clear();
 
 	for (objp = GET_FIRST(&obj_used_list); objp != END_OF_LIST(&obj_used_list); objp = GET_NEXT(objp)) {
 		// skip objects which should be dead
@@ -1433,43 +1679,144 @@ void obj_move_all(float frametime)
 			obj_check_object( objp );
 #endif
 
-		// pre-move
 		obj_move_all_pre(objp, frametime);
 
-		// store last pos and orient
 		objp->last_pos = cur_pos;
 		objp->last_orient = objp->orient;
 
+		obj_move_entry entry;
+		entry.objnum = OBJ_INDEX(objp);
+		entry.physics = false;
+
 		// Goober5000 - skip objects which don't move, but only until they're destroyed
 		if (!(objp->flags[Object::Object_Flags::Immobile] && objp->hull_strength > 0.0f)) {
-			// if this is an object which should be interpolated in multiplayer, do so
 			if (multi_oo_is_interp_object(objp)) {
 				multi_oo_interp(objp);
 			} else {
-				// physics
-				obj_move_call_physics(objp, frametime);
+				entry.physics = true;
+
+				if (obj_move_physics_prepare(objp, frametime)) {
+					if (obj_move_can_drift(objp)) {
+						Obj_drift_list.push_back(entry.objnum);
+					} else {
+						Obj_integrate_list.push_back(entry.objnum);
+					}
+				}
 			}
 		}
 
-		// move post
+		Obj_move_entries.push_back(entry);
+	}
+
+	{
+		TRACE_SCOPE(tracing::Physics);
+
+		jobs::parallel_for(Obj_integrate_list.size(), 32, [frametime](size_t begin, size_t end, size_t) {
+			for (size_t i = begin; i < end; ++i) {
+				object *integrate_objp = &Objects[Obj_integrate_list[i]];
+
+				physics_sim(&integrate_objp->pos, &integrate_objp->orient, &integrate_objp->phys_info, frametime);
+			}
+		}, tracing::PhysicsJob);
+
+		jobs::parallel_for(Obj_drift_list.size(), 128, [frametime](size_t begin, size_t end, size_t) {
+			for (size_t i = begin; i < end; ++i) {
+				object *drift_objp = &Objects[Obj_drift_list[i]];
+
+				physics_sim_drift(&drift_objp->pos, &drift_objp->orient, &drift_objp->phys_info, frametime);
+			}
+		}, tracing::PhysicsJob);
+	}
+
+	for (auto &entry : Obj_move_entries) {
+		objp = &Objects[entry.objnum];
+
+		if (entry.physics) {
+			obj_move_physics_finish(objp);
+		}
+
 		obj_move_all_post(objp, frametime);
 
-		// Equipment script processing
-		if (objp->type == OBJ_SHIP) {
-			ship* shipp = &Ships[objp->instance];
-			object* target;
+		obj_run_equipment_scripts(objp);
+	}
+}
+
+/**
+ * Move all objects for the current frame
+ */
+void obj_move_all(float frametime)
+{
+	TRACE_SCOPE(tracing::MoveObjects);
 
-			if (Ai_info[shipp->ai_index].target_objnum != -1)
-				target = &Objects[Ai_info[shipp->ai_index].target_objnum];
-			else
-				target = NULL;
-			if (objp == Player_obj && Player_ai->target_objnum != -1)
-				target = &Objects[Player_ai->target_objnum];
+	object *objp;	
+
+	// Goober5000 - HACK HACK HACK
+	// this function also resets the OF_DOCKED_ALREADY_HANDLED flag, to save trips
+	// through the used object list
+	obj_delete_all_that_should_be_dead();
+
+	obj_merge_created_list();
+
+	// the timers of the objects which elapsed since the last frame
+	obj_timer_process_all();
+
+	if (!physics_paused && !ai_paused) {
+		ai_think_all();
+
+		// after the AI so the animations it started this frame already move
+		model_anim_process_triggered_rotations();
+	}
+
+	// Clear the table that tells which groups of weapons have cast light so far.
+	if(!(Game_mode & GM_MULTIPLAYER) || (MULTIPLAYER_MASTER)) {
+		obj_clear_weapon_group_id_list();
+	}
+
+	MONITOR_INC( NumObjects, Num_objects );	
+
+	if (Physics_parallel_integration) {
+		obj_move_all_parallel(frametime);
+	} else {
+		for (objp = GET_FIRST(&obj_used_list); objp != END_OF_LIST(&obj_used_list); objp = GET_NEXT(objp)) {
+			// skip objects which should be dead
+			if (objp->flags[Object::Object_Flags::Should_be_dead]) {
+				continue;
+			}
 
-			Script_system.SetHookObjects(2, "User", objp, "Target", target);
-			Script_system.RunCondition(CHA_ONWPEQUIPPED, 0, NULL, objp);
+			// if this is an observer object, skip it
+			if (objp->type == OBJ_OBSERVER) {
+				continue;
+			}
+
+			vec3d cur_pos = objp->pos;			// Save the current position
+
+#ifdef OBJECT_CHECK 
+				obj_check_object( objp );
+#endif
+
+			// pre-move
+			obj_move_all_pre(objp, frametime);
+
+			// store last pos and orient
+			objp->last_pos = cur_pos;
+			objp->last_orient = objp->orient;
+
+			// Goober5000 - skip objects which don't move, but only until they're destroyed
+			if (!(objp->flags[Object::Object_Flags::Immobile] && objp->hull_strength > 0.0f)) {
+				// if this is an object which should be interpolated in multiplayer, do so
+				if (multi_oo_is_interp_object(objp)) {
+					multi_oo_interp(objp);
+				} else {
+					// physics
+					obj_move_call_physics(objp, frametime);
+				}
+			}
+
+			// move post
+			obj_move_all_post(objp, frametime);
+
+			obj_run_equipment_scripts(objp);
 		}
-		Script_system.RemHookVars(2, "User", "Target");
 	}
 
 	// Now that we've moved all the objects, move all the models that use intrinsic rotations.  We do that here because we already handled the
@@ -1519,15 +1866,22 @@ void obj_move_all(float frametime)
 		objp = GET_NEXT(objp);
 	}
 
+	// the projectiles which get close to something become weapons and collide from the next frame on
+	projectile_move_all(frametime);
+
 	find_homing_object_cmeasures();	//	If any cmeasures fired, maybe steer away homing missiles	
 
 	// do pre-collision stuff for beam weapons
 	beam_move_all_pre();
 
+	obj_hot_sync();
+
 	if ( Collisions_enabled ) {
 		TRACE_SCOPE(tracing::CollisionDetection);
 		if ( Cmdline_old_collision_sys ) {
 			obj_check_all_collisions();
+		} else if ( Collision_broadphase == COLLISION_BROADPHASE_HASH ) {
+			obj_hash_and_collide();
 		} else {
 			obj_sort_and_collide();
 		}
@@ -1545,6 +1899,92 @@ void obj_move_all(float frametime)
 }
 
 
+// the transforms of the objects at the start of the last fixed simulation step, see -fixed_simulation
+struct obj_sim_transform {
+	int signature = 0;
+	vec3d pos;
+	matrix orient;
+};
+
+static obj_sim_transform Obj_prev_transforms[MAX_OBJECTS];
+static obj_sim_transform Obj_sim_transforms[MAX_OBJECTS];
+static SCP_vector<int> Obj_interpolated;
+
+void obj_reset_sim_transforms()
+{
+	for (auto& transform : Obj_prev_transforms) {
+		transform.signature = 0;
+	}
+
+	Obj_interpolated.clear();
+}
+
+void obj_save_sim_transforms()
+{
+	for (auto objp = GET_FIRST(&obj_used_list); objp != END_OF_LIST(&obj_used_list); objp = GET_NEXT(objp)) {
+		auto& transform = Obj_prev_transforms[OBJ_INDEX(objp)];
+
+		transform.signature = objp->signature;
+		transform.pos = objp->pos;
+		transform.orient = objp->orient;
+	}
+}
+
+void obj_interpolate_sim_transforms(float t)
+{
+	Assertion(Obj_interpolated.empty(), "The transforms of the objects are still interpolated!");
+
+	CLAMP(t, 0.0f, 1.0f);
+
+	for (auto objp = GET_FIRST(&obj_used_list); objp != END_OF_LIST(&obj_used_list); objp = GET_NEXT(objp)) {
+		int objnum = OBJ_INDEX(objp);
+		auto& prev = Obj_prev_transforms[objnum];
+
+		// created during the last step
+		if (prev.signature != objp->signature || objp->flags[Object::Object_Flags::Should_be_dead]) {
+			continue;
+		}
+
+		auto& current = Obj_sim_transforms[objnum];
+		current.signature = objp->signature;
+		current.pos = objp->pos;
+		current.orient = objp->orient;
+		Obj_interpolated.push_back(objnum);
+
+		vec3d delta;
+		vm_vec_sub(&delta, &current.pos, &prev.pos);
+		vm_vec_scale_add(&objp->pos, &prev.pos, &delta, t);
+
+		// a step only turns an object by a few degrees, anything more is a jump which is not smoothed out
+		if (vm_vec_dot(&prev.orient.vec.fvec, &current.orient.vec.fvec) > 0.7f
+			&& vm_vec_dot(&prev.orient.vec.uvec, &current.orient.vec.uvec) > 0.7f) {
+			vec3d fvec, uvec;
+			vm_vec_sub(&delta, &current.orient.vec.fvec, &prev.orient.vec.fvec);
+			vm_vec_scale_add(&fvec, &prev.orient.vec.fvec, &delta, t);
+			vm_vec_sub(&delta, &current.orient.vec.uvec, &prev.orient.vec.uvec);
+			vm_vec_scale_add(&uvec, &prev.orient.vec.uvec, &delta, t);
+
+			vm_vector_2_matrix(&objp->orient, &fvec, &uvec, nullptr);
+		}
+	}
+}
+
+void obj_restore_sim_transforms()
+{
+	for (auto objnum : Obj_interpolated) {
+		auto objp = &Objects[objnum];
+		auto& current = Obj_sim_transforms[objnum];
+
+		if (objp->signature == current.signature) {
+			objp->pos = current.pos;
+			objp->orient = current.orient;
+		}
+	}
+
+	Obj_interpolated.clear();
+}
+
+
 MONITOR( NumObjectsRend )
 
 /**
@@ -1714,9 +2154,13 @@ void obj_client_post_interpolate()
 		objp = GET_NEXT(objp);
 	}	
 
+	obj_hot_sync();
+
 	// check collisions
 	if ( Cmdline_old_collision_sys ) {
 		obj_check_all_collisions();
+	} else if ( Collision_broadphase == COLLISION_BROADPHASE_HASH ) {
+		obj_hash_and_collide();
 	} else {
 		obj_sort_and_collide();
 	}
@@ -2015,15 +2459,23 @@ int obj_get_by_signature(int sig)
 {
 	Assert(sig > 0);
 
-	object *objp = GET_FIRST(&obj_used_list);
-	while( objp !=END_OF_LIST(&obj_used_list) )
-	{
-		if(objp->signature == sig)
-			return OBJ_INDEX(objp);
+	auto it = Object_signature_index.find(sig);
 
-		objp = GET_NEXT(objp);
-	}
-	return -1;
+	if (it == Object_signature_index.end())
+		return -1;
+
+	return it->second;
+}
+
+/**
+ * Checks if an object number and signature pair saved earlier still refers to the same object
+ */
+bool obj_is_valid(int objnum, int sig)
+{
+	if (objnum < 0 || objnum >= MAX_OBJECTS || sig <= 0)
+		return false;
+
+	return Objects[objnum].type != OBJ_NONE && Objects[objnum].signature == sig;
 }
 
 /**
@@ -167,6 +167,25 @@ typedef struct object_orient_pos {
 	matrix orient;
 } object_orient_pos;
 
+/**
+ * @brief Densely packed copy of the object fields the per frame passes read the most
+ *
+ * Each array holds one entry per allocated object, so passes which only need positions and radii can walk them
+ * linearly instead of chasing obj_used_list through the much larger object struct. Entries are added by obj_create()
+ * and removed by obj_delete(); the removal moves the last entry into the freed spot so the arrays stay gap free.
+ *
+ * The values are a snapshot taken by obj_hot_sync(), which is called after all objects have been moved and before
+ * collision detection. Code which changes an object after that point still has to use the object itself.
+ */
+struct object_hot_store {
+	SCP_vector<int> objnum;
+	SCP_vector<vec3d> pos;
+	SCP_vector<vec3d> last_pos;
+	SCP_vector<matrix> orient;
+	SCP_vector<float> radius;
+	SCP_vector<vec3d> vel;
+};
+
 #ifdef OBJECT_CHECK
 class checkobject
 {
@@ -199,12 +218,18 @@ extern object obj_free_list;
 extern object obj_used_list;
 extern object obj_create_list;
 
+extern object_hot_store Object_hot;
+extern int Object_hot_index[MAX_OBJECTS];	// position of each object in Object_hot, -1 if it isn't in there
+
 extern int render_total;
 extern int render_order[MAX_OBJECTS];
 
 extern object *Viewer_obj;	// Which object is the viewer. Can be NULL.
 extern object *Player_obj;	// Which object is the player. Has to be valid.
 
+// Integrate the physics of all objects on the worker pool, see obj_move_all()
+extern bool Physics_parallel_integration;
+
 // Use this instead of "objp - Objects" to get an object number
 // given it's pointer.  This way, we can replace it with a macro
 // to check that the pointer is valid for debugging.
@@ -293,6 +318,20 @@ void obj_move_all_post(object *objp, float frametime);
 
 void obj_move_call_physics(object *objp, float frametime);
 
+// the fixed simulation steps of -fixed_simulation, the objects are drawn between the transforms of the last two steps
+
+// forgets the saved transforms, done in obj_init()
+void obj_reset_sim_transforms();
+
+// saves the transforms of all objects, called before every simulation step
+void obj_save_sim_transforms();
+
+// moves the objects to t between the saved transforms and their current ones for rendering
+void obj_interpolate_sim_transforms(float t);
+
+// puts the objects back where the simulation has them after rendering
+void obj_restore_sim_transforms();
+
 // multiplayer object update stuff begins -------------------------------------------
 
 // do client-side pre-interpolation object movement
@@ -342,8 +381,35 @@ void object_set_gliding(object *objp, bool enable=true, bool force = false);
 bool object_get_gliding(object *objp);
 bool object_glide_forced(object* objp);
 int obj_get_by_signature(int sig);
+bool obj_is_valid(int objnum, int sig);
+void obj_hot_sync();
+
+/**
+ * @brief The objects of a type which are on obj_used_list, in no particular order
+ *
+ * Objects are added when obj_merge_created_list() moves them onto obj_used_list and removed by obj_delete(), which
+ * moves the last entry into the freed spot. Loops over a list must not create or delete objects of its type.
+ */
+const SCP_vector<int>& obj_get_type_list(int type);
+
+/**
+ * @brief The homing weapons among obj_get_type_list(OBJ_WEAPON), kept the same way
+ */
+const SCP_vector<int>& obj_get_homing_weapons();
 int object_get_model(object *objp);
 
+// the views of a frame an object can be seen in, see obj_build_view_masks()
+#define OBJ_VIEW_MAIN					(1 << 0)
+#define OBJ_VIEW_SHADOW_CASCADE_SHIFT	1		// followed by one bit for each shadow cascade
+
+struct obj_view_mask {
+	int objnum;
+	int mask;
+};
+
+void obj_build_view_masks();
+const SCP_vector<obj_view_mask>& obj_get_view_masks();
+
 void obj_render_queue_all();
 
 #endif
@@ -6,25 +6,47 @@
 
 
 
-#include "math/bitarray.h"
 #include "math/vecmat.h"
 #include "mission/missionparse.h"
 #include "object/object.h"
 #include "object/objectdock.h"
 #include "ship/ship.h"
 
+#include <algorithm>
 
 
 
+// The objects of an assembly, in the order dock_evaluate_all_docked_objects() visits them starting from one of them.
+// They are only searched again after something docked or undocked, and the total mass is only summed again after
+// dock_invalidate_docked_mass() or a change of the assembly.  The positions and orientations of the objects change
+// every frame, so the centers and radii are still calculated from the members every time.
+struct dock_assembly_cache
+{
+	int dock_generation = -1;
+	int mass_generation = -1;
+	int signature = -1;
+	bool assume_hub = false;
+
+	float total_mass = 0.0f;
+	SCP_vector<object*> members;
+};
+
+static dock_assembly_cache Dock_assemblies[MAX_OBJECTS];
+
+// incremented whenever any dock list changes
+static int Dock_generation = 0;
+
+// incremented whenever the mass of a docked object may have changed
+static int Dock_mass_generation = 0;
+
 // helper prototypes
 
-void dock_evaluate_tree(object *objp, dock_function_info *infop, void (*function)(object *, dock_function_info *), ubyte *visited_bitstring);
+dock_assembly_cache *dock_get_assembly(object *objp);
+void dock_collect_tree(object *objp, SCP_vector<object*> &members);
 void dock_move_docked_children_tree(object *objp, object *parent_objp);
-void dock_count_total_docked_objects_helper(object *objp, dock_function_info *infop);
 void dock_check_find_docked_object_helper(object *objp, dock_function_info *infop);
 void dock_calc_docked_center_helper(object *objp, dock_function_info *infop);
 void dock_calc_docked_center_of_mass_helper(object *objp, dock_function_info *infop);
-void dock_calc_total_docked_mass_helper(object *objp, dock_function_info *infop);
 void dock_calc_max_cross_sectional_radius_squared_perpendicular_to_line_helper(object *objp, dock_function_info *infop);
 void dock_calc_max_semilatus_rectum_squared_parallel_to_directrix_helper(object *objp, dock_function_info *infop);
 void dock_find_max_speed_helper(object *objp, dock_function_info *infop);
@@ -88,11 +110,10 @@ int dock_count_total_docked_objects(object *objp)
 {
 	Assert(objp != NULL);
 
-	dock_function_info dfi;
-
-	dock_evaluate_all_docked_objects(objp, &dfi, dock_count_total_docked_objects_helper);
+	if (!object_is_docked(objp))
+		return 1;
 
-	return dfi.maintained_variables.int_value;
+	return (int) dock_get_assembly(objp)->members.size();
 }
 
 bool dock_check_find_direct_docked_object(object *objp, object *other_objp)
@@ -177,11 +198,26 @@ float dock_calc_total_docked_mass(object *objp)
 {
 	Assert(objp != NULL);
 
-	dock_function_info dfi;
-	
-	dock_evaluate_all_docked_objects(objp, &dfi, dock_calc_total_docked_mass_helper);
+	if (!object_is_docked(objp))
+		return objp->phys_info.mass;
 
-	return dfi.maintained_variables.float_value;
+	dock_assembly_cache *assembly = dock_get_assembly(objp);
+
+	if (assembly->mass_generation != Dock_mass_generation)
+	{
+		assembly->total_mass = 0.0f;
+		for (object *member : assembly->members)
+			assembly->total_mass += member->phys_info.mass;
+
+		assembly->mass_generation = Dock_mass_generation;
+	}
+
+	return assembly->total_mass;
+}
+
+void dock_invalidate_docked_mass()
+{
+	Dock_mass_generation++;
 }
 
 float dock_calc_max_cross_sectional_radius_perpendicular_to_axis(object *objp, axis_type axis)
@@ -328,74 +364,75 @@ void dock_evaluate_all_docked_objects(object *objp, dock_function_info *infop, v
 		return;
 	}
 
-	// we only have two objects docked
-	if (dock_check_docked_one_on_one(objp))
+	// iterate through all objects of the assembly
+	for (object *member : dock_get_assembly(objp)->members)
 	{
-		// call the function for the first object, and return if instructed
-		function(objp, infop);
+		// call the function for this object, and return if instructed
+		function(member, infop);
 		if (infop->early_return_condition) return;
+	}
+}
 
-		// call the function for the second object, and return if instructed
-		function(objp->dock_list->docked_objp, infop);
-		if (infop->early_return_condition) return;
+// find the objects docked with objp, if that wasn't done since the last change of any dock list
+dock_assembly_cache *dock_get_assembly(object *objp)
+{
+	Assert(object_is_docked(objp));
+
+	dock_assembly_cache *assembly = &Dock_assemblies[OBJ_INDEX(objp)];
+	bool assume_hub = dock_check_assume_hub();
+
+	if ((assembly->dock_generation == Dock_generation) && (assembly->signature == objp->signature) && (assembly->assume_hub == assume_hub))
+		return assembly;
+
+	assembly->members.clear();
+
+	// we only have two objects docked
+	if (dock_check_docked_one_on_one(objp))
+	{
+		assembly->members.push_back(objp);
+		assembly->members.push_back(objp->dock_list->docked_objp);
 	}
 
 	// we have multiple objects docked and we're treating them as a hub
-	else if (dock_check_assume_hub())
+	else if (assume_hub)
 	{
 		// get the hub
 		object *hub_objp = dock_get_hub(objp);
 
-		// call the function for the hub, and return if instructed
-		function(hub_objp, infop);
-		if (infop->early_return_condition) return;
-
-		// iterate through all docked objects
+		// the hub comes first, then all objects docked to it
+		assembly->members.push_back(hub_objp);
 		for (dock_instance *ptr = hub_objp->dock_list; ptr != NULL; ptr = ptr->next)
-		{
-			// call the function for this object, and return if instructed
-			function(ptr->docked_objp, infop);
-			if (infop->early_return_condition) return;
-		}
+			assembly->members.push_back(ptr->docked_objp);
 	}
 
 	// we have multiple objects docked and we must treat them as a tree
 	else
 	{
-		// create a bit array to mark the objects we check
-		ubyte *visited_bitstring = (ubyte *) vm_malloc(calculate_num_bytes(MAX_OBJECTS));
-
-		// clear it
-		memset(visited_bitstring, 0, calculate_num_bytes(MAX_OBJECTS));
+		dock_collect_tree(objp, assembly->members);
+	}
 
-		// start evaluating the tree
-		dock_evaluate_tree(objp, infop, function, visited_bitstring);
+	assembly->dock_generation = Dock_generation;
+	assembly->mass_generation = -1;
+	assembly->signature = objp->signature;
+	assembly->assume_hub = assume_hub;
 
-		// destroy the bit array
-		vm_free(visited_bitstring);
-		visited_bitstring = NULL;
-	}
+	return assembly;
 }
 
-void dock_evaluate_tree(object *objp, dock_function_info *infop, void (*function)(object *, dock_function_info *), ubyte *visited_bitstring)
+void dock_collect_tree(object *objp, SCP_vector<object*> &members)
 {
-	// make sure we haven't visited this object already
-	if (get_bit(visited_bitstring, OBJ_INDEX(objp)))
+	// make sure we haven't visited this object already (assemblies are small, so a search is fine)
+	if (std::find(members.begin(), members.end(), objp) != members.end())
 		return;
 
 	// mark as visited
-	set_bit(visited_bitstring, OBJ_INDEX(objp));
-
-	// call the function for this object, and return if instructed
-	function(objp, infop);
-	if (infop->early_return_condition) return;
+	members.push_back(objp);
 
 	// iterate through all docked objects
 	for (dock_instance *ptr = objp->dock_list; ptr != NULL; ptr = ptr->next)
 	{
-		// start another tree with the docked object as the root, and return if instructed
-		dock_evaluate_tree(ptr->docked_objp, infop, function, visited_bitstring);
-		if (infop->early_return_condition) return;
+		// start another tree with the docked object as the root
+		dock_collect_tree(ptr->docked_objp, members);
 	}
 }
 
@@ -475,12 +512,6 @@ void dock_move_docked_children_tree(object *objp, object *parent_objp)
 // helper functions
 // ----------------
 
-void dock_count_total_docked_objects_helper(object *objp, dock_function_info *infop)
-{
-	// increment count
-	infop->maintained_variables.int_value++;
-}
-
 void dock_check_find_docked_object_helper(object *objp, dock_function_info *infop)
 {
 	// if object found, set to true and break
@@ -505,12 +536,6 @@ void dock_calc_docked_center_of_mass_helper(object *objp, dock_function_info *in
 	infop->maintained_variables.float_value += objp->phys_info.mass;
 }
 
-void dock_calc_total_docked_mass_helper(object *objp, dock_function_info *infop)
-{
-	// add mass
-	infop->maintained_variables.float_value += objp->phys_info.mass;
-}
-
 // What we're doing here is finding the distances between each extent of the object and the line, and then taking the
 // maximum distance as the cross-sectional radius.  We're actually maintaining the square of the distance rather than
 // the actual distance, as it's faster to calculate and it gives the same result in a greater-than or less-than
@@ -724,6 +749,8 @@ void dock_add_instance(object *objp, int dockpoint, object *other_objp)
 	// prepend item to existing list
 	item->next = objp->dock_list;
 	objp->dock_list = item;
+
+	Dock_generation++;
 }
 
 void dock_remove_instance(object *objp, object *other_objp)
@@ -765,6 +792,8 @@ void dock_remove_instance(object *objp, object *other_objp)
 
 		// delete it
 		vm_free(ptr);
+
+		Dock_generation++;
 	}
 	else
 	{
@@ -778,6 +807,9 @@ void dock_free_dock_list(object *objp)
 {
 	Assert(objp != NULL);
 
+	if (objp->dock_list != NULL)
+		Dock_generation++;
+
 	while (objp->dock_list != NULL)
 	{
 		dock_instance *ptr = objp->dock_list;
@@ -99,6 +99,10 @@ void dock_calc_docked_center_of_mass(vec3d *dest, object *objp);
 // sum the masses of all directly or indirectly docked ships
 float dock_calc_total_docked_mass(object *objp);
 
+// the total masses are kept until an assembly changes, so this must be called after changing the mass of an object
+// which may be docked
+void dock_invalidate_docked_mass();
+
 // calculate cross-sectional radius of a set of docked models
 float dock_calc_max_cross_sectional_radius_perpendicular_to_axis(object *objp, axis_type axis);
 
@@ -116,7 +120,8 @@ float dock_calc_docked_speed(object *objp);
 
 // berfunction for evaluating all objects that could possibly be docked to objp.  This will
 // call "function" for each docked object.  The function should store its intermediate and
-// return values in the dock_function_info class.
+// return values in the dock_function_info class.  The objects of an assembly are only searched
+// again after something docked or undocked.
 void dock_evaluate_all_docked_objects(object *objp, dock_function_info *infop, void (*function)(object *, dock_function_info *));
 
 // moves all docked objects; called only from obj_move_all in object.cpp
@@ -45,8 +45,25 @@ typedef struct _obj_snd {
 	int		flags;			
 	vec3d	offset;			// offset from the center of the object where the sound lives
 	ship_subsys *ss;		//Associated subsystem
+	float		submitted_vol;	// volume last passed to the sound source with the master volume applied, -1 if it has to be set
+	vec3d	submitted_pos;	// position last passed to the sound source
+	vec3d	submitted_vel;	// velocity last passed to the sound source
 } obj_snd;
 
+// a sound in the range of the listener in the batch of obj_snd_do_frame()
+struct obj_snd_batch_entry {
+	obj_snd	*osp;
+	vec3d	source_pos;
+	float		add_distance;	// radius of the object for main sounds
+	float		distance;		// from the listener, less add_distance
+	float		min;
+	float		max;
+	float		max_vol;
+	float		vol;				// attenuated by the distance
+};
+
+static SCP_vector<obj_snd_batch_entry> Obj_snd_batch;
+
 #define VOL_PAN_UPDATE			50						// time in ms to update a persistent sound vol/pan
 #define MIN_PERSISTANT_VOL		0.10f
 #define MIN_FORWARD_SPEED		5
@@ -56,6 +73,9 @@ static int MAX_OBJ_SOUNDS_PLAYING = -1; // initialized in obj_snd_level_init()
 static int Num_obj_sounds_playing;
 
 #define OBJSND_CHANGE_FREQUENCY_THRESHOLD			10
+#define OBJSND_CHANGE_VOLUME_THRESHOLD				0.005f
+#define OBJSND_CHANGE_POSITION_THRESHOLD			0.5f	// in meters
+#define OBJSND_CHANGE_VELOCITY_THRESHOLD			1.0f	// in meters per second
 
 static	obj_snd	obj_snd_list;						// head of linked list of object sound structs
 static	int		Doppler_enabled = TRUE;
@@ -454,16 +474,19 @@ void maybe_play_flyby_snd(float closest_dist, object *closest_objp, object *list
 //
 // Called once per frame to process the persistent sound objects
 //
+// The sounds are updated in a batch: the positions and distances of all sounds are gathered
+// first and the ones which are out of range and not playing are culled, then the attenuation
+// of the rest is computed in one go before the sounds are started, stopped and updated.
+//
 void obj_snd_do_frame()
 {
-	float				closest_dist, distance, speed_vol_multiplier, rot_vol_mult, percent_max, alive_vol_mult;
+	float				closest_dist, speed_vol_multiplier, rot_vol_mult, percent_max, alive_vol_mult;
 	obj_snd			*osp;
 	object			*objp, *closest_objp;
 	game_snd			*gs;
 	ship				*sp;
 	int				channel, go_ahead_flag;
-	vec3d			source_pos;
-	float				add_distance;
+	size_t			i;
 
 	if ( Obj_snd_enabled == FALSE )
 		return;
@@ -488,6 +511,8 @@ void obj_snd_do_frame()
 		observer_obj = Player_obj;
 	}
 
+	// gather the sources and cull the sounds which are out of range and not playing
+	Obj_snd_batch.clear();
 	for ( osp = GET_FIRST(&obj_snd_list); osp !=END_OF_LIST(&obj_snd_list); osp = GET_NEXT(osp) ) {
 		Assert(osp != NULL);
 		objp = &Objects[osp->objnum];
@@ -495,31 +520,59 @@ void obj_snd_do_frame()
 			// we don't play the engine sound if the view is from the player
 			continue;
 		}
-		
+
 		gs = &Snds[osp->id];
 
-		obj_snd_source_pos(&source_pos, osp);
-		distance = vm_vec_dist_quick( &source_pos, &View_position );
+		obj_snd_batch_entry entry;
+		entry.osp = osp;
+		obj_snd_source_pos(&entry.source_pos, osp);
 
 		// how much extra distance do we add before attentuation?
-		add_distance = 0.0f;
+		entry.add_distance = 0.0f;
 		if(osp->flags & OS_MAIN){
-			add_distance = objp->radius;
-		} 
+			entry.add_distance = objp->radius;
+		}
 
-		distance -= add_distance;
-		if ( distance < 0.0f ) {
-			distance = 0.0f;
+		entry.distance = vm_vec_dist_quick( &entry.source_pos, &View_position ) - entry.add_distance;
+		if ( entry.distance < 0.0f ) {
+			entry.distance = 0.0f;
 		}
 
 		// save closest distance (used for flyby sound) if this is a small ship (and not the observer)
-		if ( (objp->type == OBJ_SHIP) && (distance < closest_dist) && (objp != observer_obj) ) {
+		if ( (objp->type == OBJ_SHIP) && (entry.distance < closest_dist) && (objp != observer_obj) ) {
 			if ( Ship_info[Ships[objp->instance].ship_info_index].is_small_ship() ) {
-				closest_dist = distance;
+				closest_dist = entry.distance;
 				closest_objp = objp;
 			}
 		}
 
+		if ( (osp->instance == -1) && (entry.distance >= gs->max) ) {
+			continue;
+		}
+
+		entry.min = i2fl(gs->min);
+		entry.max = i2fl(gs->max);
+		entry.max_vol = gs->default_volume;
+		Obj_snd_batch.push_back(entry);
+	}
+
+	// attenuate the sounds by their distance
+	for ( i = 0; i < Obj_snd_batch.size(); i++ ) {
+		auto& entry = Obj_snd_batch[i];
+
+		if ( entry.distance <= entry.min ) {
+			entry.vol = entry.max_vol;
+		} else {
+			entry.vol = entry.max_vol - (entry.distance - entry.min) * entry.max_vol / (entry.max - entry.min);
+		}
+	}
+
+	for ( i = 0; i < Obj_snd_batch.size(); i++ ) {
+		auto& entry = Obj_snd_batch[i];
+		osp = entry.osp;
+		objp = &Objects[osp->objnum];
+		gs = &Snds[osp->id];
+
 		// If the object is a ship, we don't want to start the engine sound unless the ship is
 		// moving (unless flag SIF_BIG_SHIP is set)
 		speed_vol_multiplier = 1.0f;
@@ -596,18 +649,9 @@ void obj_snd_do_frame()
 		}
 	
 		go_ahead_flag = TRUE;
-		float max_vol,new_vol;
 		if ( osp->instance == -1 ) {
-			if ( distance < Snds[osp->id].max ) {
-				max_vol = Snds[osp->id].default_volume;
-				if ( distance <= Snds[osp->id].min ) {
-					new_vol = max_vol;
-				}
-				else {
-					new_vol = max_vol - (distance - Snds[osp->id].min) * max_vol / (Snds[osp->id].max - Snds[osp->id].min);
-				}
-
-				if ( new_vol < 0.1f ) {
+			if ( entry.distance < entry.max ) {
+				if ( entry.vol < 0.1f ) {
 					continue;
 				}
 
@@ -616,7 +660,7 @@ void obj_snd_do_frame()
 					case OBJ_DEBRIS:
 					case OBJ_ASTEROID:
 						if ( Num_obj_sounds_playing >= MAX_OBJ_SOUNDS_PLAYING ) {
-							go_ahead_flag = obj_snd_stop_lowest_vol(new_vol);
+							go_ahead_flag = obj_snd_stop_lowest_vol(entry.vol);
 						}
 						break;
 
@@ -626,17 +670,20 @@ void obj_snd_do_frame()
 				} // end switch
 
 				if ( go_ahead_flag ) {
-					osp->instance = snd_play_3d(gs, &source_pos, &View_position, add_distance, &objp->phys_info.vel, 1, 1.0f, SND_PRIORITY_TRIPLE_INSTANCE, NULL, 1.0f, 0, true);
+					osp->instance = snd_play_3d(gs, &entry.source_pos, &View_position, entry.add_distance, &objp->phys_info.vel, 1, 1.0f, SND_PRIORITY_TRIPLE_INSTANCE, NULL, 1.0f, 0, true);
 					if ( osp->instance != -1 ) {
 						Num_obj_sounds_playing++;
+
+						// a new source, everything has to be set
+						osp->submitted_vol = -1.0f;
 					}
 				}
 				Assert(Num_obj_sounds_playing <= MAX_OBJ_SOUNDS_PLAYING);
 
-			} // 		end if ( distance < Snds[osp->id].max )
+			} // 		end if ( entry.distance < entry.max )
 		} // 		if ( osp->instance == -1 )
 		else {
-			if ( distance > Snds[osp->id].max ) {
+			if ( entry.distance > entry.max ) {
 				int sound_index = -1;
 				int idx = 0;
 
@@ -660,16 +707,13 @@ void obj_snd_do_frame()
 		if ( objp->type == OBJ_SHIP )
 			sp = &Ships[objp->instance];
 
-
-		channel = ds_get_channel(osp->instance);
-		// for DirectSound3D sounds, re-establish the maximum speed based on the
-		//	speed_vol_multiplier
+		float volume;
 		if ( sp == NULL || ( (sp != NULL) && (sp->flags[Ship::Ship_Flags::Engines_on]) ) ) {
-			snd_set_volume( osp->instance, gs->default_volume*speed_vol_multiplier*rot_vol_mult*alive_vol_mult );
+			volume = gs->default_volume*speed_vol_multiplier*rot_vol_mult*alive_vol_mult;
 		}
 		else {
 			// engine sound is disabled
-			snd_set_volume( osp->instance, 0.0f );
+			volume = 0.0f;
 		}
 
 		vec3d vel = objp->phys_info.vel;
@@ -681,8 +725,32 @@ void obj_snd_do_frame()
 			}
 		}
 
-		ds3d_update_buffer(channel, i2fl(gs->min), i2fl(gs->max), &source_pos, &vel);
-		snd_get_3d_vol_and_pan(gs, &source_pos, &osp->vol, &osp->pan, add_distance);
+		// only the parameters which changed noticeably are passed on to the sound source
+		bool new_source = osp->submitted_vol < 0.0f;
+		float master_volume = volume * (Master_sound_volume * aav_effect_volume);
+
+		if ( new_source || fabs(master_volume - osp->submitted_vol) > OBJSND_CHANGE_VOLUME_THRESHOLD ) {
+			snd_set_volume( osp->instance, volume );
+			osp->submitted_vol = master_volume;
+		}
+
+		if ( new_source
+			|| vm_vec_dist_squared(&entry.source_pos, &osp->submitted_pos) > OBJSND_CHANGE_POSITION_THRESHOLD * OBJSND_CHANGE_POSITION_THRESHOLD
+			|| vm_vec_dist_squared(&vel, &osp->submitted_vel) > OBJSND_CHANGE_VELOCITY_THRESHOLD * OBJSND_CHANGE_VELOCITY_THRESHOLD ) {
+			channel = ds_get_channel(osp->instance);
+			ds3d_update_buffer(channel, entry.min, entry.max, &entry.source_pos, &vel);
+			osp->submitted_pos = entry.source_pos;
+			osp->submitted_vel = vel;
+		}
+
+		// what snd_get_3d_vol_and_pan() would return, with the distance from above
+		osp->vol = MIN(entry.vol, 1.0f);
+		osp->pan = 0.0f;
+		if ( entry.distance > 0.0f ) {
+			vec3d vector_to_sound;
+			vm_vec_normalized_dir_quick( &vector_to_sound, &entry.source_pos, &View_position );
+			osp->pan = vm_vec_dot( &View_matrix.vec.rvec, &vector_to_sound );
+		}
 	}	// end for
 
 	// see if we want to play a flyby sound
@@ -757,6 +825,7 @@ int obj_snd_assign(int objnum, int sndnum, vec3d *pos, int main, int flags, ship
 
 	snd->instance = -1;
 	snd->vol = 0.0f;
+	snd->submitted_vol = -1.0f;
 	snd->objnum = OBJ_INDEX(objp);
 	snd->next_update = 1;
 	snd->offset = *pos;
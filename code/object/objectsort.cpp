@@ -16,17 +16,22 @@
 #include "asteroid/asteroid.h"
 #include "cmdline/cmdline.h"
 #include "debris/debris.h"
+#include "globalincs/jobs.h"
+#include "graphics/decals.h"
 #include "graphics/opengl/gropengldraw.h"
+#include "graphics/shadows.h"
 #include "jumpnode/jumpnode.h"
 #include "mission/missionparse.h"
 #include "model/modelrender.h"
 #include "nebula/neb.h"
 #include "object/object.h"
+#include "object/objocclusion.h"
 #include "scripting/scripting.h"
 #include "render/3d.h"
 #include "render/batching.h"
 #include "ship/ship.h"
 #include "tracing/tracing.h"
+#include "weapon/projectile.h"
 #include "weapon/weapon.h"
 
 
@@ -132,15 +137,20 @@ vec3d check_offsets[8] = {
 int obj_in_view_cone( object * objp )
 {
 	int i;
-	vec3d tmp,pt;
+	vec3d pts[8];
 	ubyte codes;
 
 	// Center isn't in... are other points?
 	ubyte and_codes = 0xff;
 
+	// this is also used on the worker threads so the points are rotated here instead of with g3_rotate_vector()
 	for (i=0; i<8; i++ ) {
-		vm_vec_scale_add( &pt, &objp->pos, &check_offsets[i], objp->radius );
-		codes=g3_rotate_vector(&tmp,&pt);
+		vm_vec_scale_add( &pts[i], &objp->pos, &check_offsets[i], objp->radius );
+	}
+	vm_vec_rotate_n( pts, pts, 8, &View_matrix, &View_position );
+
+	for (i=0; i<8; i++ ) {
+		codes=g3_code_vector(&pts[i]);
 		if ( !codes ) {
 			//mprintf(( "A point is inside, so render it.\n" ));
 			return 1;		// this point is in, so return 1
@@ -333,53 +343,131 @@ void obj_render_all(void (*render_function)(object *objp), bool *draw_viewer_las
 	}
 }
 
-void obj_render_queue_all()
+// the objects which are in any view of this frame
+static SCP_vector<obj_view_mask> Obj_view_masks;
+static bool Obj_view_masks_built = false;
+
+/**
+ * Culls all objects against all views of the frame, the main view and the shadow cascades
+ *
+ * The shadow cascades have to be set up with shadows_prepare_frame() before. The result is used by
+ * shadows_render_all() and obj_render_queue_all() and is built again by the first of them if this wasn't called.
+ */
+void obj_build_view_masks()
 {
-	GR_DEBUG_SCOPE("Render all objects");
-	TRACE_SCOPE(tracing::RenderScene);
+	TRACE_SCOPE(tracing::BuildViewMasks);
+
+	static SCP_vector<int> candidates;
+	static SCP_vector<int> masks;
 
 	object *objp;
 	int i;
-	model_draw_list scene;
 
-	objp = Objects;
+	candidates.clear();
 
-	gr_deferred_lighting_begin();
+	for ( i = 0, objp = Objects; i <= Highest_object_index; i++, objp++ ) {
+		if ( objp->type == OBJ_NONE ) {
+			continue;
+		}
 
-	scene.init();
+		if ( objp->flags[Object::Object_Flags::Renders] ) {
+			objp->flags.remove(Object::Object_Flags::Was_rendered);
+		}
 
-	for ( i = 0; i <= Highest_object_index; i++,objp++ ) {
-		if ( (objp->type != OBJ_NONE) && ( objp->flags [Object::Object_Flags::Renders] ) )	{
-            objp->flags.remove(Object::Object_Flags::Was_rendered);
+		candidates.push_back(i);
+	}
 
-			if ( !obj_in_view_cone(objp) ) {
-				continue;
-			}
+	// Culling only reads the objects and the views so it is done on the workers. Queuing the objects stays on the main
+	// thread since it runs scripting hooks and adds glow points, thrusters and effects to the shared batches.
+	masks.resize(candidates.size());
 
-			if ( (The_mission.flags[Mission::Mission_Flags::Fullneb]) && (Neb2_render_mode != NEB2_RENDER_NONE) && !Fred_running ) {
-				vec3d to_obj;
-				vm_vec_sub( &to_obj, &objp->pos, &Eye_position );
-				float z = vm_vec_dot( &Eye_matrix.vec.fvec, &to_obj );
+	bool nebula_skip = (The_mission.flags[Mission::Mission_Flags::Fullneb]) && (Neb2_render_mode != NEB2_RENDER_NONE) && !Fred_running;
+
+	jobs::parallel_for(candidates.size(), 64, [nebula_skip](size_t begin, size_t end, size_t) {
+		for ( size_t j = begin; j < end; ++j ) {
+			object *cull_objp = &Objects[candidates[j]];
+
+			int mask = shadows_obj_cascade_mask(cull_objp) << OBJ_VIEW_SHADOW_CASCADE_SHIFT;
+
+			if ( cull_objp->flags[Object::Object_Flags::Renders] && obj_in_view_cone(cull_objp) ) {
+				mask |= OBJ_VIEW_MAIN;
 
-				if ( neb2_skip_render(objp, z) ){
-					continue;
+				if ( nebula_skip ) {
+					vec3d to_obj;
+					vm_vec_sub( &to_obj, &cull_objp->pos, &Eye_position );
+					float z = vm_vec_dot( &Eye_matrix.vec.fvec, &to_obj );
+
+					if ( neb2_skip_render(cull_objp, z) ){
+						mask &= ~OBJ_VIEW_MAIN;
+					}
 				}
 			}
 
-			if ( obj_render_is_model(objp) ) {
-				if( (objp->type == OBJ_SHIP) && Ships[objp->instance].shader_effect_active ) {
-					effect_ships.push_back(objp);
-					continue;
-				}
+			masks[j] = mask;
+		}
+	}, tracing::RenderCullJob);
+
+	Obj_view_masks.clear();
+
+	for ( size_t j = 0; j < candidates.size(); ++j ) {
+		if ( masks[j] != 0 ) {
+			Obj_view_masks.push_back({ candidates[j], masks[j] });
+		}
+	}
+
+	Obj_view_masks_built = true;
+}
+
+const SCP_vector<obj_view_mask>& obj_get_view_masks()
+{
+	if ( !Obj_view_masks_built ) {
+		obj_build_view_masks();
+	}
+
+	return Obj_view_masks;
+}
+
+void obj_render_queue_all()
+{
+	GR_DEBUG_SCOPE("Render all objects");
+	TRACE_SCOPE(tracing::RenderScene);
+
+	object *objp;
+	model_draw_list scene;
+
+	gr_deferred_lighting_begin();
+
+	scene.init();
+
+	for ( auto& view_mask : obj_get_view_masks() ) {
+		if ( !(view_mask.mask & OBJ_VIEW_MAIN) ) {
+			continue;
+		}
+
+		objp = &Objects[view_mask.objnum];
+
+		if ( obj_render_is_model(objp) ) {
+			if( (objp->type == OBJ_SHIP) && Ships[objp->instance].shader_effect_active ) {
+				effect_ships.push_back(objp);
+				continue;
 			}
+		}
 
-            objp->flags.set(Object::Object_Flags::Was_rendered);
-			obj_queue_render(objp, &scene);
+		// hidden objects are skipped together with their thrusters, glow points and effects
+		if ( obj_occlusion_cull(objp) ) {
+			continue;
 		}
+
+        objp->flags.set(Object::Object_Flags::Was_rendered);
+		obj_queue_render(objp, &scene);
 	}
 
 	scene.init_render();
 
+	if ( Cmdline_depth_prepass && Deferred_lighting ) {
+		scene.render_depth_prepass();
+	}
+
 	scene.render_all(ZBUFFER_TYPE_FULL);
 	gr_zbuffer_set(ZBUFFER_TYPE_READ);
 	gr_zbias(0);
@@ -388,6 +476,12 @@ void obj_render_queue_all()
 	gr_clear_states();
 	gr_set_fill_mode(GR_FILL_MODE_SOLID);
 
+	// the G-buffer is complete so the decals can be projected onto it
+	decals_render_all();
+
+	// the depth buffer now holds all opaque geometry so this is where the objects are tested for the next frames
+	obj_occlusion_render_queries();
+
  	gr_deferred_lighting_end();
 	gr_deferred_lighting_finish();
 
@@ -405,6 +499,9 @@ void obj_render_queue_all()
 	scene.render_insignias();
 	scene.render_arcs();
 
+	// the next frame has to cull again
+	Obj_view_masks_built = false;
+
 	gr_zbuffer_set(ZBUFFER_TYPE_READ);
 	gr_zbias(0);
 	gr_set_cull(0);
@@ -420,6 +517,8 @@ void obj_render_queue_all()
 		gr_fog_set(GR_FOGMODE_NONE, 0, 0, 0);
 	}
 
+	projectile_render_all();
+
 	batching_render_all();
 
 	gr_zbias(0);
@@ -0,0 +1,215 @@
+#include "object/objocclusion.h"
+
+#include "debugconsole/console.h"
+#include "graphics/2d.h"
+#include "graphics/material.h"
+#include "model/model.h"
+#include "object/object.h"
+#include "render/3d.h"
+#include "ship/ship.h"
+#include "tracing/Monitor.h"
+#include "tracing/tracing.h"
+
+namespace {
+
+struct occlusion_state {
+	int signature = -1;
+	int query = -1;
+
+	bool query_pending = false;
+	bool hidden = false;
+};
+
+occlusion_state Occlusion_states[MAX_OBJECTS];
+
+SCP_vector<int> Occlusion_test_objects;
+
+int Occlusion_num_culled = 0;
+int Occlusion_num_visible = 0;
+
+// the bounding boxes are grown a bit since thrusters, glow points and rotating submodels may stick out of them
+const float OCCLUSION_BOX_MARGIN = 0.1f;
+
+// the corners of every face of a bounding box, bit 0 of a corner selects the x, bit 1 the y and bit 2 the z coordinate
+const int Occlusion_box_faces[6][4] = {
+	{ 0, 4, 6, 2 },
+	{ 1, 3, 7, 5 },
+	{ 0, 1, 5, 4 },
+	{ 2, 6, 7, 3 },
+	{ 0, 2, 3, 1 },
+	{ 4, 5, 7, 6 }
+};
+
+bool obj_occlusion_can_test(object* objp)
+{
+	// only ships are big enough to be worth a query and to be able to hide each other
+	return objp->type == OBJ_SHIP && objp != Viewer_obj && !Fred_running;
+}
+
+void obj_occlusion_get_box(object* objp, vec3d* mins, vec3d* maxs)
+{
+	polymodel* pm = model_get(Ship_info[Ships[objp->instance].ship_info_index].model_num);
+
+	vec3d margin;
+	vm_vec_sub(&margin, &pm->maxs, &pm->mins);
+	vm_vec_scale(&margin, OCCLUSION_BOX_MARGIN);
+
+	vm_vec_sub(mins, &pm->mins, &margin);
+	vm_vec_add(maxs, &pm->maxs, &margin);
+}
+
+}
+
+bool Occlusion_culling = true;
+DCF_BOOL(occlusion_culling, Occlusion_culling);
+
+MONITOR(OcclusionCulled)
+MONITOR(OcclusionVisible)
+MONITOR(OcclusionQueries)
+
+void obj_occlusion_level_init()
+{
+	for (auto& state : Occlusion_states) {
+		state.signature = -1;
+		state.query_pending = false;
+		state.hidden = false;
+	}
+
+	Occlusion_test_objects.clear();
+}
+
+void obj_occlusion_level_close()
+{
+	for (auto& state : Occlusion_states) {
+		if (state.query >= 0) {
+			gr_delete_query_object(state.query);
+			state.query = -1;
+		}
+	}
+
+	obj_occlusion_level_init();
+}
+
+bool obj_occlusion_cull(object* objp)
+{
+	if (!Occlusion_culling || !obj_occlusion_can_test(objp)) {
+		return false;
+	}
+
+	auto& state = Occlusion_states[OBJ_INDEX(objp)];
+
+	if (state.signature != objp->signature) {
+		// a new object in this slot, the result of a query which may still be running belongs to the old one
+		state.signature = objp->signature;
+		state.query_pending = false;
+		state.hidden = false;
+	}
+
+	if (state.query_pending && gr_query_value_available(state.query)) {
+		state.hidden = gr_get_query_value(state.query) == 0;
+		state.query_pending = false;
+	}
+
+	// an object is tested again once the result of its last test is known, hidden objects have to be tested as well so
+	// they can become visible again
+	if (!state.query_pending) {
+		Occlusion_test_objects.push_back(OBJ_INDEX(objp));
+	}
+
+	if (state.hidden) {
+		++Occlusion_num_culled;
+	} else {
+		++Occlusion_num_visible;
+	}
+
+	return state.hidden;
+}
+
+void obj_occlusion_render_queries()
+{
+	GR_DEBUG_SCOPE("Occlusion queries");
+	TRACE_SCOPE(tracing::OcclusionQueries);
+
+	MONITOR_SET(OcclusionCulled, Occlusion_num_culled);
+	MONITOR_SET(OcclusionVisible, Occlusion_num_visible);
+	MONITOR_SET(OcclusionQueries, (int)Occlusion_test_objects.size());
+
+	Occlusion_num_culled = 0;
+	Occlusion_num_visible = 0;
+
+	if (Occlusion_test_objects.empty()) {
+		return;
+	}
+
+	material proxy_material;
+	proxy_material.set_blend_mode(ALPHA_BLEND_NONE);
+	proxy_material.set_depth_mode(ZBUFFER_TYPE_READ);
+	proxy_material.set_cull_mode(false);
+
+	vertex_layout layout;
+	layout.add_vertex_component(vertex_format_data::POSITION3, sizeof(vec3d), 0);
+
+	// the boxes must only touch the queries, not the frame
+	int color_buffer = gr_set_color_buffer(0);
+
+	for (auto objnum : Occlusion_test_objects) {
+		object* objp = &Objects[objnum];
+		auto& state = Occlusion_states[objnum];
+
+		vec3d mins, maxs;
+		obj_occlusion_get_box(objp, &mins, &maxs);
+
+		// if the viewer is inside the box the faces would be clipped by the near plane so the object can't be hidden
+		vec3d rel, local_eye;
+		vm_vec_sub(&rel, &View_position, &objp->pos);
+		vm_vec_rotate(&local_eye, &rel, &objp->orient);
+
+		if (local_eye.xyz.x > mins.xyz.x - Min_draw_distance && local_eye.xyz.x < maxs.xyz.x + Min_draw_distance
+			&& local_eye.xyz.y > mins.xyz.y - Min_draw_distance && local_eye.xyz.y < maxs.xyz.y + Min_draw_distance
+			&& local_eye.xyz.z > mins.xyz.z - Min_draw_distance && local_eye.xyz.z < maxs.xyz.z + Min_draw_distance) {
+			state.hidden = false;
+			continue;
+		}
+
+		if (state.query < 0) {
+			state.query = gr_create_query_object();
+
+			if (state.query < 0) {
+				continue;
+			}
+		}
+
+		vec3d corners[8];
+		for (int i = 0; i < 8; ++i) {
+			vec3d local;
+			local.xyz.x = (i & 1) ? maxs.xyz.x : mins.xyz.x;
+			local.xyz.y = (i & 2) ? maxs.xyz.y : mins.xyz.y;
+			local.xyz.z = (i & 4) ? maxs.xyz.z : mins.xyz.z;
+
+			vm_vec_unrotate(&corners[i], &local, &objp->orient);
+			vm_vec_add2(&corners[i], &objp->pos);
+		}
+
+		vec3d verts[36];
+		int n_verts = 0;
+		for (auto& face : Occlusion_box_faces) {
+			verts[n_verts++] = corners[face[0]];
+			verts[n_verts++] = corners[face[1]];
+			verts[n_verts++] = corners[face[2]];
+
+			verts[n_verts++] = corners[face[0]];
+			verts[n_verts++] = corners[face[2]];
+			verts[n_verts++] = corners[face[3]];
+		}
+
+		gr_begin_query(state.query, QueryType::Occlusion);
+		gr_render_primitives_immediate(&proxy_material, PRIM_TYPE_TRIS, &layout, n_verts, verts, (int)sizeof(verts));
+		gr_end_query(state.query);
+
+		state.query_pending = true;
+	}
+
+	gr_set_color_buffer(color_buffer);
+
+	Occlusion_test_objects.clear();
+}
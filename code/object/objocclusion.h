@@ -0,0 +1,36 @@
+#ifndef _OBJOCCLUSION_H
+#define _OBJOCCLUSION_H
+#pragma once
+
+class object;
+
+/** @file
+ *  GPU occlusion culling of objects.
+ *
+ *  After the opaque geometry of a frame has been rendered the bounding box of every tested object is drawn against the
+ *  depth buffer inside an occlusion query. Once the GPU has the result of such a query it decides if the object is
+ *  drawn in the following frames. Results are never waited on so an object may be culled or shown one or two frames
+ *  late but the CPU never stalls on the GPU.
+ */
+
+void obj_occlusion_level_init();
+void obj_occlusion_level_close();
+
+/**
+ * @brief Checks if an object in the view cone is hidden behind other geometry
+ *
+ * The object is also scheduled for the occlusion tests of this frame.
+ *
+ * @param objp The object to check
+ * @return @c true if the last occlusion test of the object found it to be completely hidden
+ */
+bool obj_occlusion_cull(object* objp);
+
+/**
+ * @brief Draws the bounding boxes of the objects scheduled in this frame inside occlusion queries
+ *
+ * @note Must be called once the opaque geometry of the scene has been rendered
+ */
+void obj_occlusion_render_queries();
+
+#endif // _OBJOCCLUSION_H
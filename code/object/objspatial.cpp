@@ -0,0 +1,220 @@
+#include "object/objspatial.h"
+
+#include "debugconsole/console.h"
+#include "globalincs/jobs.h"
+#include "globalincs/linklist.h"
+#include "globalincs/systemvars.h"
+#include "iff_defs/iff_defs.h"
+#include "object/object.h"
+#include "ship/ship.h"
+#include "tracing/Monitor.h"
+
+#include <algorithm>
+#include <cstdint>
+
+extern float flFrametime;
+
+// the edge length of the grid cells, ships with a bigger radius are kept in a separate list
+#define OBJ_SPATIAL_CELL_SIZE		2000.0f
+
+// cells further out than this along one axis share the cells at the edge
+#define OBJ_SPATIAL_MAX_CELL_COORD	((1 << 20) - 1)
+
+typedef struct spatial_entry {
+	std::uint64_t key;
+	int order;			// position in Ship_obj_list
+	int objnum;
+	int signature;
+} spatial_entry;
+
+static SCP_vector<spatial_entry> Spatial_entries;	// sorted by cell
+static SCP_vector<spatial_entry> Spatial_large;		// the ships which are too big for the cells
+static SCP_vector<int> Spatial_order_objnums;		// the object numbers by position in Ship_obj_list
+
+// the frame the index was built in, -1 if it has to be built again
+static int Spatial_frame = -1;
+
+// the biggest radius in the cells and the distance a ship may have moved since the index was built
+static float Spatial_max_radius = 0.0f;
+static float Spatial_move_pad = 0.0f;
+
+static bool Spatial_index_enabled = true;
+DCF_BOOL(ship_spatial_index, Spatial_index_enabled)
+
+MONITOR(SpatialQueries)
+MONITOR(SpatialQueryShips)
+
+static inline int obj_spatial_cell_coord(float pos)
+{
+	float coord = floorf(pos * (1.0f / OBJ_SPATIAL_CELL_SIZE));
+
+	return (int)MIN(MAX(coord, (float)-OBJ_SPATIAL_MAX_CELL_COORD), (float)OBJ_SPATIAL_MAX_CELL_COORD);
+}
+
+// unlike the collision hash the coordinates are offset instead of masked, so the cells of a row along z have
+// consecutive keys
+static inline std::uint64_t obj_spatial_cell_key(int x, int y, int z)
+{
+	const std::uint64_t offset = OBJ_SPATIAL_MAX_CELL_COORD + 1;
+
+	return (((std::uint64_t)x + offset) << 42) | (((std::uint64_t)y + offset) << 21) | ((std::uint64_t)z + offset);
+}
+
+static void obj_spatial_build()
+{
+	ship_obj *so;
+	int order = 0;
+	float max_speed = 0.0f;
+
+	Spatial_entries.clear();
+	Spatial_large.clear();
+	Spatial_order_objnums.clear();
+	Spatial_max_radius = 0.0f;
+
+	for ( so = GET_FIRST(&Ship_obj_list); so != END_OF_LIST(&Ship_obj_list); so = GET_NEXT(so) ) {
+		object *objp = &Objects[so->objnum];
+		physics_info *pi = &objp->phys_info;
+
+		spatial_entry entry;
+		entry.order = order++;
+		entry.objnum = so->objnum;
+		entry.signature = objp->signature;
+
+		Spatial_order_objnums.push_back(so->objnum);
+
+		max_speed = MAX(max_speed, vm_vec_mag(&pi->vel));
+		max_speed = MAX(max_speed, MAX(pi->max_vel.xyz.z, MAX(pi->afterburner_max_vel.xyz.z, pi->booster_max_vel.xyz.z)));
+
+		if (objp->radius > OBJ_SPATIAL_CELL_SIZE) {
+			entry.key = 0;
+			Spatial_large.push_back(entry);
+		} else {
+			entry.key = obj_spatial_cell_key(obj_spatial_cell_coord(objp->pos.xyz.x), obj_spatial_cell_coord(objp->pos.xyz.y), obj_spatial_cell_coord(objp->pos.xyz.z));
+			Spatial_entries.push_back(entry);
+
+			Spatial_max_radius = MAX(Spatial_max_radius, objp->radius);
+		}
+	}
+
+	std::sort(Spatial_entries.begin(), Spatial_entries.end(),
+		[](const spatial_entry& a, const spatial_entry& b) { return a.key < b.key; });
+
+	// twice what the fastest ship could cover in this frame, in case it is accelerating
+	Spatial_move_pad = 2.0f * max_speed * flFrametime;
+	Spatial_frame = Framecount;
+}
+
+static inline bool obj_spatial_test(const spatial_entry &entry, const vec3d *pos, float range, int team_mask)
+{
+	object *objp = &Objects[entry.objnum];
+
+	// the ship may have been deleted since the index was built
+	if ((objp->signature != entry.signature) || (objp->type != OBJ_SHIP))
+		return false;
+
+	if (!iff_matches_mask(Ships[objp->instance].team, team_mask))
+		return false;
+
+	// twice the radius covers the corners of the bounding box
+	float reach = range + 2.0f * objp->radius;
+
+	return vm_vec_dist_squared(pos, &objp->pos) <= reach * reach;
+}
+
+void obj_spatial_invalidate()
+{
+	Spatial_frame = -1;
+}
+
+void obj_spatial_prepare()
+{
+	if (Spatial_index_enabled && (Spatial_frame != Framecount)) {
+		obj_spatial_build();
+	}
+}
+
+void obj_spatial_find_ships(const vec3d *pos, float range, int team_mask, SCP_vector<int> &objnums)
+{
+	objnums.clear();
+
+	// the monitors are only counted on the main thread, the other threads only ever query a prepared index
+	bool main_thread = !jobs::is_worker_thread();
+
+	if (main_thread) {
+		MONITOR_INC(SpatialQueries, 1);
+	}
+
+	if (!Spatial_index_enabled) {
+		ship_obj *so;
+
+		for ( so = GET_FIRST(&Ship_obj_list); so != END_OF_LIST(&Ship_obj_list); so = GET_NEXT(so) ) {
+			if (iff_matches_mask(Ships[Objects[so->objnum].instance].team, team_mask)) {
+				objnums.push_back(so->objnum);
+			}
+		}
+
+		if (main_thread) {
+			MONITOR_INC(SpatialQueryShips, (int)objnums.size());
+		}
+		return;
+	}
+
+	if (Spatial_frame != Framecount) {
+		Assertion(main_thread, "The spatial index must be prepared before it is queried by a worker thread!");
+		obj_spatial_build();
+	}
+
+	// the positions of the ships in Ship_obj_list are collected first and turned into object numbers once they are sorted
+
+	// the cells hold the centers of the ships
+	float reach = range + 2.0f * Spatial_max_radius + Spatial_move_pad;
+
+	int cell_min[3], cell_max[3];
+	for (int axis = 0; axis < 3; axis++) {
+		cell_min[axis] = obj_spatial_cell_coord(pos->a1d[axis] - reach);
+		cell_max[axis] = obj_spatial_cell_coord(pos->a1d[axis] + reach);
+	}
+
+	std::uint64_t num_rows = (std::uint64_t)(cell_max[0] - cell_min[0] + 1) * (std::uint64_t)(cell_max[1] - cell_min[1] + 1);
+
+	if (num_rows > Spatial_entries.size()) {
+		// searching the rows would take longer than testing every ship
+		for (auto &entry : Spatial_entries) {
+			if (obj_spatial_test(entry, pos, range, team_mask)) {
+				objnums.push_back(entry.order);
+			}
+		}
+	} else {
+		for (int x = cell_min[0]; x <= cell_max[0]; x++) {
+			for (int y = cell_min[1]; y <= cell_max[1]; y++) {
+				std::uint64_t first_key = obj_spatial_cell_key(x, y, cell_min[2]);
+				std::uint64_t last_key = obj_spatial_cell_key(x, y, cell_max[2]);
+
+				auto it = std::lower_bound(Spatial_entries.begin(), Spatial_entries.end(), first_key,
+					[](const spatial_entry& entry, std::uint64_t key) { return entry.key < key; });
+
+				for (; (it != Spatial_entries.end()) && (it->key <= last_key); ++it) {
+					if (obj_spatial_test(*it, pos, range, team_mask)) {
+						objnums.push_back(it->order);
+					}
+				}
+			}
+		}
+	}
+
+	for (auto &entry : Spatial_large) {
+		if (obj_spatial_test(entry, pos, range, team_mask)) {
+			objnums.push_back(entry.order);
+		}
+	}
+
+	std::sort(objnums.begin(), objnums.end());
+
+	for (auto &objnum : objnums) {
+		objnum = Spatial_order_objnums[objnum];
+	}
+
+	if (main_thread) {
+		MONITOR_INC(SpatialQueryShips, (int)objnums.size());
+	}
+}
@@ -0,0 +1,45 @@
+#ifndef _OBJSPATIAL_H
+#define _OBJSPATIAL_H
+#pragma once
+
+#include "globalincs/pstypes.h"
+
+/** @file
+ *  Spatial index of the ships for proximity queries.
+ *
+ *  The ships are sorted into a uniform grid the first time a query is made in a frame, and again whenever a ship is
+ *  added to Ship_obj_list. Queries look at the cells which cover the query sphere, grown by the distance the fastest
+ *  ship can move in a frame, and test the current positions of the ships they find. Ships which are too big for the
+ *  cells are always tested. A ship which is teleported after the index was built is found from the next frame on.
+ */
+
+/**
+ * @brief Forgets the index so the next query builds it again
+ */
+void obj_spatial_invalidate();
+
+/**
+ * @brief Builds the index if it is out of date
+ *
+ * Queries from worker threads don't build the index themselves, so this has to be called on the main thread before
+ * they are started.
+ */
+void obj_spatial_prepare();
+
+/**
+ * @brief Finds the ships which may be within a distance of a point
+ *
+ * The test is conservative: every ship whose bounding box comes within @a range of @a pos is returned, together with
+ * some ships which are a bit further away. The ships are returned in the order of Ship_obj_list, so a caller which
+ * picks the best candidate gets the same result as when it walks the whole list.
+ *
+ * Several threads may query the index at the same time once obj_spatial_prepare() was called for this frame.
+ *
+ * @param pos The point
+ * @param range The distance from the point
+ * @param team_mask Only ships of teams matching this IFF mask are returned
+ * @param objnums Receives the object numbers of the ships
+ */
+void obj_spatial_find_ships(const vec3d *pos, float range, int team_mask, SCP_vector<int> &objnums);
+
+#endif // _OBJSPATIAL_H
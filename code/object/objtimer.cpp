@@ -0,0 +1,267 @@
+#include "object/objtimer.h"
+
+#include "io/timer.h"
+#include "object/object.h"
+#include "tracing/Monitor.h"
+
+#include <algorithm>
+
+namespace {
+
+const int WHEEL_BITS = 6;
+const int WHEEL_SLOTS = 1 << WHEEL_BITS;
+const int WHEEL_LEVELS = 4;
+
+const int OVERFLOW_LIST = WHEEL_LEVELS * WHEEL_SLOTS;
+const int DUE_LIST = OVERFLOW_LIST + 1;
+const int NUM_LISTS = DUE_LIST + 1;
+
+// when the timestamps moved back or further than this the timers are sorted again instead of stepping through the
+// slots of every millisecond
+const int MAX_STEP_TIME = WHEEL_SLOTS * WHEEL_SLOTS;
+
+// a handle is the index of the timer and its generation so the handles of timers which already ran don't match
+const int HANDLE_INDEX_BITS = 16;
+const int HANDLE_INDEX_MASK = (1 << HANDLE_INDEX_BITS) - 1;
+const int HANDLE_GENERATION_MASK = 0x7fff;
+
+struct obj_timer {
+	int stamp = 0;
+	obj_timer_func func = nullptr;
+	int data = 0;
+	int objnum = -1;
+	int signature = 0;
+
+	int generation = 0;
+	int list = -1;			// -1 if the timer is not used
+	int prev = -1;
+	int next = -1;
+};
+
+SCP_vector<obj_timer> Obj_timers;
+int Obj_timer_free = -1;
+
+int List_heads[NUM_LISTS];
+int List_tails[NUM_LISTS];
+
+// the last millisecond the timers were run for
+int Wheel_time = 0;
+
+void list_append(int list, int index)
+{
+	auto& timer = Obj_timers[index];
+
+	timer.list = list;
+	timer.prev = List_tails[list];
+	timer.next = -1;
+
+	if (List_tails[list] >= 0) {
+		Obj_timers[List_tails[list]].next = index;
+	} else {
+		List_heads[list] = index;
+	}
+	List_tails[list] = index;
+}
+
+void list_remove(int index)
+{
+	auto& timer = Obj_timers[index];
+
+	if (timer.prev >= 0) {
+		Obj_timers[timer.prev].next = timer.next;
+	} else {
+		List_heads[timer.list] = timer.next;
+	}
+	if (timer.next >= 0) {
+		Obj_timers[timer.next].prev = timer.prev;
+	} else {
+		List_tails[timer.list] = timer.prev;
+	}
+
+	timer.list = -1;
+	timer.prev = -1;
+	timer.next = -1;
+}
+
+void free_timer(int index)
+{
+	auto& timer = Obj_timers[index];
+
+	timer.generation = (timer.generation + 1) & HANDLE_GENERATION_MASK;
+	timer.next = Obj_timer_free;
+	Obj_timer_free = index;
+}
+
+// the list a timer goes into, a timer due before the given time is put into the slot of that time
+int list_for(int stamp, int earliest)
+{
+	stamp = std::max(stamp, earliest);
+	int delta = stamp - Wheel_time;
+
+	for (int level = 0; level < WHEEL_LEVELS; ++level) {
+		if (delta < (1 << (WHEEL_BITS * (level + 1)))) {
+			return level * WHEEL_SLOTS + ((stamp >> (WHEEL_BITS * level)) & (WHEEL_SLOTS - 1));
+		}
+	}
+
+	return OVERFLOW_LIST;
+}
+
+// moves the timers of a slot to a lower level, the order of the timers is kept
+void relist(int list)
+{
+	int index = List_heads[list];
+	List_heads[list] = -1;
+	List_tails[list] = -1;
+
+	while (index >= 0) {
+		int next = Obj_timers[index].next;
+		list_append(list_for(Obj_timers[index].stamp, Wheel_time), index);
+		index = next;
+	}
+}
+
+// called when Wheel_time is the first millisecond of a slot of this level
+void cascade(int level)
+{
+	if (level == WHEEL_LEVELS) {
+		relist(OVERFLOW_LIST);
+		return;
+	}
+
+	int slot = (Wheel_time >> (WHEEL_BITS * level)) & (WHEEL_SLOTS - 1);
+	relist(level * WHEEL_SLOTS + slot);
+
+	if (slot == 0) {
+		cascade(level + 1);
+	}
+}
+
+MONITOR(NumObjTimersRun)
+
+void run_list(int list)
+{
+	while (List_heads[list] >= 0) {
+		int index = List_heads[list];
+		list_remove(index);
+
+		// the timer may schedule a new one which takes this slot
+		auto timer = Obj_timers[index];
+		free_timer(index);
+
+		auto objp = &Objects[timer.objnum];
+		if (objp->signature != timer.signature || objp->type == OBJ_NONE
+			|| objp->flags[Object::Object_Flags::Should_be_dead]) {
+			continue;
+		}
+
+		MONITOR_INC(NumObjTimersRun, 1);
+		timer.func(objp, timer.data);
+	}
+}
+
+// puts all timers into the slots for the new time, the ones which are due then are run in the order of their stamps
+void resort(int now)
+{
+	SCP_vector<int> timers;
+	for (int list = 0; list < DUE_LIST; ++list) {
+		for (int index = List_heads[list]; index >= 0; index = Obj_timers[index].next) {
+			timers.push_back(index);
+		}
+		List_heads[list] = -1;
+		List_tails[list] = -1;
+	}
+
+	std::stable_sort(timers.begin(), timers.end(), [](int a, int b) {
+		return Obj_timers[a].stamp < Obj_timers[b].stamp;
+	});
+
+	Wheel_time = now;
+
+	for (auto index : timers) {
+		list_append(Obj_timers[index].stamp <= now ? DUE_LIST : list_for(Obj_timers[index].stamp, now + 1), index);
+	}
+
+	run_list(DUE_LIST);
+}
+
+}
+
+int obj_timer_schedule(object* objp, int stamp, obj_timer_func func, int data)
+{
+	Assertion(objp != nullptr && func != nullptr, "A timer needs an object and a function!");
+
+	if (!timestamp_valid(stamp)) {
+		return -1;
+	}
+
+	int index;
+	if (Obj_timer_free >= 0) {
+		index = Obj_timer_free;
+		Obj_timer_free = Obj_timers[index].next;
+	} else {
+		Assertion(Obj_timers.size() <= (size_t)HANDLE_INDEX_MASK, "Too many object timers!");
+		index = (int)Obj_timers.size();
+		Obj_timers.emplace_back();
+	}
+
+	auto& timer = Obj_timers[index];
+	timer.stamp = stamp;
+	timer.func = func;
+	timer.data = data;
+	timer.objnum = OBJ_INDEX(objp);
+	timer.signature = objp->signature;
+
+	list_append(list_for(stamp, Wheel_time + 1), index);
+
+	return (timer.generation << HANDLE_INDEX_BITS) | index;
+}
+
+void obj_timer_cancel(int* handle)
+{
+	if (*handle < 0) {
+		return;
+	}
+
+	int index = *handle & HANDLE_INDEX_MASK;
+	int generation = *handle >> HANDLE_INDEX_BITS;
+	*handle = -1;
+
+	if (index >= (int)Obj_timers.size() || Obj_timers[index].generation != generation || Obj_timers[index].list < 0) {
+		return;
+	}
+
+	list_remove(index);
+	free_timer(index);
+}
+
+void obj_timer_process_all()
+{
+	int now = timestamp();
+
+	if (now < Wheel_time || now - Wheel_time > MAX_STEP_TIME) {
+		resort(now);
+		return;
+	}
+
+	while (Wheel_time < now) {
+		++Wheel_time;
+
+		if ((Wheel_time & (WHEEL_SLOTS - 1)) == 0) {
+			cascade(1);
+		}
+
+		run_list(Wheel_time & (WHEEL_SLOTS - 1));
+	}
+}
+
+void obj_timer_reset()
+{
+	Obj_timers.clear();
+	Obj_timer_free = -1;
+
+	std::fill(std::begin(List_heads), std::end(List_heads), -1);
+	std::fill(std::begin(List_tails), std::end(List_tails), -1);
+
+	Wheel_time = timestamp();
+}
@@ -0,0 +1,56 @@
+#ifndef _OBJTIMER_H
+#define _OBJTIMER_H
+#pragma once
+
+class object;
+
+/** @file
+ *  Timers of the objects which run a function when their timestamp elapses.
+ *
+ *  Instead of every object checking its own timestamps every frame the timers are kept in a hierarchical timer wheel:
+ *  four levels of 64 slots each cover one millisecond per slot at the lowest level up to about 4.6 hours per slot at
+ *  the highest, later timers wait in an overflow list. A timer is moved to the next lower level when the slot it is in
+ *  comes up, so only the timers of the milliseconds which passed in a frame are touched.
+ *
+ *  A timer belongs to an object and is dropped when the object is gone by the time it elapses. The order the timers of
+ *  one millisecond are run in is the order they were scheduled in.
+ */
+
+/**
+ * @brief Function run when a timer elapses
+ *
+ * @param objp The object of the timer, it still exists
+ * @param data The value the timer was scheduled with
+ */
+typedef void (*obj_timer_func)(object* objp, int data);
+
+/**
+ * @brief Schedules a timer
+ *
+ * @param objp The object the timer belongs to
+ * @param stamp The timestamp at which the timer elapses, see timestamp(). A timestamp which has already elapsed runs
+ * the timer in the next obj_timer_process_all().
+ * @param func The function to run
+ * @param data Passed to the function
+ * @return The handle of the timer for obj_timer_cancel(), -1 if the stamp is invalid
+ */
+int obj_timer_schedule(object* objp, int stamp, obj_timer_func func, int data = 0);
+
+/**
+ * @brief Removes a timer before it elapses
+ *
+ * @param handle The handle of the timer, it is set to -1. Handles of timers which already ran are ignored.
+ */
+void obj_timer_cancel(int* handle);
+
+/**
+ * @brief Runs the timers which elapsed since the last call, once per frame after the timestamps were advanced
+ */
+void obj_timer_process_all();
+
+/**
+ * @brief Removes all timers, done in obj_init()
+ */
+void obj_timer_reset();
+
+#endif // _OBJTIMER_H
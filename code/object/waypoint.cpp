@@ -5,6 +5,8 @@
 #include "object/object.h"
 #include "object/waypoint.h"
 
+#include <algorithm>
+
 //********************GLOBALS********************
 SCP_list<waypoint_list> Waypoint_lists;
 
@@ -91,21 +93,29 @@ SCP_vector<waypoint> &waypoint_list::get_waypoints()
 	return waypoints;
 }
 
+// the lists by their lower case names, rebuilt on the next lookup after a list was added, removed or renamed
+static SCP_unordered_map<SCP_string, waypoint_list*> Waypoint_list_index;
+static bool Waypoint_list_index_dirty = true;
+
 void waypoint_list::set_name(const char *name)
 {
 	Assert(name != NULL);
 	strcpy_s(this->m_name, name);
+
+	Waypoint_list_index_dirty = true;
 }
 
 //********************FUNCTIONS********************
 void waypoint_parse_init()
 {
 	Waypoint_lists.clear();
+	Waypoint_list_index_dirty = true;
 }
 
 void waypoint_level_close()
 {
 	Waypoint_lists.clear();
+	Waypoint_list_index_dirty = true;
 }
 
 int calc_waypoint_instance(int waypoint_list_index, int waypoint_index)
@@ -168,13 +178,30 @@ waypoint_list *find_matching_waypoint_list(const char *name)
 	Assert(name != NULL);
 	SCP_list<waypoint_list>::iterator ii;
 
-	for (ii = Waypoint_lists.begin(); ii != Waypoint_lists.end(); ++ii)
+	if (Waypoint_list_index_dirty)
 	{
-		if (!stricmp(ii->get_name(), name))
-			return &(*ii);
+		Waypoint_list_index.clear();
+
+		for (ii = Waypoint_lists.begin(); ii != Waypoint_lists.end(); ++ii)
+		{
+			SCP_string key = ii->get_name();
+			std::transform(key.begin(), key.end(), key.begin(), ::tolower);
+
+			// the first list of a name wins, like the search this replaces
+			Waypoint_list_index.emplace(key, &(*ii));
+		}
+
+		Waypoint_list_index_dirty = false;
 	}
 
-	return NULL;
+	SCP_string key = name;
+	std::transform(key.begin(), key.end(), key.begin(), ::tolower);
+
+	auto iter = Waypoint_list_index.find(key);
+	if (iter == Waypoint_list_index.end())
+		return NULL;
+
+	return iter->second;
 }
 
 // NOTE: waypoint names are always in the format Name:index
@@ -386,6 +413,7 @@ void waypoint_add_list(const char *name, SCP_vector<vec3d> &vec_list)
 	waypoint_list new_list(name);
 	Waypoint_lists.push_back(new_list);
 	waypoint_list *wp_list = &Waypoint_lists.back();
+	Waypoint_list_index_dirty = true;
 
 	wp_list->get_waypoints().reserve(vec_list.size());
 	SCP_vector<vec3d>::iterator ii;
@@ -418,6 +446,7 @@ int waypoint_add(vec3d *pos, int waypoint_instance)
 		waypoint_list new_list(buf);
 		Waypoint_lists.push_back(new_list);
 		wp_list = &Waypoint_lists.back();
+		Waypoint_list_index_dirty = true;
 
 		// set up references
 		wp_list_index = (int)(Waypoint_lists.size() - 1);
@@ -482,6 +511,7 @@ void waypoint_remove(waypoint *wpt)
 		if (Waypoint_lists.size() == 1)
 		{
 			Waypoint_lists.clear();
+			Waypoint_list_index_dirty = true;
 		}
 		// shift the other waypoint lists down
 		else
@@ -494,6 +524,7 @@ void waypoint_remove(waypoint *wpt)
 				if (i == this_list)
 				{
 					Waypoint_lists.erase(ii);
+					Waypoint_list_index_dirty = true;
 					break;
 				}
 			}
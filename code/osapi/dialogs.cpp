@@ -11,6 +11,8 @@
 
 #include <string>
 #include <algorithm>
+#include <mutex>
+#include <thread>
 
 extern "C" {
 #include <lauxlib.h>
@@ -22,6 +24,18 @@ namespace
 	const char* Separator = "------------------------------------------------------------------\n";
 
 	const int Messagebox_lines = 30;
+
+	// Tables may be parsed on worker threads so warnings can come from several threads at once. Only one message box is
+	// shown at a time and only the main thread may touch the window.
+	std::recursive_mutex Messagebox_mutex;
+	const std::thread::id Main_thread_id = std::this_thread::get_id();
+
+	void activate_main_window(int active)
+	{
+		if (std::this_thread::get_id() == Main_thread_id) {
+			gr_activate(active);
+		}
+	}
 	
 	template<typename Stream>
 	void LuaDebugPrint(Stream& stream, lua_Debug &ar)
@@ -215,6 +229,7 @@ namespace os
 			msgStream << Separator;
 
 			mprintf(("Lua Error: %s\n", msgStream.str().c_str()));
+			outwnd_flush();
 
 			if (Cmdline_noninteractive) {
 				exit(1);
@@ -299,6 +314,7 @@ namespace os
 		void Error(const char* text)
 		{
 			mprintf(("\n%s\n", text));
+			outwnd_flush();
 
 			if (Cmdline_noninteractive) {
 				abort();
@@ -309,6 +325,8 @@ namespace os
 				throw ErrorException(text);
 			}
 
+			std::lock_guard<std::recursive_mutex> lock(Messagebox_mutex);
+
 			SCP_stringstream messageStream;
 			messageStream << text << "\n";
 			messageStream << dump_stacktrace();
@@ -337,7 +355,7 @@ namespace os
 			boxData.title = "Error!";
 			boxData.window = os::getSDLMainWindow();
 
-			gr_activate(0);
+			activate_main_window(0);
 
 			int buttonId;
 			if (SDL_ShowMessageBox(&boxData, &buttonId) < 0)
@@ -355,7 +373,7 @@ namespace os
 				Int3();
 				break;
 			}
-			gr_activate(1);
+			activate_main_window(1);
 		}
 
 		// Actual implementation of the warning function. Used by the various warning functions
@@ -369,6 +387,7 @@ namespace os
 			std::transform(printfString.begin(), printfString.end(), printfString.begin(), replaceNewline);
 
 			mprintf(("WARNING: \"%s\" at %s:%d\n", printfString.c_str(), filename, line));
+			outwnd_flush();
 
 			// now go for the additional popup window, if we want it ...
 			if (Cmdline_noninteractive) {
@@ -379,6 +398,8 @@ namespace os
 				throw WarningException(printfString);
 			}
 
+			std::lock_guard<std::recursive_mutex> lock(Messagebox_mutex);
+
 			SCP_stringstream boxMsgStream;
 			boxMsgStream << "Warning: " << text << "\n";
 			boxMsgStream << "File: " << filename << "\n";
@@ -410,7 +431,7 @@ namespace os
 			boxData.title = "Warning!";
 			boxData.window = os::getSDLMainWindow();
 
-			gr_activate(0);
+			activate_main_window(0);
 
 			int buttonId;
 			if (SDL_ShowMessageBox(&boxData, &buttonId) < 0)
@@ -432,7 +453,7 @@ namespace os
 				break;
 			}
 
-			gr_activate(1);
+			activate_main_window(1);
 		}
 
 
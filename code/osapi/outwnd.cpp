@@ -14,6 +14,9 @@
 #include <stdio.h>
 #include <stdarg.h>
 #include <string.h>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
 
 #include "osapi/DebugWindow.h"
 #include "osapi/osapi.h"
@@ -31,6 +34,9 @@ struct outwnd_filter_struct {
 
 SCP_vector<outwnd_filter_struct> OutwndFilter;
 
+// the filter last found for a category string, almost all categories are string literals so the pointer identifies them
+static SCP_unordered_map<const char*, size_t> Outwnd_filter_ids;
+
 void outwnd_print(const char *id = NULL, const char *temp = NULL);
 
 ubyte Outwnd_no_filter_file = 0;		// 0 = .cfg file found, 1 = not found and warning not printed yet, 2 = not found and warning printed
@@ -45,6 +51,106 @@ const char *FreeSpace_logfilename = NULL;
 
 std::unique_ptr<osapi::DebugWindow> debugWindow;
 
+// messages may be printed from worker threads, recursive since the first message prints the missing filter notice
+static std::recursive_mutex Outwnd_mutex;
+
+// The log file is written by a thread of its own. The messages are queued up and the writer thread writes and flushes
+// everything which has come in since it last woke up in one go. outwnd_flush() writes the queue right away.
+static std::mutex Outwnd_queue_mutex;
+static std::condition_variable Outwnd_queue_cond;
+static SCP_string Outwnd_queue;
+static bool Outwnd_writer_quit = false;
+
+// held while the queue is written to the file so the messages are written in the order they came in
+static std::mutex Outwnd_file_mutex;
+
+static void outwnd_write_queue()
+{
+	std::lock_guard<std::mutex> file_lock(Outwnd_file_mutex);
+
+	SCP_string text;
+	{
+		std::lock_guard<std::mutex> queue_lock(Outwnd_queue_mutex);
+		text.swap(Outwnd_queue);
+	}
+
+	if (!text.empty() && Log_fp != nullptr) {
+		fwrite(text.data(), 1, text.size(), Log_fp);
+		fflush(Log_fp);
+	}
+}
+
+static void outwnd_writer_main()
+{
+	for (;;) {
+		{
+			std::unique_lock<std::mutex> queue_lock(Outwnd_queue_mutex);
+			Outwnd_queue_cond.wait(queue_lock, []() { return Outwnd_writer_quit || !Outwnd_queue.empty(); });
+
+			if (Outwnd_writer_quit) {
+				return;
+			}
+		}
+
+		outwnd_write_queue();
+	}
+}
+
+// stops the writer thread when the program exits without calling outwnd_close()
+static struct outwnd_writer_thread {
+	std::thread thread;
+
+	void start()
+	{
+		Outwnd_writer_quit = false;
+		thread = std::thread(outwnd_writer_main);
+	}
+
+	void stop()
+	{
+		if (!thread.joinable()) {
+			return;
+		}
+
+		{
+			std::lock_guard<std::mutex> queue_lock(Outwnd_queue_mutex);
+			Outwnd_writer_quit = true;
+		}
+		Outwnd_queue_cond.notify_one();
+
+		thread.join();
+		outwnd_write_queue();
+	}
+
+	~outwnd_writer_thread()
+	{
+		stop();
+	}
+} Outwnd_writer;
+
+static void outwnd_queue_text(const char *text)
+{
+	bool was_empty;
+	{
+		std::lock_guard<std::mutex> queue_lock(Outwnd_queue_mutex);
+		was_empty = Outwnd_queue.empty();
+		Outwnd_queue.append(text);
+	}
+
+	if (was_empty) {
+		Outwnd_queue_cond.notify_one();
+	}
+}
+
+void outwnd_flush()
+{
+	if (running_unittests || !outwnd_inited) {
+		return;
+	}
+
+	outwnd_write_queue();
+}
+
 void load_filter_info(void)
 {
 	FILE *fp = NULL;
@@ -137,6 +243,54 @@ void save_filter_info(void)
 	}
 }
 
+// checks if the messages of a category are shown, Outwnd_mutex must be held
+static bool outwnd_filter_enabled(const char *id)
+{
+	size_t i;
+
+	if (Outwnd_no_filter_file == 1) {
+		Outwnd_no_filter_file = 2;
+
+		outwnd_print( "general", "==========================================================================\n" );
+		outwnd_print( "general", "DEBUG SPEW: No debug_filter.cfg found, so only general, error, and warning\n" );
+		outwnd_print( "general", "categories can be shown and no debug_filter.cfg info will be saved.\n" );
+		outwnd_print( "general", "==========================================================================\n" );
+	}
+
+	// the same pointer may still be a different category if it points to a buffer
+	auto cached = Outwnd_filter_ids.find(id);
+	if ( (cached != Outwnd_filter_ids.end()) && !stricmp(id, OutwndFilter[cached->second].name) ) {
+		return OutwndFilter[cached->second].enabled;
+	}
+
+	auto outwnd_size = OutwndFilter.size();
+
+	for (i = 0; i < OutwndFilter.size(); i++) {
+		if ( !stricmp(id, OutwndFilter[i].name) )
+			break;
+	}
+
+	// id found that isn't in the filter list yet
+	if ( i == outwnd_size ) {
+		// Only create new filters if there was a filter file
+		if (Outwnd_no_filter_file)
+			return false;
+
+		Assert( strlen(id)+1 < NAME_LENGTH );
+		outwnd_filter_struct new_filter;
+
+		strcpy_s(new_filter.name, id);
+		new_filter.enabled = true;
+
+		OutwndFilter.push_back( new_filter );
+		save_filter_info();
+	}
+
+	Outwnd_filter_ids[id] = i;
+
+	return OutwndFilter[i].enabled;
+}
+
 void outwnd_printf2(const char *format, ...)
 {
 	SCP_string temp;
@@ -145,6 +299,16 @@ void outwnd_printf2(const char *format, ...)
 	if (format == NULL)
 		return;
 
+	if ( running_unittests || !outwnd_inited )
+		return;
+
+	// don't bother formatting messages which aren't shown
+	{
+		std::lock_guard<std::recursive_mutex> lock(Outwnd_mutex);
+		if ( !outwnd_filter_enabled("General") )
+			return;
+	}
+
 	va_start(args, format);
 	vsprintf(temp, format, args);
 	va_end(args);
@@ -160,6 +324,15 @@ void outwnd_printf(const char *id, const char *format, ...)
 	if ( (id == NULL) || (format == NULL) )
 		return;
 
+	if ( running_unittests || !outwnd_inited )
+		return;
+
+	{
+		std::lock_guard<std::recursive_mutex> lock(Outwnd_mutex);
+		if ( !outwnd_filter_enabled(id) )
+			return;
+	}
+
 	va_start(args, format);
 	vsprintf(temp, format, args);
 	va_end(args);
@@ -169,8 +342,6 @@ void outwnd_printf(const char *id, const char *format, ...)
 
 void outwnd_print(const char *id, const char *tmp)
 {
-	size_t i;
-
 	if ( running_unittests ) {
 		// Ignore all messages when running unit tests
 		return;
@@ -182,45 +353,14 @@ void outwnd_print(const char *id, const char *tmp)
   	if ( !outwnd_inited )
   		return;
 
-	if (Outwnd_no_filter_file == 1) {
-		Outwnd_no_filter_file = 2;
+	std::lock_guard<std::recursive_mutex> lock(Outwnd_mutex);
 
-		outwnd_print( "general", "==========================================================================\n" );
-		outwnd_print( "general", "DEBUG SPEW: No debug_filter.cfg found, so only general, error, and warning\n" );
-		outwnd_print( "general", "categories can be shown and no debug_filter.cfg info will be saved.\n" );
-		outwnd_print( "general", "==========================================================================\n" );
-	}
-
-	auto outwnd_size = OutwndFilter.size();
-
-	for (i = 0; i < OutwndFilter.size(); i++) {
-		if ( !stricmp(id, OutwndFilter[i].name) )
-			break;
-	}
-
-	// id found that isn't in the filter list yet
-	if ( i == outwnd_size ) {
-		// Only create new filters if there was a filter file
-		if (Outwnd_no_filter_file)
-			return;
-
-		Assert( strlen(id)+1 < NAME_LENGTH );
-		outwnd_filter_struct new_filter;
-
-		strcpy_s(new_filter.name, id);
-		new_filter.enabled = true;
-
-		OutwndFilter.push_back( new_filter );
-		save_filter_info();
-	}
-
-	if ( !OutwndFilter[i].enabled )
+	if ( !outwnd_filter_enabled(id) )
 		return;
 
 	if (Log_debug_output_to_file) {
 		if (Log_fp != NULL) {
-			fputs(tmp, Log_fp);	
-			fflush(Log_fp);
+			outwnd_queue_text(tmp);
 		}
 	}
 
@@ -257,6 +397,10 @@ void outwnd_init()
 
 		outwnd_inited = Log_fp != nullptr;
 
+		if (outwnd_inited) {
+			Outwnd_writer.start();
+		}
+
 		if (Log_fp == NULL) {
 			fprintf(stderr, "Error opening %s\n", pathname);
 		} else {
@@ -282,6 +426,8 @@ void outwnd_close()
 
 		outwnd_printf("General", "... Log closed, %s\n", datestr);
 
+		Outwnd_writer.stop();
+
 		fclose(Log_fp);
 		Log_fp = NULL;
 	}
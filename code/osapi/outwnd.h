@@ -20,12 +20,19 @@ void outwnd_close();
 void outwnd_printf(const char *id, SCP_FORMAT_STRING const char *format, ...) SCP_FORMAT_STRING_ARGS(2, 3);
 void outwnd_printf2(SCP_FORMAT_STRING const char *format, ...) SCP_FORMAT_STRING_ARGS(1, 2);
 
+// the log file is written in the background, this writes everything which was printed so far right away
+void outwnd_flush();
+
 void outwnd_debug_window_init();
 void outwnd_debug_window_do_frame(float frametime);
 void outwnd_debug_window_deinit();
 
 extern int Log_debug_output_to_file;
 
+#else
+
+inline void outwnd_flush() {}
+
 #endif	// NDEBUG
 
 #endif	// _OUTWND_H
@@ -13,6 +13,16 @@
 #include <assert.h>
 #include <stdarg.h>
 #include <setjmp.h>
+#include <mutex>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#include <emmintrin.h>
+	#define PARSE_USE_SSE2
+#endif
+
+#ifdef _MSC_VER
+	#include <intrin.h>
+#endif
 
 #include "ctype.h"
 #include "globalincs/version.h"
@@ -22,7 +32,9 @@
 #include "parse/encrypt.h"
 #include "parse/parselo.h"
 #include "parse/sexp.h"
+#include "parse/tablecache.h"
 #include "ship/ship.h"
+#include "tracing/StartupProfiler.h"
 #include "weapon/weapon.h"
 
 
@@ -31,28 +43,137 @@
 #define	RS_MAX_TRIES	5
 #define SHARP_S			(char)-33
 
+// The state of a parse is kept per thread so independent tables can be parsed on several threads at once
+
 // to know that a modular table is currently being parsed
-bool	Parsing_modular_table = false;
+SCP_THREAD_LOCAL bool	Parsing_modular_table = false;
 
-char		Current_filename[MAX_PATH_LEN];
-char		Current_filename_save[MAX_PATH_LEN];
-char		Current_filename_sub[MAX_PATH_LEN];	//Last attempted file to load, don't know if ex or not.
-char		Error_str[ERROR_LENGTH];
-int		Warning_count, Error_count;
-int		Warning_count_save = 0, Error_count_save = 0;
-int		fred_parse_flag = 0;
-int		Token_found_flag;
+SCP_THREAD_LOCAL char		Current_filename[MAX_PATH_LEN];
+SCP_THREAD_LOCAL char		Current_filename_save[MAX_PATH_LEN];
+SCP_THREAD_LOCAL char		Current_filename_sub[MAX_PATH_LEN];	//Last attempted file to load, don't know if ex or not.
+SCP_THREAD_LOCAL char		Error_str[ERROR_LENGTH];
+SCP_THREAD_LOCAL int		Warning_count, Error_count;
+SCP_THREAD_LOCAL int		Warning_count_save = 0, Error_count_save = 0;
+SCP_THREAD_LOCAL int		fred_parse_flag = 0;
+SCP_THREAD_LOCAL int		Token_found_flag;
 
-char 	*Mission_text = NULL;
-char	*Mission_text_raw = NULL;
-char	*Mp = NULL, *Mp_save = NULL;
-const char	*token_found;
+SCP_THREAD_LOCAL char 	*Mission_text = NULL;
+SCP_THREAD_LOCAL char	*Mission_text_raw = NULL;
+SCP_THREAD_LOCAL char	*Mp = NULL, *Mp_save = NULL;
+SCP_THREAD_LOCAL const char	*token_found;
 
-static int Parsing_paused = 0;
+static SCP_THREAD_LOCAL int Parsing_paused = 0;
 
 // text allocation stuff
 void allocate_mission_text(size_t size);
-static size_t Mission_text_size = 0;
+static SCP_THREAD_LOCAL size_t Mission_text_size = 0;
+
+// Scanning primitives for the loops which go through the text character by character. With SSE2 they test 16
+// characters at once. The text always ends with a character which stops every scan (EOF_CHAR or the null terminator).
+#ifdef PARSE_USE_SSE2
+static inline int first_set_bit(int mask)
+{
+#ifdef _MSC_VER
+	unsigned long index;
+	_BitScanForward(&index, (unsigned long)mask);
+	return (int)index;
+#else
+	return __builtin_ctz((unsigned int)mask);
+#endif
+}
+
+// Returns the first character for which the mask of stop_mask has its bit set. The loads are aligned so they never
+// reach into a page past the end of the text, the bits of the characters before str are cleared.
+template <typename StopMask>
+static inline const char *scan_until(const char *str, StopMask stop_mask)
+{
+	auto offset = (int)((uintptr_t)str & 15);
+	auto block = reinterpret_cast<const __m128i *>(str - offset);
+
+	int mask = stop_mask(_mm_load_si128(block)) & ((0xFFFF << offset) & 0xFFFF);
+	while (mask == 0) {
+		++block;
+		mask = stop_mask(_mm_load_si128(block));
+	}
+
+	return reinterpret_cast<const char *>(block) + first_set_bit(mask);
+}
+
+static inline __m128i match_char(__m128i chars, char ch)
+{
+	return _mm_cmpeq_epi8(chars, _mm_set1_epi8(ch));
+}
+#endif
+
+// Compares the start of text with str, the first character is checked before calling strnicmp() since most lines
+// already differ there
+static inline bool starts_with_nocase(const char *text, const char *str, size_t len)
+{
+	if (len == 0)
+		return true;
+
+	if (tolower((unsigned char)*text) != tolower((unsigned char)*str))
+		return false;
+
+	return !strnicmp(str, text, len);
+}
+
+// Skips spaces, tabs and line ends
+static inline char *scan_white_space(char *str)
+{
+#ifdef PARSE_USE_SSE2
+	if (!is_white_space(*str)) {
+		return str;
+	}
+
+	return const_cast<char *>(scan_until(str, [](__m128i chars) {
+		auto white = _mm_or_si128(_mm_or_si128(match_char(chars, ' '), match_char(chars, '\t')), match_char(chars, EOLN));
+		return ~_mm_movemask_epi8(white) & 0xFFFF;
+	}));
+#else
+	while ((*str != EOF_CHAR) && is_white_space(*str))
+		str++;
+
+	return str;
+#endif
+}
+
+// Returns the next line end, EOF_CHAR or null terminator
+static inline char *scan_to_eoln(char *str)
+{
+#ifdef PARSE_USE_SSE2
+	return const_cast<char *>(scan_until(str, [](__m128i chars) {
+		auto stop = _mm_or_si128(_mm_or_si128(match_char(chars, EOLN), match_char(chars, EOF_CHAR)), match_char(chars, '\0'));
+		return _mm_movemask_epi8(stop);
+	}));
+#else
+	while ((*str != EOLN) && (*str != EOF_CHAR) && (*str != '\0'))
+		str++;
+
+	return str;
+#endif
+}
+
+// Returns how many characters of a line strip_comments() can copy as they are: the ones before the next line end, quote
+// or comment character
+static inline size_t scan_plain_line_chars(const char *str)
+{
+#ifdef PARSE_USE_SSE2
+	return (size_t)(scan_until(str, [](__m128i chars) {
+		auto stop = _mm_or_si128(_mm_or_si128(match_char(chars, '\r'), match_char(chars, '\n')), match_char(chars, '\0'));
+		stop = _mm_or_si128(stop, _mm_or_si128(match_char(chars, '/'), match_char(chars, '!')));
+		stop = _mm_or_si128(stop, _mm_or_si128(match_char(chars, '*'), match_char(chars, ';')));
+		stop = _mm_or_si128(stop, match_char(chars, '\"'));
+		return _mm_movemask_epi8(stop);
+	}) - str);
+#else
+	auto p = str;
+	while (*p != '\r' && *p != '\n' && *p != '\0' && *p != '/' && *p != '!' && *p != '*' && *p != ';' && *p != '\"')
+		p++;
+
+	return (size_t)(p - str);
+#endif
+}
 
 
 //	Return true if this character is white space, else false.
@@ -76,8 +197,7 @@ int is_parenthesis(char ch)
 //	Leaves Mp pointing at first non white space character.
 void ignore_white_space()
 {
-	while ((*Mp != EOF_CHAR) && is_white_space(*Mp))
-		Mp++;
+	Mp = scan_white_space(Mp);
 }
 
 void ignore_gray_space()
@@ -297,6 +417,11 @@ void advance_to_eoln(const char *more_terminators)
 
 	Assert((more_terminators == NULL) || (strlen(more_terminators) < 125));
 
+	if (more_terminators == NULL) {
+		Mp = scan_to_eoln(Mp);
+		return;
+	}
+
 	terminators[0] = EOLN;
 	terminators[1] = EOF_CHAR;
 	terminators[2] = 0;
@@ -340,11 +465,11 @@ int skip_to_string(const char *pstr, const char *end)
 	if (end)
 		len2 = strlen(end);
 
-	while ((*Mp != EOF_CHAR) && strnicmp(pstr, Mp, len)) {
+	while ((*Mp != EOF_CHAR) && !starts_with_nocase(Mp, pstr, len)) {
 		if (end && *Mp == '#')
 			return 0;
 
-		if (end && !strnicmp(end, Mp, len2))
+		if (end && starts_with_nocase(Mp, end, len2))
 			return -1;
 
 		advance_to_eoln(NULL);
@@ -370,11 +495,11 @@ int skip_to_start_of_string(const char *pstr, const char *end)
 	else
 		endlen = 0;
 
-	while ( (*Mp != EOF_CHAR) && strnicmp(pstr, Mp, len) ) {
+	while ( (*Mp != EOF_CHAR) && !starts_with_nocase(Mp, pstr, len) ) {
 		if (end && *Mp == '#')
 			return 0;
 
-		if (end && !strnicmp(end, Mp, endlen))
+		if (end && starts_with_nocase(Mp, end, endlen))
 			return 0;
 
 		advance_to_eoln(NULL);
@@ -400,11 +525,11 @@ int skip_to_start_of_string_either(const char *pstr1, const char *pstr2, const c
 	else
 		endlen = 0;
 
-	while ( (*Mp != EOF_CHAR) && strnicmp(pstr1, Mp, len1) && strnicmp(pstr2, Mp, len2) ) {
+	while ( (*Mp != EOF_CHAR) && !starts_with_nocase(Mp, pstr1, len1) && !starts_with_nocase(Mp, pstr2, len2) ) {
 		if (end && *Mp == '#')
 			return 0;
 
-		if (end && !strnicmp(end, Mp, endlen))
+		if (end && starts_with_nocase(Mp, end, endlen))
 			return 0;
 
 		advance_to_eoln(NULL);
@@ -1896,6 +2021,22 @@ void strip_comments(char *line, bool &in_quote, bool &in_multiline_comment_a, bo
 	// copy all characters from read to write, unless they're commented
 	while (*readp != '\r' && *readp != '\n' && *readp != '\0')
 	{
+		// the characters which can't start or end a comment or a quote are handled in one go
+		auto plain = scan_plain_line_chars(readp);
+		if (plain > 0)
+		{
+			if (!in_multiline_comment_a && !in_multiline_comment_b)
+			{
+				if (writep != readp)
+					memmove(writep, readp, plain);
+
+				writep += plain;
+			}
+
+			readp += plain;
+			continue;
+		}
+
 		// only check for comments if not quoting
 		if (!in_quote)
 		{
@@ -1987,6 +2128,18 @@ int parse_get_line(char *lineout, int max_line_len, char *start, int max_size, c
 	int i, num_chars_read=0;
 	char c;
 
+	// most lines have no carriage return and fit into the buffer so they are copied at once
+	auto remaining = (size_t)MAX(max_size - (int)(cur - start), 0);
+	if (remaining > 0) {
+		auto eoln = static_cast<char *>(memchr(cur, '\n', remaining));
+		auto line_len = eoln ? (size_t)(eoln - cur) + 1 : remaining;
+
+		if ((int)line_len < max_line_len && memchr(cur, '\r', line_len) == NULL) {
+			memcpy(lineout, cur, line_len);
+			lineout[line_len] = 0;
+			return (int)line_len;
+		}
+	}
 
 	for ( i = 0; i < max_line_len-1; i++ ) {
 		do {
@@ -2014,6 +2167,8 @@ int parse_get_line(char *lineout, int max_line_len, char *start, int max_size, c
 //	When a comment is found, it is removed.  If an entire line
 //	consisted of a comment, a blank line is left in the input file.
 // Goober5000 - added ability to read somewhere other than Mission_text
+static size_t process_raw_text(char *processed_text, char *raw_text);
+
 void read_file_text(const char *filename, int mode, char *processed_text, char *raw_text)
 {
 	// copy the filename
@@ -2022,6 +2177,10 @@ void read_file_text(const char *filename, int mode, char *processed_text, char *
 
 	strcpy_s(Current_filename_sub, filename);
 
+	if (mode == CF_TYPE_TABLES) {
+		tracing::startup::table_begin(filename);
+	}
+
 	// if we are paused then processed_text and raw_text must not be NULL!!
 	if ( Parsing_paused && ((processed_text == NULL) || (raw_text == NULL)) ) {
 		Error(LOCATION, "ERROR: Neither processed_text nor raw_text may be NULL when parsing is paused!!\n");
@@ -2036,6 +2195,21 @@ void read_file_text(const char *filename, int mode, char *processed_text, char *
 	if (raw_text == NULL)
 		raw_text = Mission_text_raw;
 
+	if (table_cache_enabled(mode)) {
+		// the processed text of a file only changes with its contents so it can be kept between runs
+		size_t raw_len = strlen(raw_text);
+		uint checksum = table_cache_checksum(raw_text, raw_len);
+
+		size_t processed_len;
+		if (table_cache_load(mode, filename, checksum, raw_len, processed_text, &processed_len)) {
+			processed_text[processed_len] = raw_text[raw_len] = EOF_CHAR;
+		} else {
+			processed_len = process_raw_text(processed_text, raw_text);
+			table_cache_save(mode, filename, checksum, raw_len, processed_text, processed_len);
+		}
+		return;
+	}
+
 	// process it (strip comments)
 	process_raw_file_text(processed_text, raw_text);
 }
@@ -2128,12 +2302,9 @@ void allocate_mission_text(size_t size)
 		return;
 	}
 
-	static ubyte parse_atexit = 0;
-
-	if (!parse_atexit) {
-		atexit(stop_parse);
-		parse_atexit = 1;
-	}
+	// this only frees the text of the main thread, other threads call stop_parse() once they are done
+	static std::once_flag parse_atexit;
+	std::call_once(parse_atexit, []() { atexit(stop_parse); });
 
 	if (Mission_text != NULL) {
 		vm_free(Mission_text);
@@ -2227,6 +2398,18 @@ void read_raw_file_text(const char *filename, int mode, char *raw_text)
 
 // Goober5000
 void process_raw_file_text(char *processed_text, char *raw_text)
+{
+	if (processed_text == NULL)
+		processed_text = Mission_text;
+
+	if (raw_text == NULL)
+		raw_text = Mission_text_raw;
+
+	process_raw_text(processed_text, raw_text);
+}
+
+// returns the length of the processed text without the EOF_CHAR at its end
+static size_t process_raw_text(char *processed_text, char *raw_text)
 {
 	char	*mp;
 	char	*mp_raw;
@@ -2236,12 +2419,6 @@ void process_raw_file_text(char *processed_text, char *raw_text)
 	bool in_multiline_comment_b = false;
 	int raw_text_len = (int)strlen(raw_text);
 
-	if (processed_text == NULL)
-		processed_text = Mission_text;
-
-	if (raw_text == NULL)
-		raw_text = Mission_text_raw;
-
 	Assert( processed_text != NULL );
 	Assert( raw_text != NULL );
 
@@ -2298,6 +2475,7 @@ void process_raw_file_text(char *processed_text, char *raw_text)
 	*mp = *mp_raw = EOF_CHAR;
 */
 
+	return (size_t)(mp - processed_text);
 }
 
 void debug_show_mission_text()
@@ -4249,6 +4427,7 @@ int parse_modular_table(const char *name_check, void (*parse_callback)(const cha
 		tbl_file_names[i] += ".tbm";
 		mprintf(("TBM  =>  Starting parse of '%s' ...\n", tbl_file_names[i].c_str()));
 		(*parse_callback)(tbl_file_names[i].c_str());
+		tracing::startup::table_end();
 	}
 
 	Parsing_modular_table = false;
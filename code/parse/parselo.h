@@ -21,12 +21,12 @@
 // NOTE: although the main game doesn't need this anymore, FRED2 still does
 #define	MISSION_TEXT_SIZE	1000000
 
-extern char	*Mission_text;
-extern char	*Mission_text_raw;
-extern char	*Mp;
-extern const char	*token_found;
-extern int fred_parse_flag;
-extern int Token_found_flag;
+extern SCP_THREAD_LOCAL char	*Mission_text;
+extern SCP_THREAD_LOCAL char	*Mission_text_raw;
+extern SCP_THREAD_LOCAL char	*Mp;
+extern SCP_THREAD_LOCAL const char	*token_found;
+extern SCP_THREAD_LOCAL int fred_parse_flag;
+extern SCP_THREAD_LOCAL int Token_found_flag;
 
 
 #define	COMMENT_CHAR	(char)';'
@@ -249,7 +249,7 @@ extern void reset_parse(char *text = NULL);
 extern void display_parse_diagnostics();
 extern void pause_parse();
 extern void unpause_parse();
-// stop parsing, basically just free's up the memory from Mission_text and Mission_text_raw
+// stop parsing, basically just free's up the memory from Mission_text and Mission_text_raw of this thread
 extern void stop_parse();
 
 // utility
@@ -323,7 +323,7 @@ inline void parse_advance(int s){Mp+=s;}
 // parse a modular table, returns the number of files matching the "name_check" filter or 0 if it did nothing
 extern int parse_modular_table(const char *name_check, void (*parse_callback)(const char *filename), int path_type = CF_TYPE_TABLES, int sort_type = CF_SORT_REVERSE);
 // to know that we are parsing a modular table
-extern bool Parsing_modular_table;
+extern SCP_THREAD_LOCAL bool Parsing_modular_table;
 
 //Karajorma - Parses mission and campaign ship loadouts.
 int stuff_loadout_list (int *ilp, int max_ints, int lookup_type);
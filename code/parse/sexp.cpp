@@ -198,18 +198,18 @@ sexp_oper Operators[] = {
 	{ "are-waypoints-done-delay",		OP_WAYPOINTS_DONE_DELAY,				3,	4,			SEXP_BOOLEAN_OPERATOR,	},
 	{ "is-nav-visited",					OP_NAV_IS_VISITED,						1,	1,			SEXP_BOOLEAN_OPERATOR,	}, // Kazan
 	{ "ship-type-destroyed",			OP_SHIP_TYPE_DESTROYED,					2,	2,			SEXP_BOOLEAN_OPERATOR,	},
-	{ "percent-ships-destroyed",		OP_PERCENT_SHIPS_DESTROYED,				2,	INT_MAX,	SEXP_BOOLEAN_OPERATOR,	},
-	{ "percent-ships-disabled",			OP_PERCENT_SHIPS_DISABLED,				2,	INT_MAX,	SEXP_BOOLEAN_OPERATOR,	},
-	{ "percent-ships-disarmed",			OP_PERCENT_SHIPS_DISARMED,				2,	INT_MAX,	SEXP_BOOLEAN_OPERATOR,	},
-	{ "percent-ships-departed",			OP_PERCENT_SHIPS_DEPARTED,				2,	INT_MAX,	SEXP_BOOLEAN_OPERATOR,	},
-	{ "percent-ships-arrived",			OP_PERCENT_SHIPS_ARRIVED,				2,	INT_MAX,	SEXP_BOOLEAN_OPERATOR,	},
+	{ "percent-ships-destroyed",		OP_PERCENT_SHIPS_DESTROYED,				2,	INT_MAX,	SEXP_BOOLEAN_OPERATOR | SEXP_PURE_OPERATOR,	},
+	{ "percent-ships-disabled",			OP_PERCENT_SHIPS_DISABLED,				2,	INT_MAX,	SEXP_BOOLEAN_OPERATOR | SEXP_PURE_OPERATOR,	},
+	{ "percent-ships-disarmed",			OP_PERCENT_SHIPS_DISARMED,				2,	INT_MAX,	SEXP_BOOLEAN_OPERATOR | SEXP_PURE_OPERATOR,	},
+	{ "percent-ships-departed",			OP_PERCENT_SHIPS_DEPARTED,				2,	INT_MAX,	SEXP_BOOLEAN_OPERATOR | SEXP_PURE_OPERATOR,	},
+	{ "percent-ships-arrived",			OP_PERCENT_SHIPS_ARRIVED,				2,	INT_MAX,	SEXP_BOOLEAN_OPERATOR | SEXP_PURE_OPERATOR,	},
 	{ "depart-node-delay",				OP_DEPART_NODE_DELAY,					3,	INT_MAX,	SEXP_BOOLEAN_OPERATOR,	},	
 	{ "destroyed-or-departed-delay",	OP_DESTROYED_DEPARTED_DELAY,			2,	INT_MAX,	SEXP_BOOLEAN_OPERATOR,	},	
 
 	//Status Category
 	//Mission Sub-Category
-	{ "num-ships-in-battle",			OP_NUM_SHIPS_IN_BATTLE,					0,	INT_MAX,	SEXP_INTEGER_OPERATOR,	},	//phreak modified by FUBAR
-	{ "num-ships-in-wing",				OP_NUM_SHIPS_IN_WING,					1,	INT_MAX,	SEXP_INTEGER_OPERATOR,	},	// Karajorma
+	{ "num-ships-in-battle",			OP_NUM_SHIPS_IN_BATTLE,					0,	INT_MAX,	SEXP_INTEGER_OPERATOR | SEXP_PURE_OPERATOR,	},	//phreak modified by FUBAR
+	{ "num-ships-in-wing",				OP_NUM_SHIPS_IN_WING,					1,	INT_MAX,	SEXP_INTEGER_OPERATOR | SEXP_PURE_OPERATOR,	},	// Karajorma
 	{ "directive-value",				OP_DIRECTIVE_VALUE,						1,	2,			SEXP_INTEGER_OPERATOR,	},	// Karajorma
 
 	//Player Sub-Category
@@ -264,7 +264,7 @@ sexp_oper Operators[] = {
 	{ "engine-recharge-pct",			OP_ENGINE_RECHARGE_PCT,					1,	1,			SEXP_INTEGER_OPERATOR,	},
 	{ "shield-quad-low",				OP_SHIELD_QUAD_LOW,						2,	2,			SEXP_INTEGER_OPERATOR,	},
 	{ "get-throttle-speed",				OP_GET_THROTTLE_SPEED,					1,	1,			SEXP_INTEGER_OPERATOR,	}, // Karajorma
-	{ "current-speed",					OP_CURRENT_SPEED,						1,	1,			SEXP_INTEGER_OPERATOR,	},
+	{ "current-speed",					OP_CURRENT_SPEED,						1,	1,			SEXP_INTEGER_OPERATOR | SEXP_PURE_OPERATOR,	},
 
 	//Cargo Sub-Category
 	{ "is-cargo-known",					OP_IS_CARGO_KNOWN,						1,	INT_MAX,	SEXP_BOOLEAN_OPERATOR,	},
@@ -273,21 +273,21 @@ sexp_oper Operators[] = {
 	{ "is-cargo",						OP_IS_CARGO,							2,	3,			SEXP_BOOLEAN_OPERATOR,	},
 
 	//Damage Sub-Category
-	{ "shields-left",					OP_SHIELDS_LEFT,						1,	1,			SEXP_INTEGER_OPERATOR,	},
-	{ "hits-left",						OP_HITS_LEFT,							1,	1,			SEXP_INTEGER_OPERATOR,	},
-	{ "hits-left-subsystem",			OP_HITS_LEFT_SUBSYSTEM,					2,	3,			SEXP_INTEGER_OPERATOR,	},
-	{ "hits-left-subsystem-generic",	OP_HITS_LEFT_SUBSYSTEM_GENERIC,			2,	2,			SEXP_INTEGER_OPERATOR,	},	// Goober5000
-	{ "hits-left-subsystem-specific",	OP_HITS_LEFT_SUBSYSTEM_SPECIFIC,		2,	2,			SEXP_INTEGER_OPERATOR,	},	// Goober5000
-	{ "sim-hits-left",					OP_SIM_HITS_LEFT,						1,	1,			SEXP_INTEGER_OPERATOR,	}, // Turey
+	{ "shields-left",					OP_SHIELDS_LEFT,						1,	1,			SEXP_INTEGER_OPERATOR | SEXP_PURE_OPERATOR,	},
+	{ "hits-left",						OP_HITS_LEFT,							1,	1,			SEXP_INTEGER_OPERATOR | SEXP_PURE_OPERATOR,	},
+	{ "hits-left-subsystem",			OP_HITS_LEFT_SUBSYSTEM,					2,	3,			SEXP_INTEGER_OPERATOR | SEXP_PURE_OPERATOR,	},
+	{ "hits-left-subsystem-generic",	OP_HITS_LEFT_SUBSYSTEM_GENERIC,			2,	2,			SEXP_INTEGER_OPERATOR | SEXP_PURE_OPERATOR,	},	// Goober5000
+	{ "hits-left-subsystem-specific",	OP_HITS_LEFT_SUBSYSTEM_SPECIFIC,		2,	2,			SEXP_INTEGER_OPERATOR | SEXP_PURE_OPERATOR,	},	// Goober5000
+	{ "sim-hits-left",					OP_SIM_HITS_LEFT,						1,	1,			SEXP_INTEGER_OPERATOR | SEXP_PURE_OPERATOR,	}, // Turey
 	{ "get-damage-caused",				OP_GET_DAMAGE_CAUSED,					2,	INT_MAX,	SEXP_INTEGER_OPERATOR,	},
 
 	//Distance and Coordinates Sub-Category
-	{ "distance",						OP_DISTANCE,							2,	2,			SEXP_INTEGER_OPERATOR,	},
+	{ "distance",						OP_DISTANCE,							2,	2,			SEXP_INTEGER_OPERATOR | SEXP_PURE_OPERATOR,	},
 	{ "distance-ship-subsystem",		OP_DISTANCE_SUBSYSTEM,					3,	3,			SEXP_INTEGER_OPERATOR,	},	// Goober5000
 	{ "distance-to-nav",				OP_NAV_DISTANCE,						1,	1,			SEXP_INTEGER_OPERATOR,	},	// Kazan
-	{ "num-within-box",					OP_NUM_WITHIN_BOX,						7,	INT_MAX,	SEXP_INTEGER_OPERATOR,	},	//WMC
-	{ "is-in-box",						OP_IS_IN_BOX,							7,	8,			SEXP_INTEGER_OPERATOR,	},	//Sushi
-	{ "special-warp-dist",				OP_SPECIAL_WARP_DISTANCE,				1,	1,			SEXP_INTEGER_OPERATOR,	},
+	{ "num-within-box",					OP_NUM_WITHIN_BOX,						7,	INT_MAX,	SEXP_INTEGER_OPERATOR | SEXP_PURE_OPERATOR,	},	//WMC
+	{ "is-in-box",						OP_IS_IN_BOX,							7,	8,			SEXP_INTEGER_OPERATOR | SEXP_PURE_OPERATOR,	},	//Sushi
+	{ "special-warp-dist",				OP_SPECIAL_WARP_DISTANCE,				1,	1,			SEXP_INTEGER_OPERATOR | SEXP_PURE_OPERATOR,	},
 	{ "get-object-x",					OP_GET_OBJECT_X,						1,	5,			SEXP_INTEGER_OPERATOR,	},	// Goober5000
 	{ "get-object-y",					OP_GET_OBJECT_Y,						1,	5,			SEXP_INTEGER_OPERATOR,	},	// Goober5000
 	{ "get-object-z",					OP_GET_OBJECT_Z,						1,	5,			SEXP_INTEGER_OPERATOR,	},	// Goober5000
@@ -925,9 +925,37 @@ int get_effect_from_name(char* name);
 #define NO_OPERATOR_INDEX_DEFINED		-2
 #define NOT_A_SEXP_OPERATOR				-1
 
+// values of sexp_node.program which are not an index into Sexp_programs
+#define SEXP_PROGRAM_UNCOMPILED		-1
+#define SEXP_PROGRAM_NONE			-2
+
+// the instructions of a compiled sexp program, see eval_sexp_program()
+enum sexp_instruction_code {
+	SIC_CONSTANT,	// pushes value
+	SIC_VARIABLE,	// pushes the number in the variable with the index value
+	SIC_OPERATOR,	// replaces the top count values with the result of the operator value
+	SIC_POSITIVE	// negates the top value if it is negative, like eval_sexp() does for OPF_POSITIVE arguments
+};
+
+struct sexp_instruction {
+	int code;
+	int value;
+	int count;
+};
+
+struct sexp_program {
+	int root;						// the operator node this was compiled from
+	bool positive;					// the parent of the root wants a positive value
+	SCP_vector<sexp_instruction> instructions;
+};
+
+SCP_vector<sexp_program> Sexp_programs;
+SCP_vector<int> Sexp_program_stack;
+
 // Karajorma - some useful helper methods
 player * get_player_from_ship_node(int node, bool test_respawns = false);
 ship * sexp_get_ship_from_node(int node);
+int sexp_ship_lookup(int node, int inc_players = 0);
 
 // hud-display-gauge magic values
 #define SEXP_HUD_GAUGE_WARPOUT "warpout"
@@ -1041,6 +1069,9 @@ void sexp_nodes_init()
 		return;
 
 	nprintf(("SEXP", "Reinitializing sexp nodes...\n"));
+
+	// the persistent nodes notice that their programs are gone because the root doesn't match anymore
+	Sexp_programs.clear();
 	nprintf(("SEXP", "Entered function with %d nodes.\n", Num_sexp_nodes));
 
 	// usually, the persistent nodes are grouped at the beginning of the array;
@@ -1125,7 +1156,8 @@ void init_sexp()
 int alloc_sexp(const char *text, int type, int subtype, int first, int rest)
 {
 	int node;
-	int sexp_const = get_operator_const(text);
+	int op_index = get_operator_index(text);
+	int sexp_const = (op_index == NOT_A_SEXP_OPERATOR) ? 0 : Operators[op_index].value;
 
 	if ((sexp_const == OP_TRUE) && (type == SEXP_ATOM) && (subtype == SEXP_ATOM_OPERATOR))
 		return Locked_sexp_true;
@@ -1168,11 +1200,31 @@ int alloc_sexp(const char *text, int type, int subtype, int first, int rest)
 	Sexp_nodes[node].rest = rest;
 	Sexp_nodes[node].value = SEXP_UNKNOWN;
 	Sexp_nodes[node].flags = SNF_DEFAULT_VALUE;	// Goober5000
-	Sexp_nodes[node].op_index = NO_OPERATOR_INDEX_DEFINED;
+	Sexp_nodes[node].op_index = op_index;	// resolved now so evaluating the node never has to look at its text
+	Sexp_nodes[node].cache_index = -1;
+	Sexp_nodes[node].cache_signature = 0;
+	Sexp_nodes[node].program = SEXP_PROGRAM_UNCOMPILED;
+	Sexp_nodes[node].cue_earliest_time = 0;
+	Sexp_nodes[node].cue_log_changes = -1;
+
+	// outside of FRED the text of a variable node already is the slot of the variable, see get_sexp_text_for_variable()
+	Sexp_nodes[node].variable_index = ((type & SEXP_FLAG_VARIABLE) && !Fred_running) ? atoi(text) : -1;
 
 	return node;
 }
 
+/**
+ * Gets the slot in Sexp_variables of a variable node which was bound when the node was parsed
+ */
+int sexp_node_variable_index(int node)
+{
+	if ( (Sexp_nodes[node].type & SEXP_FLAG_VARIABLE) && Sexp_nodes[node].variable_index >= 0 ) {
+		return Sexp_nodes[node].variable_index;
+	}
+
+	return atoi(Sexp_nodes[node].text);
+}
+
 static int Sexp_hwm = 0;
 
 int count_free_sexp_nodes()
@@ -1561,21 +1613,37 @@ int find_argnum(int parent_node, int arg_node)
 	return -1;
 }
 
+// the indices of the operators by their lower case names, filled on the first lookup
+static SCP_unordered_map<SCP_string, int> Operator_lookup;
+
 /**
  * From an operator name, return its index in the array Operators
  */
 int get_operator_index(const char *token)
 {
-	int	i;
 	Assertion(token != NULL, "get_operator_index(char*) called with a null token; get a coder!\n");
 
-	for (i=0; i<Num_operators; i++){
-		if (!stricmp(token, Operators[i].text)){
-			return i;
+	if (Operator_lookup.empty()) {
+		for (int i = 0; i < Num_operators; i++) {
+			SCP_string name = Operators[i].text;
+			std::transform(name.begin(), name.end(), name.begin(), ::tolower);
+
+			// like the linear search this replaces, the first operator of a name wins
+			Operator_lookup.emplace(name, i);
 		}
 	}
 
-	return NOT_A_SEXP_OPERATOR;
+	// reused so a lookup doesn't have to allocate
+	static SCP_string lowered;
+	lowered.assign(token);
+	std::transform(lowered.begin(), lowered.end(), lowered.begin(), ::tolower);
+
+	auto iter = Operator_lookup.find(lowered);
+	if (iter == Operator_lookup.end()) {
+		return NOT_A_SEXP_OPERATOR;
+	}
+
+	return iter->second;
 }
 
 /**
@@ -1888,7 +1956,7 @@ int check_sexp_syntax(int node, int return_type, int recursive, int *bad_node, i
 					return SEXP_CHECK_TYPE_MISMATCH;
 				}
 
-				if (ship_name_lookup(CTEXT(node), 0) < 0)
+				if (sexp_ship_lookup(node) < 0)
 				{
 					if (Fred_running || !mission_parse_get_arrival_ship(CTEXT(node)))
 					{
@@ -1906,7 +1974,7 @@ int check_sexp_syntax(int node, int return_type, int recursive, int *bad_node, i
 
 				if (stricmp(CTEXT(node), SEXP_NONE_STRING))		// none is okay
 				{
-					if (ship_name_lookup(CTEXT(node), 1) < 0)
+					if (sexp_ship_lookup(node, 1) < 0)
 					{
 						if (Fred_running || !mission_parse_get_arrival_ship(CTEXT(node)))
 						{
@@ -1923,7 +1991,7 @@ int check_sexp_syntax(int node, int return_type, int recursive, int *bad_node, i
 					return SEXP_CHECK_TYPE_MISMATCH;
 				}
 
-				if (ship_name_lookup(CTEXT(node), 1) < 0) {
+				if (sexp_ship_lookup(node, 1) < 0) {
 					if (Fred_running || !mission_parse_get_arrival_ship(CTEXT(node)))
 					{
 						if (type == OPF_SHIP)
@@ -1971,7 +2039,7 @@ int check_sexp_syntax(int node, int return_type, int recursive, int *bad_node, i
 				}
 
 				// all of these have ships and wings in common
-				if (ship_name_lookup(CTEXT(node), 1) >= 0 || wing_name_lookup(CTEXT(node), 1) >= 0) {
+				if (sexp_ship_lookup(node, 1) >= 0 || wing_name_lookup(CTEXT(node), 1) >= 0) {
 					break;
 				}
 				// also check arrival list if we're running the game
@@ -2258,7 +2326,7 @@ int check_sexp_syntax(int node, int return_type, int recursive, int *bad_node, i
 						valid = 1;
 					}
 
-					if (ship_name_lookup(CTEXT(node), 1) >= 0)
+					if (sexp_ship_lookup(node, 1) >= 0)
 					{
 						valid = 1;
 					}
@@ -2420,7 +2488,7 @@ int check_sexp_syntax(int node, int return_type, int recursive, int *bad_node, i
 						break;
 					}
 
-					ship_num = ship_name_lookup(CTEXT(Sexp_nodes[op_node].rest), 1);	// Goober5000 - include players
+					ship_num = sexp_ship_lookup(Sexp_nodes[op_node].rest, 1);	// Goober5000 - include players
 					if (ship_num < 0) {
 						w = wing_name_lookup(CTEXT(Sexp_nodes[op_node].rest));
 						if (w < 0) {
@@ -2450,7 +2518,7 @@ int check_sexp_syntax(int node, int return_type, int recursive, int *bad_node, i
 					}
 
 					if ((z == OP_AI_DOCK) && (Sexp_nodes[node].rest >= 0)) {
-						ship2 = ship_name_lookup(CTEXT(Sexp_nodes[node].rest), 1);	// Goober5000 - include players
+						ship2 = sexp_ship_lookup(Sexp_nodes[node].rest, 1);	// Goober5000 - include players
 						if ((ship_num < 0) || !ship_docking_valid(ship_num, ship2)){
 							return SEXP_CHECK_DOCKING_NOT_ALLOWED;
 						}
@@ -2656,7 +2724,7 @@ int check_sexp_syntax(int node, int return_type, int recursive, int *bad_node, i
 					}
 
 					// look for the ship this goal is being assigned to
-					ship_num = ship_name_lookup(CTEXT(Sexp_nodes[z].rest), 1);
+					ship_num = sexp_ship_lookup(Sexp_nodes[z].rest, 1);
 					if (ship_num < 0) {
 						if (bad_node)
 							*bad_node = Sexp_nodes[z].rest;
@@ -2695,7 +2763,7 @@ int check_sexp_syntax(int node, int return_type, int recursive, int *bad_node, i
 						ship_num = ship_name_lookup(Sexp_nodes[z].text, 1);
 					}
 					else {
-						ship_num = ship_name_lookup(CTEXT(Sexp_nodes[op_node].rest), 1);
+						ship_num = sexp_ship_lookup(Sexp_nodes[op_node].rest, 1);
 					}
 
 					if (ship_num < 0) {
@@ -2724,7 +2792,7 @@ int check_sexp_syntax(int node, int return_type, int recursive, int *bad_node, i
 				if (*CTEXT(node) != '#') {  // not a manual source?
 					if ( stricmp(CTEXT(node), "<any wingman>"))  
 						if ( stricmp(CTEXT(node), "<none>") ) // not a special token?
-							if ((ship_name_lookup(CTEXT(node), TRUE) < 0) && (wing_name_lookup(CTEXT(node), 1) < 0))  // is it in the mission?
+							if ((sexp_ship_lookup(node, 1) < 0) && (wing_name_lookup(CTEXT(node), 1) < 0))  // is it in the mission?
 								if (Fred_running || !mission_parse_get_arrival_ship(CTEXT(node)))
 									return SEXP_CHECK_INVALID_MSG_SOURCE;
 				}
@@ -3918,7 +3986,7 @@ player * get_player_from_ship_node(int node, bool test_respawns)
 	
 	Assert (node != -1);
 
-	sindex = ship_name_lookup(CTEXT(node));
+	sindex = sexp_ship_lookup(node);
 
 	// singleplayer
 	if (!(Game_mode & GM_MULTIPLAYER)){	
@@ -3953,6 +4021,37 @@ player * get_player_from_ship_node(int node, bool test_respawns)
 	}
 }
 
+/**
+ * Returns the index of the ship named by a node like ship_name_lookup() does. The ship is remembered in the node
+ * together with the signature of its object so the next evaluation only has to check that it is still the same ship.
+ */
+int sexp_ship_lookup(int node, int inc_players)
+{
+	const char *name = CTEXT(node);
+	sexp_node *snp = &Sexp_nodes[node];
+
+	int sindex = snp->cache_index;
+	if (sindex >= 0 && !Fred_running) {
+		int objnum = Ships[sindex].objnum;
+
+		// the name is compared as well since the node may be a variable or an argument, or the ship was renamed
+		if ((objnum >= 0) && (Objects[objnum].signature == snp->cache_signature)
+			&& (Objects[objnum].type == OBJ_SHIP || (Objects[objnum].type == OBJ_START && inc_players))
+			&& !stricmp(name, Ships[sindex].ship_name)) {
+			return sindex;
+		}
+	}
+
+	sindex = ship_name_lookup(name, inc_players);
+
+	if (sindex >= 0) {
+		snp->cache_index = sindex;
+		snp->cache_signature = Objects[Ships[sindex].objnum].signature;
+	}
+
+	return sindex;
+}
+
 /**
  * Given a node, returns a pointer to the ship or NULL if this isn't the name of a ship
  */
@@ -3961,7 +4060,7 @@ ship * sexp_get_ship_from_node(int node)
 	int sindex;
 	ship *shipp = NULL;
 
-	sindex = ship_name_lookup( CTEXT(node) );
+	sindex = sexp_ship_lookup(node);
 
 	if (sindex < 0) {
 		return shipp;
@@ -4532,6 +4631,35 @@ int sexp_xor(int node)
 	return (num_true == 1);
 }
 
+// checks if two numbers satisfy a comparison operator
+static bool sexp_compare_numbers(int op, int first_number, int current_number)
+{
+	switch(op)
+	{
+		case OP_EQUALS:
+			return first_number == current_number;
+
+		case OP_NOT_EQUAL:
+			return first_number != current_number;
+
+		case OP_GREATER_THAN:
+			return first_number > current_number;
+
+		case OP_GREATER_OR_EQUAL:
+			return first_number >= current_number;
+
+		case OP_LESS_THAN:
+			return first_number < current_number;
+
+		case OP_LESS_OR_EQUAL:
+			return first_number <= current_number;
+
+		default:
+			Warning(LOCATION, "Unhandled comparison case!  Operator = %d", op);
+			return true;
+	}
+}
+
 // Goober5000
 int sexp_number_compare(int n, int op)
 {
@@ -4570,36 +4698,8 @@ int sexp_number_compare(int n, int op)
 		current_number = eval_sexp(current_node);
 
 		// must satisfy our particular operator
-		switch(op)
-		{
-			case OP_EQUALS:
-				if (first_number != current_number) return SEXP_FALSE;
-				break;
-
-			case OP_NOT_EQUAL:
-				if (first_number == current_number) return SEXP_FALSE;
-				break;
-
-			case OP_GREATER_THAN:
-				if (first_number <= current_number) return SEXP_FALSE;
-				break;
-
-			case OP_GREATER_OR_EQUAL:
-				if (first_number < current_number) return SEXP_FALSE;
-				break;
-
-			case OP_LESS_THAN:
-				if (first_number >= current_number) return SEXP_FALSE;
-				break;
-
-			case OP_LESS_OR_EQUAL:
-				if (first_number > current_number) return SEXP_FALSE;
-				break;
-
-			default:
-				Warning(LOCATION, "Unhandled comparison case!  Operator = %d", op);
-				break;
-		}
+		if (!sexp_compare_numbers(op, first_number, current_number))
+			return SEXP_FALSE;
 	}
 
 	// it satisfies the operator for all the arguments
@@ -5562,6 +5662,172 @@ int sexp_has_time_elapsed(int n)
 	return SEXP_FALSE;
 }
 
+/**
+ * Finds the mission time before which an event formula is known to be false and to do nothing
+ *
+ * This is the case for events which are just a has-time-elapsed with a fixed number of seconds, or a when or
+ * every-time with such a condition.
+ *
+ * @param formula The root of the event formula
+ * @return The mission time, 0 if the formula has to be evaluated every time
+ */
+fix sexp_event_earliest_time(int formula)
+{
+	int cond = formula;
+	int op_num = get_operator_const(formula);
+
+	if ((op_num == OP_WHEN) || (op_num == OP_EVERY_TIME))
+	{
+		int n = CDR(formula);
+		if ((n < 0) || (CAR(n) < 0))
+			return 0;
+
+		cond = CAR(n);
+	}
+
+	if (get_operator_const(cond) != OP_HAS_TIME_ELAPSED)
+		return 0;
+
+	int n = CDR(cond);
+	if ((n < 0) || (CAR(n) != -1) || (Sexp_nodes[n].type & SEXP_FLAG_VARIABLE) || (Sexp_nodes[n].subtype != SEXP_ATOM_NUMBER)
+		|| !strcmp(Sexp_nodes[n].text, SEXP_ARGUMENT_STRING))
+		return 0;
+
+	// the mission time can't get beyond this anyway
+	int time = atoi(Sexp_nodes[n].text);
+	if ((time <= 0) || (time > SHRT_MAX))
+		return 0;
+
+	return i2f(time);
+}
+
+/**
+ * Collects the names of the messages which are given as literal arguments to the operators of a formula, e.g. the
+ * messages of send-message
+ */
+void sexp_get_message_arguments(int node, SCP_vector<SCP_string> &names)
+{
+	int op_index = get_operator_index(node);
+	if (op_index == NOT_A_SEXP_OPERATOR)
+		return;
+
+	int argnum = 0;
+	for (int n = CDR(node); n >= 0; n = CDR(n), argnum++)
+	{
+		if (CAR(n) != -1)
+		{
+			sexp_get_message_arguments(CAR(n), names);
+			continue;
+		}
+
+		if ((Sexp_nodes[n].type & SEXP_FLAG_VARIABLE) || !strcmp(Sexp_nodes[n].text, SEXP_ARGUMENT_STRING))
+			continue;
+
+		if (query_operator_argument_type(op_index, argnum) == OPF_MESSAGE)
+			names.push_back(Sexp_nodes[n].text);
+	}
+}
+
+/**
+ * Finds whether a false cue is false because of the mission log alone
+ *
+ * This is the case for cues which are just one of the objective operators with a delay, with literal arguments and
+ * an undelayed condition which isn't true yet.  Such a cue stays false until the log changes, whatever the delay.
+ */
+static bool sexp_cue_waits_for_log(int formula)
+{
+	int op_num = get_operator_const(formula);
+	int node = CDR(formula);
+	int val;
+
+	for (int n = node; n >= 0; n = CDR(n))
+	{
+		if ((CAR(n) != -1) || (Sexp_nodes[n].type & SEXP_FLAG_VARIABLE) || !strcmp(Sexp_nodes[n].text, SEXP_ARGUMENT_STRING))
+			return false;
+	}
+
+	if (node < 0)
+		return false;
+
+	switch (op_num)
+	{
+		case OP_IS_DESTROYED_DELAY:
+			val = sexp_is_destroyed(CDR(node), NULL);
+			break;
+
+		case OP_HAS_ARRIVED_DELAY:
+			val = sexp_has_arrived(CDR(node), NULL);
+			break;
+
+		case OP_HAS_DEPARTED_DELAY:
+			val = sexp_has_departed(CDR(node), NULL);
+			break;
+
+		case OP_IS_DISABLED_DELAY:
+			val = sexp_is_disabled(CDR(node), NULL);
+			break;
+
+		case OP_IS_DISARMED_DELAY:
+			val = sexp_is_disarmed(CDR(node), NULL);
+			break;
+
+		case OP_IS_SUBSYSTEM_DESTROYED_DELAY:
+			val = sexp_is_subsystem_destroyed(node);
+			break;
+
+		case OP_HAS_DOCKED_DELAY:
+			val = sexp_has_docked_or_undocked(node, OP_HAS_DOCKED);
+			break;
+
+		case OP_HAS_UNDOCKED_DELAY:
+			val = sexp_has_docked_or_undocked(node, OP_HAS_UNDOCKED);
+			break;
+
+		default:
+			return false;
+	}
+
+	return (val == SEXP_FALSE) || (val == SEXP_CANT_EVAL);
+}
+
+/**
+ * Evaluates an arrival or departure cue
+ *
+ * A cue which was false and is known to stay false until some time has elapsed or until the mission log changes isn't
+ * evaluated again before that, see sexp_event_earliest_time() and sexp_cue_waits_for_log().
+ *
+ * @param cue The root of the cue
+ * @return Nonzero if the cue is true
+ */
+int eval_cue(int cue)
+{
+	if (cue < 0)
+		return eval_sexp(cue);
+
+	sexp_node *node = &Sexp_nodes[cue];
+
+	if (Missiontime < node->cue_earliest_time)
+		return SEXP_FALSE;
+
+	if ((node->cue_log_changes >= 0) && (node->cue_log_changes == mission_log_get_change_count()))
+		return SEXP_FALSE;
+
+	int result = eval_sexp(cue);
+
+	if (result)
+	{
+		node->cue_earliest_time = 0;
+		node->cue_log_changes = -1;
+	}
+	else
+	{
+		node->cue_earliest_time = sexp_event_earliest_time(cue);
+		node->cue_log_changes = sexp_cue_waits_for_log(cue) ? mission_log_get_change_count() : -1;
+	}
+
+	return result;
+}
+
 /**
  * Returns the time into the mission
  */
@@ -8194,7 +8460,7 @@ int special_argument_appears_in_sexp_tree(int node)
 
 	// we don't want to include special arguments if they are nested in a new argument SEXP
 	if (Sexp_nodes[node].type == SEXP_ATOM && Sexp_nodes[node].subtype == SEXP_ATOM_OPERATOR) {
-		if (is_blank_argument_op(get_operator_const(CTEXT(node)))) {
+		if (is_blank_argument_op(get_operator_const(node))) {
 			return 0; 
 		}
 	}
@@ -8227,7 +8493,7 @@ void eval_when_do_one_exp(int exp)
 	arg_item *ptr;
 	int do_node;
 
-	switch (get_operator_const(CTEXT(exp)))
+	switch (get_operator_const(exp))
 	{
 		// if the op is a conditional then we just evaluate it
 		case OP_WHEN:
@@ -8306,7 +8572,7 @@ void eval_when_do_all_exp(int all_actions, int when_op_num)
 		{	
 			exp = CAR(actions);	
 
-			op_num = get_operator_const(CTEXT(exp));
+			op_num = get_operator_const(exp);
 
 			if (op_num == OP_DO_FOR_VALID_ARGUMENTS) {
 				int do_node = CDR(exp); 
@@ -9009,7 +9275,7 @@ void sexp_change_all_argument_validity(int n, bool invalidate)
 		return;
 
 	// can't change validity of for-counter
-	if (get_operator_const(CTEXT(arg_handler)) == OP_FOR_COUNTER)
+	if (get_operator_const(arg_handler) == OP_FOR_COUNTER)
 		return;
 		
 	while (n != -1)
@@ -9066,7 +9332,7 @@ void sexp_change_argument_validity(int n, bool invalidate)
 		return;
 
 	// can't change validity of for-counter
-	if (get_operator_const(CTEXT(arg_handler)) == OP_FOR_COUNTER)
+	if (get_operator_const(arg_handler) == OP_FOR_COUNTER)
 		return;
 		
 	// loop through arguments
@@ -9145,11 +9411,11 @@ int get_handler_for_x_of_operator(int n)
 			return -1;
 		}
 	}
-	while (!is_blank_argument_op(get_operator_const(CTEXT(conditional))));
+	while (!is_blank_argument_op(get_operator_const(conditional)));
 
 	// get the first op of the parent, which should be a *_of operator
 	arg_handler = CADR(conditional);
-	if (arg_handler < 0 || !is_blank_of_op(get_operator_const(CTEXT(arg_handler)))) {
+	if (arg_handler < 0 || !is_blank_of_op(get_operator_const(arg_handler))) {
 		return -1;
 	}
 
@@ -9510,7 +9776,7 @@ int sexp_is_ship_class(int n)
 	while (n != -1)
 	{
 		// get ship
-		ship_num = ship_name_lookup(CTEXT(n));
+		ship_num = sexp_ship_lookup(n);
 
 		// we can't do anything with ships that aren't present
 		if (ship_num < 0)
@@ -9543,7 +9809,7 @@ int sexp_is_ship_type(int n)
 	while (n != -1)
 	{
 		// get ship
-		ship_num = ship_name_lookup(CTEXT(n));
+		ship_num = sexp_ship_lookup(n);
 
 		// we can't do anything with ships that aren't present
 		if (ship_num < 0)
@@ -9646,7 +9912,7 @@ void sexp_change_ai_class(int n)
 
 	// find ship
 	n = CDR(n);
-	ship_num = ship_name_lookup(CTEXT(n));
+	ship_num = sexp_ship_lookup(n);
 	n = CDR(n);
 
 	// we can't do anything with ships that aren't present
@@ -10645,7 +10911,7 @@ void sexp_set_explosion_option(int node)
 	shockwave_create_info *sci;
 
 	// get ship
-	ship_num = ship_name_lookup(CTEXT(n));
+	ship_num = sexp_ship_lookup(n);
 	if (ship_num < 0)
 		return;
 
@@ -11200,7 +11466,7 @@ void sexp_self_destruct(int node)
 
 	for (n = node; n != -1; n = CDR(n))	{
 		// get the ship
-		ship_num = ship_name_lookup(CTEXT(n));
+		ship_num = sexp_ship_lookup(n);
 
 		// if it still exists, destroy it
 		if (ship_num >= 0) {
@@ -11633,7 +11899,7 @@ void sexp_destroy_subsys_instantly (int n)
 		return;
 	}
 
-	shipnum = ship_name_lookup(CTEXT(n));
+	shipnum = sexp_ship_lookup(n);
 	// if no ship, then return immediately.
 	if ( shipnum == -1 ){
 		return;
@@ -12022,7 +12288,7 @@ void sexp_jettison_cargo(int n, bool jettison_new)
 		for (; n != -1; n = CDR(n))
 		{
 			// make sure ship exists
-			ship_index = ship_name_lookup(CTEXT(n));
+			ship_index = sexp_ship_lookup(n);
 			if (ship_index < 0)
 				continue;
 
@@ -12214,7 +12480,7 @@ void sexp_add_background_bitmap(int n)
 		// ripped from sexp_modify_variable()
 		// get sexp_variable index
 		Assert(Sexp_nodes[n].first == -1);
-		sexp_var = atoi(Sexp_nodes[n].text);
+		sexp_var = sexp_node_variable_index(n);
 		
 		// verify variable set
 		Assert(Sexp_variables[sexp_var].type & SEXP_VARIABLE_SET);
@@ -12305,7 +12571,7 @@ void sexp_add_sun_bitmap(int n)
 		// ripped from sexp_modify_variable()
 		// get sexp_variable index
 		Assert(Sexp_nodes[n].first == -1);
-		sexp_var = atoi(Sexp_nodes[n].text);
+		sexp_var = sexp_node_variable_index(n);
 		
 		// verify variable set
 		Assert(Sexp_variables[sexp_var].type & SEXP_VARIABLE_SET);
@@ -12520,7 +12786,7 @@ void sexp_change_player_score(int node)
 	node = CDR(node);
 
 	if(!(Game_mode & GM_MULTIPLAYER)){
-		if ( (sindex = ship_name_lookup(CTEXT(node))) == -1) {
+		if ( (sindex = sexp_ship_lookup(node)) == -1) {
 			Warning(LOCATION, "Invalid shipname '%s' passed to sexp_change_player_score!", CTEXT(node));
 			return;
 		}
@@ -14074,7 +14340,7 @@ void sexp_ships_visible(int n, bool visible)
 	// we also have to add any escort ships that were made visible
 	for (; n >= 0; n = CDR(n))
 	{
-		int shipnum = ship_name_lookup(CTEXT(n));
+		int shipnum = sexp_ship_lookup(n);
 		if (shipnum < 0)
 			continue;
 
@@ -14097,7 +14363,7 @@ void sexp_ships_stealthy(int n, bool stealthy)
 	{
 		for (; n >= 0; n = CDR(n))
 		{
-			int shipnum = ship_name_lookup(CTEXT(n));
+			int shipnum = sexp_ship_lookup(n);
 			if (shipnum < 0)
 				continue;
 
@@ -14117,7 +14383,7 @@ void sexp_friendly_stealth_invisible(int n, bool invisible)
 	{
 		for (; n >= 0; n = CDR(n))
 		{
-			int shipnum = ship_name_lookup(CTEXT(n));
+			int shipnum = sexp_ship_lookup(n);
 			if (shipnum < 0)
 				continue;
 
@@ -14243,7 +14509,7 @@ void sexp_ship_tag( int n, int tag )
 		return;
 
 	// get the ship num
-	ship_num = ship_name_lookup(CTEXT(n));
+	ship_num = sexp_ship_lookup(n);
 	if ( ship_num < 0 )
 		return;
 
@@ -14513,7 +14779,7 @@ void sexp_weapon_create(int n)
 	parent_objnum = -1;
 	if (stricmp(CTEXT(n), SEXP_NONE_STRING))
 	{
-		int parent_ship = ship_name_lookup(CTEXT(n));
+		int parent_ship = sexp_ship_lookup(n);
 
 		if (parent_ship >= 0)
 			parent_objnum = Ships[parent_ship].objnum;
@@ -14565,7 +14831,7 @@ void sexp_weapon_create(int n)
 	target_objnum = -1;
 	if (n >= 0)
 	{
-		int target_ship = ship_name_lookup(CTEXT(n));
+		int target_ship = sexp_ship_lookup(n);
 
 		if (target_ship >= 0)
 			target_objnum = Ships[target_ship].objnum;
@@ -14872,7 +15138,7 @@ void sexp_ship_change_callsign(int node)
 
 	while ( node >= 0 )
 	{
-		sindex = ship_name_lookup(CTEXT(node));
+		sindex = sexp_ship_lookup(node);
 		if (sindex >= 0) 
 		{
 			shipp = &Ships[sindex];
@@ -15023,7 +15289,7 @@ int sexp_targeted(int node)
 		return SEXP_CANT_EVAL;
 	}
 
-	z = ship_name_lookup(CTEXT(node), 1);
+	z = sexp_ship_lookup(node, 1);
 	if ((z < 0) || !Player_ai || (Ships[z].objnum != Players_target)){
 		return SEXP_FALSE;
 	}
@@ -15118,7 +15384,7 @@ int sexp_primaries_depleted(int node)
 	ship *shipp;
 
 	// get ship
-	sindex = ship_name_lookup(CTEXT(node));
+	sindex = sexp_ship_lookup(node);
 	if (sindex < 0) {
 		return SEXP_FALSE;
 	}
@@ -15155,7 +15421,7 @@ int sexp_secondaries_depleted(int node)
 	ship *shipp;
 
 	// get ship
-	sindex = ship_name_lookup(CTEXT(node));
+	sindex = sexp_ship_lookup(node);
 	if (sindex < 0) {
 		return SEXP_FALSE;
 	}
@@ -15451,7 +15717,7 @@ int sexp_shield_recharge_pct(int node)
 	int sindex;
 
 	// get the firing ship
-	sindex = ship_name_lookup(CTEXT(node));
+	sindex = sexp_ship_lookup(node);
 	if(sindex < 0){
 		return 0;
 	}
@@ -15468,7 +15734,7 @@ int sexp_engine_recharge_pct(int node)
 	int sindex;
 
 	// get the firing ship
-	sindex = ship_name_lookup(CTEXT(node));
+	sindex = sexp_ship_lookup(node);
 	if(sindex < 0){
 		return 0;
 	}
@@ -15485,7 +15751,7 @@ int sexp_weapon_recharge_pct(int node)
 	int sindex;
 
 	// get the firing ship
-	sindex = ship_name_lookup(CTEXT(node));
+	sindex = sexp_ship_lookup(node);
 	if(sindex < 0){
 		return 0;
 	}
@@ -15508,7 +15774,7 @@ int sexp_get_ets_value(int node)
 	ets_type = CTEXT(node);
 	node = CDR(node);
 
-	sindex = ship_name_lookup(CTEXT(node));
+	sindex = sexp_ship_lookup(node);
 	if (sindex < 0) {
 		return SEXP_FALSE;
 	}
@@ -15549,7 +15815,7 @@ void sexp_set_ets_values(int node)
 
 	// apply ETS settings to specified ships
 	for ( ; node != -1; node = CDR(node)) {
-		sindex = ship_name_lookup(CTEXT(node));
+		sindex = sexp_ship_lookup(node);
 
 		if (sindex >= 0 && validate_ship_ets_indxes(sindex, ets_idx)) {
 			Ships[sindex].engine_recharge_index = ets_idx[ENGINES];
@@ -15589,7 +15855,7 @@ int sexp_shield_quad_low(int node)
 	object *objp;
 
 	// get the ship
-	sindex = ship_name_lookup(CTEXT(node));
+	sindex = sexp_ship_lookup(node);
 	if(sindex < 0){
 		return SEXP_FALSE;
 	}
@@ -15630,7 +15896,7 @@ int sexp_primary_ammo_pct(int node)
 	int ret = 0;
 
 	// get the ship
-	sindex = ship_name_lookup(CTEXT(node));
+	sindex = sexp_ship_lookup(node);
 	if(sindex < 0)
 	{
 		return 0;
@@ -15701,7 +15967,7 @@ int sexp_secondary_ammo_pct(int node)
 	int ret = 0;
 
 	// get the ship
-	sindex = ship_name_lookup(CTEXT(node));
+	sindex = sexp_ship_lookup(node);
 	if(sindex < 0){
 		return 0;
 	}
@@ -15749,7 +16015,7 @@ int sexp_get_primary_ammo(int node)
 	int check;
 
 	// get the ship
-	sindex = ship_name_lookup(CTEXT(node));
+	sindex = sexp_ship_lookup(node);
 	if(sindex < 0)
 	{
 		return 0;
@@ -15803,7 +16069,7 @@ void sexp_set_primary_ammo (int node)
 	int rearm_limit = -1;
 
 	// Check that a ship has been supplied
-	sindex = ship_name_lookup(CTEXT(node));
+	sindex = sexp_ship_lookup(node);
 	if (sindex < 0) 
 	{
 		return ;
@@ -15924,7 +16190,7 @@ int sexp_get_secondary_ammo (int node)
 	int check ;
 
 	// Get the ship
-	sindex = ship_name_lookup(CTEXT(node));
+	sindex = sexp_ship_lookup(node);
 	if (sindex < 0) 
 	{
 		return 0;
@@ -15968,7 +16234,7 @@ void sexp_set_secondary_ammo (int node)
 	int rearm_limit = -1;
 
 	// Check that a ship has been supplied
-	sindex = ship_name_lookup(CTEXT(node));
+	sindex = sexp_ship_lookup(node);
 	if (sindex < 0) 
 	{
 		return ;
@@ -16079,7 +16345,7 @@ void sexp_set_weapon(int node, bool primary)
 	Assert(node != -1);
 
 	// Check that a ship has been supplied
-	sindex = ship_name_lookup(CTEXT(node));
+	sindex = sexp_ship_lookup(node);
 	if (sindex < 0)
 	{
 		return;
@@ -16283,7 +16549,7 @@ void sexp_change_subsystem_name(int node)
 	Assert (node != -1);
 
 	// Check that a ship has been supplied
-	ship_index = ship_name_lookup(CTEXT(node));
+	ship_index = sexp_ship_lookup(node);
 	if (ship_index < 0) {
 		return;
 	}
@@ -16358,7 +16624,7 @@ void sexp_change_ship_class(int n)
 	// all ships in the sexp
 	for ( ; n != -1; n = CDR(n))
 	{
-		ship_num = ship_name_lookup(CTEXT(n), 1);
+		ship_num = sexp_ship_lookup(n, 1);
 
 		// If the ship hasn't arrived we still want the ability to change its class.
 		if (ship_num == -1)
@@ -16543,7 +16809,7 @@ void sexp_ship_copy_damage(int node)
 	p_object *target_pobjp;
 
 	// source ship must be present
-	source_shipnum = ship_name_lookup(CTEXT(node));
+	source_shipnum = sexp_ship_lookup(node);
 	if (source_shipnum < 0)
 		return;
 
@@ -16551,7 +16817,7 @@ void sexp_ship_copy_damage(int node)
 	for (n = CDR(node); n != -1; n = CDR(n))
 	{
 		// maybe it's present in-mission
-		target_shipnum = ship_name_lookup(CTEXT(n));
+		target_shipnum = sexp_ship_lookup(n);
 		if (target_shipnum >= 0)
 		{
 			ship_copy_damage(&Ships[target_shipnum], &Ships[source_shipnum]);
@@ -16579,7 +16845,7 @@ void sexp_activate_deactivate_glow_points(int n, bool activate)
 
 	for ( ; n != -1; n = CDR(n))
 	{
-		sindex = ship_name_lookup(CTEXT(n), 1);
+		sindex = sexp_ship_lookup(n, 1);
 		if (sindex >= 0)
 		{
 			for (i = 0; i < Ships[sindex].glow_point_bank_active.size(); i++)
@@ -16593,7 +16859,7 @@ void sexp_activate_deactivate_glow_point_bank(int n, bool activate)
 {
 	int sindex, num;
 
-	sindex = ship_name_lookup(CTEXT(n), 1);
+	sindex = sexp_ship_lookup(n, 1);
 	if (sindex >= 0)
 	{
 		for ( n = CDR(n); n != -1; n = CDR(n))
@@ -16615,7 +16881,7 @@ void sexp_activate_deactivate_glow_maps(int n, int activate)
 
 	for ( ; n != -1; n = CDR(n))
 	{
-		sindex = ship_name_lookup(CTEXT(n), 1);
+		sindex = sexp_ship_lookup(n, 1);
 		if (sindex >= 0)
 		{
 			shipp = &Ships[sindex];
@@ -16791,7 +17057,7 @@ void sexp_beam_fire(int node, bool at_coords)
 	fire_info.accuracy = 0.000001f;							// this will guarantee a hit
 
 	// get the firing ship
-	sindex = ship_name_lookup(CTEXT(n));
+	sindex = sexp_ship_lookup(n);
 	n = CDR(n);
 	if (sindex < 0) {
 		return;
@@ -16821,7 +17087,7 @@ void sexp_beam_fire(int node, bool at_coords)
 		fire_info.target_subsys = NULL;
 	} else {
 		// get the target
-		sindex = ship_name_lookup(CTEXT(n));
+		sindex = sexp_ship_lookup(n);
 		n = CDR(n);
 		if (sindex < 0) {
 			return;
@@ -16918,7 +17184,7 @@ void sexp_beam_floating_fire(int n)
 	fire_info.shooter = NULL;
 	if (stricmp(CTEXT(n), SEXP_NONE_STRING))
 	{
-		sindex = ship_name_lookup(CTEXT(n));
+		sindex = sexp_ship_lookup(n);
 
 		if (sindex >= 0)
 			fire_info.shooter = &Objects[Ships[sindex].objnum];
@@ -16941,7 +17207,7 @@ void sexp_beam_floating_fire(int n)
 	sindex = -1;
 	if (stricmp(CTEXT(n), SEXP_NONE_STRING))
 	{
-		sindex = ship_name_lookup(CTEXT(n));
+		sindex = sexp_ship_lookup(n);
 
 		if (sindex >= 0)
 			fire_info.target = &Objects[Ships[sindex].objnum];
@@ -16995,7 +17261,7 @@ void sexp_beam_free(int node)
 	ship_subsys *turret = NULL;	
 
 	// get the firing ship
-	sindex = ship_name_lookup(CTEXT(node));
+	sindex = sexp_ship_lookup(node);
 	if(sindex < 0){
 		return;
 	}
@@ -17026,7 +17292,7 @@ void sexp_set_thrusters(int node)
 	node = CDR(node);
 
 	for(; node >= 0; node = CDR(node)) {
-		int sindex = ship_name_lookup(CTEXT(node));
+		int sindex = sexp_ship_lookup(node);
 		
 		if (sindex < 0) {
 			continue;
@@ -17080,7 +17346,7 @@ void sexp_beam_lock(int node)
 	ship_subsys *turret = NULL;	
 
 	// get the firing ship
-	sindex = ship_name_lookup(CTEXT(node));
+	sindex = sexp_ship_lookup(node);
 	if(sindex < 0){
 		return;
 	}
@@ -17139,7 +17405,7 @@ void sexp_turret_free(int node)
 	ship_subsys *turret = NULL;	
 
 	// get the firing ship
-	sindex = ship_name_lookup(CTEXT(node));
+	sindex = sexp_ship_lookup(node);
 	if(sindex < 0){
 		return;
 	}
@@ -17203,7 +17469,7 @@ void sexp_turret_lock(int node)
 	ship_subsys *turret = NULL;	
 
 	// get the firing ship
-	sindex = ship_name_lookup(CTEXT(node));
+	sindex = sexp_ship_lookup(node);
 	if(sindex < 0){
 		return;
 	}
@@ -17262,7 +17528,7 @@ void sexp_turret_tagged_only_all(int node)
 	int sindex;
 
 	// get the firing ship
-	sindex = ship_name_lookup(CTEXT(node));
+	sindex = sexp_ship_lookup(node);
 	if(sindex < 0){
 		return;
 	}
@@ -17289,7 +17555,7 @@ void sexp_turret_tagged_clear_all(int node)
 	int sindex;
 
 	// get the firing ship
-	sindex = ship_name_lookup(CTEXT(node));
+	sindex = sexp_ship_lookup(node);
 	if(sindex < 0){
 		return;
 	}
@@ -17318,7 +17584,7 @@ void sexp_turret_change_weapon(int node)
 	ship_weapon *swp = NULL;
 
 	// get the firing ship
-	sindex = ship_name_lookup(CTEXT(node));
+	sindex = sexp_ship_lookup(node);
 	if(sindex < 0 || Ships[sindex].objnum < 0){
 		return;
 	}
@@ -17408,7 +17674,7 @@ void sexp_set_armor_type(int node)
 	ship_info *sip = NULL;
 
 	// get ship
-	sindex = ship_name_lookup(CTEXT(node));
+	sindex = sexp_ship_lookup(node);
 	if(sindex < 0) {
 		return;
 	}
@@ -17556,7 +17822,7 @@ void sexp_ship_set_damage_type(int node)
 	while(node != -1)
 	{
 		// get the ship
-		sindex = ship_name_lookup(CTEXT(node));
+		sindex = sexp_ship_lookup(node);
 		if(sindex >= 0) 
 		{
 			shipp = &Ships[sindex];
@@ -17662,7 +17928,7 @@ void sexp_turret_set_target_order(int node)
 	int i;
 
 	// get ship
-	sindex = ship_name_lookup(CTEXT(node));
+	sindex = sexp_ship_lookup(node);
 	if(sindex < 0){
 		return;
 	}
@@ -17706,7 +17972,7 @@ void sexp_turret_set_direction_preference(int node)
 	ship_subsys *turret = NULL;	
 	
 	// get ship
-	sindex = ship_name_lookup(CTEXT(node));
+	sindex = sexp_ship_lookup(node);
 	if(sindex < 0){
 		return;
 	}
@@ -17750,7 +18016,7 @@ void sexp_turret_set_rate_of_fire(int node)
 	ship_subsys *turret = NULL;	
 	
 	// get ship
-	sindex = ship_name_lookup(CTEXT(node));
+	sindex = sexp_ship_lookup(node);
 	if(sindex < 0){
 		return;
 	}
@@ -17789,7 +18055,7 @@ void sexp_turret_set_optimum_range(int node)
 	ship_subsys *turret = NULL;	
 	
 	// get ship
-	sindex = ship_name_lookup(CTEXT(node));
+	sindex = sexp_ship_lookup(node);
 	if(sindex < 0){
 		return;
 	}
@@ -17830,7 +18096,7 @@ void sexp_turret_set_target_priorities(int node)
 	int j;
 
 	// get ship
-	sindex = ship_name_lookup(CTEXT(node));
+	sindex = sexp_ship_lookup(node);
 	if(sindex < 0){
 		return;
 	}
@@ -17886,7 +18152,7 @@ void sexp_ship_turret_target_order(int node)
 	int new_target_order[NUM_TURRET_ORDER_TYPES];
 
 	// get ship
-	sindex = ship_name_lookup(CTEXT(node));
+	sindex = sexp_ship_lookup(node);
 	if(sindex < 0){
 		return;
 	}
@@ -17935,7 +18201,7 @@ int sexp_get_turret_primary_ammo(int node)
 	ship_weapon *swp;
 	int bank, check, ammo_left = 0;
 
-	sindex = ship_name_lookup(CTEXT(node));
+	sindex = sexp_ship_lookup(node);
 	if (sindex < 0) {
 		return 0;
 	}
@@ -17992,7 +18258,7 @@ void sexp_set_turret_primary_ammo(int node)
 	int requested_weapons;
 
 	// Check that a ship has been supplied
-	sindex = ship_name_lookup(CTEXT(node));
+	sindex = sexp_ship_lookup(node);
 	if (sindex < 0)
 	{
 		return;
@@ -18090,7 +18356,7 @@ int sexp_get_turret_secondary_ammo(int node)
 	ship_weapon *swp;
 	int bank, check, ammo_left = 0;
 
-	sindex = ship_name_lookup(CTEXT(node));
+	sindex = sexp_ship_lookup(node);
 	if (sindex < 0) {
 		return 0;
 	}
@@ -18139,7 +18405,7 @@ void sexp_set_turret_secondary_ammo(int node)
 	int requested_weapons;
 
 	// Check that a ship has been supplied
-	sindex = ship_name_lookup(CTEXT(node));
+	sindex = sexp_ship_lookup(node);
 	if (sindex < 0)
 	{
 		return;
@@ -18232,7 +18498,7 @@ void sexp_set_subsys_rotation_lock_free(int node, bool locked)
 	ship_subsys *rotate;
 
 	// get the ship
-	ship_num = ship_name_lookup(CTEXT(node));
+	ship_num = sexp_ship_lookup(node);
 	if (ship_num < 0)
 		return;
 	
@@ -18277,7 +18543,7 @@ void sexp_reverse_rotating_subsystem(int node)
 	ship_subsys *rotate;
 
 	// get the ship
-	ship_num = ship_name_lookup(CTEXT(node));
+	ship_num = sexp_ship_lookup(node);
 	if (ship_num < 0)
 		return;
 	
@@ -18309,7 +18575,7 @@ void sexp_rotating_subsys_set_turn_time(int node)
 	ship_subsys *rotate;
 
 	// get the ship
-	ship_num = ship_name_lookup(CTEXT(n));
+	ship_num = sexp_ship_lookup(n);
 	if (ship_num < 0)
 		return;
 	if (Ships[ship_num].objnum < 0)
@@ -18343,7 +18609,7 @@ void sexp_trigger_submodel_animation(int node)
 	bool instant;
 
 	// get the ship
-	ship_num = ship_name_lookup(CTEXT(n));
+	ship_num = sexp_ship_lookup(n);
 	if (ship_num < 0)
 		return;
 	if (Ships[ship_num].objnum < 0)
@@ -18404,7 +18670,7 @@ void sexp_turret_tagged_specific(int node)
 	int sindex;
 
 	// get the firing ship
-	sindex = ship_name_lookup(CTEXT(node));
+	sindex = sexp_ship_lookup(node);
 	if(sindex < 0){
 		return;
 	}
@@ -18431,7 +18697,7 @@ void sexp_turret_tagged_clear_specific(int node)
 	int sindex;
 
 	// get the firing ship
-	sindex = ship_name_lookup(CTEXT(node));
+	sindex = sexp_ship_lookup(node);
 	if(sindex < 0){
 		return;
 	}
@@ -18458,7 +18724,7 @@ void sexp_add_remove_escort(int node)
 	int flag;
 
 	// get the firing ship
-	sindex = ship_name_lookup(CTEXT(node));
+	sindex = sexp_ship_lookup(node);
 	if(sindex < 0){
 		return;
 	}
@@ -18529,7 +18795,7 @@ void sexp_damage_escort_list(int node)
 		if ( mission_log_get_time(LOG_SHIP_DEPARTED, CTEXT(n), NULL, NULL) || mission_log_get_time(LOG_SHIP_DESTROYED, CTEXT(n), NULL, NULL) || mission_log_get_time(LOG_SELF_DESTRUCTED, CTEXT(n), NULL, NULL) )
 			continue;
 
-		shipnum=ship_name_lookup(CTEXT(n));
+		shipnum=sexp_ship_lookup(n);
 		
 		//it may be dead
 		if (shipnum < 0)
@@ -18967,7 +19233,7 @@ void sexp_awacs_set_radius(int node)
 	ship_subsys *awacs;
 
 	// get the firing ship
-	sindex = ship_name_lookup(CTEXT(node));
+	sindex = sexp_ship_lookup(node);
 	if(sindex < 0){
 		return;
 	}
@@ -19427,7 +19693,7 @@ int sexp_is_tagged(int node)
 	int sindex;
 
 	// get the firing ship
-	sindex = ship_name_lookup(CTEXT(node));
+	sindex = sexp_ship_lookup(node);
 	if(sindex < 0){
 		return SEXP_FALSE;
 	}
@@ -19499,7 +19765,7 @@ int sexp_is_player (int node)
 	int standard_check = is_sexp_true(node);
 
 	if (!(Game_mode & GM_MULTIPLAYER)){	
-		sindex = ship_name_lookup(CTEXT(CDR(node)));
+		sindex = sexp_ship_lookup(CDR(node));
 
 		// There can only be one player ship in singleplayer so if more than one ship is specifed the sexp is false
 		if (CDDR(node) < 0 ) {
@@ -19526,7 +19792,7 @@ int sexp_is_player (int node)
 			// reset the netplayer index
 			np_index = -1; 
 
-			sindex = ship_name_lookup(CTEXT(node));
+			sindex = sexp_ship_lookup(node);
 			if(sindex >= 0){
 				if(Ships[sindex].objnum >= 0) {
 					// try and find the player
@@ -19658,7 +19924,7 @@ int sexp_return_player_data(int node, int type)
 	player *p = NULL;
 	p_object *p_objp;
 
-	sindex = ship_name_lookup(CTEXT(node));
+	sindex = sexp_ship_lookup(node);
 
 	if(Game_mode & GM_MULTIPLAYER){			
 		if(sindex >= 0){
@@ -19759,7 +20025,7 @@ int sexp_num_type_kills(int node)
 	player *p = NULL;
 
 	// get the ship we're interested in
-	sindex = ship_name_lookup(CTEXT(node));
+	sindex = sexp_ship_lookup(node);
 	if(sindex < 0){
 		return 0;
 	}
@@ -19814,7 +20080,7 @@ int sexp_num_class_kills(int node)
 	player *p = NULL;
 
 	// get the ship we're interested in
-	sindex = ship_name_lookup(CTEXT(node));
+	sindex = sexp_ship_lookup(node);
 	if(sindex < 0){
 		return 0;
 	}
@@ -19862,7 +20128,7 @@ void sexp_subsys_set_random(int node)
 	ship *shipp;
 
 	// get ship
-	sindex = ship_name_lookup(CTEXT(node));
+	sindex = sexp_ship_lookup(node);
 	if(sindex < 0){
 		return;
 	}
@@ -19937,7 +20203,7 @@ int sexp_is_secondary_selected(int node)
 	ship *shipp;
 
 	// lookup ship
-	sindex = ship_name_lookup(CTEXT(node));
+	sindex = sexp_ship_lookup(node);
 	if(sindex < 0){
 		return SEXP_FALSE;
 	}
@@ -19968,7 +20234,7 @@ int sexp_is_primary_selected(int node)
 	ship *shipp;
 
 	// lookup ship
-	sindex = ship_name_lookup(CTEXT(node));
+	sindex = sexp_ship_lookup(node);
 	if(sindex < 0){
 		return SEXP_FALSE;
 	}
@@ -20234,7 +20500,7 @@ void sexp_int_to_string(int n)
 
 	// get sexp_variable index
 	Assert(Sexp_nodes[n].first == -1);
-	sexp_variable_index = atoi(Sexp_nodes[n].text);
+	sexp_variable_index = sexp_node_variable_index(n);
 
 	// verify variable set
 	Assert(Sexp_variables[sexp_variable_index].type & SEXP_VARIABLE_SET);
@@ -20270,7 +20536,7 @@ void sexp_string_concatenate(int n)
 
 	// get sexp_variable index
 	Assert(Sexp_nodes[n].first == -1);
-	sexp_variable_index = atoi(Sexp_nodes[n].text);
+	sexp_variable_index = sexp_node_variable_index(n);
 
 	// verify variable set
 	Assert(Sexp_variables[sexp_variable_index].type & SEXP_VARIABLE_SET);
@@ -20323,7 +20589,7 @@ void sexp_string_get_substring(int node)
 
 	// get sexp_variable index
 	Assert(Sexp_nodes[n].first == -1);
-	sexp_variable_index = atoi(Sexp_nodes[n].text);
+	sexp_variable_index = sexp_node_variable_index(n);
 
 	// verify variable set
 	Assert(Sexp_variables[sexp_variable_index].type & SEXP_VARIABLE_SET);
@@ -20378,7 +20644,7 @@ void sexp_string_set_substring(int node)
 
 	// get sexp_variable index
 	Assert(Sexp_nodes[n].first == -1);
-	sexp_variable_index = atoi(Sexp_nodes[n].text);
+	sexp_variable_index = sexp_node_variable_index(n);
 
 	// verify variable set
 	Assert(Sexp_variables[sexp_variable_index].type & SEXP_VARIABLE_SET);
@@ -22007,7 +22273,7 @@ int sexp_script_eval(int node, int return_type, bool concat_args = false)
 				if (n != -1 && success)
 				{
 					Assert(Sexp_nodes[n].first == -1);
-					int variable_index = atoi(Sexp_nodes[n].text);
+					int variable_index = sexp_node_variable_index(n);
 
 					// verify variable set
 					Assert(Sexp_variables[variable_index].type & SEXP_VARIABLE_SET);
@@ -22107,7 +22373,7 @@ void sexp_script_eval_multi(int node)
 				}
 				// otherwise notify the clients
 				else {
-					sindex = ship_name_lookup(CTEXT(node));
+					sindex = sexp_ship_lookup(node);
 					Current_sexp_network_packet.send_ship(sindex);
 				}
 			}
@@ -22162,7 +22428,7 @@ void sexp_force_glide(int node)
 	int sindex;
 
 	// get ship
-	sindex = ship_name_lookup(CTEXT(node));
+	sindex = sexp_ship_lookup(node);
 
 	if (sindex < 0) {
 		return;
@@ -22238,7 +22504,7 @@ int sexp_is_in_box(int n)
 	object* reference_ship_obj = NULL;
 	if (n != -1)
 	{
-		int sindex = ship_name_lookup(CTEXT(n));
+		int sindex = sexp_ship_lookup(n);
 
 		if (sindex < 0 || Ships[sindex].objnum < 0)
 			return SEXP_FALSE;
@@ -22270,7 +22536,7 @@ int sexp_is_in_box(int n)
 int sexp_is_in_mission(int node)
 {
 	for (int n = node; n != -1; n = CDR(n))
-		if (ship_name_lookup(CTEXT(n)) < 0)
+		if (sexp_ship_lookup(n) < 0)
 			return SEXP_FALSE;
 
 	return SEXP_TRUE;
@@ -22471,7 +22737,7 @@ void sexp_call_ssm_strike(int node) {
 		return;
 
 	for (int n = node; n != -1; n = CDR(n)) {
-		int ship_num = ship_name_lookup(CTEXT(n));
+		int ship_num = sexp_ship_lookup(n);
 		// don't do anything if the ship isn't there
 		if (ship_num >= 0) {
 			int obj_num = Ships[ship_num].objnum;
@@ -22759,6 +23025,403 @@ void add_to_event_log_buffer(int op_num, int result)
 /**
  * High-level sexpression evaluator
  */
+// Side effect free arithmetic and comparisons are compiled into a flat program for a small stack machine the first
+// time they are evaluated.  Literals are converted once, constant subtrees are folded into a single value and variables
+// are read straight from their slot.  The tree stays the source of truth: FRED never compiles anything, and whenever
+// an operator inside the program would return one of the special sexp values the tree is walked instead.
+static bool sexp_is_compilable_operator(int op_num)
+{
+	switch (op_num)
+	{
+		case OP_PLUS:
+		case OP_MINUS:
+		case OP_MUL:
+		case OP_DIV:
+		case OP_MOD:
+		case OP_ABS:
+		case OP_MIN:
+		case OP_MAX:
+		case OP_EQUALS:
+		case OP_GREATER_THAN:
+		case OP_LESS_THAN:
+		case OP_NOT_EQUAL:
+		case OP_GREATER_OR_EQUAL:
+		case OP_LESS_OR_EQUAL:
+			return true;
+
+		default:
+			return false;
+	}
+}
+
+// replaces the count values on top of the stack with the result of the operator, fails if eval_sexp() would give that
+// result any special treatment
+static bool sexp_program_apply(SCP_vector<int> &stack, int op_num, int count)
+{
+	int *args = &stack[stack.size() - count];
+	int result = args[0];
+	int i;
+
+	switch (op_num)
+	{
+		case OP_PLUS:
+			for (i = 1; i < count; i++)
+				result += args[i];
+			break;
+
+		case OP_MINUS:
+			for (i = 1; i < count; i++)
+				result -= args[i];
+			break;
+
+		case OP_MUL:
+			for (i = 1; i < count; i++)
+				result *= args[i];
+			break;
+
+		case OP_DIV:
+			for (i = 1; i < count; i++)
+			{
+				if (args[i] == 0) {
+					Warning(LOCATION, "Division by zero in sexp. Please check all uses of the / operator for possible causes.\n");
+					Int3();
+					continue;
+				}
+				result /= args[i];
+			}
+			break;
+
+		case OP_MOD:
+			for (i = 1; i < count; i++)
+			{
+				if (args[i] == 0) {
+					Warning(LOCATION, "Division by zero in sexp. Please check all uses of the mod operator for possible causes.\n");
+					Int3();
+					continue;
+				}
+				result %= args[i];
+			}
+			break;
+
+		case OP_ABS:
+			result = abs(result);
+			break;
+
+		case OP_MIN:
+			for (i = 1; i < count; i++)
+				result = MIN(result, args[i]);
+			break;
+
+		case OP_MAX:
+			for (i = 1; i < count; i++)
+				result = MAX(result, args[i]);
+			break;
+
+		default:
+			result = SEXP_TRUE;
+			for (i = 1; i < count; i++)
+			{
+				if (!sexp_compare_numbers(op_num, args[0], args[i])) {
+					result = SEXP_FALSE;
+					break;
+				}
+			}
+			break;
+	}
+
+	stack.resize(stack.size() - count);
+
+	if ((result >= SEXP_KNOWN_FALSE) && (result <= SEXP_NUM_EVAL))
+		return false;
+
+	stack.push_back(result);
+	return true;
+}
+
+// runs the instructions from start to the end of the program
+static bool sexp_program_run(const SCP_vector<sexp_instruction> &instructions, size_t start, int &result)
+{
+	auto &stack = Sexp_program_stack;
+	stack.clear();
+
+	for (size_t i = start; i < instructions.size(); i++)
+	{
+		auto &instruction = instructions[i];
+
+		switch (instruction.code)
+		{
+			case SIC_CONSTANT:
+				stack.push_back(instruction.value);
+				break;
+
+			case SIC_VARIABLE:
+				stack.push_back(atoi(Sexp_variables[instruction.value].text));
+				break;
+
+			case SIC_OPERATOR:
+				if (!sexp_program_apply(stack, instruction.value, instruction.count))
+					return false;
+				break;
+
+			case SIC_POSITIVE:
+				if (stack.back() < 0)
+					stack.back() *= -1;
+				break;
+		}
+	}
+
+	Assert(stack.size() == 1);
+	result = stack.back();
+	return true;
+}
+
+static bool sexp_compile_operator(sexp_program &program, int op_node, bool &constant);
+
+// appends the instructions for an argument of an operator
+static bool sexp_compile_argument(sexp_program &program, int node, int parent_op_index, int argnum, bool &constant)
+{
+	if (Sexp_nodes[node].first != -1)
+	{
+		if (!sexp_compile_operator(program, CAR(node), constant))
+			return false;
+
+		// this is what eval_sexp() does with a negative value of the operator
+		if (query_operator_argument_type(parent_op_index, argnum) == OPF_POSITIVE)
+		{
+			if (!constant)
+				program.instructions.push_back({ SIC_POSITIVE, 0, 0 });
+			else if (program.instructions.back().value < 0)
+				program.instructions.back().value *= -1;
+		}
+
+		return true;
+	}
+
+	if ((SEXP_NODE_TYPE(node) != SEXP_ATOM) || !strcmp(Sexp_nodes[node].text, SEXP_ARGUMENT_STRING))
+		return false;
+
+	if (Sexp_nodes[node].type & SEXP_FLAG_VARIABLE)
+	{
+		program.instructions.push_back({ SIC_VARIABLE, sexp_node_variable_index(node), 0 });
+		constant = false;
+		return true;
+	}
+
+	if (Sexp_nodes[node].subtype != SEXP_ATOM_NUMBER)
+		return false;
+
+	program.instructions.push_back({ SIC_CONSTANT, atoi(Sexp_nodes[node].text), 0 });
+	constant = true;
+	return true;
+}
+
+// appends the instructions for an operator and its arguments, folding them into a constant if nothing can change
+static bool sexp_compile_operator(sexp_program &program, int op_node, bool &constant)
+{
+	int op_num = get_operator_const(op_node);
+	int op_index = Sexp_nodes[op_node].op_index;
+	size_t start = program.instructions.size();
+	int count = 0;
+
+	if (!sexp_is_compilable_operator(op_num))
+		return false;
+
+	constant = true;
+
+	for (int n = CDR(op_node); n != -1; n = CDR(n))
+	{
+		bool arg_constant;
+
+		if (!sexp_compile_argument(program, n, op_index, count, arg_constant))
+			return false;
+
+		constant = constant && arg_constant;
+		count++;
+
+		// abs_sexp() ignores any further arguments
+		if (op_num == OP_ABS)
+			break;
+	}
+
+	// leave the error handling for broken sexps to the tree
+	if (count == 0)
+		return false;
+
+	program.instructions.push_back({ SIC_OPERATOR, op_num, count });
+
+	if (constant)
+	{
+		int value;
+
+		if (!sexp_program_run(program.instructions, start, value))
+			return false;
+
+		program.instructions.resize(start);
+		program.instructions.push_back({ SIC_CONSTANT, value, 0 });
+	}
+
+	return true;
+}
+
+/**
+ * Evaluates an operator through its compiled program, the program is compiled on the first call
+ *
+ * @param node The operator node
+ * @param op_num The operator of the node
+ * @param result The value of the operator, already made positive if the parent wants it that way
+ * @return false if the node has to be evaluated by walking the tree
+ */
+static bool eval_sexp_program(int node, int op_num, int &result)
+{
+	int index = Sexp_nodes[node].program;
+
+	if (index == SEXP_PROGRAM_NONE)
+		return false;
+
+	// persistent nodes may still refer to a program of an earlier mission
+	if ((index < 0) || (index >= (int)Sexp_programs.size()) || (Sexp_programs[index].root != node))
+	{
+		sexp_program program;
+		bool constant;
+
+		if (Fred_running || !sexp_is_compilable_operator(op_num) || !sexp_compile_operator(program, node, constant))
+		{
+			Sexp_nodes[node].program = SEXP_PROGRAM_NONE;
+			return false;
+		}
+
+		program.root = node;
+		program.positive = false;
+
+		// this is what eval_sexp() would otherwise look up every time the value is negative
+		int parent_node = find_parent_operator(node);
+		if (parent_node >= 0)
+		{
+			int arg_num = find_argnum(parent_node, node);
+			if (arg_num >= 0)
+				program.positive = (query_operator_argument_type(get_operator_index(parent_node), arg_num) == OPF_POSITIVE);
+		}
+
+		index = (int)Sexp_programs.size();
+		Sexp_programs.push_back(std::move(program));
+		Sexp_nodes[node].program = index;
+	}
+
+	auto &program = Sexp_programs[index];
+
+	if (!sexp_program_run(program.instructions, 0, result))
+		return false;
+
+	if (program.positive && (result < 0))
+		result *= -1;
+
+	return true;
+}
+
+/**
+ * Stores the value of an operator in its node and converts it to the value eval_sexp() returns
+ *
+ * @param cur_node The operator node
+ * @param sexp_val The value the operator returned
+ * @param reconcile_sign Whether a negative value has to be made positive if the parent of the node wants that
+ */
+static int eval_sexp_result(int cur_node, int sexp_val, bool reconcile_sign)
+{
+	// if we haven't returned, check the sexp value of the sexpression evaluation.  A special
+	// value of known true or known false means that we should set the sexp.value field for
+	// short circuit eval.
+	if (sexp_val == SEXP_KNOWN_TRUE) {
+		Sexp_nodes[cur_node].value = SEXP_KNOWN_TRUE;
+		return SEXP_TRUE;
+	}
+
+	if (sexp_val == SEXP_KNOWN_FALSE) {
+		Sexp_nodes[cur_node].value = SEXP_KNOWN_FALSE;
+		return SEXP_FALSE;
+	}
+
+	if ( sexp_val == SEXP_NAN ) {
+		Sexp_nodes[cur_node].value = SEXP_NAN;			// not a number values are false I would suspect
+		return SEXP_FALSE;
+	}
+
+	if ( sexp_val == SEXP_NAN_FOREVER ) {
+		Sexp_nodes[cur_node].value = SEXP_NAN_FOREVER;
+		return SEXP_FALSE;	// Goober5000 changed from sexp_val to SEXP_FALSE on 2/21/2006 in accordance with above comment
+	}
+
+	if ( sexp_val == SEXP_CANT_EVAL ) {
+		Sexp_nodes[cur_node].value = SEXP_CANT_EVAL;
+		Sexp_useful_number = 0;  // indicate sexp isn't current yet
+		return SEXP_FALSE;
+	}
+
+	if ( Sexp_nodes[cur_node].value == SEXP_NAN ) {	// if we had a nan, but now don't, reset the value
+		Sexp_nodes[cur_node].value = SEXP_UNKNOWN;
+		return sexp_val;
+	}
+
+	// now, reconcile positive and negative - Goober5000
+	if (reconcile_sign && (sexp_val < 0))
+	{
+		int parent_node = find_parent_operator(cur_node);
+
+		// if the SEXP has no parent, the point is moot
+		if (parent_node >= 0)
+		{
+			int arg_num = find_argnum(parent_node, cur_node);
+			Assertion(arg_num >= 0, "Error finding sexp argument.  The SEXP is not listed among its parent's children.");
+
+			// if we need a positive value, make it positive
+			if (query_operator_argument_type(get_operator_index(parent_node), arg_num) == OPF_POSITIVE)
+			{
+				sexp_val *= -1;
+			}
+		}
+	}
+
+	if ( sexp_val ){
+		Sexp_nodes[cur_node].value = SEXP_TRUE;
+	} else {
+		Sexp_nodes[cur_node].value = SEXP_FALSE;
+	}
+
+	return sexp_val;
+}
+
+// the results of the pure operators, see sexp_pure_results_begin()
+static bool Sexp_pure_results_active = false;
+static SCP_unordered_map<SCP_string, int> Sexp_pure_results;
+
+void sexp_pure_results_begin()
+{
+	Sexp_pure_results.clear();
+	Sexp_pure_results_active = true;
+}
+
+void sexp_pure_results_end()
+{
+	Sexp_pure_results.clear();
+	Sexp_pure_results_active = false;
+}
+
+// builds the key the result of an operator is remembered under, which only works if every argument is a plain value
+static bool sexp_pure_result_key(int op_num, int node, SCP_string &key)
+{
+	key.assign(reinterpret_cast<const char*>(&op_num), sizeof(op_num));
+
+	for (int n = node; n != -1; n = CDR(n)) {
+		if (Sexp_nodes[n].first != -1) {
+			return false;
+		}
+
+		key += CTEXT(n);
+		key += '\0';
+	}
+
+	return true;
+}
+
 int eval_sexp(int cur_node, int referenced_node)
 {
 	int node, type, sexp_val = UNINITIALIZED;
@@ -22808,6 +23471,29 @@ int eval_sexp(int cur_node, int referenced_node)
 		node = CDR(cur_node);		// makes reading the next bit of code a little easier.
 
 		op_num = get_operator_const(cur_node);
+
+		// arithmetic and comparisons run as a compiled program unless every operator has to be logged
+		if (!Log_event && eval_sexp_program(cur_node, op_num, sexp_val)) {
+			return eval_sexp_result(cur_node, sexp_val, false);
+		}
+
+		// pure operators give the same result for the same arguments until something changes the mission
+		SCP_string pure_key;
+		bool remember_result = false;
+		if (Sexp_pure_results_active && op_num && !Log_event) {
+			if (Operators[get_operator_index(cur_node)].type & SEXP_PURE_OPERATOR) {
+				if (sexp_pure_result_key(op_num, node, pure_key)) {
+					auto it = Sexp_pure_results.find(pure_key);
+					if (it != Sexp_pure_results.end()) {
+						return eval_sexp_result(cur_node, it->second, true);
+					}
+					remember_result = true;
+				}
+			} else if ((query_operator_return_type(op_num) == OPR_NULL) || (op_num == OP_SCRIPT_EVAL_NUM) || (op_num == OP_SCRIPT_EVAL_STRING)) {
+				Sexp_pure_results.clear();
+			}
+		}
+
 		// add the op_num to the stack if it is an actual operator rather than a number
 		if (op_num) {
 			Current_sexp_operator.push_back(op_num); 
@@ -24997,66 +25683,11 @@ int eval_sexp(int cur_node, int referenced_node)
 
 		Assert(sexp_val != UNINITIALIZED);		
 
-		// if we haven't returned, check the sexp value of the sexpression evaluation.  A special
-		// value of known true or known false means that we should set the sexp.value field for
-		// short circuit eval.
-		if (sexp_val == SEXP_KNOWN_TRUE) {
-			Sexp_nodes[cur_node].value = SEXP_KNOWN_TRUE;
-			return SEXP_TRUE;
-		}
-
-		if (sexp_val == SEXP_KNOWN_FALSE) {
-			Sexp_nodes[cur_node].value = SEXP_KNOWN_FALSE;
-			return SEXP_FALSE;
-		}
-
-		if ( sexp_val == SEXP_NAN ) {
-			Sexp_nodes[cur_node].value = SEXP_NAN;			// not a number values are false I would suspect
-			return SEXP_FALSE;
-		}
-
-		if ( sexp_val == SEXP_NAN_FOREVER ) {
-			Sexp_nodes[cur_node].value = SEXP_NAN_FOREVER;
-			return SEXP_FALSE;	// Goober5000 changed from sexp_val to SEXP_FALSE on 2/21/2006 in accordance with above comment
-		}
-
-		if ( sexp_val == SEXP_CANT_EVAL ) {
-			Sexp_nodes[cur_node].value = SEXP_CANT_EVAL;
-			Sexp_useful_number = 0;  // indicate sexp isn't current yet
-			return SEXP_FALSE;
+		if (remember_result) {
+			Sexp_pure_results[pure_key] = sexp_val;
 		}
 
-		if ( Sexp_nodes[cur_node].value == SEXP_NAN ) {	// if we had a nan, but now don't, reset the value
-			Sexp_nodes[cur_node].value = SEXP_UNKNOWN;
-			return sexp_val;
-		}
-
-		// now, reconcile positive and negative - Goober5000
-		if (sexp_val < 0)
-		{
-			int parent_node = find_parent_operator(cur_node);
-
-			// if the SEXP has no parent, the point is moot
-			if (parent_node >= 0)
-			{
-				int arg_num = find_argnum(parent_node, cur_node);
-				Assertion(arg_num >= 0, "Error finding sexp argument.  The SEXP is not listed among its parent's children.");
-
-				// if we need a positive value, make it positive
-				if (query_operator_argument_type(get_operator_index(parent_node), arg_num) == OPF_POSITIVE)
-				{
-					sexp_val *= -1;
-				}
-			}
-		}
-
-		if ( sexp_val ){
-			Sexp_nodes[cur_node].value = SEXP_TRUE;
-		} else {
-			Sexp_nodes[cur_node].value = SEXP_FALSE;
-		}
-
-		return sexp_val;
+		return eval_sexp_result(cur_node, sexp_val, true);
 	}
 }
 
@@ -28778,7 +29409,7 @@ char *CTEXT(int n)
 		}
 		else
 		{
-			sexp_variable_index = atoi(Sexp_nodes[n].text);
+			sexp_variable_index = sexp_node_variable_index(n);
 		}
 		// Reference a Sexp_variable
 		// string format -- "Sexp_variables[xx]=number" or "Sexp_variables[xx]=string", where xx is the index
@@ -28803,12 +29434,41 @@ char *CTEXT(int n)
 /**
  * Set all Sexp_variables to type uninitialized
  */
+// The slots of the variables by the hash of their name. FRED also moves and renames variables directly, so a slot is
+// only used once the variable in it turned out to have the name, otherwise the variables are searched and the slot
+// is bound again.
+static SCP_unordered_map<uint, int> Sexp_variable_slots;
+
+static uint sexp_variable_name_hash(const char *name)
+{
+	// FNV-1a, the names are case sensitive
+	uint hash = 2166136261u;
+
+	for (auto c = name; *c != '\0'; ++c) {
+		hash ^= (uint)(unsigned char)*c;
+		hash *= 16777619u;
+	}
+
+	return hash;
+}
+
+static void sexp_variable_unbind_slot(int index)
+{
+	auto slot = Sexp_variable_slots.find(sexp_variable_name_hash(Sexp_variables[index].variable_name));
+
+	if (slot != Sexp_variable_slots.end() && slot->second == index) {
+		Sexp_variable_slots.erase(slot);
+	}
+}
+
 void init_sexp_vars()
 {
 	for (int i=0; i<MAX_SEXP_VARIABLES; i++) {
 		Sexp_variables[i].type = SEXP_VARIABLE_NOT_USED;
 		Block_variables[i].type = SEXP_VARIABLE_NOT_USED;
 	}
+
+	Sexp_variable_slots.clear();
 }
 
 /**
@@ -28845,10 +29505,17 @@ int sexp_add_variable(const char *text, const char *var_name, int type, int inde
 	}
 
 	if (index >= 0) {
+		if (Sexp_variables[index].type & SEXP_VARIABLE_SET) {
+			sexp_variable_unbind_slot(index);
+		}
+
 		strcpy_s(Sexp_variables[index].text, text);
 		strcpy_s(Sexp_variables[index].variable_name, var_name);
 		Sexp_variables[index].type &= ~SEXP_VARIABLE_NOT_USED;
 		Sexp_variables[index].type = (type | SEXP_VARIABLE_SET);
+
+		// binds the name to the first slot which has it
+		get_index_sexp_variable_name(var_name);
 	}
 
 	return index;
@@ -28948,7 +29615,7 @@ void sexp_modify_variable(int n)
 
 	// get sexp_variable index
 	Assert(Sexp_nodes[n].first == -1);
-	sexp_variable_index = atoi(Sexp_nodes[n].text);
+	sexp_variable_index = sexp_node_variable_index(n);
 
 	// verify variable set
 	Assert(Sexp_variables[sexp_variable_index].type & SEXP_VARIABLE_SET);
@@ -29115,7 +29782,7 @@ void sexp_copy_variable_from_index(int node)
 	}
 
 	// now get the variable we are modifying
-	to_index = atoi(Sexp_nodes[CDR(node)].text);
+	to_index = sexp_node_variable_index(CDR(node));
 
 	// verify variable set
 	Assert(Sexp_variables[to_index].type & SEXP_VARIABLE_SET);
@@ -29196,6 +29863,8 @@ void sexp_fred_modify_variable(const char *text, const char *var_name, int index
 	Assert(Sexp_variables[index].type & SEXP_VARIABLE_SET);
 	Assert( (type & SEXP_VARIABLE_NUMBER) || (type & SEXP_VARIABLE_STRING) );
 
+	sexp_variable_unbind_slot(index);
+
 	strcpy_s(Sexp_variables[index].text, text);
 	strcpy_s(Sexp_variables[index].variable_name, var_name);
 	Sexp_variables[index].type = (SEXP_VARIABLE_SET | SEXP_VARIABLE_MODIFIED | type);
@@ -29216,7 +29885,7 @@ int get_index_sexp_variable_from_node (int node)
 		var_index = get_index_sexp_variable_name(Sexp_nodes[node].text);
 	}
 	else {
-		var_index = atoi(Sexp_nodes[node].text);
+		var_index = sexp_node_variable_index(node);
 	}
 
 	return var_index; 
@@ -29227,10 +29896,22 @@ int get_index_sexp_variable_from_node (int node)
  */
 int get_index_sexp_variable_name(const char *text)
 {
+	uint hash = sexp_variable_name_hash(text);
+
+	auto slot = Sexp_variable_slots.find(hash);
+	if (slot != Sexp_variable_slots.end()) {
+		int i = slot->second;
+
+		if ( (Sexp_variables[i].type & SEXP_VARIABLE_SET) && !strcmp(Sexp_variables[i].variable_name, text) ) {
+			return i;
+		}
+	}
+
 	for (int i=0; i<MAX_SEXP_VARIABLES; i++) {
 		if (Sexp_variables[i].type & SEXP_VARIABLE_SET) {
 			// check case sensitive
 			if ( !strcmp(Sexp_variables[i].variable_name, text) ) {
+				Sexp_variable_slots[hash] = i;
 				return i;
 			}
 		}
@@ -29245,17 +29926,7 @@ int get_index_sexp_variable_name(const char *text)
  */
 int get_index_sexp_variable_name(SCP_string &text)
 {
-	for (int i=0; i<MAX_SEXP_VARIABLES; i++) {
-		if (Sexp_variables[i].type & SEXP_VARIABLE_SET) {
-			// check case sensitive
-			if ( text == Sexp_variables[i].variable_name ) {
-				return i;
-			}
-		}
-	}
-
-	// not found
-	return -1;
+	return get_index_sexp_variable_name(text.c_str());
 }
 
 // Goober5000 - tests whether a variable name starts here
@@ -29450,6 +30121,8 @@ void sexp_variable_delete(int index)
 {
 	Assert(Sexp_variables[index].type & SEXP_VARIABLE_SET);
 
+	sexp_variable_unbind_slot(index);
+
 	Sexp_variables[index].type = SEXP_VARIABLE_NOT_USED;
 }
 
@@ -29481,6 +30154,9 @@ int sexp_var_compare(const void *var1, const void *var2)
 void sexp_variable_sort()
 {
 	insertion_sort( (void *)Sexp_variables, (size_t)(MAX_SEXP_VARIABLES), sizeof(sexp_variable), sexp_var_compare );
+
+	// every variable may have moved
+	Sexp_variable_slots.clear();
 }
 
 /**
@@ -1030,6 +1030,7 @@ typedef struct sexp_ai_goal_link {
 #define SEXP_BOOLEAN_OPERATOR				(1<<4)
 #define SEXP_INTEGER_OPERATOR				(1<<5)
 #define SEXP_GOAL_OPERATOR					(1<<6)
+#define SEXP_PURE_OPERATOR					(1<<7)	// no side effects, see sexp_pure_results_begin()
 
 #define SEXP_TRIGGER_OPERATOR		( SEXP_ARITHMETIC_OPERATOR | SEXP_BOOLEAN_OPERATOR | SEXP_INTEGER_OPERATOR ) 
 
@@ -1049,6 +1050,12 @@ typedef struct sexp_node {
 	int	rest;						// index into Sexp_nodes of rest of parameters
 	int	value;					// known to be true, known to be false, or not known
 	int flags;					// Goober5000
+	int cache_index;			// the ship the text of this node resolved to the last time, see sexp_ship_lookup()
+	int cache_signature;		// the signature of the object of that ship
+	int program;				// the compiled form of this operator, see eval_sexp_program()
+	int variable_index;			// the slot in Sexp_variables of a variable node, -1 in FRED, see sexp_node_variable_index()
+	fix cue_earliest_time;		// a false cue stays false before this mission time, see eval_cue()
+	int cue_log_changes;		// a false cue stays false until the mission log changes from this count, -1 if it doesn't wait for the log
 } sexp_node;
 
 // Goober5000
@@ -1148,7 +1155,20 @@ extern int get_sexp_main(void);	//	Returns start node
 extern int run_sexp(const char* sexpression); // debug and lua sexps
 extern int stuff_sexp_variable_list();
 extern int eval_sexp(int cur_node, int referenced_node = -1);
+
+/**
+ * @brief Remembers the results of the pure operators until sexp_pure_results_end()
+ *
+ * In between, an operator flagged SEXP_PURE_OPERATOR whose arguments are all plain values is only evaluated once for
+ * the same arguments. Every operator which doesn't return a value forgets the results, since it may change what they
+ * depend on.
+ */
+extern void sexp_pure_results_begin();
+extern void sexp_pure_results_end();
 extern int is_sexp_true(int cur_node, int referenced_node = -1);
+extern fix sexp_event_earliest_time(int formula);
+extern void sexp_get_message_arguments(int node, SCP_vector<SCP_string> &names);
+extern int eval_cue(int cue);
 extern int query_operator_return_type(int op);
 extern int query_operator_argument_type(int op, int argnum);
 extern void update_sexp_references(const char *old_name, const char *new_name);
@@ -1179,6 +1199,7 @@ void flush_sexp_tree(int node);
 void sexp_modify_variable(const char *text, int index, bool sexp_callback = true);
 int get_index_sexp_variable_from_node (int node);
 int get_index_sexp_variable_name(const char *text);
+int sexp_node_variable_index(int node);
 int get_index_sexp_variable_name(SCP_string &text);	// Goober5000
 int get_index_sexp_variable_name_special(const char *text);	// Goober5000
 int get_index_sexp_variable_name_special(SCP_string &text, size_t startpos);	// Goober5000
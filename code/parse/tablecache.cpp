@@ -0,0 +1,201 @@
+#include "parse/tablecache.h"
+
+#include "cfile/cfile.h"
+#include "cmdline/cmdline.h"
+#include "globalincs/systemvars.h"
+#include "localization/localize.h"
+#include "tracing/tracing.h"
+
+#include <cstdint>
+
+namespace {
+
+const int TABLE_CACHE_ID = 0x43544250;	// "PBTC"
+const int TABLE_CACHE_VERSION = 1;
+const int TABLE_CACHE_END = 0x444e4543;	// "CEND"
+
+// settings which change the result of processing a table
+const int TABLE_CACHE_FRED = 1 << 0;
+const int TABLE_CACHE_POLISH = 1 << 1;
+
+// the processed text of the last mission, restarting a mission loads the same file again
+struct mission_text_entry {
+	SCP_string filename;
+	uint checksum = 0;
+	size_t raw_len = 0;
+	SCP_vector<char> processed_text;
+};
+
+mission_text_entry Last_mission_text;
+
+struct table_cache_header {
+	int id;
+	int version;
+	int settings;
+	uint checksum;
+	uint64_t raw_len;
+	uint64_t processed_len;
+};
+
+SCP_string table_cache_filename(const char* filename)
+{
+	SCP_string name = filename;
+
+	auto dot = name.rfind('.');
+	if (dot != SCP_string::npos) {
+		// keep the extension so a table and a modular table of the same name don't share a file
+		name[dot] = '_';
+	}
+
+	return name + ".ptc";
+}
+
+int table_cache_settings()
+{
+	int settings = 0;
+
+	// the foreign characters are converted differently in these cases, see maybe_convert_foreign_characters()
+	if (Fred_running) {
+		settings |= TABLE_CACHE_FRED;
+	}
+	if (Lcl_pl) {
+		settings |= TABLE_CACHE_POLISH;
+	}
+
+	return settings;
+}
+
+}
+
+bool table_cache_enabled(int mode)
+{
+	switch (mode) {
+	case CF_TYPE_TABLES:
+		return Cmdline_table_cache;
+	case CF_TYPE_MISSIONS:
+		return Cmdline_mission_cache;
+	default:
+		return false;
+	}
+}
+
+uint table_cache_checksum(const char* raw_text, size_t raw_len)
+{
+	return cf_add_chksum_long(0, reinterpret_cast<ubyte*>(const_cast<char*>(raw_text)), raw_len);
+}
+
+bool table_cache_load(int mode, const char* filename, uint checksum, size_t raw_len, char* processed_text, size_t* processed_len)
+{
+	if (!table_cache_enabled(mode)) {
+		return false;
+	}
+
+	TRACE_SCOPE(tracing::TableCacheLoad);
+
+	if (mode == CF_TYPE_MISSIONS && !stricmp(Last_mission_text.filename.c_str(), filename)
+		&& Last_mission_text.checksum == checksum && Last_mission_text.raw_len == raw_len) {
+		memcpy(processed_text, Last_mission_text.processed_text.data(), Last_mission_text.processed_text.size());
+		*processed_len = Last_mission_text.processed_text.size();
+
+		nprintf(("TableCache", "Loaded mission '%s' from memory.\n", filename));
+		return true;
+	}
+
+	auto cache_filename = table_cache_filename(filename);
+
+	auto cfp = cfopen(cache_filename.c_str(), "rb", CFILE_MEMORY_MAPPED, CF_TYPE_CACHE);
+	if (cfp == nullptr) {
+		return false;
+	}
+
+	auto data = reinterpret_cast<const ubyte*>(cf_returndata(cfp));
+	auto size = (size_t)cfilelength(cfp);
+
+	table_cache_header header;
+	bool valid = size >= sizeof(header) + sizeof(TABLE_CACHE_END);
+
+	if (valid) {
+		memcpy(&header, data, sizeof(header));
+
+		valid = header.id == TABLE_CACHE_ID && header.version == TABLE_CACHE_VERSION
+			&& header.settings == table_cache_settings() && header.checksum == checksum
+			&& header.raw_len == (uint64_t)raw_len
+			&& header.processed_len == (uint64_t)(size - sizeof(header) - sizeof(TABLE_CACHE_END));
+	}
+
+	if (valid) {
+		int end;
+		memcpy(&end, data + size - sizeof(end), sizeof(end));
+		valid = end == TABLE_CACHE_END;
+	}
+
+	if (valid) {
+		memcpy(processed_text, data + sizeof(header), (size_t)header.processed_len);
+		*processed_len = (size_t)header.processed_len;
+	}
+
+	cfclose(cfp);
+
+	if (valid && mode == CF_TYPE_MISSIONS) {
+		Last_mission_text.filename = filename;
+		Last_mission_text.checksum = checksum;
+		Last_mission_text.raw_len = raw_len;
+		Last_mission_text.processed_text.assign(processed_text, processed_text + *processed_len);
+	}
+
+	if (!valid) {
+		nprintf(("TableCache", "Cached text of table '%s' is out of date.\n", filename));
+		return false;
+	}
+
+	nprintf(("TableCache", "Loaded table '%s' from the cache.\n", filename));
+
+	return true;
+}
+
+void table_cache_save(int mode, const char* filename, uint checksum, size_t raw_len, const char* processed_text, size_t processed_len)
+{
+	if (!table_cache_enabled(mode)) {
+		return;
+	}
+
+	TRACE_SCOPE(tracing::TableCacheSave);
+
+	if (mode == CF_TYPE_MISSIONS) {
+		Last_mission_text.filename = filename;
+		Last_mission_text.checksum = checksum;
+		Last_mission_text.raw_len = raw_len;
+		Last_mission_text.processed_text.assign(processed_text, processed_text + processed_len);
+	}
+
+	table_cache_header header;
+	memset(&header, 0, sizeof(header));
+	header.id = TABLE_CACHE_ID;
+	header.version = TABLE_CACHE_VERSION;
+	header.settings = table_cache_settings();
+	header.checksum = checksum;
+	header.raw_len = (uint64_t)raw_len;
+	header.processed_len = (uint64_t)processed_len;
+
+	auto cache_filename = table_cache_filename(filename);
+
+	auto cfp = cfopen(cache_filename.c_str(), "wb", CFILE_NORMAL, CF_TYPE_CACHE);
+	if (cfp == nullptr) {
+		mprintf(("Could not open table cache file %s!\n", cache_filename.c_str()));
+		return;
+	}
+
+	bool written = cfwrite(&header, sizeof(header), 1, cfp) == 1;
+	if (written && processed_len > 0) {
+		written = cfwrite(processed_text, 1, (int)processed_len, cfp) == (int)processed_len;
+	}
+	if (written) {
+		written = cfwrite(&TABLE_CACHE_END, sizeof(TABLE_CACHE_END), 1, cfp) == 1;
+	}
+
+	if (!written) {
+		mprintf(("Failed to write table cache file %s!\n", cache_filename.c_str()));
+	}
+
+	cfclose(cfp);
+}
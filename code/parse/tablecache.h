@@ -0,0 +1,61 @@
+#ifndef _TABLECACHE_H
+#define _TABLECACHE_H
+#pragma once
+
+#include "globalincs/pstypes.h"
+
+/** @file
+ *  Binary cache of the processed text of the tables and missions.
+ *
+ *  Every table and modular table is read, stripped of its comments and has its foreign characters converted before a
+ *  single token is parsed. The result only depends on the contents of the file and on a few settings so with
+ *  -table_cache it is written to the cache directory and used again as long as the checksum of the file matches the
+ *  one it was written with.
+ *
+ *  -mission_cache does the same for missions and also keeps the text of the last mission in memory since a mission is
+ *  mostly loaded again when it's restarted.
+ */
+
+/**
+ * @brief Checks if the table cache is used for a type of file
+ * @param mode The CF_TYPE_* of the file, only tables and missions are cached
+ * @return @c true if the processed text of the files should be read from and written to the cache
+ */
+bool table_cache_enabled(int mode);
+
+/**
+ * @brief Computes the checksum which identifies the contents of a table
+ *
+ * @param raw_text The text of the table as it was read from the file
+ * @param raw_len The length of the text
+ * @return The checksum
+ */
+uint table_cache_checksum(const char* raw_text, size_t raw_len);
+
+/**
+ * @brief Loads the processed text of a table from the cache
+ *
+ * @param mode The CF_TYPE_* of the file
+ * @param filename The name of the table file
+ * @param checksum The checksum of the raw text, see table_cache_checksum()
+ * @param raw_len The length of the raw text
+ * @param processed_text The buffer for the processed text, it has to be as large as the one process_raw_file_text()
+ * would need. No terminator is added.
+ * @param processed_len Set to the length of the processed text
+ * @return @c true if the cache was valid and the text was loaded. On @c false the buffer is unchanged.
+ */
+bool table_cache_load(int mode, const char* filename, uint checksum, size_t raw_len, char* processed_text, size_t* processed_len);
+
+/**
+ * @brief Writes the processed text of a table to the cache
+ *
+ * @param mode The CF_TYPE_* of the file
+ * @param filename The name of the table file
+ * @param checksum The checksum of the raw text, see table_cache_checksum()
+ * @param raw_len The length of the raw text
+ * @param processed_text The processed text
+ * @param processed_len The length of the processed text without the terminator
+ */
+void table_cache_save(int mode, const char* filename, uint checksum, size_t raw_len, const char* processed_text, size_t processed_len);
+
+#endif // _TABLECACHE_H
@@ -0,0 +1,183 @@
+#include "particle/GpuParticles.h"
+
+#include "cmdline/cmdline.h"
+#include "graphics/2d.h"
+#include "graphics/material.h"
+#include "tracing/Monitor.h"
+#include "tracing/tracing.h"
+
+#include <algorithm>
+#include <cstddef>
+
+namespace {
+
+// the layout of a particle in the vertex buffer, see effect-v.sdr
+struct gpu_particle {
+	vec3d pos;
+	vec3d velocity;
+	float spawn_time;
+	float lifetime;
+	float radius;
+	vec3d uvec;
+};
+
+struct gpu_particle_batch {
+	int bitmap = -1;
+	int nframes = 1;
+
+	int buffer = -1;
+	size_t buffer_size = 0; // in particles
+
+	SCP_vector<gpu_particle> particles;
+	size_t next = 0;
+
+	// the range of particles which changed since the last upload
+	size_t dirty_begin = 0;
+	size_t dirty_end = 0;
+
+	// when the last particle of the batch dies
+	float end_time = 0.0f;
+};
+
+SCP_map<int, gpu_particle_batch> Gpu_particle_batches;
+
+// the same rotations batching_add_volume_bitmap() uses for the CPU particles
+const vec3d Gpu_particle_uvecs[4] = {
+	{{{ 0.0f, 1.0f, 0.0f }}},
+	{{{ 0.0f, -1.0f, 0.0f }}},
+	{{{ -1.0f, 0.0f, 0.0f }}},
+	{{{ 1.0f, 0.0f, 0.0f }}},
+};
+
+bool gpu_particle_dead(const gpu_particle& part, float time)
+{
+	return time > part.spawn_time + part.lifetime;
+}
+
+void gpu_particle_upload(gpu_particle_batch& batch)
+{
+	if (batch.buffer < 0) {
+		batch.buffer = gr_create_vertex_buffer();
+	}
+
+	if (batch.particles.size() > batch.buffer_size) {
+		// reserve room for as many particles as the CPU copy so the buffer doesn't have to grow every frame
+		batch.buffer_size = batch.particles.capacity();
+		gr_update_buffer_data(batch.buffer, batch.buffer_size * sizeof(gpu_particle), nullptr);
+
+		batch.dirty_begin = 0;
+		batch.dirty_end = batch.particles.size();
+	}
+
+	if (batch.dirty_begin < batch.dirty_end) {
+		gr_update_buffer_data_offset(batch.buffer, batch.dirty_begin * sizeof(gpu_particle),
+			(batch.dirty_end - batch.dirty_begin) * sizeof(gpu_particle), &batch.particles[batch.dirty_begin]);
+	}
+
+	batch.dirty_begin = batch.particles.size();
+	batch.dirty_end = 0;
+}
+
+}
+
+namespace particle {
+namespace gpu {
+
+MONITOR(GpuParticleSlots)
+
+bool enabled()
+{
+	return Cmdline_gpu_particles && gr_is_capable(CAPABILITY_SOFT_PARTICLES) && gr_is_capable(CAPABILITY_POINT_PARTICLES);
+}
+
+void create(const vec3d& pos, const vec3d& vel, float radius, float lifetime, int bitmap, int nframes, float time)
+{
+	auto& batch = Gpu_particle_batches[bitmap];
+
+	if (batch.bitmap < 0) {
+		batch.bitmap = bitmap;
+		batch.nframes = nframes;
+	}
+
+	// the oldest slot is reused if its particle is dead, otherwise the batch grows
+	size_t slot;
+	if (!batch.particles.empty() && gpu_particle_dead(batch.particles[batch.next], time)) {
+		slot = batch.next;
+	} else {
+		slot = batch.particles.size();
+		batch.particles.emplace_back();
+	}
+	batch.next = (slot + 1) % batch.particles.size();
+
+	auto& part = batch.particles[slot];
+	part.pos = pos;
+	part.velocity = vel;
+	part.spawn_time = time;
+	part.lifetime = lifetime;
+	part.radius = radius;
+	part.uvec = Gpu_particle_uvecs[slot % 4];
+
+	batch.dirty_begin = std::min(batch.dirty_begin, slot);
+	batch.dirty_end = std::max(batch.dirty_end, slot + 1);
+
+	batch.end_time = std::max(batch.end_time, time + lifetime);
+}
+
+void render_all(float time)
+{
+	if (Gpu_particle_batches.empty()) {
+		return;
+	}
+
+	GR_DEBUG_SCOPE("Render GPU particles");
+
+	int num_slots = 0;
+
+	vertex_layout layout;
+	layout.add_vertex_component(vertex_format_data::POSITION3, sizeof(gpu_particle), (int)offsetof(gpu_particle, pos));
+	layout.add_vertex_component(vertex_format_data::NORMAL, sizeof(gpu_particle), (int)offsetof(gpu_particle, velocity));
+	layout.add_vertex_component(vertex_format_data::TEX_COORD, sizeof(gpu_particle), (int)offsetof(gpu_particle, spawn_time));
+	layout.add_vertex_component(vertex_format_data::RADIUS, sizeof(gpu_particle), (int)offsetof(gpu_particle, radius));
+	layout.add_vertex_component(vertex_format_data::UVEC, sizeof(gpu_particle), (int)offsetof(gpu_particle, uvec));
+
+	for (auto& entry : Gpu_particle_batches) {
+		auto& batch = entry.second;
+
+		if (time > batch.end_time) {
+			continue;
+		}
+
+		gpu_particle_upload(batch);
+
+		num_slots += (int)batch.particles.size();
+
+		// every frame of the animation is drawn from the whole buffer, the shader only keeps the particles which show
+		// that frame right now
+		for (int frame = 0; frame < batch.nframes; ++frame) {
+			float life_start = i2fl(frame) / i2fl(batch.nframes);
+			float life_end = (frame == batch.nframes - 1) ? 2.0f : i2fl(frame + 1) / i2fl(batch.nframes);
+
+			particle_material material_def;
+			material_set_unlit_volume(&material_def, batch.bitmap + frame, true);
+			material_def.set_gpu_simulation(time, life_start, life_end);
+
+			gr_render_primitives_particle(&material_def, PRIM_TYPE_POINTS, &layout, 0, (int)batch.particles.size(), batch.buffer);
+		}
+	}
+
+	MONITOR_INC(GpuParticleSlots, num_slots);
+}
+
+void kill_all()
+{
+	for (auto& entry : Gpu_particle_batches) {
+		if (entry.second.buffer >= 0) {
+			gr_delete_buffer(entry.second.buffer);
+		}
+	}
+
+	Gpu_particle_batches.clear();
+}
+
+}
+}
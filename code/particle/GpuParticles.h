@@ -0,0 +1,49 @@
+#pragma once
+
+#include "globalincs/pstypes.h"
+
+namespace particle {
+/**
+ * @brief Particles which are moved, aged and rendered by the GPU
+ *
+ * Particles which nothing refers to after they were created, which are not attached to an object and which move in a
+ * straight line only need their spawn values to be known. These values are written once into a vertex buffer per
+ * animation and the shader computes position, age and animation frame from the current time of the particle clock, the
+ * CPU never touches such a particle again. The slots of dead particles are reused in the order they were created in.
+ *
+ * @ingroup particleSystems
+ */
+namespace gpu {
+
+/**
+ * @brief Checks if new particles may be simulated on the GPU
+ * @return @c true if -gpu_particles was given and the renderer supports soft particles drawn from points
+ */
+bool enabled();
+
+/**
+ * @brief Adds a particle
+ *
+ * @param pos The position at the time of the spawn
+ * @param vel The velocity
+ * @param radius The radius
+ * @param lifetime The lifetime in seconds
+ * @param bitmap The first frame of the bitmap or animation
+ * @param nframes The number of frames of the animation, they must all be shown for the same time
+ * @param time The current time of the particle clock
+ */
+void create(const vec3d& pos, const vec3d& vel, float radius, float lifetime, int bitmap, int nframes, float time);
+
+/**
+ * @brief Uploads the new particles and draws all of them
+ * @param time The current time of the particle clock
+ */
+void render_all(float time);
+
+/**
+ * @brief Removes all particles and frees the GPU buffers
+ */
+void kill_all();
+
+}
+}
@@ -7,6 +7,12 @@
 namespace particle {
 class ParticleSource;
 
+// typedef this to make usages of particle effects clearer
+/**
+ * The particle index type. Use this in place of int or ptrdiff_t.
+ */
+typedef ptrdiff_t ParticleEffectIndex;
+
 /**
  * @brief The type of an Effect
  * If you add a new effect type you need to add it to the enum.
@@ -37,6 +43,8 @@ class ParticleEffect {
  protected:
 	SCP_string m_name; //!< The name if this effect
 
+	ParticleEffectIndex m_index = -1; //!< The index of this effect in the ParticleManager
+
  public:
 	/**
 	 * @brief Initializes the base ParticleEffect
@@ -48,6 +56,15 @@ class ParticleEffect {
 
 	const SCP_string& getName() const { return m_name; }
 
+	ParticleEffectIndex getIndex() const { return m_index; }
+
+	/**
+	 * @brief Sets the index of this effect
+	 * @note Only the ParticleManager should call this when the effect is added
+	 * @param index The index
+	 */
+	void setIndex(ParticleEffectIndex index) { m_index = index; }
+
 	/**
 	 * @brief Parses the values of this effect
 	 *
@@ -2,6 +2,7 @@
 #include <memory>
 
 #include "particle/ParticleManager.h"
+#include "particle/ParticleStats.h"
 
 #include "particle/effects/SingleParticleEffect.h"
 #include "particle/effects/CompositeEffect.h"
@@ -11,6 +12,7 @@
 #include "particle/effects/GenericShapeEffect.h"
 
 #include "bmpman/bmpman.h"
+#include "globalincs/jobs.h"
 #include "globalincs/systemvars.h"
 #include "tracing/tracing.h"
 
@@ -21,6 +23,12 @@
 namespace {
 using namespace particle;
 
+// set while a worker processes sources, the particles these sources create are collected here
+SCP_THREAD_LOCAL SCP_vector<DeferredParticle>* Deferred_particles = nullptr;
+
+// below this number of sources it is faster to process them on the main thread
+const size_t PARALLEL_SOURCES_MIN = 128;
+
 const char* effectTypeNames[static_cast<int64_t>(EffectType::MAX)] = {
 	"Single",
 	"Composite",
@@ -173,7 +181,9 @@ ParticleEffectIndex ParticleManager::getEffectByName(const SCP_string& name) {
 	return distance(m_effects.begin(), foundIterator);
 }
 
-void ParticleManager::doFrame(float) {
+void ParticleManager::doFrame(float frameTime) {
+	stats::frame_done(frameTime);
+
 	if (Is_standalone) {
 		// Don't process sources for standalone server
 		m_sources.clear(); // Always clear the vector to free memory
@@ -183,22 +193,43 @@ void ParticleManager::doFrame(float) {
 
 		m_processingSources = true;
 
-		for (auto source = std::begin(m_sources); source != std::end(m_sources);) {
-			if (!source->isValid() || !source->process()) {
-				// if we're sitting on the very last source, popping-back will invalidate the iterator!
-				if (std::next(source) == m_sources.end()) {
+		// the cost of the effects can only be measured if their sources are processed one after another
+		bool recordStats = stats::enabled();
+
+		if (m_sources.size() >= PARALLEL_SOURCES_MIN && jobs::num_workers() > 1 && !recordStats) {
+			processSourcesParallel();
+		} else {
+			for (auto source = std::begin(m_sources); source != std::end(m_sources);) {
+				bool alive = source->isValid();
+
+				if (alive) {
+					if (recordStats) {
+						stats::begin_source(source->getEffect());
+					}
+
+					alive = source->process();
+
+					if (recordStats) {
+						stats::end_source();
+					}
+				}
+
+				if (!alive) {
+					// if we're sitting on the very last source, popping-back will invalidate the iterator!
+					if (std::next(source) == m_sources.end()) {
+						m_sources.pop_back();
+						break;
+					}
+
+					*source = std::move(m_sources.back());
 					m_sources.pop_back();
-					break;
+					continue;
 				}
 
-				*source = std::move(m_sources.back());
-				m_sources.pop_back();
-				continue;
+				// source is only incremented here as elements would be skipped in
+				// the case that a source needs to be removed
+				++source;
 			}
-
-			// source is only incremented here as elements would be skipped in
-			// the case that a source needs to be removed
-			++source;
 		}
 
 		m_processingSources = false;
@@ -210,6 +241,82 @@ void ParticleManager::doFrame(float) {
 	}
 }
 
+void ParticleManager::processSourcesParallel() {
+	m_sourceAlive.resize(m_sources.size());
+	m_deferredParticles.resize(jobs::num_workers());
+
+	jobs::parallel_for(m_sources.size(), 32, [this](size_t begin, size_t end, size_t worker) {
+		Deferred_particles = &m_deferredParticles[worker];
+
+		for (size_t i = begin; i < end; ++i) {
+			auto& source = m_sources[i];
+
+			m_sourceAlive[i] = (source.isValid() && source.process()) ? 1 : 0;
+		}
+
+		Deferred_particles = nullptr;
+	}, tracing::ParticleSourceJob);
+
+	size_t kept = 0;
+	for (size_t i = 0; i < m_sources.size(); ++i) {
+		if (!m_sourceAlive[i]) {
+			continue;
+		}
+
+		if (kept != i) {
+			m_sources[kept] = std::move(m_sources[i]);
+		}
+		++kept;
+	}
+	m_sources.erase(m_sources.begin() + kept, m_sources.end());
+
+	// no source is processed anymore so the particles can be created now, new trail sources still end up in
+	// m_deferredSourceAdding since m_processingSources is set
+	for (auto& particles : m_deferredParticles) {
+		for (auto& deferred : particles) {
+			createDeferredParticle(deferred);
+		}
+
+		particles.clear();
+	}
+}
+
+void ParticleManager::createDeferredParticle(DeferredParticle& deferred) {
+	if (deferred.trailEffect >= 0) {
+		createTrailedParticle(deferred.info, deferred.lifetime, deferred.trailEffect);
+	} else {
+		create_unreferenced(&deferred.info, deferred.lifetime);
+	}
+}
+
+void ParticleManager::createTrailedParticle(const particle_info& info, float lifetime, ParticleEffectIndex trailEffect) {
+	if (Deferred_particles != nullptr) {
+		Deferred_particles->push_back({ info, lifetime, trailEffect });
+		return;
+	}
+
+	auto pinfo = info;
+	auto part = create(&pinfo);
+
+	if (lifetime >= 0.0f && part.isValid()) {
+		part.maxLife() = lifetime;
+	}
+
+	auto trailSource = createSource(trailEffect);
+	trailSource.moveToParticle(part);
+
+	trailSource.finish();
+}
+
+bool ParticleManager::deferParticle(const particle_info& info, float lifetime) {
+	if (Deferred_particles == nullptr) {
+		return false;
+	}
+
+	Deferred_particles->push_back({ info, lifetime, -1 });
+	return true;
+}
+
 ParticleEffectIndex ParticleManager::addEffect(ParticleEffectPtr effect) {
 	Assertion(effect, "Invalid effect pointer passed!");
 
@@ -225,6 +332,7 @@ ParticleEffectIndex ParticleManager::addEffect(ParticleEffectPtr effect) {
 	}
 #endif
 
+	effect->setIndex(static_cast<ParticleEffectIndex>(m_effects.size()));
 	m_effects.push_back(std::shared_ptr<ParticleEffect>(effect));
 
 	return static_cast<ParticleEffectIndex>(m_effects.size() - 1);
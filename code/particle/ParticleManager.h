@@ -8,11 +8,16 @@
 #include "particle/ParticleSourceWrapper.h"
 
 namespace particle {
-// typedef this to make usages of particle effects clearer
 /**
- * The particle index type. Use this in place of int or ptrdiff_t.
+ * @brief A particle created by a source which is processed on a worker thread
+ *
+ * Particles can't be created while sources are processed in parallel so they are collected and created afterwards.
  */
-typedef ptrdiff_t ParticleEffectIndex;
+struct DeferredParticle {
+	particle_info info;
+	float lifetime; //!< Replaces the lifetime of the particle if not negative
+	ParticleEffectIndex trailEffect; //!< The effect of a source which follows the particle, -1 if there is none
+};
 
 /**
  * @brief Manages high-level particle effects and sources
@@ -35,6 +40,10 @@ class ParticleManager {
 	 */
 	SCP_vector<ParticleSource> m_deferredSourceAdding;
 
+	SCP_vector<ubyte> m_sourceAlive; //!< The results of the sources processed in parallel
+
+	SCP_vector<SCP_vector<DeferredParticle>> m_deferredParticles; //!< The particles created by every worker
+
 	/**
 	 * The global paticle manager
 	 */
@@ -49,6 +58,15 @@ class ParticleManager {
 	 * @return The source pointer
 	 */
 	ParticleSource* createSource();
+
+	/**
+	 * @brief Processes the sources on all workers
+	 *
+	 * The particles created by the sources are collected per worker and created once all sources are done.
+	 */
+	void processSourcesParallel();
+
+	void createDeferredParticle(DeferredParticle& deferred);
  public:
 	ParticleManager() {}
 
@@ -129,6 +147,26 @@ class ParticleManager {
 	 * @return A wrapper class which allows access to the created sources
 	 */
 	ParticleSourceWrapper createSource(ParticleEffectIndex index);
+
+	/**
+	 * @brief Creates a particle and a source of another effect which follows it
+	 *
+	 * If this is called while the sources are processed in parallel both are created after the processing is done.
+	 *
+	 * @param info The values of the particle
+	 * @param lifetime Replaces the lifetime of the particle if not negative
+	 * @param trailEffect The effect of the source
+	 */
+	void createTrailedParticle(const particle_info& info, float lifetime, ParticleEffectIndex trailEffect);
+
+	/**
+	 * @brief Defers the creation of a particle if the current thread processes particle sources in parallel
+	 *
+	 * @param info The values of the particle
+	 * @param lifetime Replaces the lifetime of the particle if not negative
+	 * @return @c true if the particle was deferred and must not be created now
+	 */
+	static bool deferParticle(const particle_info& info, float lifetime);
 };
 
 namespace internal {
@@ -0,0 +1,249 @@
+#include "particle/ParticleStats.h"
+
+#include "debugconsole/console.h"
+#include "graphics/2d.h"
+#include "io/timer.h"
+#include "parse/parselo.h"
+#include "particle/ParticleManager.h"
+#include "render/3d.h"
+#include "tracing/tracing.h"
+
+#include <algorithm>
+#include <memory>
+
+namespace {
+using namespace particle;
+
+struct effect_stats {
+	// the values of the current frame
+	int frame_particles = 0;
+	std::uint64_t frame_cpu_ns = 0;
+
+	// added up until the averages are computed again
+	std::uint64_t total_particles = 0;
+	std::uint64_t total_spawned = 0;
+	double total_pixels = 0.0;
+	std::uint64_t total_cpu_ns = 0;
+
+	// the averages of the last second
+	float avg_particles = 0.0f;
+	float spawn_rate = 0.0f;
+	float avg_overdraw = 0.0f;
+	float avg_cpu_ms = 0.0f;
+
+	// the counters of the trace output keep a pointer to their name
+	SCP_string particles_name;
+	SCP_string cpu_name;
+	std::unique_ptr<tracing::Category> particles_category;
+	std::unique_ptr<tracing::Category> cpu_category;
+};
+
+// element 0 is for the particles which were not created by an effect, effect i uses element i + 1
+SCP_vector<std::unique_ptr<effect_stats>> Effect_stats;
+
+bool Stats_enabled = false;
+
+ParticleEffectIndex Current_effect = -1;
+std::uint64_t Source_start_time = 0;
+
+float Stats_window_time = 0.0f;
+int Stats_window_frames = 0;
+
+// the averages are computed over this many seconds
+const float STATS_WINDOW = 1.0f;
+
+SCP_string get_effect_name(ParticleEffectIndex effect)
+{
+	if (effect < 0) {
+		return "<no effect>";
+	}
+
+	auto& name = ParticleManager::get()->getEffect(effect)->getName();
+
+	if (name.empty()) {
+		SCP_string unnamed;
+		sprintf(unnamed, "<unnamed " PTRDIFF_T_ARG ">", effect);
+		return unnamed;
+	}
+
+	return name;
+}
+
+effect_stats& get_stats(ParticleEffectIndex effect)
+{
+	auto index = static_cast<size_t>(effect + 1);
+
+	if (index >= Effect_stats.size()) {
+		Effect_stats.resize(index + 1);
+	}
+
+	auto& stats = Effect_stats[index];
+
+	if (!stats) {
+		stats.reset(new effect_stats());
+
+		auto name = get_effect_name(effect);
+		stats->particles_name = name + " particles";
+		stats->cpu_name = name + " CPU us";
+		stats->particles_category.reset(new tracing::Category(stats->particles_name.c_str(), false));
+		stats->cpu_category.reset(new tracing::Category(stats->cpu_name.c_str(), false));
+	}
+
+	return *stats;
+}
+
+void print_stats()
+{
+	SCP_vector<std::pair<ParticleEffectIndex, effect_stats*>> sorted;
+
+	for (size_t i = 0; i < Effect_stats.size(); ++i) {
+		if (Effect_stats[i]) {
+			sorted.emplace_back(static_cast<ParticleEffectIndex>(i) - 1, Effect_stats[i].get());
+		}
+	}
+
+	// the most expensive effects first, the particles without an effect have no CPU time so they are sorted by count
+	std::sort(sorted.begin(), sorted.end(), [](const std::pair<ParticleEffectIndex, effect_stats*>& a,
+											   const std::pair<ParticleEffectIndex, effect_stats*>& b) {
+		if (a.second->avg_cpu_ms != b.second->avg_cpu_ms) {
+			return a.second->avg_cpu_ms > b.second->avg_cpu_ms;
+		}
+		return a.second->avg_particles > b.second->avg_particles;
+	});
+
+	dc_printf("%6s %-32s %10s %10s %10s %10s\n", "Index", "Effect", "Particles", "Spawn/s", "Overdraw", "CPU ms");
+
+	for (auto& entry : sorted) {
+		auto stats = entry.second;
+
+		dc_printf("%6d %-32s %10.1f %10.1f %9.1f%% %10.3f\n", static_cast<int>(entry.first),
+				  get_effect_name(entry.first).c_str(), stats->avg_particles, stats->spawn_rate,
+				  stats->avg_overdraw * 100.0f, stats->avg_cpu_ms);
+	}
+}
+
+}
+
+DCF(particle_stats, "Records the cost of every particle effect (on|off|reset|print)")
+{
+	if (dc_optional_string_either("help", "--help")) {
+		dc_printf("Usage: particle_stats [on|off|reset|print]\n");
+		dc_printf("\ton     Starts recording the cost of the effects\n");
+		dc_printf("\toff    Stops recording\n");
+		dc_printf("\treset  Forgets all recorded values\n");
+		dc_printf("\tprint  Lists the effects with the number of drawn particles, the particles created per second,\n");
+		dc_printf("\t       the covered pixels relative to the screen and the CPU time per frame, each averaged\n");
+		dc_printf("\t       over the last second (default)\n");
+		return;
+	}
+
+	if (dc_optional_string("on")) {
+		Stats_enabled = true;
+	} else if (dc_optional_string("off")) {
+		Stats_enabled = false;
+	} else if (dc_optional_string("reset")) {
+		Effect_stats.clear();
+		Stats_window_time = 0.0f;
+		Stats_window_frames = 0;
+	} else {
+		print_stats();
+	}
+
+	dc_printf("Particle effect stats are %s\n", Stats_enabled ? "on" : "off");
+}
+
+namespace particle {
+namespace stats {
+
+bool enabled()
+{
+	return Stats_enabled;
+}
+
+void begin_source(const ParticleEffect* effect)
+{
+	Current_effect = effect->getIndex();
+	Source_start_time = timer_get_nanoseconds();
+}
+
+void end_source()
+{
+	get_stats(Current_effect).frame_cpu_ns += timer_get_nanoseconds() - Source_start_time;
+	Current_effect = -1;
+}
+
+ParticleEffectIndex current_effect()
+{
+	return Current_effect;
+}
+
+void particle_created(ParticleEffectIndex effect)
+{
+	++get_stats(effect).total_spawned;
+}
+
+void particle_rendered(ParticleEffectIndex effect, float radius, float dist)
+{
+	auto& stats = get_stats(effect);
+
+	++stats.frame_particles;
+
+	if (dist > 0.0f) {
+		float pixel_radius = radius / dist * (gr_screen.clip_height * 0.5f) / tanf(Proj_fov * 0.5f);
+		stats.total_pixels += PI * pixel_radius * pixel_radius;
+	}
+}
+
+void frame_done(float frametime)
+{
+	if (!Stats_enabled) {
+		return;
+	}
+
+	for (auto& stats : Effect_stats) {
+		if (!stats) {
+			continue;
+		}
+
+		tracing::counter::value(*stats->particles_category, i2fl(stats->frame_particles));
+		tracing::counter::value(*stats->cpu_category, static_cast<float>(stats->frame_cpu_ns) / 1000.0f);
+
+		stats->total_particles += stats->frame_particles;
+		stats->total_cpu_ns += stats->frame_cpu_ns;
+
+		stats->frame_particles = 0;
+		stats->frame_cpu_ns = 0;
+	}
+
+	Stats_window_time += frametime;
+	++Stats_window_frames;
+
+	if (Stats_window_time < STATS_WINDOW) {
+		return;
+	}
+
+	auto frames = i2fl(Stats_window_frames);
+	auto screen_pixels = i2fl(gr_screen.clip_width * gr_screen.clip_height);
+
+	for (auto& stats : Effect_stats) {
+		if (!stats) {
+			continue;
+		}
+
+		stats->avg_particles = static_cast<float>(stats->total_particles) / frames;
+		stats->spawn_rate = static_cast<float>(stats->total_spawned) / Stats_window_time;
+		stats->avg_overdraw = (screen_pixels > 0.0f) ? static_cast<float>(stats->total_pixels / frames) / screen_pixels : 0.0f;
+		stats->avg_cpu_ms = static_cast<float>(stats->total_cpu_ns) / frames / 1000000.0f;
+
+		stats->total_particles = 0;
+		stats->total_spawned = 0;
+		stats->total_pixels = 0.0;
+		stats->total_cpu_ns = 0;
+	}
+
+	Stats_window_time = 0.0f;
+	Stats_window_frames = 0;
+}
+
+}
+}
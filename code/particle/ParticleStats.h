@@ -0,0 +1,72 @@
+#pragma once
+
+#include "globalincs/pstypes.h"
+#include "particle/ParticleEffect.h"
+
+namespace particle {
+/**
+ * @brief Cost accounting for every particle effect
+ *
+ * While enabled with the particle_stats debug command the particles which are created while the source of an effect is
+ * processed are attributed to that effect, together with the time the processing took. Every frame the number of
+ * particles that were drawn and an estimate of the pixels they covered are added up per effect as well. The results
+ * of every frame are written to the trace output as counters named after the effects and an average over the last
+ * second can be printed on the debug console.
+ *
+ * Particles which are not created by an effect are collected as "<no effect>". GPU particles are only counted when
+ * they are created since the CPU never sees them again.
+ *
+ * @note Sources are processed on the main thread while the accounting is enabled so the times can be measured.
+ *
+ * @ingroup particleSystems
+ */
+namespace stats {
+
+/**
+ * @brief Checks if the accounting is enabled
+ * @return @c true if the costs of the effects are recorded
+ */
+bool enabled();
+
+/**
+ * @brief Starts processing a source of an effect
+ *
+ * The particles created until end_source() is called belong to this effect.
+ *
+ * @param effect The effect of the source
+ */
+void begin_source(const ParticleEffect* effect);
+
+/**
+ * @brief Stops processing the source given to begin_source() and records how long it took
+ */
+void end_source();
+
+/**
+ * @brief Gets the effect new particles belong to
+ * @return The effect of the source which is processed right now, -1 if there is none
+ */
+ParticleEffectIndex current_effect();
+
+/**
+ * @brief Records the creation of a particle
+ * @param effect The effect which created the particle, -1 if there is none
+ */
+void particle_created(ParticleEffectIndex effect);
+
+/**
+ * @brief Records that a particle was drawn
+ * @param effect The effect which created the particle, -1 if there is none
+ * @param radius The radius of the particle
+ * @param dist The distance of the particle from the eye
+ */
+void particle_rendered(ParticleEffectIndex effect, float radius, float dist);
+
+/**
+ * @brief Writes the values of the last frame to the trace output and starts a new frame
+ * @param frametime The length of the last frame
+ */
+void frame_done(float frametime);
+
+}
+}
@@ -47,13 +47,13 @@ bool BeamPiercingEffect::processSource(const ParticleSource* source) {
 	vm_vec_scale_add2(&info.vel, &rnd_vec, base_v * m_variance);
 
 	// Create the primary piercing particle
-	create(&info);
+	create_unreferenced(&info);
 
 	vm_vec_copy_scale(&info.vel, &fvec, back_v * frand_range(1.0f, 2.0f));
 	vm_vec_scale_add2(&info.vel, &rnd_vec, back_v * m_variance);
 
 	// Create the splash particle
-	create(&info);
+	create_unreferenced(&info);
 
 	return false;
 }
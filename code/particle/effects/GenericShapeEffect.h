@@ -108,13 +108,10 @@ class GenericShapeEffect : public ParticleEffect {
 			}
 			vm_vec_scale(&info.vel, m_velocity.next());
 
-			auto part = m_particleProperties.createParticle(info);
-
 			if (m_particleTrail >= 0) {
-				auto trailSource = ParticleManager::get()->createSource(m_particleTrail);
-				trailSource.moveToParticle(part);
-
-				trailSource.finish();
+				m_particleProperties.createTrailedParticle(info, m_particleTrail);
+			} else {
+				m_particleProperties.createUnreferencedParticle(info);
 			}
 		}
 
@@ -27,7 +27,7 @@ bool SingleParticleEffect::processSource(const ParticleSource* source) {
 	source->getOrigin()->applyToParticleInfo(info);
 	info.vel = vmd_zero_vector;
 
-	m_particleProperties.createParticle(info);
+	m_particleProperties.createUnreferencedParticle(info);
 
 	// Continue processing this source
 	return true;
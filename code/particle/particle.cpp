@@ -12,6 +12,8 @@
 #include "bmpman/bmpman.h"
 #include "particle/particle.h"
 #include "particle/ParticleManager.h"
+#include "particle/ParticleStats.h"
+#include "particle/GpuParticles.h"
 #include "cmdline/cmdline.h"
 #include "debugconsole/console.h"
 #include "globalincs/systemvars.h"
@@ -24,12 +26,133 @@
 #include "tracing/tracing.h"
 #include "tracing/Monitor.h"
 
+#include <algorithm>
+
 using namespace particle;
 
 namespace
 {
-	int Num_particles = 0;
-	static SCP_vector<ParticlePtr> Particles;
+	// The data of the living particles is kept in parallel arrays which all use the same index. A dying particle is
+	// replaced by the last one so the arrays have no holes and the update loops can run over them without indirection.
+	// The arrays are only ever grown so creating a particle does not allocate memory once the pool is big enough.
+	struct particle_pool {
+		size_t count = 0;
+
+		SCP_vector<vec3d> pos;				// position
+		SCP_vector<vec3d> velocity;			// velocity
+		SCP_vector<float> age;				// How long it's been alive
+		SCP_vector<float> max_life;			// How much life we had
+		SCP_vector<float> radius;			// radius
+		SCP_vector<int> type;				// type
+		SCP_vector<int> optional_data;		// depends on type
+		SCP_vector<int> nframes;			// If an ani, how many frames?
+		SCP_vector<int> attached_objnum;	// if this is set, pos is relative to the attached object. velocity is ignored
+		SCP_vector<int> attached_sig;		// to check for dead/nonexistent objects
+		SCP_vector<ubyte> reverse;			// play any animations in reverse
+		SCP_vector<int> slot;				// the handle slot of the particle, also used for the orient of the bitmap
+		SCP_vector<ParticleEffectIndex> effect;	// the effect which created the particle, -1 if none did
+
+		// indexed by handle slot
+		SCP_vector<int> slot_index;			// index of the particle using the slot, -1 if the slot is free
+		SCP_vector<uint> slot_generation;	// changed every time the particle of a slot dies
+		SCP_vector<int> free_slots;
+	};
+
+	particle_pool Particles;
+
+	const size_t PARTICLE_POOL_MIN_SIZE = 256;
+
+	void pool_grow()
+	{
+		auto size = std::max(Particles.pos.size() * 2, PARTICLE_POOL_MIN_SIZE);
+
+		Particles.pos.resize(size);
+		Particles.velocity.resize(size);
+		Particles.age.resize(size);
+		Particles.max_life.resize(size);
+		Particles.radius.resize(size);
+		Particles.type.resize(size);
+		Particles.optional_data.resize(size);
+		Particles.nframes.resize(size);
+		Particles.attached_objnum.resize(size);
+		Particles.attached_sig.resize(size);
+		Particles.reverse.resize(size);
+		Particles.slot.resize(size);
+		Particles.effect.resize(size);
+
+		Particles.slot_index.reserve(size);
+		Particles.slot_generation.reserve(size);
+		Particles.free_slots.reserve(size);
+	}
+
+	// returns the index of a new particle, its handle slot is already set up
+	size_t pool_add()
+	{
+		if (Particles.count == Particles.pos.size())
+		{
+			pool_grow();
+		}
+
+		int slot;
+		if (!Particles.free_slots.empty())
+		{
+			slot = Particles.free_slots.back();
+			Particles.free_slots.pop_back();
+		}
+		else
+		{
+			slot = static_cast<int>(Particles.slot_index.size());
+			Particles.slot_index.push_back(-1);
+			Particles.slot_generation.push_back(0);
+		}
+
+		auto index = Particles.count++;
+
+		Particles.slot[index] = slot;
+		Particles.slot_index[slot] = static_cast<int>(index);
+
+		return index;
+	}
+
+	void pool_remove(size_t index)
+	{
+		auto slot = Particles.slot[index];
+
+		Particles.slot_index[slot] = -1;
+		++Particles.slot_generation[slot];
+		Particles.free_slots.push_back(slot);
+
+		auto last = --Particles.count;
+		if (index == last)
+		{
+			return;
+		}
+
+		Particles.pos[index] = Particles.pos[last];
+		Particles.velocity[index] = Particles.velocity[last];
+		Particles.age[index] = Particles.age[last];
+		Particles.max_life[index] = Particles.max_life[last];
+		Particles.radius[index] = Particles.radius[last];
+		Particles.type[index] = Particles.type[last];
+		Particles.optional_data[index] = Particles.optional_data[last];
+		Particles.nframes[index] = Particles.nframes[last];
+		Particles.attached_objnum[index] = Particles.attached_objnum[last];
+		Particles.attached_sig[index] = Particles.attached_sig[last];
+		Particles.reverse[index] = Particles.reverse[last];
+		Particles.slot[index] = Particles.slot[last];
+		Particles.effect[index] = Particles.effect[last];
+
+		Particles.slot_index[Particles.slot[index]] = static_cast<int>(index);
+	}
+
+	void pool_clear()
+	{
+		// new generations make sure that the handles of the killed particles stay invalid
+		while (Particles.count > 0)
+		{
+			pool_remove(Particles.count - 1);
+		}
+	}
 
 	int Anim_bitmap_id_fire = -1;
 	int Anim_num_frames_fire = -1;
@@ -42,6 +165,12 @@ namespace
 
 	static int Particles_enabled = 1;
 
+	// the number of CPU particles above which new ones may be skipped, 0 if there is no limit
+	static int Particle_budget = -1;
+
+	// the time the particles have been moved for, the shader of the GPU particles computes their age from it
+	float Particle_time = 0.0f;
+
 	float get_current_alpha(vec3d* pos)
 	{
 		float dist;
@@ -79,74 +208,83 @@ namespace
 		// based on value of 'count' (detail level)
 		return (50 + (25 * (count - 1)));
 	}
-}
 
-namespace particle
-{
-	// Reset everything between levels
-	void init()
+	// the share of the budget which may be used before particles are skipped
+	const float PARTICLE_BUDGET_SOFT_LIMIT = 0.75f;
+
+	// particles whose radius is at least this share of their distance are kept while the budget isn't used up
+	const float PARTICLE_BUDGET_LOD_SIZE = 0.02f;
+
+	// the kept particles grow at most by this factor to make up for the skipped ones
+	const float PARTICLE_BUDGET_MAX_SCALE = 2.0f;
+
+	MONITOR(NumParticlesSkipped)
+
+	// Decides if a new particle fits into the budget. Returns the factor its radius is scaled with to cover the area of
+	// the skipped particles or 0 if the particle is skipped.
+	float get_budget_scale(const particle_info* pinfo)
 	{
-		// FIRE!!!
-		if (Anim_bitmap_id_fire == -1)
-		{
-			Anim_bitmap_id_fire = bm_load_animation("particleexp01", &Anim_num_frames_fire, nullptr, NULL, 0);
-		}
+		int budget = Particle_budget;
 
-		// Cough, cough
-		if (Anim_bitmap_id_smoke == -1)
+		if ((budget <= 0) || (pinfo->priority == PARTICLE_PRIORITY_HIGH))
 		{
-			Anim_bitmap_id_smoke = bm_load_animation("particlesmoke01", &Anim_num_frames_smoke, nullptr, NULL, 0);
+			return 1.0f;
 		}
 
-		// wheeze
-		if (Anim_bitmap_id_smoke2 == -1)
+		float load = static_cast<float>(Particles.count) / i2fl(budget);
+
+		if (load < PARTICLE_BUDGET_SOFT_LIMIT)
 		{
-			Anim_bitmap_id_smoke2 = bm_load_animation("particlesmoke02", &Anim_num_frames_smoke2, nullptr, NULL, 0);
+			return 1.0f;
 		}
-	}
 
-	// only call from game_shutdown()!!!
-	void close()
-	{
-		Particles.clear();
-	}
+		// 0 at the soft limit, 1 once the budget is used up
+		float pressure = (load - PARTICLE_BUDGET_SOFT_LIMIT) / (1.0f - PARTICLE_BUDGET_SOFT_LIMIT);
 
-	void page_in()
-	{
-		bm_page_in_texture(Anim_bitmap_id_fire);
-		bm_page_in_texture(Anim_bitmap_id_smoke);
-		bm_page_in_texture(Anim_bitmap_id_smoke2);
+		float keep = 0.0f;
 
-		ParticleManager::get()->pageIn();
-	}
+		if (pressure < 1.0f)
+		{
+			vec3d pos = pinfo->pos;
+			if (pinfo->attached_objnum >= 0)
+			{
+				vm_vec_add2(&pos, &Objects[pinfo->attached_objnum].pos);
+			}
 
-	DCF_BOOL2(particles, Particles_enabled, "Turns particles on/off",
-			  "Usage: particles [bool]\nTurns particle system on/off.  If nothing passed, then toggles it.\n");
+			float dist = vm_vec_dist_quick(&Eye_position, &pos);
+			float size = (dist > 0.0f) ? pinfo->rad / dist : PARTICLE_BUDGET_LOD_SIZE;
 
-	int Num_particles_hwm = 0;
+			// the smaller a particle is on the screen the sooner it is skipped
+			keep = (1.0f - pressure) * size / PARTICLE_BUDGET_LOD_SIZE;
 
-	// Creates a single particle. See the PARTICLE_?? defines for types.
-	WeakParticlePtr create(particle_info* pinfo)
-	{
-		if (!Particles_enabled)
+			if (pinfo->priority == PARTICLE_PRIORITY_LOW)
+			{
+				keep *= 0.5f;
+			}
+		}
+
+		if (keep >= 1.0f)
+		{
+			return 1.0f;
+		}
+
+		if (frand() >= keep)
 		{
-			return WeakParticlePtr();
+			MONITOR_INC(NumParticlesSkipped, 1);
+			return 0.0f;
 		}
 
-		ParticlePtr new_particle(new particle());
+		return MIN(1.0f / sqrtf(keep), PARTICLE_BUDGET_MAX_SCALE);
+	}
+
+	// Determines the bitmap, the number of frames and the lifetime of a new particle. Returns false if the animation of
+	// a built-in particle type isn't available.
+	bool get_particle_bitmap(particle_info* pinfo, int* optional_data, int* nframes, float* max_life)
+	{
 		int fps = 1;
 
-		new_particle->pos = pinfo->pos;
-		new_particle->velocity = pinfo->vel;
-		new_particle->age = 0.0f;
-		new_particle->max_life = pinfo->lifetime;
-		new_particle->radius = pinfo->rad;
-		new_particle->type = pinfo->type;
-		new_particle->optional_data = pinfo->optional_data;
-		new_particle->attached_objnum = pinfo->attached_objnum;
-		new_particle->attached_sig = pinfo->attached_sig;
-		new_particle->reverse = pinfo->reverse;
-		new_particle->particle_index = (int) Particles.size();
+		*optional_data = pinfo->optional_data;
+		*max_life = pinfo->lifetime;
 
 		switch (pinfo->type)
 		{
@@ -155,12 +293,12 @@ namespace particle
 			{
 				Assertion(bm_is_valid(pinfo->optional_data), "Invalid bitmap handle passed to particle create.");
 
-				bm_get_info(pinfo->optional_data, NULL, NULL, NULL, &new_particle->nframes, &fps);
+				bm_get_info(pinfo->optional_data, NULL, NULL, NULL, nframes, &fps);
 
-				if (new_particle->nframes > 1)
+				if (*nframes > 1)
 				{
 					// Recalculate max life for ani's
-					new_particle->max_life = i2fl(new_particle->nframes) / i2fl(fps);
+					*max_life = i2fl(*nframes) / i2fl(fps);
 				}
 
 				break;
@@ -170,11 +308,11 @@ namespace particle
 			{
 				if (Anim_bitmap_id_fire < 0)
 				{
-					return WeakParticlePtr();
+					return false;
 				}
 
-				new_particle->optional_data = Anim_bitmap_id_fire;
-				new_particle->nframes = Anim_num_frames_fire;
+				*optional_data = Anim_bitmap_id_fire;
+				*nframes = Anim_num_frames_fire;
 
 				break;
 			}
@@ -183,11 +321,11 @@ namespace particle
 			{
 				if (Anim_bitmap_id_smoke < 0)
 				{
-					return WeakParticlePtr();
+					return false;
 				}
 
-				new_particle->optional_data = Anim_bitmap_id_smoke;
-				new_particle->nframes = Anim_num_frames_smoke;
+				*optional_data = Anim_bitmap_id_smoke;
+				*nframes = Anim_num_frames_smoke;
 
 				break;
 			}
@@ -196,43 +334,267 @@ namespace particle
 			{
 				if (Anim_bitmap_id_smoke2 < 0)
 				{
-					return WeakParticlePtr();
+					return false;
 				}
 
-				new_particle->optional_data = Anim_bitmap_id_smoke2;
-				new_particle->nframes = Anim_num_frames_smoke2;
+				*optional_data = Anim_bitmap_id_smoke2;
+				*nframes = Anim_num_frames_smoke2;
 
 				break;
 			}
 
 			default:
-				new_particle->nframes = 1;
+				*nframes = 1;
 				break;
 		}
 
-		Particles.push_back(new_particle);
+		return true;
+	}
+}
+
+namespace particle
+{
+	// Reset everything between levels
+	void init()
+	{
+		// FIRE!!!
+		if (Anim_bitmap_id_fire == -1)
+		{
+			Anim_bitmap_id_fire = bm_load_animation("particleexp01", &Anim_num_frames_fire, nullptr, NULL, 0);
+		}
+
+		// Cough, cough
+		if (Anim_bitmap_id_smoke == -1)
+		{
+			Anim_bitmap_id_smoke = bm_load_animation("particlesmoke01", &Anim_num_frames_smoke, nullptr, NULL, 0);
+		}
+
+		// wheeze
+		if (Anim_bitmap_id_smoke2 == -1)
+		{
+			Anim_bitmap_id_smoke2 = bm_load_animation("particlesmoke02", &Anim_num_frames_smoke2, nullptr, NULL, 0);
+		}
+
+		// a budget set with the debug console stays until the game is closed
+		if (Particle_budget < 0)
+		{
+			Particle_budget = Cmdline_particle_budget;
+		}
+	}
+
+	// only call from game_shutdown()!!!
+	void close()
+	{
+		Particles = particle_pool();
+
+		gpu::kill_all();
+		Particle_time = 0.0f;
+	}
+
+	void page_in()
+	{
+		bm_page_in_texture(Anim_bitmap_id_fire);
+		bm_page_in_texture(Anim_bitmap_id_smoke);
+		bm_page_in_texture(Anim_bitmap_id_smoke2);
+
+		ParticleManager::get()->pageIn();
+	}
+
+	DCF_BOOL2(particles, Particles_enabled, "Turns particles on/off",
+			  "Usage: particles [bool]\nTurns particle system on/off.  If nothing passed, then toggles it.\n");
+
+	DCF(particle_budget, "Sets the number of particles above which distant ones are skipped")
+	{
+		if (dc_optional_string_either("help", "--help"))
+		{
+			dc_printf("Usage: particle_budget [count]\n");
+			dc_printf("\tOnce three quarters of the budget are used particles which are small on the screen are skipped.\n");
+			dc_printf("\tThe radius of the others is increased to make up for them. 0 removes the limit.\n");
+			return;
+		}
+
+		if (dc_optional_string_either("status", "--status") || dc_optional_string_either("?", "--?"))
+		{
+			dc_printf("Particle budget is %d, %d particles exist\n", MAX(Particle_budget, 0), static_cast<int>(Particles.count));
+			return;
+		}
+
+		int budget;
+		dc_stuff_int(&budget);
+		Particle_budget = MAX(budget, 0);
+
+		dc_printf("Particle budget set to %d\n", Particle_budget);
+	}
+
+	int Num_particles_hwm = 0;
+
+	ParticleHandle::ParticleHandle(int slot, uint generation) : m_slot(slot), m_generation(generation)
+	{
+	}
+
+	bool ParticleHandle::isValid() const
+	{
+		return m_slot >= 0 && m_slot < static_cast<int>(Particles.slot_generation.size())
+			&& Particles.slot_generation[m_slot] == m_generation;
+	}
+
+	vec3d& ParticleHandle::pos() const
+	{
+		Assertion(isValid(), "Tried to access a particle which is not valid anymore!");
+		return Particles.pos[Particles.slot_index[m_slot]];
+	}
+
+	vec3d& ParticleHandle::velocity() const
+	{
+		Assertion(isValid(), "Tried to access a particle which is not valid anymore!");
+		return Particles.velocity[Particles.slot_index[m_slot]];
+	}
+
+	float& ParticleHandle::age() const
+	{
+		Assertion(isValid(), "Tried to access a particle which is not valid anymore!");
+		return Particles.age[Particles.slot_index[m_slot]];
+	}
+
+	float& ParticleHandle::maxLife() const
+	{
+		Assertion(isValid(), "Tried to access a particle which is not valid anymore!");
+		return Particles.max_life[Particles.slot_index[m_slot]];
+	}
+
+	float& ParticleHandle::radius() const
+	{
+		Assertion(isValid(), "Tried to access a particle which is not valid anymore!");
+		return Particles.radius[Particles.slot_index[m_slot]];
+	}
+
+	int& ParticleHandle::attachedObjnum() const
+	{
+		Assertion(isValid(), "Tried to access a particle which is not valid anymore!");
+		return Particles.attached_objnum[Particles.slot_index[m_slot]];
+	}
+
+	// adds a particle to the pool, the values derived from its bitmap are already known
+	static ParticleHandle add_particle(particle_info* pinfo, float radius, int optional_data, int nframes, float max_life)
+	{
+		auto index = pool_add();
+
+		Particles.pos[index] = pinfo->pos;
+		Particles.velocity[index] = pinfo->vel;
+		Particles.age[index] = 0.0f;
+		Particles.max_life[index] = max_life;
+		Particles.radius[index] = radius;
+		Particles.type[index] = pinfo->type;
+		Particles.optional_data[index] = optional_data;
+		Particles.nframes[index] = nframes;
+		Particles.attached_objnum[index] = pinfo->attached_objnum;
+		Particles.attached_sig[index] = pinfo->attached_sig;
+		Particles.reverse[index] = pinfo->reverse ? 1 : 0;
+		Particles.effect[index] = stats::current_effect();
+
+		if (stats::enabled())
+		{
+			stats::particle_created(Particles.effect[index]);
+		}
 
 #ifndef NDEBUG
-		if (Particles.size() > static_cast<size_t>(Num_particles_hwm))
+		if (Particles.count > static_cast<size_t>(Num_particles_hwm))
 		{
-			Num_particles_hwm = static_cast<int>(Particles.size());
+			Num_particles_hwm = static_cast<int>(Particles.count);
 
 			nprintf(("Particles", "Num_particles high water mark = %i\n", Num_particles_hwm));
 		}
 #endif
 
-		return WeakParticlePtr(Particles.back());
+		auto slot = Particles.slot[index];
+		return ParticleHandle(slot, Particles.slot_generation[slot]);
 	}
 
-	WeakParticlePtr create(vec3d* pos, vec3d* vel, float lifetime, float rad, ParticleType type, int optional_data,
-						   object* objp, bool reverse)
+	// Creates a single particle. See the PARTICLE_?? defines for types.
+	ParticleHandle create(particle_info* pinfo)
+	{
+		if (!Particles_enabled)
+		{
+			return ParticleHandle();
+		}
+
+		int optional_data;
+		int nframes;
+		float max_life;
+
+		if (!get_particle_bitmap(pinfo, &optional_data, &nframes, &max_life))
+		{
+			return ParticleHandle();
+		}
+
+		float scale = get_budget_scale(pinfo);
+		if (scale <= 0.0f)
+		{
+			return ParticleHandle();
+		}
+
+		return add_particle(pinfo, pinfo->rad * scale, optional_data, nframes, max_life);
+	}
+
+	void create_unreferenced(particle_info* pinfo, float lifetime)
+	{
+		if (!Particles_enabled)
+		{
+			return;
+		}
+
+		// sources processed on worker threads can't create particles directly
+		if (ParticleManager::deferParticle(*pinfo, lifetime))
+		{
+			return;
+		}
+
+		int optional_data;
+		int nframes;
+		float max_life;
+
+		if (!get_particle_bitmap(pinfo, &optional_data, &nframes, &max_life))
+		{
+			return;
+		}
+
+		if (lifetime >= 0.0f)
+		{
+			max_life = lifetime;
+		}
+
+		float scale = get_budget_scale(pinfo);
+		if (scale <= 0.0f)
+		{
+			return;
+		}
+
+		// attached particles have to follow their object and the shader can neither play animations backwards nor
+		// handle frames with different delays
+		if (gpu::enabled() && (pinfo->type != PARTICLE_DEBUG) && (pinfo->attached_objnum < 0) && !pinfo->reverse
+			&& !bm_has_variable_frame_delays(optional_data))
+		{
+			gpu::create(pinfo->pos, pinfo->vel, pinfo->rad * scale, max_life, optional_data, nframes, Particle_time);
+
+			if (stats::enabled())
+			{
+				stats::particle_created(stats::current_effect());
+			}
+			return;
+		}
+
+		add_particle(pinfo, pinfo->rad * scale, optional_data, nframes, max_life);
+	}
+
+	ParticleHandle create(vec3d* pos, vec3d* vel, float lifetime, float rad, ParticleType type, int optional_data,
+						  object* objp, bool reverse)
 	{
 		particle_info pinfo;
 
 		if ((type < 0) || (type >= NUM_PARTICLE_TYPES))
 		{
 			Int3();
-			return WeakParticlePtr();
+			return ParticleHandle();
 		}
 
 		// setup old data
@@ -255,6 +617,7 @@ namespace particle
 			pinfo.attached_sig = objp->signature;
 		}
 		pinfo.reverse = reverse;
+		pinfo.priority = PARTICLE_PRIORITY_NORMAL;
 
 		// lower level function
 		return create(&pinfo);
@@ -266,44 +629,56 @@ namespace particle
 	{
 		TRACE_SCOPE(tracing::ParticlesMoveAll);
 
-		MONITOR_INC(NumParticles, Num_particles);
+		MONITOR_INC(NumParticles, static_cast<int>(Particles.count));
 
 		if (!Particles_enabled)
 			return;
 
-		if (Particles.empty())
+		Particle_time += frametime;
+
+		if (Particles.count == 0)
 			return;
 
-		for (auto p = Particles.begin(); p != Particles.end();)
+		auto count = Particles.count;
+
+		// the age and the position of every particle are updated in separate loops over the plain arrays so the
+		// compiler can vectorize them, the particles which die in this frame are moved as well but that doesn't matter
+		float* age = Particles.age.data();
+		for (size_t i = 0; i < count; ++i)
 		{
-			ParticlePtr part = *p;
-			if (part->age == 0.0f)
-			{
-				part->age = 0.00001f;
-			}
-			else
-			{
-				part->age += frametime;
-			}
+			age[i] = (age[i] == 0.0f) ? 0.00001f : age[i] + frametime;
+		}
+
+		vec3d* pos = Particles.pos.data();
+		const vec3d* velocity = Particles.velocity.data();
+		for (size_t i = 0; i < count; ++i)
+		{
+			pos[i].xyz.x += velocity[i].xyz.x * frametime;
+			pos[i].xyz.y += velocity[i].xyz.y * frametime;
+			pos[i].xyz.z += velocity[i].xyz.z * frametime;
+		}
 
+		for (size_t i = 0; i < Particles.count;)
+		{
 			bool remove_particle = false;
 
 			// if its time expired, remove it
-			if (part->age > part->max_life)
+			if (Particles.age[i] > Particles.max_life[i])
 			{
 				// special case, if max_life is 0 then we want it to render at least once
-				if ((part->age > frametime) || (part->max_life > 0.0f))
+				if ((Particles.age[i] > frametime) || (Particles.max_life[i] > 0.0f))
 				{
 					remove_particle = true;
 				}
 			}
 
 			// if the particle is attached to an object which has become invalid, kill it
-			if (part->attached_objnum >= 0)
+			auto attached_objnum = Particles.attached_objnum[i];
+			if (attached_objnum >= 0)
 			{
 				// if the signature has changed, or it's bogus, kill it
-				if ((part->attached_objnum >= MAX_OBJECTS) ||
-					(part->attached_sig != Objects[part->attached_objnum].signature))
+				if ((attached_objnum >= MAX_OBJECTS) ||
+					(Particles.attached_sig[i] != Objects[attached_objnum].signature))
 				{
 					remove_particle = true;
 				}
@@ -311,23 +686,13 @@ namespace particle
 
 			if (remove_particle)
 			{
-				// if we're sitting on the very last particle, popping-back will invalidate the iterator!
-				if (p + 1 == Particles.end())
-				{
-					Particles.pop_back();
-					break;
-				}
-
-				*p = Particles.back();
-				Particles.pop_back();
+				// the last particle takes the place of this one so the index must not be advanced
+				pool_remove(i);
 				continue;
 			}
 
-			// move as a regular particle
-			vm_vec_scale_add2(&part->pos, &part->velocity, frametime);
-
 			// next particle
-			++p;
+			++i;
 		}
 	}
 
@@ -335,10 +700,12 @@ namespace particle
 	void kill_all()
 	{
 		// kill all active particles
-		Num_particles = 0;
 		Num_particles_hwm = 0;
 
-		Particles.clear();
+		pool_clear();
+
+		gpu::kill_all();
+		Particle_time = 0.0f;
 	}
 
 	MONITOR(NumParticlesRend)
@@ -357,25 +724,29 @@ namespace particle
 		if (!Particles_enabled)
 			return;
 
-		MONITOR_INC(NumParticlesRend, Num_particles);
+		MONITOR_INC(NumParticlesRend, static_cast<int>(Particles.count));
 
-		if (Particles.empty())
+		gpu::render_all(Particle_time);
+
+		if (Particles.count == 0)
 			return;
 
-		for (SCP_vector<ParticlePtr>::iterator p = Particles.begin(); p != Particles.end(); ++p)
+		bool record_stats = stats::enabled();
+
+		for (size_t i = 0; i < Particles.count; ++i)
 		{
-			ParticlePtr part = *p;
 			// skip back-facing particles (ripped from fullneb code)
 			// Wanderer - add support for attached particles
 			vec3d p_pos;
-			if (part->attached_objnum >= 0)
+			auto attached_objnum = Particles.attached_objnum[i];
+			if (attached_objnum >= 0)
 			{
-				vm_vec_unrotate(&p_pos, &part->pos, &Objects[part->attached_objnum].orient);
-				vm_vec_add2(&p_pos, &Objects[part->attached_objnum].pos);
+				vm_vec_unrotate(&p_pos, &Particles.pos[i], &Objects[attached_objnum].orient);
+				vm_vec_add2(&p_pos, &Objects[attached_objnum].pos);
 			}
 			else
 			{
-				p_pos = part->pos;
+				p_pos = Particles.pos[i];
 			}
 
 			if (vm_vec_dot_to_point(&Eye_matrix.vec.fvec, &Eye_position, &p_pos) <= 0.0f)
@@ -401,28 +772,35 @@ namespace particle
 
 			g3_transfer_vertex(&pos, &p_pos);
 
+			auto nframes = Particles.nframes[i];
+
 			// figure out which frame we should be using
-			if (part->nframes > 1) {
-				framenum = bm_get_anim_frame(part->optional_data, part->age, part->max_life);
-				cur_frame = part->reverse ? (part->nframes - framenum - 1) : framenum;
+			if (nframes > 1) {
+				framenum = bm_get_anim_frame(Particles.optional_data[i], Particles.age[i], Particles.max_life[i]);
+				cur_frame = Particles.reverse[i] ? (nframes - framenum - 1) : framenum;
 			}
 			else
 			{
 				cur_frame = 0;
 			}
 
-			if (part->type == PARTICLE_DEBUG)
+			if (Particles.type[i] == PARTICLE_DEBUG)
 			{
 				gr_set_color(255, 0, 0);
-				g3_draw_sphere_ez(&p_pos, part->radius);
+				g3_draw_sphere_ez(&p_pos, Particles.radius[i]);
 			}
 			else
 			{
-				framenum = part->optional_data;
+				framenum = Particles.optional_data[i];
+
+				Assert( cur_frame < nframes );
 
-				Assert( cur_frame < part->nframes );
+				batching_add_volume_bitmap(framenum + cur_frame, &pos, Particles.slot[i] % 8, Particles.radius[i], alpha);
 
-				batching_add_volume_bitmap(framenum + cur_frame, &pos, part->particle_index % 8, part->radius, alpha);
+				if (record_stats)
+				{
+					stats::particle_rendered(Particles.effect[i], Particles.radius[i], vm_vec_dist(&Eye_position, &p_pos));
+				}
 
 				render_batch = true;
 			}
@@ -509,7 +887,19 @@ namespace particle
 			vm_vec_normalize_safe(&normal);
 			vm_vec_scale_add(&tmp_vel, &pe->vel, &normal, speed);
 
-			create(&pe->pos, &tmp_vel, life, radius, type, optional_data);
+			particle_info pinfo;
+			pinfo.pos = pe->pos;
+			pinfo.vel = tmp_vel;
+			pinfo.lifetime = life;
+			pinfo.rad = radius;
+			pinfo.type = type;
+			pinfo.optional_data = optional_data;
+			pinfo.attached_objnum = -1;
+			pinfo.attached_sig = -1;
+			pinfo.reverse = false;
+			pinfo.priority = PARTICLE_PRIORITY_NORMAL;
+
+			create_unreferenced(&pinfo);
 		}
 	}
 }
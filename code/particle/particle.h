@@ -15,8 +15,6 @@
 #include "globalincs/pstypes.h"
 #include "object/object.h"
 
-#include <memory>
-
 namespace particle
 {
 	//============================================================================
@@ -58,6 +56,16 @@ namespace particle
 		NUM_PARTICLE_TYPES,
 	};
 
+	/**
+	 * How important a particle is once more particles exist than -particle_budget allows
+	 */
+	enum ParticlePriority
+	{
+		PARTICLE_PRIORITY_NORMAL = 0, //!< Skipped when it is small on the screen, the default of a zeroed particle_info
+		PARTICLE_PRIORITY_LOW, //!< Skipped before the particles with normal priority
+		PARTICLE_PRIORITY_HIGH, //!< Never skipped
+	};
+
 	// particle creation stuff
 	typedef struct particle_info {
 		// old-style particle info
@@ -72,32 +80,56 @@ namespace particle
 		int attached_objnum;			// if these are set, the pos is relative to the pos of the origin of the attached object
 		int	attached_sig;				// to make sure the object hasn't changed or died. velocity is ignored in this case
 		bool	reverse;						// play any animations in reverse
+		ParticlePriority priority;		// which particles are skipped first if there are too many
 	} particle_info;
 
-	typedef struct particle {
-		// old style data
-		vec3d	pos;				// position
-		vec3d	velocity;			// velocity
-		float	age;				// How long it's been alive
-		float	max_life;			// How much life we had
-		float	radius;				// radius
-		int		type;				// type										// -1 = None
-		int		optional_data;		// depends on type
-		int		nframes;			// If an ani, how many frames?	
-
-		// new style data
-		int		attached_objnum;	// if this is set, pos is relative to the attached object. velocity is ignored
-		int		attached_sig;		// to check for dead/nonexistent objects
-		bool	reverse;			// play any animations in reverse
-		int		particle_index;		// used to keep particle offset in dynamic array for orient usage
-	} particle;
-
-	typedef std::weak_ptr<particle> WeakParticlePtr;
-	typedef std::shared_ptr<particle> ParticlePtr;
+	/**
+	 * @brief A weak reference to a particle
+	 *
+	 * The data of the particles is kept in pooled arrays. A handle stores the pool slot of its particle together with
+	 * the generation the slot had when the particle was created. Once the particle dies the generation of the slot
+	 * changes so the handle becomes invalid even if the slot is reused by a new particle.
+	 *
+	 * @warning The references returned by the accessors are only valid until the next particle is created or the
+	 * particles are moved.
+	 */
+	class ParticleHandle {
+		int m_slot = -1;
+		uint m_generation = 0;
+
+	 public:
+		ParticleHandle() = default;
+		ParticleHandle(int slot, uint generation);
+
+		/**
+		 * @brief Checks if the particle is still alive
+		 * @return @c true if the handle refers to a living particle
+		 */
+		bool isValid() const;
+
+		vec3d& pos() const;
+		vec3d& velocity() const;
+		float& age() const;
+		float& maxLife() const;
+		float& radius() const;
+		int& attachedObjnum() const;
+	};
 
 	// Creates a single particle. See the PARTICLE_?? defines for types.
-    WeakParticlePtr create(particle_info *pinfo);
-    WeakParticlePtr create(vec3d *pos, vec3d *vel, float lifetime, float rad, ParticleType type, int optional_data = -1, object *objp = NULL, bool reverse = false);
+	// Once the particle budget is nearly used up particles which are small on the screen may be skipped, depending on
+	// their priority, and the radius of the others is increased. The returned handle is invalid if that happens.
+	ParticleHandle create(particle_info *pinfo);
+	ParticleHandle create(vec3d *pos, vec3d *vel, float lifetime, float rad, ParticleType type, int optional_data = -1, object *objp = NULL, bool reverse = false);
+
+	/**
+	 * @brief Creates a particle nothing needs to refer to later
+	 *
+	 * If possible the particle is simulated and rendered on the GPU, otherwise this is the same as create().
+	 *
+	 * @param pinfo The values of the particle
+	 * @param lifetime If not negative this replaces the lifetime of @a pinfo and the one of an animation
+	 */
+	void create_unreferenced(particle_info *pinfo, float lifetime = -1.0f);
 
 	//============================================================================
 	//============== HIGH-LEVEL PARTICLE SYSTEM CREATION CODE ====================
@@ -28,22 +28,56 @@ void ParticleProperties::parse(bool nocreate) {
 			m_lifetime = util::parseUniformRange<float>();
 		}
 	}
+
+	if (optional_string("+Priority:")) {
+		SCP_string priority;
+		stuff_string(priority, F_NAME);
+
+		if (!stricmp(priority.c_str(), "Low")) {
+			m_priority = PARTICLE_PRIORITY_LOW;
+		} else if (!stricmp(priority.c_str(), "Normal")) {
+			m_priority = PARTICLE_PRIORITY_NORMAL;
+		} else if (!stricmp(priority.c_str(), "High")) {
+			m_priority = PARTICLE_PRIORITY_HIGH;
+		} else {
+			error_display(0, "Unknown particle priority '%s'! Must be Low, Normal or High.", priority.c_str());
+		}
+	}
 }
 
-WeakParticlePtr ParticleProperties::createParticle(particle_info& info) {
+ParticleHandle ParticleProperties::createParticle(particle_info& info) {
 	info.optional_data = m_bitmap;
 	info.type = PARTICLE_BITMAP;
 	info.rad = m_radius.next();
+	info.priority = m_priority;
 
 	auto p = create(&info);
 
-	if (m_hasLifetime && !p.expired()) {
-		p.lock()->max_life = m_lifetime.next();
+	if (m_hasLifetime && p.isValid()) {
+		p.maxLife() = m_lifetime.next();
 	}
 
 	return p;
 }
 
+void ParticleProperties::createUnreferencedParticle(particle_info& info) {
+	info.optional_data = m_bitmap;
+	info.type = PARTICLE_BITMAP;
+	info.rad = m_radius.next();
+	info.priority = m_priority;
+
+	create_unreferenced(&info, m_hasLifetime ? m_lifetime.next() : -1.0f);
+}
+
+void ParticleProperties::createTrailedParticle(particle_info& info, ParticleEffectIndex trailEffect) {
+	info.optional_data = m_bitmap;
+	info.type = PARTICLE_BITMAP;
+	info.rad = m_radius.next();
+	info.priority = m_priority;
+
+	ParticleManager::get()->createTrailedParticle(info, m_hasLifetime ? m_lifetime.next() : -1.0f, trailEffect);
+}
+
 void ParticleProperties::pageIn() {
 	if (m_bitmap >= 0) {
 		bm_page_in_aabitmap(m_bitmap, -1);
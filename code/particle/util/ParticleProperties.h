@@ -1,6 +1,7 @@
 #pragma once
 
 #include "particle/particle.h"
+#include "particle/ParticleManager.h"
 #include "particle/util/RandomRange.h"
 
 namespace particle {
@@ -20,6 +21,8 @@ class ParticleProperties {
 	bool m_hasLifetime = false;
 	UniformFloatRange m_lifetime;
 
+	ParticlePriority m_priority = PARTICLE_PRIORITY_NORMAL;
+
 	ParticleProperties();
 
 	/**
@@ -33,7 +36,24 @@ class ParticleProperties {
 	 * @param info The base values of the particle. Some values will be overwritten by this function
 	 * @return The created particle
 	 */
-	WeakParticlePtr createParticle(particle_info& info);
+	ParticleHandle createParticle(particle_info& info);
+
+	/**
+	 * @brief Creates a particle with the stored values which isn't referenced afterwards
+	 *
+	 * The particle may be simulated on the GPU, see particle::create_unreferenced().
+	 *
+	 * @param info The base values of the particle. Some values will be overwritten by this function
+	 */
+	void createUnreferencedParticle(particle_info& info);
+
+	/**
+	 * @brief Creates a particle with the stored values which is followed by a source of another effect
+	 *
+	 * @param info The base values of the particle. Some values will be overwritten by this function
+	 * @param trailEffect The effect of the source following the particle
+	 */
+	void createTrailedParticle(particle_info& info, ParticleEffectIndex trailEffect);
 
 	void pageIn();
 };
@@ -4,6 +4,7 @@
 #include <random>
 #include <type_traits>
 
+#include "globalincs/jobs.h"
 #include "globalincs/pstypes.h"
 #include "parse/parselo.h"
 
@@ -37,6 +38,31 @@ size_t parse_number_list(T (& list)[N]) {
 }
 }
 
+/**
+ * @brief Gets the random number generator of the current worker
+ *
+ * The sources of an effect may be processed on several workers at once so every worker has its own generator.
+ *
+ * @return The generator
+ *
+ * @ingroup particleUtils
+ */
+template<typename Generator>
+Generator& worker_generator() {
+	static SCP_vector<Generator> generators = []() {
+		std::random_device seed;
+		SCP_vector<Generator> workerGenerators;
+
+		for (size_t i = 0; i < jobs::num_workers(); ++i) {
+			workerGenerators.emplace_back(seed());
+		}
+
+		return workerGenerators;
+	}();
+
+	return generators[jobs::current_worker()];
+}
+
 /**
  * @brief Generic class for generating numbers in a specific range
  *
@@ -53,7 +79,6 @@ class RandomRange {
 	typedef Value ValueType;
 
  private:
-	GeneratorType m_generator;
 	DistributionType m_distribution;
 
 	bool m_constant;
@@ -62,7 +87,6 @@ class RandomRange {
  public:
 	template<typename... Ts>
 	RandomRange(ValueType param1, ValueType param2, Ts&& ... distributionParameters) :
-		m_generator(std::random_device()()),
 		m_distribution(param1, param2, distributionParameters...) {
 		m_constantValue = static_cast<ValueType>(0.0);
 		m_constant = false;
@@ -74,7 +98,6 @@ class RandomRange {
 	}
 
 	RandomRange() :
-		m_generator(std::random_device()()),
 		m_distribution() {
 		m_constantValue = static_cast<ValueType>(0.0);
 		m_constant = true;
@@ -89,7 +112,10 @@ class RandomRange {
 			return m_constantValue;
 		}
 
-		return m_distribution(m_generator);
+		// a copy of the distribution is used since some distributions keep state between calls
+		DistributionType distribution(m_distribution.param());
+
+		return distribution(worker_generator<GeneratorType>());
 	}
 };
 
@@ -378,6 +378,66 @@ void physics_sim(vec3d* position, matrix* orient, physics_info* pi, float sim_ti
 
 }
 
+//	-----------------------------------------------------------------------------------------------------------
+// Checks if physics_sim_drift() gives the same result as physics_sim() for this object.  This is the case for
+// everything which drifts with the same damping on all axes and isn't shaken by a shockwave, like debris and asteroids.
+bool physics_can_sim_drift(const physics_info *pi)
+{
+	return (pi->flags & PF_DEAD_DAMP) && !(pi->flags & (PF_CONST_VEL | PF_IN_SHOCKWAVE | PF_SPECIAL_WARP_IN | PF_SPECIAL_WARP_OUT));
+}
+
+//	-----------------------------------------------------------------------------------------------------------
+// Simulates an object for which physics_can_sim_drift() is true.  With the same damping on all axes the velocity
+// doesn't have to be moved into the local frame and back and apply_physics() only needs one exp() for all axes.
+void physics_sim_drift(vec3d *position, matrix *orient, physics_info *pi, float sim_time)
+{
+	Assert(physics_can_sim_drift(pi));
+	Assert(is_valid_matrix(orient));
+
+	if ((pi->flags & PF_REDUCED_DAMP) && timestamp_elapsed(pi->reduced_damp_decay)) {
+		pi->flags &= ~PF_REDUCED_DAMP;
+	}
+
+	vec3d dv;
+	vm_vec_sub(&dv, &pi->vel, &pi->desired_vel);
+
+	if (pi->side_slip_time_const < 0.0001f) {
+		vm_vec_scale_add2(position, &pi->desired_vel, sim_time);
+		pi->vel = pi->desired_vel;
+	} else {
+		float e = expf(-sim_time / pi->side_slip_time_const);
+
+		vm_vec_scale_add2(position, &dv, (1.0f - e) * pi->side_slip_time_const);
+		vm_vec_scale_add2(position, &pi->desired_vel, sim_time);
+		vm_vec_scale_add(&pi->vel, &pi->desired_vel, &dv, e);
+	}
+
+	vec3d drotvel;
+	vm_vec_sub(&drotvel, &pi->rotvel, &pi->desired_rotvel);
+
+	if (pi->rotdamp < 0.0001f) {
+		pi->rotvel = pi->desired_rotvel;
+	} else {
+		vm_vec_scale_add(&pi->rotvel, &pi->desired_rotvel, &drotvel, expf(-sim_time / pi->rotdamp));
+	}
+
+	angles tangles;
+	matrix tmp;
+
+	tangles.p = pi->rotvel.xyz.x*sim_time;
+	tangles.h = pi->rotvel.xyz.y*sim_time;
+	tangles.b = pi->rotvel.xyz.z*sim_time;
+
+	vm_angles_2_matrix(&pi->last_rotmat, &tangles);
+	vm_matrix_x_matrix(&tmp, orient, &pi->last_rotmat);
+	*orient = tmp;
+
+	vm_orthogonalize_matrix(orient);
+
+	pi->speed = vm_vec_mag(&pi->vel);
+	pi->fspeed = vm_vec_dot(&orient->vec.fvec, &pi->vel);
+}
+
 //	-----------------------------------------------------------------------------------------------------------
 // Simulate a physics object for this frame.  Used by the editor.  The difference between
 // this function and physics_sim() is that this one uses a heading change to rotate around
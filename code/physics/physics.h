@@ -128,6 +128,8 @@ extern void physics_init( physics_info * pi );
 extern void physics_read_flying_controls( matrix * orient, physics_info * pi, control_info * ci, float sim_time, vec3d *wash_rot=NULL);
 extern void physics_sim(vec3d *position, matrix * orient, physics_info * pi, float sim_time );
 extern void physics_sim_editor(vec3d *position, matrix * orient, physics_info * pi, float sim_time);
+extern bool physics_can_sim_drift(const physics_info *pi);
+extern void physics_sim_drift(vec3d *position, matrix *orient, physics_info *pi, float sim_time);
 
 extern void physics_sim_vel(vec3d * position, physics_info * pi, float sim_time, matrix * orient);
 extern void physics_sim_rot(matrix * orient, physics_info * pi, float sim_time );
@@ -1561,8 +1561,9 @@ bool pilotfile::save_savefile()
 	// i.e. lose one mission, not several missions worth (in theory)
 	Assertion(Red_alert_wingman_status.size() <= MAX_SHIPS, "Invalid number of Red_alert_wingman_status entries: " SIZE_T_ARG "\n", Red_alert_wingman_status.size());
 
-	// open it, hopefully...
-	cfp = cfopen((char*)filename.c_str(), "wb", CFILE_NORMAL, CF_TYPE_PLAYERS);
+	// the file is put together in memory and written to disk in the background
+	SCP_vector<ubyte> buffer;
+	cfp = cfopen_write_buffer(buffer);
 
 	if ( !cfp ) {
 		mprintf(("CSG => Unable to open '%s' for saving!\n", filename.c_str()));
@@ -1608,8 +1609,11 @@ bool pilotfile::save_savefile()
 	// Done!
 	mprintf(("CSG => Saving complete!\n"));
 
+	SCP_string save_filename = filename;
 	csg_close();
 
+	cf_write_file_async(save_filename.c_str(), CF_TYPE_PLAYERS, std::move(buffer));
+
 	return true;
 }
 
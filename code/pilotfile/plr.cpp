@@ -983,8 +983,9 @@ bool pilotfile::save_player(player *_p)
 		filename += ".plr";
 	}
 
-	// open it, hopefully...
-	auto fp = cfopen((char*)filename.c_str(), "wb", CFILE_NORMAL, CF_TYPE_PLAYERS);
+	// the file is put together in memory and written to disk in the background
+	SCP_vector<ubyte> buffer;
+	auto fp = cfopen_write_buffer(buffer);
 
 	if ( !fp ) {
 		mprintf(("PLR => Unable to open '%s' for saving!\n", filename.c_str()));
@@ -1030,8 +1031,11 @@ bool pilotfile::save_player(player *_p)
 	// Done!
 	mprintf(("PLR => Saving complete!\n"));
 
+	SCP_string save_filename = filename;
 	plr_close();
 
+	cf_write_file_async(save_filename.c_str(), CF_TYPE_PLAYERS, std::move(buffer));
+
 	return true;
 }
 
@@ -34,6 +34,7 @@
 #include "observer/observer.h"
 #include "parse/parselo.h"
 #include "playerman/player.h"
+#include "playerman/replay.h"
 #include "ship/ship.h"
 #include "ship/shipfx.h"
 #include "weapon/weapon.h"
@@ -1004,6 +1005,9 @@ void read_player_controls(object *objp, float frametime)
 		case PCM_NORMAL:
 			read_keyboard_controls(&(Player->ci), frametime, &objp->phys_info );
 
+			// a replay plays back the controls of its recording instead
+			replay_controls(&(Player->ci));
+
 			if ( lua_game_control & LGC_STEERING ) {
 				// make sure to copy the control before reseting it
 				Player->lua_ci = Player->ci;
@@ -0,0 +1,407 @@
+#include "cmdline/cmdline.h"
+#include "controlconfig/controlsconfig.h"
+#include "playerman/replay.h"
+
+#include <time.h>
+
+// The file starts with the magic, the version, the size of the button fields, the number of controls, the seed and the
+// length and characters of the mission. After that come the frames. Every number is a 32-bit little endian value.
+static const char Replay_magic[8] = { 'F', 'S', 'O', 'R', 'E', 'P', 'L', 'Y' };
+#define REPLAY_VERSION			1
+
+#define REPLAY_NONE				0
+#define REPLAY_RECORDING		1
+#define REPLAY_PLAYING			2
+
+// what a frame holds besides its frame times
+#define REPLAY_FRAME_BUTTONS	(1<<0)
+#define REPLAY_FRAME_CONTROLS	(1<<1)
+
+// a recorded file is flushed this often so a crash loses at most this many frames
+#define REPLAY_FLUSH_FRAMES		60
+
+typedef struct replay_frame {
+	int flags;
+	fix frametime;
+	float real_frametime;
+	button_info bi;
+	control_info ci;
+} replay_frame;
+
+static int Replay_mode = REPLAY_NONE;
+static bool Replay_in_mission = false;
+
+static SCP_string Replay_mission;
+static int Replay_seed = 0;
+
+// recording
+static FILE *Replay_file = nullptr;
+static replay_frame Replay_pending;
+static bool Replay_have_pending = false;
+static int Replay_recorded_frames = 0;
+
+// playing back
+static SCP_vector<replay_frame> Replay_frames;
+static size_t Replay_next_frame = 0;
+static replay_frame *Replay_current = nullptr;
+static float Replay_recorded_time = 0.0f;
+static float Replay_recorded_worst = 0.0f;
+static float Replay_played_time = 0.0f;
+static float Replay_played_worst = 0.0f;
+
+static void replay_write_int(int value)
+{
+	ubyte bytes[4];
+
+	for (int i = 0; i < 4; i++) {
+		bytes[i] = (ubyte)((uint)value >> (i * 8));
+	}
+	fwrite(bytes, 1, sizeof(bytes), Replay_file);
+}
+
+static void replay_write_float(float value)
+{
+	int bits;
+	memcpy(&bits, &value, sizeof(bits));
+
+	replay_write_int(bits);
+}
+
+static void replay_write_frame(const replay_frame *frame)
+{
+	replay_write_int(frame->flags);
+	replay_write_int(frame->frametime);
+	replay_write_float(frame->real_frametime);
+
+	for (int i = 0; i < NUM_BUTTON_FIELDS; i++) {
+		replay_write_int(frame->bi.status[i]);
+	}
+
+	replay_write_float(frame->ci.pitch);
+	replay_write_float(frame->ci.vertical);
+	replay_write_float(frame->ci.heading);
+	replay_write_float(frame->ci.sideways);
+	replay_write_float(frame->ci.bank);
+	replay_write_float(frame->ci.forward);
+	replay_write_float(frame->ci.forward_cruise_percent);
+	replay_write_int(frame->ci.fire_primary_count);
+	replay_write_int(frame->ci.fire_secondary_count);
+	replay_write_int(frame->ci.fire_countermeasure_count);
+	replay_write_int(frame->ci.fire_debug_count);
+	replay_write_int(frame->ci.afterburner_start);
+	replay_write_int(frame->ci.afterburner_stop);
+
+	if (++Replay_recorded_frames % REPLAY_FLUSH_FRAMES == 0) {
+		fflush(Replay_file);
+	}
+}
+
+// reads the values of a replay file, once the end is reached every value is 0 and done is set
+class replay_reader {
+	const SCP_vector<ubyte> &m_data;
+	size_t m_pos = 0;
+
+ public:
+	bool done = false;
+
+	explicit replay_reader(const SCP_vector<ubyte> &data) : m_data(data) {}
+
+	size_t remaining() const { return m_data.size() - m_pos; }
+
+	int read_int()
+	{
+		if (remaining() < 4) {
+			done = true;
+			return 0;
+		}
+
+		uint value = 0;
+		for (int i = 0; i < 4; i++) {
+			value |= (uint)m_data[m_pos++] << (i * 8);
+		}
+		return (int)value;
+	}
+
+	SCP_string read_string(size_t len)
+	{
+		if (remaining() < len) {
+			done = true;
+			return SCP_string();
+		}
+
+		SCP_string str(reinterpret_cast<const char *>(m_data.data() + m_pos), len);
+		m_pos += len;
+		return str;
+	}
+
+	float read_float()
+	{
+		int bits = read_int();
+		float value;
+		memcpy(&value, &bits, sizeof(value));
+
+		return value;
+	}
+};
+
+static bool replay_read_frame(replay_reader &reader, replay_frame *frame)
+{
+	frame->flags = reader.read_int();
+	frame->frametime = reader.read_int();
+	frame->real_frametime = reader.read_float();
+
+	for (int i = 0; i < NUM_BUTTON_FIELDS; i++) {
+		frame->bi.status[i] = reader.read_int();
+	}
+
+	frame->ci.pitch = reader.read_float();
+	frame->ci.vertical = reader.read_float();
+	frame->ci.heading = reader.read_float();
+	frame->ci.sideways = reader.read_float();
+	frame->ci.bank = reader.read_float();
+	frame->ci.forward = reader.read_float();
+	frame->ci.forward_cruise_percent = reader.read_float();
+	frame->ci.fire_primary_count = reader.read_int();
+	frame->ci.fire_secondary_count = reader.read_int();
+	frame->ci.fire_countermeasure_count = reader.read_int();
+	frame->ci.fire_debug_count = reader.read_int();
+	frame->ci.afterburner_start = reader.read_int();
+	frame->ci.afterburner_stop = reader.read_int();
+
+	// a recording which wasn't finished may end in the middle of a frame
+	return !reader.done;
+}
+
+bool replay_init()
+{
+	if (Cmdline_record_replay != nullptr) {
+		// The file is opened right away since the working directory may change later
+		Replay_file = fopen(Cmdline_record_replay, "wb");
+		if (Replay_file == nullptr) {
+			mprintf(("Replay: failed to open %s for recording\n", Cmdline_record_replay));
+			return false;
+		}
+
+		Replay_mode = REPLAY_RECORDING;
+		return true;
+	}
+
+	if (Cmdline_play_replay == nullptr) {
+		return true;
+	}
+
+	FILE *fp = fopen(Cmdline_play_replay, "rb");
+	if (fp == nullptr) {
+		mprintf(("Replay: failed to open %s\n", Cmdline_play_replay));
+		return false;
+	}
+
+	SCP_vector<ubyte> data;
+	ubyte buffer[4096];
+	size_t count;
+	while ((count = fread(buffer, 1, sizeof(buffer), fp)) > 0) {
+		data.insert(data.end(), buffer, buffer + count);
+	}
+	fclose(fp);
+
+	if (data.size() < sizeof(Replay_magic) || memcmp(data.data(), Replay_magic, sizeof(Replay_magic)) != 0) {
+		mprintf(("Replay: %s is not a replay\n", Cmdline_play_replay));
+		return false;
+	}
+
+	SCP_vector<ubyte> rest(data.begin() + sizeof(Replay_magic), data.end());
+	replay_reader reader(rest);
+
+	int version = reader.read_int();
+	int button_fields = reader.read_int();
+	int controls = reader.read_int();
+	Replay_seed = reader.read_int();
+	int mission_len = reader.read_int();
+
+	if (reader.done || version != REPLAY_VERSION) {
+		mprintf(("Replay: version %d of %s is not supported\n", version, Cmdline_play_replay));
+		return false;
+	}
+
+	// The buttons are stored by their index so they only mean the same in a build with the same controls
+	if (button_fields != NUM_BUTTON_FIELDS || controls != CCFG_MAX) {
+		mprintf(("Replay: %s was recorded by a build with different controls\n", Cmdline_play_replay));
+		return false;
+	}
+
+	if (mission_len <= 0 || (size_t)mission_len > reader.remaining()) {
+		mprintf(("Replay: %s is damaged\n", Cmdline_play_replay));
+		return false;
+	}
+
+	Replay_mission = reader.read_string((size_t)mission_len);
+
+	replay_frame frame;
+	while (replay_read_frame(reader, &frame)) {
+		Replay_frames.push_back(frame);
+	}
+
+	mprintf(("Replay: playing back %d frames of %s with seed %d\n", (int)Replay_frames.size(), Replay_mission.c_str(), Replay_seed));
+
+	Replay_mode = REPLAY_PLAYING;
+
+	// The string stays alive until the end so the command line may use it
+	Cmdline_start_mission = &Replay_mission[0];
+
+	return true;
+}
+
+bool replay_active()
+{
+	return Replay_mode != REPLAY_NONE;
+}
+
+void replay_mission_start(const char *mission)
+{
+	if (Replay_mode == REPLAY_NONE || Replay_in_mission) {
+		return;
+	}
+
+	if (Replay_mode == REPLAY_RECORDING) {
+		Replay_mission = mission;
+		Replay_seed = (int)time(nullptr);
+
+		fwrite(Replay_magic, 1, sizeof(Replay_magic), Replay_file);
+		replay_write_int(REPLAY_VERSION);
+		replay_write_int(NUM_BUTTON_FIELDS);
+		replay_write_int(CCFG_MAX);
+		replay_write_int(Replay_seed);
+		replay_write_int((int)Replay_mission.size());
+		fwrite(Replay_mission.c_str(), 1, Replay_mission.size(), Replay_file);
+
+		mprintf(("Replay: recording %s with seed %d to %s\n", mission, Replay_seed, Cmdline_record_replay));
+	} else {
+		if (stricmp(mission, Replay_mission.c_str()) != 0) {
+			Warning(LOCATION, "The replay was recorded in %s, not %s. It won't play back the same.", Replay_mission.c_str(), mission);
+		}
+	}
+
+	// Everything which is random while the mission loads and plays has to turn out the same way again
+	srand(Replay_seed);
+
+	Replay_in_mission = true;
+}
+
+static void replay_print_playback()
+{
+	auto frames = (int)Replay_next_frame;
+
+	if (frames == 0) {
+		return;
+	}
+
+	mprintf(("Replay: played back %d frames. Real frame time of the recording %.2f ms average, %.2f ms worst. This run %.2f ms average, %.2f ms worst.\n",
+		frames, Replay_recorded_time * 1000.0f / frames, Replay_recorded_worst * 1000.0f, Replay_played_time * 1000.0f / frames,
+		Replay_played_worst * 1000.0f));
+}
+
+void replay_mission_end()
+{
+	if (!Replay_in_mission) {
+		return;
+	}
+
+	Replay_in_mission = false;
+
+	if (Replay_mode == REPLAY_RECORDING) {
+		if (Replay_have_pending) {
+			replay_write_frame(&Replay_pending);
+			Replay_have_pending = false;
+		}
+
+		fclose(Replay_file);
+		Replay_file = nullptr;
+		mprintf(("Replay: recorded %d frames to %s\n", Replay_recorded_frames, Cmdline_record_replay));
+
+		// Only the first mission is recorded so a second one doesn't overwrite it
+		Replay_mode = REPLAY_NONE;
+	} else if (Replay_mode == REPLAY_PLAYING) {
+		replay_print_playback();
+
+		Replay_current = nullptr;
+		Replay_mode = REPLAY_NONE;
+	}
+}
+
+void replay_frame_start(fix *frametime, float real_frametime)
+{
+	if (!Replay_in_mission) {
+		return;
+	}
+
+	if (Replay_mode == REPLAY_RECORDING) {
+		if (Replay_have_pending) {
+			replay_write_frame(&Replay_pending);
+		}
+
+		memset(&Replay_pending, 0, sizeof(Replay_pending));
+		Replay_pending.frametime = *frametime;
+		Replay_pending.real_frametime = real_frametime;
+		Replay_have_pending = true;
+	} else if (Replay_mode == REPLAY_PLAYING) {
+		if (Replay_next_frame >= Replay_frames.size()) {
+			// The rest of the mission runs without the player
+			Replay_current = nullptr;
+			return;
+		}
+
+		Replay_current = &Replay_frames[Replay_next_frame++];
+		*frametime = Replay_current->frametime;
+
+		Replay_recorded_time += Replay_current->real_frametime;
+		Replay_recorded_worst = MAX(Replay_recorded_worst, Replay_current->real_frametime);
+		Replay_played_time += real_frametime;
+		Replay_played_worst = MAX(Replay_played_worst, real_frametime);
+
+		if (Replay_next_frame == Replay_frames.size()) {
+			replay_print_playback();
+		}
+	}
+}
+
+void replay_buttons(button_info *bi)
+{
+	if (!Replay_in_mission) {
+		return;
+	}
+
+	if (Replay_mode == REPLAY_RECORDING && Replay_have_pending) {
+		Replay_pending.bi = *bi;
+		Replay_pending.flags |= REPLAY_FRAME_BUTTONS;
+	} else if (Replay_mode == REPLAY_PLAYING) {
+		// The keys of this run don't count while the recorded ones are played back
+		if (Replay_current != nullptr && (Replay_current->flags & REPLAY_FRAME_BUTTONS)) {
+			*bi = Replay_current->bi;
+		} else {
+			button_info_clear(bi);
+		}
+	}
+}
+
+void replay_controls(control_info *ci)
+{
+	if (!Replay_in_mission) {
+		return;
+	}
+
+	if (Replay_mode == REPLAY_RECORDING && Replay_have_pending) {
+		Replay_pending.ci = *ci;
+		Replay_pending.flags |= REPLAY_FRAME_CONTROLS;
+	} else if (Replay_mode == REPLAY_PLAYING) {
+		if (Replay_current != nullptr && (Replay_current->flags & REPLAY_FRAME_CONTROLS)) {
+			*ci = Replay_current->ci;
+		} else {
+			memset(ci, 0, sizeof(*ci));
+		}
+	}
+}
+
+bool replay_finished()
+{
+	return Replay_mode == REPLAY_PLAYING && Replay_in_mission && Replay_next_frame >= Replay_frames.size();
+}
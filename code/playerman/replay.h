@@ -0,0 +1,44 @@
+#ifndef _REPLAY_H
+#define _REPLAY_H
+
+#include "globalincs/pstypes.h"
+#include "io/keycontrol.h"
+#include "physics/physics.h"
+
+// Records the controls of the player in a single player mission so the same simulation can be run again, see
+// -record_replay and -play_replay.
+//
+// A replay stores the mission, the random seed it was loaded with and for every frame its frame time, the real frame
+// time of the recording and the controls and buttons the player used. Playing it back loads the mission with the same
+// seed, skips the loadout like the benchmarks do and feeds the recorded frame times and controls to the simulation
+// instead of the ones of this run. Together with -benchmark_simulation or -benchmark_flythrough it makes a reproducible
+// benchmark out of a bug report.
+
+// opens the replay of -play_replay and makes its mission the one of -start_mission, call after the command line was
+// parsed. returns false if the replay can't be read
+bool replay_init();
+
+// whether a replay is recorded or played back
+bool replay_active();
+
+// starts recording or playing back the mission if a replay is active, this seeds the random numbers so call it right
+// before the mission is loaded
+void replay_mission_start(const char *mission);
+
+// writes the replay if one is recorded, call when the mission ends
+void replay_mission_end();
+
+// called for every frame of the mission once its frame time is known, this is replaced by the recorded one while a
+// replay is played back. real_frametime is the frame time before the time compression
+void replay_frame_start(fix *frametime, float real_frametime);
+
+// records the buttons the player pressed in this frame or replaces them with the recorded ones
+void replay_buttons(button_info *bi);
+
+// records the controls of the player ship in this frame or replaces them with the recorded ones
+void replay_controls(control_info *ci);
+
+// returns true once every recorded frame was played back
+bool replay_finished();
+
+#endif // _REPLAY_H
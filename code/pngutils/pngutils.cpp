@@ -525,6 +525,7 @@ void apng_ani::_process_chunk()
 
 		if (_reading) {
 			anim_time+= frame_delay;
+			frame_delays.push_back(frame_delay);
 			_frame_offsets.push_back((int)_offset);
 		}
 		else {
@@ -41,6 +41,7 @@ public:
 	uint       current_frame;
 	uint       plays;
 	float      anim_time;
+	SCP_vector<float> frame_delays;  // the delay of every frame, known once the header has been read
 
 	apng_ani(const char* filenamen, bool cache = true);
 	~apng_ani();
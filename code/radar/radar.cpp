@@ -279,6 +279,8 @@ void HudGaugeRadarStd::drawContactImage( int x, int y, int rad, int idx, int clr
 
 void HudGaugeRadarStd::render(float frametime)
 {
+	radar_update_blips();
+
 	//WMC - This strikes me as a bit hackish
 	bool g3_yourself = !g3_in_frame();
 	if(g3_yourself)
@@ -479,6 +479,8 @@ void HudGaugeRadarDradis::drawBlipsSorted(int distort)
 
 void HudGaugeRadarDradis::render(float frametime)
 {
+	radar_update_blips();
+
 	float sensors_str;
 	int   ok_to_blit_radar;
 	
@@ -440,6 +440,8 @@ void HudGaugeRadarOrb::drawOutlinesHtl()
 
 void HudGaugeRadarOrb::render(float frametime)
 {
+	radar_update_blips();
+
 	float	sensors_str;
 	int ok_to_blit_radar;
 
@@ -143,13 +143,38 @@ void radar_stuff_blip_info(object *objp, int is_bright, color **blip_color, int
 	}
 }
 
+static hud_update_rate Radar_update_rate(RADAR_UPDATE_RATE);
+
+// whether the blips are gathered again in this frame, or just moved along with their objects by radar_update_blips()
+static bool Radar_gather_blips = true;
+static bool Radar_blips_moved = true;
+
+// a new target or range changes which blips are shown, so the blips are gathered right away then
+static int Radar_gathered_target = -1;
+static int Radar_gathered_range = -1;
+
+static void radar_get_eye_orient(matrix *eye_orient)
+{
+	vec3d tempv;
+
+	if (Player_obj->type == OBJ_SHIP)
+		ship_get_eye(&tempv, eye_orient, Player_obj, false , false);
+	else
+		*eye_orient = Player_obj->orient;
+}
+
 void radar_plot_object( object *objp )
 {
 	vec3d pos, tempv;
 	float awacs_level, dist, max_radar_dist;
 	vec3d world_pos = objp->pos;
+	bool use_last_pos = false;
 	SCP_list<CJumpNode>::iterator jnp;
 
+	if (!Radar_gather_blips) {
+		return;
+	}
+
 	// don't process anything here.  Somehow, a jumpnode object caused this function
 	// to get entered on server side.
 	if( Game_mode & GM_STANDALONE_SERVER ){
@@ -224,8 +249,10 @@ void radar_plot_object( object *objp )
 				return;
 
 			// if corkscrew missile use last frame pos for pos
-			if ( (Weapon_info[Weapons[objp->instance].weapon_info_index].wi_flags[Weapon::Info_Flags::Corkscrew]) )
+			if ( (Weapon_info[Weapons[objp->instance].weapon_info_index].wi_flags[Weapon::Info_Flags::Corkscrew]) ) {
 				world_pos = objp->last_pos;
+				use_last_pos = true;
+			}
 
 			break;
 		}
@@ -237,11 +264,7 @@ void radar_plot_object( object *objp )
 
 	// Retrieve the eye orientation so we can position the blips relative to it
 	matrix eye_orient;
-
-	if (Player_obj->type == OBJ_SHIP) 
-		ship_get_eye(&tempv, &eye_orient, Player_obj, false , false);
-	else
-		eye_orient = Player_obj->orient;
+	radar_get_eye_orient(&eye_orient);
 
 	// JAS -- new way of getting the rotated point that doesn't require this to be
 	// in a g3_start_frame/end_frame block.
@@ -296,6 +319,8 @@ void radar_plot_object( object *objp )
 	b->position = pos;
 	b->dist = dist;
 	b->objp = objp;
+	b->objsig = objp->signature;
+	b->use_last_pos = use_last_pos;
 	b->radar_image_2d = -1;
 	b->radar_color_image_2d = -1;
 	b->radar_image_size = -1;
@@ -348,6 +373,8 @@ void radar_mission_init()
 	}
 
 	Radar_calc_bright_dist_timer = timestamp(0);
+
+	Radar_update_rate.force();
 }
 
 void radar_null_nblips()
@@ -364,7 +391,65 @@ void radar_null_nblips()
 
 void radar_frame_init()
 {
-	radar_null_nblips();
+	int target = (Player_ai != NULL) ? Player_ai->target_objnum : -1;
+
+	if (target != Radar_gathered_target || HUD_config.rp_dist != Radar_gathered_range) {
+		Radar_update_rate.force();
+	}
+
+	Radar_gather_blips = Radar_update_rate.due();
+
+	if (Radar_gather_blips) {
+		radar_null_nblips();
+		Radar_gathered_target = target;
+		Radar_gathered_range = HUD_config.rp_dist;
+	} else {
+		Radar_blips_moved = false;
+	}
+}
+
+// moves the blips gathered in an earlier frame to where their objects are now and drops the ones which are gone
+void radar_update_blips()
+{
+	if (Radar_blips_moved) {
+		return;
+	}
+	Radar_blips_moved = true;
+
+	if (Player_obj == NULL) {
+		return;
+	}
+
+	matrix eye_orient;
+	radar_get_eye_orient(&eye_orient);
+
+	float max_radar_dist = Radar_ranges[HUD_config.rp_dist];
+
+	for (int i = 0; i < N_blips; i++) {
+		blip *b = &Blips[i];
+
+		// already dropped
+		if (b->next == NULL) {
+			continue;
+		}
+
+		if (b->objp->signature != b->objsig || b->objp->flags[Object::Object_Flags::Should_be_dead]) {
+			list_remove(NULL, b);
+			continue;
+		}
+
+		vec3d world_pos = b->use_last_pos ? b->objp->last_pos : b->objp->pos;
+		vec3d tempv;
+
+		b->dist = vm_vec_dist(&world_pos, &Player_obj->pos);
+		if (b->dist > max_radar_dist) {
+			list_remove(NULL, b);
+			continue;
+		}
+
+		vm_vec_sub(&tempv, &world_pos, &Player_obj->pos);
+		vm_vec_rotate(&b->position, &tempv, &eye_orient);
+	}
 }
 
 HudGaugeRadar::HudGaugeRadar():
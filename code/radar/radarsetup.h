@@ -43,6 +43,8 @@ typedef struct blip	{
 
 	float   dist;
 	object* objp;
+	int objsig;		// to check objp is still the object the blip was made for
+	bool use_last_pos;
 } blip;
 
 
@@ -91,8 +93,12 @@ enum RadarVisibility
 	DISTORTED //!< Visible but not fully
 };
 
+// times per second the blips are gathered, they follow their objects in between
+#define RADAR_UPDATE_RATE	20
+
 void radar_frame_init();
 void radar_mission_init();
+void radar_update_blips();
 void radar_plot_object( object *objp );
 RadarVisibility radar_is_visible( object *objp );
 
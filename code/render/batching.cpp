@@ -15,7 +15,15 @@
 #include "graphics/material.h"
 #include "tracing/tracing.h"
 
-static SCP_map<batch_info, primitive_batch> Batching_primitives;
+#include <cstring>
+#include <memory>
+
+// the batches are looked up in a hash table whenever something is added, the list keeps them in creation order for
+// loading the buffers. Batches are never removed so their vertex storage is reused in the next frames.
+static SCP_vector<std::unique_ptr<primitive_batch>> Batching_primitives;
+static SCP_unordered_map<batch_info, primitive_batch*, batch_info_hash> Batching_primitive_lookup;
+static primitive_batch* Batching_last_batch = nullptr;
+
 static SCP_map<batch_buffer_key, primitive_batch_buffer> Batching_buffers;
 
 void primitive_batch::add_triangle(batch_vertex* v0, batch_vertex* v1, batch_vertex *v2)
@@ -34,8 +42,8 @@ size_t primitive_batch::load_buffer(batch_vertex* buffer, size_t n_verts)
 {
 	size_t verts_to_render = Vertices.size();
 
-	for ( size_t i = 0; i < verts_to_render; ++i) {
-		buffer[n_verts+i] = Vertices[i];
+	if ( verts_to_render > 0 ) {
+		memcpy(buffer + n_verts, &Vertices[0], verts_to_render * sizeof(batch_vertex));
 	}
 
 	return verts_to_render;
@@ -76,8 +84,10 @@ void batching_init_buffer(primitive_batch_buffer *buffer, primitive_type prim_ty
 	batching_setup_vertex_layout(&buffer->layout, vertex_mask);
 
 	buffer->buffer_num = gr_create_vertex_buffer();
+	buffer->render_buffer_num = buffer->buffer_num;
 	buffer->buffer_ptr = NULL;
 	buffer->buffer_size = 0;
+	buffer->gpu_buffer_size = 0;
 	buffer->desired_buffer_size = 0;
 	buffer->prim_type = prim_type;
 }
@@ -114,16 +124,24 @@ primitive_batch* batching_find_batch(int texture, batch_info::material_type mate
 {
 	batch_info query(material_id, texture, prim_type, thruster);
 
-	SCP_map<batch_info, primitive_batch>::iterator iter = Batching_primitives.find(query);
+	// effects of the same kind are usually added one after another
+	if ( Batching_last_batch != nullptr && Batching_last_batch->get_render_info() == query ) {
+		return Batching_last_batch;
+	}
+
+	auto iter = Batching_primitive_lookup.find(query);
 
-	if ( iter == Batching_primitives.end() ) {
-		primitive_batch* batch = &Batching_primitives[query];
+	if ( iter == Batching_primitive_lookup.end() ) {
+		Batching_primitives.emplace_back(new primitive_batch(query));
 
-		*batch = primitive_batch(query);
+		primitive_batch* batch = Batching_primitives.back().get();
+		Batching_primitive_lookup.emplace(query, batch);
 
+		Batching_last_batch = batch;
 		return batch;
 	} else {
-		return &iter->second;
+		Batching_last_batch = iter->second;
+		return iter->second;
 	}
 }
 
@@ -131,6 +149,7 @@ uint batching_determine_vertex_layout(batch_info *info)
 {
 	if ( info->prim_type == PRIM_TYPE_POINTS ) {
 		return vertex_format_data::mask(vertex_format_data::POSITION3) 
+			| vertex_format_data::mask(vertex_format_data::COLOR4) 
 			| vertex_format_data::mask(vertex_format_data::RADIUS) 
 			| vertex_format_data::mask(vertex_format_data::UVEC);
 	}
@@ -258,7 +277,7 @@ void batching_add_bitmap_internal(primitive_batch *batch, vertex *pnt, int orien
 	batch->add_triangle(&verts[2], &verts[1], &verts[0]);
 }
 
-void batching_add_point_bitmap(primitive_batch *batch, vertex *position, int orient, float rad, float depth)
+void batching_add_point_bitmap(primitive_batch *batch, vertex *position, int orient, float rad, color *clr, float depth)
 {
 	Assert(batch->get_render_info().prim_type == PRIM_TYPE_POINTS);
 
@@ -279,8 +298,12 @@ void batching_add_point_bitmap(primitive_batch *batch, vertex *position, int ori
 	batch_vertex new_particle;
 	vec3d up = {{{ 0.0f, 1.0f, 0.0f }}};
 
-	new_particle.position = position->world;
+	new_particle.position = PNT;
 	new_particle.radius = radius;
+	new_particle.r = clr->red;
+	new_particle.g = clr->green;
+	new_particle.b = clr->blue;
+	new_particle.a = clr->alpha;
 
 	int direction = orient % 4;
 
@@ -385,7 +408,7 @@ void batching_add_bitmap_rotated_internal(primitive_batch *batch, vertex *pnt, f
 	batch->add_triangle(&verts[3], &verts[4], &verts[5]);
 }
 
-void batching_add_point_bitmap(primitive_batch *batch, vertex *position, float rad, float angle, float depth)
+void batching_add_point_bitmap(primitive_batch *batch, vertex *position, float angle, float rad, color *clr, float depth)
 {
 	Assert(batch->get_render_info().prim_type == PRIM_TYPE_POINTS);
 
@@ -403,13 +426,21 @@ void batching_add_point_bitmap(primitive_batch *batch, vertex *position, float r
 	if ( depth != 0.0f )
 		vm_vec_scale_add(&PNT, &PNT, &fvec, depth);
 
+	extern float Physics_viewer_bank;
+	angle -= Physics_viewer_bank;
+
 	batch_vertex new_particle;
 	vec3d up;
 
+	// the geometry shader builds the quad in view space so the up vector is rotated around the view axis
 	vm_rot_point_around_line(&up, &vmd_y_vector, angle, &vmd_zero_vector, &vmd_z_vector);
 
-	new_particle.position = position->world;
+	new_particle.position = PNT;
 	new_particle.radius = radius;
+	new_particle.r = clr->red;
+	new_particle.g = clr->green;
+	new_particle.b = clr->blue;
+	new_particle.a = clr->alpha;
 	new_particle.uvec = up;
 
 	batch->add_point_sprite(&new_particle);
@@ -720,8 +751,11 @@ void batching_add_volume_bitmap(int texture, vertex *pnt, int orient, float rad,
 	}
 
 	primitive_batch *batch;
-	
-	if ( gr_is_capable(CAPABILITY_SOFT_PARTICLES) ) {
+
+	if ( gr_is_capable(CAPABILITY_SOFT_PARTICLES) && gr_is_capable(CAPABILITY_POINT_PARTICLES) ) {
+		// one vertex per sprite, the geometry shader expands it into the quad
+		batch = batching_find_batch(texture, batch_info::VOLUME_EMISSIVE, PRIM_TYPE_POINTS);
+	} else if ( gr_is_capable(CAPABILITY_SOFT_PARTICLES) ) {
 		batch = batching_find_batch(texture, batch_info::VOLUME_EMISSIVE);
 	} else {
 		batch = batching_find_batch(texture, batch_info::FLAT_EMISSIVE);
@@ -730,7 +764,11 @@ void batching_add_volume_bitmap(int texture, vertex *pnt, int orient, float rad,
 	color clr;
 	batching_determine_blend_color(&clr, texture, alpha);
 
-	batching_add_bitmap_internal(batch, pnt, orient, rad, &clr, depth);
+	if ( batch->get_render_info().prim_type == PRIM_TYPE_POINTS ) {
+		batching_add_point_bitmap(batch, pnt, orient, rad, &clr, depth);
+	} else {
+		batching_add_bitmap_internal(batch, pnt, orient, rad, &clr, depth);
+	}
 }
 
 void batching_add_volume_bitmap_rotated(int texture, vertex *pnt, float angle, float rad, float alpha, float depth)
@@ -742,7 +780,10 @@ void batching_add_volume_bitmap_rotated(int texture, vertex *pnt, float angle, f
 
 	primitive_batch *batch;
 
-	if ( gr_is_capable(CAPABILITY_SOFT_PARTICLES) ) {
+	if ( gr_is_capable(CAPABILITY_SOFT_PARTICLES) && gr_is_capable(CAPABILITY_POINT_PARTICLES) ) {
+		// one vertex per sprite, the geometry shader expands it into the quad
+		batch = batching_find_batch(texture, batch_info::VOLUME_EMISSIVE, PRIM_TYPE_POINTS);
+	} else if ( gr_is_capable(CAPABILITY_SOFT_PARTICLES) ) {
 		batch = batching_find_batch(texture, batch_info::VOLUME_EMISSIVE);
 	} else {
 		batch = batching_find_batch(texture, batch_info::FLAT_EMISSIVE);
@@ -751,7 +792,11 @@ void batching_add_volume_bitmap_rotated(int texture, vertex *pnt, float angle, f
 	color clr;
 	batching_determine_blend_color(&clr, texture, alpha);
 
-	batching_add_bitmap_rotated_internal(batch, pnt, angle, rad, &clr, depth);
+	if ( batch->get_render_info().prim_type == PRIM_TYPE_POINTS ) {
+		batching_add_point_bitmap(batch, pnt, angle, rad, &clr, depth);
+	} else {
+		batching_add_bitmap_rotated_internal(batch, pnt, angle, rad, &clr, depth);
+	}
 }
 
 void batching_add_distortion_bitmap_rotated(int texture, vertex *pnt, float angle, float rad, float alpha, float depth)
@@ -884,19 +929,55 @@ void batching_allocate_and_load_buffer(primitive_batch_buffer *draw_queue)
 {
 	Assert(draw_queue != NULL);
 
-	if ( draw_queue->buffer_size < draw_queue->desired_buffer_size ) {
+	size_t num_items = draw_queue->items.size();
+
+	if ( num_items == 0 ) {
+		draw_queue->desired_buffer_size = 0;
+		return;
+	}
+
+	// write the vertices straight into the immediate buffer so the driver doesn't have to copy them again
+	int immediate_handle = -1;
+	size_t immediate_offset = 0;
+	auto immediate_ptr = gr_map_immediate_buffer(draw_queue->desired_buffer_size, sizeof(batch_vertex), &immediate_handle, &immediate_offset);
+
+	if ( immediate_ptr != nullptr ) {
+		draw_queue->desired_buffer_size = 0;
+		draw_queue->render_buffer_num = immediate_handle;
+
+		size_t first_vert = immediate_offset / sizeof(batch_vertex);
+		size_t offset = 0;
+
+		for ( size_t i = 0; i < num_items; ++i ) {
+			primitive_batch_item *item = &draw_queue->items[i];
+
+			item->offset = first_vert + offset;
+			item->n_verts = item->batch->load_buffer((batch_vertex*)immediate_ptr, offset);
+			item->batch->clear();
+
+			offset += item->n_verts;
+		}
+
+		gr_unmap_immediate_buffer();
+		return;
+	}
+
+	size_t used_size = draw_queue->desired_buffer_size;
+
+	if ( draw_queue->buffer_size < used_size ) {
 		if ( draw_queue->buffer_ptr != NULL ) {
 			vm_free(draw_queue->buffer_ptr);
 		}
 
-		draw_queue->buffer_size = draw_queue->desired_buffer_size;
-		draw_queue->buffer_ptr = vm_malloc(draw_queue->desired_buffer_size);
+		// leave room for more vertices so the buffers only grow a few times
+		draw_queue->buffer_size = MAX(used_size, draw_queue->buffer_size * 2);
+		draw_queue->buffer_ptr = vm_malloc(draw_queue->buffer_size);
 	}
 
 	draw_queue->desired_buffer_size = 0;
+	draw_queue->render_buffer_num = draw_queue->buffer_num;
 	
 	size_t offset = 0;
-	size_t num_items = draw_queue->items.size();
 
 	for ( size_t i = 0; i < num_items; ++i ) {
 		primitive_batch_item *item = &draw_queue->items[i];
@@ -909,7 +990,12 @@ void batching_allocate_and_load_buffer(primitive_batch_buffer *draw_queue)
 	}
 
 	if ( draw_queue->buffer_num >= 0 ) {
-		gr_update_buffer_data(draw_queue->buffer_num, draw_queue->buffer_size, draw_queue->buffer_ptr);
+		if ( draw_queue->gpu_buffer_size < draw_queue->buffer_size ) {
+			draw_queue->gpu_buffer_size = draw_queue->buffer_size;
+			gr_update_buffer_data(draw_queue->buffer_num, draw_queue->gpu_buffer_size, nullptr);
+		}
+
+		gr_update_buffer_data_offset(draw_queue->buffer_num, 0, used_size, draw_queue->buffer_ptr);
 	}
 }
 
@@ -918,7 +1004,6 @@ void batching_load_buffers(bool distortion)
 	GR_DEBUG_SCOPE("Batching load buffers");
 	TRACE_SCOPE(tracing::LoadBatchingBuffers);
 
-	SCP_map<batch_info, primitive_batch>::iterator bi;
 	SCP_map<batch_buffer_key, primitive_batch_buffer>::iterator buffer_iter;
 
 	for ( buffer_iter = Batching_buffers.begin(); buffer_iter != Batching_buffers.end(); ++buffer_iter ) {
@@ -927,8 +1012,8 @@ void batching_load_buffers(bool distortion)
 	}
 
 	// assign primitive batch items
-	for ( bi = Batching_primitives.begin(); bi != Batching_primitives.end(); ++bi ) {
-		if ( bi->first.mat_type == batch_info::DISTORTION ) {
+	for ( auto& batch : Batching_primitives ) {
+		if ( batch->get_render_info().mat_type == batch_info::DISTORTION ) {
 			if ( !distortion ) {
 				continue;
 			}
@@ -938,10 +1023,10 @@ void batching_load_buffers(bool distortion)
 			}
 		}
 
-		size_t num_verts = bi->second.num_verts();
+		size_t num_verts = batch->num_verts();
 
 		if ( num_verts > 0 ) {
-			batch_info render_info = bi->second.get_render_info();
+			batch_info render_info = batch->get_render_info();
 			uint vertex_mask = batching_determine_vertex_layout(&render_info);
 
 			primitive_batch_buffer *buffer = batching_find_buffer(vertex_mask, render_info.prim_type);
@@ -950,7 +1035,7 @@ void batching_load_buffers(bool distortion)
 			draw_item.batch_item_info = render_info;
 			draw_item.offset = 0;
 			draw_item.n_verts = num_verts;
-			draw_item.batch = &bi->second;
+			draw_item.batch = batch.get();
 
 			buffer->desired_buffer_size += num_verts * sizeof(batch_vertex);
 			buffer->items.push_back(draw_item);
@@ -975,7 +1060,7 @@ void batching_render_buffer(primitive_batch_buffer *buffer)
 				continue;
 			}
 
-			batching_render_batch_item(&buffer->items[i], &buffer->layout, buffer->prim_type, buffer->buffer_num);
+			batching_render_batch_item(&buffer->items[i], &buffer->layout, buffer->prim_type, buffer->render_buffer_num);
 		}
 	}
 
@@ -998,6 +1083,74 @@ void batching_render_all(bool render_distortions)
 	gr_clear_states();
 }
 
+bool batching_get_distortion_bounds(int *x1, int *y1, int *x2, int *y2)
+{
+	bool queued = false;
+	bool full_screen = false;
+
+	float min_x = i2fl(gr_screen.max_w);
+	float min_y = i2fl(gr_screen.max_h);
+	float max_x = 0.0f;
+	float max_y = 0.0f;
+
+	for ( auto& batch : Batching_primitives ) {
+		if ( batch->get_render_info().mat_type != batch_info::DISTORTION || batch->num_verts() == 0 ) {
+			continue;
+		}
+
+		queued = true;
+
+		for ( auto& batch_vert : batch->get_vertices() ) {
+			vertex v;
+			g3_rotate_vertex(&v, &batch_vert.position);
+
+			if ( v.codes & CC_BEHIND ) {
+				full_screen = true;
+				break;
+			}
+
+			g3_project_vertex(&v);
+
+			if ( v.flags & PF_OVERFLOW ) {
+				full_screen = true;
+				break;
+			}
+
+			min_x = MIN(min_x, v.screen.xyw.x);
+			min_y = MIN(min_y, v.screen.xyw.y);
+			max_x = MAX(max_x, v.screen.xyw.x);
+			max_y = MAX(max_y, v.screen.xyw.y);
+		}
+
+		if ( full_screen ) {
+			break;
+		}
+	}
+
+	if ( !queued ) {
+		return false;
+	}
+
+	if ( full_screen ) {
+		*x1 = 0;
+		*y1 = 0;
+		*x2 = gr_screen.max_w;
+		*y2 = gr_screen.max_h;
+		return true;
+	}
+
+	// the distortion shader samples up to half a percent of the screen away from the fragment
+	float pad_x = gr_screen.max_w * 0.01f + 1.0f;
+	float pad_y = gr_screen.max_h * 0.01f + 1.0f;
+
+	*x1 = MAX(fl2i(min_x - pad_x), 0);
+	*y1 = MAX(fl2i(min_y - pad_y), 0);
+	*x2 = MIN(fl2i(max_x + pad_x) + 1, gr_screen.max_w);
+	*y2 = MIN(fl2i(max_y + pad_y) + 1, gr_screen.max_h);
+
+	return *x1 < *x2 && *y1 < *y2;
+}
+
 void batching_shutdown()
 {
 	for ( auto buffer_iter = Batching_buffers.begin(); buffer_iter != Batching_buffers.end(); ++buffer_iter ) {
@@ -1008,4 +1161,8 @@ void batching_shutdown()
 			batch_buffer->buffer_ptr = nullptr;
 		}
 	}
+
+	Batching_last_batch = nullptr;
+	Batching_primitive_lookup.clear();
+	Batching_primitives.clear();
 }
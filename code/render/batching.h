@@ -35,20 +35,18 @@ struct batch_info {
 	batch_info(): mat_type(FLAT_EMISSIVE), texture(-1), prim_type(PRIM_TYPE_TRIS), thruster(false) {}
 	batch_info(material_type mat, int tex, primitive_type prim, bool thrust): mat_type(mat), texture(tex), prim_type(prim), thruster(thrust) {}
 
-	bool operator < (const batch_info& batch) const {
-		if ( mat_type != batch.mat_type ) {
-			return mat_type < batch.mat_type;
-		}
-
-		if ( texture != batch.texture ) {
-			return texture < batch.texture;
-		}
-
-		if ( prim_type != batch.prim_type ) {
-			return prim_type < batch.prim_type;
-		}
+	bool operator == (const batch_info& batch) const {
+		return mat_type == batch.mat_type && texture == batch.texture && prim_type == batch.prim_type && thruster == batch.thruster;
+	}
+};
 
-		return thruster != batch.thruster;
+struct batch_info_hash {
+	size_t operator()(const batch_info& info) const {
+		// the texture is what usually differs, the other values only use a few bits
+		size_t hash = static_cast<size_t>(static_cast<uint>(info.texture));
+		hash = hash * 31 + static_cast<size_t>(info.mat_type);
+		hash = hash * 31 + static_cast<size_t>(info.prim_type);
+		return hash * 2 + (info.thruster ? 1 : 0);
 	}
 };
 
@@ -85,6 +83,7 @@ public:
 	size_t load_buffer(batch_vertex* buffer, size_t n_verts);
 
 	size_t num_verts() { return Vertices.size();  }
+	const SCP_vector<batch_vertex> &get_vertices() { return Vertices; }
 
 	void clear();
 };
@@ -101,9 +100,15 @@ struct primitive_batch_buffer {
 	vertex_layout layout;
 	int buffer_num;
 
+	// the buffer the vertices of this frame were loaded into, either buffer_num or the immediate buffer
+	int render_buffer_num;
+
 	void* buffer_ptr;
 	size_t buffer_size;
 
+	// the size of buffer_num, it only grows so uploading the vertices doesn't allocate a new buffer every frame
+	size_t gpu_buffer_size;
+
 	size_t desired_buffer_size;
 
 	primitive_type prim_type;
@@ -127,4 +132,14 @@ void batching_add_tri(int texture, vertex *verts);
 
 void batching_render_all(bool render_distortions = false);
 
+/**
+ * @brief Finds the part of the screen the queued distortions are drawn to
+ *
+ * The rectangle is in screen coordinates and includes the neighborhood the distortions sample the scene from, it is
+ * the whole screen if a distortion reaches behind the eye.
+ *
+ * @return @c false if no distortion is queued, the rectangle isn't set then
+ */
+bool batching_get_distortion_bounds(int *x1, int *y1, int *x2, int *y2);
+
 void batching_shutdown();
\ No newline at end of file
@@ -971,6 +971,66 @@ const char *ade_get_type_string(lua_State *L, int argnum)
 	return Lua_type_names[type];
 }
 
+// only the address is used, as the key of the handle cache in the registry
+static char Object_handle_cache_key;
+
+/**
+ * Pushes the handle of an object, reusing the userdata of the last time it was pushed if Lua still has it
+ *
+ * The handle of an object never changes, so the hooks called for the same objects over and over don't have to create
+ * new userdata every time. The cache holds the handles by signature with weak values, so the handles which the scripts
+ * don't use any more are still collected.
+ */
+static int ade_set_object_handle(lua_State *L, const ade_obj<object_h> &type, object *objp)
+{
+	lua_pushlightuserdata(L, &Object_handle_cache_key);
+	lua_rawget(L, LUA_REGISTRYINDEX);
+
+	if (!lua_istable(L, -1)) {
+		lua_pop(L, 1);
+
+		lua_newtable(L);
+		lua_newtable(L);
+		lua_pushstring(L, "__mode");
+		lua_pushstring(L, "v");
+		lua_rawset(L, -3);
+		lua_setmetatable(L, -2);
+
+		lua_pushlightuserdata(L, &Object_handle_cache_key);
+		lua_pushvalue(L, -2);
+		lua_rawset(L, LUA_REGISTRYINDEX);
+	}
+
+	int cache_ldx = lua_gettop(L);
+
+	object_h handle(objp);
+
+	lua_rawgeti(L, cache_ldx, objp->signature);
+
+	if (lua_isuserdata(L, -1) && lua_getmetatable(L, -1)) {
+		luaL_getmetatable(L, getTableEntry(type.GetIdx()).Name);
+		bool same_type = lua_rawequal(L, -1, -2) != 0;
+		lua_pop(L, 2);
+
+		// a signature may be used again once they wrapped around
+		auto cached = static_cast<object_h*>(lua_touserdata(L, -1));
+		if (same_type && (cached->objp == handle.objp) && (cached->sig == handle.sig)) {
+			lua_remove(L, cache_ldx);
+			return 1;
+		}
+	}
+
+	lua_pop(L, 1);
+
+	int ret = ade_set_args(L, "o", type.Set(handle));
+
+	lua_pushvalue(L, -1);
+	lua_rawseti(L, cache_ldx, objp->signature);
+	lua_remove(L, cache_ldx);
+
+	return ret;
+}
+
 int ade_set_object_with_breed(lua_State *L, int obj_idx)
 {
 	using namespace scripting::api;
@@ -983,19 +1043,19 @@ int ade_set_object_with_breed(lua_State *L, int obj_idx)
 	switch(objp->type)
 	{
 		case OBJ_SHIP:
-			return ade_set_args(L, "o", l_Ship.Set(object_h(objp)));
+			return ade_set_object_handle(L, l_Ship, objp);
 		case OBJ_ASTEROID:
-			return ade_set_args(L, "o", l_Asteroid.Set(object_h(objp)));
+			return ade_set_object_handle(L, l_Asteroid, objp);
 		case OBJ_DEBRIS:
-			return ade_set_args(L, "o", l_Debris.Set(object_h(objp)));
+			return ade_set_object_handle(L, l_Debris, objp);
 		case OBJ_WAYPOINT:
-			return ade_set_args(L, "o", l_Waypoint.Set(object_h(objp)));
+			return ade_set_object_handle(L, l_Waypoint, objp);
 		case OBJ_WEAPON:
-			return ade_set_args(L, "o", l_Weapon.Set(object_h(objp)));
+			return ade_set_object_handle(L, l_Weapon, objp);
 		case OBJ_BEAM:
-			return ade_set_args(L, "o", l_Beam.Set(object_h(objp)));
+			return ade_set_object_handle(L, l_Beam, objp);
 		default:
-			return ade_set_args(L, "o", l_Object.Set(object_h(objp)));
+			return ade_set_object_handle(L, l_Object, objp);
 	}
 }
 
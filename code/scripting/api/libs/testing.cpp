@@ -67,6 +67,7 @@ ADE_FUNC(createParticle, l_Testing, "vector Position, vector Velocity, number Li
 	pi.attached_objnum = -1;
 	pi.attached_sig = -1;
 	pi.reverse = 0;
+	pi.priority = particle::PARTICLE_PRIORITY_NORMAL;
 
 	// Need to consume tracer_length parameter but it isn't used anymore
 	float temp;
@@ -113,9 +114,9 @@ ADE_FUNC(createParticle, l_Testing, "vector Position, vector Velocity, number Li
 		pi.attached_sig = objh->objp->signature;
 	}
 
-	particle::WeakParticlePtr p = particle::create(&pi);
+	particle::ParticleHandle p = particle::create(&pi);
 
-	if (!p.expired())
+	if (p.isValid())
 		return ade_set_args(L, "o", l_Particle.Set(new particle_h(p)));
 	else
 		return ADE_RETURN_NIL;
@@ -338,6 +338,59 @@ ADE_FUNC(getOffset, l_CockpitDisplay, NULL, "Gets the offset of this cockpit dis
 	return ade_set_args(L, "ii", cd->offset[0], cd->offset[1]);
 }
 
+ADE_VIRTVAR(RefreshRate, l_CockpitDisplay, "number", "The number of times per second this display is updated, 0 to update it every frame", "number", "The refresh rate or -1 on error")
+{
+	cockpit_display_h *cdh = NULL;
+	int rate = 0;
+
+	if (!ade_get_args(L, "o|i", l_CockpitDisplay.GetPtr(&cdh), &rate))
+		return ade_set_error(L, "i", -1);
+
+	if (!cdh->isValid())
+		return ade_set_error(L, "i", -1);
+
+	cockpit_display *cd = cdh->Get();
+
+	if (cd == NULL)
+		return ade_set_error(L, "i", -1);
+
+	if (ADE_SETTING_VAR && rate >= 0)
+	{
+		cd->refresh_interval = (rate > 0) ? MAX(1000 / rate, 1) : 0;
+		cd->next_refresh = timestamp(0);
+	}
+
+	return ade_set_args(L, "i", (cd->refresh_interval > 0) ? 1000 / cd->refresh_interval : 0);
+}
+
+ADE_FUNC(needsUpdate, l_CockpitDisplay, NULL, "Checks if this display is due for an update at its refresh rate. A script which draws on the display can skip drawing while this is false since the texture keeps what was drawn last. Displays with HUD gauges on them are already updated by the HUD.", "boolean", "true if the display should be drawn now, false otherwise")
+{
+	cockpit_display_h *cdh = NULL;
+
+	if (!ade_get_args(L, "o", l_CockpitDisplay.GetPtr(&cdh)))
+		return ADE_RETURN_FALSE;
+
+	if (!cdh->isValid())
+		return ADE_RETURN_FALSE;
+
+	return ade_set_args(L, "b", ship_cockpit_display_needs_update(cdh->GetId()));
+}
+
+ADE_FUNC(invalidate, l_CockpitDisplay, NULL, "Makes this display draw its content again at its next update even if it looks unchanged", "boolean", "true if successfull, false otherwise")
+{
+	cockpit_display_h *cdh = NULL;
+
+	if (!ade_get_args(L, "o", l_CockpitDisplay.GetPtr(&cdh)))
+		return ADE_RETURN_FALSE;
+
+	if (!cdh->isValid())
+		return ADE_RETURN_FALSE;
+
+	ship_invalidate_cockpit_display(cdh->GetId());
+
+	return ADE_RETURN_TRUE;
+}
+
 ADE_FUNC(isValid, l_CockpitDisplay, NULL, "Detects whether this handle is valid or not", "boolean", "true if valid, false otherwise")
 {
 	cockpit_display_h *cdh = NULL;
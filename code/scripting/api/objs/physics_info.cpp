@@ -2,6 +2,8 @@
 #include "physics_info.h"
 #include "vecmath.h"
 
+#include "object/objectdock.h"
+
 namespace scripting {
 namespace api {
 
@@ -141,6 +143,7 @@ ADE_VIRTVAR(Mass, l_Physics, "number", "Object mass", "number", "Object mass, or
 
 	if(ADE_SETTING_VAR) {
 		pih->pi->mass = f;
+		dock_invalidate_docked_mass();
 	}
 
 	return ade_set_args(L, "f", pih->pi->mass);
@@ -45,7 +45,7 @@ ADE_INDEXER(l_WeaponBankType, "number Index", "Array of weapon banks", "weaponba
 
 			if(ADE_SETTING_VAR && newbank && newbank->IsValid()) {
 				sb->sw->primary_bank_weapons[idx] = newbank->sw->primary_bank_weapons[idx];
-				sb->sw->next_primary_fire_stamp[idx] = timestamp(0);
+				sb->sw->next_primary_fire_stamp[idx] = timestamp_us(0);
 				sb->sw->primary_bank_ammo[idx] = newbank->sw->primary_bank_ammo[idx];
 				sb->sw->primary_bank_start_ammo[idx] = newbank->sw->primary_bank_start_ammo[idx];
 				sb->sw->primary_bank_capacity[idx] = newbank->sw->primary_bank_capacity[idx];
@@ -60,7 +60,7 @@ ADE_INDEXER(l_WeaponBankType, "number Index", "Array of weapon banks", "weaponba
 
 			if(ADE_SETTING_VAR && newbank && newbank->IsValid()) {
 				sb->sw->primary_bank_weapons[idx] = newbank->sw->primary_bank_weapons[idx];
-				sb->sw->next_primary_fire_stamp[idx] = timestamp(0);
+				sb->sw->next_primary_fire_stamp[idx] = timestamp_us(0);
 				sb->sw->primary_bank_ammo[idx] = newbank->sw->primary_bank_ammo[idx];
 				sb->sw->primary_bank_start_ammo[idx] = newbank->sw->primary_bank_start_ammo[idx];
 				sb->sw->primary_bank_capacity[idx] = newbank->sw->primary_bank_capacity[idx];
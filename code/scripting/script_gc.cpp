@@ -0,0 +1,219 @@
+#include "scripting/script_gc.h"
+
+#include "debugconsole/console.h"
+#include "gamesequence/gamesequence.h"
+#include "io/timer.h"
+#include "scripting/lua/LuaHeaders.h"
+#include "tracing/tracing.h"
+
+namespace {
+
+struct gc_values {
+	int steps = 0;
+	int cycles = 0;
+	int forced_cycles = 0;
+	std::uint64_t ns = 0;
+	std::uint64_t max_frame_ns = 0;
+};
+
+lua_State* Gc_state = nullptr;
+
+// true while the collector runs on its own, until the first frame or while a mission is loaded
+bool Gc_automatic = true;
+bool Gc_loading = false;
+
+// how long the collector may run at the end of a frame, in a mission and outside of one
+float Gc_budget_ms = 1.0f;
+float Gc_idle_budget_ms = 4.0f;
+
+// the memory which was in use after the last full cycle. once the scripts allocated this much again on top of it
+// the collector has fallen behind and the cycle is finished regardless of the budget
+std::int64_t Gc_live_bytes = 0;
+const std::int64_t GC_MIN_GROWTH = 1024 * 1024;
+
+// the values of the current second and of the last one
+gc_values Gc_window;
+gc_values Gc_last_window;
+std::uint64_t Gc_window_start = 0;
+int Gc_window_frames = 0;
+int Gc_last_window_frames = 0;
+
+tracing::Category Gc_step_category("Lua GC step ms", false);
+tracing::Category Gc_cycles_category("Lua GC cycles", false);
+
+const std::uint64_t GC_WINDOW_NS = 1000000000;
+
+std::int64_t lua_memory_bytes(lua_State* L)
+{
+	return static_cast<std::int64_t>(lua_gc(L, LUA_GCCOUNT, 0)) * 1024 + lua_gc(L, LUA_GCCOUNTB, 0);
+}
+
+void reset_values()
+{
+	Gc_window = gc_values();
+	Gc_last_window = gc_values();
+	Gc_window_start = 0;
+	Gc_window_frames = 0;
+	Gc_last_window_frames = 0;
+}
+
+void print_values()
+{
+	if (Gc_state != nullptr) {
+		dc_printf("Lua memory: %.1f KB, %.1f KB after the last cycle\n",
+				  static_cast<double>(lua_memory_bytes(Gc_state)) / 1024.0, static_cast<double>(Gc_live_bytes) / 1024.0);
+	}
+
+	dc_printf("The collector runs %s\n", Gc_automatic ? "on its own" : "at the end of the frames");
+
+	if (Gc_last_window_frames > 0) {
+		auto frames = i2fl(Gc_last_window_frames);
+
+		dc_printf("Last second: %d frames, %.1f steps and %.3f ms per frame, longest frame %.3f ms\n",
+				  Gc_last_window_frames, i2fl(Gc_last_window.steps) / frames,
+				  static_cast<float>(Gc_last_window.ns) / frames / 1000000.0f,
+				  static_cast<float>(Gc_last_window.max_frame_ns) / 1000000.0f);
+		dc_printf("             %d cycles finished, %d of them over the budget\n", Gc_last_window.cycles,
+				  Gc_last_window.forced_cycles);
+	}
+}
+
+void finish_cycle()
+{
+	Gc_live_bytes = lua_memory_bytes(Gc_state);
+	++Gc_window.cycles;
+}
+
+}
+
+DCF(lua_gc, "Shows the statistics of the Lua garbage collector or changes its budget (print|budget|idle_budget|collect)")
+{
+	if (dc_optional_string_either("help", "--help")) {
+		dc_printf("Usage: lua_gc [print|budget <ms>|idle_budget <ms>|collect]\n");
+		dc_printf("\tprint        Shows the memory and how much the collector did over the last second (default)\n");
+		dc_printf("\tbudget       Sets how long the collector may run at the end of a frame in a mission\n");
+		dc_printf("\tidle_budget  Sets how long the collector may run at the end of a frame outside of a mission\n");
+		dc_printf("\tcollect      Does a full collection\n");
+		return;
+	}
+
+	if (dc_optional_string("budget")) {
+		dc_stuff_float(&Gc_budget_ms);
+		Gc_budget_ms = MAX(Gc_budget_ms, 0.0f);
+	} else if (dc_optional_string("idle_budget")) {
+		dc_stuff_float(&Gc_idle_budget_ms);
+		Gc_idle_budget_ms = MAX(Gc_idle_budget_ms, 0.0f);
+	} else if (dc_optional_string("collect")) {
+		if (Gc_state != nullptr) {
+			lua_gc(Gc_state, LUA_GCCOLLECT, 0);
+			finish_cycle();
+		}
+	} else {
+		print_values();
+	}
+
+	dc_printf("The budget is %.3f ms in a mission and %.3f ms outside of one\n", Gc_budget_ms, Gc_idle_budget_ms);
+}
+
+namespace scripting {
+namespace gc {
+
+void set_state(lua_State* L)
+{
+	Gc_state = L;
+	Gc_automatic = true;
+	Gc_live_bytes = 0;
+
+	reset_values();
+}
+
+void frame_step()
+{
+	if (Gc_state == nullptr) {
+		return;
+	}
+
+	auto now = timer_get_nanoseconds();
+
+	if (Gc_window_start == 0) {
+		Gc_window_start = now;
+	} else if (now - Gc_window_start >= GC_WINDOW_NS) {
+		Gc_last_window = Gc_window;
+		Gc_last_window_frames = Gc_window_frames;
+		Gc_window = gc_values();
+		Gc_window_frames = 0;
+		Gc_window_start = now;
+	}
+
+	++Gc_window_frames;
+
+	// game_busy() may flip frames while a mission is loaded
+	if (Gc_loading) {
+		return;
+	}
+
+	if (Gc_automatic) {
+		lua_gc(Gc_state, LUA_GCSTOP, 0);
+		Gc_automatic = false;
+		Gc_live_bytes = lua_memory_bytes(Gc_state);
+	}
+
+	TRACE_SCOPE(tracing::LuaGarbageCollection);
+
+	auto budget_ms = (gameseq_get_state() == GS_STATE_GAME_PLAY) ? Gc_budget_ms : Gc_idle_budget_ms;
+	auto budget_ns = static_cast<std::uint64_t>(budget_ms * 1000000.0f);
+
+	bool forced = lua_memory_bytes(Gc_state) > Gc_live_bytes * 2 + GC_MIN_GROWTH;
+
+	std::uint64_t elapsed = 0;
+	do {
+		++Gc_window.steps;
+
+		// the smallest step, which is what the collector does on its own when the scripts allocated a bit
+		if (lua_gc(Gc_state, LUA_GCSTEP, 0)) {
+			finish_cycle();
+			if (forced) {
+				++Gc_window.forced_cycles;
+			}
+			break;
+		}
+
+		elapsed = timer_get_nanoseconds() - now;
+	} while (forced || elapsed < budget_ns);
+
+	// a step sets up the next automatic one
+	lua_gc(Gc_state, LUA_GCSTOP, 0);
+
+	elapsed = timer_get_nanoseconds() - now;
+
+	Gc_window.ns += elapsed;
+	Gc_window.max_frame_ns = MAX(Gc_window.max_frame_ns, elapsed);
+
+	tracing::counter::value(Gc_step_category, static_cast<float>(elapsed) / 1000000.0f);
+	tracing::counter::value(Gc_cycles_category, i2fl(Gc_window.cycles));
+}
+
+void begin_loading()
+{
+	Gc_loading = true;
+
+	if (Gc_state != nullptr && !Gc_automatic) {
+		lua_gc(Gc_state, LUA_GCRESTART, 0);
+		Gc_automatic = true;
+	}
+}
+
+void end_loading()
+{
+	Gc_loading = false;
+
+	if (Gc_state != nullptr) {
+		TRACE_SCOPE(tracing::LuaGarbageCollection);
+
+		lua_gc(Gc_state, LUA_GCCOLLECT, 0);
+		finish_cycle();
+	}
+}
+
+}
+}
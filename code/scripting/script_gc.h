@@ -0,0 +1,52 @@
+#ifndef _SCRIPT_GC_H
+#define _SCRIPT_GC_H
+#pragma once
+
+#include "globalincs/pstypes.h"
+
+struct lua_State;
+
+/** @file
+ *  Scheduling of the Lua garbage collector.
+ *
+ *  Left alone, the collector does its work in steps whenever the scripts allocated enough memory, so a hook which
+ *  allocates a lot in a busy frame pays for the garbage of all the hooks before it. Once the game runs frames the
+ *  automatic steps are turned off and the engine does the work at the end of every frame instead, for as long as the
+ *  budget of the frame allows. Outside of a mission, for example on the pause screen or in the menus, the budget is
+ *  larger. While a mission is loaded the collector runs on its own again and a full collection follows the load.
+ *
+ *  If the frames can't keep up with the garbage the scripts create, a collection cycle is finished in one frame no
+ *  matter the budget before the Lua memory grows too far.
+ *
+ *  The lua_gc debug command prints the statistics of the collector and changes the budgets.
+ */
+
+namespace scripting {
+namespace gc {
+
+/**
+ * @brief Sets the Lua state the collector is scheduled for
+ *
+ * @param L The state, @c nullptr when it is closed
+ */
+void set_state(lua_State* L);
+
+/**
+ * @brief Does the collection work of a frame, called at the end of every frame
+ */
+void frame_step();
+
+/**
+ * @brief Lets the collector run on its own while a mission is loaded
+ */
+void begin_loading();
+
+/**
+ * @brief Does a full collection at the end of loading a mission
+ */
+void end_loading();
+
+}
+}
+
+#endif // _SCRIPT_GC_H
@@ -0,0 +1,304 @@
+#include "scripting/script_stats.h"
+
+#include "debugconsole/console.h"
+#include "io/timer.h"
+#include "scripting/lua/LuaHeaders.h"
+
+#include <algorithm>
+#include <memory>
+
+namespace {
+
+struct function_values {
+	// the values of the current frame
+	int frame_calls = 0;
+	std::uint64_t frame_ns = 0;
+	std::int64_t frame_bytes = 0;
+
+	// added up until the averages are computed again
+	std::uint64_t total_calls = 0;
+	std::uint64_t total_ns = 0;
+	std::int64_t total_bytes = 0;
+	std::uint64_t window_max_call_ns = 0;
+	std::uint64_t window_max_frame_ns = 0;
+	bool window_warned = false;
+
+	// the averages of the last second
+	float avg_calls = 0.0f;
+	float avg_ms = 0.0f;
+	float avg_kb = 0.0f;
+	float max_call_ms = 0.0f;
+	float max_frame_ms = 0.0f;
+};
+
+struct function_stats {
+	SCP_string name;
+	SCP_string file;
+
+	function_values values;
+
+	// the categories of the trace output keep a pointer to their name
+	SCP_string time_name;
+	std::unique_ptr<tracing::Category> call_category;
+	std::unique_ptr<tracing::Category> time_category;
+};
+
+SCP_vector<std::unique_ptr<function_stats>> Function_stats;
+
+bool Stats_enabled = false;
+
+// hooks which take longer than this in one frame are logged, 0 disables the warnings
+float Stats_budget_ms = 0.0f;
+
+std::uint64_t Stats_window_start = 0;
+int Stats_window_frames = 0;
+
+lua_State* Stats_state = nullptr;
+
+tracing::Category Lua_memory_category("Lua memory KB", false);
+
+// the averages are computed over this many nanoseconds
+const std::uint64_t STATS_WINDOW_NS = 1000000000;
+
+std::int64_t lua_memory_bytes(lua_State* L)
+{
+	return static_cast<std::int64_t>(lua_gc(L, LUA_GCCOUNT, 0)) * 1024 + lua_gc(L, LUA_GCCOUNTB, 0);
+}
+
+void reset_stats()
+{
+	for (auto& stats : Function_stats) {
+		stats->values = function_values();
+	}
+
+	Stats_window_start = 0;
+	Stats_window_frames = 0;
+}
+
+void print_stats()
+{
+	SCP_vector<function_stats*> sorted;
+
+	for (auto& stats : Function_stats) {
+		if (stats->values.avg_calls > 0.0f) {
+			sorted.push_back(stats.get());
+		}
+	}
+
+	// the most expensive hooks first
+	std::sort(sorted.begin(), sorted.end(), [](const function_stats* a, const function_stats* b) {
+		return a->values.avg_ms > b->values.avg_ms;
+	});
+
+	dc_printf("%-40s %8s %9s %9s %9s %9s\n", "Hook", "Calls", "ms", "Max call", "Max frame", "Alloc KB");
+
+	for (auto stats : sorted) {
+		auto& values = stats->values;
+
+		dc_printf("%-40s %8.1f %9.3f %9.3f %9.3f %9.1f\n", stats->name.c_str(), values.avg_calls, values.avg_ms,
+				  values.max_call_ms, values.max_frame_ms, values.avg_kb);
+	}
+
+	// the same file may contain several hooks
+	SCP_vector<std::pair<SCP_string, function_values>> files;
+
+	for (auto stats : sorted) {
+		auto it = std::find_if(files.begin(), files.end(), [stats](const std::pair<SCP_string, function_values>& entry) {
+			return entry.first == stats->file;
+		});
+
+		if (it == files.end()) {
+			files.emplace_back(stats->file, function_values());
+			it = files.end() - 1;
+		}
+
+		it->second.avg_calls += stats->values.avg_calls;
+		it->second.avg_ms += stats->values.avg_ms;
+		it->second.avg_kb += stats->values.avg_kb;
+	}
+
+	std::sort(files.begin(), files.end(), [](const std::pair<SCP_string, function_values>& a,
+											 const std::pair<SCP_string, function_values>& b) {
+		return a.second.avg_ms > b.second.avg_ms;
+	});
+
+	dc_printf("\n%-40s %8s %9s %9s\n", "File", "Calls", "ms", "Alloc KB");
+
+	for (auto& entry : files) {
+		dc_printf("%-40s %8.1f %9.3f %9.1f\n", entry.first.c_str(), entry.second.avg_calls, entry.second.avg_ms,
+				  entry.second.avg_kb);
+	}
+
+	if (Stats_state != nullptr) {
+		dc_printf("\nLua memory: %.1f KB\n", static_cast<double>(lua_memory_bytes(Stats_state)) / 1024.0);
+	}
+}
+
+}
+
+DCF(script_stats, "Records the cost of every scripting hook (on|off|reset|print|budget)")
+{
+	if (dc_optional_string_either("help", "--help")) {
+		dc_printf("Usage: script_stats [on|off|reset|print|budget <ms>]\n");
+		dc_printf("\ton      Starts recording the cost of the hooks\n");
+		dc_printf("\toff     Stops recording\n");
+		dc_printf("\treset   Forgets all recorded values\n");
+		dc_printf("\tprint   Lists the hooks with their calls, time and the memory they allocated per frame and the\n");
+		dc_printf("\t        longest call and frame, each over the last second, followed by the totals per file\n");
+		dc_printf("\t        (default)\n");
+		dc_printf("\tbudget  Logs a hook when it takes longer than this many milliseconds in a frame, 0 disables\n");
+		dc_printf("\t        the warnings\n");
+		return;
+	}
+
+	if (dc_optional_string("on")) {
+		Stats_enabled = true;
+	} else if (dc_optional_string("off")) {
+		Stats_enabled = false;
+	} else if (dc_optional_string("reset")) {
+		reset_stats();
+	} else if (dc_optional_string("budget")) {
+		dc_stuff_float(&Stats_budget_ms);
+		Stats_budget_ms = MAX(Stats_budget_ms, 0.0f);
+	} else {
+		print_stats();
+	}
+
+	dc_printf("Script stats are %s, the budget is %.3f ms\n", Stats_enabled ? "on" : "off", Stats_budget_ms);
+}
+
+namespace scripting {
+namespace stats {
+
+int register_function(const SCP_string& name, const SCP_string& file)
+{
+	std::unique_ptr<function_stats> stats(new function_stats());
+
+	stats->name = name;
+	stats->file = file;
+	stats->time_name = name + " ms";
+	stats->call_category.reset(new tracing::Category(stats->name.c_str(), false));
+	stats->time_category.reset(new tracing::Category(stats->time_name.c_str(), false));
+
+	Function_stats.push_back(std::move(stats));
+
+	return static_cast<int>(Function_stats.size()) - 1;
+}
+
+void clear_functions()
+{
+	Function_stats.clear();
+	Stats_state = nullptr;
+	Stats_window_start = 0;
+	Stats_window_frames = 0;
+}
+
+bool enabled()
+{
+	return Stats_enabled;
+}
+
+call_scope::call_scope(int index, lua_State* state) : _index(-1), _state(state)
+{
+	if (!Stats_enabled || index < 0 || index >= static_cast<int>(Function_stats.size())) {
+		return;
+	}
+
+	_index = index;
+	Stats_state = state;
+
+	tracing::complete::start(*Function_stats[_index]->call_category, &_event);
+
+	_start_bytes = lua_memory_bytes(_state);
+	_start_ns = timer_get_nanoseconds();
+}
+
+call_scope::~call_scope()
+{
+	// the functions may have been cleared by the hook
+	if (_index < 0 || _index >= static_cast<int>(Function_stats.size())) {
+		return;
+	}
+
+	auto time = timer_get_nanoseconds() - _start_ns;
+	auto& values = Function_stats[_index]->values;
+
+	tracing::complete::end(&_event);
+
+	++values.frame_calls;
+	values.frame_ns += time;
+	// a collection step during the call may have freed more than the call allocated
+	values.frame_bytes += MAX(lua_memory_bytes(_state) - _start_bytes, (std::int64_t)0);
+	values.window_max_call_ns = MAX(values.window_max_call_ns, time);
+}
+
+void frame_done()
+{
+	if (!Stats_enabled) {
+		return;
+	}
+
+	auto now = timer_get_nanoseconds();
+
+	if (Stats_window_start == 0) {
+		Stats_window_start = now;
+	}
+
+	for (auto& stats : Function_stats) {
+		auto& values = stats->values;
+
+		tracing::counter::value(*stats->time_category, static_cast<float>(values.frame_ns) / 1000000.0f);
+
+		if (Stats_budget_ms > 0.0f && !values.window_warned &&
+			static_cast<float>(values.frame_ns) / 1000000.0f > Stats_budget_ms) {
+			mprintf(("Scripting: Hook '%s' from '%s' took %.3f ms in %d calls this frame, the budget is %.3f ms\n",
+					 stats->name.c_str(), stats->file.c_str(), static_cast<float>(values.frame_ns) / 1000000.0f,
+					 values.frame_calls, Stats_budget_ms));
+			values.window_warned = true;
+		}
+
+		values.total_calls += values.frame_calls;
+		values.total_ns += values.frame_ns;
+		values.total_bytes += values.frame_bytes;
+		values.window_max_frame_ns = MAX(values.window_max_frame_ns, values.frame_ns);
+
+		values.frame_calls = 0;
+		values.frame_ns = 0;
+		values.frame_bytes = 0;
+	}
+
+	if (Stats_state != nullptr) {
+		tracing::counter::value(Lua_memory_category, static_cast<float>(lua_memory_bytes(Stats_state)) / 1024.0f);
+	}
+
+	++Stats_window_frames;
+
+	if (now - Stats_window_start < STATS_WINDOW_NS) {
+		return;
+	}
+
+	auto frames = i2fl(Stats_window_frames);
+
+	for (auto& stats : Function_stats) {
+		auto& values = stats->values;
+
+		values.avg_calls = static_cast<float>(values.total_calls) / frames;
+		values.avg_ms = static_cast<float>(values.total_ns) / frames / 1000000.0f;
+		values.avg_kb = static_cast<float>(values.total_bytes) / frames / 1024.0f;
+		values.max_call_ms = static_cast<float>(values.window_max_call_ns) / 1000000.0f;
+		values.max_frame_ms = static_cast<float>(values.window_max_frame_ns) / 1000000.0f;
+
+		values.total_calls = 0;
+		values.total_ns = 0;
+		values.total_bytes = 0;
+		values.window_max_call_ns = 0;
+		values.window_max_frame_ns = 0;
+		values.window_warned = false;
+	}
+
+	Stats_window_start = now;
+	Stats_window_frames = 0;
+}
+
+}
+}
@@ -0,0 +1,81 @@
+#ifndef _SCRIPT_STATS_H
+#define _SCRIPT_STATS_H
+#pragma once
+
+#include "globalincs/pstypes.h"
+#include "tracing/tracing.h"
+
+struct lua_State;
+
+/** @file
+ *  Cost accounting for the scripting hooks.
+ *
+ *  Every script function which is loaded from a table registers itself here with the name of its hook and the file it
+ *  came from. While the accounting is enabled with the script_stats debug command every call of a registered function
+ *  is timed and the memory the Lua state grew by during the call is added up. The hooks show up on the trace timeline
+ *  under their own names and the time they took every frame is written to the trace output as a counter. Averages over
+ *  the last second can be printed per hook or per file on the debug console.
+ *
+ *  A budget in milliseconds can be set as well. Hooks which take longer than that in a single frame are reported in
+ *  the log, at most once a second each.
+ *
+ *  @note Lua doesn't report how long its collector runs. The collector does its work in small steps while the scripts
+ *  allocate memory, so most of its time is part of the time of the hooks and the allocated memory shows which hooks
+ *  cause it. The work the engine schedules at the end of the frame is traced on its own, see script_gc.h.
+ */
+
+namespace scripting {
+namespace stats {
+
+/**
+ * @brief Registers a script function for the accounting
+ *
+ * @param name The name of the hook the function belongs to
+ * @param file The table or script file the function was loaded from
+ * @return The index to pass to call_scope
+ */
+int register_function(const SCP_string& name, const SCP_string& file);
+
+/**
+ * @brief Forgets all registered functions, for when the scripts are unloaded
+ */
+void clear_functions();
+
+/**
+ * @brief Checks if the accounting is enabled
+ * @return @c true if the costs of the hooks are recorded
+ */
+bool enabled();
+
+/**
+ * @brief Records the cost of a call of a script function for as long as it is alive
+ */
+class call_scope {
+	int _index;
+	lua_State* _state;
+	std::uint64_t _start_ns = 0;
+	std::int64_t _start_bytes = 0;
+	tracing::trace_event _event;
+
+ public:
+	/**
+	 * @param index The index returned by register_function(), calls of functions with a negative index are not
+	 * recorded
+	 * @param state The Lua state the function is executed in
+	 */
+	call_scope(int index, lua_State* state);
+	~call_scope();
+
+	call_scope(const call_scope&) = delete;
+	call_scope& operator=(const call_scope&) = delete;
+};
+
+/**
+ * @brief Writes the values of the last frame to the trace output and starts a new frame
+ */
+void frame_done();
+
+}
+}
+
+#endif // _SCRIPT_STATS_H
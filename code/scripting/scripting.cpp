@@ -13,7 +13,10 @@
 #include "parse/parselo.h"
 #include "scripting/scripting.h"
 #include "scripting/ade_args.h"
+#include "scripting/script_gc.h"
+#include "scripting/script_stats.h"
 #include "ship/ship.h"
+#include "tracing/StartupProfiler.h"
 #include "weapon/beam.h"
 #include "weapon/weapon.h"
 #include "ade.h"
@@ -24,6 +27,9 @@ using namespace scripting;
 script_state Script_system("FS2_Open Scripting");
 bool Output_scripting_meta = false;
 
+// the table which is parsed right now, for the script stats
+static SCP_string Script_parse_file;
+
 flag_def_list Script_conditions[] = 
 {
 	{"State",		CHC_STATE,			0},
@@ -101,6 +107,8 @@ void script_parse_table(const char *filename)
 {
 	script_state *st = &Script_system;
 	
+	Script_parse_file = filename;
+
 	try
 	{
 		read_file_text(filename, CF_TYPE_TABLES);
@@ -175,6 +183,8 @@ void script_parse_table(const char *filename)
 //script_close is handled by destructors
 void script_init()
 {
+	TRACE_STARTUP_SCOPE(tracing::ScriptInit);
+
 	mprintf(("SCRIPTING: Beginning initialization sequence...\n"));
 
 	mprintf(("SCRIPTING: Beginning Lua initialization...\n"));
@@ -210,6 +220,60 @@ DCF(script, "Evaluates a line of scripting")
 
 //*************************CLASS: ConditionedScript*************************
 extern char Game_current_mission_filename[];
+
+// bumped whenever the mission or campaign changes, so the hooks check their static conditions again
+static int Script_static_generation = 0;
+
+static bool script_condition_state_is(script_condition *scp, int state)
+{
+	if (scp->resolved_index == SCRIPT_CONDITION_UNRESOLVED) {
+		scp->resolved_index = -1;
+		for (int i = 0; i < GS_NUM_STATES; i++) {
+			if (!stricmp(GS_state_text[i], scp->data.name)) {
+				scp->resolved_index = i;
+				break;
+			}
+		}
+	}
+
+	return state == scp->resolved_index;
+}
+
+static bool script_condition_ship_class_is(script_condition *scp, int ship_info_index)
+{
+	if (scp->resolved_index == SCRIPT_CONDITION_UNRESOLVED) {
+		scp->resolved_index = -1;
+		for (int i = 0; i < (int)Ship_info.size(); i++) {
+			if (!stricmp(Ship_info[i].name, scp->data.name)) {
+				scp->resolved_index = i;
+				break;
+			}
+		}
+	}
+
+	return (ship_info_index >= 0) && (ship_info_index == scp->resolved_index);
+}
+
+static bool script_condition_weapon_class_is(script_condition *scp, int weapon_info_index)
+{
+	if (scp->resolved_index == SCRIPT_CONDITION_UNRESOLVED) {
+		scp->resolved_index = -1;
+		for (int i = 0; i < Num_weapon_types; i++) {
+			if (!stricmp(Weapon_info[i].name, scp->data.name)) {
+				scp->resolved_index = i;
+				break;
+			}
+		}
+	}
+
+	return (weapon_info_index >= 0) && (weapon_info_index == scp->resolved_index);
+}
+
+ConditionedHook::ConditionedHook()
+	: StaticGeneration(-1), StaticValid(false)
+{
+}
+
 bool ConditionedHook::AddCondition(script_condition *sc)
 {
 	for(int i = 0; i < MAX_HOOK_CONDITIONS; i++)
@@ -234,10 +298,106 @@ bool ConditionedHook::AddAction(script_action *sa)
 	return true;
 }
 
+bool ConditionedHook::HasAction(int action)
+{
+	for (auto &sa : Actions)
+	{
+		if (sa.action_type == action)
+			return true;
+	}
+
+	return false;
+}
+
+bool ConditionedHook::StaticConditionsValid()
+{
+	if (StaticGeneration == Script_static_generation)
+		return StaticValid;
+
+	StaticGeneration = Script_static_generation;
+	StaticValid = false;
+
+	for (int i = 0; i < MAX_HOOK_CONDITIONS; i++)
+	{
+		script_condition *scp = &Conditions[i];
+		switch(scp->condition_type)
+		{
+			case CHC_MISSION:
+				{
+					//WMC - Get mission filename with Mission_filename
+					//I don't use Game_current_mission_filename, because
+					//Mission_filename is valid in both fs2_open and FRED
+					size_t len = strlen(Mission_filename);
+					if(!len)
+						return false;
+					if(len > 4 && !stricmp(&Mission_filename[len-4], ".fs2"))
+						len -= 4;
+					if(strnicmp(scp->data.name, Mission_filename, len))
+						return false;
+					break;
+				}
+			case CHC_CAMPAIGN:
+				{
+					size_t len = strlen(Campaign.filename);
+					if(!len)
+						return false;
+					if(len > 4 && !stricmp(&Mission_filename[len-4], ".fc2"))
+						len -= 4;
+					if(strnicmp(scp->data.name, Mission_filename, len))
+						return false;
+					break;
+				}
+			case CHC_VERSION:
+				{
+					// Goober5000: I'm going to assume scripting doesn't care about SVN revision
+					char buf[32];
+					sprintf(buf, "%i.%i.%i", FS_VERSION_MAJOR, FS_VERSION_MINOR, FS_VERSION_BUILD);
+					if(stricmp(buf, scp->data.name))
+					{
+						//In case some people are lazy and say "3.7" instead of "3.7.0" or something
+						if(FS_VERSION_BUILD == 0)
+						{
+							sprintf(buf, "%i.%i", FS_VERSION_MAJOR, FS_VERSION_MINOR);
+							if(stricmp(buf, scp->data.name))
+								return false;
+						}
+						else
+						{
+							return false;
+						}
+					}
+					break;
+				}
+			case CHC_APPLICATION:
+				{
+					if(Fred_running)
+					{
+						if(stricmp("FRED2_Open", scp->data.name) && stricmp("FRED2Open", scp->data.name) && stricmp("FRED 2", scp->data.name) && stricmp("FRED", scp->data.name))
+							return false;
+					}
+					else
+					{
+						if(stricmp("FS2_Open", scp->data.name) && stricmp("FS2Open", scp->data.name) && stricmp("Freespace 2", scp->data.name) && stricmp("Freespace", scp->data.name))
+							return false;
+					}
+					break;
+				}
+			default:
+				break;
+		}
+	}
+
+	StaticValid = true;
+	return true;
+}
+
 bool ConditionedHook::ConditionsValid(int action, object *objp, int more_data)
 {
 	uint i;
 
+	if (!StaticConditionsValid())
+		return false;
+
 	//Return false if any conditions are not met
 	script_condition *scp;
 	ship_info *sip;
@@ -249,7 +409,7 @@ bool ConditionedHook::ConditionsValid(int action, object *objp, int more_data)
 			case CHC_STATE:
 				if(gameseq_get_depth() < 0)
 					return false;
-				if(stricmp(GS_state_text[gameseq_get_state(0)], scp->data.name))
+				if(!script_condition_state_is(scp, gameseq_get_state(0)))
 					return false;
 				break;
 			case CHC_SHIPTYPE:
@@ -263,7 +423,7 @@ bool ConditionedHook::ConditionsValid(int action, object *objp, int more_data)
 			case CHC_SHIPCLASS:
 				if(objp == NULL || objp->type != OBJ_SHIP)
 					return false;
-				if(stricmp(Ship_info[Ships[objp->instance].ship_info_index].name, scp->data.name))
+				if(!script_condition_ship_class_is(scp, Ships[objp->instance].ship_info_index))
 					return false;
 				break;
 			case CHC_SHIP:
@@ -272,42 +432,17 @@ bool ConditionedHook::ConditionsValid(int action, object *objp, int more_data)
 				if(stricmp(Ships[objp->instance].ship_name, scp->data.name))
 					return false;
 				break;
-			case CHC_MISSION:
-				{
-					//WMC - Get mission filename with Mission_filename
-					//I don't use Game_current_mission_filename, because
-					//Mission_filename is valid in both fs2_open and FRED
-					size_t len = strlen(Mission_filename);
-					if(!len)
-						return false;
-					if(len > 4 && !stricmp(&Mission_filename[len-4], ".fs2"))
-						len -= 4;
-					if(strnicmp(scp->data.name, Mission_filename, len))
-						return false;
-					break;
-				}
-			case CHC_CAMPAIGN:
-				{
-					size_t len = strlen(Campaign.filename);
-					if(!len)
-						return false;
-					if(len > 4 && !stricmp(&Mission_filename[len-4], ".fc2"))
-						len -= 4;
-					if(strnicmp(scp->data.name, Mission_filename, len))
-						return false;
-					break;
-				}
 			case CHC_WEAPONCLASS:
 				{
 					if (action == CHA_COLLIDEWEAPON) {
-						if (stricmp(Weapon_info[more_data].name, scp->data.name) != 0)
+						if (!script_condition_weapon_class_is(scp, more_data))
 							return false;
 					} else if (!(action == CHA_ONWPSELECTED || action == CHA_ONWPDESELECTED || action == CHA_ONWPEQUIPPED || action == CHA_ONWPFIRED || action == CHA_ONTURRETFIRED )) {
 						if(objp == NULL || (objp->type != OBJ_WEAPON && objp->type != OBJ_BEAM))
 							return false;
-						else if (( objp->type == OBJ_WEAPON) && (stricmp(Weapon_info[Weapons[objp->instance].weapon_info_index].name, scp->data.name) != 0 ))
+						else if (( objp->type == OBJ_WEAPON) && (!script_condition_weapon_class_is(scp, Weapons[objp->instance].weapon_info_index) ))
 							return false;
-						else if (( objp->type == OBJ_BEAM) && (stricmp(Weapon_info[Beams[objp->instance].weapon_info_index].name, scp->data.name) != 0 ))
+						else if (( objp->type == OBJ_BEAM) && (!script_condition_weapon_class_is(scp, Beams[objp->instance].weapon_info_index) ))
 							return false;
 					} else if(objp == NULL || objp->type != OBJ_SHIP) {
 						return false;
@@ -318,8 +453,8 @@ bool ConditionedHook::ConditionsValid(int action, object *objp, int more_data)
 						bool primary = false, secondary = false, prev_primary = false, prev_secondary = false;
 						switch (action) {
 							case CHA_ONWPSELECTED:
-								primary = stricmp(Weapon_info[shipp->weapons.primary_bank_weapons[shipp->weapons.current_primary_bank]].name, scp->data.name) == 0;
-								secondary = stricmp(Weapon_info[shipp->weapons.secondary_bank_weapons[shipp->weapons.current_secondary_bank]].name, scp->data.name) == 0;
+								primary = script_condition_weapon_class_is(scp, shipp->weapons.primary_bank_weapons[shipp->weapons.current_primary_bank]);
+								secondary = script_condition_weapon_class_is(scp, shipp->weapons.secondary_bank_weapons[shipp->weapons.current_secondary_bank]);
 								
 								if (!(primary || secondary))
 									return false;
@@ -329,10 +464,10 @@ bool ConditionedHook::ConditionsValid(int action, object *objp, int more_data)
 								
 								break;
 							case CHA_ONWPDESELECTED:
-								primary = stricmp(Weapon_info[shipp->weapons.primary_bank_weapons[shipp->weapons.current_primary_bank]].name, scp->data.name) == 0;
-								prev_primary = stricmp(Weapon_info[shipp->weapons.primary_bank_weapons[shipp->weapons.previous_primary_bank]].name, scp->data.name) == 0;
-								secondary = stricmp(Weapon_info[shipp->weapons.secondary_bank_weapons[shipp->weapons.current_secondary_bank]].name, scp->data.name) == 0;
-								prev_secondary = stricmp(Weapon_info[shipp->weapons.secondary_bank_weapons[shipp->weapons.previous_secondary_bank]].name, scp->data.name) == 0;
+								primary = script_condition_weapon_class_is(scp, shipp->weapons.primary_bank_weapons[shipp->weapons.current_primary_bank]);
+								prev_primary = script_condition_weapon_class_is(scp, shipp->weapons.primary_bank_weapons[shipp->weapons.previous_primary_bank]);
+								secondary = script_condition_weapon_class_is(scp, shipp->weapons.secondary_bank_weapons[shipp->weapons.current_secondary_bank]);
+								prev_secondary = script_condition_weapon_class_is(scp, shipp->weapons.secondary_bank_weapons[shipp->weapons.previous_secondary_bank]);
 
 								if ((shipp->flags[Ship::Ship_Flags::Primary_linked]) && prev_primary && (Weapon_info[shipp->weapons.primary_bank_weapons[shipp->weapons.previous_primary_bank]].wi_flags[Weapon::Info_Flags::Nolink]))
 									return true;
@@ -357,7 +492,7 @@ bool ConditionedHook::ConditionsValid(int action, object *objp, int more_data)
 								bool equipped = false;
 								for(int j = 0; j < MAX_SHIP_PRIMARY_BANKS; j++) {
 									if (!equipped && (shipp->weapons.primary_bank_weapons[j] >= 0) && (shipp->weapons.primary_bank_weapons[j] < MAX_WEAPON_TYPES) ) {
-										if ( !stricmp(Weapon_info[shipp->weapons.primary_bank_weapons[j]].name, scp->data.name) ) {
+										if ( script_condition_weapon_class_is(scp, shipp->weapons.primary_bank_weapons[j]) ) {
 											equipped = true;
 											break;
 										}
@@ -367,7 +502,7 @@ bool ConditionedHook::ConditionsValid(int action, object *objp, int more_data)
 								if (!equipped) {
 									for(int j = 0; j < MAX_SHIP_SECONDARY_BANKS; j++) {
 										if (!equipped && (shipp->weapons.secondary_bank_weapons[j] >= 0) && (shipp->weapons.secondary_bank_weapons[j] < MAX_WEAPON_TYPES) ) {
-											if ( !stricmp(Weapon_info[shipp->weapons.secondary_bank_weapons[j]].name, scp->data.name) ) {
+											if ( script_condition_weapon_class_is(scp, shipp->weapons.secondary_bank_weapons[j]) ) {
 												equipped = true;
 												break;
 											}
@@ -382,11 +517,11 @@ bool ConditionedHook::ConditionsValid(int action, object *objp, int more_data)
 							}
 							case CHA_ONWPFIRED: {
 								if (more_data == 1) {
-									primary = stricmp(Weapon_info[shipp->weapons.primary_bank_weapons[shipp->weapons.current_primary_bank]].name, scp->data.name) == 0;
+									primary = script_condition_weapon_class_is(scp, shipp->weapons.primary_bank_weapons[shipp->weapons.current_primary_bank]);
 									secondary = false;
 								} else {
 									primary = false;
-									secondary = stricmp(Weapon_info[shipp->weapons.secondary_bank_weapons[shipp->weapons.current_secondary_bank]].name, scp->data.name) == 0;
+									secondary = script_condition_weapon_class_is(scp, shipp->weapons.secondary_bank_weapons[shipp->weapons.current_secondary_bank]);
 								}
 
 								if ((shipp->flags[Ship::Ship_Flags::Primary_linked]) && primary && (Weapon_info[shipp->weapons.primary_bank_weapons[shipp->weapons.current_primary_bank]].wi_flags[Weapon::Info_Flags::Nolink]))
@@ -397,22 +532,22 @@ bool ConditionedHook::ConditionsValid(int action, object *objp, int more_data)
 								break;
 							}
 							case CHA_ONTURRETFIRED: {
-								if (! (stricmp(Weapon_info[shipp->last_fired_turret->last_fired_weapon_info_index].name, scp->data.name) == 0))
+								if (! (script_condition_weapon_class_is(scp, shipp->last_fired_turret->last_fired_weapon_info_index)))
 									return false;
 								break;
 							}
 							case CHA_PRIMARYFIRE: {
-								if (stricmp(Weapon_info[shipp->weapons.primary_bank_weapons[shipp->weapons.current_primary_bank]].name, scp->data.name))
+								if (!script_condition_weapon_class_is(scp, shipp->weapons.primary_bank_weapons[shipp->weapons.current_primary_bank]))
 									return false;
 								break;
 							}
 							case CHA_SECONDARYFIRE: {
-								if (stricmp(Weapon_info[shipp->weapons.secondary_bank_weapons[shipp->weapons.current_secondary_bank]].name, scp->data.name))
+								if (!script_condition_weapon_class_is(scp, shipp->weapons.secondary_bank_weapons[shipp->weapons.current_secondary_bank]))
 									return false;
 								break;
 							}
 							case CHA_BEAMFIRE: {
-								if (!(stricmp(Weapon_info[more_data].name, scp->data.name) == 0))
+								if (!(script_condition_weapon_class_is(scp, more_data)))
 									return false;
 								break;
 							}
@@ -450,40 +585,6 @@ bool ConditionedHook::ConditionsValid(int action, object *objp, int more_data)
 						return false;
 					break;
 				}
-			case CHC_VERSION:
-				{
-					// Goober5000: I'm going to assume scripting doesn't care about SVN revision
-					char buf[32];
-					sprintf(buf, "%i.%i.%i", FS_VERSION_MAJOR, FS_VERSION_MINOR, FS_VERSION_BUILD);
-					if(stricmp(buf, scp->data.name))
-					{
-						//In case some people are lazy and say "3.7" instead of "3.7.0" or something
-						if(FS_VERSION_BUILD == 0)
-						{
-							sprintf(buf, "%i.%i", FS_VERSION_MAJOR, FS_VERSION_MINOR);
-							if(stricmp(buf, scp->data.name))
-								return false;
-						}
-						else
-						{
-							return false;
-						}
-					}
-					break;
-				}
-			case CHC_APPLICATION:
-				{
-					if(Fred_running)
-					{
-						if(stricmp("FRED2_Open", scp->data.name) && stricmp("FRED2Open", scp->data.name) && stricmp("FRED 2", scp->data.name) && stricmp("FRED", scp->data.name))
-							return false;
-					}
-					else
-					{
-						if(stricmp("FS2_Open", scp->data.name) && stricmp("FS2Open", scp->data.name) && stricmp("Freespace 2", scp->data.name) && stricmp("Freespace", scp->data.name))
-							return false;
-					}
-				}
 			default:
 				break;
 		}
@@ -843,6 +944,8 @@ int script_state::RunBytecodeSub(script_function& func, char format, void *data)
 
 	GR_DEBUG_SCOPE("Lua code");
 
+	stats::call_scope stats_scope(func.stats_index, LuaState);
+
 	try {
 		auto ret = func.function.call();
 
@@ -873,11 +976,45 @@ int script_state::RunBytecode(script_hook &hd, char format, void *data)
 	return 1;
 }
 
+const SCP_vector<int> &script_state::GetActionHooks(int action)
+{
+	Assertion(action >= 0 && action < NUM_HOOK_ACTIONS, "Invalid hook action %d!", action);
+
+	if (ActionHooksDirty)
+	{
+		for (int i = 0; i < NUM_HOOK_ACTIONS; i++)
+		{
+			ActionHooks[i].clear();
+
+			for (int j = 0; j < (int)ConditionalHooks.size(); j++)
+			{
+				if (ConditionalHooks[j].HasAction(i))
+					ActionHooks[i].push_back(j);
+			}
+		}
+
+		ActionHooksDirty = false;
+	}
+
+	const SCP_vector<int> &hooks = ActionHooks[action];
+
+	// the static conditions of the hooks only have to be checked again when the mission or campaign changed
+	if (!hooks.empty() && (StaticMissionName != Mission_filename || StaticCampaignName != Campaign.filename))
+	{
+		StaticMissionName = Mission_filename;
+		StaticCampaignName = Campaign.filename;
+		Script_static_generation++;
+	}
+
+	return hooks;
+}
+
 int script_state::RunCondition(int action, char format, void *data, object *objp, int more_data)
 {
 	int num = 0;
-	for(SCP_vector<ConditionedHook>::iterator chp = ConditionalHooks.begin(); chp != ConditionalHooks.end(); ++chp) 
+	for (int hook : GetActionHooks(action))
 	{
+		ConditionedHook *chp = &ConditionalHooks[hook];
 		if(chp->ConditionsValid(action, objp, more_data))
 		{
 			chp->Run(this, action, format, data);
@@ -890,8 +1027,9 @@ int script_state::RunCondition(int action, char format, void *data, object *objp
 bool script_state::IsConditionOverride(int action, object *objp)
 {
 	//bool b = false;
-	for(SCP_vector<ConditionedHook>::iterator chp = ConditionalHooks.begin(); chp != ConditionalHooks.end(); ++chp)
+	for (int hook : GetActionHooks(action))
 	{
+		ConditionedHook *chp = &ConditionalHooks[hook];
 		if(chp->ConditionsValid(action, objp))
 		{
 			if(chp->IsOverride(this, action))
@@ -901,17 +1039,28 @@ bool script_state::IsConditionOverride(int action, object *objp)
 	return false;
 }
 
+bool script_state::HasHooks(int action)
+{
+	return !GetActionHooks(action).empty();
+}
+
 void script_state::EndFrame()
 {
 	EndLuaFrame();
+
+	gc::frame_step();
+	stats::frame_done();
 }
 
 void script_state::Clear()
 {
 	// Free all lua value references
 	ConditionalHooks.clear();
+	ActionHooksDirty = true;
+	stats::clear_functions();
 
 	if(LuaState != NULL) {
+		gc::set_state(nullptr);
 		lua_close(LuaState);
 	}
 
@@ -931,6 +1080,8 @@ script_state::script_state(const char *name)
 
 	LuaState = NULL;
 	LuaLibs = NULL;
+
+	ActionHooksDirty = true;
 }
 
 script_state::~script_state()
@@ -942,10 +1093,12 @@ void script_state::SetLuaSession(lua_State *L)
 {
 	if(LuaState != NULL)
 	{
+		gc::set_state(nullptr);
 		lua_close(LuaState);
 	}
 	LuaState = L;
 	if(LuaState != NULL) {
+		gc::set_state(LuaState);
 		Langs |= SC_LUA;
 	}
 	else if(Langs & SC_LUA) {
@@ -1096,6 +1249,7 @@ void script_state::ParseChunkSub(script_function& script_func, const char* debug
 
 	std::string source;
 	std::string function_name(debug_str);
+	SCP_string stats_file(Script_parse_file);
 
 	if(check_for_string("[["))
 	{
@@ -1108,6 +1262,7 @@ void script_state::ParseChunkSub(script_function& script_func, const char* debug
 
 		//WMC - use filename instead of debug_str so that the filename gets passed.
 		function_name = filename;
+		stats_file = filename;
 		vm_free(filename);
 
 		if(cfp == NULL)
@@ -1153,6 +1308,7 @@ void script_state::ParseChunkSub(script_function& script_func, const char* debug
 		function.setErrorFunction(LuaFunction::createFromCFunction(LuaState, ade_friendly_error));
 
 		script_func.function = function;
+		script_func.stats_index = stats::register_function(debug_str, stats_file);
 	} catch (const LuaException& e) {
 		LuaError(GetLuaSession(), "%s", e.what());
 	}
@@ -1221,6 +1377,7 @@ void script_state::ParseGlobalChunk(int hookType, const char* debug_str) {
 	hook.AddAction(&sat);
 
 	ConditionalHooks.push_back(hook);
+	ActionHooksDirty = true;
 }
 bool script_state::ParseCondition(const char *filename)
 {
@@ -1253,6 +1410,7 @@ bool script_state::ParseCondition(const char *filename)
 		{
 			ConditionalHooks.push_back(ConditionedHook());
 			chp = &ConditionalHooks[ConditionalHooks.size()-1];
+			ActionHooksDirty = true;
 		}
 
 		if(!chp->AddCondition(&sct))
@@ -22,6 +22,7 @@ struct image_desc
 struct script_function {
 	int language = 0;
 	luacpp::LuaFunction function;
+	int stats_index = -1;	// for scripting::stats
 };
 
 //-WMC
@@ -98,11 +99,15 @@ extern bool script_hook_valid(script_hook *hook);
 #define CHA_BEAMFIRE        38
 #define CHA_SIMULATION      39
 
+#define NUM_HOOK_ACTIONS	(CHA_SIMULATION + 1)
+
 // management stuff
 void scripting_state_init();
 void scripting_state_close();
 void scripting_state_do_frame(float frametime);
 
+#define SCRIPT_CONDITION_UNRESOLVED	-2
+
 class script_condition
 {
 public:
@@ -112,8 +117,12 @@ public:
 		char name[CONDITION_LENGTH];
 	} data;
 
+	// the index of the game state, ship class or weapon class named by the condition, looked up the first time it is
+	// needed; -1 if there is none by that name
+	int resolved_index;
+
 	script_condition()
-		: condition_type(CHC_NONE)
+		: condition_type(CHC_NONE), resolved_index(SCRIPT_CONDITION_UNRESOLVED)
 	{
 		memset(data.name, 0, sizeof(data.name));
 	}
@@ -136,10 +145,21 @@ class ConditionedHook
 private:
 	SCP_vector<script_action> Actions;
 	script_condition Conditions[MAX_HOOK_CONDITIONS];
+
+	// the conditions which don't change during a mission (mission, campaign, version and application) are only
+	// checked again when the mission changes
+	int StaticGeneration;
+	bool StaticValid;
+
+	bool StaticConditionsValid();
 public:
+	ConditionedHook();
+
 	bool AddCondition(script_condition *sc);
 	bool AddAction(script_action *sa);
 
+	bool HasAction(int action);
+
 	bool ConditionsValid(int action, class object *objp=NULL, int more_data = 0);
 	bool IsOverride(class script_state *sys, int action);
 	bool Run(class script_state *sys, int action, char format='\0', void *data=NULL);
@@ -159,8 +179,18 @@ private:
 	SCP_vector<image_desc> ScriptImages;
 	SCP_vector<ConditionedHook> ConditionalHooks;
 
+	// the indices of the hooks in ConditionalHooks which have an action of each type, rebuilt when ConditionalHooks changes
+	SCP_vector<int> ActionHooks[NUM_HOOK_ACTIONS];
+	bool ActionHooksDirty;
+
+	// the mission the static conditions of the hooks were checked for
+	SCP_string StaticMissionName;
+	SCP_string StaticCampaignName;
+
 private:
 
+	const SCP_vector<int> &GetActionHooks(int action);
+
 	void ParseChunkSub(script_function& out_func, const char* debug_str=NULL);
 	int RunBytecodeSub(script_function& func, char format='\0', void *data=NULL);
 
@@ -224,6 +254,8 @@ public:
 	bool IsOverride(script_hook &hd);
 	int RunCondition(int condition, char format='\0', void *data=NULL, class object *objp = NULL, int more_data = 0);
 	bool IsConditionOverride(int action, object *objp=NULL);
+	// true if any hook has an action of this type, whatever its conditions are
+	bool HasHooks(int action);
 
 	//*****Other functions
 	void EndFrame();
@@ -16,6 +16,7 @@
 #include "mission/missionparse.h"
 #include "nebula/neb.h"
 #include "network/multi.h"
+#include "object/objspatial.h"
 #include "ship/awacs.h"
 #include "ship/ship.h"
 #include "species_defs/species_defs.h"
@@ -39,10 +40,26 @@ typedef struct awacs_entry {
 	int team;
 	ship_subsys *subsys;
 	object *objp;
+	int signature;
+	vec3d pos;					// where the subsystem is this frame
+	bool pos_valid;
 } awacs_entry;
 awacs_entry Awacs[MAX_AWACS];
 int Awacs_count = 0;
 
+// the distances are measured with vm_vec_mag_quick(), which can come out a bit shorter than the real distance, so
+// the spatial queries look this much further
+#define AWACS_QUERY_SLACK			1.25f
+
+// the teams whose AWACS sources cover each ship this frame
+typedef struct awacs_coverage {
+	int signature;				// of the ship, other ships in the slot are not covered yet
+	int team_mask;
+} awacs_coverage;
+awacs_coverage Awacs_coverage[MAX_SHIPS];
+
+static SCP_vector<int> Awacs_candidates;
+
 // TEAM SHIP VISIBILITY
 // team-wide shared visibility info
 // at start of each frame (maybe timestamp), compute visibility 
@@ -55,6 +72,9 @@ ubyte Ship_visibility_by_team[MAX_IFFS][MAX_SHIPS];
 // update the total awacs levels
 void awacs_update_all_levels();
 
+// find the ships covered by the AWACS sources
+void awacs_update_coverage();
+
 // update team visibility info
 void team_visibility_update();
 
@@ -68,20 +88,34 @@ void awacs_level_init()
 {
 	// set the update timestamp to -1 
 	Awacs_stamp = -1;
+
+	Awacs_count = 0;
+	for (int idx = 0; idx < MAX_SHIPS; idx++) {
+		Awacs_coverage[idx].signature = -1;
+		Awacs_coverage[idx].team_mask = 0;
+	}
 }
 
 // call every frame to process AWACS details
 void awacs_process()
 {
 	// if we need to update total AWACS levels, do so now
-	if ((Awacs_stamp == -1) || timestamp_elapsed(Awacs_stamp))
+	bool update = (Awacs_stamp == -1) || timestamp_elapsed(Awacs_stamp);
+
+	if (update)
 	{
 		// reset the timestamp
 		Awacs_stamp = timestamp(AWACS_STAMP_TIME);
 
 		// recalculate everything
 		awacs_update_all_levels();
+	}
 
+	// the sources move with their ships, so what they cover is found every frame
+	awacs_update_coverage();
+
+	if (update)
+	{
 		// update team visibility
 		team_visibility_update();
 	}
@@ -126,7 +160,7 @@ void awacs_update_all_levels()
 			continue;
 
 		// traverse all subsystems
-		for (ship_system = GET_FIRST(&shipp->subsys_list); ship_system != END_OF_LIST(&shipp->subsys_list); ship_system = GET_NEXT(ship_system))
+		for ( ship_system = shipp->subsys_array; ship_system < shipp->subsys_array + shipp->num_subsys; ship_system++ )
 		{
 			// if this is an AWACS subsystem
 			if ((ship_system->system_info != NULL) && (ship_system->system_info->flags[Model::Subsystem_Flags::Awacs]))
@@ -139,7 +173,9 @@ void awacs_update_all_levels()
 				{
 					Awacs[Awacs_count].subsys = ship_system;
 					Awacs[Awacs_count].team = shipp->team;
-					Awacs[Awacs_count].objp = &Objects[moveup->objnum];				
+					Awacs[Awacs_count].objp = &Objects[moveup->objnum];
+					Awacs[Awacs_count].signature = Objects[moveup->objnum].signature;
+					Awacs[Awacs_count].pos_valid = false;
 					Awacs_count++;
 				}
 			}
@@ -161,6 +197,83 @@ void awacs_update_all_levels()
 #endif
 }
 
+// check if an AWACS source reaches the target, the position of the source has to be valid
+static bool awacs_covers(awacs_entry *awacs, object *target)
+{
+	// special case for HUGE_SHIPS
+	if ((target->type == OBJ_SHIP) && Ship_info[Ships[target->instance].ship_info_index].is_huge_ship())
+	{
+		// check if inside bbox expanded by awacs_radius
+		return check_world_pt_in_expanded_ship_bbox(&awacs->pos, target, awacs->subsys->awacs_radius) != 0;
+	}
+
+	// get distance from Subsys to target
+	vec3d dist_vec;
+	vm_vec_sub(&dist_vec, &awacs->pos, &target->pos);
+
+	return vm_vec_mag_quick(&dist_vec) <= awacs->subsys->awacs_radius;
+}
+
+// find the ships covered by the AWACS sources, called once per frame
+void awacs_update_coverage()
+{
+	int idx;
+
+	for (idx = 0; idx < MAX_SHIPS; idx++)
+	{
+		Awacs_coverage[idx].signature = -1;
+		Awacs_coverage[idx].team_mask = 0;
+	}
+
+	ship_obj *moveup;
+	for (moveup = GET_FIRST(&Ship_obj_list); moveup != END_OF_LIST(&Ship_obj_list); moveup = GET_NEXT(moveup))
+	{
+		object *objp = &Objects[moveup->objnum];
+
+		Awacs_coverage[objp->instance].signature = objp->signature;
+	}
+
+	for (idx = 0; idx < Awacs_count; idx++)
+	{
+		awacs_entry *awacs = &Awacs[idx];
+
+		// if this awacs source has somehow become invalid
+		awacs->pos_valid = (awacs->objp->type == OBJ_SHIP) && (awacs->objp->signature == awacs->signature)
+			&& get_subsystem_pos(&awacs->pos, awacs->objp, awacs->subsys);
+
+		if (!awacs->pos_valid)
+			continue;
+
+		// a huge ship may be covered even though its center is out of range, the query finds those as well
+		obj_spatial_find_ships(&awacs->pos, awacs->subsys->awacs_radius * AWACS_QUERY_SLACK, -1, Awacs_candidates);
+
+		for (auto objnum : Awacs_candidates)
+		{
+			object *target = &Objects[objnum];
+
+			if (awacs_covers(awacs, target))
+				Awacs_coverage[target->instance].team_mask |= iff_get_mask(awacs->team);
+		}
+	}
+}
+
+// check if an AWACS source of the team reaches the target
+static bool awacs_in_range(object *target, int team)
+{
+	// the ships are looked up
+	if ((target->type == OBJ_SHIP) && (target->instance >= 0) && (Awacs_coverage[target->instance].signature == target->signature))
+		return iff_matches_mask(team, Awacs_coverage[target->instance].team_mask) != 0;
+
+	// everything else is tested against the sources
+	for (int idx = 0; idx < Awacs_count; idx++)
+	{
+		if ((Awacs[idx].team == team) && Awacs[idx].pos_valid && awacs_covers(&Awacs[idx], target))
+			return true;
+	}
+
+	return false;
+}
+
 // get the total AWACS level for target to viewer
 // < 0.0f		: untargetable
 // 0.0 - 1.0f	: marginally targetable
@@ -170,11 +283,9 @@ float awacs_get_level(object *target, ship *viewer, int use_awacs)
 	Assert(target);	// Goober5000
 	Assert(viewer);	// Goober5000
 
-	vec3d dist_vec, subsys_pos;
-	float closest = 0.0f;
+	vec3d dist_vec;
 	float test;
-	int closest_index = -1;
-	int idx, stealth_ship = 0, check_huge_ship = 0, friendly_stealth_invisible = 0;
+	int stealth_ship = 0, check_huge_ship = 0, friendly_stealth_invisible = 0;
 	ship *shipp = NULL;
 	ship_info *sip = NULL;
 
@@ -232,59 +343,16 @@ float awacs_get_level(object *target, ship *viewer, int use_awacs)
 	}
 	
 	// only check for Awacs if stealth ship or Nebula mission
-	// determine the closest awacs on our team
+	// determine if an awacs on our team reaches the target
+	bool in_awacs_range = false;
 	if ((stealth_ship || nebula_enabled) && use_awacs)
-	{
-		for (idx=0; idx<Awacs_count; idx++)
-		{
-			// if not on the same team as the viewer
-			if (Awacs[idx].team != viewer->team)
-				continue;
-
-			// if this awacs source has somehow become invalid
-			if (Awacs[idx].objp->type != OBJ_SHIP)
-				continue;
-
-			// get the subsystem position
-			if (!get_subsystem_pos(&subsys_pos, Awacs[idx].objp, Awacs[idx].subsys))
-				continue;
-
-			// determine if its the closest
-			// special case for HUGE_SHIPS
-			if (check_huge_ship)
-			{
-				// check if inside bbox expanded by awacs_radius
-				if (check_world_pt_in_expanded_ship_bbox(&subsys_pos, target, Awacs[idx].subsys->awacs_radius))
-				{
-					closest_index = idx;
-					break;
-				}
-			}
-			// not a huge ship
-			else
-			{
-				// get distance from Subsys to target
-				vm_vec_sub(&dist_vec, &subsys_pos, &target->pos);
-				test = vm_vec_mag_quick(&dist_vec);
-
-				if (test > Awacs[idx].subsys->awacs_radius)
-					continue;
-
-				if ((closest_index == -1) || (test < closest))
-				{
-					closest = test;
-					closest_index = idx;
-					break;
-				}
-			}
-		}
-	}
+		in_awacs_range = awacs_in_range(target, viewer->team);
 
 	// if this is a stealth ship
 	if (stealth_ship)
 	{
 		// if the ship is within range of an awacs
-		if (closest_index >= 0)
+		if (in_awacs_range)
 		{
 			// if the nebula effect is active, stealth ships are only partially targetable
 			if (nebula_enabled)
@@ -307,7 +375,7 @@ float awacs_get_level(object *target, ship *viewer, int use_awacs)
 			return FULLY_TARGETABLE;
 
 		// if the ship is within range of an awacs, its fully targetable
-		if (closest_index >= 0)
+		if (in_awacs_range)
 			return FULLY_TARGETABLE;
 
 
@@ -345,19 +413,60 @@ float awacs_get_level(object *target, ship *viewer, int use_awacs)
 }
 
 
+// how close a ship of the team has to be to target to make awacs_get_level() return more than 1.0f,
+// FLT_MAX if the distance doesn't matter and < 0.0f if no ship can
+static float team_visibility_range(object *target, int team, float scan_nebula_range)
+{
+	ship *shipp = &Ships[target->instance];
+	int stealth_ship = (shipp->flags[Ship::Ship_Flags::Stealth]);
+	int friendly_stealth_invisible = (shipp->flags[Ship::Ship_Flags::Friendly_stealth_invis]);
+	int nebula_enabled = (The_mission.flags[Mission::Mission_Flags::Fullneb]);
+
+	float any_range = (Hud_max_targeting_range > 0) ? Hud_max_targeting_range * AWACS_QUERY_SLACK : FLT_MAX;
+
+	// the same order as in awacs_get_level()
+	if ((shipp->team == team) && !(stealth_ship && friendly_stealth_invisible))
+		return any_range;
+
+	if (shipp->tag_left > 0.0f || shipp->level2_tag_left > 0.0f)
+		return any_range;
+
+	bool in_awacs_range = (stealth_ship || nebula_enabled) && awacs_in_range(target, team);
+
+	if (stealth_ship)
+		return (in_awacs_range && !nebula_enabled) ? any_range : -1.0f;
+
+	if (!nebula_enabled || in_awacs_range)
+		return any_range;
+
+	// a viewer may be inside the expanded bounding box of a huge ship while its center is further away
+	return MIN(any_range, 0.5f * scan_nebula_range * AWACS_QUERY_SLACK + 2.0f * target->radius);
+}
+
 // update team visibility
 void team_visibility_update()
 {
 	int team_count[MAX_IFFS];
-	int team_ships[MAX_IFFS][MAX_SHIPS];
+	static int team_ships[MAX_IFFS][MAX_SHIPS];
+
+	// the ships which see for their team, nav buoys and cargo containers don't
+	int viewer_count[MAX_IFFS];
+	static int team_viewers[MAX_IFFS][MAX_SHIPS];
+	static ubyte is_viewer[MAX_SHIPS];
+	float team_scan_range[MAX_IFFS];
 
 	ship_obj *moveup;
 	ship *shipp;
 
 	// zero out stuff for each team
 	memset(team_count, 0, MAX_IFFS * sizeof(int));
+	memset(viewer_count, 0, MAX_IFFS * sizeof(int));
+	memset(is_viewer, 0, MAX_SHIPS * sizeof(ubyte));
 	memset(Ship_visibility_by_team, 0, MAX_IFFS * MAX_SHIPS * sizeof(ubyte));
 
+	for (int team = 0; team < MAX_IFFS; team++)
+		team_scan_range[team] = 0.0f;
+
 	// Go through list of ships and mark those visible for their own team
 	for (moveup = GET_FIRST(&Ship_obj_list); moveup != END_OF_LIST(&Ship_obj_list); moveup = GET_NEXT(moveup))
 	{
@@ -384,17 +493,29 @@ void team_visibility_update()
 		Ship_visibility_by_team[shipp->team][ship_num] = 1;
 		team_ships[shipp->team][team_count[shipp->team]] = ship_num;
 		team_count[shipp->team]++;
+
+		// ignore nav buoys and cargo containers
+		ship_info *sip = &Ship_info[shipp->ship_info_index];
+		if (sip->flags[Ship::Info_Flags::Cargo] || sip->flags[Ship::Info_Flags::Navbuoy])
+			continue;
+
+		is_viewer[ship_num] = 1;
+		team_viewers[shipp->team][viewer_count[shipp->team]] = ship_num;
+		viewer_count[shipp->team]++;
+
+		float scan_nebula_range = Neb2_awacs * Species_info[sip->species].awacs_multiplier;
+		team_scan_range[shipp->team] = MAX(team_scan_range[shipp->team], scan_nebula_range);
 	}
 
 	int idx, en_idx, cur_count, en_count;
-	int *cur_team_ships, *en_team_ships;
+	int *cur_team_viewers, *en_team_ships;
 
 	// Do for all teams that cooperate with visibility
 	for (int cur_team = 0; cur_team < MAX_IFFS; cur_team++)
 	{
 		// set up current team
-		cur_count = team_count[cur_team];
-		cur_team_ships = team_ships[cur_team];
+		cur_count = viewer_count[cur_team];
+		cur_team_viewers = team_viewers[cur_team];
 
 		// short circuit if team has no presence
 		if (cur_count == 0)
@@ -415,20 +536,43 @@ void team_visibility_update()
 			// check if current team can see enemy team's ships
 			for (en_idx = 0; en_idx < en_count; en_idx++)
 			{
-				// for each ship on other team
-				for (idx = 0; idx < cur_count; idx++)
+				int en_ship = en_team_ships[en_idx];
+				object *en_objp = &Objects[Ships[en_ship].objnum];
+
+				if (Ship_visibility_by_team[cur_team][en_ship])
+					continue;
+
+				float range = team_visibility_range(en_objp, cur_team, team_scan_range[cur_team]);
+
+				if (range < 0.0f)
+					continue;
+
+				if (range == FLT_MAX)
 				{
-					// ignore nav buoys and cargo containers
-                    if (Ship_info[Ships[cur_team_ships[idx]].ship_info_index].flags[Ship::Info_Flags::Cargo] || Ship_info[Ships[cur_team_ships[idx]].ship_info_index].flags[Ship::Info_Flags::Navbuoy])
+					// usually the first ship on my team will do
+					for (idx = 0; idx < cur_count; idx++)
 					{
-						continue;
+						if (awacs_get_level(en_objp, &Ships[cur_team_viewers[idx]]) > 1.0f)
+						{
+							Ship_visibility_by_team[cur_team][en_ship] = 1;
+							break;
+						}
 					}
+				}
+				else
+				{
+					// only the ships of my team which are close enough can see it
+					obj_spatial_find_ships(&en_objp->pos, range, iff_get_mask(cur_team), Awacs_candidates);
 
-					// check against each ship on my team (and AWACS only once)
-					if (awacs_get_level(&Objects[Ships[en_team_ships[en_idx]].objnum], &Ships[cur_team_ships[idx]], (idx == 0)) > 1.0f)
+					for (auto objnum : Awacs_candidates)
 					{
-						Ship_visibility_by_team[cur_team][en_team_ships[en_idx]] = 1;
-						break;
+						int ship_num = Objects[objnum].instance;
+
+						if (is_viewer[ship_num] && (awacs_get_level(en_objp, &Ships[ship_num]) > 1.0f))
+						{
+							Ship_visibility_by_team[cur_team][en_ship] = 1;
+							break;
+						}
 					}
 				}
 			}
@@ -13,7 +13,7 @@
 //		1		An animating bitmap rendered per hit, not shrink-wrapped.  Lasts half time.  One per ship.
 //		2		Animating bitmap per hit, not shrink-wrapped.  Lasts full time.  Unlimited.
 //		3		Shrink-wrapped texture.  Lasts half-time.
-//		4		Shrink-wrapped texture.  Lasts full-time.
+//		4		Shrink-wrapped texture.  Lasts full-time.  Drawn by the shader on the shield mesh, once per ship for all its hits.
 
 #include "render/3d.h"
 #include "model/model.h"
@@ -66,6 +66,14 @@ typedef struct shield_hit {
 	vec3d hit_pos;								//	hit position
 } shield_hit;
 
+/**
+ * A shield hit which is drawn with the shield mesh at the highest detail level
+ */
+typedef struct shield_hit_decal {
+	int	shield_num;								//	Index in Shield_hits
+	int	bitmap_id;								//	The frame of the hit animation
+} shield_hit_decal;
+
 /**
  * Stores point at which shield was hit.
  * Gets processed in frame interval.
@@ -388,9 +396,12 @@ void shield_render_triangle(int texture, float alpha, gshield_tri *trip, matrix
 	}
 }
 
-void shield_render_decal(polymodel *pm, matrix *orient, vec3d *pos, matrix* hit_orient, vec3d *hit_pos, float hit_radius, int bitmap_id, color *clr)
+/**
+ * Draws the shield mesh of a ship once for up to ::SHIELD_MAX_IMPACTS hits, the shader evaluates all of them
+ */
+void shield_render_decals(polymodel *pm, matrix *orient, vec3d *pos, const shield_hit_decal *decals, int num_decals, float hit_radius, color *clr)
 {
-	if ( pm->shield.buffer_id < 0 || pm->shield.buffer_n_verts < 3 ) {
+	if ( pm->shield.buffer_id < 0 || pm->shield.buffer_n_verts < 3 || num_decals <= 0 ) {
 		return;
 	}
 
@@ -398,34 +409,40 @@ void shield_render_decal(polymodel *pm, matrix *orient, vec3d *pos, matrix* hit_
 
 	shield_material material_info;
 
-	material_info.set_texture_map(TM_BASE_TYPE, bitmap_id);
+	material_info.set_texture_map(TM_BASE_TYPE, decals[0].bitmap_id);
 	material_info.set_color(*clr);
-	material_info.set_blend_mode(bm_has_alpha_channel(bitmap_id) ? ALPHA_BLEND_ALPHA_BLEND_ALPHA : ALPHA_BLEND_ADDITIVE);
+	material_info.set_blend_mode(bm_has_alpha_channel(decals[0].bitmap_id) ? ALPHA_BLEND_ALPHA_BLEND_ALPHA : ALPHA_BLEND_ADDITIVE);
 	material_info.set_depth_mode(ZBUFFER_TYPE_READ);
 	material_info.set_impact_radius(hit_radius);
-	material_info.set_impact_transform(*hit_orient, *hit_pos);
 	material_info.set_cull_mode(false);
 
+	for ( int i = 0; i < num_decals; i++ ) {
+		shield_hit *hitp = &Shield_hits[decals[i].shield_num];
+
+		material_info.add_impact(hitp->hit_orient, hitp->hit_pos, decals[i].bitmap_id);
+	}
+
 	gr_render_shield_impact(&material_info, PRIM_TYPE_TRIS, &pm->shield.layout, pm->shield.buffer_id, pm->shield.buffer_n_verts);
 
 	g3_done_instance(true);
 }
 
 MONITOR(NumShieldRend)
+MONITOR(NumShieldDraws)
 
 /**
- * Render a shield mesh in the global array ::Shield_hits[]
+ * Ages a shield hit in the global array ::Shield_hits[] and finds the frame of its animation
+ *
+ * @return The bitmap to draw, or -1 if the hit isn't drawn
  */
-void render_shield(int shield_num)
+static int shield_hit_update(int shield_num)
 {
-	vec3d	*centerp;
-	matrix	*orient;
 	object	*objp;
 	ship		*shipp;
 	ship_info	*si;
 
 	if (Shield_hits[shield_num].type == SH_UNUSED)	{
-		return;
+		return -1;
 	}
 
 	Assert(Shield_hits[shield_num].objnum >= 0);
@@ -433,13 +450,13 @@ void render_shield(int shield_num)
 	objp = &Objects[Shield_hits[shield_num].objnum];
 
 	if (objp->flags[Object::Object_Flags::No_shields])	{
-		return;
+		return -1;
 	}
 
 	//	If this object didn't get rendered, don't render its shields.  In fact, make the shield hit go away.
 	if (!(objp->flags[Object::Object_Flags::Was_rendered])) {
 		Shield_hits[shield_num].type = SH_UNUSED;
-		return;
+		return -1;
 	}
 
 	//	At detail levels 1, 3, animations play at double speed to reduce load.
@@ -463,56 +480,125 @@ void render_shield(int shield_num)
 		if (Shield_hits[shield_num].start_time + (SHIELD_HIT_DURATION*50)/Poly_count < Missiontime) {
 			Shield_hits[shield_num].type = SH_UNUSED;
 			free_global_tri_records(shield_num);
-			return;
+			return -1;
 		}
 	} else if ((Shield_hits[shield_num].start_time + SHIELD_HIT_DURATION) < Missiontime) {
 		Shield_hits[shield_num].type = SH_UNUSED;
 		free_global_tri_records(shield_num);
-		return;
+		return -1;
 	}
 
-	orient = &objp->orient;
-	centerp = &objp->pos;
-
-	int bitmap_id, frame_num;
-
 	// Do some sanity checking
 	Assert( (si->species >= 0) && (si->species < (int)Species_info.size()) );
 
 	generic_anim *sa = &Species_info[si->species].shield_anim;
-	polymodel *pm = model_get(si->model_num);
 
 	// don't try to draw if we don't have an ani
-	if ( sa->first_frame >= 0 )
-	{
-		frame_num = bm_get_anim_frame(sa->first_frame, f2fl(Missiontime - Shield_hits[shield_num].start_time), f2fl(SHIELD_HIT_DURATION));
-		bitmap_id = sa->first_frame + frame_num;
-
-		float alpha = 0.9999f;
-		if(The_mission.flags[Mission::Mission_Flags::Fullneb]){
-			alpha *= 0.85f;
+	if ( sa->first_frame < 0 ) {
+		return -1;
+	}
+
+	int frame_num = bm_get_anim_frame(sa->first_frame, f2fl(Missiontime - Shield_hits[shield_num].start_time), f2fl(SHIELD_HIT_DURATION));
+
+	return sa->first_frame + frame_num;
+}
+
+static float shield_hit_alpha()
+{
+	float alpha = 0.9999f;
+	if(The_mission.flags[Mission::Mission_Flags::Fullneb]){
+		alpha *= 0.85f;
+	}
+
+	return alpha;
+}
+
+/**
+ * Render a shield mesh in the global array ::Shield_hits[]
+ */
+void render_shield(int shield_num)
+{
+	int bitmap_id = shield_hit_update(shield_num);
+
+	if ( bitmap_id <= -1 ) {
+		return;
+	}
+
+	object *objp = &Objects[Shield_hits[shield_num].objnum];
+	float alpha = shield_hit_alpha();
+
+	// hits made at the highest detail level don't have any triangles
+	if ( Shield_hits[shield_num].num_tris <= 0 ) {
+		return;
+	}
+
+	if ( (Detail.shield_effects == 1) || (Detail.shield_effects == 2) ) {
+		shield_render_low_detail_bitmap(bitmap_id, alpha, &Global_tris[Shield_hits[shield_num].tri_list[0]], &objp->orient, &objp->pos, Shield_hits[shield_num].rgb[0], Shield_hits[shield_num].rgb[1], Shield_hits[shield_num].rgb[2]);
+	} else {
+		for ( int i = 0; i < Shield_hits[shield_num].num_tris; i++ ) {
+			shield_render_triangle(bitmap_id, alpha, &Global_tris[Shield_hits[shield_num].tri_list[i]], &objp->orient, &objp->pos, Shield_hits[shield_num].rgb[0], Shield_hits[shield_num].rgb[1], Shield_hits[shield_num].rgb[2]);
 		}
+	}
+}
 
-		if ( bitmap_id <= -1 ) {
-			return;
+static SCP_vector<shield_hit_decal> Shield_hit_decals;
+
+/**
+ * Renders the shield hits at the highest detail level, the shield mesh of each ship is drawn once for all of its hits
+ */
+static void render_shield_decals()
+{
+	Shield_hit_decals.clear();
+
+	for ( int i = 0; i < MAX_SHIELD_HITS; i++ ) {
+		if ( Shield_hits[i].type == SH_UNUSED ) {
+			continue;
 		}
 
-		if ( (Detail.shield_effects == 1) || (Detail.shield_effects == 2) ) {
-			shield_render_low_detail_bitmap(bitmap_id, alpha, &Global_tris[Shield_hits[shield_num].tri_list[0]], orient, centerp, Shield_hits[shield_num].rgb[0], Shield_hits[shield_num].rgb[1], Shield_hits[shield_num].rgb[2]);
-		} else if ( Detail.shield_effects < 4 ) {
-			for ( int i = 0; i < Shield_hits[shield_num].num_tris; i++ ) {
-				shield_render_triangle(bitmap_id, alpha, &Global_tris[Shield_hits[shield_num].tri_list[i]], orient, centerp, Shield_hits[shield_num].rgb[0], Shield_hits[shield_num].rgb[1], Shield_hits[shield_num].rgb[2]);
-			}
-		} else {
-			float hit_radius = pm->core_radius;
-			if ( si->is_big_or_huge() ) {
-				hit_radius = pm->core_radius * 0.5f;
-			}
+		int bitmap_id = shield_hit_update(i);
+
+		if ( bitmap_id > -1 ) {
+			shield_hit_decal decal;
+			decal.shield_num = i;
+			decal.bitmap_id = bitmap_id;
+
+			Shield_hit_decals.push_back(decal);
+		}
+	}
+
+	// keep the hits of a ship in the order they were drawn in before
+	std::stable_sort(Shield_hit_decals.begin(), Shield_hit_decals.end(), [](const shield_hit_decal &a, const shield_hit_decal &b) {
+		return Shield_hits[a.shield_num].objnum < Shield_hits[b.shield_num].objnum;
+	});
+
+	float alpha = shield_hit_alpha();
+
+	for ( size_t first = 0; first < Shield_hit_decals.size(); ) {
+		shield_hit *first_hit = &Shield_hits[Shield_hit_decals[first].shield_num];
 
-			color clr;
-			gr_init_alphacolor(&clr, Shield_hits[shield_num].rgb[0], Shield_hits[shield_num].rgb[1], Shield_hits[shield_num].rgb[2], fl2i(alpha * 255.0f));
-			shield_render_decal(pm, orient, centerp, &Shield_hits[shield_num].hit_orient, &Shield_hits[shield_num].hit_pos, hit_radius, bitmap_id, &clr);
+		size_t end = first + 1;
+		while ( end < Shield_hit_decals.size() && end - first < SHIELD_MAX_IMPACTS
+			&& Shield_hits[Shield_hit_decals[end].shield_num].objnum == first_hit->objnum ) {
+			++end;
 		}
+
+		object *objp = &Objects[first_hit->objnum];
+		ship_info *si = &Ship_info[Ships[objp->instance].ship_info_index];
+		polymodel *pm = model_get(si->model_num);
+
+		float hit_radius = pm->core_radius;
+		if ( si->is_big_or_huge() ) {
+			hit_radius = pm->core_radius * 0.5f;
+		}
+
+		color clr;
+		gr_init_alphacolor(&clr, first_hit->rgb[0], first_hit->rgb[1], first_hit->rgb[2], fl2i(alpha * 255.0f));
+
+		MONITOR_INC(NumShieldDraws, 1);
+
+		shield_render_decals(pm, &objp->orient, &objp->pos, &Shield_hit_decals[first], (int)(end - first), hit_radius, &clr);
+
+		first = end;
 	}
 }
 
@@ -533,9 +619,13 @@ void render_shields()
 		return;	//	No shield effect rendered at lowest detail level.
 	}
 
-	for (i=0; i<MAX_SHIELD_HITS; i++){
-		if (Shield_hits[i].type != SH_UNUSED){
-			render_shield(i);
+	if (Detail.shield_effects >= 4) {
+		render_shield_decals();
+	} else {
+		for (i=0; i<MAX_SHIELD_HITS; i++){
+			if (Shield_hits[i].type != SH_UNUSED){
+				render_shield(i);
+			}
 		}
 	}
 
@@ -618,6 +708,24 @@ void create_shield_from_triangle(int trinum, matrix *orient, shield_info *shield
 	visit_children(trinum, 2, orient, shieldp, tcp, centerp, radius, rvec, uvec);
 }
 
+/**
+ * Sets the color of a hit in ::Shield_hits to the shield color of the ship which was hit
+ */
+static void shield_hit_set_color(int shnum, int objnum)
+{
+	Shield_hits[shnum].rgb[0] = 255;
+	Shield_hits[shnum].rgb[1] = 255;
+	Shield_hits[shnum].rgb[2] = 255;
+
+	if((objnum >= 0) && (objnum < MAX_OBJECTS) && (Objects[objnum].type == OBJ_SHIP) && (Objects[objnum].instance >= 0) && (Objects[objnum].instance < MAX_SHIPS) && (Ships[Objects[objnum].instance].ship_info_index >= 0) && (Ships[Objects[objnum].instance].ship_info_index < static_cast<int>(Ship_info.size()))){
+		ship_info *sip = &Ship_info[Ships[Objects[objnum].instance].ship_info_index];
+		
+		Shield_hits[shnum].rgb[0] = sip->shield_color[0];
+		Shield_hits[shnum].rgb[1] = sip->shield_color[1];
+		Shield_hits[shnum].rgb[2] = sip->shield_color[2];
+	}
+}
+
 /**
  * Copy information from Current_tris to ::Global_tris, stuffing information
  * in a slot in ::Shield_hits.  
@@ -669,17 +777,25 @@ void copy_shield_to_globals( int objnum, shield_info *shieldp, matrix *hit_orien
 	Shield_hits[shnum].hit_orient = *hit_orient;
 	Shield_hits[shnum].hit_pos = *hit_pos;
 
-	Shield_hits[shnum].rgb[0] = 255;
-	Shield_hits[shnum].rgb[1] = 255;
-	Shield_hits[shnum].rgb[2] = 255;
+	shield_hit_set_color(shnum, objnum);
+}
 
-	if((objnum >= 0) && (objnum < MAX_OBJECTS) && (Objects[objnum].type == OBJ_SHIP) && (Objects[objnum].instance >= 0) && (Objects[objnum].instance < MAX_SHIPS) && (Ships[Objects[objnum].instance].ship_info_index >= 0) && (Ships[Objects[objnum].instance].ship_info_index < static_cast<int>(Ship_info.size()))){
-		ship_info *sip = &Ship_info[Ships[Objects[objnum].instance].ship_info_index];
-		
-		Shield_hits[shnum].rgb[0] = sip->shield_color[0];
-		Shield_hits[shnum].rgb[1] = sip->shield_color[1];
-		Shield_hits[shnum].rgb[2] = sip->shield_color[2];
-	}
+/**
+ * Records a shield hit for the highest detail level, where the shield shader finds the triangles which are hit
+ */
+void create_shield_impact(int objnum, vec3d *tcp, int tr0, shield_info *shieldp)
+{
+	int	shnum = get_global_shield_tri();
+
+	Shield_hits[shnum].type = SH_TYPE_1;
+	Shield_hits[shnum].num_tris = 0;
+	Shield_hits[shnum].start_time = Missiontime;
+	Shield_hits[shnum].objnum = objnum;
+
+	vm_vector_2_matrix(&Shield_hits[shnum].hit_orient, &shieldp->tris[tr0].norm, NULL, NULL);
+	Shield_hits[shnum].hit_pos = *tcp;
+
+	shield_hit_set_color(shnum, objnum);
 }
 
 
@@ -709,16 +825,7 @@ void create_shield_low_detail(int objnum, int model_num, matrix *orient, vec3d *
 	Shield_hits[shnum].start_time = Missiontime;
 	Shield_hits[shnum].objnum = objnum;
 
-	Shield_hits[shnum].rgb[0] = 255;
-	Shield_hits[shnum].rgb[1] = 255;
-	Shield_hits[shnum].rgb[2] = 255;
-	if((objnum >= 0) && (objnum < MAX_OBJECTS) && (Objects[objnum].type == OBJ_SHIP) && (Objects[objnum].instance >= 0) && (Objects[objnum].instance < MAX_SHIPS) && (Ships[Objects[objnum].instance].ship_info_index >= 0) && (Ships[Objects[objnum].instance].ship_info_index < static_cast<int>(Ship_info.size()))){
-		ship_info *sip = &Ship_info[Ships[Objects[objnum].instance].ship_info_index];
-		
-		Shield_hits[shnum].rgb[0] = sip->shield_color[0];
-		Shield_hits[shnum].rgb[1] = sip->shield_color[1];
-		Shield_hits[shnum].rgb[2] = sip->shield_color[2];
-	}
+	shield_hit_set_color(shnum, objnum);
 
 	vm_vector_2_matrix(&tom, &shieldp->tris[tr0].norm, NULL, NULL);
 
@@ -763,6 +870,12 @@ void create_shield_explosion(int objnum, int model_num, matrix *orient, vec3d *c
 		return;
 	}
 
+	// the shader draws the hit on the shield mesh, the triangles are only needed at the lower detail levels
+	if ( Detail.shield_effects >= 4 ) {
+		create_shield_impact(objnum, tcp, tr0, shieldp);
+		return;
+	}
+
 	for (i=0; i<Num_tris; i++)
 		shieldp->tris[i].used = 0;
 
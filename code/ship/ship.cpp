@@ -61,6 +61,8 @@
 #include "object/objectdock.h"
 #include "object/objectshield.h"
 #include "object/objectsnd.h"
+#include "object/objspatial.h"
+#include "object/objtimer.h"
 #include "object/waypoint.h"
 #include "parse/parselo.h"
 #include "scripting/scripting.h"
@@ -81,11 +83,13 @@
 #include "weapon/corkscrew.h"
 #include "weapon/emp.h"
 #include "weapon/flak.h"								//phreak addded 11/05/02 for flak primaries
+#include "weapon/projectile.h"
 #include "weapon/shockwave.h"
 #include "weapon/swarm.h"
 #include "weapon/weapon.h"
 #include "tracing/Monitor.h"
 #include "tracing/tracing.h"
+#include "utils/string_intern.h"
 
 using namespace Ship;
 
@@ -103,8 +107,14 @@ using namespace Ship;
 static int Num_ship_subsystems = 0;
 static int Num_ship_subsystems_allocated = 0;
 
-static SCP_vector<ship_subsys*> Ship_subsystems;
-ship_subsys ship_subsys_free_list;
+// each ship gets its subsystems as one run of consecutive entries in a batch
+typedef struct ship_subsys_batch {
+	ship_subsys *subsystems;
+	int size;
+	SCP_vector<bool> in_use;
+} ship_subsys_batch;
+
+static SCP_vector<ship_subsys_batch> Ship_subsystems;
 
 extern bool splodeing;
 extern float splode_level;
@@ -155,6 +165,17 @@ int ship_info_lookup_sub(const char *token);
 // information for ships which have exited the game
 SCP_vector<exited_ship> Ships_exited;
 
+// the ships which have an object by the interned id of their name, kept current by ship_name_index_add() and
+// ship_name_index_remove()
+static SCP_unordered_map<int, int> Ship_name_index;
+
+// the wings by the interned id of their name, rebuilt when the number of wings changed
+static SCP_unordered_map<int, int> Wing_name_index;
+static int Wing_name_index_count = -1;
+
+// the ship classes found by ship_info_lookup_sub() by the interned id of their name
+static SCP_unordered_map<int, int> Ship_info_name_index;
+
 int	Num_engine_wash_types;
 int	Num_ship_subobj_types;
 int	Num_ship_subobjects;
@@ -601,6 +622,9 @@ int ship_obj_list_add(int objnum)
 	list_append(&Ship_obj_list, &Ship_objs[i]);
 	Ship_objs[i].flags |= SHIP_OBJ_USED;
 
+	// the new ship has to be found by the proximity queries right away
+	obj_spatial_invalidate();
+
 	return i;
 }
 
@@ -2413,6 +2437,7 @@ int parse_ship_values(ship_info* sip, const bool is_template, const bool first_t
 		display.name[0] = 0;
 		display.offset[0] = 0;
 		display.offset[1] = 0;
+		display.refresh_rate = 0;
 
 		required_string("+Texture:");
 		stuff_string(display.filename, F_NAME, MAX_FILENAME_LEN);
@@ -2434,6 +2459,15 @@ int parse_ship_values(ship_info* sip, const bool is_template, const bool first_t
 		required_string("+Display Name:");
 		stuff_string(display.name, F_NAME, MAX_FILENAME_LEN);
 
+		if ( optional_string("+Refresh Rate:") ) {
+			stuff_int(&display.refresh_rate);
+
+			if ( display.refresh_rate < 0 ) {
+				Warning(LOCATION, "Negative refresh rate given for cockpit display %s on %s, updating it every frame", display.name, sip->name);
+				display.refresh_rate = 0;
+			}
+		}
+
 		if ( display.offset[0] < 0 || display.offset[1] < 0 ) {
 			Warning(LOCATION, "Negative display offsets given for cockpit display on %s, skipping entry", sip->name);
 			continue;
@@ -3593,22 +3627,22 @@ int parse_ship_values(ship_info* sip, const bool is_template, const bool first_t
 	}
 	else if (first_time && strlen(sip->pof_file))
 	{
-		//Calculate from the model file. This is inefficient, but whatever
-		int model_idx = model_load(sip->pof_file, 0, NULL);
-		polymodel *pm = model_get(model_idx);
-
-		//Go through, find best
-		sip->closeup_pos.xyz.z = fabsf(pm->maxs.xyz.z);
-
-		float temp = fabsf(pm->mins.xyz.z);
-		if(temp > sip->closeup_pos.xyz.z)
-			sip->closeup_pos.xyz.z = temp;
-
-		//Now multiply by 2
-		sip->closeup_pos.xyz.z *= -2.0f;
-
-		//We're done with the model.
-		model_unload(model_idx);
+		//Calculate from the bounding box in the model file. Only its header is read so classes which aren't used
+		//don't load their model (and all of its textures) at startup
+		vec3d mins, maxs;
+		if (model_read_bounding_box(sip->pof_file, &mins, &maxs)) {
+			//Go through, find best
+			sip->closeup_pos.xyz.z = fabsf(maxs.xyz.z);
+
+			float temp = fabsf(mins.xyz.z);
+			if(temp > sip->closeup_pos.xyz.z)
+				sip->closeup_pos.xyz.z = temp;
+
+			//Now multiply by 2
+			sip->closeup_pos.xyz.z *= -2.0f;
+		} else {
+			Warning(LOCATION, "Can't read the bounding box of model file <%s> of ship class %s for its $Closeup_pos.", sip->pof_file, sip->name);
+		}
 	}
 
 	if (optional_string("$Closeup_zoom:")) {
@@ -5315,57 +5349,110 @@ int Man_thruster_reset_timestamp = 0;
 static void ship_clear_subsystems()
 {
 	for (auto it = Ship_subsystems.begin(); it != Ship_subsystems.end(); ++it) {
-		delete[] *it;
+		delete[] it->subsystems;
 	}
 	Ship_subsystems.clear();
 
 	Num_ship_subsystems = 0;
 	Num_ship_subsystems_allocated = 0;
 
-	Triggered_rotations.clear();
+	model_anim_clear_triggered_rotations();
 }
 
-static int ship_allocate_subsystems(int num_so, bool page_in = false)
+static void ship_add_subsystem_batch(int size)
 {
-	int i;
-	int num_subsystems_save = 0;
+	ship_subsys_batch batch;
+
+	batch.size = MAX(size, NUM_SHIP_SUBSYSTEMS_PER_SET);
+	batch.subsystems = new ship_subsys[batch.size];
+	batch.in_use.assign(batch.size, false);
+
+	Ship_subsystems.push_back(std::move(batch));
 
+	Num_ship_subsystems_allocated += Ship_subsystems.back().size;
+}
+
+/**
+ * Makes room for more subsystems, so that we can grab as much as possible before mission start
+ */
+static int ship_allocate_subsystems(int num_so)
+{
 	// "0" itself is safe
 	if (num_so < 0) {
 		Int3();
 		return 0;
 	}
 
-	// allow a page-in thingy, so that we can grab as much as possible before mission
-	// start, but without messing up our count for future things
-	if (page_in)
-		num_subsystems_save = Num_ship_subsystems;
-
-	Num_ship_subsystems += num_so;
+	int num_needed = Num_ship_subsystems + num_so;
 
 	// bail if we don't actually need any more
-	if ( Num_ship_subsystems < Num_ship_subsystems_allocated )
+	if ( num_needed < Num_ship_subsystems_allocated )
 		return 1;
 
 	mprintf(("Allocating space for at least %i new ship subsystems ... ", num_so));
 
-	// we might need more than one set worth of new subsystems, so make as many as required
-	do {
-		ship_subsys* new_batch = new ship_subsys[NUM_SHIP_SUBSYSTEMS_PER_SET];
-		Ship_subsystems.push_back(new_batch);
+	// one batch for all of them, so the runs of the ships can be taken from it without gaps
+	ship_add_subsystem_batch(num_needed - Num_ship_subsystems_allocated);
 
-		// append the new set to our free list
-		for (i = 0; i < NUM_SHIP_SUBSYSTEMS_PER_SET; i++)
-			list_append( &ship_subsys_free_list, &new_batch[i] );
+	mprintf((" a total of %i is now available (%i in-use).\n", Num_ship_subsystems_allocated, Num_ship_subsystems));
+	return 1;
+}
+
+/**
+ * Takes a run of consecutive subsystems for a ship, adding a batch if none of them has enough free space left
+ */
+static ship_subsys *ship_take_subsystems(int num_so)
+{
+	if (num_so <= 0)
+		return NULL;
 
-		Num_ship_subsystems_allocated += NUM_SHIP_SUBSYSTEMS_PER_SET;
-	} while ( (Num_ship_subsystems - Num_ship_subsystems_allocated) > 0 );
+	for (int pass = 0; pass < 2; pass++) {
+		for (auto &batch : Ship_subsystems) {
+			int run = 0;
 
-	if (page_in)
-		Num_ship_subsystems = num_subsystems_save;
+			for (int i = 0; i < batch.size; i++) {
+				run = batch.in_use[i] ? 0 : run + 1;
 
-	mprintf((" a total of %i is now available (%i in-use).\n", Num_ship_subsystems_allocated, Num_ship_subsystems));
-	return 1;
+				if (run == num_so) {
+					int first = i - num_so + 1;
+
+					std::fill(batch.in_use.begin() + first, batch.in_use.begin() + i + 1, true);
+					Num_ship_subsystems += num_so;
+
+					return &batch.subsystems[first];
+				}
+			}
+		}
+
+		// the free subsystems are spread out too much, a new batch will have room
+		mprintf(("Allocating space for %i new ship subsystems ... ", num_so));
+		ship_add_subsystem_batch(num_so);
+		mprintf((" a total of %i is now available (%i in-use).\n", Num_ship_subsystems_allocated, Num_ship_subsystems));
+	}
+
+	Error(LOCATION, "A new batch of subsystems has no room for %d subsystems, get a coder!", num_so);
+	return NULL;
+}
+
+/**
+ * Puts the subsystems of a ship back into their batch
+ */
+static void ship_return_subsystems(ship_subsys *subsystems, int num_so)
+{
+	if (num_so <= 0)
+		return;
+
+	for (auto &batch : Ship_subsystems) {
+		if ((subsystems >= batch.subsystems) && (subsystems < batch.subsystems + batch.size)) {
+			auto first = subsystems - batch.subsystems;
+
+			std::fill(batch.in_use.begin() + first, batch.in_use.begin() + first + num_so, false);
+			Num_ship_subsystems -= num_so;
+			return;
+		}
+	}
+
+	Assertion(false, "The subsystems of a ship were not found in any batch, get a coder!");
 }
 
 /**
@@ -5383,8 +5470,10 @@ void ship_level_init()
 		Ships[i].ship_name[0] = '\0';
 		Ships[i].objnum = -1;
 	}
+	Ship_name_index.clear();
 
 	Num_wings = 0;
+	Wing_name_index_count = -1;
 	for (i = 0; i < MAX_WINGS; i++ )
 	{
 		Wings[i].num_waves = -1;
@@ -5424,7 +5513,6 @@ void ship_level_init()
 
 	// Empty the subsys list
 	ship_clear_subsystems();
-	list_init( &ship_subsys_free_list );
 
 	Laser_energy_out_snd_timer = 1;
 	Missile_out_snd_timer		= 1;
@@ -5551,6 +5639,9 @@ void physics_ship_init(object *objp)
 	else
 		pi->I_body_inv = pm->moment_of_inertia;
 
+	// the ship may be docked, e.g. when it changes its class
+	dock_invalidate_docked_mass();
+
 	// scale pm->I_body_inv value by density
 	vm_vec_scale( &pi->I_body_inv.vec.rvec, sinfo->density );
 	vm_vec_scale( &pi->I_body_inv.vec.uvec, sinfo->density );
@@ -5790,6 +5881,8 @@ void ship::clear()
 	// since these aren't cleared by clear()
 	subsys_list.next = NULL;
 	subsys_list.prev = NULL;
+	subsys_array = NULL;
+	num_subsys = 0;
 
 	memset(&subsys_info, 0, SUBSYSTEM_MAX * sizeof(ship_subsys_info));
 
@@ -5876,7 +5969,6 @@ void ship::clear()
 	persona_index = -1;
 
 	subsys_disrupted_flags = 0;
-	subsys_disrupted_check_timestamp = timestamp(0);
 
 	create_time = 0;
 
@@ -5906,7 +5998,7 @@ void ship::clear()
 	for (i = 0; i < MAX_PLAYERS; i++ )
 	{
 		np_updates[i].seq = 0;
-		np_updates[i].update_stamp = -1;
+		np_updates[i].priority = OO_PRIORITY_DUE;
 		np_updates[i].status_update_stamp = -1;
 		np_updates[i].subsys_update_stamp = -1;
 		np_updates[i].pos_chksum = 0;
@@ -6010,7 +6102,7 @@ void ship_weapon::clear()
     {
         primary_bank_weapons[i] = -1;
 
-        next_primary_fire_stamp[i] = timestamp(0);
+        next_primary_fire_stamp[i] = timestamp_us(0);
         last_primary_fire_stamp[i] = timestamp(-1);
         last_primary_fire_sound_stamp[i] = timestamp(0);
 
@@ -6036,7 +6128,7 @@ void ship_weapon::clear()
     {
         secondary_bank_weapons[i] = -1;
 
-        next_secondary_fire_stamp[i] = timestamp(0);
+        next_secondary_fire_stamp[i] = timestamp_us(0);
         last_secondary_fire_stamp[i] = timestamp(-1);
 
         secondary_bank_rearm_time[i] = timestamp(0);
@@ -6072,6 +6164,8 @@ ship_weapon::ship_weapon() {
 }
 
 // NOTE: Now that the clear() member function exists, this function only sets the stuff associated with the object and ship class.
+static void ship_subsys_disrupted_maybe_check(object *objp, int data);
+
 void ship_set(int ship_index, int objnum, int ship_type)
 {
 	int i;
@@ -6096,6 +6190,8 @@ void ship_set(int ship_index, int objnum, int ship_type)
 
 	if ( !Fred_running ) {
 		ship_set_warp_effects(objp, sip);
+
+		obj_timer_schedule(objp, timestamp(0), ship_subsys_disrupted_maybe_check);
 	}
 
 	if (Fred_running){
@@ -6242,7 +6338,7 @@ void ship_recalc_subsys_strength( ship *shipp )
 
 	// count all of the subsystems of a particular type.  For each generic type of subsystem, we store the
 	// total count of hits.  (i.e. for 3 engines, we store the sum of the max_hits for each engine)
-	for ( ship_system = GET_FIRST(&shipp->subsys_list); ship_system != END_OF_LIST(&shipp->subsys_list); ship_system = GET_NEXT(ship_system) ) {
+	for ( ship_system = shipp->subsys_array; ship_system < shipp->subsys_array + shipp->num_subsys; ship_system++ ) {
 
 		if (!(ship_system->flags[Ship::Subsystem_Flags::No_aggregate])) {
 			int type = ship_system->system_info->type;
@@ -6471,11 +6567,17 @@ int subsys_set(int objnum, int ignore_subsys_info)
 	// for each subsystem, get a new ship_subsys instance and set up the pointers and other values
 	list_init ( &shipp->subsys_list );								// initialize the ship's list of subsystems
 
-	// make sure to have allocated the number of subsystems we require
-	if (!ship_allocate_subsystems( sinfo->n_subsystems )) {
-		return 0;
+	// the subsystems which are linked into the ship, they are taken in one piece
+	shipp->num_subsys = 0;
+	for ( i = 0; i < sinfo->n_subsystems; i++ )
+	{
+		if (sinfo->subsystems[i].model_num >= 0)
+			shipp->num_subsys++;
 	}
 
+	shipp->subsys_array = ship_take_subsystems( shipp->num_subsys );
+
+	int subsys_index = 0;
 	for ( i = 0; i < sinfo->n_subsystems; i++ )
 	{
 		model_system = &(sinfo->subsystems[i]);
@@ -6485,9 +6587,7 @@ int subsys_set(int objnum, int ignore_subsys_info)
 		}
 
 		// set up the linked list
-		ship_system = GET_FIRST( &ship_subsys_free_list );		// get a new element from the ship_subsystem array
-		Assert ( ship_system != &ship_subsys_free_list );		// shouldn't have the dummy element
-		list_remove( ship_subsys_free_list, ship_system );		// remove the element from the array
+		ship_system = &shipp->subsys_array[subsys_index++];		// get the next element of the ship's run
 		list_append( &shipp->subsys_list, ship_system );		// link the element into the ship
 		ship_system->clear();									// initialize it to a known blank slate
 
@@ -6593,7 +6693,7 @@ int subsys_set(int objnum, int ignore_subsys_info)
 			if (model_system->primary_banks[k] != -1) {
 				ship_system->weapons.primary_bank_weapons[j] = model_system->primary_banks[k];
 				ship_system->weapons.primary_bank_capacity[j] = model_system->primary_bank_capacity[k];	// added by Goober5000
-				ship_system->weapons.next_primary_fire_stamp[j] = timestamp(0);
+				ship_system->weapons.next_primary_fire_stamp[j] = timestamp_us(0);
 				ship_system->weapons.last_primary_fire_stamp[j++] = -1;
 			}
 			ship_system->weapons.burst_counter[k] = 0;
@@ -6607,7 +6707,7 @@ int subsys_set(int objnum, int ignore_subsys_info)
 			if (model_system->secondary_banks[k] != -1) {
 				ship_system->weapons.secondary_bank_weapons[j] = model_system->secondary_banks[k];
 				ship_system->weapons.secondary_bank_capacity[j] = model_system->secondary_bank_capacity[k];
-				ship_system->weapons.next_secondary_fire_stamp[j] = timestamp(0);
+				ship_system->weapons.next_secondary_fire_stamp[j] = timestamp_us(0);
 				ship_system->weapons.last_secondary_fire_stamp[j++] = -1;
 			}
 			ship_system->weapons.burst_counter[k + MAX_SHIP_PRIMARY_BANKS] = 0;
@@ -6724,6 +6824,9 @@ int subsys_set(int objnum, int ignore_subsys_info)
 		if (model_system->flags[Model::Subsystem_Flags::Triggered]) {
 			ship_system->triggered_rotation_index = (int)Triggered_rotations.size();
 			triggered_rotation tr;
+			tr.obj_num = objnum;
+			tr.obj_signature = Objects[objnum].signature;
+			tr.subsys = ship_system;
 			Triggered_rotations.push_back(tr);
 		}
 	}
@@ -6974,6 +7077,22 @@ void ship_init_cockpit_displays(ship *shipp)
 		ship_add_cockpit_display(&sip->displays[i], cockpit_model_num);
 	}
 
+	int num_displays = (int)Player_displays.size();
+
+	for ( i = 0; i < num_displays; i++ ) {
+		cockpit_display *display = &Player_displays[i];
+
+		// spread the updates of the displays over their interval so they don't all happen in the same frame
+		display->next_refresh = timestamp(display->refresh_interval * i / num_displays);
+
+		// starting a display clears its whole texture
+		for ( int j = 0; j < num_displays; j++ ) {
+			if ( (j != i) && (Player_displays[j].target == display->target) ) {
+				display->shared_target = true;
+			}
+		}
+	}
+
 	ship_set_hud_cockpit_targets();
 }
 
@@ -7068,6 +7187,12 @@ void ship_add_cockpit_display(cockpit_display_info *display, int cockpit_model_n
 	new_display.source = glow_handle;
 	new_display.target = Player_cockpit_textures[glow_target];
 
+	new_display.refresh_interval = (display->refresh_rate > 0) ? MAX(1000 / display->refresh_rate, 1) : 0;
+	new_display.next_refresh = timestamp(0);
+	new_display.dirty = true;
+	new_display.shared_target = false;
+	new_display.content_version = 0;
+
 	Player_displays.push_back(new_display);
 }
 
@@ -7132,6 +7257,50 @@ int ship_start_render_cockpit_display(size_t cockpit_display_num)
 	return display->target;
 }
 
+bool ship_cockpit_display_needs_update(size_t cockpit_display_num, std::uint64_t content_version)
+{
+	if ( cockpit_display_num >= Player_displays.size() ) {
+		return false;
+	}
+
+	cockpit_display* display = &Player_displays[cockpit_display_num];
+
+	if ( display->shared_target ) {
+		return true;
+	}
+
+	if ( (display->refresh_interval > 0) && !timestamp_elapsed(display->next_refresh) ) {
+		return false;
+	}
+
+	if ( !display->dirty && (content_version != 0) && (content_version == display->content_version) ) {
+		return false;
+	}
+
+	if ( display->refresh_interval > 0 ) {
+		// keeping the phase keeps the staggered displays apart
+		display->next_refresh += display->refresh_interval;
+
+		if ( timestamp_elapsed(display->next_refresh) ) {
+			display->next_refresh = timestamp(display->refresh_interval);
+		}
+	}
+
+	display->dirty = false;
+	display->content_version = content_version;
+
+	return true;
+}
+
+void ship_invalidate_cockpit_display(size_t cockpit_display_num)
+{
+	if ( cockpit_display_num >= Player_displays.size() ) {
+		return;
+	}
+
+	Player_displays[cockpit_display_num].dirty = true;
+}
+
 void ship_end_render_cockpit_display(size_t cockpit_display_num)
 {
 	// make sure this thing even has a cockpit
@@ -7173,11 +7342,15 @@ void ship_subsystems_delete(ship *shipp)
 		while ( systemp != END_OF_LIST(&shipp->subsys_list) ) {
 			temp = GET_NEXT( systemp );								// use temporary since pointers will get screwed with next operation
 			list_remove( shipp->subsys_list, systemp );			// remove the element
-			list_append( &ship_subsys_free_list, systemp );		// and place back onto free list
-			Num_ship_subsystems--;								// subtract from our in-use total
 			systemp = temp;												// use the temp variable to move right along
 		}
 	}
+
+	// and place the run back into its batch
+	ship_return_subsystems(shipp->subsys_array, shipp->num_subsys);
+
+	shipp->subsys_array = NULL;
+	shipp->num_subsys = 0;
 }
 
 void ship_delete( object * obj )
@@ -7200,6 +7373,7 @@ void ship_delete( object * obj )
 	// free up the list of subsystems of this ship.  walk through list and move remaining subsystems
 	// on ship back to the free list for other ships to use.
 	ship_subsystems_delete(&Ships[num]);
+	ship_name_index_remove(num);
 	shipp->objnum = -1;
 
 	if (shipp->shield_integrity != NULL) {
@@ -8427,7 +8601,7 @@ void ship_auto_repair_frame(int shipnum, float frametime)
 		return;
 	
 	// iterate through subsystems, repair as needed based on elapsed frametime
-	for ( ssp = GET_FIRST(&sp->subsys_list); ssp != END_OF_LIST(&sp->subsys_list); ssp = GET_NEXT(ssp) ) {
+	for ( ssp = sp->subsys_array; ssp < sp->subsys_array + sp->num_subsys; ssp++ ) {
 		Assert(ssp->system_info->type >= 0 && ssp->system_info->type < SUBSYSTEM_MAX);
 		ssip = &sp->subsys_info[ssp->system_info->type];
 
@@ -8618,12 +8792,10 @@ void ship_subsys_disrupted_check(ship *sp)
 
 	sp->subsys_disrupted_flags=0;
 
-	ss = GET_FIRST(&sp->subsys_list);
-	while ( ss != END_OF_LIST( &sp->subsys_list ) ) {
+	for ( ss = sp->subsys_array; ss < sp->subsys_array + sp->num_subsys; ss++ ) {
 		if ( !timestamp_elapsed(ss->disruption_timestamp) ) {
 			sp->subsys_disrupted_flags |= (1<<ss->system_info->type);
 		}
-		ss = GET_NEXT( ss );
 	}
 
 	if ( engines_disabled ) {
@@ -8636,14 +8808,15 @@ void ship_subsys_disrupted_check(ship *sp)
 }
 
 /**
- * Maybe check ship subsystems for disruption, and set/clear flags
+ * Check ship subsystems for disruption four times a second, and set/clear flags
+ *
+ * Runs as a timer of the ship object, see obj_timer_schedule().
  */
-void ship_subsys_disrupted_maybe_check(ship *shipp)
+static void ship_subsys_disrupted_maybe_check(object *objp, int /*data*/)
 {
-	if ( timestamp_elapsed(shipp->subsys_disrupted_check_timestamp) ) {
-		ship_subsys_disrupted_check(shipp);
-		shipp->subsys_disrupted_check_timestamp=timestamp(250);
-	}
+	ship_subsys_disrupted_check(&Ships[objp->instance]);
+
+	obj_timer_schedule(objp, timestamp(250), ship_subsys_disrupted_maybe_check);
 }
 
 /**
@@ -8827,8 +9000,6 @@ void ship_process_post(object * obj, float frametime)
 
 	afterburners_update(obj, frametime);
 
-	ship_subsys_disrupted_maybe_check(shipp);
-
 	ship_dying_frame(obj, num);
 
 	ship_chase_shield_energy_targets(shipp, obj, frametime);
@@ -8942,8 +9113,8 @@ void ship_process_post(object * obj, float frametime)
 		//	Do AI.
 
 		// for multiplayer people.  return here if in multiplay and not the host
+		// (the animations which are safe to play on clients are done by model_anim_process_triggered_rotations())
 		if ( MULTIPLAYER_CLIENT ) {
-			model_anim_handle_multiplayer( &Ships[num] );
 			return;
 		}
 
@@ -9116,14 +9287,14 @@ void ship_set_default_weapons(ship *shipp, ship_info *sip)
 	}
 
 	for ( i = 0; i < MAX_SHIP_PRIMARY_BANKS; i++ ){
-		swp->next_primary_fire_stamp[i] = timestamp(0);
+		swp->next_primary_fire_stamp[i] = timestamp_us(0);
 		swp->last_primary_fire_stamp[i] = -1;
 		swp->burst_counter[i] = 0;
 		swp->last_primary_fire_sound_stamp[i] = timestamp(0);
 	}
 
 	for ( i = 0; i < MAX_SHIP_SECONDARY_BANKS; i++ ){
-		swp->next_secondary_fire_stamp[i] = timestamp(0);
+		swp->next_secondary_fire_stamp[i] = timestamp_us(0);
 		swp->last_secondary_fire_stamp[i] = -1;
 		swp->burst_counter[i + MAX_SHIP_PRIMARY_BANKS] = 0;
 	}
@@ -9415,6 +9586,7 @@ int ship_create(matrix *orient, vec3d *pos, int ship_type, char *ship_name)
 
 	ship_set_default_weapons(shipp, sip);	//	Moved up here because ship_set requires that weapon info be valid.  MK, 4/28/98
 	ship_set(n, objnum, ship_type);
+	ship_name_index_add(n);
 
 	init_ai_object(objnum);
 	ai_clear_ship_goals( &Ai_info[Ships[n].ai_index] );		// only do this one here.  Can't do it in init_ai because it might wipe out goals in mission file
@@ -10255,11 +10427,11 @@ int ship_fire_primary_debug(object *objp)
 	ship	*shipp = &Ships[objp->instance];
 	vec3d wpos;
 
-	if ( !timestamp_elapsed(shipp->weapons.next_primary_fire_stamp[0]) )
+	if ( !timestamp_us_elapsed(shipp->weapons.next_primary_fire_stamp[0]) )
 		return 0;
 
 	// do timestamp stuff for next firing time
-	shipp->weapons.next_primary_fire_stamp[0] = timestamp(250);
+	shipp->weapons.next_primary_fire_stamp[0] = timestamp_us(250000);
 	shipp->weapons.last_primary_fire_stamp[0] = timestamp();
 
 	//	Debug code!  Make the single laser fire only one bolt and from the object center!
@@ -10775,7 +10947,7 @@ int ship_fire_primary(object * obj, int stream_weapons, int force)
 		}
 
 		// only non-multiplayer clients (single, multi-host) need to do timestamp checking
-		if ( !timestamp_elapsed(swp->next_primary_fire_stamp[bank_to_fire]) ) {
+		if ( !timestamp_us_elapsed(swp->next_primary_fire_stamp[bank_to_fire]) ) {
 			continue;
 		}
 
@@ -10836,11 +11008,11 @@ int ship_fire_primary(object * obj, int stream_weapons, int force)
 		//	know how much time to subtract off.  It could be this fire is "late" because the user didn't want to fire.
 		if ((next_fire_delay > 0.0f)) {
 			if (obj->flags[Object::Object_Flags::Player_ship]) {
-				int	t = timestamp_until(swp->next_primary_fire_stamp[bank_to_fire]);
+				std::int64_t	t = timestamp_us_until(swp->next_primary_fire_stamp[bank_to_fire]);
 				if (t < 0) {
 					float	tx;
 
-					tx = (float) t/-1000.0f;
+					tx = (float) t/-1000000.0f;
 					if (tx > flFrametime/2.0f){
 						tx = 1000.0f * flFrametime * 0.7f;
 					}
@@ -10852,21 +11024,21 @@ int ship_fire_primary(object * obj, int stream_weapons, int force)
 				}
 			}
 
-			swp->next_primary_fire_stamp[bank_to_fire] = timestamp((int)(next_fire_delay));
+			swp->next_primary_fire_stamp[bank_to_fire] = timestamp_us((std::int64_t)(next_fire_delay * 1000.0f));
 			swp->last_primary_fire_stamp[bank_to_fire] = timestamp();
 		}
 
 		if (sip->flags[Ship::Info_Flags::Dyn_primary_linking] ) {
 			Assert(pm->gun_banks[bank_to_fire].num_slots != 0);
-			swp->next_primary_fire_stamp[bank_to_fire] = timestamp((int)(next_fire_delay * ( swp->primary_bank_slot_count[ bank_to_fire ] ) / pm->gun_banks[bank_to_fire].num_slots ) );
+			swp->next_primary_fire_stamp[bank_to_fire] = timestamp_us((std::int64_t)(next_fire_delay * 1000.0f * ( swp->primary_bank_slot_count[ bank_to_fire ] ) / pm->gun_banks[bank_to_fire].num_slots ) );
 			swp->last_primary_fire_stamp[bank_to_fire] = timestamp();
 		} else if (winfo_p->wi_flags[Weapon::Info_Flags::Cycle]) {
 			Assert(pm->gun_banks[bank_to_fire].num_slots != 0);
-			swp->next_primary_fire_stamp[bank_to_fire] = timestamp((int)(next_fire_delay / pm->gun_banks[bank_to_fire].num_slots));
+			swp->next_primary_fire_stamp[bank_to_fire] = timestamp_us((std::int64_t)(next_fire_delay * 1000.0f / pm->gun_banks[bank_to_fire].num_slots));
 			swp->last_primary_fire_stamp[bank_to_fire] = timestamp();
 			//to maintain balance of fighters with more fire points they will fire faster than ships with fewer points
 		}else{
-			swp->next_primary_fire_stamp[bank_to_fire] = timestamp((int)(next_fire_delay));
+			swp->next_primary_fire_stamp[bank_to_fire] = timestamp_us((std::int64_t)(next_fire_delay * 1000.0f));
 			swp->last_primary_fire_stamp[bank_to_fire] = timestamp();
 		}
 		// Here is where we check if weapons subsystem is capable of firing the weapon.
@@ -10931,7 +11103,7 @@ int ship_fire_primary(object * obj, int stream_weapons, int force)
 					t = winfo_p->fire_wait;//doing that time scale thing on enemy fighter is just ugly with beams, especaly ones that have careful timeing
 					swp->burst_counter[bank_to_fire] = 0;
 				}
-				swp->next_primary_fire_stamp[bank_to_fire] = timestamp((int) (t * 1000.0f));
+				swp->next_primary_fire_stamp[bank_to_fire] = timestamp_us((std::int64_t) (t * 1000000.0f));
 				swp->last_primary_fire_stamp[bank_to_fire] = timestamp();
 				beam_fire_info fbfire_info;				
 
@@ -10948,7 +11120,7 @@ int ship_fire_primary(object * obj, int stream_weapons, int force)
 
 				if ( shipp->weapon_energy < points*winfo_p->energy_consumed*flFrametime)
 				{
-					swp->next_primary_fire_stamp[bank_to_fire] = timestamp((int)(next_fire_delay));
+					swp->next_primary_fire_stamp[bank_to_fire] = timestamp_us((std::int64_t)(next_fire_delay * 1000.0f));
 					if ( obj == Player_obj )
 					{
 						ship_maybe_play_primary_fail_sound();
@@ -11029,7 +11201,7 @@ int ship_fire_primary(object * obj, int stream_weapons, int force)
 				if ( (shipp->weapon_energy < points*numtimes * winfo_p->energy_consumed)			//was num_slots
 				 && !force ) {
 
-					swp->next_primary_fire_stamp[bank_to_fire] = timestamp((int)(next_fire_delay));
+					swp->next_primary_fire_stamp[bank_to_fire] = timestamp_us((std::int64_t)(next_fire_delay * 1000.0f));
 					if ( obj == Player_obj )
 					{
 						ship_maybe_play_primary_fail_sound();
@@ -11211,14 +11383,21 @@ int ship_fire_primary(object * obj, int stream_weapons, int force)
 								vm_vec_add2(&total_impulse, &local_impulse);
 							}
 
-							// create the weapon -- the network signature for multiplayer is created inside
-							// of weapon_create							
-							weapon_objnum = weapon_create( &firing_pos, &firing_orient, weapon_idx, OBJ_INDEX(obj), new_group_id,
-								0, 0, swp->primary_bank_fof_cooldown[bank_to_fire] );
-							winfo_p = &Weapon_info[Weapons[Objects[weapon_objnum].instance].weapon_info_index];
-							has_fired = true;
-
-							weapon_set_tracking_info(weapon_objnum, OBJ_INDEX(obj), aip->target_objnum, aip->current_target_is_locked, aip->targeted_subsys);				
+							if (projectile_can_create(weapon_idx)) {
+								// a simple bolt which only becomes a weapon object when it gets close to something
+								projectile_create( &firing_pos, &firing_orient, weapon_idx, OBJ_INDEX(obj), new_group_id,
+									swp->primary_bank_fof_cooldown[bank_to_fire], aip->target_objnum );
+								has_fired = true;
+							} else {
+								// create the weapon -- the network signature for multiplayer is created inside
+								// of weapon_create							
+								weapon_objnum = weapon_create( &firing_pos, &firing_orient, weapon_idx, OBJ_INDEX(obj), new_group_id,
+									0, 0, swp->primary_bank_fof_cooldown[bank_to_fire] );
+								winfo_p = &Weapon_info[Weapons[Objects[weapon_objnum].instance].weapon_info_index];
+								has_fired = true;
+
+								weapon_set_tracking_info(weapon_objnum, OBJ_INDEX(obj), aip->target_objnum, aip->current_target_is_locked, aip->targeted_subsys);				
+							}
 
 							if (winfo_p->wi_flags[Weapon::Info_Flags::Flak])
 							{
@@ -11731,8 +11910,8 @@ int ship_fire_secondary( object *obj, int allow_swarm )
 		//	Solves problem of fire button likely being down next frame and
 		//	firing weapon despite fire causing detonation of existing weapon.
 		if (swp->current_secondary_bank >= 0) {
-			if (timestamp_elapsed(swp->next_secondary_fire_stamp[bank])){
-				swp->next_secondary_fire_stamp[bank] = timestamp(MAX((int) flFrametime*3000, 250));
+			if (timestamp_us_elapsed(swp->next_secondary_fire_stamp[bank])){
+				swp->next_secondary_fire_stamp[bank] = timestamp_us(MAX((int) flFrametime*3000, 250) * 1000);
 			}
 		}
 		return 0;
@@ -11743,9 +11922,9 @@ int ship_fire_secondary( object *obj, int allow_swarm )
 		return 0;
 	}
 
-	if ( !timestamp_elapsed(swp->next_secondary_fire_stamp[bank]) && !allow_swarm) {
-		if (timestamp_until(swp->next_secondary_fire_stamp[bank]) > 60000){
-			swp->next_secondary_fire_stamp[bank] = timestamp(1000);
+	if ( !timestamp_us_elapsed(swp->next_secondary_fire_stamp[bank]) && !allow_swarm) {
+		if (timestamp_us_until(swp->next_secondary_fire_stamp[bank]) > 60000000){
+			swp->next_secondary_fire_stamp[bank] = timestamp_us(1000000);
 		}
 		goto done_secondary;
 	}
@@ -11772,7 +11951,7 @@ int ship_fire_secondary( object *obj, int allow_swarm )
 					}
 
 					snd_play( &Snds[ship_get_sound(Player_obj, SND_OUT_OF_MISSLES)] );
-					swp->next_secondary_fire_stamp[bank] = timestamp(800);	// to avoid repeating messages
+					swp->next_secondary_fire_stamp[bank] = timestamp_us(800000);	// to avoid repeating messages
 					return 0;
 				}
 			} else {
@@ -11795,7 +11974,7 @@ int ship_fire_secondary( object *obj, int allow_swarm )
 				{
 					HUD_sourced_printf(HUD_SOURCE_HIDDEN, NOX("Cannot fire %s if target is not tagged"),wip->name);
 					snd_play( &Snds[ship_get_sound(Player_obj, SND_OUT_OF_MISSLES)] );
-					swp->next_secondary_fire_stamp[bank] = timestamp(800);	// to avoid repeating messages
+					swp->next_secondary_fire_stamp[bank] = timestamp_us(800000);	// to avoid repeating messages
 					return 0;
 				}
 			}
@@ -11841,7 +12020,7 @@ int ship_fire_secondary( object *obj, int allow_swarm )
 		t = Weapon_info[weapon_idx].fire_wait;	// They can fire 5 times a second
 		swp->burst_counter[bank_adjusted] = 0;
 	}
-	swp->next_secondary_fire_stamp[bank] = timestamp((int) (t * 1000.0f));
+	swp->next_secondary_fire_stamp[bank] = timestamp_us((std::int64_t) (t * 1000000.0f));
 	swp->last_secondary_fire_stamp[bank] = timestamp();
 
 	// Here is where we check if weapons subsystem is capable of firing the weapon.
@@ -12102,8 +12281,8 @@ done_secondary:
 		// ensures all "extras" are dealt with, like animations, scripting hooks, etc
 		if (ship_select_next_secondary(obj) ) {			//DTP here we switch to the next valid bank, but we can't call weapon_info on next fire_wait
 
-			if ( timestamp_elapsed(shipp->weapons.next_secondary_fire_stamp[shipp->weapons.current_secondary_bank]) ) {	//DTP, this is simply a copy of the manual cycle functions
-				shipp->weapons.next_secondary_fire_stamp[shipp->weapons.current_secondary_bank] = timestamp(1000);	//Bumped from 250 to 1000 because some people seem to be to triggerhappy :).
+			if ( timestamp_us_elapsed(shipp->weapons.next_secondary_fire_stamp[shipp->weapons.current_secondary_bank]) ) {	//DTP, this is simply a copy of the manual cycle functions
+				shipp->weapons.next_secondary_fire_stamp[shipp->weapons.current_secondary_bank] = timestamp_us(1000000);	//Bumped from 250 to 1000 because some people seem to be to triggerhappy :).
 				shipp->weapons.last_secondary_fire_stamp[shipp->weapons.current_secondary_bank] = timestamp();
 			}
 						
@@ -12516,6 +12695,34 @@ void wing_bash_ship_name(char *ship_name, const char *wing_name, int index)
 /**
  * Return the object index of the ship with name *name.
  */
+/**
+ * Return the index of the wing with name *name among the first Num_wings wings, no matter how many ships it has.
+ */
+static int wing_index_lookup(const char *name)
+{
+	for (int attempt = 0; attempt < 2; attempt++) {
+		// wings are only renamed while they are parsed, before Num_wings counts them
+		if ((Wing_name_index_count != Num_wings) || (attempt > 0)) {
+			Wing_name_index.clear();
+
+			for (int i = 0; i < Num_wings; i++)
+				Wing_name_index.emplace(string_intern::intern(Wings[i].name), i);
+
+			Wing_name_index_count = Num_wings;
+		}
+
+		auto iter = Wing_name_index.find(string_intern::find(name));
+
+		if (iter == Wing_name_index.end())
+			return -1;
+
+		if (!stricmp(Wings[iter->second].name, name))
+			return iter->second;
+	}
+
+	return -1;
+}
+
 int wing_name_lookup(const char *name, int ignore_count)
 {
 	int i, wing_limit;
@@ -12523,6 +12730,18 @@ int wing_name_lookup(const char *name, int ignore_count)
 	if (name == NULL)
 		return -1;
 
+	if ( !Fred_running ) {
+		i = wing_index_lookup(name);
+
+		if (i < 0)
+			return -1;
+
+		if (ignore_count ? Wings[i].wave_count : Wings[i].current_count)
+			return i;
+
+		return -1;
+	}
+
 	if ( Fred_running )
 		wing_limit = MAX_WINGS;
 	else
@@ -12549,6 +12768,9 @@ int wing_name_lookup(const char *name, int ignore_count)
 int wing_lookup(const char *name)
 {
    int idx;
+
+	if ( !Fred_running )
+		return wing_index_lookup(name);
 	for(idx=0;idx<Num_wings;idx++)
 		if(stricmp(Wings[idx].name,name)==0)
 		   return idx;
@@ -12561,9 +12783,20 @@ int wing_lookup(const char *name)
  */
 int ship_info_lookup_sub(const char *token)
 {
-	for (auto it = Ship_info.cbegin(); it != Ship_info.cend(); ++it)
-		if (!stricmp(token, it->name))
-			return (int)std::distance(Ship_info.cbegin(), it);
+	// classes are added and renamed while the tables are parsed, so a class from the index is checked and a class
+	// which isn't in there is still searched for
+	auto iter = Ship_info_name_index.find(string_intern::find(token));
+
+	if ((iter != Ship_info_name_index.end()) && (iter->second < (int)Ship_info.size()) && !stricmp(token, Ship_info[iter->second].name))
+		return iter->second;
+
+	for (auto it = Ship_info.cbegin(); it != Ship_info.cend(); ++it) {
+		if (!stricmp(token, it->name)) {
+			auto idx = (int)std::distance(Ship_info.cbegin(), it);
+			Ship_info_name_index[string_intern::intern(token)] = idx;
+			return idx;
+		}
+	}
 
 	return -1;
 }
@@ -12707,6 +12940,49 @@ int ship_info_lookup(const char *token)
 	return ship_info_lookup_sub(name);
 }
 
+/**
+ * Adds a ship to the name lookup, call when it got its object and whenever its name changed.
+ */
+void ship_name_index_add(int shipnum)
+{
+	Assert((shipnum >= 0) && (shipnum < MAX_SHIPS));
+	Assert(Ships[shipnum].objnum >= 0);
+
+	auto result = Ship_name_index.emplace(string_intern::intern(Ships[shipnum].ship_name), shipnum);
+
+	if (!result.second) {
+		// of two ships with the same name the linear search always found the one in the lower slot
+		int other = result.first->second;
+		if ((other == shipnum) || (Ships[other].objnum < 0) || stricmp(Ships[other].ship_name, Ships[shipnum].ship_name) || (shipnum < other)) {
+			result.first->second = shipnum;
+		}
+	}
+}
+
+/**
+ * Removes a ship from the name lookup, call before its object is deleted and before its name changes.
+ */
+void ship_name_index_remove(int shipnum)
+{
+	Assert((shipnum >= 0) && (shipnum < MAX_SHIPS));
+
+	auto iter = Ship_name_index.find(string_intern::find(Ships[shipnum].ship_name));
+
+	if ((iter == Ship_name_index.end()) || (iter->second != shipnum)) {
+		return;
+	}
+
+	Ship_name_index.erase(iter);
+
+	// another ship with the same name takes over
+	for (int i = 0; i < MAX_SHIPS; i++) {
+		if ((i != shipnum) && (Ships[i].objnum >= 0) && !stricmp(Ships[i].ship_name, Ships[shipnum].ship_name)) {
+			Ship_name_index.emplace(string_intern::intern(Ships[i].ship_name), i);
+			break;
+		}
+	}
+}
+
 /**
  * Return the ship index of the ship with name *name.
  */
@@ -12719,6 +12995,25 @@ int ship_name_lookup(const char *name, int inc_players)
 		return -1;
 	}
 
+	// FRED renames ships all over the place so it always searches
+	if (!Fred_running) {
+		auto iter = Ship_name_index.find(string_intern::find(name));
+
+		if (iter == Ship_name_index.end()) {
+			return -1;
+		}
+
+		i = iter->second;
+
+		if ((Ships[i].objnum >= 0) && !stricmp(name, Ships[i].ship_name)) {
+			if (Objects[Ships[i].objnum].type == OBJ_SHIP || (Objects[Ships[i].objnum].type == OBJ_START && inc_players)) {
+				return i;
+			}
+		}
+
+		// a player start without inc_players, or a rename which didn't update the index, falls back to the search
+	}
+
 	for (i=0; i<MAX_SHIPS; i++){
 		if (Ships[i].objnum >= 0){
 			if (Objects[Ships[i].objnum].type == OBJ_SHIP || (Objects[Ships[i].objnum].type == OBJ_START && inc_players)){
@@ -12900,7 +13195,7 @@ void ship_model_update_instance(object *objp)
 	model_clear_submodel_instances(model_instance_num);
 
 	// Handle subsystem rotations for this ship
-	for ( pss = GET_FIRST(&shipp->subsys_list); pss != END_OF_LIST(&shipp->subsys_list); pss = GET_NEXT(pss) ) {
+	for ( pss = shipp->subsys_array; pss < shipp->subsys_array + shipp->num_subsys; pss++ ) {
 		psub = pss->system_info;
 		switch (psub->type) {
 			case SUBSYSTEM_RADAR:
@@ -13099,7 +13394,7 @@ ship_subsys *ship_get_best_subsys_to_attack(ship *sp, int subsys_type, vec3d *at
 	lowest_in_sight_attackers = lowest_num_attackers = 1000;
 	ss_return = best_in_sight_subsys = lowest_attacker_subsys = NULL;
 
-	for (ss = GET_FIRST(&sp->subsys_list); ss != END_OF_LIST(&sp->subsys_list); ss = GET_NEXT(ss) ) {
+	for ( ss = sp->subsys_array; ss < sp->subsys_array + sp->num_subsys; ss++ ) {
 		if ( (ss->system_info->type == subsys_type) && (ss->current_hits > 0) ) {
 
 			// get world pos of subsystem
@@ -13152,7 +13447,6 @@ ship_subsys *ship_get_best_subsys_to_attack(ship *sp, int subsys_type, vec3d *at
 //							and based on the number of ships already attacking the subsystem
 ship_subsys *ship_get_indexed_subsys( ship *sp, int index, vec3d *attacker_pos )
 {
-	int count;
 	ship_subsys *ss;
 
 	// first, special code to see if the index < 0.  If so, we are looking for one of several possible
@@ -13183,14 +13477,9 @@ ship_subsys *ship_get_indexed_subsys( ship *sp, int index, vec3d *attacker_pos )
 	}
 
 
-	count = 0;
-	ss = GET_FIRST(&sp->subsys_list);
-	while ( ss != END_OF_LIST( &sp->subsys_list ) ) {
-		if ( count == index )
-			return ss;
-		count++;
-		ss = GET_NEXT( ss );
-	}
+	// the subsystems are stored in the order of the list
+	if ( (index >= 0) && (index < sp->num_subsys) )
+		return &sp->subsys_array[index];
 
 	// get allender -- turret ref didn't fixup correctly!!!!
 	Warning(LOCATION, "In ship_get_indexed_subsys, unable to get a subsystem of index %d on ship %s, due to a broken subsystem reference!  This is most likely due to a table/model mismatch.", index, sp->ship_name);	
@@ -13205,7 +13494,6 @@ int ship_get_index_from_subsys(ship_subsys *ssp, int objnum, int error_bypass)
 	if (ssp == NULL)
 		return -1;
 	else {
-		int	count;
 		ship	*shipp;
 		ship_subsys	*ss;
 
@@ -13214,13 +13502,10 @@ int ship_get_index_from_subsys(ship_subsys *ssp, int objnum, int error_bypass)
 
 		shipp = &Ships[Objects[objnum].instance];
 
-		count = 0;
-		ss = GET_FIRST(&shipp->subsys_list);
-		while ( ss != END_OF_LIST( &shipp->subsys_list ) ) {
+		// the subsystems are stored in the order of the list
+		for ( ss = shipp->subsys_array; ss < shipp->subsys_array + shipp->num_subsys; ss++ ) {
 			if ( ss == ssp)
-				return count;
-			count++;
-			ss = GET_NEXT( ss );
+				return (int)(ss - shipp->subsys_array);
 		}
 		if ( !error_bypass )
 			Int3();			// get allender -- turret ref didn't fixup correctly!!!!
@@ -13985,6 +14270,7 @@ void ship_close()
 
 	// free info from parsed table data
 	Ship_info.clear();
+	Ship_info_name_index.clear();
 
 	for (i = 0; i < (int)Ship_types.size(); i++) {
 		Ship_types[i].ai_actively_pursues.clear();
@@ -14788,7 +15074,7 @@ ship_subsys *ship_get_closest_subsys_in_sight(ship *sp, int subsys_type, vec3d *
 	closest_in_sight_subsys = NULL;
 	closest_dist = FLT_MAX;
 
-	for (ss = GET_FIRST(&sp->subsys_list); ss != END_OF_LIST(&sp->subsys_list); ss = GET_NEXT(ss) ) {
+	for ( ss = sp->subsys_array; ss < sp->subsys_array + sp->num_subsys; ss++ ) {
 		if ( (ss->system_info->type == subsys_type) && (ss->current_hits > 0) ) {
 
 			// get world pos of subsystem
@@ -16239,7 +16525,7 @@ void ship_page_in()
 
 	// pre-allocate the subsystems, this really only needs to happen for ships
 	// which don't exist yet (ie, ships NOT in Ships[])
-	if (!ship_allocate_subsystems(num_subsystems_needed, true)) {
+	if (!ship_allocate_subsystems(num_subsystems_needed)) {
 		Error(LOCATION, "Attempt to page in new subsystems subsystems failed, which shouldn't be possible anymore. Currently allocated %d subsystems (%d in use)", Num_ship_subsystems_allocated, Num_ship_subsystems); 
 	}
 
@@ -16251,6 +16537,9 @@ void ship_page_in()
 
 	memset( fireball_used, 0, sizeof(int) * MAX_FIREBALL_TYPES );
 
+	// the models which aren't loaded yet are processed by the job workers while the loop continues
+	model_begin_batch_load();
+
 	i = 0;
 	for (auto sip = Ship_info.begin(); sip != Ship_info.end(); i++, ++sip) {
 		if ( !ship_class_used[i] )
@@ -16376,6 +16665,8 @@ void ship_page_in()
 		}
 	}
 
+	model_end_batch_load();
+
 	nprintf(( "Paging", "There are %d ship classes used in this mission.\n", num_ship_types_used ));
 
 
@@ -17374,11 +17665,9 @@ void ship_do_submodel_rotation(ship *shipp, model_subsystem *psub, ship_subsys *
 		return;
 	}
 
+	// triggered rotations are advanced all at once by model_anim_process_triggered_rotations()
 	if (psub->flags[Model::Subsystem_Flags::Triggered] && pss->triggered_rotation_index >= 0) {
-		Triggered_rotations[pss->triggered_rotation_index].process_queue();
-		model_anim_submodel_trigger_rotate(psub, pss );
 		return;
-	
 	}
 
 	// check for rotating artillery
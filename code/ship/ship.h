@@ -108,9 +108,9 @@ public:
 	int previous_primary_bank;
 	int previous_secondary_bank;		// currently selected secondary bank
 
-	int next_primary_fire_stamp[MAX_SHIP_PRIMARY_BANKS];			// next time this primary bank can fire
+	std::int64_t next_primary_fire_stamp[MAX_SHIP_PRIMARY_BANKS];	// next time this primary bank can fire, see timestamp_us()
 	int last_primary_fire_stamp[MAX_SHIP_PRIMARY_BANKS];			// last time this primary bank fired (mostly used by SEXPs)
-	int next_secondary_fire_stamp[MAX_SHIP_SECONDARY_BANKS];		// next time this secondary bank can fire
+	std::int64_t next_secondary_fire_stamp[MAX_SHIP_SECONDARY_BANKS];	// next time this secondary bank can fire, see timestamp_us()
 	int last_secondary_fire_stamp[MAX_SHIP_SECONDARY_BANKS];		// last time this secondary bank fired (mostly used by SEXPs)
 	int next_tertiary_fire_stamp;
 	int last_primary_fire_sound_stamp[MAX_SHIP_PRIMARY_BANKS];		// trailing end of the last time this primary bank was fired, for purposes of timing the pre-launch sound
@@ -270,6 +270,13 @@ typedef struct cockpit_display {
 	int offset[2];
 	int size[2];
 	char name[MAX_FILENAME_LEN];
+
+	// reduced rate updates, see ship_cockpit_display_needs_update()
+	int refresh_interval;			// milliseconds between two updates, 0 to update every frame
+	int next_refresh;				// timestamp of the next update
+	bool dirty;						// has to be drawn again at the next update even if the content looks the same
+	bool shared_target;				// another display draws to the same texture, so neither can keep what it drew
+	std::uint64_t content_version;	// the version of the content the texture was drawn with, 0 if unknown
 } cockpit_display;
 
 extern SCP_vector<cockpit_display> Player_displays;
@@ -281,11 +288,15 @@ typedef struct cockpit_display_info {
 	char bg_filename[MAX_FILENAME_LEN];
 	int offset[2];
 	int size[2];
+	int refresh_rate;	// updates per second, 0 to update every frame
 } cockpit_display_info;
 
 // structure definition for a linked list of subsystems for a ship.  Each subsystem has a pointer
 // to the static data for the subsystem.  The obj_subsystem data is defined and read in the model
 // code.  Other dynamic data (such as current_hits) should remain in this structure.
+//
+// The subsystems of a ship are stored one after the other, see ship::subsys_array. The fields which are
+// looked at whenever all subsystems of a ship are walked come first so they share the first cache line.
 class ship_subsys
 {
 public:
@@ -294,7 +305,6 @@ public:
 
 	int			parent_objnum;						// objnum of the parent ship
 
-	char		sub_name[NAME_LENGTH];					//WMC - Name that overrides name of original
 	float		current_hits;							// current number of hits this subsystem has left.
 	float		max_hits;
 
@@ -303,6 +313,14 @@ public:
 	int subsys_guardian_threshold;	// Goober5000
 	int armor_type_idx;				// FUBAR
 
+	int disruption_timestamp;							// time at which subsystem isn't disrupted
+
+	// awacs info
+	float		awacs_intensity;
+	float		awacs_radius;
+
+	char		sub_name[NAME_LENGTH];					//WMC - Name that overrides name of original
+
 	// turret info
 	//Important -WMC
 	//With the new turret code, indexes run from 0 to MAX_SHIP_WEAPONS; a value of MAX_SHIP_PRIMARY_WEAPONS
@@ -334,10 +352,6 @@ public:
 	int		turret_swarm_info_index[MAX_TFP];	
 	int		turret_swarm_num;	
 
-	// awacs info
-	float		awacs_intensity;
-	float		awacs_radius;
-
 	ship_weapon	weapons;
 
 	// Data the renderer needs for ship instance specific data, like
@@ -347,8 +361,6 @@ public:
 	submodel_instance_info	submodel_info_1;		// Instance data for main turret or main object
 	submodel_instance_info	submodel_info_2;		// Instance data for turret guns, if there is one
 
-	int disruption_timestamp;							// time at which subsystem isn't disrupted
-
 	int subsys_cargo_name;			// cap ship cargo on subsys
 	fix time_subsys_cargo_revealed;	// added by Goober5000
 
@@ -520,6 +532,8 @@ public:
 	// types of subsystems.  (i.e. the list might contain 3 engines.  There will be one subsys_info entry
 	// describing the state of all engines combined) -- MWA 4/1/97
 	ship_subsys	subsys_list;									//	linked list of subsystems for this ship.
+	ship_subsys	*subsys_array;									//	the same subsystems in the order of the list, one after the other
+	int			num_subsys;										//	number of subsystems in subsys_array
 	ship_subsys	*last_targeted_subobject[MAX_PLAYERS];	// Last subobject that has been targeted.  NULL if none;(player specific)
 	ship_subsys_info	subsys_info[SUBSYSTEM_MAX];		// info on particular generic types of subsystems	
 
@@ -587,7 +601,6 @@ public:
 	int	persona_index;						// which persona is this guy.
 
 	int	subsys_disrupted_flags;					// bitflags used to check if SUBYSTEM_* is disrupted or not
-	int	subsys_disrupted_check_timestamp;	// timer to control how oftern flags are set/cleared in subsys_disrupted_flags
 
 	uint	create_time;						// time ship was created, set by gettime()
 
@@ -1438,6 +1451,8 @@ void parse_ship_particle_effect(ship_info* sip, particle_effect* pe, char *id_st
 
 extern int ship_info_lookup(const char *name = NULL);
 extern int ship_name_lookup(const char *name, int inc_players = 0);	// returns the index into Ship array of name
+extern void ship_name_index_add(int shipnum);		// call when a ship got its object or a new name
+extern void ship_name_index_remove(int shipnum);	// call before a ship loses its object or its name changes
 extern int ship_type_name_lookup(const char *name);
 
 extern int wing_lookup(const char *name);
@@ -1745,6 +1760,23 @@ void ship_add_cockpit_display(cockpit_display_info *display, int cockpit_model_n
 void ship_set_hud_cockpit_targets();
 void ship_clear_cockpit_displays();
 int ship_start_render_cockpit_display(size_t cockpit_display_num);
+
+/**
+ * @brief Checks if a cockpit display has to be drawn in this frame
+ *
+ * Displays with a refresh rate are only drawn when the interval of the rate is over and then only if they are dirty or
+ * their content changed. While a display isn't drawn its texture keeps what was drawn last.
+ *
+ * @param cockpit_display_num The display
+ * @param content_version The version of what would be drawn on the display, 0 if it isn't known
+ * @return @c true if the display should be drawn now, the next update is then scheduled
+ */
+bool ship_cockpit_display_needs_update(size_t cockpit_display_num, std::uint64_t content_version = 0);
+
+/**
+ * @brief Makes a cockpit display draw its content again at its next update
+ */
+void ship_invalidate_cockpit_display(size_t cockpit_display_num);
 void ship_end_render_cockpit_display(size_t cockpit_display_num);
 
 //WMC - Warptype stuff
@@ -71,6 +71,42 @@ vec3d	Original_vec_to_deader;
 
 static bool global_damage = false;
 
+// the world positions of the subsystems of a ship, kept for all the hits it takes in a frame
+typedef struct subsys_pos_cache {
+	int frame;
+	int signature;
+	vec3d ship_pos;
+	matrix ship_orient;
+	SCP_vector<vec3d> positions;		// in the order of ship::subsys_array
+} subsys_pos_cache;
+
+static subsys_pos_cache Subsys_pos_cache[MAX_SHIPS];
+
+/**
+ * The world positions of all subsystems of a ship, worked out once per frame unless the ship moved in between.
+ * Explosions and streams of fire hit the same ships many times in a frame.
+ */
+static const vec3d *shiphit_get_subsys_positions(object *ship_objp)
+{
+	ship *shipp = &Ships[ship_objp->instance];
+	subsys_pos_cache *cache = &Subsys_pos_cache[ship_objp->instance];
+
+	if ( (cache->frame != Framecount) || (cache->signature != ship_objp->signature) || (cache->positions.size() != (size_t)shipp->num_subsys)
+		|| !vm_vec_same(&cache->ship_pos, &ship_objp->pos) || !vm_matrix_same(&cache->ship_orient, &ship_objp->orient) ) {
+		cache->frame = Framecount;
+		cache->signature = ship_objp->signature;
+		cache->ship_pos = ship_objp->pos;
+		cache->ship_orient = ship_objp->orient;
+
+		cache->positions.resize(shipp->num_subsys);
+		for (int i = 0; i < shipp->num_subsys; i++) {
+			get_subsystem_world_pos(ship_objp, &shipp->subsys_array[i], &cache->positions[i]);
+		}
+	}
+
+	return cache->positions.data();
+}
+
 //WMC - Camera rough draft stuff
 /*
 camid dead_get_camera()
@@ -91,7 +127,7 @@ bool is_subsys_destroyed(ship *shipp, int submodel)
 		return false;
 	}
 
-	for ( subsys=GET_FIRST(&shipp->subsys_list); subsys != END_OF_LIST(&shipp->subsys_list); subsys = GET_NEXT(subsys) ) {
+	for ( subsys = shipp->subsys_array; subsys < shipp->subsys_array + shipp->num_subsys; subsys++ ) {
 		if (subsys->system_info->subobj_num == submodel) {
 			if (subsys->current_hits > 0.0f) {
 				return false;
@@ -195,7 +231,7 @@ void do_subobj_destroyed_stuff( ship *ship_p, ship_subsys *subsys, vec3d* hitpos
 		ship_subsys *ssp;
 
 		hits = 0.0f;
-		for ( ssp=GET_FIRST(&ship_p->subsys_list); ssp != END_OF_LIST(&ship_p->subsys_list); ssp = GET_NEXT(ssp) ) {
+		for ( ssp = ship_p->subsys_array; ssp < ship_p->subsys_array + ship_p->num_subsys; ssp++ ) {
 			// type matches?
 			if ( (ssp->system_info->type == type) && !(ssp->flags[Ship::Subsystem_Flags::No_aggregate]) ) {
 				hits += ssp->current_hits;
@@ -517,10 +553,12 @@ float do_subobj_hit_stuff(object *ship_objp, object *other_obj, vec3d *hitpos, i
 		create_subsys_debris(ship_objp, hitpos);
 	}
 
+	const vec3d *subsys_positions = shiphit_get_subsys_positions(ship_objp);
+
 	//	First, create a list of the N subsystems within range.
 	//	Then, one at a time, process them in order.
 	int	count = 0;
-	for ( subsys=GET_FIRST(&ship_p->subsys_list); subsys != END_OF_LIST(&ship_p->subsys_list); subsys = GET_NEXT(subsys) )
+	for ( subsys = ship_p->subsys_array; subsys < ship_p->subsys_array + ship_p->num_subsys; subsys++ )
 	{
 		model_subsystem *mss = subsys->system_info;
 
@@ -561,7 +599,7 @@ float do_subobj_hit_stuff(object *ship_objp, object *other_obj, vec3d *hitpos, i
 			} else {
 				// Default behavior:
 				// get the distance between the hit and the subsystem center
-				get_subsystem_world_pos(ship_objp, subsys, &g_subobj_pos);
+				g_subobj_pos = subsys_positions[subsys - ship_p->subsys_array];
 				dist = vm_vec_dist_quick(&hitpos2, &g_subobj_pos);
 
 				range = subsys_get_range(other_obj, subsys);
@@ -1866,9 +1904,11 @@ int maybe_shockwave_damage_adjust(object *ship_objp, object *other_obj, float *d
 
 	shipp = &Ships[ship_objp->instance];
 
+	const vec3d *subsys_positions = shiphit_get_subsys_positions(ship_objp);
+
 	// find closest subsystem distance to shockwave origin
-	for (subsys=GET_FIRST(&shipp->subsys_list); subsys != END_OF_LIST(&shipp->subsys_list); subsys = GET_NEXT(subsys) ) {
-		get_subsystem_world_pos(ship_objp, subsys, &g_subobj_pos);
+	for ( subsys = shipp->subsys_array; subsys < shipp->subsys_array + shipp->num_subsys; subsys++ ) {
+		g_subobj_pos = subsys_positions[subsys - shipp->subsys_array];
 		dist = vm_vec_dist_quick(&g_subobj_pos, &other_obj->pos);
 
 		if (dist < nearest_dist) {
@@ -1945,7 +1985,7 @@ static void ship_do_damage(object *ship_objp, object *other_obj, vec3d *hitpos,
 	{
 		other_obj_is_weapon = ((other_obj->type == OBJ_WEAPON) && (other_obj->instance >= 0) && (other_obj->instance < MAX_WEAPONS));
 		other_obj_is_beam = ((other_obj->type == OBJ_BEAM) && (other_obj->instance >= 0) && (other_obj->instance < MAX_BEAMS));
-		other_obj_is_shockwave = ((other_obj->type == OBJ_SHOCKWAVE) && (other_obj->instance >= 0) && (other_obj->instance < MAX_SHOCKWAVES));
+		other_obj_is_shockwave = ((other_obj->type == OBJ_SHOCKWAVE) && (other_obj->instance >= 0) && (other_obj->instance < shockwave_get_num_slots()));
 		other_obj_is_asteroid = ((other_obj->type == OBJ_ASTEROID) && (other_obj->instance >= 0) && (other_obj->instance < MAX_ASTEROIDS));
 		other_obj_is_debris = ((other_obj->type == OBJ_DEBRIS) && (other_obj->instance >= 0) && (other_obj->instance < MAX_DEBRIS_PIECES));
 		other_obj_is_ship = ((other_obj->type == OBJ_SHIP) && (other_obj->instance >= 0) && (other_obj->instance < MAX_SHIPS));
@@ -19,6 +19,12 @@
 #include "sound/sound.h"
 
 #include "libs/ffmpeg/FFmpegContext.h"
+#include "utils/spsc_queue.h"
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
 
 
 #define MAX_STREAM_BUFFERS 4
@@ -34,7 +40,30 @@ ubyte *Wavedata_service_buffer = NULL;	// buffer used for servicing audiostreams
 
 SDL_mutex* Global_service_lock;
 
-typedef bool (*TIMERCALLBACK)(ptr_u);
+// The streams are decoded and their buffers refilled on the audio thread. The game thread only queues what it wants
+// the streams to do so a long frame doesn't leave the music without data.
+#define AUDIOSTREAM_QUEUE_SIZE		256		// commands from the game thread
+#define AUDIOSTREAM_THREAD_WAIT_MS	10		// how long the audio thread sleeps before it looks at the commands again
+
+enum class stream_command_type {
+	Play,
+	Stop,
+	Stop_and_rewind,
+	Set_volume,
+	Set_sample_cutoff,
+	Close
+};
+
+struct stream_command {
+	stream_command_type type;
+	int stream;
+	float volume;
+	int arg;		// looping for Play, paused for Stop, the cutoff or fade for Close
+};
+
+static std::thread Audiostream_thread;
+static std::atomic<bool> Audiostream_thread_running(false);
+static std::unique_ptr<spsc_queue<stream_command>> Audiostream_commands;	// game thread -> audio thread
 
 #define COMPRESSED_BUFFER_SIZE	176400
 ubyte *Compressed_buffer = NULL;				// Used to load in compressed data during a cueing interval
@@ -47,21 +76,6 @@ const int NUM_AUDIO_EXT = sizeof(audio_ext_list) / sizeof(char*);
 
 int Audiostream_inited = 0;
 
-class Timer
-{
-public:
-    void constructor(void);
-    void destructor(void);
-    bool Create (uint nPeriod, uint nRes, ptr_u dwUser, TIMERCALLBACK pfnCallback);
-protected:
-    static uint TimeProc(uint interval, void *param);
-    TIMERCALLBACK m_pfnCallback;
-    ptr_u m_dwUser;
-    uint m_nPeriod;
-    uint m_nRes;
-    SDL_TimerID m_nIDTimer;
-};
-
 class AudioStream
 {
 public:
@@ -70,8 +84,8 @@ public:
 	bool Create (char *pszFilename);
 	bool Destroy (void);
 	void Play (float volume, int looping);
-	bool Is_Playing(){ return m_fPlaying; }
-	bool Is_Paused(){ return m_bIsPaused; }
+	bool Is_Playing(){ return commands_in_flight.load(std::memory_order_acquire) > 0 ? queued.playing : m_fPlaying; }
+	bool Is_Paused(){ return commands_in_flight.load(std::memory_order_acquire) > 0 ? queued.paused : m_bIsPaused; }
 	bool Is_Past_Limit() { return m_bPastLimit; }
 	void Stop (int paused = 0);
 	void Stop_and_Rewind (void);
@@ -84,23 +98,35 @@ public:
 	void	Set_Default_Volume(float vol) { m_lDefaultVolume = vol; }
 	float	Get_Default_Volume() { return m_lDefaultVolume; }
 	uint	Get_Samples_Committed(void);
-	int	Is_looping() { return m_bLooping; }
+	int	Is_looping() { return commands_in_flight.load(std::memory_order_acquire) > 0 ? queued.looping : m_bLooping; }
+	float	Get_Queued_Volume() { return commands_in_flight.load(std::memory_order_acquire) > 0 ? queued.volume : m_lVolume; }
+	void	Queue_Command(const stream_command& cmd);
+	void	Run_Command(const stream_command& cmd);
+	void	Maybe_Service(uint now);
 	int	status;
 	int	type;
 	bool paused_via_sexp_or_script;
 
+	// What the stream does once the audio thread ran the commands which are queued for it, the game thread sees this
+	// instead of the real state until then. Only used by the game thread.
+	struct {
+		bool playing;
+		bool paused;
+		bool looping;
+		float volume;
+	} queued;
+	std::atomic<int> commands_in_flight;
+
 protected:
 	void Cue (void);
 	bool WriteWaveData (uint cbSize, uint *num_bytes_written, int service = 1);
 	uint GetMaxWriteSize (void);
 	bool ServiceBuffer (void);
-	static bool TimerCallback (ptr_u dwUser);
 	bool PlaybackDone(void);
 
 	ALuint m_source_id;	// name of openAL source
 	ALuint m_buffer_ids[MAX_STREAM_BUFFERS];	// names of buffers
 
-	Timer m_timer;			// ptr to Timer object
 	std::unique_ptr<ffmpeg::WaveFile> m_pwavefile;	// ptr to WaveFile object
 	bool m_fCued;			// semaphore (stream cued)
 	bool m_fPlaying;		// semaphore (stream playing)
@@ -108,6 +134,7 @@ protected:
 	uint m_cbBufSize;		// size of sound buffer in bytes
 	uint m_nBufService;		// service interval in msec
 	uint m_nTimeStarted;	// time (in system time) playback started
+	uint m_nNextService;	// time (in system time) the buffers are refilled next
 
 	bool	m_bLooping;				// whether or not to loop playback
 	bool	m_bFade;				// fade out music 
@@ -128,71 +155,6 @@ protected:
 };
 
 
-// Timer class implementation
-//
-////////////////////////////////////////////////////////////
-
-// constructor
-void Timer::constructor(void)
-{
-	m_nIDTimer = 0;
-}
-
-
-// Destructor
-void Timer::destructor(void)
-{
-	if (m_nIDTimer) {
-		SDL_RemoveTimer(m_nIDTimer);
-		m_nIDTimer = 0;
-	}
-}
-
-// Create
-bool Timer::Create (uint nPeriod, uint nRes, ptr_u dwUser, TIMERCALLBACK pfnCallback)
-{
-	bool bRtn = true;    // assume success
-
-	Assert(pfnCallback);
-	Assert(nPeriod > 10);
-	Assert(nPeriod >= nRes);
-
-	m_nPeriod = nPeriod;
-	m_nRes = nRes;
-	m_dwUser = dwUser;
-	m_pfnCallback = pfnCallback;
-
-	if ((m_nIDTimer = SDL_AddTimer(m_nPeriod, TimeProc, (void*)this)) == 0) {
-	  bRtn = false;
-	}
-
-	return (bRtn);
-}
-
-
-// Timer proc for multimedia timer callback set with timeSetTime().
-//
-// Calls procedure specified when Timer object was created. The 
-// dwUser parameter contains "this" pointer for associated Timer object.
-// 
-uint Timer::TimeProc(uint interval, void *dwUser)
-{
-    // dwUser contains ptr to Timer object
-	Timer * ptimer = (Timer *) dwUser;
-
-    // Call user-specified callback and pass back user specified data
-    (ptimer->m_pfnCallback) (ptimer->m_dwUser);
-
-    if (ptimer->m_nPeriod) {
-		return interval;
-    } else {
-		SDL_RemoveTimer(ptimer->m_nIDTimer);
-		ptimer->m_nIDTimer = 0;
-		return 0;
-    }
-}
-
-//
 // AudioStream class implementation
 //
 ////////////////////////////////////////////////////////////
@@ -201,7 +163,7 @@ uint Timer::TimeProc(uint interval, void *dwUser)
 const ushort DefBufferServiceInterval = 250;  // default buffer service interval in msec
 
 // Constructor
-AudioStream::AudioStream (void) : m_total_uncompressed_bytes_read(0), m_max_uncompressed_bytes_to_read(0)
+AudioStream::AudioStream (void) : commands_in_flight(0), m_total_uncompressed_bytes_read(0), m_max_uncompressed_bytes_to_read(0)
 {
 	write_lock = SDL_CreateMutex();
 }
@@ -232,6 +194,12 @@ void AudioStream::Init_Data ()
 	m_cbBufSize = 0;
 	m_nBufService = DefBufferServiceInterval;
 	m_nTimeStarted = 0;
+	m_nNextService = 0;
+
+	queued.playing = false;
+	queued.paused = false;
+	queued.looping = false;
+	queued.volume = 1.0f;
 
 	memset(m_buffer_ids, 0, sizeof(m_buffer_ids));
 	m_source_id = 0;
@@ -247,12 +215,16 @@ bool AudioStream::Create (char *pszFilename)
 
 	Assert(pszFilename);
 
+	SDL_LockMutex(write_lock);
+
 	Init_Data();
 
 	if (pszFilename) {
 		// make 100% sure we got a good filename
-		if ( !strlen(pszFilename) )
+		if ( !strlen(pszFilename) ) {
+			SDL_UnlockMutex(write_lock);
 			return false;
+		}
 
 		// Create a new WaveFile object
 		m_pwavefile.reset(new ffmpeg::WaveFile());
@@ -320,6 +292,8 @@ ErrorExit:
 		m_pwavefile = nullptr;
 	}
 
+	SDL_UnlockMutex(write_lock);
+
 	return (fRtn);
 }
 
@@ -377,10 +351,9 @@ bool AudioStream::WriteWaveData (uint size, uint *num_bytes_written, int service
 		return fRtn;
 	}
 
-	if ( service ) {
-		SDL_LockMutex(Global_service_lock);
-	}
-		    
+	// a stream is cued on the game thread when it's opened while the audio thread services the others
+	SDL_LockMutex(Global_service_lock);
+
 	if ( service ) {
 		uncompressed_wave_data = Wavedata_service_buffer;
 	} else {
@@ -428,9 +401,7 @@ bool AudioStream::WriteWaveData (uint size, uint *num_bytes_written, int service
 ErrorExit:
 	m_total_uncompressed_bytes_read += *num_bytes_written;
 
-	if ( service ) {
-		SDL_UnlockMutex(Global_service_lock);
-	}
+	SDL_UnlockMutex(Global_service_lock);
     
 	return (fRtn);
 }
@@ -468,7 +439,7 @@ bool AudioStream::ServiceBuffer (void)
 	SDL_LockMutex( write_lock );
 
 	// status may have changed, so lets check once again
-	if ( status != ASF_USED ){
+	if ( (status != ASF_USED) || !m_fPlaying ){
 		SDL_UnlockMutex( write_lock );
 
 		return false;
@@ -632,10 +603,8 @@ void AudioStream::Play (float volume, int looping)
 		m_nTimeStarted = timer_get_milliseconds();
 		Set_Volume(volume);
 
-		// Kick off timer to service buffer
-		m_timer.constructor();
-
-		m_timer.Create (m_nBufService, m_nBufService, ptr_u (this), TimerCallback);
+		// the audio thread services the buffer from now on
+		m_nNextService = m_nTimeStarted + m_nBufService;
 
 		// Playback begun, no longer cued
 		m_fPlaying = true;
@@ -643,13 +612,115 @@ void AudioStream::Play (float volume, int looping)
 	}
 }
 
-// Timer callback for Timer object created by ::Play method.
-bool AudioStream::TimerCallback (ptr_u dwUser)
+// Queue_Command
+//
+// Hands a command to the audio thread, only called by the game thread.
+void AudioStream::Queue_Command(const stream_command& cmd)
 {
-    // dwUser contains ptr to AudioStream object
-    AudioStream * pas = (AudioStream *) dwUser;
+	// nothing is in flight so the game thread has to start from where the audio thread left the stream
+	if ( commands_in_flight.load(std::memory_order_acquire) == 0 ) {
+		queued.playing = m_fPlaying;
+		queued.paused = m_bIsPaused;
+		queued.looping = m_bLooping;
+		queued.volume = m_lVolume;
+	}
+
+	switch (cmd.type) {
+		case stream_command_type::Play:
+			queued.playing = true;
+			queued.paused = false;
+			queued.looping = (cmd.arg != 0);
+			queued.volume = cmd.volume;
+			break;
 
-    return (pas->ServiceBuffer ());
+		case stream_command_type::Stop:
+			if ( queued.playing ) {
+				queued.playing = false;
+				queued.paused = (cmd.arg != 0);
+			}
+			break;
+
+		case stream_command_type::Stop_and_rewind:
+		case stream_command_type::Close:
+			queued.playing = false;
+			queued.paused = false;
+			break;
+
+		case stream_command_type::Set_volume:
+			queued.volume = cmd.volume;
+			CAP(queued.volume, 0.0f, 1.0f);
+			break;
+
+		case stream_command_type::Set_sample_cutoff:
+			break;
+	}
+
+	commands_in_flight.fetch_add(1, std::memory_order_acq_rel);
+
+	// the audio thread empties the queue every few milliseconds, it can only be full if that thread was stalled
+	while ( !Audiostream_commands->push(cmd) ) {
+		std::this_thread::yield();
+	}
+}
+
+// Run_Command
+//
+// Does what the game thread queued, only called by the audio thread.
+void AudioStream::Run_Command(const stream_command& cmd)
+{
+	SDL_LockMutex( write_lock );
+
+	if ( status == ASF_USED ) {
+		switch (cmd.type) {
+			case stream_command_type::Play:
+				Play(cmd.volume, cmd.arg);
+				break;
+
+			case stream_command_type::Stop:
+				Stop(cmd.arg);
+				break;
+
+			case stream_command_type::Stop_and_rewind:
+				Stop_and_Rewind();
+				break;
+
+			case stream_command_type::Set_volume:
+				Set_Volume(cmd.volume);
+				break;
+
+			case stream_command_type::Set_sample_cutoff:
+				Set_Sample_Cutoff((uint)cmd.arg);
+				break;
+
+			case stream_command_type::Close:
+				if ( cmd.arg )
+					Fade_and_Destroy();
+				else
+					Destroy();
+				break;
+		}
+	}
+
+	SDL_UnlockMutex( write_lock );
+
+	commands_in_flight.fetch_sub(1, std::memory_order_acq_rel);
+}
+
+// Maybe_Service
+//
+// Refills the buffers once the service interval is up, only called by the audio thread.
+void AudioStream::Maybe_Service(uint now)
+{
+	// ServiceBuffer() checks this again with the lock held
+	if ( (status != ASF_USED) || !m_fPlaying )
+		return;
+
+	if ( now < m_nNextService )
+		return;
+
+	m_nNextService = now + m_nBufService;
+
+	ServiceBuffer();
 }
 
 void AudioStream::Set_Sample_Cutoff(unsigned int sample_cutoff)
@@ -705,9 +776,6 @@ void AudioStream::Stop(int paused)
 
 		m_fPlaying = false;
 		m_bIsPaused = (paused != 0);
-
-		// Delete Timer object
-		m_timer.destructor();
 	}
 }
 
@@ -718,9 +786,6 @@ void AudioStream::Stop_and_Rewind (void)
 		// Stop playback
 		OpenAL_ErrorPrint( alSourceStop(m_source_id) );
 
-		// Delete Timer object
-		m_timer.destructor();
-
 		m_fPlaying = false;
 		m_bIsPaused = false;
 	}
@@ -770,6 +835,38 @@ bool AudioStream::PlaybackDone()
 
 AudioStream Audio_streams[MAX_AUDIO_STREAMS];
 
+static void audiostream_thread_main()
+{
+	while ( Audiostream_thread_running.load(std::memory_order_acquire) ) {
+		stream_command* cmd;
+
+		while ( (cmd = Audiostream_commands->front()) != nullptr ) {
+			Audio_streams[cmd->stream].Run_Command(*cmd);
+			Audiostream_commands->pop();
+		}
+
+		auto now = (uint)timer_get_milliseconds();
+
+		for (auto& stream : Audio_streams) {
+			stream.Maybe_Service(now);
+		}
+
+		std::this_thread::sleep_for(std::chrono::milliseconds(AUDIOSTREAM_THREAD_WAIT_MS));
+	}
+}
+
+static void audiostream_queue_command(int i, stream_command_type type, float volume = 0.0f, int arg = 0)
+{
+	stream_command cmd;
+
+	cmd.type = type;
+	cmd.stream = i;
+	cmd.volume = volume;
+	cmd.arg = arg;
+
+	Audio_streams[i].Queue_Command(cmd);
+}
+
 
 void audiostream_init()
 {
@@ -814,6 +911,11 @@ void audiostream_init()
 
 	Global_service_lock = SDL_CreateMutex();
 
+	Audiostream_commands.reset(new spsc_queue<stream_command>(AUDIOSTREAM_QUEUE_SIZE));
+
+	Audiostream_thread_running.store(true, std::memory_order_release);
+	Audiostream_thread = std::thread(audiostream_thread_main);
+
 	Audiostream_inited = 1;
 }
 
@@ -826,7 +928,15 @@ void audiostream_close()
 
 	int i;
 
+	// whatever is still queued doesn't matter anymore, all the streams are destroyed below
+	Audiostream_thread_running.store(false, std::memory_order_release);
+	Audiostream_thread.join();
+
+	Audiostream_commands.reset();
+
 	for ( i = 0; i < MAX_AUDIO_STREAMS; i++ ) {
+		Audio_streams[i].commands_in_flight.store(0, std::memory_order_relaxed);
+
 		if ( Audio_streams[i].status == ASF_USED ) {
 			Audio_streams[i].status = ASF_FREE;
 			Audio_streams[i].Destroy();
@@ -937,12 +1047,9 @@ void audiostream_close_file(int i, int fade)
 
 	Assert( i >= 0 && i < MAX_AUDIO_STREAMS );
 
-	if ( Audio_streams[i].status == ASF_USED ) {
-		if ( fade )
-			Audio_streams[i].Fade_and_Destroy();
-		else
-			Audio_streams[i].Destroy();
-	}
+	// the stream stays used until the audio thread destroyed it so its slot isn't given out again before
+	if ( Audio_streams[i].status == ASF_USED )
+		audiostream_queue_command(i, stream_command_type::Close, 0.0f, fade);
 
 }
 
@@ -978,7 +1085,7 @@ void audiostream_play(int i, float volume, int looping)
 
 	Assert( Audio_streams[i].status == ASF_USED );
 	Audio_streams[i].Set_Default_Volume(volume);
-	Audio_streams[i].Play(volume, looping);
+	audiostream_queue_command(i, stream_command_type::Play, volume, looping);
 }
 
 // use as buffer service function
@@ -1007,9 +1114,9 @@ void audiostream_stop(int i, int rewind, int paused)
 	Assert( Audio_streams[i].status == ASF_USED );
 
 	if ( rewind )
-		Audio_streams[i].Stop_and_Rewind();
+		audiostream_queue_command(i, stream_command_type::Stop_and_rewind);
 	else
-		Audio_streams[i].Stop(paused);
+		audiostream_queue_command(i, stream_command_type::Stop, 0.0f, paused);
 }
 
 void audiostream_set_volume_all(float volume, int type)
@@ -1021,7 +1128,7 @@ void audiostream_set_volume_all(float volume, int type)
 			continue;
 
 		if ( (Audio_streams[i].type == type) || ((Audio_streams[i].type == ASF_MENUMUSIC) && (type == ASF_EVENTMUSIC)) ) {
-			Audio_streams[i].Set_Volume(volume);
+			audiostream_queue_command(i, stream_command_type::Set_volume, volume);
 		}
 	}
 }
@@ -1037,7 +1144,7 @@ void audiostream_set_volume(int i, float volume)
 	if ( Audio_streams[i].status == ASF_FREE )
 		return;
 
-	Audio_streams[i].Set_Volume(volume);
+	audiostream_queue_command(i, stream_command_type::Set_volume, volume);
 }
 
 int audiostream_is_paused(int i)
@@ -1064,7 +1171,7 @@ void audiostream_set_sample_cutoff(int i, uint cutoff)
 	if ( Audio_streams[i].status == ASF_FREE )
 		return;
 
-	Audio_streams[i].Set_Sample_Cutoff(cutoff);
+	audiostream_queue_command(i, stream_command_type::Set_sample_cutoff, 0.0f, (int)cutoff);
 }
 
 uint audiostream_get_samples_committed(int i)
@@ -1126,7 +1233,7 @@ void audiostream_unpause(int i, bool via_sexp_or_script)
 		return;
 
 	if ( audiostream_is_paused(i) == (int)true ) {
-		audiostream_play(i, Audio_streams[i].Get_Volume(), Audio_streams[i].Is_looping());
+		audiostream_play(i, Audio_streams[i].Get_Queued_Volume(), Audio_streams[i].Is_looping());
 	}
 
 	if (via_sexp_or_script)
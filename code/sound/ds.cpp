@@ -12,6 +12,8 @@
 #include "cfile/cfile.h"
 #include "cmdline/cmdline.h"
 #include "globalincs/pstypes.h"
+#include "io/timer.h"
+#include "math/vecmat.h"
 #include "osapi/osapi.h"
 #include "sound/audiostr.h"
 #include "sound/channel.h"
@@ -20,6 +22,9 @@
 #include "sound/dscap.h"
 #include "sound/openal.h"
 #include "sound/sound.h" // jg18 - for enhanced sound
+#include "tracing/Monitor.h"
+
+#include <algorithm>
 
 
 typedef struct sound_buffer
@@ -45,6 +50,42 @@ static int MAX_CHANNELS;		// initialized properly in ds_init_channels()
 channel *Channels = NULL;
 static int channel_next_sig = 1;
 
+// set when the last ds_get_free_channel() failed because all channels were busy, not because of an instance limit
+static bool Ds_out_of_channels = false;
+
+/**
+ * A one-shot 3D sound which was started while all channels were busy. It plays silently from the time it was started on
+ * and is moved onto a channel once per frame if it became audible enough, see ds_update_virtual_voices().
+ */
+typedef struct virtual_voice {
+	int sig;
+	int sid;
+	int snd_id;
+	vec3d pos;
+	vec3d vel;
+	float min;
+	float max;
+	float max_volume;
+	int priority;
+	EnhancedSoundData enhanced_sound_data;
+	bool is_ambient;
+	int start_time;		// in ms
+	int end_time;
+} virtual_voice;
+
+static SCP_vector<virtual_voice> Virtual_voices;
+
+const size_t MAX_VIRTUAL_VOICES = 256;
+
+// each try scans all channels so only the most audible voices get one every frame
+const int MAX_VIRTUAL_VOICE_TRIES = 4;
+
+// the same cutoff snd_play_3d() uses for the sounds it starts
+const float VIRTUAL_VOICE_MIN_VOLUME = 0.05f;
+
+MONITOR(NumVirtualVoices)
+MONITOR(NumVirtualVoicesBound)
+
 const int BUFFER_BUMP = 50;
 SCP_vector<sound_buffer> sound_buffers;
 
@@ -251,30 +292,42 @@ int ds_load_buffer(int *sid, int flags, ffmpeg::WaveFile* file)
 	Assert(sid != NULL);
 	Assert(file != NULL);
 
-	// All sounds are required to have a software buffer
-	*sid = ds_get_sid();
-	if (*sid == -1) {
-		nprintf(("Sound", "SOUND ==> No more sound buffers available\n"));
+	ds_decoded_sound decoded;
+
+	if (!ds_decode_file(file, &decoded)) {
+		*sid = -1;
 		return -1;
 	}
 
-	ALuint pi;
-	OpenAL_ErrorCheck(alGenBuffers(1, &pi), return -1);
+	return ds_load_buffer(sid, &decoded);
+}
+
+/**
+ * Reads all samples of a sound file
+ *
+ * @return false if the format of the file can't be put into a buffer
+ */
+bool ds_decode_file(ffmpeg::WaveFile* file, ds_decoded_sound* decoded)
+{
+	Assert(file != NULL);
+	Assert(decoded != NULL);
 
-	ALenum format;
 	ALsizei size = file->getTotalSamples() * file->getSampleByteSize();
-	ALint n_channels = file->getNumChannels();
-	ALsizei frequency;
-		
+
 	// format is now in pcm
-	frequency = file->getSampleRate();
-	format = file->getALFormat();
+	decoded->frequency = file->getSampleRate();
+	decoded->format = file->getALFormat();
 
-	if (format == AL_INVALID_VALUE) {
-		return -1;
+	if (decoded->format == AL_INVALID_VALUE) {
+		return false;
 	}
 
-	SCP_vector<uint8_t> audio_buffer;
+	decoded->bits_per_sample = (file->getSampleByteSize() / file->getNumChannels()) * 8;
+	decoded->n_channels = file->getNumChannels();
+	decoded->nseconds = fl2i(file->getDuration());
+
+	auto& audio_buffer = decoded->data;
+	audio_buffer.clear();
 	audio_buffer.reserve(size);
 
 	SCP_vector<uint8_t> buffer(file->getSampleRate() * file->getSampleByteSize());
@@ -288,18 +341,43 @@ int ds_load_buffer(int *sid, int flags, ffmpeg::WaveFile* file)
 		}
 	}
 
+	return true;
+}
+
+/**
+ * Creates the buffer of a sound from samples which were already decoded, the samples are released afterwards
+ */
+int ds_load_buffer(int *sid, ds_decoded_sound* decoded)
+{
+	Assert(sid != NULL);
+	Assert(decoded != NULL);
+
+	// All sounds are required to have a software buffer
+	*sid = ds_get_sid();
+	if (*sid == -1) {
+		nprintf(("Sound", "SOUND ==> No more sound buffers available\n"));
+		return -1;
+	}
+
+	ALuint pi;
+	OpenAL_ErrorCheck(alGenBuffers(1, &pi), return -1);
+
+	auto& audio_buffer = decoded->data;
+
 	Snd_sram += audio_buffer.size();
 
-	OpenAL_ErrorCheck(alBufferData(pi, format, audio_buffer.data(), (ALsizei)audio_buffer.size(), frequency), return -1; );
+	OpenAL_ErrorCheck(alBufferData(pi, decoded->format, audio_buffer.data(), (ALsizei)audio_buffer.size(), decoded->frequency), return -1; );
 
 	sound_buffers[*sid].buf_id = pi;
 	sound_buffers[*sid].channel_id = -1;
-	sound_buffers[*sid].frequency = frequency;
-	sound_buffers[*sid].bits_per_sample = (file->getSampleByteSize() / file->getNumChannels()) * 8;
-	sound_buffers[*sid].nchannels = n_channels;
-	sound_buffers[*sid].nseconds = fl2i(file->getDuration());
+	sound_buffers[*sid].frequency = decoded->frequency;
+	sound_buffers[*sid].bits_per_sample = decoded->bits_per_sample;
+	sound_buffers[*sid].nchannels = decoded->n_channels;
+	sound_buffers[*sid].nseconds = decoded->nseconds;
 	sound_buffers[*sid].nbytes = (int)audio_buffer.size();
 
+	SCP_vector<uint8_t>().swap(audio_buffer);
+
 	return 0;
 }
 
@@ -594,6 +672,8 @@ void ds_close_all_channels()
 {
 	int i;
 
+	Virtual_voices.clear();
+
 	for (i = 0; i < MAX_CHANNELS; i++) {
 		ds_close_channel(i);
 	}
@@ -608,6 +688,9 @@ void ds_unload_buffer(int sid)
 		return;
 	}
 
+	Virtual_voices.erase(std::remove_if(Virtual_voices.begin(), Virtual_voices.end(),
+		[sid](const virtual_voice &voice) { return voice.sid == sid; }), Virtual_voices.end());
+
 	if (sound_buffers[sid].channel_id >= 0) {
 		ds_close_channel_fast(sound_buffers[sid].channel_id);
 		sound_buffers[sid].channel_id = -1;
@@ -622,6 +705,21 @@ void ds_unload_buffer(int sid)
 	sound_buffers[sid].buf_id = 0;
 }
 
+/**
+ * Check if a buffer is still heard on a channel or waits to be heard as a virtual voice
+ */
+bool ds_is_buffer_in_use(int sid)
+{
+	for (int i = 0; i < MAX_CHANNELS; i++) {
+		if ( (Channels[i].sid == sid) && ds_is_channel_playing(i) ) {
+			return true;
+		}
+	}
+
+	return std::any_of(Virtual_voices.begin(), Virtual_voices.end(),
+		[sid](const virtual_voice &voice) { return voice.sid == sid; });
+}
+
 /**
  * Unload all the channel buffers
  */
@@ -686,6 +784,7 @@ int ds_get_free_channel_retail(float new_volume, int snd_id, int priority)
 
 	instance_count = 0;
 	first_free_channel = -1;
+	Ds_out_of_channels = false;
 
 	// determine the limit of concurrent instances of this sound
 	switch (priority) {
@@ -788,6 +887,8 @@ int ds_get_free_channel_retail(float new_volume, int snd_id, int priority)
 				first_free_channel = lowest_vol_index;
 			}
 		}
+
+		Ds_out_of_channels = (first_free_channel == -1);
 	}
 
 	if ( (first_free_channel >= 0) && (Channels[first_free_channel].source_id == 0) ) {
@@ -823,6 +924,7 @@ int ds_get_free_channel_enhanced(float new_volume, int snd_id, int enhanced_prio
 
 	instance_count = 0;
 	first_free_channel = -1;
+	Ds_out_of_channels = false;
 
 	// Look for a channel to use to play this sample
 	for ( i = 0; i < MAX_CHANNELS; i++ ) {
@@ -909,6 +1011,8 @@ int ds_get_free_channel_enhanced(float new_volume, int snd_id, int enhanced_prio
 				}
 			}
 		}
+
+		Ds_out_of_channels = (first_free_channel == -1);
 	}
 
 	if ( (first_free_channel >= 0) && (Channels[first_free_channel].source_id == 0) ) {
@@ -1213,6 +1317,8 @@ void ds_stop_channel_all()
 {
 	int i;
 
+	Virtual_voices.clear();
+
 	for ( i=0; i<MAX_CHANNELS; i++ ) {
 		if ( Channels[i].source_id != 0 ) {
 			OpenAL_ErrorPrint( alSourceStop(Channels[i].source_id) );
@@ -1339,6 +1445,9 @@ void ds_chg_loop_status(int channel_id, int loop)
  *
  * @return 0 if sound started successfully, -1 if sound could not be played
  */
+static int ds3d_start_channel(int channel_id, int sig, int sid, int snd_id, vec3d *pos, vec3d *vel, float min, float max, int looping, float max_volume, int enhanced_priority, bool is_ambient, float offset);
+static int ds3d_add_virtual_voice(int sid, int snd_id, vec3d *pos, vec3d *vel, float min, float max, float max_volume, float estimated_vol, const EnhancedSoundData *enhanced_sound_data, int priority, bool is_ambient);
+
 int ds3d_play(int sid, int snd_id, vec3d *pos, vec3d *vel, float min, float max, int looping, float max_volume, float estimated_vol, const EnhancedSoundData * enhanced_sound_data, int priority, bool is_ambient)
 {
 	int channel_id;
@@ -1352,9 +1461,26 @@ int ds3d_play(int sid, int snd_id, vec3d *pos, vec3d *vel, float min, float max,
 	channel_id = ds_get_free_channel(estimated_vol, snd_id, priority, enhanced_priority, *enhanced_sound_data);
 
 	if (channel_id < 0) {
+		if ( Ds_out_of_channels && !looping && Cmdline_virtual_voices ) {
+			return ds3d_add_virtual_voice(sid, snd_id, pos, vel, min, max, max_volume, estimated_vol, enhanced_sound_data, priority, is_ambient);
+		}
+
 		return -1;
 	}
 
+	return ds3d_start_channel(channel_id, -1, sid, snd_id, pos, vel, min, max, looping, max_volume, enhanced_priority, is_ambient, 0.0f);
+}
+
+/**
+ * Starts a 3D sound on a channel
+ *
+ * @param sig The signature of the sound or -1 to give it a new one
+ * @param offset The time in seconds from which the sound is played
+ *
+ * @return The signature of the sound or -1 if it could not be started
+ */
+static int ds3d_start_channel(int channel_id, int sig, int sid, int snd_id, vec3d *pos, vec3d *vel, float min, float max, int looping, float max_volume, int enhanced_priority, bool is_ambient, float offset)
+{
 	if ( Channels[channel_id].source_id == 0 ) {
 		return -1;
 	}
@@ -1385,6 +1511,10 @@ int ds3d_play(int sid, int snd_id, vec3d *pos, vec3d *vel, float min, float max,
 
 	OpenAL_ErrorPrint( alSourcei(Channels[channel_id].source_id, AL_LOOPING, (looping) ? AL_TRUE : AL_FALSE) );
 
+	if (offset > 0.0f) {
+		OpenAL_ErrorPrint( alSourcef(Channels[channel_id].source_id, AL_SEC_OFFSET, offset) );
+	}
+
 	OpenAL_ErrorPrint( alSourcePlay(Channels[channel_id].source_id) );
 
 
@@ -1392,7 +1522,7 @@ int ds3d_play(int sid, int snd_id, vec3d *pos, vec3d *vel, float min, float max,
 
 	Channels[channel_id].sid = sid;
 	Channels[channel_id].snd_id = snd_id;
-	Channels[channel_id].sig = channel_next_sig++;
+	Channels[channel_id].sig = (sig >= 0) ? sig : channel_next_sig++;
 	Channels[channel_id].last_position = 0;
 	Channels[channel_id].is_voice_msg = false;
 	Channels[channel_id].vol = max_volume;
@@ -1407,6 +1537,151 @@ int ds3d_play(int sid, int snd_id, vec3d *pos, vec3d *vel, float min, float max,
 	return Channels[channel_id].sig;
 }
 
+/**
+ * Keeps track of a 3D sound which could not get a channel
+ *
+ * @return The signature the sound will have once it is on a channel, or -1 if it is not kept
+ */
+static int ds3d_add_virtual_voice(int sid, int snd_id, vec3d *pos, vec3d *vel, float min, float max, float max_volume, float estimated_vol, const EnhancedSoundData *enhanced_sound_data, int priority, bool is_ambient)
+{
+	if ( (estimated_vol < VIRTUAL_VOICE_MIN_VOLUME) || (Virtual_voices.size() >= MAX_VIRTUAL_VOICES) ) {
+		return -1;
+	}
+
+	auto &buffer = sound_buffers[sid];
+	int bytes_per_second = buffer.frequency * (buffer.bits_per_sample / 8) * buffer.nchannels;
+
+	if (bytes_per_second <= 0) {
+		return -1;
+	}
+
+	virtual_voice voice;
+	voice.sig = channel_next_sig++;
+	voice.sid = sid;
+	voice.snd_id = snd_id;
+	voice.pos = *pos;
+	voice.vel = (vel != NULL) ? *vel : vmd_zero_vector;
+	voice.min = min;
+	voice.max = max;
+	voice.max_volume = max_volume;
+	voice.priority = priority;
+	voice.enhanced_sound_data = *enhanced_sound_data;
+	voice.is_ambient = is_ambient;
+	voice.start_time = timer_get_milliseconds();
+	voice.end_time = voice.start_time + (int)(((long long)buffer.nbytes * 1000) / bytes_per_second);
+
+	if (channel_next_sig < 0) {
+		channel_next_sig = 1;
+	}
+
+	Virtual_voices.push_back(voice);
+
+	return voice.sig;
+}
+
+/**
+ * The volume a virtual voice would have at the listener, see snd_play_3d()
+ */
+static float ds3d_virtual_voice_volume(const virtual_voice &voice, const vec3d &listener_pos)
+{
+	float distance = vm_vec_dist_quick(&voice.pos, &listener_pos);
+
+	if (distance <= voice.min) {
+		return voice.max_volume;
+	} else if (distance >= voice.max) {
+		return 0.0f;
+	}
+
+	return voice.max_volume - voice.max_volume * (distance / voice.max);
+}
+
+/**
+ * Drops the virtual voices which are done and moves the most audible ones onto channels, they are played from where
+ * they would be by now. The channels are given up by the same rules a new sound uses.
+ */
+static void ds_update_virtual_voices()
+{
+	if (Virtual_voices.empty()) {
+		return;
+	}
+
+	int now = timer_get_milliseconds();
+
+	Virtual_voices.erase(std::remove_if(Virtual_voices.begin(), Virtual_voices.end(),
+		[now](const virtual_voice &voice) { return voice.end_time <= now; }), Virtual_voices.end());
+
+	MONITOR_INC(NumVirtualVoices, (int)Virtual_voices.size());
+
+	if (Virtual_voices.empty() || Cmdline_no_3d_sound) {
+		return;
+	}
+
+	ALfloat listener[3];
+	OpenAL_ErrorCheck( alGetListener3f(AL_POSITION, &listener[0], &listener[1], &listener[2]), return );
+
+	vec3d listener_pos;
+	listener_pos.xyz.x = listener[0];
+	listener_pos.xyz.y = listener[1];
+	listener_pos.xyz.z = -listener[2];
+
+	SCP_vector<std::pair<float, size_t>> audible;
+	audible.reserve(Virtual_voices.size());
+
+	for (size_t i = 0; i < Virtual_voices.size(); i++) {
+		float volume = ds3d_virtual_voice_volume(Virtual_voices[i], listener_pos);
+
+		if (volume >= VIRTUAL_VOICE_MIN_VOLUME) {
+			audible.emplace_back(volume, i);
+		}
+	}
+
+	std::sort(audible.begin(), audible.end(), [](const std::pair<float, size_t> &a, const std::pair<float, size_t> &b) {
+		return a.first > b.first;
+	});
+
+	bool bound = false;
+	int tries = 0;
+
+	for (auto &entry : audible) {
+		if (tries++ >= MAX_VIRTUAL_VOICE_TRIES) {
+			break;
+		}
+
+		auto &voice = Virtual_voices[entry.second];
+		int enhanced_priority = SND_ENHANCED_PRIORITY_INVALID;
+
+		int channel_id = ds_get_free_channel(entry.first, voice.snd_id, voice.priority, enhanced_priority, voice.enhanced_sound_data);
+
+		if (channel_id < 0) {
+			continue;
+		}
+
+		float offset = (now - voice.start_time) / 1000.0f;
+
+		ds3d_start_channel(channel_id, voice.sig, voice.sid, voice.snd_id, &voice.pos, &voice.vel, voice.min, voice.max, FALSE, voice.max_volume, enhanced_priority, voice.is_ambient, offset);
+
+		// the voice is gone either way, a channel which failed to start is not tried again
+		voice.end_time = 0;
+		bound = true;
+
+		MONITOR_INC(NumVirtualVoicesBound, 1);
+	}
+
+	if (bound) {
+		Virtual_voices.erase(std::remove_if(Virtual_voices.begin(), Virtual_voices.end(),
+			[](const virtual_voice &voice) { return voice.end_time == 0; }), Virtual_voices.end());
+	}
+}
+
+/**
+ * Stops a sound which is waiting for a channel
+ */
+void ds_stop_virtual_voice(int sig)
+{
+	Virtual_voices.erase(std::remove_if(Virtual_voices.begin(), Virtual_voices.end(),
+		[sig](const virtual_voice &voice) { return voice.sig == sig; }), Virtual_voices.end());
+}
+
 /**
  * @todo Documentation
  */
@@ -1930,6 +2205,8 @@ void ds_do_frame()
 			}
 		}
 	}
+
+	ds_update_virtual_voices();
 }
 
 /**
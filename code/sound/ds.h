@@ -47,12 +47,26 @@ typedef struct sound_info {
 	int duration;	// time in ms for duration of sound
 } sound_info;
 
+// The samples of a sound file decoded by ds_decode_file(), ready to be put into a buffer
+struct ds_decoded_sound {
+	SCP_vector<uint8_t> data;
+	int format = 0;
+	int frequency = 0;
+	int bits_per_sample = 0;
+	int n_channels = 0;
+	int nseconds = 0;
+};
+
 extern int ds_initialized;
 
 int ds_init();
 void ds_close();
 int ds_load_buffer(int *sid, int flags, ffmpeg::WaveFile* file);
+// doesn't touch any state of the sound system so it may run on any thread
+bool ds_decode_file(ffmpeg::WaveFile* file, ds_decoded_sound* decoded);
+int ds_load_buffer(int *sid, ds_decoded_sound* decoded);
 void ds_unload_buffer(int sid);
+bool ds_is_buffer_in_use(int sid);
 int ds_play(int sid, int snd_id, int priority, const EnhancedSoundData * enhanced_sound_data, float volume, float pan, int looping, bool is_voice_msg = false);
 int ds_get_channel(int sig);
 int ds_is_channel_playing(int channel);
@@ -83,6 +97,7 @@ int ds_get_number_channels();
 int ds3d_play(int sid, int snd_id, vec3d *pos, vec3d *vel, float min, float max, int looping, float max_volume, float estimated_vol, const EnhancedSoundData * enhanced_sound_data, int priority = DS_MUST_PLAY, bool is_ambient = false);
 
 void ds_do_frame();
+void ds_stop_virtual_voice(int sig);
 
 // --------------------
 //
@@ -15,8 +15,10 @@
 #include "gamesnd/eventmusic.h"
 #include "gamesnd/gamesnd.h"
 #include "globalincs/alphacolors.h"
+#include "globalincs/jobs.h"
 #include "globalincs/pstypes.h"
 #include "globalincs/vmallocator.h"
+#include "io/timer.h"
 #include "osapi/osapi.h"
 #include "render/3d.h"
 #include "sound/ffmpeg/WaveFile.h"
@@ -25,24 +27,37 @@
 #include "sound/ds3d.h"
 #include "sound/dscap.h"
 #include "tracing/Monitor.h"
+#include "tracing/StartupProfiler.h"
 #include "tracing/tracing.h"
 
 #include "globalincs/pstypes.h"
 
+#include <algorithm>
 #include <limits.h>
+#include <memory>
 
 const unsigned int SND_ENHANCED_MAX_LIMIT = 15; // seems like a good max limit
 
 #define SND_F_USED			(1<<0)		// Sounds[] element is used
+#define SND_F_DEFERRED		(1<<1)		// only decoded when played and evicted again to stay in the -snd_ram_budget
+#define SND_F_PLAYED		(1<<2)		// played since the last snd_page_in_start()
+#define SND_F_PAGED_IN		(1<<3)		// loaded or played since the last snd_page_in_start(), or played before it
+#define SND_F_PREFETCHED	(1<<4)		// created by snd_prefetch() and not loaded by snd_load() since
+
+// a sound which is expected to play all the time is still kept compressed if it would take more than this part of the
+// -snd_ram_budget
+#define SND_LONG_SOUND_FRACTION		16
 
 typedef struct sound	{
 	int				sid;			// software id
 	char				filename[MAX_FILENAME_LEN];
 	int				sig;
 	int				flags;
+	int				ds_flags;		// the DS_* flags the sound is decoded with
 	sound_info		info;
 	int				uncompressed_size;		// size (in bytes) of sound (uncompressed)
 	int				duration;
+	int				last_used;		// time the deferred sound was last played at
 } sound;
 
 SCP_vector<sound> Sounds;
@@ -54,6 +69,9 @@ float Master_voice_volume = 0.7f;	// range is 0 -> 1, used for all voice playbac
 
 unsigned int SND_ENV_DEFAULT = 0;
 
+// set between snd_page_in_start() and snd_page_in_stop()
+static bool Snd_paging = false;
+
 struct LoopingSoundInfo {
 	int m_dsHandle;
 	float m_defaultVolume;	//!< The default volume of this sound (from game_snd)
@@ -131,6 +149,8 @@ int snd_init()
 {
 	int rval;
 
+	TRACE_STARTUP_SCOPE(tracing::SoundInit);
+
 	if ( Cmdline_freespace_no_sound )
 		return 0;
 
@@ -259,6 +279,368 @@ void snd_spew_debug_info()
 	gr_printf_no_resize(sx, sy, "Total sounds : %d\n", game_sounds + interface_sounds + message_sounds);
 }
 
+// Opens a sound file the way it's decoded into a buffer, 3D sounds are always mixed down to one channel
+static std::unique_ptr<ffmpeg::WaveFile> snd_open_file(const char* filename, int ds_flags, bool* downmixed = nullptr)
+{
+	std::unique_ptr<ffmpeg::WaveFile> audio_file(new ffmpeg::WaveFile());
+
+	if (!audio_file->Open(filename, false)) {
+		return nullptr;
+	}
+
+	if ((ds_flags & DS_3D) && (audio_file->getNumChannels() > 1)) {
+		// We need to resample the audio down to one channel
+		auto current = audio_file->getAudioProperties();
+		current.channel_layout = AV_CH_LAYOUT_MONO;
+
+		audio_file->setAdjustedAudioProperties(current);
+
+		if (downmixed != nullptr) {
+			*downmixed = true;
+		}
+	}
+
+	return audio_file;
+}
+
+// With a -snd_ram_budget only the sounds which are expected to play all the time are decoded when they are loaded, the
+// others stay compressed in their files until they are played
+static bool snd_keep_compressed(const game_snd* gs, int size)
+{
+	if (Cmdline_snd_ram_budget <= 0) {
+		return false;
+	}
+
+	const size_t budget = (size_t)Cmdline_snd_ram_budget * 1024 * 1024;
+
+	return !gs->preload || ((size_t)size > budget / SND_LONG_SOUND_FRACTION);
+}
+
+MONITOR( NumSoundsDecoded )
+MONITOR( NumSoundsEvicted )
+
+// Releases the buffers of the deferred sounds which were played the longest time ago until the sounds fit into the
+// -snd_ram_budget again. Playing sounds are kept, the others are simply decoded again the next time they are played.
+static void snd_enforce_ram_budget(size_t keep)
+{
+	if (Cmdline_snd_ram_budget <= 0) {
+		return;
+	}
+
+	const size_t budget = (size_t)Cmdline_snd_ram_budget * 1024 * 1024;
+
+	if (Snd_sram <= budget) {
+		return;
+	}
+
+	SCP_vector<std::pair<int, size_t>> candidates;
+
+	for (size_t n = 0; n < Sounds.size(); n++) {
+		auto snd = &Sounds[n];
+
+		if ((n == keep) || !(snd->flags & SND_F_USED) || !(snd->flags & SND_F_DEFERRED) || (snd->sid < 0)
+			|| ds_is_buffer_in_use(snd->sid)) {
+			continue;
+		}
+
+		candidates.emplace_back(snd->last_used, n);
+	}
+
+	std::sort(candidates.begin(), candidates.end());
+
+	for (auto& candidate : candidates) {
+		if (Snd_sram <= budget) {
+			break;
+		}
+
+		auto snd = &Sounds[candidate.second];
+
+		ds_unload_buffer(snd->sid);
+		Snd_sram -= snd->uncompressed_size;
+		snd->sid = -1;
+
+		MONITOR_INC( NumSoundsEvicted, 1 );
+	}
+}
+
+// Finds the Sounds[] element a file is loaded in the way a sound with the DS_* flags can use
+//
+// returns:			the index of the element if *loaded is set, otherwise the index of the first free element which
+//						is Sounds.size() if there is none
+static size_t snd_find_slot(const char *filename, int ds_flags, bool *loaded)
+{
+	size_t n;
+
+	*loaded = false;
+
+	for (n = 0; n < Sounds.size(); n++) {
+		if ( !(Sounds[n].flags & SND_F_USED) ) {
+			break;
+		} else if ( !stricmp( Sounds[n].filename, filename) ) {
+			// extra check: make sure the sound is actually loaded in a compatible way (2D vs. 3D)
+			//
+			// NOTE: this will allow a duplicate 3D entry if 2D stereo entry exists,
+			//       but will not load a duplicate 2D entry to get stereo if 3D
+			//       version already loaded
+			if ( (Sounds[n].info.n_channels == 1) || !(ds_flags & DS_3D) ) {
+				*loaded = true;
+				break;
+			}
+		}
+	}
+
+	return n;
+}
+
+static sound *snd_new_slot(size_t n)
+{
+	if ( n == Sounds.size() ) {
+		sound new_sound;
+		new_sound.sid = -1;
+		new_sound.flags = 0;
+		new_sound.ds_flags = 0;
+		new_sound.last_used = 0;
+
+		Sounds.push_back( new_sound );
+	}
+
+	return &Sounds[n];
+}
+
+// snd_prefetch() decodes files on the job workers while the game goes on. The samples are put into a buffer by
+// snd_do_frame() once they are ready, or right away by snd_load() and snd_decode() when the sound is needed earlier.
+struct snd_prefetch_file {
+	char filename[MAX_FILENAME_LEN];
+	int ds_flags = 0;
+
+	// written by the job, the rest of the code only looks at them once the group is done
+	bool decoded = false;
+	sound_info info;
+	int duration = 0;
+	ds_decoded_sound samples;
+
+	jobs::job_group group;
+};
+
+// the number of files which may be decoded at the same time
+#define SND_MAX_PREFETCHES		4
+
+static SCP_vector<std::unique_ptr<snd_prefetch_file>> Snd_prefetches;
+
+MONITOR( NumSoundsPrefetched )
+
+// runs on a job worker, only uses the prefetch itself
+static void snd_prefetch_decode(snd_prefetch_file *prefetch)
+{
+	auto audio_file = snd_open_file(prefetch->filename, prefetch->ds_flags);
+	if (!audio_file) {
+		return;
+	}
+
+	auto si = &prefetch->info;
+	si->n_channels			= audio_file->getNumChannels();
+	si->sample_rate			= audio_file->getSampleRate();
+	si->avg_bytes_per_sec	= audio_file->getSampleRate() * audio_file->getSampleByteSize();
+	si->bits					= audio_file->getSampleByteSize() / audio_file->getNumChannels() * 8;
+	si->size					= audio_file->getTotalSamples() * audio_file->getSampleByteSize();
+
+	prefetch->duration = fl2i(1000.0f * audio_file->getDuration());
+	prefetch->decoded = ds_decode_file(audio_file.get(), &prefetch->samples);
+}
+
+// Puts the samples of a finished prefetch into the buffer of its sound, the sound is created if it isn't loaded
+static void snd_prefetch_install(snd_prefetch_file *prefetch)
+{
+	// snd_load() reports the error if the sound is used
+	if (!prefetch->decoded) {
+		return;
+	}
+
+	bool loaded;
+	auto n = snd_find_slot(prefetch->filename, prefetch->ds_flags, &loaded);
+
+	if (loaded) {
+		auto snd = &Sounds[n];
+
+		// only a deferred sound whose buffer was evicted needs the samples
+		if ( (snd->sid >= 0) || !(snd->flags & SND_F_DEFERRED) ) {
+			return;
+		}
+
+		if (ds_load_buffer(&snd->sid, &prefetch->samples) == -1) {
+			snd->sid = -1;
+			return;
+		}
+
+		snd->last_used = timer_get_milliseconds();
+	} else {
+		auto snd = snd_new_slot(n);
+
+		if (ds_load_buffer(&snd->sid, &prefetch->samples) == -1) {
+			nprintf(("Sound", "SOUND ==> Failed to load prefetched '%s'\n", prefetch->filename));
+			snd->sid = -1;
+			return;
+		}
+
+		strcpy_s( snd->filename, prefetch->filename );
+		snd->info = prefetch->info;
+		snd->uncompressed_size = prefetch->info.size;
+		snd->ds_flags = prefetch->ds_flags;
+		snd->duration = prefetch->duration;
+		snd->last_used = timer_get_milliseconds();
+
+		// with a -snd_ram_budget it's evicted again like any other sound which isn't preloaded
+		snd->flags = SND_F_USED | SND_F_PREFETCHED;
+		if (Cmdline_snd_ram_budget > 0) {
+			snd->flags |= SND_F_DEFERRED;
+		}
+
+		snd->sig = snd_next_sig++;
+		if (snd_next_sig < 0 ) snd_next_sig = 1;
+	}
+
+	MONITOR_INC( NumSoundsPrefetched, 1 );
+
+	snd_enforce_ram_budget(n);
+}
+
+// Waits for the prefetch of a file if there is one, so the file isn't decoded twice
+static void snd_prefetch_finish(const char *filename, int ds_flags)
+{
+	for (auto iter = Snd_prefetches.begin(); iter != Snd_prefetches.end(); ++iter) {
+		auto prefetch = iter->get();
+
+		if ( (prefetch->ds_flags == ds_flags) && !stricmp(prefetch->filename, filename) ) {
+			prefetch->group.wait();
+			snd_prefetch_install(prefetch);
+
+			Snd_prefetches.erase(iter);
+			return;
+		}
+	}
+}
+
+static void snd_prefetch_do_frame()
+{
+	for (auto iter = Snd_prefetches.begin(); iter != Snd_prefetches.end();) {
+		if ( !(*iter)->group.done() ) {
+			++iter;
+			continue;
+		}
+
+		snd_prefetch_install(iter->get());
+		iter = Snd_prefetches.erase(iter);
+	}
+}
+
+void snd_prefetch(const char *filename)
+{
+	if ( !ds_initialized || !Sound_enabled || !VALID_FNAME(filename) )
+		return;
+
+	// without a worker the file would only be decoded earlier, on the same thread
+	if ( jobs::num_workers() < 2 )
+		return;
+
+	bool loaded;
+	auto n = snd_find_slot(filename, 0, &loaded);
+
+	if (loaded) {
+		auto snd = &Sounds[n];
+
+		if ( !(snd->flags & SND_F_DEFERRED) ) {
+			return;
+		}
+
+		// it's about to be played, so it goes to the back of the eviction order
+		snd->last_used = timer_get_milliseconds();
+
+		if (snd->sid >= 0) {
+			return;
+		}
+	}
+
+	if (Snd_prefetches.size() >= SND_MAX_PREFETCHES) {
+		return;
+	}
+
+	for (auto& prefetch : Snd_prefetches) {
+		if ( (prefetch->ds_flags == 0) && !stricmp(prefetch->filename, filename) ) {
+			return;
+		}
+	}
+
+	std::unique_ptr<snd_prefetch_file> prefetch(new snd_prefetch_file());
+	strcpy_s( prefetch->filename, filename );
+	prefetch->ds_flags = 0;
+
+	auto job_prefetch = prefetch.get();
+	prefetch->group.run([job_prefetch]() { snd_prefetch_decode(job_prefetch); }, tracing::SoundPrefetchJob);
+
+	Snd_prefetches.push_back(std::move(prefetch));
+}
+
+void snd_prefetch_clear()
+{
+	// the groups wait for their jobs
+	Snd_prefetches.clear();
+
+	if (!ds_initialized)
+		return;
+
+	for (size_t n = 0; n < Sounds.size(); n++) {
+		if ( (Sounds[n].flags & SND_F_USED) && (Sounds[n].flags & SND_F_PREFETCHED) ) {
+			snd_unload( (int)n );
+		}
+	}
+}
+
+// Makes sure the buffer of a sound exists before it's played
+//
+// returns:			true if the sound can be played
+static bool snd_decode(sound *snd)
+{
+	if (snd->flags & SND_F_DEFERRED) {
+		snd->last_used = timer_get_milliseconds();
+	}
+
+	if (snd->sid >= 0) {
+		return true;
+	}
+
+	if (!(snd->flags & SND_F_DEFERRED)) {
+		return false;
+	}
+
+	auto index = (size_t)(snd - Sounds.data());
+	snd_prefetch_finish(snd->filename, snd->ds_flags);
+
+	// finishing the prefetch may have added sounds
+	snd = &Sounds[index];
+	if (snd->sid >= 0) {
+		return true;
+	}
+
+	TRACE_SCOPE(tracing::LoadSound);
+
+	auto audio_file = snd_open_file(snd->filename, snd->ds_flags);
+	if (!audio_file) {
+		return false;
+	}
+
+	if (ds_load_buffer(&snd->sid, snd->ds_flags, audio_file.get()) == -1) {
+		nprintf(("Sound", "SOUND ==> Failed to decode '%s'\n", snd->filename));
+		snd->sid = -1;
+		return false;
+	}
+
+	MONITOR_INC( NumSoundsDecoded, 1 );
+
+	snd_enforce_ram_budget((size_t)(snd - Sounds.data()));
+
+	return true;
+}
+
 // ---------------------------------------------------------------------------------------
 // snd_load() 
 //
@@ -287,54 +669,48 @@ int snd_load( game_snd *gs, int allow_hardware_load )
 	if ( !VALID_FNAME(gs->filename) )
 		return -1;
 
-	for (n = 0; n < Sounds.size(); n++) {
-		if ( !(Sounds[n].flags & SND_F_USED) ) {
-			break;
-		} else if ( !stricmp( Sounds[n].filename, gs->filename) ) {
-			// extra check: make sure the sound is actually loaded in a compatible way (2D vs. 3D)
-			//
-			// NOTE: this will allow a duplicate 3D entry if 2D stereo entry exists,
-			//       but will not load a duplicate 2D entry to get stereo if 3D
-			//       version already loaded
-			if ( (Sounds[n].info.n_channels == 1) || !(gs->flags & GAME_SND_USE_DS3D) ) {
-				return (int)n;
-			}
+	// still loaded from before, e.g. a gameplay sound kept from the last level
+	if ( snd_is_loaded(gs) ) {
+		if (Snd_paging) {
+			Sounds[gs->id].flags |= SND_F_PAGED_IN;
 		}
+		return gs->id;
 	}
 
-	if ( n == Sounds.size() ) {
-		sound new_sound;
-		new_sound.sid = -1;
-		new_sound.flags = 0;
+	type = 0;
+	if (gs->flags & GAME_SND_USE_DS3D) {
+		type |= DS_3D;
+	}
 
-		Sounds.push_back( new_sound );
+	snd_prefetch_finish(gs->filename, type);
+
+	bool loaded;
+	n = snd_find_slot(gs->filename, type, &loaded);
+
+	if (loaded) {
+		Sounds[n].flags &= ~SND_F_PREFETCHED;
+		if (Snd_paging) {
+			Sounds[n].flags |= SND_F_PAGED_IN;
+		}
+		return (int)n;
 	}
 
-	snd = &Sounds[n];
+	snd = snd_new_slot(n);
 
 	si = &snd->info;
 
 	TRACE_SCOPE(tracing::LoadSound);
 
-	std::unique_ptr<ffmpeg::WaveFile> audio_file(new ffmpeg::WaveFile());
-
 	nprintf(("Sound", "SOUND ==> Loading '%s'\n", gs->filename));
 
-	if (!audio_file->Open(gs->filename, false)) {
+	bool downmixed = false;
+	auto audio_file = snd_open_file(gs->filename, type, &downmixed);
+	if (!audio_file) {
 		return -1;
 	}
 
-	type = 0;
-	if (gs->flags & GAME_SND_USE_DS3D) {
-		type |= DS_3D;
-
-		if (audio_file->getNumChannels() > 1) {
-			// We need to resample the audio down to one channel
-			auto current = audio_file->getAudioProperties();
-			current.channel_layout = AV_CH_LAYOUT_MONO;
-
-			audio_file->setAdjustedAudioProperties(current);
-
+	if (type & DS_3D) {
+		if (downmixed) {
 #ifndef NDEBUG
             // Retail has a few sounds that triggers this warning so we need to ignore those
             const char* warning_ignore_list[] = {
@@ -367,18 +743,31 @@ int snd_load( game_snd *gs, int allow_hardware_load )
 	si->size					= audio_file->getTotalSamples() * audio_file->getSampleByteSize();
 
 	snd->uncompressed_size = si->size;
+	snd->ds_flags = type;
+	snd->last_used = 0;
 
-	auto rc = ds_load_buffer(&snd->sid, type, audio_file.get());
-	if (rc == -1) {
-		nprintf(("Sound", "SOUND ==> Failed to load '%s'\n", gs->filename));
-		return -1;
+	if (snd_keep_compressed(gs, si->size)) {
+		// decoded by snd_decode() when it's played
+		snd->sid = -1;
+		snd->flags = SND_F_DEFERRED;
+	} else {
+		auto rc = ds_load_buffer(&snd->sid, type, audio_file.get());
+		if (rc == -1) {
+			nprintf(("Sound", "SOUND ==> Failed to load '%s'\n", gs->filename));
+			return -1;
+		}
+
+		snd->flags = 0;
 	}
 
 	// NOTE: "si" values can change once loaded in the buffer
 	snd->duration = fl2i(1000.0f * audio_file->getDuration());
 
 	strcpy_s( snd->filename, gs->filename );
-	snd->flags = SND_F_USED;
+	snd->flags |= SND_F_USED;
+	if (Snd_paging) {
+		snd->flags |= SND_F_PAGED_IN;
+	}
 
 	snd->sig = snd_next_sig++;
 	if (snd_next_sig < 0 ) snd_next_sig = 1;
@@ -422,6 +811,45 @@ int snd_unload( int n )
 	return 1;
 }
 
+bool snd_is_loaded(const game_snd *gs)
+{
+	if ( (gs->id < 0) || ((size_t)gs->id >= Sounds.size()) ) {
+		return false;
+	}
+
+	return (Sounds[gs->id].flags & SND_F_USED) && (Sounds[gs->id].sig == gs->id_sig);
+}
+
+void snd_page_in_start()
+{
+	for (auto& snd : Sounds) {
+		// what was played before is expected to be played again, e.g. when a mission is restarted
+		if (snd.flags & SND_F_PLAYED) {
+			snd.flags |= SND_F_PAGED_IN;
+		} else {
+			snd.flags &= ~SND_F_PAGED_IN;
+		}
+
+		snd.flags &= ~SND_F_PLAYED;
+	}
+
+	Snd_paging = true;
+}
+
+void snd_page_in_stop()
+{
+	Snd_paging = false;
+}
+
+bool snd_is_paged_in(int n)
+{
+	if ( (n < 0) || ((size_t)n >= Sounds.size()) ) {
+		return false;
+	}
+
+	return (Sounds[n].flags & SND_F_PAGED_IN) != 0;
+}
+
 // ---------------------------------------------------------------------------------------
 // snd_unload_all() 
 //
@@ -430,6 +858,8 @@ int snd_unload( int n )
 //
 void snd_unload_all()
 {
+	Snd_prefetches.clear();
+
 	while ( !Sounds.empty() ) {
 		snd_unload( (int)(Sounds.size()-1) );
 	}
@@ -515,11 +945,9 @@ int snd_play( game_snd *gs, float pan, float vol_scale, int priority, bool is_vo
 
 	MONITOR_INC( NumSoundsStarted, 1 );
 
-	if ( gs->id == -1 ) {
+	if ( !snd_is_loaded(gs) ) {
 		gs->id = snd_load(gs);
 		MONITOR_INC( NumSoundsLoaded, 1);
-	} else if ( gs->id_sig != Sounds[gs->id].sig ) {
-		gs->id = snd_load(gs);
 	}
 
 	if ( gs->id == -1 )
@@ -539,10 +967,15 @@ int snd_play( game_snd *gs, float pan, float vol_scale, int priority, bool is_vo
 	if ( !(snd->flags & SND_F_USED) )
 		return -1;
 
+	snd->flags |= SND_F_PLAYED;
+
 	if (!ds_initialized)
 		return -1;
 
 	if ( volume > MIN_SOUND_VOLUME ) {
+		if ( !snd_decode(snd) )
+			return -1;
+
 		handle = ds_play( snd->sid, gs->id_sig, ds_priority(priority), &gs->enhanced_sound_data, volume, pan, 0, is_voice_msg);
 	}
 
@@ -594,11 +1027,9 @@ int snd_play_3d(game_snd *gs, vec3d *source_pos, vec3d *listen_pos, float radius
 
 	MONITOR_INC( Num3DSoundsStarted, 1 );
 
-	if ( gs->id < 0 ) {
+	if ( !snd_is_loaded(gs) ) {
 		gs->id = snd_load(gs);
 		MONITOR_INC( Num3DSoundsLoaded, 1 );
-	}else if ( gs->id_sig != Sounds[gs->id].sig ) {
-		gs->id = snd_load(gs);
 	}
 
 	if ( gs->id == -1 )
@@ -609,7 +1040,9 @@ int snd_play_3d(game_snd *gs, vec3d *source_pos, vec3d *listen_pos, float radius
 	if ( !(snd->flags & SND_F_USED) )
 		return -1;
 
-	if (snd->sid < 0) {
+	snd->flags |= SND_F_PLAYED;
+
+	if ( (snd->sid < 0) && !(snd->flags & SND_F_DEFERRED) ) {
 		return -1;
 	}
 
@@ -658,6 +1091,11 @@ int snd_play_3d(game_snd *gs, vec3d *source_pos, vec3d *listen_pos, float radius
 	// been converted to mono already!
 	Assertion( snd->info.n_channels == 1, "Sound should be mono! Sound file: %s", snd->filename );
 
+	// a deferred sound is only decoded once it's known to be heard
+	if ( !snd_decode(snd) ) {
+		return -1;
+	}
+
 	if (Cmdline_no_3d_sound) {
 		if (distance <= 0.0f) {
 			pan = 0.0f;
@@ -820,10 +1258,7 @@ int snd_play_looping( game_snd *gs, float pan, int start_loop, int stop_loop, fl
 		return -1;
 	}
 
-	if ( gs->id == -1 ) {
-		gs->id = snd_load(gs);
-	}
-	else if ( gs->id_sig != Sounds[gs->id].sig ) {
+	if ( !snd_is_loaded(gs) ) {
 		gs->id = snd_load(gs);
 	}
 
@@ -835,12 +1270,17 @@ int snd_play_looping( game_snd *gs, float pan, int start_loop, int stop_loop, fl
 	if ( !(snd->flags & SND_F_USED) )
 		return -1;
 
+	snd->flags |= SND_F_PLAYED;
+
 	volume = gs->default_volume * vol_scale;
 	volume *= (Master_sound_volume * aav_effect_volume);
 	if ( volume > 1.0f )
 		volume = 1.0f;
 
 	if (volume > MIN_SOUND_VOLUME) {
+		if ( !snd_decode(snd) )
+			return -1;
+
 		handle = ds_play( snd->sid, gs->id_sig, DS_MUST_PLAY, &gs->enhanced_sound_data, volume, pan, 1);
 
 		if(handle != -1 && scriptingUpdateVolume) {
@@ -864,8 +1304,11 @@ void snd_stop( int sig )
 	if ( sig < 0 ) return;
 
 	channel = ds_get_channel(sig);
-	if ( channel == -1 )
+	if ( channel == -1 ) {
+		// the sound may still be waiting for a channel
+		ds_stop_virtual_voice(sig);
 		return;
+	}
 	
 	SCP_list<LoopingSoundInfo>::iterator iter = currentlyLoopingSoundInfos.begin();
 	while (iter != currentlyLoopingSoundInfos.end())
@@ -1217,6 +1660,10 @@ int snd_get_data(int handle, char *data)
 {
 	Assert( (handle >= 0) && ((size_t)handle < Sounds.size()) );
 
+	if ( !snd_decode(&Sounds[handle]) ) {
+		return -1;
+	}
+
 	if ( ds_get_data(Sounds[handle].sid, data) ) {
 		return -1;
 	}
@@ -1229,6 +1676,10 @@ int snd_size(int handle, int *size)
 {
 	Assert( (handle >= 0) && ((size_t)handle < Sounds.size()) );
 
+	if ( !snd_decode(&Sounds[handle]) ) {
+		return -1;
+	}
+
 	if ( ds_get_size(Sounds[handle].sid, size) ) {
 		return -1;
 	}
@@ -1398,6 +1849,8 @@ void snd_do_frame()
 	adjust_volume_on_frame(&aav_voice_volume, &aav_data[AAV_VOICE]);
 	adjust_volume_on_frame(&aav_effect_volume, &aav_data[AAV_EFFECTS]);
 
+	snd_prefetch_do_frame();
+
 	SCP_list<LoopingSoundInfo>::iterator iter;
 	for (iter = currentlyLoopingSoundInfos.begin(); iter != currentlyLoopingSoundInfos.end(); ++iter) {
 
@@ -109,6 +109,22 @@ int	snd_load( game_snd *gs, int allow_hardware_load = 0);
 int	snd_unload( int sndnum );
 void	snd_unload_all();
 
+// whether the Sounds[] element of gs is still the one loaded for it
+bool snd_is_loaded(const game_snd *gs);
+
+// Sounds loaded between these two calls, and sounds played since the previous snd_page_in_start(), are
+// reported by snd_is_paged_in() so the level paging can unload just the rest.
+void snd_page_in_start();
+void snd_page_in_stop();
+bool snd_is_paged_in(int sndnum);
+
+// Starts decoding a file for a 2D sound on a job worker, so it's ready when it's loaded with snd_load() or played.
+// The sound it creates stays loaded until it's unloaded or snd_prefetch_clear() is called.
+void snd_prefetch(const char *filename);
+
+// Drops the pending prefetches and unloads the prefetched sounds which weren't loaded with snd_load()
+void snd_prefetch_clear();
+
 // Plays a sound with volume between 0 and 1.0, where 0 is the
 // inaudible and 1.0 is the loudest sound in the game.
 // Pan goes from -1.0 all the way left to 0.0 in center to 1.0 all the way right.
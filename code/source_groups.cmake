@@ -41,15 +41,21 @@ set (file_root_autopilot
 
 # Bmpman files
 set (file_root_bmpman
+	bmpman/atlas.cpp
+	bmpman/atlas.h
 	bmpman/bm_internal.h
 	bmpman/bmpman.cpp
 	bmpman/bmpman.h
+	bmpman/texturecache.cpp
+	bmpman/texturecache.h
 )
 
 # Camera files
 set (file_root_camera
 	camera/camera.cpp
 	camera/camera.h
+	camera/flythrough.cpp
+	camera/flythrough.h
 )
 
 # CFile files
@@ -59,6 +65,7 @@ set (file_root_cfile
 	cfile/cfilearchive.cpp
 	cfile/cfilearchive.h
 	cfile/cfilelist.cpp
+	cfile/cfilereader.h
 	cfile/cfilesystem.cpp
 	cfile/cfilesystem.h
 )
@@ -152,7 +159,6 @@ endif()
 SET(file_root_def_files_files
 	def_files/ai_profiles.tbl
 	def_files/autopilot.tbl
-	def_files/bloom-comp-f.sdr
 	def_files/blur-f.sdr
 	def_files/brightpass-f.sdr
 	def_files/controlconfigdefaults.tbl
@@ -169,7 +175,6 @@ SET(file_root_def_files_files
 	def_files/fonts.tbl
 	def_files/fxaa-f.sdr
 	def_files/fxaa-v.sdr
-	def_files/fxaapre-f.sdr
 	def_files/game_settings.tbl
 	def_files/iff_defs.tbl
 	def_files/ls-f.sdr
@@ -190,6 +195,10 @@ SET(file_root_def_files_files
 	def_files/video-v.sdr
 	def_files/shield-impact-v.sdr
 	def_files/shield-impact-f.sdr
+	def_files/decal-v.sdr
+	def_files/decal-f.sdr
+	def_files/background-cubemap-v.sdr
+	def_files/background-cubemap-f.sdr
 )
 
 # ExceptionHandler files
@@ -253,8 +262,12 @@ set(file_root_generated
 set (file_root_globalincs
 	globalincs/alphacolors.cpp
 	globalincs/alphacolors.h
+	globalincs/frame_arena.cpp
+	globalincs/frame_arena.h
 	globalincs/fsmemory.h
 	globalincs/globals.h
+	globalincs/jobs.cpp
+	globalincs/jobs.h
 	globalincs/linklist.h
 	globalincs/pstypes.h
 	globalincs/safe_strings.cpp
@@ -281,6 +294,8 @@ ENDIF(WIN32)
 set(file_root_globalincs_memory
 	globalincs/memory/memory.h
 	globalincs/memory/memory.cpp
+	globalincs/memory/tracking.cpp
+	globalincs/memory/tracking.h
 	globalincs/memory/utils.h
 )
 
@@ -296,6 +311,8 @@ set(file_root_globalincs_toolchain
 set (file_root_graphics
 	graphics/2d.cpp
 	graphics/2d.h
+	graphics/decals.cpp
+	graphics/decals.h
 	graphics/grbatch.cpp
 	graphics/grbatch.h
 	graphics/grinternal.h
@@ -315,6 +332,7 @@ set (file_root_graphics_openglgr_opengl_cpps
 	graphics/opengl/gropengl.cpp
 	graphics/opengl/gropenglbmpman.cpp
 	graphics/opengl/gropengldraw.cpp
+	graphics/opengl/gropengldynres.cpp
 	graphics/opengl/gropengllight.cpp
 	graphics/opengl/gropenglpostprocessing.cpp
 	graphics/opengl/gropenglquery.cpp
@@ -330,6 +348,7 @@ set (file_root_graphics_openglgr_opengl_headers
 	graphics/opengl/gropengl.h
 	graphics/opengl/gropenglbmpman.h
 	graphics/opengl/gropengldraw.h
+	graphics/opengl/gropengldynres.h
 	graphics/opengl/gropengllight.h
 	graphics/opengl/gropenglpostprocessing.h
 	graphics/opengl/gropenglquery.h
@@ -464,6 +483,8 @@ set (file_root_inetfile
 set (file_root_io
 	io/cursor.cpp
 	io/cursor.h
+	io/framepacer.cpp
+	io/framepacer.h
 	io/key.cpp
 	io/key.h
 	io/keycontrol.cpp
@@ -630,6 +651,8 @@ set (file_root_model
 	model/model.h
 	model/modelanim.cpp
 	model/modelanim.h
+	model/modelcache.cpp
+	model/modelcache.h
 	model/modelcollide.cpp
 	model/modelinterp.cpp
 	model/modeloctant.cpp
@@ -674,6 +697,7 @@ set (file_root_network
 	network/multi_observer.h
 	network/multi_options.cpp
 	network/multi_options.h
+	network/multi_packet.h
 	network/multi_pause.cpp
 	network/multi_pause.h
 	network/multi_pinfo.cpp
@@ -682,6 +706,8 @@ set (file_root_network
 	network/multi_ping.h
 	network/multi_pmsg.cpp
 	network/multi_pmsg.h
+	network/multi_profile.cpp
+	network/multi_profile.h
 	network/multi_pxo.cpp
 	network/multi_pxo.h
 	network/multi_rate.cpp
@@ -746,6 +772,12 @@ set (file_root_object
 	object/objectsnd.cpp
 	object/objectsnd.h
 	object/objectsort.cpp
+	object/objocclusion.cpp
+	object/objocclusion.h
+	object/objspatial.cpp
+	object/objspatial.h
+	object/objtimer.cpp
+	object/objtimer.h
 	object/parseobjectdock.cpp
 	object/parseobjectdock.h
 	object/waypoint.cpp
@@ -783,10 +815,14 @@ set (file_root_parse
 	parse/parselo.h
 	parse/sexp.cpp
 	parse/sexp.h
+	parse/tablecache.cpp
+	parse/tablecache.h
 )
 
 # Particle files
 set (file_root_particle
+	particle/GpuParticles.cpp
+	particle/GpuParticles.h
 	particle/particle.cpp
 	particle/particle.h
 	particle/ParticleEffect.h
@@ -796,6 +832,8 @@ set (file_root_particle
 	particle/ParticleSource.h
 	particle/ParticleSourceWrapper.cpp
 	particle/ParticleSourceWrapper.h
+	particle/ParticleStats.cpp
+	particle/ParticleStats.h
 )
 
 set(file_root_particle_effects
@@ -855,6 +893,8 @@ set (file_root_playerman
 	playerman/managepilot.h
 	playerman/player.h
 	playerman/playercontrol.cpp
+	playerman/replay.cpp
+	playerman/replay.h
 )
 
 # pngutils files
@@ -903,6 +943,10 @@ set(file_root_scripting
 	scripting/ade_args.cpp
 	scripting/ade_args.h
 	scripting/lua.cpp
+	scripting/script_gc.cpp
+	scripting/script_gc.h
+	scripting/script_stats.cpp
+	scripting/script_stats.h
 	scripting/scripting.cpp
 	scripting/scripting.h
 )
@@ -1120,8 +1164,15 @@ set (file_root_tgautils
 
 # Tracing files
 set (file_root_tracing
+	tracing/BinaryTraceFormat.h
+	tracing/BinaryTraceWriter.h
+	tracing/BinaryTraceWriter.cpp
 	tracing/categories.cpp
 	tracing/categories.h
+	tracing/FlightRecorder.h
+	tracing/FlightRecorder.cpp
+	tracing/FrameBudget.h
+	tracing/FrameBudget.cpp
 	tracing/FrameProfiler.h
 	tracing/FrameProfiler.cpp
 	tracing/MainFrameTimer.h
@@ -1130,6 +1181,10 @@ set (file_root_tracing
 	tracing/Monitor.cpp
 	tracing/scopes.cpp
 	tracing/scopes.h
+	tracing/SimulationBenchmark.h
+	tracing/SimulationBenchmark.cpp
+	tracing/StartupProfiler.h
+	tracing/StartupProfiler.cpp
 	tracing/ThreadedEventProcessor.h
 	tracing/TraceEventWriter.h
 	tracing/TraceEventWriter.cpp
@@ -1158,6 +1213,9 @@ set (file_root_ui
 )
 
 set(file_root_utils
+	utils/spsc_queue.h
+	utils/string_intern.cpp
+	utils/string_intern.h
 	utils/strings.h
 )
 
@@ -1178,6 +1236,8 @@ set (file_root_weapon
 	weapon/flak.h
 	weapon/muzzleflash.cpp
 	weapon/muzzleflash.h
+	weapon/projectile.cpp
+	weapon/projectile.h
 	weapon/shockwave.cpp
 	weapon/shockwave.h
 	weapon/swarm.cpp
@@ -117,6 +117,11 @@ typedef struct starfield_bitmap_instance {
 static SCP_vector<starfield_bitmap> Starfield_bitmaps;
 static SCP_vector<starfield_bitmap_instance> Starfield_bitmap_instances;
 
+// the vertices of all bitmap instances stay in one static buffer until an instance changes
+static int Starfield_bitmap_buffer = -1;
+static bool Starfield_bitmap_buffer_dirty = true;
+static SCP_vector<int> Starfield_bitmap_buffer_offsets;
+
 // sun bitmaps and sun glow bitmaps
 static SCP_vector<starfield_bitmap> Sun_bitmaps;
 static SCP_vector<starfield_bitmap_instance> Suns;
@@ -181,6 +186,10 @@ static int Default_env_map = -1;
 static int Mission_env_map = -1;
 static bool Env_cubemap_drawn = false;
 
+// the skybox drawn once, see stars_setup_background_cubemap()
+static int Background_cubemap_target = -1;
+static bool Background_cubemap_drawn = false;
+
 void stars_release_debris_vclips(debris_vclip *vclips)
 {
 	int i;
@@ -258,6 +267,8 @@ static void starfield_create_bitmap_buffer(const int si_idx)
 
 	starfield_bitmap_instance *sbi = &Starfield_bitmap_instances[si_idx];
 
+	Starfield_bitmap_buffer_dirty = true;
+
 	angles *a = &sbi->ang;
 	float scale_x = sbi->scale_x;
 	float scale_y = sbi->scale_y;
@@ -693,6 +704,8 @@ void stars_clear_instances()
 
 	Starfield_bitmap_instances.clear();
 	Suns.clear();
+
+	Starfield_bitmap_buffer_dirty = true;
 }
 
 // call on game startup
@@ -788,6 +801,7 @@ void stars_pre_level_init(bool clear_backgrounds)
 	Motion_debris_override = false;
 
 	Env_cubemap_drawn = false;
+	Background_cubemap_drawn = false;
 }
 
 // setup the render target ready for this mission's environment map
@@ -907,6 +921,13 @@ void stars_level_close() {
 		}
 	}
 
+	if (Background_cubemap_target >= 0) {
+		if ( bm_release(Background_cubemap_target, 1) ) {
+			Background_cubemap_target = -1;
+		}
+	}
+	Background_cubemap_drawn = false;
+
 	if (Mission_env_map >= 0) {
 		bm_release(Mission_env_map);
 		Mission_env_map = -1;
@@ -1310,6 +1331,39 @@ void stars_draw_sun_glow(int sun_n)
 	//gr_zbuffer_set(zbuff);
 }
 
+/**
+ * Copies the vertices of all bitmap instances into the static buffer if any of them changed
+ */
+static void stars_upload_bitmap_buffer()
+{
+	if ( !Starfield_bitmap_buffer_dirty ) {
+		return;
+	}
+
+	SCP_vector<vertex> verts;
+	Starfield_bitmap_buffer_offsets.resize(Starfield_bitmap_instances.size());
+
+	for (size_t idx = 0; idx < Starfield_bitmap_instances.size(); idx++) {
+		starfield_bitmap_instance *sbi = &Starfield_bitmap_instances[idx];
+
+		Starfield_bitmap_buffer_offsets[idx] = (int)verts.size();
+
+		if (sbi->verts != NULL) {
+			verts.insert(verts.end(), sbi->verts, sbi->verts + sbi->n_verts);
+		}
+	}
+
+	if (Starfield_bitmap_buffer < 0) {
+		Starfield_bitmap_buffer = gr_create_vertex_buffer(true);
+	}
+
+	if (Starfield_bitmap_buffer >= 0 && !verts.empty()) {
+		gr_update_buffer_data(Starfield_bitmap_buffer, verts.size() * sizeof(vertex), &verts[0]);
+	}
+
+	Starfield_bitmap_buffer_dirty = false;
+}
+
 void stars_draw_bitmaps(int show_bitmaps)
 {
 	GR_DEBUG_SCOPE("Draw Bitmaps");
@@ -1332,6 +1386,12 @@ void stars_draw_bitmaps(int show_bitmaps)
 
 	gr_start_instance_matrix(&Eye_position, &vmd_identity_matrix);
 
+	stars_upload_bitmap_buffer();
+
+	vertex_layout layout;
+	layout.add_vertex_component(vertex_format_data::POSITION3, sizeof(vertex), (int)offsetof(vertex, world));
+	layout.add_vertex_component(vertex_format_data::TEX_COORD, sizeof(vertex), (int)offsetof(vertex, texture_position));
+
 	int sb_instances = (int)Starfield_bitmap_instances.size();
 
 	for (idx = 0; idx < sb_instances; idx++) {
@@ -1371,7 +1431,12 @@ void stars_draw_bitmaps(int show_bitmaps)
 
 		material material_params;
 		material_set_unlit(&material_params, bitmap_id, alpha, blending, false);
-		g3_render_primitives_textured(&material_params, Starfield_bitmap_instances[idx].verts, Starfield_bitmap_instances[idx].n_verts, PRIM_TYPE_TRIS, false);
+
+		if (Starfield_bitmap_buffer >= 0) {
+			gr_render_primitives(&material_params, PRIM_TYPE_TRIS, &layout, Starfield_bitmap_buffer_offsets[idx], Starfield_bitmap_instances[idx].n_verts, Starfield_bitmap_buffer);
+		} else {
+			g3_render_primitives_textured(&material_params, Starfield_bitmap_instances[idx].verts, Starfield_bitmap_instances[idx].n_verts, PRIM_TYPE_TRIS, false);
+		}
 	}
 	
 	gr_end_instance_matrix();
@@ -1759,6 +1824,25 @@ void stars_draw_debris()
 	reload_old_debris = 0;
 }
 
+// if the skybox looks the same every frame apart from the view direction
+static bool stars_background_is_static()
+{
+	if ( !Cmdline_cached_background || Fred_running ) {
+		return false;
+	}
+
+	if ( Game_subspace_effect ) {
+		return false;
+	}
+
+	// no skybox or it is turning
+	if ( (Nmodel_num < 0) || (Nmodel_instance_num >= 0) ) {
+		return false;
+	}
+
+	return true;
+}
+
 void stars_draw(int show_stars, int show_suns, int show_nebulas, int show_subspace, int env)
 {
 	GR_DEBUG_SCOPE("Draw Stars");
@@ -1780,8 +1864,14 @@ void stars_draw(int show_stars, int show_suns, int show_nebulas, int show_subspa
 	xt1 = timer_get_fixed_seconds();
 #endif
 	
+	bool cached_background = !env && show_stars && !show_subspace && Background_cubemap_drawn
+		&& (Background_cubemap_target >= 0) && stars_background_is_static();
+
 	// draw background stuff
-	if ( show_stars ) {
+	if ( cached_background ) {
+		gr_render_background_cubemap(Background_cubemap_target);
+	}
+	else if ( show_stars ) {
 		// semi-hack, do we don't fog the background
 		int neb_save = Neb2_render_mode;
 		Neb2_render_mode = NEB2_RENDER_NONE;
@@ -2447,6 +2537,8 @@ void stars_mark_instance_unused(int index, bool is_a_sun)
 	if ( !is_a_sun ) {
 		delete [] Starfield_bitmap_instances[index].verts;
 		Starfield_bitmap_instances[index].verts = NULL;
+
+		Starfield_bitmap_buffer_dirty = true;
 	}
 
 	// The background changed so we need to invalidate the environment map
@@ -2594,6 +2686,8 @@ void stars_delete_entry_FRED(int index, bool is_a_sun)
 		Suns.erase( Suns.begin() + index );
 	} else {
 		Starfield_bitmap_instances.erase( Starfield_bitmap_instances.begin() + index );
+
+		Starfield_bitmap_buffer_dirty = true;
 	}
 }
 
@@ -2738,6 +2832,66 @@ void stars_pack_backgrounds()
 	}
 }
 
+/*
+ * Envmap matrix setup -- left-handed
+ * -------------------------------------------------
+ * Face --	Forward		Up		Right
+ * px		+X			+Y		-Z
+ * nx		-X			+Y		+Z
+ * py		+Y			-Z		+X
+ * ny		-Y			+Z		+X
+ * pz		+Z 			+Y		+X
+ * nz		-Z			+Y		-X
+*/
+// NOTE: OpenGL needs up/down reversed
+static void stars_get_cubemap_face_orient(int face, matrix *orient)
+{
+	memset( orient, 0, sizeof(matrix) );
+
+	switch (face) {
+	case 0:	// px / right
+		orient->vec.fvec.xyz.x =  1.0f;
+		orient->vec.uvec.xyz.y =  1.0f;
+		orient->vec.rvec.xyz.z = -1.0f;
+		break;
+
+	case 1:	// nx / left
+		orient->vec.fvec.xyz.x = -1.0f;
+		orient->vec.uvec.xyz.y =  1.0f;
+		orient->vec.rvec.xyz.z =  1.0f;
+		break;
+
+	case 2:	// py / up
+		orient->vec.fvec.xyz.y =  (gr_screen.mode == GR_OPENGL) ?  1.0f : -1.0f;
+		orient->vec.uvec.xyz.z =  (gr_screen.mode == GR_OPENGL) ? -1.0f :  1.0f;
+		orient->vec.rvec.xyz.x =  1.0f;
+		break;
+
+	case 3:	// ny / down
+		orient->vec.fvec.xyz.y =  (gr_screen.mode == GR_OPENGL) ? -1.0f :  1.0f;
+		orient->vec.uvec.xyz.z =  (gr_screen.mode == GR_OPENGL) ?  1.0f : -1.0f;
+		orient->vec.rvec.xyz.x =  1.0f;
+		break;
+
+	case 4:	// pz / forward
+		orient->vec.fvec.xyz.z =  1.0f;
+		orient->vec.uvec.xyz.y =  1.0f;
+		orient->vec.rvec.xyz.x =  1.0f;
+		break;
+
+	case 5:	// nz / back
+		orient->vec.fvec.xyz.z = -1.0f;
+		orient->vec.uvec.xyz.y =  1.0f;
+		orient->vec.rvec.xyz.x = -1.0f;
+		break;
+
+	default:
+		Int3();
+		*orient = vmd_identity_matrix;
+		break;
+	}
+}
+
 static void render_environment(int i, vec3d *eye_pos, matrix *new_orient, float new_zoom)
 {
 	bm_set_render_target(gr_screen.envmap_render_target, i);
@@ -2803,69 +2957,13 @@ void stars_setup_environment_mapping(camid cid) {
 
 	ENVMAP = gr_screen.envmap_render_target;
 
-	/*
-	 * Envmap matrix setup -- left-handed
-	 * -------------------------------------------------
-	 * Face --	Forward		Up		Right
-	 * px		+X			+Y		-Z
-	 * nx		-X			+Y		+Z
-	 * py		+Y			-Z		+X
-	 * ny		-Y			+Z		+X
-	 * pz		+Z 			+Y		+X
-	 * nz		-Z			+Y		-X
-	*/
-	// NOTE: OpenGL needs up/down reversed
-
 	// Save the previous render target so we can reset it once we are done here
 	auto previous_target = gr_screen.rendering_to_texture;
 
-	// face 1 (px / right)
-	memset( &new_orient, 0, sizeof(matrix) );
-	new_orient.vec.fvec.xyz.x =  1.0f;
-	new_orient.vec.uvec.xyz.y =  1.0f;
-	new_orient.vec.rvec.xyz.z = -1.0f;
-	render_environment(i, &cam_pos, &new_orient, new_zoom);
-	i++; // bump!
-
-	// face 2 (nx / left)
-	memset( &new_orient, 0, sizeof(matrix) );
-	new_orient.vec.fvec.xyz.x = -1.0f;
-	new_orient.vec.uvec.xyz.y =  1.0f;
-	new_orient.vec.rvec.xyz.z =  1.0f;
-	render_environment(i, &cam_pos, &new_orient, new_zoom);
-	i++; // bump!
-
-	// face 3 (py / up)
-	memset( &new_orient, 0, sizeof(matrix) );
-	new_orient.vec.fvec.xyz.y =  (gr_screen.mode == GR_OPENGL) ?  1.0f : -1.0f;
-	new_orient.vec.uvec.xyz.z =  (gr_screen.mode == GR_OPENGL) ? -1.0f :  1.0f;
-	new_orient.vec.rvec.xyz.x =  1.0f;
-	render_environment(i, &cam_pos, &new_orient, new_zoom);
-	i++; // bump!
-
-	// face 4 (ny / down)
-	memset( &new_orient, 0, sizeof(matrix) );
-	new_orient.vec.fvec.xyz.y =  (gr_screen.mode == GR_OPENGL) ? -1.0f :  1.0f;
-	new_orient.vec.uvec.xyz.z =  (gr_screen.mode == GR_OPENGL) ?  1.0f : -1.0f;
-	new_orient.vec.rvec.xyz.x =  1.0f;
-	render_environment(i, &cam_pos, &new_orient, new_zoom);
-	i++; // bump!
-
-	// face 5 (pz / forward)
-	memset( &new_orient, 0, sizeof(matrix) );
-	new_orient.vec.fvec.xyz.z =  1.0f;
-	new_orient.vec.uvec.xyz.y =  1.0f;
-	new_orient.vec.rvec.xyz.x =  1.0f;
-	render_environment(i, &cam_pos, &new_orient, new_zoom);
-	i++; // bump!
-
-	// face 6 (nz / back)
-	memset( &new_orient, 0, sizeof(matrix) );
-	new_orient.vec.fvec.xyz.z = -1.0f;
-	new_orient.vec.uvec.xyz.y =  1.0f;
-	new_orient.vec.rvec.xyz.x = -1.0f;
-	render_environment(i, &cam_pos, &new_orient, new_zoom);
-
+	for (i = 0; i < 6; i++) {
+		stars_get_cubemap_face_orient(i, &new_orient);
+		render_environment(i, &cam_pos, &new_orient, new_zoom);
+	}
 
 	// we're done, so now reset
 	bm_set_render_target(previous_target);
@@ -2875,6 +2973,74 @@ void stars_setup_environment_mapping(camid cid) {
 		Env_cubemap_drawn = true;
 	}
 }
+void stars_setup_background_cubemap(camid cid) {
+	if ( !cid.isValid() || !stars_background_is_static() ) {
+		return;
+	}
+
+	if ( Background_cubemap_drawn ) {
+		return;
+	}
+
+	if ( Background_cubemap_target < 0 ) {
+		int size = (gr_screen.max_h > 768) ? 2048 : 1024;
+
+		Background_cubemap_target = bm_make_render_target(size, size, BMP_FLAG_RENDER_TARGET_STATIC | BMP_FLAG_CUBEMAP);
+
+		if ( Background_cubemap_target < 0 ) {
+			mprintf(("Unable to create the background cubemap, drawing the background every frame.\n"));
+			Cmdline_cached_background = false;
+			return;
+		}
+	}
+
+	GR_DEBUG_SCOPE("Background Cubemap");
+	TRACE_SCOPE(tracing::BackgroundCubemap);
+
+	extern float View_zoom;
+	float old_zoom = View_zoom;
+
+	vec3d cam_pos;
+	matrix cam_orient;
+	cid.getCamera()->get_info(&cam_pos, &cam_orient);
+
+	auto previous_target = gr_screen.rendering_to_texture;
+
+	int gr_zbuffering_save = gr_zbuffer_get();
+	gr_zbuffer_set(GR_ZBUFF_NONE);
+
+	// the background isn't fogged, see stars_draw()
+	int neb_save = Neb2_render_mode;
+	Neb2_render_mode = NEB2_RENDER_NONE;
+
+	for (int i = 0; i < 6; i++) {
+		matrix new_orient;
+		stars_get_cubemap_face_orient(i, &new_orient);
+
+		bm_set_render_target(Background_cubemap_target, i);
+
+		gr_clear();
+
+		g3_set_view_matrix( &cam_pos, &new_orient, 1.0f );
+
+		gr_set_proj_matrix( PI_2, 1.0f, Min_draw_distance, Max_draw_distance);
+		gr_set_view_matrix( &Eye_position, &Eye_matrix );
+
+		stars_draw_background();
+
+		gr_end_view_matrix();
+		gr_end_proj_matrix();
+	}
+
+	Neb2_render_mode = neb_save;
+	gr_zbuffer_set(gr_zbuffering_save);
+
+	bm_set_render_target(previous_target);
+	g3_set_view_matrix( &cam_pos, &cam_orient, old_zoom );
+
+	Background_cubemap_drawn = true;
+}
+
 void stars_set_dynamic_environment(bool dynamic) {
 	Dynamic_environment = dynamic;
 	stars_invalidate_environment_map();
@@ -2882,4 +3048,5 @@ void stars_set_dynamic_environment(bool dynamic) {
 void stars_invalidate_environment_map() {
 	// This will cause a redraw in the next frame
 	Env_cubemap_drawn = false;
+	Background_cubemap_drawn = false;
 }
@@ -148,6 +148,16 @@ void stars_load_background(int background_idx);
 
 void stars_setup_environment_mapping(camid cid);
 
+/**
+ * @brief Draws the skybox into a cubemap if it isn't up to date
+ *
+ * With -cached_background the skybox is only drawn once and stars_draw() shows the cubemap instead as long as it
+ * doesn't turn. The suns and the background bitmaps are still drawn on top of it every frame.
+ *
+ * @param cid The camera of the frame
+ */
+void stars_setup_background_cubemap(camid cid);
+
 /**
  * @brief Enabled dynamic rendering of environment map
  * @param dynamic @c true if the environment should be dynamic
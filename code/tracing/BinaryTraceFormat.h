@@ -0,0 +1,66 @@
+#pragma once
+
+// This is also used by tools/traceconv which is built without the engine so only the standard library may be used here
+#include <cstddef>
+#include <cstdint>
+
+/** @file
+ *  @ingroup tracing
+ *
+ *  The binary trace format written with -binary_profiling.
+ *
+ *  A file starts with the 8 characters of MAGIC and the version as a 32-bit little endian integer. Everything after
+ *  that are blocks which are compressed with zlib, each one starting with its compressed and its uncompressed size as
+ *  32-bit little endian integers. A block holds whole records, the first byte of a record is its type:
+ *  - RECORD_STRING: the id and the length of the string followed by its characters. These are the names of the
+ *    categories and scopes, ids start at 1 so 0 can mean "none".
+ *  - RECORD_THREAD: the id of the thread followed by its process and thread id. The process of the GPU events is
+ *    tracing::GPU_PID.
+ *  - RECORD_EVENT + the event code: the id of the thread, the time stamp as the difference to the last event of that
+ *    thread, the string id of the category and the string id of the scope. Complete events add their duration,
+ *    counter events their value as a 32-bit little endian float and flow events the id of their flow. The category of
+ *    a thread name event is the name of the thread.
+ *
+ *  Times are in nanoseconds. Integers are written 7 bits per byte starting with the lowest bits, the highest bit of a
+ *  byte is set if another byte follows. Signed integers are zigzag encoded first so small negative values stay short.
+ *  Strings and threads are always written before the first event which uses them, the ids stay valid for the rest of
+ *  the file.
+ *
+ *  Version 2 added the flow and thread name events, a version 1 file is also a valid version 2 file.
+ */
+
+namespace tracing {
+namespace binary_trace {
+
+const char MAGIC[8] = { 'F', 'S', 'O', 'T', 'R', 'A', 'C', 'E' };
+const std::uint32_t VERSION = 2;
+
+// a block is compressed and written once it is at least this big
+const size_t BLOCK_SIZE = 64 * 1024;
+
+const std::uint8_t RECORD_STRING = 1;
+const std::uint8_t RECORD_THREAD = 2;
+const std::uint8_t RECORD_EVENT = 16;
+
+// the event types in the file, these don't change when tracing::EventType does
+const std::uint8_t EVENT_COMPLETE = 0;
+const std::uint8_t EVENT_BEGIN = 1;
+const std::uint8_t EVENT_END = 2;
+const std::uint8_t EVENT_ASYNC_BEGIN = 3;
+const std::uint8_t EVENT_ASYNC_STEP = 4;
+const std::uint8_t EVENT_ASYNC_END = 5;
+const std::uint8_t EVENT_COUNTER = 6;
+const std::uint8_t EVENT_FLOW_BEGIN = 7;
+const std::uint8_t EVENT_FLOW_END = 8;
+const std::uint8_t EVENT_THREAD_NAME = 9;
+
+inline std::uint64_t zigzag_encode(std::int64_t value) {
+	return (static_cast<std::uint64_t>(value) << 1) ^ static_cast<std::uint64_t>(value >> 63);
+}
+
+inline std::int64_t zigzag_decode(std::uint64_t value) {
+	return static_cast<std::int64_t>(value >> 1) ^ -static_cast<std::int64_t>(value & 1);
+}
+
+}
+}
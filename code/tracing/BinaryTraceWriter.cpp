@@ -0,0 +1,183 @@
+
+#include "tracing/BinaryTraceWriter.h"
+#include "tracing/BinaryTraceFormat.h"
+
+#include <zlib.h>
+
+namespace
+{
+using namespace tracing;
+
+ubyte getEventCode(EventType type) {
+	switch (type) {
+		case EventType::Complete:
+			return binary_trace::EVENT_COMPLETE;
+		case EventType::Begin:
+			return binary_trace::EVENT_BEGIN;
+		case EventType::End:
+			return binary_trace::EVENT_END;
+		case EventType::AsyncBegin:
+			return binary_trace::EVENT_ASYNC_BEGIN;
+		case EventType::AsyncStep:
+			return binary_trace::EVENT_ASYNC_STEP;
+		case EventType::AsyncEnd:
+			return binary_trace::EVENT_ASYNC_END;
+		case EventType::Counter:
+			return binary_trace::EVENT_COUNTER;
+		case EventType::FlowBegin:
+			return binary_trace::EVENT_FLOW_BEGIN;
+		case EventType::FlowEnd:
+			return binary_trace::EVENT_FLOW_END;
+		case EventType::ThreadName:
+			return binary_trace::EVENT_THREAD_NAME;
+		default:
+			Assertion(false, "Invalid enum value!");
+			return binary_trace::EVENT_COMPLETE;
+	}
+}
+}
+
+namespace tracing
+{
+
+BinaryTraceWriter::BinaryTraceWriter() : _out("tracing/trace.fstrace", std::ios::binary) {
+	_block.reserve(binary_trace::BLOCK_SIZE + 1024);
+
+	SCP_vector<ubyte> header(binary_trace::MAGIC, binary_trace::MAGIC + sizeof(binary_trace::MAGIC));
+	writeUInt32(binary_trace::VERSION, header);
+
+	_out.write(reinterpret_cast<const char*>(header.data()), header.size());
+}
+
+BinaryTraceWriter::~BinaryTraceWriter() {
+	flushBlock();
+	_out.close();
+}
+
+void BinaryTraceWriter::writeByte(ubyte value) {
+	_block.push_back(value);
+}
+
+void BinaryTraceWriter::writeVarUInt(std::uint64_t value) {
+	while (value >= 0x80) {
+		_block.push_back(static_cast<ubyte>(value | 0x80));
+		value >>= 7;
+	}
+	_block.push_back(static_cast<ubyte>(value));
+}
+
+void BinaryTraceWriter::writeVarInt(std::int64_t value) {
+	writeVarUInt(binary_trace::zigzag_encode(value));
+}
+
+void BinaryTraceWriter::writeUInt32(std::uint32_t value, SCP_vector<ubyte>& out) {
+	for (int i = 0; i < 4; ++i) {
+		out.push_back(static_cast<ubyte>(value >> (i * 8)));
+	}
+}
+
+std::uint64_t BinaryTraceWriter::internString(const char* str) {
+	if (str == nullptr) {
+		return 0;
+	}
+
+	// Categories may be created at runtime so the pointer of a name can't be used to identify it
+	auto iter = _strings.find(str);
+	if (iter != _strings.end()) {
+		return iter->second;
+	}
+
+	auto id = static_cast<std::uint64_t>(_strings.size() + 1);
+	_strings.emplace(str, id);
+
+	auto len = strlen(str);
+
+	writeByte(binary_trace::RECORD_STRING);
+	writeVarUInt(id);
+	writeVarUInt(len);
+	_block.insert(_block.end(), str, str + len);
+
+	return id;
+}
+
+BinaryTraceWriter::thread_state& BinaryTraceWriter::internThread(std::int64_t pid, std::int64_t tid) {
+	auto key = std::make_pair(pid, tid);
+
+	auto iter = _threads.find(key);
+	if (iter != _threads.end()) {
+		return iter->second;
+	}
+
+	thread_state state;
+	state.id = static_cast<std::uint64_t>(_threads.size() + 1);
+	state.last_timestamp = 0;
+
+	writeByte(binary_trace::RECORD_THREAD);
+	writeVarUInt(state.id);
+	writeVarInt(pid);
+	writeVarInt(tid);
+
+	return _threads.emplace(key, state).first->second;
+}
+
+void BinaryTraceWriter::flushBlock() {
+	if (_block.empty()) {
+		return;
+	}
+
+	auto compressed_size = compressBound(static_cast<uLong>(_block.size()));
+
+	_compressed.clear();
+	writeUInt32(0, _compressed);
+	writeUInt32(static_cast<std::uint32_t>(_block.size()), _compressed);
+	_compressed.resize(8 + compressed_size);
+
+	// The default level is too slow to keep up with the events of a busy frame
+	if (compress2(_compressed.data() + 8, &compressed_size, _block.data(), static_cast<uLong>(_block.size()), Z_BEST_SPEED) != Z_OK) {
+		mprintf(("Failed to compress a block of the binary trace, %d bytes were lost!\n", static_cast<int>(_block.size())));
+		_block.clear();
+		return;
+	}
+
+	for (int i = 0; i < 4; ++i) {
+		_compressed[i] = static_cast<ubyte>(compressed_size >> (i * 8));
+	}
+
+	_out.write(reinterpret_cast<const char*>(_compressed.data()), 8 + compressed_size);
+	_block.clear();
+}
+
+void BinaryTraceWriter::processEvent(const trace_event* event) {
+	auto category = internString(event->category->getName());
+	auto scope = internString(event->scope != nullptr ? event->scope->getName() : nullptr);
+	auto& thread = internThread(event->pid, event->tid);
+
+	auto code = getEventCode(event->type);
+
+	writeByte(binary_trace::RECORD_EVENT + code);
+	writeVarUInt(thread.id);
+	writeVarInt(static_cast<std::int64_t>(event->timestamp - thread.last_timestamp));
+	writeVarUInt(category);
+	writeVarUInt(scope);
+
+	thread.last_timestamp = event->timestamp;
+
+	if (code == binary_trace::EVENT_COMPLETE) {
+		writeVarUInt(event->duration);
+	} else if (code == binary_trace::EVENT_COUNTER) {
+		std::uint32_t bits;
+		static_assert(sizeof(bits) == sizeof(event->value), "Counter values must be 32-bit floats!");
+		memcpy(&bits, &event->value, sizeof(bits));
+
+		for (int i = 0; i < 4; ++i) {
+			writeByte(static_cast<ubyte>(bits >> (i * 8)));
+		}
+	} else if (code == binary_trace::EVENT_FLOW_BEGIN || code == binary_trace::EVENT_FLOW_END) {
+		writeVarUInt(event->flow_id);
+	}
+
+	if (_block.size() >= binary_trace::BLOCK_SIZE) {
+		flushBlock();
+	}
+}
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include "globalincs/pstypes.h"
+#include "tracing/tracing.h"
+
+#include "tracing/ThreadedEventProcessor.h"
+
+#include <fstream>
+
+/** @file
+ *  @ingroup tracing
+ */
+
+namespace tracing
+{
+/**
+ * @brief Writes the events in the compressed binary format of BinaryTraceFormat.h
+ *
+ * This is much smaller and cheaper to write than the JSON of TraceEventWriter, tools/traceconv turns it into that JSON.
+ */
+class BinaryTraceWriter
+{
+	struct thread_state {
+		std::uint64_t id;
+		std::uint64_t last_timestamp;
+	};
+
+	std::ofstream _out;
+
+	SCP_vector<ubyte> _block;
+	SCP_vector<ubyte> _compressed;
+
+	SCP_unordered_map<SCP_string, std::uint64_t> _strings;
+	SCP_map<std::pair<std::int64_t, std::int64_t>, thread_state> _threads;
+
+	void writeByte(ubyte value);
+	void writeVarUInt(std::uint64_t value);
+	void writeVarInt(std::int64_t value);
+	void writeUInt32(std::uint32_t value, SCP_vector<ubyte>& out);
+
+	std::uint64_t internString(const char* str);
+	thread_state& internThread(std::int64_t pid, std::int64_t tid);
+
+	void flushBlock();
+
+public:
+	BinaryTraceWriter();
+	~BinaryTraceWriter();
+
+	void processEvent(const trace_event* event);
+};
+
+typedef ThreadedEventProcessor<BinaryTraceWriter> ThreadedBinaryTraceWriter;
+}
@@ -0,0 +1,124 @@
+
+#include "tracing/FlightRecorder.h"
+#include "tracing/TraceEventWriter.h"
+#include "parse/parselo.h"
+
+#include <algorithm>
+
+namespace {
+
+// the number of events kept per thread, this limits how far back a busy thread goes
+const size_t RING_EVENTS = 1 << 16;
+
+// every recorder gets its own generation so a thread doesn't use the ring of an earlier one
+std::atomic<int> next_generation(0);
+
+}
+
+namespace tracing {
+
+thread_local FlightRecorder::thread_ring* FlightRecorder::_current_ring = nullptr;
+thread_local int FlightRecorder::_current_generation = -1;
+
+FlightRecorder::FlightRecorder(std::uint64_t window_ns, std::uint64_t hitch_ns)
+	: _window_ns(window_ns), _hitch_ns(hitch_ns), _generation(++next_generation), _dump_pending(false) {
+}
+
+FlightRecorder::thread_ring* FlightRecorder::getRing() {
+	if (_current_generation != _generation) {
+		std::unique_ptr<thread_ring> ring(new thread_ring());
+		ring->events.resize(RING_EVENTS);
+
+		_current_ring = ring.get();
+		_current_generation = _generation;
+
+		std::lock_guard<std::mutex> lock(_rings_mutex);
+		_rings.push_back(std::move(ring));
+	}
+
+	return _current_ring;
+}
+
+void FlightRecorder::processEvent(const trace_event* event) {
+	if (event->type == EventType::ThreadName) {
+		// These would be overwritten in a busy ring, every dump gets the current names instead
+		return;
+	}
+
+	if (event->type == EventType::Complete) {
+		if (event->duration < 1000) {
+			// The trace event writer discards these anyway
+			return;
+		}
+
+		if (_hitch_ns > 0 && event->category == &MainFrame && event->pid != GPU_PID && event->duration >= _hitch_ns) {
+			_dump_pending = true;
+		}
+	}
+
+	auto ring = getRing();
+
+	std::lock_guard<std::mutex> lock(ring->mutex);
+
+	ring->events[ring->next] = *event;
+	if (++ring->next == ring->events.size()) {
+		ring->next = 0;
+		ring->wrapped = true;
+	}
+}
+
+bool FlightRecorder::dumpPending() const {
+	return _dump_pending;
+}
+
+void FlightRecorder::dump(std::uint64_t now, const char* reason, const SCP_vector<trace_event>& thread_names) {
+	auto hitch = _dump_pending.exchange(false);
+
+	if (hitch && now < _next_hitch_dump) {
+		// This hitch is part of the last dump or was caused by writing it
+		return;
+	}
+
+	auto start = now > _window_ns ? now - _window_ns : 0;
+
+	SCP_vector<trace_event> events;
+	{
+		std::lock_guard<std::mutex> rings_lock(_rings_mutex);
+
+		for (auto& ring : _rings) {
+			std::lock_guard<std::mutex> lock(ring->mutex);
+
+			auto count = ring->wrapped ? ring->events.size() : ring->next;
+			for (size_t i = 0; i < count; ++i) {
+				auto& evt = ring->events[i];
+
+				if (evt.timestamp + evt.duration >= start) {
+					events.push_back(evt);
+				}
+			}
+		}
+	}
+
+	std::sort(events.begin(), events.end(),
+		[](const trace_event& left, const trace_event& right) { return left.timestamp < right.timestamp; });
+
+	SCP_string filename;
+	sprintf(filename, "tracing/flight_recorder_%03d.json", _dumps++);
+
+	{
+		TraceEventWriter writer(filename.c_str());
+
+		for (auto& evt : thread_names) {
+			writer.processEvent(&evt);
+		}
+		for (auto& evt : events) {
+			writer.processEvent(&evt);
+		}
+	}
+
+	mprintf(("Flight recorder (%s): wrote %d events to %s\n", reason, (int)events.size(), filename.c_str()));
+
+	_next_hitch_dump = now + _window_ns;
+}
+
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include "globalincs/pstypes.h"
+
+#include "tracing/tracing.h"
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+
+/** @file
+ *  @ingroup tracing
+ */
+
+namespace tracing {
+
+/**
+ * @brief Keeps the last events of every thread in memory so they can be written out after something went wrong
+ *
+ * Every thread which submits events gets its own ring buffer of a fixed size, so recording an event only copies it and
+ * never waits for another thread. When a main frame takes longer than the hitch threshold a dump is requested, which
+ * writes the events of the last seconds in the same format as -json_profiling.
+ */
+class FlightRecorder {
+	struct thread_ring {
+		// only ever contended while a dump copies the ring
+		std::mutex mutex;
+		SCP_vector<trace_event> events;
+		size_t next = 0;
+		bool wrapped = false;
+	};
+
+	std::uint64_t _window_ns;
+	std::uint64_t _hitch_ns;
+	int _generation;
+
+	std::mutex _rings_mutex;
+	SCP_vector<std::unique_ptr<thread_ring>> _rings;
+
+	std::atomic<bool> _dump_pending;
+	std::uint64_t _next_hitch_dump = 0;
+	int _dumps = 0;
+
+	static thread_local thread_ring* _current_ring;
+	static thread_local int _current_generation;
+
+	thread_ring* getRing();
+
+ public:
+	/**
+	 * @param window_ns How far back a dump goes
+	 * @param hitch_ns How long a main frame has to take for a dump, 0 for never
+	 */
+	FlightRecorder(std::uint64_t window_ns, std::uint64_t hitch_ns);
+
+	/**
+	 * @brief Records an event, may be called from every thread at the same time
+	 */
+	void processEvent(const trace_event* event);
+
+	/**
+	 * @return @c true if a hitch was recorded which wasn't written out yet
+	 */
+	bool dumpPending() const;
+
+	/**
+	 * @brief Writes the events of the last seconds to tracing/flight_recorder_<number>.json
+	 *
+	 * @param now The current time, relative to the start of the tracing like the time stamps of the events
+	 * @param reason Why the events are written, for the log
+	 * @param thread_names The ThreadName events of all named threads, the recorder doesn't keep these itself
+	 */
+	void dump(std::uint64_t now, const char* reason, const SCP_vector<trace_event>& thread_names);
+};
+
+}
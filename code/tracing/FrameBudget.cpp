@@ -0,0 +1,125 @@
+
+#include "tracing/FrameBudget.h"
+
+#include <algorithm>
+
+namespace {
+
+float to_ms(std::uint64_t ns) {
+	return static_cast<float>(ns / 1000000.);
+}
+
+}
+
+namespace tracing {
+
+FrameBudget::timeline::timeline(std::initializer_list<const Category*> stages) : categories(stages) {
+	for (auto category : categories) {
+		names.push_back(category->getName());
+	}
+	names.push_back("Other");
+
+	current.resize(names.size(), 0);
+	history.resize(FRAME_BUDGET_HISTORY * names.size(), 0.0f);
+}
+
+void FrameBudget::timeline::add(const Category* category, std::uint64_t begin, std::uint64_t end) {
+	auto iter = std::find(categories.begin(), categories.end(), category);
+	if (iter == categories.end()) {
+		return;
+	}
+
+	// Scopes are submitted when they end so the ones inside of this scope are already here
+	auto time = end - begin;
+	for (auto it = outer.begin(); it != outer.end();) {
+		if (it->begin >= begin && it->end <= end) {
+			time -= std::min(time, it->end - it->begin);
+			it = outer.erase(it);
+		} else {
+			++it;
+		}
+	}
+	outer.push_back({ begin, end });
+
+	current[iter - categories.begin()] += time;
+}
+
+void FrameBudget::timeline::finish(std::uint64_t duration) {
+	auto stages = names.size();
+	auto other = duration;
+
+	for (size_t i = 0; i < stages - 1; ++i) {
+		history[next * stages + i] = to_ms(current[i]);
+		other -= std::min(other, current[i]);
+	}
+	history[next * stages + stages - 1] = to_ms(other);
+
+	next = (next + 1) % FRAME_BUDGET_HISTORY;
+	frames = std::min(frames + 1, FRAME_BUDGET_HISTORY);
+
+	std::fill(current.begin(), current.end(), 0);
+	outer.clear();
+}
+
+void FrameBudget::timeline::get(frame_budget_history& out) const {
+	auto stages = names.size();
+
+	out.stages = names;
+	out.times.clear();
+	out.times.reserve(frames * stages);
+
+	auto first = (next + FRAME_BUDGET_HISTORY - frames) % FRAME_BUDGET_HISTORY;
+	for (size_t i = 0; i < frames; ++i) {
+		auto frame = history.begin() + ((first + i) % FRAME_BUDGET_HISTORY) * stages;
+		out.times.insert(out.times.end(), frame, frame + stages);
+	}
+}
+
+FrameBudget::FrameBudget(std::int64_t main_thread_id)
+	: _main_thread_id(main_thread_id), _cpu({ &Simulation, &RenderScene, &SubmitDraws, &LuaOnFrame, &PageFlip }),
+	  _gpu({ &BuildShadowMap, &RenderScene, &DrawPostEffects, &LuaOnFrame }) {
+}
+
+void FrameBudget::processEvent(const trace_event* event) {
+	if (event->pid == GPU_PID) {
+		// The GPU scopes are submitted as begin and end events once their queries are done
+		if (event->type == EventType::Begin) {
+			_gpu_open.push_back({ event->category, event->timestamp });
+		} else if (event->type == EventType::End) {
+			auto iter = std::find_if(_gpu_open.rbegin(), _gpu_open.rend(),
+				[event](const gpu_begin& begin) { return begin.category == event->category; });
+
+			if (iter == _gpu_open.rend()) {
+				return;
+			}
+
+			auto begin = iter->timestamp;
+			_gpu_open.erase(std::next(iter).base(), _gpu_open.end());
+
+			if (event->category == &MainFrame) {
+				_gpu.finish(event->timestamp - begin);
+			} else {
+				_gpu.add(event->category, begin, event->timestamp);
+			}
+		}
+		return;
+	}
+
+	if (event->type != EventType::Complete || event->tid != _main_thread_id) {
+		// The stages of the frame are the ones of the main thread
+		return;
+	}
+
+	if (event->category == &MainFrame) {
+		_cpu.finish(event->duration);
+	} else {
+		_cpu.add(event->category, event->timestamp, event->timestamp + event->duration);
+	}
+}
+
+void FrameBudget::getHistory(frame_budget_history& cpu, frame_budget_history& gpu) const {
+	_cpu.get(cpu);
+	_gpu.get(gpu);
+}
+
+}
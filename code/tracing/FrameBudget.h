@@ -0,0 +1,87 @@
+#pragma once
+
+#include "globalincs/pstypes.h"
+
+#include "tracing/tracing.h"
+
+#include <initializer_list>
+
+/** @file
+ *  @ingroup tracing
+ */
+
+namespace tracing {
+
+/**
+ * @brief How many frames the history of the stages goes back
+ */
+const size_t FRAME_BUDGET_HISTORY = 300;
+
+/**
+ * @brief How long the stages of the last frames took, for the frame budget graph
+ */
+struct frame_budget_history {
+	// the names of the stages, the last one is the time of the frame which none of the others accounts for
+	SCP_vector<const char*> stages;
+
+	// the milliseconds of every stage in every frame: the stages of the oldest frame come first
+	SCP_vector<float> times;
+
+	size_t frames() const { return stages.empty() ? 0 : times.size() / stages.size(); }
+};
+
+/**
+ * @brief Keeps how long the top-level stages of the last frames took on the CPU and on the GPU
+ *
+ * The time of a stage doesn't include the time of other stages nested in it, so the stages of a frame can be stacked on
+ * top of each other and add up to the time of the frame.
+ */
+class FrameBudget {
+	struct interval {
+		std::uint64_t begin;
+		std::uint64_t end;
+	};
+
+	struct timeline {
+		SCP_vector<const Category*> categories;
+		SCP_vector<const char*> names;
+
+		// the tracked scopes of the current frame which aren't inside another tracked scope
+		SCP_vector<interval> outer;
+		SCP_vector<std::uint64_t> current;
+
+		// a ring of the times of the last frames
+		SCP_vector<float> history;
+		size_t next = 0;
+		size_t frames = 0;
+
+		explicit timeline(std::initializer_list<const Category*> stages);
+
+		void add(const Category* category, std::uint64_t begin, std::uint64_t end);
+		void finish(std::uint64_t duration);
+
+		void get(frame_budget_history& out) const;
+	};
+
+	struct gpu_begin {
+		const Category* category;
+		std::uint64_t timestamp;
+	};
+
+	std::int64_t _main_thread_id;
+
+	timeline _cpu;
+	timeline _gpu;
+
+	// the GPU scopes which began but didn't end yet
+	SCP_vector<gpu_begin> _gpu_open;
+
+ public:
+	explicit FrameBudget(std::int64_t main_thread_id);
+
+	void processEvent(const trace_event* event);
+
+	void getHistory(frame_budget_history& cpu, frame_budget_history& gpu) const;
+};
+
+}
@@ -1,15 +1,104 @@
 
 #include "MainFrameTimer.h"
 
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+
+namespace {
+
+// the time within which the given part of the frames finished, using the nearest rank
+std::uint64_t percentile(const SCP_vector<std::uint64_t>& sorted, double part) {
+	auto rank = (size_t)std::ceil(part * sorted.size());
+
+	return sorted[std::max(rank, (size_t)1) - 1];
+}
+
+void write_summary_line(std::ofstream& out, const char* timer, SCP_vector<std::uint64_t>& frames) {
+	if (frames.empty()) {
+		return;
+	}
+
+	std::sort(frames.begin(), frames.end());
+
+	std::uint64_t total = 0;
+	for (auto frame : frames) {
+		total += frame;
+	}
+
+	double average = total / 1000000. / frames.size();
+
+	// the frame pacing, a steady framerate has a small deviation even if its average is high
+	double variance = 0.0;
+	for (auto frame : frames) {
+		auto diff = frame / 1000000. - average;
+		variance += diff * diff;
+	}
+	variance /= frames.size();
+
+	out << timer << ";" << frames.size() << ";" << average << ";"
+	    << (percentile(frames, 0.50) / 1000000.) << ";" << (percentile(frames, 0.95) / 1000000.) << ";"
+	    << (percentile(frames, 0.99) / 1000000.) << ";" << (frames.back() / 1000000.) << ";" << std::sqrt(variance)
+	    << "\n";
+}
+
+}
+
 namespace tracing {
 
 MainFrameTimer::MainFrameTimer() : _out("profiling.csv") {
 }
 MainFrameTimer::~MainFrameTimer() {
 	_out.close();
+
+	writeSummary();
+}
+void MainFrameTimer::writeSummary() {
+	if (_cpu_frames.empty()) {
+		return;
+	}
+
+	std::ofstream summary("profiling_summary.csv");
+
+	summary << std::fixed << std::setprecision(3);
+	summary << "timer;frames;average_ms;p50_ms;p95_ms;p99_ms;worst_ms;stddev_ms\n";
+
+	write_summary_line(summary, "cpu", _cpu_frames);
+	write_summary_line(summary, "gpu", _gpu_frames);
 }
 void MainFrameTimer::processEvent(const trace_event* event) {
-	if (event->scope != &MainFrameScope || event->category != &MainFrame) {
+	if (event->type == EventType::Counter && event->category == &FrameTimeSummary) {
+		_summary_recording = event->value > 0.f;
+
+		if (_summary_recording) {
+			_cpu_frames.clear();
+			_gpu_frames.clear();
+		}
+		return;
+	}
+
+	if (event->category != &MainFrame) {
+		return;
+	}
+
+	// The GPU time comes from the timestamp queries of the complete event
+	if (event->pid == GPU_PID) {
+		switch (event->type) {
+			case EventType::Begin:
+				_gpu_begin_time = event->timestamp;
+				break;
+			case EventType::End:
+				if (_summary_recording) {
+					_gpu_frames.push_back(event->timestamp - _gpu_begin_time);
+				}
+				break;
+			default:
+				break;
+		}
+		return;
+	}
+
+	if (event->scope != &MainFrameScope) {
 		return;
 	}
 
@@ -23,6 +112,10 @@ void MainFrameTimer::processEvent(const trace_event* event) {
 			auto duration = event->timestamp - _begin_time;
 
 			_out << end << ";" << duration << "\n";
+
+			if (_summary_recording) {
+				_cpu_frames.push_back(duration);
+			}
 			break;
 		}
 		default:
@@ -14,11 +14,25 @@
 
 namespace tracing
 {
+/**
+ * @brief Writes the time of every frame to profiling.csv, and a summary of them to profiling_summary.csv
+ *
+ * The summary has the average, the 50th, 95th and 99th percentile, the worst frame and the standard deviation of the CPU
+ * and, if the renderer has timestamp queries, the GPU time of the frames. It covers every frame unless a FrameTimeSummary
+ * counter picks the frames: a value of 1 starts the summary over and 0 stops adding frames to it.
+ */
 class MainFrameTimer
 {
 	std::ofstream _out;
 
 	std::uint64_t _begin_time = 0;
+	std::uint64_t _gpu_begin_time = 0;
+
+	bool _summary_recording = true;
+	SCP_vector<std::uint64_t> _cpu_frames;
+	SCP_vector<std::uint64_t> _gpu_frames;
+
+	void writeSummary();
  public:
 	MainFrameTimer();
 	~MainFrameTimer();
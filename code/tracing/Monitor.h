@@ -66,4 +66,7 @@ class Monitor: public MonitorBase {
 // Increments a monitor variable
 #define MONITOR_INC(function_name, inc)		do { mon_##function_name += (inc); } while(0)
 
+// Sets a monitor variable to a new value
+#define MONITOR_SET(function_name, val)		do { mon_##function_name = (val); } while(0)
+
 
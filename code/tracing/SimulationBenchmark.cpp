@@ -0,0 +1,85 @@
+
+#include "tracing/SimulationBenchmark.h"
+
+#include <fstream>
+#include <iomanip>
+
+namespace {
+
+void write_json_string(std::ofstream& out, const char* str) {
+	out << '"';
+	for (; *str != '\0'; ++str) {
+		if (*str == '"' || *str == '\\') {
+			out << '\\';
+		}
+		out << *str;
+	}
+	out << '"';
+}
+
+double to_ms(std::uint64_t ns) {
+	return ns / 1000000.;
+}
+
+}
+
+namespace tracing {
+
+void SimulationBenchmark::processEvent(const trace_event* event) {
+	if (!_recording || event->type != EventType::Complete) {
+		return;
+	}
+
+	auto& stage = _stages[event->category->getName()];
+
+	stage.count++;
+	stage.total_ns += event->duration;
+	stage.min_ns = std::min(stage.min_ns, event->duration);
+	stage.max_ns = std::max(stage.max_ns, event->duration);
+}
+
+void SimulationBenchmark::start() {
+	_stages.clear();
+	_recording = true;
+}
+
+void SimulationBenchmark::write(const char* filename, const char* mission, int frames, float timestep, int seed,
+                                std::uint64_t wall_time_ns) const {
+	std::ofstream out(filename);
+
+	if (!out) {
+		mprintf(("Could not write the simulation benchmark to %s\n", filename));
+		return;
+	}
+
+	out << std::fixed << std::setprecision(4);
+
+	out << "{\n\t\"mission\": ";
+	write_json_string(out, mission);
+	out << ",\n\t\"frames\": " << frames;
+	out << ",\n\t\"timestep\": " << timestep;
+	out << ",\n\t\"seed\": " << seed;
+	out << ",\n\t\"wall_time_ms\": " << to_ms(wall_time_ns);
+	out << ",\n\t\"stages\": {";
+
+	bool first = true;
+	for (auto& entry : _stages) {
+		auto& stage = entry.second;
+
+		out << (first ? "\n\t\t" : ",\n\t\t");
+		first = false;
+
+		write_json_string(out, entry.first.c_str());
+		out << ": {\"count\": " << stage.count;
+		out << ", \"total_ms\": " << to_ms(stage.total_ns);
+		out << ", \"per_frame_ms\": " << ((frames > 0) ? to_ms(stage.total_ns) / frames : 0.);
+		out << ", \"min_ms\": " << to_ms(stage.min_ns);
+		out << ", \"max_ms\": " << to_ms(stage.max_ns) << "}";
+	}
+
+	out << "\n\t}\n}\n";
+
+	mprintf(("Wrote the simulation benchmark of %d frames to %s\n", frames, filename));
+}
+
+}
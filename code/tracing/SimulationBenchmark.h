@@ -0,0 +1,52 @@
+#pragma once
+
+#include "globalincs/pstypes.h"
+
+#include "tracing/tracing.h"
+
+/** @file
+ *  @ingroup tracing
+ */
+
+namespace tracing {
+
+struct benchmark_stage {
+	std::uint64_t count = 0;
+	std::uint64_t total_ns = 0;
+	std::uint64_t min_ns = UINT64_MAX;
+	std::uint64_t max_ns = 0;
+};
+
+/**
+ * @brief Adds up the time spent in every category while a simulation benchmark runs
+ *
+ * Only complete events are counted. The events of the job workers are counted as well, so a stage which runs in
+ * parallel adds up the time of all threads.
+ */
+class SimulationBenchmark {
+	SCP_map<SCP_string, benchmark_stage> _stages;
+	bool _recording = false;
+
+ public:
+	void processEvent(const trace_event* event);
+
+	/**
+	 * @brief Starts counting, everything before it is part of loading the mission
+	 */
+	void start();
+
+	/**
+	 * @brief Writes the timings of every stage as JSON
+	 *
+	 * @param filename The file to write
+	 * @param mission The mission which was simulated
+	 * @param frames The number of simulated frames
+	 * @param timestep The simulated time of every frame, in seconds
+	 * @param seed The random seed
+	 * @param wall_time_ns How long the frames took
+	 */
+	void write(const char* filename, const char* mission, int frames, float timestep, int seed,
+	           std::uint64_t wall_time_ns) const;
+};
+
+}
@@ -0,0 +1,262 @@
+#include "tracing/StartupProfiler.h"
+
+#include "cfile/cfile.h"
+#include "io/timer.h"
+#include "utils/strings.h"
+
+#include <algorithm>
+#include <mutex>
+#include <thread>
+
+namespace {
+
+struct phase_record {
+	const char* name;
+	int depth;
+	std::uint64_t begin;
+	std::uint64_t end;
+};
+
+struct table_record {
+	SCP_string filename;
+	SCP_string location;
+	bool main_thread;
+	std::uint64_t begin;
+	std::uint64_t end;
+};
+
+struct root_record {
+	SCP_string path;
+	bool pack;
+	std::uint64_t duration;
+};
+
+// the directory of a mod with the pack files in it
+struct mod_root {
+	SCP_string path;
+	std::uint64_t list_ns = 0;
+	int packs = 0;
+	std::uint64_t table_ns = 0;
+	int tables = 0;
+};
+
+std::mutex startup_mutex;
+bool recording = false;
+std::uint64_t start_time = 0;
+std::thread::id main_thread;
+
+SCP_vector<phase_record> phases;
+SCP_vector<table_record> tables;
+SCP_vector<root_record> roots;
+
+// the table which is being parsed on this thread and the depth of the phase it was read in
+SCP_THREAD_LOCAL size_t current_table = SIZE_MAX;
+SCP_THREAD_LOCAL int current_depth = 0;
+SCP_THREAD_LOCAL int current_table_depth = 0;
+
+double to_ms(std::uint64_t ns) {
+	return ns / 1000000.;
+}
+
+// startup_mutex must be held
+void close_table(std::uint64_t now) {
+	if (current_table < tables.size() && tables[current_table].end == 0) {
+		tables[current_table].end = now;
+	}
+	current_table = SIZE_MAX;
+}
+
+// the longest mod root which contains the path, or nullptr
+mod_root* find_mod_root(SCP_vector<mod_root>& mods, const SCP_string& path) {
+	mod_root* found = nullptr;
+
+	for (auto& mod : mods) {
+		if (mod.path.size() <= path.size() && !strnicmp(mod.path.c_str(), path.c_str(), mod.path.size())) {
+			if (found == nullptr || mod.path.size() > found->path.size()) {
+				found = &mod;
+			}
+		}
+	}
+
+	return found;
+}
+
+}
+
+namespace tracing {
+namespace startup {
+
+void begin() {
+	std::lock_guard<std::mutex> lock(startup_mutex);
+
+	phases.clear();
+	tables.clear();
+	roots.clear();
+
+	main_thread = std::this_thread::get_id();
+	start_time = timer_get_nanoseconds();
+	recording = true;
+}
+
+ScopedPhase::ScopedPhase(const Category& category) : _trace(category) {
+	std::lock_guard<std::mutex> lock(startup_mutex);
+
+	if (!recording) {
+		return;
+	}
+
+	_index = phases.size();
+	phases.push_back({ category.getName(), current_depth, timer_get_nanoseconds(), 0 });
+
+	++current_depth;
+}
+
+ScopedPhase::~ScopedPhase() {
+	std::lock_guard<std::mutex> lock(startup_mutex);
+
+	if (_index == SIZE_MAX) {
+		return;
+	}
+
+	--current_depth;
+
+	if (!recording) {
+		return;
+	}
+
+	auto now = timer_get_nanoseconds();
+
+	// a table read in this phase is done with
+	if (current_table_depth > current_depth) {
+		close_table(now);
+	}
+
+	phases[_index].end = now;
+}
+
+void table_begin(const char* filename) {
+	std::lock_guard<std::mutex> lock(startup_mutex);
+
+	if (!recording) {
+		return;
+	}
+
+	auto now = timer_get_nanoseconds();
+
+	close_table(now);
+
+	char location[MAX_PATH_LEN] = "";
+	cf_find_file_location(filename, CF_TYPE_TABLES, sizeof(location) - 1, location, nullptr, nullptr);
+
+	current_table = tables.size();
+	current_table_depth = current_depth;
+
+	tables.push_back({ filename, location, std::this_thread::get_id() == main_thread, now, 0 });
+}
+
+void table_end() {
+	std::lock_guard<std::mutex> lock(startup_mutex);
+
+	if (!recording) {
+		return;
+	}
+
+	close_table(timer_get_nanoseconds());
+}
+
+void root_listed(const char* path, bool pack, std::uint64_t duration_ns) {
+	std::lock_guard<std::mutex> lock(startup_mutex);
+
+	if (!recording) {
+		return;
+	}
+
+	roots.push_back({ path, pack, duration_ns });
+}
+
+void report() {
+	std::lock_guard<std::mutex> lock(startup_mutex);
+
+	if (!recording) {
+		return;
+	}
+
+	recording = false;
+
+	auto now = timer_get_nanoseconds();
+
+	mprintf(("Startup took %.1f ms\n", to_ms(now - start_time)));
+
+	mprintf(("Startup phases:\n"));
+	for (auto& phase : phases) {
+		auto end = phase.end != 0 ? phase.end : now;
+		mprintf(("  %*s%-*s %9.1f ms\n", phase.depth * 2, "", std::max(40 - phase.depth * 2, 0), phase.name,
+			to_ms(end - phase.begin)));
+	}
+
+	for (auto& table : tables) {
+		if (table.end == 0) {
+			table.end = now;
+		}
+	}
+
+	SCP_vector<const table_record*> sorted;
+	std::uint64_t table_ns = 0;
+	for (auto& table : tables) {
+		sorted.push_back(&table);
+		table_ns += table.end - table.begin;
+	}
+	std::sort(sorted.begin(), sorted.end(), [](const table_record* a, const table_record* b) {
+		return (a->end - a->begin) > (b->end - b->begin);
+	});
+
+	mprintf(("Startup tables (%d files, %.1f ms, slowest first):\n", (int)sorted.size(), to_ms(table_ns)));
+	for (auto table : sorted) {
+		mprintf(("  %9.1f ms  %-32s %s%s\n", to_ms(table->end - table->begin), table->filename.c_str(),
+			table->location.c_str(), table->main_thread ? "" : " (job)"));
+	}
+
+	// the pack files and tables belong to the directory they are in
+	SCP_vector<mod_root> mods;
+	for (auto& root : roots) {
+		if (!root.pack) {
+			mod_root mod;
+			mod.path = root.path;
+			mod.list_ns = root.duration;
+			mods.push_back(mod);
+		}
+	}
+	for (auto& root : roots) {
+		if (root.pack) {
+			auto mod = find_mod_root(mods, root.path);
+			if (mod == nullptr) {
+				mod_root pack_root;
+				pack_root.path = root.path;
+				mods.push_back(pack_root);
+				mod = &mods.back();
+			}
+			mod->list_ns += root.duration;
+			mod->packs++;
+		}
+	}
+	for (auto& table : tables) {
+		auto mod = find_mod_root(mods, table.location);
+		if (mod != nullptr) {
+			mod->table_ns += table.end - table.begin;
+			mod->tables++;
+		}
+	}
+
+	mprintf(("Startup mod roots:\n"));
+	for (auto& mod : mods) {
+		mprintf(("  %s: file list %.1f ms (%d pack files), %d tables %.1f ms\n", mod.path.c_str(), to_ms(mod.list_ns),
+			mod.packs, mod.tables, to_ms(mod.table_ns)));
+	}
+
+	phases.clear();
+	tables.clear();
+	roots.clear();
+}
+
+}
+}
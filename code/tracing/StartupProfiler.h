@@ -0,0 +1,69 @@
+#pragma once
+
+#include "globalincs/pstypes.h"
+
+#include "tracing/tracing.h"
+
+/** @file
+ *  @ingroup tracing
+ *
+ *  Times the engine startup for the summary which is written to the log at the end of game_init(). This works without
+ *  any profiling option since most of the startup happens before tracing::init() can be called.
+ */
+
+namespace tracing {
+namespace startup {
+
+/**
+ * @brief Starts recording the startup, everything before is not counted
+ */
+void begin();
+
+/**
+ * @brief Writes the summary to the log and stops recording
+ */
+void report();
+
+/**
+ * @brief A phase of the startup, traced with its category as well
+ *
+ * The phases may be nested, the summary shows the time of a phase including the phases in it.
+ */
+class ScopedPhase {
+	complete::ScopedCompleteEvent _trace;
+	size_t _index = SIZE_MAX;
+
+ public:
+	explicit ScopedPhase(const Category& category);
+	~ScopedPhase();
+};
+
+/**
+ * @brief Called when a table file is read
+ *
+ * A table is timed until the next table is read on the same thread, the phase it was read in ends or table_end() is
+ * called. Parsing a table happens right after it was read so this includes the parse and what its module did with the
+ * result.
+ *
+ * @param filename The name of the table
+ */
+void table_begin(const char* filename);
+
+/**
+ * @brief Stops timing the current table of this thread
+ */
+void table_end();
+
+/**
+ * @brief Called when the files of a root were added to the file list
+ *
+ * @param path The path of the directory or the pack file
+ * @param pack @c true for a pack file
+ * @param duration_ns How long it took to list the files
+ */
+void root_listed(const char* path, bool pack, std::uint64_t duration_ns);
+
+}
+}
+
+#define TRACE_STARTUP_SCOPE(category) ::tracing::startup::ScopedPhase SCP_TOKEN_CONCAT(startup_trace_scope, __LINE__)(category)
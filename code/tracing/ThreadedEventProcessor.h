@@ -26,28 +26,38 @@ namespace tracing {
  *
  * This function will be called in a background-thread whenever a new event arrives.
  *
+ * The events are handed to the background thread in batches so the queue is only locked once per batch. A batch is
+ * handed over once it is full or when flush() is called, which tracing::process_events() does every frame.
+ *
+ * @warning processEvent() and flush() must not be called by several threads at the same time.
+ *
  * @tparam Processor Your processor implementation
- * @tparam QUEUE_SIZE The maximum size of the internal event buffer
+ * @tparam BATCH_SIZE The number of events in a batch
+ * @tparam QUEUE_SIZE The maximum number of batches waiting for the background thread
  */
-template<class Processor, size_t QUEUE_SIZE = 200>
+template<class Processor, size_t BATCH_SIZE = 256, size_t QUEUE_SIZE = 64>
 class ThreadedEventProcessor {
-	sync_bounded_queue<trace_event> _event_queue;
+	sync_bounded_queue<SCP_vector<trace_event>> _batch_queue;
+
+	SCP_vector<trace_event> _batch;
 
 	std::thread _worker_thread;
 
 	Processor _processor;
 
 	void workerThread() {
-		while (!_event_queue.closed()) {
+		while (!_batch_queue.closed()) {
 			try {
-				trace_event evt;
-				auto status = _event_queue.wait_pull_front(evt);
+				SCP_vector<trace_event> batch;
+				auto status = _batch_queue.wait_pull_front(batch);
 
 				if (status != success) {
 					break;
 				}
 
-				_processor.processEvent(&evt);
+				for (auto& evt : batch) {
+					_processor.processEvent(&evt);
+				}
 			}
 			catch (const sync_queue_is_closed&) {
 				// We are done here
@@ -58,19 +68,41 @@ class ThreadedEventProcessor {
  public:
 	template<typename... Params>
 	explicit ThreadedEventProcessor(Params&& ... params)
-		: _event_queue(QUEUE_SIZE), _worker_thread(&ThreadedEventProcessor<Processor>::workerThread, this),
-		  _processor(std::forward<Params>(params)...) {}
+		: _batch_queue(QUEUE_SIZE), _worker_thread(&ThreadedEventProcessor::workerThread, this),
+		  _processor(std::forward<Params>(params)...) {
+		_batch.reserve(BATCH_SIZE);
+	}
 	~ThreadedEventProcessor() {
-		_event_queue.close();
+		flush();
+
+		_batch_queue.close();
 		_worker_thread.join();
 	}
 
 	void processEvent(const trace_event* event) {
+		_batch.push_back(*event);
+
+		if (_batch.size() >= BATCH_SIZE) {
+			flush();
+		}
+	}
+
+	/**
+	 * @brief Hands the events which were collected so far to the background thread
+	 */
+	void flush() {
+		if (_batch.empty()) {
+			return;
+		}
+
 		try {
-			_event_queue.wait_push_back(std::move(*event));
+			_batch_queue.wait_push_back(std::move(_batch));
 		} catch (const sync_queue_is_closed&) {
-			mprintf(("Stream queue was closed in processEvent! This should not be possible..."));
+			mprintf(("Stream queue was closed in flush! This should not be possible..."));
 		}
+
+		_batch = SCP_vector<trace_event>();
+		_batch.reserve(BATCH_SIZE);
 	}
 };
 
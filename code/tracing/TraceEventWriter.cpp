@@ -23,6 +23,12 @@ const char* getTypeStr(tracing::EventType type) {
 			return "e";
 		case EventType::Counter:
 			return "C";
+		case EventType::FlowBegin:
+			return "s";
+		case EventType::FlowEnd:
+			return "f";
+		case EventType::ThreadName:
+			return "M";
 		default: 
 			Assertion(false, "Invalid enum value!");
 			return "";
@@ -51,7 +57,10 @@ void writeCompleteEvent(std::ofstream& out_str, const trace_event* evt) {
 namespace tracing
 {
 
-TraceEventWriter::TraceEventWriter() : _out("tracing/trace.json") {
+TraceEventWriter::TraceEventWriter() : TraceEventWriter("tracing/trace.json") {
+}
+
+TraceEventWriter::TraceEventWriter(const char* filename) : _out(filename) {
 	_out << "[";
 }
 
@@ -83,6 +92,14 @@ void TraceEventWriter::processEvent(const trace_event* event) {
 		_out << event->pid;
 	}
 
+	if (event->type == EventType::ThreadName) {
+		// A metadata event, the viewers show the thread with this name instead of its id
+		_out << ",\"name\":\"thread_name\",\"ph\":\"M\",\"args\": {\"name\":\"" << event->category->getName() << "\"}}";
+
+		_first_line = false;
+		return;
+	}
+
 	if (event->scope != nullptr) {
 		_out << ",\"cat\":\"" << event->scope->getName() << "\"";
 		_out << ",\"id\":\"" << reinterpret_cast<const void*>(event->scope) << "\"";
@@ -103,6 +120,13 @@ void TraceEventWriter::processEvent(const trace_event* event) {
 		case EventType::AsyncEnd:
 			// Nothing to do here...
 			break;
+		case EventType::FlowBegin:
+			_out << ",\"cat\":\"flow\",\"id\":\"" << event->flow_id << "\"";
+			break;
+		case EventType::FlowEnd:
+			// Binds the end to the scope which encloses it instead of the next one which starts
+			_out << ",\"cat\":\"flow\",\"id\":\"" << event->flow_id << "\",\"bp\":\"e\"";
+			break;
 		case EventType::Counter: {
 			auto flags = _out.flags();
 			_out << std::fixed;
@@ -1,114 +1,173 @@
-
-#include "tracing/categories.h"
-
-namespace tracing {
-
-Category::Category(const char* name, bool is_graphics) : _name(name), _graphics_category(is_graphics) {
-}
-const char* Category::getName() const {
-	return _name;
-}
-bool Category::usesGPUCounter() const {
-	return _graphics_category;
-}
-
-Category LuaOnFrame("LUA On Frame", true);
-
-Category DrawSceneTexture("Draw scene texture", true);
-Category UpdateDistortion("Update distortion", true);
-
-Category SceneTextureBegin("Scene texture begin", true);
-Category SceneTextureEnd("Scene texture end", true);
-Category Tonemapping("Tonemapping", true);
-Category Bloom("Bloom", true);
-Category BloomBrightPass("Bloom bright pass", true);
-Category BloomIterationStep("Bloom iteration step", true);
-Category BloomCompositeStep("Bloom composite step", true);
-Category FXAA("FXAA", true);
-Category Lightshafts("Lightshafts", true);
-Category DrawPostEffects("Draw post effects", true);
-
-Category RenderBatchItem("Render batch item", true);
-Category RenderBatchBuffer("Render batch buffer", true);
-Category LoadBatchingBuffers("Load batching buffers", true);
-
-Category SortColliders("Sort Colliders", false);
-Category FindOverlapColliders("Find overlap colliders", false);
-Category CollidePair("Collide Pair", false);
-
-Category WeaponPostMove("Weapon post move", false);
-Category ShipPostMove("Ship post move", false);
-Category FireballPostMove("Fireball post move", false);
-Category DebrisPostMove("Debris post move", false);
-Category AsteroidPostMove("Asteroid post move", false);
-Category PreMove("Pre Move", false);
-Category Physics("Physics", false);
-Category PostMove("Post Move", false);
-Category CollisionDetection("Collision Detection", false);
-
-Category RenderBuffer("Render Buffer", true);
-
-Category QueueRender("Queue Render", false);
-Category SubmitDraws("Submit Draws", true);
-Category ApplyLights("Apply Lights", true);
-Category DrawEffects("Draw Effects", true);
-Category SetupNebula("Setup Nebula", true);
-Category DrawStars("Draw Stars", true);
-Category DrawShields("Draw Shields", true);
-Category DrawBeams("Draw Beams", true);
-Category DrawStarfield("Draw Starfield", true);
-Category DrawMotionDebris("Draw Motion debris", true);
-Category DrawBackground("Draw Background", true);
-Category DrawSuns("Draw Suns", true);
-Category DrawBitmaps("Draw Bitmaps", true);
-
-Category RepeatingEvents("Repeating events", false);
-Category NonrepeatingEvents("Nonrepeating events", false);
-
-Category ParticlesRenderAll("Render particles", true);
-Category ParticlesMoveAll("Move particles", false);
-
-Category TrailDraw("Trail Draw", true);
-
-Category EnvironmentMapping("Environment Mapping", true);
-Category BuildShadowMap("Build Shadow Map", true);
-Category RenderScene("Render scene", true);
-Category RenderTrails("Render trails", true);
-Category MoveObjects("Move Objects", false);
-Category ProcessParticleEffects("Process particle effects", false);
-Category TrailsMoveAll("Trails move all", false);
-Category Simulation("Simulation", false);
-Category RenderMainFrame("Render frame", true);
-Category MainFrame("Main Frame", true);
-Category PageFlip("Page flip", true);
-
-Category CutsceneStep("Cutscene step", true);
-Category CutsceneDrawVideoFrame("Draw cutscene frame", true);
-Category CutsceneProcessDecoder("Process decoder data", false);
-Category CutsceneProcessVideoData("Process video data", true);
-Category CutsceneProcessAudioData("Process audio data", false);
-
-Category CutsceneFFmpegVideoDecoder("FFmpeg decode video", false);
-Category CutsceneFFmpegAudioDecoder("FFmpeg decode audio", false);
-
-Category LoadMissionLoad("Load mission", false);
-Category LoadPostMissionLoad("Mission load post processing", false);
-Category LoadModelFile("Load model file", false);
-Category ReadModelFile("Read model file", false);
-Category ModelCreateVertexBuffers("Create model vertex buffers", false);
-Category ModelCreateOctants("Create model octants", false);
-Category ModelParseAllBSPTrees("Parse all BSP trees", false);
-Category ModelParseBSPTree("Parse BSP tree", false);
-Category ModelConfigureVertexBuffers("Model configure vertex buffers", false);
-Category ModelCreateTransparencyIndexBuffer("Model create transparency buffer", false);
-Category ModelCreateDetailIndexBuffers("Model create detail index buffers", false);
-
-Category PreloadMissionSounds("Preload mission sounds", false);
-Category LoadSound("Load Sound", false);
-
-Category LevelPageIn("Level page in", false);
-Category PageInStop("Finish page in", false);
-Category PageInSingleBitmap("Page in single bitmap", false);
-Category ShipPageIn("Ship page in", false);
-Category WeaponPageIn("Weapon page in", false);
-}
+
+#include "tracing/categories.h"
+
+namespace tracing {
+
+Category::Category(const char* name, bool is_graphics) : _name(name), _graphics_category(is_graphics) {
+}
+const char* Category::getName() const {
+	return _name;
+}
+bool Category::usesGPUCounter() const {
+	return _graphics_category;
+}
+
+Category LuaOnFrame("LUA On Frame", true);
+Category LuaGarbageCollection("Lua garbage collection", false);
+
+Category DrawSceneTexture("Draw scene texture", true);
+Category UpdateDistortion("Update distortion", true);
+Category CopyEffectTexture("Copy effect texture", true);
+
+Category SceneTextureBegin("Scene texture begin", true);
+Category SceneTextureEnd("Scene texture end", true);
+Category Tonemapping("Tonemapping", true);
+Category Bloom("Bloom", true);
+Category BloomBrightPass("Bloom bright pass", true);
+Category BloomIterationStep("Bloom iteration step", true);
+Category FXAA("FXAA", true);
+Category Lightshafts("Lightshafts", true);
+Category DrawPostEffects("Draw post effects", true);
+
+Category RenderBatchItem("Render batch item", true);
+Category RenderBatchBuffer("Render batch buffer", true);
+Category LoadBatchingBuffers("Load batching buffers", true);
+
+Category SortColliders("Sort Colliders", false);
+Category FindOverlapColliders("Find overlap colliders", false);
+Category CollidePair("Collide Pair", false);
+Category CollideDeferredPairs("Collide deferred pairs", false);
+
+Category WeaponPostMove("Weapon post move", false);
+Category MoveProjectiles("Move projectiles", false);
+Category RenderProjectiles("Render projectiles", true);
+Category ShipPostMove("Ship post move", false);
+Category FireballPostMove("Fireball post move", false);
+Category DebrisPostMove("Debris post move", false);
+Category AsteroidPostMove("Asteroid post move", false);
+Category PreMove("Pre Move", false);
+Category Physics("Physics", false);
+Category SyncHotObjects("Sync hot object data", false);
+Category PostMove("Post Move", false);
+Category CollisionDetection("Collision Detection", false);
+
+Category RenderBuffer("Render Buffer", true);
+
+Category QueueRender("Queue Render", false);
+Category SubmitDraws("Submit Draws", true);
+Category OcclusionQueries("Occlusion Queries", true);
+Category ApplyLights("Apply Lights", true);
+Category DeferredClearBuffers("Deferred clear buffers", true);
+Category DeferredDepthPrepass("Deferred depth pre-pass", true);
+Category DeferredGBufferFill("Deferred G-buffer fill", true);
+Category DeferredPointLights("Deferred point lights", true);
+Category DeferredConeLights("Deferred cone lights", true);
+Category DeferredTubeLights("Deferred tube lights", true);
+Category DeferredTiledLights("Deferred tiled lights", true);
+Category DeferredLightComposite("Deferred light composite", true);
+Category DeferredDecals("Deferred decals", true);
+Category DrawEffects("Draw Effects", true);
+Category SetupNebula("Setup Nebula", true);
+Category DrawStars("Draw Stars", true);
+Category DrawShields("Draw Shields", true);
+Category DrawBeams("Draw Beams", true);
+Category DrawStarfield("Draw Starfield", true);
+Category DrawMotionDebris("Draw Motion debris", true);
+Category DrawBackground("Draw Background", true);
+Category DrawSuns("Draw Suns", true);
+Category DrawBitmaps("Draw Bitmaps", true);
+
+Category RepeatingEvents("Repeating events", false);
+Category NonrepeatingEvents("Nonrepeating events", false);
+
+Category ParticlesRenderAll("Render particles", true);
+Category ParticlesMoveAll("Move particles", false);
+
+Category TrailDraw("Trail Draw", true);
+
+Category EnvironmentMapping("Environment Mapping", true);
+Category BackgroundCubemap("Background Cubemap", true);
+Category BuildShadowMap("Build Shadow Map", true);
+Category ShadowMapClear("Shadow map clear", true);
+Category RenderShadowCasters("Render shadow casters", true);
+Category RenderScene("Render scene", true);
+Category BuildViewMasks("Build view masks", false);
+Category RenderTrails("Render trails", true);
+Category MoveObjects("Move Objects", false);
+Category ProcessParticleEffects("Process particle effects", false);
+Category TrailsMoveAll("Trails move all", false);
+Category Simulation("Simulation", false);
+Category RenderMainFrame("Render frame", true);
+Category MainFrame("Main Frame", true);
+Category FrameTimeSummary("Frame time summary", false);
+Category PageFlip("Page flip", true);
+Category FramePacingWait("Frame pacing wait", false);
+Category FramePacingInterval("Frame interval ms", false);
+Category FramePacingDeviation("Frame interval deviation ms", false);
+
+Category CutsceneStep("Cutscene step", true);
+Category CutsceneDrawVideoFrame("Draw cutscene frame", true);
+Category CutsceneProcessDecoder("Process decoder data", false);
+Category CutsceneProcessVideoData("Process video data", true);
+Category CutsceneProcessAudioData("Process audio data", false);
+
+Category CutsceneFFmpegVideoDecoder("FFmpeg decode video", false);
+Category CutsceneFFmpegVideoTransfer("FFmpeg transfer hardware frame", false);
+Category CutsceneFFmpegVideoHardware("FFmpeg hardware decoded frame", false);
+Category CutsceneFFmpegAudioDecoder("FFmpeg decode audio", false);
+
+Category LoadMissionLoad("Load mission", false);
+Category LoadPostMissionLoad("Mission load post processing", false);
+Category LoadModelFile("Load model file", false);
+Category ReadModelFile("Read model file", false);
+Category ModelCreateVertexBuffers("Create model vertex buffers", false);
+Category ModelCreateOctants("Create model octants", false);
+Category ModelParseAllBSPTrees("Parse all BSP trees", false);
+Category ModelParseBSPTree("Parse BSP tree", false);
+Category ModelConfigureVertexBuffers("Model configure vertex buffers", false);
+Category ModelCreateTransparencyIndexBuffer("Model create transparency buffer", false);
+Category ModelCreateDetailIndexBuffers("Model create detail index buffers", false);
+Category ModelCreateGeneratedLODs("Model create generated LODs", false);
+Category ModelCacheLoad("Load cached model data", false);
+Category ModelCacheSave("Save cached model data", false);
+Category TableCacheLoad("Load cached table text", false);
+Category TableCacheSave("Save cached table text", false);
+Category TextureCacheLoad("Load cached texture", false);
+Category TextureCacheSave("Save cached texture", false);
+Category ModelFinishBatchLoad("Finish model batch load", false);
+
+Category CfileInit("Init cfile", false);
+Category BuildRootList("Build root list", false);
+Category BuildFileList("Build file list", false);
+Category LocalizationInit("Init localization", false);
+Category ModTableInit("Init mod table", false);
+Category SoundInit("Init sound", false);
+Category GraphicsInit("Init graphics", false);
+Category ShaderInit("Init shaders", false);
+Category ScriptInit("Init scripting", false);
+Category FontInit("Init fonts", false);
+
+Category PreloadMissionSounds("Preload mission sounds", false);
+Category LoadSound("Load Sound", false);
+
+Category LevelPageIn("Level page in", false);
+Category PageInStop("Finish page in", false);
+Category PageInSingleBitmap("Page in single bitmap", false);
+Category ShipPageIn("Ship page in", false);
+Category WeaponPageIn("Weapon page in", false);
+
+Category Job("Job", false);
+Category ShipWeaponCollisionJob("Ship weapon collision job", false);
+Category PhysicsJob("Physics job", false);
+Category AIThinkJob("AI think job", false);
+Category RenderCullJob("Render cull job", false);
+Category PageInDecodeJob("Page in decode job", false);
+Category TextureStreamJob("Texture stream job", false);
+Category AnimStreamJob("Animation stream job", false);
+Category ModelLoadJob("Model load job", false);
+Category ParticleSourceJob("Particle source job", false);
+Category ObjectUpdateJob("Object update job", false);
+Category ParseTableJob("Parse table job", false);
+Category FileWriteJob("File write job", false);
+Category SoundPrefetchJob("Sound prefetch job", false);
+}
@@ -5,10 +5,18 @@
 #include "io/timer.h"
 
 #include "TraceEventWriter.h"
+#include "BinaryTraceWriter.h"
 #include "MainFrameTimer.h"
 #include "FrameProfiler.h"
+#include "FrameBudget.h"
+#include "SimulationBenchmark.h"
+#include "FlightRecorder.h"
+#include "debugconsole/console.h"
+#include "utils/spsc_queue.h"
 
 #include <inttypes.h>
+#include <algorithm>
+#include <atomic>
 #include <fstream>
 #include <future>
 #include <mutex>
@@ -53,8 +61,15 @@ namespace {
 using namespace tracing;
 
 std::unique_ptr<ThreadedTraceEventWriter> traceEventWriter;
+std::unique_ptr<ThreadedBinaryTraceWriter> binaryTraceWriter;
 std::unique_ptr<ThreadedMainFrameTimer> mainFrameTimer;
 std::unique_ptr<FrameProfiler> frameProfiler;
+std::unique_ptr<FrameBudget> frameBudget;
+std::unique_ptr<SimulationBenchmark> simulationBenchmark;
+std::unique_ptr<FlightRecorder> flightRecorder;
+
+// Whether there is a processor besides the flight recorder, they all need the submit mutex
+bool do_locked_processors = false;
 
 SCP_vector<int> query_objects;
 // The GPU timestamp queries use an internal free list to reduce the number of graphics API calls
@@ -104,20 +119,81 @@ int gpu_start_query = -1;
 std::uint64_t gpu_start_time = 0;
 std::uint64_t cpu_start_time = 0;
 
-std::uint64_t current_id = 0;
+std::atomic<std::uint64_t> current_id(0);
 
-void submit_event(trace_event* evt) {
-	if (evt->pid == GPU_PID) {
-		evt->timestamp -= gpu_start_time;
-	} else {
-		evt->timestamp -= cpu_start_time;
+// Every thread takes the ids of its events from a block of its own so the threads don't fight over the counter. The ids
+// of a thread still grow with every event.
+const std::uint64_t THREAD_ID_BLOCK = 1024;
+SCP_THREAD_LOCAL std::uint64_t thread_next_id = 0;
+SCP_THREAD_LOCAL std::uint64_t thread_id_block_end = 0;
+
+std::uint64_t next_event_id() {
+	if (thread_next_id == thread_id_block_end) {
+		thread_next_id = current_id.fetch_add(THREAD_ID_BLOCK, std::memory_order_relaxed) + 1;
+		thread_id_block_end = thread_next_id + THREAD_ID_BLOCK;
+	}
+	return thread_next_id++;
+}
+
+// Events may be submitted by the job workers so the processors have to be protected
+std::mutex submit_mutex;
+
+// get_tid() may be a system call so every thread only asks once
+SCP_THREAD_LOCAL std::int64_t current_tid = -1;
+
+std::int64_t get_current_tid() {
+	if (current_tid == -1) {
+		current_tid = get_tid();
 	}
+	return current_tid;
+}
+
+// The number of events a thread other than the main thread can have waiting for the main thread
+const size_t THREAD_QUEUE_EVENTS = 4096;
+
+// The events of a thread other than the main thread which haven't been given to the processors yet. The thread adds
+// them without any lock and the main thread takes them every frame. Only a thread which fills its queue before that
+// has to take the submit mutex.
+struct thread_events {
+	spsc_queue<trace_event> events;
+
+	thread_events() : events(THREAD_QUEUE_EVENTS) {}
+};
+
+std::mutex thread_events_mutex;
+SCP_vector<std::unique_ptr<thread_events>> all_thread_events;
+
+// every init() gets its own generation so a thread doesn't use a buffer of an earlier one
+int thread_events_generation = 0;
+SCP_THREAD_LOCAL thread_events* current_thread_events = nullptr;
+SCP_THREAD_LOCAL int current_thread_events_generation = -1;
+
+struct thread_name {
+	std::int64_t pid;
+	std::int64_t tid;
+	SCP_string name;
+
+	// the name is given to the processors as the category of a ThreadName event
+	std::unique_ptr<Category> category;
+};
+
+// A thread which is named again gets a new entry since the old category may still be in use by queued events
+std::mutex thread_names_mutex;
+SCP_vector<std::unique_ptr<thread_name>> thread_names;
+// Whether the names were given to the processors, the names of threads which are named later are submitted directly
+bool thread_names_published = false;
 
+void process_locked_event(const trace_event* evt) {
 	if (traceEventWriter) {
 		// Trace event writer receives all events
 		traceEventWriter->processEvent(evt);
 	}
 
+	if (binaryTraceWriter) {
+		// Same as above but in a compact format
+		binaryTraceWriter->processEvent(evt);
+	}
+
 	if (mainFrameTimer) {
 		mainFrameTimer->processEvent(evt);
 	}
@@ -125,10 +201,105 @@ void submit_event(trace_event* evt) {
 	if (frameProfiler) {
 		frameProfiler->processEvent(evt);
 	}
+
+	if (frameBudget) {
+		frameBudget->processEvent(evt);
+	}
+
+	if (simulationBenchmark) {
+		simulationBenchmark->processEvent(evt);
+	}
+}
+
+// The submit mutex must be held
+void flush_threaded_processors() {
+	if (traceEventWriter) {
+		traceEventWriter->flush();
+	}
+
+	if (binaryTraceWriter) {
+		binaryTraceWriter->flush();
+	}
+
+	if (mainFrameTimer) {
+		mainFrameTimer->flush();
+	}
+}
+
+void buffer_thread_event(const trace_event* evt) {
+	if (current_thread_events_generation != thread_events_generation) {
+		std::unique_ptr<thread_events> buffer(new thread_events());
+
+		current_thread_events = buffer.get();
+		current_thread_events_generation = thread_events_generation;
+
+		std::lock_guard<std::mutex> lock(thread_events_mutex);
+		all_thread_events.push_back(std::move(buffer));
+	}
+
+	if (!current_thread_events->events.push(*evt)) {
+		// The main thread didn't take the events in time, this thread may not take them from its own queue so this
+		// event skips it
+		std::lock_guard<std::mutex> lock(submit_mutex);
+		process_locked_event(evt);
+	}
+}
+
+// Only called on the main thread since it's the only one which takes events from the queues
+void flush_all_thread_events() {
+	SCP_vector<thread_events*> buffers;
+	{
+		// Only copy the list so a thread which submits its first event doesn't have to wait for the processors
+		std::lock_guard<std::mutex> lock(thread_events_mutex);
+
+		for (auto& buffer : all_thread_events) {
+			buffers.push_back(buffer.get());
+		}
+	}
+
+	std::lock_guard<std::mutex> lock(submit_mutex);
+
+	for (auto buffer : buffers) {
+		size_t count = 0;
+		while (auto evt = buffer->events.front(count)) {
+			process_locked_event(evt);
+			++count;
+		}
+		buffer->events.pop(count);
+	}
+
+	flush_threaded_processors();
+}
+
+void submit_event(trace_event* evt) {
+	if (evt->pid == GPU_PID) {
+		evt->timestamp -= gpu_start_time;
+	} else {
+		evt->timestamp -= cpu_start_time;
+	}
+
+	if (flightRecorder) {
+		// The flight recorder keeps a buffer per thread so it doesn't need the lock
+		flightRecorder->processEvent(evt);
+	}
+
+	if (!do_locked_processors) {
+		return;
+	}
+
+	if (get_current_tid() != main_thread_id) {
+		// The events of the other threads are collected first so they rarely wait for each other or the main thread
+		buffer_thread_event(evt);
+		return;
+	}
+
+	std::lock_guard<std::mutex> lock(submit_mutex);
+
+	process_locked_event(evt);
 }
 
 void process_gpu_events() {
-	Assertion(get_tid() == main_thread_id, "This function must be called from the main thread!");
+	Assertion(get_current_tid() == main_thread_id, "This function must be called from the main thread!");
 
 	if (gpu_start_query >= 0) {
 		if (gr_query_value_available(gpu_start_query)) {
@@ -201,7 +372,40 @@ void init_event(const Category& category, trace_event* evt) {
 	evt->timestamp = timer_get_nanoseconds();
 
 	evt->pid = get_pid();
-	evt->tid = get_tid();
+	evt->tid = get_current_tid();
+}
+
+// The latest name of every thread, thread_names_mutex must be held
+SCP_vector<const thread_name*> get_current_thread_names() {
+	SCP_vector<const thread_name*> names;
+
+	for (auto iter = thread_names.rbegin(); iter != thread_names.rend(); ++iter) {
+		auto& entry = *iter;
+
+		auto renamed = std::find_if(names.begin(), names.end(), [&entry](const thread_name* name) {
+			return name->pid == entry->pid && name->tid == entry->tid;
+		});
+
+		if (renamed == names.end()) {
+			names.push_back(entry.get());
+		}
+	}
+
+	return names;
+}
+
+trace_event make_thread_name_event(const thread_name& name) {
+	trace_event evt;
+	init_event(*name.category, &evt);
+
+	// The event belongs to the named thread, not the one which submits it
+	evt.pid = name.pid;
+	evt.tid = name.tid;
+
+	evt.type = EventType::ThreadName;
+	evt.event_id = next_event_id();
+
+	return evt;
 }
 }
 
@@ -211,20 +415,50 @@ void init() {
 	do_async_events = false;
 	do_counter_events = false;
 
+	main_thread_id = get_current_tid();
+
 	if (Cmdline_json_profiling) {
 		traceEventWriter.reset(new ThreadedTraceEventWriter());
 		do_trace_events = true;
 		do_async_events = true;
 		do_counter_events = true;
 	}
+	if (Cmdline_binary_profiling) {
+		binaryTraceWriter.reset(new ThreadedBinaryTraceWriter());
+		do_trace_events = true;
+		do_async_events = true;
+		do_counter_events = true;
+	}
 	if (Cmdline_profile_write_file) {
 		mainFrameTimer.reset(new ThreadedMainFrameTimer());
 		do_async_events = true;
+		// the GPU time of the frames comes from the complete events, the counters pick the frames of the summary
+		do_trace_events = true;
+		do_counter_events = true;
 	}
 	if (Cmdline_frame_profile) {
 		frameProfiler.reset(new FrameProfiler());
 		do_trace_events = true;
 	}
+	if (Cmdline_benchmark_simulation > 0) {
+		simulationBenchmark.reset(new SimulationBenchmark());
+		do_trace_events = true;
+	}
+	if (Cmdline_frame_budget_graph) {
+		frameBudget.reset(new FrameBudget(main_thread_id));
+		do_trace_events = true;
+	}
+
+	do_locked_processors =
+		traceEventWriter || binaryTraceWriter || mainFrameTimer || frameProfiler || simulationBenchmark || frameBudget;
+
+	if (Cmdline_flight_recorder > 0.0f) {
+		flightRecorder.reset(new FlightRecorder((std::uint64_t)(Cmdline_flight_recorder * 1000000000.0),
+			(std::uint64_t)Cmdline_flight_recorder_hitch * 1000000));
+		do_trace_events = true;
+		do_async_events = true;
+		do_counter_events = true;
+	}
 
 	do_gpu_queries = gr_is_capable(CAPABILITY_TIMESTAMP_QUERY);
 
@@ -233,9 +467,22 @@ void init() {
 	}
 	cpu_start_time = timer_get_nanoseconds();
 
-	main_thread_id = get_tid();
+	++thread_events_generation;
 
 	initialized = true;
+
+	set_thread_name("Main thread");
+
+	// The threads which were named before are named in the traces now
+	std::lock_guard<std::mutex> lock(thread_names_mutex);
+
+	if (do_trace_events) {
+		for (auto name : get_current_thread_names()) {
+			auto evt = make_thread_name_event(*name);
+			submit_event(&evt);
+		}
+	}
+	thread_names_published = true;
 }
 
 void process_events() {
@@ -243,19 +490,96 @@ void process_events() {
 		// Process pending GPU events
 		process_gpu_events();
 	}
+
+	if (do_locked_processors) {
+		// The other threads only hand over their events once they have enough of them
+		flush_all_thread_events();
+	}
+
+	if (flightRecorder && flightRecorder->dumpPending()) {
+		flight_recorder_dump("hitch");
+	}
 }
 void frame_profile_process_frame() {
 	Assertion(frameProfiler, "Frame profiling must be enabled for this function!");
 
+	std::lock_guard<std::mutex> lock(submit_mutex);
 	return frameProfiler->processFrame();
 }
 
 SCP_string get_frame_profile_output() {
 	Assertion(frameProfiler, "Frame profiling must be enabled for this function!");
 
+	std::lock_guard<std::mutex> lock(submit_mutex);
 	return frameProfiler->getContent();
 }
 
+void simulation_benchmark_start() {
+	Assertion(simulationBenchmark, "The simulation benchmark must be enabled for this function!");
+
+	// The events from before the start must not be counted
+	flush_all_thread_events();
+
+	std::lock_guard<std::mutex> lock(submit_mutex);
+	simulationBenchmark->start();
+}
+
+void simulation_benchmark_write(const char* mission, int frames, float timestep, int seed, std::uint64_t wall_time_ns) {
+	Assertion(simulationBenchmark, "The simulation benchmark must be enabled for this function!");
+
+	flush_all_thread_events();
+
+	std::lock_guard<std::mutex> lock(submit_mutex);
+	simulationBenchmark->write("tracing/simulation_benchmark.json", mission, frames, timestep, seed, wall_time_ns);
+}
+
+bool frame_budget_enabled() {
+	return frameBudget != nullptr;
+}
+
+void get_frame_budget(frame_budget_history& cpu, frame_budget_history& gpu) {
+	Assertion(frameBudget, "The frame budget graph must be enabled for this function!");
+
+	std::lock_guard<std::mutex> lock(submit_mutex);
+	frameBudget->getHistory(cpu, gpu);
+}
+
+bool flight_recorder_enabled() {
+	return flightRecorder != nullptr;
+}
+
+void flight_recorder_dump(const char* reason) {
+	Assertion(flightRecorder, "The flight recorder must be enabled for this function!");
+
+	SCP_vector<trace_event> names;
+	{
+		std::lock_guard<std::mutex> lock(thread_names_mutex);
+
+		for (auto name : get_current_thread_names()) {
+			names.push_back(make_thread_name_event(*name));
+		}
+	}
+
+	flightRecorder->dump(timer_get_nanoseconds() - cpu_start_time, reason, names);
+}
+
+void set_thread_name(const char* name) {
+	std::unique_ptr<thread_name> entry(new thread_name());
+	entry->pid = get_pid();
+	entry->tid = get_current_tid();
+	entry->name = name;
+	entry->category.reset(new Category(entry->name.c_str(), false));
+
+	std::lock_guard<std::mutex> lock(thread_names_mutex);
+
+	thread_names.push_back(std::move(entry));
+
+	if (thread_names_published && do_trace_events) {
+		auto evt = make_thread_name_event(*thread_names.back());
+		submit_event(&evt);
+	}
+}
+
 void shutdown() {
 	while (!gpu_events.empty()) {
 		process_events();
@@ -269,8 +593,31 @@ void shutdown() {
 	}
 	query_objects.clear();
 
+	if (do_locked_processors) {
+		flush_all_thread_events();
+	}
+
+	// the threads stop using their queues before those are deleted
+	do_locked_processors = false;
+
+	{
+		std::lock_guard<std::mutex> lock(thread_events_mutex);
+		all_thread_events.clear();
+	}
+
+	{
+		// The names are kept since the threads may still be running when tracing is started again
+		std::lock_guard<std::mutex> lock(thread_names_mutex);
+		thread_names_published = false;
+	}
+
 	mainFrameTimer = nullptr;
 	traceEventWriter = nullptr;
+	binaryTraceWriter = nullptr;
+	simulationBenchmark = nullptr;
+	frameBudget = nullptr;
+	flightRecorder = nullptr;
+	do_locked_processors = false;
 
 	initialized = false;
 }
@@ -291,10 +638,10 @@ void start(const Category& category, trace_event* evt) {
 
 	evt->duration = 0;
 	evt->type = EventType::Complete;
-	evt->event_id = ++current_id;
+	evt->event_id = next_event_id();
 
 	if (do_gpu_queries && category.usesGPUCounter()) {
-		Assertion(get_tid() == main_thread_id, "This function must be called from the main thread!");
+		Assertion(get_current_tid() == main_thread_id, "This function must be called from the main thread!");
 
 		gpu_trace_event gpu_event;
 		gpu_event.base_evt.category = &category;
@@ -320,17 +667,17 @@ void end(trace_event* evt) {
 	}
 
 	Assertion(evt->pid == get_pid(), "Complete events must be generated from the same process!");
-	Assertion(evt->tid == get_tid(), "Complete events must be generated from the same thread!");
+	Assertion(evt->tid == get_current_tid(), "Complete events must be generated from the same thread!");
 
 	evt->duration = timer_get_nanoseconds() - evt->timestamp;
-	evt->end_event_id = ++current_id;
+	evt->end_event_id = next_event_id();
 
 	// Process CPU events
 	submit_event(evt);
 
 	// Create GPU events
 	if (do_gpu_queries && evt->category->usesGPUCounter()) {
-		Assertion(get_tid() == main_thread_id, "This function must be called from the main thread!");
+		Assertion(get_current_tid() == main_thread_id, "This function must be called from the main thread!");
 
 		gpu_trace_event gpu_event;
 		gpu_event.base_evt.category = evt->category;
@@ -359,7 +706,7 @@ void begin(const Category& category, const Scope& async_scope) {
 
 	evt.type = EventType::AsyncBegin;
 	evt.scope = &async_scope;
-	evt.event_id = ++current_id;
+	evt.event_id = next_event_id();
 
 	submit_event(&evt);
 }
@@ -374,7 +721,7 @@ void step(const Category& category, const Scope& async_scope) {
 
 	evt.type = EventType::AsyncStep;
 	evt.scope = &async_scope;
-	evt.event_id = ++current_id;
+	evt.event_id = next_event_id();
 
 	submit_event(&evt);
 }
@@ -389,7 +736,43 @@ void end(const Category& category, const Scope& async_scope) {
 
 	evt.type = EventType::AsyncEnd;
 	evt.scope = &async_scope;
-	evt.event_id = ++current_id;
+	evt.event_id = next_event_id();
+
+	submit_event(&evt);
+}
+
+}
+
+namespace flow {
+
+std::uint64_t begin(const Category& category) {
+	if (!do_trace_events || !initialized) {
+		return 0;
+	}
+
+	trace_event evt;
+	init_event(category, &evt);
+
+	evt.type = EventType::FlowBegin;
+	evt.event_id = next_event_id();
+	evt.flow_id = evt.event_id;
+
+	submit_event(&evt);
+
+	return evt.flow_id;
+}
+
+void end(const Category& category, std::uint64_t flow_id) {
+	if (!do_trace_events || !initialized || flow_id == 0) {
+		return;
+	}
+
+	trace_event evt;
+	init_event(category, &evt);
+
+	evt.type = EventType::FlowEnd;
+	evt.event_id = next_event_id();
+	evt.flow_id = flow_id;
 
 	submit_event(&evt);
 }
@@ -407,7 +790,7 @@ void value(const Category& category, float value) {
 	init_event(category, &evt);
 	evt.type = EventType::Counter;
 	evt.value = value;
-	evt.event_id = ++current_id;
+	evt.event_id = next_event_id();
 
 	submit_event(&evt);
 }
@@ -415,3 +798,19 @@ void value(const Category& category, float value) {
 }
 
 }
+
+DCF(flight_recorder, "Writes the events of the last seconds which the flight recorder kept (see -flight_recorder)")
+{
+	if (dc_optional_string_either("help", "--help")) {
+		dc_printf("Usage: flight_recorder\n");
+		dc_printf("\tWrites the events of the last seconds to tracing/flight_recorder_<number>.json\n");
+		return;
+	}
+
+	if (!tracing::flight_recorder_enabled()) {
+		dc_printf("The flight recorder is off, start the game with -flight_recorder <seconds>\n");
+		return;
+	}
+
+	tracing::flight_recorder_dump("debug command");
+}
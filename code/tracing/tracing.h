@@ -18,6 +18,8 @@
 
 namespace tracing {
 
+struct frame_budget_history;
+
 /**
  * @brief Process if used for GPU events
  */
@@ -33,7 +35,11 @@ enum class EventType {
 
 	AsyncBegin, AsyncStep, AsyncEnd,
 
-	Counter
+	Counter,
+
+	FlowBegin, FlowEnd,
+
+	ThreadName
 };
 
 /**
@@ -50,6 +56,9 @@ struct trace_event {
 	std::uint64_t event_id = 0;
 	std::uint64_t end_event_id = 0;
 
+	// links the two events of a flow, see flow::begin()
+	std::uint64_t flow_id = 0;
+
 	std::int64_t tid = -1;
 	std::int64_t pid = -1;
 
@@ -74,6 +83,56 @@ void frame_profile_process_frame();
  */
 SCP_string get_frame_profile_output();
 
+/**
+ * @brief Starts adding up the time of every category for the simulation benchmark, see -benchmark_simulation
+ */
+void simulation_benchmark_start();
+
+/**
+ * @brief Writes the time of every category since simulation_benchmark_start() to tracing/simulation_benchmark.json
+ *
+ * @param mission The mission which was simulated
+ * @param frames The number of simulated frames
+ * @param timestep The simulated time of every frame, in seconds
+ * @param seed The random seed of the simulation
+ * @param wall_time_ns How long the frames took
+ */
+void simulation_benchmark_write(const char* mission, int frames, float timestep, int seed, std::uint64_t wall_time_ns);
+
+/**
+ * @brief Whether the time of the stages of the frames is kept for the graph, see -frame_budget_graph
+ */
+bool frame_budget_enabled();
+
+/**
+ * @brief Gets how long the stages of the last frames took
+ *
+ * @param cpu The time of the stages on the main thread
+ * @param gpu The time of the render passes on the GPU, these are a few frames behind the CPU
+ */
+void get_frame_budget(frame_budget_history& cpu, frame_budget_history& gpu);
+
+/**
+ * @brief Whether the last events are kept in memory, see -flight_recorder
+ */
+bool flight_recorder_enabled();
+
+/**
+ * @brief Writes the events of the last seconds which the flight recorder kept
+ *
+ * @param reason Why the events are written, for the log
+ */
+void flight_recorder_dump(const char* reason);
+
+/**
+ * @brief Gives the current thread a name for the timelines of the traces
+ *
+ * May be called from every thread at any time, also before init(). Naming a thread again replaces its name.
+ *
+ * @param name The name of the thread
+ */
+void set_thread_name(const char* name);
+
 /**
  * @brief Deinitializes the tracing subsystem
  */
@@ -101,13 +160,21 @@ void end(trace_event* evt);
  */
 class ScopedCompleteEvent {
 	trace_event _evt;
+	const char* _previous_alloc_tag = nullptr;
 
  public:
 	explicit ScopedCompleteEvent(const Category& category) {
+		if (memory::tracking::Enabled) {
+			// The allocations in this scope are counted under its name
+			_previous_alloc_tag = memory::tracking::push_tag(category.getName());
+		}
 		start(category, &_evt);
 	}
 	~ScopedCompleteEvent() {
 		end(&_evt);
+		if (memory::tracking::Enabled) {
+			memory::tracking::pop_tag(_previous_alloc_tag);
+		}
 	}
 };
 }
@@ -144,6 +211,31 @@ void step(const Category& category, const Scope& async_scope);
 void end(const Category& category, const Scope& async_scope);
 }
 
+namespace flow {
+
+/**
+ * @brief Starts a flow which connects the current scope of this thread with a scope where the work is done later
+ *
+ * This is used to show which code submitted the work that a worker thread is executing. Pass the returned id to end()
+ * in the scope which does the work.
+ *
+ * @note Flows can be started and ended on every thread
+ *
+ * @param category The category of the flow, both ends must use the same one
+ * @return The id of the flow, 0 if no one records flows
+ */
+std::uint64_t begin(const Category& category);
+
+/**
+ * @brief Ends a flow in the current scope of this thread
+ *
+ * @param category The category the flow was started with
+ * @param flow_id The id begin() returned, nothing is recorded for 0
+ */
+void end(const Category& category, std::uint64_t flow_id);
+
+}
+
 namespace counter {
 
 /**
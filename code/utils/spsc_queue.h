@@ -0,0 +1,93 @@
+#pragma once
+
+#include "globalincs/pstypes.h"
+
+#include <atomic>
+
+/** @file
+ *  A bounded queue for passing items from one thread to another without locking.
+ */
+
+/**
+ * @brief A bounded lock-free queue for exactly one producer and one consumer thread
+ *
+ * Only one thread may call push() and only one other thread may call front() and pop(). The items are kept in a ring
+ * which is allocated once, so they should be plain data.
+ *
+ * @tparam T The type of the items
+ */
+template<typename T>
+class spsc_queue {
+	SCP_vector<T> _items;
+	size_t _mask;
+
+	// the next item the consumer takes and the next slot the producer fills, both only ever grow. they are kept apart
+	// so the two threads don't fight over the same cache line
+	std::atomic<size_t> _head;
+	char _padding[64];
+	std::atomic<size_t> _tail;
+
+ public:
+	/**
+	 * @param capacity The number of items the queue can hold, rounded up to a power of two
+	 */
+	explicit spsc_queue(size_t capacity) : _head(0), _tail(0) {
+		size_t size = 1;
+		while (size < capacity) {
+			size <<= 1;
+		}
+
+		_items.resize(size);
+		_mask = size - 1;
+	}
+
+	spsc_queue(const spsc_queue&) = delete;
+	spsc_queue& operator=(const spsc_queue&) = delete;
+
+	/**
+	 * @brief Adds an item, only called by the producer
+	 * @return @c false if the queue is full
+	 */
+	bool push(const T& item) {
+		auto tail = _tail.load(std::memory_order_relaxed);
+
+		if (tail - _head.load(std::memory_order_acquire) > _mask) {
+			return false;
+		}
+
+		_items[tail & _mask] = item;
+		_tail.store(tail + 1, std::memory_order_release);
+
+		return true;
+	}
+
+	/**
+	 * @brief One of the oldest items, only called by the consumer
+	 * @param index 0 for the oldest item, 1 for the one after it and so on
+	 * @return The item which stays valid until it is popped, @c nullptr if the queue has fewer items
+	 */
+	T* front(size_t index = 0) {
+		auto head = _head.load(std::memory_order_relaxed);
+
+		if (_tail.load(std::memory_order_acquire) - head <= index) {
+			return nullptr;
+		}
+
+		return &_items[(head + index) & _mask];
+	}
+
+	/**
+	 * @brief Removes the oldest items, only called by the consumer after front() returned them
+	 */
+	void pop(size_t count = 1) {
+		_head.store(_head.load(std::memory_order_relaxed) + count, std::memory_order_release);
+	}
+
+	/**
+	 * @brief Removes all items, only called while neither thread uses the queue
+	 */
+	void clear() {
+		_head.store(0, std::memory_order_relaxed);
+		_tail.store(0, std::memory_order_relaxed);
+	}
+};
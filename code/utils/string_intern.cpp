@@ -0,0 +1,121 @@
+#include "utils/string_intern.h"
+
+#include <cctype>
+#include <mutex>
+
+namespace {
+
+struct interned_name {
+	uint32_t hash;
+	SCP_string name;
+};
+
+std::mutex Intern_mutex;
+
+// a deque doesn't move its elements, so the names stay where they are
+SCP_deque<interned_name> Interned_names;
+
+// open addressing, the slots hold the ids and INVALID_ID for empty slots. the size is a power of two
+SCP_vector<int> Intern_slots;
+
+uint32_t name_hash(const char* name)
+{
+	// FNV-1a of the lower case name
+	uint32_t hash = 2166136261u;
+
+	for (auto c = name; *c != '\0'; ++c) {
+		hash ^= (uint32_t)tolower((unsigned char)*c);
+		hash *= 16777619u;
+	}
+
+	return hash;
+}
+
+// Intern_mutex must be held, returns the slot of the name or the empty slot where it would go
+size_t find_slot(const char* name, uint32_t hash)
+{
+	auto mask = Intern_slots.size() - 1;
+
+	for (auto slot = hash & mask;; slot = (slot + 1) & mask) {
+		auto id = Intern_slots[slot];
+
+		if (id == string_intern::INVALID_ID) {
+			return slot;
+		}
+
+		auto& entry = Interned_names[id];
+		if (entry.hash == hash && !stricmp(entry.name.c_str(), name)) {
+			return slot;
+		}
+	}
+}
+
+// Intern_mutex must be held
+void grow_slots()
+{
+	SCP_vector<int> slots(std::max(Intern_slots.size() * 2, (size_t)1024), string_intern::INVALID_ID);
+	auto mask = slots.size() - 1;
+
+	for (size_t id = 0; id < Interned_names.size(); ++id) {
+		auto slot = Interned_names[id].hash & mask;
+		while (slots[slot] != string_intern::INVALID_ID) {
+			slot = (slot + 1) & mask;
+		}
+		slots[slot] = (int)id;
+	}
+
+	Intern_slots.swap(slots);
+}
+
+}
+
+namespace string_intern {
+
+int intern(const char* name)
+{
+	Assert(name != nullptr);
+
+	auto hash = name_hash(name);
+
+	std::lock_guard<std::mutex> lock(Intern_mutex);
+
+	// keep the table at most half full
+	if ((Interned_names.size() + 1) * 2 > Intern_slots.size()) {
+		grow_slots();
+	}
+
+	auto slot = find_slot(name, hash);
+
+	if (Intern_slots[slot] == INVALID_ID) {
+		Intern_slots[slot] = (int)Interned_names.size();
+		Interned_names.push_back({ hash, name });
+	}
+
+	return Intern_slots[slot];
+}
+
+int find(const char* name)
+{
+	Assert(name != nullptr);
+
+	auto hash = name_hash(name);
+
+	std::lock_guard<std::mutex> lock(Intern_mutex);
+
+	if (Intern_slots.empty()) {
+		return INVALID_ID;
+	}
+
+	return Intern_slots[find_slot(name, hash)];
+}
+
+const char* get(int id)
+{
+	std::lock_guard<std::mutex> lock(Intern_mutex);
+
+	Assert(id >= 0 && id < (int)Interned_names.size());
+
+	return Interned_names[id].name.c_str();
+}
+
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include "globalincs/pstypes.h"
+
+/** @file
+ *  Case insensitive string interning.
+ *
+ *  Every distinct name gets a small id which stays valid until the program exits, names which only differ in case get
+ *  the same one. Lookups which are done often can be keyed by the id instead of the string, so they don't need to
+ *  copy or lower case the name to find it and comparing two names becomes comparing two integers.
+ *
+ *  All functions may be called from any thread.
+ */
+
+namespace string_intern {
+
+/**
+ * @brief Returned by find() for names which were never interned
+ */
+const int INVALID_ID = -1;
+
+/**
+ * @brief Gets the id of a name, adding it if it's new
+ *
+ * @param name The name
+ * @return The id of the name
+ */
+int intern(const char* name);
+
+/**
+ * @brief Gets the id of a name without adding it
+ *
+ * This doesn't allocate any memory, so it's meant for checking names against the ones which were interned before.
+ *
+ * @param name The name
+ * @return The id of the name or INVALID_ID if it was never interned
+ */
+int find(const char* name);
+
+/**
+ * @brief Gets an interned name
+ *
+ * @param id An id returned by intern()
+ * @return The name with the case it was first interned with
+ */
+const char* get(int id);
+
+}
@@ -40,6 +40,7 @@
 #include "weapon/beam.h"
 #include "weapon/weapon.h"
 #include "globalincs/globals.h"
+#include "tracing/Monitor.h"
 #include "tracing/tracing.h"
 
 // ------------------------------------------------------------------------------------------------
@@ -98,6 +99,25 @@ int Beam_test_ship = 0;
 int Beam_test_ast = 0;
 int Beam_test_framecount = 0;
 
+// a collision test of a beam against a ship is reused while both ends of the beam inside the bounding sphere of the
+// ship moved less than this fraction of the beam width relative to it
+#define BEAM_HIT_CACHE_TOLERANCE		0.1f
+
+bool Beam_hit_cache = true;
+DCF_BOOL(beam_hit_cache, Beam_hit_cache);
+
+MONITOR(BeamShipTests)
+MONITOR(BeamShipTestsReused)
+
+// the sections of all beams drawn this frame, grouped by texture so every texture is drawn once
+struct beam_section_vertex {
+	vec3d position;
+	uv_pair tex_coord;
+	ubyte r, g, b, a;
+};
+
+static SCP_map<int, SCP_vector<beam_section_vertex>> Beam_section_batches;
+
 // beam warmup completion %
 #define BEAM_WARMUP_PCT(b)			( ((float)Weapon_info[b->weapon_info_index].b_info.beam_warmup - (float)timestamp_until(b->warmup_stamp)) / (float)Weapon_info[b->weapon_info_index].b_info.beam_warmup ) 
 
@@ -241,6 +261,12 @@ float beam_get_ship_damage(beam *b, object *objp);
 // if the beam is likely to tool a given target before its lifetime expires
 int beam_will_tool_target(beam *b, object *objp);
 
+// forget all collision tests the beam made
+void beam_clear_hit_cache(beam *b);
+
+// draw the sections of all beams added by beam_render()
+void beam_render_section_batches();
+
 // ------------------------------------------------------------------------------------------------
 // BEAM WEAPON FUNCTIONS
 //
@@ -274,6 +300,8 @@ void beam_level_init()
 // shutdown beam weapons for this level
 void beam_level_close()
 {
+	Beam_section_batches.clear();
+
 	// clear the beams
 	list_init( &Beam_free_list );
 	list_init( &Beam_used_list );
@@ -358,6 +386,7 @@ int beam_fire(beam_fire_info *fire_info)
 	new_item->life_total = wip->b_info.beam_life;
 	new_item->r_collision_count = 0;
 	new_item->f_collision_count = 0;
+	beam_clear_hit_cache(new_item);
 	new_item->target = fire_info->target;
 	new_item->target_subsys = fire_info->target_subsys;
 	new_item->target_sig = (fire_info->target != NULL) ? fire_info->target->signature : 0;
@@ -544,6 +573,7 @@ int beam_fire_targeting(fighter_beam_fire_info *fire_info)
 	new_item->life_total = fire_info->life_total;
 	new_item->r_collision_count = 0;
 	new_item->f_collision_count = 0;
+	beam_clear_hit_cache(new_item);
 	new_item->target = NULL;
 	new_item->target_subsys = NULL;
 	new_item->target_sig = 0;	
@@ -1253,9 +1283,21 @@ void beam_render(beam *b, float u_offset)
 			framenum = bm_get_anim_frame(bwsi->texture.first_frame, b->beam_section_frame[s_idx], bwsi->texture.total_time, true);
 		}
 
-		material material_params;
-		material_set_unlit_emissive(&material_params, bwsi->texture.first_frame + framenum, 0.9999f, 2.0f);
-		g3_render_primitives_colored_textured(&material_params, h1, 4, PRIM_TYPE_TRIFAN, false);
+		// the fan of the section is split into two triangles so all sections with the same texture can be drawn at once
+		auto& batch = Beam_section_batches[bwsi->texture.first_frame + framenum];
+		const int fan_order[6] = { 0, 1, 2, 0, 2, 3 };
+
+		for (int v : fan_order) {
+			beam_section_vertex section_vert;
+			section_vert.position = h1[v].world;
+			section_vert.tex_coord = h1[v].texture_position;
+			section_vert.r = h1[v].r;
+			section_vert.g = h1[v].g;
+			section_vert.b = h1[v].b;
+			section_vert.a = h1[v].a;
+
+			batch.push_back(section_vert);
+		}
 	}		
 	
 	// turn backface culling back on
@@ -1558,6 +1600,65 @@ void beam_render_all()
 		// next item
 		moveup = GET_NEXT(moveup);
 	}	
+
+	beam_render_section_batches();
+}
+
+void beam_render_section_batches()
+{
+	size_t num_verts = 0;
+
+	for (auto& batch : Beam_section_batches) {
+		num_verts += batch.second.size();
+	}
+
+	if (num_verts == 0) {
+		return;
+	}
+
+	// all sections are written into the immediate buffer at once, if it can't be mapped every batch is uploaded by itself
+	int buffer_handle = -1;
+	size_t buffer_offset = 0;
+	auto verts = (beam_section_vertex*)gr_map_immediate_buffer(num_verts * sizeof(beam_section_vertex), sizeof(beam_section_vertex), &buffer_handle, &buffer_offset);
+
+	if (verts != nullptr) {
+		size_t offset = 0;
+
+		for (auto& batch : Beam_section_batches) {
+			std::copy(batch.second.begin(), batch.second.end(), verts + offset);
+			offset += batch.second.size();
+		}
+
+		gr_unmap_immediate_buffer();
+	}
+
+	vertex_layout layout;
+	layout.add_vertex_component(vertex_format_data::POSITION3, sizeof(beam_section_vertex), (int)offsetof(beam_section_vertex, position));
+	layout.add_vertex_component(vertex_format_data::TEX_COORD, sizeof(beam_section_vertex), (int)offsetof(beam_section_vertex, tex_coord));
+	layout.add_vertex_component(vertex_format_data::COLOR4, sizeof(beam_section_vertex), (int)offsetof(beam_section_vertex, r));
+
+	size_t first_vert = buffer_offset / sizeof(beam_section_vertex);
+
+	for (auto& batch : Beam_section_batches) {
+		if (batch.second.empty()) {
+			continue;
+		}
+
+		material material_params;
+		material_set_unlit_emissive(&material_params, batch.first, 0.9999f, 2.0f);
+
+		int n_verts = (int)batch.second.size();
+
+		if (verts != nullptr) {
+			gr_render_primitives(&material_params, PRIM_TYPE_TRIS, &layout, (int)first_vert, n_verts, buffer_handle);
+			first_vert += n_verts;
+		} else {
+			gr_render_primitives_immediate(&material_params, PRIM_TYPE_TRIS, &layout, n_verts, batch.second.data(), n_verts * (int)sizeof(beam_section_vertex));
+		}
+
+		// keeps the memory for the next frame
+		batch.second.clear();
+	}
 }
 
 // output top and bottom vectors
@@ -2335,6 +2436,72 @@ void beam_jitter_aim(beam *b, float aim)
 // BEAM COLLISION FUNCTIONS
 // -----------------------------===========================------------------------------
 
+void beam_clear_hit_cache(beam *b)
+{
+	for (int idx = 0; idx < MAX_BEAM_HIT_CACHE; idx++) {
+		b->hit_cache[idx].objnum = -1;
+	}
+
+	b->hit_cache_next = 0;
+}
+
+// find the last collision test of the beam against the ship if it is still close enough to be used again
+beam_hit_cache *beam_find_hit_cache(beam *b, object *ship_objp, mc_info *mc, int check_exit, vec3d *local_start, vec3d *local_dir, float widest)
+{
+	if (!Beam_hit_cache) {
+		return NULL;
+	}
+
+	for (int idx = 0; idx < MAX_BEAM_HIT_CACHE; idx++) {
+		beam_hit_cache *cache = &b->hit_cache[idx];
+
+		if ((cache->objnum != OBJ_INDEX(ship_objp)) || (cache->sig != ship_objp->signature)) {
+			continue;
+		}
+
+		if ((cache->mc_flags != mc->flags) || (cache->mc_radius != mc->radius) || (cache->check_exit != check_exit)) {
+			return NULL;
+		}
+
+		// how far any point of the beam inside the bounding sphere of the ship may have moved since the test
+		float turn_dist = vm_vec_mag(local_start) + ship_objp->radius;
+		float moved = vm_vec_dist(local_start, &cache->local_start) + vm_vec_dist(local_dir, &cache->local_dir) * turn_dist;
+
+		if (moved > widest * BEAM_HIT_CACHE_TOLERANCE) {
+			return NULL;
+		}
+
+		return cache;
+	}
+
+	return NULL;
+}
+
+// remember where a hit was in the frame of the ship
+void beam_store_hit_point(vec3d *local_point, mc_info *cinfo, object *ship_objp)
+{
+	vec3d temp;
+	vm_vec_sub(&temp, &cinfo->hit_point_world, &ship_objp->pos);
+	vm_vec_rotate(local_point, &temp, &ship_objp->orient);
+}
+
+// copy a hit out of the cache and move it to where the ship is now
+void beam_restore_hit(mc_info *cinfo, mc_info *cached, vec3d *local_point, object *ship_objp, beam *b)
+{
+	*cinfo = *cached;
+
+	vm_vec_unrotate(&cinfo->hit_point_world, local_point, &ship_objp->orient);
+	vm_vec_add2(&cinfo->hit_point_world, &ship_objp->pos);
+
+	// the length of the beam may have changed
+	vec3d *p0 = cinfo->p0;
+	float length = vm_vec_dist(p0, cinfo->p1);
+
+	if (length > 0.0f) {
+		cinfo->hit_dist = vm_vec_dist(p0, &cinfo->hit_point_world) / length;
+	}
+}
+
 // collide a beam with a ship, returns 1 if we can ignore all future collisions between the 2 objects
 int beam_collide_ship(obj_pair *pair)
 {
@@ -2449,10 +2616,57 @@ int beam_collide_ship(obj_pair *pair)
 	mc_hull_enter.flags |= MC_CHECK_MODEL;
 	mc_hull_exit.flags |= MC_CHECK_MODEL;
 
-	// check all three kinds of collisions
-	int shield_collision = (pm->shield.ntris > 0) ? model_collide(&mc_shield) : 0;
-	int hull_enter_collision = model_collide(&mc_hull_enter);
-	int hull_exit_collision = (beam_will_tool_target(b, ship_objp)) ? model_collide(&mc_hull_exit) : 0;
+	// check all three kinds of collisions, unless the beam barely moved since the last test against this ship
+	int shield_collision, hull_enter_collision, hull_exit_collision;
+	int check_exit = beam_will_tool_target(b, ship_objp);
+
+	vec3d local_start, local_dir, temp;
+	vm_vec_sub(&temp, &b->last_start, &ship_objp->pos);
+	vm_vec_rotate(&local_start, &temp, &ship_objp->orient);
+	vm_vec_normalized_dir(&temp, &b->last_shot, &b->last_start);
+	vm_vec_rotate(&local_dir, &temp, &ship_objp->orient);
+
+	MONITOR_INC(BeamShipTests, 1);
+
+	beam_hit_cache *cache = beam_find_hit_cache(b, ship_objp, &mc, check_exit, &local_start, &local_dir, widest);
+
+	if (cache != NULL) {
+		MONITOR_INC(BeamShipTestsReused, 1);
+
+		beam_restore_hit(&mc_shield, &cache->mc_shield, &cache->shield_local, ship_objp, b);
+		beam_restore_hit(&mc_hull_enter, &cache->mc_hull_enter, &cache->hull_enter_local, ship_objp, b);
+		beam_restore_hit(&mc_hull_exit, &cache->mc_hull_exit, &cache->hull_exit_local, ship_objp, b);
+
+		shield_collision = cache->shield_collision;
+		hull_enter_collision = cache->hull_enter_collision;
+		hull_exit_collision = cache->hull_exit_collision;
+	} else {
+		shield_collision = (pm->shield.ntris > 0) ? model_collide(&mc_shield) : 0;
+		hull_enter_collision = model_collide(&mc_hull_enter);
+		hull_exit_collision = check_exit ? model_collide(&mc_hull_exit) : 0;
+
+		cache = &b->hit_cache[b->hit_cache_next];
+		b->hit_cache_next = (b->hit_cache_next + 1) % MAX_BEAM_HIT_CACHE;
+
+		cache->objnum = OBJ_INDEX(ship_objp);
+		cache->sig = ship_objp->signature;
+		cache->local_start = local_start;
+		cache->local_dir = local_dir;
+		cache->mc_flags = mc.flags;
+		cache->mc_radius = mc.radius;
+		cache->check_exit = check_exit;
+
+		cache->shield_collision = shield_collision;
+		cache->hull_enter_collision = hull_enter_collision;
+		cache->hull_exit_collision = hull_exit_collision;
+		cache->mc_shield = mc_shield;
+		cache->mc_hull_enter = mc_hull_enter;
+		cache->mc_hull_exit = mc_hull_exit;
+
+		beam_store_hit_point(&cache->shield_local, &mc_shield, ship_objp);
+		beam_store_hit_point(&cache->hull_enter_local, &mc_hull_enter, ship_objp);
+		beam_store_hit_point(&cache->hull_exit_local, &mc_hull_exit, ship_objp);
+	}
 
     // If we have a range less than the "far" range, check if the ray actually hit within the range
     if (b->range < BEAM_FAR_LENGTH
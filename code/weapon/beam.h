@@ -102,6 +102,30 @@ typedef struct beam_collision {
 	int			is_exit_collision;					//does this occur when the beam is exiting the ship
 } beam_collision;
 
+#define MAX_BEAM_HIT_CACHE			4
+
+// the results of the last full collision test of a beam against a ship, reused as long as the beam barely moved
+// relative to the ship since then, see beam_collide_ship()
+typedef struct beam_hit_cache {
+	int				objnum;							// the ship, -1 if unused
+	int				sig;							// object sig
+	vec3d			local_start;					// where the beam started, in the frame of the ship
+	vec3d			local_dir;						// the direction of the beam, in the frame of the ship
+	int				mc_flags;						// the MC_CHECK_* flags of the test
+	float			mc_radius;						// the radius of a sphereline test
+	int				check_exit;						// whether the exit hole was tested too
+
+	int				shield_collision;
+	int				hull_enter_collision;
+	int				hull_exit_collision;
+	mc_info			mc_shield;
+	mc_info			mc_hull_enter;
+	mc_info			mc_hull_exit;
+	vec3d			shield_local;					// the hit points, in the frame of the ship
+	vec3d			hull_enter_local;
+	vec3d			hull_exit_local;
+} beam_hit_cache;
+
 // beam flag defines
 #define BF_SAFETY						(1<<0)		// if this is set, don't collide or render for this frame. lifetime still increases though
 #define BF_SHRINK						(1<<1)		// if this is set, the beam is in the warmdown phase
@@ -153,6 +177,10 @@ typedef struct beam {
 	beam_collision f_collisions[MAX_FRAME_COLLISIONS];					// collisions for the current frame
 	int f_collision_count;														// # of collisions we recorded this frame
 
+	// collision tests against ships which may be reused
+	beam_hit_cache hit_cache[MAX_BEAM_HIT_CACHE];
+	int hit_cache_next;															// the entry which is replaced next
+
 	// looping sound info, HANDLE
 	int		beam_sound_loop;		// -1 if none
 
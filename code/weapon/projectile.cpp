@@ -0,0 +1,472 @@
+#include "weapon/projectile.h"
+
+#include "cmdline/cmdline.h"
+#include "globalincs/jobs.h"
+#include "globalincs/linklist.h"
+#include "globalincs/systemvars.h"
+#include "lighting/lighting.h"
+#include "mission/missionparse.h"
+#include "mod_table/mod_table.h"
+#include "network/multi.h"
+#include "object/object.h"
+#include "physics/physics.h"
+#include "render/3d.h"
+#include "scripting/scripting.h"
+#include "ship/ship.h"
+#include "tracing/Monitor.h"
+#include "tracing/tracing.h"
+#include "weapon/weapon.h"
+
+extern bool weapon_is_used(int weapon_index);
+extern ubyte Obj_weapon_group_id_used[WEAPON_MAX_GROUP_IDS];
+
+namespace {
+
+const size_t MAX_PROJECTILES = 16384;
+
+// how far ahead a projectile looks for something it could hit, in seconds of its flight. This is the range in which
+// the AI notices incoming fire, see update_danger_weapon().
+const float PROJECTILE_LOOKAHEAD_TIME = 1.0f;
+
+// the distance at which a weapon may play its flyby sound, see weapon_maybe_play_flyby_sound()
+const float PROJECTILE_FLYBY_RADIUS = 55.0f;
+
+// what a weapon object needs to take over from a projectile
+struct projectile_info {
+	int weapon_type;
+	int parent_objnum;
+	int parent_sig;
+	int team;
+	int species;
+	int collision_group_id;
+	int group_id;
+	int target_objnum;
+	int target_sig;
+	matrix orient;
+	vec3d start_pos;
+	fix creation_time;
+	float max_vel;
+	float laser_bitmap_frame;
+	float laser_glow_bitmap_frame;
+};
+
+// the projectiles, the arrays are used in parallel
+SCP_vector<vec3d> Projectile_pos;
+SCP_vector<vec3d> Projectile_vel;
+SCP_vector<float> Projectile_lifeleft;
+SCP_vector<projectile_info> Projectile_info;
+SCP_vector<ubyte> Projectile_promote;
+
+// the projectiles before this one existed during the last projectile_move_all(), the rest were created since
+size_t Num_moved_projectiles = 0;
+
+// the spheres of the objects the projectiles may hit, grown by the distance the objects move in the lookahead time
+struct projectile_targets {
+	SCP_vector<float> x;
+	SCP_vector<float> y;
+	SCP_vector<float> z;
+	SCP_vector<float> radius;
+	SCP_vector<int> objnum;
+
+	void clear()
+	{
+		x.clear();
+		y.clear();
+		z.clear();
+		radius.clear();
+		objnum.clear();
+	}
+
+	void add(const vec3d* pos, float r, int num)
+	{
+		x.push_back(pos->xyz.x);
+		y.push_back(pos->xyz.y);
+		z.push_back(pos->xyz.z);
+		radius.push_back(r);
+		objnum.push_back(num);
+	}
+};
+
+projectile_targets Targets;
+
+void remove_projectile(size_t index)
+{
+	size_t last = Projectile_pos.size() - 1;
+
+	if (index != last) {
+		Projectile_pos[index] = Projectile_pos[last];
+		Projectile_vel[index] = Projectile_vel[last];
+		Projectile_lifeleft[index] = Projectile_lifeleft[last];
+		Projectile_info[index] = Projectile_info[last];
+		Projectile_promote[index] = Projectile_promote[last];
+	}
+
+	Projectile_pos.pop_back();
+	Projectile_vel.pop_back();
+	Projectile_lifeleft.pop_back();
+	Projectile_info.pop_back();
+	Projectile_promote.pop_back();
+}
+
+void gather_targets(float lookahead)
+{
+	Targets.clear();
+
+	for (auto objp = GET_FIRST(&obj_used_list); objp != END_OF_LIST(&obj_used_list); objp = GET_NEXT(objp)) {
+		if (!(objp->flags[Object::Object_Flags::Collides]) || objp->flags[Object::Object_Flags::Should_be_dead]) {
+			continue;
+		}
+
+		switch (objp->type) {
+		case OBJ_SHIP:
+		case OBJ_DEBRIS:
+		case OBJ_ASTEROID:
+			break;
+
+		case OBJ_WEAPON:
+			// lasers only hit the weapons which can be shot down
+			if (Weapon_info[Weapons[objp->instance].weapon_info_index].weapon_hitpoints <= 0) {
+				continue;
+			}
+			break;
+
+		default:
+			continue;
+		}
+
+		Targets.add(&objp->pos, objp->radius + vm_vec_mag_quick(&objp->phys_info.vel) * lookahead, OBJ_INDEX(objp));
+	}
+
+	// the projectiles of the player don't play a flyby sound, so the player is the parent of the viewer
+	Targets.add(&Eye_position, PROJECTILE_FLYBY_RADIUS, (Player_obj != NULL) ? OBJ_INDEX(Player_obj) : -1);
+}
+
+// checks the path of the projectiles in the lookahead time against the targets
+void find_promoted_projectiles(float lookahead)
+{
+	jobs::parallel_for(Projectile_pos.size(), 256, [lookahead](size_t begin, size_t end, size_t) {
+		const size_t num_targets = Targets.objnum.size();
+		const float* tx = Targets.x.data();
+		const float* ty = Targets.y.data();
+		const float* tz = Targets.z.data();
+		const float* tr = Targets.radius.data();
+		const int* tobjnum = Targets.objnum.data();
+
+		for (size_t i = begin; i < end; ++i) {
+			const auto& info = Projectile_info[i];
+			const weapon_info* wip = &Weapon_info[info.weapon_type];
+
+			const float px = Projectile_pos[i].xyz.x;
+			const float py = Projectile_pos[i].xyz.y;
+			const float pz = Projectile_pos[i].xyz.z;
+			const float dx = Projectile_vel[i].xyz.x * lookahead;
+			const float dy = Projectile_vel[i].xyz.y * lookahead;
+			const float dz = Projectile_vel[i].xyz.z * lookahead;
+			const float dd = MAX(dx * dx + dy * dy + dz * dz, 0.0001f);
+			const float margin = wip->laser_length + wip->laser_head_radius;
+
+			ubyte promote = 0;
+
+			for (size_t j = 0; j < num_targets; ++j) {
+				// the closest point of the path to the center of the target
+				float cx = tx[j] - px;
+				float cy = ty[j] - py;
+				float cz = tz[j] - pz;
+
+				float t = (cx * dx + cy * dy + cz * dz) / dd;
+				t = MIN(MAX(t, 0.0f), 1.0f);
+
+				float ex = cx - t * dx;
+				float ey = cy - t * dy;
+				float ez = cz - t * dz;
+				float r = tr[j] + margin;
+
+				if ((ex * ex + ey * ey + ez * ez < r * r) && (tobjnum[j] != info.parent_objnum)) {
+					promote = 1;
+					break;
+				}
+			}
+
+			Projectile_promote[i] = promote;
+		}
+	}, tracing::MoveProjectiles);
+}
+
+// turns a projectile into a weapon object, false if there is no room for it
+bool promote_projectile(size_t index)
+{
+	auto& info = Projectile_info[index];
+	weapon_info* wip = &Weapon_info[info.weapon_type];
+
+	int parent_objnum = info.parent_objnum;
+	if ((parent_objnum >= 0) && ((Objects[parent_objnum].signature != info.parent_sig) || (Objects[parent_objnum].type != OBJ_SHIP))) {
+		parent_objnum = -1;
+	}
+
+	int objnum = weapon_create(&Projectile_pos[index], &info.orient, info.weapon_type, parent_objnum, info.group_id);
+	if (objnum < 0) {
+		return false;
+	}
+
+	object* objp = &Objects[objnum];
+	weapon* wp = &Weapons[objp->instance];
+
+	// weapon_create() picked a new direction and lifetime, the projectile already has them
+	objp->orient = info.orient;
+	vm_vec_copy_scale(&objp->phys_info.desired_vel, &info.orient.vec.fvec, wip->max_speed);
+	objp->phys_info.vel = Projectile_vel[index];
+	objp->phys_info.speed = vm_vec_mag(&objp->phys_info.vel);
+
+	wp->lifeleft = Projectile_lifeleft[index];
+	wp->weapon_max_vel = info.max_vel;
+	wp->start_pos = info.start_pos;
+	wp->creation_time = info.creation_time;
+	wp->laser_bitmap_frame = info.laser_bitmap_frame;
+	wp->laser_glow_bitmap_frame = info.laser_glow_bitmap_frame;
+
+	if (parent_objnum < 0) {
+		// the ship which fired it is gone, the weapon still belongs to it like the ones which were in flight
+		objp->parent = info.parent_objnum;
+		objp->parent_sig = info.parent_sig;
+		objp->parent_type = OBJ_SHIP;
+		wp->team = info.team;
+		wp->species = info.species;
+
+		if (Weapons_inherit_parent_collision_group) {
+			objp->collision_group_id = info.collision_group_id;
+		}
+	} else {
+		int target_objnum = info.target_objnum;
+		if ((target_objnum >= 0) && (Objects[target_objnum].signature != info.target_sig)) {
+			target_objnum = -1;
+		}
+
+		weapon_set_tracking_info(objnum, parent_objnum, target_objnum);
+	}
+
+	return true;
+}
+
+// the same as the weapon objects do in obj_move_all_post()
+void cast_light(size_t index)
+{
+	auto& info = Projectile_info[index];
+
+	if ((info.group_id >= 0) && (Obj_weapon_group_id_used[info.group_id] == 0)) {
+		// Mark this group as done
+		Obj_weapon_group_id_used[info.group_id]++;
+	} else {
+		// This group has already done its light casting
+		return;
+	}
+
+	color c;
+	weapon_get_laser_color(&c, &Weapon_info[info.weapon_type], Projectile_lifeleft[index]);
+
+	light_add_point(&Projectile_pos[index], 10.0f, 100.0f, 1.0f, i2fl(c.red) / 255.0f, i2fl(c.green) / 255.0f,
+		i2fl(c.blue) / 255.0f, info.parent_objnum);
+}
+
+}
+
+MONITOR(NumProjectiles)
+MONITOR(NumProjectilesPromoted)
+
+void projectile_level_init()
+{
+	Projectile_pos.clear();
+	Projectile_vel.clear();
+	Projectile_lifeleft.clear();
+	Projectile_info.clear();
+	Projectile_promote.clear();
+	Num_moved_projectiles = 0;
+
+	Targets.clear();
+}
+
+bool projectile_can_create(int weapon_type)
+{
+	if (!Cmdline_light_projectiles || (Game_mode & GM_MULTIPLAYER)) {
+		return false;
+	}
+
+	if (Projectile_pos.size() >= MAX_PROJECTILES) {
+		return false;
+	}
+
+	weapon_info* wip = &Weapon_info[weapon_type];
+
+	if ((wip->subtype != WP_LASER) || (wip->render_type != WRT_LASER)) {
+		return false;
+	}
+
+	if (wip->is_homing() || (wip->acceleration_time > 0.0f) || (wip->num_substitution_patterns > 0)) {
+		return false;
+	}
+
+	// these are handled in weapon_process_pre() and weapon_process_post() or make the weapon a target itself
+	if ((wip->det_range > 0.0f) || (wip->det_radius > 0.0f) || (wip->weapon_hitpoints > 0)) {
+		return false;
+	}
+
+	if (wip->wi_flags[Weapon::Info_Flags::Trail] || wip->wi_flags[Weapon::Info_Flags::Particle_spew]
+		|| wip->wi_flags[Weapon::Info_Flags::Flak] || wip->wi_flags[Weapon::Info_Flags::Spawn]
+		|| wip->wi_flags[Weapon::Info_Flags::Thruster] || wip->wi_flags[Weapon::Info_Flags::Transparent]
+		|| wip->wi_flags[Weapon::Info_Flags::Remote] || wip->wi_flags[Weapon::Info_Flags::Local_ssm]) {
+		return false;
+	}
+
+	// the first weapon of a class which wasn't paged in loads its bitmaps
+	if (!weapon_is_used(weapon_type)) {
+		return false;
+	}
+
+	// scripts may look at every weapon when it is rendered or deleted
+	if (Script_system.HasHooks(CHA_OBJECTRENDER) || Script_system.HasHooks(CHA_ONWEAPONDELETE)) {
+		return false;
+	}
+
+	return true;
+}
+
+void projectile_create(vec3d *pos, matrix *orient, int weapon_type, int parent_objnum, int group_id, float fof_cooldown, int target_objnum)
+{
+	Assertion(projectile_can_create(weapon_type), "Weapon %s can't be fired as a projectile!", Weapon_info[weapon_type].name);
+	Assertion(parent_objnum >= 0 && Objects[parent_objnum].type == OBJ_SHIP, "Projectiles have to be fired by a ship!");
+
+	weapon_info* wip = &Weapon_info[weapon_type];
+	object* parent_objp = &Objects[parent_objnum];
+	ship* parent_shipp = &Ships[parent_objp->instance];
+
+	projectile_info info;
+	info.weapon_type = weapon_type;
+	info.parent_objnum = parent_objnum;
+	info.parent_sig = parent_objp->signature;
+	info.team = parent_shipp->team;
+	info.species = Ship_info[parent_shipp->ship_info_index].species;
+	info.collision_group_id = parent_objp->collision_group_id;
+	info.group_id = group_id;
+	info.target_objnum = target_objnum;
+	info.target_sig = (target_objnum >= 0) ? Objects[target_objnum].signature : -1;
+	info.orient = *orient;
+	info.start_pos = *pos;
+	info.creation_time = Missiontime;
+	info.laser_bitmap_frame = 0.0f;
+	info.laser_glow_bitmap_frame = 0.0f;
+
+	// the spread and lifetime are picked like weapon_create() does, with the same random numbers
+	float combined_fof = wip->field_of_fire;
+	if (fof_cooldown != 0.0f) {
+		combined_fof = wip->field_of_fire + (fof_cooldown * wip->max_fof_spread);
+	}
+
+	if (combined_fof > 0.0f) {
+		vec3d f;
+		vm_vec_random_cone(&f, &info.orient.vec.fvec, combined_fof);
+		vm_vec_normalize(&f);
+		vm_vector_2_matrix(&info.orient, &f, NULL, NULL);
+	}
+
+	float rand_val = frand();
+	float lifeleft;
+	if (wip->life_min < 0.0f && wip->life_max < 0.0f) {
+		lifeleft = wip->lifetime;
+	} else {
+		lifeleft = (rand_val) * (wip->life_max - wip->life_min) / wip->life_min;
+		lifeleft = wip->life_min + lifeleft * (wip->life_max - wip->life_min);
+	}
+
+	vec3d vel;
+	vm_vec_copy_scale(&vel, &info.orient.vec.fvec, wip->max_speed);
+	info.max_vel = wip->max_speed;
+
+	if (The_mission.ai_profile->flags[AI::Profile_Flags::Use_additive_weapon_velocity]) {
+		vm_vec_scale_add2(&vel, &parent_objp->phys_info.vel, wip->vel_inherit_amount);
+		info.max_vel += vm_vec_mag(&parent_objp->phys_info.vel) * wip->vel_inherit_amount;
+	}
+
+	Projectile_pos.push_back(*pos);
+	Projectile_vel.push_back(vel);
+	Projectile_lifeleft.push_back(lifeleft);
+	Projectile_info.push_back(info);
+	Projectile_promote.push_back(0);
+}
+
+void projectile_move_all(float frametime)
+{
+	if (Projectile_pos.empty()) {
+		return;
+	}
+
+	TRACE_SCOPE(tracing::MoveProjectiles);
+
+	// the projectiles created in this frame start moving in the next one like the weapon objects
+	if (!physics_paused) {
+		vec3d* pos = Projectile_pos.data();
+		const vec3d* vel = Projectile_vel.data();
+		float* lifeleft = Projectile_lifeleft.data();
+
+		for (size_t i = 0; i < Num_moved_projectiles; ++i) {
+			pos[i].xyz.x += vel[i].xyz.x * frametime;
+			pos[i].xyz.y += vel[i].xyz.y * frametime;
+			pos[i].xyz.z += vel[i].xyz.z * frametime;
+			lifeleft[i] -= frametime;
+		}
+
+		for (size_t i = Num_moved_projectiles; i-- > 0;) {
+			if (Projectile_lifeleft[i] < 0.0f) {
+				remove_projectile(i);
+			}
+		}
+	}
+
+	// the next frame may be longer than this one, so the lookahead has some room for that
+	float lookahead = PROJECTILE_LOOKAHEAD_TIME + 2.0f * frametime;
+
+	gather_targets(lookahead);
+	find_promoted_projectiles(lookahead);
+
+	// Cast light
+	if (Detail.lighting > 2) {
+		for (size_t i = 0; i < Projectile_pos.size(); ++i) {
+			cast_light(i);
+		}
+	}
+
+	int promoted = 0;
+	for (size_t i = Projectile_pos.size(); i-- > 0;) {
+		if (Projectile_promote[i] && promote_projectile(i)) {
+			remove_projectile(i);
+			promoted++;
+		}
+	}
+
+	Num_moved_projectiles = Projectile_pos.size();
+
+	MONITOR_INC(NumProjectiles, (int)Projectile_pos.size());
+	MONITOR_INC(NumProjectilesPromoted, promoted);
+}
+
+void projectile_render_all()
+{
+	if (Projectile_pos.empty() || Cmdline_dis_weapons) {
+		return;
+	}
+
+	TRACE_SCOPE(tracing::RenderProjectiles);
+
+	for (size_t i = 0; i < Projectile_pos.size(); ++i) {
+		auto& info = Projectile_info[i];
+		weapon_info* wip = &Weapon_info[info.weapon_type];
+
+		// skip the ones behind the viewer
+		vec3d to_projectile;
+		vm_vec_sub(&to_projectile, &Projectile_pos[i], &Eye_position);
+		if (vm_vec_dot(&to_projectile, &Eye_matrix.vec.fvec) < -(wip->laser_length + wip->laser_head_radius)) {
+			continue;
+		}
+
+		weapon_render_laser(wip, &Projectile_pos[i], &info.orient, Projectile_lifeleft[i], 1.0f, &info.laser_bitmap_frame,
+			&info.laser_glow_bitmap_frame);
+	}
+}
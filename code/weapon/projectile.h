@@ -0,0 +1,66 @@
+#ifndef _PROJECTILE_H
+#define _PROJECTILE_H
+#pragma once
+
+#include "globalincs/pstypes.h"
+
+class object;
+
+/** @file
+ *  Lightweight projectiles for the bolts of primary weapons, see -light_projectiles.
+ *
+ *  Most laser bolts of a dogfight fly through empty space and never hit anything, yet every one of them is an object
+ *  and a weapon which is moved, collided and rendered like everything else. The simple ones are kept in compact arrays
+ *  here instead: they are moved in one loop, tested against the spheres of all the objects they may hit in a batch and
+ *  rendered straight into the laser batches.
+ *
+ *  A projectile which gets within about one second of flight of something it could hit or of the viewer is handed over
+ *  to weapon_create() with its position, direction and life left. From there on it is a normal weapon, so the hits, the
+ *  AI reacting to incoming fire, the flyby sounds and the scripting hooks all work on it as before.
+ */
+
+/**
+ * @brief Removes all projectiles, called from weapon_level_init()
+ */
+void projectile_level_init();
+
+/**
+ * @brief Checks if a weapon is fired as a projectile
+ *
+ * Only unguided lasers without any effects which need a weapon object qualify, and only in single player.
+ *
+ * @param weapon_type The weapon class
+ * @return @c true if projectile_create() should be used instead of weapon_create()
+ */
+bool projectile_can_create(int weapon_type);
+
+/**
+ * @brief Fires a projectile
+ *
+ * The direction and lifetime are picked the same way weapon_create() does.
+ *
+ * @param pos The firing position
+ * @param orient The firing direction
+ * @param weapon_type The weapon class, projectile_can_create() has to be @c true for it
+ * @param parent_objnum The ship which fired the weapon
+ * @param group_id The group of the weapon, see weapon_create_group_id()
+ * @param fof_cooldown The field of fire spread of the bank
+ * @param target_objnum The target of the ship, given to weapon_set_tracking_info() if the projectile becomes a weapon
+ */
+void projectile_create(vec3d *pos, matrix *orient, int weapon_type, int parent_objnum, int group_id, float fof_cooldown, int target_objnum);
+
+/**
+ * @brief Moves all projectiles and turns the ones which may hit something into weapons
+ *
+ * Called from obj_move_all() once the objects moved.
+ *
+ * @param frametime The time of the frame
+ */
+void projectile_move_all(float frametime);
+
+/**
+ * @brief Adds the projectiles to the laser batches
+ */
+void projectile_render_all();
+
+#endif // _PROJECTILE_H
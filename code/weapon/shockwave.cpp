@@ -22,6 +22,8 @@
 #include "weapon/shockwave.h"
 #include "weapon/weapon.h"
 
+#include <memory>
+
 // -----------------------------------------------------------
 // Module-wide globals
 // -----------------------------------------------------------
@@ -31,16 +33,53 @@ static const char *Default_shockwave_3D_filename = "shockwave.pof";
 static int Default_2D_shockwave_index = -1;
 static int Default_shockwave_loaded = 0;
 
+// the objects a shockwave may reach this frame
+static SCP_vector<int> Shockwave_objnums;
+
 SCP_vector<shockwave_info> Shockwave_info;
 
-shockwave Shockwaves[MAX_SHOCKWAVES];
+// the shockwaves are kept in blocks which are added as needed, a shockwave never moves so the linked list stays
+// valid when the damage of one shockwave spawns new ones
+#define SHOCKWAVE_BLOCK_SIZE	16
+
+static SCP_vector<std::unique_ptr<shockwave[]>> Shockwave_blocks;
+static SCP_vector<int> Shockwave_free_slots;
+static int Num_shockwave_slots = 0;
+
 shockwave Shockwave_list;
 int Shockwave_inited = 0;
 
-// -----------------------------------------------------------
-// Function macros
-// -----------------------------------------------------------
-#define SW_INDEX(sw) (sw-Shockwaves)
+static shockwave *shockwave_get(int index)
+{
+	Assertion( (index >= 0) && (index < Num_shockwave_slots), "Shockwave index %d is invalid (should be 0-%d); get a coder!\n", index, Num_shockwave_slots - 1 );
+	return &Shockwave_blocks[index / SHOCKWAVE_BLOCK_SIZE][index % SHOCKWAVE_BLOCK_SIZE];
+}
+
+/**
+ * Takes an unused shockwave slot, adding a new block of them if all are in use
+ */
+static int shockwave_alloc_slot()
+{
+	if (Shockwave_free_slots.empty()) {
+		Shockwave_blocks.emplace_back(new shockwave[SHOCKWAVE_BLOCK_SIZE]);
+
+		// the slots of the new block are handed out in ascending order
+		for (int i = SHOCKWAVE_BLOCK_SIZE - 1; i >= 0; i--) {
+			shockwave *sw = &Shockwave_blocks.back()[i];
+			sw->flags = 0;
+			sw->objnum = -1;
+			sw->model_id = -1;
+
+			Shockwave_free_slots.push_back(Num_shockwave_slots + i);
+		}
+
+		Num_shockwave_slots += SHOCKWAVE_BLOCK_SIZE;
+	}
+
+	int index = Shockwave_free_slots.back();
+	Shockwave_free_slots.pop_back();
+	return index;
+}
 	
 // -----------------------------------------------------------
 // Externals
@@ -69,14 +108,6 @@ int shockwave_create(int parent_objnum, vec3d *pos, shockwave_create_info *sci,
 	shockwave		*sw;
 	matrix			orient;
 
- 	for (i = 0; i < MAX_SHOCKWAVES; i++) {
-		if ( !(Shockwaves[i].flags & SW_USED) )
-			break;
-	}
-
-	if (i == MAX_SHOCKWAVES)
-		return -1;
-
 	// try 2D shockwave first, then fall back to 3D, then fall back to default of either
 	// this should be pretty fool-proof and allow quick change between 2D and 3D effects
 	if ( strlen(sci->name) )
@@ -106,7 +137,8 @@ int shockwave_create(int parent_objnum, vec3d *pos, shockwave_create_info *sci,
 		real_parent = parent_objnum;
 	}
 
-	sw = &Shockwaves[i];
+	i = shockwave_alloc_slot();
+	sw = shockwave_get(i);
 
 	sw->model_id = model_id;
 	sw->flags = (SW_USED | flag);
@@ -143,6 +175,9 @@ int shockwave_create(int parent_objnum, vec3d *pos, shockwave_create_info *sci,
 
 	if ( objnum == -1 ){
 		Int3();
+		sw->flags = 0;
+		Shockwave_free_slots.push_back(i);
+		return -1;
 	}
 
 	sw->objnum = objnum;
@@ -160,11 +195,13 @@ int shockwave_create(int parent_objnum, vec3d *pos, shockwave_create_info *sci,
 void shockwave_delete(object *objp)
 {
 	Assertion(objp->type == OBJ_SHOCKWAVE, "shockwave_delete() called on an object with a type of %d instead of OBJ_SHOCKWAVE (%d); get a coder!\n", objp->type, OBJ_SHOCKWAVE);
-	Assertion(objp->instance >= 0 && objp->instance < MAX_SHOCKWAVES, "shockwave_delete() called on an object with an invalid instance of %d (should be 0-%d); get a coder!\n", objp->instance, MAX_SHOCKWAVES - 1);
 
-	Shockwaves[objp->instance].flags = 0;
-	Shockwaves[objp->instance].objnum = -1;	
-	list_remove(&Shockwave_list, &Shockwaves[objp->instance]);
+	shockwave *sw = shockwave_get(objp->instance);
+
+	sw->flags = 0;
+	sw->objnum = -1;
+	list_remove(&Shockwave_list, sw);
+	Shockwave_free_slots.push_back(objp->instance);
 }
 
 /**
@@ -191,9 +228,7 @@ void shockwave_set_framenum(int index)
 	shockwave		*sw;
 	shockwave_info	*si;
 
-	Assertion( (index >= 0) && (index < MAX_SHOCKWAVES), "shockwave_set_framenum called with an index of %d (should be 0-%d); get a coder!\n", index, MAX_SHOCKWAVES - 1 );
-
-	sw = &Shockwaves[index];
+	sw = shockwave_get(index);
 	si = &Shockwave_info[sw->shockwave_info_index];
 
 	// skip this if it's a 3d shockwave since it won't have the maps managed here
@@ -212,12 +247,12 @@ int shockwave_get_framenum(const int sw_idx, const int ani_id)
 {
 	shockwave		*sw;
 
-	if ( (sw_idx < 0) || (sw_idx >= MAX_SHOCKWAVES) ) {
+	if ( (sw_idx < 0) || (sw_idx >= Num_shockwave_slots) ) {
 		Int3();
 		return 0;
 	}
 
-	sw = &Shockwaves[sw_idx];
+	sw = shockwave_get(sw_idx);
 
 	// ignore setting of OF_SHOULD_BE_DEAD, handled by shockwave_move
 	return bm_get_anim_frame(ani_id, sw->time_elapsed, sw->total_time);
@@ -238,8 +273,7 @@ void shockwave_move(object *shockwave_objp, float frametime)
 	int			i;
 
 	Assertion(shockwave_objp->type == OBJ_SHOCKWAVE, "shockwave_move() called on an object of type %d instead of OBJ_SHOCKWAVE (%d); get a coder!\n", shockwave_objp->type, OBJ_SHOCKWAVE);
-	Assertion(shockwave_objp->instance  >= 0 && shockwave_objp->instance < MAX_SHOCKWAVES, "shockwave_move() called on an object with an instance of %d (should be 0-%d); get a coder!\n", shockwave_objp->instance, MAX_SHOCKWAVES - 1);
-	sw = &Shockwaves[shockwave_objp->instance];
+	sw = shockwave_get(shockwave_objp->instance);
 
 	// if the shockwave has a delay on it
 	if(sw->delay_stamp != -1){
@@ -261,9 +295,13 @@ void shockwave_move(object *shockwave_objp, float frametime)
 		return;
 	}
 
+	weapon_area_find_objects(&sw->pos, sw->radius, Shockwave_objnums);
+
 	// blast ships and asteroids
 	// And (some) weapons
-	for ( objp = GET_FIRST(&obj_used_list); objp !=END_OF_LIST(&obj_used_list); objp = GET_NEXT(objp) ) {
+	for ( auto objnum : Shockwave_objnums ) {
+		objp = &Objects[objnum];
+
 		if ( (objp->type != OBJ_SHIP) && (objp->type != OBJ_ASTEROID) && (objp->type != OBJ_WEAPON)) {
 			continue;
 		}
@@ -369,9 +407,8 @@ void shockwave_render(object *objp, model_draw_list *scene)
 	vertex			p;
 
 	Assertion(objp->type == OBJ_SHOCKWAVE, "shockwave_render() called on an object of type %d instead of OBJ_SHOCKWAVE (%d); get a coder!\n", objp->type, OBJ_SHOCKWAVE);
-	Assertion(objp->instance >= 0 && objp->instance < MAX_SHOCKWAVES, "shockwave_render() called on an object with an instance of %d (should be 0-%d); get a coder!\n", objp->instance, MAX_SHOCKWAVES - 1);
 
-	sw = &Shockwaves[objp->instance];
+	sw = shockwave_get(objp->instance);
 
 	if( (sw->delay_stamp != -1) && !timestamp_elapsed(sw->delay_stamp)){
 		return;
@@ -545,10 +582,15 @@ void shockwave_level_init()
 
 	list_init(&Shockwave_list);
 
-	for ( i = 0; i < MAX_SHOCKWAVES; i++ ) {
-		Shockwaves[i].flags = 0;
-		Shockwaves[i].objnum = -1;
-		Shockwaves[i].model_id = -1;
+	// the blocks of the last mission are kept as they are likely needed again
+	Shockwave_free_slots.clear();
+	for ( i = Num_shockwave_slots - 1; i >= 0; i-- ) {
+		shockwave *sw = shockwave_get(i);
+		sw->flags = 0;
+		sw->objnum = -1;
+		sw->model_id = -1;
+
+		Shockwave_free_slots.push_back(i);
 	}
 
 	Shockwave_inited = 1;
@@ -611,13 +653,20 @@ void shockwave_move_all(float frametime)
 	}
 }
 
+/**
+ * Return the number of shockwave slots, every index below it is valid
+ */
+int shockwave_get_num_slots()
+{
+	return Num_shockwave_slots;
+}
+
 /**
  * Return the weapon_info_index field for a shockwave
  */
 int shockwave_get_weapon_index(int index)
 {
-	Assertion( (index >= 0) && (index < MAX_SHOCKWAVES), "shockwave_get_weapon_index() called on an index of %d (should be 0-%d); get a coder!\n", index, MAX_SHOCKWAVES - 1 );
-	return Shockwaves[index].weapon_info_index;
+	return shockwave_get(index)->weapon_info_index;
 }
 
 /**
@@ -625,8 +674,7 @@ int shockwave_get_weapon_index(int index)
  */
 float shockwave_get_max_radius(int index)
 {
-	Assertion( (index >= 0) && (index < MAX_SHOCKWAVES), "shockwave_get_max_radius() called on an index of %d (should be 0-%d); get a coder!\n", index, MAX_SHOCKWAVES - 1 );
-	return Shockwaves[index].outer_radius;
+	return shockwave_get(index)->outer_radius;
 }
 
 /**
@@ -634,8 +682,7 @@ float shockwave_get_max_radius(int index)
  */
 float shockwave_get_min_radius(int index)
 {
-	Assertion( (index >= 0) && (index < MAX_SHOCKWAVES), "shockwave_get_min_radius() called on an index of %d (should be 0-%d); get a coder!\n", index, MAX_SHOCKWAVES - 1 );
-	return Shockwaves[index].inner_radius;
+	return shockwave_get(index)->inner_radius;
 }
 
 /**
@@ -643,8 +690,7 @@ float shockwave_get_min_radius(int index)
  */
 float shockwave_get_damage(int index)
 {
-	Assertion( (index >= 0) && (index < MAX_SHOCKWAVES), "shockwave_get_damage() called on an index of %d (should be 0-%d); get a coder!\n", index, MAX_SHOCKWAVES - 1 );
-	return Shockwaves[index].damage;
+	return shockwave_get(index)->damage;
 }
 
 /**
@@ -652,8 +698,7 @@ float shockwave_get_damage(int index)
  */
 int shockwave_get_damage_type_idx(int index)
 {
-	Assertion( (index >= 0) && (index < MAX_SHOCKWAVES), "shockwave_get_damage_type_idx() called on an index of %d (should be 0-%d); get a coder!\n", index, MAX_SHOCKWAVES - 1 );
-	return Shockwaves[index].damage_type_idx;
+	return shockwave_get(index)->damage_type_idx;
 }
 
 /**
@@ -661,8 +706,7 @@ int shockwave_get_damage_type_idx(int index)
  */
 int shockwave_get_flags(int index)
 {
-	Assertion( (index >= 0) && (index < MAX_SHOCKWAVES), "shockwave_get_flags() called on an index of %d (should be 0-%d); get a coder!\n", index, MAX_SHOCKWAVES - 1 );
-	return Shockwaves[index].flags;
+	return shockwave_get(index)->flags;
 }
 
 void shockwave_page_in()
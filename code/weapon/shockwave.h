@@ -23,7 +23,6 @@ class model_draw_list;
 #define	SW_SHIP_DEATH		(1<<2)
 #define	SW_WEAPON_KILL		(1<<3)	// Shockwave created when weapon destroyed by another
 
-#define	MAX_SHOCKWAVES					16
 #define	SW_MAX_OBJS_HIT	64
 
 // -----------------------------------------------------------
@@ -97,6 +96,7 @@ int  shockwave_create(int parent_objnum, vec3d *pos, shockwave_create_info *sci,
 void shockwave_render(object *objp, model_draw_list *scene);
 int shockwave_load(const char *s_name, bool shock_3D = false);
 
+int   shockwave_get_num_slots();
 int   shockwave_get_weapon_index(int index);
 float shockwave_get_min_radius(int index);
 float shockwave_get_max_radius(int index);
@@ -15,31 +15,105 @@
 #include "io/timer.h"
 #include "render/3d.h" 
 #include "ship/ship.h"
+#include "tracing/Monitor.h"
 #include "tracing/tracing.h"
 #include "weapon/trails.h"
 
-int Num_trails;
-trail Trails;
+#include <memory>
+
+namespace {
+
+// the layout of the ribbon vertices, the same components g3_render_primitives_colored_textured() uses
+struct trail_vertex {
+	vec3d position;
+	uv_pair tex_coord;
+	ubyte r, g, b, a;
+};
+
+// a trail which is drawn this frame and where its ribbon is in the vertex data
+struct trail_render_item {
+	trail *trailp;
+	size_t first_section;
+	int num_sections;
+	size_t first_vert;
+	int num_verts;
+};
+
+// trails are allocated in blocks of this many so creating and destroying one never touches the heap
+const size_t TRAIL_POOL_BLOCK_SIZE = 64;
+
+SCP_vector<std::unique_ptr<trail[]>> Trail_pool_blocks;
+SCP_vector<trail*> Trail_free_list;
+
+// all trails that exist right now, in no particular order
+SCP_vector<trail*> Trails;
+
+// the ages of the trail points are measured against this clock so moving the trails doesn't need to touch every point
+float Trail_time = 0.0f;
+
+SCP_vector<int> Trail_render_sections;
+SCP_vector<trail_render_item> Trail_render_items;
+SCP_vector<trail_vertex> Trail_render_verts;
+
+trail *trail_pool_alloc()
+{
+	if (Trail_free_list.empty()) {
+		std::unique_ptr<trail[]> block(new trail[TRAIL_POOL_BLOCK_SIZE]);
+
+		for (size_t i = 0; i < TRAIL_POOL_BLOCK_SIZE; ++i) {
+			Trail_free_list.push_back(&block[TRAIL_POOL_BLOCK_SIZE - 1 - i]);
+		}
+
+		Trail_pool_blocks.push_back(std::move(block));
+	}
+
+	trail *trailp = Trail_free_list.back();
+	Trail_free_list.pop_back();
+
+	return trailp;
+}
+
+void trail_pool_free(trail *trailp)
+{
+	// keeps the list of active trails contiguous by moving the last one into the free spot
+	trail *last = Trails.back();
+	Trails[trailp->active_index] = last;
+	last->active_index = trailp->active_index;
+	Trails.pop_back();
+
+	trailp->active_index = -1;
+	Trail_free_list.push_back(trailp);
+}
+
+// how far the point has faded out, 0 when it was just added and 1 at the end of its life
+inline float trail_point_age(const trail *trailp, int n)
+{
+	return (Trail_time - trailp->spawn_time[n]) / trailp->info.max_life;
+}
+
+}
+
+MONITOR(NumTrails)
 
 // Reset everything between levels
 void trail_level_init()
 {
-	Num_trails = 0;
-	Trails.next = &Trails;
+	for (auto trailp : Trails) {
+		trailp->active_index = -1;
+		Trail_free_list.push_back(trailp);
+	}
+
+	Trails.clear();
+	Trail_time = 0.0f;
 }
 
 void trail_level_close()
 {
-	trail *nextp;
-	for(trail *trailp = Trails.next; trailp != &Trails; trailp = nextp)
-	{
-		nextp = trailp->next;
+	Trails.clear();
+	Trail_free_list.clear();
+	Trail_pool_blocks.clear();
 
-		//Now we can delete it
-		delete trailp;
-	}
-
-	Num_trails=0;
+	Trail_time = 0.0f;
 }
 
 //returns the number of a free trail
@@ -51,11 +125,8 @@ trail *trail_create(trail_info *info)
 	if((Game_mode & GM_STANDALONE_SERVER) || !Detail.weapon_extras)
 		return NULL;
 
-	// Make a new trail
-	trail *trailp = new trail;
-
-	// increment counter
-	Num_trails++;
+	// Take a trail from the pool
+	trail *trailp = trail_pool_alloc();
 
 	// Init the trail data
 	trailp->info = *info;
@@ -64,10 +135,8 @@ trail *trail_create(trail_info *info)
 	trailp->object_died = false;		
 	trailp->trail_stamp = timestamp(trailp->info.stamp);
 
-	//Add it to the front of the list
-	//This is quickest since there are no prev vars
-	trailp->next = Trails.next;
-	Trails.next = trailp;
+	trailp->active_index = (int)Trails.size();
+	Trails.push_back(trailp);
 
 	return trailp;
 }
@@ -108,96 +177,20 @@ int trail_is_on_ship(trail *trailp, ship *shipp)
 	return 0;
 }
 
-// Render the trail behind a missile.
-// Basically a queue of points that face the viewer
-static vertex *Trail_v_list = NULL;
-static int Trail_verts_allocated = 0;
-
-static void deallocate_trail_verts()
-{
-	if (Trail_v_list != NULL) {
-		vm_free(Trail_v_list);
-		Trail_v_list = NULL;
-	}
-}
-
-static void allocate_trail_verts(int num_verts)
+// Builds the ribbon behind a missile.
+// Basically a tristrip of a top and a bottom vertex for every point, facing the viewer and closed by the center of the
+// oldest point. Returns the number of vertices written, num_sections * 2 - 1.
+static int trail_build_ribbon( trail *trailp, const int *sections, int num_sections, trail_vertex *verts )
 {
-	if (num_verts <= 0)
-		return;
-
-	if (num_verts <= Trail_verts_allocated)
-		return;
-
-	if (Trail_v_list != NULL) {
-		vm_free(Trail_v_list);
-		Trail_v_list = NULL;
-	}
-
-	Trail_v_list = (vertex*) vm_malloc( num_verts * sizeof(vertex) );
-
-	memset( Trail_v_list, 0, sizeof(vertex) * Trail_verts_allocated );
-
-	Trail_verts_allocated = num_verts;
-
-
-	static bool will_free_at_exit = false;
-
-	if ( !will_free_at_exit ) {
-		atexit(deallocate_trail_verts);
-		will_free_at_exit = true;
-	}
-}
-
-void trail_render( trail * trailp )
-{
-	int sections[NUM_TRAIL_SECTIONS];
-	int num_sections = 0;
-	int i;
+	int i, n;
 	vec3d topv, botv, *fvec, last_pos, tmp_fvec;
-	vertex  top, bot;
+	vec3d prev_topv, prev_botv;
 	int nv = 0;
 	float w;
-	ubyte l;
-	vec3d centerv;
-
-	if (trailp->tail == trailp->head)
-		return;
-
-	// if this trail is on the player ship, and he's in any padlock view except rear view, don't draw	
-	if ( (Player_ship != NULL) && trail_is_on_ship(trailp, Player_ship) &&
-		(Viewer_mode & (VM_PADLOCK_UP | VM_PADLOCK_LEFT | VM_PADLOCK_RIGHT)) )
-	{
-		return;
-	}
+	ubyte l, prev_l = 0;
 
 	trail_info *ti	= &trailp->info;
 
-	int n = trailp->tail;
-
-	do	{
-		n--;
-
-		if (n < 0)
-			n = NUM_TRAIL_SECTIONS-1;
-
-		if (trailp->val[n] > 1.0f)
-			break;
-
-		sections[num_sections++] = n;
-	} while ( n != trailp->head );
-
-	if (num_sections <= 0)
-		return;
-
-	Assertion(ti->texture.bitmap_id != -1, "Weapon trail %s could not be loaded", ti->texture.filename); // We can leave this as an assert, but tell them how to fix it. --Chief
-
-	memset( &top, 0, sizeof(vertex) );
-	memset( &bot, 0, sizeof(vertex) );
-
-	// it's a tristrip, so allocate for 2+1
-	allocate_trail_verts((num_sections * 2) + 1);
-
 	float w_size = (ti->w_end - ti->w_start);
 	float a_size = (ti->a_end - ti->a_start);
 	int num_faded_sections = ti->n_fade_out_sections;
@@ -205,16 +198,17 @@ void trail_render( trail * trailp )
 	for (i = 0; i < num_sections; i++) {
 		n = sections[i];
 		float init_fade_out = 1.0f;
+		float val = trail_point_age(trailp, n);
 
 		if ((num_faded_sections > 0) && (i < num_faded_sections)) {
 			init_fade_out = ((float) i) / (float) num_faded_sections;
 		}
 
-		w = trailp->val[n] * w_size + ti->w_start;
+		w = val * w_size + ti->w_start;
 		if (init_fade_out != 1.0f) {
-			l = (ubyte)fl2i((trailp->val[n] * a_size + ti->a_start) * 255.0f * init_fade_out * init_fade_out);
+			l = (ubyte)fl2i((val * a_size + ti->a_start) * 255.0f * init_fade_out * init_fade_out);
 		} else {
-			l = (ubyte)fl2i((trailp->val[n] * a_size + ti->a_start) * 255.0f);
+			l = (ubyte)fl2i((val * a_size + ti->a_start) * 255.0f);
 		}
 
 		if ( i == 0 )	{
@@ -236,71 +230,41 @@ void trail_render( trail * trailp )
 
 		trail_calc_facing_pts( &topv, &botv, fvec, &trailp->pos[n], w );
 
-		g3_transfer_vertex( &top, &topv );
-		g3_transfer_vertex( &bot, &botv );
-
-		top.a = bot.a = l;	
-
 		if (i > 0) {
 			float U = i2fl(i);
 
+			// the previous point is finished with the brightness of this one
+			verts[nv].position = prev_topv;
+			verts[nv].tex_coord.u = U;
+			verts[nv].tex_coord.v = 1.0f;
+			verts[nv].r = verts[nv].g = verts[nv].b = l;
+			verts[nv].a = (i == num_sections-1) ? l : prev_l;
+			nv++;
+
+			verts[nv].position = prev_botv;
+			verts[nv].tex_coord.u = U;
+			verts[nv].tex_coord.v = 0.0f;
+			verts[nv].r = verts[nv].g = verts[nv].b = l;
+			verts[nv].a = prev_l;
+			nv++;
+
 			if (i == num_sections-1) {
 				// Last one...
-				vm_vec_avg( &centerv, &topv, &botv );
-
-				g3_transfer_vertex( &Trail_v_list[nv+2], &centerv );
-
-				Trail_v_list[nv].a = l;	
-
-				Trail_v_list[nv].texture_position.u = U;
-				Trail_v_list[nv].texture_position.v = 1.0f; 
-				Trail_v_list[nv].r = Trail_v_list[nv].g = Trail_v_list[nv].b = l;
-				nv++;
-
-				Trail_v_list[nv].texture_position.u = U;
-				Trail_v_list[nv].texture_position.v = 0.0f; 
-				Trail_v_list[nv].r = Trail_v_list[nv].g = Trail_v_list[nv].b = l;
-				nv++;
-
-				Trail_v_list[nv].texture_position.u = U + 1.0f;
-				Trail_v_list[nv].texture_position.v = 0.5f;
-				Trail_v_list[nv].r = Trail_v_list[nv].g = Trail_v_list[nv].b = 0;
-				nv++;
-			} else {
-				Trail_v_list[nv].texture_position.u = U;
-				Trail_v_list[nv].texture_position.v = 1.0f; 
-				Trail_v_list[nv].r = Trail_v_list[nv].g = Trail_v_list[nv].b = l;
-				nv++;
-
-				Trail_v_list[nv].texture_position.u = U;
-				Trail_v_list[nv].texture_position.v = 0.0f; 
-				Trail_v_list[nv].r = Trail_v_list[nv].g = Trail_v_list[nv].b = l;
+				vm_vec_avg( &verts[nv].position, &topv, &botv );
+				verts[nv].tex_coord.u = U + 1.0f;
+				verts[nv].tex_coord.v = 0.5f;
+				verts[nv].r = verts[nv].g = verts[nv].b = verts[nv].a = 0;
 				nv++;
 			}
 		}
 
 		last_pos = trailp->pos[n];
-		Trail_v_list[nv] = top;
-		Trail_v_list[nv+1] = bot;
+		prev_topv = topv;
+		prev_botv = botv;
+		prev_l = l;
 	}
 
-	if ( !nv )
-		return;
-
-	if (nv < 3)
-		Error( LOCATION, "too few verts in trail render\n" );
-
-	// there should always be three verts in the last section and 2 everyware else, therefore there should always be an odd number of verts
-	if ( (nv % 2) != 1 )
-		Warning( LOCATION, "even number of verts in trail render\n" );
-
-	TRACE_SCOPE(tracing::TrailDraw);
-	//gr_set_bitmap( ti->texture.bitmap_id, GR_ALPHABLEND_FILTER, GR_BITBLT_MODE_NORMAL, 1.0f );
-	//gr_render(nv, Trail_v_list, TMAP_FLAG_TEXTURED | TMAP_FLAG_ALPHA | TMAP_FLAG_GOURAUD | TMAP_FLAG_RGB | TMAP_HTL_3D_UNLIT | TMAP_FLAG_TRISTRIP);
-
-	material material_def;
-	material_set_unlit(&material_def, ti->texture.bitmap_id, 1.0f, true, true);
-	g3_render_primitives_colored_textured(&material_def, Trail_v_list, nv, PRIM_TYPE_TRISTRIP, false);
+	return nv;
 }
 
 void trail_add_segment( trail *trailp, vec3d *pos )
@@ -318,7 +282,7 @@ void trail_add_segment( trail *trailp, vec3d *pos )
 	}
 	
 	trailp->pos[next] = *pos;
-	trailp->val[next] = 0.0f;
+	trailp->spawn_time[next] = Trail_time;
 }		
 
 void trail_set_segment( trail *trailp, vec3d *pos )
@@ -335,45 +299,29 @@ void trail_move_all(float frametime)
 {
 	TRACE_SCOPE(tracing::TrailsMoveAll);
 
-	int num_alive_segments,n;
-	float time_delta;
-	trail *next_trail;
-	trail *prev_trail = &Trails;
+	Trail_time += frametime;
 
-	for (trail *trailp = Trails.next; trailp != &Trails; trailp = next_trail) {
-		next_trail = trailp->next;
-
-		num_alive_segments = 0;
+	for (size_t i = 0; i < Trails.size(); ) {
+		trail *trailp = Trails[i];
+		bool alive = false;
 
+		// the newest point is the last one to fade out
 		if ( trailp->tail != trailp->head )	{
-			n = trailp->tail;			
-			time_delta = frametime / trailp->info.max_life;
-			do	{
-				n--;
-				if ( n < 0 ) n = NUM_TRAIL_SECTIONS-1;
-
-				trailp->val[n] += time_delta;
-
-				if ( trailp->val[n] <= 1.0f ) {
-					num_alive_segments++;	// Record how many still alive.
-				}
-
-			} while ( n != trailp->head );
-		}		
-	
-		if ( (num_alive_segments < 1) && trailp->object_died)
-		{
-			prev_trail->next = trailp->next;
-			delete trailp;
+			int newest = trailp->tail - 1;
+			if ( newest < 0 ) newest = NUM_TRAIL_SECTIONS-1;
 
-			// decrement counter
-			Num_trails--;
+			alive = trail_point_age(trailp, newest) <= 1.0f;
 		}
-		else
-		{
-			prev_trail = trailp;
+
+		if ( !alive && trailp->object_died ) {
+			// the last trail takes its place so the same index is checked again
+			trail_pool_free(trailp);
+		} else {
+			++i;
 		}
 	}
+
+	MONITOR_SET(NumTrails, (int)Trails.size());
 }
 
 void trail_object_died( trail *trailp )
@@ -390,16 +338,101 @@ void trail_render_all()
 	if ( !Detail.weapon_extras )
 		return;
 
-	for(trail *trailp = Trails.next; trailp!=&Trails; trailp = trailp->next )
-	{
-		//trail_add_batch(trailp);
-		trail_render(trailp);
+	Trail_render_sections.clear();
+	Trail_render_items.clear();
+
+	size_t num_verts = 0;
+
+	for (auto trailp : Trails) {
+		if (trailp->tail == trailp->head)
+			continue;
+
+		// if this trail is on the player ship, and he's in any padlock view except rear view, don't draw	
+		if ( (Player_ship != NULL) && trail_is_on_ship(trailp, Player_ship) &&
+			(Viewer_mode & (VM_PADLOCK_UP | VM_PADLOCK_LEFT | VM_PADLOCK_RIGHT)) )
+		{
+			continue;
+		}
+
+		trail_render_item item;
+		item.trailp = trailp;
+		item.first_section = Trail_render_sections.size();
+
+		// collect the points which are still alive, newest first
+		int n = trailp->tail;
+
+		do	{
+			n--;
+
+			if (n < 0)
+				n = NUM_TRAIL_SECTIONS-1;
+
+			if (trail_point_age(trailp, n) > 1.0f)
+				break;
+
+			Trail_render_sections.push_back(n);
+		} while ( n != trailp->head );
+
+		item.num_sections = (int)(Trail_render_sections.size() - item.first_section);
+
+		// a single point has no ribbon
+		if (item.num_sections < 2) {
+			Trail_render_sections.resize(item.first_section);
+			continue;
+		}
+
+		Assertion(trailp->info.texture.bitmap_id != -1, "Weapon trail %s could not be loaded", trailp->info.texture.filename); // We can leave this as an assert, but tell them how to fix it. --Chief
+
+		item.first_vert = num_verts;
+		item.num_verts = (item.num_sections * 2) - 1;
+		num_verts += item.num_verts;
+
+		Trail_render_items.push_back(item);
+	}
+
+	if (Trail_render_items.empty())
+		return;
+
+	// the ribbons of all trails are written straight into the immediate buffer so they are uploaded at once
+	int buffer_handle = -1;
+	size_t buffer_offset = 0;
+	auto verts = (trail_vertex*)gr_map_immediate_buffer(num_verts * sizeof(trail_vertex), sizeof(trail_vertex), &buffer_handle, &buffer_offset);
+	bool mapped = verts != nullptr;
+
+	if (!mapped) {
+		Trail_render_verts.resize(num_verts);
+		verts = Trail_render_verts.data();
+	}
+
+	for (auto& item : Trail_render_items) {
+		trail_build_ribbon(item.trailp, &Trail_render_sections[item.first_section], item.num_sections, &verts[item.first_vert]);
+	}
+
+	if (mapped) {
+		gr_unmap_immediate_buffer();
 	}
 
-	//profile_begin("Batch Render Trails");
-	//batch_render_all(Trail_buffer_object);
-	//profile_end("Batch Render Trails");
+	TRACE_SCOPE(tracing::TrailDraw);
+
+	vertex_layout layout;
+	layout.add_vertex_component(vertex_format_data::POSITION3, sizeof(trail_vertex), (int)offsetof(trail_vertex, position));
+	layout.add_vertex_component(vertex_format_data::TEX_COORD, sizeof(trail_vertex), (int)offsetof(trail_vertex, tex_coord));
+	layout.add_vertex_component(vertex_format_data::COLOR4, sizeof(trail_vertex), (int)offsetof(trail_vertex, r));
+
+	size_t first_vert = buffer_offset / sizeof(trail_vertex);
+
+	for (auto& item : Trail_render_items) {
+		material material_def;
+		material_set_unlit(&material_def, item.trailp->info.texture.bitmap_id, 1.0f, true, true);
+
+		if (mapped) {
+			gr_render_primitives(&material_def, PRIM_TYPE_TRISTRIP, &layout, (int)(first_vert + item.first_vert), item.num_verts, buffer_handle);
+		} else {
+			gr_render_primitives_immediate(&material_def, PRIM_TYPE_TRISTRIP, &layout, item.num_verts, &verts[item.first_vert], item.num_verts * (int)sizeof(trail_vertex));
+		}
+	}
 }
+
 int trail_stamp_elapsed(trail *trailp)
 {
 	return timestamp_elapsed(trailp->trail_stamp);
@@ -31,17 +31,18 @@ typedef struct trail_info {
 	int n_fade_out_sections;// number of initial sections used for fading out start 'edge' of the effect
 } trail_info;
 
+// trails are kept in pooled blocks, a pointer to one stays valid until the trail has faded out after trail_object_died()
 typedef struct trail {
 	int		head, tail;						// pointers into the queue for the trail points
 	vec3d	pos[NUM_TRAIL_SECTIONS];	// positions of trail points
-	float	val[NUM_TRAIL_SECTIONS];	// for each point, a value that tells how much to fade out	
+	float	spawn_time[NUM_TRAIL_SECTIONS];	// for each point, the time of the trail clock it was added at
 	bool	object_died;					// set to zero as long as object	
 	int		trail_stamp;					// trail timestamp	
 
 	// trail info
 	trail_info info;							// this is passed when creating a trail
 
-	struct	trail * next;
+	int		active_index;					// index into the list of active trails
 
 } trail;
 
@@ -15,6 +15,7 @@
 #include "globalincs/globals.h"
 #include "globalincs/systemvars.h"
 #include "graphics/2d.h"
+#include "graphics/decals.h"
 #include "graphics/generic.h"
 #include "model/model.h"
 #include "weapon/shockwave.h"
@@ -332,6 +333,8 @@ typedef struct weapon_info {
 	float shield_impact_explosion_radius;
 
 	particle::ParticleEffectIndex impact_weapon_expl_effect; // Impact particle effect
+
+	decal_definition impact_decal; // left on the hull where the weapon hits
 	
 	particle::ParticleEffectIndex dinky_impact_weapon_expl_effect; // Dinky impact particle effect
 
@@ -574,6 +577,9 @@ void	weapon_area_apply_blast(vec3d *force_apply_pos, object *ship_objp, vec3d *b
 int	weapon_area_calc_damage(object *objp, vec3d *pos, float inner_rad, float outer_rad, float max_blast, float max_damage,
 										float *blast, float *damage, float limit);
 
+// finds the ships, asteroids and weapons an explosion at pos may reach within radius, some further away may be returned too
+void	weapon_area_find_objects(vec3d *pos, float radius, SCP_vector<int> &objnums);
+
 void	missile_obj_list_rebuild();	// called by save/restore code only
 missile_obj *missile_obj_return_address(int index);
 void find_homing_object_cmeasures();
@@ -590,6 +596,10 @@ void ship_do_weapon_thruster_frame( weapon *weaponp, object *objp, float frameti
 
 // call to get the "color" of the laser at the given moment (since glowing lasers can cycle colors)
 void weapon_get_laser_color(color *c, object *objp);
+void weapon_get_laser_color(color *c, weapon_info *wip, float lifeleft);
+
+// adds the bitmaps of a laser to the batches, for weapons which are rendered as lasers
+void weapon_render_laser(weapon_info *wip, vec3d *pos, matrix *orient, float lifeleft, float alpha_current, float *bitmap_frame, float *glow_bitmap_frame);
 
 void weapon_hit_do_sound(object *hit_obj, weapon_info *wip, vec3d *hitpos, bool is_armed);
 
@@ -18,6 +18,7 @@
 #include "freespace.h"
 #include "gamesnd/gamesnd.h"
 #include "globalincs/linklist.h"
+#include "graphics/decals.h"
 #include "graphics/grbatch.h"
 #include "hud/hud.h"
 #include "hud/hudartillery.h"
@@ -34,6 +35,7 @@
 #include "network/multiutil.h"
 #include "object/objcollide.h"
 #include "object/object.h"
+#include "object/objspatial.h"
 #include "parse/parselo.h"
 #include "scripting/scripting.h"
 #include "particle/particle.h"
@@ -50,6 +52,7 @@
 #include "weapon/emp.h"
 #include "weapon/flak.h"
 #include "weapon/muzzleflash.h"
+#include "weapon/projectile.h"
 #include "weapon/swarm.h"
 #include "weapon/weapon.h"
 #include "particle/effects/SingleParticleEffect.h"
@@ -57,6 +60,7 @@
 #include "particle/effects/ParticleEmitterEffect.h"
 #include "tracing/Monitor.h"
 #include "tracing/tracing.h"
+#include "utils/string_intern.h"
 
 // Since SSMs are parsed after weapons, if we want to allow SSM strikes to be specified by name, we need to store those names until after SSMs are parsed.
 typedef struct delayed_ssm_data {
@@ -179,6 +183,9 @@ const size_t num_weapon_info_flags = sizeof(Weapon_Info_Flags) / sizeof(flag_def
 
 int Num_weapon_types = 0;
 
+// the weapons found by weapon_info_lookup() by the interned id of their name
+static SCP_unordered_map<int, int> Weapon_info_name_index;
+
 int Num_weapons = 0;
 int Weapons_inited = 0;
 int Weapon_expl_initted = 0;
@@ -225,6 +232,26 @@ int		Weapon_impact_timer;			// timer, initialized at start of each mission
 // range. Check the comment in weapon_set_tracking_info() for more details
 #define LOCKED_HOMING_EXTENDED_LIFE_FACTOR			1.2f
 
+// heat seekers look for ships within this distance first and search further out only if there is none in their cone
+#define HOMING_SEARCH_MIN_RANGE		1000.0f
+#define HOMING_SEARCH_MAX_RANGE		99999.9f
+
+// lists of objects gathered the first time they are needed in a frame
+typedef struct frame_obj {
+	int objnum;
+	int signature;
+} frame_obj;
+
+static SCP_vector<frame_obj> Cmeasure_objs;		// the countermeasures in flight
+static SCP_vector<frame_obj> Blast_objs;		// the asteroids and weapons which explosions can damage, see weapon_area_find_objects()
+static int Frame_objs_frame = -1;
+
+// weapon_area_calc_damage() measures with vm_vec_dist_quick(), which can come out a bit shorter than the
+// real distance, so the objects are looked for this much further out
+#define BLAST_QUERY_SLACK		1.25f
+
+static SCP_vector<int> Homing_candidate_ships;
+
 extern int compute_num_homing_objects(object *target_objp);
 
 extern void fs2netd_add_table_validation(const char *tblname);
@@ -545,9 +572,19 @@ int weapon_info_lookup(const char *name)
 	if (name == NULL)
 		return -1;
 
-	for (int i=0; i<Num_weapon_types; i++)
-		if (!stricmp(name, Weapon_info[i].name))
+	// weapons are added while the tables are parsed and sorted afterwards, so a weapon from the index is checked and
+	// one which isn't in there is still searched for
+	auto iter = Weapon_info_name_index.find(string_intern::find(name));
+
+	if ((iter != Weapon_info_name_index.end()) && (iter->second < Num_weapon_types) && !stricmp(name, Weapon_info[iter->second].name))
+		return iter->second;
+
+	for (int i=0; i<Num_weapon_types; i++) {
+		if (!stricmp(name, Weapon_info[i].name)) {
+			Weapon_info_name_index[string_intern::intern(name)] = i;
 			return i;
+		}
+	}
 
 	return -1;
 }
@@ -1690,6 +1727,10 @@ int parse_weapon(int subtype, bool replace, const char *filename)
 		}
 	}
 
+	if (optional_string("$Impact Decal:")) {
+		decal_definition_parse(&wip->impact_decal);
+	}
+
 	if (optional_string("$Dinky Impact Effect:")) {
 		wip->dinky_impact_weapon_expl_effect = particle::util::parseEffect(wip->name);
 	} else {
@@ -3134,6 +3175,11 @@ void weapon_release_bitmaps()
 		if ( used_weapons[i] )
 			continue;
 
+		if (wip->impact_decal.bitmap >= 0) {
+			bm_release(wip->impact_decal.bitmap);
+			wip->impact_decal.bitmap = -1;
+		}
+
 		if (wip->render_type == WRT_LASER) {
 			if (wip->laser_bitmap.first_frame >= 0) {
 				bm_release(wip->laser_bitmap.first_frame);
@@ -3325,6 +3371,8 @@ void weapon_load_bitmaps(int weapon_index)
 		generic_anim_load(&wip->thruster_flame);
 	}
 
+	decal_definition_load(&wip->impact_decal);
+
 	if (strlen(wip->thruster_glow.filename)) {
 		wip->thruster_glow.first_frame = bm_load(wip->thruster_glow.filename);
 		if (wip->thruster_glow.first_frame >= 0) {
@@ -3546,6 +3594,12 @@ void weapon_level_init()
 	
 	cscrew_level_init();
 
+	projectile_level_init();
+
+	Cmeasure_objs.clear();
+	Blast_objs.clear();
+	Frame_objs_frame = -1;
+
 	// emp effect
 	emp_level_init();
 
@@ -3691,28 +3745,145 @@ void detonate_nearby_missiles(object* killer_objp, object* missile_objp)
 	}
 }
 
+/**
+ * Gathers the countermeasures and the objects explosions can damage, once per frame.
+ * The weapons created later in the frame are added by weapon_create().
+ */
+static void weapon_gather_frame_objs()
+{
+	if (Frame_objs_frame == Framecount)
+		return;
+
+	Cmeasure_objs.clear();
+	Blast_objs.clear();
+
+	for (int objnum : obj_get_type_list(OBJ_WEAPON)) {
+		object *objp = &Objects[objnum];
+		weapon_info *wip = &Weapon_info[Weapons[objp->instance].weapon_info_index];
+
+		if (wip->wi_flags[Weapon::Info_Flags::Cmeasure]) {
+			Cmeasure_objs.push_back({ objnum, objp->signature });
+		}
+		if (wip->weapon_hitpoints > 0) {
+			Blast_objs.push_back({ objnum, objp->signature });
+		}
+	}
+
+	for (int objnum : obj_get_type_list(OBJ_ASTEROID)) {
+		Blast_objs.push_back({ objnum, Objects[objnum].signature });
+	}
+
+	Frame_objs_frame = Framecount;
+}
+
+/**
+ * The countermeasures which are in flight this frame.
+ */
+static const SCP_vector<frame_obj> &weapon_get_cmeasures()
+{
+	weapon_gather_frame_objs();
+
+	return Cmeasure_objs;
+}
+
+/**
+ * Checks if the heat seeker weapon_objp may home on objp, which is a ship or a countermeasure.
+ * The distance and the cone are left to the caller since they are cheaper to test.
+ */
+static bool find_homing_object_allowed(object *weapon_objp, weapon *wp, weapon_info *wip, object *objp, ship_subsys **target_engines)
+{
+	//WMC - Spawn weapons shouldn't go for protected ships
+	// ditto for untargeted heat seekers - niffiwan
+	if ( (objp->flags[Object::Object_Flags::Protected]) &&
+		((wp->weapon_flags[Weapon::Weapon_Flags::Spawned]) || (wip->wi_flags[Weapon::Info_Flags::Untargeted_heat_seeker])) )
+		return false;
+
+	// Spawned weapons should never home in on their parent - even in multiplayer dogfights where they would pass the iff test below
+	if ((wp->weapon_flags[Weapon::Weapon_Flags::Spawned]) && (objp == &Objects[weapon_objp->parent]))
+		return false;
+
+	if (!iff_x_attacks_y(wp->team, obj_team(objp)))
+		return false;
+
+	*target_engines = NULL;
+
+	if ( objp->type == OBJ_SHIP )
+	{
+		ship *sp = &Ships[objp->instance];
+		ship_info *sip = &Ship_info[sp->ship_info_index];
+
+		//if the homing weapon is a huge weapon and the ship that is being
+		//looked at is not huge, then don't home
+		if ((wip->wi_flags[Weapon::Info_Flags::Huge]) &&
+			(sip->is_small_ship() || !sip->is_flyable() || sip->is_harmless()))
+		{
+			return false;
+		}
+
+		// AL 2-17-98: If ship is immune to sensors, can't home on it (Sandeep says so)!
+		if ( sp->flags[Ship::Ship_Flags::Hidden_from_sensors] ) {
+			return false;
+		}
+
+		// Goober5000: if missiles can't home on sensor-ghosted ships,
+		// they definitely shouldn't home on stealth ships
+		if ( sp->flags[Ship::Ship_Flags::Stealth] && (The_mission.ai_profile->flags[AI::Profile_Flags::Fix_heat_seeker_stealth_bug]) ) {
+			return false;
+		}
+
+		if (wip->wi_flags[Weapon::Info_Flags::Homing_javelin])
+		{
+			*target_engines = ship_get_closest_subsys_in_sight(sp, SUBSYSTEM_ENGINE, &weapon_objp->pos);
+
+			if (!*target_engines)
+				return false;
+		}
+
+		//	MK, 9/4/99.
+		//	If this is a player object, make sure there aren't already too many homers.
+		//	Only in single player.  In multiplayer, we don't want to restrict it in dogfight on team vs. team.
+		//	For co-op, it's probably also OK.
+		if (!( Game_mode & GM_MULTIPLAYER )) {
+			int	num_homers = compute_num_homing_objects(objp);
+			if (The_mission.ai_profile->max_allowed_player_homers[Game_skill_level] < num_homers)
+				return false;
+		}
+	}
+	else if (objp->type == OBJ_WEAPON)
+	{
+		//don't attempt to home on weapons if the weapon is a huge weapon or is a javelin homing weapon.
+		if (wip->wi_flags[Weapon::Info_Flags::Huge, Weapon::Info_Flags::Homing_javelin])
+			return false;
+
+		//don't look for local ssms that are gone for the time being
+		if (Weapons[objp->instance].lssm_stage == 3)
+			return false;
+	}
+
+	return true;
+}
+
 /**
  * Find an object for weapon #num (object *weapon_objp) to home on due to heat.
+ *
+ * The closest ship or countermeasure in the cone of the seeker is picked, countermeasures count at half their distance.
  */
 void find_homing_object(object *weapon_objp, int num)
 {
 	object      *objp, *old_homing_objp;
 	weapon_info *wip;
 	weapon      *wp;
-    ship        *sp;
-    ship_info   *sip;
 	float       best_dist;
-    int         homing_object_team;
-    float       dist;
-    float       dot;
-    vec3d       vec_to_object;
-    ship_subsys *target_engines = NULL;
+	float       dist;
+	float       dot;
+	vec3d       vec_to_object;
+	ship_subsys *target_engines = NULL;
 
 	wp = &Weapons[num];
 
 	wip = &Weapon_info[Weapons[num].weapon_info_index];
 
-	best_dist = 99999.9f;
+	best_dist = HOMING_SEARCH_MAX_RANGE;
 
 	// save the old homing object so that multiplayer servers can give the right information
 	// to clients if the object changes
@@ -3720,98 +3891,65 @@ void find_homing_object(object *weapon_objp, int num)
 
 	wp->homing_object = &obj_used_list;
 
-	//	Scan all objects, find a weapon to home on.
-	for ( objp = GET_FIRST(&obj_used_list); objp !=END_OF_LIST(&obj_used_list); objp = GET_NEXT(objp) ) {
-		if ((objp->type == OBJ_SHIP) || ((objp->type == OBJ_WEAPON) && (Weapon_info[Weapons[objp->instance].weapon_info_index].wi_flags[Weapon::Info_Flags::Cmeasure])))
-		{
-			//WMC - Spawn weapons shouldn't go for protected ships
-			// ditto for untargeted heat seekers - niffiwan
-			if ( (objp->flags[Object::Object_Flags::Protected]) &&
-				((wp->weapon_flags[Weapon::Weapon_Flags::Spawned]) || (wip->wi_flags[Weapon::Info_Flags::Untargeted_heat_seeker])) )
-				continue;
-
-			// Spawned weapons should never home in on their parent - even in multiplayer dogfights where they would pass the iff test below
-			if ((wp->weapon_flags[Weapon::Weapon_Flags::Spawned]) && (objp == &Objects[weapon_objp->parent]))
-				continue; 
-
-			homing_object_team = obj_team(objp);
-			if (iff_x_attacks_y(wp->team, homing_object_team))
-			{
-				if ( objp->type == OBJ_SHIP )
-                {
-                    sp  = &Ships[objp->instance];
-                    sip = &Ship_info[sp->ship_info_index];
-
-                    //if the homing weapon is a huge weapon and the ship that is being
-                    //looked at is not huge, then don't home
-                    if ((wip->wi_flags[Weapon::Info_Flags::Huge]) &&
-                        (sip->is_small_ship() || !sip->is_flyable() || sip->is_harmless()))
-                    {
-                        continue;
-                    }
+	for (auto &cm : weapon_get_cmeasures()) {
+		objp = &Objects[cm.objnum];
 
-					// AL 2-17-98: If ship is immune to sensors, can't home on it (Sandeep says so)!
-					if ( sp->flags[Ship::Ship_Flags::Hidden_from_sensors] ) {
-						continue;
-					}
+		// it may have been deleted since the list was gathered
+		if ((objp->signature != cm.signature) || (objp->type != OBJ_WEAPON))
+			continue;
 
-					// Goober5000: if missiles can't home on sensor-ghosted ships,
-					// they definitely shouldn't home on stealth ships
-					if ( sp->flags[Ship::Ship_Flags::Stealth] && (The_mission.ai_profile->flags[AI::Profile_Flags::Fix_heat_seeker_stealth_bug]) ) {
-						continue;
-					}
+		dist = 0.5f * vm_vec_normalized_dir(&vec_to_object, &objp->pos, &weapon_objp->pos);
+		if (dist >= best_dist)
+			continue;
 
-                    if (wip->wi_flags[Weapon::Info_Flags::Homing_javelin])
-                    {
-                        target_engines = ship_get_closest_subsys_in_sight(sp, SUBSYSTEM_ENGINE, &weapon_objp->pos);
+		dot = vm_vec_dot(&vec_to_object, &weapon_objp->orient.vec.fvec);
+		if (dot <= wip->fov)
+			continue;
 
-                        if (!target_engines)
-                            continue;
-                    }
+		if (find_homing_object_allowed(weapon_objp, wp, wip, objp, &target_engines)) {
+			best_dist = dist;
+			wp->homing_object	= objp;
+			wp->target_sig		= objp->signature;
+			wp->homing_subsys	= target_engines;
+		}
+	}
 
-					//	MK, 9/4/99.
-					//	If this is a player object, make sure there aren't already too many homers.
-					//	Only in single player.  In multiplayer, we don't want to restrict it in dogfight on team vs. team.
-					//	For co-op, it's probably also OK.
-					if (!( Game_mode & GM_MULTIPLAYER )) {
-						int	num_homers = compute_num_homing_objects(objp);
-						if (The_mission.ai_profile->max_allowed_player_homers[Game_skill_level] < num_homers)
-							continue;
-					}
-				}
-                else if (objp->type == OBJ_WEAPON)
-				{
-                    //don't attempt to home on weapons if the weapon is a huge weapon or is a javelin homing weapon.
-                    if (wip->wi_flags[Weapon::Info_Flags::Huge, Weapon::Info_Flags::Homing_javelin])
-                        continue;
-                    
-                    //don't look for local ssms that are gone for the time being
-					if (Weapons[objp->instance].lssm_stage == 3)
-						continue;
-				}
+	// Search for ships in growing spheres. Once the best ship is inside the sphere every ship which could be closer was
+	// tested, the ones further out may be returned too but that doesn't hurt.
+	int enemy_team_mask = iff_get_attackee_mask(wp->team);
+	float range = MIN(HOMING_SEARCH_MIN_RANGE, best_dist);
 
-				dist = vm_vec_normalized_dir(&vec_to_object, &objp->pos, &weapon_objp->pos);
+	for (;;) {
+		obj_spatial_find_ships(&weapon_objp->pos, range, enemy_team_mask, Homing_candidate_ships);
 
-				if (objp->type == OBJ_WEAPON && (Weapon_info[Weapons[objp->instance].weapon_info_index].wi_flags[Weapon::Info_Flags::Cmeasure])) {
-					dist *= 0.5f;
-				}
+		for (auto objnum : Homing_candidate_ships) {
+			objp = &Objects[objnum];
 
-				dot = vm_vec_dot(&vec_to_object, &weapon_objp->orient.vec.fvec);
+			dist = vm_vec_normalized_dir(&vec_to_object, &objp->pos, &weapon_objp->pos);
+			if (dist >= best_dist)
+				continue;
 
-				if (dot > wip->fov) {
-					if (dist < best_dist) {
-						best_dist = dist;
-						wp->homing_object	= objp;
-						wp->target_sig		= objp->signature;
-						wp->homing_subsys	= target_engines;
+			dot = vm_vec_dot(&vec_to_object, &weapon_objp->orient.vec.fvec);
+			if (dot <= wip->fov)
+				continue;
 
-						cmeasure_maybe_alert_success(objp);
-					}
-				}
+			if (find_homing_object_allowed(weapon_objp, wp, wip, objp, &target_engines)) {
+				best_dist = dist;
+				wp->homing_object	= objp;
+				wp->target_sig		= objp->signature;
+				wp->homing_subsys	= target_engines;
 			}
 		}
+
+		if ((best_dist <= range) || (range >= HOMING_SEARCH_MAX_RANGE))
+			break;
+
+		range = MIN(range * 4.0f, HOMING_SEARCH_MAX_RANGE);
 	}
 
+	if (wp->homing_object != &obj_used_list)
+		cmeasure_maybe_alert_success(wp->homing_object);
+
 	if (wp->homing_object == Player_obj)
 		weapon_maybe_play_warning(wp);
 
@@ -3836,10 +3974,12 @@ void find_homing_object_cmeasures_1(object *weapon_objp)
 
 	best_dot = wip->fov;			//	Note, setting to this avoids comparison below.
 
-	for ( objp = GET_FIRST(&obj_used_list); objp !=END_OF_LIST(&obj_used_list); objp = GET_NEXT(objp) )
+	for (auto &cm : weapon_get_cmeasures())
 	{
-		//first check if its a weapon, then setup the pointers
-		if (objp->type == OBJ_WEAPON)
+		objp = &Objects[cm.objnum];
+
+		//first check if its still there, then setup the pointers
+		if ((objp->signature == cm.signature) && (objp->type == OBJ_WEAPON))
 		{
 			cm_wp = &Weapons[objp->instance];
 			cm_wip = &Weapon_info[cm_wp->weapon_info_index];
@@ -3931,13 +4071,13 @@ void find_homing_object_cmeasures()
 
 	Cmeasures_homing_check--;
 
-	for (weapon_objp = GET_FIRST(&obj_used_list); weapon_objp != END_OF_LIST(&obj_used_list); weapon_objp = GET_NEXT(weapon_objp) ) {
-		if (weapon_objp->type == OBJ_WEAPON) {
-			weapon_info	*wip = &Weapon_info[Weapons[weapon_objp->instance].weapon_info_index];
+	// nothing to be decoyed by
+	if (weapon_get_cmeasures().empty())
+		return;
 
-			if (wip->is_homing())
-				find_homing_object_cmeasures_1(weapon_objp);
-		}
+	for (int objnum : obj_get_homing_weapons()) {
+		weapon_objp = &Objects[objnum];
+		find_homing_object_cmeasures_1(weapon_objp);
 	}
 
 }
@@ -5325,6 +5465,16 @@ int weapon_create( vec3d * pos, matrix * porient, int weapon_type, int parent_ob
 	if(wip->wi_flags[Weapon::Info_Flags::Cmeasure]) {
 		//2-frame homing check, to fend off sync errors
 		Cmeasures_homing_check = 2;
+
+		// the missiles of this frame should see it too
+		if (Frame_objs_frame == Framecount) {
+			Cmeasure_objs.push_back({ objnum, Objects[objnum].signature });
+		}
+	}
+
+	// and the explosions of this frame may shoot it down
+	if ((wip->weapon_hitpoints > 0) && (Frame_objs_frame == Framecount)) {
+		Blast_objs.push_back({ objnum, Objects[objnum].signature });
 	}
 
 	//	Make remote detonate missiles look like they're getting detonated by firer simply by giving them variable lifetimes.
@@ -5508,8 +5658,8 @@ int weapon_create( vec3d * pos, matrix * porient, int weapon_type, int parent_ob
 
 	Num_weapons++;
 
-	if (Weapons_inherit_parent_collision_group) {
-		Objects[objnum].collision_group_id = Objects[parent_objnum].collision_group_id;
+	if (Weapons_inherit_parent_collision_group && (parent_objp != NULL)) {
+		Objects[objnum].collision_group_id = parent_objp->collision_group_id;
 	}
 
 	weapon_update_state(wp);
@@ -5954,6 +6104,37 @@ void weapon_area_apply_blast(vec3d *force_apply_pos, object *ship_objp, vec3d *b
 	}
 }
 
+/**
+ * Finds the objects an explosion may reach
+ *
+ * The ships come from the spatial index, the asteroids and the weapons with hitpoints from the list of this frame.
+ * weapon_area_calc_damage() still has to be called for each of them.
+ *
+ * @param pos		World pos of explosion center
+ * @param radius	How far the explosion reaches
+ * @param objnums	Receives the object numbers
+ */
+void weapon_area_find_objects(vec3d *pos, float radius, SCP_vector<int> &objnums)
+{
+	weapon_gather_frame_objs();
+
+	// the ships are tested against their bounding box, which the index allows for
+	obj_spatial_find_ships(pos, radius * BLAST_QUERY_SLACK, -1, objnums);
+
+	for (auto &entry : Blast_objs) {
+		object *objp = &Objects[entry.objnum];
+
+		// it may have been deleted since the list was gathered
+		if ((objp->signature != entry.signature) || ((objp->type != OBJ_WEAPON) && (objp->type != OBJ_ASTEROID)))
+			continue;
+
+		float reach = (radius + objp->radius) * BLAST_QUERY_SLACK;
+
+		if (vm_vec_dist_squared(pos, &objp->pos) <= reach * reach)
+			objnums.push_back(entry.objnum);
+	}
+}
+
 /**
  * Do the area effect for a weapon
  *
@@ -5970,9 +6151,15 @@ void weapon_do_area_effect(object *wobjp, shockwave_create_info *sci, vec3d *pos
 
 	wip = &Weapon_info[Weapons[wobjp->instance].weapon_info_index];	
 
+	// the damage may delete objects and the lists may be refilled, so this has its own copy
+	SCP_vector<int> objnums;
+	weapon_area_find_objects(pos, sci->outer_rad, objnums);
+
 	// only blast ships and asteroids
 	// And (some) weapons
-	for ( objp = GET_FIRST(&obj_used_list); objp !=END_OF_LIST(&obj_used_list); objp = GET_NEXT(objp) ) {
+	for ( auto objnum : objnums ) {
+		objp = &Objects[objnum];
+
 		if ( (objp->type != OBJ_SHIP) && (objp->type != OBJ_ASTEROID) && (objp->type != OBJ_WEAPON) ) {
 			continue;
 		}
@@ -6397,6 +6584,9 @@ void weapons_page_in()
 	if ( !Cmdline_load_all_weapons )
 		weapon_release_bitmaps();
 
+	// the models which aren't loaded yet are processed by the job workers while the loop continues
+	model_begin_batch_load();
+
 	// Page in bitmaps for all used weapons
 	for (i = 0; i < Num_weapon_types; i++) {
 		if ( !Cmdline_load_all_weapons ) {
@@ -6457,6 +6647,8 @@ void weapons_page_in()
 		shockwave_create_info_load(&wip->shockwave);
 		shockwave_create_info_load(&wip->dinky_shockwave);
 
+		bm_page_in_texture( wip->impact_decal.bitmap );
+
 		// trail bitmaps
 		if ( (wip->wi_flags[Weapon::Info_Flags::Trail]) && (wip->tr_info.texture.bitmap_id > -1) )
 			bm_page_in_texture( wip->tr_info.texture.bitmap_id );
@@ -6489,6 +6681,8 @@ void weapons_page_in()
 		bm_page_in_texture(wip->thruster_flame.first_frame);
 		bm_page_in_texture(wip->thruster_glow.first_frame);
 	}
+
+	model_end_batch_load();
 }
 
 /**
@@ -6642,6 +6836,8 @@ bool weapon_page_in(int weapon_type)
 		shockwave_create_info_load(&wip->shockwave);
 		shockwave_create_info_load(&wip->dinky_shockwave);
 
+		bm_page_in_texture( wip->impact_decal.bitmap );
+
 		// trail bitmaps
 		if ((wip->wi_flags[Weapon::Info_Flags::Trail]) && (wip->tr_info.texture.bitmap_id > -1))
 			bm_page_in_texture(wip->tr_info.texture.bitmap_id);
@@ -6690,8 +6886,6 @@ bool weapon_used(int weapon_type) {
 void weapon_get_laser_color(color *c, object *objp)
 {
 	weapon *wep;
-	weapon_info *winfo;
-	float pct;
 
 	// sanity
 	if (c == NULL)
@@ -6707,7 +6901,16 @@ void weapon_get_laser_color(color *c, object *objp)
 		return;
 
 	wep = &Weapons[objp->instance];
-	winfo = &Weapon_info[wep->weapon_info_index];
+
+	weapon_get_laser_color(c, &Weapon_info[wep->weapon_info_index], wep->lifeleft);
+}
+
+/**
+ * Get the "color" of a laser of a weapon class with the given life left
+ */
+void weapon_get_laser_color(color *c, weapon_info *winfo, float lifeleft)
+{
+	float pct;
 
 	// if we're a one-color laser
 	if ( (winfo->laser_color_2.red == winfo->laser_color_1.red) && (winfo->laser_color_2.green == winfo->laser_color_1.green) && (winfo->laser_color_2.blue == winfo->laser_color_1.blue) ) {
@@ -6720,7 +6923,7 @@ void weapon_get_laser_color(color *c, object *objp)
 	int b = winfo->laser_color_1.blue;
 
 	// lifetime pct
-	pct = 1.0f - (wep->lifeleft / winfo->lifetime);
+	pct = 1.0f - (lifeleft / winfo->lifetime);
 	CLAMP(pct, 0.0f, 0.5f);
 
 	if (pct > 0.0f) {
@@ -7248,12 +7451,96 @@ void shield_impact_explosion(vec3d *hitpos, object *objp, float radius, int idx)
 	particle::create( hitpos, &vmd_zero_vector, 0.0f, radius, particle::PARTICLE_BITMAP_PERSISTENT, expl_ani_handle, objp );
 }
 
+/**
+ * Adds the bitmaps of a laser to the batches
+ *
+ * @param wip The weapon class, it has to be rendered as a laser
+ * @param pos The tail of the laser
+ * @param orient The orientation of the laser
+ * @param lifeleft The life left of the laser, for the color of the glow
+ * @param alpha_current The alpha of a transparent laser
+ * @param bitmap_frame The time into the animation of the laser bitmap, advanced by the frame time
+ * @param glow_bitmap_frame The time into the animation of the glow bitmap, advanced by the frame time
+ */
+void weapon_render_laser(weapon_info *wip, vec3d *pos, matrix *orient, float lifeleft, float alpha_current, float *bitmap_frame, float *glow_bitmap_frame)
+{
+	if(wip->laser_length < 0.0001f)
+		return;
+
+	color c;
+
+	int alpha = 255;
+	int framenum = 0;
+
+	if (wip->laser_bitmap.first_frame >= 0) {					
+		gr_set_color_fast(&wip->laser_color_1);
+
+		if (wip->laser_bitmap.num_frames > 1) {
+			*bitmap_frame += flFrametime;
+
+			framenum = bm_get_anim_frame(wip->laser_bitmap.first_frame, *bitmap_frame, wip->laser_bitmap.total_time, true);
+		}
+
+		if (wip->wi_flags[Weapon::Info_Flags::Transparent])
+			alpha = fl2i(alpha_current * 255.0f);
+
+		vec3d headp;
+
+		vm_vec_scale_add(&headp, pos, &orient->vec.fvec, wip->laser_length);
+
+		batching_add_laser(wip->laser_bitmap.first_frame + framenum, &headp, wip->laser_head_radius, pos, wip->laser_tail_radius, alpha, alpha, alpha);
+	}			
+
+	// maybe draw laser glow bitmap
+	if (wip->laser_glow_bitmap.first_frame >= 0) {
+		// get the laser color
+		weapon_get_laser_color(&c, wip, lifeleft);
+
+		// *Tail point "getting bigger" as well as headpoint isn't being taken into consideration, so
+		//  it caused uneven glow between the head and tail, which really shows in big lasers. So...fixed!    -Et1
+		vec3d headp2, tailp;
+
+		vm_vec_scale_add(&headp2, pos, &orient->vec.fvec, wip->laser_length * weapon_glow_scale_l);
+		vm_vec_scale_add(&tailp, pos, &orient->vec.fvec, wip->laser_length * (1 -  weapon_glow_scale_l) );
+
+		framenum = 0;
+
+		if (wip->laser_glow_bitmap.num_frames > 1) {
+			*glow_bitmap_frame += flFrametime;
+
+			// Sanity checks
+			if (*glow_bitmap_frame < 0.0f)
+				*glow_bitmap_frame = 0.0f;
+			if (*glow_bitmap_frame > 100.0f)
+				*glow_bitmap_frame = 0.0f;
+
+			while (*glow_bitmap_frame > wip->laser_glow_bitmap.total_time)
+				*glow_bitmap_frame -= wip->laser_glow_bitmap.total_time;
+
+			framenum = fl2i( (*glow_bitmap_frame * wip->laser_glow_bitmap.num_frames) / wip->laser_glow_bitmap.total_time );
+
+			CLAMP(framenum, 0, wip->laser_glow_bitmap.num_frames-1);
+		}
+
+		if (wip->wi_flags[Weapon::Info_Flags::Transparent]) {
+			alpha = fl2i(alpha_current * 255.0f);
+			alpha -= 38; // take 1.5f into account for the normal glow alpha
+
+			if (alpha < 0)
+				alpha = 0;
+		} else {
+			alpha = weapon_glow_alpha;
+		}
+
+		batching_add_laser(wip->laser_glow_bitmap.first_frame + framenum, &headp2, wip->laser_head_radius * weapon_glow_scale_f, &tailp, wip->laser_tail_radius * weapon_glow_scale_r, (c.red*alpha)/255, (c.green*alpha)/255, (c.blue*alpha)/255);
+	}
+}
+
 void weapon_render(object* obj, model_draw_list *scene)
 {
 	int num;
 	weapon_info *wip;
 	weapon *wp;
-	color c;
 
 	MONITOR_INC(NumWeaponsRend, 1);
 
@@ -7289,75 +7576,7 @@ void weapon_render(object* obj, model_draw_list *scene)
 	{
 	case WRT_LASER:
 		{
-			if(wip->laser_length < 0.0001f)
-				return;
-
-			int alpha = 255;
-			int framenum = 0;
-
-			if (wip->laser_bitmap.first_frame >= 0) {					
-				gr_set_color_fast(&wip->laser_color_1);
-
-				if (wip->laser_bitmap.num_frames > 1) {
-					wp->laser_bitmap_frame += flFrametime;
-
-					framenum = bm_get_anim_frame(wip->laser_bitmap.first_frame, wp->laser_bitmap_frame, wip->laser_bitmap.total_time, true);
-				}
-
-				if (wip->wi_flags[Weapon::Info_Flags::Transparent])
-					alpha = fl2i(wp->alpha_current * 255.0f);
-
-				vec3d headp;
-
-				vm_vec_scale_add(&headp, &obj->pos, &obj->orient.vec.fvec, wip->laser_length);
-
-				batching_add_laser(wip->laser_bitmap.first_frame + framenum, &headp, wip->laser_head_radius, &obj->pos, wip->laser_tail_radius, alpha, alpha, alpha);
-			}			
-
-			// maybe draw laser glow bitmap
-			if (wip->laser_glow_bitmap.first_frame >= 0) {
-				// get the laser color
-				weapon_get_laser_color(&c, obj);
-
-				// *Tail point "getting bigger" as well as headpoint isn't being taken into consideration, so
-				//  it caused uneven glow between the head and tail, which really shows in big lasers. So...fixed!    -Et1
-				vec3d headp2, tailp;
-
-				vm_vec_scale_add(&headp2, &obj->pos, &obj->orient.vec.fvec, wip->laser_length * weapon_glow_scale_l);
-				vm_vec_scale_add(&tailp, &obj->pos, &obj->orient.vec.fvec, wip->laser_length * (1 -  weapon_glow_scale_l) );
-
-				framenum = 0;
-
-				if (wip->laser_glow_bitmap.num_frames > 1) {
-					wp->laser_glow_bitmap_frame += flFrametime;
-
-					// Sanity checks
-					if (wp->laser_glow_bitmap_frame < 0.0f)
-						wp->laser_glow_bitmap_frame = 0.0f;
-					if (wp->laser_glow_bitmap_frame > 100.0f)
-						wp->laser_glow_bitmap_frame = 0.0f;
-
-					while (wp->laser_glow_bitmap_frame > wip->laser_glow_bitmap.total_time)
-						wp->laser_glow_bitmap_frame -= wip->laser_glow_bitmap.total_time;
-
-					framenum = fl2i( (wp->laser_glow_bitmap_frame * wip->laser_glow_bitmap.num_frames) / wip->laser_glow_bitmap.total_time );
-
-					CLAMP(framenum, 0, wip->laser_glow_bitmap.num_frames-1);
-				}
-
-				if (wip->wi_flags[Weapon::Info_Flags::Transparent]) {
-					alpha = fl2i(wp->alpha_current * 255.0f);
-					alpha -= 38; // take 1.5f into account for the normal glow alpha
-
-					if (alpha < 0)
-						alpha = 0;
-				} else {
-					alpha = weapon_glow_alpha;
-				}
-
-				batching_add_laser(wip->laser_glow_bitmap.first_frame + framenum, &headp2, wip->laser_head_radius * weapon_glow_scale_f, &tailp, wip->laser_tail_radius * weapon_glow_scale_r, (c.red*alpha)/255, (c.green*alpha)/255, (c.blue*alpha)/255);
-			}
-
+			weapon_render_laser(wip, &obj->pos, &obj->orient, wp->lifeleft, wp->alpha_current, &wp->laser_bitmap_frame, &wp->laser_glow_bitmap_frame);
 			break;
 		}
 
@@ -7612,6 +7831,8 @@ void weapon_info::reset()
 
 	this->impact_weapon_expl_effect = -1;
 
+	this->impact_decal = decal_definition();
+
 	this->dinky_impact_weapon_expl_effect = -1;
 
 	this->flash_impact_weapon_expl_effect = -1;
@@ -425,6 +425,11 @@ BOOL CFREDApp::OnIdle(LONG lCount) {
 		return FALSE;
 
 	render_frame();	// "do the rendering!"  Renders image to offscreen buffer
+
+	// game_do_frame() asks for the next one when something changes
+	if (Update_window > 0)
+		Update_window--;
+
 	process_pending_messages();
 
 	FrameCount++;
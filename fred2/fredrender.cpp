@@ -26,6 +26,7 @@
 #include "globalincs/linklist.h"
 #include "graphics/2d.h"
 #include "graphics/font.h"
+#include "graphics/material.h"
 #include "graphics/tmapper.h"
 #include "iff_defs/iff_defs.h"
 #include "io/key.h"
@@ -48,6 +49,7 @@
 #include "starfield/starfield.h"
 #include "weapon/weapon.h"
 
+#include <algorithm>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -70,6 +72,9 @@ static char THIS_FILE[] = __FILE__;
 #define FRED_COLOUR_WHITE	0xffffff
 #define FRED_COLOUR_YELLOW	0x9fff00
 
+#define PICK_CELL_SIZE	64		// size of the cells of the screen which the objects are sorted into for picking, in pixels
+#define REDRAW_INTERVAL	500		// ms between redraws when nothing seems to change, for what the scene checksum misses
+
 const float FRED_DEFAULT_HTL_FOV = 0.485f;
 const float FRED_BRIEFING_HTL_FOV = 0.325f;
 const float FRED_DEAFULT_HTL_DRAW_DIST = 300000.0f;
@@ -133,6 +138,44 @@ static vec3d Global_light_world = { 0.208758f, -0.688253f, -0.694782f };
 int Fred_grid_colors_inited = 0;
 color Fred_grid_bright, Fred_grid_dark, Fred_grid_bright_aa, Fred_grid_dark_aa;
 
+// the lines of the grid, made again only when the grid moves
+struct grid_lines {
+	vec3d center;
+	matrix gmatrix;
+	float square_size;
+	int ncols, nrows;
+	int double_fine;
+
+	SCP_vector<vec3d> dark;
+	SCP_vector<vec3d> bright;
+};
+
+static grid_lines Grid_lines;
+static bool Grid_lines_valid = false;
+
+// the waypoints drawn so far in this frame by their instance, to find the neighbours they are connected to
+static SCP_unordered_map<int, int> Rendered_waypoints;
+
+// the objects which were there when the view was drawn the last time
+struct pick_entry {
+	int objnum;
+	int signature;
+};
+
+static SCP_vector<pick_entry> Pick_entries;		// in the order of obj_used_list
+static SCP_vector<SCP_vector<int>> Pick_cells;	// the entries which may cover some of each cell
+static SCP_vector<int> Pick_everywhere;			// the entries which are too close to the eye to be bounded on the screen
+static int Pick_cols = 0;
+static int Pick_rows = 0;
+static int Pick_screen_w = 0;
+static int Pick_screen_h = 0;
+static int Pick_num_objects = 0;
+static vec3d Pick_eye_pos;
+static bool Pick_valid = false;
+
+static uint Last_scene_checksum = 0;
+static int Last_redraw_time = 0;
+
 /**
  * @brief Enables HTL
  */
@@ -312,6 +355,18 @@ void fred_render_grid(grid *gridp);
  */
 void render_active_rect(void);
 
+/**
+ * @brief Sorts the objects into the cells of the screen they cover, for select_object() and pick_objects_in_rect()
+ *
+ * @details Called at the end of render_frame() with the view it was drawn with
+ */
+void pick_index_build();
+
+/**
+ * @brief Checksum of everything the view shows, so it only has to be drawn again when something changed
+ */
+uint fred_scene_checksum();
+
 /**
  * @brief Render the universal compass
  */
@@ -433,37 +488,39 @@ void display_distances() {
 	object *objp, *o2;
 	vec3d pos;
 	vertex v;
+	size_t i, j;
 
+	// only the marked objects are measured, find them once instead of going through all objects for every one of them
+	SCP_vector<object*> marked;
 
-	gr_set_color(255, 0, 0);
 	objp = GET_FIRST(&obj_used_list);
 	while (objp != END_OF_LIST(&obj_used_list))
 	{
 		if (objp->flags[Object::Object_Flags::Marked])
-		{
-			o2 = GET_NEXT(objp);
-			while (o2 != END_OF_LIST(&obj_used_list))
-			{
-				if (o2->flags[Object::Object_Flags::Marked])
-				{
-					rpd_line(&objp->pos, &o2->pos);
-					vm_vec_avg(&pos, &objp->pos, &o2->pos);
-					g3_rotate_vertex(&v, &pos);
-					if (!(v.codes & CC_BEHIND))
-						if (!(g3_project_vertex(&v) & PF_OVERFLOW))	{
-							sprintf(buf, "%.1f", vm_vec_dist(&objp->pos, &o2->pos));
-							gr_set_color_fast(&colour_white);
-							gr_string((int) v.screen.xyw.x, (int) v.screen.xyw.y, buf);
-						}
-				}
+			marked.push_back(objp);
 
+		objp = GET_NEXT(objp);
+	}
 
+	gr_set_color(255, 0, 0);
+	for (i = 0; i < marked.size(); i++)
+	{
+		objp = marked[i];
 
-				o2 = GET_NEXT(o2);
-			}
+		for (j = i + 1; j < marked.size(); j++)
+		{
+			o2 = marked[j];
+
+			rpd_line(&objp->pos, &o2->pos);
+			vm_vec_avg(&pos, &objp->pos, &o2->pos);
+			g3_rotate_vertex(&v, &pos);
+			if (!(v.codes & CC_BEHIND))
+				if (!(g3_project_vertex(&v) & PF_OVERFLOW))	{
+					sprintf(buf, "%.1f", vm_vec_dist(&objp->pos, &o2->pos));
+					gr_set_color_fast(&colour_white);
+					gr_string((int) v.screen.xyw.x, (int) v.screen.xyw.y, buf);
+				}
 		}
-
-		objp = GET_NEXT(objp);
 	}
 }
 
@@ -805,9 +862,79 @@ void fred_enable_htl() {
 	gr_set_view_matrix(&Eye_position, &Eye_matrix);
 }
 
-void fred_render_grid(grid *gridp) {
+static void fred_make_grid_lines(grid *gridp) {
 	int	i, ncols, nrows;
 
+	Grid_lines.center = gridp->center;
+	Grid_lines.gmatrix = gridp->gmatrix;
+	Grid_lines.square_size = gridp->square_size;
+	Grid_lines.ncols = gridp->ncols;
+	Grid_lines.nrows = gridp->nrows;
+	Grid_lines.double_fine = double_fine_gridlines;
+
+	Grid_lines.dark.clear();
+	Grid_lines.bright.clear();
+
+	ncols = gridp->ncols;
+	nrows = gridp->nrows;
+	if (double_fine_gridlines) {
+		ncols *= 2;
+		nrows *= 2;
+	}
+
+	//	The column lines.
+	for (i = 0; i <= ncols; i++) {
+		Grid_lines.dark.push_back(gridp->gpoints1[i]);
+		Grid_lines.dark.push_back(gridp->gpoints2[i]);
+	}
+	//	The row lines.
+	for (i = 0; i <= nrows; i++) {
+		Grid_lines.dark.push_back(gridp->gpoints3[i]);
+		Grid_lines.dark.push_back(gridp->gpoints4[i]);
+	}
+
+	ncols = gridp->ncols / 2;
+	nrows = gridp->nrows / 2;
+
+	// the larger, brighter gridlines that is x10 the scale of smaller one.
+	for (i = 0; i <= ncols; i++) {
+		Grid_lines.bright.push_back(gridp->gpoints5[i]);
+		Grid_lines.bright.push_back(gridp->gpoints6[i]);
+	}
+
+	for (i = 0; i <= nrows; i++) {
+		Grid_lines.bright.push_back(gridp->gpoints7[i]);
+		Grid_lines.bright.push_back(gridp->gpoints8[i]);
+	}
+
+	Grid_lines_valid = true;
+}
+
+// all the lines of one color in one go, like g3_draw_htl_line() draws one of them
+static void fred_draw_grid_lines(SCP_vector<vec3d> &points) {
+	if (points.empty())
+		return;
+
+	material mat;
+
+	mat.set_depth_mode(ZBUFFER_TYPE_READ);
+	mat.set_color(gr_screen.current_color);
+	mat.set_cull_mode(false);
+
+	if (gr_screen.current_color.is_alphacolor) {
+		mat.set_blend_mode(ALPHA_BLEND_ALPHA_BLEND_ALPHA);
+	} else {
+		mat.set_blend_mode(ALPHA_BLEND_NONE);
+	}
+
+	vertex_layout vert_def;
+
+	vert_def.add_vertex_component(vertex_format_data::POSITION3, 0, 0);
+
+	gr_render_primitives_immediate(&mat, PRIM_TYPE_LINES, &vert_def, (int) points.size(), points.data(), (int) (points.size() * sizeof(vec3d)));
+}
+
+void fred_render_grid(grid *gridp) {
 	fred_enable_htl();
 	gr_zbuffer_set(0);
 
@@ -820,11 +947,10 @@ void fred_render_grid(grid *gridp) {
 		gr_init_color(&Fred_grid_bright, 128, 128, 128);
 	}
 
-	ncols = gridp->ncols;
-	nrows = gridp->nrows;
-	if (double_fine_gridlines) {
-		ncols *= 2;
-		nrows *= 2;
+	if (!Grid_lines_valid || memcmp(&Grid_lines.center, &gridp->center, sizeof(vec3d)) || memcmp(&Grid_lines.gmatrix, &gridp->gmatrix, sizeof(matrix))
+		|| (Grid_lines.square_size != gridp->square_size) || (Grid_lines.ncols != gridp->ncols) || (Grid_lines.nrows != gridp->nrows)
+		|| (Grid_lines.double_fine != double_fine_gridlines)) {
+		fred_make_grid_lines(gridp);
 	}
 
 	if (Aa_gridlines)
@@ -832,17 +958,7 @@ void fred_render_grid(grid *gridp) {
 	else
 		gr_set_color_fast(&Fred_grid_dark);
 
-	//	Draw the column lines.
-	for (i = 0; i <= ncols; i++) {
-		g3_draw_htl_line(&gridp->gpoints1[i], &gridp->gpoints2[i]);
-	}
-	//	Draw the row lines.
-	for (i = 0; i <= nrows; i++) {
-		g3_draw_htl_line(&gridp->gpoints3[i], &gridp->gpoints4[i]);
-	}
-
-	ncols = gridp->ncols / 2;
-	nrows = gridp->nrows / 2;
+	fred_draw_grid_lines(Grid_lines.dark);
 
 	// now draw the larger, brighter gridlines that is x10 the scale of smaller one.
 	if (Aa_gridlines)
@@ -850,13 +966,7 @@ void fred_render_grid(grid *gridp) {
 	else
 		gr_set_color_fast(&Fred_grid_bright);
 
-	for (i = 0; i <= ncols; i++) {
-		g3_draw_htl_line(&gridp->gpoints5[i], &gridp->gpoints6[i]);
-	}
-
-	for (i = 0; i <= nrows; i++) {
-		g3_draw_htl_line(&gridp->gpoints7[i], &gridp->gpoints8[i]);
-	}
+	fred_draw_grid_lines(Grid_lines.bright);
 
 	fred_disable_htl();
 	gr_zbuffer_set(1);
@@ -1045,6 +1155,70 @@ void game_do_frame() {
 		Last_eye_pos = eye_pos;
 		Last_eye_orient = eye_orient;
 	}
+
+	// redraw screen if anything else which is shown changed, not all the menus and dialogs say so
+	uint checksum = fred_scene_checksum();
+	if (checksum != Last_scene_checksum) {
+		Update_window = 1;
+		Last_scene_checksum = checksum;
+	}
+
+	// the briefing icons and the background bitmaps are animated while they are edited, and once in a while anyway
+	// for what isn't in the checksum, like names and backgrounds
+	if (Briefing_dialog || Bg_bitmap_dialog || (timer_get_milliseconds() - Last_redraw_time > REDRAW_INTERVAL)) {
+		Update_window = 1;
+	}
+}
+
+uint fred_scene_checksum() {
+	struct object_state {
+		int objnum;
+		int type;
+		int instance;
+		int marked;
+		int hidden;
+		int ship_class;
+		int team;
+		vec3d pos;
+		matrix orient;
+	};
+
+	int view_state[] = {
+		Show_grid, Show_grid_positions, Show_coordinates, Show_outlines, Show_stars, Show_distances, Show_horizon,
+		Show_asteroid_field, Show_ship_info, Show_ship_models, Show_compass, Show_waypoints, Show_starts, Show_ships,
+		Show_dock_points, Show_paths_fred, Lighting_on, FullDetail, Aa_gridlines, double_fine_gridlines,
+		Fixed_briefing_size, cur_object_index, Cursor_over, viewpoint, box_marking, marking_box.x1, marking_box.y1,
+		marking_box.x2, marking_box.y2, gr_screen.max_w, gr_screen.max_h, Num_objects
+	};
+
+	uint checksum = cf_add_chksum_long(0, reinterpret_cast<const ubyte*>(view_state), sizeof(view_state));
+	checksum = cf_add_chksum_long(checksum, reinterpret_cast<const ubyte*>(Show_iff), sizeof(bool) * MAX_IFFS);
+
+	object *objp = GET_FIRST(&obj_used_list);
+	while (objp != END_OF_LIST(&obj_used_list)) {
+		object_state state;
+
+		memset(&state, 0, sizeof(state));
+		state.objnum = OBJ_INDEX(objp);
+		state.type = objp->type;
+		state.instance = objp->instance;
+		state.marked = objp->flags[Object::Object_Flags::Marked] ? 1 : 0;
+		state.hidden = objp->flags[Object::Object_Flags::Hidden] ? 1 : 0;
+
+		if ((objp->type == OBJ_SHIP) || (objp->type == OBJ_START)) {
+			state.ship_class = Ships[objp->instance].ship_info_index;
+			state.team = Ships[objp->instance].team;
+		}
+
+		state.pos = objp->pos;
+		state.orient = objp->orient;
+
+		checksum = cf_add_chksum_long(checksum, reinterpret_cast<const ubyte*>(&state), sizeof(state));
+
+		objp = GET_NEXT(objp);
+	}
+
+	return checksum;
 }
 
 vec3d* get_subsystem_world_pos2(object* parent_obj, ship_subsys* subsys, vec3d* world_pos) {
@@ -1589,12 +1763,18 @@ void render_frame() {
 
 	g3_start_frame(0);	 // ** Accounted for
 	g3_set_view_matrix(&eye_pos, &eye_orient, (Briefing_dialog ? Briefing_window_FOV : FRED_DEFAULT_HTL_FOV));
+
+	// the clicks until the next frame pick from what is on the screen now
+	pick_index_build();
+
+	Last_redraw_time = timer_get_milliseconds();
 }
 
 void render_models(void) {
 	gr_set_color_fast(&colour_white);
 
 	render_count = 0;
+	Rendered_waypoints.clear();
 
 	if ((ENVMAP == -1) && strlen(The_mission.envmap_name)) {
 		ENVMAP = bm_load(The_mission.envmap_name);
@@ -1847,14 +2027,16 @@ void render_one_model_htl(object *objp) {
 	}
 
 	if (objp->type == OBJ_WAYPOINT) {
-		for (j = 0; j < render_count; j++) {
-			o2 = &Objects[rendering_order[j]];
-			if (o2->type == OBJ_WAYPOINT) {
-				if ((o2->instance == objp->instance - 1) || (o2->instance == objp->instance + 1)) {
-					g3_draw_htl_line(&o2->pos, &objp->pos);
-				}
+		// the line to a neighbour which isn't drawn yet is drawn with that one
+		for (j = -1; j <= 1; j += 2) {
+			auto neighbour = Rendered_waypoints.find(objp->instance + j);
+			if (neighbour != Rendered_waypoints.end()) {
+				o2 = &Objects[neighbour->second];
+				g3_draw_htl_line(&o2->pos, &objp->pos);
 			}
 		}
+
+		Rendered_waypoints[objp->instance] = OBJ_INDEX(objp);
 	}
 
 	render_model_x_htl(&objp->pos, The_grid);
@@ -2034,12 +2216,140 @@ void render_waypoints(void) {
 	}
 }
 
+// the largest radius the picking tests in object_check_collision() can hit the object in
+static float pick_radius(object *objp) {
+	float radius = (objp->radius > 0.1f) ? objp->radius : LOLLIPOP_SIZE;
+
+	if ((objp->type == OBJ_SHIP) || (objp->type == OBJ_START)) {
+		polymodel *pm = model_get(Ship_info[Ships[objp->instance].ship_info_index].model_num);
+
+		if (pm != NULL)
+			radius = MAX(radius, pm->rad);
+	}
+
+	// the shield mesh may stick out a little
+	return radius * 1.25f;
+}
+
+void pick_index_build() {
+	object *ptr;
+	vertex v, edge;
+	vec3d edge_pos;
+	int x, y, x1, y1, x2, y2;
+	bool projected;
+
+	Pick_entries.clear();
+	Pick_everywhere.clear();
+
+	Pick_screen_w = gr_screen.max_w;
+	Pick_screen_h = gr_screen.max_h;
+	Pick_cols = (Pick_screen_w + PICK_CELL_SIZE - 1) / PICK_CELL_SIZE;
+	Pick_rows = (Pick_screen_h + PICK_CELL_SIZE - 1) / PICK_CELL_SIZE;
+	Pick_num_objects = Num_objects;
+	Pick_eye_pos = eye_pos;
+
+	Pick_cells.resize(Pick_cols * Pick_rows);
+	for (auto &cell : Pick_cells)
+		cell.clear();
+
+	ptr = GET_FIRST(&obj_used_list);
+	while (ptr != END_OF_LIST(&obj_used_list)) {
+		pick_entry entry;
+
+		entry.objnum = OBJ_INDEX(ptr);
+		entry.signature = ptr->signature;
+
+		projected = false;
+		g3_rotate_vertex(&v, &ptr->pos);
+		if (!(v.codes & CC_BEHIND))
+			if (!(g3_project_vertex(&v) & PF_OVERFLOW))
+				projected = true;
+
+		int index = (int) Pick_entries.size();
+		Pick_entries.push_back(entry);
+
+		float radius = pick_radius(ptr);
+		float z = v.world.xyz.z;
+
+		// entirely behind the eye, the rays from it can't hit it and it isn't on the screen
+		if (z < -radius) {
+			ptr = GET_NEXT(ptr);
+			continue;
+		}
+
+		float screen_radius = -1.0f;
+		if (projected && (z > 2.0f * radius)) {
+			vm_vec_scale_add(&edge_pos, &ptr->pos, &eye_orient.vec.rvec, radius);
+			g3_rotate_vertex(&edge, &edge_pos);
+
+			if (!(edge.codes & CC_BEHIND))
+				if (!(g3_project_vertex(&edge) & PF_OVERFLOW)) {
+					// away from the middle of the view a sphere looks bigger than this, the factor covers that
+					screen_radius = fl_abs(edge.screen.xyw.x - v.screen.xyw.x) * z / fl_sqrt(z * z - radius * radius) * 1.5f + 4.0f;
+				}
+		}
+
+		if ((screen_radius < 0.0f) || (screen_radius > (float) MAX(Pick_screen_w, Pick_screen_h))) {
+			Pick_everywhere.push_back(index);
+
+		} else {
+			x1 = MAX((int) floorf((v.screen.xyw.x - screen_radius) / PICK_CELL_SIZE), 0);
+			y1 = MAX((int) floorf((v.screen.xyw.y - screen_radius) / PICK_CELL_SIZE), 0);
+			x2 = MIN((int) floorf((v.screen.xyw.x + screen_radius) / PICK_CELL_SIZE), Pick_cols - 1);
+			y2 = MIN((int) floorf((v.screen.xyw.y + screen_radius) / PICK_CELL_SIZE), Pick_rows - 1);
+
+			for (y = y1; y <= y2; y++)
+				for (x = x1; x <= x2; x++)
+					Pick_cells[y * Pick_cols + x].push_back(index);
+		}
+
+		ptr = GET_NEXT(ptr);
+	}
+
+	Pick_valid = true;
+}
+
+bool pick_objects_in_rect(int x1, int y1, int x2, int y2, SCP_vector<int> *objnums) {
+	int x, y;
+
+	// something changed since the view was drawn, it is drawn again soon
+	if (!Pick_valid || Update_window || (Num_objects != Pick_num_objects) || (gr_screen.max_w != Pick_screen_w) || (gr_screen.max_h != Pick_screen_h))
+		return false;
+
+	x1 = MAX(x1, 0) / PICK_CELL_SIZE;
+	y1 = MAX(y1, 0) / PICK_CELL_SIZE;
+	x2 = MIN(x2, Pick_screen_w - 1) / PICK_CELL_SIZE;
+	y2 = MIN(y2, Pick_screen_h - 1) / PICK_CELL_SIZE;
+
+	SCP_vector<int> found = Pick_everywhere;
+
+	for (y = y1; y <= y2; y++)
+		for (x = x1; x <= x2; x++)
+			found.insert(found.end(), Pick_cells[y * Pick_cols + x].begin(), Pick_cells[y * Pick_cols + x].end());
+
+	// the entries are in the order of obj_used_list, which the callers go by when objects are equally good
+	std::sort(found.begin(), found.end());
+	found.erase(std::unique(found.begin(), found.end()), found.end());
+
+	objnums->clear();
+	for (auto index : found) {
+		const pick_entry &entry = Pick_entries[index];
+
+		if ((Objects[entry.objnum].type != OBJ_NONE) && (Objects[entry.objnum].signature == entry.signature))
+			objnums->push_back(entry.objnum);
+	}
+
+	return true;
+}
+
 int select_object(int cx, int cy) {
 	int		best = -1;
 	double	dist, best_dist = 9e99;
 	vec3d	p0, p1, v, hitpos;
 	vertex	vt;
 	object *ptr;
+	SCP_vector<int> nearby;
+	size_t	i;
 
 	if (Briefing_dialog) {
 		best = Briefing_dialog->check_mouse_hit(cx, cy);
@@ -2065,7 +2375,13 @@ int select_object(int cx, int cy) {
 	p0 = view_pos;
 	vm_vec_scale_add(&p1, &p0, &v, 100.0f);
 
-	ptr = GET_FIRST(&obj_used_list);
+	// only the objects which were drawn around the cursor can be under it, a few pixels around it for the second test.
+	// the rays start at view_pos, which isn't where the index was made from when viewing from an object
+	bool indexed = pick_objects_in_rect(cx - 3, cy - 3, cx + 3, cy + 3, &nearby);
+	bool indexed_rays = indexed && !vm_vec_cmp(&view_pos, &Pick_eye_pos);
+
+	i = 0;
+	ptr = indexed_rays ? (nearby.empty() ? END_OF_LIST(&obj_used_list) : &Objects[nearby[0]]) : GET_FIRST(&obj_used_list);
 	while (ptr != END_OF_LIST(&obj_used_list)) {
 		if (object_check_collision(ptr, &p0, &p1, &hitpos)) {
 			hitpos.xyz.x = ptr->pos.xyz.x - view_pos.xyz.x;
@@ -2078,7 +2394,10 @@ int select_object(int cx, int cy) {
 			}
 		}
 
-		ptr = GET_NEXT(ptr);
+		if (indexed_rays)
+			ptr = (++i < nearby.size()) ? &Objects[nearby[i]] : END_OF_LIST(&obj_used_list);
+		else
+			ptr = GET_NEXT(ptr);
 	}
 
 	if (best >= 0) {
@@ -2087,7 +2406,8 @@ int select_object(int cx, int cy) {
 		}
 		return best;
 	}
-	ptr = GET_FIRST(&obj_used_list);
+	i = 0;
+	ptr = indexed ? (nearby.empty() ? END_OF_LIST(&obj_used_list) : &Objects[nearby[0]]) : GET_FIRST(&obj_used_list);
 	while (ptr != END_OF_LIST(&obj_used_list)) {
 		g3_rotate_vertex(&vt, &ptr->pos);
 		if (!(vt.codes & CC_BEHIND))
@@ -2101,7 +2421,10 @@ int select_object(int cx, int cy) {
 				}
 			}
 
-		ptr = GET_NEXT(ptr);
+		if (indexed)
+			ptr = (++i < nearby.size()) ? &Objects[nearby[i]] : END_OF_LIST(&obj_used_list);
+		else
+			ptr = GET_NEXT(ptr);
 	}
 
 	if (Selection_lock && !(Objects[best].flags[Object::Object_Flags::Marked])) {
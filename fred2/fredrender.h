@@ -87,3 +87,20 @@ void verticalize_controlled();
  * @return -1 if no object found
  */
 int select_object(int cx, int cy);
+
+/**
+ * @brief Finds the objects which were drawn in or around a rectangle on the viewport the last time it was drawn
+ *
+ * @param[in]  x1      Left edge of the rectangle
+ * @param[in]  y1      Top edge of the rectangle
+ * @param[in]  x2      Right edge of the rectangle
+ * @param[in]  y2      Bottom edge of the rectangle
+ * @param[out] objnums Object index numbers of the objects, in the order of obj_used_list
+ *
+ * @details The objects are sorted into the cells of the viewport they cover whenever it is drawn, so picking and box
+ * selection don't have to test all objects. The results are a superset of what is really in the rectangle.
+ *
+ * @return true if objnums has the objects, or
+ * @return false if something changed since the view was drawn and all objects have to be looked at
+ */
+bool pick_objects_in_rect(int x1, int y1, int x2, int y2, SCP_vector<int> *objnums);
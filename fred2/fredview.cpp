@@ -1247,6 +1247,8 @@ void select_objects()
 	int	x, y, valid, icon_mode = 0;		
 	vertex	v;
 	object	*ptr;
+	SCP_vector<int> inside;
+	size_t	i = 0;
 
 	if (marking_box.x1 > marking_box.x2) {
 		x = marking_box.x1;
@@ -1260,7 +1262,11 @@ void select_objects()
 		marking_box.y2 = y;
 	}
 
-	ptr = GET_FIRST(&obj_used_list);
+	// the objects drawn around the box, unless it reaches out of the window where the index doesn't look
+	bool indexed = (marking_box.x1 >= 0) && (marking_box.y1 >= 0) && (marking_box.x2 < gr_screen.max_w) && (marking_box.y2 < gr_screen.max_h)
+		&& pick_objects_in_rect(marking_box.x1, marking_box.y1, marking_box.x2, marking_box.y2, &inside);
+
+	ptr = indexed ? (inside.empty() ? END_OF_LIST(&obj_used_list) : &Objects[inside[0]]) : GET_FIRST(&obj_used_list);
 	while (ptr != END_OF_LIST(&obj_used_list)) {
 		valid = 1;
 		if (ptr->flags[Object::Object_Flags::Hidden])
@@ -1305,7 +1311,10 @@ void select_objects()
 				}
 			}
 		
-		ptr = GET_NEXT(ptr);
+		if (indexed)
+			ptr = (++i < inside.size()) ? &Objects[inside[i]] : END_OF_LIST(&obj_used_list);
+		else
+			ptr = GET_NEXT(ptr);
 	}
 
 	if (icon_mode) {
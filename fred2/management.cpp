@@ -2307,11 +2307,12 @@ void object_moved(object *objp)
 		wpt->set_pos(&objp->pos);
 	}
 
-	if ((objp->type == OBJ_SHIP) || (objp->type == OBJ_START)) // do we have a ship?
+	// do we have a docked ship?
+	if (((objp->type == OBJ_SHIP) || (objp->type == OBJ_START)) && object_is_docked(objp))
 	{
-		// reset the already-handled flag (inefficient, but it's FRED, so who cares)
-        for (int i = 0; i < MAX_OBJECTS; i++)
-            Objects[i].flags.remove(Object::Object_Flags::Docked_already_handled);
+		// reset the already-handled flag, only the objects in use can be docked
+		for (object *ptr = GET_FIRST(&obj_used_list); ptr != END_OF_LIST(&obj_used_list); ptr = GET_NEXT(ptr))
+			ptr->flags.remove(Object::Object_Flags::Docked_already_handled);
 
 		// move all docked objects docked to me
 		dock_move_docked_objects(objp);
@@ -3,6 +3,8 @@
 
 #include "SDLGraphicsOperations.h"
 
+#include "cmdline/cmdline.h"
+
 namespace {
 void setOGLProperties(const os::ViewPortProperties& props) {
 	SDL_GL_ResetAttributes();
@@ -137,6 +139,19 @@ SDLGraphicsOperations::SDLGraphicsOperations() {
 #ifdef SCP_UNIX
 	// Slight hack to make Mesa advertise S3TC support without libtxc_dxtn
 	setenv("force_s3tc_enable", "true", 1);
+
+	if (Cmdline_threaded_gl) {
+		// The drivers which can record the GL calls of the game thread and submit them on a thread of their own are told
+		// so through the environment before the GL library is loaded. Readbacks like screenshots synchronize with that
+		// thread by themselves. A value the user set explicitly is kept.
+		setenv("mesa_glthread", "true", 0);
+		setenv("__GL_THREADED_OPTIMIZATIONS", "1", 0);
+		mprintf(("  Requesting threaded OpenGL submission from the driver\n"));
+
+		if (Cmdline_gl_finish) {
+			mprintf(("  -gl_finish waits for the driver thread every frame and undoes most of -threaded_gl!\n"));
+		}
+	}
 #endif
 
 	if (SDL_InitSubSystem(SDL_INIT_VIDEO) < 0) {
@@ -20,6 +20,7 @@
 #endif // !_MINGW
 #else
  #include <unistd.h>
+ #include <signal.h>
  #include <sys/stat.h>
 #endif
 
@@ -27,6 +28,7 @@
 #include "asteroid/asteroid.h"
 #include "autopilot/autopilot.h"
 #include "bmpman/bmpman.h"
+#include "camera/flythrough.h"
 #include "cfile/cfile.h"
 #include "cmdline/cmdline.h"
 #include "cmeasure/cmeasure.h"
@@ -47,8 +49,10 @@
 #include "gamesnd/eventmusic.h"
 #include "gamesnd/gamesnd.h"
 #include "globalincs/alphacolors.h"
+#include "globalincs/jobs.h"
 #include "globalincs/mspdb_callstack.h"
 #include "globalincs/version.h"
+#include "graphics/decals.h"
 #include "graphics/font.h"
 #include "graphics/shadows.h"
 #include "headtracking/headtracking.h"
@@ -67,6 +71,7 @@
 #include "io/key.h"
 #include "io/mouse.h"
 #include "io/cursor.h"
+#include "io/framepacer.h"
 #include "io/timer.h"
 #include "jumpnode/jumpnode.h"
 #include "libs/ffmpeg/FFmpeg.h"
@@ -111,9 +116,11 @@
 #include "network/multi_endgame.h"
 #include "network/multi_ingame.h"
 #include "network/multi_log.h"
+#include "network/multi_options.h"
 #include "network/multi_pause.h"
 #include "network/multi_pxo.h"
 #include "network/multi_rate.h"
+#include "network/multi_profile.h"
 #include "network/multi_respawn.h"
 #include "network/multi_voice.h"
 #include "network/multimsgs.h"
@@ -123,6 +130,7 @@
 #include "network/stand_gui.h"
 #include "object/objcollide.h"
 #include "object/objectsnd.h"
+#include "object/objocclusion.h"
 #include "object/waypoint.h"
 #include "observer/observer.h"
 #include "osapi/osapi.h"
@@ -130,6 +138,7 @@
 #include "parse/encrypt.h"
 #include "parse/generic_log.h"
 #include "parse/parselo.h"
+#include "scripting/script_gc.h"
 #include "scripting/scripting.h"
 #include "parse/sexp.h"
 #include "particle/particle.h"
@@ -137,6 +146,7 @@
 #include "pilotfile/pilotfile.h"
 #include "playerman/managepilot.h"
 #include "playerman/player.h"
+#include "playerman/replay.h"
 #include "popup/popup.h"
 #include "popup/popupdead.h"
 #include "radar/radar.h"
@@ -159,6 +169,8 @@
 #include "stats/medals.h"
 #include "stats/stats.h"
 #include "tracing/tracing.h"
+#include "tracing/FrameBudget.h"
+#include "tracing/StartupProfiler.h"
 #include "weapon/beam.h"
 #include "weapon/emp.h"
 #include "weapon/flak.h"
@@ -471,6 +483,7 @@ void game_shutdown(void);
 void game_show_event_debug(float frametime);
 void game_event_debug_init();
 void game_frame(bool paused = false);
+void game_fixed_simulation_reset();
 void game_start_subspace_ambient_sound();
 void game_stop_subspace_ambient_sound();
 void verify_ships_tbl();
@@ -874,6 +887,8 @@ void game_flash_diminish(float frametime)
 
 void game_level_close()
 {
+	replay_mission_end();
+
 	//WMC - this is actually pretty damn dangerous, but I don't want a modder
 	//to accidentally use an override here without realizing it.
 	if(!Script_system.IsConditionOverride(CHA_MISSIONEND))
@@ -887,12 +902,13 @@ void game_level_close()
 		game_stop_looped_sounds();
 		snd_stop_all();
 		obj_snd_level_close();					// uninit object-linked persistant sounds
-		gamesnd_unload_gameplay_sounds();	// unload gameplay sounds from memory
+		obj_occlusion_level_close();
 		anim_level_close();						// stop and clean up any anim instances
 		message_mission_shutdown();			// called after anim_level_close() to make sure instances are clear
 		shockwave_level_close();
 		fireball_close();	
 		shield_hit_close();
+		decals_level_close();
 		mission_event_shutdown();
 		asteroid_level_close();
 		jumpnode_level_close();
@@ -976,11 +992,14 @@ void game_level_init()
 	Multi_ping_timestamp = -1;
 
 	obj_init();						// Must be inited before the other systems
+	game_fixed_simulation_reset();
 
 	if ( !(Game_mode & GM_STANDALONE_SERVER) ) {
 		model_page_in_start();		// mark any existing models as unused but don't unload them yet
 		mprintf(( "Beginning level bitmap paging...\n" ));
 		bm_page_in_start();
+		gamesnd_page_in_start();	// gameplay sounds stay loaded until the level is paged in
+		gr_shader_precompile_begin();	// the shaders of the loaded models are compiled in the background
 	} else {
 		model_free_all();			// Free all existing models if standalone server
 	}
@@ -1004,6 +1023,7 @@ void game_level_init()
 	mission_log_init();
 	messages_init();
 	obj_snd_level_init();					// init object-linked persistant sounds
+	obj_occlusion_level_init();
 	anim_level_init();
 	shockwave_level_init();
 	afterburner_level_init();
@@ -1299,6 +1319,8 @@ void freespace_mission_load_stuff()
 		// Load in all the bitmaps for this level
 		level_page_in();
 
+		gr_shader_precompile_end();
+
 		game_busy( NOX("** finished with level_page_in() **") );
 
 		if(Game_loading_callback_inited) {
@@ -1385,6 +1407,8 @@ int game_start_mission()
 	if ( !(Game_mode & GM_STANDALONE_SERVER) )
 		game_loading_callback_init();
 
+	scripting::gc::begin_loading();
+
 	game_level_init();
 	
 	if (Game_mode & GM_MULTIPLAYER) {
@@ -1406,10 +1430,13 @@ int game_start_mission()
 
 		if ( !(Game_mode & GM_STANDALONE_SERVER) ) {
 			game_loading_callback_close();
+			gr_shader_precompile_end();
 		}
 
 		game_level_close();
 
+		scripting::gc::end_loading();
+
 		return 0;
 	}
 	load_mission_load = (uint) (time(NULL) - load_mission_load);
@@ -1423,6 +1450,8 @@ int game_start_mission()
 	game_post_level_init();
 	load_post_level_init = (uint) (time(NULL) - load_post_level_init);
 
+	scripting::gc::end_loading();
+
 #ifndef NDEBUG
 	{
 		void Do_model_timings_test();
@@ -1443,6 +1472,39 @@ int Interface_framerate = 0;
 
 DCF_BOOL( mouse_control, Use_mouse_to_fly )
 DCF_BOOL( show_framerate, Show_framerate )
+
+// The frame time the frame budget graph marks, see -frame_budget_graph
+float Frame_budget_ms = 1000.0f / 60.0f;
+bool Frame_budget_graph_visible = true;
+
+DCF(frame_budget, "Shows or hides the frame budget graph, or sets its budget (see -frame_budget_graph)")
+{
+	if (dc_optional_string_either("help", "--help")) {
+		dc_printf("Usage: frame_budget [ms]\n");
+		dc_printf("\tWithout an argument the graph is shown or hidden, otherwise the line of the budget is moved to\n");
+		dc_printf("\tthis many milliseconds. The default is %.1f ms, a frame at 60 FPS.\n", 1000.0f / 60.0f);
+		return;
+	}
+
+	if (dc_optional_string_either("status", "--status") || dc_optional_string_either("?", "--?")) {
+		dc_printf("The frame budget graph is %s, the budget is %.1f ms\n", Frame_budget_graph_visible ? "shown" : "hidden",
+			Frame_budget_ms);
+		return;
+	}
+
+	if (!tracing::frame_budget_enabled()) {
+		dc_printf("The frame budget graph is off, start the game with -frame_budget_graph\n");
+		return;
+	}
+
+	float budget;
+	if (dc_maybe_stuff_float(&budget)) {
+		Frame_budget_ms = std::max(budget, 1.0f);
+		Frame_budget_graph_visible = true;
+	} else {
+		Frame_budget_graph_visible = !Frame_budget_graph_visible;
+	}
+}
 DCF_BOOL( show_target_debug_info, Show_target_debug_info )
 DCF_BOOL( show_target_weapons, Show_target_weapons )
 DCF_BOOL( lead_target_cheat, Players[Player_num].lead_target_cheat )
@@ -1647,6 +1709,62 @@ DCF(gamma,"Sets and saves Gamma Factor")
 #	include "SDL_syswm.h" // For SDL_SysWMinfo
 #endif
 
+/**
+ * Starts the other games of a standalone server which hosts several of them, see -standalone_sessions
+ *
+ * Everything which was parsed and loaded so far is shared: every other game is a copy of this process which keeps the
+ * memory pages of the tables until it changes them, while the missions and everything else of a running game are its
+ * own. Each game listens on its own game and web api port, the operating system spreads them over the cores.
+ */
+static void game_start_standalone_sessions()
+{
+	if (!Is_standalone || (Cmdline_standalone_sessions <= 1)) {
+		return;
+	}
+
+#ifdef SCP_UNIX
+	// the worker threads don't survive a fork, they are started again when they are needed
+	jobs::shutdown();
+
+	// nobody waits for the other games, so don't let them linger once they exit
+	signal(SIGCHLD, SIG_IGN);
+
+	for (int session = 1; session < Cmdline_standalone_sessions; ++session) {
+		pid_t pid = fork();
+
+		if (pid < 0) {
+			mprintf(("Could not start standalone session %d: %s\n", session, strerror(errno)));
+			break;
+		}
+
+		if (pid == 0) {
+			// the reliable socket uses the port after the game port
+			Multi_options_g.port = (ushort)(Multi_options_g.port + 2 * session);
+			Multi_options_g.webapiPort = (ushort)(Multi_options_g.webapiPort + session);
+
+			mprintf(("Standalone session %d is using port %d and web api port %d\n", session, Multi_options_g.port, Multi_options_g.webapiPort));
+			return;
+		}
+	}
+
+	mprintf(("Started %d standalone sessions\n", Cmdline_standalone_sessions));
+#else
+	mprintf(("Hosting several standalone sessions from one install is only supported on Unix, ignoring -standalone_sessions\n"));
+#endif
+}
+
+// Parses a table on the job workers, parse_func may only fill the data of its own table
+static void game_parse_table_job(jobs::job_group& group, void (*parse_func)())
+{
+	group.run([parse_func]() {
+		parse_func();
+		tracing::startup::table_end();
+
+		// the parse buffers belong to the thread which did the parsing
+		stop_parse();
+	}, tracing::ParseTableJob);
+}
+
 /**
  * Game initialisation
  */
@@ -1675,6 +1793,12 @@ void game_init()
 
 	// Initialize the timer before the os
 	timer_init();
+
+	// the summary is written at the end of this function
+	tracing::startup::begin();
+
+	// before any threads are started so they all see it
+	memory::tracking::init();
 	
 #ifndef NDEBUG
 	outwnd_init();
@@ -1695,6 +1819,11 @@ void game_init()
 	cmdline_debug_print_cmdline();
 #endif
 
+	// a replay which is played back sets the mission so this has to happen before the main hall starts it
+	if (!replay_init()) {
+		Error(LOCATION, "Failed to open the replay %s!", Cmdline_record_replay != nullptr ? Cmdline_record_replay : Cmdline_play_replay);
+	}
+
 	memset(whee, 0, sizeof(whee));
 
 	_getcwd(whee, MAX_PATH_LEN-1);
@@ -1888,6 +2017,14 @@ void game_init()
 	//This may seem scary, but it should take up 0 processing time and very little memory
 	//as long as it's not being used.
 	//Otherwise, it just keeps the parsed interface.tbl in memory.
+	// These tables don't depend on any other table and nothing else needs them until the objects are set up so they
+	// are parsed on the job workers while the main thread goes on with the tables which load bitmaps, sounds or fonts
+	jobs::job_group independent_tables;
+	game_parse_table_job(independent_tables, parse_rank_tbl);
+	game_parse_table_job(independent_tables, parse_medal_tbl);
+	game_parse_table_job(independent_tables, armor_init);
+	game_parse_table_job(independent_tables, ai_profiles_init);		// Goober5000
+
 	GUI_system.ParseClassInfo("interface.tbl");
 	
 	particle::ParticleManager::init();
@@ -1901,9 +2038,6 @@ void game_init()
 
 	control_config_common_init();				// sets up localization stuff in the control config
 
-	parse_rank_tbl();
-	parse_medal_tbl();
-
 	cutscene_init();
 	key_init();
 	mouse_init();
@@ -1931,11 +2065,12 @@ void game_init()
 	// CommanderDJ: try with colors.tbl first, then use the old way if that doesn't work
 	alpha_colors_init();
 
+	// ranks, medals, armor and the AI profiles
+	independent_tables.wait();
+
 	obj_init();	
 	mflash_game_init();	
-	armor_init();
 	ai_init();
-	ai_profiles_init();		// Goober5000
 	weapon_init();
 	glowpoint_init();
 	ship_init();						// read in ships.tbl	
@@ -1947,8 +2082,12 @@ void game_init()
 	techroom_intel_init();			// parse species.tbl, load intel info  
 	hud_positions_init();		//Setup hud positions
 	
+	// every standalone game needs its own network ports
+	game_start_standalone_sessions();
+
 	// initialize psnet
 	psnet_init( Multi_options_g.protocol, Multi_options_g.port );						// initialize the networking code		
+	multi_profile_init();
 
 	asteroid_init();
 	mission_brief_common_init();	// Mark all the briefing structures as empty.
@@ -1964,7 +2103,7 @@ void game_init()
 	pilot_load_pic_list();	
 	pilot_load_squad_pic_list();
 
-	if (!Is_standalone) {
+	if (!Is_standalone && (Cmdline_benchmark_simulation <= 0)) {
 		// Load the default cursor and enable it
 		io::mouse::Cursor* cursor = io::mouse::CursorManager::get()->loadCursor("cursor", true);
 		if (cursor) {
@@ -1994,6 +2133,8 @@ void game_init()
 
 	mprintf(("cfile_init() took %d\n", e1 - s1));
 
+	tracing::startup::report();
+
 	// if we are done initializing, start showing the cursor
 	io::mouse::CursorManager::get()->showCursor(true);
 
@@ -2045,6 +2186,122 @@ void game_get_framerate()
 	Framecount++;
 }
 
+// The colors of the stages in the frame budget graph, the time which no stage accounts for is gray
+static const int Frame_budget_colors[][3] = {
+	{ 80, 160, 255 }, { 80, 220, 80 }, { 255, 200, 40 }, { 220, 80, 220 }, { 255, 100, 60 }, { 60, 220, 220 },
+};
+
+static void game_set_frame_budget_color(const tracing::frame_budget_history& history, size_t stage)
+{
+	if (stage == history.stages.size() - 1) {
+		gr_set_color(128, 128, 128);
+	} else {
+		auto& rgb = Frame_budget_colors[stage % (sizeof(Frame_budget_colors) / sizeof(Frame_budget_colors[0]))];
+		gr_set_color(rgb[0], rgb[1], rgb[2]);
+	}
+}
+
+/**
+ * Draws the time of the stages of the last frames as stacked bars, one pixel per frame, with a line at the budget
+ *
+ * @return The height of the graph and its title
+ */
+static int game_draw_frame_budget_graph(int x, int y, const char* title, const tracing::frame_budget_history& history)
+{
+	const int graph_height = 120;
+	const int graph_width = static_cast<int>(tracing::FRAME_BUDGET_HISTORY);
+
+	int line_height = gr_get_font_height() + 1;
+	auto stages = history.stages.size();
+	auto frames = history.frames();
+
+	// The graph goes up to twice the budget so the stages of a frame which is over it can still be told apart
+	auto px_per_ms = graph_height / (2.0f * Frame_budget_ms);
+
+	gr_set_color_fast(&HUD_color_debug);
+	gr_string(x, y, title, GR_RESIZE_NONE);
+
+	auto bottom = y + line_height + graph_height;
+
+	// The newest frame is on the right
+	auto left = x + graph_width - static_cast<int>(frames);
+	for (size_t frame = 0; frame < frames; ++frame) {
+		auto times = &history.times[frame * stages];
+		auto stacked = 0.0f;
+
+		for (size_t stage = 0; stage < stages; ++stage) {
+			auto low = bottom - std::min(static_cast<int>(stacked * px_per_ms), graph_height);
+			stacked += times[stage];
+			auto high = bottom - std::min(static_cast<int>(stacked * px_per_ms), graph_height);
+
+			if (low > high) {
+				game_set_frame_budget_color(history, stage);
+				gr_rect(left + static_cast<int>(frame), high, 1, low - high, GR_RESIZE_NONE);
+			}
+		}
+	}
+
+	auto budget_y = bottom - graph_height / 2;
+	gr_set_color(255, 255, 255);
+	gr_line(x, budget_y, x + graph_width, budget_y, GR_RESIZE_NONE);
+	gr_set_color(128, 128, 128);
+	gr_line(x, bottom, x + graph_width, bottom, GR_RESIZE_NONE);
+	gr_line(x, bottom - graph_height, x + graph_width, bottom - graph_height, GR_RESIZE_NONE);
+
+	// The legend lists the last, average and worst time of every stage next to the graph
+	auto legend_x = x + graph_width + 10;
+	auto legend_y = y + line_height;
+
+	gr_set_color_fast(&HUD_color_debug);
+	gr_printf_no_resize(legend_x, y, "Budget %.1f ms      last   avg   max", Frame_budget_ms);
+
+	for (size_t stage = 0; stage < stages; ++stage) {
+		auto last = 0.0f;
+		auto total = 0.0f;
+		auto worst = 0.0f;
+
+		for (size_t frame = 0; frame < frames; ++frame) {
+			auto time = history.times[frame * stages + stage];
+
+			total += time;
+			worst = std::max(worst, time);
+			last = time;
+		}
+
+		game_set_frame_budget_color(history, stage);
+		gr_rect(legend_x, legend_y + 2, line_height - 4, line_height - 4, GR_RESIZE_NONE);
+
+		gr_set_color_fast(&HUD_color_debug);
+		gr_printf_no_resize(legend_x + line_height, legend_y, "%-16s %5.1f %5.1f %5.1f", history.stages[stage], last,
+			frames > 0 ? total / frames : 0.0f, worst);
+
+		legend_y += line_height;
+	}
+
+	return std::max(line_height + graph_height, legend_y - y);
+}
+
+/**
+ * Draws the frame budget graphs of the CPU and the GPU in the lower left corner, see -frame_budget_graph
+ */
+static void game_show_frame_budget()
+{
+	if (!tracing::frame_budget_enabled() || !Frame_budget_graph_visible) {
+		return;
+	}
+
+	tracing::frame_budget_history cpu;
+	tracing::frame_budget_history gpu;
+	tracing::get_frame_budget(cpu, gpu);
+
+	int line_height = gr_get_font_height() + 1;
+	auto x = gr_screen.center_offset_x + 20;
+	auto y = gr_screen.center_offset_y + gr_screen.center_h - 2 * (120 + 2 * line_height) - 40;
+
+	y += game_draw_frame_budget_graph(x, y, "CPU (ms)", cpu) + line_height;
+	game_draw_frame_budget_graph(x, y, "GPU (ms)", gpu);
+}
+
 /**
  * Show FPS within game
  */
@@ -2101,6 +2358,8 @@ void game_show_framerate()
 		}
 	}
 
+	game_show_frame_budget();
+
 #ifndef NDEBUG
 	if ( Debug_dump_frames )
 		return;
@@ -3360,6 +3619,9 @@ void game_render_frame( camid cid )
 	GR_DEBUG_SCOPE("Main Frame");
 	TRACE_SCOPE(tracing::RenderMainFrame);
 
+	// before g3_start_frame() so the 3D code sees the size the scene is drawn with
+	gr_scene_resolution_begin();
+
 	g3_start_frame(game_zbuffer);
 
 	camera *cam = cid.getCamera();
@@ -3405,6 +3667,9 @@ void game_render_frame( camid cid )
 	if ( Cmdline_env ) {
 		stars_setup_environment_mapping(cid);
 	}
+	if ( Cmdline_cached_background ) {
+		stars_setup_background_cubemap(cid);
+	}
 	gr_zbuffer_clear(TRUE);
 
 	gr_scene_texture_begin();
@@ -3422,6 +3687,10 @@ void game_render_frame( camid cid )
 		stars_draw(1,1,1,0,0);
 	}
 
+	// the objects are culled against the main view and the shadow cascades at once
+	shadows_prepare_frame(Proj_fov, &Eye_matrix, &Eye_position);
+	obj_build_view_masks();
+
 	shadows_render_all(Proj_fov, &Eye_matrix, &Eye_position);
 	obj_render_queue_all();
 
@@ -3447,7 +3716,16 @@ void game_render_frame( camid cid )
 
 	batching_render_all(false);
 
-	gr_copy_effect_texture();
+	// the effect texture is only read by the ships with shader effects and by the distortions, the distortions only
+	// need the part of the scene they cover
+	int dist_x1, dist_y1, dist_x2, dist_y2;
+	bool distortions = batching_get_distortion_bounds(&dist_x1, &dist_y1, &dist_x2, &dist_y2);
+
+	if ( !effect_ships.empty() ) {
+		gr_copy_effect_texture(0, 0, gr_screen.max_w, gr_screen.max_h);
+	} else if ( distortions ) {
+		gr_copy_effect_texture(dist_x1, dist_y1, dist_x2, dist_y2);
+	}
 
 	// render all ships with shader effects on them
 	SCP_vector<object*>::iterator obji = effect_ships.begin();
@@ -3458,7 +3736,9 @@ void game_render_frame( camid cid )
 	effect_ships.clear();
 
 	// render distortions after the effect framebuffer is copied.
-	batching_render_all(true);
+	if ( distortions ) {
+		batching_render_all(true);
+	}
 
 	Shadow_override = true;
 	//Draw the viewer 'cause we didn't before.
@@ -3506,6 +3786,7 @@ void game_render_frame( camid cid )
 	//================ END OF 3D RENDERING STUFF ====================
 
 	gr_scene_texture_end();
+	gr_scene_resolution_end();
 
 	extern int Multi_display_netinfo;
 	if(Multi_display_netinfo){
@@ -3580,6 +3861,89 @@ void game_flip_page_and_time_it()
 	sprintf( transfer_text, NOX("%d MB/s"), (int)fixmuldiv(t,65,d) );
 }
 
+// the simulation benchmark, see -benchmark_simulation
+#define BENCHMARK_FRAMETIME		(F1_0/60)		// the simulated time of every frame
+
+static int Benchmark_frames = 0;
+static std::uint64_t Benchmark_start_time = 0;
+
+// counts the frames of the simulation benchmark, called before every simulation frame
+static void game_benchmark_simulation_frame()
+{
+	if (Cmdline_benchmark_simulation <= 0) {
+		return;
+	}
+
+	if (Benchmark_frames == 0) {
+		tracing::simulation_benchmark_start();
+		Benchmark_start_time = timer_get_nanoseconds();
+	} else if ((Benchmark_frames == Cmdline_benchmark_simulation) || replay_finished()) {
+		tracing::simulation_benchmark_write(Game_current_mission_filename, Benchmark_frames, f2fl(BENCHMARK_FRAMETIME), Cmdline_benchmark_seed, timer_get_nanoseconds() - Benchmark_start_time);
+		gameseq_post_event(GS_EVENT_QUIT_GAME);
+	}
+
+	Benchmark_frames++;
+}
+
+static bool Replay_end_posted = false;
+
+// ends the mission once a replay was played back, the benchmarks end it themselves
+static void game_replay_frame()
+{
+	if (!replay_finished() || Replay_end_posted) {
+		return;
+	}
+
+	if ((Cmdline_benchmark_simulation > 0) || (Cmdline_benchmark_flythrough > 0.0f)) {
+		return;
+	}
+
+	Replay_end_posted = true;
+	gameseq_post_event(GS_EVENT_END_GAME);
+}
+
+// the flythrough benchmark, see -benchmark_flythrough
+#define FLYTHROUGH_NOT_STARTED		0
+#define FLYTHROUGH_FLYING			1
+#define FLYTHROUGH_DONE				2
+
+static int Flythrough_state = FLYTHROUGH_NOT_STARTED;
+
+// moves the camera of the flythrough benchmark, called before every simulation frame
+static void game_benchmark_flythrough_frame()
+{
+	if (Cmdline_benchmark_flythrough <= 0.0f) {
+		return;
+	}
+
+	switch (Flythrough_state) {
+	case FLYTHROUGH_NOT_STARTED:
+		if (!flythrough_start(Cmdline_benchmark_flythrough)) {
+			Flythrough_state = FLYTHROUGH_DONE;
+			gameseq_post_event(GS_EVENT_END_GAME);
+			break;
+		}
+
+		// only the frames of the flythrough go into the summary of the frame times
+		tracing::counter::value(tracing::FrameTimeSummary, 1.0f);
+		Flythrough_state = FLYTHROUGH_FLYING;
+		break;
+
+	case FLYTHROUGH_FLYING:
+		if (flythrough_do_frame(flRealframetime)) {
+			tracing::counter::value(tracing::FrameTimeSummary, 0.0f);
+			flythrough_stop();
+
+			Flythrough_state = FLYTHROUGH_DONE;
+			gameseq_post_event(GS_EVENT_END_GAME);
+		}
+		break;
+
+	default:
+		break;
+	}
+}
+
 void game_simulation_frame()
 {
 	TRACE_SCOPE(tracing::Simulation);
@@ -3767,6 +4131,65 @@ void game_simulation_frame()
 	Script_system.RunCondition(CHA_SIMULATION);
 }
 
+// the fixed simulation steps, see -fixed_simulation
+#define FIXED_SIMULATION_MAX_STEPS		8		// the most steps of a frame, the game slows down if it needs more
+
+static float Fixed_simulation_time = 0.0f;		// the time which still has to be simulated
+static bool Fixed_simulation_stepped = false;	// if a step ran yet, there is nothing to interpolate before that
+
+static bool game_fixed_simulation_active()
+{
+	// multiplayer has to simulate the same frames as the server and the benchmark has to be the same on every machine
+	return (Cmdline_fixed_simulation > 0) && !(Game_mode & GM_MULTIPLAYER) && (Cmdline_benchmark_simulation <= 0);
+}
+
+void game_fixed_simulation_reset()
+{
+	Fixed_simulation_time = 0.0f;
+	Fixed_simulation_stepped = false;
+}
+
+// runs as many steps as the frame time has room for, with the resets game_frame() does once per frame
+static void game_fixed_simulation_frame()
+{
+	float step = 1.0f / Cmdline_fixed_simulation;
+	fix render_frametime = Frametime;
+	int steps = 0;
+
+	Fixed_simulation_time += flFrametime;
+
+	while (Fixed_simulation_time >= step && steps < FIXED_SIMULATION_MAX_STEPS) {
+		Fixed_simulation_time -= step;
+		steps++;
+
+		radar_frame_init();
+		shield_frame_init();
+		game_whack_reset();
+		light_reset();
+
+		obj_save_sim_transforms();
+
+		Frametime = fl2f(step);
+		flFrametime = step;
+
+		game_simulation_frame();
+	}
+
+	if (Fixed_simulation_time >= step) {
+		Fixed_simulation_time = 0.0f;
+	}
+
+	Frametime = render_frametime;
+	flFrametime = f2fl(render_frametime);
+
+	if (steps > 0) {
+		Fixed_simulation_stepped = true;
+
+		// the lights of the objects have to stay for the frames which don't simulate
+		light_save_frame();
+	}
+}
+
 // Maybe render and process the dead-popup
 void game_maybe_do_dead_popup(float frametime)
 {
@@ -4059,12 +4482,17 @@ void game_frame(bool paused)
 			; //nprintf(("AI", "Framecount = %i, time = %7.3f\n", Framecount, f2fl(Missiontime)));
 		}
 
+		bool fixed_simulation = game_fixed_simulation_active();
+
 		//	Note: These are done even before the player enters, else buffers can overflow.
-		if (! (Game_mode & GM_STANDALONE_SERVER)){
-			radar_frame_init();
-		}
+		// The fixed simulation does them for every step instead.
+		if (!fixed_simulation) {
+			if (! (Game_mode & GM_STANDALONE_SERVER)){
+				radar_frame_init();
+			}
 
-		shield_frame_init();
+			shield_frame_init();
+		}
 
 		if ( !Pre_player_entry && actually_playing ) {
 			if (! (Game_mode & GM_STANDALONE_SERVER) ) {
@@ -4081,18 +4509,28 @@ void game_frame(bool paused)
 			}
 		}
 	
-		// Reset the whack stuff
-		game_whack_reset();
-	
-		// These two lines must be outside of Pre_player_entry code,
-		// otherwise too many lights are added.
-		light_reset();
+		if (!fixed_simulation) {
+			// Reset the whack stuff
+			game_whack_reset();
+
+			// These two lines must be outside of Pre_player_entry code,
+			// otherwise too many lights are added.
+			light_reset();
+		}
 	
 		if ((Game_mode & GM_MULTIPLAYER) && (Netgame.game_state == NETGAME_STATE_SERVER_TRANSFER)){
 			return;
 		}
 		
-		game_simulation_frame();
+		game_benchmark_simulation_frame();
+		game_benchmark_flythrough_frame();
+		game_replay_frame();
+
+		if (fixed_simulation) {
+			game_fixed_simulation_frame();
+		} else {
+			game_simulation_frame();
+		}
 		
 		// if not actually in a game play state, then return.  This condition could only be true in 
 		// a multiplayer game.
@@ -4114,6 +4552,13 @@ void game_frame(bool paused)
 
 			DEBUG_GET_TIME( clear_time2 )
 			DEBUG_GET_TIME( render3_time1 )
+
+			// draw the objects between the last two simulation steps
+			bool interpolated = !paused && Fixed_simulation_stepped && game_fixed_simulation_active();
+			if (interpolated) {
+				light_restore_frame();
+				obj_interpolate_sim_transforms(Fixed_simulation_time * Cmdline_fixed_simulation);
+			}
 			
 			camid cid = game_render_frame_setup();
 
@@ -4169,6 +4614,10 @@ void game_frame(bool paused)
 				}
 			}
 
+			if (interpolated) {
+				obj_restore_sim_transforms();
+			}
+
 			// Goober5000 - check if we should red-alert
 			// (this is approximately where the red_alert_check_status() function tree began in the pre-HUD-overhaul code)
 			red_alert_maybe_move_to_next_mission();
@@ -4211,6 +4660,9 @@ void game_frame(bool paused)
 	// process lightning (nebula only)
 	nebl_process();
 
+	// all jobs of this frame have to be done before the next one starts
+	jobs::end_frame();
+
 	if (Cmdline_frame_profile) {
 		tracing::frame_profile_process_frame();
 	}
@@ -4342,11 +4794,29 @@ void set_time_compression(float multiplier, float change_time)
 	Time_compression_change_rate = fl2f( f2fl(Desired_time_compression - Game_time_compression) / change_time );
 }
 
+// the time of a frame at the framerate cap, 0 if the frames are not capped
+static std::uint64_t game_frame_cap_ns()
+{
+	if (Cmdline_NoFPSCap || (Cmdline_benchmark_simulation > 0) || (Framerate_cap <= 0)) {
+		return 0;
+	}
+
+	return 1000000000ull / Framerate_cap;
+}
+
 void game_set_frametime(int state)
 {
 	fix thistime;
 	float frame_cap_diff;
 
+	Assertion( Framerate_cap > 0, "Framerate cap %d is too low. Needs to be a positive, non-zero number", Framerate_cap );
+
+	// Cap the framerate so it doesn't get too high.
+	// With -low_latency_fps_cap the main loop waited already, before the input was read.
+	if (!Cmdline_low_latency_fps_cap) {
+		frame_pacer_wait(game_frame_cap_ns());
+	}
+
 	thistime = timer_get_fixed_seconds();
 
 	if ( Last_time == 0 )	
@@ -4360,8 +4830,11 @@ void game_set_frametime(int state)
 	fix	debug_frametime = Frametime;	//	Just used to display frametime.
 #endif
 
+	// the simulation benchmark runs at a fixed timestep so every run simulates the same frames
+	if (Cmdline_benchmark_simulation > 0)
+		Frametime = BENCHMARK_FRAMETIME;
 	//	If player hasn't entered mission yet, make frame take 1/4 second.
-	if ((Pre_player_entry) && (state == GS_STATE_GAME_PLAY))
+	else if ((Pre_player_entry) && (state == GS_STATE_GAME_PLAY))
 		Frametime = F1_0/4;
 #ifndef NDEBUG
 	else if ((Debug_dump_frames) && (state == GS_STATE_GAME_PLAY)) {				// note link to above if!!!!!
@@ -4380,23 +4853,6 @@ void game_set_frametime(int state)
 	}
 #endif
 
-	Assertion( Framerate_cap > 0, "Framerate cap %d is too low. Needs to be a positive, non-zero number", Framerate_cap );
-
-	// Cap the framerate so it doesn't get too high.
-	if (!Cmdline_NoFPSCap)
-	{
-		fix cap;
-
-		cap = F1_0/Framerate_cap;
-		if (Frametime < cap) {
-			thistime = cap - Frametime;
-//  			mprintf(("Sleeping for %6.3f seconds.\n", f2fl(thistime)));
-			os_sleep(static_cast<int>(f2fl(thistime) * 1000.0f));
-			Frametime = cap;
-			thistime = timer_get_fixed_seconds();
-		}
-	}
-
 	if((Game_mode & GM_STANDALONE_SERVER) && 
 		(f2fl(Frametime) < ((float)1.0/(float)Multi_options_g.std_framecap))){
 
@@ -4418,6 +4874,11 @@ void game_set_frametime(int state)
 
 	flRealframetime = f2fl(Frametime);
 
+	// the frame times of a replay are the recorded ones so the simulation runs the same
+	if (state == GS_STATE_GAME_PLAY) {
+		replay_frame_start(&Frametime, flRealframetime);
+	}
+
 	//Handle changes in time compression
 	if(Game_time_compression != Desired_time_compression)
 	{
@@ -4730,6 +5191,13 @@ int game_poll()
 			k = 0;
 			break;
 
+		case KEY_SHIFTED | KEY_PRINT_SCRN:
+			if (tracing::flight_recorder_enabled()) {
+				tracing::flight_recorder_dump("hotkey");
+				k = 0;
+			}
+			break;
+
 		case KEY_SHIFTED | KEY_ENTER: {
 
 #if !defined(NDEBUG)
@@ -5639,12 +6107,29 @@ void game_enter_state( int old_state, int new_state )
 			main_hall_stop_music(true);
 			main_hall_stop_ambient();
 			
+			// the simulation benchmark has to load the mission the same way every time
+			if (Cmdline_benchmark_simulation > 0) {
+				srand(Cmdline_benchmark_seed);
+			}
+
+			// same for a replay, this uses the seed of the recording. only single player missions can be replayed
+			if (Game_mode & GM_NORMAL) {
+				replay_mission_start(Game_current_mission_filename);
+			}
+
 			if (Game_mode & GM_NORMAL) {
 				// this should put us into a new state on failure!
 				if (!game_start_mission())
 					break;
 			}
 
+			// nobody is there to pick a loadout for the benchmarks, and a replay has to use the same loadout as its recording
+			if ((Cmdline_benchmark_simulation > 0) || (Cmdline_benchmark_flythrough > 0.0f) || replay_active()) {
+				Select_default_ship = 1;
+				gameseq_post_event(GS_EVENT_ENTER_GAME);
+				break;
+			}
+
 			// maybe play a movie before the mission
 			mission_campaign_maybe_play_movie(CAMPAIGN_MOVIE_PRE_MISSION);
 
@@ -6730,6 +7215,11 @@ int game_main(int argc, char *argv[])
 	}
 
 	while (1) {
+		// the input of the frame is sampled as late as possible, see -low_latency_fps_cap
+		if (Cmdline_low_latency_fps_cap) {
+			frame_pacer_wait(game_frame_cap_ns());
+		}
+
 		// only important for non THREADED mode
 		os_poll();
 
@@ -6740,6 +7230,8 @@ int game_main(int argc, char *argv[])
 
 		// Since tracing is always active this needs to happen in the main loop
 		tracing::process_events();
+
+		memory::tracking::frame();
 	} 
 
 	game_shutdown();
@@ -6861,6 +7353,7 @@ void game_shutdown(void)
 	snd_close();
 	event_music_close();
 	gamesnd_close();		// close out gamesnd, needs to happen *after* other sounds are closed
+	multi_profile_close();
 	psnet_close();
 
 	model_free_all();
@@ -6868,6 +7361,8 @@ void game_shutdown(void)
 
 	tracing::shutdown();
 
+	jobs::shutdown();
+
 #ifndef NDEBUG
 	outwnd_debug_window_deinit();
 #endif
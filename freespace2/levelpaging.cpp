@@ -29,6 +29,7 @@ extern void training_mission_page_in();
 extern void neb2_page_in();
 extern void message_pagein_mission_messages();
 extern void model_page_in_stop();
+extern void gamesnd_page_in_stop();
 extern void mflash_page_in(bool);
 
 namespace particle
@@ -50,15 +51,20 @@ void level_page_in()
 	weapons_page_in();
 	game_busy( NOX("*** paging in various effects ***") );
 	fireballs_page_in();
-	particle::page_in();
 	debris_page_in();
-	hud_page_in();
-	stars_page_in();
 	shockwave_page_in();
-	shield_hit_page_in();
 	asteroid_page_in();
-	neb2_page_in();
-	mflash_page_in(false);  // just so long as it happens after weapons_page_in()
+
+	// a standalone server never draws anything, so it leaves out what is only there to be seen, like the HUD
+	// gauges and the skybox and subspace models
+	if(!(Game_mode & GM_STANDALONE_SERVER)){
+		particle::page_in();
+		hud_page_in();
+		stars_page_in();
+		shield_hit_page_in();
+		neb2_page_in();
+		mflash_page_in(false);  // just so long as it happens after weapons_page_in()
+	}
 
 	// preload mission messages if NOT running low-memory (greater than 48MB)
 	if (game_using_low_mem() == false) {
@@ -68,6 +74,7 @@ void level_page_in()
 	if(!(Game_mode & GM_STANDALONE_SERVER)){
 		model_page_in_stop();		// free any loaded models that aren't used
 		bm_page_in_stop();
+		gamesnd_page_in_stop();		// unload the gameplay sounds of the last level which this one doesn't use
 	}
 
 	mprintf(( "Ending level bitmap paging...\n" ));
@@ -0,0 +1,110 @@
+
+#include "benchmark.h"
+#include "bench_data.h"
+
+#include "bmpman/bmpman.h"
+#include "render/batching.h"
+
+namespace {
+
+// the number of effects added every iteration, about what a busy battle has per frame
+const int EFFECTS_PER_FRAME = 1000;
+
+// a white texture with an alpha channel, like the effect animations
+int create_texture() {
+	static ubyte pixels[16 * 16 * 4];
+	memset(pixels, 255, sizeof(pixels));
+
+	return bm_create(32, 16, 16, pixels);
+}
+
+// renders the batches with the stub renderer which empties them again, this isn't measured
+void flush_batches(benchmark::State& state) {
+	state.pause_timing();
+	batching_render_all(false);
+	state.resume_timing();
+}
+
+}
+
+BENCHMARK(batching_add_laser) {
+	auto starts = benchmark::make_vectors(EFFECTS_PER_FRAME, 1000.0f, 1);
+	auto ends = benchmark::make_vectors(EFFECTS_PER_FRAME, 1000.0f, 2);
+	auto texture = create_texture();
+
+	state.set_items_per_iteration(EFFECTS_PER_FRAME);
+	while (state.keep_running()) {
+		for (int i = 0; i < EFFECTS_PER_FRAME; ++i) {
+			batching_add_laser(texture, &starts[i], 1.0f, &ends[i], 1.0f, 255, 128, 64);
+		}
+
+		flush_batches(state);
+	}
+
+	batching_shutdown();
+	bm_release(texture);
+}
+
+BENCHMARK(batching_add_bitmap) {
+	auto positions = benchmark::make_vectors(EFFECTS_PER_FRAME, 1000.0f);
+	auto texture = create_texture();
+
+	SCP_vector<vertex> verts(EFFECTS_PER_FRAME);
+	for (int i = 0; i < EFFECTS_PER_FRAME; ++i) {
+		memset(&verts[i], 0, sizeof(vertex));
+		verts[i].world = positions[i];
+	}
+
+	state.set_items_per_iteration(EFFECTS_PER_FRAME);
+	while (state.keep_running()) {
+		for (int i = 0; i < EFFECTS_PER_FRAME; ++i) {
+			batching_add_bitmap(texture, &verts[i], 0, 5.0f, 0.8f);
+		}
+
+		flush_batches(state);
+	}
+
+	batching_shutdown();
+	bm_release(texture);
+}
+
+BENCHMARK(batching_add_volume_bitmap_rotated) {
+	auto positions = benchmark::make_vectors(EFFECTS_PER_FRAME, 1000.0f);
+	auto texture = create_texture();
+
+	SCP_vector<vertex> verts(EFFECTS_PER_FRAME);
+	for (int i = 0; i < EFFECTS_PER_FRAME; ++i) {
+		memset(&verts[i], 0, sizeof(vertex));
+		verts[i].world = positions[i];
+	}
+
+	state.set_items_per_iteration(EFFECTS_PER_FRAME);
+	while (state.keep_running()) {
+		for (int i = 0; i < EFFECTS_PER_FRAME; ++i) {
+			batching_add_volume_bitmap_rotated(texture, &verts[i], i * 0.1f, 5.0f, 0.8f);
+		}
+
+		flush_batches(state);
+	}
+
+	batching_shutdown();
+	bm_release(texture);
+}
+
+BENCHMARK(batching_add_beam) {
+	auto starts = benchmark::make_vectors(EFFECTS_PER_FRAME, 1000.0f, 1);
+	auto ends = benchmark::make_vectors(EFFECTS_PER_FRAME, 1000.0f, 2);
+	auto texture = create_texture();
+
+	state.set_items_per_iteration(EFFECTS_PER_FRAME);
+	while (state.keep_running()) {
+		for (int i = 0; i < EFFECTS_PER_FRAME; ++i) {
+			batching_add_beam(texture, &starts[i], &ends[i], 10.0f, 0.9f);
+		}
+
+		flush_batches(state);
+	}
+
+	batching_shutdown();
+	bm_release(texture);
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include "globalincs/pstypes.h"
+
+/** @file
+ *  Input data for the benchmarks which is the same on every run and every platform.
+ */
+
+namespace benchmark {
+
+// the number of values the benchmarks go through over and over, small enough to stay in the cache
+const int DATA_SIZE = 1024;
+
+// a random number in [-1, 1], from a fixed sequence
+inline float next_random(std::uint32_t& seed) {
+	seed = seed * 1664525u + 1013904223u;
+	return static_cast<float>(seed >> 8) / static_cast<float>(1 << 23) - 1.0f;
+}
+
+inline SCP_vector<vec3d> make_vectors(int count, float scale, std::uint32_t seed = 1) {
+	SCP_vector<vec3d> vectors(count);
+
+	for (auto& vec : vectors) {
+		vec.xyz.x = next_random(seed) * scale;
+		vec.xyz.y = next_random(seed) * scale;
+		vec.xyz.z = next_random(seed) * scale;
+	}
+
+	return vectors;
+}
+
+}
@@ -0,0 +1,100 @@
+
+#include "benchmark.h"
+#include "bench_data.h"
+
+#include "math/fvi.h"
+#include "math/vecmat.h"
+
+BENCHMARK(fvi_segment_sphere) {
+	auto p0 = benchmark::make_vectors(benchmark::DATA_SIZE, 100.0f, 1);
+	auto p1 = benchmark::make_vectors(benchmark::DATA_SIZE, 100.0f, 2);
+	auto centers = benchmark::make_vectors(benchmark::DATA_SIZE, 50.0f, 3);
+	vec3d hit;
+
+	state.set_items_per_iteration(benchmark::DATA_SIZE);
+	while (state.keep_running()) {
+		for (int i = 0; i < benchmark::DATA_SIZE; ++i) {
+			benchmark::do_not_optimize(fvi_segment_sphere(&hit, &p0[i], &p1[i], &centers[i], 20.0f));
+		}
+	}
+}
+
+BENCHMARK(fvi_segment_sphere_batch) {
+	auto p0 = benchmark::make_vectors(benchmark::DATA_SIZE, 100.0f, 1);
+	auto p1 = benchmark::make_vectors(benchmark::DATA_SIZE, 100.0f, 2);
+	auto centers = benchmark::make_vectors(benchmark::DATA_SIZE, 50.0f, 3);
+
+	fvi_segment_sphere_batch batch;
+	for (int i = 0; i < benchmark::DATA_SIZE; ++i) {
+		batch.add(&p0[i], &p1[i], &centers[i], 20.0f);
+	}
+
+	SCP_vector<ubyte> hits;
+
+	state.set_items_per_iteration(benchmark::DATA_SIZE);
+	while (state.keep_running()) {
+		benchmark::do_not_optimize(fvi_segment_sphere_batch_test(&batch, &hits));
+	}
+}
+
+BENCHMARK(fvi_ray_plane) {
+	auto origins = benchmark::make_vectors(benchmark::DATA_SIZE, 100.0f, 1);
+	auto directions = benchmark::make_vectors(benchmark::DATA_SIZE, 1.0f, 2);
+	auto normals = benchmark::make_vectors(benchmark::DATA_SIZE, 1.0f, 3);
+	for (auto& normal : normals) {
+		vm_vec_normalize_safe(&normal);
+	}
+	vec3d hit;
+
+	state.set_items_per_iteration(benchmark::DATA_SIZE);
+	while (state.keep_running()) {
+		for (int i = 0; i < benchmark::DATA_SIZE; ++i) {
+			benchmark::do_not_optimize(
+				fvi_ray_plane(&hit, &vmd_zero_vector, &normals[i], &origins[i], &directions[i], 0.0f));
+		}
+	}
+}
+
+BENCHMARK(fvi_point_face) {
+	// One triangle per point, with the point on the plane of the triangle like model_collide checks it
+	auto corners = benchmark::make_vectors(benchmark::DATA_SIZE * 3, 10.0f);
+	SCP_vector<vec3d> normals(benchmark::DATA_SIZE);
+	SCP_vector<vec3d> points(benchmark::DATA_SIZE);
+	std::uint32_t seed = 4;
+
+	for (int i = 0; i < benchmark::DATA_SIZE; ++i) {
+		auto tri = &corners[i * 3];
+		vm_vec_normal(&normals[i], &tri[0], &tri[1], &tri[2]);
+
+		auto u = benchmark::next_random(seed) * 0.5f + 0.5f;
+		auto v = (benchmark::next_random(seed) * 0.5f + 0.5f) * (1.0f - u);
+		vec3d edge1, edge2;
+		vm_vec_sub(&edge1, &tri[1], &tri[0]);
+		vm_vec_sub(&edge2, &tri[2], &tri[0]);
+		vm_vec_scale_add(&points[i], &tri[0], &edge1, u);
+		vm_vec_scale_add2(&points[i], &edge2, v);
+	}
+
+	state.set_items_per_iteration(benchmark::DATA_SIZE);
+	while (state.keep_running()) {
+		for (int i = 0; i < benchmark::DATA_SIZE; ++i) {
+			const vec3d* verts[3] = { &corners[i * 3], &corners[i * 3 + 1], &corners[i * 3 + 2] };
+			benchmark::do_not_optimize(fvi_point_face(&points[i], 3, verts, &normals[i], nullptr, nullptr, nullptr));
+		}
+	}
+}
+
+BENCHMARK(fvi_ray_boundingbox) {
+	auto origins = benchmark::make_vectors(benchmark::DATA_SIZE, 100.0f, 1);
+	auto directions = benchmark::make_vectors(benchmark::DATA_SIZE, 1.0f, 2);
+	vec3d box_min, box_max, hit;
+	vm_vec_make(&box_min, -20.0f, -10.0f, -40.0f);
+	vm_vec_make(&box_max, 20.0f, 10.0f, 40.0f);
+
+	state.set_items_per_iteration(benchmark::DATA_SIZE);
+	while (state.keep_running()) {
+		for (int i = 0; i < benchmark::DATA_SIZE; ++i) {
+			benchmark::do_not_optimize(fvi_ray_boundingbox(&box_min, &box_max, &origins[i], &directions[i], &hit));
+		}
+	}
+}
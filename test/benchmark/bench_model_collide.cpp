@@ -0,0 +1,88 @@
+
+#include "benchmark.h"
+#include "bench_data.h"
+
+#include "math/vecmat.h"
+#include "model/model.h"
+
+namespace {
+
+// the rays of every iteration, they start outside of the model and go through a point near its center
+const int RAYS = 256;
+
+// loads the model given with --model, -1 if there is none
+int load_benchmark_model(benchmark::State& state) {
+	auto filename = benchmark::get_option("model");
+
+	if (filename.empty()) {
+		state.skip("No model given, use --model=<file.pof> with a model in test_data/benchmark/data/models");
+		return -1;
+	}
+
+	static bool model_inited = false;
+	if (!model_inited) {
+		model_init();
+		model_inited = true;
+	}
+
+	auto model_num = model_load(filename.c_str(), 0, nullptr, 0);
+	if (model_num < 0) {
+		state.skip("The model " + filename + " could not be loaded");
+	}
+
+	return model_num;
+}
+
+void collide_rays(benchmark::State& state, int flags, float radius) {
+	auto model_num = load_benchmark_model(state);
+	if (model_num < 0) {
+		return;
+	}
+
+	auto pm = model_get(model_num);
+
+	// Rays from a sphere around the model through points inside of its bounding box
+	auto starts = benchmark::make_vectors(RAYS, 1.0f, 1);
+	auto targets = benchmark::make_vectors(RAYS, 0.5f, 2);
+	for (int i = 0; i < RAYS; ++i) {
+		vm_vec_normalize_safe(&starts[i]);
+		vm_vec_scale(&starts[i], pm->rad * 2.0f);
+
+		targets[i].xyz.x *= pm->maxs.xyz.x - pm->mins.xyz.x;
+		targets[i].xyz.y *= pm->maxs.xyz.y - pm->mins.xyz.y;
+		targets[i].xyz.z *= pm->maxs.xyz.z - pm->mins.xyz.z;
+	}
+
+	vec3d pos = vmd_zero_vector;
+	matrix orient = vmd_identity_matrix;
+
+	state.set_items_per_iteration(RAYS);
+	while (state.keep_running()) {
+		for (int i = 0; i < RAYS; ++i) {
+			mc_info mc;
+			mc_info_init(&mc);
+
+			mc.model_num = model_num;
+			mc.orient = &orient;
+			mc.pos = &pos;
+			mc.p0 = &starts[i];
+			mc.p1 = &targets[i];
+			mc.flags = flags;
+			mc.radius = radius;
+
+			benchmark::do_not_optimize(model_collide(&mc));
+		}
+	}
+
+	model_unload(model_num);
+}
+
+}
+
+BENCHMARK(model_collide_ray) {
+	collide_rays(state, MC_CHECK_MODEL, 0.0f);
+}
+
+BENCHMARK(model_collide_sphereline) {
+	collide_rays(state, MC_CHECK_MODEL | MC_CHECK_SPHERELINE, 2.0f);
+}
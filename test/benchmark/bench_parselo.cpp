@@ -0,0 +1,139 @@
+
+#include "benchmark.h"
+
+#include "parse/parselo.h"
+
+#include <fstream>
+#include <iterator>
+
+namespace {
+
+const int TABLE_ENTRIES = 256;
+
+// a table with the kind of entries the ship and weapon tables have
+SCP_string make_table() {
+	SCP_string table = "#Entries\n\n";
+
+	for (int i = 0; i < TABLE_ENTRIES; ++i) {
+		SCP_string entry;
+		sprintf(entry,
+			"$Name: Entry %d\t\t; a comment\n"
+			"$Speed: %d.5\n"
+			"$Count: %d\n"
+			"$Position: %d.0, -%d.25, 1000.0\n"
+			"/* a block\n   comment */\n"
+			"$Description: \"Some text which goes on for a while, like the descriptions in the tables do\"\n\n",
+			i, i * 3, i % 17, i, i * 2);
+		table += entry;
+	}
+
+	table += "#End\n";
+
+	return table;
+}
+
+// reads the file of the option, the text is empty if there is none
+SCP_vector<char> read_benchmark_file(benchmark::State& state, const char* option) {
+	SCP_vector<char> text;
+
+	auto filename = benchmark::get_option(option);
+	if (filename.empty()) {
+		state.skip(SCP_string("No file given, use --") + option + "=<file>");
+		return text;
+	}
+
+	std::ifstream file(filename.c_str(), std::ios::binary);
+	if (!file) {
+		state.skip("The file " + filename + " could not be read");
+		return text;
+	}
+
+	text.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+	text.push_back('\0');
+
+	return text;
+}
+
+// strips the comments of a real file and then scans it for every line start like the lookups of the tables do
+void benchmark_file(benchmark::State& state, const char* option, const char* first_token) {
+	auto raw_text = read_benchmark_file(state, option);
+	if (raw_text.empty()) {
+		return;
+	}
+
+	SCP_vector<char> text(raw_text.size() * 2);
+
+	state.set_items_per_iteration(raw_text.size());
+	while (state.keep_running()) {
+		process_raw_file_text(text.data(), raw_text.data());
+
+		reset_parse(text.data());
+		int tokens = 0;
+		while (skip_to_start_of_string(first_token)) {
+			++tokens;
+			advance_to_eoln(nullptr);
+		}
+
+		benchmark::do_not_optimize(tokens);
+	}
+}
+
+}
+
+BENCHMARK(parselo_process_raw_text) {
+	auto raw = make_table();
+	SCP_vector<char> raw_text(raw.begin(), raw.end());
+	raw_text.push_back('\0');
+
+	SCP_vector<char> processed(raw_text.size() * 2);
+
+	state.set_items_per_iteration(TABLE_ENTRIES);
+	while (state.keep_running()) {
+		process_raw_file_text(processed.data(), raw_text.data());
+		benchmark::do_not_optimize(processed[0]);
+	}
+}
+
+BENCHMARK(parselo_tokenize_table) {
+	auto raw = make_table();
+	SCP_vector<char> raw_text(raw.begin(), raw.end());
+	raw_text.push_back('\0');
+
+	SCP_vector<char> text(raw_text.size() * 2);
+	process_raw_file_text(text.data(), raw_text.data());
+
+	char name[NAME_LENGTH];
+	SCP_string description;
+	float speed;
+	int count;
+	vec3d position;
+
+	state.set_items_per_iteration(TABLE_ENTRIES);
+	while (state.keep_running()) {
+		reset_parse(text.data());
+
+		required_string("#Entries");
+		while (optional_string("$Name:")) {
+			stuff_string(name, F_NAME, NAME_LENGTH);
+			required_string("$Speed:");
+			stuff_float(&speed);
+			required_string("$Count:");
+			stuff_int(&count);
+			required_string("$Position:");
+			stuff_vec3d(&position);
+			required_string("$Description:");
+			stuff_string(description, F_MESSAGE);
+		}
+		required_string("#End");
+
+		benchmark::do_not_optimize(position);
+	}
+}
+
+BENCHMARK(parselo_table) {
+	benchmark_file(state, "table", "$Name:");
+}
+
+BENCHMARK(parselo_mission) {
+	benchmark_file(state, "mission", "$Name:");
+}
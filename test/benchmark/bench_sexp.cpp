@@ -0,0 +1,53 @@
+
+#include "benchmark.h"
+
+#include "parse/parselo.h"
+#include "parse/sexp.h"
+
+namespace {
+
+// evaluates the given sexp over and over, the test data has no missions so the sexps are built from text
+void eval_sexp_text(benchmark::State& state, const SCP_string& text) {
+	init_sexp();
+
+	SCP_vector<char> buffer(text.begin(), text.end());
+	buffer.push_back('\0');
+
+	auto old_mp = Mp;
+	Mp = buffer.data();
+	auto node = get_sexp_main();
+	Mp = old_mp;
+
+	if (node < 0) {
+		state.skip("The sexp could not be parsed");
+		return;
+	}
+
+	while (state.keep_running()) {
+		benchmark::do_not_optimize(eval_sexp(node));
+	}
+
+	free_sexp2(node);
+}
+
+}
+
+BENCHMARK(sexp_eval_condition) {
+	// A condition like the ones of the mission events, with arithmetic in the arguments
+	eval_sexp_text(state,
+		"( and ( < ( + 1 2 ) 5 ) ( or ( = 3 ( - 5 2 ) ) ( > ( mod 10 3 ) 0 ) ) ( not ( = ( * 2 4 ) 9 ) ) )");
+}
+
+BENCHMARK(sexp_eval_wide_tree) {
+	// Many events are long lists of checks
+	SCP_string text = "( and";
+	for (int i = 0; i < 32; ++i) {
+		SCP_string check;
+		sprintf(check, " ( >= ( + %d ( * %d 2 ) ) %d )", i, i, i);
+		text += check;
+	}
+	text += " )";
+
+	state.set_items_per_iteration(32);
+	eval_sexp_text(state, text);
+}
@@ -0,0 +1,138 @@
+
+#include "benchmark.h"
+#include "bench_data.h"
+
+#include "math/vecmat.h"
+
+namespace {
+
+SCP_vector<matrix> make_matrices(int count) {
+	SCP_vector<matrix> matrices(count);
+	std::uint32_t seed = 2;
+
+	for (auto& mat : matrices) {
+		angles a;
+		a.p = benchmark::next_random(seed) * PI;
+		a.b = benchmark::next_random(seed) * PI;
+		a.h = benchmark::next_random(seed) * PI;
+
+		vm_angles_2_matrix(&mat, &a);
+	}
+
+	return matrices;
+}
+
+}
+
+BENCHMARK(vecmat_vec_add) {
+	auto a = benchmark::make_vectors(benchmark::DATA_SIZE, 100.0f, 1);
+	auto b = benchmark::make_vectors(benchmark::DATA_SIZE, 100.0f, 2);
+	vec3d result;
+
+	state.set_items_per_iteration(benchmark::DATA_SIZE);
+	while (state.keep_running()) {
+		for (int i = 0; i < benchmark::DATA_SIZE; ++i) {
+			vm_vec_add(&result, &a[i], &b[i]);
+			benchmark::do_not_optimize(result);
+		}
+	}
+}
+
+BENCHMARK(vecmat_vec_normalize) {
+	auto vecs = benchmark::make_vectors(benchmark::DATA_SIZE, 100.0f);
+
+	state.set_items_per_iteration(benchmark::DATA_SIZE);
+	while (state.keep_running()) {
+		for (int i = 0; i < benchmark::DATA_SIZE; ++i) {
+			auto vec = vecs[i];
+			benchmark::do_not_optimize(vm_vec_normalize(&vec));
+		}
+	}
+}
+
+BENCHMARK(vecmat_vec_cross_dot) {
+	auto a = benchmark::make_vectors(benchmark::DATA_SIZE, 1.0f, 1);
+	auto b = benchmark::make_vectors(benchmark::DATA_SIZE, 1.0f, 2);
+	vec3d cross;
+
+	state.set_items_per_iteration(benchmark::DATA_SIZE);
+	while (state.keep_running()) {
+		for (int i = 0; i < benchmark::DATA_SIZE; ++i) {
+			vm_vec_cross(&cross, &a[i], &b[i]);
+			benchmark::do_not_optimize(vm_vec_dot(&cross, &a[i]));
+		}
+	}
+}
+
+BENCHMARK(vecmat_vec_rotate) {
+	auto vecs = benchmark::make_vectors(benchmark::DATA_SIZE, 100.0f);
+	auto mats = make_matrices(benchmark::DATA_SIZE);
+	vec3d result;
+
+	state.set_items_per_iteration(benchmark::DATA_SIZE);
+	while (state.keep_running()) {
+		for (int i = 0; i < benchmark::DATA_SIZE; ++i) {
+			vm_vec_rotate(&result, &vecs[i], &mats[i]);
+			benchmark::do_not_optimize(result);
+		}
+	}
+}
+
+BENCHMARK(vecmat_vec_unrotate) {
+	auto vecs = benchmark::make_vectors(benchmark::DATA_SIZE, 100.0f);
+	auto mats = make_matrices(benchmark::DATA_SIZE);
+	vec3d result;
+
+	state.set_items_per_iteration(benchmark::DATA_SIZE);
+	while (state.keep_running()) {
+		for (int i = 0; i < benchmark::DATA_SIZE; ++i) {
+			vm_vec_unrotate(&result, &vecs[i], &mats[i]);
+			benchmark::do_not_optimize(result);
+		}
+	}
+}
+
+BENCHMARK(vecmat_matrix_x_matrix) {
+	auto mats = make_matrices(benchmark::DATA_SIZE);
+	matrix result;
+
+	state.set_items_per_iteration(benchmark::DATA_SIZE);
+	while (state.keep_running()) {
+		for (int i = 0; i < benchmark::DATA_SIZE; ++i) {
+			vm_matrix_x_matrix(&result, &mats[i], &mats[(i + 1) % benchmark::DATA_SIZE]);
+			benchmark::do_not_optimize(result);
+		}
+	}
+}
+
+BENCHMARK(vecmat_orthogonalize_matrix) {
+	auto mats = make_matrices(benchmark::DATA_SIZE);
+	auto noise = benchmark::make_vectors(benchmark::DATA_SIZE, 0.05f);
+
+	// Slightly skewed matrices, like the ones which come out of the physics
+	for (int i = 0; i < benchmark::DATA_SIZE; ++i) {
+		vm_vec_add2(&mats[i].vec.fvec, &noise[i]);
+	}
+
+	state.set_items_per_iteration(benchmark::DATA_SIZE);
+	while (state.keep_running()) {
+		for (int i = 0; i < benchmark::DATA_SIZE; ++i) {
+			auto mat = mats[i];
+			vm_orthogonalize_matrix(&mat);
+			benchmark::do_not_optimize(mat);
+		}
+	}
+}
+
+BENCHMARK(vecmat_vector_2_matrix) {
+	auto vecs = benchmark::make_vectors(benchmark::DATA_SIZE, 100.0f);
+	matrix result;
+
+	state.set_items_per_iteration(benchmark::DATA_SIZE);
+	while (state.keep_running()) {
+		for (int i = 0; i < benchmark::DATA_SIZE; ++i) {
+			vm_vector_2_matrix(&result, &vecs[i], nullptr, nullptr);
+			benchmark::do_not_optimize(result);
+		}
+	}
+}
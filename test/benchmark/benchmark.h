@@ -0,0 +1,117 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+/** @file
+ *  A small benchmark harness for the hot functions of the engine.
+ *
+ *  A benchmark is a function which does the measured work once for every iteration of its state:
+ *
+ *  @code{.cpp}
+ *  BENCHMARK(vecmat_vec_add) {
+ *      vec3d a = ..., b = ..., c;
+ *      while (state.keep_running()) {
+ *          vm_vec_add(&c, &a, &b);
+ *          benchmark::do_not_optimize(c);
+ *      }
+ *  }
+ *  @endcode
+ *
+ *  Only the loop is measured, so the setup before it doesn't count. The runner picks the number of iterations so a run
+ *  takes long enough to be measured, repeats the run and writes the time of the fastest, the median and the mean
+ *  iteration. See main.cpp for the options.
+ */
+
+namespace benchmark {
+
+/**
+ * @brief Tells the compiler the value is used so computing it can't be optimized away
+ */
+void escape(const void* ptr);
+
+template<typename T>
+inline void do_not_optimize(const T& value) {
+	escape(&value);
+}
+
+class State {
+	std::uint64_t _iterations;
+	std::uint64_t _remaining;
+	std::uint64_t _items_per_iteration = 1;
+
+	std::uint64_t _start_ns = 0;
+	std::uint64_t _end_ns = 0;
+	std::uint64_t _paused_ns = 0;
+	std::uint64_t _pause_start = 0;
+
+	void start_timing();
+	void stop_timing();
+
+	std::string _skip_reason;
+
+ public:
+	explicit State(std::uint64_t iterations) : _iterations(iterations), _remaining(iterations) {}
+
+	/**
+	 * @return @c true while there are iterations left
+	 */
+	bool keep_running() {
+		if (_remaining == _iterations) {
+			start_timing();
+		}
+		if (_remaining == 0) {
+			stop_timing();
+			return false;
+		}
+		--_remaining;
+		return true;
+	}
+
+	std::uint64_t iterations() const { return _iterations; }
+
+	/**
+	 * @brief How many items, such as vectors or tokens, one iteration handles, for the items per second
+	 */
+	void set_items_per_iteration(std::uint64_t items) { _items_per_iteration = items; }
+	std::uint64_t items_per_iteration() const { return _items_per_iteration; }
+
+	/**
+	 * @brief Stops measuring, for work every iteration needs which isn't part of the benchmark
+	 */
+	void pause_timing();
+	void resume_timing();
+
+	/**
+	 * @return How long the loop took without the paused time
+	 */
+	std::uint64_t elapsed_ns() const;
+
+	/**
+	 * @brief Marks the benchmark as skipped, for example because its data isn't there
+	 */
+	void skip(const std::string& reason) {
+		_skip_reason = reason;
+		_remaining = 0;
+	}
+	const std::string& skip_reason() const { return _skip_reason; }
+};
+
+typedef void (*benchmark_function)(State& state);
+
+struct registration {
+	registration(const char* name, benchmark_function function);
+};
+
+/**
+ * @brief The value of a --name=value option of the command line, empty if it wasn't given
+ */
+std::string get_option(const char* name);
+
+}
+
+// the function gets a prefix so a benchmark can be named like the function it measures
+#define BENCHMARK(name) \
+	static void benchmark_##name(::benchmark::State& state); \
+	static ::benchmark::registration benchmark_##name##_registration(#name, benchmark_##name); \
+	static void benchmark_##name(::benchmark::State& state)
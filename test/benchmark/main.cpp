@@ -0,0 +1,320 @@
+/**
+ * Runs the benchmarks of the engine hot paths.
+ *
+ * Options:
+ *  --filter=<text>       Only run the benchmarks which have the text in their name
+ *  --min_time=<seconds>  How long a run has to take at least, the default is 0.2 seconds
+ *  --repetitions=<n>     How often every benchmark is run, the default is 5
+ *  --json=<file>         Also write the results as JSON, to compare them between releases
+ *  --model=<file.pof>    The model for model_collide, from test_data/benchmark/data/models
+ *  --table=<file>        A table file for parselo_table, e.g. the ships.tbl of the retail data
+ *  --mission=<file>      A mission file for parselo_mission
+ */
+
+#include "benchmark.h"
+
+#include "cfile/cfile.h"
+#include "cmdline/cmdline.h"
+#include "globalincs/pstypes.h"
+#include "graphics/2d.h"
+#include "io/timer.h"
+#include "localization/localize.h"
+#include "osapi/osapi.h"
+#include "osapi/outwnd.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <vector>
+
+#ifdef main
+#undef main
+#endif
+
+namespace {
+
+struct benchmark_entry {
+	const char* name;
+	benchmark::benchmark_function function;
+};
+
+struct benchmark_result {
+	std::string name;
+	std::string skipped;
+
+	std::uint64_t iterations = 0;
+	double min_ns = 0.0;
+	double median_ns = 0.0;
+	double mean_ns = 0.0;
+	double items_per_second = 0.0;
+};
+
+// a function so the list exists before the first registration, those run during static initialization
+std::vector<benchmark_entry>& get_benchmarks() {
+	static std::vector<benchmark_entry> benchmarks;
+	return benchmarks;
+}
+
+std::map<std::string, std::string> Options;
+
+std::uint64_t now_ns() {
+	return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+		std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+// runs the benchmark once, returns the nanoseconds its loop took
+std::uint64_t run_once(const benchmark_entry& entry, benchmark::State& state) {
+	entry.function(state);
+
+	return state.elapsed_ns();
+}
+
+benchmark_result run_benchmark(const benchmark_entry& entry, double min_time, int repetitions) {
+	benchmark_result result;
+	result.name = entry.name;
+
+	// Find the number of iterations which take long enough
+	auto min_ns = static_cast<std::uint64_t>(min_time * 1e9);
+	std::uint64_t iterations = 1;
+
+	while (true) {
+		benchmark::State state(iterations);
+		auto elapsed = run_once(entry, state);
+
+		if (!state.skip_reason().empty()) {
+			result.skipped = state.skip_reason();
+			return result;
+		}
+
+		if (elapsed >= min_ns || iterations >= (1ull << 40)) {
+			break;
+		}
+
+		// Aim a bit above the minimum so the next run is very likely the last one
+		auto next = elapsed > 0 ? static_cast<std::uint64_t>(iterations * (min_ns * 1.2 / elapsed)) : iterations * 100;
+		iterations = std::max(iterations * 2, std::min(next, iterations * 100));
+	}
+
+	std::vector<double> times;
+	std::uint64_t items = 1;
+
+	for (int i = 0; i < repetitions; ++i) {
+		benchmark::State state(iterations);
+		auto elapsed = run_once(entry, state);
+
+		times.push_back(static_cast<double>(elapsed) / iterations);
+		items = state.items_per_iteration();
+	}
+
+	std::sort(times.begin(), times.end());
+
+	result.iterations = iterations;
+	result.min_ns = times.front();
+	result.median_ns = times[times.size() / 2];
+	for (auto time : times) {
+		result.mean_ns += time;
+	}
+	result.mean_ns /= times.size();
+	result.items_per_second = result.median_ns > 0.0 ? items * 1e9 / result.median_ns : 0.0;
+
+	return result;
+}
+
+void write_json_string(std::ostream& out, const std::string& str) {
+	out << '"';
+	for (auto c : str) {
+		if (c == '"' || c == '\\') {
+			out << '\\';
+		}
+		out << c;
+	}
+	out << '"';
+}
+
+bool write_json(const char* filename, const std::vector<benchmark_result>& results, double min_time, int repetitions) {
+	std::ofstream out(filename);
+
+	if (!out.good()) {
+		return false;
+	}
+
+	out << "{\n  \"context\": {\n";
+#ifdef NDEBUG
+	out << "    \"build_type\": \"release\",\n";
+#else
+	out << "    \"build_type\": \"debug\",\n";
+#endif
+	out << "    \"min_time\": " << min_time << ",\n";
+	out << "    \"repetitions\": " << repetitions << "\n";
+	out << "  },\n  \"benchmarks\": [";
+
+	for (size_t i = 0; i < results.size(); ++i) {
+		auto& result = results[i];
+
+		out << (i == 0 ? "\n" : ",\n") << "    {\"name\": ";
+		write_json_string(out, result.name);
+
+		if (!result.skipped.empty()) {
+			out << ", \"skipped\": ";
+			write_json_string(out, result.skipped);
+		} else {
+			out << ", \"iterations\": " << result.iterations;
+			out << ", \"min_ns\": " << result.min_ns;
+			out << ", \"median_ns\": " << result.median_ns;
+			out << ", \"mean_ns\": " << result.mean_ns;
+			out << ", \"items_per_second\": " << result.items_per_second;
+		}
+		out << "}";
+	}
+
+	out << "\n  ]\n}\n";
+
+	return out.good();
+}
+
+bool init_engine(char* program) {
+	const char* args[] = { program, "-parse_cmdline_only", "-standalone", "-portable_mode", "-mod", "benchmark" };
+	parse_cmdline(static_cast<int>(sizeof(args) / sizeof(args[0])), const_cast<char**>(args));
+
+	timer_init();
+
+#ifndef NDEBUG
+	outwnd_init();
+#endif
+
+	os_init("Benchmark", "Benchmark");
+
+	SCP_string cfile_dir(TEST_DATA_PATH);
+	cfile_dir += DIR_SEPARATOR_CHAR;
+	cfile_dir += "benchmark"; // Cfile expects something after the path
+
+	if (cfile_init(cfile_dir.c_str())) {
+		std::cout << "ERROR: Cfile init failed!" << std::endl;
+		return false;
+	}
+
+	lcl_init(-1);
+	lcl_xstr_init();
+
+	if (!gr_init(nullptr, GR_STUB, 1024, 768)) {
+		std::cout << "ERROR: Graphics init failed!" << std::endl;
+		return false;
+	}
+
+	return true;
+}
+
+}
+
+namespace benchmark {
+
+// not static so the compiler has to assume it is read somewhere
+const void* volatile Escape_sink = nullptr;
+
+void escape(const void* ptr) {
+	Escape_sink = ptr;
+}
+
+void State::start_timing() {
+	_start_ns = now_ns();
+}
+
+void State::stop_timing() {
+	_end_ns = now_ns();
+}
+
+std::uint64_t State::elapsed_ns() const {
+	auto elapsed = _end_ns > _start_ns ? _end_ns - _start_ns : 0;
+
+	return elapsed > _paused_ns ? elapsed - _paused_ns : 0;
+}
+
+void State::pause_timing() {
+	_pause_start = now_ns();
+}
+
+void State::resume_timing() {
+	_paused_ns += now_ns() - _pause_start;
+}
+
+registration::registration(const char* name, benchmark_function function) {
+	get_benchmarks().push_back({ name, function });
+}
+
+std::string get_option(const char* name) {
+	auto iter = Options.find(name);
+
+	return iter != Options.end() ? iter->second : std::string();
+}
+
+}
+
+int main(int argc, char** argv) {
+	for (int i = 1; i < argc; ++i) {
+		auto arg = argv[i];
+
+		if (strncmp(arg, "--", 2) != 0) {
+			std::cout << "ERROR: Unknown argument " << arg << "!" << std::endl;
+			return 1;
+		}
+
+		auto value = strchr(arg, '=');
+		if (value == nullptr) {
+			Options[arg + 2] = "1";
+		} else {
+			Options[std::string(arg + 2, value)] = value + 1;
+		}
+	}
+
+	auto filter = benchmark::get_option("filter");
+	auto min_time = benchmark::get_option("min_time").empty() ? 0.2 : atof(benchmark::get_option("min_time").c_str());
+	auto repetitions = benchmark::get_option("repetitions").empty() ? 5 : atoi(benchmark::get_option("repetitions").c_str());
+	repetitions = std::max(repetitions, 1);
+
+	if (!init_engine(argv[0])) {
+		return 1;
+	}
+
+	auto benchmarks = get_benchmarks();
+	std::sort(benchmarks.begin(), benchmarks.end(),
+		[](const benchmark_entry& left, const benchmark_entry& right) { return strcmp(left.name, right.name) < 0; });
+
+	std::vector<benchmark_result> results;
+
+	printf("%-40s %14s %14s %14s %12s\n", "Benchmark", "Median ns", "Min ns", "Items/s", "Iterations");
+	for (auto& entry : benchmarks) {
+		if (!filter.empty() && strstr(entry.name, filter.c_str()) == nullptr) {
+			continue;
+		}
+
+		auto result = run_benchmark(entry, min_time, repetitions);
+
+		if (!result.skipped.empty()) {
+			printf("%-40s skipped: %s\n", result.name.c_str(), result.skipped.c_str());
+		} else {
+			printf("%-40s %14.1f %14.1f %14.3g %12llu\n", result.name.c_str(), result.median_ns, result.min_ns,
+				result.items_per_second, static_cast<unsigned long long>(result.iterations));
+		}
+		fflush(stdout);
+
+		results.push_back(result);
+	}
+
+	auto json = benchmark::get_option("json");
+	if (!json.empty() && !write_json(json.c_str(), results, min_time, repetitions)) {
+		std::cout << "ERROR: Failed to write " << json << "!" << std::endl;
+		return 1;
+	}
+
+	gr_close();
+	cfile_close();
+	timer_close();
+	lcl_close();
+	os_cleanup();
+
+	return 0;
+}
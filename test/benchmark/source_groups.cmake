@@ -0,0 +1,24 @@
+
+set(source_files)
+
+macro(add_file_folder VAR_NAME FOLDER_NAME)
+    set(file_${VAR_NAME} ${ARGN})
+    source_group("${FOLDER_NAME}" FILES ${file_${VAR_NAME}})
+    set(source_files ${source_files} ${file_${VAR_NAME}})
+endmacro(add_file_folder)
+
+add_file_folder(root ""
+    bench_data.h
+    benchmark.h
+    main.cpp
+    ../src/test_stubs.cpp
+)
+
+add_file_folder(benchmarks "Benchmarks"
+    bench_batching.cpp
+    bench_fvi.cpp
+    bench_model_collide.cpp
+    bench_parselo.cpp
+    bench_sexp.cpp
+    bench_vecmat.cpp
+)
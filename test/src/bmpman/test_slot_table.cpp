@@ -0,0 +1,67 @@
+#define BMPMAN_INTERNAL
+#include "bmpman/bm_internal.h"
+
+#include <gtest/gtest.h>
+
+TEST(BitmapSlotTable, grows_in_chunks) {
+	bitmap_slot_table table;
+
+	ASSERT_EQ(0, table.size());
+	ASSERT_EQ(-1, table.find_free(1));
+
+	ASSERT_TRUE(table.grow(1));
+	ASSERT_EQ(bitmap_slot_table::CHUNK_SIZE, table.size());
+	ASSERT_EQ(0, table.find_free(1));
+
+	ASSERT_FALSE(table.grow(MAX_BITMAPS + 1));
+}
+
+TEST(BitmapSlotTable, smallest_run_is_used) {
+	bitmap_slot_table table;
+	ASSERT_TRUE(table.grow(1));
+
+	table.claim(0, table.size());
+
+	// leaves a run of 8 slots at 10 and a run of 3 slots at 30
+	table.release(10, 8);
+	table.release(30, 3);
+
+	ASSERT_EQ(30, table.find_free(2));
+	ASSERT_EQ(10, table.find_free(4));
+	ASSERT_EQ(-1, table.find_free(9));
+
+	table.claim(30, 2);
+	ASSERT_EQ(32, table.find_free(1));
+}
+
+TEST(BitmapSlotTable, released_runs_are_merged) {
+	bitmap_slot_table table;
+	ASSERT_TRUE(table.grow(1));
+
+	table.claim(0, table.size());
+
+	table.release(10, 5);
+	table.release(20, 5);
+	ASSERT_EQ(-1, table.find_free(15));
+
+	table.release(15, 5);
+	ASSERT_EQ(10, table.find_free(15));
+}
+
+TEST(BitmapSlotTable, handles_of_reused_slots_differ) {
+	bitmap_slot_table table;
+	ASSERT_TRUE(table.grow(1));
+
+	int first = table.next_handle(5, 1);
+	int second = table.next_handle(5, 1);
+
+	ASSERT_EQ(5, first % MAX_BITMAPS);
+	ASSERT_EQ(5, second % MAX_BITMAPS);
+	ASSERT_NE(first, second);
+
+	// an animation over the slot gets a generation newer than every slot it covers
+	int anim = table.next_handle(4, 3);
+
+	ASSERT_EQ(4, anim % MAX_BITMAPS);
+	ASSERT_GT(anim / MAX_BITMAPS, second / MAX_BITMAPS);
+}
@@ -81,3 +81,25 @@ TEST_F(CFileTest, list_files_in_vps_and_dirs) {
 	ASSERT_STREQ("dir", table_files[0].c_str());
 	ASSERT_STREQ("dir2", table_files[1].c_str());
 }
+
+TEST_F(CFileTest, long_checksum_any_length) {
+	const char* check = "123456789";
+	ASSERT_EQ(0x2dfd2d88u, cf_add_chksum_long(0, reinterpret_cast<const ubyte*>(check), strlen(check)));
+
+	SCP_vector<ubyte> data(1000);
+	for (size_t i = 0; i < data.size(); ++i) {
+		data[i] = (ubyte)(i * 31 + 7);
+	}
+
+	// adding the bytes one at a time has to give the same checksum as adding them in one go, whatever the alignment
+	for (size_t offset = 0; offset < 8; ++offset) {
+		for (size_t size = 0; size < 100; ++size) {
+			uint bytewise = 0x12345678;
+			for (size_t i = 0; i < size; ++i) {
+				bytewise = cf_add_chksum_long(bytewise, &data[offset + i], 1);
+			}
+
+			ASSERT_EQ(bytewise, cf_add_chksum_long(0x12345678, &data[offset], size));
+		}
+	}
+}
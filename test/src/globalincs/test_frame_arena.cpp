@@ -0,0 +1,62 @@
+#include "globalincs/frame_arena.h"
+
+#include <gtest/gtest.h>
+
+#include <thread>
+
+TEST(FrameArena, blocks_are_aligned_and_separate) {
+	auto a = static_cast<char*>(frame_arena::allocate(3));
+	auto b = static_cast<char*>(frame_arena::allocate(100));
+
+	ASSERT_EQ(0u, reinterpret_cast<uintptr_t>(a) % 16);
+	ASSERT_EQ(0u, reinterpret_cast<uintptr_t>(b) % 16);
+	ASSERT_GE(b, a + 3);
+
+	frame_arena::deallocate(b);
+	frame_arena::deallocate(a);
+}
+
+TEST(FrameArena, starts_over_once_everything_is_freed) {
+	void* first;
+	{
+		SCP_frame_vector<int> values(10, 1);
+		first = values.data();
+	}
+
+	SCP_frame_vector<int> values(10, 2);
+	ASSERT_EQ(first, values.data());
+}
+
+TEST(FrameArena, merges_chunks_at_frame_end) {
+	// a block larger than a chunk needs a chunk of its own
+	{
+		SCP_frame_vector<char> small(16, 'x');
+		SCP_frame_vector<char> large(3 * 1024 * 1024, 'x');
+		ASSERT_EQ('x', large.back());
+	}
+	frame_arena::frame_end();
+
+	// after merging there is one chunk with room for both blocks
+	SCP_frame_vector<char> small(16, 'y');
+	SCP_frame_vector<char> large(3 * 1024 * 1024, 'y');
+	ASSERT_EQ(small.data() + 32, large.data());
+}
+
+TEST(FrameArena, blocks_can_be_freed_on_other_threads) {
+	SCP_frame_vector<int>* values = nullptr;
+
+	std::thread worker([&values]() {
+		values = new SCP_frame_vector<int>(1000, 3);
+	});
+	worker.join();
+
+	ASSERT_EQ(3, values->back());
+	delete values;
+}
+
+TEST(FrameArena, string) {
+	SCP_frame_string str("a string which is too long for the small string optimization");
+	str += " and some more";
+
+	ASSERT_STREQ("a string which is too long for the small string optimization and some more", str.c_str());
+}
@@ -0,0 +1,71 @@
+#include "globalincs/jobs.h"
+
+#include <gtest/gtest.h>
+
+TEST(Jobs, parallel_for_covers_all_items) {
+	const size_t count = 10000;
+	SCP_vector<int> visited(count, 0);
+
+	jobs::parallel_for(count, 64, [&visited](size_t begin, size_t end, size_t worker) {
+		ASSERT_LT(worker, jobs::num_workers());
+
+		for (size_t i = begin; i < end; ++i) {
+			++visited[i];
+		}
+	});
+
+	for (size_t i = 0; i < count; ++i) {
+		ASSERT_EQ(1, visited[i]);
+	}
+}
+
+TEST(Jobs, nested_parallel_for) {
+	std::atomic<size_t> total(0);
+
+	jobs::parallel_for(16, 1, [&total](size_t begin, size_t end, size_t) {
+		for (size_t i = begin; i < end; ++i) {
+			jobs::parallel_for(100, 10, [&total](size_t inner_begin, size_t inner_end, size_t) {
+				total += inner_end - inner_begin;
+			});
+		}
+	});
+
+	ASSERT_EQ(1600u, total.load());
+}
+
+TEST(Jobs, group_dependencies) {
+	std::atomic<int> first_done(0);
+	std::atomic<int> ran_too_early(0);
+
+	jobs::job_group first;
+	jobs::job_group second;
+
+	for (int i = 0; i < 32; ++i) {
+		first.run([&first_done]() { ++first_done; });
+	}
+	for (int i = 0; i < 8; ++i) {
+		second.run_after(first, [&first_done, &ran_too_early]() {
+			if (first_done != 32) {
+				++ran_too_early;
+			}
+		});
+	}
+
+	second.wait();
+
+	ASSERT_TRUE(first.done());
+	ASSERT_TRUE(second.done());
+	ASSERT_EQ(0, ran_too_early.load());
+}
+
+TEST(Jobs, frame_group) {
+	std::atomic<int> executed(0);
+
+	for (int i = 0; i < 8; ++i) {
+		jobs::frame_group().run([&executed]() { ++executed; });
+	}
+
+	jobs::end_frame();
+
+	ASSERT_EQ(8, executed.load());
+}
@@ -0,0 +1,44 @@
+#include "io/timer.h"
+
+#include <gtest/gtest.h>
+
+TEST(TimestampMicroseconds, special_values) {
+	timestamp_reset();
+
+	ASSERT_EQ(0, timestamp_us(-1));
+	ASSERT_EQ(1, timestamp_us(0));
+
+	ASSERT_FALSE(timestamp_us_elapsed(0));
+	ASSERT_TRUE(timestamp_us_elapsed(1));
+
+	ASSERT_EQ(0, timestamp_us_to_ms(0));
+	ASSERT_EQ(1, timestamp_us_to_ms(1));
+}
+
+TEST(TimestampMicroseconds, elapses_within_a_millisecond) {
+	timestamp_reset();
+	timestamp_set_value(1000);
+
+	auto stamp = timestamp_us(500);
+	ASSERT_EQ(500, timestamp_us_until(stamp));
+	ASSERT_FALSE(timestamp_us_elapsed(stamp));
+
+	// a quarter of a millisecond, the millisecond timestamps don't change
+	timestamp_inc(F1_0 / 4000);
+	ASSERT_EQ(1000, timestamp());
+	ASSERT_FALSE(timestamp_us_elapsed(stamp));
+
+	timestamp_inc(F1_0 / 4000);
+	timestamp_inc(F1_0 / 4000);
+	ASSERT_TRUE(timestamp_us_elapsed(stamp));
+	ASSERT_LT(timestamp_us_until(stamp), 0);
+}
+
+TEST(TimestampMicroseconds, converts_to_the_next_millisecond) {
+	timestamp_reset();
+	timestamp_set_value(1000);
+
+	auto stamp = timestamp_us(1500);
+	ASSERT_EQ(1002, timestamp_us_to_ms(stamp));
+	ASSERT_EQ(1001, timestamp_us_to_ms(timestamp_us(1000)));
+}
@@ -0,0 +1,129 @@
+#include "math/vecmat.h"
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+
+namespace {
+
+matrix test_matrix()
+{
+	angles a;
+	a.p = 0.3f;
+	a.b = -1.1f;
+	a.h = 2.4f;
+
+	matrix m;
+	vm_angles_2_matrix(&m, &a);
+	return m;
+}
+
+SCP_vector<vec3d> test_points(size_t count)
+{
+	SCP_vector<vec3d> points(count);
+
+	for (size_t i = 0; i < count; ++i) {
+		points[i].xyz.x = (float)i * 0.5f - 3.0f;
+		points[i].xyz.y = (float)(i % 7) * -2.25f;
+		points[i].xyz.z = 100.0f / (float)(i + 1);
+	}
+
+	return points;
+}
+
+void expect_near(const vec3d& expected, const vec3d& actual)
+{
+	EXPECT_NEAR(expected.xyz.x, actual.xyz.x, 1e-4f);
+	EXPECT_NEAR(expected.xyz.y, actual.xyz.y, 1e-4f);
+	EXPECT_NEAR(expected.xyz.z, actual.xyz.z, 1e-4f);
+}
+
+}
+
+TEST(VecmatBatch, rotate_matches_single) {
+	matrix m = test_matrix();
+	vec3d origin;
+	vm_vec_make(&origin, 10.0f, -20.0f, 5.0f);
+
+	// not a multiple of four so the remainder is handled as well
+	auto points = test_points(11);
+	SCP_vector<vec3d> rotated(points.size());
+	SCP_vector<vec3d> relative(points.size());
+
+	vm_vec_rotate_n(rotated.data(), points.data(), points.size(), &m);
+	vm_vec_rotate_n(relative.data(), points.data(), points.size(), &m, &origin);
+
+	for (size_t i = 0; i < points.size(); ++i) {
+		vec3d expected, rel;
+		vm_vec_rotate(&expected, &points[i], &m);
+		expect_near(expected, rotated[i]);
+
+		vm_vec_sub(&rel, &points[i], &origin);
+		vm_vec_rotate(&expected, &rel, &m);
+		expect_near(expected, relative[i]);
+	}
+}
+
+TEST(VecmatBatch, unrotate_matches_single) {
+	matrix m = test_matrix();
+	vec3d pos;
+	vm_vec_make(&pos, -4.0f, 8.0f, 1000.0f);
+
+	auto points = test_points(13);
+	SCP_vector<vec3d> world(points.size());
+
+	vm_vec_unrotate_n(world.data(), points.data(), points.size(), &m, &pos);
+
+	for (size_t i = 0; i < points.size(); ++i) {
+		vec3d expected;
+		vm_vec_unrotate(&expected, &points[i], &m);
+		vm_vec_add2(&expected, &pos);
+		expect_near(expected, world[i]);
+	}
+}
+
+TEST(VecmatBatch, in_place) {
+	matrix m = test_matrix();
+
+	auto points = test_points(9);
+	auto expected = points;
+
+	vm_vec_unrotate_n(points.data(), points.data(), points.size(), &m);
+
+	for (size_t i = 0; i < points.size(); ++i) {
+		vec3d single;
+		vm_vec_unrotate(&single, &expected[i], &m);
+		expect_near(single, points[i]);
+	}
+}
+
+// run with --gtest_also_run_disabled_tests to compare the batch functions with single vector rotations
+TEST(VecmatBatch, DISABLED_benchmark) {
+	const size_t count = 4096;
+	const int rounds = 2000;
+
+	matrix m = test_matrix();
+	auto points = test_points(count);
+	SCP_vector<vec3d> out(count);
+
+	auto start = std::chrono::steady_clock::now();
+	for (int round = 0; round < rounds; ++round) {
+		for (size_t i = 0; i < count; ++i) {
+			vm_vec_rotate(&out[i], &points[i], &m);
+		}
+	}
+	auto single = std::chrono::steady_clock::now() - start;
+
+	start = std::chrono::steady_clock::now();
+	for (int round = 0; round < rounds; ++round) {
+		vm_vec_rotate_n(out.data(), points.data(), count, &m);
+	}
+	auto batch = std::chrono::steady_clock::now() - start;
+
+	auto to_ns = [count, rounds](std::chrono::steady_clock::duration d) {
+		return std::chrono::duration<double, std::nano>(d).count() / (double)(count * rounds);
+	};
+
+	printf("vm_vec_rotate:   %.2f ns per vector\n", to_ns(single));
+	printf("vm_vec_rotate_n: %.2f ns per vector\n", to_ns(batch));
+}
@@ -12,12 +12,18 @@ add_file_folder(root ""
     test_stubs.cpp
 )
 
+add_file_folder(bmpman "Bmpman"
+    bmpman/test_slot_table.cpp
+)
+
 add_file_folder(cfile "CFile"
     cfile/cfile.cpp
 )
 
 add_file_folder(graphics "Globalincs"
     globalincs/test_flagset.cpp
+    globalincs/test_frame_arena.cpp
+    globalincs/test_jobs.cpp
     globalincs/test_safe_strings.cpp
 )
 
@@ -25,6 +31,14 @@ add_file_folder(graphics "Graphics"
 	   graphics/test_font.cpp
 )
 
+add_file_folder(io "Io"
+    io/test_timer.cpp
+)
+
+add_file_folder(math "Math"
+    math/test_vecmat_batch.cpp
+)
+
 add_file_folder(menuui "menuui"
     menuui/test_intel_parse.cpp
 )
@@ -62,6 +76,10 @@ add_file_folder(util "Util"
     util/test_util.h
 )
 
+add_file_folder(utils "Utils"
+    utils/test_string_intern.cpp
+)
+
 add_file_folder(weapon "Weapon"
     weapon/weapons.cpp
 )
@@ -0,0 +1,32 @@
+#include "utils/string_intern.h"
+
+#include <gtest/gtest.h>
+
+TEST(StringIntern, same_id_regardless_of_case) {
+	auto id = string_intern::intern("GTF Ulysses");
+
+	ASSERT_EQ(id, string_intern::intern("gtf ulysses"));
+	ASSERT_EQ(id, string_intern::find("GTF ULYSSES"));
+	ASSERT_STREQ("GTF Ulysses", string_intern::get(id));
+
+	ASSERT_NE(id, string_intern::intern("GTF Hercules"));
+}
+
+TEST(StringIntern, find_does_not_add) {
+	ASSERT_EQ(string_intern::INVALID_ID, string_intern::find("a name which was never interned"));
+	ASSERT_EQ(string_intern::INVALID_ID, string_intern::find("a name which was never interned"));
+}
+
+TEST(StringIntern, names_stay_valid_while_growing) {
+	auto first = string_intern::intern("first name");
+	auto first_str = string_intern::get(first);
+
+	for (int i = 0; i < 5000; ++i) {
+		SCP_string name = "name " + std::to_string(i);
+		auto id = string_intern::intern(name.c_str());
+		ASSERT_EQ(id, string_intern::find(name.c_str()));
+	}
+
+	ASSERT_EQ(first, string_intern::find("FIRST NAME"));
+	ASSERT_EQ(first_str, string_intern::get(first));
+}
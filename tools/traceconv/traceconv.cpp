@@ -0,0 +1,358 @@
+/**
+ * Converts a binary trace written with -binary_profiling into the JSON trace format which is also written by
+ * -json_profiling. The output can be loaded by chrome://tracing and the Perfetto UI.
+ */
+
+#include "tracing/BinaryTraceFormat.h"
+
+#include <zlib.h>
+
+#include <string.h>
+
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+using namespace tracing::binary_trace;
+
+enum traceconv_errors {
+	error_none = 0,
+	error_cantopenfile,
+	error_cantoutputfile,
+	error_invalidargs,
+	error_invalidfile,
+};
+
+typedef unsigned char ubyte;
+
+// must match tracing::GPU_PID
+static const std::int64_t GPU_PID = std::numeric_limits<std::int64_t>::min();
+
+struct thread_info {
+	std::int64_t pid = 0;
+	std::int64_t tid = 0;
+	std::uint64_t last_timestamp = 0;
+};
+
+class block_reader {
+	const std::vector<ubyte>& _data;
+	size_t _pos = 0;
+	bool _failed = false;
+
+ public:
+	explicit block_reader(const std::vector<ubyte>& data) : _data(data) {}
+
+	bool done() const { return _failed || _pos >= _data.size(); }
+	bool failed() const { return _failed; }
+
+	ubyte read_byte() {
+		if (_pos >= _data.size()) {
+			_failed = true;
+			return 0;
+		}
+		return _data[_pos++];
+	}
+
+	std::uint64_t read_varuint() {
+		std::uint64_t value = 0;
+		int shift = 0;
+		ubyte next;
+
+		do {
+			next = read_byte();
+			if (shift < 64) {
+				value |= static_cast<std::uint64_t>(next & 0x7f) << shift;
+			}
+			shift += 7;
+		} while ((next & 0x80) && !_failed);
+
+		return value;
+	}
+
+	std::int64_t read_varint() {
+		return zigzag_decode(read_varuint());
+	}
+
+	std::uint32_t read_uint32() {
+		std::uint32_t value = 0;
+		for (int i = 0; i < 4; ++i) {
+			value |= static_cast<std::uint32_t>(read_byte()) << (i * 8);
+		}
+		return value;
+	}
+
+	std::string read_string(size_t len) {
+		if (len > _data.size() - _pos) {
+			_failed = true;
+			return std::string();
+		}
+
+		std::string str(reinterpret_cast<const char*>(_data.data() + _pos), len);
+		_pos += len;
+		return str;
+	}
+};
+
+std::uint32_t read_uint32(const ubyte* data) {
+	return static_cast<std::uint32_t>(data[0]) | (static_cast<std::uint32_t>(data[1]) << 8) |
+		   (static_cast<std::uint32_t>(data[2]) << 16) | (static_cast<std::uint32_t>(data[3]) << 24);
+}
+
+const char* get_type_str(ubyte code) {
+	switch (code) {
+		case EVENT_COMPLETE:
+			return "X";
+		case EVENT_BEGIN:
+			return "B";
+		case EVENT_END:
+			return "E";
+		case EVENT_ASYNC_BEGIN:
+			return "b";
+		case EVENT_ASYNC_STEP:
+			return "n";
+		case EVENT_ASYNC_END:
+			return "e";
+		case EVENT_COUNTER:
+			return "C";
+		case EVENT_FLOW_BEGIN:
+			return "s";
+		case EVENT_FLOW_END:
+			return "f";
+		case EVENT_THREAD_NAME:
+			return "M";
+		default:
+			return nullptr;
+	}
+}
+
+void write_time(std::ostream& out, std::uint64_t time) {
+	auto flags = out.flags();
+	out << std::fixed << std::setprecision(3);
+
+	out << (time / 1000.);
+
+	out.flags(flags);
+}
+
+void write_json_string(std::ostream& out, const std::string& str) {
+	out << '"';
+	for (auto c : str) {
+		if (c == '"' || c == '\\') {
+			out << '\\';
+		}
+		out << c;
+	}
+	out << '"';
+}
+
+class converter {
+	std::ostream& _out;
+	bool _first_line = true;
+	std::uint64_t _events = 0;
+
+	std::unordered_map<std::uint64_t, std::string> _strings;
+	std::unordered_map<std::uint64_t, thread_info> _threads;
+
+	bool write_event(block_reader& reader, ubyte code) {
+		auto type = get_type_str(code);
+		if (type == nullptr) {
+			std::cout << "ERROR: Unknown event type " << int(code) << "!" << std::endl;
+			return false;
+		}
+
+		auto thread_iter = _threads.find(reader.read_varuint());
+		auto delta = reader.read_varint();
+		auto category = reader.read_varuint();
+		auto scope = reader.read_varuint();
+
+		if (thread_iter == _threads.end()) {
+			std::cout << "ERROR: Event of an unknown thread!" << std::endl;
+			return false;
+		}
+
+		auto& thread = thread_iter->second;
+		thread.last_timestamp += delta;
+
+		if (!_first_line) {
+			_out << ",";
+		}
+		_out << "\n{\"tid\": " << thread.tid << ",\"ts\":";
+		write_time(_out, thread.last_timestamp);
+
+		_out << ",\"pid\":";
+		if (thread.pid == GPU_PID) {
+			_out << "\"GPU\"";
+		} else {
+			_out << thread.pid;
+		}
+
+		if (code == EVENT_THREAD_NAME) {
+			_out << ",\"name\":\"thread_name\",\"ph\":\"M\",\"args\": {\"name\":";
+			write_json_string(_out, _strings[category]);
+			_out << "}}";
+
+			_first_line = false;
+			++_events;
+
+			return !reader.failed();
+		}
+
+		if (scope != 0) {
+			_out << ",\"cat\":";
+			write_json_string(_out, _strings[scope]);
+			_out << ",\"id\":\"" << scope << "\"";
+		}
+
+		_out << ",\"name\":";
+		write_json_string(_out, _strings[category]);
+		_out << ",\"ph\":\"" << type << "\"";
+
+		if (code == EVENT_COMPLETE) {
+			_out << ",\"dur\":";
+			write_time(_out, reader.read_varuint());
+		} else if (code == EVENT_COUNTER) {
+			auto bits = reader.read_uint32();
+			float value;
+			memcpy(&value, &bits, sizeof(value));
+
+			auto flags = _out.flags();
+			_out << std::fixed;
+			_out << ",\"args\": {\"value\": " << value << "}";
+			_out.flags(flags);
+		} else if (code == EVENT_FLOW_BEGIN || code == EVENT_FLOW_END) {
+			_out << ",\"cat\":\"flow\",\"id\":\"" << reader.read_varuint() << "\"";
+			if (code == EVENT_FLOW_END) {
+				_out << ",\"bp\":\"e\"";
+			}
+		}
+
+		_out << "}";
+
+		_first_line = false;
+		++_events;
+
+		return !reader.failed();
+	}
+
+ public:
+	explicit converter(std::ostream& out) : _out(out) {
+		_out << "[";
+	}
+	~converter() {
+		_out << "]\n";
+	}
+
+	std::uint64_t events() const { return _events; }
+
+	bool convert_block(const std::vector<ubyte>& block) {
+		block_reader reader(block);
+
+		while (!reader.done()) {
+			auto record = reader.read_byte();
+
+			if (record == RECORD_STRING) {
+				auto id = reader.read_varuint();
+				auto len = reader.read_varuint();
+				_strings[id] = reader.read_string(static_cast<size_t>(len));
+			} else if (record == RECORD_THREAD) {
+				auto id = reader.read_varuint();
+				thread_info info;
+				info.pid = reader.read_varint();
+				info.tid = reader.read_varint();
+				_threads[id] = info;
+			} else if (record >= RECORD_EVENT) {
+				if (!write_event(reader, static_cast<ubyte>(record - RECORD_EVENT))) {
+					return false;
+				}
+			} else {
+				std::cout << "ERROR: Unknown record type " << int(record) << "!" << std::endl;
+				return false;
+			}
+		}
+
+		return !reader.failed();
+	}
+};
+
+int main(int argc, char* argv[]) {
+	if (argc != 3) {
+		std::cout << "Usage: traceconv <input.fstrace> <output.json>" << std::endl;
+		std::cout << "Converts a trace written with -binary_profiling to the JSON trace format." << std::endl;
+		return error_invalidargs;
+	}
+
+	std::ifstream file_in(argv[1], std::ios::binary);
+	if (!file_in.good()) {
+		std::cout << "ERROR: Failed to open input file " << argv[1] << "!" << std::endl;
+		return error_cantopenfile;
+	}
+
+	ubyte header[sizeof(MAGIC) + 4];
+	file_in.read(reinterpret_cast<char*>(header), sizeof(header));
+
+	if (!file_in.good() || memcmp(header, MAGIC, sizeof(MAGIC)) != 0) {
+		std::cout << "ERROR: " << argv[1] << " is not a binary trace!" << std::endl;
+		return error_invalidfile;
+	}
+
+	auto version = read_uint32(header + sizeof(MAGIC));
+	// Newer versions only added records so every older file can be read
+	if (version < 1 || version > VERSION) {
+		std::cout << "ERROR: Version " << version << " of the binary trace is not supported!" << std::endl;
+		return error_invalidfile;
+	}
+
+	std::ofstream file_out(argv[2]);
+	if (!file_out.good()) {
+		std::cout << "ERROR: Failed to open output file " << argv[2] << "!" << std::endl;
+		return error_cantoutputfile;
+	}
+
+	std::vector<ubyte> compressed;
+	std::vector<ubyte> block;
+	std::uint64_t events;
+
+	{
+		converter conv(file_out);
+
+		while (true) {
+			ubyte block_header[8];
+			file_in.read(reinterpret_cast<char*>(block_header), sizeof(block_header));
+
+			if (file_in.gcount() == 0) {
+				// Regular end of the file
+				break;
+			}
+
+			compressed.resize(read_uint32(block_header));
+			block.resize(read_uint32(block_header + 4));
+
+			file_in.read(reinterpret_cast<char*>(compressed.data()), compressed.size());
+
+			uLongf block_size = static_cast<uLongf>(block.size());
+			if (!file_in.good() ||
+				uncompress(block.data(), &block_size, compressed.data(), static_cast<uLong>(compressed.size())) != Z_OK ||
+				block_size != block.size()) {
+				// A trace which wasn't closed properly may end with a partial block, keep what was converted so far
+				std::cout << "WARNING: The trace ends with a damaged block, the rest is ignored." << std::endl;
+				break;
+			}
+
+			if (!conv.convert_block(block)) {
+				std::cout << "WARNING: The trace has a damaged block, the rest is ignored." << std::endl;
+				break;
+			}
+		}
+
+		events = conv.events();
+	}
+
+	std::cout << "Converted " << events << " events." << std::endl;
+
+	return error_none;
+}